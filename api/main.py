@@ -16,7 +16,8 @@ from pydantic import BaseModel, field_validator
 
 sys.path.insert(0, str(Path(__file__).resolve().parent.parent / "notebooks"))
 from book_replay import _MiniBook
-from qrsdp_reader import load_manifest, read_day, read_header
+import libqrsdp
+from qrsdp_reader import load_manifest, read_bars, read_day, read_header
 
 logger = logging.getLogger("qrsdp_api")
 
@@ -28,7 +29,11 @@ _BIN_CANDIDATES = [
     REPO_ROOT / "build" / "Release" / _BIN_BASENAME,
 ]
 RUN_BIN = next((p for p in _BIN_CANDIDATES if p.exists()), _BIN_CANDIDATES[0])
+# In-process engine (libqrsdp); None falls back to spawning RUN_BIN.
+NATIVE_LIB = libqrsdp.load()
 OUTPUT_DIR = REPO_ROOT / "output" / "api_sims"
+# Live runs publish book frames to a ring file here (plain shared memory on Linux).
+LIVE_RING_DIR = Path("/dev/shm") if Path("/dev/shm").is_dir() else OUTPUT_DIR
 
 SYMBOL_RE = re.compile(r"^[A-Z0-9]{1,8}$")
 MAX_DAYS = 252
@@ -81,8 +86,8 @@ PRESETS = {
 
 @asynccontextmanager
 async def lifespan(application: FastAPI):
-    if not RUN_BIN.exists():
-        logger.error("C++ binary not found at %s — build the project first", RUN_BIN)
+    if NATIVE_LIB is None and not RUN_BIN.exists():
+        logger.error("Neither libqrsdp nor %s found — build the project first", RUN_BIN)
     OUTPUT_DIR.mkdir(parents=True, exist_ok=True)
     yield
 
@@ -111,6 +116,10 @@ class SimulationCreate(BaseModel):
     imbalance_sens: Optional[float] = None
     cancel_sens: Optional[float] = None
     spread_sens: Optional[float] = None
+    # Stream while generating, paced at speed (needs libqrsdp); the run
+    # becomes a normal replayable simulation once it finishes.
+    live: bool = False
+    speed: float = 500.0
 
     @field_validator("symbol")
     @classmethod
@@ -155,6 +164,13 @@ class SimulationCreate(BaseModel):
             raise ValueError(f"Unknown preset: {v}. Valid: {list(PRESETS.keys())}")
         return v
 
+    @field_validator("speed")
+    @classmethod
+    def validate_speed(cls, v: float) -> float:
+        if not (1.0 <= v <= MAX_SPEED):
+            raise ValueError(f"speed must be between 1 and {MAX_SPEED}")
+        return v
+
 
 class SimulationInfo(BaseModel):
     id: str
@@ -187,34 +203,52 @@ async def get_presets():
     return PRESETS
 
 
-@app.post("/api/simulations", response_model=SimulationInfo)
-async def create_simulation(cfg: SimulationCreate):
-    symbol = cfg.symbol
-    for s in _simulations.values():
-        if s["symbol"] == symbol and s["status"] == "ready":
-            raise HTTPException(409, f"Symbol '{symbol}' already exists. Delete it first or choose a different name.")
-
-    if not RUN_BIN.exists():
-        raise HTTPException(503, "Simulation engine not available — binary not built")
-
-    preset = PRESETS[cfg.preset]
-    model = cfg.model or preset["model"]
-    if model not in ("simple", "hlr"):
-        raise HTTPException(400, "model must be 'simple' or 'hlr'")
-
-    base_L = cfg.base_L if cfg.base_L is not None else preset["base_L"]
-    base_C = cfg.base_C if cfg.base_C is not None else preset["base_C"]
-    base_M = cfg.base_M if cfg.base_M is not None else preset["base_M"]
-    imb = cfg.imbalance_sens if cfg.imbalance_sens is not None else preset["imbalance_sens"]
-    canc = cfg.cancel_sens if cfg.cancel_sens is not None else preset["cancel_sens"]
-    eps = cfg.epsilon_exec if cfg.epsilon_exec is not None else preset["epsilon_exec"]
-    sprd = cfg.spread_sens if cfg.spread_sens is not None else preset["spread_sens"]
-
-    p0_ticks = int(cfg.p0 * 100)
+async def _run_native(out_dir: Path, symbol: str, cfg: SimulationCreate, p0_ticks: int,
+                      model: str, **params: float):
+    """Run in-process through libqrsdp; event counts come back with the result."""
+    try:
+        result = await asyncio.to_thread(
+            libqrsdp.run, str(out_dir), symbol=symbol, days=cfg.days, seed=cfg.seed,
+            seconds=cfg.seconds, p0_ticks=p0_ticks, model=model, **params,
+        )
+    except (RuntimeError, ValueError) as e:
+        logger.error("Simulation failed: %s", str(e)[:500])
+        raise HTTPException(500, "Simulation engine returned an error")
+    header_sample = None
+    if result["days"]:
+        header_sample = read_header(str(out_dir / result["days"][0]["file"]))
+    return result["total_events"], header_sample
 
-    sim_id = uuid.uuid4().hex[:12]
-    out_dir = OUTPUT_DIR / sim_id
 
+async def _run_live(sim: dict, cfg: SimulationCreate, p0_ticks: int, model: str, **params: float):
+    """Background task of a live simulation: generates in real time at cfg.speed
+    while publishing book frames to sim["ring"], then marks it ready (or failed)."""
+    out_dir = Path(sim["run_dir"])
+    ring = Path(sim["ring"])
+    try:
+        result = await asyncio.to_thread(
+            libqrsdp.run, str(out_dir), symbol=sim["symbol"], days=cfg.days, seed=cfg.seed,
+            seconds=cfg.seconds, p0_ticks=p0_ticks, model=model, realtime=True,
+            speed=cfg.speed, live_frames=str(ring),
+            frame_interval_ns=int(cfg.speed * 1e9 / STREAM_FPS), **params,
+        )
+    except (RuntimeError, ValueError) as e:
+        logger.error("Live simulation failed: %s", str(e)[:500])
+        sim["status"] = "failed"
+        return
+    finally:
+        # Readers that attached keep their mapping; new ones replay the files.
+        ring.unlink(missing_ok=True)
+    sim["total_events"] = result["total_events"]
+    if result["days"]:
+        sim["header_sample"] = read_header(str(out_dir / result["days"][0]["file"]))
+    sim["status"] = "ready"
+
+
+async def _run_subprocess(out_dir: Path, symbol: str, cfg: SimulationCreate, p0_ticks: int,
+                          model: str, params: List[float]):
+    """Fallback without libqrsdp: spawn qrsdp_run, then count events from the files."""
+    base_L, base_C, base_M, imb, canc, eps, sprd = params
     cmd = [
         str(RUN_BIN),
         "--seed", str(cfg.seed),
@@ -257,6 +291,68 @@ async def create_simulation(cfg: SimulationCreate):
                 total += len(evts)
                 if header_sample is None:
                     header_sample = read_header(str(fpath))
+    return total, header_sample
+
+
+@app.post("/api/simulations", response_model=SimulationInfo)
+async def create_simulation(cfg: SimulationCreate):
+    symbol = cfg.symbol
+    for s in _simulations.values():
+        if s["symbol"] == symbol and s["status"] in ("ready", "running"):
+            raise HTTPException(409, f"Symbol '{symbol}' already exists. Delete it first or choose a different name.")
+
+    if NATIVE_LIB is None and not RUN_BIN.exists():
+        raise HTTPException(503, "Simulation engine not available — binary not built")
+    if cfg.live and NATIVE_LIB is None:
+        raise HTTPException(400, "Live simulations need libqrsdp — build the qrsdp target")
+
+    preset = PRESETS[cfg.preset]
+    model = cfg.model or preset["model"]
+    if model not in ("simple", "hlr", "hawkes"):
+        raise HTTPException(400, "model must be 'simple', 'hlr' or 'hawkes'")
+
+    base_L = cfg.base_L if cfg.base_L is not None else preset["base_L"]
+    base_C = cfg.base_C if cfg.base_C is not None else preset["base_C"]
+    base_M = cfg.base_M if cfg.base_M is not None else preset["base_M"]
+    imb = cfg.imbalance_sens if cfg.imbalance_sens is not None else preset["imbalance_sens"]
+    canc = cfg.cancel_sens if cfg.cancel_sens is not None else preset["cancel_sens"]
+    eps = cfg.epsilon_exec if cfg.epsilon_exec is not None else preset["epsilon_exec"]
+    sprd = cfg.spread_sens if cfg.spread_sens is not None else preset["spread_sens"]
+
+    p0_ticks = int(cfg.p0 * 100)
+
+    sim_id = uuid.uuid4().hex[:12]
+    out_dir = OUTPUT_DIR / sim_id
+
+    if cfg.live:
+        sim = {
+            "id": sim_id, "symbol": symbol, "seconds": cfg.seconds, "days": cfg.days,
+            "seed": cfg.seed, "p0": cfg.p0, "status": "running",
+            "total_events": 0, "preset": cfg.preset,
+            "run_dir": str(out_dir), "header_sample": None,
+            "ring": str(LIVE_RING_DIR / f"qrsdp_{sim_id}.ring"), "speed": cfg.speed,
+        }
+        _simulations[sim_id] = sim
+        sim["task"] = asyncio.create_task(_run_live(
+            sim, cfg, p0_ticks, model,
+            base_L=base_L, base_C=base_C, base_M=base_M,
+            imbalance_sensitivity=imb, cancel_sensitivity=canc,
+            epsilon_exec=eps, spread_sensitivity=sprd,
+        ))
+        return SimulationInfo(**_pub(sim))
+
+    if NATIVE_LIB is not None:
+        total, header_sample = await _run_native(
+            out_dir, symbol, cfg, p0_ticks, model,
+            base_L=base_L, base_C=base_C, base_M=base_M,
+            imbalance_sensitivity=imb, cancel_sensitivity=canc,
+            epsilon_exec=eps, spread_sensitivity=sprd,
+        )
+    else:
+        total, header_sample = await _run_subprocess(
+            out_dir, symbol, cfg, p0_ticks, model,
+            [base_L, base_C, base_M, imb, canc, eps, sprd],
+        )
 
     _simulations[sim_id] = {
         "id": sim_id, "symbol": symbol, "seconds": cfg.seconds, "days": cfg.days,
@@ -280,12 +376,51 @@ async def get_simulation(sim_id: str):
     return SimulationInfo(**_pub(s))
 
 
+@app.get("/api/simulations/{sim_id}/bars")
+async def get_bars(sim_id: str, day: int = 0, seconds: int = 60):
+    """OHLC bars of one day from its file footer: no event replay."""
+    s = _simulations.get(sim_id)
+    if not s:
+        raise HTTPException(404, "Not found")
+    if s["status"] != "ready":
+        raise HTTPException(409, "Simulation is still generating")
+    sessions = load_manifest(Path(s["run_dir"]))["securities"][0]["sessions"]
+    if not 0 <= day < len(sessions):
+        raise HTTPException(404, "No such day")
+    bars = read_bars(Path(s["run_dir"]) / sessions[day]["file"]).get(seconds)
+    if bars is None:
+        raise HTTPException(404, f"No {seconds}s bars in this run")
+    tick_div = s["header_sample"].get("tick_size", 100) if s["header_sample"] else 100
+    div = 2.0 * tick_div
+    return {
+        "date": sessions[day]["date"],
+        "seconds": seconds,
+        "bars": [
+            {
+                "time_s": int(b["start_ns"]) / 1e9,
+                "open": int(b["open_mid2"]) / div,
+                "high": int(b["high_mid2"]) / div,
+                "low": int(b["low_mid2"]) / div,
+                "close": int(b["close_mid2"]) / div,
+                "bid": int(b["close_bid_ticks"]) / tick_div,
+                "ask": int(b["close_ask_ticks"]) / tick_div,
+                "events": int(b["events"]),
+                "volume": int(b["volume"]),
+            }
+            for b in bars
+        ],
+    }
+
+
 @app.delete("/api/simulations/{sim_id}", response_model=DeleteResponse)
 async def delete_simulation(sim_id: str):
-    _active_streams.pop(sim_id, None)
-    s = _simulations.pop(sim_id, None)
+    s = _simulations.get(sim_id)
     if not s:
         raise HTTPException(404, "Not found")
+    if s["status"] == "running":
+        raise HTTPException(409, "Simulation is still generating")
+    _active_streams.pop(sim_id, None)
+    _simulations.pop(sim_id, None)
     run_dir = s.get("run_dir")
     if run_dir:
         p = Path(run_dir)
@@ -318,11 +453,203 @@ class _PlaybackState:
         await self._resume_event.wait()
 
 
+STREAM_FPS = 20         # book frames per second of wall time
+STREAM_RECENT_EVENTS = 8
+
+
+async def _stream_day_frames(websocket: WebSocket, pb: _PlaybackState, sim_id: str,
+                             fpath: Path, ctx: dict):
+    """Forwards one day as binary book frames built in C++ (libqrsdp.FrameStream):
+    a JSON "day" message with the context the frames lack, then one frame per
+    speed / STREAM_FPS simulated seconds. Returns (events, close bid ticks), or
+    None once the client has gone."""
+    await websocket.send_json({"type": "day", **ctx})
+    speed = pb.speed
+    frames = libqrsdp.FrameStream(fpath, int(speed * 1e9 / STREAM_FPS), STREAM_RECENT_EVENTS)
+    prev_ts_ns = None
+    last = None
+    try:
+        for frame in frames:
+            if not _active_streams.get(sim_id, False):
+                break
+            await pb.wait_if_paused()
+            if pb.speed != speed:
+                speed = pb.speed
+                frames.set_interval(int(speed * 1e9 / STREAM_FPS))
+            ts_ns = libqrsdp.frame_ts_ns(frame)
+            if prev_ts_ns is not None:
+                wall_gap = (ts_ns - prev_ts_ns) / 1e9 / speed
+                if wall_gap > 0:
+                    await asyncio.sleep(min(wall_gap, 2.0))
+            prev_ts_ns = ts_ns
+            try:
+                await websocket.send_bytes(frame)
+            except Exception:
+                return None
+            last = frame
+    finally:
+        frames.close()
+    if last is None:
+        return 0, 0
+    info = libqrsdp.decode_frame(last)
+    return info["record_index"], info["best_bid"]
+
+
+async def _stream_live(websocket: WebSocket, pb: _PlaybackState, sim_id: str, sim: dict) -> bool:
+    """Forwards a running simulation's book frames as the engine publishes them
+    (libqrsdp.Feed): each day start becomes the JSON "day" message, each day end
+    a "night" one. The engine sets the pace; while paused, frames are skipped.
+    Returns False if the run finished before the feed could attach (the caller
+    replays the files instead)."""
+    feed = None
+    while feed is None:
+        if sim["status"] != "running":
+            return False
+        try:
+            feed = libqrsdp.Feed(sim["ring"])
+        except OSError:
+            await asyncio.sleep(0.05)  # the run has not created the ring yet
+    try:
+        day = None
+        events_before = 0
+        while _active_streams.get(sim_id, False):
+            msg = feed.next()
+            if msg is None:
+                if feed.closed:
+                    break
+                await asyncio.sleep(0.5 / STREAM_FPS)
+                continue
+            kind, payload = msg
+            if kind == libqrsdp.FEED_BOOK_FRAME:
+                if not pb.paused:
+                    await websocket.send_bytes(payload)
+            elif kind == libqrsdp.FEED_DAY_START:
+                day = libqrsdp.decode_day_start(payload)
+                await websocket.send_json({
+                    "type": "day",
+                    "total": 0,  # not known until the run ends
+                    "day": day["day_index"] + 1,
+                    "totalDays": day["num_days"],
+                    "date": day["date"],
+                    "dayOffset": day["day_index"] * 86400,
+                    "eventsBefore": events_before,
+                    "tickSize": day["tick_size"],
+                })
+            elif kind == libqrsdp.FEED_DAY_END:
+                end = libqrsdp.decode_day_end(payload)
+                events_before += end["events"]
+                if day and end["day_index"] + 1 < day["num_days"]:
+                    await websocket.send_json({
+                        "type": "night",
+                        "day": end["day_index"] + 1,
+                        "totalDays": day["num_days"],
+                        "date": day["date"],
+                        "nextDate": "",
+                        "close": round(end["close_ticks"] / day["tick_size"], 4),
+                    })
+        if _active_streams.get(sim_id, False):
+            await websocket.send_json({"type": "complete", "totalEvents": events_before,
+                                       "totalDays": day["num_days"] if day else 0})
+    finally:
+        feed.close()
+    return True
+
+
+async def _stream_day_json(websocket: WebSocket, pb: _PlaybackState, sim_id: str,
+                           fpath: Path, ctx: dict):
+    """Fallback without libqrsdp: replays the day in Python and sends JSON "tick"
+    messages, about 400 per day. Same return as _stream_day_frames."""
+    tick_div = ctx["tickSize"]
+    hdr = read_header(str(fpath))
+    events = read_day(str(fpath))
+    n = len(events)
+
+    book = _MiniBook(
+        p0_ticks=hdr["p0_ticks"],
+        levels_per_side=hdr["levels_per_side"],
+        initial_spread_ticks=hdr["initial_spread_ticks"],
+        initial_depth=hdr["initial_depth"],
+    )
+
+    ts_arr = events["ts_ns"]
+    types = events["type"]
+    prices = events["price_ticks"]
+    qtys = events["qty"]
+
+    prev_ts_ns = int(ts_arr[0]) if n else 0
+    batch = max(1, n // 400)
+    recent_events: list = []
+
+    for i in range(n):
+        if not _active_streams.get(sim_id, False):
+            break
+
+        await pb.wait_if_paused()
+
+        etype = int(types[i])
+        eprice = int(prices[i])
+        eqty = int(qtys[i])
+        book.apply(etype, eprice, eqty)
+
+        recent_events.append({
+            "type": EVENT_NAMES.get(etype, "?"),
+            "price": round(eprice / tick_div, 4),
+            "qty": eqty,
+        })
+        if len(recent_events) > 50:
+            recent_events = recent_events[-50:]
+
+        if i % batch == 0 or i == n - 1:
+            cur_ts_ns = int(ts_arr[i])
+            if i > 0:
+                sim_gap_s = (cur_ts_ns - prev_ts_ns) / 1e9
+                wall_gap = sim_gap_s / pb.speed
+                if wall_gap > 0:
+                    await asyncio.sleep(min(wall_gap, 2.0))
+            prev_ts_ns = cur_ts_ns
+
+            mid = (book.best_bid + book.best_ask) / 2.0
+            ts_s = cur_ts_ns / 1e9
+
+            bids = [{"price": round(book.bids[k].price / tick_div, 4),
+                     "depth": book.bids[k].depth}
+                    for k in range(book.num_levels)]
+            asks = [{"price": round(book.asks[k].price / tick_div, 4),
+                     "depth": book.asks[k].depth}
+                    for k in range(book.num_levels)]
+
+            msg = {
+                "type": "tick",
+                "idx": ctx["eventsBefore"] + i,
+                "total": ctx["total"],
+                "day": ctx["day"],
+                "totalDays": ctx["totalDays"],
+                "date": ctx["date"],
+                "ts": round(ts_s, 3),
+                "dayOffset": ctx["dayOffset"],
+                "mid": round(mid / tick_div, 4),
+                "bestBid": round(book.best_bid / tick_div, 4),
+                "bestAsk": round(book.best_ask / tick_div, 4),
+                "spread": round((book.best_ask - book.best_bid) / tick_div, 4),
+                "bids": bids,
+                "asks": asks,
+                "events": recent_events[-8:],
+                "speed": pb.speed,
+            }
+            try:
+                await websocket.send_json(msg)
+            except Exception:
+                return None
+            recent_events.clear()
+
+    return n, book.best_bid
+
+
 @app.websocket("/api/simulations/{sim_id}/stream")
 async def stream_simulation(websocket: WebSocket, sim_id: str):
     await websocket.accept()
     sim = _simulations.get(sim_id)
-    if not sim or sim["status"] != "ready":
+    if not sim or sim["status"] not in ("ready", "running"):
         await websocket.send_json({"type": "error", "msg": "Simulation not found or not ready"})
         await websocket.close(code=4004)
         return
@@ -331,7 +658,8 @@ async def stream_simulation(websocket: WebSocket, sim_id: str):
     initial_speed = float(speed_param) if speed_param else 500.0
     initial_speed = max(1.0, min(initial_speed, MAX_SPEED))
 
-    pb = _PlaybackState(initial_speed)
+    live = sim["status"] == "running"
+    pb = _PlaybackState(sim["speed"] if live else initial_speed)
     _active_streams[sim_id] = True
 
     async def _listen_controls():
@@ -344,7 +672,8 @@ async def stream_simulation(websocket: WebSocket, sim_id: str):
                     continue
                 ctype = ctrl.get("type")
                 if ctype == "set_speed" and isinstance(ctrl.get("speed"), (int, float)):
-                    pb.set_speed(float(ctrl["speed"]))
+                    if not live:  # a live run keeps the engine's pace
+                        pb.set_speed(float(ctrl["speed"]))
                     await websocket.send_json({"type": "speed_changed", "speed": pb.speed})
                 elif ctype == "pause":
                     pb.pause()
@@ -357,12 +686,17 @@ async def stream_simulation(websocket: WebSocket, sim_id: str):
 
     control_task = asyncio.create_task(_listen_controls())
 
-    run_dir = Path(sim["run_dir"])
-    header_sample = sim["header_sample"]
-    tick_div = header_sample.get("tick_size", 100) if header_sample else 100
-
     try:
         await websocket.send_json({"type": "playback_init", "speed": pb.speed, "paused": False})
+        if live and await _stream_live(websocket, pb, sim_id, sim):
+            return
+        if sim["status"] != "ready":
+            await websocket.send_json({"type": "error", "msg": "Simulation failed"})
+            return
+
+        run_dir = Path(sim["run_dir"])
+        header_sample = sim["header_sample"]
+        tick_div = header_sample.get("tick_size", 100) if header_sample else 100
 
         manifest = load_manifest(run_dir)
         sec = manifest["securities"][0]
@@ -376,94 +710,25 @@ async def stream_simulation(websocket: WebSocket, sim_id: str):
                 break
 
             fpath = run_dir / sess["file"]
-            hdr = read_header(str(fpath))
-            events = read_day(str(fpath))
-            n = len(events)
-
-            book = _MiniBook(
-                p0_ticks=hdr["p0_ticks"],
-                levels_per_side=hdr["levels_per_side"],
-                initial_spread_ticks=hdr["initial_spread_ticks"],
-                initial_depth=hdr["initial_depth"],
-            )
-
-            ts_arr = events["ts_ns"]
-            types = events["type"]
-            prices = events["price_ticks"]
-            qtys = events["qty"]
-
-            prev_ts_ns = int(ts_arr[0])
-            batch = max(1, n // 400)
-            recent_events: list = []
-
-            for i in range(n):
-                if not _active_streams.get(sim_id, False):
-                    break
-
-                await pb.wait_if_paused()
-
-                etype = int(types[i])
-                eprice = int(prices[i])
-                eqty = int(qtys[i])
-                book.apply(etype, eprice, eqty)
-
-                recent_events.append({
-                    "type": EVENT_NAMES.get(etype, "?"),
-                    "price": round(eprice / tick_div, 4),
-                    "qty": eqty,
-                })
-                if len(recent_events) > 50:
-                    recent_events = recent_events[-50:]
-
-                if i % batch == 0 or i == n - 1:
-                    cur_ts_ns = int(ts_arr[i])
-                    if i > 0:
-                        sim_gap_s = (cur_ts_ns - prev_ts_ns) / 1e9
-                        wall_gap = sim_gap_s / pb.speed
-                        if wall_gap > 0:
-                            await asyncio.sleep(min(wall_gap, 2.0))
-                    prev_ts_ns = cur_ts_ns
-
-                    mid = (book.best_bid + book.best_ask) / 2.0
-                    ts_s = cur_ts_ns / 1e9
-                    global_idx = events_so_far + i
-
-                    bids = [{"price": round(book.bids[k].price / tick_div, 4),
-                             "depth": book.bids[k].depth}
-                            for k in range(book.num_levels)]
-                    asks = [{"price": round(book.asks[k].price / tick_div, 4),
-                             "depth": book.asks[k].depth}
-                            for k in range(book.num_levels)]
-
-                    msg = {
-                        "type": "tick",
-                        "idx": global_idx,
-                        "total": grand_total,
-                        "day": day_idx + 1,
-                        "totalDays": total_days,
-                        "date": sess["date"],
-                        "ts": round(ts_s, 3),
-                        "dayOffset": day_idx * 86400,
-                        "mid": round(mid / tick_div, 4),
-                        "bestBid": round(book.best_bid / tick_div, 4),
-                        "bestAsk": round(book.best_ask / tick_div, 4),
-                        "spread": round((book.best_ask - book.best_bid) / tick_div, 4),
-                        "bids": bids,
-                        "asks": asks,
-                        "events": recent_events[-8:],
-                        "speed": pb.speed,
-                    }
-                    try:
-                        await websocket.send_json(msg)
-                    except Exception:
-                        return
-                    recent_events.clear()
-
+            ctx = {
+                "total": grand_total,
+                "day": day_idx + 1,
+                "totalDays": total_days,
+                "date": sess["date"],
+                "dayOffset": day_idx * 86400,
+                "eventsBefore": events_so_far,
+                "tickSize": tick_div,
+            }
+            stream_day = _stream_day_frames if NATIVE_LIB is not None else _stream_day_json
+            streamed = await stream_day(websocket, pb, sim_id, fpath, ctx)
+            if streamed is None:
+                return
+            n, close_bid_ticks = streamed
             events_so_far += n
 
             if day_idx < total_days - 1 and _active_streams.get(sim_id, False):
                 next_date = sessions[day_idx + 1]["date"]
-                close_price = round(book.best_bid / tick_div, 4)
+                close_price = round(close_bid_ticks / tick_div, 4)
                 try:
                     await websocket.send_json({
                         "type": "night",
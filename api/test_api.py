@@ -1,9 +1,11 @@
 """API integration tests for the QRSDP simulation backend."""
 
+import asyncio
+
 import pytest
 from httpx import ASGITransport, AsyncClient
 
-from api.main import app, _simulations, OUTPUT_DIR, RUN_BIN
+from api.main import app, _simulations, NATIVE_LIB, OUTPUT_DIR, RUN_BIN
 
 
 @pytest.fixture(autouse=True)
@@ -126,12 +128,61 @@ async def test_duplicate_symbol_rejected(client):
     assert r.status_code == 409
 
 
+@pytest.mark.anyio
+@pytest.mark.skipif(NATIVE_LIB is None, reason="libqrsdp not built")
+async def test_live_simulation_becomes_ready(client):
+    r = await client.post("/api/simulations", json={
+        "symbol": "LIVE", "seconds": 60, "days": 1, "seed": 1, "p0": 100,
+        "live": True, "speed": 600,
+    })
+    assert r.status_code == 200
+    sim = r.json()
+    assert sim["status"] == "running"
+    assert (await client.delete(f"/api/simulations/{sim['id']}")).status_code == 409
+    assert (await client.get(f"/api/simulations/{sim['id']}/bars")).status_code == 409
+
+    for _ in range(100):
+        sim = (await client.get(f"/api/simulations/{sim['id']}")).json()
+        if sim["status"] != "running":
+            break
+        await asyncio.sleep(0.1)
+    assert sim["status"] == "ready"
+    assert sim["total_events"] > 0
+    r = await client.get(f"/api/simulations/{sim['id']}/bars", params={"seconds": 60})
+    assert sum(b["events"] for b in r.json()["bars"]) == sim["total_events"]
+    await client.delete(f"/api/simulations/{sim['id']}")
+
+
 @pytest.mark.anyio
 async def test_delete_nonexistent_returns_404(client):
     r = await client.delete("/api/simulations/does_not_exist")
     assert r.status_code == 404
 
 
+@pytest.mark.anyio
+async def test_bars_nonexistent_returns_404(client):
+    r = await client.get("/api/simulations/does_not_exist/bars")
+    assert r.status_code == 404
+
+
+@pytest.mark.anyio
+@pytest.mark.skipif(not RUN_BIN.exists(), reason="C++ binary not built")
+async def test_bars_come_from_the_day_file(client):
+    r = await client.post("/api/simulations", json={
+        "symbol": "BARS", "seconds": 120, "days": 1, "seed": 3, "p0": 100,
+    })
+    sim = r.json()
+    r = await client.get(f"/api/simulations/{sim['id']}/bars", params={"seconds": 60})
+    assert r.status_code == 200
+    bars = r.json()["bars"]
+    assert len(bars) == 2
+    assert sum(b["events"] for b in bars) == sim["total_events"]
+    assert all(b["low"] <= b["close"] <= b["high"] for b in bars)
+    r = await client.get(f"/api/simulations/{sim['id']}/bars", params={"seconds": 7})
+    assert r.status_code == 404
+    await client.delete(f"/api/simulations/{sim['id']}")
+
+
 @pytest.mark.anyio
 async def test_get_nonexistent_returns_404(client):
     r = await client.get("/api/simulations/does_not_exist")
@@ -0,0 +1,66 @@
+#include <benchmark/benchmark.h>
+#include "bench_support.h"
+
+#include "book/multi_level_book.h"
+#include "book/order_level_book.h"
+
+namespace qrsdp {
+namespace bench {
+
+/// apply() over a recorded session, in order, so the book sees the producer's
+/// own mix of adds, cancels, executions and shifts.
+template <class Book>
+static void BM_BookApply(benchmark::State& state) {
+    const std::vector<EventRecord>& events = recordedEvents();
+    Book book;
+    book.seed(benchBookSeed());
+    size_t i = 0;
+    for (auto _ : state) {
+        book.apply(toSimEvent(events[i]));
+        if (++i == events.size()) {
+            state.PauseTiming();
+            book.seed(benchBookSeed());
+            i = 0;
+            state.ResumeTiming();
+        }
+    }
+    benchmark::DoNotOptimize(book.bestBid());
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK_TEMPLATE(BM_BookApply, MultiLevelBook);
+BENCHMARK_TEMPLATE(BM_BookApply, MultiLevelBookN<5>);
+BENCHMARK_TEMPLATE(BM_BookApply, OrderLevelBook);
+
+/// Executions that take out the whole best level, so every apply() shifts the
+/// ladder; buys and sells alternate to keep the price in place. Arg: K.
+template <class Book>
+static void BM_BookShift(benchmark::State& state) {
+    const uint32_t levels = static_cast<uint32_t>(state.range(0));
+    Book book;
+    book.seed(benchBookSeed(levels, 1));
+    uint64_t id = 1;
+    bool buy = true;
+    for (auto _ : state) {
+        const Level best = buy ? book.bestAsk() : book.bestBid();
+        book.apply(SimEvent{buy ? EventType::EXECUTE_BUY : EventType::EXECUTE_SELL,
+                            buy ? Side::ASK : Side::BID, best.price_ticks, best.depth, id++});
+        buy = !buy;
+    }
+    benchmark::DoNotOptimize(book.bestBid());
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK_TEMPLATE(BM_BookShift, MultiLevelBook)->Arg(5)->Arg(10)->Arg(50);
+BENCHMARK_TEMPLATE(BM_BookShift, OrderLevelBook)->Arg(5)->Arg(10)->Arg(50);
+
+/// features(): the book snapshot taken before every intensity update.
+static void BM_BookFeatures(benchmark::State& state) {
+    MultiLevelBook book;
+    book.seed(benchBookSeed());
+    for (auto _ : state)
+        benchmark::DoNotOptimize(book.features());
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_BookFeatures);
+
+}  // namespace bench
+}  // namespace qrsdp
@@ -0,0 +1,115 @@
+#include <benchmark/benchmark.h>
+#include "bench_support.h"
+
+#include "io/binary_file_sink.h"
+#include "io/event_log_reader.h"
+
+#include <cstdio>
+#include <memory>
+
+namespace qrsdp {
+namespace bench {
+
+static constexpr uint32_t kChunk = kDefaultChunkCapacity;
+static constexpr int kChunksPerFile = 256;  // reopen the sink so the file stays small
+
+static BinaryFileSinkOptions sinkOptions(bool columnar, ChunkCodec codec) {
+    BinaryFileSinkOptions options;
+    options.chunk_capacity = kChunk;
+    options.columnar = columnar;
+    options.codec.codec = codec;
+    return options;
+}
+
+static const char* layoutLabel(bool columnar, ChunkCodec codec) {
+    if (codec == ChunkCodec::NONE) return columnar ? "columnar/none" : "row/none";
+    return columnar ? "columnar/lz4" : "row/lz4";
+}
+
+/// One full chunk per iteration through appendBatch: record conversion, encoding,
+/// compression and the write, on the caller's thread. Args: columnar, codec (0 = lz4, 1 = none).
+static void BM_FileSinkChunkFlush(benchmark::State& state) {
+    const bool columnar = state.range(0) != 0;
+    const ChunkCodec codec = state.range(1) != 0 ? ChunkCodec::NONE : ChunkCodec::LZ4;
+    const std::vector<EventRecord>& events = recordedEvents();
+    const size_t slices = events.size() / kChunk;
+    const std::string path = scratchPath("qrsdp_bench_sink.qrsdp");
+    const TradingSession session = benchSession(42);
+    const BinaryFileSinkOptions options = sinkOptions(columnar, codec);
+
+    auto sink = std::make_unique<BinaryFileSink>(path, session, options);
+    size_t slice = 0;
+    int chunks = 0;
+    for (auto _ : state) {
+        sink->appendBatch(events.data() + slice * kChunk, kChunk);
+        if (++slice == slices) slice = 0;
+        if (++chunks == kChunksPerFile) {
+            state.PauseTiming();
+            sink->close();
+            sink = std::make_unique<BinaryFileSink>(path, session, options);
+            chunks = 0;
+            state.ResumeTiming();
+        }
+    }
+    sink->close();
+    std::remove(path.c_str());
+    state.SetItemsProcessed(state.iterations() * kChunk);
+    state.SetBytesProcessed(state.iterations() * kChunk * sizeof(DiskEventRecord));
+    state.SetLabel(layoutLabel(columnar, codec));
+}
+BENCHMARK(BM_FileSinkChunkFlush)->Args({0, 0})->Args({1, 0})->Args({0, 1})->Args({1, 1});
+
+/// Writes the recorded events as one file for the reader benchmarks.
+static std::string writeBenchFile(bool columnar, ChunkCodec codec) {
+    const std::string path = scratchPath(columnar ? "qrsdp_bench_col.qrsdp" : "qrsdp_bench_row.qrsdp");
+    BinaryFileSink sink(path, benchSession(42), sinkOptions(columnar, codec));
+    const std::vector<EventRecord>& events = recordedEvents();
+    sink.appendBatch(events.data(), events.size());
+    sink.close();
+    return path;
+}
+
+/// chunkRecords(): decompress and decode one chunk into reused scratch. Args as above.
+static void BM_ReaderChunkDecode(benchmark::State& state) {
+    const bool columnar = state.range(0) != 0;
+    const ChunkCodec codec = state.range(1) != 0 ? ChunkCodec::NONE : ChunkCodec::LZ4;
+    const std::string path = writeBenchFile(columnar, codec);
+    {
+        EventLogReader reader(path);
+        std::vector<DiskEventRecord> scratch;
+        uint32_t idx = 0;
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(reader.chunkRecords(idx, scratch).data);
+            if (++idx == reader.chunkCount()) idx = 0;
+        }
+    }
+    std::remove(path.c_str());
+    state.SetItemsProcessed(state.iterations() * kChunk);
+    state.SetBytesProcessed(state.iterations() * kChunk * sizeof(DiskEventRecord));
+    state.SetLabel(layoutLabel(columnar, codec));
+}
+BENCHMARK(BM_ReaderChunkDecode)->Args({0, 0})->Args({1, 0})->Args({0, 1})->Args({1, 1});
+
+/// readColumns() of the ts and price columns only, the typical analytics
+/// projection; on columnar chunks the other columns are skipped. Arg: columnar.
+static void BM_ReaderColumnProjection(benchmark::State& state) {
+    const bool columnar = state.range(0) != 0;
+    const std::string path = writeBenchFile(columnar, ChunkCodec::LZ4);
+    {
+        EventLogReader reader(path);
+        ChunkColumns cols;
+        uint32_t idx = 0;
+        for (auto _ : state) {
+            reader.readColumns(idx, kSelectTs | kSelectPrice, cols);
+            benchmark::DoNotOptimize(cols);
+            if (++idx == reader.chunkCount()) idx = 0;
+        }
+    }
+    std::remove(path.c_str());
+    state.SetItemsProcessed(state.iterations() * kChunk);
+    state.SetLabel(columnar ? "columnar/lz4" : "row/lz4");
+}
+BENCHMARK(BM_ReaderColumnProjection)->Arg(0)->Arg(1);
+
+}  // namespace bench
+}  // namespace qrsdp
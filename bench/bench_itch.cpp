@@ -0,0 +1,88 @@
+#include <benchmark/benchmark.h>
+#include "bench_support.h"
+
+#include "itch/itch_encoder.h"
+#include "itch/moldudp64.h"
+
+#include <cstdint>
+
+namespace qrsdp {
+namespace bench {
+
+using itch::ItchEncoder;
+using itch::MoldUDP64Framer;
+
+/// encodeInto() over the recorded event mix (adds, deletes, executions).
+static void BM_ItchEncodeInto(benchmark::State& state) {
+    const std::vector<EventRecord>& events = recordedEvents();
+    ItchEncoder encoder("AAPL", 1, 100);
+    uint8_t buf[ItchEncoder::kMaxMessageSize];
+    size_t i = 0;
+    size_t bytes = 0;
+    for (auto _ : state) {
+        bytes += encoder.encodeInto(events[i], buf, sizeof(buf));
+        benchmark::DoNotOptimize(buf);
+        if (++i == events.size()) i = 0;
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.SetBytesProcessed(static_cast<int64_t>(bytes));
+}
+BENCHMARK(BM_ItchEncodeInto);
+
+/// encode(): the allocating form, for comparison with encodeInto().
+static void BM_ItchEncodeVector(benchmark::State& state) {
+    const std::vector<EventRecord>& events = recordedEvents();
+    ItchEncoder encoder("AAPL", 1, 100);
+    size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(encoder.encode(events[i]));
+        if (++i == events.size()) i = 0;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ItchEncodeVector);
+
+/// addMessage() of pre-encoded messages into packets handed to a no-op send
+/// callback; includes packet sealing whenever the MTU fills.
+static void BM_MoldFramerAddMessage(benchmark::State& state) {
+    const std::vector<EventRecord>& events = recordedEvents();
+    ItchEncoder encoder("AAPL", 1, 100);
+    std::vector<std::vector<uint8_t>> messages;
+    for (size_t i = 0; i < 4096; ++i) messages.push_back(encoder.encode(events[i]));
+
+    MoldUDP64Framer framer("BENCH00001");
+    uint64_t packets = 0;
+    framer.setSendCallback([&packets](const uint8_t*, size_t) { ++packets; });
+    size_t i = 0;
+    for (auto _ : state) {
+        const std::vector<uint8_t>& m = messages[i];
+        framer.addMessage(m.data(), static_cast<uint16_t>(m.size()));
+        if (++i == messages.size()) i = 0;
+    }
+    framer.sendPending();
+    state.SetItemsProcessed(state.iterations());
+    state.counters["packets"] = static_cast<double>(packets);
+}
+BENCHMARK(BM_MoldFramerAddMessage);
+
+/// The zero-copy path the live sinks use: encode straight into the packet with
+/// reserveMessage()/commitMessage().
+static void BM_MoldFramerEncodeInPlace(benchmark::State& state) {
+    const std::vector<EventRecord>& events = recordedEvents();
+    ItchEncoder encoder("AAPL", 1, 100);
+    MoldUDP64Framer framer("BENCH00001");
+    framer.setSendCallback([](const uint8_t* data, size_t) { benchmark::DoNotOptimize(data); });
+    size_t i = 0;
+    for (auto _ : state) {
+        uint8_t* slot = framer.reserveMessage(ItchEncoder::kMaxMessageSize);
+        framer.commitMessage(static_cast<uint16_t>(
+            encoder.encodeInto(events[i], slot, ItchEncoder::kMaxMessageSize)));
+        if (++i == events.size()) i = 0;
+    }
+    framer.sendPending();
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_MoldFramerEncodeInPlace);
+
+}  // namespace bench
+}  // namespace qrsdp
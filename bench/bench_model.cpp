@@ -0,0 +1,235 @@
+#include <benchmark/benchmark.h>
+#include "bench_support.h"
+
+#include "book/multi_level_book.h"
+#include "io/in_memory_sink.h"
+#include "model/curve_intensity_model.h"
+#include "model/hawkes_intensity_model.h"
+#include "model/hlr_params.h"
+#include "model/simple_imbalance_intensity.h"
+#include "model/spread_feedback.h"
+#include "producer/basic_qrsdp_producer.h"
+#include "rng/mt19937_rng.h"
+#include "sampler/competing_intensity_sampler.h"
+#include "sampler/unit_size_attribute_sampler.h"
+
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace qrsdp {
+namespace bench {
+
+/// BookState of a freshly seeded K-level book, as the producer builds it.
+static BookState seededState(uint32_t levels) {
+    MultiLevelBook book;
+    book.seed(benchBookSeed(levels));
+    BookState state;
+    state.features = book.features();
+    for (size_t k = 0; k < book.numLevels(); ++k) {
+        state.bid_depths.push_back(book.bidDepthAtLevel(k));
+        state.ask_depths.push_back(book.askDepthAtLevel(k));
+    }
+    return state;
+}
+
+static void BM_SimpleIntensityCompute(benchmark::State& state) {
+    const BookState book_state = seededState(5);
+    SimpleImbalanceIntensity model(benchSession(1).intensity_params);
+    for (auto _ : state)
+        benchmark::DoNotOptimize(model.compute(book_state));
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_SimpleIntensityCompute);
+
+/// Spread feedback multipliers for a spread that changes every call, from the
+/// table built at construction vs the two exponentials per event it replaced.
+static void BM_SpreadFeedbackTable(benchmark::State& state) {
+    const SpreadFeedback feedback(benchSession(1).intensity_params.spread_sensitivity);
+    int spread = 1;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(feedback.at(spread));
+        spread = spread == 8 ? 1 : spread + 1;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_SpreadFeedbackTable);
+
+static void BM_SpreadFeedbackExp(benchmark::State& state) {
+    const double sS = benchSession(1).intensity_params.spread_sensitivity;
+    int spread = 1;
+    for (auto _ : state) {
+        const double spread_delta = static_cast<double>(spread) - 2.0;
+        benchmark::DoNotOptimize(SpreadFeedback::Multipliers{std::exp(sS * spread_delta),
+                                                             std::exp(-sS * spread_delta)});
+        spread = spread == 8 ? 1 : spread + 1;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_SpreadFeedbackExp);
+
+/// M books' features, as a worker holding M securities would gather them.
+struct BookBatchInputs {
+    std::vector<double> imbalance;
+    std::vector<int> spread;
+    std::vector<uint32_t> q_bid, q_ask;
+    std::vector<uint64_t> bid_total, ask_total;
+    std::vector<BookState> states;
+
+    explicit BookBatchInputs(size_t m)
+        : imbalance(m), spread(m), q_bid(m), q_ask(m), bid_total(m), ask_total(m), states(m) {
+        for (size_t i = 0; i < m; ++i) {
+            imbalance[i] = static_cast<double>(static_cast<int>(i % 21) - 10) / 10.0;
+            spread[i] = 1 + static_cast<int>(i % 4);
+            q_bid[i] = 3 + static_cast<uint32_t>(i % 7);
+            q_ask[i] = 3 + static_cast<uint32_t>(i % 5);
+            states[i] = seededState(5);
+            states[i].features.imbalance = imbalance[i];
+            states[i].features.spread_ticks = spread[i];
+            states[i].features.q_bid_best = q_bid[i];
+            states[i].features.q_ask_best = q_ask[i];
+            for (uint32_t d : states[i].bid_depths) bid_total[i] += d;
+            for (uint32_t d : states[i].ask_depths) ask_total[i] += d;
+        }
+    }
+};
+
+/// One compute() per book. Arg: books.
+static void BM_SimpleIntensityComputeBooks(benchmark::State& state) {
+    const size_t m = static_cast<size_t>(state.range(0));
+    const BookBatchInputs in(m);
+    SimpleImbalanceIntensity model(benchSession(1).intensity_params);
+    for (auto _ : state) {
+        for (size_t i = 0; i < m; ++i) benchmark::DoNotOptimize(model.compute(in.states[i]));
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(m));
+}
+BENCHMARK(BM_SimpleIntensityComputeBooks)->Arg(64)->Arg(1000);
+
+/// The same books through computeBatch(). Arg: books.
+static void BM_SimpleIntensityComputeBatch(benchmark::State& state) {
+    const size_t m = static_cast<size_t>(state.range(0));
+    const BookBatchInputs in(m);
+    SimpleImbalanceIntensity model(benchSession(1).intensity_params);
+    BookFeatureBatch books;
+    books.count = m;
+    books.imbalance = in.imbalance.data();
+    books.spread_ticks = in.spread.data();
+    books.q_bid_best = in.q_bid.data();
+    books.q_ask_best = in.q_ask.data();
+    books.total_bid_depth = in.bid_total.data();
+    books.total_ask_depth = in.ask_total.data();
+    std::vector<double> rates(6 * m);
+    IntensityBatch out{&rates[0], &rates[m], &rates[2 * m], &rates[3 * m], &rates[4 * m], &rates[5 * m]};
+    for (auto _ : state) {
+        model.computeBatch(books, out);
+        benchmark::DoNotOptimize(rates.data());
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(m));
+}
+BENCHMARK(BM_SimpleIntensityComputeBatch)->Arg(64)->Arg(1000);
+
+/// Full per-level evaluation of the HLR curves. Arg: K.
+static void BM_CurveIntensityCompute(benchmark::State& state) {
+    const int levels = static_cast<int>(state.range(0));
+    const BookState book_state = seededState(static_cast<uint32_t>(levels));
+    CurveIntensityModel model(makeDefaultHLRParams(levels));
+    for (auto _ : state)
+        benchmark::DoNotOptimize(model.compute(book_state));
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_CurveIntensityCompute)->Arg(5)->Arg(10)->Arg(20)->Arg(50);
+
+/// Incremental update after a one-level change (the common case), alternating
+/// the touched level's depth so each call does real work. Arg: K.
+static void BM_CurveIntensityUpdate(benchmark::State& state) {
+    const int levels = static_cast<int>(state.range(0));
+    BookState book_state = seededState(static_cast<uint32_t>(levels));
+    CurveIntensityModel model(makeDefaultHLRParams(levels));
+    model.compute(book_state);
+    const uint32_t level = static_cast<uint32_t>(levels / 2);
+    const BookDelta delta{false, Side::BID, level};
+    uint32_t& depth = book_state.bid_depths[level];
+    const uint32_t base = depth;
+    for (auto _ : state) {
+        depth = depth == base ? base + 1 : base;
+        benchmark::DoNotOptimize(model.update(book_state, delta));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_CurveIntensityUpdate)->Arg(5)->Arg(10)->Arg(20)->Arg(50);
+
+/// Hawkes bookkeeping of one event on the default two kernels: decay to the
+/// event time, intensities for the (unchanged) book, the event's jumps. The
+/// types and gaps are those of a recorded session.
+static void BM_HawkesIntensityEvent(benchmark::State& state) {
+    const BookState book_state = seededState(5);
+    HawkesIntensityModel model(
+        makeDefaultHawkesParams(),
+        std::make_shared<const SimpleImbalanceIntensity>(benchSession(1).intensity_params));
+    model.compute(book_state);
+    const std::vector<EventRecord>& events = recordedEvents();
+    const BookDelta unchanged{false, Side::NA, 0};
+    size_t i = 0;
+    double t = 0.0;
+    for (auto _ : state) {
+        t += 1e-3;
+        model.advanceTo(t);
+        benchmark::DoNotOptimize(model.update(book_state, unchanged));
+        model.onEvent(static_cast<EventType>(events[i].type));
+        if (++i == events.size()) {
+            i = 0;
+            t = 0.0;
+            model.resetHistory(0.0);
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_HawkesIntensityEvent);
+
+/// Whole-producer throughput (events/s) of the concrete session loop on a
+/// simple model and on the Hawkes model over the same baseline, which adds the
+/// thinning draws and the history updates.
+template <class Model>
+static void runProducerEvents(benchmark::State& state, Model& model, const TradingSession& session) {
+    Mt19937Rng rng(session.seed);
+    MultiLevelBook book;
+    CompetingIntensitySampler sampler(rng);
+    UnitSizeAttributeSampler attrs(rng, 0.5, 0.5);
+    BasicQrsdpProducer<Mt19937Rng, MultiLevelBook, Model, CompetingIntensitySampler,
+                       UnitSizeAttributeSampler, InMemorySink>
+        producer(rng, book, model, sampler, attrs);
+    producer.startSession(session);
+    EventRecord batch[256];
+    uint64_t events = 0;
+    for (auto _ : state) {
+        size_t n = producer.stepEvents(256, batch);
+        if (n == 0) {
+            producer.startSession(session);
+            n = producer.stepEvents(256, batch);
+        }
+        benchmark::DoNotOptimize(batch[n - 1]);
+        events += n;
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(events));
+}
+
+static void BM_ProducerEventsSimple(benchmark::State& state) {
+    const TradingSession session = benchSession(7);
+    SimpleImbalanceIntensity model(session.intensity_params);
+    runProducerEvents(state, model, session);
+}
+BENCHMARK(BM_ProducerEventsSimple);
+
+static void BM_ProducerEventsHawkes(benchmark::State& state) {
+    const TradingSession session = benchSession(7);
+    HawkesIntensityModel model(
+        makeDefaultHawkesParams(),
+        std::make_shared<const SimpleImbalanceIntensity>(session.intensity_params));
+    runProducerEvents(state, model, session);
+}
+BENCHMARK(BM_ProducerEventsHawkes);
+
+}  // namespace bench
+}  // namespace qrsdp
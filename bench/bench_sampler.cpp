@@ -0,0 +1,121 @@
+#include <benchmark/benchmark.h>
+#include "bench_support.h"
+
+#include "book/multi_level_book.h"
+#include "rng/mt19937_rng.h"
+#include "rng/philox_rng.h"
+#include "rng/xoshiro256pp_rng.h"
+#include "sampler/competing_intensity_sampler.h"
+#include "sampler/unit_size_attribute_sampler.h"
+
+#include <vector>
+
+namespace qrsdp {
+namespace bench {
+
+// --- RNG ---
+
+template <class Rng>
+static void BM_RngUniform(benchmark::State& state) {
+    Rng rng(42);
+    for (auto _ : state)
+        benchmark::DoNotOptimize(rng.uniform());
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK_TEMPLATE(BM_RngUniform, Mt19937Rng);
+BENCHMARK_TEMPLATE(BM_RngUniform, Xoshiro256ppRng);
+BENCHMARK_TEMPLATE(BM_RngUniform, PhiloxRng);
+
+template <class Rng>
+static void BM_RngExponential(benchmark::State& state) {
+    Rng rng(42);
+    for (auto _ : state)
+        benchmark::DoNotOptimize(rng.exponential());
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK_TEMPLATE(BM_RngExponential, Mt19937Rng);
+BENCHMARK_TEMPLATE(BM_RngExponential, Xoshiro256ppRng);
+BENCHMARK_TEMPLATE(BM_RngExponential, PhiloxRng);
+
+// --- Event sampler ---
+
+static Intensities benchIntensities() {
+    return Intensities{22.0, 22.0, 10.0, 10.0, 15.0, 15.0};
+}
+
+static void BM_SampleDeltaT(benchmark::State& state) {
+    Xoshiro256ppRng rng(42);
+    CompetingIntensitySampler sampler(rng);
+    const double total = benchIntensities().total();
+    for (auto _ : state)
+        benchmark::DoNotOptimize(sampler.sampleDeltaT(total));
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_SampleDeltaT);
+
+static void BM_SampleType(benchmark::State& state) {
+    Xoshiro256ppRng rng(42);
+    CompetingIntensitySampler sampler(rng);
+    const Intensities intens = benchIntensities();
+    for (auto _ : state)
+        benchmark::DoNotOptimize(sampler.sampleType(intens));
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_SampleType);
+
+/// Per-level weights of a K-level HLR model (4K + 2 entries).
+static std::vector<double> levelWeights(size_t levels) {
+    std::vector<double> w(4 * levels + 2);
+    for (size_t i = 0; i < w.size(); ++i) w[i] = 1.0 + static_cast<double>(i % 7);
+    return w;
+}
+
+/// Linear scan over the per-level weights. Arg: K.
+static void BM_SampleIndexLinear(benchmark::State& state) {
+    Xoshiro256ppRng rng(42);
+    CompetingIntensitySampler sampler(rng, SelectionMode::LINEAR);
+    const std::vector<double> weights = levelWeights(static_cast<size_t>(state.range(0)));
+    for (auto _ : state)
+        benchmark::DoNotOptimize(sampler.sampleIndexFromWeights(weights));
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_SampleIndexLinear)->Arg(5)->Arg(10)->Arg(20)->Arg(50);
+
+/// Fenwick selection as the producer drives it: one weight update, one draw. Arg: K.
+static void BM_SampleIndexFenwick(benchmark::State& state) {
+    Xoshiro256ppRng rng(42);
+    CompetingIntensitySampler sampler(rng, SelectionMode::FENWICK);
+    const std::vector<double> weights = levelWeights(static_cast<size_t>(state.range(0)));
+    sampler.loadWeights(weights);
+    size_t i = 0;
+    for (auto _ : state) {
+        sampler.updateWeight(i, weights[i] + 0.5);
+        benchmark::DoNotOptimize(sampler.sampleLoadedIndex());
+        if (++i == weights.size()) i = 0;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_SampleIndexFenwick)->Arg(5)->Arg(10)->Arg(20)->Arg(50);
+
+// --- Attribute sampler ---
+
+static void BM_AttributeSample(benchmark::State& state) {
+    Xoshiro256ppRng rng(42);
+    UnitSizeAttributeSampler attrs(rng, 0.5, 0.5);
+    MultiLevelBook book;
+    book.seed(benchBookSeed());
+    const BookFeatures features = book.features();
+    static constexpr EventType kTypes[] = {EventType::ADD_BID, EventType::ADD_ASK,
+                                           EventType::CANCEL_BID, EventType::CANCEL_ASK,
+                                           EventType::EXECUTE_BUY, EventType::EXECUTE_SELL};
+    size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(attrs.sample(kTypes[i], book, features));
+        if (++i == 6) i = 0;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_AttributeSample);
+
+}  // namespace bench
+}  // namespace qrsdp
@@ -0,0 +1,70 @@
+#include "bench_support.h"
+
+#include "book/multi_level_book.h"
+#include "io/in_memory_sink.h"
+#include "model/simple_imbalance_intensity.h"
+#include "producer/qrsdp_producer.h"
+#include "rng/mt19937_rng.h"
+#include "sampler/competing_intensity_sampler.h"
+#include "sampler/unit_size_attribute_sampler.h"
+
+#include <filesystem>
+
+namespace qrsdp {
+namespace bench {
+
+static constexpr size_t kRecordedEvents = 1u << 16;
+
+TradingSession benchSession(uint64_t seed, uint32_t levels, uint32_t depth,
+                            uint32_t session_seconds) {
+    TradingSession s{};
+    s.seed = seed;
+    s.p0_ticks = 10000;
+    s.session_seconds = session_seconds;
+    s.levels_per_side = levels;
+    s.tick_size = 100;
+    s.initial_spread_ticks = 2;
+    s.initial_depth = depth;
+    s.market_open_seconds = kDefaultMarketOpenSeconds;
+    s.intensity_params.base_L = 22.0;
+    s.intensity_params.base_C = 0.2;
+    s.intensity_params.base_M = 30.0;
+    s.intensity_params.imbalance_sensitivity = 1.0;
+    s.intensity_params.cancel_sensitivity = 1.0;
+    s.intensity_params.epsilon_exec = 0.5;
+    s.intensity_params.spread_sensitivity = 0.4;
+    return s;
+}
+
+BookSeed benchBookSeed(uint32_t levels, uint32_t depth) {
+    BookSeed seed;
+    seed.p0_ticks = 10000;
+    seed.levels_per_side = levels;
+    seed.initial_depth = depth;
+    seed.initial_spread_ticks = 2;
+    return seed;
+}
+
+const std::vector<EventRecord>& recordedEvents() {
+    static const std::vector<EventRecord> events = [] {
+        const TradingSession session = benchSession(42);
+        Mt19937Rng rng(0);
+        MultiLevelBook book;
+        SimpleImbalanceIntensity model(session.intensity_params);
+        CompetingIntensitySampler sampler(rng);
+        UnitSizeAttributeSampler attrs(rng, 0.5, 0.5);
+        QrsdpProducer producer(rng, book, model, sampler, attrs);
+        InMemorySink sink;
+        producer.startSession(session);
+        while (sink.size() < kRecordedEvents && producer.stepOneEvent(sink)) {}
+        return sink.events().toVector();
+    }();
+    return events;
+}
+
+std::string scratchPath(const std::string& name) {
+    return (std::filesystem::temp_directory_path() / name).string();
+}
+
+}  // namespace bench
+}  // namespace qrsdp
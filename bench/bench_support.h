@@ -0,0 +1,35 @@
+#pragma once
+
+#include "core/records.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace qrsdp {
+namespace bench {
+
+/// Simple-model session with every level seeded at `depth`; the defaults match
+/// qrsdp_run's (K = 5, 50 per level, spread 2).
+TradingSession benchSession(uint64_t seed, uint32_t levels = 5, uint32_t depth = 50,
+                            uint32_t session_seconds = 23400);
+
+/// BookSeed the producer derives from benchSession(seed, levels, depth).
+BookSeed benchBookSeed(uint32_t levels = 5, uint32_t depth = 50);
+
+/// 65536 events of one generated session (seed 42, K = 5), computed once. A
+/// MultiLevelBook seeded with benchBookSeed() reproduces the producer's book
+/// when they are applied in order.
+const std::vector<EventRecord>& recordedEvents();
+
+/// The book event an EventRecord was generated from.
+inline SimEvent toSimEvent(const EventRecord& rec) {
+    return SimEvent{static_cast<EventType>(rec.type), static_cast<Side>(rec.side),
+                    rec.price_ticks, rec.qty, rec.order_id};
+}
+
+/// Path in the system temp directory for a benchmark's scratch file.
+std::string scratchPath(const std::string& name);
+
+}  // namespace bench
+}  // namespace qrsdp
@@ -1,5 +1,6 @@
 import { useState, useCallback, useRef } from "react";
-import type { Simulation, TickUpdate, NightUpdate, PricePoint, OrderEvent, StreamMessage } from "./types";
+import type { Simulation, TickUpdate, NightUpdate, PricePoint, OrderEvent, StreamMessage, DayContext } from "./types";
+import { decodeBookFrame } from "./bookFrame";
 import CreateSimulation from "./components/CreateSimulation";
 import SimulationList from "./components/SimulationList";
 import SimulationView from "./components/SimulationView";
@@ -30,24 +31,6 @@ export default function App() {
     }
   }, []);
 
-  const handleCreate = useCallback(
-    async (body: Record<string, unknown>) => {
-      const res = await fetch(`${API}/simulations`, {
-        method: "POST",
-        headers: { "Content-Type": "application/json" },
-        body: JSON.stringify(body),
-      });
-      if (!res.ok) {
-        const err = await res.json().catch(() => ({ detail: `Server error (${res.status})` }));
-        throw new Error(err.detail || `Request failed (${res.status})`);
-      }
-      const sim: Simulation = await res.json();
-      setSims((prev) => [...prev, sim]);
-      return sim;
-    },
-    []
-  );
-
   const sendControl = useCallback((msg: Record<string, unknown>) => {
     const ws = wsRef.current;
     if (ws && ws.readyState === WebSocket.OPEN) {
@@ -85,7 +68,31 @@ export default function App() {
         `${proto}//${window.location.host}${API}/simulations/${sim.id}/stream?speed=${DEFAULT_REPLAY_SPEED}`
       );
 
+      // Binary book frames carry the book only; the day and speed come from JSON messages.
+      socket.binaryType = "arraybuffer";
+      let day: DayContext | null = null;
+      let speed = DEFAULT_REPLAY_SPEED;
+
+      const applyTick = (tick: TickUpdate) => {
+        setLastTick(tick);
+        setNight(null);
+        setReplaySpeed(tick.speed);
+        const absT = tick.dayOffset + tick.ts;
+        setPriceHistory((prev) => [
+          ...prev,
+          { absT, t: tick.ts, mid: tick.mid, bid: tick.bestBid, ask: tick.bestAsk, day: tick.day },
+        ]);
+        if (tick.events?.length) {
+          setEventFeed((prev) => [...prev.slice(-92), ...tick.events]);
+        }
+      };
+
       socket.onmessage = (e) => {
+        if (e.data instanceof ArrayBuffer) {
+          const tick = day && decodeBookFrame(e.data, day, speed);
+          if (tick) applyTick(tick);
+          return;
+        }
         let msg: StreamMessage;
         try {
           msg = JSON.parse(e.data);
@@ -94,26 +101,21 @@ export default function App() {
         }
 
         if (msg.type === "tick") {
-          setLastTick(msg);
-          setNight(null);
-          setReplaySpeed(msg.speed);
-          const absT = msg.dayOffset + msg.ts;
-          setPriceHistory((prev) => [
-            ...prev,
-            { absT, t: msg.ts, mid: msg.mid, bid: msg.bestBid, ask: msg.bestAsk, day: msg.day },
-          ]);
-          if (msg.events?.length) {
-            setEventFeed((prev) => [...prev.slice(-92), ...msg.events]);
-          }
+          applyTick(msg);
+        } else if (msg.type === "day") {
+          day = msg;
         } else if (msg.type === "night") {
           setNight(msg);
         } else if (msg.type === "complete") {
           setDone(true);
           setStreaming(false);
+          refreshSims();  // a live run is now ready to replay
         } else if (msg.type === "playback_init") {
+          speed = msg.speed;
           setReplaySpeed(msg.speed);
           setPaused(msg.paused);
         } else if (msg.type === "speed_changed") {
+          speed = msg.speed;
           setReplaySpeed(msg.speed);
         } else if (msg.type === "paused") {
           setPaused(true);
@@ -129,7 +131,26 @@ export default function App() {
       };
       wsRef.current = socket;
     },
-    []
+    [refreshSims]
+  );
+
+  const handleCreate = useCallback(
+    async (body: Record<string, unknown>) => {
+      const res = await fetch(`${API}/simulations`, {
+        method: "POST",
+        headers: { "Content-Type": "application/json" },
+        body: JSON.stringify(body),
+      });
+      if (!res.ok) {
+        const err = await res.json().catch(() => ({ detail: `Server error (${res.status})` }));
+        throw new Error(err.detail || `Request failed (${res.status})`);
+      }
+      const sim: Simulation = await res.json();
+      setSims((prev) => [...prev, sim]);
+      if (sim.status === "running") handleReplay(sim);
+      return sim;
+    },
+    [handleReplay]
   );
 
   const handleDelete = useCallback(
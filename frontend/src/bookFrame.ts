@@ -0,0 +1,68 @@
+import type { DayContext, Level, OrderEvent, TickUpdate } from "./types";
+
+// Binary book frame (src/io/book_frame.h), little-endian:
+//   header (40 B): magic u32, levels u16, event_count u16, ts_ns u64,
+//     record_index u64, best_bid i32, best_ask i32, frame_records u32, reserved u32
+//   levels x {price i32, depth u32} bids, then asks (best first)
+//   event_count x {type u8, side u8, price i32, qty u32} (oldest first)
+const FRAME_MAGIC = 0x31464251; // "QBF1"
+const HEADER_BYTES = 40;
+const LEVEL_BYTES = 8;
+const EVENT_BYTES = 10;
+
+const EVENT_NAMES = ["ADD BID", "ADD ASK", "CANCEL BID", "CANCEL ASK", "EXEC BUY", "EXEC SELL"];
+
+const round4 = (x: number) => Math.round(x * 1e4) / 1e4;
+
+/** Turns one frame into the TickUpdate the JSON stream would have sent; null if malformed. */
+export function decodeBookFrame(buf: ArrayBuffer, ctx: DayContext, speed: number): TickUpdate | null {
+  const v = new DataView(buf);
+  if (buf.byteLength < HEADER_BYTES || v.getUint32(0, true) !== FRAME_MAGIC) return null;
+  const levels = v.getUint16(4, true);
+  const eventCount = v.getUint16(6, true);
+  if (buf.byteLength < HEADER_BYTES + 2 * levels * LEVEL_BYTES + eventCount * EVENT_BYTES) return null;
+
+  const tick = ctx.tickSize;
+  const tsNs = Number(v.getBigUint64(8, true));
+  const recordIndex = Number(v.getBigUint64(16, true));
+  const bestBid = v.getInt32(24, true);
+  const bestAsk = v.getInt32(28, true);
+
+  let pos = HEADER_BYTES;
+  const readLevels = (): Level[] => {
+    const out: Level[] = [];
+    for (let k = 0; k < levels; k++, pos += LEVEL_BYTES) {
+      out.push({ price: round4(v.getInt32(pos, true) / tick), depth: v.getUint32(pos + 4, true) });
+    }
+    return out;
+  };
+  const bids = readLevels();
+  const asks = readLevels();
+  const events: OrderEvent[] = [];
+  for (let i = 0; i < eventCount; i++, pos += EVENT_BYTES) {
+    events.push({
+      type: EVENT_NAMES[v.getUint8(pos)] ?? "?",
+      price: round4(v.getInt32(pos + 2, true) / tick),
+      qty: v.getUint32(pos + 6, true),
+    });
+  }
+
+  return {
+    type: "tick",
+    idx: ctx.eventsBefore + recordIndex - 1,
+    total: ctx.total,
+    day: ctx.day,
+    totalDays: ctx.totalDays,
+    date: ctx.date,
+    ts: Math.round(tsNs / 1e6) / 1e3,
+    dayOffset: ctx.dayOffset,
+    mid: round4((bestBid + bestAsk) / 2 / tick),
+    bestBid: round4(bestBid / tick),
+    bestAsk: round4(bestAsk / tick),
+    spread: round4((bestAsk - bestBid) / tick),
+    bids,
+    asks,
+    events,
+    speed,
+  };
+}
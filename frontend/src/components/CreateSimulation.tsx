@@ -13,6 +13,7 @@ export default function CreateSimulation({ onCreate }: Props) {
   const [seed, setSeed] = useState(42);
   const [p0, setP0] = useState(150);
   const [preset, setPreset] = useState("simple_high_exec");
+  const [live, setLive] = useState(false);
   const [loading, setLoading] = useState(false);
   const [error, setError] = useState("");
 
@@ -38,6 +39,7 @@ export default function CreateSimulation({ onCreate }: Props) {
         seed,
         p0,
         preset,
+        live,
       });
       setSeed((s) => s + 1);
     } catch (err: any) {
@@ -121,9 +123,13 @@ export default function CreateSimulation({ onCreate }: Props) {
           min={1}
         />
       </label>
+      <label className="checkbox-label">
+        <input type="checkbox" checked={live} onChange={(e) => setLive(e.target.checked)} />
+        Stream while generating
+      </label>
       {error && <div className="form-error">{error}</div>}
       <button type="submit" disabled={loading || !symbol.trim()}>
-        {loading ? "Generating..." : "Create Simulation"}
+        {loading ? "Generating..." : live ? "Start Live Simulation" : "Create Simulation"}
       </button>
     </form>
   );
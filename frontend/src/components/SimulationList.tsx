@@ -32,10 +32,13 @@ export default function SimulationList({ sims, activeSim, onReplay, onDelete, on
             {fmtEvents(s.total_events)} events · {s.days}d · ${s.p0} · seed {s.seed}
           </div>
           <div className="sim-card-actions">
-            <button className="btn-stream" onClick={() => onReplay(s)} disabled={s.status !== "ready"}>
-              Replay
+            <button className="btn-stream" onClick={() => onReplay(s)}
+                    disabled={s.status !== "ready" && s.status !== "running"}>
+              {s.status === "running" ? "Watch Live" : "Replay"}
+            </button>
+            <button className="btn-delete" onClick={() => onDelete(s.id)} disabled={s.status === "running"}>
+              Delete
             </button>
-            <button className="btn-delete" onClick={() => onDelete(s.id)}>Delete</button>
           </div>
         </div>
       ))}
@@ -24,7 +24,10 @@ export default function SimulationView({
   sim, tick, night, done, streaming, paused, replaySpeed,
   priceHistory, eventFeed, onSetSpeed, onPause, onResume, onStop,
 }: Props) {
-  const pct = tick ? Math.round((tick.idx / tick.total) * 100) : done ? 100 : 0;
+  // A live run's total is unknown until it ends: count finished days instead.
+  const pct = done ? 100 : !tick ? 0
+    : tick.total > 0 ? Math.round((tick.idx / tick.total) * 100)
+    : Math.round(((tick.day - 1) / Math.max(tick.totalDays, 1)) * 100);
   const dayLabel = tick ? `Day ${tick.day}/${tick.totalDays} · ${tick.date}` : "";
 
   return (
@@ -48,7 +51,8 @@ export default function SimulationView({
         )}
         <div className="sim-view-controls">
           <div className="progress-info">
-            {done ? "Complete" : paused ? "Paused" : `${pct}%`} · {(tick?.idx ?? 0).toLocaleString()} / {(tick?.total ?? sim.total_events).toLocaleString()}
+            {done ? "Complete" : paused ? "Paused" : `${pct}%`} · {(tick?.idx ?? 0).toLocaleString()}
+            {tick?.total !== 0 && <> / {(tick?.total ?? sim.total_events).toLocaleString()}</>}
           </div>
           <div className="progress-bar"><div className="progress-fill" style={{ width: `${pct}%` }} /></div>
         </div>
@@ -74,7 +78,7 @@ export default function SimulationView({
             <div className="night-detail">
               Day {night.day} ended · Close ${night.close.toFixed(2)}
             </div>
-            <div className="night-next">Opening {night.nextDate}...</div>
+            <div className="night-next">Opening {night.nextDate || "next session"}...</div>
             <div className="night-spinner" />
           </div>
         </div>
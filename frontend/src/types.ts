@@ -49,6 +49,18 @@ export interface TickUpdate {
   speed: number;
 }
 
+/** Sent before each day's binary book frames: what the frames do not carry. */
+export interface DayContext {
+  type: "day";
+  total: number;
+  day: number;
+  totalDays: number;
+  date: string;
+  dayOffset: number;
+  eventsBefore: number;
+  tickSize: number;
+}
+
 export interface NightUpdate {
   type: "night";
   day: number;
@@ -85,6 +97,7 @@ export interface ResumedMsg {
 
 export type StreamMessage =
   | TickUpdate
+  | DayContext
   | NightUpdate
   | CompleteUpdate
   | PlaybackInit
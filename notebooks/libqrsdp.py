@@ -0,0 +1,730 @@
+"""
+In-process access to the simulator through libqrsdp (src/capi/qrsdp.h) via ctypes.
+
+- run(): multi-day runs through SessionRunner, writing the same day files and
+  manifest as qrsdp_run, returning per-day event counts without re-reading them.
+- Session: one trading session generated in memory, pulled as numpy arrays
+  with RECORD_DTYPE (optionally with the book top after every event).
+- EventLog: .qrsdp files read by the C++ EventLogReader. Records come back as
+  numpy arrays over the library's own buffers (no copy), bars as views into
+  the open log; any format the C++ reader handles works here unchanged.
+- FrameStream: a .qrsdp file replayed in C++ into downsampled binary book
+  frames (src/io/book_frame.h) for live displays; decode_frame() unpacks one.
+- Feed: the same frames from a run(live_frames=...) still generating, read
+  from its shared-memory ring (src/io/frame_ring.h) by any process.
+- EventBus: every record of a `qrsdp_run --shm-ring` run as it is generated,
+  in sequence-numbered batches (src/io/shm_ring_sink.h).
+
+The library is found via $QRSDP_LIB or the usual build directories; load()
+returns None when it has not been built (callers fall back to qrsdp_run).
+"""
+
+import ctypes
+import os
+import struct
+import sys
+from pathlib import Path
+from typing import Dict, Optional, Sequence
+
+import numpy as np
+
+from qrsdp_reader import BAR_DTYPE, RECORD_DTYPE
+
+ABI_VERSION = 1  # QRSDP_ABI_VERSION
+MODELS = {"simple": 0, "hlr": 1, "hawkes": 2}
+
+# Best bid/ask after an event (qrsdp_top).
+TOP_DTYPE = np.dtype([
+    ("bid_ticks", "<i4"),
+    ("bid_depth", "<u4"),
+    ("ask_ticks", "<i4"),
+    ("ask_depth", "<u4"),
+])
+
+# BookFrameHeader: magic, levels, event_count, ts_ns, record_index, best_bid,
+# best_ask, frame_records, reserved; then levels x (price, depth) bids and asks,
+# then event_count x (type, side, price, qty).
+FRAME_MAGIC = 0x31464251  # "QBF1"
+_FRAME_HEADER = struct.Struct("<IHHQQiiII")
+_FRAME_LEVEL = struct.Struct("<iI")
+_FRAME_EVENT = struct.Struct("<BBiI")
+
+# Live feed message kinds (FrameRingKind) and their non-frame payloads.
+FEED_BOOK_FRAME, FEED_DAY_START, FEED_DAY_END = 1, 2, 3
+_FEED_EMPTY, _FEED_MESSAGE, _FEED_CLOSED = 0, 1, 2
+_DAY_START = struct.Struct("<IIQiI12s12s")
+_DAY_END = struct.Struct("<IiQ")
+
+
+class _BusBatch(ctypes.Structure):
+    _pack_ = 1
+    _fields_ = [
+        ("first_seq", ctypes.c_uint64),
+        ("count", ctypes.c_uint32),
+        ("security", ctypes.c_uint16),
+        ("reserved", ctypes.c_uint16),
+        ("symbol", ctypes.c_char * 16),
+        ("date", ctypes.c_char * 16),
+    ]
+
+_REPO_ROOT = Path(__file__).resolve().parent.parent
+if sys.platform.startswith("win"):
+    _LIB_NAME = "qrsdp.dll"
+elif sys.platform == "darwin":
+    _LIB_NAME = "libqrsdp.dylib"
+else:
+    _LIB_NAME = "libqrsdp.so"
+_LIB_CANDIDATES = [
+    _REPO_ROOT / "build" / _LIB_NAME,
+    _REPO_ROOT / "build" / "Release" / _LIB_NAME,
+    _REPO_ROOT / "build" / "Debug" / _LIB_NAME,
+]
+
+
+class _SessionConfig(ctypes.Structure):
+    _fields_ = [
+        ("struct_size", ctypes.c_uint32),
+        ("model", ctypes.c_uint32),
+        ("seed", ctypes.c_uint64),
+        ("p0_ticks", ctypes.c_int32),
+        ("tick_size", ctypes.c_uint32),
+        ("session_seconds", ctypes.c_uint32),
+        ("levels_per_side", ctypes.c_uint32),
+        ("initial_spread_ticks", ctypes.c_uint32),
+        ("initial_depth", ctypes.c_uint32),
+        ("market_open_seconds", ctypes.c_uint32),
+        ("base_L", ctypes.c_double),
+        ("base_C", ctypes.c_double),
+        ("base_M", ctypes.c_double),
+        ("imbalance_sensitivity", ctypes.c_double),
+        ("cancel_sensitivity", ctypes.c_double),
+        ("epsilon_exec", ctypes.c_double),
+        ("spread_sensitivity", ctypes.c_double),
+    ]
+
+
+class _SessionStats(ctypes.Structure):
+    _fields_ = [
+        ("events", ctypes.c_uint64),
+        ("shifts", ctypes.c_uint64),
+        ("sim_seconds", ctypes.c_double),
+        ("finished", ctypes.c_int32),
+        ("reserved", ctypes.c_int32),
+    ]
+
+
+class _RunConfig(ctypes.Structure):
+    _fields_ = [
+        ("struct_size", ctypes.c_uint32),
+        ("num_days", ctypes.c_uint32),
+        ("output_dir", ctypes.c_char_p),
+        ("run_id", ctypes.c_char_p),
+        ("start_date", ctypes.c_char_p),
+        ("symbol", ctypes.c_char_p),
+        ("base_seed", ctypes.c_uint64),
+        ("threads", ctypes.c_uint32),
+        ("columnar", ctypes.c_uint32),
+        ("bar_seconds", ctypes.POINTER(ctypes.c_uint32)),
+        ("bar_seconds_count", ctypes.c_uint32),
+        ("reserved", ctypes.c_uint32),
+        ("session", _SessionConfig),
+        ("realtime", ctypes.c_uint32),
+        ("live_recent_events", ctypes.c_uint32),
+        ("speed", ctypes.c_double),
+        ("live_frames", ctypes.c_char_p),
+        ("live_frame_interval_ns", ctypes.c_uint64),
+        ("live_ring_bytes", ctypes.c_uint64),
+    ]
+
+
+class _DayInfo(ctypes.Structure):
+    _fields_ = [
+        ("symbol", ctypes.c_char_p),
+        ("date", ctypes.c_char_p),
+        ("filename", ctypes.c_char_p),
+        ("seed", ctypes.c_uint64),
+        ("open_ticks", ctypes.c_int32),
+        ("close_ticks", ctypes.c_int32),
+        ("events", ctypes.c_uint64),
+        ("file_size_bytes", ctypes.c_uint64),
+    ]
+
+
+class _Level(ctypes.Structure):
+    _fields_ = [("price_ticks", ctypes.c_int32), ("depth", ctypes.c_uint32)]
+
+
+class _LogInfo(ctypes.Structure):
+    _fields_ = [
+        ("version_major", ctypes.c_uint16),
+        ("version_minor", ctypes.c_uint16),
+        ("header_flags", ctypes.c_uint32),
+        ("seed", ctypes.c_uint64),
+        ("p0_ticks", ctypes.c_int32),
+        ("tick_size", ctypes.c_uint32),
+        ("session_seconds", ctypes.c_uint32),
+        ("levels_per_side", ctypes.c_uint32),
+        ("initial_spread_ticks", ctypes.c_uint32),
+        ("initial_depth", ctypes.c_uint32),
+        ("chunk_capacity", ctypes.c_uint32),
+        ("chunk_count", ctypes.c_uint32),
+        ("market_open_ns", ctypes.c_uint64),
+        ("total_records", ctypes.c_uint64),
+    ]
+
+
+class _LogStats(ctypes.Structure):
+    _fields_ = [
+        ("type_counts", ctypes.c_uint64 * 6),
+        ("min_price_ticks", ctypes.c_int32),
+        ("max_price_ticks", ctypes.c_int32),
+        ("executed_qty", ctypes.c_uint64),
+        ("shifts_up", ctypes.c_uint64),
+        ("shifts_down", ctypes.c_uint64),
+        ("reinits", ctypes.c_uint64),
+    ]
+
+
+_lib = None
+
+
+def _declare(lib: ctypes.CDLL) -> None:
+    p = ctypes.c_void_p
+    lib.qrsdp_abi_version.restype = ctypes.c_uint32
+    lib.qrsdp_last_error.restype = ctypes.c_char_p
+    lib.qrsdp_session_config_init.argtypes = [ctypes.POINTER(_SessionConfig)]
+    lib.qrsdp_session_create.argtypes = [ctypes.POINTER(_SessionConfig)]
+    lib.qrsdp_session_create.restype = p
+    lib.qrsdp_session_destroy.argtypes = [p]
+    lib.qrsdp_session_next.argtypes = [p, p, ctypes.c_size_t, p]
+    lib.qrsdp_session_next.restype = ctypes.c_int64
+    lib.qrsdp_session_book.argtypes = [p, ctypes.POINTER(_Level), ctypes.POINTER(_Level), ctypes.c_size_t]
+    lib.qrsdp_session_book.restype = ctypes.c_int64
+    lib.qrsdp_session_stats_get.argtypes = [p, ctypes.POINTER(_SessionStats)]
+    lib.qrsdp_run_config_init.argtypes = [ctypes.POINTER(_RunConfig)]
+    lib.qrsdp_run.argtypes = [ctypes.POINTER(_RunConfig)]
+    lib.qrsdp_run.restype = p
+    lib.qrsdp_run_result_free.argtypes = [p]
+    lib.qrsdp_run_result_total_events.argtypes = [p]
+    lib.qrsdp_run_result_total_events.restype = ctypes.c_uint64
+    lib.qrsdp_run_result_elapsed_seconds.argtypes = [p]
+    lib.qrsdp_run_result_elapsed_seconds.restype = ctypes.c_double
+    lib.qrsdp_run_result_day_count.argtypes = [p]
+    lib.qrsdp_run_result_day_count.restype = ctypes.c_size_t
+    lib.qrsdp_run_result_day.argtypes = [p, ctypes.c_size_t, ctypes.POINTER(_DayInfo)]
+    lib.qrsdp_log_open.argtypes = [ctypes.c_char_p, ctypes.c_uint32]
+    lib.qrsdp_log_open.restype = p
+    lib.qrsdp_log_close.argtypes = [p]
+    lib.qrsdp_log_get_info.argtypes = [p, ctypes.POINTER(_LogInfo)]
+    lib.qrsdp_log_get_stats.argtypes = [p, ctypes.POINTER(_LogStats)]
+    lib.qrsdp_log_read.argtypes = [p, ctypes.c_uint64, ctypes.c_uint64]
+    lib.qrsdp_log_read.restype = p
+    lib.qrsdp_log_read_chunks.argtypes = [p, ctypes.c_uint32, ctypes.c_uint32]
+    lib.qrsdp_log_read_chunks.restype = p
+    lib.qrsdp_log_select.argtypes = [p, ctypes.c_uint64, ctypes.c_uint64]
+    lib.qrsdp_log_select.restype = p
+    lib.qrsdp_records_data.argtypes = [p]
+    lib.qrsdp_records_data.restype = p
+    lib.qrsdp_records_count.argtypes = [p]
+    lib.qrsdp_records_count.restype = ctypes.c_size_t
+    lib.qrsdp_records_free.argtypes = [p]
+    lib.qrsdp_log_bar_intervals.argtypes = [p, ctypes.POINTER(ctypes.c_uint64), ctypes.c_size_t]
+    lib.qrsdp_log_bar_intervals.restype = ctypes.c_size_t
+    lib.qrsdp_log_bars.argtypes = [p, ctypes.c_uint64, ctypes.POINTER(p)]
+    lib.qrsdp_log_bars.restype = ctypes.c_size_t
+    lib.qrsdp_frames_open.argtypes = [ctypes.c_char_p, ctypes.c_uint64, ctypes.c_uint32]
+    lib.qrsdp_frames_open.restype = p
+    lib.qrsdp_frames_close.argtypes = [p]
+    lib.qrsdp_frames_next.argtypes = [p, ctypes.POINTER(p)]
+    lib.qrsdp_frames_next.restype = ctypes.c_int64
+    lib.qrsdp_frames_set_interval.argtypes = [p, ctypes.c_uint64]
+    lib.qrsdp_feed_attach.argtypes = [ctypes.c_char_p]
+    lib.qrsdp_feed_attach.restype = p
+    lib.qrsdp_feed_close.argtypes = [p]
+    lib.qrsdp_feed_next.argtypes = [p, ctypes.POINTER(ctypes.c_uint32), ctypes.POINTER(p),
+                                    ctypes.POINTER(ctypes.c_size_t)]
+    lib.qrsdp_feed_dropped.argtypes = [p]
+    lib.qrsdp_feed_dropped.restype = ctypes.c_uint64
+    lib.qrsdp_bus_attach.argtypes = [ctypes.c_char_p, ctypes.c_int]
+    lib.qrsdp_bus_attach.restype = p
+    lib.qrsdp_bus_close.argtypes = [p]
+    lib.qrsdp_bus_next.argtypes = [p, ctypes.POINTER(ctypes.POINTER(_BusBatch)), ctypes.POINTER(p)]
+    lib.qrsdp_bus_cursor.argtypes = [p]
+    lib.qrsdp_bus_cursor.restype = ctypes.c_uint64
+    lib.qrsdp_bus_lost.argtypes = [p]
+    lib.qrsdp_bus_lost.restype = ctypes.c_uint64
+
+
+def load(path: Optional[str] = None) -> Optional[ctypes.CDLL]:
+    """Load libqrsdp once; None if it is not found or has another ABI version."""
+    global _lib
+    if _lib is not None:
+        return _lib
+    candidates = [Path(path)] if path else []
+    if os.environ.get("QRSDP_LIB"):
+        candidates.append(Path(os.environ["QRSDP_LIB"]))
+    candidates += _LIB_CANDIDATES
+    for cand in candidates:
+        if not cand.exists():
+            continue
+        lib = ctypes.CDLL(str(cand))
+        _declare(lib)
+        if lib.qrsdp_abi_version() != ABI_VERSION:
+            continue
+        _lib = lib
+        return _lib
+    return None
+
+
+def _require() -> ctypes.CDLL:
+    lib = load()
+    if lib is None:
+        raise RuntimeError("libqrsdp not found: build the qrsdp target or set QRSDP_LIB")
+    return lib
+
+
+def _error(lib: ctypes.CDLL) -> str:
+    return lib.qrsdp_last_error().decode(errors="replace")
+
+
+def _fill_session(cfg: _SessionConfig, model: str, params: Dict[str, float], **fields) -> None:
+    if model not in MODELS:
+        raise ValueError(f"model must be one of {sorted(MODELS)}")
+    cfg.model = MODELS[model]
+    for name, value in list(fields.items()) + list(params.items()):
+        if value is None:
+            continue
+        if not hasattr(cfg, name):
+            raise TypeError(f"unknown session parameter: {name}")
+        setattr(cfg, name, value)
+
+
+def run(output_dir: str, *, symbol: Optional[str] = None, days: int = 1, seed: int = 42,
+        seconds: int = 23400, p0_ticks: int = 10000, model: str = "simple",
+        start_date: str = "2026-01-02", threads: int = 0,
+        bar_seconds: Sequence[int] = (1, 60, 300), realtime: bool = False,
+        speed: float = 100.0, live_frames: Optional[str] = None,
+        frame_interval_ns: int = 50_000_000, **params: float) -> dict:
+    """Run days of simulation into output_dir; params are IntensityParams fields
+    (base_L, base_C, base_M, imbalance_sensitivity, cancel_sensitivity,
+    epsilon_exec, spread_sensitivity). Releases the GIL for the whole run.
+
+    live_frames: ring file to publish book frames to while generating (follow
+    it with Feed from another thread or process); realtime paces the run at
+    speed simulated seconds per wall second."""
+    lib = _require()
+    cfg = _RunConfig()
+    lib.qrsdp_run_config_init(ctypes.byref(cfg))
+    out = str(output_dir).encode()
+    date = start_date.encode()
+    sym = symbol.encode() if symbol else None
+    bars = (ctypes.c_uint32 * len(bar_seconds))(*bar_seconds)
+    cfg.output_dir = out
+    cfg.start_date = date
+    cfg.symbol = sym
+    cfg.num_days = days
+    cfg.base_seed = seed
+    cfg.threads = threads
+    cfg.bar_seconds = ctypes.cast(bars, ctypes.POINTER(ctypes.c_uint32))
+    cfg.bar_seconds_count = len(bar_seconds)
+    cfg.realtime = 1 if realtime else 0
+    cfg.speed = speed
+    ring = str(live_frames).encode() if live_frames else None
+    cfg.live_frames = ring
+    cfg.live_frame_interval_ns = frame_interval_ns
+    _fill_session(cfg.session, model, params, session_seconds=seconds, p0_ticks=p0_ticks)
+
+    handle = lib.qrsdp_run(ctypes.byref(cfg))
+    if not handle:
+        raise RuntimeError(f"qrsdp_run failed: {_error(lib)}")
+    try:
+        day_list = []
+        info = _DayInfo()
+        for i in range(lib.qrsdp_run_result_day_count(handle)):
+            lib.qrsdp_run_result_day(handle, i, ctypes.byref(info))
+            day_list.append({
+                "symbol": info.symbol.decode(), "date": info.date.decode(),
+                "file": info.filename.decode(), "seed": info.seed,
+                "open_ticks": info.open_ticks, "close_ticks": info.close_ticks,
+                "events": info.events, "file_size_bytes": info.file_size_bytes,
+            })
+        return {
+            "total_events": lib.qrsdp_run_result_total_events(handle),
+            "elapsed_seconds": lib.qrsdp_run_result_elapsed_seconds(handle),
+            "days": day_list,
+        }
+    finally:
+        lib.qrsdp_run_result_free(handle)
+
+
+class Session:
+    """One trading session generated in memory.
+
+    >>> with Session(seed=7, seconds=600) as s:
+    ...     for batch in s.batches():
+    ...         ...
+    """
+
+    def __init__(self, *, seed: int = 42, seconds: int = 23400, p0_ticks: int = 10000,
+                 model: str = "simple", levels_per_side: int = 5, **params: float):
+        self._lib = _require()
+        cfg = _SessionConfig()
+        self._lib.qrsdp_session_config_init(ctypes.byref(cfg))
+        _fill_session(cfg, model, params, seed=seed, session_seconds=seconds,
+                      p0_ticks=p0_ticks, levels_per_side=levels_per_side)
+        self._levels = cfg.levels_per_side
+        self._handle = self._lib.qrsdp_session_create(ctypes.byref(cfg))
+        if not self._handle:
+            raise ValueError(_error(self._lib))
+
+    def close(self) -> None:
+        if self._handle:
+            self._lib.qrsdp_session_destroy(self._handle)
+            self._handle = None
+
+    def __enter__(self) -> "Session":
+        return self
+
+    def __exit__(self, *exc) -> None:
+        self.close()
+
+    def __del__(self) -> None:
+        self.close()
+
+    def next(self, max_events: int = 4096, tops: bool = False):
+        """Up to max_events records (RECORD_DTYPE); with tops, also the book top
+        after each (TOP_DTYPE). Empty once the session has ended."""
+        events = np.empty(max_events, dtype=RECORD_DTYPE)
+        top_arr = np.empty(max_events, dtype=TOP_DTYPE) if tops else None
+        n = self._lib.qrsdp_session_next(
+            self._handle, events.ctypes.data, max_events,
+            top_arr.ctypes.data if tops else None)
+        if n < 0:
+            raise RuntimeError(_error(self._lib))
+        return (events[:n], top_arr[:n]) if tops else events[:n]
+
+    def batches(self, max_events: int = 4096):
+        while True:
+            batch = self.next(max_events)
+            if len(batch) == 0:
+                return
+            yield batch
+
+    def book(self) -> dict:
+        """Current book: {'bids': [(price, depth), ...], 'asks': [...]}, best first."""
+        bids = (_Level * self._levels)()
+        asks = (_Level * self._levels)()
+        n = self._lib.qrsdp_session_book(self._handle, bids, asks, self._levels)
+        return {
+            "bids": [(bids[k].price_ticks, bids[k].depth) for k in range(n)],
+            "asks": [(asks[k].price_ticks, asks[k].depth) for k in range(n)],
+        }
+
+    def stats(self) -> dict:
+        s = _SessionStats()
+        self._lib.qrsdp_session_stats_get(self._handle, ctypes.byref(s))
+        return {"events": s.events, "shifts": s.shifts,
+                "sim_seconds": s.sim_seconds, "finished": bool(s.finished)}
+
+
+class _Buffer:
+    """Exposes memory the library owns to numpy via __array_interface__; numpy
+    keeps this object (and so the buffer or log) alive as the array's base."""
+
+    def __init__(self, ptr: int, count: int, dtype: np.dtype, owner, free=None):
+        self._owner = owner
+        self._free = free
+        self.__array_interface__ = {
+            "version": 3, "shape": (count,), "typestr": f"|V{dtype.itemsize}",
+            "descr": dtype.descr, "data": (ptr, False),
+        }
+
+    def __del__(self) -> None:
+        if self._free is not None:
+            self._free(self._owner)
+            self._free = None
+
+
+class EventLog:
+    """One .qrsdp file opened through the C++ EventLogReader.
+
+    threads > 1 decodes whole-file reads in parallel. Returned arrays own their
+    buffers and stay valid after close(); bars() views are tied to the log and
+    keep it open while referenced.
+    """
+
+    def __init__(self, path, threads: int = 0):
+        self._lib = _require()
+        self._handle = self._lib.qrsdp_log_open(str(path).encode(), threads)
+        if not self._handle:
+            raise OSError(f"{path}: {_error(self._lib)}")
+        info = _LogInfo()
+        self._lib.qrsdp_log_get_info(self._handle, ctypes.byref(info))
+        self.header = {name: getattr(info, name) for name, _ in _LogInfo._fields_}
+
+    @property
+    def total_records(self) -> int:
+        return self.header["total_records"]
+
+    @property
+    def chunk_count(self) -> int:
+        return self.header["chunk_count"]
+
+    def close(self) -> None:
+        if self._handle:
+            self._lib.qrsdp_log_close(self._handle)
+            self._handle = None
+
+    def __enter__(self) -> "EventLog":
+        return self
+
+    def __exit__(self, *exc) -> None:
+        self.close()
+
+    def __del__(self) -> None:
+        self.close()
+
+    def _records(self, handle) -> np.ndarray:
+        if not handle:
+            raise RuntimeError(_error(self._lib))
+        count = self._lib.qrsdp_records_count(handle)
+        if count == 0:
+            self._lib.qrsdp_records_free(handle)
+            return np.empty(0, dtype=RECORD_DTYPE)
+        buf = _Buffer(self._lib.qrsdp_records_data(handle), count, RECORD_DTYPE,
+                      handle, self._lib.qrsdp_records_free)
+        return np.asarray(buf).view(RECORD_DTYPE)
+
+    def read(self, first: int = 0, end: Optional[int] = None) -> np.ndarray:
+        """Records [first, end) in file order (default: the whole file)."""
+        return self._records(self._lib.qrsdp_log_read(
+            self._handle, first, (1 << 64) - 1 if end is None else end))
+
+    def read_chunks(self, first: int, end: int) -> np.ndarray:
+        """Every record of chunks [first, end)."""
+        return self._records(self._lib.qrsdp_log_read_chunks(self._handle, first, end))
+
+    def select(self, ts_start: int, ts_end: int) -> np.ndarray:
+        """Exactly the records with ts_start <= ts_ns <= ts_end."""
+        return self._records(self._lib.qrsdp_log_select(self._handle, ts_start, ts_end))
+
+    def stats(self) -> Optional[Dict]:
+        """Footer stats totals, or None if the file has no stats block."""
+        out = _LogStats()
+        if self._lib.qrsdp_log_get_stats(self._handle, ctypes.byref(out)) != 0:
+            return None
+        stats = {name: getattr(out, name) for name, _ in _LogStats._fields_}
+        stats["type_counts"] = list(out.type_counts)
+        return stats
+
+    def bars(self) -> Dict[int, np.ndarray]:
+        """{interval_seconds: BAR_DTYPE array} like qrsdp_reader.read_bars."""
+        n = self._lib.qrsdp_log_bar_intervals(self._handle, None, 0)
+        intervals = (ctypes.c_uint64 * n)()
+        self._lib.qrsdp_log_bar_intervals(self._handle, intervals, n)
+        series = {}
+        for interval_ns in intervals:
+            ptr = ctypes.c_void_p()
+            count = self._lib.qrsdp_log_bars(self._handle, interval_ns, ctypes.byref(ptr))
+            if count == 0:
+                series[interval_ns // 1_000_000_000] = np.empty(0, dtype=BAR_DTYPE)
+                continue
+            view = np.asarray(_Buffer(ptr.value, count, BAR_DTYPE, self)).view(BAR_DTYPE)
+            series[interval_ns // 1_000_000_000] = view
+        return series
+
+
+class FrameStream:
+    """Book frames of one .qrsdp file, one per frame_interval_ns of simulated
+    time that has records. Iterating yields each frame as bytes, ready to send
+    as is; decode_frame() turns one into a dict.
+    """
+
+    def __init__(self, path, frame_interval_ns: int, recent_events: int = 8):
+        self._lib = _require()
+        self._handle = self._lib.qrsdp_frames_open(str(path).encode(), frame_interval_ns, recent_events)
+        if not self._handle:
+            raise OSError(f"{path}: {_error(self._lib)}")
+
+    def close(self) -> None:
+        if self._handle:
+            self._lib.qrsdp_frames_close(self._handle)
+            self._handle = None
+
+    def __enter__(self) -> "FrameStream":
+        return self
+
+    def __exit__(self, *exc) -> None:
+        self.close()
+
+    def __del__(self) -> None:
+        self.close()
+
+    def next(self) -> Optional[bytes]:
+        """The next frame, or None after the last one."""
+        ptr = ctypes.c_void_p()
+        n = self._lib.qrsdp_frames_next(self._handle, ctypes.byref(ptr))
+        if n < 0:
+            raise RuntimeError(_error(self._lib))
+        return ctypes.string_at(ptr.value, n) if n else None
+
+    def __iter__(self):
+        while True:
+            frame = self.next()
+            if frame is None:
+                return
+            yield frame
+
+    def set_interval(self, frame_interval_ns: int) -> None:
+        """Applies from the next frame on (e.g. after a playback speed change)."""
+        if self._lib.qrsdp_frames_set_interval(self._handle, frame_interval_ns) != 0:
+            raise ValueError(_error(self._lib))
+
+
+def frame_ts_ns(frame: bytes) -> int:
+    """Timestamp of a frame's last record, without decoding the rest."""
+    return struct.unpack_from("<Q", frame, 8)[0]
+
+
+def decode_frame(frame: bytes) -> dict:
+    """{ts_ns, record_index, best_bid, best_ask, frame_records, bids, asks, events}
+    with bids/asks as [(price_ticks, depth)] best first and events as
+    [(type, side, price_ticks, qty)] oldest first."""
+    magic, levels, event_count, ts_ns, record_index, bid, ask, frame_records, _ = \
+        _FRAME_HEADER.unpack_from(frame, 0)
+    if magic != FRAME_MAGIC:
+        raise ValueError("not a book frame")
+    pos = _FRAME_HEADER.size
+    sides = []
+    for _ in range(2):
+        sides.append([_FRAME_LEVEL.unpack_from(frame, pos + k * _FRAME_LEVEL.size) for k in range(levels)])
+        pos += levels * _FRAME_LEVEL.size
+    events = [_FRAME_EVENT.unpack_from(frame, pos + i * _FRAME_EVENT.size) for i in range(event_count)]
+    return {
+        "ts_ns": ts_ns,
+        "record_index": record_index,
+        "best_bid": bid,
+        "best_ask": ask,
+        "frame_records": frame_records,
+        "bids": sides[0],
+        "asks": sides[1],
+        "events": events,
+    }
+
+
+class Feed:
+    """Follows the ring a run(live_frames=...) publishes to. next() never
+    blocks: (kind, payload) with kind one of FEED_BOOK_FRAME (a frame for
+    decode_frame), FEED_DAY_START or FEED_DAY_END (see decode_day_start and
+    decode_day_end); None when nothing is new yet. closed is set once the run
+    has finished and everything has been read.
+    """
+
+    def __init__(self, path):
+        self._lib = _require()
+        self._handle = self._lib.qrsdp_feed_attach(str(path).encode())
+        if not self._handle:
+            raise OSError(f"{path}: {_error(self._lib)}")
+        self.closed = False
+
+    def close(self) -> None:
+        if self._handle:
+            self._lib.qrsdp_feed_close(self._handle)
+            self._handle = None
+
+    def __enter__(self) -> "Feed":
+        return self
+
+    def __exit__(self, *exc) -> None:
+        self.close()
+
+    def __del__(self) -> None:
+        self.close()
+
+    def next(self):
+        kind = ctypes.c_uint32()
+        ptr = ctypes.c_void_p()
+        size = ctypes.c_size_t()
+        r = self._lib.qrsdp_feed_next(self._handle, ctypes.byref(kind), ctypes.byref(ptr), ctypes.byref(size))
+        if r < 0:
+            raise RuntimeError(_error(self._lib))
+        if r == _FEED_CLOSED:
+            self.closed = True
+        if r != _FEED_MESSAGE:
+            return None
+        return kind.value, ctypes.string_at(ptr.value, size.value)
+
+    @property
+    def dropped(self) -> int:
+        """Times the writer overtook this reader and it skipped ahead."""
+        return self._lib.qrsdp_feed_dropped(self._handle)
+
+
+def decode_day_start(payload: bytes) -> dict:
+    day_index, num_days, open_ns, open_ticks, tick_size, date, symbol = _DAY_START.unpack_from(payload, 0)
+    return {
+        "day_index": day_index, "num_days": num_days, "market_open_ns": open_ns,
+        "open_ticks": open_ticks, "tick_size": tick_size,
+        "date": date.rstrip(b"\0").decode(), "symbol": symbol.rstrip(b"\0").decode(),
+    }
+
+
+def decode_day_end(payload: bytes) -> dict:
+    day_index, close_ticks, events = _DAY_END.unpack_from(payload, 0)
+    return {"day_index": day_index, "close_ticks": close_ticks, "events": events}
+
+
+class EventBus:
+    """Follows the event bus of a `qrsdp_run --shm-ring <path>` run. next()
+    never blocks: (batch, records) with batch a dict {first_seq, security,
+    symbol, date} and records a RECORD_DTYPE array (a copy); None when nothing
+    is new yet. closed is set once the run has finished and everything has
+    been read; lost counts records the run overwrote before they were read.
+    """
+
+    def __init__(self, path, from_oldest: bool = False):
+        self._lib = _require()
+        self._handle = self._lib.qrsdp_bus_attach(str(path).encode(), 1 if from_oldest else 0)
+        if not self._handle:
+            raise OSError(f"{path}: {_error(self._lib)}")
+        self.closed = False
+
+    def close(self) -> None:
+        if self._handle:
+            self._lib.qrsdp_bus_close(self._handle)
+            self._handle = None
+
+    def __enter__(self) -> "EventBus":
+        return self
+
+    def __exit__(self, *exc) -> None:
+        self.close()
+
+    def __del__(self) -> None:
+        self.close()
+
+    def next(self):
+        batch = ctypes.POINTER(_BusBatch)()
+        ptr = ctypes.c_void_p()
+        r = self._lib.qrsdp_bus_next(self._handle, ctypes.byref(batch), ctypes.byref(ptr))
+        if r < 0:
+            raise RuntimeError(_error(self._lib))
+        if r == _FEED_CLOSED:
+            self.closed = True
+        if r != _FEED_MESSAGE:
+            return None
+        b = batch.contents
+        records = np.frombuffer(ctypes.string_at(ptr.value, b.count * RECORD_DTYPE.itemsize), dtype=RECORD_DTYPE)
+        return {
+            "first_seq": b.first_seq, "security": b.security,
+            "symbol": b.symbol.decode(), "date": b.date.decode(),
+        }, records
+
+    @property
+    def cursor(self) -> int:
+        """Sequence number the next record should have."""
+        return self._lib.qrsdp_bus_cursor(self._handle)
+
+    @property
+    def lost(self) -> int:
+        return self._lib.qrsdp_bus_lost(self._handle)
@@ -3,11 +3,14 @@ Compute OHLC (Open-High-Low-Close) bars from tick-level mid-price data
 at multiple time resolutions for interactive charting.
 """
 
+from pathlib import Path
 from typing import Dict
 
 import numpy as np
 import pandas as pd
 
+from qrsdp_reader import read_bars
+
 # Pre-defined resolution tiers (label -> nanoseconds)
 RESOLUTIONS = {
     "1s": 1_000_000_000,
@@ -66,6 +69,35 @@ def multi_resolution_ohlc(
     }
 
 
+def load_precomputed_ohlc(path: str | Path) -> Dict[str, pd.DataFrame]:
+    """
+    OHLC bars written by the simulator into a day file's footer (``qrsdp_run --bars``).
+
+    Keys are labels such as ``"1s"``, ``"1min"`` and ``"5min"``. Columns match
+    compute_ohlc() (``volume`` is the event count, as there) plus ``close_bid``,
+    ``close_ask``, ``executions`` and ``exec_volume``. Bars start at market open
+    and empty intervals have no row. Returns {} if the file has no bars; fall back
+    to multi_resolution_ohlc() on the replayed mids then.
+    """
+    out = {}
+    for seconds, bars in read_bars(path).items():
+        label = f"{seconds // 60}min" if seconds % 60 == 0 else f"{seconds}s"
+        out[label] = pd.DataFrame({
+            "time_ns": bars["start_ns"],
+            "time_s": bars["start_ns"] / 1e9,
+            "open": bars["open_mid2"] / 2.0,
+            "high": bars["high_mid2"] / 2.0,
+            "low": bars["low_mid2"] / 2.0,
+            "close": bars["close_mid2"] / 2.0,
+            "volume": bars["events"],
+            "close_bid": bars["close_bid_ticks"],
+            "close_ask": bars["close_ask_ticks"],
+            "executions": bars["executions"],
+            "exec_volume": bars["volume"],
+        })
+    return out
+
+
 def select_resolution(
     bars: Dict[str, pd.DataFrame],
     visible_seconds: float,
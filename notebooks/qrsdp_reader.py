@@ -23,6 +23,22 @@ import numpy as np
 MAGIC = b"QRSDPLOG"
 FILE_HEADER_SIZE = 64
 CHUNK_HEADER_SIZE = 32
+CHUNK_FLAG_RAW = 0x1  # payload stored uncompressed
+CHUNK_FLAG_COLUMNAR = 0x2  # v1.1 columnar payload (see docs/event-log-format.md)
+CHUNK_FLAG_DICTIONARY = 0x4  # zstd dictionary block directly after the file header
+CHUNK_FLAG_SEEK_INDEX = 0x8  # seek index block after the last chunk (no records)
+CHUNK_FLAG_CHECKPOINTS = 0x10  # book checkpoint block after the last chunk (no records)
+CHUNK_FLAG_BARS = 0x20  # OHLC bar block after the last chunk (no records)
+CHUNK_FLAG_STATS = 0x40  # per-chunk stats block after the last chunk (no records)
+CHUNK_FLAG_METADATA = (CHUNK_FLAG_SEEK_INDEX | CHUNK_FLAG_CHECKPOINTS | CHUNK_FLAG_BARS
+                       | CHUNK_FLAG_STATS)
+HEADER_FLAG_HAS_INDEX = 0x1
+INDEX_ENTRY_SIZE = 32
+INDEX_TAIL_SIZE = 16
+CHUNK_CODEC_SHIFT = 8
+CHUNK_CODEC_MASK = 0xF00
+CODEC_LZ4, CODEC_NONE, CODEC_ZSTD = 0, 1, 2
+COLUMN_COUNT = 5  # type/side, ts_ns, price_ticks, qty, order_id
 RECORD_SIZE = 26
 
 RECORD_DTYPE = np.dtype([
@@ -35,6 +51,35 @@ RECORD_DTYPE = np.dtype([
 ])
 assert RECORD_DTYPE.itemsize == RECORD_SIZE
 
+# One DiskBar of a bar block; mids are doubled (best bid + best ask).
+BAR_DTYPE = np.dtype([
+    ("start_ns", "<u8"),
+    ("open_mid2", "<i4"),
+    ("high_mid2", "<i4"),
+    ("low_mid2", "<i4"),
+    ("close_mid2", "<i4"),
+    ("close_bid_ticks", "<i4"),
+    ("close_ask_ticks", "<i4"),
+    ("events", "<u4"),
+    ("executions", "<u4"),
+    ("volume", "<u4"),
+    ("reserved", "<u4"),
+])
+assert BAR_DTYPE.itemsize == 48
+
+# One ChunkStats of a stats block: what a chunk holds, readable without decoding it.
+STATS_DTYPE = np.dtype([
+    ("type_counts", "<u4", (6,)),
+    ("min_price_ticks", "<i4"),
+    ("max_price_ticks", "<i4"),
+    ("executed_qty", "<u8"),
+    ("shifts_up", "<u4"),
+    ("shifts_down", "<u4"),
+    ("reinits", "<u4"),
+    ("reserved", "<u4"),
+])
+assert STATS_DTYPE.itemsize == 56
+
 _HEADER_STRUCT = struct.Struct("<8s HH I Q i I I I I I I I Q")
 assert _HEADER_STRUCT.size == FILE_HEADER_SIZE
 
@@ -85,12 +130,65 @@ def read_header(path: str | Path) -> Dict:
     }
 
 
+# ---------------------------------------------------------------------------
+# Columnar chunks (v1.1)
+# ---------------------------------------------------------------------------
+
+def _decode_varints(buf: bytes, count: int) -> np.ndarray:
+    """Decode `count` unsigned LEB128 varints from buf into a uint64 array."""
+    b = np.frombuffer(buf, dtype=np.uint8)
+    ends = np.flatnonzero(b < 0x80)
+    if len(ends) != count or (count and ends[-1] != len(b) - 1):
+        raise ValueError("columnar chunk: varint column does not hold record_count values")
+    starts = np.concatenate(([0], ends[:-1] + 1)) if count else ends
+    pos = np.arange(len(b)) - np.repeat(starts, ends - starts + 1)
+    parts = (b & 0x7F).astype(np.uint64) << (7 * pos).astype(np.uint64)
+    return np.add.reduceat(parts, starts) if count else np.empty(0, dtype=np.uint64)
+
+
+def _unzigzag(u: np.ndarray) -> np.ndarray:
+    return (u >> np.uint64(1)).astype(np.int64) ^ -(u & np.uint64(1)).astype(np.int64)
+
+
+def _decompress(codec: int, blob: bytes, size: int, zstd_dict=None) -> bytes:
+    if codec == CODEC_LZ4:
+        return lz4.block.decompress(blob, uncompressed_size=size)
+    if codec == CODEC_ZSTD:
+        import zstandard  # optional: only needed for --codec zstd files
+        return zstandard.ZstdDecompressor(dict_data=zstd_dict).decompress(blob, max_output_size=size)
+    if codec == CODEC_NONE:
+        return blob
+    raise ValueError(f"unknown chunk codec {codec}")
+
+
+def _decode_columnar(payload: bytes, record_count: int, codec: int = CODEC_LZ4,
+                     zstd_dict=None) -> np.ndarray:
+    sizes = struct.unpack_from(f"<{2 * COLUMN_COUNT}I", payload)
+    encoded, stored = sizes[:COLUMN_COUNT], sizes[COLUMN_COUNT:]
+    cols = []
+    offset = 4 * 2 * COLUMN_COUNT
+    for enc, sto in zip(encoded, stored):
+        blob = payload[offset:offset + sto]
+        cols.append(blob if sto == enc else _decompress(codec, blob, enc, zstd_dict))
+        offset += sto
+    records = np.empty(record_count, dtype=RECORD_DTYPE)
+    type_side = np.frombuffer(cols[0], dtype=np.uint8, count=record_count)
+    records["type"] = type_side & 0x0F
+    records["side"] = type_side >> 4
+    records["ts_ns"] = np.cumsum(_decode_varints(cols[1], record_count), dtype=np.uint64)
+    records["price_ticks"] = np.cumsum(_unzigzag(_decode_varints(cols[2], record_count)))
+    records["qty"] = _decode_varints(cols[3], record_count)
+    records["order_id"] = np.cumsum(_unzigzag(_decode_varints(cols[4], record_count)).view(np.uint64),
+                                    dtype=np.uint64)
+    return records
+
+
 # ---------------------------------------------------------------------------
 # Chunk iteration
 # ---------------------------------------------------------------------------
 
 def iter_chunks(path: str | Path) -> Generator[np.ndarray, None, None]:
-    """Lazily yield one numpy structured array per LZ4-compressed chunk."""
+    """Lazily yield one numpy structured array per chunk (row or columnar)."""
     with open(path, "rb") as f:
         header_raw = f.read(FILE_HEADER_SIZE)
         if len(header_raw) < FILE_HEADER_SIZE:
@@ -98,6 +196,7 @@ def iter_chunks(path: str | Path) -> Generator[np.ndarray, None, None]:
         magic = header_raw[:8]
         if magic != MAGIC:
             raise ValueError(f"bad magic: {magic!r}")
+        zstd_dict = None
 
         while True:
             ch_raw = f.read(CHUNK_HEADER_SIZE)
@@ -105,7 +204,7 @@ def iter_chunks(path: str | Path) -> Generator[np.ndarray, None, None]:
                 break
 
             (uncompressed_size, compressed_size, record_count,
-             _flags, _first_ts, _last_ts) = _CHUNK_HEADER_STRUCT.unpack(ch_raw)
+             flags, _first_ts, _last_ts) = _CHUNK_HEADER_STRUCT.unpack(ch_raw)
 
             if compressed_size == 0:
                 break
@@ -114,13 +213,147 @@ def iter_chunks(path: str | Path) -> Generator[np.ndarray, None, None]:
             if len(payload) < compressed_size:
                 break
 
-            decompressed = lz4.block.decompress(payload, uncompressed_size=uncompressed_size)
+            codec = (flags & CHUNK_CODEC_MASK) >> CHUNK_CODEC_SHIFT
+            if flags & CHUNK_FLAG_DICTIONARY:
+                import zstandard
+                zstd_dict = zstandard.ZstdCompressionDict(payload)
+                continue
+            if flags & CHUNK_FLAG_METADATA:
+                continue
+            if record_count == 0 or uncompressed_size != record_count * RECORD_SIZE:
+                break  # torn tail of a crashed writer
+            if flags & CHUNK_FLAG_COLUMNAR:
+                yield _decode_columnar(payload, record_count, codec, zstd_dict)
+                continue
+            if flags & CHUNK_FLAG_RAW:
+                decompressed = payload
+            else:
+                decompressed = _decompress(codec, payload, uncompressed_size, zstd_dict)
             records = np.frombuffer(decompressed, dtype=RECORD_DTYPE, count=record_count)
             yield records.copy()
 
 
+def read_checkpoints(path: str | Path) -> list[Dict]:
+    """Book checkpoints of a file (``qrsdp_run --checkpoint-every``), in record order.
+
+    Each is a dict with ``record_index``, ``ts_ns``, ``next_order_id`` and ``bids`` /
+    ``asks`` as lists of ``(price_ticks, depth)``, best first. The book after the
+    first ``record_index`` records equals these levels, so a replay can start there.
+    """
+    checkpoints = []
+    with open(path, "rb") as f:
+        f.seek(FILE_HEADER_SIZE)
+        while True:
+            ch_raw = f.read(CHUNK_HEADER_SIZE)
+            if len(ch_raw) < CHUNK_HEADER_SIZE:
+                break
+            _u, compressed_size, _n, flags, _t0, _t1 = _CHUNK_HEADER_STRUCT.unpack(ch_raw)
+            if compressed_size == 0:
+                break
+            if not flags & CHUNK_FLAG_CHECKPOINTS:
+                f.seek(compressed_size, 1)
+                continue
+            payload = f.read(compressed_size)
+            count, levels = struct.unpack_from("<I I", payload, 0)
+            pos = 8
+            for _ in range(count):
+                record_index, ts_ns, next_order_id, _rng_position = struct.unpack_from("<Q Q Q Q", payload, pos)
+                pos += 32
+                flat = struct.unpack_from("<" + "iI" * (2 * levels), payload, pos)
+                pos += 16 * levels
+                pairs = list(zip(flat[0::2], flat[1::2]))
+                checkpoints.append({
+                    "record_index": record_index,
+                    "ts_ns": ts_ns,
+                    "next_order_id": next_order_id,
+                    "bids": pairs[:levels],
+                    "asks": pairs[levels:],
+                })
+            break
+    return checkpoints
+
+
+def _footer_block(path: str | Path, flag: int) -> Optional[bytes]:
+    """Payload of the metadata block with flag after a finished file's last chunk.
+
+    Only the index tail, the last chunk header and the blocks after it are read.
+    """
+    with open(path, "rb") as f:
+        header = f.read(FILE_HEADER_SIZE)
+        if len(header) < FILE_HEADER_SIZE or not _HEADER_STRUCT.unpack(header)[12] & HEADER_FLAG_HAS_INDEX:
+            return None
+        f.seek(-INDEX_TAIL_SIZE, 2)
+        chunk_count, magic, index_start = struct.unpack("<I 4s Q", f.read(INDEX_TAIL_SIZE))
+        if magic != b"QIDX" or chunk_count == 0:
+            return None
+        f.seek(index_start + (chunk_count - 1) * INDEX_ENTRY_SIZE)
+        (offset,) = struct.unpack("<Q", f.read(8))
+        while offset < index_start:
+            f.seek(offset)
+            _u, compressed_size, _n, flags, _t0, _t1 = _CHUNK_HEADER_STRUCT.unpack(f.read(CHUNK_HEADER_SIZE))
+            if flags & flag:
+                return f.read(compressed_size)
+            offset += CHUNK_HEADER_SIZE + compressed_size
+    return None
+
+
+def read_bars(path: str | Path) -> Dict[int, np.ndarray]:
+    """OHLC bars stored in a finished file's footer (``qrsdp_run --bars``).
+
+    Returns ``{interval_seconds: BAR_DTYPE array}``, empty if the file has no bar
+    block. Only the index tail, the last chunk header and the bar block are read,
+    so this costs a few KB of I/O however long the day is.
+    """
+    payload = _footer_block(path, CHUNK_FLAG_BARS)
+    if payload is None:
+        return {}
+    series = {}
+    (count, _reserved) = struct.unpack_from("<I I", payload, 0)
+    pos = 8
+    for _ in range(count):
+        interval_ns, bar_count, _r = struct.unpack_from("<Q I I", payload, pos)
+        pos += 16
+        series[interval_ns // 1_000_000_000] = np.frombuffer(
+            payload, dtype=BAR_DTYPE, count=bar_count, offset=pos).copy()
+        pos += bar_count * BAR_DTYPE.itemsize
+    return series
+
+
+def read_stats(path: str | Path) -> Optional[np.ndarray]:
+    """Per-chunk stats stored in a finished file's footer, as a STATS_DTYPE array
+    in chunk order, or None if the file has none (older or resumed files).
+
+    ``read_stats(p)["type_counts"].sum(axis=0)`` is the day's event distribution,
+    read without decoding a single chunk.
+    """
+    payload = _footer_block(path, CHUNK_FLAG_STATS)
+    if payload is None:
+        return None
+    (count, _reserved) = struct.unpack_from("<I I", payload, 0)
+    return np.frombuffer(payload, dtype=STATS_DTYPE, count=count, offset=8).copy()
+
+
+def _native_log(path: str | Path):
+    """libqrsdp.EventLog over path when the library is built, else None."""
+    try:
+        import libqrsdp
+    except ImportError:
+        return None
+    if libqrsdp.load() is None:
+        return None
+    return libqrsdp.EventLog(path)
+
+
 def read_day(path: str | Path) -> np.ndarray:
-    """Read all records from a single .qrsdp file into one numpy array."""
+    """Read all records from a single .qrsdp file into one numpy array.
+
+    Decodes with the C++ EventLogReader through libqrsdp when it is built (no
+    per-chunk Python work, no copy), otherwise chunk by chunk in Python.
+    """
+    log = _native_log(path)
+    if log is not None:
+        with log:
+            return log.read()
     chunks = list(iter_chunks(path))
     if not chunks:
         return np.empty(0, dtype=RECORD_DTYPE)
@@ -210,3 +443,134 @@ def iter_securities(
             continue
         records = read_day(run_dir / session["file"])
         yield sym, date, records
+
+
+# ---------------------------------------------------------------------------
+# Run catalogue (catalog.qcat, see src/io/run_catalog.h)
+# ---------------------------------------------------------------------------
+
+CATALOG_MAGIC = b"QCAT"
+CATALOG_HEADER_SIZE = 16
+CATALOG_ENTRY_SIZE = 256
+CATALOG_FLAG_IN_CONTAINER = 0x1
+CATALOG_FLAG_HAS_STATS = 0x2
+_CATALOG_ENTRY = struct.Struct("<16s16s64sQiiQIIQQQ6QiiQQQQQQ")
+
+
+def _fnv1a64(data: bytes) -> int:
+    h = 0xCBF29CE484222325
+    for b in data:
+        h = ((h ^ b) * 0x100000001B3) & 0xFFFFFFFFFFFFFFFF
+    return h
+
+
+def read_catalog(
+    run_dir_or_path: str | Path,
+    symbol: Optional[str] = None,
+    start_date: Optional[str] = None,
+    end_date: Optional[str] = None,
+) -> list[Dict]:
+    """Days listed in a run's catalogue, sorted by (symbol, date).
+
+    Takes the run directory or the catalog.qcat path. Each dict carries the
+    day's file (relative to the run directory), counts, time range and footer
+    stats, so a date range can be sized without opening a single day file. A
+    torn last entry (the run was killed mid-write) is ignored.
+    """
+    path = Path(run_dir_or_path)
+    if path.is_dir():
+        path = path / "catalog.qcat"
+    data = path.read_bytes()
+    magic, major, _minor, entry_size, _reserved = struct.unpack_from("<4sHHII", data, 0)
+    if magic != CATALOG_MAGIC or major != 1 or entry_size != CATALOG_ENTRY_SIZE:
+        raise ValueError(f"not a run catalogue: {path}")
+
+    days = []
+    offsets = range(CATALOG_HEADER_SIZE, len(data) - CATALOG_ENTRY_SIZE + 1, CATALOG_ENTRY_SIZE)
+    for n, off in enumerate(offsets):
+        raw = data[off:off + CATALOG_ENTRY_SIZE]
+        f = _CATALOG_ENTRY.unpack(raw)
+        if _fnv1a64(raw[:-8]) != f[-1]:
+            if n == len(offsets) - 1:
+                break
+            raise ValueError(f"corrupt entry {n} in {path}")
+        day = {
+            "symbol": f[0].rstrip(b"\0").decode(),
+            "date": f[1].rstrip(b"\0").decode(),
+            "file": f[2].rstrip(b"\0").decode(),
+            "seed": f[3], "open_ticks": f[4], "close_ticks": f[5],
+            "record_count": f[6], "chunk_count": f[7],
+            "in_container": bool(f[8] & CATALOG_FLAG_IN_CONTAINER),
+            "has_stats": bool(f[8] & CATALOG_FLAG_HAS_STATS),
+            "file_bytes": f[9], "first_ts_ns": f[10], "last_ts_ns": f[11],
+            "type_counts": list(f[12:18]),
+            "min_price_ticks": f[18], "max_price_ticks": f[19], "executed_qty": f[20],
+            "shifts_up": f[21], "shifts_down": f[22], "reinits": f[23],
+        }
+        if symbol is not None and day["symbol"] != symbol:
+            continue
+        if start_date and day["date"] < start_date:
+            continue
+        if end_date and day["date"] > end_date:
+            continue
+        days.append(day)
+    days.sort(key=lambda d: (d["symbol"], d["date"]))
+    return days
+
+
+# ---------------------------------------------------------------------------
+# Arrow datasets (qrsdp_run --arrow, qrsdp_export --out-dir)
+# ---------------------------------------------------------------------------
+
+def arrow_files(
+    root: str | Path,
+    symbols: Optional[list[str]] = None,
+    start_date: Optional[str] = None,
+    end_date: Optional[str] = None,
+) -> list[Path]:
+    """
+    List the <date>.arrow / <SYMBOL>/<date>.arrow files under root, sorted,
+    keeping only the given symbols and dates in [start_date, end_date].
+
+    The selection uses the paths alone, so files outside it are never opened.
+    """
+    root = Path(root)
+    files = []
+    for path in sorted(root.glob("*.arrow")) + sorted(root.glob("*/*.arrow")):
+        symbol = "" if path.parent == root else path.parent.name
+        date = path.stem
+        if symbols is not None and symbol not in symbols:
+            continue
+        if start_date and date < start_date:
+            continue
+        if end_date and date > end_date:
+            continue
+        files.append(path)
+    return files
+
+
+def scan_arrow(
+    root: str | Path,
+    symbols: Optional[list[str]] = None,
+    start_date: Optional[str] = None,
+    end_date: Optional[str] = None,
+    backend: str = "pyarrow",
+):
+    """
+    Lazily scan Arrow event files as one table, without a Python loop per day.
+
+    backend="pyarrow" returns a pyarrow.dataset.Dataset (filter / to_table /
+    DuckDB); backend="polars" returns a polars LazyFrame. Both read only the
+    columns and record batches a query needs. Columns: ts_ns, type and side
+    (dictionary-encoded names), price_ticks, qty, order_id, symbol, date.
+    """
+    files = [str(p) for p in arrow_files(root, symbols, start_date, end_date)]
+    if not files:
+        raise FileNotFoundError(f"no .arrow files under {root} for that selection")
+    if backend == "polars":
+        import polars as pl
+        return pl.scan_ipc(files)
+    if backend == "pyarrow":
+        import pyarrow.dataset as ds
+        return ds.dataset(files, format="ipc")
+    raise ValueError(f"unknown backend {backend!r} (pyarrow or polars)")
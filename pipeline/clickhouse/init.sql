@@ -1,19 +1,17 @@
 -- ClickHouse schema for the exchange event streaming pipeline.
 -- Kafka broker and topic are substituted by init.sh before execution.
 
+-- Each Kafka message value is either one bare 26-byte record or a batch: a
+-- 12-byte 'QRKB' header followed by 26-byte records (src/io/kafka_payload.h).
+-- The Kafka table takes the raw value; exchange_events_mv splits it into rows.
 CREATE TABLE IF NOT EXISTS exchange_events_kafka (
-    ts_ns      UInt64,
-    type       UInt8,
-    side       UInt8,
-    price_ticks Int32,
-    qty        UInt32,
-    order_id   UInt64
+    payload String
 ) ENGINE = Kafka
 SETTINGS
     kafka_broker_list = '${KAFKA_BROKERS}',
     kafka_topic_list = '${KAFKA_TOPIC}',
     kafka_group_name = 'clickhouse-consumer',
-    kafka_format = 'RowBinary',
+    kafka_format = 'RawBLOB',
     kafka_num_consumers = 1;
 
 CREATE TABLE IF NOT EXISTS exchange_events (
@@ -33,8 +31,8 @@ ORDER BY (symbol, date, ts_ns);
 CREATE MATERIALIZED VIEW IF NOT EXISTS exchange_events_mv
 TO exchange_events AS
 SELECT
-    ts_ns,
-    type,
+    reinterpretAsUInt64(substring(body, off + 1, 8))  AS ts_ns,
+    reinterpretAsUInt8(substring(body, off + 9, 1))   AS type,
     multiIf(
         type = 0, 'ADD_BID',
         type = 1, 'ADD_ASK',
@@ -44,13 +42,22 @@ SELECT
         type = 5, 'EXECUTE_SELL',
         'UNKNOWN'
     ) AS type_name,
-    side,
-    price_ticks,
-    qty,
-    order_id,
-    _key AS symbol,
-    toDate(_timestamp) AS date
-FROM exchange_events_kafka;
+    reinterpretAsUInt8(substring(body, off + 10, 1))  AS side,
+    reinterpretAsInt32(substring(body, off + 11, 4))  AS price_ticks,
+    reinterpretAsUInt32(substring(body, off + 15, 4)) AS qty,
+    reinterpretAsUInt64(substring(body, off + 19, 8)) AS order_id,
+    symbol,
+    date
+FROM (
+    SELECT
+        if(length(payload) = 26, payload, substring(payload, 13)) AS body,
+        _key AS symbol,
+        toDate(_timestamp) AS date
+    FROM exchange_events_kafka
+    WHERE length(payload) = 26
+       OR (startsWith(payload, 'QRKB') AND length(payload) >= 12 AND (length(payload) - 12) % 26 = 0)
+)
+ARRAY JOIN arrayMap(i -> i * 26, range(intDiv(length(body), 26))) AS off;
 
 -- ── Best-bid/offer tracking (trade-implied) ────────────────────────
 -- Execution events reveal the BBO at the moment of the trade:
@@ -66,9 +73,10 @@ CREATE TABLE IF NOT EXISTS current_bbo (
 ) ENGINE = AggregatingMergeTree()
 ORDER BY symbol;
 
+-- Reads the decoded rows, so it sees batched and bare messages alike.
 CREATE MATERIALIZED VIEW IF NOT EXISTS current_bbo_mv TO current_bbo AS
 SELECT
-    _key AS symbol,
+    symbol,
     argMaxState(
         if(type = 5, price_ticks, toInt32(-2147483648)),
         if(type = 5, ts_ns, toUInt64(0))
@@ -77,9 +85,9 @@ SELECT
         if(type = 4, price_ticks, toInt32(2147483647)),
         if(type = 4, ts_ns, toUInt64(0))
     ) AS last_ask
-FROM exchange_events_kafka
+FROM exchange_events
 WHERE type IN (4, 5)
-GROUP BY _key;
+GROUP BY symbol;
 
 CREATE VIEW IF NOT EXISTS v_current_midprice AS
 SELECT
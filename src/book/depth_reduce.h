@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace qrsdp {
+
+/// Sum of n queue depths, widened to 64 bits so deep books cannot overflow.
+/// AVX2 / NEON when the target enables them (e.g. -DQRSDP_NATIVE_ARCH=ON),
+/// otherwise a plain loop. Integer sums are exact, so every path agrees.
+inline uint64_t sumDepths(const uint32_t* d, size_t n) {
+    size_t i = 0;
+    uint64_t total = 0;
+#if defined(__AVX2__)
+    __m256i acc = _mm256_setzero_si256();
+    for (; i + 8 <= n; i += 8) {
+        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(d + i));
+        acc = _mm256_add_epi64(acc, _mm256_cvtepu32_epi64(_mm256_castsi256_si128(v)));
+        acc = _mm256_add_epi64(acc, _mm256_cvtepu32_epi64(_mm256_extracti128_si256(v, 1)));
+    }
+    alignas(32) uint64_t lanes[4];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), acc);
+    total = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+#elif defined(__ARM_NEON)
+    uint64x2_t acc = vdupq_n_u64(0);
+    for (; i + 4 <= n; i += 4) acc = vpadalq_u32(acc, vld1q_u32(d + i));
+    total = vgetq_lane_u64(acc, 0) + vgetq_lane_u64(acc, 1);
+#endif
+    for (; i < n; ++i) total += d[i];
+    return total;
+}
+
+/// Scalar reference for sumDepths (tests and non-SIMD callers).
+inline uint64_t sumDepthsScalar(const uint32_t* d, size_t n) {
+    uint64_t total = 0;
+    for (size_t i = 0; i < n; ++i) total += d[i];
+    return total;
+}
+
+}  // namespace qrsdp
@@ -1,12 +1,27 @@
 #pragma once
 
+#include "book/level_depth_index.h"
 #include "core/records.h"
 #include "rng/irng.h"
 #include <cstddef>
+#include <cstdint>
 
 namespace qrsdp {
 
-/// Order book: state, features, and event application. v1 = counts only (no FIFO).
+/// Read-only contiguous view of one side's depths, best level first.
+/// Valid until the next mutating call on the book. Empty = not supported.
+struct DepthSpan {
+    const uint32_t* data = nullptr;
+    size_t size = 0;
+
+    const uint32_t* begin() const { return data; }
+    const uint32_t* end() const { return data + size; }
+    uint32_t operator[](size_t k) const { return data[k]; }
+    bool empty() const { return size == 0; }
+};
+
+/// Order book: state, features, and event application. MultiLevelBook is counts only;
+/// OrderLevelBook keeps FIFO queues of individual orders.
 class IOrderBook {
 public:
     virtual ~IOrderBook() = default;
@@ -20,8 +35,25 @@ public:
     virtual int32_t askPriceAtLevel(size_t k) const = 0;
     virtual uint32_t bidDepthAtLevel(size_t k) const = 0;
     virtual uint32_t askDepthAtLevel(size_t k) const = 0;
+    /// All numLevels() depths of a side as one span, for vectorised reductions.
+    /// Default: empty (callers fall back to the per-level accessors).
+    virtual DepthSpan bidDepths() const { return DepthSpan{}; }
+    virtual DepthSpan askDepths() const { return DepthSpan{}; }
+    /// Cumulative-depth index of a side over numLevels() levels, current as of the
+    /// last mutating call. Default: nullptr (callers scan the depths instead).
+    virtual const LevelDepthIndex* bidDepthIndex() const { return nullptr; }
+    virtual const LevelDepthIndex* askDepthIndex() const { return nullptr; }
+    /// Levels changed by the most recent apply(). Default: full (no incremental information).
+    virtual BookDelta lastChange() const { return BookDelta{}; }
     /// HLR2014 Model III: optionally reinitialize all queue depths (e.g. from invariant). Default: no-op.
     virtual void reinitialize(IRng& rng, double depth_mean) { (void)rng; (void)depth_mean; }
+    /// Replaces every level with bids[0, numLevels()) and asks[0, numLevels()), best
+    /// first (a BookCheckpoint), keeping seed()'s depth and refill size. Returns false
+    /// if the book cannot be restored. Default: false.
+    virtual bool restore(const Level* bids, const Level* asks) { (void)bids; (void)asks; return false; }
+    /// Id of the resting order hit by the most recent cancel/execute apply().
+    /// Default: 0 (counts-only book; no resting identities).
+    virtual uint64_t restingOrderId() const { return 0; }
 };
 
 }  // namespace qrsdp
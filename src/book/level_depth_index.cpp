@@ -0,0 +1,41 @@
+#include "book/level_depth_index.h"
+
+namespace qrsdp {
+
+void LevelDepthIndex::refresh(const uint32_t* depths, size_t n) {
+    if (valid_ && n == n_) return;
+    n_ = n;
+    tree_.assign(n + 1, 0);
+    total_ = 0;
+    for (size_t i = 1; i <= n; ++i) {
+        tree_[i] += depths[i - 1];
+        total_ += depths[i - 1];
+        const size_t parent = i + (i & (~i + 1));
+        if (parent <= n) tree_[parent] += tree_[i];
+    }
+    top_bit_ = 0;
+    if (n > 0) {
+        top_bit_ = 1;
+        while (top_bit_ * 2 <= n) top_bit_ *= 2;
+    }
+    valid_ = true;
+}
+
+size_t LevelDepthIndex::find(double u) const {
+    if (n_ == 0) return 0;
+    const double total = static_cast<double>(total_);
+    size_t pos = 0;
+    uint64_t prefix = 0;
+    // Prefix ratios are nondecreasing, so descending on "ratio <= u" lands on the
+    // first level whose ratio exceeds u.
+    for (size_t step = top_bit_; step > 0; step >>= 1) {
+        const size_t next = pos + step;
+        if (next <= n_ && static_cast<double>(prefix + tree_[next]) / total <= u) {
+            pos = next;
+            prefix += tree_[next];
+        }
+    }
+    return pos < n_ ? pos : n_ - 1;
+}
+
+}  // namespace qrsdp
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace qrsdp {
+
+/// Fenwick tree over one side's queue depths, indexed by level (best first).
+///
+/// Books keep it current with update() on single-level changes and invalidate() when
+/// levels move (shift, improvement, reseed, reinitialisation); the next refresh()
+/// rebuilds it. Until a consumer first refreshes it an index stays invalid, so books
+/// whose callers never query it only pay one branch per depth change.
+class LevelDepthIndex {
+public:
+    void invalidate() { valid_ = false; }
+    bool valid() const { return valid_; }
+
+    /// Level k's depth changed from old_depth to new_depth.
+    void update(size_t k, uint32_t old_depth, uint32_t new_depth) {
+        if (!valid_ || k >= n_) return;
+        const uint64_t delta = static_cast<uint64_t>(new_depth) - static_cast<uint64_t>(old_depth);
+        total_ += delta;  // modular: a decrease wraps back exactly
+        for (size_t j = k + 1; j <= n_; j += j & (~j + 1)) tree_[j] += delta;
+    }
+
+    /// Rebuilds from depths[0, n) if invalidated since the last refresh.
+    void refresh(const uint32_t* depths, size_t n);
+
+    size_t size() const { return n_; }
+    uint64_t total() const { return total_; }
+
+    /// Smallest level k with u < prefix(k) / total(), i.e. the level a linear
+    /// cumulative-depth scan would pick for u, evaluated with the same double
+    /// arithmetic so both agree bit for bit. size() - 1 if rounding runs off the end.
+    size_t find(double u) const;
+
+private:
+    std::vector<uint64_t> tree_;  // 1-based partial sums; tree_[0] unused
+    size_t n_ = 0;
+    size_t top_bit_ = 0;          // highest power of two <= n_
+    uint64_t total_ = 0;
+    bool valid_ = false;
+};
+
+}  // namespace qrsdp
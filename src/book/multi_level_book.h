@@ -1,46 +1,430 @@
 #pragma once
 
 #include "book/i_order_book.h"
+#include "book/level_depth_index.h"
 #include "rng/irng.h"
+#include "rng/poisson_sampler.h"
 #include "core/records.h"
+#include <algorithm>
 #include <array>
 #include <cstddef>
+#include <cstdio>
+#include <stdexcept>
+#include <vector>
 
 namespace qrsdp {
 
-constexpr size_t kMaxLevels = 64;
+/// BasicMultiLevelBook<kDynamicLevels>: depth chosen at seed() time, unbounded.
+constexpr size_t kDynamicLevels = 0;
+
+namespace detail {
+
+/// Smallest power of two >= levels (at least 1).
+constexpr size_t ringSizeFor(size_t levels) {
+    size_t r = 1;
+    while (r < levels) r <<= 1;
+    return r;
+}
+
+/// Ring storage for one side: fixed arrays sized for N levels.
+template <size_t N>
+struct LadderStorage {
+    static constexpr size_t kRingSize = ringSizeFor(N);
+    alignas(64) std::array<uint32_t, 2 * kRingSize> depths{};
+    std::array<int32_t, kRingSize> prices{};
+    static constexpr size_t mask() { return kRingSize - 1; }
+    void reset(size_t) {}
+};
+
+/// Ring storage for one side: heap arrays sized at seed() time.
+template <>
+struct LadderStorage<kDynamicLevels> {
+    std::vector<uint32_t> depths;
+    std::vector<int32_t> prices;
+    size_t mask_ = 0;
+    size_t mask() const { return mask_; }
+    void reset(size_t levels) {
+        const size_t ring = ringSizeFor(levels);
+        depths.assign(2 * ring, 0);
+        prices.assign(ring, 0);
+        mask_ = ring - 1;
+    }
+};
+
+}  // namespace detail
 
 /// Counts-only order book: L levels per side, no FIFO. Satisfies bid < ask, spread >= 1.
-class MultiLevelBook : public IOrderBook {
+///
+/// N > 0 fixes the depth at compile time (seed() requires levels_per_side == N), so
+/// per-level loops have constant trip counts and small books unroll fully.
+/// N == kDynamicLevels sizes the book from BookSeed::levels_per_side, with no cap.
+/// Both behave identically for the same seed and events.
+template <size_t N>
+class BasicMultiLevelBook final : public IOrderBook {
 public:
+    static constexpr bool kFixedDepth = (N != kDynamicLevels);
+
     void seed(const BookSeed&) override;
     BookFeatures features() const override;
     void apply(const SimEvent&) override;
     Level bestBid() const override;
     Level bestAsk() const override;
-    size_t numLevels() const override;
+    size_t numLevels() const override { return levels(); }
     int32_t bidPriceAtLevel(size_t k) const override;
     int32_t askPriceAtLevel(size_t k) const override;
     uint32_t bidDepthAtLevel(size_t k) const override;
     uint32_t askDepthAtLevel(size_t k) const override;
     void reinitialize(IRng& rng, double depth_mean) override;
+    bool restore(const Level* bids, const Level* asks) override;
+    BookDelta lastChange() const override { return last_change_; }
+    DepthSpan bidDepths() const override { return DepthSpan{bid_.depthData(), levels()}; }
+    DepthSpan askDepths() const override { return DepthSpan{ask_.depthData(), levels()}; }
+    const LevelDepthIndex* bidDepthIndex() const override { return bid_.refreshedIndex(levels()); }
+    const LevelDepthIndex* askDepthIndex() const override { return ask_.refreshedIndex(levels()); }
+
+    /// O(1) level of a price by its tick offset from the best (-1 outside
+    /// [0, numLevels)): the index apply() uses. Exact while the side has no gaps;
+    /// after an improvement leaves one, the level found may hold another price.
+    int bidIndexForPrice(int32_t price_ticks) const;
+    int askIndexForPrice(int32_t price_ticks) const;
 
 private:
-    struct LevelSlot {
-        int32_t  price_ticks;
-        uint32_t depth;
+    /// Each side is a ring: level k lives at slot (head + k) & mask, so a shift
+    /// (best level consumed) or an improvement (new best inside the spread) moves the
+    /// head instead of copying the ladder. Slots keep their own price because an
+    /// improvement may leave a gap behind the new best.
+    ///
+    /// Depths are structure-of-arrays and mirrored (slot s is also stored at
+    /// s + ring size), so levels [0, numLevels) are always one contiguous span.
+    /// The level index follows setDepth() and is invalidated whenever the head moves.
+    struct Ladder : detail::LadderStorage<N> {
+        size_t head = 0;
+        mutable LevelDepthIndex index;
+
+        size_t ring() const { return this->mask() + 1; }
+        size_t slot(size_t k) const { return (head + k) & this->mask(); }
+        uint32_t depth(size_t k) const { return this->depths[head + k]; }
+        void setDepth(size_t k, uint32_t d) {
+            const size_t s = slot(k);
+            index.update(k, this->depths[s], d);
+            this->depths[s] = d;
+            this->depths[s + ring()] = d;
+        }
+        int32_t price(size_t k) const { return this->prices[slot(k)]; }
+        void setLevel(size_t k, int32_t price_ticks, uint32_t d) {
+            this->prices[slot(k)] = price_ticks;
+            setDepth(k, d);
+        }
+        void advance() {
+            head = (head + 1) & this->mask();
+            index.invalidate();
+        }
+        void retreat() {
+            head = (head + this->mask()) & this->mask();
+            index.invalidate();
+        }
+        const uint32_t* depthData() const { return this->depths.data() + head; }
+        const LevelDepthIndex* refreshedIndex(size_t n) const {
+            index.refresh(depthData(), n);
+            return &index;
+        }
     };
-    std::array<LevelSlot, kMaxLevels> bid_levels_{};
-    std::array<LevelSlot, kMaxLevels> ask_levels_{};
-    size_t num_levels_ = 0;
+
+    size_t levels() const { return kFixedDepth ? N : num_levels_; }
+
+    Ladder bid_;
+    Ladder ask_;
+    size_t num_levels_ = kFixedDepth ? N : 0;
     uint32_t initial_depth_ = 50;
+    BookDelta last_change_{};
+    PoissonSampler poisson_;  // reinitialize() draws; table cached per depth mean
 
+    void touch(Side side, int idx);
     void shiftBidBook();
     void shiftAskBook();
     void improveBid(int32_t price, uint32_t qty);
     void improveAsk(int32_t price, uint32_t qty);
-    int bidIndexForPrice(int32_t price_ticks) const;
-    int askIndexForPrice(int32_t price_ticks) const;
 };
 
+/// Runtime-depth book used by default.
+using MultiLevelBook = BasicMultiLevelBook<kDynamicLevels>;
+
+/// Compile-time-depth book; SessionRunner picks one of kFixedBookDepths when
+/// levels_per_side matches and falls back to MultiLevelBook otherwise.
+template <size_t N>
+using MultiLevelBookN = BasicMultiLevelBook<N>;
+
+// ---------------------------------------------------------------------------
+
+template <size_t N>
+void BasicMultiLevelBook<N>::seed(const BookSeed& s) {
+    if (kFixedDepth) {
+        if (s.levels_per_side != N)
+            throw std::invalid_argument("MultiLevelBookN: levels_per_side does not match N");
+    } else {
+        num_levels_ = s.levels_per_side > 0 ? s.levels_per_side : 1;
+        bid_.reset(num_levels_);
+        ask_.reset(num_levels_);
+    }
+    initial_depth_ = s.initial_depth > 0 ? s.initial_depth : 50u;
+    const uint32_t spread = s.initial_spread_ticks > 0 ? s.initial_spread_ticks : 2u;
+    const int half = static_cast<int>(spread / 2);
+
+    const int32_t best_bid = s.p0_ticks - half;
+    const int32_t best_ask = s.p0_ticks + static_cast<int>(spread) - half;
+
+    bid_.head = 0;
+    ask_.head = 0;
+    bid_.index.invalidate();
+    ask_.index.invalidate();
+    for (size_t k = 0; k < levels(); ++k) {
+        bid_.setLevel(k, static_cast<int32_t>(best_bid - static_cast<int>(k)), initial_depth_);
+        ask_.setLevel(k, static_cast<int32_t>(best_ask + static_cast<int>(k)), initial_depth_);
+    }
+    last_change_ = BookDelta{};
+}
+
+template <size_t N>
+BookFeatures BasicMultiLevelBook<N>::features() const {
+    constexpr double kImbalanceEps = 1e-9;
+    if (levels() == 0) {
+        return BookFeatures{0, 0, 0, 0, 0, 0.0};
+    }
+    const int32_t best_bid = bid_.price(0);
+    const int32_t best_ask = ask_.price(0);
+    const uint32_t q_bid = bid_.depth(0);
+    const uint32_t q_ask = ask_.depth(0);
+    const int spread = best_ask - best_bid;
+    const double sum = static_cast<double>(q_bid) + static_cast<double>(q_ask) + kImbalanceEps;
+    const double imbalance = (static_cast<double>(q_bid) - static_cast<double>(q_ask)) / sum;
+    return BookFeatures{best_bid, best_ask, q_bid, q_ask, spread, imbalance};
+}
+
+template <size_t N>
+void BasicMultiLevelBook<N>::apply(const SimEvent& e) {
+    last_change_ = BookDelta{false, Side::NA, 0};
+    const size_t n = levels();
+    switch (e.type) {
+        case EventType::ADD_BID: {
+            const int32_t best_bid = bid_.price(0);
+            const int32_t best_ask = ask_.price(0);
+            if (e.price_ticks > best_bid && e.price_ticks < best_ask) {
+                improveBid(e.price_ticks, e.qty);
+            } else {
+                const int idx = bidIndexForPrice(e.price_ticks);
+                if (idx >= 0 && static_cast<size_t>(idx) < n) {
+                    const size_t k = static_cast<size_t>(idx);
+                    bid_.setDepth(k, bid_.depth(k) + e.qty);
+                    touch(Side::BID, idx);
+                }
+            }
+            break;
+        }
+        case EventType::ADD_ASK: {
+            const int32_t best_bid = bid_.price(0);
+            const int32_t best_ask = ask_.price(0);
+            if (e.price_ticks < best_ask && e.price_ticks > best_bid) {
+                improveAsk(e.price_ticks, e.qty);
+            } else {
+                const int idx = askIndexForPrice(e.price_ticks);
+                if (idx >= 0 && static_cast<size_t>(idx) < n) {
+                    const size_t k = static_cast<size_t>(idx);
+                    ask_.setDepth(k, ask_.depth(k) + e.qty);
+                    touch(Side::ASK, idx);
+                }
+            }
+            break;
+        }
+        case EventType::CANCEL_BID: {
+            const int idx = bidIndexForPrice(e.price_ticks);
+            if (idx >= 0 && static_cast<size_t>(idx) < n) {
+                const size_t k = static_cast<size_t>(idx);
+                const uint32_t d = bid_.depth(k);
+                bid_.setDepth(k, d >= e.qty ? d - e.qty : 0);
+                touch(Side::BID, idx);
+                if (idx == 0 && bid_.depth(0) == 0 && d > 0) shiftBidBook();
+            }
+            break;
+        }
+        case EventType::CANCEL_ASK: {
+            const int idx = askIndexForPrice(e.price_ticks);
+            if (idx >= 0 && static_cast<size_t>(idx) < n) {
+                const size_t k = static_cast<size_t>(idx);
+                const uint32_t d = ask_.depth(k);
+                ask_.setDepth(k, d >= e.qty ? d - e.qty : 0);
+                touch(Side::ASK, idx);
+                if (idx == 0 && ask_.depth(0) == 0 && d > 0) shiftAskBook();
+            }
+            break;
+        }
+        case EventType::EXECUTE_BUY: {
+            if (n > 0) {
+                const int32_t best_ask = ask_.price(0);
+                if (e.price_ticks != best_ask) {
+                    std::fprintf(stderr, "QRSDP: EXECUTE_BUY target price %d != best ask %d (not k=0)\n",
+                                 e.price_ticks, best_ask);
+                }
+                if (ask_.depth(0) > 0) {
+                    ask_.setDepth(0, ask_.depth(0) - 1);
+                    touch(Side::ASK, 0);
+                    if (ask_.depth(0) == 0) shiftAskBook();
+                }
+            }
+            break;
+        }
+        case EventType::EXECUTE_SELL: {
+            if (n > 0) {
+                const int32_t best_bid = bid_.price(0);
+                if (e.price_ticks != best_bid) {
+                    std::fprintf(stderr, "QRSDP: EXECUTE_SELL target price %d != best bid %d (not k=0)\n",
+                                 e.price_ticks, best_bid);
+                }
+                if (bid_.depth(0) > 0) {
+                    bid_.setDepth(0, bid_.depth(0) - 1);
+                    touch(Side::BID, 0);
+                    if (bid_.depth(0) == 0) shiftBidBook();
+                }
+            }
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+template <size_t N>
+Level BasicMultiLevelBook<N>::bestBid() const {
+    if (levels() == 0) return Level{0, 0};
+    return Level{bid_.price(0), bid_.depth(0)};
+}
+
+template <size_t N>
+Level BasicMultiLevelBook<N>::bestAsk() const {
+    if (levels() == 0) return Level{0, 0};
+    return Level{ask_.price(0), ask_.depth(0)};
+}
+
+template <size_t N>
+int32_t BasicMultiLevelBook<N>::bidPriceAtLevel(size_t k) const {
+    if (levels() == 0) return 0;
+    if (k >= levels()) return bid_.price(levels() - 1);
+    return bid_.price(k);
+}
+
+template <size_t N>
+int32_t BasicMultiLevelBook<N>::askPriceAtLevel(size_t k) const {
+    if (levels() == 0) return 0;
+    if (k >= levels()) return ask_.price(levels() - 1);
+    return ask_.price(k);
+}
+
+template <size_t N>
+uint32_t BasicMultiLevelBook<N>::bidDepthAtLevel(size_t k) const {
+    if (k >= levels()) return 0;
+    return bid_.depth(k);
+}
+
+template <size_t N>
+uint32_t BasicMultiLevelBook<N>::askDepthAtLevel(size_t k) const {
+    if (k >= levels()) return 0;
+    return ask_.depth(k);
+}
+
+template <size_t N>
+void BasicMultiLevelBook<N>::touch(Side side, int idx) {
+    last_change_.side = side;
+    last_change_.level = static_cast<uint32_t>(idx);
+}
+
+template <size_t N>
+void BasicMultiLevelBook<N>::shiftBidBook() {
+    last_change_.full = true;
+    constexpr size_t kMaxCascade = 64;
+    for (size_t cascade = 0; cascade < kMaxCascade; ++cascade) {
+        // Drop the best level; the freed slot becomes the new deepest level.
+        const int32_t deepest = bid_.price(levels() - 1);
+        bid_.advance();
+        bid_.setLevel(levels() - 1, deepest - 1, initial_depth_);
+        if (bid_.depth(0) > 0) break;
+    }
+}
+
+template <size_t N>
+void BasicMultiLevelBook<N>::shiftAskBook() {
+    last_change_.full = true;
+    constexpr size_t kMaxCascade = 64;
+    for (size_t cascade = 0; cascade < kMaxCascade; ++cascade) {
+        const int32_t deepest = ask_.price(levels() - 1);
+        ask_.advance();
+        ask_.setLevel(levels() - 1, deepest + 1, initial_depth_);
+        if (ask_.depth(0) > 0) break;
+    }
+}
+
+template <size_t N>
+void BasicMultiLevelBook<N>::improveBid(int32_t price, uint32_t qty) {
+    last_change_.full = true;
+    // New best in front of the head; the deepest level falls off the window.
+    bid_.retreat();
+    bid_.setLevel(0, price, qty);
+}
+
+template <size_t N>
+void BasicMultiLevelBook<N>::improveAsk(int32_t price, uint32_t qty) {
+    last_change_.full = true;
+    ask_.retreat();
+    ask_.setLevel(0, price, qty);
+}
+
+template <size_t N>
+void BasicMultiLevelBook<N>::reinitialize(IRng& rng, double depth_mean) {
+    const double mu = depth_mean > 0.0 ? depth_mean : static_cast<double>(initial_depth_);
+    poisson_.setMean(mu);
+    bid_.index.invalidate();
+    ask_.index.invalidate();
+    for (size_t k = 0; k < levels(); ++k) {
+        bid_.setDepth(k, poisson_.sample(rng));
+        ask_.setDepth(k, poisson_.sample(rng));
+    }
+    last_change_ = BookDelta{};
+}
+
+template <size_t N>
+bool BasicMultiLevelBook<N>::restore(const Level* bids, const Level* asks) {
+    bid_.head = 0;
+    ask_.head = 0;
+    bid_.index.invalidate();
+    ask_.index.invalidate();
+    for (size_t k = 0; k < levels(); ++k) {
+        bid_.setLevel(k, bids[k].price_ticks, bids[k].depth);
+        ask_.setLevel(k, asks[k].price_ticks, asks[k].depth);
+    }
+    last_change_ = BookDelta{};
+    return true;
+}
+
+template <size_t N>
+int BasicMultiLevelBook<N>::bidIndexForPrice(int32_t price_ticks) const {
+    if (levels() == 0) return -1;
+    const int32_t best = bid_.price(0);
+    const int idx = best - price_ticks;
+    if (idx < 0 || static_cast<size_t>(idx) >= levels()) return -1;
+    return idx;
+}
+
+template <size_t N>
+int BasicMultiLevelBook<N>::askIndexForPrice(int32_t price_ticks) const {
+    if (levels() == 0) return -1;
+    const int32_t best = ask_.price(0);
+    const int idx = price_ticks - best;
+    if (idx < 0 || static_cast<size_t>(idx) >= levels()) return -1;
+    return idx;
+}
+
+// Common instantiations live in multi_level_book.cpp.
+extern template class BasicMultiLevelBook<kDynamicLevels>;
+extern template class BasicMultiLevelBook<5>;
+extern template class BasicMultiLevelBook<10>;
+extern template class BasicMultiLevelBook<20>;
+
 }  // namespace qrsdp
@@ -0,0 +1,373 @@
+#include "book/order_level_book.h"
+#include "book/multi_level_book.h"
+#include <algorithm>
+#include <cstdio>
+
+namespace qrsdp {
+
+namespace {
+constexpr double kImbalanceEps = 1e-9;
+constexpr size_t kMaxCascade = 64;
+}  // namespace
+
+void OrderLevelBook::Ladder::reset(size_t levels) {
+    const size_t r = detail::ringSizeFor(levels);
+    depths.assign(2 * r, 0);
+    prices.assign(r, 0);
+    first.assign(r, kNilOrder);
+    last.assign(r, kNilOrder);
+    head = 0;
+    mask = r - 1;
+    index.invalidate();
+}
+
+void OrderLevelBook::seed(const BookSeed& s) {
+    num_levels_ = s.levels_per_side > 0 ? s.levels_per_side : 1;
+    initial_depth_ = s.initial_depth > 0 ? s.initial_depth : 50u;
+    const uint32_t spread = s.initial_spread_ticks > 0 ? s.initial_spread_ticks : 2u;
+    const int half = static_cast<int>(spread / 2);
+
+    const int32_t best_bid = s.p0_ticks - half;
+    const int32_t best_ask = s.p0_ticks + static_cast<int>(spread) - half;
+
+    pool_.clear();
+    index_.clear();
+    pool_.reserve(2 * num_levels_ * initial_depth_);
+    bid_.reset(num_levels_);
+    ask_.reset(num_levels_);
+    next_background_id_ = kBackgroundOrderIdBase;
+    for (size_t k = 0; k < num_levels_; ++k) {
+        fillLevel(bid_, k, static_cast<int32_t>(best_bid - static_cast<int>(k)), initial_depth_);
+        fillLevel(ask_, k, static_cast<int32_t>(best_ask + static_cast<int>(k)), initial_depth_);
+    }
+    resting_order_id_ = 0;
+    last_change_ = BookDelta{};
+}
+
+bool OrderLevelBook::restore(const Level* bids, const Level* asks) {
+    pool_.clear();
+    index_.clear();
+    bid_.reset(num_levels_);
+    ask_.reset(num_levels_);
+    next_background_id_ = kBackgroundOrderIdBase;
+    for (size_t k = 0; k < num_levels_; ++k) {
+        fillLevel(bid_, k, bids[k].price_ticks, bids[k].depth);
+        fillLevel(ask_, k, asks[k].price_ticks, asks[k].depth);
+    }
+    resting_order_id_ = 0;
+    last_change_ = BookDelta{};
+    return true;
+}
+
+BookFeatures OrderLevelBook::features() const {
+    if (num_levels_ == 0) {
+        return BookFeatures{0, 0, 0, 0, 0, 0.0};
+    }
+    const int32_t best_bid = bid_.price(0);
+    const int32_t best_ask = ask_.price(0);
+    const uint32_t q_bid = bid_.depth(0);
+    const uint32_t q_ask = ask_.depth(0);
+    const int spread = best_ask - best_bid;
+    const double sum = static_cast<double>(q_bid) + static_cast<double>(q_ask) + kImbalanceEps;
+    const double imbalance = (static_cast<double>(q_bid) - static_cast<double>(q_ask)) / sum;
+    return BookFeatures{best_bid, best_ask, q_bid, q_ask, spread, imbalance};
+}
+
+void OrderLevelBook::journal(const Ladder& side, bool add, uint64_t order_id, int32_t price, uint32_t qty) {
+    const bool bid = &side == &bid_;
+    EventRecord rec{};
+    rec.order_id = order_id;
+    rec.price_ticks = price;
+    rec.qty = qty;
+    rec.type = static_cast<uint8_t>(add ? (bid ? EventType::ADD_BID : EventType::ADD_ASK)
+                                        : (bid ? EventType::CANCEL_BID : EventType::CANCEL_ASK));
+    rec.side = static_cast<uint8_t>(bid ? Side::BID : Side::ASK);
+    journal_->push_back(rec);
+}
+
+void OrderLevelBook::pushBack(Ladder& side, size_t k, uint64_t order_id, uint32_t qty) {
+    const size_t s = side.slot(k);
+    const uint32_t idx = pool_.acquire(order_id, qty);
+    pool_[idx].prev = side.last[s];
+    if (side.last[s] != kNilOrder) pool_[side.last[s]].next = idx;
+    else side.first[s] = idx;
+    side.last[s] = idx;
+    index_.insert(order_id, idx);
+}
+
+void OrderLevelBook::unlink(Ladder& side, size_t k, uint32_t idx) {
+    const size_t s = side.slot(k);
+    const OrderNode& n = pool_[idx];
+    if (n.prev != kNilOrder) pool_[n.prev].next = n.next;
+    else side.first[s] = n.next;
+    if (n.next != kNilOrder) pool_[n.next].prev = n.prev;
+    else side.last[s] = n.prev;
+    index_.erase(n.order_id);
+    pool_.release(idx);
+}
+
+void OrderLevelBook::clearLevel(Ladder& side, size_t k) {
+    const size_t s = side.slot(k);
+    for (uint32_t idx = side.first[s]; idx != kNilOrder;) {
+        const uint32_t next = pool_[idx].next;
+        if (journal_) journal(side, false, pool_[idx].order_id, side.price(k), pool_[idx].qty);
+        index_.erase(pool_[idx].order_id);
+        pool_.release(idx);
+        idx = next;
+    }
+    side.first[s] = kNilOrder;
+    side.last[s] = kNilOrder;
+    side.setDepth(k, 0);
+}
+
+void OrderLevelBook::fillLevel(Ladder& side, size_t k, int32_t price, uint32_t depth) {
+    clearLevel(side, k);
+    side.prices[side.slot(k)] = price;
+    for (uint32_t i = 0; i < depth; ++i) {
+        if (journal_) journal(side, true, next_background_id_, price, 1);
+        pushBack(side, k, next_background_id_++, 1);
+    }
+    side.setDepth(k, depth);
+}
+
+void OrderLevelBook::cancelFromBack(Ladder& side, size_t k, uint32_t qty, bool reported) {
+    const size_t s = side.slot(k);
+    const uint64_t newest = side.last[s] != kNilOrder ? pool_[side.last[s]].order_id : 0;
+    if (reported) resting_order_id_ = newest;
+    uint32_t removed = 0;
+    while (removed < qty && side.last[s] != kNilOrder) {
+        const uint32_t idx = side.last[s];
+        const uint32_t take = std::min(qty - removed, pool_[idx].qty);
+        pool_[idx].qty -= take;
+        removed += take;
+        if (pool_[idx].qty == 0) {
+            if (journal_ && !(reported && pool_[idx].order_id == newest))
+                journal(side, false, pool_[idx].order_id, side.price(k), take);
+            unlink(side, k, idx);
+        }
+    }
+    side.setDepth(k, side.depth(k) - removed);
+}
+
+void OrderLevelBook::executeFront(Ladder& side) {
+    const size_t s = side.slot(0);
+    const uint32_t idx = side.first[s];
+    if (idx == kNilOrder) return;
+    resting_order_id_ = pool_[idx].order_id;
+    if (--pool_[idx].qty == 0) unlink(side, 0, idx);
+    side.setDepth(0, side.depth(0) - 1);
+}
+
+void OrderLevelBook::resizeLevel(Ladder& side, size_t k, uint32_t depth) {
+    const uint32_t d = side.depth(k);
+    if (depth < d) {
+        cancelFromBack(side, k, d - depth, false);
+    } else {
+        for (uint32_t i = d; i < depth; ++i) {
+            if (journal_) journal(side, true, next_background_id_, side.price(k), 1);
+            pushBack(side, k, next_background_id_++, 1);
+        }
+        side.setDepth(k, depth);
+    }
+}
+
+void OrderLevelBook::apply(const SimEvent& e) {
+    last_change_ = BookDelta{false, Side::NA, 0};
+    resting_order_id_ = 0;
+    switch (e.type) {
+        case EventType::ADD_BID: {
+            const int32_t best_bid = bid_.price(0);
+            const int32_t best_ask = ask_.price(0);
+            if (e.price_ticks > best_bid && e.price_ticks < best_ask) {
+                improve(bid_, e.price_ticks, e.order_id, e.qty);
+            } else {
+                const int idx = bidIndexForPrice(e.price_ticks);
+                if (idx >= 0 && static_cast<size_t>(idx) < num_levels_) {
+                    const size_t k = static_cast<size_t>(idx);
+                    pushBack(bid_, k, e.order_id, e.qty);
+                    bid_.setDepth(k, bid_.depth(k) + e.qty);
+                    touch(Side::BID, idx);
+                } else if (journal_) {
+                    journal(bid_, false, e.order_id, e.price_ticks, e.qty);  // never rests
+                }
+            }
+            break;
+        }
+        case EventType::ADD_ASK: {
+            const int32_t best_bid = bid_.price(0);
+            const int32_t best_ask = ask_.price(0);
+            if (e.price_ticks < best_ask && e.price_ticks > best_bid) {
+                improve(ask_, e.price_ticks, e.order_id, e.qty);
+            } else {
+                const int idx = askIndexForPrice(e.price_ticks);
+                if (idx >= 0 && static_cast<size_t>(idx) < num_levels_) {
+                    const size_t k = static_cast<size_t>(idx);
+                    pushBack(ask_, k, e.order_id, e.qty);
+                    ask_.setDepth(k, ask_.depth(k) + e.qty);
+                    touch(Side::ASK, idx);
+                } else if (journal_) {
+                    journal(ask_, false, e.order_id, e.price_ticks, e.qty);  // never rests
+                }
+            }
+            break;
+        }
+        case EventType::CANCEL_BID: {
+            const int idx = bidIndexForPrice(e.price_ticks);
+            if (idx >= 0 && static_cast<size_t>(idx) < num_levels_) {
+                const uint32_t d = bid_.depth(static_cast<size_t>(idx));
+                cancelFromBack(bid_, static_cast<size_t>(idx), e.qty, true);
+                touch(Side::BID, idx);
+                if (idx == 0 && bid_.depth(0) == 0 && d > 0) shift(bid_, -1);
+            }
+            break;
+        }
+        case EventType::CANCEL_ASK: {
+            const int idx = askIndexForPrice(e.price_ticks);
+            if (idx >= 0 && static_cast<size_t>(idx) < num_levels_) {
+                const uint32_t d = ask_.depth(static_cast<size_t>(idx));
+                cancelFromBack(ask_, static_cast<size_t>(idx), e.qty, true);
+                touch(Side::ASK, idx);
+                if (idx == 0 && ask_.depth(0) == 0 && d > 0) shift(ask_, +1);
+            }
+            break;
+        }
+        case EventType::EXECUTE_BUY: {
+            if (num_levels_ > 0) {
+                const int32_t best_ask = ask_.price(0);
+                if (e.price_ticks != best_ask) {
+                    std::fprintf(stderr, "QRSDP: EXECUTE_BUY target price %d != best ask %d (not k=0)\n",
+                                 e.price_ticks, best_ask);
+                }
+                if (ask_.depth(0) > 0) {
+                    executeFront(ask_);
+                    touch(Side::ASK, 0);
+                    if (ask_.depth(0) == 0) shift(ask_, +1);
+                }
+            }
+            break;
+        }
+        case EventType::EXECUTE_SELL: {
+            if (num_levels_ > 0) {
+                const int32_t best_bid = bid_.price(0);
+                if (e.price_ticks != best_bid) {
+                    std::fprintf(stderr, "QRSDP: EXECUTE_SELL target price %d != best bid %d (not k=0)\n",
+                                 e.price_ticks, best_bid);
+                }
+                if (bid_.depth(0) > 0) {
+                    executeFront(bid_);
+                    touch(Side::BID, 0);
+                    if (bid_.depth(0) == 0) shift(bid_, -1);
+                }
+            }
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+Level OrderLevelBook::bestBid() const {
+    if (num_levels_ == 0) return Level{0, 0};
+    return Level{bid_.price(0), bid_.depth(0)};
+}
+
+Level OrderLevelBook::bestAsk() const {
+    if (num_levels_ == 0) return Level{0, 0};
+    return Level{ask_.price(0), ask_.depth(0)};
+}
+
+int32_t OrderLevelBook::bidPriceAtLevel(size_t k) const {
+    if (num_levels_ == 0) return 0;
+    if (k >= num_levels_) return bid_.price(num_levels_ - 1);
+    return bid_.price(k);
+}
+
+int32_t OrderLevelBook::askPriceAtLevel(size_t k) const {
+    if (num_levels_ == 0) return 0;
+    if (k >= num_levels_) return ask_.price(num_levels_ - 1);
+    return ask_.price(k);
+}
+
+uint32_t OrderLevelBook::bidDepthAtLevel(size_t k) const {
+    if (k >= num_levels_) return 0;
+    return bid_.depth(k);
+}
+
+uint32_t OrderLevelBook::askDepthAtLevel(size_t k) const {
+    if (k >= num_levels_) return 0;
+    return ask_.depth(k);
+}
+
+uint32_t OrderLevelBook::orderQty(uint64_t order_id) const {
+    const uint32_t idx = index_.find(order_id);
+    return idx == kNilOrder ? 0 : pool_[idx].qty;
+}
+
+std::vector<uint64_t> OrderLevelBook::queueAtLevel(Side side, size_t k) const {
+    std::vector<uint64_t> out;
+    if (k >= num_levels_) return out;
+    const Ladder& l = (side == Side::BID) ? bid_ : ask_;
+    for (uint32_t idx = l.first[l.slot(k)]; idx != kNilOrder; idx = pool_[idx].next)
+        out.push_back(pool_[idx].order_id);
+    return out;
+}
+
+void OrderLevelBook::touch(Side side, int idx) {
+    last_change_.side = side;
+    last_change_.level = static_cast<uint32_t>(idx);
+}
+
+void OrderLevelBook::shift(Ladder& side, int32_t step) {
+    last_change_.full = true;
+    for (size_t cascade = 0; cascade < kMaxCascade; ++cascade) {
+        // Drop the (empty) best level; its slot's queue is already clear.
+        const int32_t deepest = side.price(num_levels_ - 1);
+        clearLevel(side, 0);
+        side.advance();
+        fillLevel(side, num_levels_ - 1, deepest + step, initial_depth_);
+        if (side.depth(0) > 0) break;
+    }
+}
+
+void OrderLevelBook::improve(Ladder& side, int32_t price, uint64_t order_id, uint32_t qty) {
+    last_change_.full = true;
+    // New best in front of the head; the deepest level's orders leave the window.
+    side.retreat();
+    clearLevel(side, num_levels_);
+    clearLevel(side, 0);
+    side.prices[side.slot(0)] = price;
+    pushBack(side, 0, order_id, qty);
+    side.setDepth(0, qty);
+}
+
+void OrderLevelBook::reinitialize(IRng& rng, double depth_mean) {
+    const double mu = depth_mean > 0.0 ? depth_mean : static_cast<double>(initial_depth_);
+    poisson_.setMean(mu);
+    bid_.index.invalidate();
+    ask_.index.invalidate();
+    for (size_t k = 0; k < num_levels_; ++k) {
+        resizeLevel(bid_, k, poisson_.sample(rng));
+        resizeLevel(ask_, k, poisson_.sample(rng));
+    }
+    // resting_order_id_ stays: the producer reinitialises after the apply() whose
+    // record still has to name the order that apply hit.
+    last_change_ = BookDelta{};
+}
+
+int OrderLevelBook::bidIndexForPrice(int32_t price_ticks) const {
+    if (num_levels_ == 0) return -1;
+    const int32_t best = bid_.price(0);
+    const int idx = best - price_ticks;
+    if (idx < 0 || static_cast<size_t>(idx) >= num_levels_) return -1;
+    return idx;
+}
+
+int OrderLevelBook::askIndexForPrice(int32_t price_ticks) const {
+    if (num_levels_ == 0) return -1;
+    const int32_t best = ask_.price(0);
+    const int idx = price_ticks - best;
+    if (idx < 0 || static_cast<size_t>(idx) >= num_levels_) return -1;
+    return idx;
+}
+
+}  // namespace qrsdp
@@ -0,0 +1,147 @@
+#pragma once
+
+#include "book/i_order_book.h"
+#include "book/level_depth_index.h"
+#include "book/order_pool.h"
+#include "rng/irng.h"
+#include "rng/poisson_sampler.h"
+#include "core/records.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace qrsdp {
+
+/// Order ids at or above this value belong to background liquidity the book
+/// creates itself (seed depth, refilled levels after a shift, reinitialised
+/// depths). They never appear in an ADD record; the ITCH feeds announce them
+/// (itch::OrderBookAnnouncer).
+constexpr uint64_t kBackgroundOrderIdBase = 1ULL << 63;
+
+/// Order-level book: the same L-level ladder and price dynamics as MultiLevelBook
+/// (identical features, depths and lastChange() for the same events), but every
+/// level is a FIFO queue of real orders.
+///  - ADD appends an order with the event's order_id (an improvement opens a new level).
+///  - EXECUTE fills the oldest order at the best level (price-time priority).
+///  - CANCEL removes quantity from the newest order at the level.
+/// restingOrderId() reports the order each cancel/execute hit, so the producer can
+/// emit OrderDelete/OrderExecuted against ids that were actually added.
+///
+/// Nodes come from an OrderPool slab and are indexed by an open-addressing
+/// order_id map; once the pool has grown to the working set, apply() does not allocate.
+class OrderLevelBook final : public IOrderBook {
+public:
+    void seed(const BookSeed&) override;
+    BookFeatures features() const override;
+    void apply(const SimEvent&) override;
+    Level bestBid() const override;
+    Level bestAsk() const override;
+    size_t numLevels() const override { return num_levels_; }
+    int32_t bidPriceAtLevel(size_t k) const override;
+    int32_t askPriceAtLevel(size_t k) const override;
+    uint32_t bidDepthAtLevel(size_t k) const override;
+    uint32_t askDepthAtLevel(size_t k) const override;
+    DepthSpan bidDepths() const override { return DepthSpan{bid_.depthData(), num_levels_}; }
+    DepthSpan askDepths() const override { return DepthSpan{ask_.depthData(), num_levels_}; }
+    const LevelDepthIndex* bidDepthIndex() const override { return bid_.refreshedIndex(num_levels_); }
+    const LevelDepthIndex* askDepthIndex() const override { return ask_.refreshedIndex(num_levels_); }
+    BookDelta lastChange() const override { return last_change_; }
+    void reinitialize(IRng& rng, double depth_mean) override;
+    /// Each restored level holds unit background orders (as seed() does), so resting
+    /// identities from before the checkpoint are not recovered.
+    bool restore(const Level* bids, const Level* asks) override;
+    uint64_t restingOrderId() const override { return resting_order_id_; }
+
+    /// Resting orders in the book (both sides).
+    size_t orderCount() const { return pool_.live(); }
+    /// Remaining quantity of a resting order; 0 if it is not in the book.
+    uint32_t orderQty(uint64_t order_id) const;
+    /// Order ids queued at level k of a side, oldest first (for tests and tools).
+    std::vector<uint64_t> queueAtLevel(Side side, size_t k) const;
+
+    /// Appends to journal (nullptr = off) every order change the records do not
+    /// carry: background orders the book creates (seed, refilled levels,
+    /// reinitialised depths) as ADD_BID/ADD_ASK, and orders it drops by itself
+    /// (the level that leaves the window on an improvement, the extra orders a
+    /// multi-share cancel removes, an add whose price is outside the window) as
+    /// CANCEL_BID/CANCEL_ASK of the whole order. Entries carry order_id, side,
+    /// price and qty; ts_ns and flags are 0. Together with the records this is
+    /// every order the book holds, so an ITCH feed can announce them
+    /// (itch::OrderBookAnnouncer).
+    void setJournal(std::vector<EventRecord>* journal) { journal_ = journal; }
+
+private:
+    /// Ring layout as in MultiLevelBook (level k at slot (head + k) & mask, mirrored
+    /// depths); each slot additionally owns the head/tail of its order queue.
+    /// Slots outside the [0, num_levels) window always have empty queues.
+    struct Ladder {
+        std::vector<uint32_t> depths;  // 2 * ring, mirrored
+        std::vector<int32_t> prices;
+        std::vector<uint32_t> first;   // oldest order
+        std::vector<uint32_t> last;    // newest order
+        size_t head = 0;
+        size_t mask = 0;
+        mutable LevelDepthIndex index;  // as in MultiLevelBook
+
+        void reset(size_t levels);
+        size_t ring() const { return mask + 1; }
+        size_t slot(size_t k) const { return (head + k) & mask; }
+        uint32_t depth(size_t k) const { return depths[head + k]; }
+        void setDepth(size_t k, uint32_t d) {
+            const size_t s = slot(k);
+            index.update(k, depths[s], d);
+            depths[s] = d;
+            depths[s + ring()] = d;
+        }
+        int32_t price(size_t k) const { return prices[slot(k)]; }
+        void advance() {
+            head = (head + 1) & mask;
+            index.invalidate();
+        }
+        void retreat() {
+            head = (head + mask) & mask;
+            index.invalidate();
+        }
+        const uint32_t* depthData() const { return depths.data() + head; }
+        const LevelDepthIndex* refreshedIndex(size_t n) const {
+            index.refresh(depthData(), n);
+            return &index;
+        }
+    };
+
+    Ladder bid_;
+    Ladder ask_;
+    OrderPool pool_;
+    OrderIndexMap index_;
+    size_t num_levels_ = 0;
+    uint32_t initial_depth_ = 50;
+    uint64_t next_background_id_ = kBackgroundOrderIdBase;
+    uint64_t resting_order_id_ = 0;
+    BookDelta last_change_{};
+    PoissonSampler poisson_;
+    std::vector<EventRecord>* journal_ = nullptr;
+
+    void pushBack(Ladder& side, size_t k, uint64_t order_id, uint32_t qty);
+    void unlink(Ladder& side, size_t k, uint32_t idx);
+    void clearLevel(Ladder& side, size_t k);
+    /// Resets level k to a fresh queue of `depth` unit background orders.
+    void fillLevel(Ladder& side, size_t k, int32_t price, uint32_t depth);
+    /// Removes up to qty shares from the newest orders at level k. With reported,
+    /// the newest order is the event's resting order (the record names it).
+    void cancelFromBack(Ladder& side, size_t k, uint32_t qty, bool reported);
+    /// Fills one share against the oldest order at the best level.
+    void executeFront(Ladder& side);
+    /// Resizes level k's queue to `depth` shares (drop newest / append background).
+    void resizeLevel(Ladder& side, size_t k, uint32_t depth);
+
+    /// Journals a whole order at level k of side as added or dropped.
+    void journal(const Ladder& side, bool add, uint64_t order_id, int32_t price, uint32_t qty);
+
+    void touch(Side side, int idx);
+    void shift(Ladder& side, int32_t step);
+    void improve(Ladder& side, int32_t price, uint64_t order_id, uint32_t qty);
+    int bidIndexForPrice(int32_t price_ticks) const;
+    int askIndexForPrice(int32_t price_ticks) const;
+};
+
+}  // namespace qrsdp
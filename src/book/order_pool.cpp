@@ -0,0 +1,102 @@
+#include "book/order_pool.h"
+
+namespace qrsdp {
+
+uint32_t OrderPool::acquire(uint64_t order_id, uint32_t qty) {
+    uint32_t idx;
+    if (free_head_ != kNilOrder) {
+        idx = free_head_;
+        free_head_ = nodes_[idx].next;
+    } else {
+        idx = static_cast<uint32_t>(nodes_.size());
+        nodes_.push_back(OrderNode{});
+    }
+    nodes_[idx] = OrderNode{order_id, qty, kNilOrder, kNilOrder};
+    ++live_;
+    return idx;
+}
+
+void OrderPool::release(uint32_t idx) {
+    nodes_[idx].next = free_head_;
+    free_head_ = idx;
+    --live_;
+}
+
+void OrderPool::clear() {
+    // Keep the slab's capacity; rebuild the free list over every node.
+    free_head_ = kNilOrder;
+    for (size_t i = nodes_.size(); i-- > 0;) {
+        nodes_[i].next = free_head_;
+        free_head_ = static_cast<uint32_t>(i);
+    }
+    live_ = 0;
+}
+
+namespace {
+constexpr size_t kInitialMapCapacity = 1024;
+}  // namespace
+
+OrderIndexMap::OrderIndexMap() : slots_(kInitialMapCapacity, Entry{0, 0}),
+                                 mask_(kInitialMapCapacity - 1) {}
+
+size_t OrderIndexMap::home(uint64_t key) const {
+    // Fibonacci hashing: sequential ids spread across the table.
+    return static_cast<size_t>((key * 0x9E3779B97F4A7C15ULL) >> 32) & mask_;
+}
+
+void OrderIndexMap::insert(uint64_t order_id, uint32_t idx) {
+    if ((size_ + 1) * 2 > slots_.size()) grow();
+    size_t i = home(order_id);
+    while (slots_[i].key != 0 && slots_[i].key != order_id) i = (i + 1) & mask_;
+    if (slots_[i].key == 0) ++size_;
+    slots_[i] = Entry{order_id, idx};
+}
+
+uint32_t OrderIndexMap::find(uint64_t order_id) const {
+    if (order_id == 0) return kNilOrder;
+    for (size_t i = home(order_id);; i = (i + 1) & mask_) {
+        if (slots_[i].key == order_id) return slots_[i].value;
+        if (slots_[i].key == 0) return kNilOrder;
+    }
+}
+
+void OrderIndexMap::erase(uint64_t order_id) {
+    if (order_id == 0) return;
+    size_t i = home(order_id);
+    while (slots_[i].key != order_id) {
+        if (slots_[i].key == 0) return;
+        i = (i + 1) & mask_;
+    }
+    // Backward shift: pull later entries of the probe run into the hole so
+    // lookups never need tombstones.
+    size_t j = i;
+    for (;;) {
+        j = (j + 1) & mask_;
+        if (slots_[j].key == 0) break;
+        const size_t h = home(slots_[j].key);
+        const bool movable = (i <= j) ? (h <= i || h > j) : (h <= i && h > j);
+        if (movable) {
+            slots_[i] = slots_[j];
+            i = j;
+        }
+    }
+    slots_[i] = Entry{0, 0};
+    --size_;
+}
+
+void OrderIndexMap::clear() {
+    for (auto& e : slots_) e = Entry{0, 0};
+    size_ = 0;
+}
+
+void OrderIndexMap::grow() {
+    std::vector<Entry> old;
+    old.swap(slots_);
+    slots_.assign(old.size() * 2, Entry{0, 0});
+    mask_ = slots_.size() - 1;
+    size_ = 0;
+    for (const Entry& e : old)
+        if (e.key != 0) insert(e.key, e.value);
+}
+
+}  // namespace qrsdp
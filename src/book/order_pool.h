@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace qrsdp {
+
+constexpr uint32_t kNilOrder = 0xFFFFFFFFu;
+
+/// One resting order; prev/next link it into its level's FIFO queue.
+struct OrderNode {
+    uint64_t order_id;
+    uint32_t qty;
+    uint32_t prev;
+    uint32_t next;
+};
+
+/// Slab of OrderNodes addressed by 32-bit index, with a free list. Freed nodes
+/// are reused before the slab grows, so a steady-state book stops allocating.
+class OrderPool {
+public:
+    uint32_t acquire(uint64_t order_id, uint32_t qty);
+    void release(uint32_t idx);
+    void clear();
+    void reserve(size_t n) { nodes_.reserve(n); }
+
+    OrderNode& operator[](uint32_t idx) { return nodes_[idx]; }
+    const OrderNode& operator[](uint32_t idx) const { return nodes_[idx]; }
+    size_t live() const { return live_; }
+
+private:
+    std::vector<OrderNode> nodes_;
+    uint32_t free_head_ = kNilOrder;  // free nodes chained through next
+    size_t live_ = 0;
+};
+
+/// Open-addressing order_id -> node index map (linear probing, backward-shift
+/// deletion, power-of-two capacity kept at most half full). order_id 0 is
+/// reserved as the empty marker.
+class OrderIndexMap {
+public:
+    OrderIndexMap();
+    void insert(uint64_t order_id, uint32_t idx);
+    /// Node index for order_id, or kNilOrder.
+    uint32_t find(uint64_t order_id) const;
+    void erase(uint64_t order_id);
+    void clear();
+    size_t size() const { return size_; }
+
+private:
+    struct Entry { uint64_t key; uint32_t value; };
+    std::vector<Entry> slots_;
+    size_t mask_ = 0;
+    size_t size_ = 0;
+
+    size_t home(uint64_t key) const;
+    void grow();
+};
+
+}  // namespace qrsdp
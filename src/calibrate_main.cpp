@@ -1,9 +1,14 @@
 #include "io/event_log_reader.h"
 #include "io/event_log_format.h"
-#include "book/multi_level_book.h"
+#include "io/hlr_curve_bundle.h"
+#include "calibration/hawkes_estimator.h"
 #include "calibration/intensity_estimator.h"
+#include "calibration/online_calibrator.h"
+#include "calibration/sojourn_replay.h"
+#include "model/hawkes_params.h"
 #include "model/hlr_params.h"
 #include "model/intensity_curve.h"
+#include "producer/work_stealing_pool.h"
 #include "core/records.h"
 #include "core/event_types.h"
 
@@ -11,62 +16,267 @@
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
+#include <exception>
+#include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
-static void printUsage(const char* prog) {
-    std::fprintf(stderr,
-        "Usage: %s [options]\n"
-        "Calibrate HLR intensity curves from .qrsdp event log files.\n\n"
-        "  --input <file>       Input .qrsdp file (may be repeated)\n"
-        "  --output <file>      Output JSON curves file (default: hlr_curves.json)\n"
-        "  --levels <K>         Levels per side for curves (default: from file header)\n"
-        "  --n-max <n>          Max queue size for tables (default: 100)\n"
-        "  --spread-sens <f>    Spread sensitivity for output (default: 0.3)\n"
-        "  --verbose            Print per-level summaries\n"
-        "  --help               Show this help\n",
-        prog);
-}
+#ifdef QRSDP_KAFKA_ENABLED
+#include "io/kafka_payload.h"
 
-namespace {
+#include <librdkafka/rdkafkacpp.h>
 
-struct LevelTracker {
-    double last_event_time = 0.0;
-    uint32_t last_depth = 0;
-    bool initialized = false;
+#include <chrono>
+#include <csignal>
+#include <filesystem>
+#endif
+
+struct KafkaCalibrationArgs {
+    std::string brokers;                    // non-empty: --kafka mode
+    std::string topic = "exchange.events";
+    std::string group = "qrsdp-calibrate";
+    std::string output_dir = "hlr_live";    // one <symbol>.json per symbol
+    double publish_every = 60.0;            // wall seconds between publishes
+    double drift_threshold = 0.2;           // hlrCurveDrift above this is reported as drift
+    std::string reference_file;             // non-empty: also report drift from these curves
 };
 
-int findBidLevel(const qrsdp::MultiLevelBook& book, int32_t price) {
-    for (size_t k = 0; k < book.numLevels(); ++k) {
-        if (book.bidPriceAtLevel(k) == price) return static_cast<int>(k);
+#ifdef QRSDP_KAFKA_ENABLED
+
+static volatile std::sig_atomic_t g_stop = 0;
+
+static void onSignal(int) { g_stop = 1; }
+
+/// Writes params to path through a temporary file and a rename, so a watcher
+/// (qrsdp_run --hlr-watch) never loads a half-written file.
+static bool publishParams(const std::string& path, const qrsdp::HLRParams& params) {
+    const std::string tmp = path + ".tmp";
+    if (!qrsdp::saveHLRParamsToJson(tmp, params)) return false;
+    std::error_code ec;
+    std::filesystem::rename(tmp, path, ec);
+    return !ec;
+}
+
+/// --kafka: consumes the KafkaSink topic, feeding each message's records to an
+/// OnlineCalibrator under its key (the symbol), and every publish_every seconds
+/// writes the refreshed curves of each symbol that saw records and reports their
+/// drift. Runs until SIGINT/SIGTERM, then publishes once more.
+static int runKafkaCalibration(const KafkaCalibrationArgs& args,
+                               const qrsdp::OnlineCalibrationConfig& config) {
+    qrsdp::HLRParams reference;
+    const bool has_reference = !args.reference_file.empty();
+    if (has_reference && !qrsdp::loadHLRParamsFromJson(args.reference_file, reference)) {
+        std::fprintf(stderr, "error: failed to load reference curves from %s\n",
+                     args.reference_file.c_str());
+        return 1;
+    }
+    std::error_code ec;
+    std::filesystem::create_directories(args.output_dir, ec);
+    if (ec) {
+        std::fprintf(stderr, "error: cannot create %s: %s\n", args.output_dir.c_str(),
+                     ec.message().c_str());
+        return 1;
+    }
+
+    std::string errstr;
+    std::unique_ptr<RdKafka::Conf> conf(RdKafka::Conf::create(RdKafka::Conf::CONF_GLOBAL));
+    if (conf->set("bootstrap.servers", args.brokers, errstr) != RdKafka::Conf::CONF_OK
+        || conf->set("group.id", args.group, errstr) != RdKafka::Conf::CONF_OK
+        || conf->set("auto.offset.reset", "earliest", errstr) != RdKafka::Conf::CONF_OK
+        || conf->set("enable.auto.commit", "true", errstr) != RdKafka::Conf::CONF_OK) {
+        std::fprintf(stderr, "error: %s\n", errstr.c_str());
+        return 1;
     }
-    return -1;
+    std::unique_ptr<RdKafka::KafkaConsumer> consumer(RdKafka::KafkaConsumer::create(conf.get(), errstr));
+    if (!consumer) {
+        std::fprintf(stderr, "error: failed to create consumer: %s\n", errstr.c_str());
+        return 1;
+    }
+    const RdKafka::ErrorCode sub = consumer->subscribe({args.topic});
+    if (sub != RdKafka::ERR_NO_ERROR) {
+        std::fprintf(stderr, "error: subscribe to %s failed: %s\n", args.topic.c_str(),
+                     RdKafka::err2str(sub).c_str());
+        return 1;
+    }
+    std::printf("consuming %s from %s (group %s), K=%d, half-life %.0f s, publishing to %s/ every %.0f s\n",
+                args.topic.c_str(), args.brokers.c_str(), args.group.c_str(), config.levels,
+                config.half_life_seconds, args.output_dir.c_str(), args.publish_every);
+
+    std::signal(SIGINT, onSignal);
+    std::signal(SIGTERM, onSignal);
+
+    qrsdp::OnlineCalibrator calibrator(config);
+    const std::string unknown = "UNKNOWN";
+    auto publish = [&]() -> bool {
+        for (const qrsdp::SymbolCalibration& cal : calibrator.publish(has_reference ? &reference : nullptr)) {
+            const std::string path = args.output_dir + "/" + cal.symbol + ".json";
+            if (!publishParams(path, cal.params)) {
+                std::fprintf(stderr, "error: failed to write %s\n", path.c_str());
+                return false;
+            }
+            std::printf("  %s: %llu events, %u session(s), %llu resync(s) -> %s", cal.symbol.c_str(),
+                        (unsigned long long)cal.events, cal.sessions,
+                        (unsigned long long)cal.resyncs, path.c_str());
+            if (!cal.first)
+                std::printf(", drift %.3f%s", cal.drift, cal.drift > args.drift_threshold ? " DRIFT" : "");
+            if (has_reference)
+                std::printf(", vs reference %.3f%s", cal.reference_drift,
+                            cal.reference_drift > args.drift_threshold ? " DRIFT" : "");
+            std::printf("\n");
+        }
+        std::fflush(stdout);
+        return true;
+    };
+
+    using Clock = std::chrono::steady_clock;
+    const auto interval = std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(std::max(args.publish_every, 0.1)));
+    Clock::time_point next_publish = Clock::now() + interval;
+    while (!g_stop) {
+        std::unique_ptr<RdKafka::Message> m(consumer->consume(100));
+        if (m && m->err() == RdKafka::ERR_NO_ERROR) {
+            qrsdp::KafkaPayloadView view;
+            if (qrsdp::parseKafkaPayload(m->payload(), m->len(), view)) {
+                const std::string* key = m->key();
+                calibrator.apply(key && !key->empty() ? *key : unknown, view.records, view.count);
+            } else {
+                std::fprintf(stderr, "unrecognised payload of %zu bytes\n", m->len());
+            }
+        } else if (m && m->err() != RdKafka::ERR__TIMED_OUT && m->err() != RdKafka::ERR__PARTITION_EOF) {
+            std::fprintf(stderr, "consumer error: %s\n", m->errstr().c_str());
+        }
+        if (Clock::now() >= next_publish) {
+            if (!publish()) return 1;
+            next_publish = Clock::now() + interval;
+        }
+    }
+    const bool ok = publish();
+    consumer->close();
+    return ok ? 0 : 1;
 }
 
-int findAskLevel(const qrsdp::MultiLevelBook& book, int32_t price) {
-    for (size_t k = 0; k < book.numLevels(); ++k) {
-        if (book.askPriceAtLevel(k) == price) return static_cast<int>(k);
+#endif  // QRSDP_KAFKA_ENABLED
+
+/// Packs JSON curve files, each "SYMBOL=path" (a bare path: the single-security
+/// run's), into one .qrhc bundle.
+static int packBundle(const std::string& bundle_path, const std::vector<std::string>& specs) {
+    std::vector<std::pair<std::string, qrsdp::HLRParams>> curves;
+    for (const std::string& spec : specs) {
+        const size_t eq = spec.find('=');
+        const std::string symbol = eq == std::string::npos ? std::string() : spec.substr(0, eq);
+        const std::string path = eq == std::string::npos ? spec : spec.substr(eq + 1);
+        qrsdp::HLRParams params;
+        if (!qrsdp::loadHLRParamsFromJson(path, params) || !params.hasCurves()) {
+            std::fprintf(stderr, "error: failed to load HLR curves from %s\n", path.c_str());
+            return 1;
+        }
+        curves.emplace_back(symbol, std::move(params));
     }
-    return -1;
+    try {
+        qrsdp::writeHLRCurveBundle(bundle_path, curves);
+    } catch (const std::exception& e) {
+        std::fprintf(stderr, "error: %s\n", e.what());
+        return 1;
+    }
+    std::printf("Wrote %s (%zu symbols)\n", bundle_path.c_str(), curves.size());
+    return 0;
 }
 
-void snapshotLevels(const qrsdp::MultiLevelBook& book, double t,
-                    std::vector<LevelTracker>& bid_trackers,
-                    std::vector<LevelTracker>& ask_trackers) {
-    const size_t K = book.numLevels();
-    bid_trackers.resize(K);
-    ask_trackers.resize(K);
-    for (size_t k = 0; k < K; ++k) {
-        bid_trackers[k].last_depth = book.bidDepthAtLevel(k);
-        bid_trackers[k].last_event_time = t;
-        bid_trackers[k].initialized = true;
-        ask_trackers[k].last_depth = book.askDepthAtLevel(k);
-        ask_trackers[k].last_event_time = t;
-        ask_trackers[k].initialized = true;
+/// --hawkes: fits HawkesIntensityModel kernels with the given decays to the
+/// event times of the input files, one session per file.
+static int fitHawkes(const std::vector<std::string>& input_files, const std::string& decays,
+                     const std::string& output_file) {
+    std::vector<double> betas;
+    for (size_t pos = 0; pos <= decays.size();) {
+        const size_t comma = std::min(decays.find(',', pos), decays.size());
+        char* end = nullptr;
+        const std::string item = decays.substr(pos, comma - pos);
+        const double beta = std::strtod(item.c_str(), &end);
+        if (item.empty() || *end != '\0' || !(beta > 0.0)) {
+            std::fprintf(stderr, "error: bad --hawkes decay list '%s'\n", decays.c_str());
+            return 1;
+        }
+        betas.push_back(beta);
+        pos = comma + 1;
     }
+
+    qrsdp::HawkesEstimator estimator(betas);
+    for (const std::string& path : input_files) {
+        std::printf("  reading %s ...\n", path.c_str());
+        qrsdp::EventLogReader reader(path);
+        const uint64_t open_ns = reader.header().market_open_ns;
+        estimator.beginSession();
+        reader.forEachRecord([&](const qrsdp::DiskEventRecord& rec) {
+            const double t = rec.ts_ns > open_ns ? static_cast<double>(rec.ts_ns - open_ns) * 1e-9 : 0.0;
+            estimator.recordEvent(t, static_cast<qrsdp::EventType>(rec.type));
+        });
+        estimator.endSession(static_cast<double>(reader.header().session_seconds));
+    }
+
+    const qrsdp::HawkesFitResult fit = estimator.fit();
+    std::printf("  %zu events over %.0f s: log-likelihood %.1f after %d iteration(s)%s\n",
+                estimator.events(), estimator.observedSeconds(), fit.log_likelihood, fit.iterations,
+                fit.converged ? "" : " (not converged)");
+    std::printf("  mu:");
+    for (double m : fit.params.mu) std::printf(" %.3f", m);
+    std::printf("\n  branching ratio %.3f\n", qrsdp::hawkesBranchingRatio(fit.params));
+    if (!qrsdp::saveHawkesParamsToJson(output_file, fit.params)) {
+        std::fprintf(stderr, "error: failed to write %s\n", output_file.c_str());
+        return 1;
+    }
+    std::printf("\nWrote Hawkes kernels to %s\n", output_file.c_str());
+    return 0;
 }
 
-}  // namespace
+static void printUsage(const char* prog) {
+    std::fprintf(stderr,
+        "Usage: %s [options]\n"
+        "Calibrate HLR intensity curves from .qrsdp event log files or, with --kafka,\n"
+        "continuously from the live event topic.\n\n"
+        "  --input <file>       Input .qrsdp file (may be repeated)\n"
+        "  --output <file>      Output JSON curves file (default: hlr_curves.json)\n"
+        "  --levels <K>         Levels per side for curves (default: from file header)\n"
+        "  --n-max <n>          Max queue size for tables (default: 100)\n"
+        "  --spread-sens <f>    Spread sensitivity for output (default: 0.3)\n"
+        "  --threads <n>        Worker threads (default: 1 = sequential; 0 = all cores).\n"
+        "                       Several files (or segments) are replayed in parallel\n"
+        "                       into per-worker estimators that are then merged; a\n"
+        "                       single one has its chunks decoded ahead of the replay\n"
+        "  --split-checkpoints  Also split each file at its book checkpoints, so one\n"
+        "                       large file spreads over the threads (level trackers\n"
+        "                       restart at each checkpoint, as after a price shift)\n"
+        "  --verbose            Print per-level summaries\n"
+        "\nHawkes kernels (instead of HLR curves):\n"
+        "  --hawkes <decays>    Fit a qrsdp_run --hawkes model (constant mu plus kernels\n"
+        "                       with these decay rates, 1/s, comma-separated, e.g. 20,1)\n"
+        "                       to the --input files' event times by EM, one session per\n"
+        "                       file; --output defaults to hawkes.json\n"
+        "\nBundling (instead of calibrating):\n"
+        "  --bundle <file>      Pack the --curves files into one .qrhc curve bundle for\n"
+        "                       qrsdp_run --hlr-bundle\n"
+        "  --curves <SYM=file>  A symbol's JSON curves (may be repeated; a bare file is\n"
+        "                       the single-security run's)\n"
+        "\nStreaming (--kafka; needs a BUILD_KAFKA_SUPPORT build):\n"
+        "  --kafka <brokers>    Consume the KafkaSink topic instead of --input files; runs\n"
+        "                       until SIGINT/SIGTERM. --output names a directory\n"
+        "                       (default: hlr_live) of <symbol>.json curves, rewritten\n"
+        "                       atomically at every publish; --levels defaults to 5\n"
+        "  --topic <name>       Topic (default: exchange.events)\n"
+        "  --group <id>         Consumer group (default: qrsdp-calibrate)\n"
+        "  --publish-every <s>  Wall seconds between publishes (default: 60)\n"
+        "  --half-life <s>      Event-time half-life of a sojourn's weight; 0 = no decay\n"
+        "                       (default: 3600)\n"
+        "  --drift-threshold <f> Flag a publish whose curves moved more than this\n"
+        "                       (0..1, see hlrCurveDrift; default: 0.2)\n"
+        "  --reference <file>   Also report each publish's drift from these curves\n"
+        "  --p0 <ticks>         Opening mid of each symbol's first session (default: from\n"
+        "                       its first record)\n"
+        "  --initial-spread <n> Book seed of each session, as the producer's (default: 2)\n"
+        "  --initial-depth <n>  (default: 5)\n"
+        "  --help               Show this help\n",
+        prog);
+}
 
 int main(int argc, char* argv[]) {
     std::vector<std::string> input_files;
@@ -75,6 +285,14 @@ int main(int argc, char* argv[]) {
     int n_max = 100;
     double spread_sens = 0.3;
     bool verbose = false;
+    int threads = 1;
+    bool split_checkpoints = false;
+    bool output_set = false;
+    KafkaCalibrationArgs kafka;
+    qrsdp::OnlineCalibrationConfig online;
+    std::string bundle_file;
+    std::vector<std::string> bundle_curves;
+    std::string hawkes_decays;
 
     for (int i = 1; i < argc; ++i) {
         const char* arg = argv[i];
@@ -87,11 +305,26 @@ int main(int argc, char* argv[]) {
         };
 
         if (std::strcmp(arg, "--input") == 0)        input_files.emplace_back(next());
-        else if (std::strcmp(arg, "--output") == 0)   output_file = next();
+        else if (std::strcmp(arg, "--output") == 0) { output_file = next(); output_set = true; }
         else if (std::strcmp(arg, "--levels") == 0)   levels_override = std::atoi(next());
         else if (std::strcmp(arg, "--n-max") == 0)    n_max = std::atoi(next());
         else if (std::strcmp(arg, "--spread-sens") == 0) spread_sens = std::atof(next());
+        else if (std::strcmp(arg, "--threads") == 0)  threads = std::atoi(next());
+        else if (std::strcmp(arg, "--split-checkpoints") == 0) split_checkpoints = true;
         else if (std::strcmp(arg, "--verbose") == 0)  verbose = true;
+        else if (std::strcmp(arg, "--bundle") == 0)   bundle_file = next();
+        else if (std::strcmp(arg, "--hawkes") == 0)   hawkes_decays = next();
+        else if (std::strcmp(arg, "--curves") == 0)   bundle_curves.emplace_back(next());
+        else if (std::strcmp(arg, "--kafka") == 0)    kafka.brokers = next();
+        else if (std::strcmp(arg, "--topic") == 0)    kafka.topic = next();
+        else if (std::strcmp(arg, "--group") == 0)    kafka.group = next();
+        else if (std::strcmp(arg, "--publish-every") == 0) kafka.publish_every = std::atof(next());
+        else if (std::strcmp(arg, "--drift-threshold") == 0) kafka.drift_threshold = std::atof(next());
+        else if (std::strcmp(arg, "--reference") == 0) kafka.reference_file = next();
+        else if (std::strcmp(arg, "--half-life") == 0) online.half_life_seconds = std::atof(next());
+        else if (std::strcmp(arg, "--p0") == 0)       online.p0_ticks = std::atoi(next());
+        else if (std::strcmp(arg, "--initial-spread") == 0) online.initial_spread_ticks = static_cast<uint32_t>(std::atoi(next()));
+        else if (std::strcmp(arg, "--initial-depth") == 0) online.initial_depth = static_cast<uint32_t>(std::atoi(next()));
         else if (std::strcmp(arg, "--help") == 0 || std::strcmp(arg, "-h") == 0) {
             printUsage(argv[0]);
             return 0;
@@ -102,12 +335,48 @@ int main(int argc, char* argv[]) {
         }
     }
 
+    if (!bundle_file.empty()) {
+        if (bundle_curves.empty() || !input_files.empty() || !kafka.brokers.empty()) {
+            std::fprintf(stderr, "error: --bundle takes --curves files only\n");
+            return 1;
+        }
+        return packBundle(bundle_file, bundle_curves);
+    }
+
+    if (!kafka.brokers.empty()) {
+#ifdef QRSDP_KAFKA_ENABLED
+        if (!input_files.empty()) {
+            std::fprintf(stderr, "error: --kafka and --input are exclusive\n");
+            return 1;
+        }
+        if (output_set) kafka.output_dir = output_file;
+        online.levels = levels_override > 0 ? levels_override : 5;
+        online.n_max = n_max;
+        online.spread_sensitivity = spread_sens;
+        return runKafkaCalibration(kafka, online);
+#else
+        (void)output_set;
+        std::fprintf(stderr, "error: --kafka needs a build with -DBUILD_KAFKA_SUPPORT=ON\n");
+        return 1;
+#endif
+    }
+
     if (input_files.empty()) {
         std::fprintf(stderr, "error: at least one --input file required\n");
         printUsage(argv[0]);
         return 1;
     }
 
+    if (!hawkes_decays.empty()) {
+        std::printf("=== qrsdp_calibrate --hawkes ===\n");
+        try {
+            return fitHawkes(input_files, hawkes_decays, output_set ? output_file : "hawkes.json");
+        } catch (const std::exception& e) {
+            std::fprintf(stderr, "error: %s\n", e.what());
+            return 1;
+        }
+    }
+
     int K = levels_override;
     if (K <= 0) {
         qrsdp::EventLogReader probe(input_files[0]);
@@ -120,166 +389,65 @@ int main(int argc, char* argv[]) {
     std::printf("inputs: %zu file(s), K=%d, n_max=%d, output=%s\n",
                 input_files.size(), K, n_max, output_file.c_str());
 
-    // Per-(level, side) estimators. Bid and ask each get K estimators.
-    // Market orders are recorded into the level-0 estimators as EXECUTE_SELL (bid)
-    // and EXECUTE_BUY (ask).
-    std::vector<qrsdp::IntensityEstimator> bid_estimators(ku);
-    std::vector<qrsdp::IntensityEstimator> ask_estimators(ku);
-    for (auto& e : bid_estimators) e.reset();
-    for (auto& e : ask_estimators) e.reset();
-
-    uint64_t total_events = 0;
-    uint64_t total_sojourns_recorded = 0;
-
-    for (const auto& input_path : input_files) {
-        std::printf("  reading %s ...\n", input_path.c_str());
-
-        qrsdp::EventLogReader reader(input_path);
-        const qrsdp::FileHeader& hdr = reader.header();
-        const int file_K = static_cast<int>(hdr.levels_per_side);
-        const int use_K = std::min(K, file_K > 0 ? file_K : K);
-
-        qrsdp::MultiLevelBook book;
-        qrsdp::BookSeed bseed{};
-        bseed.p0_ticks = hdr.p0_ticks;
-        bseed.levels_per_side = hdr.levels_per_side;
-        bseed.initial_depth = hdr.initial_depth > 0 ? hdr.initial_depth : 5;
-        bseed.initial_spread_ticks = hdr.initial_spread_ticks > 0 ? hdr.initial_spread_ticks : 2;
-        book.seed(bseed);
-
-        std::vector<LevelTracker> bid_trackers;
-        std::vector<LevelTracker> ask_trackers;
-        snapshotLevels(book, 0.0, bid_trackers, ask_trackers);
-
-        auto records = reader.readAll();
-        total_events += records.size();
-
-        for (const auto& rec : records) {
-            const double t = static_cast<double>(rec.ts_ns) * 1e-9;
-            const auto type = static_cast<qrsdp::EventType>(rec.type);
-
-            int level = -1;
-            bool is_bid_side = false;
-
-            switch (type) {
-                case qrsdp::EventType::ADD_BID:
-                case qrsdp::EventType::CANCEL_BID: {
-                    is_bid_side = true;
-                    level = findBidLevel(book, rec.price_ticks);
-                    if (level < 0 && type == qrsdp::EventType::ADD_BID) {
-                        // Spread-improving add: treat as new level 0
-                        level = 0;
-                    }
-                    break;
-                }
-                case qrsdp::EventType::ADD_ASK:
-                case qrsdp::EventType::CANCEL_ASK: {
-                    is_bid_side = false;
-                    level = findAskLevel(book, rec.price_ticks);
-                    if (level < 0 && type == qrsdp::EventType::ADD_ASK) {
-                        level = 0;
-                    }
-                    break;
-                }
-                case qrsdp::EventType::EXECUTE_SELL: {
-                    is_bid_side = true;
-                    level = 0;
-                    break;
-                }
-                case qrsdp::EventType::EXECUTE_BUY: {
-                    is_bid_side = false;
-                    level = 0;
-                    break;
-                }
-                default:
-                    break;
-            }
-
-            if (level >= 0 && level < use_K) {
-                const size_t lk = static_cast<size_t>(level);
-                auto& tracker = is_bid_side ? bid_trackers[lk] : ask_trackers[lk];
-                auto& estimator = is_bid_side ? bid_estimators[lk] : ask_estimators[lk];
-
-                if (tracker.initialized) {
-                    const double dt = t - tracker.last_event_time;
-                    if (dt > 0.0) {
-                        estimator.recordSojourn(tracker.last_depth, dt, type);
-                        ++total_sojourns_recorded;
-                    }
-                }
-
-                tracker.last_event_time = t;
-                tracker.last_depth = is_bid_side
-                    ? book.bidDepthAtLevel(lk)
-                    : book.askDepthAtLevel(lk);
-                tracker.initialized = true;
-            }
+    // Per-(level, side) estimators. Bid and ask each get K estimators, preallocated
+    // for queues 0..n_max (the tables written) with larger queues pooled.
+    const uint32_t table_n_max = static_cast<uint32_t>(std::max(n_max, 0));
+    qrsdp::LevelEstimators estimators(ku, table_n_max);
+
+    // Map: every segment (a whole file, or a checkpoint interval with
+    // --split-checkpoints) streams into its own estimators. Reduce: merge them in
+    // input order, so the result does not depend on the thread count.
+    std::vector<std::unique_ptr<qrsdp::EventLogReader>> readers;
+    std::vector<qrsdp::CalibrationSegment> segments;
+    for (size_t f = 0; f < input_files.size(); ++f) {
+        std::printf("  reading %s ...\n", input_files[f].c_str());
+        readers.push_back(std::make_unique<qrsdp::EventLogReader>(input_files[f]));
+        for (const qrsdp::CalibrationSegment& seg :
+                 qrsdp::planSegments(*readers.back(), f, split_checkpoints))
+            segments.push_back(seg);
+    }
 
-            // Apply the event to the book
-            const int32_t prev_bid = book.bestBid().price_ticks;
-            const int32_t prev_ask = book.bestAsk().price_ticks;
-
-            qrsdp::SimEvent ev{};
-            ev.type = type;
-            ev.side = static_cast<qrsdp::Side>(rec.side);
-            ev.price_ticks = rec.price_ticks;
-            ev.qty = rec.qty;
-            ev.order_id = rec.order_id;
-            book.apply(ev);
-
-            const int32_t new_bid = book.bestBid().price_ticks;
-            const int32_t new_ask = book.bestAsk().price_ticks;
-            if (new_bid != prev_bid || new_ask != prev_ask) {
-                snapshotLevels(book, t, bid_trackers, ask_trackers);
-            } else {
-                // Update only the affected level's depth
-                if (level >= 0 && level < use_K) {
-                    const size_t lk = static_cast<size_t>(level);
-                    if (is_bid_side) {
-                        bid_trackers[lk].last_depth = book.bidDepthAtLevel(lk);
-                    } else {
-                        ask_trackers[lk].last_depth = book.askDepthAtLevel(lk);
-                    }
+    if (threads == 1) {
+        for (const qrsdp::CalibrationSegment& seg : segments)
+            qrsdp::replaySegment(*readers[seg.file], seg, K, estimators);
+    } else if (segments.size() == 1) {
+        // Nothing to split: the pool decompresses chunks ahead of the sequential replay.
+        qrsdp::WorkStealingPool decode_pool(threads > 1 ? static_cast<size_t>(threads) : 0);
+        qrsdp::SojournReplay replay(readers[0]->header(), K, estimators);
+        readers[0]->forEachChunk(decode_pool, [&replay](const qrsdp::RecordSpan& chunk) {
+            for (const auto& rec : chunk) replay.apply(rec);
+        });
+    } else {
+        qrsdp::WorkStealingPool pool(threads > 1 ? static_cast<size_t>(threads) : 0);
+        std::printf("  %zu segment(s) on %zu thread(s)\n", segments.size(), pool.size());
+        std::vector<qrsdp::LevelEstimators> partial(segments.size(), qrsdp::LevelEstimators(ku, table_n_max));
+        std::vector<std::string> errors(segments.size());
+        for (size_t i = 0; i < segments.size(); ++i) {
+            pool.submit([&, i] {
+                try {
+                    qrsdp::replaySegment(*readers[segments[i].file], segments[i], K, partial[i]);
+                } catch (const std::exception& e) {
+                    errors[i] = e.what();
                 }
+            });
+        }
+        pool.wait();
+        for (size_t i = 0; i < segments.size(); ++i) {
+            if (!errors[i].empty()) {
+                std::fprintf(stderr, "error: %s: %s\n", input_files[segments[i].file].c_str(),
+                             errors[i].c_str());
+                return 1;
             }
+            estimators.merge(partial[i]);
         }
     }
+    const std::vector<qrsdp::IntensityEstimator>& bid_estimators = estimators.bid;
+    const std::vector<qrsdp::IntensityEstimator>& ask_estimators = estimators.ask;
 
     std::printf("  total events: %llu, sojourns recorded: %llu\n",
-                (unsigned long long)total_events, (unsigned long long)total_sojourns_recorded);
-
-    // Build HLRParams from estimated curves
-    qrsdp::HLRParams params;
-    params.K = K;
-    params.n_max = n_max;
-    params.spread_sensitivity = spread_sens;
-    params.lambda_L_bid.resize(ku);
-    params.lambda_L_ask.resize(ku);
-    params.lambda_C_bid.resize(ku);
-    params.lambda_C_ask.resize(ku);
-
-    auto extractCurve = [&](const qrsdp::IntensityEstimator& est, qrsdp::EventType type,
-                            int n_table) -> qrsdp::IntensityCurve {
-        std::vector<double> values;
-        values.reserve(static_cast<size_t>(n_table + 1));
-        for (int n = 0; n <= n_table; ++n) {
-            values.push_back(est.lambdaType(static_cast<uint32_t>(n), type));
-        }
-        qrsdp::IntensityCurve curve;
-        curve.setTable(std::move(values), qrsdp::IntensityCurve::TailRule::FLAT);
-        return curve;
-    };
-
-    for (int i = 0; i < K; ++i) {
-        const size_t si = static_cast<size_t>(i);
-        params.lambda_L_bid[si] = extractCurve(bid_estimators[si], qrsdp::EventType::ADD_BID, n_max);
-        params.lambda_L_ask[si] = extractCurve(ask_estimators[si], qrsdp::EventType::ADD_ASK, n_max);
-        params.lambda_C_bid[si] = extractCurve(bid_estimators[si], qrsdp::EventType::CANCEL_BID, n_max);
-        params.lambda_C_ask[si] = extractCurve(ask_estimators[si], qrsdp::EventType::CANCEL_ASK, n_max);
-    }
+                (unsigned long long)estimators.events, (unsigned long long)estimators.sojourns);
 
-    params.lambda_M_buy = extractCurve(ask_estimators[0], qrsdp::EventType::EXECUTE_BUY, n_max);
-    params.lambda_M_sell = extractCurve(bid_estimators[0], qrsdp::EventType::EXECUTE_SELL, n_max);
+    const qrsdp::HLRParams params = qrsdp::fitHLRParams(estimators, n_max, spread_sens);
 
     if (verbose) {
         std::printf("\n--- Estimated curves ---\n");
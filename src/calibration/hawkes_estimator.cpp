@@ -0,0 +1,219 @@
+#include "calibration/hawkes_estimator.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+namespace qrsdp {
+
+namespace {
+
+constexpr size_t kTypes = static_cast<size_t>(kNumEventTypes);
+
+/// Parameters flattened for the pass: alpha[(k * kTypes + i) * kTypes + j].
+struct FlatParams {
+    std::vector<double> mu;
+    std::vector<double> alpha;
+};
+
+/// E-step sums: baseline share per target type, kernel share per (k, i, j).
+struct Attribution {
+    std::vector<double> base;
+    std::vector<double> excited;
+};
+
+}  // namespace
+
+HawkesEstimator::HawkesEstimator(std::vector<double> betas) : betas_(std::move(betas)) {
+    for (double b : betas_) {
+        if (!(b > 0.0) || !std::isfinite(b))
+            throw std::invalid_argument("HawkesEstimator: every decay must be finite and > 0");
+    }
+}
+
+void HawkesEstimator::beginSession() {
+    if (open_) endSession(times_.empty() ? 0.0 : times_.back());
+    session_begin_.push_back(times_.size());
+    open_ = true;
+}
+
+void HawkesEstimator::recordEvent(double t, EventType type) {
+    if (!open_) beginSession();
+    if (times_.size() > session_begin_.back() && t < times_.back())
+        throw std::invalid_argument("HawkesEstimator: event times must not decrease within a session");
+    if (static_cast<size_t>(type) >= kTypes) return;
+    times_.push_back(t);
+    types_.push_back(static_cast<uint8_t>(type));
+}
+
+void HawkesEstimator::endSession(double horizon) {
+    if (!open_) return;
+    const double last = times_.size() > session_begin_.back() ? times_.back() : 0.0;
+    horizons_.push_back(std::max(horizon, last));
+    open_ = false;
+}
+
+double HawkesEstimator::observedSeconds() const {
+    double total = 0.0;
+    for (double h : horizons_) total += h;
+    return total;
+}
+
+// One pass over the closed sessions at params: returns Σ log λ(t_m) (the
+// compensator is the caller's) and, with attr, the E-step attributions.
+static double eventPass(const std::vector<double>& betas, const std::vector<double>& times,
+                        const std::vector<uint8_t>& types, const std::vector<size_t>& begins,
+                        size_t sessions, const FlatParams& p, Attribution* attr) {
+    const size_t K = betas.size();
+    std::vector<double> R(K * kTypes);
+    std::vector<double> share(K * kTypes);
+    double sum_log = 0.0;
+    for (size_t s = 0; s < sessions; ++s) {
+        const size_t b = begins[s];
+        const size_t e = s + 1 < begins.size() ? begins[s + 1] : times.size();
+        std::fill(R.begin(), R.end(), 0.0);
+        double t_prev = 0.0;
+        for (size_t m = b; m < e; ++m) {
+            const double dt = times[m] - t_prev;
+            if (dt > 0.0) {
+                for (size_t k = 0; k < K; ++k) {
+                    const double d = std::exp(-betas[k] * dt);
+                    for (size_t j = 0; j < kTypes; ++j) R[k * kTypes + j] *= d;
+                }
+            }
+            t_prev = times[m];
+            const size_t i = types[m];
+            double lambda = p.mu[i];
+            for (size_t k = 0; k < K; ++k) {
+                const double* a = &p.alpha[(k * kTypes + i) * kTypes];
+                for (size_t j = 0; j < kTypes; ++j) {
+                    share[k * kTypes + j] = a[j] * R[k * kTypes + j];
+                    lambda += share[k * kTypes + j];
+                }
+            }
+            lambda = std::max(lambda, 1e-300);
+            sum_log += std::log(lambda);
+            if (attr) {
+                const double inv = 1.0 / lambda;
+                attr->base[i] += p.mu[i] * inv;
+                for (size_t k = 0; k < K; ++k)
+                    for (size_t j = 0; j < kTypes; ++j)
+                        attr->excited[(k * kTypes + i) * kTypes + j] += share[k * kTypes + j] * inv;
+            }
+            for (size_t k = 0; k < K; ++k) R[k * kTypes + i] += 1.0;
+        }
+    }
+    return sum_log;
+}
+
+// G[k][j] = Σ_{type-j events} (1 - exp(-beta_k (T - t_m))) / beta_k: the
+// compensator of a unit alpha_k[.][j] over the sessions.
+static std::vector<double> kernelExposure(const std::vector<double>& betas,
+                                          const std::vector<double>& times,
+                                          const std::vector<uint8_t>& types,
+                                          const std::vector<size_t>& begins,
+                                          const std::vector<double>& horizons) {
+    const size_t K = betas.size();
+    std::vector<double> G(K * kTypes, 0.0);
+    for (size_t s = 0; s < horizons.size(); ++s) {
+        const size_t e = s + 1 < begins.size() ? begins[s + 1] : times.size();
+        for (size_t m = begins[s]; m < e; ++m) {
+            for (size_t k = 0; k < K; ++k)
+                G[k * kTypes + types[m]] += -std::expm1(-betas[k] * (horizons[s] - times[m])) / betas[k];
+        }
+    }
+    return G;
+}
+
+static double compensator(const FlatParams& p, const std::vector<double>& G, double T) {
+    double c = 0.0;
+    for (size_t i = 0; i < kTypes; ++i) c += p.mu[i] * T;
+    const size_t K = G.size() / kTypes;
+    for (size_t k = 0; k < K; ++k)
+        for (size_t i = 0; i < kTypes; ++i)
+            for (size_t j = 0; j < kTypes; ++j)
+                c += p.alpha[(k * kTypes + i) * kTypes + j] * G[k * kTypes + j];
+    return c;
+}
+
+double HawkesEstimator::logLikelihood(const HawkesParams& params) const {
+    if (params.kernels.size() != betas_.size())
+        throw std::invalid_argument("HawkesEstimator: params have a different number of kernels");
+    const size_t K = betas_.size();
+    FlatParams p;
+    p.mu.assign(params.mu.begin(), params.mu.end());
+    p.alpha.assign(K * kTypes * kTypes, 0.0);
+    for (size_t k = 0; k < K; ++k)
+        for (size_t i = 0; i < kTypes; ++i)
+            for (size_t j = 0; j < kTypes; ++j)
+                p.alpha[(k * kTypes + i) * kTypes + j] = params.kernels[k].alpha[i][j];
+    const std::vector<double> G = kernelExposure(betas_, times_, types_, session_begin_, horizons_);
+    return eventPass(betas_, times_, types_, session_begin_, horizons_.size(), p, nullptr)
+           - compensator(p, G, observedSeconds());
+}
+
+HawkesFitResult HawkesEstimator::fit(const HawkesFitOptions& options) const {
+    const size_t K = betas_.size();
+    const size_t sessions = horizons_.size();
+    const double T = observedSeconds();
+    size_t n_events = 0;
+    std::vector<double> count(kTypes, 0.0);
+    for (size_t s = 0; s < sessions; ++s) {
+        const size_t e = s + 1 < session_begin_.size() ? session_begin_[s + 1] : times_.size();
+        for (size_t m = session_begin_[s]; m < e; ++m) count[types_[m]] += 1.0;
+        n_events += e - session_begin_[s];
+    }
+
+    HawkesFitResult result;
+    result.params.baseline = HawkesBaseline::MU;  // alpha is fitted against the constant mu
+    result.params.kernels.resize(K);
+    for (size_t k = 0; k < K; ++k) result.params.kernels[k].beta = betas_[k];
+    if (n_events == 0 || !(T > 0.0)) return result;
+
+    // Start from half the events on the baseline and a branching ratio of 0.5
+    // spread evenly over the kernels and source types.
+    FlatParams p;
+    p.mu.resize(kTypes);
+    p.alpha.assign(K * kTypes * kTypes, 0.0);
+    for (size_t i = 0; i < kTypes; ++i) {
+        p.mu[i] = 0.5 * count[i] / T;
+        if (count[i] == 0.0) continue;
+        for (size_t k = 0; k < K; ++k)
+            for (size_t j = 0; j < kTypes; ++j)
+                p.alpha[(k * kTypes + i) * kTypes + j] = 0.5 * betas_[k] / static_cast<double>(K * kTypes);
+    }
+
+    const std::vector<double> G = kernelExposure(betas_, times_, types_, session_begin_, horizons_);
+    double previous = -std::numeric_limits<double>::infinity();
+    Attribution attr;
+    for (int iter = 1; iter <= std::max(options.max_iterations, 1); ++iter) {
+        attr.base.assign(kTypes, 0.0);
+        attr.excited.assign(K * kTypes * kTypes, 0.0);
+        const double ll = eventPass(betas_, times_, types_, session_begin_, sessions, p, &attr)
+                          - compensator(p, G, T);
+        result.log_likelihood = ll;
+        result.iterations = iter;
+        if (std::fabs(ll - previous) <= options.tolerance * std::fabs(ll)) {
+            result.converged = true;
+            break;
+        }
+        previous = ll;
+        for (size_t i = 0; i < kTypes; ++i) p.mu[i] = attr.base[i] / T;
+        for (size_t k = 0; k < K; ++k)
+            for (size_t i = 0; i < kTypes; ++i)
+                for (size_t j = 0; j < kTypes; ++j) {
+                    const size_t a = (k * kTypes + i) * kTypes + j;
+                    const double g = G[k * kTypes + j];
+                    p.alpha[a] = g > 0.0 ? attr.excited[a] / g : 0.0;
+                }
+    }
+
+    for (size_t i = 0; i < kTypes; ++i) result.params.mu[i] = p.mu[i];
+    for (size_t k = 0; k < K; ++k)
+        for (size_t i = 0; i < kTypes; ++i)
+            for (size_t j = 0; j < kTypes; ++j)
+                result.params.kernels[k].alpha[i][j] = p.alpha[(k * kTypes + i) * kTypes + j];
+    return result;
+}
+
+}  // namespace qrsdp
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "core/event_types.h"
+#include "model/hawkes_params.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace qrsdp {
+
+struct HawkesFitOptions {
+    int max_iterations = 1000;  // EM's tail is slow: a few hundred passes is typical
+    double tolerance = 1e-7;  // stop once the log-likelihood gains less than this, relatively
+};
+
+struct HawkesFitResult {
+    HawkesParams params;
+    double log_likelihood = 0.0;
+    int iterations = 0;
+    bool converged = false;
+};
+
+/// Maximum-likelihood fit of HawkesIntensityModel's parameters from event times,
+/// by expectation-maximisation with the kernels' decay rates held fixed (the
+/// usual practice: decays are picked from a grid, alpha and mu fitted).
+///
+/// Each iteration is one pass over the events. The E-step splits every event
+/// between the baseline and the (kernel, source type) excitations in proportion
+/// to their intensities at that time, with the same recursion the model uses
+/// (R_k,j decays by exp(-beta_k Δt) and steps by 1 at a type-j event), so a pass
+/// costs O(events × kernels × types). The M-step is closed-form:
+///   mu_i = (events of type i attributed to the baseline) / T
+///   alpha_k[i][j] = (type-i events attributed to kernel k, source j) / Σ_{type-j events} (1 - exp(-beta_k (T - t_m))) / beta_k
+/// The baseline is a constant per type; fitting it on top of a book-driven
+/// baseline is not supported. The result's baseline is therefore MU, so a run of
+/// the fitted params uses the same baseline the alphas were fitted against.
+class HawkesEstimator {
+public:
+    /// Throws std::invalid_argument unless every beta is > 0.
+    explicit HawkesEstimator(std::vector<double> betas);
+
+    /// Starts a session (an independent realisation from time 0).
+    void beginSession();
+    /// Records an event at session time t (seconds, non-decreasing within the
+    /// session). Throws std::invalid_argument if t steps back.
+    void recordEvent(double t, EventType type);
+    /// Closes the session observed over [0, horizon] (>= its last event time).
+    void endSession(double horizon);
+
+    size_t events() const { return times_.size(); }
+    size_t sessions() const { return horizons_.size(); }
+    double observedSeconds() const;
+
+    /// Fits from the recorded sessions. With no events the result has mu = 0 and
+    /// alpha = 0.
+    HawkesFitResult fit(const HawkesFitOptions& options = HawkesFitOptions{}) const;
+
+    /// Log-likelihood of params (its kernels must be this estimator's decays, in order).
+    double logLikelihood(const HawkesParams& params) const;
+
+private:
+    std::vector<double> betas_;
+    std::vector<double> times_;
+    std::vector<uint8_t> types_;
+    std::vector<size_t> session_begin_;  // first event index of each session
+    std::vector<double> horizons_;
+    bool open_ = false;
+};
+
+}  // namespace qrsdp
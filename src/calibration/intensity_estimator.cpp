@@ -5,42 +5,87 @@
 
 namespace qrsdp {
 
+IntensityEstimator::IntensityEstimator(uint32_t n_max) : n_max_(n_max) {
+    if (n_max_ != kUnbounded) grow(static_cast<size_t>(n_max_) + 2);
+}
+
 void IntensityEstimator::reset() {
-    cells_.clear();
+    if (n_max_ != kUnbounded) {
+        std::fill(sum_dt_.begin(), sum_dt_.end(), 0.0);
+        std::fill(count_.begin(), count_.end(), 0.0);
+        for (std::vector<double>& c : count_by_type_) std::fill(c.begin(), c.end(), 0.0);
+        return;
+    }
+    sum_dt_.clear();
+    count_.clear();
+    for (std::vector<double>& c : count_by_type_) c.clear();
 }
 
-void IntensityEstimator::recordSojourn(uint32_t n, double dt_sec, EventType type) {
-    const size_t idx = static_cast<size_t>(n);
-    if (idx >= cells_.size()) cells_.resize(idx + 1);
-    Cell& c = cells_[idx];
-    c.sum_dt += dt_sec;
-    c.count += 1;
-    const size_t ti = static_cast<size_t>(type);
-    if (ti < static_cast<size_t>(EventType::COUNT)) c.count_by_type[ti] += 1;
+void IntensityEstimator::grow(size_t cells) {
+    sum_dt_.resize(cells, 0.0);
+    count_.resize(cells, 0.0);
+    for (std::vector<double>& c : count_by_type_) c.resize(cells, 0.0);
+}
+
+void IntensityEstimator::merge(const IntensityEstimator& other) {
+    const size_t n = other.cells();
+    if (n_max_ == kUnbounded && n > cells()) grow(n);
+    // Cells both estimators hold at the same n: a straight element-wise sum.
+    const size_t direct = (n_max_ == other.n_max_) ? n
+                        : std::min(n, n_max_ == kUnbounded ? cells() : static_cast<size_t>(n_max_) + 1);
+    for (size_t i = 0; i < direct; ++i) {
+        sum_dt_[i] += other.sum_dt_[i];
+        count_[i] += other.count_[i];
+    }
+    for (size_t t = 0; t < kTypes; ++t) {
+        const double* src = other.count_by_type_[t].data();
+        double* dst = count_by_type_[t].data();
+        for (size_t i = 0; i < direct; ++i) dst[i] += src[i];
+    }
+    if (direct == n) return;
+    // The rest of other's cells lie above this fixed range: into the overflow cell.
+    // (An unbounded estimator grew above, so only a fixed one gets here; other's
+    // own overflow cell, if any, pools queues above other.n_max_ > n_max_.)
+    const size_t overflow = static_cast<size_t>(n_max_) + 1;
+    for (size_t i = direct; i < n; ++i) {
+        sum_dt_[overflow] += other.sum_dt_[i];
+        count_[overflow] += other.count_[i];
+        for (size_t t = 0; t < kTypes; ++t) count_by_type_[t][overflow] += other.count_by_type_[t][i];
+    }
+}
+
+void IntensityEstimator::decay(double factor) {
+    for (double& v : sum_dt_) v *= factor;
+    for (double& v : count_) v *= factor;
+    for (std::vector<double>& c : count_by_type_)
+        for (double& v : c) v *= factor;
+}
+
+size_t IntensityEstimator::cellOf(uint32_t n) const {
+    if (n_max_ != kUnbounded && n > n_max_) return static_cast<size_t>(n_max_) + 1;
+    return n < cells() ? n : cells();
 }
 
 double IntensityEstimator::lambdaTotal(uint32_t n) const {
-    if (n >= cells_.size()) return 0.0;
-    const Cell& c = cells_[n];
-    if (c.count == 0 || c.sum_dt <= 0.0) return 0.0;
-    return static_cast<double>(c.count) / c.sum_dt;
+    const size_t i = cellOf(n);
+    if (i >= cells()) return 0.0;
+    if (!(count_[i] > 0.0) || sum_dt_[i] <= 0.0) return 0.0;
+    return count_[i] / sum_dt_[i];
 }
 
 double IntensityEstimator::lambdaType(uint32_t n, EventType type) const {
     const double lambda_tot = lambdaTotal(n);
     if (lambda_tot <= 0.0) return 0.0;
-    if (n >= cells_.size()) return 0.0;
-    const Cell& c = cells_[n];
+    const size_t i = cellOf(n);
     const size_t ti = static_cast<size_t>(type);
-    if (ti >= static_cast<size_t>(EventType::COUNT)) return 0.0;
-    if (c.count == 0) return 0.0;
-    const double freq = static_cast<double>(c.count_by_type[ti]) / static_cast<double>(c.count);
+    if (ti >= kTypes) return 0.0;
+    const double freq = count_by_type_[ti][i] / count_[i];
     return lambda_tot * freq;
 }
 
 size_t IntensityEstimator::nMaxObserved() const {
-    for (size_t i = cells_.size(); i > 0; --i) {
-        if (cells_[i - 1].count > 0) return i - 1;
+    for (size_t i = cells(); i > 0; --i) {
+        if (count_[i - 1] > 0.0) return i - 1;
     }
     return 0;
 }
@@ -4,35 +4,88 @@
 #include "core/records.h"
 #include <cstddef>
 #include <cstdint>
+#include <limits>
 #include <vector>
 
 namespace qrsdp {
 
 /// Scaffold for HLR MLE intensity estimation from event stream.
 /// Λ̂(n) = 1 / mean(Δt | q=n),  λ̂_type(n) = Λ̂(n) * freq(type | q=n).
+///
+/// Storage is structure-of-arrays over the queue size n: dwell-time sums, sojourn
+/// counts and one count array per event type. Counts are doubles (exact for whole
+/// numbers up to 2^53) so that decay() can weight them. Default-constructed, the arrays grow
+/// to the largest n recorded. Constructed with n_max, cells 0..n_max are allocated
+/// once and every queue above n_max shares one overflow cell, so recordSojourn()
+/// never allocates: the configuration for calibration passes.
 struct IntensityEstimator {
-    /// Reset for a new calibration run.
+    static constexpr uint32_t kUnbounded = std::numeric_limits<uint32_t>::max();
+    static constexpr size_t kTypes = static_cast<size_t>(EventType::COUNT);
+
+    IntensityEstimator() = default;
+    /// Fixed range: cells 0..n_max plus the overflow cell for n > n_max.
+    explicit IntensityEstimator(uint32_t n_max);
+
+    /// Reset for a new calibration run (a fixed range keeps its cells).
     void reset();
 
     /// Record a sojourn: queue size n, dwell time dt_sec, and event type that occurred.
-    void recordSojourn(uint32_t n, double dt_sec, EventType type);
+    void recordSojourn(uint32_t n, double dt_sec, EventType type) {
+        size_t idx = n;
+        if (n_max_ != kUnbounded) {
+            if (idx > n_max_) idx = static_cast<size_t>(n_max_) + 1;
+        } else if (idx >= sum_dt_.size()) {
+            grow(idx + 1);
+        }
+        sum_dt_[idx] += dt_sec;
+        count_[idx] += 1.0;
+        const size_t ti = static_cast<size_t>(type);
+        if (ti < kTypes) count_by_type_[ti][idx] += 1.0;
+    }
+
+    /// Adds other's sojourns to this one's, as if they had been recorded here:
+    /// the reduction step of a parallel calibration. Estimators with the same range
+    /// merge as plain array sums; a fixed range folds other's cells above n_max
+    /// into its overflow cell. (Across different ranges, other's overflow cell
+    /// counts as the queue size it is stored at, n_max + 1.)
+    void merge(const IntensityEstimator& other);
+
+    /// Scales every dwell-time sum and count by factor in (0, 1]: observations
+    /// recorded so far then weigh factor as much as new ones. Repeated with
+    /// factor = 2^(-elapsed / half_life) it makes an exponentially-weighted
+    /// estimator; the rate estimates themselves are unchanged by a decay.
+    void decay(double factor);
 
     /// Compute Λ̂(n) = 1 / mean(Δt | q=n). Returns 0 if no observations for n.
+    /// With a fixed range, every n > n_max reads the pooled overflow cell.
     double lambdaTotal(uint32_t n) const;
 
     /// Compute λ̂ for given type at queue size n. Returns 0 if no observations.
     double lambdaType(uint32_t n, EventType type) const;
 
-    /// Maximum n with any observations.
+    /// Summed (weighted) dwell time at queue size n: how long the queue sat there.
+    double dwellTime(uint32_t n) const {
+        const size_t i = cellOf(n);
+        return i < cells() ? sum_dt_[i] : 0.0;
+    }
+
+    /// Maximum n with any observations (n_max + 1 if only the overflow cell has
+    /// observations above n_max).
     size_t nMaxObserved() const;
 
+    /// kUnbounded unless constructed with a fixed range.
+    uint32_t nMax() const { return n_max_; }
+
 private:
-    struct Cell {
-        double sum_dt = 0.0;
-        uint64_t count = 0;
-        uint64_t count_by_type[static_cast<size_t>(EventType::COUNT)] = {};
-    };
-    std::vector<Cell> cells_;
+    void grow(size_t cells);
+    /// Cell holding queue size n, or cells() if none.
+    size_t cellOf(uint32_t n) const;
+    size_t cells() const { return sum_dt_.size(); }
+
+    uint32_t n_max_ = kUnbounded;
+    std::vector<double> sum_dt_;
+    std::vector<double> count_;
+    std::vector<double> count_by_type_[kTypes];
 };
 
 }  // namespace qrsdp
@@ -0,0 +1,179 @@
+#include "calibration/online_calibrator.h"
+
+#include "book/multi_level_book.h"
+#include "core/event_types.h"
+#include "core/records.h"
+#include "model/intensity_curve.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace qrsdp {
+
+struct OnlineCalibrator::SymbolState {
+    LevelEstimators estimators;
+    std::unique_ptr<SojournReplay> replay;  // current session
+    uint64_t last_ts_ns = 0;
+    double clock = 0.0;          // event time seen, summed over sessions (seconds)
+    double decayed_at = 0.0;     // clock at the last decay
+    uint64_t events = 0;
+    uint64_t published_events = 0;
+    uint32_t sessions = 0;
+    uint64_t resyncs = 0;
+    bool has_published = false;
+    HLRParams last_published;
+
+    SymbolState(size_t levels, uint32_t n_max) : estimators(levels, n_max) {}
+};
+
+OnlineCalibrator::OnlineCalibrator(const OnlineCalibrationConfig& config) : config_(config) {
+    config_.levels = std::max(config_.levels, 1);
+    config_.n_max = std::max(config_.n_max, 0);
+}
+
+OnlineCalibrator::~OnlineCalibrator() = default;
+
+void OnlineCalibrator::startSession(SymbolState& s, int32_t p0_ticks, uint64_t open_ns,
+                                    uint32_t spread_ticks) {
+    FileHeader header{};
+    header.p0_ticks = p0_ticks;
+    header.levels_per_side = static_cast<uint32_t>(config_.levels);
+    header.initial_spread_ticks = spread_ticks > 0 ? spread_ticks : config_.initial_spread_ticks;
+    header.initial_depth = config_.initial_depth;
+    header.market_open_ns = open_ns;
+    s.replay = std::make_unique<SojournReplay>(header, config_.levels, s.estimators);
+}
+
+void OnlineCalibrator::resync(SymbolState& s, int32_t bid, int32_t ask, uint64_t ts_ns) {
+    // The book's seed puts the best bid spread/2 below p0.
+    const uint32_t spread = static_cast<uint32_t>(ask - bid);
+    startSession(s, bid + static_cast<int32_t>(spread / 2), ts_ns, spread);
+    ++s.resyncs;
+}
+
+int32_t OnlineCalibrator::p0Quoting(const DiskEventRecord& rec) const {
+    // The book's seed puts the best bid spread/2 below p0, the best ask the rest above.
+    const uint32_t spread = config_.initial_spread_ticks > 0 ? config_.initial_spread_ticks : 2u;
+    const int32_t half = static_cast<int32_t>(spread / 2);
+    return static_cast<Side>(rec.side) == Side::BID ? rec.price_ticks + half
+                                                    : rec.price_ticks - (static_cast<int32_t>(spread) - half);
+}
+
+OnlineCalibrator::SymbolState& OnlineCalibrator::stateFor(const std::string& symbol,
+                                                          const DiskEventRecord& first) {
+    if (last_ && *last_key_ == symbol) return *last_;
+    auto it = symbols_.find(symbol);
+    if (it == symbols_.end()) {
+        auto state = std::make_unique<SymbolState>(static_cast<size_t>(config_.levels),
+                                                   static_cast<uint32_t>(config_.n_max));
+        const int32_t p0 = config_.p0_ticks != 0 ? config_.p0_ticks : p0Quoting(first);
+        startSession(*state, p0, first.ts_ns);
+        state->sessions = 1;
+        state->last_ts_ns = first.ts_ns;
+        it = symbols_.emplace(symbol, std::move(state)).first;
+    }
+    last_ = it->second.get();
+    last_key_ = &it->first;
+    return *last_;
+}
+
+void OnlineCalibrator::apply(const std::string& symbol, const DiskEventRecord& rec) {
+    SymbolState& s = stateFor(symbol, rec);
+    const MultiLevelBook& book = s.replay->replayer().book();
+    if (rec.ts_ns < s.last_ts_ns) {
+        // A new session: chained runs open at the previous close's mid.
+        startSession(s, (book.bestBid().price_ticks + book.bestAsk().price_ticks) / 2, rec.ts_ns);
+        ++s.sessions;
+    } else {
+        s.clock += static_cast<double>(rec.ts_ns - s.last_ts_ns) * 1e-9;
+        // Executions trade at the touch: one elsewhere means the seeded book (a
+        // guessed p0, a stream joined mid-session) is off. Reseed it there.
+        const auto type = static_cast<EventType>(rec.type);
+        const int32_t bid = book.bestBid().price_ticks;
+        const int32_t ask = book.bestAsk().price_ticks;
+        if (type == EventType::EXECUTE_BUY && rec.price_ticks != ask) {
+            resync(s, bid < rec.price_ticks ? bid : rec.price_ticks - 1, rec.price_ticks, rec.ts_ns);
+        } else if (type == EventType::EXECUTE_SELL && rec.price_ticks != bid) {
+            resync(s, rec.price_ticks, ask > rec.price_ticks ? ask : rec.price_ticks + 1, rec.ts_ns);
+        }
+    }
+    s.last_ts_ns = rec.ts_ns;
+    s.replay->apply(rec);
+    ++s.events;
+}
+
+void OnlineCalibrator::apply(const std::string& symbol, const DiskEventRecord* recs, size_t n) {
+    for (size_t i = 0; i < n; ++i) apply(symbol, recs[i]);
+}
+
+std::vector<SymbolCalibration> OnlineCalibrator::publish(const HLRParams* reference) {
+    std::vector<SymbolCalibration> out;
+    for (auto& [symbol, state] : symbols_) {
+        SymbolState& s = *state;
+        if (s.events == s.published_events) continue;
+        if (config_.half_life_seconds > 0.0 && s.clock > s.decayed_at) {
+            const double factor = std::exp2(-(s.clock - s.decayed_at) / config_.half_life_seconds);
+            for (IntensityEstimator& e : s.estimators.bid) e.decay(factor);
+            for (IntensityEstimator& e : s.estimators.ask) e.decay(factor);
+        }
+        s.decayed_at = s.clock;
+
+        SymbolCalibration cal;
+        cal.symbol = symbol;
+        cal.params = fitHLRParams(s.estimators, config_.n_max, config_.spread_sensitivity);
+        cal.first = !s.has_published;
+        cal.drift = s.has_published ? hlrCurveDrift(s.last_published, cal.params, &s.estimators) : 0.0;
+        if (reference) cal.reference_drift = hlrCurveDrift(*reference, cal.params, &s.estimators);
+        cal.events = s.events;
+        cal.sessions = s.sessions;
+        cal.resyncs = s.resyncs;
+        s.last_published = cal.params;
+        s.has_published = true;
+        s.published_events = s.events;
+        out.push_back(std::move(cal));
+    }
+    return out;
+}
+
+namespace {
+
+/// Adds one curve pair's weighted terms to the pooled sums.
+void addCurveDrift(const IntensityCurve& a, const IntensityCurve& b, size_t n_max,
+                   const IntensityEstimator* occupancy, double& diff, double& scale) {
+    for (size_t n = 0; n <= n_max; ++n) {
+        const double w = occupancy ? occupancy->dwellTime(static_cast<uint32_t>(n)) : 1.0;
+        if (!(w > 0.0)) continue;
+        const double va = a.value(n);
+        const double vb = b.value(n);
+        diff += w * std::fabs(va - vb);
+        scale += w * std::max(va, vb);
+    }
+}
+
+}  // namespace
+
+double hlrCurveDrift(const HLRParams& a, const HLRParams& b, const LevelEstimators* occupancy) {
+    if (a.K != b.K) return 1.0;
+    const size_t n_max = static_cast<size_t>(std::max(0, std::min(a.n_max, b.n_max)));
+    double diff = 0.0;
+    double scale = 0.0;
+    // side null: unweighted. Otherwise levels the occupancy lacks are left out.
+    auto add = [&](const IntensityCurve& x, const IntensityCurve& y,
+                   const std::vector<IntensityEstimator>* side, size_t k) {
+        if (side && k >= side->size()) return;
+        addCurveDrift(x, y, n_max, side ? &(*side)[k] : nullptr, diff, scale);
+    };
+    const std::vector<IntensityEstimator>* bid = occupancy ? &occupancy->bid : nullptr;
+    const std::vector<IntensityEstimator>* ask = occupancy ? &occupancy->ask : nullptr;
+    for (size_t k = 0; k < static_cast<size_t>(std::max(a.K, 0)); ++k) {
+        if (k < a.lambda_L_bid.size() && k < b.lambda_L_bid.size()) add(a.lambda_L_bid[k], b.lambda_L_bid[k], bid, k);
+        if (k < a.lambda_L_ask.size() && k < b.lambda_L_ask.size()) add(a.lambda_L_ask[k], b.lambda_L_ask[k], ask, k);
+        if (k < a.lambda_C_bid.size() && k < b.lambda_C_bid.size()) add(a.lambda_C_bid[k], b.lambda_C_bid[k], bid, k);
+        if (k < a.lambda_C_ask.size() && k < b.lambda_C_ask.size()) add(a.lambda_C_ask[k], b.lambda_C_ask[k], ask, k);
+    }
+    add(a.lambda_M_buy, b.lambda_M_buy, ask, 0);
+    add(a.lambda_M_sell, b.lambda_M_sell, bid, 0);
+    return scale > 0.0 ? diff / scale : 0.0;
+}
+
+}  // namespace qrsdp
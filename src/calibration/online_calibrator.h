@@ -0,0 +1,95 @@
+#pragma once
+
+#include "calibration/sojourn_replay.h"
+#include "io/event_log_format.h"
+#include "model/hlr_params.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace qrsdp {
+
+struct OnlineCalibrationConfig {
+    int levels = 5;                     // K of the published curves
+    int n_max = 100;                    // curve tables cover queues 0..n_max
+    double spread_sensitivity = 0.3;    // written into the published params
+    double half_life_seconds = 3600.0;  // sojourn weight halves per this much event time; <= 0 = no decay
+    int32_t p0_ticks = 0;               // opening mid of a symbol's first session; 0 = from its first record
+    uint32_t initial_spread_ticks = 2;  // book seed, as the producer's session (0 = book default)
+    uint32_t initial_depth = 5;
+};
+
+/// One symbol's refreshed calibration.
+struct SymbolCalibration {
+    std::string symbol;
+    HLRParams params;
+    double drift = 0.0;       // hlrCurveDrift from the symbol's previous publish (0 on the first)
+    double reference_drift = -1.0;  // hlrCurveDrift from publish()'s reference; -1 without one
+    bool first = true;        // no previous publish to compare with
+    uint64_t events = 0;      // records applied since the symbol was first seen
+    uint32_t sessions = 0;    // sessions (days) seen
+    uint64_t resyncs = 0;     // book reseeds at an execution off the replayed touch
+};
+
+/// Streaming calibration of many symbols from records in arrival order, as a
+/// consumer of the KafkaSink topic sees them. Each symbol keeps a SojournReplay
+/// and exponentially-weighted estimators: publish() first decays them by
+/// 2^(-elapsed / half_life) for the event time elapsed since the last publish
+/// (weights are stepwise, constant within a publish interval), then fits
+/// HLRParams as qrsdp_calibrate would.
+///
+/// Records carry no file header, so the book of a symbol's first session is
+/// seeded from config (p0_ticks = 0 puts the best quote of the first record's
+/// side at its price); when the timestamps step back a new session begins and the
+/// book is reseeded at the previous session's closing mid, as chained runs open.
+/// A session's sojourns start at its first record. An execution away from the
+/// replayed touch shows the book is off (a guessed p0, a stream joined
+/// mid-session): the book is reseeded around it and the sojourns restart. Until
+/// the deeper levels have turned over their depths are the seed's, so early
+/// sojourns are approximate until the decay retires them.
+class OnlineCalibrator {
+public:
+    explicit OnlineCalibrator(const OnlineCalibrationConfig& config);
+    ~OnlineCalibrator();
+
+    void apply(const std::string& symbol, const DiskEventRecord& rec);
+    void apply(const std::string& symbol, const DiskEventRecord* recs, size_t n);
+
+    /// Decays and refits every symbol with records since its last publish; with
+    /// reference, also measures each fit's drift from it.
+    std::vector<SymbolCalibration> publish(const HLRParams* reference = nullptr);
+
+    size_t symbolCount() const { return symbols_.size(); }
+    const OnlineCalibrationConfig& config() const { return config_; }
+
+private:
+    struct SymbolState;
+    SymbolState& stateFor(const std::string& symbol, const DiskEventRecord& first);
+    /// spread_ticks 0: config's initial spread.
+    void startSession(SymbolState& s, int32_t p0_ticks, uint64_t open_ns, uint32_t spread_ticks = 0);
+    /// Reseeds s's book with its touch at (bid, ask).
+    void resync(SymbolState& s, int32_t bid, int32_t ask, uint64_t ts_ns);
+    /// p0 of a seeded book whose best quote on rec's side is at rec's price.
+    int32_t p0Quoting(const DiskEventRecord& rec) const;
+
+    OnlineCalibrationConfig config_;
+    std::map<std::string, std::unique_ptr<SymbolState>> symbols_;
+    SymbolState* last_ = nullptr;       // the last symbol applied: consecutive records usually share it
+    const std::string* last_key_ = nullptr;
+};
+
+/// How far two curve sets are apart: the share of intensity that moved,
+/// sum |a(n) - b(n)| / sum max(a(n), b(n)) pooled over every curve both hold and
+/// n = 0..min n_max. With occupancy, each (level, side, n) term is weighted by the
+/// time its queue sat at n (occupancy's dwell times; market orders by level 0), so
+/// rarely visited queue sizes, whose estimates rest on a few sojourns, barely count.
+/// 0 for identical curves, 1 when one is zero wherever the other is not or the K
+/// differ.
+double hlrCurveDrift(const HLRParams& a, const HLRParams& b,
+                     const LevelEstimators* occupancy = nullptr);
+
+}  // namespace qrsdp
@@ -0,0 +1,116 @@
+#include "calibration/sojourn_replay.h"
+
+#include "core/event_types.h"
+#include "core/records.h"
+#include "model/intensity_curve.h"
+
+#include <algorithm>
+
+namespace qrsdp {
+
+void LevelEstimators::merge(const LevelEstimators& other) {
+    for (size_t k = 0; k < std::min(bid.size(), other.bid.size()); ++k) bid[k].merge(other.bid[k]);
+    for (size_t k = 0; k < std::min(ask.size(), other.ask.size()); ++k) ask[k].merge(other.ask[k]);
+    events += other.events;
+    sojourns += other.sojourns;
+}
+
+namespace {
+
+IntensityCurve extractCurve(const IntensityEstimator& est, EventType type, int n_table) {
+    std::vector<double> values;
+    values.reserve(static_cast<size_t>(n_table + 1));
+    for (int n = 0; n <= n_table; ++n) values.push_back(est.lambdaType(static_cast<uint32_t>(n), type));
+    IntensityCurve curve;
+    curve.setTable(std::move(values), IntensityCurve::TailRule::FLAT);
+    return curve;
+}
+
+}  // namespace
+
+HLRParams fitHLRParams(const LevelEstimators& est, int n_max, double spread_sensitivity) {
+    const size_t ku = est.bid.size();
+    HLRParams params;
+    params.K = static_cast<int>(ku);
+    params.n_max = n_max;
+    params.spread_sensitivity = spread_sensitivity;
+    params.lambda_L_bid.resize(ku);
+    params.lambda_L_ask.resize(ku);
+    params.lambda_C_bid.resize(ku);
+    params.lambda_C_ask.resize(ku);
+    for (size_t k = 0; k < ku; ++k) {
+        params.lambda_L_bid[k] = extractCurve(est.bid[k], EventType::ADD_BID, n_max);
+        params.lambda_L_ask[k] = extractCurve(est.ask[k], EventType::ADD_ASK, n_max);
+        params.lambda_C_bid[k] = extractCurve(est.bid[k], EventType::CANCEL_BID, n_max);
+        params.lambda_C_ask[k] = extractCurve(est.ask[k], EventType::CANCEL_ASK, n_max);
+    }
+    if (ku > 0) {
+        params.lambda_M_buy = extractCurve(est.ask[0], EventType::EXECUTE_BUY, n_max);
+        params.lambda_M_sell = extractCurve(est.bid[0], EventType::EXECUTE_SELL, n_max);
+    }
+    return params;
+}
+
+SojournReplay::SojournReplay(const FileHeader& header, int levels, LevelEstimators& out,
+                             const BookCheckpoint* start)
+    : replayer_(header, start), out_(out) {
+    const int file_K = static_cast<int>(header.levels_per_side);
+    use_K_ = std::max(0, std::min(levels, file_K > 0 ? file_K : levels));
+    // Sojourns open with the session, not at ts 0 (records carry the market open).
+    last_shift_time_ = static_cast<double>(start ? start->ts_ns : header.market_open_ns) * 1e-9;
+    bid_last_event_.assign(static_cast<size_t>(use_K_), last_shift_time_);
+    ask_last_event_.assign(static_cast<size_t>(use_K_), last_shift_time_);
+}
+
+void SojournReplay::apply(const DiskEventRecord& rec) {
+    ++out_.events;
+    const double t = static_cast<double>(rec.ts_ns) * 1e-9;
+    const BookReplayer::Step step = replayer_.apply(rec);
+    if (step.level >= 0 && step.level < use_K_) {
+        const size_t lk = static_cast<size_t>(step.level);
+        double& last = step.bid ? bid_last_event_[lk] : ask_last_event_[lk];
+        const double dt = t - std::max(last, last_shift_time_);
+        if (dt > 0.0) {
+            IntensityEstimator& estimator = step.bid ? out_.bid[lk] : out_.ask[lk];
+            estimator.recordSojourn(step.depth_before, dt, static_cast<EventType>(rec.type));
+            ++out_.sojourns;
+        }
+        last = t;
+    }
+    // Levels renumber on a shift: every sojourn restarts here instead of each
+    // tracker being rewritten.
+    if (step.shifted) last_shift_time_ = t;
+}
+
+std::vector<CalibrationSegment> planSegments(const EventLogReader& reader, size_t file,
+                                             bool split_at_checkpoints) {
+    const uint64_t total = reader.totalRecords();
+    std::vector<CalibrationSegment> out;
+    CalibrationSegment seg;
+    seg.file = file;
+    if (split_at_checkpoints) {
+        const std::vector<BookCheckpoint>& cps = reader.checkpoints();
+        for (size_t i = 0; i < cps.size(); ++i) {
+            const uint64_t at = cps[i].record_index;
+            if (at <= seg.first_record || at >= total) continue;
+            seg.end_record = at;
+            out.push_back(seg);
+            seg.first_record = at;
+            seg.checkpoint = static_cast<int>(i);
+        }
+    }
+    seg.end_record = total;
+    out.push_back(seg);
+    return out;
+}
+
+void replaySegment(const EventLogReader& reader, const CalibrationSegment& seg, int levels,
+                   LevelEstimators& out) {
+    const BookCheckpoint* start = seg.checkpoint >= 0
+        ? &reader.checkpoints()[static_cast<size_t>(seg.checkpoint)] : nullptr;
+    SojournReplay replay(reader.header(), levels, out, start);
+    reader.forEachRecordBetween(seg.first_record, seg.end_record,
+                                [&replay](const DiskEventRecord& rec) { replay.apply(rec); });
+}
+
+}  // namespace qrsdp
@@ -0,0 +1,84 @@
+#pragma once
+
+#include "calibration/intensity_estimator.h"
+#include "io/book_checkpoint.h"
+#include "io/book_replayer.h"
+#include "io/event_log_format.h"
+#include "io/event_log_reader.h"
+#include "model/hlr_params.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace qrsdp {
+
+/// Per-(level, side) estimators of a calibration pass: K each for bid and ask.
+/// Market orders are recorded into the level-0 estimators as EXECUTE_SELL (bid)
+/// and EXECUTE_BUY (ask).
+struct LevelEstimators {
+    std::vector<IntensityEstimator> bid;
+    std::vector<IntensityEstimator> ask;
+    uint64_t events = 0;    // records replayed
+    uint64_t sojourns = 0;  // sojourns recorded
+
+    /// n_max: see IntensityEstimator(n_max); kUnbounded lets the cells grow.
+    explicit LevelEstimators(size_t levels = 0, uint32_t n_max = IntensityEstimator::kUnbounded)
+        : bid(levels, IntensityEstimator(n_max)), ask(levels, IntensityEstimator(n_max)) {}
+
+    /// Adds other's sojourns and counts level by level (levels other lacks are
+    /// left as they are).
+    void merge(const LevelEstimators& other);
+};
+
+/// HLR curves from est: one table per level and side for queues 0..n_max (flat
+/// tail), K = est.bid.size(); market orders from the level-0 estimators.
+HLRParams fitHLRParams(const LevelEstimators& est, int n_max, double spread_sensitivity);
+
+/// Replays one log's records, in order, through a BookReplayer and records each
+/// (level, side)'s sojourns into a LevelEstimators. A sojourn runs from the
+/// level's previous event, or the last price shift if later (levels renumber on
+/// a shift), to its next event, at the depth the book holds just before it.
+class SojournReplay {
+public:
+    /// Estimates levels 0..levels-1 (capped at the file's levels_per_side).
+    /// Sojourns start at the header's market open or, with start, the book is
+    /// restored from that checkpoint and they start at its timestamp, as they do
+    /// after a price shift.
+    /// Throws std::runtime_error if the book cannot restore start's levels.
+    SojournReplay(const FileHeader& header, int levels, LevelEstimators& out,
+                  const BookCheckpoint* start = nullptr);
+
+    void apply(const DiskEventRecord& rec);
+
+    const BookReplayer& replayer() const { return replayer_; }
+
+private:
+    BookReplayer replayer_;
+    LevelEstimators& out_;
+    int use_K_;
+    double last_shift_time_ = 0.0;
+    std::vector<double> bid_last_event_;  // per level: time of its last event
+    std::vector<double> ask_last_event_;
+};
+
+/// A contiguous record range of one input file: the unit of work of a parallel
+/// calibration.
+struct CalibrationSegment {
+    size_t file = 0;            // index into the input list
+    uint64_t first_record = 0;
+    uint64_t end_record = 0;    // exclusive
+    int checkpoint = -1;        // reader.checkpoints() index the range starts at; -1 = opening book
+};
+
+/// The whole file as one segment or, with split_at_checkpoints, one segment per
+/// interval between the file's book checkpoints (a single segment if it has none).
+std::vector<CalibrationSegment> planSegments(const EventLogReader& reader, size_t file,
+                                             bool split_at_checkpoints);
+
+/// Streams seg's records of reader through a SojournReplay into out, one chunk
+/// in memory at a time.
+void replaySegment(const EventLogReader& reader, const CalibrationSegment& seg, int levels,
+                   LevelEstimators& out);
+
+}  // namespace qrsdp
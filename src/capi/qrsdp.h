@@ -0,0 +1,374 @@
+/*
+ * libqrsdp — stable C ABI over the simulator, for in-process callers (Python
+ * ctypes/cffi, other languages) that would otherwise spawn qrsdp_run and parse
+ * its files back.
+ *
+ * Three entry points:
+ *   - Sessions: one handle per trading session (QrsdpProducer + MultiLevelBook),
+ *     pulled in batches with qrsdp_session_next() or pushed through a callback
+ *     with qrsdp_session_run(). Nothing touches the disk.
+ *   - Runs: qrsdp_run() drives SessionRunner over a multi-day config, writing
+ *     the same day files and manifest.json as qrsdp_run, and hands back the
+ *     per-day results (event counts, close prices) without re-reading them.
+ *   - Logs: qrsdp_log_open() wraps EventLogReader, so callers read .qrsdp files
+ *     (any version, codec or layout the C++ reader supports) into record
+ *     buffers the library owns, which bindings expose without copying.
+ *   - Frames: qrsdp_frames_open() replays a .qrsdp file into downsampled book
+ *     frames (io/book_frame.h) for live displays that should not see every event.
+ *     A run with live_frames set publishes the same frames to a shared-memory
+ *     ring while it generates; qrsdp_feed_attach() follows it from any process.
+ *   - Event bus: qrsdp_bus_attach() reads every record a qrsdp_run --shm-ring
+ *     run publishes, in sequence-numbered batches (io/shm_ring_sink.h).
+ *
+ * ABI rules: handles are opaque; config structs start with struct_size and are
+ * filled by their *_init() function, so fields can be appended without breaking
+ * older callers; qrsdp_event is the 26-byte .qrsdp DiskEventRecord. Functions
+ * that can fail return a negative status (or NULL) and leave a message for
+ * qrsdp_last_error() on the calling thread. A handle is not thread-safe; distinct
+ * handles may be used from different threads.
+ */
+#ifndef QRSDP_CAPI_H
+#define QRSDP_CAPI_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(_WIN32)
+#  if defined(QRSDP_CAPI_BUILD)
+#    define QRSDP_API __declspec(dllexport)
+#  else
+#    define QRSDP_API __declspec(dllimport)
+#  endif
+#else
+#  define QRSDP_API __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Bumped on any incompatible change; compare with qrsdp_abi_version() at load time. */
+#define QRSDP_ABI_VERSION 1
+
+enum {
+    QRSDP_OK = 0,
+    QRSDP_ERR_INVALID = -1,  /* bad argument or config */
+    QRSDP_ERR_IO = -2,       /* a file could not be read or written */
+    QRSDP_ERR_INTERNAL = -3  /* anything else the simulator threw */
+};
+
+enum { QRSDP_MODEL_SIMPLE = 0, QRSDP_MODEL_HLR = 1, QRSDP_MODEL_HAWKES = 2 };
+
+/* One event, byte-compatible with DiskEventRecord (and notebooks' RECORD_DTYPE). */
+#pragma pack(push, 1)
+typedef struct qrsdp_event {
+    uint64_t ts_ns;
+    uint8_t  type;   /* EventType: 0 ADD_BID .. 5 EXECUTE_SELL */
+    uint8_t  side;   /* 0 bid, 1 ask */
+    int32_t  price_ticks;
+    uint32_t qty;
+    uint64_t order_id;
+} qrsdp_event;
+#pragma pack(pop)
+
+/* Best bid/ask after an event. */
+typedef struct qrsdp_top {
+    int32_t  bid_ticks;
+    uint32_t bid_depth;
+    int32_t  ask_ticks;
+    uint32_t ask_depth;
+} qrsdp_top;
+
+typedef struct qrsdp_level {
+    int32_t  price_ticks;
+    uint32_t depth;
+} qrsdp_level;
+
+typedef struct qrsdp_session_config {
+    uint32_t struct_size;           /* set by qrsdp_session_config_init */
+    uint32_t model;                 /* QRSDP_MODEL_*; HLR and HAWKES use the default curves / kernels */
+    uint64_t seed;
+    int32_t  p0_ticks;
+    uint32_t tick_size;
+    uint32_t session_seconds;
+    uint32_t levels_per_side;
+    uint32_t initial_spread_ticks;
+    uint32_t initial_depth;
+    uint32_t market_open_seconds;
+    /* IntensityParams (SIMPLE model) */
+    double   base_L;
+    double   base_C;
+    double   base_M;
+    double   imbalance_sensitivity;
+    double   cancel_sensitivity;
+    double   epsilon_exec;
+    double   spread_sensitivity;
+} qrsdp_session_config;
+
+typedef struct qrsdp_session_stats {
+    uint64_t events;
+    uint64_t shifts;        /* mid-price moves */
+    double   sim_seconds;   /* simulated time since the open */
+    int32_t  finished;      /* non-zero once the session end has been reached */
+    int32_t  reserved;
+} qrsdp_session_stats;
+
+typedef struct qrsdp_session qrsdp_session;
+
+/* Return non-zero to stop qrsdp_session_run after this batch. */
+typedef int (*qrsdp_event_callback)(const qrsdp_event* events, size_t count, void* user);
+
+typedef struct qrsdp_run_config {
+    uint32_t struct_size;           /* set by qrsdp_run_config_init */
+    uint32_t num_days;              /* >= 1 */
+    const char* output_dir;         /* required; created if missing */
+    const char* run_id;             /* NULL: "run_<base_seed>" */
+    const char* start_date;         /* "YYYY-MM-DD" */
+    const char* symbol;             /* NULL or "": single-security layout */
+    uint64_t base_seed;
+    uint32_t threads;               /* day-scheduler workers; 0 = all cores */
+    uint32_t columnar;              /* non-zero: v1.1 columnar chunks */
+    const uint32_t* bar_seconds;    /* footer OHLC resolutions; count 0 = none */
+    uint32_t bar_seconds_count;
+    uint32_t reserved;
+    qrsdp_session_config session;   /* per-day parameters; session.seed is ignored */
+    /* Appended in the live-frames revision; older callers' struct_size stops above. */
+    uint32_t realtime;              /* non-zero: pace events to simulated time */
+    uint32_t live_recent_events;    /* records carried by each live frame */
+    double   speed;                 /* realtime: simulated seconds per wall second */
+    const char* live_frames;        /* NULL or "": off; else the ring file to publish to */
+    uint64_t live_frame_interval_ns;
+    uint64_t live_ring_bytes;
+} qrsdp_run_config;
+
+typedef struct qrsdp_day_info {
+    const char* symbol;             /* "" for single-security runs */
+    const char* date;
+    const char* filename;           /* relative to output_dir */
+    uint64_t seed;
+    int32_t  open_ticks;
+    int32_t  close_ticks;
+    uint64_t events;
+    uint64_t file_size_bytes;
+} qrsdp_day_info;
+
+typedef struct qrsdp_run_result qrsdp_run_result;
+
+typedef struct qrsdp_log qrsdp_log;
+typedef struct qrsdp_records qrsdp_records;
+typedef struct qrsdp_frames qrsdp_frames;
+typedef struct qrsdp_feed qrsdp_feed;
+typedef struct qrsdp_bus qrsdp_bus;
+
+/* Live feed message kinds (FrameRingKind). */
+enum {
+    QRSDP_FEED_BOOK_FRAME = 1,  /* a book frame, as from qrsdp_frames_next */
+    QRSDP_FEED_DAY_START = 2,   /* qrsdp_day_start */
+    QRSDP_FEED_DAY_END = 3      /* qrsdp_day_end */
+};
+
+/* qrsdp_feed_next results. */
+enum { QRSDP_FEED_EMPTY = 0, QRSDP_FEED_MESSAGE = 1, QRSDP_FEED_CLOSED = 2 };
+
+#pragma pack(push, 1)
+typedef struct qrsdp_day_start {
+    uint32_t day_index;
+    uint32_t num_days;              /* 0: continuous run */
+    uint64_t market_open_ns;
+    int32_t  open_ticks;
+    uint32_t tick_size;
+    char     date[12];
+    char     symbol[12];
+} qrsdp_day_start;
+
+typedef struct qrsdp_day_end {
+    uint32_t day_index;
+    int32_t  close_ticks;
+    uint64_t events;
+} qrsdp_day_end;
+
+/* EventBatchHeader: the records that follow are first_seq .. first_seq + count - 1. */
+typedef struct qrsdp_bus_batch {
+    uint64_t first_seq;
+    uint32_t count;
+    uint16_t security;
+    uint16_t reserved;
+    char     symbol[16];
+    char     date[16];
+} qrsdp_bus_batch;
+#pragma pack(pop)
+
+/* FileHeader fields plus the chunk index totals. */
+typedef struct qrsdp_log_info {
+    uint16_t version_major;
+    uint16_t version_minor;
+    uint32_t header_flags;
+    uint64_t seed;
+    int32_t  p0_ticks;
+    uint32_t tick_size;
+    uint32_t session_seconds;
+    uint32_t levels_per_side;
+    uint32_t initial_spread_ticks;
+    uint32_t initial_depth;
+    uint32_t chunk_capacity;
+    uint32_t chunk_count;
+    uint64_t market_open_ns;
+    uint64_t total_records;
+} qrsdp_log_info;
+
+/* Footer stats totals (EventLogReader::stats()): records per event type in
+ * qrsdp_event type order, price range, executed qty and flagged shifts/reinits. */
+typedef struct qrsdp_log_stats {
+    uint64_t type_counts[6];
+    int32_t  min_price_ticks;
+    int32_t  max_price_ticks;
+    uint64_t executed_qty;
+    uint64_t shifts_up;
+    uint64_t shifts_down;
+    uint64_t reinits;
+} qrsdp_log_stats;
+
+/* One footer OHLC bar, byte-compatible with DiskBar (notebooks' BAR_DTYPE).
+ * Mids are doubled: best bid + best ask. */
+#pragma pack(push, 1)
+typedef struct qrsdp_bar {
+    uint64_t start_ns;
+    int32_t  open_mid2;
+    int32_t  high_mid2;
+    int32_t  low_mid2;
+    int32_t  close_mid2;
+    int32_t  close_bid_ticks;
+    int32_t  close_ask_ticks;
+    uint32_t events;
+    uint32_t executions;
+    uint32_t volume;
+    uint32_t reserved;
+} qrsdp_bar;
+#pragma pack(pop)
+
+QRSDP_API uint32_t qrsdp_abi_version(void);
+
+/* Message for the last failed call on this thread ("" if none). Valid until the
+ * thread's next failing call. */
+QRSDP_API const char* qrsdp_last_error(void);
+
+/* qrsdp_run's defaults: seed 42, p0 10000, 23400 s, 5 levels, spread 2, depth 5,
+ * open 09:30, SIMPLE with {20, 0.5, 15, 1, 1, 0.5, 0.4}. */
+QRSDP_API void qrsdp_session_config_init(qrsdp_session_config* config);
+
+/* NULL on invalid config (see qrsdp_last_error). */
+QRSDP_API qrsdp_session* qrsdp_session_create(const qrsdp_session_config* config);
+QRSDP_API void qrsdp_session_destroy(qrsdp_session* session);
+
+/* Generates up to max events into out; with tops non-NULL, tops[i] is the book
+ * top after out[i] (slower: one event at a time). Returns the count, 0 once the
+ * session has ended, or a negative status. */
+QRSDP_API int64_t qrsdp_session_next(qrsdp_session* session, qrsdp_event* out, size_t max,
+                                     qrsdp_top* tops);
+
+/* Generates the rest of the session, handing callback batches of up to
+ * batch_size events (0 = 4096). Returns the events generated or a negative status. */
+QRSDP_API int64_t qrsdp_session_run(qrsdp_session* session, qrsdp_event_callback callback,
+                                    void* user, size_t batch_size);
+
+/* Current book, best level first: fills up to max_levels of each side and
+ * returns the number filled (levels_per_side when max_levels allows). */
+QRSDP_API int64_t qrsdp_session_book(const qrsdp_session* session, qrsdp_level* bids,
+                                     qrsdp_level* asks, size_t max_levels);
+
+QRSDP_API int qrsdp_session_stats_get(const qrsdp_session* session, qrsdp_session_stats* out);
+
+/* qrsdp_run's defaults: 1 day from 2026-01-02, base seed 42, bars 1/60/300 s,
+ * session as qrsdp_session_config_init, speed 100, live frames every 50 ms with
+ * 8 records in a 4 MiB ring. output_dir must still be set. */
+QRSDP_API void qrsdp_run_config_init(qrsdp_run_config* config);
+
+/* Runs every day and writes manifest.json. NULL on failure. With live_frames
+ * set, the first security's book frames are published to that ring as they are
+ * generated (see qrsdp_feed_attach); call from a worker thread to follow it. */
+QRSDP_API qrsdp_run_result* qrsdp_run(const qrsdp_run_config* config);
+QRSDP_API void qrsdp_run_result_free(qrsdp_run_result* result);
+
+QRSDP_API uint64_t qrsdp_run_result_total_events(const qrsdp_run_result* result);
+QRSDP_API double qrsdp_run_result_elapsed_seconds(const qrsdp_run_result* result);
+QRSDP_API size_t qrsdp_run_result_day_count(const qrsdp_run_result* result);
+/* Strings stay valid until qrsdp_run_result_free. */
+QRSDP_API int qrsdp_run_result_day(const qrsdp_run_result* result, size_t index,
+                                   qrsdp_day_info* out);
+
+/* Maps a .qrsdp file. threads > 1 decodes whole-file reads on that many
+ * workers (0 or 1: on the calling thread). NULL on failure. */
+QRSDP_API qrsdp_log* qrsdp_log_open(const char* path, uint32_t threads);
+QRSDP_API void qrsdp_log_close(qrsdp_log* log);
+QRSDP_API int qrsdp_log_get_info(const qrsdp_log* log, qrsdp_log_info* out);
+/* Fills out from the footer without decoding any chunk; QRSDP_ERR_INVALID if the
+ * file has no stats block (older or resumed files). */
+QRSDP_API int qrsdp_log_get_stats(const qrsdp_log* log, qrsdp_log_stats* out);
+
+/* Record numbers [first_record, end_record) in file order; end_record past the
+ * end stops at the last record. NULL on failure. */
+QRSDP_API qrsdp_records* qrsdp_log_read(const qrsdp_log* log, uint64_t first_record,
+                                        uint64_t end_record);
+/* Every record of chunks [first_chunk, end_chunk). */
+QRSDP_API qrsdp_records* qrsdp_log_read_chunks(const qrsdp_log* log, uint32_t first_chunk,
+                                               uint32_t end_chunk);
+/* Exactly the records with ts_start <= ts_ns <= ts_end (EventLogReader::select). */
+QRSDP_API qrsdp_records* qrsdp_log_select(const qrsdp_log* log, uint64_t ts_start,
+                                          uint64_t ts_end);
+
+/* A record buffer stays valid, and its data pointer fixed, until freed; it
+ * does not depend on the log staying open. */
+QRSDP_API const qrsdp_event* qrsdp_records_data(const qrsdp_records* records);
+QRSDP_API size_t qrsdp_records_count(const qrsdp_records* records);
+QRSDP_API void qrsdp_records_free(qrsdp_records* records);
+
+/* Footer bar resolutions in ascending order: fills up to max and returns how
+ * many the file has. */
+QRSDP_API size_t qrsdp_log_bar_intervals(const qrsdp_log* log, uint64_t* intervals_ns, size_t max);
+/* Sets *bars to the series with this interval (valid while the log is open)
+ * and returns its length; 0 and NULL if the file has no such series. */
+QRSDP_API size_t qrsdp_log_bars(const qrsdp_log* log, uint64_t interval_ns, const qrsdp_bar** bars);
+
+/* Book frames of a .qrsdp file, one per frame_interval_ns of simulated time
+ * that has records, each carrying up to recent_events of the latest records
+ * (wire layout: BookFrameHeader in io/book_frame.h). NULL on failure. */
+QRSDP_API qrsdp_frames* qrsdp_frames_open(const char* path, uint64_t frame_interval_ns,
+                                          uint32_t recent_events);
+QRSDP_API void qrsdp_frames_close(qrsdp_frames* frames);
+/* Sets *frame to the next frame (valid until the next call on this handle) and
+ * returns its size in bytes; 0 after the last frame, or a negative status. */
+QRSDP_API int64_t qrsdp_frames_next(qrsdp_frames* frames, const void** frame);
+/* Changes the interval from the next frame on (e.g. a playback speed change). */
+QRSDP_API int qrsdp_frames_set_interval(qrsdp_frames* frames, uint64_t frame_interval_ns);
+
+/* Attaches to the ring a live run publishes to. The first message is the
+ * current day's QRSDP_FEED_DAY_START, then everything published from now on.
+ * NULL on failure (e.g. the run has not created the ring yet). */
+QRSDP_API qrsdp_feed* qrsdp_feed_attach(const char* path);
+QRSDP_API void qrsdp_feed_close(qrsdp_feed* feed);
+/* Never blocks. On QRSDP_FEED_MESSAGE sets *kind, *data (valid until the next
+ * call on this feed) and *size; QRSDP_FEED_EMPTY: nothing new yet;
+ * QRSDP_FEED_CLOSED: the run finished and everything has been read. A reader
+ * that falls a whole ring behind skips to the newest message. */
+QRSDP_API int qrsdp_feed_next(qrsdp_feed* feed, uint32_t* kind, const void** data, size_t* size);
+/* Times this reader was overtaken and skipped ahead. */
+QRSDP_API uint64_t qrsdp_feed_dropped(const qrsdp_feed* feed);
+
+/* Attaches to an event bus. from_oldest: start at the first batch if the ring
+ * has not wrapped yet; otherwise only batches published from now on. */
+QRSDP_API qrsdp_bus* qrsdp_bus_attach(const char* path, int from_oldest);
+QRSDP_API void qrsdp_bus_close(qrsdp_bus* bus);
+/* Never blocks; returns QRSDP_FEED_MESSAGE, QRSDP_FEED_EMPTY or
+ * QRSDP_FEED_CLOSED like qrsdp_feed_next. On a message, *batch and *records
+ * (batch->count of them) stay valid until the next call on this bus. */
+QRSDP_API int qrsdp_bus_next(qrsdp_bus* bus, const qrsdp_bus_batch** batch, const qrsdp_event** records);
+/* Sequence number the next record should have. */
+QRSDP_API uint64_t qrsdp_bus_cursor(const qrsdp_bus* bus);
+/* Records skipped because the run overtook this reader. */
+QRSDP_API uint64_t qrsdp_bus_lost(const qrsdp_bus* bus);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* QRSDP_CAPI_H */
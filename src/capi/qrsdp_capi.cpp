@@ -0,0 +1,684 @@
+#include "capi/qrsdp.h"
+
+#include "book/multi_level_book.h"
+#include "io/book_frame.h"
+#include "io/frame_ring.h"
+#include "io/shm_ring_sink.h"
+#include "io/event_log_format.h"
+#include "io/event_log_reader.h"
+#include "model/curve_intensity_model.h"
+#include "model/hawkes_intensity_model.h"
+#include "model/hlr_params.h"
+#include "model/simple_imbalance_intensity.h"
+#include "producer/qrsdp_producer.h"
+#include "producer/session_runner.h"
+#include "producer/work_stealing_pool.h"
+#include "rng/mt19937_rng.h"
+#include "sampler/competing_intensity_sampler.h"
+#include "sampler/unit_size_attribute_sampler.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <filesystem>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+static_assert(sizeof(qrsdp_event) == sizeof(qrsdp::DiskEventRecord), "qrsdp_event must match DiskEventRecord");
+static_assert(offsetof(qrsdp_event, price_ticks) == offsetof(qrsdp::DiskEventRecord, price_ticks),
+              "qrsdp_event must match DiskEventRecord");
+static_assert(offsetof(qrsdp_event, order_id) == offsetof(qrsdp::DiskEventRecord, order_id),
+              "qrsdp_event must match DiskEventRecord");
+static_assert(sizeof(qrsdp_bar) == sizeof(qrsdp::DiskBar), "qrsdp_bar must match DiskBar");
+static_assert(sizeof(qrsdp_day_start) == sizeof(qrsdp::LiveDayStart), "qrsdp_day_start must match LiveDayStart");
+static_assert(sizeof(qrsdp_day_end) == sizeof(qrsdp::LiveDayEnd), "qrsdp_day_end must match LiveDayEnd");
+static_assert(sizeof(qrsdp_bus_batch) == sizeof(qrsdp::EventBatchHeader), "qrsdp_bus_batch must match EventBatchHeader");
+static_assert(offsetof(qrsdp_bar, volume) == offsetof(qrsdp::DiskBar, volume), "qrsdp_bar must match DiskBar");
+
+using namespace qrsdp;
+
+namespace {
+
+thread_local std::string g_last_error;
+
+int fail(int status, const std::string& message) {
+    g_last_error = message;
+    return status;
+}
+
+/// Maps the exception in flight to a status and records its message.
+int failCurrent() {
+    try {
+        throw;
+    } catch (const std::invalid_argument& e) {
+        return fail(QRSDP_ERR_INVALID, e.what());
+    } catch (const std::filesystem::filesystem_error& e) {
+        return fail(QRSDP_ERR_IO, e.what());
+    } catch (const std::exception& e) {
+        return fail(QRSDP_ERR_INTERNAL, e.what());
+    } catch (...) {
+        return fail(QRSDP_ERR_INTERNAL, "unknown error");
+    }
+}
+
+constexpr uint32_t kDefaultBarSeconds[] = {1, 60, 300};
+constexpr size_t kDefaultBatch = 4096;
+
+void validate(const qrsdp_session_config& c) {
+    if (c.struct_size < sizeof(qrsdp_session_config))
+        throw std::invalid_argument("session config: struct_size too small (call qrsdp_session_config_init)");
+    if (c.model != QRSDP_MODEL_SIMPLE && c.model != QRSDP_MODEL_HLR && c.model != QRSDP_MODEL_HAWKES)
+        throw std::invalid_argument("session config: unknown model");
+    if (c.p0_ticks <= 0 || c.tick_size == 0 || c.session_seconds == 0 || c.levels_per_side == 0 ||
+        c.initial_spread_ticks == 0)
+        throw std::invalid_argument("session config: p0, tick size, seconds, levels and spread must be positive");
+}
+
+TradingSession toSession(const qrsdp_session_config& c) {
+    TradingSession s{};
+    s.seed = c.seed;
+    s.p0_ticks = c.p0_ticks;
+    s.session_seconds = c.session_seconds;
+    s.levels_per_side = c.levels_per_side;
+    s.tick_size = c.tick_size;
+    s.initial_spread_ticks = c.initial_spread_ticks;
+    s.initial_depth = c.initial_depth;
+    s.market_open_seconds = c.market_open_seconds;
+    s.intensity_params = {c.base_L, c.base_C, c.base_M, c.imbalance_sensitivity,
+                          c.cancel_sensitivity, c.epsilon_exec, c.spread_sensitivity};
+    return s;
+}
+
+std::unique_ptr<IIntensityModel> makeModel(const qrsdp_session_config& c) {
+    if (c.model == QRSDP_MODEL_HLR)
+        return std::make_unique<CurveIntensityModel>(makeDefaultHLRParams(static_cast<int>(c.levels_per_side)));
+    if (c.model == QRSDP_MODEL_HAWKES) {
+        return std::make_unique<HawkesIntensityModel>(
+            makeDefaultHawkesParams(),
+            std::make_shared<const SimpleImbalanceIntensity>(toSession(c).intensity_params));
+    }
+    return std::make_unique<SimpleImbalanceIntensity>(toSession(c).intensity_params);
+}
+
+/// qrsdp_event is byte-compatible with DiskEventRecord (asserted above).
+DiskEventRecord* asDisk(qrsdp_event* out) { return reinterpret_cast<DiskEventRecord*>(out); }
+
+}  // namespace
+
+/// Everything one session needs, built the way SessionRunner builds a day
+/// (Mt19937Rng, MultiLevelBook, competing-intensity sampler), so a handle seeded
+/// with a day's seed produces that day's file.
+struct qrsdp_session {
+    explicit qrsdp_session(const qrsdp_session_config& c)
+        : session(toSession(c)),
+          rng(c.seed),
+          model(makeModel(c)),
+          sampler(rng),
+          attrs(rng, 0.5, 0.5),
+          producer(rng, book, *model, sampler, attrs) {
+        producer.startSession(session);
+    }
+
+    /// Up to max events into out; sets finished once the session end is reached.
+    size_t step(size_t max, qrsdp_event* out, qrsdp_top* tops) {
+        if (finished || max == 0) return 0;
+        size_t n = 0;
+        if (tops) {
+            EventRecord rec;
+            while (n < max && producer.stepEvents(1, &rec) == 1) {
+                *asDisk(out + n) = toDisk(rec);
+                const Level bid = book.bestBid();
+                const Level ask = book.bestAsk();
+                tops[n] = {bid.price_ticks, bid.depth, ask.price_ticks, ask.depth};
+                ++n;
+            }
+        } else {
+            if (scratch.size() < max) scratch.resize(max);
+            n = producer.stepEvents(max, scratch.data());
+            toDisk(scratch.data(), n, asDisk(out));
+        }
+        if (n < max) finished = true;
+        return n;
+    }
+
+    TradingSession session;
+    Mt19937Rng rng;
+    MultiLevelBook book;
+    std::unique_ptr<IIntensityModel> model;
+    CompetingIntensitySampler sampler;
+    UnitSizeAttributeSampler attrs;
+    QrsdpProducer producer;
+    std::vector<EventRecord> scratch;
+    bool finished = false;
+};
+
+struct qrsdp_run_result {
+    RunResult result;
+};
+
+struct qrsdp_log {
+    qrsdp_log(const std::string& path, uint32_t threads) : reader(path) {
+        if (threads > 1) pool = std::make_unique<WorkStealingPool>(threads);
+    }
+
+    EventLogReader reader;
+    std::unique_ptr<WorkStealingPool> pool;  // whole-file reads only
+};
+
+struct qrsdp_records {
+    std::vector<DiskEventRecord> records;
+};
+
+struct qrsdp_feed {
+    explicit qrsdp_feed(const std::string& path) : reader(path) {}
+
+    FrameRingReader reader;
+    std::vector<char> message;
+};
+
+struct qrsdp_bus {
+    qrsdp_bus(const std::string& path, bool from_oldest) : reader(path, from_oldest) {}
+
+    ShmRingReader reader;
+};
+
+struct qrsdp_frames {
+    qrsdp_frames(const std::string& path, const BookFrameOptions& options)
+        : reader(path), builder(reader.header(), options) {}
+
+    /// Feeds records to the builder until it emits a frame; false once every
+    /// record and the final partial frame have been handed out.
+    bool next() {
+        for (;;) {
+            while (pos < span.size)
+                if (builder.add(span[pos++], frame)) return true;
+            if (chunk < reader.chunkCount()) {
+                span = reader.chunkRecords(chunk++, scratch);
+                pos = 0;
+                continue;
+            }
+            return builder.flush(frame);
+        }
+    }
+
+    EventLogReader reader;
+    BookFrameBuilder builder;
+    std::vector<DiskEventRecord> scratch;
+    RecordSpan span;
+    size_t pos = 0;
+    uint32_t chunk = 0;
+    std::vector<char> frame;
+};
+
+namespace {
+
+/// Records [first, end) in file order, one chunk decode each, copied once into out.
+void readRecords(const EventLogReader& reader, uint64_t first, uint64_t end,
+                 std::vector<DiskEventRecord>& out) {
+    std::vector<DiskEventRecord> scratch;
+    uint64_t chunk_first = 0;
+    for (uint32_t i = 0; i < reader.chunkCount() && chunk_first < end; ++i) {
+        const uint64_t chunk_end = chunk_first + reader.index()[i].record_count;
+        if (chunk_end > first) {
+            const RecordSpan span = reader.chunkRecords(i, scratch);
+            const size_t lo = static_cast<size_t>(std::max(first, chunk_first) - chunk_first);
+            const size_t hi = static_cast<size_t>(std::min(end, chunk_end) - chunk_first);
+            out.insert(out.end(), span.begin() + lo, span.begin() + hi);
+        }
+        chunk_first = chunk_end;
+    }
+}
+
+}  // namespace
+
+extern "C" {
+
+uint32_t qrsdp_abi_version(void) { return QRSDP_ABI_VERSION; }
+
+const char* qrsdp_last_error(void) { return g_last_error.c_str(); }
+
+void qrsdp_session_config_init(qrsdp_session_config* config) {
+    if (!config) return;
+    *config = qrsdp_session_config{};
+    config->struct_size = sizeof(qrsdp_session_config);
+    config->model = QRSDP_MODEL_SIMPLE;
+    config->seed = 42;
+    config->p0_ticks = 10000;
+    config->tick_size = 100;
+    config->session_seconds = 23400;
+    config->levels_per_side = 5;
+    config->initial_spread_ticks = 2;
+    config->initial_depth = 5;
+    config->market_open_seconds = kDefaultMarketOpenSeconds;
+    config->base_L = 20.0;
+    config->base_C = 0.5;
+    config->base_M = 15.0;
+    config->imbalance_sensitivity = 1.0;
+    config->cancel_sensitivity = 1.0;
+    config->epsilon_exec = 0.5;
+    config->spread_sensitivity = 0.4;
+}
+
+qrsdp_session* qrsdp_session_create(const qrsdp_session_config* config) {
+    try {
+        if (!config) throw std::invalid_argument("session config is NULL");
+        validate(*config);
+        return new qrsdp_session(*config);
+    } catch (...) {
+        failCurrent();
+        return nullptr;
+    }
+}
+
+void qrsdp_session_destroy(qrsdp_session* session) { delete session; }
+
+int64_t qrsdp_session_next(qrsdp_session* session, qrsdp_event* out, size_t max, qrsdp_top* tops) {
+    if (!session || (!out && max > 0)) return fail(QRSDP_ERR_INVALID, "session_next: NULL argument");
+    try {
+        return static_cast<int64_t>(session->step(max, out, tops));
+    } catch (...) {
+        return failCurrent();
+    }
+}
+
+int64_t qrsdp_session_run(qrsdp_session* session, qrsdp_event_callback callback, void* user,
+                          size_t batch_size) {
+    if (!session || !callback) return fail(QRSDP_ERR_INVALID, "session_run: NULL argument");
+    try {
+        std::vector<qrsdp_event> batch(batch_size > 0 ? batch_size : kDefaultBatch);
+        int64_t total = 0;
+        size_t n;
+        while ((n = session->step(batch.size(), batch.data(), nullptr)) > 0) {
+            total += static_cast<int64_t>(n);
+            if (callback(batch.data(), n, user) != 0) break;
+        }
+        return total;
+    } catch (...) {
+        return failCurrent();
+    }
+}
+
+int64_t qrsdp_session_book(const qrsdp_session* session, qrsdp_level* bids, qrsdp_level* asks,
+                           size_t max_levels) {
+    if (!session || ((!bids || !asks) && max_levels > 0))
+        return fail(QRSDP_ERR_INVALID, "session_book: NULL argument");
+    const MultiLevelBook& book = session->book;
+    size_t n = book.numLevels() < max_levels ? book.numLevels() : max_levels;
+    for (size_t k = 0; k < n; ++k) {
+        bids[k] = {book.bidPriceAtLevel(k), book.bidDepthAtLevel(k)};
+        asks[k] = {book.askPriceAtLevel(k), book.askDepthAtLevel(k)};
+    }
+    return static_cast<int64_t>(n);
+}
+
+int qrsdp_session_stats_get(const qrsdp_session* session, qrsdp_session_stats* out) {
+    if (!session || !out) return fail(QRSDP_ERR_INVALID, "session_stats_get: NULL argument");
+    *out = qrsdp_session_stats{};
+    out->events = session->producer.eventsWrittenThisSession();
+    out->shifts = session->producer.shiftCountThisSession();
+    out->sim_seconds = session->producer.currentTime();
+    out->finished = session->finished ? 1 : 0;
+    return QRSDP_OK;
+}
+
+void qrsdp_run_config_init(qrsdp_run_config* config) {
+    if (!config) return;
+    *config = qrsdp_run_config{};
+    config->struct_size = sizeof(qrsdp_run_config);
+    config->num_days = 1;
+    config->start_date = "2026-01-02";
+    config->base_seed = 42;
+    config->bar_seconds = kDefaultBarSeconds;
+    config->bar_seconds_count = sizeof(kDefaultBarSeconds) / sizeof(kDefaultBarSeconds[0]);
+    qrsdp_session_config_init(&config->session);
+    const LiveFramesConfig live;
+    config->speed = 100.0;
+    config->live_recent_events = live.recent_events;
+    config->live_frame_interval_ns = live.frame_interval_ns;
+    config->live_ring_bytes = live.ring_bytes;
+}
+
+qrsdp_run_result* qrsdp_run(const qrsdp_run_config* config) {
+    try {
+        if (!config) throw std::invalid_argument("run config is NULL");
+        if (config->struct_size < offsetof(qrsdp_run_config, realtime))
+            throw std::invalid_argument("run config: struct_size too small (call qrsdp_run_config_init)");
+        const bool has_live = config->struct_size >= sizeof(qrsdp_run_config);
+        if (!config->output_dir || !*config->output_dir)
+            throw std::invalid_argument("run config: output_dir is required");
+        if (config->num_days == 0)
+            throw std::invalid_argument("run config: num_days must be >= 1");
+        if (config->bar_seconds_count > 0 && !config->bar_seconds)
+            throw std::invalid_argument("run config: bar_seconds is NULL");
+        const qrsdp_session_config& sc = config->session;
+        validate(sc);
+
+        const TradingSession base = toSession(sc);
+        RunConfig rc{};
+        rc.run_id = config->run_id && *config->run_id ? config->run_id
+                                                       : "run_" + std::to_string(config->base_seed);
+        rc.output_dir = config->output_dir;
+        rc.base_seed = config->base_seed;
+        rc.p0_ticks = base.p0_ticks;
+        rc.session_seconds = base.session_seconds;
+        rc.levels_per_side = base.levels_per_side;
+        rc.tick_size = base.tick_size;
+        rc.initial_spread_ticks = base.initial_spread_ticks;
+        rc.initial_depth = base.initial_depth;
+        rc.intensity_params = base.intensity_params;
+        rc.model_type = sc.model == QRSDP_MODEL_HLR      ? ModelType::HLR
+                      : sc.model == QRSDP_MODEL_HAWKES ? ModelType::HAWKES
+                                                       : ModelType::SIMPLE;
+        rc.num_days = config->num_days;
+        rc.columnar = config->columnar != 0;
+        rc.bar_seconds.assign(config->bar_seconds, config->bar_seconds + config->bar_seconds_count);
+        rc.start_date = config->start_date ? config->start_date : "2026-01-02";
+        parseDate(rc.start_date);  // invalid_argument before any file is written
+        rc.market_open_seconds = base.market_open_seconds;
+        rc.threads = config->threads;
+        if (has_live) {
+            rc.realtime = config->realtime != 0;
+            rc.speed = config->speed;
+            if (rc.realtime && !(rc.speed > 0.0))
+                throw std::invalid_argument("run config: speed must be > 0");
+            if (config->live_frames && *config->live_frames) {
+                if (config->live_frame_interval_ns == 0)
+                    throw std::invalid_argument("run config: live_frame_interval_ns must be > 0");
+                rc.live_frames.path = config->live_frames;
+                rc.live_frames.frame_interval_ns = config->live_frame_interval_ns;
+                rc.live_frames.recent_events = config->live_recent_events;
+                rc.live_frames.ring_bytes = static_cast<size_t>(config->live_ring_bytes);
+            }
+        }
+        if (config->symbol && *config->symbol) {
+            SecurityConfig sec{};
+            sec.symbol = config->symbol;
+            sec.p0_ticks = rc.p0_ticks;
+            sec.tick_size = rc.tick_size;
+            sec.levels_per_side = rc.levels_per_side;
+            sec.initial_spread_ticks = rc.initial_spread_ticks;
+            sec.initial_depth = rc.initial_depth;
+            sec.intensity_params = rc.intensity_params;
+            sec.model_type = rc.model_type;
+            rc.securities.push_back(sec);
+        }
+
+        auto result = std::make_unique<qrsdp_run_result>();
+        SessionRunner runner;
+        result->result = runner.run(rc);
+        return result.release();
+    } catch (...) {
+        failCurrent();
+        return nullptr;
+    }
+}
+
+void qrsdp_run_result_free(qrsdp_run_result* result) { delete result; }
+
+uint64_t qrsdp_run_result_total_events(const qrsdp_run_result* result) {
+    return result ? result->result.total_events : 0;
+}
+
+double qrsdp_run_result_elapsed_seconds(const qrsdp_run_result* result) {
+    return result ? result->result.total_elapsed_seconds : 0.0;
+}
+
+size_t qrsdp_run_result_day_count(const qrsdp_run_result* result) {
+    return result ? result->result.days.size() : 0;
+}
+
+int qrsdp_run_result_day(const qrsdp_run_result* result, size_t index, qrsdp_day_info* out) {
+    if (!result || !out) return fail(QRSDP_ERR_INVALID, "run_result_day: NULL argument");
+    if (index >= result->result.days.size()) return fail(QRSDP_ERR_INVALID, "run_result_day: index out of range");
+    const DayResult& d = result->result.days[index];
+    out->symbol = d.symbol.c_str();
+    out->date = d.date.c_str();
+    out->filename = d.filename.c_str();
+    out->seed = d.seed;
+    out->open_ticks = d.open_ticks;
+    out->close_ticks = d.close_ticks;
+    out->events = d.events_written;
+    out->file_size_bytes = d.file_size_bytes;
+    return QRSDP_OK;
+}
+
+qrsdp_log* qrsdp_log_open(const char* path, uint32_t threads) {
+    try {
+        if (!path) throw std::invalid_argument("log path is NULL");
+        return new qrsdp_log(path, threads);
+    } catch (const std::runtime_error& e) {
+        fail(QRSDP_ERR_IO, e.what());
+        return nullptr;
+    } catch (...) {
+        failCurrent();
+        return nullptr;
+    }
+}
+
+void qrsdp_log_close(qrsdp_log* log) { delete log; }
+
+int qrsdp_log_get_info(const qrsdp_log* log, qrsdp_log_info* out) {
+    if (!log || !out) return fail(QRSDP_ERR_INVALID, "log_get_info: NULL argument");
+    const FileHeader& h = log->reader.header();
+    *out = qrsdp_log_info{};
+    out->version_major = h.version_major;
+    out->version_minor = h.version_minor;
+    out->header_flags = h.header_flags;
+    out->seed = h.seed;
+    out->p0_ticks = h.p0_ticks;
+    out->tick_size = h.tick_size;
+    out->session_seconds = h.session_seconds;
+    out->levels_per_side = h.levels_per_side;
+    out->initial_spread_ticks = h.initial_spread_ticks;
+    out->initial_depth = h.initial_depth;
+    out->chunk_capacity = h.chunk_capacity;
+    out->chunk_count = log->reader.chunkCount();
+    out->market_open_ns = h.market_open_ns;
+    out->total_records = log->reader.totalRecords();
+    return QRSDP_OK;
+}
+
+int qrsdp_log_get_stats(const qrsdp_log* log, qrsdp_log_stats* out) {
+    if (!log || !out) return fail(QRSDP_ERR_INVALID, "log_get_stats: NULL argument");
+    if (!log->reader.hasStats()) return fail(QRSDP_ERR_INVALID, "log_get_stats: file has no stats block");
+    const LogStats stats = log->reader.stats();
+    *out = qrsdp_log_stats{};
+    for (int t = 0; t < 6; ++t) out->type_counts[t] = stats.type_counts[t];
+    out->min_price_ticks = stats.min_price_ticks;
+    out->max_price_ticks = stats.max_price_ticks;
+    out->executed_qty = stats.executed_qty;
+    out->shifts_up = stats.shifts_up;
+    out->shifts_down = stats.shifts_down;
+    out->reinits = stats.reinits;
+    return QRSDP_OK;
+}
+
+qrsdp_records* qrsdp_log_read(const qrsdp_log* log, uint64_t first_record, uint64_t end_record) {
+    try {
+        if (!log) throw std::invalid_argument("log_read: NULL log");
+        auto out = std::make_unique<qrsdp_records>();
+        const uint64_t total = log->reader.totalRecords();
+        if (first_record == 0 && end_record >= total)
+            out->records = log->pool ? log->reader.readAll(*log->pool) : log->reader.readAll();
+        else if (first_record < end_record)
+            readRecords(log->reader, first_record, end_record, out->records);
+        return out.release();
+    } catch (...) {
+        failCurrent();
+        return nullptr;
+    }
+}
+
+qrsdp_records* qrsdp_log_read_chunks(const qrsdp_log* log, uint32_t first_chunk, uint32_t end_chunk) {
+    try {
+        if (!log) throw std::invalid_argument("log_read_chunks: NULL log");
+        const EventLogReader& reader = log->reader;
+        if (first_chunk > end_chunk || end_chunk > reader.chunkCount())
+            throw std::invalid_argument("log_read_chunks: chunk range out of bounds");
+        uint64_t first = 0;
+        for (uint32_t i = 0; i < first_chunk; ++i) first += reader.index()[i].record_count;
+        uint64_t end = first;
+        for (uint32_t i = first_chunk; i < end_chunk; ++i) end += reader.index()[i].record_count;
+        return qrsdp_log_read(log, first, end);
+    } catch (...) {
+        failCurrent();
+        return nullptr;
+    }
+}
+
+qrsdp_records* qrsdp_log_select(const qrsdp_log* log, uint64_t ts_start, uint64_t ts_end) {
+    try {
+        if (!log) throw std::invalid_argument("log_select: NULL log");
+        RecordQuery q;
+        q.ts_start = ts_start;
+        q.ts_end = ts_end;
+        auto out = std::make_unique<qrsdp_records>();
+        out->records = log->reader.select(q);
+        return out.release();
+    } catch (...) {
+        failCurrent();
+        return nullptr;
+    }
+}
+
+const qrsdp_event* qrsdp_records_data(const qrsdp_records* records) {
+    return records ? reinterpret_cast<const qrsdp_event*>(records->records.data()) : nullptr;
+}
+
+size_t qrsdp_records_count(const qrsdp_records* records) {
+    return records ? records->records.size() : 0;
+}
+
+void qrsdp_records_free(qrsdp_records* records) { delete records; }
+
+size_t qrsdp_log_bar_intervals(const qrsdp_log* log, uint64_t* intervals_ns, size_t max) {
+    if (!log) return 0;
+    const std::vector<BarSeries>& series = log->reader.bars();
+    for (size_t i = 0; i < series.size() && i < max && intervals_ns; ++i)
+        intervals_ns[i] = series[i].interval_ns;
+    return series.size();
+}
+
+size_t qrsdp_log_bars(const qrsdp_log* log, uint64_t interval_ns, const qrsdp_bar** bars) {
+    const BarSeries* series = log ? log->reader.barsAt(interval_ns) : nullptr;
+    if (bars) *bars = series ? reinterpret_cast<const qrsdp_bar*>(series->bars.data()) : nullptr;
+    return series ? series->bars.size() : 0;
+}
+
+qrsdp_frames* qrsdp_frames_open(const char* path, uint64_t frame_interval_ns, uint32_t recent_events) {
+    try {
+        if (!path) throw std::invalid_argument("frames path is NULL");
+        BookFrameOptions options;
+        options.frame_interval_ns = frame_interval_ns;
+        options.recent_events = recent_events;
+        return new qrsdp_frames(path, options);
+    } catch (const std::invalid_argument&) {
+        failCurrent();
+        return nullptr;
+    } catch (const std::runtime_error& e) {
+        fail(QRSDP_ERR_IO, e.what());
+        return nullptr;
+    } catch (...) {
+        failCurrent();
+        return nullptr;
+    }
+}
+
+void qrsdp_frames_close(qrsdp_frames* frames) { delete frames; }
+
+int64_t qrsdp_frames_next(qrsdp_frames* frames, const void** frame) {
+    if (!frames || !frame) return fail(QRSDP_ERR_INVALID, "frames_next: NULL argument");
+    try {
+        if (!frames->next()) {
+            *frame = nullptr;
+            return 0;
+        }
+        *frame = frames->frame.data();
+        return static_cast<int64_t>(frames->frame.size());
+    } catch (...) {
+        return failCurrent();
+    }
+}
+
+int qrsdp_frames_set_interval(qrsdp_frames* frames, uint64_t frame_interval_ns) {
+    if (!frames) return fail(QRSDP_ERR_INVALID, "frames_set_interval: NULL argument");
+    try {
+        frames->builder.setFrameInterval(frame_interval_ns);
+        return QRSDP_OK;
+    } catch (...) {
+        return failCurrent();
+    }
+}
+
+qrsdp_feed* qrsdp_feed_attach(const char* path) {
+    try {
+        if (!path) throw std::invalid_argument("feed path is NULL");
+        return new qrsdp_feed(path);
+    } catch (const std::runtime_error& e) {
+        fail(QRSDP_ERR_IO, e.what());
+        return nullptr;
+    } catch (...) {
+        failCurrent();
+        return nullptr;
+    }
+}
+
+void qrsdp_feed_close(qrsdp_feed* feed) { delete feed; }
+
+int qrsdp_feed_next(qrsdp_feed* feed, uint32_t* kind, const void** data, size_t* size) {
+    if (!feed || !kind || !data || !size) return fail(QRSDP_ERR_INVALID, "feed_next: NULL argument");
+    FrameRingKind k = kRingWrap;
+    switch (feed->reader.poll(k, feed->message)) {
+        case FrameRingReader::Poll::Message:
+            *kind = k;
+            *data = feed->message.data();
+            *size = feed->message.size();
+            return QRSDP_FEED_MESSAGE;
+        case FrameRingReader::Poll::Closed:
+            return QRSDP_FEED_CLOSED;
+        case FrameRingReader::Poll::Empty:
+            break;
+    }
+    return QRSDP_FEED_EMPTY;
+}
+
+uint64_t qrsdp_feed_dropped(const qrsdp_feed* feed) { return feed ? feed->reader.dropped() : 0; }
+
+qrsdp_bus* qrsdp_bus_attach(const char* path, int from_oldest) {
+    try {
+        if (!path) throw std::invalid_argument("bus path is NULL");
+        return new qrsdp_bus(path, from_oldest != 0);
+    } catch (const std::runtime_error& e) {
+        fail(QRSDP_ERR_IO, e.what());
+        return nullptr;
+    } catch (...) {
+        failCurrent();
+        return nullptr;
+    }
+}
+
+void qrsdp_bus_close(qrsdp_bus* bus) { delete bus; }
+
+int qrsdp_bus_next(qrsdp_bus* bus, const qrsdp_bus_batch** batch, const qrsdp_event** records) {
+    if (!bus || !batch || !records) return fail(QRSDP_ERR_INVALID, "bus_next: NULL argument");
+    const EventBatchHeader* header = nullptr;
+    const DiskEventRecord* recs = nullptr;
+    switch (bus->reader.poll(header, recs)) {
+        case ShmRingReader::Poll::Message:
+            *batch = reinterpret_cast<const qrsdp_bus_batch*>(header);
+            *records = reinterpret_cast<const qrsdp_event*>(recs);
+            return QRSDP_FEED_MESSAGE;
+        case ShmRingReader::Poll::Closed:
+            return QRSDP_FEED_CLOSED;
+        case ShmRingReader::Poll::Empty:
+            break;
+    }
+    return QRSDP_FEED_EMPTY;
+}
+
+uint64_t qrsdp_bus_cursor(const qrsdp_bus* bus) { return bus ? bus->reader.cursor() : 0; }
+
+uint64_t qrsdp_bus_lost(const qrsdp_bus* bus) { return bus ? bus->reader.lost() : 0; }
+
+}  // extern "C"
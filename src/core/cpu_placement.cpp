@@ -0,0 +1,259 @@
+#include "core/cpu_placement.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <stdexcept>
+#include <thread>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace qrsdp {
+
+namespace {
+
+std::string readFirstLine(const std::string& path) {
+    std::ifstream in(path);
+    std::string line;
+    std::getline(in, line);
+    return line;
+}
+
+/// CPU -> node from sysfs, read once.
+const std::map<int, int>& cpuNodes() {
+    static const std::map<int, int> nodes = [] {
+        std::map<int, int> out;
+        std::error_code ec;
+        for (const auto& entry : std::filesystem::directory_iterator("/sys/devices/system/node", ec)) {
+            const std::string name = entry.path().filename().string();
+            if (name.rfind("node", 0) != 0 || name.size() == 4
+                || name.find_first_not_of("0123456789", 4) != std::string::npos)
+                continue;
+            const int node = std::atoi(name.c_str() + 4);
+            const std::string list = readFirstLine((entry.path() / "cpulist").string());
+            if (list.empty())
+                continue;
+            try {
+                for (int cpu : parseCpuList(list)) out[cpu] = node;
+            } catch (const std::invalid_argument&) {
+            }
+        }
+        return out;
+    }();
+    return nodes;
+}
+
+}  // namespace
+
+std::vector<int> parseCpuList(const std::string& spec) {
+    std::vector<int> cpus;
+    size_t pos = 0;
+    while (pos <= spec.size()) {
+        const size_t comma = std::min(spec.find(',', pos), spec.size());
+        const std::string item = spec.substr(pos, comma - pos);
+        const size_t dash = item.find('-');
+        const std::string lo_s = item.substr(0, dash);
+        const std::string hi_s = dash == std::string::npos ? lo_s : item.substr(dash + 1);
+        auto number = [&](const std::string& s) {
+            if (s.empty() || s.size() > 6 || s.find_first_not_of("0123456789") != std::string::npos)
+                throw std::invalid_argument("bad CPU list '" + spec + "'");
+            return std::atoi(s.c_str());
+        };
+        const int lo = number(lo_s);
+        const int hi = number(hi_s);
+        if (hi < lo)
+            throw std::invalid_argument("bad CPU range '" + item + "' in '" + spec + "'");
+        for (int cpu = lo; cpu <= hi; ++cpu) cpus.push_back(cpu);
+        pos = comma + 1;
+    }
+    std::sort(cpus.begin(), cpus.end());
+    cpus.erase(std::unique(cpus.begin(), cpus.end()), cpus.end());
+    return cpus;
+}
+
+std::string formatCpuList(const std::vector<int>& cpus) {
+    std::string out;
+    for (size_t i = 0; i < cpus.size();) {
+        size_t j = i;
+        while (j + 1 < cpus.size() && cpus[j + 1] == cpus[j] + 1) ++j;
+        if (!out.empty()) out += ',';
+        out += std::to_string(cpus[i]);
+        if (j > i) out += '-' + std::to_string(cpus[j]);
+        i = j + 1;
+    }
+    return out;
+}
+
+std::vector<int> onlineCpus() {
+    const std::string list = readFirstLine("/sys/devices/system/cpu/online");
+    if (!list.empty()) {
+        try {
+            return parseCpuList(list);
+        } catch (const std::invalid_argument&) {
+        }
+    }
+    std::vector<int> cpus(std::max(1u, std::thread::hardware_concurrency()));
+    for (size_t i = 0; i < cpus.size(); ++i) cpus[i] = static_cast<int>(i);
+    return cpus;
+}
+
+int cpuNumaNode(int cpu) {
+    const auto& nodes = cpuNodes();
+    const auto it = nodes.find(cpu);
+    return it == nodes.end() ? 0 : it->second;
+}
+
+std::vector<int> cpusByNode(std::vector<int> cpus) {
+    std::stable_sort(cpus.begin(), cpus.end(),
+                     [](int a, int b) { return cpuNumaNode(a) < cpuNumaNode(b); });
+    return cpus;
+}
+
+bool pinCurrentThread(int cpu) {
+    if (cpu < 0)
+        return false;
+    return setCurrentThreadCpus({cpu});
+}
+
+bool setCurrentThreadCpus(const std::vector<int>& cpus) {
+    if (cpus.empty())
+        return false;
+#if defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu : cpus) {
+        if (cpu < 0 || cpu >= CPU_SETSIZE)
+            return false;
+        CPU_SET(cpu, &set);
+    }
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+    return false;
+#endif
+}
+
+std::vector<int> currentThreadCpus() {
+    std::vector<int> cpus;
+#if defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (pthread_getaffinity_np(pthread_self(), sizeof(set), &set) == 0) {
+        for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+            if (CPU_ISSET(cpu, &set)) cpus.push_back(cpu);
+    }
+#endif
+    return cpus;
+}
+
+bool parseNumaPolicy(const std::string& name, NumaPolicy& out) {
+    if (name == "none") out = NumaPolicy::NONE;
+    else if (name == "local") out = NumaPolicy::LOCAL;
+    else if (name == "interleave") out = NumaPolicy::INTERLEAVE;
+    else return false;
+    return true;
+}
+
+const char* numaPolicyName(NumaPolicy policy) {
+    switch (policy) {
+    case NumaPolicy::LOCAL: return "local";
+    case NumaPolicy::INTERLEAVE: return "interleave";
+    default: return "none";
+    }
+}
+
+bool setCurrentThreadMemoryPolicy(NumaPolicy policy, const std::vector<int>& nodes) {
+#if defined(__linux__) && defined(SYS_set_mempolicy)
+    // <numaif.h> values; libnuma is not needed for the bare syscall.
+    constexpr int kMpolDefault = 0;
+    constexpr int kMpolPreferred = 1;
+    constexpr int kMpolInterleave = 3;
+    constexpr size_t kMaskBits = 1024;
+    unsigned long mask[kMaskBits / (8 * sizeof(unsigned long))] = {};
+    auto add = [&](int node) {
+        if (node < 0 || static_cast<size_t>(node) >= kMaskBits) return false;
+        mask[node / (8 * sizeof(unsigned long))] |= 1UL << (node % (8 * sizeof(unsigned long)));
+        return true;
+    };
+    if (policy == NumaPolicy::NONE)
+        return syscall(SYS_set_mempolicy, kMpolDefault, nullptr, 0UL) == 0;
+    if (nodes.empty())
+        return false;
+    if (policy == NumaPolicy::LOCAL) {
+        if (!add(nodes.front())) return false;
+    } else {
+        for (int node : nodes)
+            if (!add(node)) return false;
+    }
+    return syscall(SYS_set_mempolicy, policy == NumaPolicy::LOCAL ? kMpolPreferred : kMpolInterleave,
+                   mask, static_cast<unsigned long>(kMaskBits)) == 0;
+#else
+    (void)nodes;
+    return policy == NumaPolicy::NONE;
+#endif
+}
+
+bool ThreadPlacement::placeThread(size_t thread) const {
+    bool ok = true;
+    const int cpu = cpuFor(thread);
+    if (cpu >= 0) ok = pinCurrentThread(cpu);
+    switch (numa) {
+    case NumaPolicy::LOCAL: {
+        // Unpinned threads prefer the node they start on.
+#if defined(__linux__)
+        const int here = cpu >= 0 ? cpu : sched_getcpu();
+#else
+        const int here = cpu;
+#endif
+        ok = setCurrentThreadMemoryPolicy(numa, {cpuNumaNode(here)}) && ok;
+        break;
+    }
+    case NumaPolicy::INTERLEAVE:
+        ok = setCurrentThreadMemoryPolicy(numa, nodes()) && ok;
+        break;
+    case NumaPolicy::NONE:
+        break;
+    }
+    return ok;
+}
+
+std::vector<int> ThreadPlacement::nodes() const {
+    std::vector<int> out;
+    for (const auto* list : {&cpus, &io_cpus})
+        for (int cpu : *list) out.push_back(cpuNumaNode(cpu));
+    if (out.empty())
+        for (int cpu : onlineCpus()) out.push_back(cpuNumaNode(cpu));
+    std::sort(out.begin(), out.end());
+    out.erase(std::unique(out.begin(), out.end()), out.end());
+    return out;
+}
+
+std::string ThreadPlacement::describe() const {
+    std::string out = "cpus=" + (cpus.empty() ? std::string("any") : formatCpuList(cpus));
+    out += " io=" + (io_cpus.empty() ? std::string("any") : formatCpuList(io_cpus));
+    out += " numa=";
+    out += numaPolicyName(numa);
+    out += " nodes=" + formatCpuList(nodes());
+    return out;
+}
+
+IoThreadScope::IoThreadScope(const ThreadPlacement& placement) {
+    if (placement.io_cpus.empty())
+        return;
+    std::vector<int> previous = currentThreadCpus();
+    if (!previous.empty() && setCurrentThreadCpus(placement.io_cpus))
+        saved_ = std::move(previous);
+}
+
+IoThreadScope::~IoThreadScope() {
+    if (!saved_.empty())
+        setCurrentThreadCpus(saved_);
+}
+
+}  // namespace qrsdp
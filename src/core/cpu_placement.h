@@ -0,0 +1,103 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace qrsdp {
+
+// --- CPU lists ---
+
+/// Parses a Linux-style CPU list ("0-3,8,10-11") into ascending unique CPU
+/// numbers. Throws std::invalid_argument on a malformed or empty list.
+std::vector<int> parseCpuList(const std::string& spec);
+
+/// Formats cpus back into ranges ("0-3,8"); "" for none.
+std::string formatCpuList(const std::vector<int>& cpus);
+
+/// CPUs the kernel reports online (/sys/devices/system/cpu/online), else
+/// 0 .. hardware_concurrency - 1.
+std::vector<int> onlineCpus();
+
+/// NUMA node of cpu from /sys/devices/system/node; 0 when the machine has no
+/// NUMA topology (or is not Linux).
+int cpuNumaNode(int cpu);
+
+/// cpus reordered node by node (stable within a node), so the first n of them
+/// fill one node before the next.
+std::vector<int> cpusByNode(std::vector<int> cpus);
+
+// --- Pinning and memory policy of the calling thread ---
+
+/// Pins the calling thread to cpu. Returns false if cpu < 0, pinning is not
+/// supported here (non-Linux) or the kernel refused.
+bool pinCurrentThread(int cpu);
+
+/// Restricts the calling thread to cpus (any of them). Returns false if cpus is
+/// empty, unsupported or refused.
+bool setCurrentThreadCpus(const std::vector<int>& cpus);
+
+/// CPUs the calling thread may run on; empty where affinity is not supported.
+std::vector<int> currentThreadCpus();
+
+enum class NumaPolicy : uint8_t {
+    NONE,        // first touch wherever the thread happens to run
+    LOCAL,       // prefer the node of the thread's CPU for its allocations
+    INTERLEAVE,  // spread allocations page by page over the placement's nodes
+};
+
+bool parseNumaPolicy(const std::string& name, NumaPolicy& out);
+const char* numaPolicyName(NumaPolicy policy);
+
+/// Sets the calling thread's memory policy (set_mempolicy) for nodes: LOCAL
+/// prefers nodes.front(), INTERLEAVE spreads over all of them, NONE restores
+/// the default. Threads it starts later inherit it. Returns false where NUMA
+/// policies are not available (non-Linux, kernel without NUMA).
+bool setCurrentThreadMemoryPolicy(NumaPolicy policy, const std::vector<int>& nodes);
+
+// --- Placement of a run's threads ---
+
+/// Where a run's threads go (qrsdp_run --cpu-list / --io-cpu-list /
+/// --numa-policy). Generation thread i (a day-scheduler or fixed worker, which
+/// also paces realtime events) is pinned to cpus[i % cpus.size()]; its book,
+/// model, producer and sink buffers are built on that thread, so first touch
+/// puts them on its node. Threads that only move data out of the process (the
+/// ITCH senders, Kafka queue and librdkafka threads, file-sink writer threads)
+/// are started inside an IoThreadScope and run on io_cpus instead, so they
+/// never preempt a generation thread. Empty lists leave threads floating.
+struct ThreadPlacement {
+    std::vector<int> cpus;
+    std::vector<int> io_cpus;
+    NumaPolicy numa = NumaPolicy::NONE;
+
+    bool enabled() const { return !cpus.empty() || !io_cpus.empty() || numa != NumaPolicy::NONE; }
+    int cpuFor(size_t thread) const { return cpus.empty() ? -1 : cpus[thread % cpus.size()]; }
+
+    /// Pins the calling thread as generation thread `thread` and applies the
+    /// memory policy. Returns false if any part of that was refused.
+    bool placeThread(size_t thread) const;
+
+    /// Distinct nodes of cpus (and io_cpus), ascending.
+    std::vector<int> nodes() const;
+
+    /// "cpus=0-7 io=8-9 numa=local nodes=0,1" for logs and performance docs.
+    std::string describe() const;
+};
+
+/// While alive, the calling thread runs on placement.io_cpus, so threads it
+/// starts inherit that affinity; the destructor restores the previous
+/// affinity. A no-op when io_cpus is empty.
+class IoThreadScope {
+public:
+    explicit IoThreadScope(const ThreadPlacement& placement);
+    ~IoThreadScope();
+
+    IoThreadScope(const IoThreadScope&) = delete;
+    IoThreadScope& operator=(const IoThreadScope&) = delete;
+
+private:
+    std::vector<int> saved_;
+};
+
+}  // namespace qrsdp
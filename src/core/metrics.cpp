@@ -0,0 +1,278 @@
+#include "core/metrics.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+namespace qrsdp {
+
+namespace {
+
+constexpr unsigned kSubBits = 4;  // 16 buckets per power of two
+
+unsigned floorLog2(uint64_t v) {
+    unsigned e = 0;
+    for (unsigned step = 32; step > 0; step >>= 1) {
+        if (v >> step) {
+            v >>= step;
+            e += step;
+        }
+    }
+    return e;
+}
+
+std::string seriesName(const std::string& name, const std::string& label,
+                       const char* suffix = "", const std::string& extra = "") {
+    std::string s = name + suffix;
+    if (label.empty() && extra.empty())
+        return s;
+    s += '{';
+    s += label;
+    if (!label.empty() && !extra.empty())
+        s += ',';
+    s += extra;
+    s += '}';
+    return s;
+}
+
+/// JSON string body: the series name with its label quotes escaped.
+std::string jsonKey(const std::string& name, const std::string& label) {
+    std::string out;
+    for (char c : seriesName(name, label)) {
+        if (c == '"' || c == '\\')
+            out += '\\';
+        out += c;
+    }
+    return out;
+}
+
+constexpr double kQuantiles[] = {0.5, 0.9, 0.99, 0.999};
+
+}  // namespace
+
+// --- Log-linear buckets ---
+
+size_t logLinearBucket(uint64_t v) {
+    if (v < (1u << kSubBits))
+        return static_cast<size_t>(v);
+    const unsigned e = floorLog2(v);
+    const uint64_t sub = (v >> (e - kSubBits)) & ((1u << kSubBits) - 1);
+    return (1u << kSubBits) + (e - kSubBits) * (1u << kSubBits) + static_cast<size_t>(sub);
+}
+
+uint64_t logLinearBucketUpper(size_t b) {
+    if (b < (1u << kSubBits))
+        return b;
+    const size_t rel = b - (1u << kSubBits);
+    const unsigned shift = static_cast<unsigned>(rel >> kSubBits);
+    const uint64_t sub = rel & ((1u << kSubBits) - 1);
+    const uint64_t lower = ((uint64_t{1} << kSubBits) + sub) << shift;
+    return lower + ((uint64_t{1} << shift) - 1);
+}
+
+// --- LatencyHistogram ---
+
+void LatencyHistogram::record(uint64_t ns) {
+    ++counts_[logLinearBucket(ns)];
+    ++count_;
+    max_ = std::max(max_, ns);
+}
+
+uint64_t LatencyHistogram::percentile(double q) const {
+    if (count_ == 0)
+        return 0;
+    const double clamped = std::min(std::max(q, 0.0), 1.0);
+    const auto rank = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(clamped * static_cast<double>(count_))));
+    uint64_t seen = 0;
+    for (size_t b = 0; b < kBuckets; ++b) {
+        seen += counts_[b];
+        if (seen >= rank)
+            return std::min(logLinearBucketUpper(b), max_);
+    }
+    return max_;
+}
+
+void LatencyHistogram::merge(const LatencyHistogram& other) {
+    for (size_t b = 0; b < kBuckets; ++b)
+        counts_[b] += other.counts_[b];
+    count_ += other.count_;
+    max_ = std::max(max_, other.max_);
+}
+
+void LatencyHistogram::reset() {
+    counts_.fill(0);
+    count_ = 0;
+    max_ = 0;
+}
+
+// --- Counter ---
+
+size_t Counter::shardIndex() {
+    static std::atomic<size_t> next{0};
+    thread_local const size_t index = next.fetch_add(1, std::memory_order_relaxed) % kShards;
+    return index;
+}
+
+uint64_t Counter::value() const {
+    uint64_t total = 0;
+    for (const auto& s : shards_)
+        total += s.value.load(std::memory_order_relaxed);
+    return total;
+}
+
+// --- Histogram ---
+
+void Histogram::record(uint64_t ns) {
+    counts_[logLinearBucket(ns)].fetch_add(1, std::memory_order_relaxed);
+    count_.fetch_add(1, std::memory_order_relaxed);
+    sum_.fetch_add(ns, std::memory_order_relaxed);
+    uint64_t prev = max_.load(std::memory_order_relaxed);
+    while (ns > prev && !max_.compare_exchange_weak(prev, ns, std::memory_order_relaxed)) {
+    }
+}
+
+uint64_t Histogram::percentile(double q) const {
+    uint64_t total = 0;
+    for (const auto& c : counts_)
+        total += c.load(std::memory_order_relaxed);
+    if (total == 0)
+        return 0;
+    const uint64_t top = max();
+    const double clamped = std::min(std::max(q, 0.0), 1.0);
+    const auto rank = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(clamped * static_cast<double>(total))));
+    uint64_t seen = 0;
+    for (size_t b = 0; b < kLogLinearBuckets; ++b) {
+        seen += counts_[b].load(std::memory_order_relaxed);
+        if (seen >= rank)
+            return std::min(logLinearBucketUpper(b), top);
+    }
+    return top;
+}
+
+// --- MetricsRegistry ---
+
+MetricsRegistry::Entry* MetricsRegistry::find(Kind kind, const std::string& name,
+                                              const std::string& label) {
+    for (auto& e : entries_) {
+        if (e.kind == kind && e.name == name && e.label == label)
+            return &e;
+    }
+    return nullptr;
+}
+
+Counter& MetricsRegistry::counter(const std::string& name, const std::string& help,
+                                  const std::string& label) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (Entry* e = find(Kind::COUNTER, name, label))
+        return *e->counter;
+    counters_.emplace_back();
+    entries_.push_back({Kind::COUNTER, name, help, label, &counters_.back(), nullptr, nullptr});
+    return counters_.back();
+}
+
+Gauge& MetricsRegistry::gauge(const std::string& name, const std::string& help,
+                              const std::string& label) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (Entry* e = find(Kind::GAUGE, name, label))
+        return *e->gauge;
+    gauges_.emplace_back();
+    entries_.push_back({Kind::GAUGE, name, help, label, nullptr, &gauges_.back(), nullptr});
+    return gauges_.back();
+}
+
+Histogram& MetricsRegistry::histogram(const std::string& name, const std::string& help,
+                                      const std::string& label) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (Entry* e = find(Kind::HISTOGRAM, name, label))
+        return *e->histogram;
+    histograms_.emplace_back();
+    entries_.push_back({Kind::HISTOGRAM, name, help, label, nullptr, nullptr, &histograms_.back()});
+    return histograms_.back();
+}
+
+std::string MetricsRegistry::prometheusText() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::string out;
+    char num[64];
+    // A family's HELP/TYPE appear once, its series right after, in registration order.
+    std::vector<const Entry*> ordered;
+    ordered.reserve(entries_.size());
+    for (const auto& e : entries_) {
+        if (std::none_of(ordered.begin(), ordered.end(),
+                         [&](const Entry* o) { return o->name == e.name; })) {
+            for (const auto& same : entries_)
+                if (same.name == e.name) ordered.push_back(&same);
+        }
+    }
+    std::string last_name;
+    for (const Entry* ep : ordered) {
+        const Entry& e = *ep;
+        if (e.name != last_name) {
+            const char* type = e.kind == Kind::COUNTER ? "counter"
+                             : e.kind == Kind::GAUGE ? "gauge" : "summary";
+            out += "# HELP " + e.name + " " + e.help + "\n";
+            out += "# TYPE " + e.name + " " + type + "\n";
+            last_name = e.name;
+        }
+        switch (e.kind) {
+            case Kind::COUNTER:
+                std::snprintf(num, sizeof(num), " %llu\n", (unsigned long long)e.counter->value());
+                out += seriesName(e.name, e.label) + num;
+                break;
+            case Kind::GAUGE:
+                std::snprintf(num, sizeof(num), " %lld\n", (long long)e.gauge->value());
+                out += seriesName(e.name, e.label) + num;
+                break;
+            case Kind::HISTOGRAM: {
+                const Histogram& h = *e.histogram;
+                for (double q : kQuantiles) {
+                    char quantile[32];
+                    std::snprintf(quantile, sizeof(quantile), "quantile=\"%g\"", q);
+                    std::snprintf(num, sizeof(num), " %llu\n", (unsigned long long)h.percentile(q));
+                    out += seriesName(e.name, e.label, "", quantile) + num;
+                }
+                std::snprintf(num, sizeof(num), " %llu\n", (unsigned long long)h.sum());
+                out += seriesName(e.name, e.label, "_sum") + num;
+                std::snprintf(num, sizeof(num), " %llu\n", (unsigned long long)h.count());
+                out += seriesName(e.name, e.label, "_count") + num;
+                break;
+            }
+        }
+    }
+    return out;
+}
+
+std::string MetricsRegistry::jsonLine() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::string out = "{";
+    char num[160];
+    bool first = true;
+    for (const auto& e : entries_) {
+        out += first ? "\"" : ",\"";
+        first = false;
+        out += jsonKey(e.name, e.label);
+        out += "\":";
+        switch (e.kind) {
+            case Kind::COUNTER:
+                std::snprintf(num, sizeof(num), "%llu", (unsigned long long)e.counter->value());
+                break;
+            case Kind::GAUGE:
+                std::snprintf(num, sizeof(num), "%lld", (long long)e.gauge->value());
+                break;
+            case Kind::HISTOGRAM: {
+                const Histogram& h = *e.histogram;
+                std::snprintf(num, sizeof(num),
+                              "{\"count\":%llu,\"sum\":%llu,\"p50\":%llu,\"p99\":%llu,\"p999\":%llu,\"max\":%llu}",
+                              (unsigned long long)h.count(), (unsigned long long)h.sum(),
+                              (unsigned long long)h.percentile(0.5), (unsigned long long)h.percentile(0.99),
+                              (unsigned long long)h.percentile(0.999), (unsigned long long)h.max());
+                break;
+            }
+        }
+        out += num;
+    }
+    out += "}";
+    return out;
+}
+
+}  // namespace qrsdp
@@ -0,0 +1,143 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace qrsdp {
+
+// --- Log-linear buckets (LatencyHistogram and Histogram) ---
+// Exact below 16, then 16 buckets per power of two: a bucket's upper bound is
+// within 1/16 of any value in it. 976 buckets cover all of uint64_t.
+constexpr size_t kLogLinearBuckets = 16 + 60 * 16;
+size_t logLinearBucket(uint64_t v);
+uint64_t logLinearBucketUpper(size_t bucket);
+
+/// Log-linear histogram of nanosecond (or cycle) values for one thread: the
+/// same buckets as Histogram without atomics, so record() is a few shifts and
+/// an increment. Percentiles are within 1/16 of the true value.
+class LatencyHistogram {
+public:
+    static constexpr size_t kBuckets = kLogLinearBuckets;
+
+    void record(uint64_t ns);
+
+    uint64_t count() const { return count_; }
+    uint64_t max() const { return max_; }
+    /// Upper bound of the bucket holding quantile q (0..1), capped at max(); 0 if empty.
+    uint64_t percentile(double q) const;
+
+    /// Adds other's records to this histogram.
+    void merge(const LatencyHistogram& other);
+    void reset();
+
+private:
+    std::array<uint64_t, kBuckets> counts_{};
+    uint64_t count_ = 0;
+    uint64_t max_ = 0;
+};
+
+/// Monotonic counter for hot paths. Each thread adds to its own cache line of
+/// a small sharded array (relaxed atomics, no locks, no shared-line traffic);
+/// value() sums the shards.
+class Counter {
+public:
+    static constexpr size_t kShards = 16;
+
+    void add(uint64_t n = 1) {
+        shards_[shardIndex()].value.fetch_add(n, std::memory_order_relaxed);
+    }
+    uint64_t value() const;
+
+private:
+    struct alignas(64) Shard {
+        std::atomic<uint64_t> value{0};
+    };
+    static size_t shardIndex();
+
+    std::array<Shard, kShards> shards_;
+};
+
+/// Last-written value (queue depths, lag).
+class Gauge {
+public:
+    void set(int64_t v) { value_.store(v, std::memory_order_relaxed); }
+    void add(int64_t n) { value_.fetch_add(n, std::memory_order_relaxed); }
+    int64_t value() const { return value_.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<int64_t> value_{0};
+};
+
+/// HDR-style histogram of nanosecond values over log-linear buckets with
+/// relaxed atomic counts, so any thread may record() and an exporter may read
+/// a snapshot concurrently (a percentile read mid-update is off by at most the
+/// records in flight).
+class Histogram {
+public:
+    void record(uint64_t ns);
+
+    uint64_t count() const { return count_.load(std::memory_order_relaxed); }
+    uint64_t sum() const { return sum_.load(std::memory_order_relaxed); }
+    uint64_t max() const { return max_.load(std::memory_order_relaxed); }
+    /// Upper bound of the bucket holding quantile q (0..1), capped at max(); 0 if empty.
+    uint64_t percentile(double q) const;
+
+private:
+    std::array<std::atomic<uint64_t>, kLogLinearBuckets> counts_{};
+    std::atomic<uint64_t> count_{0};
+    std::atomic<uint64_t> sum_{0};
+    std::atomic<uint64_t> max_{0};
+};
+
+/// Named metrics for qrsdp_run. Registration takes a lock and returns a
+/// reference that stays valid for the registry's lifetime, so hot paths look a
+/// metric up once and then only touch its atomics. Asking again for the same
+/// name and label returns the same metric.
+///
+/// Instrumented code takes a MetricsRegistry* (RunConfig::metrics) and holds
+/// null metric pointers when it is null, so a run without metrics pays one
+/// predictable branch per batch.
+class MetricsRegistry {
+public:
+    /// label is an optional Prometheus label set without braces, e.g. symbol="AAPL".
+    Counter& counter(const std::string& name, const std::string& help,
+                     const std::string& label = "");
+    Gauge& gauge(const std::string& name, const std::string& help,
+                 const std::string& label = "");
+    Histogram& histogram(const std::string& name, const std::string& help,
+                         const std::string& label = "");
+
+    /// Prometheus text exposition (version 0.0.4). Histograms are summaries:
+    /// quantiles 0.5/0.9/0.99/0.999 plus _sum and _count.
+    std::string prometheusText() const;
+    /// One JSON object on one line: {"name{label}": value, "hist{label}": {...}}.
+    std::string jsonLine() const;
+
+private:
+    enum class Kind { COUNTER, GAUGE, HISTOGRAM };
+    struct Entry {
+        Kind kind;
+        std::string name;
+        std::string help;
+        std::string label;
+        Counter* counter;
+        Gauge* gauge;
+        Histogram* histogram;
+    };
+
+    Entry* find(Kind kind, const std::string& name, const std::string& label);
+
+    mutable std::mutex mutex_;
+    std::vector<Entry> entries_;
+    std::deque<Counter> counters_;      // deques: growth never moves a metric
+    std::deque<Gauge> gauges_;
+    std::deque<Histogram> histograms_;
+};
+
+}  // namespace qrsdp
@@ -0,0 +1,119 @@
+#include "core/plot_series.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace qrsdp {
+
+PlotSeries::PlotSeries(size_t capacity) {
+    if (capacity == 0)
+        throw std::invalid_argument("PlotSeries: capacity must be > 0");
+    x_.resize(capacity);
+    y_.resize(capacity);
+}
+
+void PlotSeries::push(double x, double y) {
+    size_t s;
+    if (size_ < x_.size()) {
+        s = slot(size_++);
+    } else {
+        s = start_;
+        if (++start_ == x_.size()) start_ = 0;
+    }
+    x_[s] = x;
+    y_[s] = y;
+}
+
+static void copyAll(const PlotSeries& series, std::vector<double>& x, std::vector<double>& y) {
+    const size_t n = series.size();
+    x.resize(n);
+    y.resize(n);
+    for (size_t i = 0; i < n; ++i) {
+        x[i] = series.x(i);
+        y[i] = series.y(i);
+    }
+}
+
+void decimateMinMax(const PlotSeries& series, size_t buckets,
+                    std::vector<double>& x, std::vector<double>& y) {
+    const size_t n = series.size();
+    if (buckets == 0 || n <= 2 * buckets) {
+        copyAll(series, x, y);
+        return;
+    }
+    x.clear();
+    y.clear();
+    for (size_t b = 0; b < buckets; ++b) {
+        const size_t lo = n * b / buckets;
+        const size_t hi = n * (b + 1) / buckets;
+        size_t imin = lo, imax = lo;
+        for (size_t i = lo + 1; i < hi; ++i) {
+            const double v = series.y(i);
+            if (v < series.y(imin)) imin = i;
+            if (v > series.y(imax)) imax = i;
+        }
+        const size_t first = imin < imax ? imin : imax;
+        const size_t second = imin < imax ? imax : imin;
+        x.push_back(series.x(first));
+        y.push_back(series.y(first));
+        if (second != first) {
+            x.push_back(series.x(second));
+            y.push_back(series.y(second));
+        }
+    }
+}
+
+void decimateLttb(const PlotSeries& series, size_t points,
+                  std::vector<double>& x, std::vector<double>& y) {
+    const size_t n = series.size();
+    if (points < 3 || n <= points) {
+        copyAll(series, x, y);
+        return;
+    }
+    x.clear();
+    y.clear();
+    x.push_back(series.x(0));
+    y.push_back(series.y(0));
+
+    // Points 1..n-2 split into points - 2 buckets.
+    const double every = static_cast<double>(n - 2) / static_cast<double>(points - 2);
+    size_t a = 0;
+    auto edge = [every](size_t b) {
+        return static_cast<size_t>(std::floor(static_cast<double>(b) * every)) + 1;
+    };
+    for (size_t b = 0; b < points - 2; ++b) {
+        const size_t lo = edge(b);
+        const size_t hi = edge(b + 1);
+        // Mean of the next bucket (the last point for the final one).
+        const size_t next_lo = hi;
+        const size_t next_hi = std::min(edge(b + 2), n);
+        double mean_x = 0.0, mean_y = 0.0;
+        for (size_t i = next_lo; i < next_hi; ++i) {
+            mean_x += series.x(i);
+            mean_y += series.y(i);
+        }
+        const double count = static_cast<double>(next_hi - next_lo);
+        mean_x /= count;
+        mean_y /= count;
+
+        const double ax = series.x(a), ay = series.y(a);
+        size_t pick = lo;
+        double best = -1.0;
+        for (size_t i = lo; i < hi; ++i) {
+            const double area = std::fabs((ax - mean_x) * (series.y(i) - ay) -
+                                          (ax - series.x(i)) * (mean_y - ay));
+            if (area > best) {
+                best = area;
+                pick = i;
+            }
+        }
+        x.push_back(series.x(pick));
+        y.push_back(series.y(pick));
+        a = pick;
+    }
+    x.push_back(series.x(n - 1));
+    y.push_back(series.y(n - 1));
+}
+
+}  // namespace qrsdp
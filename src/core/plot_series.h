@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace qrsdp {
+
+// ---------------------------------------------------------------------------
+// Live plot history: a fixed-capacity (x, y) series and the decimation that
+// turns it into a few points per pixel. Memory stays constant however long a
+// run goes, and drawing costs the same for 1k points as for 1M.
+// ---------------------------------------------------------------------------
+
+/// Circular (x, y) history. Once full, push() overwrites the oldest point.
+class PlotSeries {
+public:
+    /// Throws std::invalid_argument if capacity is 0.
+    explicit PlotSeries(size_t capacity);
+
+    void push(double x, double y);
+    void clear() { start_ = size_ = 0; }
+
+    size_t size() const { return size_; }
+    size_t capacity() const { return x_.size(); }
+    bool empty() const { return size_ == 0; }
+
+    /// i-th point, oldest first.
+    double x(size_t i) const { return x_[slot(i)]; }
+    double y(size_t i) const { return y_[slot(i)]; }
+
+private:
+    size_t slot(size_t i) const {
+        const size_t s = start_ + i;
+        return s >= x_.size() ? s - x_.size() : s;
+    }
+
+    std::vector<double> x_, y_;
+    size_t start_ = 0;
+    size_t size_ = 0;
+};
+
+/// Min-max decimation: splits the series into `buckets` runs of equal length
+/// and keeps each run's lowest and highest point, in order, so spikes survive.
+/// At most 2 * buckets points; a series that short (or buckets 0) is copied.
+void decimateMinMax(const PlotSeries& series, size_t buckets,
+                    std::vector<double>& x, std::vector<double>& y);
+
+/// Largest-Triangle-Three-Buckets (Steinarsson, 2013): keeps the first and last
+/// point and, from each bucket between, the one spanning the largest triangle
+/// with the previous pick and the next bucket's mean; preserves the shape.
+/// Exactly `points` points; a series that short (or points < 3) is copied.
+void decimateLttb(const PlotSeries& series, size_t points,
+                  std::vector<double>& x, std::vector<double>& y);
+
+}  // namespace qrsdp
@@ -12,18 +12,22 @@ constexpr uint32_t kFlagShiftUp   = 0x1;  // best ask moved up (ask-side depleti
 constexpr uint32_t kFlagShiftDown = 0x2;  // best bid moved down (bid-side depletion)
 constexpr uint32_t kFlagReinit    = 0x4;  // book depths were reinitialized after this shift
 
-// --- EventRecord (fixed width, packed) ---
-#pragma pack(push, 1)
+// --- EventRecord (in-memory, naturally aligned) ---
+/// Producers, sinks and rings pass these by the batch, so every field sits on
+/// its natural boundary (32 bytes, 8-aligned). Files and wire formats use the
+/// packed DiskEventRecord (io/event_log_format.h); toDisk()/fromDisk() there
+/// convert at that boundary. Fields are set by name; the order is layout only.
 struct EventRecord {
     uint64_t ts_ns;
-    uint8_t  type;
-    uint8_t  side;
+    uint64_t order_id;
     int32_t  price_ticks;
     uint32_t qty;
-    uint64_t order_id;
     uint32_t flags;
+    uint8_t  type;
+    uint8_t  side;
+    uint16_t reserved;  // 0
 };
-#pragma pack(pop)
+static_assert(sizeof(EventRecord) == 32 && alignof(EventRecord) == 8, "EventRecord must be 32 bytes, 8-aligned");
 
 // --- TradingSession input ---
 struct IntensityParams {
@@ -45,6 +49,10 @@ struct QueueReactiveParams {
 
 constexpr uint32_t kDefaultMarketOpenSeconds = 34200;  // 09:30 ET
 
+/// Uniform generator behind IRng. Recorded in the .qrsdp header (header_flags bits 8-15)
+/// so seed + algorithm regenerate a day exactly.
+enum class RngAlgorithm : uint8_t { MT19937 = 0, XOSHIRO256PP = 1, PHILOX4X32 = 2 };
+
 struct TradingSession {
     uint64_t seed;
     int32_t  p0_ticks;
@@ -56,6 +64,7 @@ struct TradingSession {
     uint32_t market_open_seconds;   // seconds from midnight to market open (default 34200 = 09:30)
     IntensityParams intensity_params;
     QueueReactiveParams queue_reactive;
+    RngAlgorithm rng = RngAlgorithm::MT19937;  // metadata only; the producer uses the IRng it is given
 };
 
 // --- SessionResult output ---
@@ -90,6 +99,13 @@ struct BookState {
     std::vector<uint32_t> ask_depths;
 };
 
+// --- Levels touched by the last IOrderBook::apply (for incremental intensity updates) ---
+struct BookDelta {
+    bool     full = true;      // prices moved or depths were reset: treat every level as changed
+    Side     side = Side::NA;  // side of the single touched level (NA with !full = nothing changed)
+    uint32_t level = 0;        // 0-based level index on that side
+};
+
 // --- Intensities (6 rates for competing risks) ---
 struct Intensities {
     double add_bid;
@@ -0,0 +1,84 @@
+#include "io/arrow_file_sink.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <stdexcept>
+
+namespace qrsdp {
+
+namespace {
+
+constexpr size_t kDrainBytes = 4 << 20;
+
+}  // namespace
+
+ArrowFileSink::ArrowFileSink(const std::string& path, const std::string& symbol, const std::string& date,
+                             size_t batch_rows)
+    : path_(path),
+      tmp_path_(path + ".tmp"),
+      symbol_(symbol),
+      days_(daysSinceEpoch(date)),
+      batch_rows_(std::max<size_t>(batch_rows, 1)),
+      encoder_(makeExportEncoder(ExportFormat::Arrow)) {
+    file_ = std::fopen(tmp_path_.c_str(), "wb");
+    if (!file_) throw std::runtime_error("ArrowFileSink: cannot create " + tmp_path_);
+    pending_.reserve(batch_rows_);
+    encoder_->begin(out_);
+}
+
+ArrowFileSink::~ArrowFileSink() {
+    try {
+        close();
+    } catch (...) {
+        // Destructors must not throw; the temporary file is left behind.
+    }
+}
+
+void ArrowFileSink::append(const EventRecord& rec) { appendBatch(&rec, 1); }
+
+void ArrowFileSink::appendBatch(const EventRecord* recs, size_t n) {
+    while (n > 0) {
+        const size_t at = pending_.size();
+        const size_t take = std::min(n, batch_rows_ - at);
+        pending_.resize(at + take);
+        toDisk(recs, take, pending_.data() + at);
+        recs += take;
+        n -= take;
+        if (pending_.size() == batch_rows_) writeBatch();
+    }
+}
+
+void ArrowFileSink::writeBatch() {
+    encoder_->batch(pending_.data(), pending_.size(), symbol_, days_, out_);
+    records_ += pending_.size();
+    ++batches_;
+    pending_.clear();
+    if (out_.size() >= kDrainBytes) drain();
+}
+
+void ArrowFileSink::drain() {
+    if (!out_.empty() && std::fwrite(out_.data(), 1, out_.size(), file_) != out_.size())
+        throw std::runtime_error("ArrowFileSink: write failed: " + tmp_path_);
+    out_.clear();
+}
+
+void ArrowFileSink::flush() {
+    if (!file_) return;
+    drain();
+    std::fflush(file_);
+}
+
+void ArrowFileSink::close() {
+    if (!file_) return;
+    if (!pending_.empty()) writeBatch();
+    encoder_->end(out_);
+    drain();
+    const bool ok = std::fclose(file_) == 0;
+    file_ = nullptr;
+    if (!ok) throw std::runtime_error("ArrowFileSink: write failed: " + tmp_path_);
+    std::remove(path_.c_str());  // rename() does not replace on Windows
+    if (std::rename(tmp_path_.c_str(), path_.c_str()) != 0)
+        throw std::runtime_error("ArrowFileSink: cannot rename " + tmp_path_ + " to " + path_);
+}
+
+}  // namespace qrsdp
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "io/event_log_format.h"
+#include "io/i_event_sink.h"
+#include "io/table_export.h"
+#include "core/records.h"
+
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace qrsdp {
+
+/// IEventSink that writes one session as an Arrow IPC file (the Arrow format of
+/// table_export.h: type and side dictionary-encoded, symbol and date filled in).
+/// Records are gathered into record batches of batch_rows; given a day file's
+/// chunk capacity, batch k holds exactly the records of chunk k. Polars, DuckDB
+/// and pyarrow can then scan a run's files without going through .qrsdp.
+///
+/// The file is written to <path>.tmp and renamed on close(), so a reader never
+/// sees a partial file. Throws std::runtime_error when the file cannot be
+/// created or written.
+class ArrowFileSink final : public IEventSink {
+public:
+    ArrowFileSink(const std::string& path, const std::string& symbol, const std::string& date,
+                  size_t batch_rows = kDefaultChunkCapacity);
+    ~ArrowFileSink() override;
+
+    ArrowFileSink(const ArrowFileSink&) = delete;
+    ArrowFileSink& operator=(const ArrowFileSink&) = delete;
+
+    void append(const EventRecord& rec) override;
+    void appendBatch(const EventRecord* recs, size_t n) override;
+    void flush() override;
+    /// Writes the last batch and the footer and renames the file into place. Idempotent.
+    void close() override;
+
+    uint64_t recordsWritten() const { return records_; }
+    uint64_t batchesWritten() const { return batches_; }
+
+private:
+    void writeBatch();
+    void drain();
+
+    std::string path_;
+    std::string tmp_path_;
+    std::string symbol_;
+    int32_t days_;
+    size_t batch_rows_;
+    std::FILE* file_ = nullptr;
+    std::unique_ptr<ExportEncoder> encoder_;
+    std::vector<DiskEventRecord> pending_;
+    std::vector<char> out_;
+    uint64_t records_ = 0;
+    uint64_t batches_ = 0;
+};
+
+}  // namespace qrsdp
@@ -0,0 +1,235 @@
+#include "io/async_sink.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <exception>
+#include <stdexcept>
+#include <vector>
+
+namespace qrsdp {
+
+namespace {
+
+/// Records handed to the downstream sink per appendBatch call.
+constexpr size_t kDrainBatch = 256;
+/// Yields before the worker goes to sleep on an empty queue.
+constexpr int kIdleSpins = 64;
+
+}  // namespace
+
+const char* overflowPolicyName(OverflowPolicy policy) {
+    switch (policy) {
+        case OverflowPolicy::BLOCK:       return "block";
+        case OverflowPolicy::DROP_OLDEST: return "drop-oldest";
+        case OverflowPolicy::DROP_NEWEST: return "drop-newest";
+    }
+    return "unknown";
+}
+
+bool parseOverflowPolicy(const std::string& name, OverflowPolicy& out) {
+    for (OverflowPolicy p : {OverflowPolicy::BLOCK, OverflowPolicy::DROP_OLDEST,
+                             OverflowPolicy::DROP_NEWEST}) {
+        if (name == overflowPolicyName(p)) {
+            out = p;
+            return true;
+        }
+    }
+    return false;
+}
+
+AsyncSink::AsyncSink(IEventSink* downstream, const AsyncSinkOptions& options)
+    : downstream_(downstream), options_(options) {
+    if (!downstream_)
+        throw std::invalid_argument("AsyncSink: null downstream sink");
+    // At least two slots: with one, a full slot's sequence would read as free.
+    size_t cap = 2;
+    while (cap < options_.queue_records) cap <<= 1;
+    slots_.reset(new Slot[cap]);
+    for (size_t i = 0; i < cap; ++i)
+        slots_[i].seq.store(i, std::memory_order_relaxed);
+    mask_ = cap - 1;
+    thread_ = std::thread([this] { run(); });
+}
+
+AsyncSink::~AsyncSink() {
+    stop_.store(true);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        cv_.notify_all();
+    }
+    thread_.join();
+}
+
+// --- queue ---
+
+bool AsyncSink::tryPush(const EventRecord& rec) {
+    const size_t pos = tail_.load(std::memory_order_relaxed);
+    Slot& slot = slots_[pos & mask_];
+    // Anything but pos: the slot still holds (or is being read for) pos - capacity.
+    if (slot.seq.load(std::memory_order_acquire) != pos)
+        return false;
+    slot.rec = rec;
+    slot.seq.store(pos + 1, std::memory_order_release);
+    // seq_cst so a worker that announces it is about to sleep cannot miss it.
+    tail_.store(pos + 1, std::memory_order_seq_cst);
+    const uint64_t lag = pos + 1 - head_.load(std::memory_order_relaxed);
+    if (lag > max_lag_.load(std::memory_order_relaxed))
+        max_lag_.store(lag, std::memory_order_relaxed);
+    return true;
+}
+
+bool AsyncSink::tryPop(EventRecord& out) {
+    size_t pos = head_.load(std::memory_order_relaxed);
+    for (;;) {
+        Slot& slot = slots_[pos & mask_];
+        const size_t seq = slot.seq.load(std::memory_order_acquire);
+        const auto diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+        if (diff == 0) {
+            if (head_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                out = slot.rec;
+                slot.seq.store(pos + mask_ + 1, std::memory_order_release);
+                return true;
+            }
+        } else if (diff < 0) {
+            return false;  // empty
+        } else {
+            pos = head_.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+bool AsyncSink::queued() const {
+    return head_.load(std::memory_order_seq_cst) != tail_.load(std::memory_order_seq_cst);
+}
+
+void AsyncSink::push(const EventRecord& rec) {
+    if (tryPush(rec))
+        return;
+    switch (options_.policy) {
+        case OverflowPolicy::DROP_NEWEST:
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        case OverflowPolicy::DROP_OLDEST: {
+            EventRecord oldest;
+            do {
+                if (tryPop(oldest))
+                    dropped_.fetch_add(1, std::memory_order_relaxed);
+            } while (!tryPush(rec));
+            return;
+        }
+        case OverflowPolicy::BLOCK:
+            break;
+    }
+    stalls_.fetch_add(1, std::memory_order_relaxed);
+    do {
+        wake();
+        std::this_thread::yield();
+    } while (!tryPush(rec));
+}
+
+// --- producer side ---
+
+void AsyncSink::append(const EventRecord& rec) {
+    push(rec);
+    wake();
+}
+
+void AsyncSink::appendBatch(const EventRecord* recs, size_t n) {
+    for (size_t i = 0; i < n; ++i)
+        push(recs[i]);
+    wake();
+}
+
+void AsyncSink::flush() {
+    runCommand(Command::FLUSH);
+}
+
+void AsyncSink::close() {
+    runCommand(Command::CLOSE);
+}
+
+void AsyncSink::runCommand(Command cmd) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    command_ = cmd;
+    const uint64_t target = commands_done_ + 1;
+    cv_.notify_all();
+    done_cv_.wait(lock, [&] { return commands_done_ >= target; });
+}
+
+AsyncSinkStats AsyncSink::stats() const {
+    AsyncSinkStats st;
+    const size_t head = head_.load(std::memory_order_acquire);
+    const size_t tail = tail_.load(std::memory_order_acquire);
+    st.appended = tail;
+    st.written = written_.load(std::memory_order_relaxed);
+    st.dropped = dropped_.load(std::memory_order_relaxed);
+    st.stalls = stalls_.load(std::memory_order_relaxed);
+    st.lag = tail - std::min(head, tail);
+    st.max_lag = max_lag_.load(std::memory_order_relaxed);
+    return st;
+}
+
+// --- worker ---
+
+void AsyncSink::wake() {
+    if (worker_sleeping_.load()) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        cv_.notify_all();
+    }
+}
+
+void AsyncSink::run() {
+    std::vector<EventRecord> batch(kDrainBatch);
+    for (;;) {
+        size_t n = 0;
+        while (n < kDrainBatch && tryPop(batch[n]))
+            ++n;
+        if (n > 0) {
+            try {
+                downstream_->appendBatch(batch.data(), n);
+            } catch (const std::exception& e) {
+                std::fprintf(stderr, "AsyncSink: sink error: %s\n", e.what());
+            }
+            written_.fetch_add(n, std::memory_order_relaxed);
+            continue;
+        }
+
+        // Queue drained: everything appended before a flush/close is written.
+        Command cmd;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            cmd = command_;
+        }
+        if (cmd != Command::NONE) {
+            try {
+                if (cmd == Command::FLUSH) downstream_->flush();
+                else downstream_->close();
+            } catch (const std::exception& e) {
+                std::fprintf(stderr, "AsyncSink: %s error: %s\n",
+                             cmd == Command::FLUSH ? "flush" : "close", e.what());
+            }
+            std::lock_guard<std::mutex> lock(mutex_);
+            command_ = Command::NONE;
+            ++commands_done_;
+            done_cv_.notify_all();
+            continue;
+        }
+        if (stop_.load())
+            break;
+
+        bool woke = false;
+        for (int spin = 0; spin < kIdleSpins && !woke; ++spin) {
+            woke = queued() || stop_.load();
+            if (!woke) std::this_thread::yield();
+        }
+        if (!woke) {
+            std::unique_lock<std::mutex> lock(mutex_);
+            worker_sleeping_.store(true);  // seq_cst: pairs with the queue's seq_cst publish in wake()
+            cv_.wait(lock, [this] { return queued() || stop_.load() || command_ != Command::NONE; });
+            worker_sleeping_.store(false);
+        }
+    }
+}
+
+}  // namespace qrsdp
@@ -0,0 +1,107 @@
+#pragma once
+
+#include "io/i_event_sink.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace qrsdp {
+
+/// What AsyncSink::append does when the queue is full.
+///   BLOCK       — wait for the worker to make room (nothing is lost).
+///   DROP_OLDEST — discard the oldest queued record, so the sink sees the latest.
+///   DROP_NEWEST — discard the record being appended.
+enum class OverflowPolicy { BLOCK, DROP_OLDEST, DROP_NEWEST };
+
+/// "block", "drop-oldest", "drop-newest"; "unknown" for out-of-range values.
+const char* overflowPolicyName(OverflowPolicy policy);
+
+/// Inverse of overflowPolicyName. Returns false (out untouched) for unknown names.
+bool parseOverflowPolicy(const std::string& name, OverflowPolicy& out);
+
+struct AsyncSinkOptions {
+    size_t queue_records = 1 << 16;   // rounded up to a power of two
+    OverflowPolicy policy = OverflowPolicy::BLOCK;
+};
+
+struct AsyncSinkStats {
+    uint64_t appended = 0;   // records accepted into the queue
+    uint64_t written = 0;    // records handed to the downstream sink
+    uint64_t dropped = 0;    // records lost to DROP_OLDEST / DROP_NEWEST
+    uint64_t stalls = 0;     // BLOCK: appends that found the queue full and waited
+    uint64_t lag = 0;        // records queued when the stats were read
+    uint64_t max_lag = 0;    // deepest the queue has been
+};
+
+/// Runs a downstream sink on its own thread behind a bounded queue, so a slow
+/// sink (a Kafka broker) cannot stall the producer or the sinks beside it in a
+/// MultiplexSink. One producer thread at a time calls append / flush / close;
+/// the downstream sink is only ever called from the worker thread, so it needs
+/// no locking, and it must outlive this object. Downstream exceptions are
+/// logged and the records counted as written, as MultiplexSink does.
+///
+/// The queue is single-producer; with DROP_OLDEST the producer also takes
+/// from the consumer end, so slots carry sequence numbers (Vyukov-style) and
+/// the head is claimed with a CAS. flush() and close() wait until the worker
+/// has written everything queued and then run the downstream flush() /
+/// close() on the worker thread; the sink stays usable afterwards.
+class AsyncSink final : public IEventSink {
+public:
+    AsyncSink(IEventSink* downstream, const AsyncSinkOptions& options = {});
+    ~AsyncSink() override;
+
+    AsyncSink(const AsyncSink&) = delete;
+    AsyncSink& operator=(const AsyncSink&) = delete;
+
+    void append(const EventRecord& rec) override;
+    void appendBatch(const EventRecord* recs, size_t n) override;
+    void flush() override;
+    void close() override;
+
+    AsyncSinkStats stats() const;
+    const AsyncSinkOptions& options() const { return options_; }
+
+private:
+    struct Slot {
+        std::atomic<size_t> seq{0};
+        EventRecord rec;
+    };
+    enum class Command { NONE, FLUSH, CLOSE };
+
+    bool tryPush(const EventRecord& rec);
+    bool tryPop(EventRecord& out);
+    void push(const EventRecord& rec);
+    bool queued() const;
+    void runCommand(Command cmd);
+    void run();
+    void wake();
+
+    IEventSink* downstream_;
+    AsyncSinkOptions options_;
+    std::unique_ptr<Slot[]> slots_;
+    size_t mask_ = 0;
+    alignas(64) std::atomic<size_t> head_{0};  // worker, and the producer under DROP_OLDEST
+    alignas(64) std::atomic<size_t> tail_{0};  // producer
+
+    std::atomic<uint64_t> written_{0};
+    std::atomic<uint64_t> dropped_{0};
+    std::atomic<uint64_t> stalls_{0};
+    std::atomic<uint64_t> max_lag_{0};
+
+    std::atomic<bool> stop_{false};
+    std::atomic<bool> worker_sleeping_{false};
+    std::mutex mutex_;
+    std::condition_variable cv_;               // wakes the worker
+    std::condition_variable done_cv_;          // signals a finished command
+    Command command_ = Command::NONE;          // guarded by mutex_
+    uint64_t commands_done_ = 0;               // guarded by mutex_
+    std::thread thread_;
+};
+
+}  // namespace qrsdp
@@ -0,0 +1,112 @@
+#include "io/bar_rollup.h"
+
+#include "core/event_types.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace qrsdp {
+
+BarRollup::BarRollup(const FileHeader& header, const std::vector<uint32_t>& bar_seconds)
+    : replayer_(header), open_ns_(header.market_open_ns) {
+    std::vector<uint32_t> seconds;
+    for (uint32_t s : bar_seconds)
+        if (s > 0) seconds.push_back(s);
+    std::sort(seconds.begin(), seconds.end());
+    seconds.erase(std::unique(seconds.begin(), seconds.end()), seconds.end());
+    for (uint32_t s : seconds) {
+        BarSeries series;
+        series.interval_ns = static_cast<uint64_t>(s) * 1'000'000'000ULL;
+        series_.push_back(std::move(series));
+    }
+}
+
+void BarRollup::add(const DiskEventRecord& rec) {
+    replayer_.apply(rec);
+    const MultiLevelBook& book = replayer_.book();
+    const int32_t bid = book.bestBid().price_ticks;
+    const int32_t ask = book.bestAsk().price_ticks;
+    const int32_t mid2 = bid + ask;
+    const auto type = static_cast<EventType>(rec.type);
+    const bool execution = type == EventType::EXECUTE_BUY || type == EventType::EXECUTE_SELL;
+    const uint64_t offset = rec.ts_ns > open_ns_ ? rec.ts_ns - open_ns_ : 0;
+
+    for (BarSeries& series : series_) {
+        const uint64_t start = open_ns_ + offset / series.interval_ns * series.interval_ns;
+        if (series.bars.empty() || series.bars.back().start_ns != start) {
+            DiskBar bar{};
+            bar.start_ns = start;
+            bar.open_mid2 = mid2;
+            bar.high_mid2 = mid2;
+            bar.low_mid2 = mid2;
+            series.bars.push_back(bar);
+        }
+        DiskBar& bar = series.bars.back();
+        bar.high_mid2 = std::max(bar.high_mid2, mid2);
+        bar.low_mid2 = std::min(bar.low_mid2, mid2);
+        bar.close_mid2 = mid2;
+        bar.close_bid_ticks = bid;
+        bar.close_ask_ticks = ask;
+        ++bar.events;
+        if (execution) {
+            ++bar.executions;
+            bar.volume += rec.qty;
+        }
+    }
+}
+
+void encodeBars(const std::vector<BarSeries>& series, std::vector<char>& out) {
+    size_t bytes = sizeof(BarBlockHeader);
+    for (const BarSeries& s : series)
+        bytes += sizeof(BarSeriesHeader) + s.bars.size() * sizeof(DiskBar);
+    size_t pos = out.size();
+    out.resize(pos + bytes);
+
+    BarBlockHeader bbh{};
+    bbh.series_count = static_cast<uint32_t>(series.size());
+    std::memcpy(out.data() + pos, &bbh, sizeof(bbh));
+    pos += sizeof(bbh);
+    for (const BarSeries& s : series) {
+        BarSeriesHeader sh{};
+        sh.interval_ns = s.interval_ns;
+        sh.bar_count = static_cast<uint32_t>(s.bars.size());
+        std::memcpy(out.data() + pos, &sh, sizeof(sh));
+        pos += sizeof(sh);
+        std::memcpy(out.data() + pos, s.bars.data(), s.bars.size() * sizeof(DiskBar));
+        pos += s.bars.size() * sizeof(DiskBar);
+    }
+}
+
+std::vector<BarSeries> decodeBars(const char* payload, size_t size) {
+    BarBlockHeader bbh{};
+    if (size < sizeof(bbh))
+        throw std::runtime_error("bar block too short");
+    std::memcpy(&bbh, payload, sizeof(bbh));
+    size_t pos = sizeof(bbh);
+
+    std::vector<BarSeries> series;
+    for (uint32_t i = 0; i < bbh.series_count; ++i) {
+        BarSeriesHeader sh{};
+        if (size - pos < sizeof(sh))
+            throw std::runtime_error("bar block size mismatch");
+        std::memcpy(&sh, payload + pos, sizeof(sh));
+        pos += sizeof(sh);
+        if (sh.interval_ns == 0 || (size - pos) / sizeof(DiskBar) < sh.bar_count)
+            throw std::runtime_error("bar block size mismatch");
+        BarSeries s;
+        s.interval_ns = sh.interval_ns;
+        s.bars.resize(sh.bar_count);
+        std::memcpy(s.bars.data(), payload + pos, s.bars.size() * sizeof(DiskBar));
+        pos += s.bars.size() * sizeof(DiskBar);
+        for (size_t k = 1; k < s.bars.size(); ++k)
+            if (s.bars[k].start_ns <= s.bars[k - 1].start_ns)
+                throw std::runtime_error("bar start times do not increase");
+        series.push_back(std::move(s));
+    }
+    if (pos != size)
+        throw std::runtime_error("bar block size mismatch");
+    return series;
+}
+
+}  // namespace qrsdp
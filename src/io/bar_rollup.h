@@ -0,0 +1,50 @@
+#pragma once
+
+#include "io/book_replayer.h"
+#include "io/event_log_format.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace qrsdp {
+
+/// Bars of one resolution, as stored in a bar block (kChunkFlagBars).
+struct BarSeries {
+    uint64_t interval_ns = 0;
+    std::vector<DiskBar> bars;  // time order, non-empty bars only
+};
+
+/// Builds multi-resolution OHLC bars from a log's records as they are written:
+/// replays them through a BookReplayer seeded from the file header, so the bars
+/// equal what a full replay of the finished file computes, at no extra I/O.
+/// Per record that is one book update plus one bar update per resolution.
+class BarRollup {
+public:
+    /// One series per distinct non-zero entry of bar_seconds, in ascending order.
+    /// Bars are aligned to header.market_open_ns; earlier records go in the first bar.
+    BarRollup(const FileHeader& header, const std::vector<uint32_t>& bar_seconds);
+
+    void add(const DiskEventRecord& rec);
+    void add(const DiskEventRecord* recs, size_t n) {
+        for (size_t i = 0; i < n; ++i) add(recs[i]);
+    }
+
+    const std::vector<BarSeries>& series() const { return series_; }
+    uint64_t records() const { return replayer_.recordsApplied(); }
+
+private:
+    BookReplayer replayer_;
+    uint64_t open_ns_;
+    std::vector<BarSeries> series_;
+};
+
+/// Appends the bar-block payload for series (BarBlockHeader, then a BarSeriesHeader
+/// and the bars of each) to out.
+void encodeBars(const std::vector<BarSeries>& series, std::vector<char>& out);
+
+/// Parses a bar-block payload. Throws std::runtime_error if it is malformed or a
+/// series' bars are not in strictly increasing start order.
+std::vector<BarSeries> decodeBars(const char* payload, size_t size);
+
+}  // namespace qrsdp
@@ -1,71 +1,338 @@
 #include "io/binary_file_sink.h"
-
-#include <lz4.h>
-
+#include "core/metrics.h"
+#include "io/crc32c.h"
+#include "io/event_log_reader.h"
+#include "io/spsc_ring.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <cstring>
+#include <exception>
+#include <filesystem>
+#include <mutex>
 #include <stdexcept>
+#include <system_error>
+#include <thread>
+#include <utility>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
 
 namespace qrsdp {
 
+namespace {
+
+/// Flushes the OS's copy of f to the device (f's stdio buffer must be flushed first).
+bool syncToDisk(std::FILE* f) {
+#ifdef _WIN32
+    return _commit(_fileno(f)) == 0;
+#else
+    return fsync(fileno(f)) == 0;
+#endif
+}
+
+void removeSidecar(const std::string& path) {
+    std::error_code ec;
+    std::filesystem::remove(sidecarIndexPath(path), ec);
+}
+
+}  // namespace
+
+/// Background compression/write thread. Chunk buffers circulate as indices: the
+/// producer pops a free slot, swaps its full buffer in and pushes the slot to
+/// filled_; the writer writes it, clears it and pushes it back to free_. Both
+/// sides spin briefly on an empty ring, then sleep on cv_ until the other wakes them.
+class BinaryFileSink::AsyncWriter {
+public:
+    AsyncWriter(BinaryFileSink& sink, uint32_t buffers)
+        : sink_(sink), slots_(buffers - 1), filled_(buffers), free_(buffers) {
+        for (uint32_t i = 0; i < slots_.size(); ++i) {
+            slots_[i].reserve(sink.chunk_capacity_);
+            free_.tryPush(i);
+        }
+        thread_ = std::thread([this] { run(); });
+    }
+
+    ~AsyncWriter() { stop(); }
+
+    /// Queues rows as the next chunk; rows is replaced by an empty recycled buffer.
+    /// Blocks while every buffer is in flight.
+    void submit(std::vector<DiskEventRecord>& rows) {
+        rethrowIfFailed();
+        uint32_t idx;
+        while (!free_.tryPop(idx))
+            waitUntil(producer_sleeping_, [this] { return !free_.empty(); });
+        std::swap(rows, slots_[idx]);
+        ++submitted_;
+        filled_.tryPush(idx);  // never full: at most slots_.size() indices exist
+        wake(writer_sleeping_);
+    }
+
+    /// Waits until every submitted chunk has been written.
+    void drain() {
+        waitUntil(producer_sleeping_, [this] { return completed_.load() == submitted_; });
+        rethrowIfFailed();
+    }
+
+    /// Finishes queued chunks and joins the thread. Idempotent; never throws.
+    void stop() {
+        if (!thread_.joinable()) return;
+        stop_.store(true);
+        wake(writer_sleeping_);
+        thread_.join();
+    }
+
+private:
+    void run() {
+        for (;;) {
+            uint32_t idx;
+            if (!filled_.tryPop(idx)) {
+                if (stop_.load() && filled_.empty()) return;
+                waitUntil(writer_sleeping_, [this] { return !filled_.empty() || stop_.load(); });
+                continue;
+            }
+            if (!failed_.load(std::memory_order_relaxed)) {
+                try {
+                    sink_.writeChunk(slots_[idx]);
+                } catch (...) {
+                    error_ = std::current_exception();
+                    failed_.store(true);
+                }
+            }
+            slots_[idx].clear();
+            free_.tryPush(idx);
+            completed_.fetch_add(1);
+            wake(producer_sleeping_);
+        }
+    }
+
+    void rethrowIfFailed() {
+        if (failed_.load()) std::rethrow_exception(error_);
+    }
+
+    template <class Ready>
+    void waitUntil(std::atomic<bool>& sleeping, Ready ready) {
+        for (int spin = 0; spin < 64; ++spin) {
+            if (ready()) return;
+            std::this_thread::yield();
+        }
+        std::unique_lock<std::mutex> lock(mutex_);
+        sleeping.store(true);  // seq_cst: pairs with the ring's seq_cst publish in wake()
+        cv_.wait(lock, ready);
+        sleeping.store(false);
+    }
+
+    void wake(std::atomic<bool>& sleeping) {
+        if (sleeping.load()) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            cv_.notify_all();
+        }
+    }
+
+    BinaryFileSink& sink_;
+    std::vector<std::vector<DiskEventRecord>> slots_;  // buffers besides the sink's own
+    SpscRing<uint32_t> filled_;  // producer -> writer
+    SpscRing<uint32_t> free_;    // writer -> producer
+    uint64_t submitted_ = 0;     // producer only
+    std::atomic<uint64_t> completed_{0};
+    std::atomic<bool> stop_{false};
+    std::atomic<bool> failed_{false};
+    std::exception_ptr error_;   // published by failed_
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::atomic<bool> writer_sleeping_{false};
+    std::atomic<bool> producer_sleeping_{false};
+    std::thread thread_;
+};
+
 BinaryFileSink::BinaryFileSink(const std::string& path,
                                const TradingSession& session,
-                               uint32_t chunk_capacity)
-    : chunk_capacity_(chunk_capacity)
+                               uint32_t chunk_capacity,
+                               uint32_t write_buffers)
+    : BinaryFileSink(path, session, [&] {
+          BinaryFileSinkOptions options;
+          options.chunk_capacity = chunk_capacity;
+          options.write_buffers = write_buffers;
+          return options;
+      }())
 {
-    file_ = std::fopen(path.c_str(), "wb");
-    if (!file_)
-        throw std::runtime_error("BinaryFileSink: cannot open " + path);
+}
 
+BinaryFileSink::BinaryFileSink(const std::string& path,
+                               const TradingSession& session,
+                               const BinaryFileSinkOptions& options)
+    : io_uring_(options.io_uring), path_(path), chunk_capacity_(options.chunk_capacity),
+      columnar_(options.columnar),
+      compressor_(options.codec), training_(options.codec.dictionary && options.codec.codec == ChunkCodec::ZSTD),
+      seek_stride_(options.seek_stride), stats_(options.stats), levels_per_side_(session.levels_per_side),
+      checkpoint_interval_(options.checkpoint_interval), next_checkpoint_chunk_(options.checkpoint_interval),
+      sync_interval_(options.sync_interval), compress_ns_(options.compress_ns)
+{
     buffer_.reserve(chunk_capacity_);
 
-    const int max_compressed = LZ4_compressBound(
-        static_cast<int>(chunk_capacity_ * sizeof(DiskEventRecord)));
-    compress_buf_.resize(static_cast<size_t>(max_compressed));
+    compress_buf_.resize(compressor_.bound(chunk_capacity_ * sizeof(DiskEventRecord)));
+    if (!options.bar_seconds.empty())
+        bars_ = std::make_unique<BarRollup>(fileHeaderFor(session), options.bar_seconds);
+
+    if (!(options.resume && resumeFile(path, session))) {
+        removeSidecar(path);  // left by an earlier run; it would describe a file we truncate
+        openFile(path, true);
+        writeFileHeader(session);
+    }
 
-    writeFileHeader(session);
+    if (options.write_buffers >= 2)
+        async_ = std::make_unique<AsyncWriter>(*this, options.write_buffers);
 }
 
 BinaryFileSink::~BinaryFileSink() {
-    if (file_)
-        close();
+    if (isOpen()) {
+        try {
+            close();
+        } catch (...) {
+            // Destructors must not throw; call close() explicitly to see write errors.
+        }
+    }
 }
 
 void BinaryFileSink::append(const EventRecord& rec) {
-    DiskEventRecord disk;
-    disk.ts_ns       = rec.ts_ns;
-    disk.type        = rec.type;
-    disk.side        = rec.side;
-    disk.price_ticks = rec.price_ticks;
-    disk.qty         = rec.qty;
-    disk.order_id    = rec.order_id;
-    buffer_.push_back(disk);
+    buffer_.push_back(toDisk(rec));
+    countFlags(rec.flags);
 
     if (buffer_.size() >= chunk_capacity_)
         flushChunk();
+    maybeCheckpoint(rec.ts_ns);
+}
+
+void BinaryFileSink::appendBatch(const EventRecord* recs, size_t n) {
+    if (n == 0)
+        return;
+    const uint64_t last_ts_ns = recs[n - 1].ts_ns;
+    // Fill the chunk buffer a span at a time; chunk boundaries land exactly
+    // where per-record append() would have put them.
+    while (n > 0) {
+        const size_t room = buffer_.size() < chunk_capacity_
+            ? chunk_capacity_ - buffer_.size() : 1;
+        const size_t take = n < room ? n : room;
+        const size_t at = buffer_.size();
+        buffer_.resize(at + take);
+        toDisk(recs, take, buffer_.data() + at);
+        for (size_t i = 0; i < take; ++i)
+            countFlags(recs[i].flags);
+        recs += take;
+        n -= take;
+        if (buffer_.size() >= chunk_capacity_)
+            flushChunk();
+    }
+    maybeCheckpoint(last_ts_ns);
 }
 
 void BinaryFileSink::flush() {
     if (!buffer_.empty())
         flushChunk();
+    if (async_)
+        async_->drain();
 }
 
 void BinaryFileSink::close() {
+    if (!isOpen())
+        return;
+
+    std::exception_ptr error;
+    try {
+        flush();
+    } catch (...) {
+        error = std::current_exception();
+    }
+    if (async_) {
+        async_->stop();
+        async_.reset();
+    }
+    if (!error) {
+        try {
+            if (training_)
+                writeHeldChunks();  // fewer than kDictionaryTrainingChunks chunks in the file
+            writeIndex();
+            if (sync_interval_ > 0)
+                syncFile();
+        } catch (...) {
+            error = std::current_exception();
+        }
+    }
+    try {
+        closeFile();
+    } catch (...) {
+        if (!error)
+            error = std::current_exception();
+    }
+    if (error)
+        std::rethrow_exception(error);
+    if (sync_interval_ > 0 || resumed_)
+        removeSidecar(path_);  // the footer supersedes it
+}
+
+// --- Private ---
+
+void BinaryFileSink::openFile(const std::string& path, bool truncate) {
+    if (io_uring_) {
+        uring_file_ = io_uring_->open(path, truncate);
+        return;
+    }
+    file_ = std::fopen(path.c_str(), truncate ? "wb" : "r+b");
     if (!file_)
+        throw std::runtime_error("BinaryFileSink: cannot open " + path);
+    std::fseek(file_, 0, SEEK_END);
+}
+
+void BinaryFileSink::writeBytes(const void* data, size_t n) {
+    if (uring_file_)
+        uring_file_->append(data, n);
+    else
+        std::fwrite(data, 1, n, file_);
+}
+
+uint64_t BinaryFileSink::writeOffset() const {
+    return uring_file_ ? uring_file_->size() : static_cast<uint64_t>(std::ftell(file_));
+}
+
+void BinaryFileSink::patchHeaderFlags(uint32_t flags) {
+    const size_t at = offsetof(FileHeader, header_flags);
+    if (uring_file_) {
+        uring_file_->patch(at, &flags, sizeof(flags));
+        return;
+    }
+    std::fseek(file_, static_cast<long>(at), SEEK_SET);
+    std::fwrite(&flags, sizeof(flags), 1, file_);
+    std::fseek(file_, 0, SEEK_END);
+}
+
+void BinaryFileSink::syncFile() {
+    if (uring_file_) {
+        uring_file_->sync();
         return;
+    }
+    if (std::fflush(file_) != 0 || !syncToDisk(file_))
+        throw std::runtime_error("BinaryFileSink: cannot sync " + path_);
+}
 
-    flush();
-    writeIndex();
+void BinaryFileSink::closeFile() {
+    if (uring_file_) {
+        std::unique_ptr<IoUringFile> f = std::move(uring_file_);
+        f->close();
+        return;
+    }
     std::fclose(file_);
     file_ = nullptr;
 }
 
-// --- Private ---
-
-void BinaryFileSink::writeFileHeader(const TradingSession& session) {
+FileHeader BinaryFileSink::fileHeaderFor(const TradingSession& session) const {
     FileHeader hdr{};
     std::memcpy(hdr.magic, kLogMagic, 8);
     hdr.version_major        = kLogVersionMajor;
-    hdr.version_minor        = kLogVersionMinor;
+    hdr.version_minor        = columnar_ ? kLogVersionMinorColumnar : kLogVersionMinor;
     hdr.record_size          = static_cast<uint32_t>(sizeof(DiskEventRecord));
     hdr.seed                 = session.seed;
     hdr.p0_ticks             = session.p0_ticks;
@@ -75,74 +342,399 @@ void BinaryFileSink::writeFileHeader(const TradingSession& session) {
     hdr.initial_spread_ticks = session.initial_spread_ticks;
     hdr.initial_depth        = session.initial_depth;
     hdr.chunk_capacity       = chunk_capacity_;
-    hdr.header_flags         = 0;
+    hdr.header_flags         = ((static_cast<uint32_t>(session.rng) << kHeaderRngShift) & kHeaderRngMask)
+                             | ((static_cast<uint32_t>(compressor_.codec()) << kHeaderCodecShift) & kHeaderCodecMask)
+                             | kHeaderFlagChunkChecksums;
     hdr.market_open_ns       = static_cast<uint64_t>(session.market_open_seconds) * 1'000'000'000ULL;
+    return hdr;
+}
 
-    std::fwrite(&hdr, sizeof(hdr), 1, file_);
+void BinaryFileSink::writeFileHeader(const TradingSession& session) {
+    const FileHeader hdr = fileHeaderFor(session);
+    header_flags_ = hdr.header_flags;
+    writeBytes(&hdr, sizeof(hdr));
+}
+
+bool BinaryFileSink::resumeFile(const std::string& path, const TradingSession& session) {
+    std::error_code ec;
+    const auto size = std::filesystem::file_size(path, ec);
+    if (ec || size < sizeof(FileHeader))
+        return false;
+
+    SinkResumePoint point;
+    uint32_t resume_chunk = 0;
+    uint64_t truncate_at = 0;
+    std::vector<char> dictionary;
+    {
+        // The reader uses the sidecar, if any, and drops a torn final chunk.
+        EventLogReader reader(path);
+        const FileHeader& hdr = reader.header();
+        if (hdr.header_flags & kHeaderFlagHasIndex)
+            throw std::runtime_error("BinaryFileSink: " + path + " is already complete");
+        const uint32_t codec = (hdr.header_flags & kHeaderCodecMask) >> kHeaderCodecShift;
+        if (hdr.seed != session.seed || hdr.p0_ticks != session.p0_ticks
+            || hdr.levels_per_side != session.levels_per_side || hdr.chunk_capacity != chunk_capacity_
+            || codec != static_cast<uint32_t>(compressor_.codec())
+            || hdr.version_minor != (columnar_ ? kLogVersionMinorColumnar : kLogVersionMinor))
+            throw std::runtime_error("BinaryFileSink: cannot resume " + path
+                                     + ": written by a different session or options");
+        if (reader.checkpoints().empty())
+            return false;
+
+        point.checkpoint = reader.checkpoints().back();
+        point.records = point.checkpoint.record_index;
+        uint64_t first = 0;
+        while (resume_chunk < reader.chunkCount()
+               && first + reader.index()[resume_chunk].record_count <= point.records)
+            first += reader.index()[resume_chunk++].record_count;
+        if (resume_chunk == 0)
+            return false;
+
+        std::vector<DiskEventRecord> scratch;
+        if (seek_stride_ > 0 || bars_) {
+            for (uint32_t i = 0; i < resume_chunk; ++i) {
+                const RecordSpan span = reader.chunkRecords(i, scratch);
+                if (seek_stride_ > 0)
+                    addSeekStats(span.data, span.size);
+                if (bars_)
+                    bars_->add(span.data, span.size);
+            }
+        }
+        // The checkpoint's chunk is cut off and its leading records go back in the buffer.
+        if (resume_chunk < reader.chunkCount()) {
+            truncate_at = reader.index()[resume_chunk].file_offset;
+            const RecordSpan span = reader.chunkRecords(resume_chunk, scratch);
+            buffer_.assign(span.begin(), span.begin() + (point.records - first));
+        } else {
+            truncate_at = reader.chunkEndOffset(resume_chunk - 1);
+        }
+        index_.assign(reader.index().begin(), reader.index().begin() + resume_chunk);
+        // A scanned index has no checksums; the kept chunks are on disk, so recompute them.
+        for (uint32_t i = 0; i < resume_chunk; ++i)
+            index_[i].checksum = reader.chunkChecksum(i);
+        checkpoints_ = reader.checkpoints();
+        total_records_ = indexed_records_ = first;
+        header_flags_ = hdr.header_flags;
+        dictionary = reader.dictionary();
+    }  // unmapped before the truncation
+
+    std::filesystem::resize_file(path, truncate_at, ec);
+    if (ec)
+        throw std::runtime_error("BinaryFileSink: cannot truncate " + path + ": " + ec.message());
+    openFile(path, false);
+
+    // Chunks are on disk, so dictionary training (if any) finished in the first run.
+    training_ = false;
+    stats_ = false;  // the first run's shift and reinit flags are not on disk
+    if (!dictionary.empty())
+        compressor_.useDictionary(dictionary.data(), dictionary.size());
+    chunks_written_ = resume_chunk;
+    next_checkpoint_chunk_ = resume_chunk + checkpoint_interval_;
+    resume_point_ = std::move(point);
+    resumed_ = true;
+    if (sync_interval_ > 0)
+        syncSidecar();
+    else
+        removeSidecar(path);
+    return true;
 }
 
 void BinaryFileSink::flushChunk() {
     if (buffer_.empty())
         return;
 
-    const uint32_t record_count = static_cast<uint32_t>(buffer_.size());
-    const auto raw_bytes = static_cast<int>(record_count * sizeof(DiskEventRecord));
+    total_records_ += buffer_.size();
+    ++chunks_written_;
+    if (stats_) {
+        chunk_flags_.push_back(buffer_flags_);
+        buffer_flags_ = FlagCounts{};
+    }
+    if (async_) {
+        async_->submit(buffer_);  // hands back an empty recycled buffer
+    } else {
+        writeChunk(buffer_);
+        buffer_.clear();
+    }
+}
 
-    const int compressed_bytes = LZ4_compress_default(
-        reinterpret_cast<const char*>(buffer_.data()),
-        compress_buf_.data(),
-        raw_bytes,
-        static_cast<int>(compress_buf_.size()));
+void BinaryFileSink::writeChunk(const std::vector<DiskEventRecord>& rows) {
+    if (training_) {
+        held_.push_back(rows);
+        if (held_.size() >= kDictionaryTrainingChunks)
+            writeHeldChunks();
+        return;
+    }
 
-    if (compressed_bytes <= 0)
-        throw std::runtime_error("BinaryFileSink: LZ4 compression failed");
+    const auto t0 = std::chrono::steady_clock::now();
+    const char* payload = nullptr;
+    size_t payload_bytes = 0;
+    const uint32_t chunk_flags = encodeChunk(rows, payload, payload_bytes);
+    const auto encode_time = std::chrono::steady_clock::now() - t0;
+    compress_seconds_ += std::chrono::duration<double>(encode_time).count();
+    if (compress_ns_)
+        compress_ns_->record(static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(encode_time).count()));
+
+    const uint32_t record_count = static_cast<uint32_t>(rows.size());
+
+    ChunkHeader chdr{};
+    chdr.uncompressed_size = static_cast<uint32_t>(record_count * sizeof(DiskEventRecord));
+    chdr.compressed_size   = static_cast<uint32_t>(payload_bytes);
+    chdr.record_count      = record_count;
+    chdr.chunk_flags       = chunk_flags;
+    chdr.first_ts_ns       = rows.front().ts_ns;
+    chdr.last_ts_ns        = rows.back().ts_ns;
 
     // Track chunk offset before writing
     IndexEntry entry{};
-    entry.file_offset  = static_cast<uint64_t>(std::ftell(file_));
-    entry.first_ts_ns  = buffer_.front().ts_ns;
-    entry.last_ts_ns   = buffer_.back().ts_ns;
+    entry.file_offset  = writeOffset();
+    entry.first_ts_ns  = rows.front().ts_ns;
+    entry.last_ts_ns   = rows.back().ts_ns;
     entry.record_count = record_count;
-    entry.reserved     = 0;
+    entry.checksum     = crc32c(payload, payload_bytes, crc32c(&chdr, sizeof(chdr)));
     index_.push_back(entry);
 
+    if (seek_stride_ > 0)
+        addSeekStats(rows.data(), rows.size());
+    if (bars_)
+        bars_->add(rows.data(), rows.size());
+    if (stats_) {
+        ChunkStats stats{};
+        stats.min_price_ticks = rows.front().price_ticks;
+        stats.max_price_ticks = rows.front().price_ticks;
+        for (const DiskEventRecord& rec : rows) {
+            if (rec.type < 6) ++stats.type_counts[rec.type];
+            const int32_t price = rec.price_ticks;
+            if (price < stats.min_price_ticks) stats.min_price_ticks = price;
+            if (price > stats.max_price_ticks) stats.max_price_ticks = price;
+            if (rec.type == static_cast<uint8_t>(EventType::EXECUTE_BUY)
+                || rec.type == static_cast<uint8_t>(EventType::EXECUTE_SELL))
+                stats.executed_qty += rec.qty;
+        }
+        chunk_stats_.push_back(stats);
+    }
+
+    writeBlock(chdr, payload, payload_bytes);
+
+    indexed_records_ += record_count;
+    if (sync_interval_ > 0 && index_.size() % sync_interval_ == 0)
+        syncSidecar();
+}
+
+void BinaryFileSink::addSeekStats(const DiskEventRecord* rows, size_t n) {
+    ChunkSeekStats stats{};
+    stats.min_price_ticks = rows[0].price_ticks;
+    stats.max_price_ticks = rows[0].price_ticks;
+    stats.first_sample = seek_samples_.size();
+    for (size_t i = 0; i < n; ++i) {
+        const int32_t price = rows[i].price_ticks;
+        if (price < stats.min_price_ticks) stats.min_price_ticks = price;
+        if (price > stats.max_price_ticks) stats.max_price_ticks = price;
+    }
+    for (size_t i = 0; i < n; i += seek_stride_) {
+        const uint64_t ts = rows[i].ts_ns;  // packed field: copy, never bind
+        seek_samples_.push_back(ts);
+    }
+    seek_stats_.push_back(stats);
+}
+
+void BinaryFileSink::syncSidecar() {
+    syncFile();
+
+    SidecarHeader sh{};
+    std::memcpy(sh.magic, kSidecarMagic, 4);
+    sh.chunk_count = static_cast<uint32_t>(index_.size());
+    sh.data_end = writeOffset();
+    std::vector<char> out(sizeof(sh) + index_.size() * sizeof(IndexEntry));
+    std::memcpy(out.data() + sizeof(sh), index_.data(), index_.size() * sizeof(IndexEntry));
+    // Only checkpoints whose records are all on disk can be resumed from.
+    std::vector<BookCheckpoint> durable;
+    {
+        std::lock_guard<std::mutex> lock(checkpoints_mutex_);
+        for (const BookCheckpoint& cp : checkpoints_)
+            if (cp.record_index <= indexed_records_) durable.push_back(cp);
+    }
+    if (!durable.empty())
+        encodeCheckpoints(durable, levels_per_side_, out);
+    sh.checkpoint_bytes = static_cast<uint32_t>(out.size() - sizeof(sh) - index_.size() * sizeof(IndexEntry));
+    std::memcpy(out.data(), &sh, sizeof(sh));
+
+    const std::string sidecar = sidecarIndexPath(path_);
+    const std::string tmp = sidecar + ".tmp";
+    std::FILE* f = std::fopen(tmp.c_str(), "wb");
+    bool ok = f != nullptr;
+    if (f) {
+        ok = std::fwrite(out.data(), 1, out.size(), f) == out.size() && std::fflush(f) == 0
+          && syncToDisk(f);
+        ok = std::fclose(f) == 0 && ok;
+    }
+    std::error_code ec;
+    if (ok)
+        std::filesystem::rename(tmp, sidecar, ec);
+    if (!ok || ec)
+        throw std::runtime_error("BinaryFileSink: cannot write " + sidecar);
+}
+
+uint32_t BinaryFileSink::encodeChunk(const std::vector<DiskEventRecord>& rows, const char*& payload,
+                                     size_t& payload_bytes) {
+    const size_t raw_bytes = rows.size() * sizeof(DiskEventRecord);
+    const uint32_t codec_bits =
+        (static_cast<uint32_t>(compressor_.codec()) << kChunkCodecShift) & kChunkCodecMask;
+
+    // Columnar chunks that would not beat the raw rows fall through to the row path.
+    if (columnar_ && columnar_encoder_.encode(rows.data(), rows.size(), compressor_, columnar_buf_)
+        && columnar_buf_.size() < raw_bytes) {
+        payload = columnar_buf_.data();
+        payload_bytes = columnar_buf_.size();
+        return kChunkFlagColumnar | codec_bits;
+    }
+
+    const size_t compressed_bytes = compressor_.compress(
+        reinterpret_cast<const char*>(rows.data()), raw_bytes,
+        compress_buf_.data(), compress_buf_.size());
+
+    // Incompressible chunk: store the rows as-is so readers can view them in place.
+    if (compressed_bytes >= raw_bytes) {
+        payload = reinterpret_cast<const char*>(rows.data());
+        payload_bytes = raw_bytes;
+        return kChunkFlagRaw;
+    }
+    payload = compress_buf_.data();
+    payload_bytes = compressed_bytes;
+    return codec_bits;
+}
+
+void BinaryFileSink::writeBlock(const ChunkHeader& chdr, const char* payload, size_t bytes) {
+    writeBytes(&chdr, sizeof(chdr));
+    writeBytes(payload, bytes);
+}
+
+void BinaryFileSink::writeHeldChunks() {
+    training_ = false;
+    const auto t0 = std::chrono::steady_clock::now();
+    // Dry-run the encoder so the samples are exactly the buffers later compressed
+    // (whole chunks for rows, single columns for the columnar layout).
+    compressor_.startCollecting();
+    for (const auto& rows : held_) {
+        const char* payload = nullptr;
+        size_t payload_bytes = 0;
+        encodeChunk(rows, payload, payload_bytes);
+    }
+    const std::vector<char> dictionary = compressor_.trainDictionary(kDictionaryMaxBytes);
+    compress_seconds_ += std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+    if (!dictionary.empty()) {
+        ChunkHeader chdr{};
+        chdr.compressed_size = static_cast<uint32_t>(dictionary.size());
+        chdr.chunk_flags = kChunkFlagDictionary
+                         | ((static_cast<uint32_t>(compressor_.codec()) << kChunkCodecShift) & kChunkCodecMask);
+        writeBlock(chdr, dictionary.data(), dictionary.size());
+    }
+    for (const auto& rows : held_)
+        writeChunk(rows);
+    held_.clear();
+    held_.shrink_to_fit();
+}
+
+void BinaryFileSink::takeCheckpoint(uint64_t last_ts_ns) {
+    BookCheckpoint cp;
+    checkpoint_source_(cp);
+    cp.record_index = total_records_ + buffer_.size();
+    cp.ts_ns = last_ts_ns;
+    std::lock_guard<std::mutex> lock(checkpoints_mutex_);
+    checkpoints_.push_back(std::move(cp));
+    next_checkpoint_chunk_ = chunks_written_ + checkpoint_interval_;
+}
+
+void BinaryFileSink::writeCheckpoints() {
+    std::vector<char> payload;
+    encodeCheckpoints(checkpoints_, levels_per_side_, payload);
     ChunkHeader chdr{};
-    chdr.uncompressed_size = static_cast<uint32_t>(raw_bytes);
-    chdr.compressed_size   = static_cast<uint32_t>(compressed_bytes);
-    chdr.record_count      = record_count;
-    chdr.chunk_flags       = 0;
-    chdr.first_ts_ns       = buffer_.front().ts_ns;
-    chdr.last_ts_ns        = buffer_.back().ts_ns;
+    chdr.compressed_size = static_cast<uint32_t>(payload.size());
+    chdr.chunk_flags = kChunkFlagCheckpoints;
+    chdr.first_ts_ns = checkpoints_.front().ts_ns;
+    chdr.last_ts_ns = checkpoints_.back().ts_ns;
+    writeBlock(chdr, payload.data(), payload.size());
+}
+
+void BinaryFileSink::writeSeekIndex() {
+    SeekIndexHeader sih{};
+    sih.ts_stride = seek_stride_;
+    sih.chunk_count = static_cast<uint32_t>(seek_stats_.size());
+    sih.sample_count = seek_samples_.size();
+    const size_t stats_bytes = seek_stats_.size() * sizeof(ChunkSeekStats);
+    const size_t sample_bytes = seek_samples_.size() * sizeof(uint64_t);
+
+    ChunkHeader chdr{};
+    chdr.compressed_size = static_cast<uint32_t>(sizeof(sih) + stats_bytes + sample_bytes);
+    chdr.chunk_flags = kChunkFlagSeekIndex;
+    chdr.first_ts_ns = index_.front().first_ts_ns;
+    chdr.last_ts_ns = index_.back().last_ts_ns;
+    writeBytes(&chdr, sizeof(chdr));
+    writeBytes(&sih, sizeof(sih));
+    writeBytes(seek_stats_.data(), stats_bytes);
+    writeBytes(seek_samples_.data(), sample_bytes);
+}
+
+void BinaryFileSink::writeBars() {
+    std::vector<char> payload;
+    encodeBars(bars_->series(), payload);
+    ChunkHeader chdr{};
+    chdr.compressed_size = static_cast<uint32_t>(payload.size());
+    chdr.chunk_flags = kChunkFlagBars;
+    chdr.first_ts_ns = index_.front().first_ts_ns;
+    chdr.last_ts_ns = index_.back().last_ts_ns;
+    writeBlock(chdr, payload.data(), payload.size());
+}
 
-    std::fwrite(&chdr, sizeof(chdr), 1, file_);
-    std::fwrite(compress_buf_.data(), 1, static_cast<size_t>(compressed_bytes), file_);
+void BinaryFileSink::writeStats() {
+    // The writer filled chunk_stats_ and the appending thread chunk_flags_; both
+    // threads are done, and both hold one entry per chunk in file order.
+    for (size_t i = 0; i < chunk_stats_.size() && i < chunk_flags_.size(); ++i) {
+        chunk_stats_[i].shifts_up = chunk_flags_[i].shifts_up;
+        chunk_stats_[i].shifts_down = chunk_flags_[i].shifts_down;
+        chunk_stats_[i].reinits = chunk_flags_[i].reinits;
+    }
+    StatsBlockHeader sbh{};
+    sbh.chunk_count = static_cast<uint32_t>(chunk_stats_.size());
+    const size_t stats_bytes = chunk_stats_.size() * sizeof(ChunkStats);
 
-    total_records_ += record_count;
-    buffer_.clear();
+    ChunkHeader chdr{};
+    chdr.compressed_size = static_cast<uint32_t>(sizeof(sbh) + stats_bytes);
+    chdr.chunk_flags = kChunkFlagStats;
+    chdr.first_ts_ns = index_.front().first_ts_ns;
+    chdr.last_ts_ns = index_.back().last_ts_ns;
+    writeBytes(&chdr, sizeof(chdr));
+    writeBytes(&sbh, sizeof(sbh));
+    writeBytes(chunk_stats_.data(), stats_bytes);
 }
 
 void BinaryFileSink::writeIndex() {
     if (index_.empty())
         return;
 
-    const uint64_t index_start = static_cast<uint64_t>(std::ftell(file_));
+    if (!checkpoints_.empty())
+        writeCheckpoints();
+    if (seek_stride_ > 0)
+        writeSeekIndex();
+    if (bars_)
+        writeBars();
+    if (stats_ && chunk_stats_.size() == index_.size())
+        writeStats();
+
+    const uint64_t index_start = writeOffset();
 
-    std::fwrite(index_.data(), sizeof(IndexEntry), index_.size(), file_);
+    writeBytes(index_.data(), index_.size() * sizeof(IndexEntry));
 
     IndexTail tail{};
     tail.chunk_count        = static_cast<uint32_t>(index_.size());
     std::memcpy(tail.index_magic, kIndexMagic, 4);
     tail.index_start_offset = index_start;
 
-    std::fwrite(&tail, sizeof(tail), 1, file_);
+    writeBytes(&tail, sizeof(tail));
 
-    // Seek back and set HAS_INDEX flag in file header
-    std::fseek(file_, static_cast<long>(offsetof(FileHeader, header_flags)), SEEK_SET);
-    uint32_t flags = kHeaderFlagHasIndex;
-    std::fwrite(&flags, sizeof(flags), 1, file_);
-
-    // Seek back to end
-    std::fseek(file_, 0, SEEK_END);
+    // Set HAS_INDEX flag in file header
+    patchHeaderFlags(header_flags_ | kHeaderFlagHasIndex);
 }
 
 }  // namespace qrsdp
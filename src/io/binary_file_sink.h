@@ -1,24 +1,118 @@
 #pragma once
 
 #include "io/i_event_sink.h"
+#include "io/bar_rollup.h"
+#include "io/book_checkpoint.h"
+#include "io/chunk_codec.h"
+#include "io/columnar_chunk.h"
 #include "io/event_log_format.h"
+#include "io/io_uring_writer.h"
 #include "core/records.h"
 
 #include <cstdio>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <utility>
 #include <vector>
 
 namespace qrsdp {
 
+class Histogram;
+
+/// Construction options for BinaryFileSink. The defaults write the v1.0 format.
+struct BinaryFileSinkOptions {
+    uint32_t chunk_capacity = kDefaultChunkCapacity;  // records per chunk
+    uint32_t write_buffers = 0;   // 0 or 1 = compress and write on the caller's thread
+    bool columnar = false;        // v1.1 columnar chunks (kChunkFlagColumnar)
+    CodecConfig codec;            // chunk/column compression (default LZ4, acceleration 1)
+    uint32_t seek_stride = 0;     // > 0: write a seek index sampling ts every seek_stride records
+    uint32_t checkpoint_interval = 0;  // > 0: book checkpoint every this many chunks (needs a source)
+    uint32_t sync_interval = 0;   // > 0: fsync and rewrite the sidecar index every this many chunks
+    bool resume = false;          // append to an unfinished file at path instead of truncating it
+    std::vector<uint32_t> bar_seconds;  // non-empty: write OHLC bars at these resolutions before the footer
+    bool stats = true;            // write per-chunk statistics before the footer
+    Histogram* compress_ns = nullptr;  // non-null: record each chunk's encode + compress time
+    IoUringWriter* io_uring = nullptr;  // non-null: write through this shared ring instead of stdio
+};
+
+/// Where a resumed BinaryFileSink picked up: the file holds the first records
+/// records, and the caller must continue the session from checkpoint.
+struct SinkResumePoint {
+    uint64_t records = 0;
+    BookCheckpoint checkpoint;
+};
+
 /// Disk-backed event sink: writes EventRecords to a .qrsdp binary file
-/// with chunked LZ4 compression per the event-log-format spec.
-class BinaryFileSink : public IEventSink {
+/// with chunked compression (LZ4 by default) per the event-log-format spec.
+///
+/// With write_buffers >= 2, full chunks are handed to a background thread that
+/// compresses and writes them (and builds the index), so append() only converts
+/// records. write_buffers chunk buffers rotate between the two threads through
+/// lock-free SPSC rings: 2 = double buffering, 3 = triple, and so on. When every
+/// buffer is in flight append() blocks until the writer frees one. Files are
+/// byte-identical to synchronous mode.
+///
+/// With options.columnar, chunks are stored column by column (delta/varint
+/// timestamps and order ids, zigzag-delta prices, packed type/side), each column
+/// compressed separately, and the header records version 1.1. EventLogReader
+/// decodes both layouts transparently.
+///
+/// options.codec selects the compressor: LZ4 at an acceleration level, zstd at a
+/// level, or none (every chunk RAW). With a zstd dictionary the first
+/// kDictionaryTrainingChunks chunks are held back, a dictionary is trained on
+/// them and written straight after the file header, and then they and every later
+/// chunk are compressed with it.
+///
+/// With options.seek_stride, close() also writes a seek index block before the
+/// footer: per-chunk min/max price and the timestamp of every seek_stride-th record,
+/// which EventLogReader::select() uses for exact ts/price queries.
+///
+/// With options.checkpoint_interval and a setCheckpointSource(), the sink asks the
+/// source for the book state at the end of the first append()/appendBatch() call
+/// after every checkpoint_interval chunks, and close() writes the checkpoints in one
+/// block before the footer. EventLogReader::checkpointAtOrBefore() then lets a replay
+/// start mid-session instead of from the opening book.
+///
+/// With options.bar_seconds, every chunk written is also folded into a BarRollup
+/// (on the writer thread in async mode), and close() writes its bars in one block
+/// before the footer, so EventLogReader::bars() serves a chart of the day without
+/// decoding any chunk.
+///
+/// With options.stats (the default), close() also writes a stats block before the
+/// footer: per chunk, the records of each type, the price range, the executed qty
+/// and the shifts and reinits flagged on the EventRecords, which the chunks
+/// themselves drop. EventLogReader::stats() then summarises a day from the footer.
+/// A resumed file has no stats block, since the flags of its first part are gone.
+///
+/// With options.sync_interval, every sync_interval chunks the writer fflush()es and
+/// fsync()s the file and then atomically replaces <path>.idx (sidecarIndexPath) with
+/// the chunk index and checkpoints of the data synced so far; close() removes it
+/// once the footer is written. After a crash, EventLogReader uses the sidecar instead
+/// of scanning and stops at a torn final chunk, and a sink opened on the same path
+/// with options.resume truncates the file back to its last checkpoint and appends
+/// from there (see resumePoint()).
+///
+/// With options.io_uring, the file is written through that IoUringWriter, which
+/// may be shared by every sink in the process: chunks are staged and submitted
+/// as large asynchronous writes, and close() waits for them before writing the
+/// footer. Files are byte-identical to stdio mode.
+class BinaryFileSink final : public IEventSink {
 public:
-    /// Opens the file and writes the file header.
-    /// chunk_capacity controls records per LZ4 chunk (default 4096).
+    /// Opens the file and writes the file header. With options.resume and an unfinished
+    /// file with a checkpoint at path, reopens it at that checkpoint instead; throws
+    /// std::runtime_error if that file is already complete or was written with
+    /// different options or session parameters.
+    /// chunk_capacity controls records per chunk (default 4096).
+    /// write_buffers: 0 or 1 = compress and write on the caller's thread.
+    BinaryFileSink(const std::string& path,
+                   const TradingSession& session,
+                   uint32_t chunk_capacity = kDefaultChunkCapacity,
+                   uint32_t write_buffers = 0);
+
     BinaryFileSink(const std::string& path,
                    const TradingSession& session,
-                   uint32_t chunk_capacity = kDefaultChunkCapacity);
+                   const BinaryFileSinkOptions& options);
 
     ~BinaryFileSink() override;
 
@@ -26,30 +120,145 @@ public:
     BinaryFileSink& operator=(const BinaryFileSink&) = delete;
 
     void append(const EventRecord& rec) override;
+    void appendBatch(const EventRecord* recs, size_t n) override;
 
-    /// Flush any buffered records as a partial chunk.
+    /// Book state provider for checkpoints (nullptr = none). Its state must be the
+    /// state after the last record appended when each append call returns, as it is
+    /// for a producer that appends what it has just generated. The source is called
+    /// on the appending thread and must outlive the appends.
+    void setCheckpointSource(CheckpointSource source) { checkpoint_source_ = std::move(source); }
+    size_t checkpointsTaken() const { return checkpoints_.size(); }
+    /// Bars of the chunks written so far (nullptr without options.bar_seconds). In
+    /// async mode, read only after close().
+    const BarRollup* bars() const { return bars_.get(); }
+
+    /// Set if the constructor resumed an unfinished file (options.resume): the records
+    /// already in it and the checkpoint to continue the session from. The first
+    /// record appended must be record number resumePoint()->records.
+    const SinkResumePoint* resumePoint() const { return resumed_ ? &resume_point_ : nullptr; }
+
+    /// Flush any buffered records as a partial chunk. In async mode, also waits
+    /// until the writer thread has written every queued chunk. Chunks held for
+    /// dictionary training are only written once the dictionary is (or at close()).
     void flush() override;
 
     /// Flush, write chunk index, finalise header flags, close file.
     /// Safe to call multiple times; subsequent calls are no-ops.
+    /// In async mode, rethrows the first error the writer thread hit.
     void close() override;
 
-    bool isOpen() const { return file_ != nullptr; }
+    bool isOpen() const { return file_ != nullptr || uring_file_ != nullptr; }
+    /// Records and chunks handed off so far (queued chunks included in async mode).
     uint64_t recordsWritten() const { return total_records_; }
-    uint32_t chunksWritten() const { return static_cast<uint32_t>(index_.size()); }
+    uint32_t chunksWritten() const { return chunks_written_; }
+    bool isAsync() const { return async_ != nullptr; }
+    bool isColumnar() const { return columnar_; }
+    ChunkCodec codec() const { return compressor_.codec(); }
+    /// Time spent encoding and compressing chunks (read after close() in async mode).
+    double compressSeconds() const { return compress_seconds_; }
+
+    static constexpr size_t kDictionaryTrainingChunks = 8;
+    static constexpr size_t kDictionaryMaxBytes = 32 * 1024;
+
+    /// The header this sink writes for session.
+    FileHeader fileHeaderFor(const TradingSession& session) const;
 
 private:
+    class AsyncWriter;
+
+    /// The file output: stdio, or an IoUringFile with options.io_uring.
+    void openFile(const std::string& path, bool truncate);
+    void writeBytes(const void* data, size_t n);
+    uint64_t writeOffset() const;
+    void patchHeaderFlags(uint32_t flags);
+    /// fflush + fsync; throws on failure.
+    void syncFile();
+    /// Closes the output; throws on a write error it only now sees.
+    void closeFile();
+
     void writeFileHeader(const TradingSession& session);
+    /// Reopens an unfinished file truncated to its last checkpoint; false (nothing
+    /// touched) if there is no such file or it has no checkpoint to resume from.
+    bool resumeFile(const std::string& path, const TradingSession& session);
+    /// Folds rows[0, n) into the seek stats of a new chunk.
+    void addSeekStats(const DiskEventRecord* rows, size_t n);
+    /// Syncs the file to disk, then atomically rewrites the sidecar index.
+    void syncSidecar();
     void flushChunk();
+    /// Compresses rows and writes them as one chunk at the end of the file.
+    /// Runs on the writer thread in async mode (the only user of file_, index_,
+    /// compress_buf_, the columnar/codec state and held_ until it is joined).
+    void writeChunk(const std::vector<DiskEventRecord>& rows);
+    /// Encodes rows to the stored payload; returns its chunk_flags.
+    uint32_t encodeChunk(const std::vector<DiskEventRecord>& rows, const char*& payload,
+                         size_t& payload_bytes);
+    void writeBlock(const ChunkHeader& chdr, const char* payload, size_t bytes);
+    /// Trains the dictionary on the held-back chunks, writes it, then the chunks.
+    void writeHeldChunks();
+    /// Takes a checkpoint if one is due; last_ts_ns is the last appended record's ts.
+    void maybeCheckpoint(uint64_t last_ts_ns) {
+        if (checkpoint_interval_ > 0 && chunks_written_ >= next_checkpoint_chunk_ && checkpoint_source_)
+            takeCheckpoint(last_ts_ns);
+    }
+    void takeCheckpoint(uint64_t last_ts_ns);
+    void writeCheckpoints();
+    void writeSeekIndex();
+    void writeBars();
+    void writeStats();
     void writeIndex();
 
+    /// Flag counts of one chunk, gathered on the appending thread.
+    struct FlagCounts {
+        uint32_t shifts_up = 0;
+        uint32_t shifts_down = 0;
+        uint32_t reinits = 0;
+    };
+    void countFlags(uint32_t flags) {
+        if (flags == kFlagNone) return;
+        if (flags & kFlagShiftUp) ++buffer_flags_.shifts_up;
+        if (flags & kFlagShiftDown) ++buffer_flags_.shifts_down;
+        if (flags & kFlagReinit) ++buffer_flags_.reinits;
+    }
+
     std::FILE* file_ = nullptr;
+    IoUringWriter* io_uring_ = nullptr;
+    std::unique_ptr<IoUringFile> uring_file_;          // replaces file_ with options.io_uring
+    std::string path_;
     uint32_t chunk_capacity_;
     uint64_t total_records_ = 0;
+    uint32_t chunks_written_ = 0;
+    uint32_t header_flags_ = 0;
+    bool columnar_ = false;
 
     std::vector<DiskEventRecord> buffer_;
-    std::vector<IndexEntry> index_;
+    std::vector<IndexEntry> index_;    // owned by the writer thread while it runs
     std::vector<char> compress_buf_;
+    std::vector<char> columnar_buf_;
+    ColumnarChunkEncoder columnar_encoder_;
+    ChunkCompressor compressor_;
+    bool training_ = false;                             // holding chunks for the dictionary
+    std::vector<std::vector<DiskEventRecord>> held_;
+    double compress_seconds_ = 0.0;
+    uint32_t seek_stride_ = 0;
+    std::vector<ChunkSeekStats> seek_stats_;           // one per chunk, like index_
+    std::vector<uint64_t> seek_samples_;
+    std::unique_ptr<BarRollup> bars_;                  // fed by writeChunk(), like the seek stats
+    bool stats_ = false;
+    std::vector<ChunkStats> chunk_stats_;              // one per chunk, like index_ (flag counts 0)
+    FlagCounts buffer_flags_;                          // of the records in buffer_
+    std::vector<FlagCounts> chunk_flags_;              // one per chunk handed off (appending thread)
+    uint32_t levels_per_side_ = 0;
+    uint32_t checkpoint_interval_ = 0;
+    uint32_t next_checkpoint_chunk_ = 0;
+    CheckpointSource checkpoint_source_;
+    std::vector<BookCheckpoint> checkpoints_;          // appended on the appending thread
+    std::mutex checkpoints_mutex_;                     // guards checkpoints_ against syncSidecar()
+    uint32_t sync_interval_ = 0;
+    Histogram* compress_ns_ = nullptr;
+    uint64_t indexed_records_ = 0;                     // records in index_ (writer thread)
+    bool resumed_ = false;
+    SinkResumePoint resume_point_;
+    std::unique_ptr<AsyncWriter> async_;
 };
 
 }  // namespace qrsdp
@@ -0,0 +1,117 @@
+#include "io/book_checkpoint.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace qrsdp {
+
+void encodeCheckpoints(const std::vector<BookCheckpoint>& cps, uint32_t levels_per_side,
+                       std::vector<char>& out) {
+    CheckpointBlockHeader cbh{};
+    cbh.checkpoint_count = static_cast<uint32_t>(cps.size());
+    cbh.levels_per_side = levels_per_side;
+    const size_t entry_bytes = sizeof(CheckpointEntry) + 2 * levels_per_side * sizeof(CheckpointLevel);
+    const size_t history_size = cps.empty() ? 0 : cps.front().history.size();
+    const bool with_state = !cps.empty()
+        && std::all_of(cps.begin(), cps.end(), [history_size](const BookCheckpoint& cp) {
+               return cp.rng_position > 0 && cp.history.size() == history_size;
+           });
+    const size_t state_bytes = with_state ? sizeof(CheckpointStateHeader)
+            + cps.size() * (sizeof(CheckpointState) + history_size * sizeof(double)) : 0;
+    size_t pos = out.size();
+    out.resize(pos + sizeof(cbh) + cps.size() * entry_bytes + state_bytes);
+    std::memcpy(out.data() + pos, &cbh, sizeof(cbh));
+    pos += sizeof(cbh);
+
+    for (const BookCheckpoint& cp : cps) {
+        CheckpointEntry entry{};
+        entry.record_index = cp.record_index;
+        entry.ts_ns = cp.ts_ns;
+        entry.next_order_id = cp.next_order_id;
+        entry.rng_position = with_state ? cp.rng_position : 0;
+        std::memcpy(out.data() + pos, &entry, sizeof(entry));
+        pos += sizeof(entry);
+        for (const std::vector<Level>* side : {&cp.bids, &cp.asks}) {
+            for (uint32_t k = 0; k < levels_per_side; ++k) {
+                CheckpointLevel level{0, 0};
+                if (k < side->size()) level = CheckpointLevel{(*side)[k].price_ticks, (*side)[k].depth};
+                std::memcpy(out.data() + pos, &level, sizeof(level));
+                pos += sizeof(level);
+            }
+        }
+    }
+    if (!with_state) return;
+    CheckpointStateHeader csh{};
+    csh.state_count = cbh.checkpoint_count;
+    csh.history_size = static_cast<uint32_t>(history_size);
+    std::memcpy(out.data() + pos, &csh, sizeof(csh));
+    pos += sizeof(csh);
+    for (const BookCheckpoint& cp : cps) {
+        const CheckpointState state{cp.clock};
+        std::memcpy(out.data() + pos, &state, sizeof(state));
+        pos += sizeof(state);
+        if (history_size > 0)
+            std::memcpy(out.data() + pos, cp.history.data(), history_size * sizeof(double));
+        pos += history_size * sizeof(double);
+    }
+}
+
+std::vector<BookCheckpoint> decodeCheckpoints(const char* payload, size_t size,
+                                              uint32_t levels_per_side) {
+    CheckpointBlockHeader cbh{};
+    if (size < sizeof(cbh))
+        throw std::runtime_error("checkpoint block too short");
+    std::memcpy(&cbh, payload, sizeof(cbh));
+    const uint64_t entry_bytes = sizeof(CheckpointEntry)
+                               + 2 * static_cast<uint64_t>(cbh.levels_per_side) * sizeof(CheckpointLevel);
+    const uint64_t entries_end = sizeof(cbh) + cbh.checkpoint_count * entry_bytes;
+    const bool with_state = entries_end < size;
+    CheckpointStateHeader csh{};
+    if (with_state && size - entries_end >= sizeof(csh))
+        std::memcpy(&csh, payload + entries_end, sizeof(csh));
+    const uint64_t state_bytes = with_state ? sizeof(csh) + static_cast<uint64_t>(cbh.checkpoint_count)
+            * (sizeof(CheckpointState) + static_cast<uint64_t>(csh.history_size) * sizeof(double)) : 0;
+    if (cbh.levels_per_side != levels_per_side || entries_end + state_bytes != size
+        || (with_state && csh.state_count != cbh.checkpoint_count))
+        throw std::runtime_error("checkpoint block size mismatch");
+
+    std::vector<BookCheckpoint> cps(cbh.checkpoint_count);
+    const char* p = payload + sizeof(cbh);
+    for (size_t i = 0; i < cps.size(); ++i) {
+        CheckpointEntry entry{};
+        std::memcpy(&entry, p, sizeof(entry));
+        p += sizeof(entry);
+        if (i > 0 && entry.record_index < cps[i - 1].record_index)
+            throw std::runtime_error("checkpoint record_index decreases");
+        BookCheckpoint& cp = cps[i];
+        cp.record_index = entry.record_index;
+        cp.ts_ns = entry.ts_ns;
+        cp.next_order_id = entry.next_order_id;
+        cp.rng_position = with_state ? entry.rng_position : 0;
+        for (std::vector<Level>* side : {&cp.bids, &cp.asks}) {
+            side->resize(levels_per_side);
+            for (uint32_t k = 0; k < levels_per_side; ++k) {
+                CheckpointLevel level{};
+                std::memcpy(&level, p, sizeof(level));
+                p += sizeof(level);
+                (*side)[k] = Level{level.price_ticks, level.depth};
+            }
+        }
+    }
+    if (!with_state) return cps;
+    p += sizeof(csh);
+    for (BookCheckpoint& cp : cps) {
+        CheckpointState state{};
+        std::memcpy(&state, p, sizeof(state));
+        p += sizeof(state);
+        cp.clock = state.clock;
+        cp.history.resize(csh.history_size);
+        if (csh.history_size > 0)
+            std::memcpy(cp.history.data(), p, csh.history_size * sizeof(double));
+        p += csh.history_size * sizeof(double);
+    }
+    return cps;
+}
+
+}  // namespace qrsdp
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "book/i_order_book.h"
+#include "core/records.h"
+#include "io/event_log_format.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace qrsdp {
+
+/// Book state part-way through a session, as stored in a checkpoint block
+/// (kChunkFlagCheckpoints). Seeding a book from the file header, restoring these
+/// levels and replaying records from record_index on gives the same book as
+/// replaying the whole session.
+struct BookCheckpoint {
+    uint64_t record_index = 0;   // records before the checkpoint; the book is as after them
+    uint64_t ts_ns = 0;          // ts of the last of those records
+    uint64_t next_order_id = 0;  // producer's next order id
+    std::vector<Level> bids;     // levels_per_side levels, best first
+    std::vector<Level> asks;
+    // Producer state for an exact resume (BasicQrsdpProducer::captureCheckpoint);
+    // without it a resume reseeds the RNG and restarts at ts_ns.
+    uint64_t rng_position = 0;   // IRng::position() of the session's generator; 0 = not recorded
+    double clock = 0.0;          // exact producer clock in seconds (when rng_position > 0)
+    std::vector<double> history; // IIntensityModel::saveHistory() (when rng_position > 0)
+};
+
+/// Fills the producer-side fields of a checkpoint (levels, next_order_id, and the
+/// producer state if recorded) on the appending thread. The BinaryFileSink sets
+/// record_index and ts_ns.
+using CheckpointSource = std::function<void(BookCheckpoint&)>;
+
+/// Copies every level of book into cp.bids / cp.asks.
+inline void captureLevels(const IOrderBook& book, BookCheckpoint& cp) {
+    const size_t n = book.numLevels();
+    cp.bids.resize(n);
+    cp.asks.resize(n);
+    for (size_t k = 0; k < n; ++k) {
+        cp.bids[k] = Level{book.bidPriceAtLevel(k), book.bidDepthAtLevel(k)};
+        cp.asks[k] = Level{book.askPriceAtLevel(k), book.askDepthAtLevel(k)};
+    }
+}
+
+/// Appends the checkpoint-block payload for cps (CheckpointBlockHeader, then one
+/// CheckpointEntry and 2 * levels_per_side CheckpointLevels each, then the
+/// CheckpointState section if every checkpoint has producer state with histories
+/// of one size) to out. Shorter level vectors are padded with empty levels.
+void encodeCheckpoints(const std::vector<BookCheckpoint>& cps, uint32_t levels_per_side,
+                       std::vector<char>& out);
+
+/// Parses a checkpoint-block payload whose levels_per_side must equal the given one.
+/// Throws std::runtime_error if it is malformed or record_index decreases.
+std::vector<BookCheckpoint> decodeCheckpoints(const char* payload, size_t size,
+                                              uint32_t levels_per_side);
+
+}  // namespace qrsdp
@@ -0,0 +1,127 @@
+#include "io/book_frame.h"
+
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+namespace qrsdp {
+
+BookFrameBuilder::BookFrameBuilder(const FileHeader& header, const BookFrameOptions& options)
+    : replayer_(header), open_ns_(header.market_open_ns), options_(options), next_frame_ns_(0) {
+    if (options_.frame_interval_ns == 0)
+        throw std::invalid_argument("BookFrameBuilder: frame_interval_ns must be > 0");
+    if (options_.recent_events > UINT16_MAX)
+        throw std::invalid_argument("BookFrameBuilder: recent_events must fit in 16 bits");
+    recent_.reserve(options_.recent_events);
+}
+
+void BookFrameBuilder::setFrameInterval(uint64_t interval_ns) {
+    if (interval_ns == 0)
+        throw std::invalid_argument("BookFrameBuilder: frame_interval_ns must be > 0");
+    options_.frame_interval_ns = interval_ns;
+}
+
+bool BookFrameBuilder::add(const DiskEventRecord& rec, std::vector<char>& frame) {
+    replayer_.apply(rec);
+    last_ts_ns_ = rec.ts_ns;
+    ++pending_;
+    if (options_.recent_events > 0) {
+        const FrameEvent ev{rec.type, rec.side, rec.price_ticks, rec.qty};
+        if (recent_.size() < options_.recent_events) {
+            recent_.push_back(ev);
+        } else {
+            recent_[recent_head_] = ev;
+            recent_head_ = (recent_head_ + 1) % recent_.size();
+        }
+    }
+    if (rec.ts_ns < next_frame_ns_) return false;
+
+    const uint64_t offset = rec.ts_ns > open_ns_ ? rec.ts_ns - open_ns_ : 0;
+    next_frame_ns_ = open_ns_ + (offset / options_.frame_interval_ns + 1) * options_.frame_interval_ns;
+    encode(frame);
+    return true;
+}
+
+bool BookFrameBuilder::flush(std::vector<char>& frame) {
+    if (pending_ == 0) return false;
+    encode(frame);
+    return true;
+}
+
+void BookFrameBuilder::encode(std::vector<char>& frame) {
+    const MultiLevelBook& book = replayer_.book();
+    const size_t levels = book.numLevels();
+    const size_t events = recent_.size();
+    frame.resize(sizeof(BookFrameHeader) + 2 * levels * sizeof(FrameLevel) + events * sizeof(FrameEvent));
+    char* p = frame.data();
+
+    BookFrameHeader h{};
+    h.magic = kBookFrameMagic;
+    h.levels = static_cast<uint16_t>(levels);
+    h.event_count = static_cast<uint16_t>(events);
+    h.ts_ns = last_ts_ns_;
+    h.record_index = replayer_.recordsApplied();
+    h.best_bid_ticks = book.bestBid().price_ticks;
+    h.best_ask_ticks = book.bestAsk().price_ticks;
+    h.frame_records = pending_;
+    std::memcpy(p, &h, sizeof(h));
+    p += sizeof(h);
+
+    for (size_t k = 0; k < levels; ++k) {
+        const FrameLevel lv{book.bidPriceAtLevel(k), book.bidDepthAtLevel(k)};
+        std::memcpy(p, &lv, sizeof(lv));
+        p += sizeof(lv);
+    }
+    for (size_t k = 0; k < levels; ++k) {
+        const FrameLevel lv{book.askPriceAtLevel(k), book.askDepthAtLevel(k)};
+        std::memcpy(p, &lv, sizeof(lv));
+        p += sizeof(lv);
+    }
+    for (size_t i = 0; i < events; ++i) {
+        std::memcpy(p, &recent_[(recent_head_ + i) % events], sizeof(FrameEvent));
+        p += sizeof(FrameEvent);
+    }
+
+    pending_ = 0;
+    recent_.clear();
+    recent_head_ = 0;
+    ++frames_;
+}
+
+size_t decodeBookFrame(const char* data, size_t size, BookFrame& out) {
+    if (size < sizeof(BookFrameHeader))
+        throw std::runtime_error("decodeBookFrame: truncated header");
+    std::memcpy(&out.header, data, sizeof(BookFrameHeader));
+    if (out.header.magic != kBookFrameMagic)
+        throw std::runtime_error("decodeBookFrame: bad magic");
+    const size_t levels = out.header.levels;
+    const size_t events = out.header.event_count;
+    const size_t bytes = sizeof(BookFrameHeader) + 2 * levels * sizeof(FrameLevel) + events * sizeof(FrameEvent);
+    if (size < bytes)
+        throw std::runtime_error("decodeBookFrame: truncated frame");
+
+    const char* p = data + sizeof(BookFrameHeader);
+    out.bids.resize(levels);
+    out.asks.resize(levels);
+    out.events.resize(events);
+    std::memcpy(out.bids.data(), p, levels * sizeof(FrameLevel));
+    p += levels * sizeof(FrameLevel);
+    std::memcpy(out.asks.data(), p, levels * sizeof(FrameLevel));
+    p += levels * sizeof(FrameLevel);
+    std::memcpy(out.events.data(), p, events * sizeof(FrameEvent));
+    return bytes;
+}
+
+BookFrameSink::BookFrameSink(const FileHeader& header, const BookFrameOptions& options,
+                             FrameCallback on_frame)
+    : builder_(header, options), on_frame_(std::move(on_frame)) {}
+
+void BookFrameSink::append(const EventRecord& rec) {
+    if (builder_.add(toDisk(rec), frame_) && on_frame_) on_frame_(frame_.data(), frame_.size());
+}
+
+void BookFrameSink::close() {
+    if (builder_.flush(frame_) && on_frame_) on_frame_(frame_.data(), frame_.size());
+}
+
+}  // namespace qrsdp
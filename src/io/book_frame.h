@@ -0,0 +1,132 @@
+#pragma once
+
+#include "io/book_replayer.h"
+#include "io/event_log_format.h"
+#include "io/i_event_sink.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace qrsdp {
+
+// ---------------------------------------------------------------------------
+// Book frames: a downsampled view of a record stream for live displays.
+// One frame (little-endian, packed) is a BookFrameHeader, then `levels`
+// FrameLevels of bids and `levels` of asks (best first), then `event_count`
+// FrameEvents — the latest records since the previous frame, oldest first.
+// ---------------------------------------------------------------------------
+
+constexpr uint32_t kBookFrameMagic = 0x31464251;  // "QBF1"
+
+#pragma pack(push, 1)
+struct BookFrameHeader {
+    uint32_t magic;
+    uint16_t levels;          // per side
+    uint16_t event_count;
+    uint64_t ts_ns;           // timestamp of the last record applied
+    uint64_t record_index;    // records applied so far (its index + 1)
+    int32_t  best_bid_ticks;
+    int32_t  best_ask_ticks;
+    uint32_t frame_records;   // records since the previous frame
+    uint32_t reserved;
+};
+
+struct FrameLevel {
+    int32_t  price_ticks;
+    uint32_t depth;
+};
+
+struct FrameEvent {
+    uint8_t  type;
+    uint8_t  side;
+    int32_t  price_ticks;
+    uint32_t qty;
+};
+#pragma pack(pop)
+
+static_assert(sizeof(BookFrameHeader) == 40, "BookFrameHeader must be 40 bytes");
+static_assert(sizeof(FrameLevel) == 8, "FrameLevel must be 8 bytes");
+static_assert(sizeof(FrameEvent) == 10, "FrameEvent must be 10 bytes");
+
+struct BookFrameOptions {
+    /// Simulated time between frames; a display at f fps and playback speed s
+    /// wants s / f seconds.
+    uint64_t frame_interval_ns = 1'000'000'000ULL;
+    /// Most FrameEvents per frame.
+    uint32_t recent_events = 8;
+};
+
+/// Turns a record stream into book frames: every record goes through a
+/// BookReplayer, and the first record at or past each frame boundary (multiples
+/// of frame_interval_ns from the open) emits a frame of the book after it. The
+/// first record always emits one; stretches with no records emit none.
+class BookFrameBuilder {
+public:
+    explicit BookFrameBuilder(const FileHeader& header, const BookFrameOptions& options = {});
+
+    /// Applies rec; when a frame is due, replaces frame with it and returns true.
+    bool add(const DiskEventRecord& rec, std::vector<char>& frame);
+
+    /// Encodes the records since the last frame, if any, into frame (the end
+    /// of a stream). Returns false when there is nothing pending.
+    bool flush(std::vector<char>& frame);
+
+    /// Changes the interval from the next frame on (e.g. a playback speed change).
+    /// Throws std::invalid_argument for 0.
+    void setFrameInterval(uint64_t interval_ns);
+    uint64_t frameInterval() const { return options_.frame_interval_ns; }
+
+    const MultiLevelBook& book() const { return replayer_.book(); }
+    uint64_t records() const { return replayer_.recordsApplied(); }
+    uint64_t frames() const { return frames_; }
+
+private:
+    void encode(std::vector<char>& frame);
+
+    BookReplayer replayer_;
+    uint64_t open_ns_;
+    BookFrameOptions options_;
+    uint64_t next_frame_ns_;
+    uint64_t last_ts_ns_ = 0;
+    uint32_t pending_ = 0;            // records since the last frame
+    std::vector<FrameEvent> recent_;  // ring of the latest recent_events of them
+    size_t recent_head_ = 0;          // oldest entry once the ring is full
+    uint64_t frames_ = 0;
+};
+
+/// A decoded frame.
+struct BookFrame {
+    BookFrameHeader header{};
+    std::vector<FrameLevel> bids;
+    std::vector<FrameLevel> asks;
+    std::vector<FrameEvent> events;
+};
+
+/// Parses the frame at data; returns the bytes it spans. Throws
+/// std::runtime_error if it is truncated or the magic does not match.
+size_t decodeBookFrame(const char* data, size_t size, BookFrame& out);
+
+/// IEventSink over a BookFrameBuilder, for frames straight from a live producer:
+/// each frame is handed to on_frame (valid for the duration of the call).
+/// close() emits the final partial frame.
+class BookFrameSink : public IEventSink {
+public:
+    using FrameCallback = std::function<void(const char* frame, size_t size)>;
+
+    /// header as BinaryFileSink::fileHeaderFor() would write for the session.
+    BookFrameSink(const FileHeader& header, const BookFrameOptions& options, FrameCallback on_frame);
+
+    void append(const EventRecord& rec) override;
+    void close() override;
+
+    BookFrameBuilder& builder() { return builder_; }
+
+private:
+    BookFrameBuilder builder_;
+    FrameCallback on_frame_;
+    std::vector<char> frame_;
+};
+
+}  // namespace qrsdp
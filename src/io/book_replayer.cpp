@@ -0,0 +1,101 @@
+#include "io/book_replayer.h"
+
+#include "core/event_types.h"
+#include "core/records.h"
+
+#include <stdexcept>
+
+namespace qrsdp {
+
+BookReplayer::BookReplayer(const FileHeader& header, const BookCheckpoint* start) {
+    // Zero depth/spread fall back to the book's defaults, as they did for the producer.
+    book_.seed(BookSeed{header.p0_ticks, header.levels_per_side, header.initial_depth,
+                        header.initial_spread_ticks});
+    if (start && (start->bids.size() < book_.numLevels() || start->asks.size() < book_.numLevels()
+                  || !book_.restore(start->bids.data(), start->asks.data())))
+        throw std::runtime_error("BookReplayer: book cannot be restored from checkpoint");
+}
+
+// Bid prices fall strictly with the level and gaps only widen the steps, so a
+// price's level is at most its offset from the best: when the offset guess misses,
+// binary search the levels below it.
+int BookReplayer::bidLevelOf(int32_t price_ticks) const {
+    const int guess = book_.bidIndexForPrice(price_ticks);
+    if (guess >= 0 && book_.bidPriceAtLevel(static_cast<size_t>(guess)) == price_ticks) return guess;
+    const int n = static_cast<int>(book_.numLevels());
+    if (n == 0 || price_ticks > book_.bidPriceAtLevel(0)) return -1;
+    int lo = 0;
+    int hi = guess >= 0 ? guess - 1 : n - 1;
+    while (lo <= hi) {
+        const int mid = (lo + hi) / 2;
+        const int32_t p = book_.bidPriceAtLevel(static_cast<size_t>(mid));
+        if (p == price_ticks) return mid;
+        if (p > price_ticks) lo = mid + 1;
+        else hi = mid - 1;
+    }
+    return -1;
+}
+
+int BookReplayer::askLevelOf(int32_t price_ticks) const {
+    const int guess = book_.askIndexForPrice(price_ticks);
+    if (guess >= 0 && book_.askPriceAtLevel(static_cast<size_t>(guess)) == price_ticks) return guess;
+    const int n = static_cast<int>(book_.numLevels());
+    if (n == 0 || price_ticks < book_.askPriceAtLevel(0)) return -1;
+    int lo = 0;
+    int hi = guess >= 0 ? guess - 1 : n - 1;
+    while (lo <= hi) {
+        const int mid = (lo + hi) / 2;
+        const int32_t p = book_.askPriceAtLevel(static_cast<size_t>(mid));
+        if (p == price_ticks) return mid;
+        if (p < price_ticks) lo = mid + 1;
+        else hi = mid - 1;
+    }
+    return -1;
+}
+
+BookReplayer::Step BookReplayer::apply(const DiskEventRecord& rec) {
+    const auto type = static_cast<EventType>(rec.type);
+    Step step;
+    switch (type) {
+        case EventType::ADD_BID:
+        case EventType::CANCEL_BID:
+            step.bid = true;
+            step.level = bidLevelOf(rec.price_ticks);
+            if (step.level < 0 && type == EventType::ADD_BID) step.level = 0;  // spread-improving add
+            break;
+        case EventType::ADD_ASK:
+        case EventType::CANCEL_ASK:
+            step.level = askLevelOf(rec.price_ticks);
+            if (step.level < 0 && type == EventType::ADD_ASK) step.level = 0;
+            break;
+        case EventType::EXECUTE_SELL:
+            step.bid = true;
+            step.level = 0;
+            break;
+        case EventType::EXECUTE_BUY:
+            step.level = 0;
+            break;
+        default:
+            break;
+    }
+    if (step.level >= 0) {
+        const size_t k = static_cast<size_t>(step.level);
+        step.depth_before = step.bid ? book_.bidDepthAtLevel(k) : book_.askDepthAtLevel(k);
+    }
+
+    const int32_t prev_bid = book_.bestBid().price_ticks;
+    const int32_t prev_ask = book_.bestAsk().price_ticks;
+    SimEvent ev{};
+    ev.type = type;
+    ev.side = static_cast<Side>(rec.side);
+    ev.price_ticks = rec.price_ticks;
+    ev.qty = rec.qty;
+    ev.order_id = rec.order_id;
+    book_.apply(ev);
+    step.shifted = book_.bestBid().price_ticks != prev_bid || book_.bestAsk().price_ticks != prev_ask;
+    shifts_ += step.shifted ? 1 : 0;
+    ++records_;
+    return step;
+}
+
+}  // namespace qrsdp
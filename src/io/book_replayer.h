@@ -0,0 +1,50 @@
+#pragma once
+
+#include "book/multi_level_book.h"
+#include "io/book_checkpoint.h"
+#include "io/event_log_format.h"
+
+#include <cstdint>
+
+namespace qrsdp {
+
+/// Rebuilds a log's book: replays its DiskEventRecords through a MultiLevelBook
+/// seeded from the file header (or restored from one of its checkpoints), and
+/// reports per record which level it addressed. Price lookups go by tick offset
+/// from the best (MultiLevelBook::bidIndexForPrice), falling back to a binary
+/// search only when the side has gaps, so a replay costs O(1) per record.
+class BookReplayer {
+public:
+    /// What one apply() did.
+    struct Step {
+        int level = -1;             // level addressed before applying; -1 if the price is not in the book
+        bool bid = false;           // side of that level
+        uint32_t depth_before = 0;  // its depth before the record (0 if level < 0)
+        bool shifted = false;       // best bid or best ask moved
+    };
+
+    /// With start, the book is restored from that checkpoint: apply() then takes
+    /// the records from start->record_index on.
+    /// Throws std::runtime_error if the book cannot restore start's levels.
+    explicit BookReplayer(const FileHeader& header, const BookCheckpoint* start = nullptr);
+
+    /// Applies rec. Adds and cancels address the level holding their price, a
+    /// spread-improving add (price not in the book) level 0; executions address
+    /// level 0 of the side they hit (bid for EXECUTE_SELL, ask for EXECUTE_BUY).
+    Step apply(const DiskEventRecord& rec);
+
+    /// Exact level holding price on each side, or -1.
+    int bidLevelOf(int32_t price_ticks) const;
+    int askLevelOf(int32_t price_ticks) const;
+
+    const MultiLevelBook& book() const { return book_; }
+    uint64_t recordsApplied() const { return records_; }
+    uint64_t shifts() const { return shifts_; }
+
+private:
+    MultiLevelBook book_;
+    uint64_t records_ = 0;
+    uint64_t shifts_ = 0;
+};
+
+}  // namespace qrsdp
@@ -0,0 +1,284 @@
+#include "io/chunk_codec.h"
+#include "io/lz4_hc.h"
+
+#include <lz4.h>
+#ifdef QRSDP_ZSTD_ENABLED
+#include <zdict.h>
+#include <zstd.h>
+#endif
+
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+
+namespace qrsdp {
+
+namespace {
+
+constexpr int kDefaultZstdLevel = 3;
+/// Training inputs are cut into samples of at most this size; zdict wants many
+/// small samples rather than a few whole chunks.
+constexpr size_t kMaxSampleBytes = 4096;
+
+#ifdef QRSDP_ZSTD_ENABLED
+/// One decompression context per thread, reused across chunks and readers.
+/// A DCtx holds no per-frame state between calls, so sharing it between
+/// ChunkDecompressor instances on the same thread is safe and keeps
+/// decompress() const without a per-chunk allocation.
+ZSTD_DCtx* threadDCtx() {
+    struct Holder {
+        ZSTD_DCtx* dctx = ZSTD_createDCtx();
+        ~Holder() { ZSTD_freeDCtx(dctx); }
+    };
+    thread_local Holder holder;
+    if (!holder.dctx)
+        throw std::runtime_error("ZSTD_createDCtx failed");
+    return holder.dctx;
+}
+#endif
+
+}  // namespace
+
+const char* chunkCodecName(ChunkCodec codec) {
+    switch (codec) {
+        case ChunkCodec::LZ4:  return "lz4";
+        case ChunkCodec::NONE: return "none";
+        case ChunkCodec::ZSTD: return "zstd";
+    }
+    return "unknown";
+}
+
+bool parseCodecSpec(const std::string& spec, CodecConfig& out) {
+    const size_t colon = spec.find(':');
+    const std::string name = spec.substr(0, colon);
+    CodecConfig config;
+    if (name == "zstd-dict") {
+        config.codec = ChunkCodec::ZSTD;
+        config.dictionary = true;
+    } else if (name == "lz4hc") {
+        config.codec = ChunkCodec::LZ4;
+        config.high_compression = true;
+    } else {
+        bool found = false;
+        for (ChunkCodec c : {ChunkCodec::LZ4, ChunkCodec::NONE, ChunkCodec::ZSTD}) {
+            if (name == chunkCodecName(c)) {
+                config.codec = c;
+                found = true;
+            }
+        }
+        if (!found) return false;
+    }
+    if (colon != std::string::npos) {
+        const std::string level = spec.substr(colon + 1);
+        char* end = nullptr;
+        const long value = std::strtol(level.c_str(), &end, 10);
+        if (level.empty() || *end != '\0' || value < 0 || value > 65537) return false;
+        config.level = static_cast<int>(value);
+        if (config.high_compression && config.level > kLz4HcMaxLevel) return false;
+    }
+    out = config;
+    return true;
+}
+
+std::string codecSpecString(const CodecConfig& config) {
+    if (config.codec == ChunkCodec::NONE) return "none";
+    const int level = config.level > 0 ? config.level
+                    : config.codec == ChunkCodec::ZSTD ? kDefaultZstdLevel
+                    : config.high_compression ? kLz4HcDefaultLevel : 1;
+    const std::string name = config.dictionary ? "zstd-dict"
+                           : config.high_compression ? "lz4hc" : chunkCodecName(config.codec);
+    return name + ":" + std::to_string(level);
+}
+
+bool codecAvailable(ChunkCodec codec) {
+#ifdef QRSDP_ZSTD_ENABLED
+    return codec == ChunkCodec::LZ4 || codec == ChunkCodec::NONE || codec == ChunkCodec::ZSTD;
+#else
+    return codec == ChunkCodec::LZ4 || codec == ChunkCodec::NONE;
+#endif
+}
+
+// --- ChunkCompressor ---
+
+#ifdef QRSDP_ZSTD_ENABLED
+struct ChunkCompressor::Zstd {
+    ZSTD_CCtx* cctx = ZSTD_createCCtx();
+    ZSTD_CDict* cdict = nullptr;
+
+    ~Zstd() {
+        ZSTD_freeCDict(cdict);
+        ZSTD_freeCCtx(cctx);
+    }
+};
+#else
+struct ChunkCompressor::Zstd {};
+#endif
+
+ChunkCompressor::ChunkCompressor(const CodecConfig& config) : config_(config) {
+    if (!codecAvailable(config.codec))
+        throw std::runtime_error(std::string("ChunkCompressor: codec ") + chunkCodecName(config.codec)
+                                 + " not available in this build (BUILD_ZSTD_SUPPORT=OFF)");
+    if (config_.codec != ChunkCodec::LZ4) config_.high_compression = false;
+    if (config_.level <= 0)
+        config_.level = config_.codec == ChunkCodec::ZSTD ? kDefaultZstdLevel
+                      : config_.high_compression ? kLz4HcDefaultLevel : 1;
+#ifdef QRSDP_ZSTD_ENABLED
+    if (config_.codec == ChunkCodec::ZSTD) zstd_ = std::make_unique<Zstd>();
+#endif
+}
+
+ChunkCompressor::~ChunkCompressor() = default;
+
+size_t ChunkCompressor::bound(size_t n) const {
+    switch (config_.codec) {
+        case ChunkCodec::LZ4:  return static_cast<size_t>(LZ4_compressBound(static_cast<int>(n)));
+        case ChunkCodec::NONE: return n;
+#ifdef QRSDP_ZSTD_ENABLED
+        case ChunkCodec::ZSTD: return ZSTD_compressBound(n);
+#else
+        case ChunkCodec::ZSTD: break;
+#endif
+    }
+    return n;
+}
+
+size_t ChunkCompressor::compress(const char* src, size_t n, char* dst, size_t cap) {
+    if (collecting_) {
+        for (size_t off = 0; off < n; off += kMaxSampleBytes) {
+            const size_t len = n - off < kMaxSampleBytes ? n - off : kMaxSampleBytes;
+            samples_.insert(samples_.end(), src + off, src + off + len);
+            sample_sizes_.push_back(len);
+        }
+        return n;
+    }
+    if (n == 0 || config_.codec == ChunkCodec::NONE)
+        return n;
+    if (config_.high_compression) {
+        const size_t bytes = lz4HcCompress(src, n, dst, cap, config_.level);
+        if (bytes == 0)
+            throw std::runtime_error("ChunkCompressor: LZ4 HC output exceeds the buffer");
+        return bytes;
+    }
+    if (config_.codec == ChunkCodec::LZ4) {
+        const int bytes = LZ4_compress_fast(src, dst, static_cast<int>(n), static_cast<int>(cap),
+                                            config_.level);
+        if (bytes <= 0)
+            throw std::runtime_error("ChunkCompressor: LZ4 compression failed");
+        return static_cast<size_t>(bytes);
+    }
+#ifdef QRSDP_ZSTD_ENABLED
+    const size_t bytes = zstd_->cdict
+        ? ZSTD_compress_usingCDict(zstd_->cctx, dst, cap, src, n, zstd_->cdict)
+        : ZSTD_compressCCtx(zstd_->cctx, dst, cap, src, n, config_.level);
+    if (ZSTD_isError(bytes))
+        throw std::runtime_error(std::string("ChunkCompressor: zstd compression failed: ")
+                                 + ZSTD_getErrorName(bytes));
+    return bytes;
+#else
+    throw std::runtime_error("ChunkCompressor: zstd not available in this build");
+#endif
+}
+
+std::vector<char> ChunkCompressor::trainDictionary(size_t max_bytes) {
+    collecting_ = false;
+    std::vector<char> dictionary;
+#ifdef QRSDP_ZSTD_ENABLED
+    if (config_.codec == ChunkCodec::ZSTD && !sample_sizes_.empty()) {
+        dictionary.resize(max_bytes);
+        const size_t bytes = ZDICT_trainFromBuffer(dictionary.data(), dictionary.size(),
+                                                   samples_.data(), sample_sizes_.data(),
+                                                   static_cast<unsigned>(sample_sizes_.size()));
+        if (ZDICT_isError(bytes)) {
+            dictionary.clear();
+        } else {
+            dictionary.resize(bytes);
+            zstd_->cdict = ZSTD_createCDict(dictionary.data(), dictionary.size(), config_.level);
+            if (!zstd_->cdict)
+                throw std::runtime_error("ChunkCompressor: cannot load trained dictionary");
+        }
+    }
+#else
+    (void)max_bytes;
+#endif
+    samples_.clear();
+    samples_.shrink_to_fit();
+    sample_sizes_.clear();
+    sample_sizes_.shrink_to_fit();
+    return dictionary;
+}
+
+void ChunkCompressor::useDictionary(const char* data, size_t size) {
+#ifdef QRSDP_ZSTD_ENABLED
+    if (config_.codec != ChunkCodec::ZSTD) return;
+    ZSTD_freeCDict(zstd_->cdict);
+    zstd_->cdict = ZSTD_createCDict(data, size, config_.level);
+    if (!zstd_->cdict)
+        throw std::runtime_error("ChunkCompressor: invalid zstd dictionary");
+#else
+    (void)data;
+    (void)size;
+#endif
+}
+
+// --- ChunkDecompressor ---
+
+#ifdef QRSDP_ZSTD_ENABLED
+struct ChunkDecompressor::Zstd {
+    ZSTD_DDict* ddict = nullptr;
+
+    ~Zstd() { ZSTD_freeDDict(ddict); }
+};
+#else
+struct ChunkDecompressor::Zstd {};
+#endif
+
+ChunkDecompressor::ChunkDecompressor() : zstd_(std::make_unique<Zstd>()) {}
+
+ChunkDecompressor::~ChunkDecompressor() = default;
+
+void ChunkDecompressor::setDictionary(const char* data, size_t size) {
+#ifdef QRSDP_ZSTD_ENABLED
+    ZSTD_freeDDict(zstd_->ddict);
+    zstd_->ddict = ZSTD_createDDict(data, size);
+    if (!zstd_->ddict)
+        throw std::runtime_error("ChunkDecompressor: invalid zstd dictionary");
+#else
+    // Kept unread: ZSTD chunks fail in decompress() with a clear message instead.
+    (void)data;
+    (void)size;
+#endif
+}
+
+void ChunkDecompressor::decompress(ChunkCodec codec, const char* src, size_t n, char* dst,
+                                   size_t raw_size) const {
+    switch (codec) {
+        case ChunkCodec::LZ4: {
+            const int result = LZ4_decompress_safe(src, dst, static_cast<int>(n),
+                                                   static_cast<int>(raw_size));
+            if (result != static_cast<int>(raw_size))
+                throw std::runtime_error("LZ4 decompression failed");
+            return;
+        }
+        case ChunkCodec::NONE:
+            if (n != raw_size)
+                throw std::runtime_error("uncompressed payload size mismatch");
+            std::memcpy(dst, src, n);
+            return;
+        case ChunkCodec::ZSTD: {
+#ifdef QRSDP_ZSTD_ENABLED
+            ZSTD_DCtx* dctx = threadDCtx();
+            const size_t result = zstd_->ddict
+                ? ZSTD_decompress_usingDDict(dctx, dst, raw_size, src, n, zstd_->ddict)
+                : ZSTD_decompressDCtx(dctx, dst, raw_size, src, n);
+            if (ZSTD_isError(result) || result != raw_size)
+                throw std::runtime_error("zstd decompression failed");
+            return;
+#else
+            throw std::runtime_error("zstd chunk in file but zstd not available in this build");
+#endif
+        }
+    }
+    throw std::runtime_error("unknown chunk codec");
+}
+
+}  // namespace qrsdp
@@ -0,0 +1,100 @@
+#pragma once
+
+#include "io/event_log_format.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace qrsdp {
+
+/// Codec choice for one run. level 0 = the codec's default: LZ4 acceleration 1
+/// (LZ4_compress_default), LZ4 HC level 9, zstd level 3. dictionary is zstd
+/// only; high_compression is LZ4 only (lz4HcCompress, same chunk format).
+struct CodecConfig {
+    ChunkCodec codec = ChunkCodec::LZ4;
+    int level = 0;
+    bool dictionary = false;
+    bool high_compression = false;
+};
+
+/// "lz4", "none", "zstd"; "unknown" for out-of-range values.
+const char* chunkCodecName(ChunkCodec codec);
+
+/// Parses "<codec>[:<level>]" with codec lz4, lz4hc (level = search depth, 1..12),
+/// none, zstd or zstd-dict (zstd with a dictionary trained on the run's first
+/// chunks). Returns false (out untouched) for unknown names or a malformed level.
+bool parseCodecSpec(const std::string& spec, CodecConfig& out);
+
+/// "lz4:1", "lz4hc:9", "zstd-dict:3", "none": the spec that parseCodecSpec would read back.
+std::string codecSpecString(const CodecConfig& config);
+
+/// False for ZSTD when the library was built without BUILD_ZSTD_SUPPORT.
+bool codecAvailable(ChunkCodec codec);
+
+/// Writer-side compressor for one codec (owns the zstd context and dictionary).
+/// One per writing thread.
+class ChunkCompressor {
+public:
+    /// Throws std::runtime_error if the codec is not available in this build.
+    explicit ChunkCompressor(const CodecConfig& config);
+    ~ChunkCompressor();
+
+    ChunkCompressor(const ChunkCompressor&) = delete;
+    ChunkCompressor& operator=(const ChunkCompressor&) = delete;
+
+    ChunkCodec codec() const { return config_.codec; }
+
+    /// Worst-case compressed size of n input bytes.
+    size_t bound(size_t n) const;
+
+    /// Compresses src[0, n) into dst (capacity cap >= bound(n)) and returns the
+    /// compressed size. A result >= n means "store it raw": NONE always returns n,
+    /// and so does sample collection. Throws std::runtime_error on codec failure.
+    size_t compress(const char* src, size_t n, char* dst, size_t cap);
+
+    /// While collecting, compress() records its inputs as dictionary training samples.
+    void startCollecting() { collecting_ = true; }
+    /// Ends collection and trains a dictionary of at most max_bytes from the samples.
+    /// Returns it (also installed for later compress() calls), or empty if the samples
+    /// were too few to train on; compression then proceeds without one.
+    std::vector<char> trainDictionary(size_t max_bytes);
+    /// Installs a dictionary trained earlier (a resumed file's dictionary block).
+    /// Throws std::runtime_error if zstd rejects it.
+    void useDictionary(const char* data, size_t size);
+
+private:
+    struct Zstd;
+
+    CodecConfig config_;
+    std::unique_ptr<Zstd> zstd_;
+    bool collecting_ = false;
+    std::vector<char> samples_;
+    std::vector<size_t> sample_sizes_;
+};
+
+/// Reader-side decompression for every codec; const and safe to call concurrently.
+class ChunkDecompressor {
+public:
+    ChunkDecompressor();
+    ~ChunkDecompressor();
+
+    ChunkDecompressor(const ChunkDecompressor&) = delete;
+    ChunkDecompressor& operator=(const ChunkDecompressor&) = delete;
+
+    /// Dictionary for ZSTD payloads (copied).
+    void setDictionary(const char* data, size_t size);
+
+    /// Decompresses exactly raw_size bytes of codec payload src[0, n) into dst.
+    /// Throws std::runtime_error on corrupt input or an unavailable codec.
+    void decompress(ChunkCodec codec, const char* src, size_t n, char* dst, size_t raw_size) const;
+
+private:
+    struct Zstd;
+
+    std::unique_ptr<Zstd> zstd_;
+};
+
+}  // namespace qrsdp
@@ -0,0 +1,261 @@
+#include "io/columnar_chunk.h"
+
+#include <cstring>
+#include <stdexcept>
+
+namespace qrsdp {
+
+namespace {
+
+constexpr size_t kMaxVarintBytes = 10;
+
+inline void putVarint(uint8_t*& p, uint64_t v) {
+    while (v >= 0x80) {
+        *p++ = static_cast<uint8_t>(v | 0x80);
+        v >>= 7;
+    }
+    *p++ = static_cast<uint8_t>(v);
+}
+
+inline uint64_t getVarint(const uint8_t*& p, const uint8_t* end) {
+    uint64_t v = 0;
+    for (unsigned shift = 0; shift < 64; shift += 7) {
+        if (p == end)
+            throw std::runtime_error("columnar chunk: truncated varint");
+        const uint8_t byte = *p++;
+        v |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80))
+            return v;
+    }
+    throw std::runtime_error("columnar chunk: varint too long");
+}
+
+inline uint64_t zigzag(int64_t v) {
+    return (static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63);
+}
+
+inline int64_t unzigzag(uint64_t u) {
+    return static_cast<int64_t>((u >> 1) ^ (~(u & 1) + 1));
+}
+
+/// One column's encoded bytes: viewed in the payload, or decompressed into buf.
+struct ColumnBytes {
+    const uint8_t* begin = nullptr;
+    const uint8_t* end = nullptr;
+};
+
+/// Validates a payload's column directory and hands out its columns.
+class ColumnReader {
+public:
+    ColumnReader(const char* payload, size_t size, const ChunkDecompressor& dec, ChunkCodec codec)
+        : dec_(dec), codec_(codec) {
+        if (size < sizeof(ColumnDirectory))
+            throw std::runtime_error("columnar chunk: payload shorter than column directory");
+        std::memcpy(&dir_, payload, sizeof(dir_));
+        uint64_t offset = sizeof(ColumnDirectory);
+        for (uint32_t c = 0; c < kColumnCount; ++c) {
+            if (dir_.stored_size[c] > dir_.encoded_size[c])
+                throw std::runtime_error("columnar chunk: stored column larger than encoded");
+            offset_[c] = offset;
+            offset += dir_.stored_size[c];
+        }
+        if (offset != size)
+            throw std::runtime_error("columnar chunk: column sizes do not match payload");
+        payload_ = payload;
+    }
+
+    ColumnBytes column(uint32_t c, std::vector<uint8_t>& buf) const {
+        const char* stored = payload_ + offset_[c];
+        const uint32_t encoded = dir_.encoded_size[c];
+        if (dir_.stored_size[c] == encoded) {
+            const auto* p = reinterpret_cast<const uint8_t*>(stored);
+            return ColumnBytes{p, p + encoded};
+        }
+        buf.resize(encoded);
+        dec_.decompress(codec_, stored, dir_.stored_size[c], reinterpret_cast<char*>(buf.data()), encoded);
+        return ColumnBytes{buf.data(), buf.data() + encoded};
+    }
+
+private:
+    const ChunkDecompressor& dec_;
+    ChunkCodec codec_;
+    const char* payload_ = nullptr;
+    ColumnDirectory dir_{};
+    uint64_t offset_[kColumnCount] = {};
+};
+
+inline void expectConsumed(const uint8_t* p, const uint8_t* end) {
+    if (p != end)
+        throw std::runtime_error("columnar chunk: trailing bytes in column");
+}
+
+/// Decodes the n varints of column c, calling put(i, varint); the caller undoes
+/// the delta/zigzag step.
+template <class Put>
+void decodeVarintColumn(const ColumnReader& reader, uint32_t c, size_t n,
+                        std::vector<uint8_t>& buf, Put put) {
+    const ColumnBytes col = reader.column(c, buf);
+    const uint8_t* p = col.begin;
+    for (size_t i = 0; i < n; ++i) put(i, getVarint(p, col.end));
+    expectConsumed(p, col.end);
+}
+
+template <class Put>
+void decodeTypeSideColumn(const ColumnReader& reader, size_t n, std::vector<uint8_t>& buf, Put put) {
+    const ColumnBytes col = reader.column(kColumnTypeSide, buf);
+    if (static_cast<size_t>(col.end - col.begin) != n)
+        throw std::runtime_error("columnar chunk: type/side column size mismatch");
+    for (size_t i = 0; i < n; ++i)
+        put(i, static_cast<uint8_t>(col.begin[i] & 0x0F), static_cast<uint8_t>(col.begin[i] >> 4));
+}
+
+}  // namespace
+
+size_t ChunkColumns::size() const {
+    if (!ts_ns.empty()) return ts_ns.size();
+    if (!type.empty()) return type.size();
+    if (!side.empty()) return side.size();
+    if (!price_ticks.empty()) return price_ticks.size();
+    if (!qty.empty()) return qty.size();
+    return order_id.size();
+}
+
+void ChunkColumns::clear() {
+    ts_ns.clear();
+    type.clear();
+    side.clear();
+    price_ticks.clear();
+    qty.clear();
+    order_id.clear();
+}
+
+bool ColumnarChunkEncoder::encode(const DiskEventRecord* rows, size_t n, ChunkCompressor& compressor,
+                                  std::vector<char>& out) {
+    for (auto& col : columns_) col.resize(n * kMaxVarintBytes);
+
+    uint8_t* type_side = columns_[kColumnTypeSide].data();
+    uint8_t* ts = columns_[kColumnTs].data();
+    uint8_t* price = columns_[kColumnPrice].data();
+    uint8_t* qty = columns_[kColumnQty].data();
+    uint8_t* order_id = columns_[kColumnOrderId].data();
+
+    uint64_t prev_ts = 0;
+    int64_t prev_price = 0;
+    uint64_t prev_id = 0;
+    for (size_t i = 0; i < n; ++i) {
+        const DiskEventRecord& r = rows[i];
+        if (r.type > 0x0F || r.side > 0x0F)
+            return false;
+        *type_side++ = static_cast<uint8_t>(r.type | (r.side << 4));
+        putVarint(ts, r.ts_ns - prev_ts);
+        putVarint(price, zigzag(static_cast<int64_t>(r.price_ticks) - prev_price));
+        putVarint(qty, r.qty);
+        putVarint(order_id, zigzag(static_cast<int64_t>(r.order_id - prev_id)));
+        prev_ts = r.ts_ns;
+        prev_price = r.price_ticks;
+        prev_id = r.order_id;
+    }
+    uint8_t* const ends[kColumnCount] = {type_side, ts, price, qty, order_id};
+
+    ColumnDirectory dir{};
+    size_t bound = sizeof(ColumnDirectory);
+    for (uint32_t c = 0; c < kColumnCount; ++c) {
+        dir.encoded_size[c] = static_cast<uint32_t>(ends[c] - columns_[c].data());
+        bound += compressor.bound(dir.encoded_size[c]);
+    }
+    out.resize(bound);
+
+    size_t offset = sizeof(ColumnDirectory);
+    for (uint32_t c = 0; c < kColumnCount; ++c) {
+        const size_t encoded = dir.encoded_size[c];
+        const size_t compressed = compressor.compress(
+            reinterpret_cast<const char*>(columns_[c].data()), encoded, out.data() + offset,
+            out.size() - offset);
+        if (compressed >= encoded) {
+            // Incompressible column (or empty chunk, or codec NONE): store it as-is.
+            std::memcpy(out.data() + offset, columns_[c].data(), encoded);
+            dir.stored_size[c] = dir.encoded_size[c];
+        } else {
+            dir.stored_size[c] = static_cast<uint32_t>(compressed);
+        }
+        offset += dir.stored_size[c];
+    }
+    std::memcpy(out.data(), &dir, sizeof(dir));
+    out.resize(offset);
+    return true;
+}
+
+void decodeColumnarChunk(const char* payload, size_t size, size_t n, const ChunkDecompressor& dec,
+                         ChunkCodec codec, DiskEventRecord* out) {
+    const ColumnReader reader(payload, size, dec, codec);
+    std::vector<uint8_t> buf;
+    decodeTypeSideColumn(reader, n, buf, [out](size_t i, uint8_t type, uint8_t side) {
+        out[i].type = type;
+        out[i].side = side;
+    });
+    uint64_t ts = 0;
+    decodeVarintColumn(reader, kColumnTs, n, buf, [out, &ts](size_t i, uint64_t v) {
+        ts += v;
+        out[i].ts_ns = ts;
+    });
+    int64_t price = 0;
+    decodeVarintColumn(reader, kColumnPrice, n, buf, [out, &price](size_t i, uint64_t v) {
+        price += unzigzag(v);
+        out[i].price_ticks = static_cast<int32_t>(price);
+    });
+    decodeVarintColumn(reader, kColumnQty, n, buf, [out](size_t i, uint64_t v) {
+        out[i].qty = static_cast<uint32_t>(v);
+    });
+    uint64_t id = 0;
+    decodeVarintColumn(reader, kColumnOrderId, n, buf, [out, &id](size_t i, uint64_t v) {
+        id += static_cast<uint64_t>(unzigzag(v));
+        out[i].order_id = id;
+    });
+}
+
+void decodeColumnarColumns(const char* payload, size_t size, size_t n, const ChunkDecompressor& dec,
+                           ChunkCodec codec, uint32_t select, ChunkColumns& out) {
+    const ColumnReader reader(payload, size, dec, codec);
+    std::vector<uint8_t> buf;
+    out.clear();
+    if (select & (kSelectType | kSelectSide)) {
+        if (select & kSelectType) out.type.resize(n);
+        if (select & kSelectSide) out.side.resize(n);
+        decodeTypeSideColumn(reader, n, buf, [&out, select](size_t i, uint8_t type, uint8_t side) {
+            if (select & kSelectType) out.type[i] = type;
+            if (select & kSelectSide) out.side[i] = side;
+        });
+    }
+    if (select & kSelectTs) {
+        out.ts_ns.resize(n);
+        uint64_t ts = 0;
+        decodeVarintColumn(reader, kColumnTs, n, buf, [&out, &ts](size_t i, uint64_t v) {
+            ts += v;
+            out.ts_ns[i] = ts;
+        });
+    }
+    if (select & kSelectPrice) {
+        out.price_ticks.resize(n);
+        int64_t price = 0;
+        decodeVarintColumn(reader, kColumnPrice, n, buf, [&out, &price](size_t i, uint64_t v) {
+            price += unzigzag(v);
+            out.price_ticks[i] = static_cast<int32_t>(price);
+        });
+    }
+    if (select & kSelectQty) {
+        out.qty.resize(n);
+        decodeVarintColumn(reader, kColumnQty, n, buf, [&out](size_t i, uint64_t v) {
+            out.qty[i] = static_cast<uint32_t>(v);
+        });
+    }
+    if (select & kSelectOrderId) {
+        out.order_id.resize(n);
+        uint64_t id = 0;
+        decodeVarintColumn(reader, kColumnOrderId, n, buf, [&out, &id](size_t i, uint64_t v) {
+            id += static_cast<uint64_t>(unzigzag(v));
+            out.order_id[i] = id;
+        });
+    }
+}
+
+}  // namespace qrsdp
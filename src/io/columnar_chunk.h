@@ -0,0 +1,81 @@
+#pragma once
+
+#include "io/chunk_codec.h"
+#include "io/event_log_format.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace qrsdp {
+
+/// Columns of the columnar chunk encoding (v1.1), in payload order.
+enum ChunkColumn : uint32_t {
+    kColumnTypeSide = 0,  // one byte per record: type | side << 4
+    kColumnTs       = 1,  // varint of ts_ns - previous ts_ns (mod 2^64)
+    kColumnPrice    = 2,  // zigzag varint of price_ticks - previous price_ticks
+    kColumnQty      = 3,  // varint of qty
+    kColumnOrderId  = 4,  // zigzag varint of order_id - previous order_id
+    kColumnCount    = 5
+};
+
+/// Column selection bits for EventLogReader::readColumns().
+constexpr uint32_t kSelectTs      = 1u << 0;
+constexpr uint32_t kSelectType    = 1u << 1;
+constexpr uint32_t kSelectSide    = 1u << 2;
+constexpr uint32_t kSelectPrice   = 1u << 3;
+constexpr uint32_t kSelectQty     = 1u << 4;
+constexpr uint32_t kSelectOrderId = 1u << 5;
+constexpr uint32_t kSelectAll     = 0x3F;
+
+/// Per-column directory at the start of a columnar payload. A column whose
+/// stored_size equals its encoded_size is stored as-is, otherwise it is compressed
+/// with the chunk's codec.
+#pragma pack(push, 1)
+struct ColumnDirectory {
+    uint32_t encoded_size[kColumnCount];
+    uint32_t stored_size[kColumnCount];
+};
+#pragma pack(pop)
+static_assert(sizeof(ColumnDirectory) == 40, "ColumnDirectory must be 40 bytes");
+
+/// Struct-of-arrays view of one chunk. Only the selected vectors are filled by
+/// a projected read; the others are left empty.
+struct ChunkColumns {
+    std::vector<uint64_t> ts_ns;
+    std::vector<uint8_t>  type;
+    std::vector<uint8_t>  side;
+    std::vector<int32_t>  price_ticks;
+    std::vector<uint32_t> qty;
+    std::vector<uint64_t> order_id;
+
+    size_t size() const;
+    void clear();
+};
+
+/// Builds columnar chunk payloads. Holds the per-column scratch so steady-state
+/// encoding does not allocate; one encoder per writing thread.
+class ColumnarChunkEncoder {
+public:
+    /// Encodes rows[0, n) into out (resized to the payload). Returns false, leaving
+    /// out unspecified, if a type or side value does not fit in 4 bits; the caller
+    /// then stores the chunk in row form. Columns are compressed with compressor.
+    bool encode(const DiskEventRecord* rows, size_t n, ChunkCompressor& compressor,
+                std::vector<char>& out);
+
+private:
+    std::vector<uint8_t> columns_[kColumnCount];
+};
+
+/// Decodes a columnar payload of n records, whose columns use codec, into out[0, n).
+/// Throws std::runtime_error if the payload is malformed.
+void decodeColumnarChunk(const char* payload, size_t size, size_t n, const ChunkDecompressor& dec,
+                         ChunkCodec codec, DiskEventRecord* out);
+
+/// Decodes only the selected columns (kSelect* bits) of a columnar payload into out;
+/// columns that are not needed are neither decompressed nor decoded.
+/// Throws std::runtime_error if the payload is malformed.
+void decodeColumnarColumns(const char* payload, size_t size, size_t n, const ChunkDecompressor& dec,
+                           ChunkCodec codec, uint32_t select, ChunkColumns& out);
+
+}  // namespace qrsdp
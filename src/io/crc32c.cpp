@@ -0,0 +1,107 @@
+#include "io/crc32c.h"
+
+#include <array>
+#include <cstring>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define QRSDP_CRC32C_X86 1
+#include <nmmintrin.h>
+#elif defined(__ARM_FEATURE_CRC32)
+#define QRSDP_CRC32C_ARM 1
+#include <arm_acle.h>
+#endif
+
+namespace qrsdp {
+
+namespace {
+
+constexpr uint32_t kPolyReflected = 0x82F63B78u;
+
+using Tables = std::array<std::array<uint32_t, 256>, 8>;
+
+Tables makeTables() {
+    Tables t{};
+    for (uint32_t i = 0; i < 256; ++i) {
+        uint32_t c = i;
+        for (int k = 0; k < 8; ++k) c = (c >> 1) ^ ((c & 1u) ? kPolyReflected : 0u);
+        t[0][i] = c;
+    }
+    for (uint32_t i = 0; i < 256; ++i)
+        for (size_t s = 1; s < 8; ++s) t[s][i] = (t[s - 1][i] >> 8) ^ t[0][t[s - 1][i] & 0xFF];
+    return t;
+}
+
+const Tables& tables() {
+    static const Tables t = makeTables();
+    return t;
+}
+
+/// Raw (uninverted) table update.
+uint32_t updateSoftware(uint32_t c, const unsigned char* p, size_t n) {
+    const Tables& t = tables();
+    for (; n >= 8; n -= 8, p += 8) {
+        uint32_t lo;
+        uint32_t hi;
+        std::memcpy(&lo, p, 4);
+        std::memcpy(&hi, p + 4, 4);
+        lo ^= c;  // little-endian hosts, like every target this builds for
+        c = t[7][lo & 0xFF] ^ t[6][(lo >> 8) & 0xFF] ^ t[5][(lo >> 16) & 0xFF] ^ t[4][lo >> 24]
+          ^ t[3][hi & 0xFF] ^ t[2][(hi >> 8) & 0xFF] ^ t[1][(hi >> 16) & 0xFF] ^ t[0][hi >> 24];
+    }
+    for (; n > 0; --n, ++p) c = (c >> 8) ^ t[0][(c ^ *p) & 0xFF];
+    return c;
+}
+
+#if defined(QRSDP_CRC32C_X86)
+__attribute__((target("sse4.2")))
+uint32_t updateHardware(uint32_t c, const unsigned char* p, size_t n) {
+    uint64_t c64 = c;
+    for (; n >= 8; n -= 8, p += 8) {
+        uint64_t v;
+        std::memcpy(&v, p, 8);
+        c64 = _mm_crc32_u64(c64, v);
+    }
+    c = static_cast<uint32_t>(c64);
+    for (; n > 0; --n, ++p) c = _mm_crc32_u8(c, *p);
+    return c;
+}
+
+bool detectHardware() { return __builtin_cpu_supports("sse4.2"); }
+#elif defined(QRSDP_CRC32C_ARM)
+uint32_t updateHardware(uint32_t c, const unsigned char* p, size_t n) {
+    for (; n >= 8; n -= 8, p += 8) {
+        uint64_t v;
+        std::memcpy(&v, p, 8);
+        c = __crc32cd(c, v);
+    }
+    for (; n > 0; --n, ++p) c = __crc32cb(c, *p);
+    return c;
+}
+
+bool detectHardware() { return true; }
+#endif
+
+}  // namespace
+
+bool crc32cHardware() {
+#if defined(QRSDP_CRC32C_X86) || defined(QRSDP_CRC32C_ARM)
+    static const bool hardware = detectHardware();
+    return hardware;
+#else
+    return false;
+#endif
+}
+
+uint32_t crc32cSoftware(const void* data, size_t size, uint32_t crc) {
+    return ~updateSoftware(~crc, static_cast<const unsigned char*>(data), size);
+}
+
+uint32_t crc32c(const void* data, size_t size, uint32_t crc) {
+#if defined(QRSDP_CRC32C_X86) || defined(QRSDP_CRC32C_ARM)
+    if (crc32cHardware())
+        return ~updateHardware(~crc, static_cast<const unsigned char*>(data), size);
+#endif
+    return crc32cSoftware(data, size, crc);
+}
+
+}  // namespace qrsdp
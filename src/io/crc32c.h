@@ -0,0 +1,22 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace qrsdp {
+
+/// CRC-32C (Castagnoli, the iSCSI / ext4 polynomial) of size bytes at data.
+/// Pass a previous result as crc to continue it: crc32c(b, nb, crc32c(a, na))
+/// equals the CRC of a followed by b. Uses the SSE4.2 crc32 instruction when the
+/// CPU has it (checked once at run time on x86-64 GCC/Clang) or the ARMv8 CRC
+/// extension when the target enables it; otherwise a slicing-by-8 table loop.
+/// Every path gives the same value.
+uint32_t crc32c(const void* data, size_t size, uint32_t crc = 0);
+
+/// The table implementation (reference for tests and benchmarks).
+uint32_t crc32cSoftware(const void* data, size_t size, uint32_t crc = 0);
+
+/// True if crc32c() runs on a hardware CRC instruction.
+bool crc32cHardware();
+
+}  // namespace qrsdp
@@ -1,7 +1,11 @@
 #pragma once
 
+#include "core/records.h"
+
+#include <cstddef>
 #include <cstdint>
 #include <cstring>
+#include <string>
 
 namespace qrsdp {
 
@@ -9,10 +13,22 @@ namespace qrsdp {
 constexpr char     kLogMagic[8] = {'Q','R','S','D','P','L','O','G'};
 constexpr uint16_t kLogVersionMajor = 1;
 constexpr uint16_t kLogVersionMinor = 0;
+/// Minor version written when chunks may use the columnar encoding (kChunkFlagColumnar).
+constexpr uint16_t kLogVersionMinorColumnar = 1;
 constexpr uint32_t kDefaultChunkCapacity = 4096;
 
 // --- Header flags ---
 constexpr uint32_t kHeaderFlagHasIndex = 0x1;
+/// Index entries carry a CRC-32C of their chunk (IndexEntry::checksum).
+constexpr uint32_t kHeaderFlagChunkChecksums = 0x2;
+/// Bits 8-15: RngAlgorithm that generated the file (0 = mt19937_64, the only
+/// generator before the field existed).
+constexpr uint32_t kHeaderRngShift = 8;
+constexpr uint32_t kHeaderRngMask  = 0xFF00;
+/// Bits 16-23: ChunkCodec the run was written with (0 = LZ4, the only codec before
+/// the field existed). Informational; every chunk names its own codec.
+constexpr uint32_t kHeaderCodecShift = 16;
+constexpr uint32_t kHeaderCodecMask  = 0xFF0000;
 
 // --- File Header (64 bytes) ---
 #pragma pack(push, 1)
@@ -48,6 +64,76 @@ struct DiskEventRecord {
 #pragma pack(pop)
 static_assert(sizeof(DiskEventRecord) == 26, "DiskEventRecord must be 26 bytes");
 
+/// The packed record of rec (flags are not stored on disk).
+inline DiskEventRecord toDisk(const EventRecord& rec) {
+    DiskEventRecord disk;
+    disk.ts_ns       = rec.ts_ns;
+    disk.type        = rec.type;
+    disk.side        = rec.side;
+    disk.price_ticks = rec.price_ticks;
+    disk.qty         = rec.qty;
+    disk.order_id    = rec.order_id;
+    return disk;
+}
+
+/// The in-memory record of disk, with the given flags.
+inline EventRecord fromDisk(const DiskEventRecord& disk, uint32_t flags = kFlagNone) {
+    EventRecord rec{};
+    rec.ts_ns       = disk.ts_ns;
+    rec.order_id    = disk.order_id;
+    rec.price_ticks = disk.price_ticks;
+    rec.qty         = disk.qty;
+    rec.flags       = flags;
+    rec.type        = disk.type;
+    rec.side        = disk.side;
+    return rec;
+}
+
+/// Packs n records into out. A branch-free loop over fixed strides, so the
+/// compiler turns it into vector gathers/stores where the target has them.
+inline void toDisk(const EventRecord* recs, size_t n, DiskEventRecord* out) {
+    for (size_t i = 0; i < n; ++i) out[i] = toDisk(recs[i]);
+}
+
+/// Unpacks n records into out (flags 0).
+inline void fromDisk(const DiskEventRecord* disk, size_t n, EventRecord* out) {
+    for (size_t i = 0; i < n; ++i) out[i] = fromDisk(disk[i]);
+}
+
+// --- Chunk flags ---
+/// Payload is the raw DiskEventRecord rows (compressed_size == uncompressed_size),
+/// written when LZ4 would not shrink the chunk. Readers can view it in place.
+constexpr uint32_t kChunkFlagRaw = 0x1;
+/// Payload is the columnar encoding (v1.1, see io/columnar_chunk.h): a column
+/// directory followed by separately LZ4-compressed delta/varint columns.
+constexpr uint32_t kChunkFlagColumnar = 0x2;
+/// Block holds a zstd dictionary (record_count 0, no index entry) for the ZSTD chunks
+/// of the file. Written only directly after the file header.
+constexpr uint32_t kChunkFlagDictionary = 0x4;
+/// Block holds the seek index (SeekIndexHeader + per-chunk stats + ts samples,
+/// record_count 0, no index entry). Written after the last chunk, before the footer.
+constexpr uint32_t kChunkFlagSeekIndex = 0x8;
+/// Block holds book checkpoints (CheckpointBlockHeader + entries, record_count 0,
+/// no index entry). Written after the last chunk, before the footer.
+constexpr uint32_t kChunkFlagCheckpoints = 0x10;
+/// Block holds OHLC bar rollups (BarBlockHeader + series, record_count 0, no index
+/// entry). Written after the last chunk, before the footer.
+constexpr uint32_t kChunkFlagBars = 0x20;
+/// Block holds per-chunk statistics (StatsBlockHeader + ChunkStats, record_count 0,
+/// no index entry). Written after the last chunk, before the footer.
+constexpr uint32_t kChunkFlagStats = 0x40;
+/// Any block that carries metadata rather than records; scanners skip these.
+constexpr uint32_t kChunkFlagMetadataMask = kChunkFlagDictionary | kChunkFlagSeekIndex
+                                          | kChunkFlagCheckpoints | kChunkFlagBars
+                                          | kChunkFlagStats;
+/// Bits 8-11: ChunkCodec of the compressed payload (row chunks) or of every
+/// compressed column (columnar chunks). Ignored for RAW chunks.
+constexpr uint32_t kChunkCodecShift = 8;
+constexpr uint32_t kChunkCodecMask  = 0xF00;
+
+/// Compression codec of a chunk payload. NONE writes every chunk RAW.
+enum class ChunkCodec : uint8_t { LZ4 = 0, NONE = 1, ZSTD = 2 };
+
 // --- Chunk Header (32 bytes) ---
 #pragma pack(push, 1)
 struct ChunkHeader {
@@ -68,11 +154,147 @@ struct IndexEntry {
     uint64_t first_ts_ns;
     uint64_t last_ts_ns;
     uint32_t record_count;
-    uint32_t reserved;
+    uint32_t checksum;       // CRC-32C of the chunk header and payload (kHeaderFlagChunkChecksums), else 0
 };
 #pragma pack(pop)
 static_assert(sizeof(IndexEntry) == 32, "IndexEntry must be 32 bytes");
 
+// --- Seek index block payload ---
+/// Followed by chunk_count ChunkSeekStats, then sample_count uint64 timestamps:
+/// for each chunk, the ts of records 0, ts_stride, 2 * ts_stride, ...
+#pragma pack(push, 1)
+struct SeekIndexHeader {
+    uint32_t ts_stride;
+    uint32_t chunk_count;
+    uint64_t sample_count;
+};
+#pragma pack(pop)
+static_assert(sizeof(SeekIndexHeader) == 16, "SeekIndexHeader must be 16 bytes");
+
+#pragma pack(push, 1)
+struct ChunkSeekStats {
+    int32_t  min_price_ticks;
+    int32_t  max_price_ticks;
+    uint64_t first_sample;  // index of this chunk's first ts sample
+};
+#pragma pack(pop)
+static_assert(sizeof(ChunkSeekStats) == 16, "ChunkSeekStats must be 16 bytes");
+
+// --- Checkpoint block payload ---
+/// Followed by checkpoint_count entries, each a CheckpointEntry and then
+/// levels_per_side CheckpointLevels for the bid side and as many for the ask side,
+/// best level first. When the entries carry producer state (rng_position > 0), a
+/// CheckpointStateHeader and one CheckpointState per entry follow them.
+#pragma pack(push, 1)
+struct CheckpointBlockHeader {
+    uint32_t checkpoint_count;
+    uint32_t levels_per_side;
+};
+#pragma pack(pop)
+static_assert(sizeof(CheckpointBlockHeader) == 8, "CheckpointBlockHeader must be 8 bytes");
+
+#pragma pack(push, 1)
+struct CheckpointEntry {
+    uint64_t record_index;   // records before the checkpoint; the book is as after them
+    uint64_t ts_ns;          // ts of record record_index - 1
+    uint64_t next_order_id;  // producer's next order id
+    uint64_t rng_position;   // producer's IRng::position(); 0 = not recorded
+};
+#pragma pack(pop)
+static_assert(sizeof(CheckpointEntry) == 32, "CheckpointEntry must be 32 bytes");
+
+/// Producer state the entries' fields cannot hold: the exact clock (ts_ns is
+/// truncated to whole nanoseconds) and the intensity model's event history.
+/// Each CheckpointState is followed by history_size float64s.
+#pragma pack(push, 1)
+struct CheckpointStateHeader {
+    uint32_t state_count;    // == checkpoint_count
+    uint32_t history_size;   // history values per checkpoint (0: no self-exciting model)
+};
+#pragma pack(pop)
+static_assert(sizeof(CheckpointStateHeader) == 8, "CheckpointStateHeader must be 8 bytes");
+
+#pragma pack(push, 1)
+struct CheckpointState {
+    double clock;            // producer clock, seconds since the open
+};
+#pragma pack(pop)
+static_assert(sizeof(CheckpointState) == 8, "CheckpointState must be 8 bytes");
+
+#pragma pack(push, 1)
+struct CheckpointLevel {
+    int32_t  price_ticks;
+    uint32_t depth;
+};
+#pragma pack(pop)
+static_assert(sizeof(CheckpointLevel) == 8, "CheckpointLevel must be 8 bytes");
+
+// --- Bar block payload ---
+/// Followed by series_count series, each a BarSeriesHeader and then bar_count
+/// DiskBars in time order. Bars start at market_open_ns + k * interval_ns; only
+/// bars holding at least one record are stored.
+#pragma pack(push, 1)
+struct BarBlockHeader {
+    uint32_t series_count;
+    uint32_t reserved;
+};
+#pragma pack(pop)
+static_assert(sizeof(BarBlockHeader) == 8, "BarBlockHeader must be 8 bytes");
+
+#pragma pack(push, 1)
+struct BarSeriesHeader {
+    uint64_t interval_ns;
+    uint32_t bar_count;
+    uint32_t reserved;
+};
+#pragma pack(pop)
+static_assert(sizeof(BarSeriesHeader) == 16, "BarSeriesHeader must be 16 bytes");
+
+/// One bar. Mids are stored doubled (best bid + best ask) so they stay integral;
+/// each is the mid after a record, so open is the mid after the bar's first record.
+#pragma pack(push, 1)
+struct DiskBar {
+    uint64_t start_ns;
+    int32_t  open_mid2;
+    int32_t  high_mid2;
+    int32_t  low_mid2;
+    int32_t  close_mid2;
+    int32_t  close_bid_ticks;  // best bid and ask after the bar's last record
+    int32_t  close_ask_ticks;
+    uint32_t events;
+    uint32_t executions;
+    uint32_t volume;           // executed qty
+    uint32_t reserved;
+};
+#pragma pack(pop)
+static_assert(sizeof(DiskBar) == 48, "DiskBar must be 48 bytes");
+
+// --- Stats block payload ---
+/// Followed by chunk_count ChunkStats, one per chunk in index order.
+#pragma pack(push, 1)
+struct StatsBlockHeader {
+    uint32_t chunk_count;
+    uint32_t reserved;
+};
+#pragma pack(pop)
+static_assert(sizeof(StatsBlockHeader) == 8, "StatsBlockHeader must be 8 bytes");
+
+/// What a chunk holds, so summaries need not decode it. Shift and reinit counts
+/// come from the producer's EventRecord flags, which the records on disk drop.
+#pragma pack(push, 1)
+struct ChunkStats {
+    uint32_t type_counts[6];   // records per EventType
+    int32_t  min_price_ticks;
+    int32_t  max_price_ticks;
+    uint64_t executed_qty;     // qty of EXECUTE_BUY and EXECUTE_SELL records
+    uint32_t shifts_up;        // records with kFlagShiftUp
+    uint32_t shifts_down;      // records with kFlagShiftDown
+    uint32_t reinits;          // records with kFlagReinit
+    uint32_t reserved;
+};
+#pragma pack(pop)
+static_assert(sizeof(ChunkStats) == 56, "ChunkStats must be 56 bytes");
+
 // --- Index Tail (16 bytes) ---
 constexpr char kIndexMagic[4] = {'Q','I','D','X'};
 
@@ -85,6 +307,29 @@ struct IndexTail {
 #pragma pack(pop)
 static_assert(sizeof(IndexTail) == 16, "IndexTail must be 16 bytes");
 
+// --- Sidecar index (<file>.idx, 24-byte header) ---
+/// Crash-recovery copy of the chunk index, written next to an unfinished file by a
+/// sink with BinaryFileSinkOptions::sync_interval and replaced atomically (temp file
+/// + rename) after each fsync of the data. Followed by chunk_count IndexEntries and
+/// checkpoint_bytes of checkpoint-block payload (0 = no checkpoints). Everything
+/// before data_end was on disk when it was written.
+constexpr char kSidecarMagic[4] = {'Q','S','I','X'};
+
+#pragma pack(push, 1)
+struct SidecarHeader {
+    char     magic[4];
+    uint32_t chunk_count;
+    uint64_t data_end;
+    uint32_t checkpoint_bytes;
+    uint32_t reserved;
+};
+#pragma pack(pop)
+static_assert(sizeof(SidecarHeader) == 24, "SidecarHeader must be 24 bytes");
+
+inline std::string sidecarIndexPath(const std::string& log_path) {
+    return log_path + ".idx";
+}
+
 inline bool validateMagic(const FileHeader& h) {
     return std::memcmp(h.magic, kLogMagic, 8) == 0;
 }
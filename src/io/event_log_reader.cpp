@@ -1,35 +1,100 @@
 #include "io/event_log_reader.h"
+#include "io/crc32c.h"
+#include "producer/work_stealing_pool.h"
 
-#include <lz4.h>
-
+#include <algorithm>
+#include <condition_variable>
+#include <cstdio>
 #include <cstring>
+#include <exception>
+#include <mutex>
 #include <stdexcept>
+#include <string>
+#include <utility>
 
 namespace qrsdp {
 
-EventLogReader::EventLogReader(const std::string& path) {
-    file_ = std::fopen(path.c_str(), "rb");
-    if (!file_)
-        throw std::runtime_error("EventLogReader: cannot open " + path);
+namespace {
+
+/// Completion latch for one batch of pool tasks; keeps the first exception.
+/// (WorkStealingPool::wait() would also wait on unrelated tasks sharing the pool.)
+class TaskGroup {
+public:
+    void add() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++pending_;
+    }
+    void done(std::exception_ptr error = nullptr) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (error && !error_) error_ = error;
+        if (--pending_ == 0) cv_.notify_all();
+    }
+    /// Blocks until every added task is done; returns the first failure, if any.
+    std::exception_ptr wait() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [this] { return pending_ == 0; });
+        std::exception_ptr error = error_;
+        error_ = nullptr;
+        return error;
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    size_t pending_ = 0;
+    std::exception_ptr error_;
+};
+
+ChunkCodec chunkCodec(const ChunkHeader& chdr) {
+    return static_cast<ChunkCodec>((chdr.chunk_flags & kChunkCodecMask) >> kChunkCodecShift);
+}
+
+template <class Fn>
+void submitTo(WorkStealingPool& pool, TaskGroup& group, Fn fn) {
+    group.add();
+    pool.submit([&group, fn]() {
+        try {
+            fn();
+            group.done();
+        } catch (...) {
+            group.done(std::current_exception());
+        }
+    });
+}
 
-    if (std::fread(&header_, sizeof(header_), 1, file_) != 1)
-        throw std::runtime_error("EventLogReader: cannot read header from " + path);
+}  // namespace
+
+EventLogReader::EventLogReader(const std::string& path)
+    : mapping_(std::make_shared<const MappedFile>(path)) {
+    file_ = Bytes{mapping_->data(), mapping_->size()};
+    open(path, path);
+}
+
+EventLogReader::EventLogReader(std::shared_ptr<const MappedFile> mapping, uint64_t offset,
+                               uint64_t size, const std::string& name)
+    : mapping_(std::move(mapping)) {
+    if (offset > mapping_->size() || size > mapping_->size() - offset)
+        throw std::runtime_error("EventLogReader: " + name + " lies outside the mapping");
+    file_ = Bytes{mapping_->data() + offset, static_cast<size_t>(size)};
+    open(name, std::string());
+}
+
+void EventLogReader::open(const std::string& name, const std::string& sidecar_path) {
+    if (file_.size() < sizeof(header_))
+        throw std::runtime_error("EventLogReader: cannot read header from " + name);
+    std::memcpy(&header_, file_.data(), sizeof(header_));
 
     if (!validateMagic(header_))
-        throw std::runtime_error("EventLogReader: invalid magic in " + path);
+        throw std::runtime_error("EventLogReader: invalid magic in " + name);
 
     if (header_.version_major != kLogVersionMajor)
-        throw std::runtime_error("EventLogReader: unsupported version in " + path);
+        throw std::runtime_error("EventLogReader: unsupported version in " + name);
 
     if (header_.record_size != sizeof(DiskEventRecord))
-        throw std::runtime_error("EventLogReader: record size mismatch in " + path);
-
-    buildIndex();
-}
+        throw std::runtime_error("EventLogReader: record size mismatch in " + name);
 
-EventLogReader::~EventLogReader() {
-    if (file_)
-        std::fclose(file_);
+    first_chunk_offset_ = loadDictionary();
+    buildIndex(sidecar_path);
 }
 
 uint64_t EventLogReader::totalRecords() const {
@@ -42,98 +107,571 @@ uint64_t EventLogReader::totalRecords() const {
 std::vector<DiskEventRecord> EventLogReader::readChunk(uint32_t idx) const {
     if (idx >= chunkCount())
         throw std::out_of_range("EventLogReader: chunk index out of range");
-    return decompressChunkAt(index_[idx].file_offset);
+    std::vector<DiskEventRecord> records(index_[idx].record_count);
+    decodeChunk(index_[idx], records.data());
+    return records;
+}
+
+RecordSpan EventLogReader::chunkRecords(uint32_t idx, std::vector<DiskEventRecord>& scratch) const {
+    if (idx >= chunkCount())
+        throw std::out_of_range("EventLogReader: chunk index out of range");
+    ChunkHeader chdr{};
+    const char* payload = chunkPayloadAt(index_[idx].file_offset, chdr);
+    if (chdr.record_count != index_[idx].record_count)
+        throw std::runtime_error("EventLogReader: chunk header does not match index");
+    if (chdr.chunk_flags & kChunkFlagRaw)  // DiskEventRecord is packed: any address is aligned
+        return RecordSpan{reinterpret_cast<const DiskEventRecord*>(payload), chdr.record_count};
+    if (scratch.size() < index_[idx].record_count)
+        scratch.resize(index_[idx].record_count);
+    decodeChunk(index_[idx], scratch.data());
+    return RecordSpan{scratch.data(), index_[idx].record_count};
+}
+
+void EventLogReader::readColumns(uint32_t idx, uint32_t select, ChunkColumns& out) const {
+    if (idx >= chunkCount())
+        throw std::out_of_range("EventLogReader: chunk index out of range");
+    const IndexEntry& entry = index_[idx];
+    ChunkHeader chdr{};
+    const char* payload = chunkPayloadAt(entry.file_offset, chdr);
+    if (chdr.record_count != entry.record_count)
+        throw std::runtime_error("EventLogReader: chunk header does not match index");
+    if (chdr.chunk_flags & kChunkFlagColumnar) {
+        decodeColumnarColumns(payload, chdr.compressed_size, chdr.record_count, decoder_,
+                              chunkCodec(chdr), select, out);
+        return;
+    }
+
+    std::vector<DiskEventRecord> scratch;
+    const RecordSpan rows = chunkRecords(idx, scratch);
+    const size_t n = rows.size;
+    out.clear();
+    if (select & kSelectTs) out.ts_ns.resize(n);
+    if (select & kSelectType) out.type.resize(n);
+    if (select & kSelectSide) out.side.resize(n);
+    if (select & kSelectPrice) out.price_ticks.resize(n);
+    if (select & kSelectQty) out.qty.resize(n);
+    if (select & kSelectOrderId) out.order_id.resize(n);
+    for (size_t i = 0; i < n; ++i) {
+        const DiskEventRecord& r = rows[i];
+        if (select & kSelectTs) out.ts_ns[i] = r.ts_ns;
+        if (select & kSelectType) out.type[i] = r.type;
+        if (select & kSelectSide) out.side[i] = r.side;
+        if (select & kSelectPrice) out.price_ticks[i] = r.price_ticks;
+        if (select & kSelectQty) out.qty[i] = r.qty;
+        if (select & kSelectOrderId) out.order_id[i] = r.order_id;
+    }
 }
 
 std::vector<DiskEventRecord> EventLogReader::readRange(uint64_t ts_start, uint64_t ts_end) const {
-    std::vector<DiskEventRecord> result;
+    size_t n = 0;
+    for (const auto& entry : index_)
+        if (entry.first_ts_ns <= ts_end && entry.last_ts_ns >= ts_start)
+            n += entry.record_count;
+    std::vector<DiskEventRecord> result(n);
+    size_t pos = 0;
     for (const auto& entry : index_) {
         if (entry.first_ts_ns <= ts_end && entry.last_ts_ns >= ts_start) {
-            auto chunk = decompressChunkAt(entry.file_offset);
-            result.insert(result.end(), chunk.begin(), chunk.end());
+            decodeChunk(entry, result.data() + pos);
+            pos += entry.record_count;
         }
     }
     return result;
 }
 
-std::vector<DiskEventRecord> EventLogReader::readAll() const {
+const BookCheckpoint* EventLogReader::checkpointAtOrBefore(uint64_t ts) const {
+    const auto it = std::partition_point(checkpoints_.begin(), checkpoints_.end(),
+                                         [ts](const BookCheckpoint& cp) { return cp.ts_ns <= ts; });
+    return it == checkpoints_.begin() ? nullptr : &*(it - 1);
+}
+
+const BarSeries* EventLogReader::barsAt(uint64_t interval_ns) const {
+    for (const BarSeries& series : bars_)
+        if (series.interval_ns == interval_ns) return &series;
+    return nullptr;
+}
+
+LogStats EventLogReader::stats() const {
+    if (chunk_stats_.empty())
+        throw std::runtime_error("EventLogReader: no stats block");
+    LogStats total;
+    total.min_price_ticks = chunk_stats_.front().min_price_ticks;
+    total.max_price_ticks = chunk_stats_.front().max_price_ticks;
+    for (const ChunkStats& c : chunk_stats_) {
+        for (int t = 0; t < 6; ++t) total.type_counts[t] += c.type_counts[t];
+        total.min_price_ticks = std::min(total.min_price_ticks, c.min_price_ticks);
+        total.max_price_ticks = std::max(total.max_price_ticks, c.max_price_ticks);
+        total.executed_qty += c.executed_qty;
+        total.shifts_up += c.shifts_up;
+        total.shifts_down += c.shifts_down;
+        total.reinits += c.reinits;
+    }
+    return total;
+}
+
+uint32_t EventLogReader::chunkOfRecord(uint64_t record, uint64_t& skip) const {
+    const auto it = std::upper_bound(chunk_first_record_.begin(), chunk_first_record_.end(), record);
+    if (it == chunk_first_record_.begin()) {
+        skip = 0;
+        return chunkCount();
+    }
+    const uint32_t idx = static_cast<uint32_t>(it - chunk_first_record_.begin() - 1);
+    skip = record - chunk_first_record_[idx];
+    return skip < index_[idx].record_count ? idx : chunkCount();
+}
+
+uint32_t EventLogReader::firstChunkAtOrAfter(uint64_t ts) const {
+    const auto it = std::partition_point(index_.begin(), index_.end(),
+                                         [ts](const IndexEntry& e) { return e.last_ts_ns < ts; });
+    return static_cast<uint32_t>(it - index_.begin());
+}
+
+bool EventLogReader::chunkMayMatchPrice(uint32_t idx, const RecordQuery& q) const {
+    if (!hasSeekIndex())
+        return true;
+    const ChunkSeekStats& stats = seek_stats_[idx];
+    return stats.max_price_ticks >= q.price_min && stats.min_price_ticks <= q.price_max;
+}
+
+RecordSpan EventLogReader::matchTsWindow(uint32_t idx, const RecordQuery& q,
+                                         std::vector<DiskEventRecord>& scratch) const {
+    const RecordSpan chunk = chunkRecords(idx, scratch);
+    size_t lo = 0;
+    size_t hi = chunk.size;
+    if (hasSeekIndex() && chunk.size > 0) {
+        // samples[k] is the ts of record k * stride: only strides whose sample range
+        // overlaps [ts_start, ts_end] need the exact search below.
+        const uint64_t* first = seek_samples_.data() + seek_stats_[idx].first_sample;
+        const uint64_t* last = first + (chunk.size + seek_stride_ - 1) / seek_stride_;
+        const uint64_t* s_lo = std::lower_bound(first, last, q.ts_start);
+        const uint64_t* s_hi = std::upper_bound(s_lo, last, q.ts_end);
+        lo = s_lo == first ? 0 : static_cast<size_t>(s_lo - first - 1) * seek_stride_;
+        hi = std::min(chunk.size, static_cast<size_t>(s_hi - first) * seek_stride_);
+    }
+    const DiskEventRecord* begin = std::partition_point(
+        chunk.data + lo, chunk.data + hi, [&q](const DiskEventRecord& r) { return r.ts_ns < q.ts_start; });
+    const DiskEventRecord* end = std::partition_point(
+        begin, chunk.data + hi, [&q](const DiskEventRecord& r) { return r.ts_ns <= q.ts_end; });
+    return RecordSpan{begin, static_cast<size_t>(end - begin)};
+}
+
+std::vector<DiskEventRecord> EventLogReader::select(const RecordQuery& q) const {
     std::vector<DiskEventRecord> result;
-    for (uint32_t i = 0; i < chunkCount(); ++i) {
-        auto chunk = readChunk(i);
-        result.insert(result.end(), chunk.begin(), chunk.end());
+    forEachMatch(q, [&result](const DiskEventRecord& rec) { result.push_back(rec); });
+    return result;
+}
+
+std::vector<DiskEventRecord> EventLogReader::readAll() const {
+    std::vector<DiskEventRecord> result(static_cast<size_t>(totalRecords()));
+    size_t pos = 0;
+    for (const auto& entry : index_) {
+        decodeChunk(entry, result.data() + pos);
+        pos += entry.record_count;
     }
     return result;
 }
 
-void EventLogReader::buildIndex() {
+std::vector<DiskEventRecord> EventLogReader::readAll(WorkStealingPool& pool) const {
+    std::vector<DiskEventRecord> result(static_cast<size_t>(totalRecords()));
+    TaskGroup group;
+    size_t pos = 0;
+    for (const auto& entry : index_) {
+        DiskEventRecord* out = result.data() + pos;
+        submitTo(pool, group, [this, &entry, out]() { decodeChunk(entry, out); });
+        pos += entry.record_count;
+    }
+    if (std::exception_ptr error = group.wait())
+        std::rethrow_exception(error);
+    return result;
+}
+
+void EventLogReader::forEachChunk(WorkStealingPool& pool,
+                                  const std::function<void(const RecordSpan&)>& visit,
+                                  size_t window) const {
+    const uint32_t n = chunkCount();
+    if (window == 0)
+        window = 2 * pool.size();
+    struct Slot {
+        std::vector<DiskEventRecord> scratch;
+        RecordSpan span;
+    };
+    // Two batches of `window` slots: one being visited, one being decoded.
+    std::vector<Slot> slots(2 * window);
+    TaskGroup groups[2];
+    auto launch = [&](uint32_t first, size_t batch) {
+        const uint32_t last = static_cast<uint32_t>(std::min<uint64_t>(first + window, n));
+        for (uint32_t i = first; i < last; ++i) {
+            Slot* slot = &slots[batch * window + (i - first)];
+            submitTo(pool, groups[batch], [this, i, slot]() { slot->span = chunkRecords(i, slot->scratch); });
+        }
+    };
+
+    size_t batch = 0;
+    if (n > 0)
+        launch(0, batch);
+    for (uint32_t first = 0; first < n; first = static_cast<uint32_t>(first + window), batch ^= 1) {
+        const uint64_t next = static_cast<uint64_t>(first) + window;
+        if (next < n)
+            launch(static_cast<uint32_t>(next), batch ^ 1);
+        std::exception_ptr error = groups[batch].wait();
+        if (!error) {
+            try {
+                const uint32_t last = static_cast<uint32_t>(std::min<uint64_t>(next, n));
+                for (uint32_t i = first; i < last; ++i)
+                    visit(slots[batch * window + (i - first)].span);
+            } catch (...) {
+                error = std::current_exception();
+            }
+        }
+        if (error) {
+            groups[batch ^ 1].wait();  // tasks still reference slots
+            std::rethrow_exception(error);
+        }
+    }
+}
+
+uint64_t EventLogReader::loadDictionary() {
+    if (file_.size() < sizeof(FileHeader) + sizeof(ChunkHeader))
+        return sizeof(FileHeader);
+    ChunkHeader chdr{};
+    std::memcpy(&chdr, file_.data() + sizeof(FileHeader), sizeof(chdr));
+    if (!(chdr.chunk_flags & kChunkFlagDictionary))
+        return sizeof(FileHeader);
+    const char* payload = chunkPayloadAt(sizeof(FileHeader), chdr);
+    decoder_.setDictionary(payload, chdr.compressed_size);
+    return sizeof(FileHeader) + sizeof(ChunkHeader) + chdr.compressed_size;
+}
+
+void EventLogReader::buildIndex(const std::string& path) {
     if (header_.header_flags & kHeaderFlagHasIndex)
         buildIndexFromFooter();
     else
-        buildIndexByScanning();
+        buildIndexByScanning(path);
+    chunk_first_record_.resize(index_.size());
+    uint64_t first = 0;
+    for (size_t i = 0; i < index_.size(); ++i) {
+        chunk_first_record_[i] = first;
+        first += index_[i].record_count;
+    }
 }
 
 void EventLogReader::buildIndexFromFooter() {
-    std::fseek(file_, -static_cast<long>(sizeof(IndexTail)), SEEK_END);
+    const size_t size = file_.size();
+    if (size < sizeof(FileHeader) + sizeof(IndexTail))
+        throw std::runtime_error("EventLogReader: cannot read index tail");
 
     IndexTail tail{};
-    if (std::fread(&tail, sizeof(tail), 1, file_) != 1)
-        throw std::runtime_error("EventLogReader: cannot read index tail");
+    std::memcpy(&tail, file_.data() + size - sizeof(IndexTail), sizeof(tail));
 
     if (std::memcmp(tail.index_magic, kIndexMagic, 4) != 0)
         throw std::runtime_error("EventLogReader: invalid index magic");
 
-    std::fseek(file_, static_cast<long>(tail.index_start_offset), SEEK_SET);
-    index_.resize(tail.chunk_count);
-    if (std::fread(index_.data(), sizeof(IndexEntry), tail.chunk_count, file_) != tail.chunk_count)
+    const uint64_t index_bytes = static_cast<uint64_t>(tail.chunk_count) * sizeof(IndexEntry);
+    if (tail.index_start_offset > size || index_bytes > size - tail.index_start_offset)
         throw std::runtime_error("EventLogReader: cannot read index entries");
+    index_.resize(tail.chunk_count);
+    std::memcpy(index_.data(), file_.data() + tail.index_start_offset, static_cast<size_t>(index_bytes));
+    findTrailingBlocks(tail.index_start_offset);
 }
 
-void EventLogReader::buildIndexByScanning() {
-    std::fseek(file_, sizeof(FileHeader), SEEK_SET);
-
-    while (true) {
-        long chunk_offset = std::ftell(file_);
+void EventLogReader::buildIndexByScanning(const std::string& path) {
+    const size_t size = file_.size();
+    uint64_t chunk_offset = loadSidecar(path);
 
+    while (chunk_offset + sizeof(ChunkHeader) <= size) {
         ChunkHeader chdr{};
-        if (std::fread(&chdr, sizeof(chdr), 1, file_) != 1)
-            break;
+        std::memcpy(&chdr, file_.data() + chunk_offset, sizeof(chdr));
+        if (chdr.compressed_size > size - chunk_offset - sizeof(ChunkHeader))
+            break;  // payload cut short by a crash
+        if (chdr.chunk_flags & kChunkFlagMetadataMask) {
+            loadMetadataBlock(chunk_offset, chdr);
+            chunk_offset += sizeof(ChunkHeader) + chdr.compressed_size;
+            continue;
+        }
+        if (chdr.record_count == 0 || chdr.uncompressed_size != chdr.record_count * sizeof(DiskEventRecord))
+            break;  // not a chunk header: bytes the crashed writer never finished
 
         IndexEntry entry{};
-        entry.file_offset  = static_cast<uint64_t>(chunk_offset);
+        entry.file_offset  = chunk_offset;
         entry.first_ts_ns  = chdr.first_ts_ns;
         entry.last_ts_ns   = chdr.last_ts_ns;
         entry.record_count = chdr.record_count;
-        entry.reserved     = 0;
+        entry.checksum     = 0;  // only the footer and sidecar carry checksums
         index_.push_back(entry);
 
-        std::fseek(file_, static_cast<long>(chdr.compressed_size), SEEK_CUR);
+        chunk_offset += sizeof(ChunkHeader) + chdr.compressed_size;
+    }
+}
+
+uint64_t EventLogReader::loadSidecar(const std::string& path) {
+    if (path.empty())
+        return first_chunk_offset_;
+    std::FILE* f = std::fopen(sidecarIndexPath(path).c_str(), "rb");
+    if (!f)
+        return first_chunk_offset_;
+    std::vector<char> bytes;
+    if (std::fseek(f, 0, SEEK_END) == 0) {
+        const long length = std::ftell(f);
+        if (length > 0) {
+            bytes.resize(static_cast<size_t>(length));
+            std::fseek(f, 0, SEEK_SET);
+            if (std::fread(bytes.data(), 1, bytes.size(), f) != bytes.size())
+                bytes.clear();
+        }
+    }
+    std::fclose(f);
+
+    SidecarHeader sh{};
+    if (bytes.size() < sizeof(sh))
+        return first_chunk_offset_;
+    std::memcpy(&sh, bytes.data(), sizeof(sh));
+    const uint64_t entry_bytes = static_cast<uint64_t>(sh.chunk_count) * sizeof(IndexEntry);
+    if (std::memcmp(sh.magic, kSidecarMagic, 4) != 0
+        || sizeof(sh) + entry_bytes + sh.checkpoint_bytes != bytes.size() || sh.data_end > file_.size())
+        return first_chunk_offset_;
+    std::vector<IndexEntry> entries(sh.chunk_count);
+    std::memcpy(entries.data(), bytes.data() + sizeof(sh), static_cast<size_t>(entry_bytes));
+
+    // A sidecar left by another run of the same path must not be trusted: the entries
+    // have to tile the file exactly up to data_end and agree with the chunk headers.
+    uint64_t expected = first_chunk_offset_;
+    for (const IndexEntry& e : entries) {
+        ChunkHeader chdr{};
+        if (e.file_offset != expected || sh.data_end - e.file_offset < sizeof(chdr))
+            return first_chunk_offset_;
+        std::memcpy(&chdr, file_.data() + e.file_offset, sizeof(chdr));
+        if (chdr.record_count != e.record_count || chdr.first_ts_ns != e.first_ts_ns
+            || chdr.last_ts_ns != e.last_ts_ns
+            || chdr.compressed_size > sh.data_end - e.file_offset - sizeof(chdr))
+            return first_chunk_offset_;
+        expected = e.file_offset + sizeof(chdr) + chdr.compressed_size;
+    }
+    if (expected != sh.data_end)
+        return first_chunk_offset_;
+
+    index_ = std::move(entries);
+    if (sh.checkpoint_bytes > 0)
+        loadCheckpoints(bytes.data() + sizeof(sh) + entry_bytes, sh.checkpoint_bytes);
+    return sh.data_end;
+}
+
+bool EventLogReader::hasChecksums() const {
+    const uint32_t want = kHeaderFlagHasIndex | kHeaderFlagChunkChecksums;
+    return (header_.header_flags & want) == want;
+}
+
+uint32_t EventLogReader::chunkChecksum(uint32_t idx) const {
+    if (idx >= chunkCount())
+        throw std::out_of_range("EventLogReader: chunk index out of range");
+    ChunkHeader chdr{};
+    const char* payload = chunkPayloadAt(index_[idx].file_offset, chdr);
+    return crc32c(payload, chdr.compressed_size, crc32c(&chdr, sizeof(chdr)));
+}
+
+uint64_t EventLogReader::verify(VerifyMode mode) const {
+    if (mode == VerifyMode::None)
+        return totalRecords();
+    const bool checksums = hasChecksums();
+    std::vector<DiskEventRecord> scratch;
+    uint64_t records = 0;
+    for (uint32_t i = 0; i < chunkCount(); ++i) {
+        const IndexEntry& entry = index_[i];
+        auto fail = [i](const char* what) {
+            return std::runtime_error("EventLogReader: chunk " + std::to_string(i) + " " + what);
+        };
+        ChunkHeader chdr{};
+        chunkPayloadAt(entry.file_offset, chdr);
+        if (chdr.record_count != entry.record_count || chdr.first_ts_ns != entry.first_ts_ns
+            || chdr.last_ts_ns != entry.last_ts_ns)
+            throw fail("header does not match the index");
+        if (checksums && chunkChecksum(i) != entry.checksum)
+            throw fail("fails its checksum");
+        if (mode == VerifyMode::Full) {
+            const RecordSpan span = chunkRecords(i, scratch);
+            if (span.size == 0 || span[0].ts_ns != entry.first_ts_ns
+                || span[span.size - 1].ts_ns != entry.last_ts_ns)
+                throw fail("records do not span its time range");
+            for (size_t r = 1; r < span.size; ++r)
+                if (span[r].ts_ns < span[r - 1].ts_ns)
+                    throw fail("has timestamps out of order");
+        }
+        records += entry.record_count;
+    }
+    return records;
+}
+
+bool parseVerifyMode(const std::string& name, VerifyMode& out) {
+    if (name == "none") out = VerifyMode::None;
+    else if (name == "checksums") out = VerifyMode::Checksums;
+    else if (name == "full") out = VerifyMode::Full;
+    else return false;
+    return true;
+}
+
+const char* verifyModeName(VerifyMode mode) {
+    switch (mode) {
+        case VerifyMode::None:      return "none";
+        case VerifyMode::Checksums: return "checksums";
+        case VerifyMode::Full:      return "full";
     }
+    return "?";
 }
 
-std::vector<DiskEventRecord> EventLogReader::decompressChunkAt(uint64_t file_offset) const {
-    std::fseek(file_, static_cast<long>(file_offset), SEEK_SET);
+uint64_t EventLogReader::chunkEndOffset(uint32_t idx) const {
+    if (idx >= chunkCount())
+        throw std::out_of_range("EventLogReader: chunk index out of range");
+    ChunkHeader chdr{};
+    chunkPayloadAt(index_[idx].file_offset, chdr);
+    return index_[idx].file_offset + sizeof(ChunkHeader) + chdr.compressed_size;
+}
+
+std::vector<char> EventLogReader::dictionary() const {
+    if (first_chunk_offset_ == sizeof(FileHeader))
+        return {};
+    const char* payload = file_.data() + sizeof(FileHeader) + sizeof(ChunkHeader);
+    return std::vector<char>(payload, file_.data() + first_chunk_offset_);
+}
 
+void EventLogReader::findTrailingBlocks(uint64_t data_end) {
+    if (index_.empty())
+        return;
+    const IndexEntry& last = index_.back();
     ChunkHeader chdr{};
-    if (std::fread(&chdr, sizeof(chdr), 1, file_) != 1)
+    if (last.file_offset > data_end || data_end - last.file_offset < sizeof(ChunkHeader))
+        return;
+    std::memcpy(&chdr, file_.data() + last.file_offset, sizeof(chdr));
+    uint64_t offset = last.file_offset + sizeof(ChunkHeader) + chdr.compressed_size;
+    while (offset < data_end && data_end - offset >= sizeof(ChunkHeader)) {
+        std::memcpy(&chdr, file_.data() + offset, sizeof(chdr));
+        if (!(chdr.chunk_flags & kChunkFlagMetadataMask))
+            return;
+        loadMetadataBlock(offset, chdr);
+        offset += sizeof(ChunkHeader) + chdr.compressed_size;
+    }
+}
+
+void EventLogReader::loadMetadataBlock(uint64_t offset, const ChunkHeader& chdr) {
+    if (!(chdr.chunk_flags & (kChunkFlagSeekIndex | kChunkFlagCheckpoints | kChunkFlagBars
+                              | kChunkFlagStats)))
+        return;
+    const size_t size = file_.size();
+    const uint64_t payload_offset = offset + sizeof(ChunkHeader);
+    if (payload_offset > size || chdr.compressed_size > size - payload_offset)
+        throw std::runtime_error("EventLogReader: cannot read metadata block");
+    const char* payload = file_.data() + payload_offset;
+    // The scan path meets these blocks after the chunks they describe, so index_ is complete.
+    if (chdr.chunk_flags & kChunkFlagSeekIndex)
+        loadSeekIndex(payload, chdr.compressed_size);
+    else if (chdr.chunk_flags & kChunkFlagCheckpoints)
+        loadCheckpoints(payload, chdr.compressed_size);
+    else if (chdr.chunk_flags & kChunkFlagBars)
+        loadBars(payload, chdr.compressed_size);
+    else
+        loadStats(payload, chdr.compressed_size);
+}
+
+void EventLogReader::loadSeekIndex(const char* payload, uint32_t size) {
+    SeekIndexHeader sih{};
+    if (size < sizeof(sih))
+        throw std::runtime_error("EventLogReader: cannot read seek index");
+    std::memcpy(&sih, payload, sizeof(sih));
+    const uint64_t expected = sizeof(SeekIndexHeader)
+                            + static_cast<uint64_t>(sih.chunk_count) * sizeof(ChunkSeekStats)
+                            + sih.sample_count * sizeof(uint64_t);
+    if (sih.ts_stride == 0 || sih.sample_count > size || expected != size)
+        throw std::runtime_error("EventLogReader: seek index size mismatch");
+
+    std::vector<ChunkSeekStats> stats(sih.chunk_count);
+    std::memcpy(stats.data(), payload + sizeof(sih), sih.chunk_count * sizeof(ChunkSeekStats));
+    std::vector<uint64_t> samples(static_cast<size_t>(sih.sample_count));
+    std::memcpy(samples.data(), payload + sizeof(sih) + sih.chunk_count * sizeof(ChunkSeekStats),
+                samples.size() * sizeof(uint64_t));
+
+    bool valid = stats.size() == index_.size();
+    for (size_t i = 0; valid && i < index_.size(); ++i) {
+        const uint64_t count = (index_[i].record_count + sih.ts_stride - 1) / sih.ts_stride;
+        valid = stats[i].first_sample <= samples.size()
+             && count <= samples.size() - stats[i].first_sample;
+    }
+    if (!valid)
+        throw std::runtime_error("EventLogReader: seek index does not match chunk index");
+    seek_stride_ = sih.ts_stride;
+    seek_stats_ = std::move(stats);
+    seek_samples_ = std::move(samples);
+}
+
+void EventLogReader::loadCheckpoints(const char* payload, uint32_t size) {
+    std::vector<BookCheckpoint> checkpoints;
+    try {
+        checkpoints = decodeCheckpoints(payload, size, header_.levels_per_side);
+    } catch (const std::runtime_error& e) {
+        throw std::runtime_error(std::string("EventLogReader: ") + e.what());
+    }
+    if (!checkpoints.empty() && checkpoints.back().record_index > totalRecords())
+        throw std::runtime_error("EventLogReader: checkpoint does not match chunk index");
+    checkpoints_ = std::move(checkpoints);
+}
+
+void EventLogReader::loadBars(const char* payload, uint32_t size) {
+    try {
+        bars_ = decodeBars(payload, size);
+    } catch (const std::runtime_error& e) {
+        throw std::runtime_error(std::string("EventLogReader: ") + e.what());
+    }
+}
+
+void EventLogReader::loadStats(const char* payload, uint32_t size) {
+    StatsBlockHeader sbh{};
+    if (size < sizeof(sbh))
+        throw std::runtime_error("EventLogReader: cannot read stats block");
+    std::memcpy(&sbh, payload, sizeof(sbh));
+    if (sizeof(sbh) + static_cast<uint64_t>(sbh.chunk_count) * sizeof(ChunkStats) != size)
+        throw std::runtime_error("EventLogReader: stats block size mismatch");
+    if (sbh.chunk_count != index_.size())
+        throw std::runtime_error("EventLogReader: stats block does not match chunk index");
+    std::vector<ChunkStats> stats(sbh.chunk_count);
+    std::memcpy(stats.data(), payload + sizeof(sbh), stats.size() * sizeof(ChunkStats));
+    chunk_stats_ = std::move(stats);
+}
+
+const char* EventLogReader::chunkPayloadAt(uint64_t file_offset, ChunkHeader& chdr) const {
+    const size_t size = file_.size();
+    if (file_offset > size || size - file_offset < sizeof(ChunkHeader))
         throw std::runtime_error("EventLogReader: cannot read chunk header");
+    std::memcpy(&chdr, file_.data() + file_offset, sizeof(chdr));
 
-    std::vector<char> compressed(chdr.compressed_size);
-    if (std::fread(compressed.data(), 1, chdr.compressed_size, file_) != chdr.compressed_size)
+    const uint64_t payload_offset = file_offset + sizeof(ChunkHeader);
+    if (chdr.compressed_size > size - payload_offset)
         throw std::runtime_error("EventLogReader: cannot read compressed payload");
+    if (static_cast<uint64_t>(chdr.record_count) * sizeof(DiskEventRecord) != chdr.uncompressed_size)
+        throw std::runtime_error("EventLogReader: chunk size does not match record count");
+    if ((chdr.chunk_flags & kChunkFlagRaw) && chdr.compressed_size != chdr.uncompressed_size)
+        throw std::runtime_error("EventLogReader: raw chunk size mismatch");
+    if ((chdr.chunk_flags & kChunkFlagRaw) && (chdr.chunk_flags & kChunkFlagColumnar))
+        throw std::runtime_error("EventLogReader: chunk is both raw and columnar");
+    return file_.data() + payload_offset;
+}
 
-    std::vector<char> decompressed(chdr.uncompressed_size);
-    int result = LZ4_decompress_safe(
-        compressed.data(),
-        decompressed.data(),
-        static_cast<int>(chdr.compressed_size),
-        static_cast<int>(chdr.uncompressed_size));
-
-    if (result != static_cast<int>(chdr.uncompressed_size))
-        throw std::runtime_error("EventLogReader: LZ4 decompression failed");
+void EventLogReader::decodeChunk(const IndexEntry& entry, DiskEventRecord* out) const {
+    ChunkHeader chdr{};
+    const char* payload = chunkPayloadAt(entry.file_offset, chdr);
+    if (chdr.record_count != entry.record_count)
+        throw std::runtime_error("EventLogReader: chunk header does not match index");
 
-    std::vector<DiskEventRecord> records(chdr.record_count);
-    std::memcpy(records.data(), decompressed.data(), chdr.uncompressed_size);
-    return records;
+    if (chdr.chunk_flags & kChunkFlagRaw) {
+        std::memcpy(out, payload, chdr.uncompressed_size);
+        return;
+    }
+    if (chdr.chunk_flags & kChunkFlagColumnar) {
+        decodeColumnarChunk(payload, chdr.compressed_size, chdr.record_count, decoder_,
+                            chunkCodec(chdr), out);
+        return;
+    }
+    try {
+        decoder_.decompress(chunkCodec(chdr), payload, chdr.compressed_size,
+                            reinterpret_cast<char*>(out), chdr.uncompressed_size);
+    } catch (const std::runtime_error& e) {
+        throw std::runtime_error(std::string("EventLogReader: ") + e.what());
+    }
 }
 
 }  // namespace qrsdp
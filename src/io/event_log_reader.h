@@ -1,23 +1,90 @@
 #pragma once
 
+#include "io/bar_rollup.h"
+#include "io/book_checkpoint.h"
+#include "io/chunk_codec.h"
+#include "io/columnar_chunk.h"
 #include "io/event_log_format.h"
+#include "io/mapped_file.h"
 
-#include <cstdio>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 namespace qrsdp {
 
+class WorkStealingPool;
+
+/// Read-only view of one chunk's records. Points either into the reader's file
+/// mapping (raw chunks) or into the caller's scratch buffer (compressed chunks).
+struct RecordSpan {
+    const DiskEventRecord* data = nullptr;
+    size_t size = 0;
+
+    const DiskEventRecord* begin() const { return data; }
+    const DiskEventRecord* end() const { return data + size; }
+    const DiskEventRecord& operator[](size_t i) const { return data[i]; }
+    bool empty() const { return size == 0; }
+};
+
+/// Exact record filter for EventLogReader::select(): inclusive timestamp and price
+/// bounds (defaults match everything).
+struct RecordQuery {
+    uint64_t ts_start = 0;
+    uint64_t ts_end = std::numeric_limits<uint64_t>::max();
+    int32_t price_min = std::numeric_limits<int32_t>::min();
+    int32_t price_max = std::numeric_limits<int32_t>::max();
+};
+
+/// File-wide totals of a log's stats block (EventLogReader::stats()).
+struct LogStats {
+    uint64_t type_counts[6] = {};  // records per EventType
+    int32_t  min_price_ticks = 0;
+    int32_t  max_price_ticks = 0;
+    uint64_t executed_qty = 0;
+    uint64_t shifts_up = 0;
+    uint64_t shifts_down = 0;
+    uint64_t reinits = 0;
+};
+
+/// How much of a finished log EventLogReader::verify() checks.
+enum class VerifyMode : uint8_t {
+    None,       // footer record count only
+    Checksums,  // chunk headers against the index, plus CRC-32C of each chunk (no decoding)
+    Full,       // Checksums, then decode every chunk and check its timestamps
+};
+
+/// Parses "none", "checksums" or "full". Returns false (out untouched) otherwise.
+bool parseVerifyMode(const std::string& name, VerifyMode& out);
+const char* verifyModeName(VerifyMode mode);
+
 /// Reads .qrsdp binary event log files produced by BinaryFileSink.
 /// Supports sequential iteration, random-access by chunk index,
 /// and timestamp-range queries via the chunk index.
+///
+/// The file is memory-mapped once at construction; chunk reads are plain loads from
+/// the mapping, with no seeks or intermediate payload copies. All const members are
+/// safe to call concurrently, and the pool overloads spread chunk decompression
+/// across a WorkStealingPool.
+///
+/// Row (v1.0) and columnar (v1.1) chunks decode to the same records; readColumns()
+/// additionally lets column-oriented passes skip the columns they do not use.
 class EventLogReader {
 public:
-    /// Opens the file and parses the file header.
+    /// Maps the file and parses the file header.
     /// Throws std::runtime_error if the file cannot be opened or the header is invalid.
     explicit EventLogReader(const std::string& path);
 
-    ~EventLogReader();
+    /// Reads the log stored in bytes [offset, offset + size) of an existing mapping,
+    /// e.g. one session of a SessionContainer; the reader keeps the mapping alive.
+    /// name is used in error messages. Throws like the path constructor.
+    EventLogReader(std::shared_ptr<const MappedFile> mapping, uint64_t offset, uint64_t size,
+                   const std::string& name);
 
     EventLogReader(const EventLogReader&) = delete;
     EventLogReader& operator=(const EventLogReader&) = delete;
@@ -35,33 +102,246 @@ public:
     /// Throws std::out_of_range if idx >= chunkCount().
     std::vector<DiskEventRecord> readChunk(uint32_t idx) const;
 
+    /// Records of chunk idx without intermediate copies: raw chunks are viewed in
+    /// place in the mapping; compressed chunks are decompressed straight into
+    /// scratch, which is only grown, so one buffer can be reused across calls.
+    /// The span is valid while the reader lives and scratch is not modified.
+    /// Throws std::out_of_range if idx >= chunkCount().
+    RecordSpan chunkRecords(uint32_t idx, std::vector<DiskEventRecord>& scratch) const;
+
+    /// Column-projected read of chunk idx: fills only the kSelect* columns in select
+    /// (the others are left empty). On columnar chunks the unselected columns are not
+    /// decompressed; row chunks are decoded and scattered. Reuses out's storage.
+    /// Throws std::out_of_range if idx >= chunkCount().
+    void readColumns(uint32_t idx, uint32_t select, ChunkColumns& out) const;
+
+    /// Streams every chunk's selected columns in file order as
+    /// visit(const ChunkColumns&), reusing one ChunkColumns.
+    template <class Visit>
+    void forEachChunkColumns(uint32_t select, Visit&& visit) const {
+        ChunkColumns cols;
+        for (uint32_t i = 0; i < chunkCount(); ++i) {
+            readColumns(i, select, cols);
+            visit(static_cast<const ChunkColumns&>(cols));
+        }
+    }
+
+    /// Streams every chunk in file order as visit(const RecordSpan&), decoding into one
+    /// reused buffer, so memory stays at one chunk regardless of file size. Prefer this
+    /// (or forEachRecord) over readAll() for whole-file passes.
+    template <class Visit>
+    void forEachChunk(Visit&& visit) const {
+        std::vector<DiskEventRecord> scratch;
+        for (uint32_t i = 0; i < chunkCount(); ++i) visit(chunkRecords(i, scratch));
+    }
+
+    /// As forEachChunk, restricted to chunks overlapping [ts_start, ts_end]
+    /// (chunk granularity, like readRange).
+    template <class Visit>
+    void forEachChunkInRange(uint64_t ts_start, uint64_t ts_end, Visit&& visit) const {
+        std::vector<DiskEventRecord> scratch;
+        for (uint32_t i = 0; i < chunkCount(); ++i) {
+            if (index_[i].first_ts_ns <= ts_end && index_[i].last_ts_ns >= ts_start)
+                visit(chunkRecords(i, scratch));
+        }
+    }
+
+    /// Streams every record in file order as visit(const DiskEventRecord&).
+    template <class Visit>
+    void forEachRecord(Visit&& visit) const {
+        forEachChunk([&visit](const RecordSpan& chunk) {
+            for (const DiskEventRecord& rec : chunk) visit(rec);
+        });
+    }
+
+    /// forEachChunk with decompression on pool. Chunks are visited in file order on
+    /// the calling thread while the next `window` chunks (default 2 x pool size) are
+    /// decoded ahead, so memory stays at 2 x window chunks. The first decode or visit
+    /// exception is rethrown once in-flight tasks have drained. Must not be called from
+    /// a task running on pool.
+    void forEachChunk(WorkStealingPool& pool, const std::function<void(const RecordSpan&)>& visit,
+                      size_t window = 0) const;
+
+    /// Book checkpoints in record order (BinaryFileSinkOptions::checkpoint_interval);
+    /// empty if the file has none.
+    const std::vector<BookCheckpoint>& checkpoints() const { return checkpoints_; }
+    /// Latest checkpoint with ts_ns <= ts (binary search), or nullptr if there is none:
+    /// replay from the opening book instead.
+    const BookCheckpoint* checkpointAtOrBefore(uint64_t ts) const;
+
+    /// OHLC bar series in ascending interval (BinaryFileSinkOptions::bar_seconds);
+    /// empty if the file has none.
+    const std::vector<BarSeries>& bars() const { return bars_; }
+    /// The series with exactly this interval, or nullptr.
+    const BarSeries* barsAt(uint64_t interval_ns) const;
+
+    /// Per-chunk statistics in index order (BinaryFileSinkOptions::stats); empty if
+    /// the file has none.
+    const std::vector<ChunkStats>& chunkStats() const { return chunk_stats_; }
+    bool hasStats() const { return !chunk_stats_.empty(); }
+    /// chunkStats() summed over the file, without decoding any chunk. Throws
+    /// std::runtime_error if the file has no stats block.
+    LogStats stats() const;
+
+    /// Streams the records from record number first_record (0-based, file order) to the
+    /// end as visit(const DiskEventRecord&). Decoding starts at the chunk holding it, so
+    /// resuming from a checkpoint costs at most one chunk of skipped records.
+    template <class Visit>
+    void forEachRecordFrom(uint64_t first_record, Visit&& visit) const {
+        forEachRecordBetween(first_record, std::numeric_limits<uint64_t>::max(),
+                             std::forward<Visit>(visit));
+    }
+
+    /// As forEachRecordFrom, stopping before record number end_record: the records
+    /// [first_record, end_record) in file order. Chunks past end_record are not decoded.
+    template <class Visit>
+    void forEachRecordBetween(uint64_t first_record, uint64_t end_record, Visit&& visit) const {
+        std::vector<DiskEventRecord> scratch;
+        uint64_t skip = 0;
+        uint64_t record = first_record;
+        for (uint32_t i = chunkOfRecord(first_record, skip); i < chunkCount() && record < end_record;
+             ++i, skip = 0) {
+            const RecordSpan chunk = chunkRecords(i, scratch);
+            for (size_t k = static_cast<size_t>(skip); k < chunk.size && record < end_record; ++k, ++record)
+                visit(chunk[k]);
+        }
+    }
+
     /// Read and decompress all chunks whose timestamp ranges overlap [ts_start, ts_end].
     /// Records outside the range may be included (filtering is at chunk granularity).
     std::vector<DiskEventRecord> readRange(uint64_t ts_start, uint64_t ts_end) const;
 
-    /// Read and decompress all records sequentially. Convenience method for small files.
+    /// Exactly the records with ts in [q.ts_start, q.ts_end] and price in
+    /// [q.price_min, q.price_max], in file order. Chunks are located by binary search
+    /// on the index; with a seek index, chunks whose price range cannot match are not
+    /// decoded, and the ts samples narrow the in-chunk search to one stride.
+    std::vector<DiskEventRecord> select(const RecordQuery& q) const;
+
+    /// Streams the records select(q) would return as visit(const DiskEventRecord&),
+    /// one decoded chunk at a time.
+    template <class Visit>
+    void forEachMatch(const RecordQuery& q, Visit&& visit) const {
+        std::vector<DiskEventRecord> scratch;
+        for (uint32_t i = firstChunkAtOrAfter(q.ts_start); i < chunkCount(); ++i) {
+            if (index_[i].first_ts_ns > q.ts_end) break;
+            if (!chunkMayMatchPrice(i, q)) continue;
+            for (const DiskEventRecord& rec : matchTsWindow(i, q, scratch)) {
+                const int32_t price = rec.price_ticks;
+                if (price >= q.price_min && price <= q.price_max) visit(rec);
+            }
+        }
+    }
+
+    /// True if the file carries a seek index (BinaryFileSinkOptions::seek_stride).
+    bool hasSeekIndex() const { return seek_stride_ > 0; }
+    uint32_t seekStride() const { return seek_stride_; }
+    /// Price range and first ts sample of chunk idx. Requires hasSeekIndex().
+    const ChunkSeekStats& chunkSeekStats(uint32_t idx) const { return seek_stats_.at(idx); }
+
+    /// Read and decompress all records into one vector. Convenience method for small
+    /// files; holds the whole file in memory.
     std::vector<DiskEventRecord> readAll() const;
 
+    /// readAll with chunks decompressed in parallel on pool, each straight into its
+    /// slot of the result (same order and contents as readAll()).
+    std::vector<DiskEventRecord> readAll(WorkStealingPool& pool) const;
+
     /// Returns the chunk index entries (useful for inspection/debugging).
     const std::vector<IndexEntry>& index() const { return index_; }
 
+    /// File offset just past chunk idx's payload.
+    /// Throws std::out_of_range if idx >= chunkCount().
+    uint64_t chunkEndOffset(uint32_t idx) const;
+
+    /// True if the file was finished with a CRC-32C per chunk in its footer
+    /// (kHeaderFlagChunkChecksums); older and unfinished files have none.
+    bool hasChecksums() const;
+    /// CRC-32C of chunk idx's header and payload as stored, the value
+    /// index()[idx].checksum must hold. Throws std::out_of_range if idx >= chunkCount().
+    uint32_t chunkChecksum(uint32_t idx) const;
+    /// Checks every chunk against the index (see VerifyMode) and returns the records
+    /// counted. Throws std::runtime_error naming the first chunk that fails.
+    uint64_t verify(VerifyMode mode) const;
+
+    /// Payload of the zstd dictionary block (empty if the file has none).
+    std::vector<char> dictionary() const;
+
 private:
     /// Build the chunk index. Prefers the footer index if HAS_INDEX is set,
-    /// otherwise scans chunk headers sequentially from offset 64.
-    void buildIndex();
+    /// otherwise scans chunk headers sequentially from offset 64 (or from the end of
+    /// what path's sidecar index covers).
+    void buildIndex(const std::string& path);
 
     /// Build index by reading the footer (fast path).
     void buildIndexFromFooter();
 
     /// Build index by scanning chunk headers from the start (slow path / crash recovery).
-    void buildIndexByScanning();
+    /// Stops at the first chunk that is cut short or not a chunk header: the torn tail
+    /// a crash leaves behind.
+    void buildIndexByScanning(const std::string& path);
+
+    /// Loads path's sidecar index (none if path is empty) if it describes a prefix of this file and returns
+    /// the offset its data ends at; otherwise leaves the index empty and returns the
+    /// first chunk offset.
+    uint64_t loadSidecar(const std::string& path);
+
+    /// Validates the chunk at file_offset and returns its header and payload.
+    const char* chunkPayloadAt(uint64_t file_offset, ChunkHeader& chdr) const;
+
+    /// Decodes the chunk of entry into out[0, entry.record_count); out must have room.
+    /// Throws if the chunk header disagrees with the index entry.
+    void decodeChunk(const IndexEntry& entry, DiskEventRecord* out) const;
+
+    /// Loads the metadata blocks between the last chunk and data_end, if any.
+    void findTrailingBlocks(uint64_t data_end);
+    /// Parses a seek index, checkpoint or bar block at offset (other metadata is ignored).
+    /// Throws if it is malformed or does not match the chunk index.
+    void loadMetadataBlock(uint64_t offset, const ChunkHeader& chdr);
+    void loadSeekIndex(const char* payload, uint32_t size);
+    void loadCheckpoints(const char* payload, uint32_t size);
+    void loadBars(const char* payload, uint32_t size);
+    void loadStats(const char* payload, uint32_t size);
+
+    /// Chunk holding record number record (chunkCount() if past the end); skip is set
+    /// to the record's position within that chunk.
+    uint32_t chunkOfRecord(uint64_t record, uint64_t& skip) const;
+
+    /// First chunk whose last_ts_ns >= ts (binary search; chunkCount() if none).
+    uint32_t firstChunkAtOrAfter(uint64_t ts) const;
+    bool chunkMayMatchPrice(uint32_t idx, const RecordQuery& q) const;
+    /// Records of chunk idx with ts in [q.ts_start, q.ts_end] (decoded into scratch
+    /// unless the chunk is raw).
+    RecordSpan matchTsWindow(uint32_t idx, const RecordQuery& q,
+                             std::vector<DiskEventRecord>& scratch) const;
+
+    /// Loads the zstd dictionary block, if one follows the header, into decoder_.
+    /// Returns the offset of the first chunk.
+    uint64_t loadDictionary();
+
+    /// The log's bytes: the whole mapping, or one session's slice of it.
+    struct Bytes {
+        const char* ptr = nullptr;
+        size_t len = 0;
+        const char* data() const { return ptr; }
+        size_t size() const { return len; }
+    };
 
-    /// Read and decompress the chunk at the given file offset.
-    std::vector<DiskEventRecord> decompressChunkAt(uint64_t file_offset) const;
+    /// Validates the file header and builds the index; sidecar_path may be empty.
+    void open(const std::string& name, const std::string& sidecar_path);
 
-    std::FILE* file_ = nullptr;
+    std::shared_ptr<const MappedFile> mapping_;
+    Bytes file_;
     FileHeader header_{};
+    ChunkDecompressor decoder_;
+    uint64_t first_chunk_offset_ = sizeof(FileHeader);
+    uint32_t seek_stride_ = 0;
+    std::vector<ChunkSeekStats> seek_stats_;
+    std::vector<uint64_t> seek_samples_;
+    std::vector<BookCheckpoint> checkpoints_;
+    std::vector<BarSeries> bars_;
+    std::vector<ChunkStats> chunk_stats_;
     std::vector<IndexEntry> index_;
+    std::vector<uint64_t> chunk_first_record_;  // prefix sums of index_ record counts
 };
 
 }  // namespace qrsdp
@@ -0,0 +1,243 @@
+#include "io/frame_ring.h"
+
+#include <cstring>
+#include <new>
+#include <stdexcept>
+
+#ifdef _WIN32
+    #ifndef WIN32_LEAN_AND_MEAN
+    #define WIN32_LEAN_AND_MEAN
+    #endif
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+namespace qrsdp {
+
+namespace {
+
+constexpr uint64_t kNoSticky = UINT64_MAX;
+constexpr size_t kMinCapacity = 4096;
+
+size_t recordBytes(size_t payload) {
+    return (sizeof(FrameRingRecord) + payload + 7) & ~static_cast<size_t>(7);
+}
+
+}  // namespace
+
+#ifdef _WIN32
+
+SharedMapping::SharedMapping(const std::string& path, size_t size, bool create) {
+    const DWORD access = create ? GENERIC_READ | GENERIC_WRITE : GENERIC_READ;
+    HANDLE file = CreateFileA(path.c_str(), access,
+                              FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr,
+                              create ? CREATE_ALWAYS : OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        throw std::runtime_error("SharedMapping: cannot open " + path);
+    file_handle_ = file;
+    if (!create) {
+        LARGE_INTEGER st{};
+        if (!GetFileSizeEx(file, &st)) {
+            CloseHandle(file);
+            throw std::runtime_error("SharedMapping: cannot stat " + path);
+        }
+        size = static_cast<size_t>(st.QuadPart);
+    }
+    size_ = size;
+    if (size_ == 0) {
+        CloseHandle(file);
+        throw std::runtime_error("SharedMapping: empty file " + path);
+    }
+    const uint64_t size64 = size_;
+    HANDLE mapping = CreateFileMappingA(file, nullptr, create ? PAGE_READWRITE : PAGE_READONLY,
+                                        static_cast<DWORD>(size64 >> 32),
+                                        static_cast<DWORD>(size64 & 0xFFFFFFFFu), nullptr);
+    if (!mapping) {
+        CloseHandle(file);
+        throw std::runtime_error("SharedMapping: cannot map " + path);
+    }
+    mapping_handle_ = mapping;
+    data_ = static_cast<char*>(MapViewOfFile(mapping, create ? FILE_MAP_ALL_ACCESS : FILE_MAP_READ,
+                                             0, 0, 0));
+    if (!data_) {
+        CloseHandle(mapping);
+        CloseHandle(file);
+        throw std::runtime_error("SharedMapping: cannot map " + path);
+    }
+}
+
+SharedMapping::~SharedMapping() {
+    if (data_) UnmapViewOfFile(data_);
+    if (mapping_handle_) CloseHandle(static_cast<HANDLE>(mapping_handle_));
+    if (file_handle_) CloseHandle(static_cast<HANDLE>(file_handle_));
+}
+
+#else
+
+SharedMapping::SharedMapping(const std::string& path, size_t size, bool create) {
+    const int fd = create ? ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644)
+                          : ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        throw std::runtime_error("SharedMapping: cannot open " + path);
+    if (create) {
+        if (::ftruncate(fd, static_cast<off_t>(size)) != 0) {
+            ::close(fd);
+            throw std::runtime_error("SharedMapping: cannot size " + path);
+        }
+    } else {
+        struct stat st{};
+        if (::fstat(fd, &st) != 0) {
+            ::close(fd);
+            throw std::runtime_error("SharedMapping: cannot stat " + path);
+        }
+        size = static_cast<size_t>(st.st_size);
+    }
+    size_ = size;
+    if (size_ == 0) {
+        ::close(fd);
+        throw std::runtime_error("SharedMapping: empty file " + path);
+    }
+    void* p = ::mmap(nullptr, size_, create ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);  // the mapping keeps the file alive
+    if (p == MAP_FAILED)
+        throw std::runtime_error("SharedMapping: cannot map " + path);
+    data_ = static_cast<char*>(p);
+}
+
+SharedMapping::~SharedMapping() {
+    if (data_) ::munmap(data_, size_);
+}
+
+#endif
+
+// ---------------------------------------------------------------------------
+// Writer
+// ---------------------------------------------------------------------------
+
+static size_t ringCapacity(size_t requested) {
+    size_t cap = kMinCapacity;
+    while (cap < requested) cap <<= 1;
+    return cap;
+}
+
+FrameRingWriter::FrameRingWriter(const std::string& path, size_t capacity)
+    : map_(path, sizeof(FrameRingHeader) + ringCapacity(capacity), true),
+      header_(new (map_.data()) FrameRingHeader{}),
+      ring_(map_.data() + sizeof(FrameRingHeader)),
+      capacity_(ringCapacity(capacity)) {
+    header_->version = 1;
+    header_->capacity = capacity_;
+    header_->write_pos.store(0, std::memory_order_relaxed);
+    header_->reserve_pos.store(0, std::memory_order_relaxed);
+    header_->sticky_pos.store(kNoSticky, std::memory_order_relaxed);
+    header_->closed.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    header_->magic = kFrameRingMagic;  // last: a reader that sees it sees the rest
+}
+
+FrameRingWriter::~FrameRingWriter() { close(); }
+
+void FrameRingWriter::publish(FrameRingKind kind, const void* data, size_t size, bool sticky) {
+    if (size > maxPayload(capacity_))
+        throw std::invalid_argument("FrameRingWriter: message larger than a quarter of the ring");
+    const size_t need = recordBytes(size);
+    const size_t off = static_cast<size_t>(pos_ & (capacity_ - 1));
+    const uint64_t start = off + need > capacity_ ? pos_ + (capacity_ - off) : pos_;
+    const uint64_t end = start + need;
+
+    // Readers check reserve_pos after copying: announcing the bytes about to be
+    // overwritten first lets them detect a message that changed under them.
+    header_->reserve_pos.store(end, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    if (start != pos_) {
+        const FrameRingRecord wrap{0, kRingWrap, 0};
+        std::memcpy(ring_ + off, &wrap, sizeof(wrap));
+    }
+    char* p = ring_ + (start & (capacity_ - 1));
+    const FrameRingRecord rec{static_cast<uint32_t>(size), kind, 0};
+    std::memcpy(p, &rec, sizeof(rec));
+    if (size > 0) std::memcpy(p + sizeof(rec), data, size);
+
+    if (sticky) header_->sticky_pos.store(start, std::memory_order_relaxed);
+    header_->write_pos.store(end, std::memory_order_release);
+    pos_ = end;
+    ++messages_;
+}
+
+void FrameRingWriter::close() {
+    header_->closed.store(1, std::memory_order_release);
+}
+
+// ---------------------------------------------------------------------------
+// Reader
+// ---------------------------------------------------------------------------
+
+FrameRingReader::FrameRingReader(const std::string& path, bool from_oldest)
+    : map_(path, 0, false),
+      header_(reinterpret_cast<const FrameRingHeader*>(map_.data())),
+      ring_(map_.data() + sizeof(FrameRingHeader)) {
+    if (map_.size() < sizeof(FrameRingHeader) || header_->magic != kFrameRingMagic)
+        throw std::runtime_error("FrameRingReader: not a frame ring: " + path);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    capacity_ = static_cast<size_t>(header_->capacity);
+    if (capacity_ < kMinCapacity || (capacity_ & (capacity_ - 1)) != 0 ||
+        map_.size() != sizeof(FrameRingHeader) + capacity_)
+        throw std::runtime_error("FrameRingReader: bad ring size: " + path);
+
+    pos_ = header_->write_pos.load(std::memory_order_acquire);
+    if (from_oldest && pos_ <= capacity_) {
+        pos_ = 0;
+        sticky_ = kNoSticky;
+        return;
+    }
+    const uint64_t s = header_->sticky_pos.load(std::memory_order_acquire);
+    // A sticky message at or past pos_ arrives in order anyway.
+    sticky_ = s != kNoSticky && s < pos_ && pos_ - s <= capacity_ ? s : kNoSticky;
+}
+
+bool FrameRingReader::readAt(uint64_t pos, FrameRingKind& kind, std::vector<char>& payload,
+                             uint64_t& next) {
+    const size_t off = static_cast<size_t>(pos & (capacity_ - 1));
+    FrameRingRecord rec;
+    std::memcpy(&rec, ring_ + off, sizeof(rec));
+    if (rec.kind == kRingWrap) {
+        next = pos + (capacity_ - off);
+    } else {
+        if (rec.size > FrameRingWriter::maxPayload(capacity_)) return false;
+        payload.assign(ring_ + off + sizeof(rec), ring_ + off + sizeof(rec) + rec.size);
+        next = pos + recordBytes(rec.size);
+    }
+    kind = static_cast<FrameRingKind>(rec.kind);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return header_->reserve_pos.load(std::memory_order_relaxed) - pos <= capacity_;
+}
+
+FrameRingReader::Poll FrameRingReader::poll(FrameRingKind& kind, std::vector<char>& payload) {
+    if (sticky_ != kNoSticky) {
+        const uint64_t s = sticky_;
+        sticky_ = kNoSticky;
+        uint64_t next;
+        if (readAt(s, kind, payload, next) && kind != kRingWrap) return Poll::Message;
+    }
+    for (;;) {
+        const bool closed = header_->closed.load(std::memory_order_acquire) != 0;
+        const uint64_t w = header_->write_pos.load(std::memory_order_acquire);
+        if (pos_ == w) return closed ? Poll::Closed : Poll::Empty;
+        uint64_t next;
+        if (w - pos_ > capacity_ || !readAt(pos_, kind, payload, next)) {
+            // Overtaken: resume at the newest message.
+            ++dropped_;
+            pos_ = header_->write_pos.load(std::memory_order_acquire);
+            continue;
+        }
+        pos_ = next;
+        if (kind != kRingWrap) return Poll::Message;
+    }
+}
+
+}  // namespace qrsdp
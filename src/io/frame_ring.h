@@ -0,0 +1,166 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace qrsdp {
+
+// ---------------------------------------------------------------------------
+// FrameRing: a broadcast ring of variable-size messages in a memory-mapped file
+// (on Linux put it under /dev/shm for plain shared memory). One writer process
+// publishes; any number of readers in other processes attach and follow it.
+// Readers never block the writer: one that falls a full ring behind skips to
+// the newest message and counts the loss, which suits live displays.
+//
+// File layout: FrameRingHeader (64 bytes), then `capacity` data bytes (a power
+// of two). Each message starts on an 8-byte boundary with a FrameRingRecord
+// and its payload; a record of kind kRingWrap pads the rest of a lap.
+// ---------------------------------------------------------------------------
+
+constexpr uint32_t kFrameRingMagic = 0x31524651;  // "QFR1"
+
+/// Message kinds. Payloads are little-endian packed structs.
+enum FrameRingKind : uint16_t {
+    kRingWrap = 0,       // no payload: continue at the start of the data area
+    kRingBookFrame = 1,  // a book frame (io/book_frame.h)
+    kRingDayStart = 2,   // LiveDayStart
+    kRingDayEnd = 3,     // LiveDayEnd
+    kRingEvents = 4,     // an event bus batch (io/shm_ring_sink.h)
+};
+
+#pragma pack(push, 1)
+struct FrameRingRecord {
+    uint32_t size;      // payload bytes
+    uint16_t kind;      // FrameRingKind
+    uint16_t reserved;
+};
+
+/// Published before a day's first book frame.
+struct LiveDayStart {
+    uint32_t day_index;       // 0-based
+    uint32_t num_days;        // 0 = continuous run
+    uint64_t market_open_ns;
+    int32_t  open_ticks;
+    uint32_t tick_size;
+    char     date[12];        // "YYYY-MM-DD", NUL-padded
+    char     symbol[12];      // "" for single-security runs
+};
+
+/// Published after a day's last book frame.
+struct LiveDayEnd {
+    uint32_t day_index;
+    int32_t  close_ticks;
+    uint64_t events;
+};
+#pragma pack(pop)
+
+static_assert(sizeof(FrameRingRecord) == 8, "FrameRingRecord must be 8 bytes");
+static_assert(sizeof(LiveDayStart) == 48, "LiveDayStart must be 48 bytes");
+static_assert(sizeof(LiveDayEnd) == 16, "LiveDayEnd must be 16 bytes");
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "FrameRing needs lock-free 64-bit atomics");
+
+struct FrameRingHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t capacity;                 // data bytes
+    std::atomic<uint64_t> write_pos;   // end of the last complete message
+    std::atomic<uint64_t> reserve_pos; // end of the message being written
+    std::atomic<uint64_t> sticky_pos;  // start of the last sticky message (UINT64_MAX: none)
+    std::atomic<uint32_t> closed;      // set once the writer has finished
+    uint32_t reserved[5];
+};
+static_assert(sizeof(FrameRingHeader) == 64, "FrameRingHeader must be 64 bytes");
+
+/// Shared mapping of a ring file: read-write for the writer, read-only for readers.
+class SharedMapping {
+public:
+    /// create: makes (or truncates) the file at size bytes and maps it writable;
+    /// otherwise maps an existing file read-only. Throws std::runtime_error on failure.
+    SharedMapping(const std::string& path, size_t size, bool create);
+    ~SharedMapping();
+
+    SharedMapping(const SharedMapping&) = delete;
+    SharedMapping& operator=(const SharedMapping&) = delete;
+
+    char* data() const { return data_; }
+    size_t size() const { return size_; }
+
+private:
+    char* data_ = nullptr;
+    size_t size_ = 0;
+#ifdef _WIN32
+    void* file_handle_ = nullptr;
+    void* mapping_handle_ = nullptr;
+#endif
+};
+
+class FrameRingWriter {
+public:
+    /// Largest payload: a quarter of the ring, so a reader copying one message
+    /// can tell when the writer has come round to it.
+    static size_t maxPayload(size_t capacity) { return capacity / 4 - sizeof(FrameRingRecord); }
+
+    /// Creates the ring file with at least capacity data bytes (rounded up to a
+    /// power of two, minimum 4 KiB). Throws std::runtime_error if it cannot.
+    FrameRingWriter(const std::string& path, size_t capacity);
+    /// Marks the ring closed (readers drain it, then see the end).
+    ~FrameRingWriter();
+
+    FrameRingWriter(const FrameRingWriter&) = delete;
+    FrameRingWriter& operator=(const FrameRingWriter&) = delete;
+
+    /// Appends one message. A sticky message is also what a reader that
+    /// attaches later receives first (e.g. the current day's LiveDayStart).
+    /// Throws std::invalid_argument if size exceeds maxPayload().
+    void publish(FrameRingKind kind, const void* data, size_t size, bool sticky = false);
+
+    /// Marks the end of the stream. Idempotent.
+    void close();
+
+    size_t capacity() const { return capacity_; }
+    uint64_t messages() const { return messages_; }
+
+private:
+    SharedMapping map_;
+    FrameRingHeader* header_;
+    char* ring_;
+    size_t capacity_;
+    uint64_t pos_ = 0;
+    uint64_t messages_ = 0;
+};
+
+class FrameRingReader {
+public:
+    enum class Poll { Message, Empty, Closed };
+
+    /// Attaches to a ring some writer created. The first message is the latest
+    /// sticky one, if the ring still holds it; after that, messages published
+    /// from the moment of attaching. from_oldest instead starts at the first
+    /// message ever published while the ring has not wrapped yet.
+    /// Throws std::runtime_error if path is not a ring.
+    explicit FrameRingReader(const std::string& path, bool from_oldest = false);
+
+    /// Copies the next message into payload and sets kind. Empty: nothing new
+    /// yet; Closed: the writer has finished and everything has been read.
+    Poll poll(FrameRingKind& kind, std::vector<char>& payload);
+
+    /// Times the writer overtook this reader and it skipped to the newest message.
+    uint64_t dropped() const { return dropped_; }
+
+private:
+    /// Copies the message at pos; false if the writer overwrote it meanwhile.
+    bool readAt(uint64_t pos, FrameRingKind& kind, std::vector<char>& payload, uint64_t& next);
+
+    SharedMapping map_;
+    const FrameRingHeader* header_;
+    const char* ring_;
+    size_t capacity_;
+    uint64_t pos_;
+    uint64_t sticky_;  // UINT64_MAX once handled
+    uint64_t dropped_ = 0;
+};
+
+}  // namespace qrsdp
@@ -0,0 +1,150 @@
+#include "io/hlr_curve_bundle.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+
+namespace qrsdp {
+
+namespace {
+
+std::string fixedString(const char* s, size_t max) {
+    return std::string(s, strnlen(s, max));
+}
+
+uint64_t alignUp(uint64_t offset) {
+    return (offset + kCurveBundleAlignment - 1) / kCurveBundleAlignment * kCurveBundleAlignment;
+}
+
+}  // namespace
+
+void writeHLRCurveBundle(const std::string& path,
+                         const std::vector<std::pair<std::string, HLRParams>>& curves) {
+    std::vector<size_t> order(curves.size());
+    for (size_t i = 0; i < order.size(); ++i) order[i] = i;
+    std::sort(order.begin(), order.end(),
+              [&](size_t a, size_t b) { return curves[a].first < curves[b].first; });
+
+    std::vector<HLRCurveTable> tables;
+    std::vector<CurveBundleEntry> entries;
+    tables.reserve(curves.size());
+    entries.reserve(curves.size());
+    uint64_t end = sizeof(CurveBundleHeader) + curves.size() * sizeof(CurveBundleEntry);
+    for (size_t i : order) {
+        const std::string& symbol = curves[i].first;
+        const HLRParams& params = curves[i].second;
+        if (symbol.size() >= kCurveBundleSymbolBytes)
+            throw std::runtime_error("writeHLRCurveBundle: symbol too long: " + symbol);
+        if (!entries.empty() && fixedString(entries.back().symbol, kCurveBundleSymbolBytes) == symbol)
+            throw std::runtime_error("writeHLRCurveBundle: duplicate symbol " + symbol);
+        tables.emplace_back(params);
+        const HLRCurveTable& t = tables.back();
+        CurveBundleEntry e{};
+        std::memcpy(e.symbol, symbol.data(), symbol.size());
+        e.levels = static_cast<uint32_t>(t.levels());
+        e.row_length = static_cast<uint32_t>(t.rowLength());
+        e.row_stride = static_cast<uint32_t>(t.rowStride());
+        e.spread_sensitivity = params.spread_sensitivity;
+        e.imbalance_sensitivity = params.imbalance_sensitivity;
+        e.rows_offset = alignUp(end);
+        e.rows_bytes = t.rowCount() * t.rowStride() * sizeof(HLRCurveTable::Rates);
+        end = e.rows_offset + e.rows_bytes;
+        entries.push_back(e);
+    }
+
+    CurveBundleHeader hdr{};
+    std::memcpy(hdr.magic, kCurveBundleMagic, 8);
+    hdr.version_major = kCurveBundleVersionMajor;
+    hdr.version_minor = kCurveBundleVersionMinor;
+    hdr.symbol_count = static_cast<uint32_t>(entries.size());
+    hdr.directory_offset = sizeof(CurveBundleHeader);
+    hdr.file_size = end;
+
+    std::FILE* f = std::fopen(path.c_str(), "wb");
+    if (!f)
+        throw std::runtime_error("writeHLRCurveBundle: cannot open " + path);
+    bool ok = std::fwrite(&hdr, sizeof(hdr), 1, f) == 1;
+    if (!entries.empty())
+        ok = ok && std::fwrite(entries.data(), sizeof(CurveBundleEntry), entries.size(), f) == entries.size();
+    uint64_t pos = sizeof(CurveBundleHeader) + entries.size() * sizeof(CurveBundleEntry);
+    static const char kZeros[kCurveBundleAlignment] = {};
+    for (size_t i = 0; ok && i < entries.size(); ++i) {
+        const size_t pad = static_cast<size_t>(entries[i].rows_offset - pos);
+        ok = (pad == 0 || std::fwrite(kZeros, 1, pad, f) == pad)
+            && std::fwrite(tables[i].rowData(), 1, static_cast<size_t>(entries[i].rows_bytes), f)
+                   == entries[i].rows_bytes;
+        pos = entries[i].rows_offset + entries[i].rows_bytes;
+    }
+    ok = (std::fclose(f) == 0) && ok;
+    if (!ok)
+        throw std::runtime_error("writeHLRCurveBundle: write failed for " + path);
+}
+
+HLRCurveBundle::HLRCurveBundle(const std::string& path)
+    : mapping_(std::make_shared<const MappedFile>(path)) {
+    const char* data = mapping_->data();
+    const size_t size = mapping_->size();
+    CurveBundleHeader hdr{};
+    if (size < sizeof(hdr))
+        throw std::runtime_error("HLRCurveBundle: " + path + " is too short");
+    std::memcpy(&hdr, data, sizeof(hdr));
+    if (std::memcmp(hdr.magic, kCurveBundleMagic, 8) != 0)
+        throw std::runtime_error("HLRCurveBundle: invalid magic in " + path);
+    if (hdr.version_major != kCurveBundleVersionMajor)
+        throw std::runtime_error("HLRCurveBundle: unsupported version in " + path);
+    const uint64_t dir_bytes = static_cast<uint64_t>(hdr.symbol_count) * sizeof(CurveBundleEntry);
+    if (hdr.file_size != size || hdr.directory_offset < sizeof(hdr)
+        || hdr.directory_offset > size || dir_bytes > size - hdr.directory_offset)
+        throw std::runtime_error("HLRCurveBundle: invalid or truncated directory in " + path);
+
+    std::vector<CurveBundleEntry> entries(hdr.symbol_count);
+    if (!entries.empty())
+        std::memcpy(entries.data(), data + hdr.directory_offset, static_cast<size_t>(dir_bytes));
+    symbols_.reserve(entries.size());
+    for (const CurveBundleEntry& e : entries) {
+        const uint64_t rows = 2 * static_cast<uint64_t>(e.levels) + 2;
+        // Views index [0, row_length) of each row, and HLRCurveTable needs whole
+        // aligned cache lines: the mapping itself is page aligned.
+        if (e.row_length == 0 || e.row_stride < e.row_length || e.row_stride % 4 != 0
+            || e.rows_offset % kCurveBundleAlignment != 0
+            || e.rows_bytes != rows * e.row_stride * sizeof(HLRCurveTable::Rates)
+            || e.rows_offset < hdr.directory_offset + dir_bytes
+            || e.rows_offset > size || e.rows_bytes > size - e.rows_offset)
+            throw std::runtime_error("HLRCurveBundle: invalid directory entry in " + path);
+        CurveBundleSymbol s;
+        s.symbol = fixedString(e.symbol, kCurveBundleSymbolBytes);
+        if (!symbols_.empty() && !(symbols_.back().symbol < s.symbol))
+            throw std::runtime_error("HLRCurveBundle: directory not sorted in " + path);
+        s.levels = e.levels;
+        s.spread_sensitivity = e.spread_sensitivity;
+        s.imbalance_sensitivity = e.imbalance_sensitivity;
+        s.rows = reinterpret_cast<const HLRCurveTable::Rates*>(data + e.rows_offset);
+        s.row_length = e.row_length;
+        s.row_stride = e.row_stride;
+        symbols_.push_back(std::move(s));
+    }
+}
+
+const CurveBundleSymbol* HLRCurveBundle::find(const std::string& symbol) const {
+    const auto it = std::lower_bound(
+        symbols_.begin(), symbols_.end(), symbol,
+        [](const CurveBundleSymbol& s, const std::string& key) { return s.symbol < key; });
+    return (it != symbols_.end() && it->symbol == symbol) ? &*it : nullptr;
+}
+
+HLRCurveTable HLRCurveBundle::table(const CurveBundleSymbol& entry) const {
+    return HLRCurveTable::view(entry.rows, entry.levels, entry.row_length, entry.row_stride, mapping_);
+}
+
+bool isHLRCurveBundle(const std::string& path) {
+    std::FILE* f = std::fopen(path.c_str(), "rb");
+    if (!f)
+        return false;
+    char magic[8] = {};
+    const bool read = std::fread(magic, 1, sizeof(magic), f) == sizeof(magic);
+    std::fclose(f);
+    return read && std::memcmp(magic, kCurveBundleMagic, 8) == 0;
+}
+
+}  // namespace qrsdp
@@ -0,0 +1,100 @@
+#pragma once
+
+#include "io/mapped_file.h"
+#include "model/hlr_curve_table.h"
+#include "model/hlr_params.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace qrsdp {
+
+// --- HLR curve bundle (.qrhc) ---
+/// Calibrated curves for many symbols in one file, stored as ready-made
+/// HLRCurveTable rows so that a reader maps the file and hands out views: no
+/// parsing, no per-model copies. A 64-byte header, a directory of one
+/// CurveBundleEntry per symbol sorted by symbol, then each symbol's rows
+/// (HLRCurveTable::rowData() layout, 64-byte aligned). Doubles and integers are
+/// little-endian, as in the .qrsdp format.
+constexpr char     kCurveBundleMagic[8] = {'Q','R','S','D','P','H','L','R'};
+constexpr uint16_t kCurveBundleVersionMajor = 1;
+constexpr uint16_t kCurveBundleVersionMinor = 0;
+constexpr size_t   kCurveBundleSymbolBytes = 16;
+constexpr size_t   kCurveBundleAlignment = 64;
+
+#pragma pack(push, 1)
+struct CurveBundleHeader {
+    char     magic[8];
+    uint16_t version_major;
+    uint16_t version_minor;
+    uint32_t symbol_count;
+    uint64_t directory_offset;  // the first CurveBundleEntry
+    uint64_t file_size;         // whole bundle, to catch truncation
+    uint64_t reserved[4];       // must be 0
+};
+#pragma pack(pop)
+static_assert(sizeof(CurveBundleHeader) == 64, "CurveBundleHeader must be 64 bytes");
+
+#pragma pack(push, 1)
+struct CurveBundleEntry {
+    char     symbol[kCurveBundleSymbolBytes];  // NUL-padded
+    uint32_t levels;            // K
+    uint32_t row_length;        // HLRCurveTable::rowLength()
+    uint32_t row_stride;        // HLRCurveTable::rowStride()
+    uint32_t reserved;          // must be 0
+    double   spread_sensitivity;
+    double   imbalance_sensitivity;
+    uint64_t rows_offset;       // absolute, 64-byte aligned
+    uint64_t rows_bytes;        // rowCount() * row_stride * sizeof(Rates)
+};
+#pragma pack(pop)
+static_assert(sizeof(CurveBundleEntry) == 64, "CurveBundleEntry must be 64 bytes");
+
+/// One symbol's curves: what a CurveIntensityModel needs besides the table.
+struct CurveBundleSymbol {
+    std::string symbol;
+    uint32_t levels = 0;
+    double spread_sensitivity = 0.0;
+    double imbalance_sensitivity = 0.0;
+    const HLRCurveTable::Rates* rows = nullptr;  // into the mapping
+    size_t row_length = 0;
+    size_t row_stride = 0;
+};
+
+/// Writes curves (symbol, params) as a bundle; seasonality is not stored. An
+/// empty symbol is the single-security run's. Throws std::runtime_error on a
+/// duplicate or too long symbol, or if the file cannot be written.
+void writeHLRCurveBundle(const std::string& path,
+                         const std::vector<std::pair<std::string, HLRParams>>& curves);
+
+/// Read side: maps the bundle once. Tables from table() are views of the mapping
+/// that keep it alive, so they may outlive the bundle and be read from any thread.
+class HLRCurveBundle {
+public:
+    /// Maps the file and checks the directory. Throws std::runtime_error if it is
+    /// not a bundle or an entry's rows fall outside it.
+    explicit HLRCurveBundle(const std::string& path);
+
+    /// Symbols sorted by name.
+    const std::vector<CurveBundleSymbol>& symbols() const { return symbols_; }
+    size_t size() const { return symbols_.size(); }
+
+    /// Entry for symbol by binary search, or nullptr.
+    const CurveBundleSymbol* find(const std::string& symbol) const;
+
+    /// The entry's curves, without copying them.
+    HLRCurveTable table(const CurveBundleSymbol& entry) const;
+
+private:
+    std::shared_ptr<const MappedFile> mapping_;
+    std::vector<CurveBundleSymbol> symbols_;
+};
+
+/// True if the file at path starts with the bundle magic.
+bool isHLRCurveBundle(const std::string& path);
+
+}  // namespace qrsdp
@@ -0,0 +1,196 @@
+#include "io/http_post.h"
+
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+
+#ifdef _WIN32
+    #ifndef WIN32_LEAN_AND_MEAN
+    #define WIN32_LEAN_AND_MEAN
+    #endif
+    #include <winsock2.h>
+    #include <ws2tcpip.h>
+    #pragma comment(lib, "ws2_32.lib")
+
+    namespace {
+    struct WinsockInit {
+        WinsockInit() {
+            WSADATA wsa;
+            WSAStartup(MAKEWORD(2, 2), &wsa);
+        }
+        ~WinsockInit() { WSACleanup(); }
+    };
+    static WinsockInit g_winsock_init;
+    }  // namespace
+
+    using socket_t = SOCKET;
+    constexpr socket_t kInvalidSocket = INVALID_SOCKET;
+    constexpr int kSendFlags = 0;
+    inline int closeSocket(socket_t s) { return closesocket(s); }
+#else
+    #include <netdb.h>
+    #include <netinet/in.h>
+    #include <netinet/tcp.h>
+    #include <sys/socket.h>
+    #include <unistd.h>
+
+    using socket_t = int;
+    constexpr socket_t kInvalidSocket = -1;
+    #ifdef MSG_NOSIGNAL
+    constexpr int kSendFlags = MSG_NOSIGNAL;  // a server that hangs up must not kill us
+    #else
+    constexpr int kSendFlags = 0;
+    #endif
+    inline int closeSocket(socket_t s) { return close(s); }
+#endif
+
+namespace qrsdp {
+
+namespace {
+
+constexpr size_t kMaxResponse = 1 << 20;
+
+}  // namespace
+
+HttpPost::HttpPost(const std::string& url, const std::vector<std::string>& headers)
+    : sock_(static_cast<decltype(sock_)>(kInvalidSocket)), target_(url) {
+    const std::string scheme = "http://";
+    if (url.compare(0, scheme.size(), scheme) != 0)
+        throw std::runtime_error("HttpPost: only http:// URLs are supported: " + url);
+    const size_t host_begin = scheme.size();
+    size_t path_begin = url.find_first_of("/?", host_begin);
+    const std::string authority = url.substr(host_begin, path_begin == std::string::npos
+                                                             ? std::string::npos : path_begin - host_begin);
+    std::string path = path_begin == std::string::npos ? "/" : url.substr(path_begin);
+    if (path[0] == '?') path.insert(0, "/");
+    std::string host = authority;
+    std::string port = "80";
+    const size_t colon = authority.rfind(':');
+    if (colon != std::string::npos) {
+        host = authority.substr(0, colon);
+        port = authority.substr(colon + 1);
+    }
+    if (host.empty()) throw std::runtime_error("HttpPost: no host in " + url);
+
+    struct addrinfo hints{}, *result = nullptr;
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    if (getaddrinfo(host.c_str(), port.c_str(), &hints, &result) != 0 || !result)
+        throw std::runtime_error("HttpPost: cannot resolve " + host);
+    socket_t sock = kInvalidSocket;
+    for (struct addrinfo* ai = result; ai; ai = ai->ai_next) {
+        sock = socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+        if (sock == kInvalidSocket) continue;
+        if (connect(sock, ai->ai_addr, static_cast<int>(ai->ai_addrlen)) == 0) break;
+        closeSocket(sock);
+        sock = kInvalidSocket;
+    }
+    freeaddrinfo(result);
+    if (sock == kInvalidSocket)
+        throw std::runtime_error("HttpPost: cannot connect to " + authority);
+    sock_ = static_cast<decltype(sock_)>(sock);
+    const int one = 1;
+    setsockopt(sock, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&one), sizeof(one));
+
+    std::string request = "POST " + path + " HTTP/1.1\r\n"
+                          "Host: " + authority + "\r\n"
+                          "Transfer-Encoding: chunked\r\n"
+                          "Content-Type: application/octet-stream\r\n"
+                          "Connection: close\r\n";
+    for (const std::string& h : headers) request += h + "\r\n";
+    request += "\r\n";
+    sendAll(request.data(), request.size());
+}
+
+HttpPost::~HttpPost() {
+    if (static_cast<socket_t>(sock_) != kInvalidSocket) closeSocket(static_cast<socket_t>(sock_));
+}
+
+void HttpPost::sendAll(const char* data, size_t size) {
+    size_t off = 0;
+    while (off < size) {
+        const auto n = send(static_cast<socket_t>(sock_), data + off, static_cast<int>(size - off), kSendFlags);
+        if (n <= 0) fail("connection closed while sending");
+        off += static_cast<size_t>(n);
+    }
+}
+
+void HttpPost::write(const char* data, size_t size) {
+    if (size == 0) return;
+    char head[24];
+    const int len = std::snprintf(head, sizeof(head), "%zx\r\n", size);
+    sendAll(head, static_cast<size_t>(len));
+    sendAll(data, size);
+    sendAll("\r\n", 2);
+    bytes_sent_ += size;
+}
+
+bool HttpPost::readResponse(std::string& status, std::string& body) {
+    std::string response;
+    char buf[4096];
+    while (response.size() < kMaxResponse) {
+        const auto n = recv(static_cast<socket_t>(sock_), buf, sizeof(buf), 0);
+        if (n <= 0) break;
+        response.append(buf, static_cast<size_t>(n));
+    }
+    const size_t line_end = response.find("\r\n");
+    status = response.substr(0, line_end);
+    const size_t header_end = response.find("\r\n\r\n");
+    body = header_end == std::string::npos ? "" : response.substr(header_end + 4);
+    if (response.find("Transfer-Encoding: chunked") < header_end) {
+        // Join the chunks; the sizes are hex lines.
+        std::string joined;
+        size_t pos = 0;
+        while (pos < body.size()) {
+            const size_t eol = body.find("\r\n", pos);
+            if (eol == std::string::npos) break;
+            const size_t n = std::strtoul(body.substr(pos, eol - pos).c_str(), nullptr, 16);
+            if (n == 0) break;
+            joined += body.substr(eol + 2, n);
+            pos = eol + 2 + n + 2;
+        }
+        body = joined;
+    }
+    while (!body.empty() && (body.back() == '\n' || body.back() == '\r')) body.pop_back();
+    // "HTTP/1.1 200 OK"
+    return status.size() >= 10 && status.compare(0, 5, "HTTP/") == 0 && status[status.find(' ') + 1] == '2';
+}
+
+void HttpPost::fail(const std::string& what) {
+    std::string status, body;
+    readResponse(status, body);
+    std::string msg = "HttpPost " + target_ + ": " + (status.empty() ? what : status);
+    if (!body.empty()) msg += ": " + body;
+    throw std::runtime_error(msg);
+}
+
+std::string HttpPost::finish() {
+    if (finished_) throw std::runtime_error("HttpPost: finish() called twice");
+    finished_ = true;
+    sendAll("0\r\n\r\n", 5);
+    std::string status, body;
+    if (!readResponse(status, body)) {
+        std::string msg = "HttpPost " + target_ + ": " + (status.empty() ? "no response" : status);
+        if (!body.empty()) msg += ": " + body;
+        throw std::runtime_error(msg);
+    }
+    return body;
+}
+
+std::string urlEncode(const std::string& s) {
+    static const char kHex[] = "0123456789ABCDEF";
+    std::string out;
+    for (unsigned char c : s) {
+        if ((c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') ||
+            c == '-' || c == '_' || c == '.' || c == '~') {
+            out += static_cast<char>(c);
+        } else {
+            out += '%';
+            out += kHex[c >> 4];
+            out += kHex[c & 15];
+        }
+    }
+    return out;
+}
+
+}  // namespace qrsdp
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace qrsdp {
+
+/// Streaming HTTP/1.1 POST with a chunked body, for bulk uploads whose size is
+/// not known up front (e.g. INSERTs through the ClickHouse HTTP interface).
+/// Plain http only; one request per connection.
+class HttpPost {
+public:
+    /// Connects to url ("http://host[:port][/path][?query]") and sends the
+    /// request headers plus any extra ones ("Name: value"). Throws
+    /// std::runtime_error if the URL is not http or the connection fails.
+    explicit HttpPost(const std::string& url, const std::vector<std::string>& headers = {});
+    ~HttpPost();
+
+    HttpPost(const HttpPost&) = delete;
+    HttpPost& operator=(const HttpPost&) = delete;
+
+    /// Sends one body chunk (nothing for size 0). Throws std::runtime_error,
+    /// with the server's answer if it sent one, when the connection breaks.
+    void write(const char* data, size_t size);
+
+    /// Ends the body and reads the response; returns its body. Throws
+    /// std::runtime_error with the status line and body unless the status is 2xx.
+    std::string finish();
+
+    uint64_t bytesSent() const { return bytes_sent_; }
+
+private:
+    void sendAll(const char* data, size_t size);
+    /// Reads the response to the end; true if the status is 2xx.
+    bool readResponse(std::string& status, std::string& body);
+    [[noreturn]] void fail(const std::string& what);
+
+#ifdef _WIN32
+    uintptr_t sock_;
+#else
+    int sock_;
+#endif
+    std::string target_;  // for messages
+    uint64_t bytes_sent_ = 0;
+    bool finished_ = false;
+};
+
+/// Percent-encodes s for use in a URL query string.
+std::string urlEncode(const std::string& s);
+
+}  // namespace qrsdp
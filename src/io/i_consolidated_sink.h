@@ -0,0 +1,19 @@
+#pragma once
+
+#include "core/records.h"
+#include <cstdint>
+
+namespace qrsdp {
+
+/// Output of a multi-security stream: events from several securities in one
+/// global timestamp order, each tagged with the index of the security that
+/// produced it. Implementations: ItchFeedWriter.
+class IConsolidatedSink {
+public:
+    virtual ~IConsolidatedSink() = default;
+    virtual void append(uint32_t security, const EventRecord&) = 0;
+    virtual void flush() {}
+    virtual void close() {}
+};
+
+}  // namespace qrsdp
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "core/records.h"
+#include <cstddef>
 
 namespace qrsdp {
 
@@ -10,6 +11,11 @@ class IEventSink {
 public:
     virtual ~IEventSink() = default;
     virtual void append(const EventRecord&) = 0;
+    /// Append n records in order. Default forwards to append(); sinks override it
+    /// to amortise per-record overhead (one virtual call / lock / poll per batch).
+    virtual void appendBatch(const EventRecord* recs, size_t n) {
+        for (size_t i = 0; i < n; ++i) append(recs[i]);
+    }
     virtual void flush() {}
     virtual void close() {}
 };
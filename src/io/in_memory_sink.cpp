@@ -3,7 +3,11 @@
 namespace qrsdp {
 
 void InMemorySink::append(const EventRecord& rec) {
-    events_.push_back(rec);
+    events_.append(rec);
+}
+
+void InMemorySink::appendBatch(const EventRecord* recs, size_t n) {
+    events_.append(recs, n);
 }
 
 }  // namespace qrsdp
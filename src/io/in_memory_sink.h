@@ -1,22 +1,33 @@
 #pragma once
 
 #include "io/i_event_sink.h"
+#include "io/segmented_event_store.h"
 #include "core/records.h"
 #include <cstddef>
-#include <vector>
+#include <cstdint>
 
 namespace qrsdp {
 
-/// In-memory event sink: append stores into a vector (v1; no file I/O).
-class InMemorySink : public IEventSink {
+/// In-memory event sink (no file I/O). Records go into a SegmentedEventStore:
+/// fixed-size blocks, so a long session grows without reallocating and copying
+/// what it already holds. With retain_last > 0 only the newest retain_last
+/// records are kept.
+class InMemorySink final : public IEventSink {
 public:
-    void append(const EventRecord&) override;
-    const std::vector<EventRecord>& events() const { return events_; }
+    explicit InMemorySink(size_t retain_last = 0,
+                          size_t block_records = SegmentedEventStore::kDefaultBlockRecords)
+        : events_(block_records, retain_last) {}
+
+    void append(const EventRecord& rec) override;
+    void appendBatch(const EventRecord* recs, size_t n) override;
+    const SegmentedEventStore& events() const { return events_; }
     size_t size() const { return events_.size(); }
+    /// Records ever appended, including any the retention window dropped.
+    uint64_t appended() const { return events_.appended(); }
     void clear() { events_.clear(); }
 
 private:
-    std::vector<EventRecord> events_;
+    SegmentedEventStore events_;
 };
 
 }  // namespace qrsdp
@@ -0,0 +1,483 @@
+#include "io/io_uring_writer.h"
+
+#include <stdexcept>
+
+#ifdef QRSDP_IO_URING_ENABLED
+
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <mutex>
+#include <new>
+#include <vector>
+
+namespace qrsdp {
+
+namespace {
+
+constexpr uint32_t kBlock = 4096;  // O_DIRECT alignment of buffers, offsets and lengths
+constexpr uint32_t kNoBuffer = UINT32_MAX;
+
+std::runtime_error ringError(const std::string& what, int err) {
+    return std::runtime_error("IoUringWriter: " + what + ": " + std::strerror(err));
+}
+
+int ioUringSetup(unsigned entries, io_uring_params* p) {
+    return static_cast<int>(syscall(__NR_io_uring_setup, entries, p));
+}
+
+int ioUringEnter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags) {
+    int rc;
+    do {
+        rc = static_cast<int>(syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, nullptr, 0));
+    } while (rc < 0 && errno == EINTR);
+    return rc;
+}
+
+}  // namespace
+
+/// The ring's mmap'd queues and the staging pool. Everything below the mutex is
+/// guarded by it, including each IoUringFile's pending_ and error_.
+struct IoUringWriter::Impl {
+    /// A write in flight; indexed by its buffer, which is also its user_data.
+    struct Op {
+        IoUringFile* file = nullptr;
+        uint64_t offset = 0;
+        uint32_t len = 0;
+        uint32_t done = 0;  // bytes already written (short writes are resubmitted)
+    };
+
+    IoUringOptions options;
+    int ring_fd = -1;
+    void* sq_map = nullptr;
+    size_t sq_map_len = 0;
+    void* cq_map = nullptr;
+    size_t cq_map_len = 0;
+    io_uring_sqe* sqes = nullptr;
+    size_t sqes_len = 0;
+    unsigned* sq_tail = nullptr;
+    unsigned* sq_mask = nullptr;
+    unsigned* sq_array = nullptr;
+    unsigned* cq_head = nullptr;
+    unsigned* cq_tail = nullptr;
+    unsigned* cq_mask = nullptr;
+    io_uring_cqe* cqes = nullptr;
+    char* pool = nullptr;
+    bool registered = false;
+
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool waiting = false;          // a thread is blocked in io_uring_enter
+    std::vector<Op> ops;
+    std::vector<uint32_t> free_buffers;
+    uint32_t in_flight = 0;
+    uint64_t submitted = 0;
+
+    ~Impl() {
+        if (sqes) munmap(sqes, sqes_len);
+        if (cq_map && cq_map != sq_map) munmap(cq_map, cq_map_len);
+        if (sq_map) munmap(sq_map, sq_map_len);
+        if (ring_fd >= 0) ::close(ring_fd);
+        std::free(pool);
+    }
+
+    char* buffer(uint32_t i) const { return pool + size_t{i} * options.buffer_bytes; }
+
+    void setUp() {
+        io_uring_params p{};
+        ring_fd = ioUringSetup(std::max<uint32_t>(options.queue_depth, 1), &p);
+        if (ring_fd < 0)
+            throw ringError("io_uring_setup", errno);
+
+        sq_map_len = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+        cq_map_len = p.cq_off.cqes + p.cq_entries * sizeof(io_uring_cqe);
+        if (p.features & IORING_FEAT_SINGLE_MMAP)
+            sq_map_len = cq_map_len = std::max(sq_map_len, cq_map_len);
+        sq_map = mmap(nullptr, sq_map_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd,
+                      IORING_OFF_SQ_RING);
+        if (sq_map == MAP_FAILED) {
+            sq_map = nullptr;
+            throw ringError("cannot map the submission ring", errno);
+        }
+        if (p.features & IORING_FEAT_SINGLE_MMAP) {
+            cq_map = sq_map;
+        } else {
+            cq_map = mmap(nullptr, cq_map_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd,
+                          IORING_OFF_CQ_RING);
+            if (cq_map == MAP_FAILED) {
+                cq_map = nullptr;
+                throw ringError("cannot map the completion ring", errno);
+            }
+        }
+        sqes_len = p.sq_entries * sizeof(io_uring_sqe);
+        void* sqe_map = mmap(nullptr, sqes_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd,
+                             IORING_OFF_SQES);
+        if (sqe_map == MAP_FAILED)
+            throw ringError("cannot map the submission entries", errno);
+        sqes = static_cast<io_uring_sqe*>(sqe_map);
+
+        char* sq = static_cast<char*>(sq_map);
+        sq_tail = reinterpret_cast<unsigned*>(sq + p.sq_off.tail);
+        sq_mask = reinterpret_cast<unsigned*>(sq + p.sq_off.ring_mask);
+        sq_array = reinterpret_cast<unsigned*>(sq + p.sq_off.array);
+        char* cq = static_cast<char*>(cq_map);
+        cq_head = reinterpret_cast<unsigned*>(cq + p.cq_off.head);
+        cq_tail = reinterpret_cast<unsigned*>(cq + p.cq_off.tail);
+        cq_mask = reinterpret_cast<unsigned*>(cq + p.cq_off.ring_mask);
+        cqes = reinterpret_cast<io_uring_cqe*>(cq + p.cq_off.cqes);
+
+        // Every buffer may be in flight at once; the completion ring must hold them all.
+        options.buffer_bytes = std::max(kBlock, (options.buffer_bytes + kBlock - 1) / kBlock * kBlock);
+        options.buffers = std::min(std::max<uint32_t>(options.buffers, 2), p.cq_entries);
+        pool = static_cast<char*>(std::aligned_alloc(kBlock, size_t{options.buffers} * options.buffer_bytes));
+        if (!pool)
+            throw std::bad_alloc();
+
+        if (options.register_buffers) {
+            std::vector<iovec> iov(options.buffers);
+            for (uint32_t i = 0; i < options.buffers; ++i)
+                iov[i] = iovec{buffer(i), options.buffer_bytes};
+            registered = syscall(__NR_io_uring_register, ring_fd, IORING_REGISTER_BUFFERS, iov.data(),
+                                 options.buffers) == 0;
+        }
+        ops.resize(options.buffers);
+        for (uint32_t i = options.buffers; i-- > 0;)
+            free_buffers.push_back(i);
+    }
+
+    /// Takes a free buffer for file, waiting for a write to finish if none is free.
+    uint32_t acquire(std::unique_lock<std::mutex>& lock, const IoUringFile& file) {
+        for (;;) {
+            if (file.error_ != 0)
+                throw ringError("write to " + file.path_ + " failed", file.error_);
+            if (!free_buffers.empty()) {
+                const uint32_t buf = free_buffers.back();
+                free_buffers.pop_back();
+                return buf;
+            }
+            if (in_flight == 0)
+                throw std::runtime_error("IoUringWriter: every staging buffer is held by an open file; "
+                                         "use more buffers than files");
+            waitForCompletion(lock);
+        }
+    }
+
+    void release(uint32_t buf) {
+        ops[buf] = Op{};
+        free_buffers.push_back(buf);
+    }
+
+    /// Queues ops[buf] (from its done bytes on) and submits it.
+    void submit(uint32_t buf, bool first) {
+        const Op& op = ops[buf];
+        const unsigned tail = *sq_tail;
+        const unsigned idx = tail & *sq_mask;
+        io_uring_sqe& sqe = sqes[idx];
+        std::memset(&sqe, 0, sizeof(sqe));
+        sqe.opcode = registered ? IORING_OP_WRITE_FIXED : IORING_OP_WRITE;
+        sqe.fd = op.file->fd_;
+        sqe.addr = reinterpret_cast<uint64_t>(buffer(buf) + op.done);
+        sqe.len = op.len - op.done;
+        sqe.off = op.offset + op.done;
+        if (registered)
+            sqe.buf_index = static_cast<uint16_t>(buf);
+        sqe.user_data = buf;
+        sq_array[idx] = idx;
+        __atomic_store_n(sq_tail, tail + 1, __ATOMIC_RELEASE);
+        if (first) {
+            ++in_flight;
+            ++op.file->pending_;
+        }
+        ++submitted;
+        if (ioUringEnter(ring_fd, 1, 0, 0) < 0)
+            throw ringError("io_uring_enter", errno);
+    }
+
+    /// Handles every completion in the ring; returns how many there were.
+    size_t reap() {
+        unsigned head = *cq_head;
+        const unsigned tail = __atomic_load_n(cq_tail, __ATOMIC_ACQUIRE);
+        std::vector<uint32_t> resubmit;
+        size_t n = 0;
+        for (; head != tail; ++head, ++n) {
+            const io_uring_cqe& cqe = cqes[head & *cq_mask];
+            const uint32_t buf = static_cast<uint32_t>(cqe.user_data);
+            Op& op = ops[buf];
+            if (cqe.res > 0 && op.done + static_cast<uint32_t>(cqe.res) < op.len) {
+                op.done += static_cast<uint32_t>(cqe.res);
+                resubmit.push_back(buf);
+                continue;
+            }
+            if (cqe.res <= 0 && op.file->error_ == 0)
+                op.file->error_ = cqe.res < 0 ? -cqe.res : EIO;
+            --op.file->pending_;
+            --in_flight;
+            release(buf);
+        }
+        __atomic_store_n(cq_head, head, __ATOMIC_RELEASE);
+        for (uint32_t buf : resubmit)
+            submit(buf, false);
+        return n;
+    }
+
+    /// Returns once at least one completion has been handled. One thread waits in
+    /// the kernel at a time; the others wait on cv for it to reap.
+    void waitForCompletion(std::unique_lock<std::mutex>& lock) {
+        if (waiting) {
+            cv.wait(lock);
+            return;
+        }
+        if (reap() > 0)
+            return;
+        waiting = true;
+        lock.unlock();
+        const int rc = ioUringEnter(ring_fd, 0, 1, IORING_ENTER_GETEVENTS);
+        const int err = errno;
+        lock.lock();
+        waiting = false;
+        reap();
+        cv.notify_all();
+        if (rc < 0)
+            throw ringError("io_uring_enter", err);
+    }
+};
+
+IoUringWriter::IoUringWriter(const IoUringOptions& options) : impl_(std::make_unique<Impl>()) {
+    impl_->options = options;
+    impl_->setUp();
+}
+
+IoUringWriter::~IoUringWriter() = default;
+
+bool IoUringWriter::available() {
+    static const bool ok = [] {
+        io_uring_params p{};
+        const int fd = ioUringSetup(1, &p);
+        if (fd < 0)
+            return false;
+        ::close(fd);
+        return true;
+    }();
+    return ok;
+}
+
+std::unique_ptr<IoUringFile> IoUringWriter::open(const std::string& path, bool truncate) {
+    std::unique_ptr<IoUringFile> file(new IoUringFile());
+    file->ring_ = impl_.get();
+    file->path_ = path;
+    const int flags = O_RDWR | O_CREAT | O_CLOEXEC | (truncate ? O_TRUNC : 0);
+    int fd = -1;
+    if (impl_->options.direct) {
+        fd = ::open(path.c_str(), flags | O_DIRECT, 0644);
+        file->direct_ = fd >= 0;
+    }
+    if (fd < 0)  // also filesystems without O_DIRECT, such as tmpfs
+        fd = ::open(path.c_str(), flags, 0644);
+    if (fd < 0)
+        throw ringError("cannot open " + path, errno);
+    file->fd_ = fd;
+
+    const off_t end = ::lseek(fd, 0, SEEK_END);
+    if (end < 0)
+        throw ringError("cannot seek " + path, errno);
+    file->size_ = file->staging_offset_ = static_cast<uint64_t>(end);
+    if (file->direct_ && end % kBlock != 0) {
+        // Stage the partial last block so the next write rewrites it whole.
+        std::unique_lock<std::mutex> lock(impl_->mutex);
+        file->staging_ = impl_->acquire(lock, *file);
+        lock.unlock();
+        file->staging_offset_ = static_cast<uint64_t>(end) / kBlock * kBlock;
+        file->staging_len_ = static_cast<uint32_t>(end - static_cast<off_t>(file->staging_offset_));
+        const ssize_t got = ::pread(fd, impl_->buffer(file->staging_), kBlock,
+                                    static_cast<off_t>(file->staging_offset_));
+        if (got != static_cast<ssize_t>(file->staging_len_))
+            throw ringError("cannot read back the tail of " + path, got < 0 ? errno : EIO);
+    }
+    return file;
+}
+
+const IoUringOptions& IoUringWriter::options() const { return impl_->options; }
+
+bool IoUringWriter::buffersRegistered() const { return impl_->registered; }
+
+uint64_t IoUringWriter::writesSubmitted() const {
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    return impl_->submitted;
+}
+
+// --- IoUringFile ---
+
+IoUringFile::~IoUringFile() {
+    try {
+        close();
+    } catch (...) {
+        // Destructors must not throw; call close() explicitly to see write errors.
+    }
+}
+
+void IoUringFile::append(const void* data, size_t n) {
+    const char* p = static_cast<const char*>(data);
+    const uint32_t capacity = ring_->options.buffer_bytes;
+    while (n > 0) {
+        if (staging_ == kNoBuffer) {
+            std::unique_lock<std::mutex> lock(ring_->mutex);
+            staging_ = ring_->acquire(lock, *this);
+            staging_len_ = 0;
+        }
+        const size_t take = std::min<size_t>(n, capacity - staging_len_);
+        std::memcpy(ring_->buffer(staging_) + staging_len_, p, take);
+        staging_len_ += static_cast<uint32_t>(take);
+        size_ += take;
+        p += take;
+        n -= take;
+        if (staging_len_ == capacity)
+            submitStaging(false);
+    }
+}
+
+void IoUringFile::submitStaging(bool pad_tail) {
+    if (staging_ == kNoBuffer || staging_len_ == 0)
+        return;
+    std::unique_lock<std::mutex> lock(ring_->mutex);
+    uint32_t len = staging_len_;
+    uint32_t keep = 0;
+    uint32_t next = kNoBuffer;
+    if (direct_ && pad_tail && len % kBlock != 0) {
+        keep = len % kBlock;
+        next = ring_->acquire(lock, *this);
+        const uint32_t padded = (len + kBlock - 1) / kBlock * kBlock;
+        std::memset(ring_->buffer(staging_) + len, 0, padded - len);
+        std::memcpy(ring_->buffer(next), ring_->buffer(staging_) + len - keep, keep);
+        len = padded;
+    }
+    IoUringWriter::Impl::Op& op = ring_->ops[staging_];
+    op.file = this;
+    op.offset = staging_offset_;
+    op.len = len;
+    op.done = 0;
+    const uint32_t buf = staging_;
+    staging_offset_ += staging_len_ - keep;
+    staging_ = next;
+    staging_len_ = keep;
+    ring_->submit(buf, true);
+}
+
+void IoUringFile::throwIfFailed() const {
+    if (error_ != 0)
+        throw ringError("write to " + path_ + " failed", error_);
+}
+
+void IoUringFile::flush() {
+    if (fd_ < 0)
+        return;
+    submitStaging(true);
+    std::unique_lock<std::mutex> lock(ring_->mutex);
+    while (pending_ > 0)
+        ring_->waitForCompletion(lock);
+    throwIfFailed();
+}
+
+void IoUringFile::sync() {
+    flush();
+    if (::fsync(fd_) != 0)
+        throw ringError("cannot sync " + path_, errno);
+}
+
+void IoUringFile::patch(uint64_t offset, const void* data, size_t n) {
+    if (offset + n > size_)
+        throw std::runtime_error("IoUringWriter: patch past the end of " + path_);
+    flush();
+    // A padded tail block stays staged and is written again later; keep it current.
+    if (staging_ != kNoBuffer && offset + n > staging_offset_) {
+        const uint64_t from = std::max(offset, staging_offset_);
+        std::memcpy(ring_->buffer(staging_) + (from - staging_offset_),
+                    static_cast<const char*>(data) + (from - offset), offset + n - from);
+    }
+    // O_DIRECT cannot write a few unaligned bytes; drop it for this one write.
+    const int flags = direct_ ? ::fcntl(fd_, F_GETFL) : 0;
+    if (direct_)
+        ::fcntl(fd_, F_SETFL, flags & ~O_DIRECT);
+    const ssize_t wrote = ::pwrite(fd_, data, n, static_cast<off_t>(offset));
+    const int err = errno;
+    if (direct_)
+        ::fcntl(fd_, F_SETFL, flags);
+    if (wrote != static_cast<ssize_t>(n))
+        throw ringError("cannot write " + path_, wrote < 0 ? err : EIO);
+}
+
+void IoUringFile::close() {
+    if (fd_ < 0)
+        return;
+    std::exception_ptr error;
+    try {
+        flush();
+    } catch (...) {
+        error = std::current_exception();
+    }
+    {
+        // No write may still point at this file once it is gone.
+        std::unique_lock<std::mutex> lock(ring_->mutex);
+        while (pending_ > 0)
+            ring_->waitForCompletion(lock);
+        if (staging_ != kNoBuffer) {
+            ring_->release(staging_);
+            staging_ = kNoBuffer;
+        }
+    }
+    if (!error && direct_ && ::ftruncate(fd_, static_cast<off_t>(size_)) != 0)
+        error = std::make_exception_ptr(ringError("cannot truncate " + path_, errno));
+    if (::close(fd_) != 0 && !error)
+        error = std::make_exception_ptr(ringError("cannot close " + path_, errno));
+    fd_ = -1;
+    if (error)
+        std::rethrow_exception(error);
+}
+
+}  // namespace qrsdp
+
+#else  // !QRSDP_IO_URING_ENABLED
+
+namespace qrsdp {
+
+struct IoUringWriter::Impl {
+    IoUringOptions options;
+};
+
+IoUringWriter::IoUringWriter(const IoUringOptions&) {
+    throw std::runtime_error("IoUringWriter: io_uring not built (BUILD_IO_URING_SUPPORT=OFF)");
+}
+
+IoUringWriter::~IoUringWriter() = default;
+
+bool IoUringWriter::available() { return false; }
+
+std::unique_ptr<IoUringFile> IoUringWriter::open(const std::string&, bool) { return nullptr; }
+
+const IoUringOptions& IoUringWriter::options() const { return impl_->options; }
+
+bool IoUringWriter::buffersRegistered() const { return false; }
+
+uint64_t IoUringWriter::writesSubmitted() const { return 0; }
+
+IoUringFile::~IoUringFile() = default;
+void IoUringFile::append(const void*, size_t) {}
+void IoUringFile::submitStaging(bool) {}
+void IoUringFile::throwIfFailed() const {}
+void IoUringFile::flush() {}
+void IoUringFile::sync() {}
+void IoUringFile::patch(uint64_t, const void*, size_t) {}
+void IoUringFile::close() {}
+
+}  // namespace qrsdp
+
+#endif  // QRSDP_IO_URING_ENABLED
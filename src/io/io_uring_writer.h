@@ -0,0 +1,111 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace qrsdp {
+
+/// Settings for IoUringWriter.
+struct IoUringOptions {
+    uint32_t queue_depth = 64;          // submission ring entries
+    uint32_t buffers = 64;              // staging buffers shared by every open file
+    uint32_t buffer_bytes = 256 * 1024; // bytes per staging buffer (rounded up to 4 KiB)
+    bool direct = false;                // open files O_DIRECT where the filesystem allows it
+    bool register_buffers = true;       // pin the staging buffers with the ring (WRITE_FIXED)
+};
+
+class IoUringFile;
+
+/// One io_uring instance plus a pool of page-aligned staging buffers, shared by
+/// every file a process writes through it (Linux, BUILD_IO_URING_SUPPORT).
+///
+/// A file copies what it is given into a staging buffer and submits the buffer
+/// as one write when it is full, so many small header and payload writes become
+/// a few large ones and the caller only waits for the device when every buffer
+/// is in flight. Completions are reaped by whichever thread next needs a buffer
+/// or waits on a file. With options.direct, files are opened O_DIRECT; writes
+/// then stay 4 KiB-aligned and a partial last block is padded and cut back to
+/// the file's size on close. Registered buffers fall back to plain writes if the
+/// kernel refuses to pin them (RLIMIT_MEMLOCK).
+///
+/// Thread-safe: files on different threads share the ring under one mutex. Each
+/// IoUringFile has one user at a time. Every file holds one staging buffer while
+/// it is open, so options.buffers must exceed the number of files open at once.
+class IoUringWriter {
+public:
+    /// Sets up the ring and buffers. Throws std::runtime_error if io_uring is not
+    /// built in or the kernel refuses it (check available() first).
+    explicit IoUringWriter(const IoUringOptions& options = IoUringOptions{});
+    ~IoUringWriter();
+
+    IoUringWriter(const IoUringWriter&) = delete;
+    IoUringWriter& operator=(const IoUringWriter&) = delete;
+
+    /// True if this build has io_uring and the kernel lets this process use it.
+    static bool available();
+
+    /// Opens path for writing at its end. truncate = true creates or empties it;
+    /// false keeps its contents (to append after a resume truncation).
+    /// Throws std::runtime_error if it cannot be opened.
+    std::unique_ptr<IoUringFile> open(const std::string& path, bool truncate);
+
+    const IoUringOptions& options() const;
+    bool buffersRegistered() const;
+    /// Writes submitted to the kernel so far (short writes resubmitted count again).
+    uint64_t writesSubmitted() const;
+
+private:
+    friend class IoUringFile;
+    struct Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
+/// A file written through an IoUringWriter. Writes land in file order; nothing
+/// is on disk until a staging buffer fills or flush() submits it.
+class IoUringFile {
+public:
+    ~IoUringFile();  // close(), swallowing errors
+
+    IoUringFile(const IoUringFile&) = delete;
+    IoUringFile& operator=(const IoUringFile&) = delete;
+
+    /// Appends n bytes. Throws std::runtime_error if an earlier write failed.
+    void append(const void* data, size_t n);
+    /// Bytes in the file, counting those still staged.
+    uint64_t size() const { return size_; }
+    /// Submits staged bytes and waits for every write of this file; throws if any failed.
+    void flush();
+    /// flush(), then fsync.
+    void sync();
+    /// Overwrites n bytes at offset, which must lie within size(). Flushes first.
+    void patch(uint64_t offset, const void* data, size_t n);
+    /// Flushes, cuts O_DIRECT padding back to size() and closes. Idempotent; throws on a write error.
+    void close();
+    bool isOpen() const { return fd_ >= 0; }
+    bool isDirect() const { return direct_; }
+
+private:
+    friend class IoUringWriter;
+    friend struct IoUringWriter::Impl;
+    IoUringFile() = default;
+
+    /// Submits the staging buffer; in direct mode a partial last block is padded
+    /// and kept staged, to be rewritten in full later.
+    void submitStaging(bool pad_tail);
+    void throwIfFailed() const;
+
+    IoUringWriter::Impl* ring_ = nullptr;
+    std::string path_;
+    int fd_ = -1;
+    bool direct_ = false;
+    uint64_t size_ = 0;
+    uint32_t staging_ = UINT32_MAX;     // pool buffer being filled, or none
+    uint32_t staging_len_ = 0;
+    uint64_t staging_offset_ = 0;       // file offset of the staging buffer's first byte
+    uint32_t pending_ = 0;              // writes in flight (guarded by the ring's mutex)
+    int error_ = 0;                     // first failed write's errno (guarded likewise)
+};
+
+}  // namespace qrsdp
@@ -0,0 +1,102 @@
+#pragma once
+
+#include "io/event_log_format.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace qrsdp {
+
+// --- Kafka event payloads ---
+/// A Kafka message value is either one bare 26-byte DiskEventRecord (the
+/// original format) or a batch: a 12-byte KafkaBatchHeader followed by
+/// record_count DiskEventRecords, all of one security (the message key) in
+/// timestamp order. Fields are little-endian, as in the event log.
+constexpr char     kKafkaBatchMagic[4] = {'Q','R','K','B'};
+constexpr uint16_t kKafkaBatchVersion = 1;
+
+#pragma pack(push, 1)
+struct KafkaBatchHeader {
+    char     magic[4];       // "QRKB"
+    uint16_t version;
+    uint16_t record_size;    // sizeof(DiskEventRecord)
+    uint32_t record_count;
+};
+#pragma pack(pop)
+static_assert(sizeof(KafkaBatchHeader) == 12, "KafkaBatchHeader must be 12 bytes");
+
+/// Payload size of a batch of n records.
+constexpr size_t kafkaBatchBytes(size_t n) {
+    return sizeof(KafkaBatchHeader) + n * sizeof(DiskEventRecord);
+}
+
+/// Builds a batch payload in a caller-owned buffer of kafkaBatchBytes(capacity)
+/// bytes. finish() writes the header and returns the payload size; reset()
+/// starts the next batch in another (or the same) buffer.
+class KafkaBatchWriter {
+public:
+    void reset(char* buf, uint32_t capacity) {
+        buf_ = buf;
+        capacity_ = capacity;
+        count_ = 0;
+    }
+
+    void add(const DiskEventRecord& rec) {
+        std::memcpy(buf_ + kafkaBatchBytes(count_), &rec, sizeof(rec));
+        ++count_;
+    }
+
+    size_t finish() {
+        KafkaBatchHeader hdr;
+        std::memcpy(hdr.magic, kKafkaBatchMagic, 4);
+        hdr.version = kKafkaBatchVersion;
+        hdr.record_size = sizeof(DiskEventRecord);
+        hdr.record_count = count_;
+        std::memcpy(buf_, &hdr, sizeof(hdr));
+        return kafkaBatchBytes(count_);
+    }
+
+    char* buffer() const { return buf_; }
+    uint32_t count() const { return count_; }
+    bool full() const { return count_ >= capacity_; }
+
+private:
+    char* buf_ = nullptr;
+    uint32_t capacity_ = 0;
+    uint32_t count_ = 0;
+};
+
+/// Records of one Kafka payload, viewed in place (DiskEventRecord is packed, so
+/// the pointer needs no alignment).
+struct KafkaPayloadView {
+    const DiskEventRecord* records = nullptr;
+    size_t count = 0;
+};
+
+/// Parses a message value. Returns false (and an empty view) if it is neither a
+/// bare record nor a well-formed batch.
+inline bool parseKafkaPayload(const void* data, size_t len, KafkaPayloadView& out) {
+    out = KafkaPayloadView{};
+    if (!data)
+        return false;
+    const auto* bytes = static_cast<const char*>(data);
+    if (len == sizeof(DiskEventRecord)) {
+        out.records = reinterpret_cast<const DiskEventRecord*>(bytes);
+        out.count = 1;
+        return true;
+    }
+    KafkaBatchHeader hdr;
+    if (len < sizeof(hdr))
+        return false;
+    std::memcpy(&hdr, bytes, sizeof(hdr));
+    if (std::memcmp(hdr.magic, kKafkaBatchMagic, 4) != 0 || hdr.version != kKafkaBatchVersion
+        || hdr.record_size != sizeof(DiskEventRecord)
+        || len - sizeof(hdr) != static_cast<size_t>(hdr.record_count) * sizeof(DiskEventRecord))
+        return false;
+    out.records = reinterpret_cast<const DiskEventRecord*>(bytes + sizeof(hdr));
+    out.count = hdr.record_count;
+    return true;
+}
+
+}  // namespace qrsdp
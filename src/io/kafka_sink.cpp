@@ -1,16 +1,44 @@
 #ifdef QRSDP_KAFKA_ENABLED
 
 #include "io/kafka_sink.h"
+#include "core/metrics.h"
 
+#include <algorithm>
 #include <cstring>
 #include <stdexcept>
 
 namespace qrsdp {
 
+void KafkaSink::DeliveryReportCb::dr_cb(RdKafka::Message& message) {
+    KafkaSinkStats& st = sink_.stats_;
+    if (message.err()) {
+        ++st.failed_deliveries;
+        std::fprintf(stderr, "KafkaSink: delivery failed: %s\n",
+                     message.errstr().c_str());
+    } else {
+        ++st.delivered;
+        const int64_t us = message.latency();
+        if (us >= 0) {
+            st.latency_us_sum += static_cast<uint64_t>(us);
+            st.latency_us_max = std::max(st.latency_us_max, static_cast<uint64_t>(us));
+            if (sink_.delivery_latency_ns_)
+                sink_.delivery_latency_ns_->record(static_cast<uint64_t>(us) * 1000);
+        }
+    }
+    // Runs inside poll()/flush() on the appending thread, so the pool needs no lock.
+    if (message.msg_opaque())
+        sink_.free_buffers_.push_back(static_cast<char*>(message.msg_opaque()));
+}
+
 KafkaSink::KafkaSink(const std::string& brokers,
                      const std::string& topic_name,
-                     const std::string& symbol)
+                     const std::string& symbol,
+                     const KafkaSinkOptions& options)
     : symbol_(symbol)
+    , batch_(options.batch)
+    , batching_(options.batch.max_records > 1)
+    , queue_depth_(options.queue_depth)
+    , delivery_latency_ns_(options.delivery_latency_ns)
 {
     std::string errstr;
 
@@ -19,12 +47,14 @@ KafkaSink::KafkaSink(const std::string& brokers,
 
     if (conf->set("bootstrap.servers", brokers, errstr) != RdKafka::Conf::CONF_OK)
         throw std::runtime_error("KafkaSink: " + errstr);
-    if (conf->set("enable.idempotence", "true", errstr) != RdKafka::Conf::CONF_OK)
-        throw std::runtime_error("KafkaSink: " + errstr);
-    if (conf->set("linger.ms", "5", errstr) != RdKafka::Conf::CONF_OK)
-        throw std::runtime_error("KafkaSink: " + errstr);
-    if (conf->set("compression.type", "lz4", errstr) != RdKafka::Conf::CONF_OK)
-        throw std::runtime_error("KafkaSink: " + errstr);
+    for (const auto& kv : kafkaProfileSettings(options.profile)) {
+        if (conf->set(kv.first, kv.second, errstr) != RdKafka::Conf::CONF_OK)
+            throw std::runtime_error("KafkaSink: " + errstr);
+    }
+    for (const auto& kv : options.extra_config) {
+        if (conf->set(kv.first, kv.second, errstr) != RdKafka::Conf::CONF_OK)
+            throw std::runtime_error("KafkaSink: " + kv.first + ": " + errstr);
+    }
     if (conf->set("dr_cb", &dr_cb_, errstr) != RdKafka::Conf::CONF_OK)
         throw std::runtime_error("KafkaSink: " + errstr);
 
@@ -38,55 +68,187 @@ KafkaSink::KafkaSink(const std::string& brokers,
     topic_ = RdKafka::Topic::create(producer_.get(), topic_name, tconf.get(), errstr);
     if (!topic_)
         throw std::runtime_error("KafkaSink: failed to create topic: " + errstr);
+
+    if (options.partitions > 0)
+        checkPartitionCount(topic_name, options.partitions);
+
+    if (batching_) {
+        const uint32_t n = std::max<uint32_t>(batch_.buffers, 1);
+        buffers_.reserve(n);
+        free_buffers_.reserve(n);
+        for (uint32_t i = 0; i < n; ++i) {
+            buffers_.emplace_back(new char[kafkaBatchBytes(batch_.max_records)]);
+            free_buffers_.push_back(buffers_.back().get());
+        }
+    }
+}
+
+void KafkaSink::checkPartitionCount(const std::string& topic_name, uint32_t partitions) {
+    RdKafka::Metadata* raw = nullptr;
+    const RdKafka::ErrorCode err = producer_->metadata(false, topic_, &raw, 5000);
+    std::unique_ptr<RdKafka::Metadata> md(raw);
+    if (err != RdKafka::ERR_NO_ERROR) {
+        // Broker not reachable yet: produce() reports an unknown partition later.
+        std::fprintf(stderr, "KafkaSink: cannot check partitions of %s: %s\n",
+                     topic_name.c_str(), RdKafka::err2str(err).c_str());
+        return;
+    }
+    for (const RdKafka::TopicMetadata* t : *md->topics()) {
+        if (t->topic() == topic_name && t->err() == RdKafka::ERR_NO_ERROR
+            && t->partitions()->size() < partitions)
+            throw std::runtime_error("KafkaSink: topic " + topic_name + " has "
+                                     + std::to_string(t->partitions()->size())
+                                     + " partitions, fewer than " + std::to_string(partitions));
+    }
 }
 
 KafkaSink::~KafkaSink() {
     close();
+    if (stats_.dropped_records > 0 || stats_.failed_deliveries > 0)
+        std::fprintf(stderr, "KafkaSink: %llu records dropped, %llu deliveries failed\n",
+                     static_cast<unsigned long long>(stats_.dropped_records),
+                     static_cast<unsigned long long>(stats_.failed_deliveries));
     delete topic_;
 }
 
+void KafkaSink::setSymbol(const std::string& symbol, int32_t partition) {
+    if (symbol == symbol_ && partition == partition_)
+        return;
+    sendPending();
+    symbol_ = symbol;
+    partition_ = partition;
+}
+
+KafkaSinkStats KafkaSink::stats() const {
+    KafkaSinkStats st = stats_;
+    if (producer_)
+        st.queue_depth = static_cast<uint64_t>(std::max(producer_->outq_len(), 0));
+    return st;
+}
+
 void KafkaSink::append(const EventRecord& rec) {
-    DiskEventRecord disk;
-    disk.ts_ns       = rec.ts_ns;
-    disk.type        = rec.type;
-    disk.side        = rec.side;
-    disk.price_ticks = rec.price_ticks;
-    disk.qty         = rec.qty;
-    disk.order_id    = rec.order_id;
-
-    RdKafka::ErrorCode err = producer_->produce(
-        topic_,
-        RdKafka::Topic::PARTITION_UA,
-        RdKafka::Producer::RK_MSG_COPY,
-        &disk, sizeof(disk),
-        symbol_.data(), symbol_.size(),
-        nullptr);
-
-    if (err == RdKafka::ERR__QUEUE_FULL) {
-        producer_->poll(100);
-        producer_->produce(
+    addRecord(rec);
+    producer_->poll(0);
+    if (queue_depth_)
+        queue_depth_->set(producer_->outq_len());
+}
+
+void KafkaSink::appendBatch(const EventRecord* recs, size_t n) {
+    for (size_t i = 0; i < n; ++i)
+        addRecord(recs[i]);
+    producer_->poll(0);
+    if (queue_depth_)
+        queue_depth_->set(producer_->outq_len());
+}
+
+void KafkaSink::addRecord(const EventRecord& rec) {
+    DiskEventRecord disk = toDisk(rec);
+    if (!batching_) {
+        produce(&disk, sizeof(disk), RdKafka::Producer::RK_MSG_COPY, nullptr, 1);
+        return;
+    }
+
+    if (!pending_.buffer()) {
+        if (!acquireBuffer()) {
+            ++stats_.dropped_records;
+            return;
+        }
+        pending_since_ = std::chrono::steady_clock::now();
+    }
+    pending_.add(disk);
+    if (pending_.full()
+        || (batch_.max_delay_ms > 0
+            && std::chrono::steady_clock::now() - pending_since_
+                   >= std::chrono::milliseconds(batch_.max_delay_ms)))
+        sendPending();
+}
+
+bool KafkaSink::acquireBuffer() {
+    if (free_buffers_.empty()) {
+        // Every payload is still in flight: let delivery reports return some.
+        ++stats_.queue_full_waits;
+        const auto deadline = std::chrono::steady_clock::now()
+                            + std::chrono::milliseconds(batch_.queue_full_wait_ms);
+        int wait_ms = 1;
+        while (free_buffers_.empty() && std::chrono::steady_clock::now() < deadline) {
+            producer_->poll(wait_ms);
+            wait_ms = std::min(wait_ms * 2, 100);
+        }
+        if (free_buffers_.empty()) {
+            if (stats_.dropped_records == 0)
+                std::fprintf(stderr, "KafkaSink: no free batch buffer after %u ms, dropping\n",
+                             batch_.queue_full_wait_ms);
+            return false;
+        }
+    }
+    pending_.reset(free_buffers_.back(), batch_.max_records);
+    free_buffers_.pop_back();
+    return true;
+}
+
+void KafkaSink::sendPending() {
+    char* buf = pending_.buffer();
+    if (!buf)
+        return;
+    const uint32_t records = pending_.count();
+    const size_t len = pending_.finish();
+    pending_.reset(nullptr, 0);
+    // No RK_MSG_COPY / RK_MSG_FREE: librdkafka references the pooled buffer
+    // until its delivery report hands it back.
+    if (!produce(buf, len, 0, buf, records))
+        free_buffers_.push_back(buf);
+}
+
+bool KafkaSink::produce(void* payload, size_t len, int msgflags, void* opaque, uint32_t records) {
+    const auto deadline = std::chrono::steady_clock::now()
+                        + std::chrono::milliseconds(batch_.queue_full_wait_ms);
+    int wait_ms = 1;
+    for (;;) {
+        const RdKafka::ErrorCode err = producer_->produce(
             topic_,
-            RdKafka::Topic::PARTITION_UA,
-            RdKafka::Producer::RK_MSG_COPY,
-            &disk, sizeof(disk),
+            partition_,
+            msgflags,
+            payload, len,
             symbol_.data(), symbol_.size(),
-            nullptr);
-    } else if (err != RdKafka::ERR_NO_ERROR) {
-        std::fprintf(stderr, "KafkaSink: produce failed: %s\n",
-                     RdKafka::err2str(err).c_str());
+            opaque);
+        if (err == RdKafka::ERR_NO_ERROR) {
+            ++stats_.messages;
+            stats_.records += records;
+            return true;
+        }
+        if (err != RdKafka::ERR__QUEUE_FULL) {
+            std::fprintf(stderr, "KafkaSink: produce failed: %s\n",
+                         RdKafka::err2str(err).c_str());
+            break;
+        }
+        if (wait_ms == 1)
+            ++stats_.queue_full_waits;
+        if (std::chrono::steady_clock::now() >= deadline) {
+            if (stats_.dropped_records == 0)
+                std::fprintf(stderr, "KafkaSink: queue full for %u ms, dropping\n",
+                             batch_.queue_full_wait_ms);
+            break;
+        }
+        // Back-pressure: serve delivery reports so the queue drains, backing off.
+        producer_->poll(wait_ms);
+        wait_ms = std::min(wait_ms * 2, 100);
     }
-
-    producer_->poll(0);
+    stats_.dropped_records += records;
+    return false;
 }
 
 void KafkaSink::flush() {
-    if (producer_)
-        producer_->flush(5000);
+    if (!producer_)
+        return;
+    sendPending();
+    producer_->flush(5000);
 }
 
 void KafkaSink::close() {
-    if (producer_)
-        producer_->flush(10000);
+    if (!producer_)
+        return;
+    sendPending();
+    producer_->flush(10000);
 }
 
 }  // namespace qrsdp
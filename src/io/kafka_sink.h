@@ -4,24 +4,37 @@
 
 #include "io/i_event_sink.h"
 #include "io/event_log_format.h"
+#include "io/kafka_payload.h"
+#include "io/kafka_sink_options.h"
 #include "core/records.h"
 
 #include <librdkafka/rdkafkacpp.h>
 
+#include <chrono>
+#include <cstdint>
 #include <cstdio>
 #include <memory>
 #include <string>
+#include <vector>
 
 namespace qrsdp {
 
-/// Kafka event sink: publishes each EventRecord as a 26-byte binary message
-/// to a Kafka topic. Uses the symbol as message key for partition affinity.
-/// Best-effort: delivery failures are logged but do not block the producer.
+/// Kafka event sink: publishes EventRecords as binary messages to a Kafka
+/// topic, with the symbol as message key. The partition is librdkafka's hash of
+/// the key unless setSymbol names one (options.partitions). Producer settings
+/// are options.profile, then options.extra_config. By default each record is
+/// one 26-byte message; with batch.max_records > 1 up to that
+/// many records of one symbol share a message behind a KafkaBatchHeader
+/// (kafka_payload.h). Batch payloads come from a fixed pool and are handed to
+/// librdkafka without copying; the delivery report returns them to the pool.
+/// When the producer queue or the pool is full, append waits (polling) up to
+/// batch.queue_full_wait_ms and then drops, counting what it dropped.
 class KafkaSink : public IEventSink {
 public:
     KafkaSink(const std::string& brokers,
               const std::string& topic,
-              const std::string& symbol);
+              const std::string& symbol,
+              const KafkaSinkOptions& options = {});
 
     ~KafkaSink() override;
 
@@ -29,25 +42,55 @@ public:
     KafkaSink& operator=(const KafkaSink&) = delete;
 
     void append(const EventRecord& rec) override;
+    /// Unbatched: produces each record as its own message but polls once per batch.
+    void appendBatch(const EventRecord* recs, size_t n) override;
+    /// Sends any part-filled batch, then waits for outstanding deliveries.
     void flush() override;
     void close() override;
 
+    /// Message key and partition (-1 = hash the key) for subsequent records;
+    /// lets one producer carry several securities. A pending batch of the
+    /// previous key is sent first.
+    void setSymbol(const std::string& symbol, int32_t partition = RdKafka::Topic::PARTITION_UA);
+
+    /// Counters so far; queue_depth is read from the producer now.
+    KafkaSinkStats stats() const;
+
 private:
-    std::string symbol_;
-    std::unique_ptr<RdKafka::Producer> producer_;
-    RdKafka::Topic* topic_ = nullptr;  // owned by producer_ lifetime
+    void checkPartitionCount(const std::string& topic_name, uint32_t partitions);
+    void addRecord(const EventRecord& rec);
+    bool acquireBuffer();
+    void sendPending();
+    bool produce(void* payload, size_t len, int msgflags, void* opaque, uint32_t records);
 
     class DeliveryReportCb : public RdKafka::DeliveryReportCb {
     public:
-        void dr_cb(RdKafka::Message& message) override {
-            if (message.err()) {
-                std::fprintf(stderr, "KafkaSink: delivery failed: %s\n",
-                             message.errstr().c_str());
-            }
-        }
+        explicit DeliveryReportCb(KafkaSink& sink) : sink_(sink) {}
+        void dr_cb(RdKafka::Message& message) override;
+
+    private:
+        KafkaSink& sink_;
     };
 
-    DeliveryReportCb dr_cb_;
+    std::string symbol_;
+    int32_t partition_ = RdKafka::Topic::PARTITION_UA;
+    KafkaBatchOptions batch_;
+    bool batching_ = false;
+
+    // Batch payload pool; declared before producer_ so buffers outlive any
+    // message librdkafka still references when the producer is destroyed.
+    std::vector<std::unique_ptr<char[]>> buffers_;
+    std::vector<char*> free_buffers_;
+    KafkaBatchWriter pending_;
+    std::chrono::steady_clock::time_point pending_since_;
+
+    KafkaSinkStats stats_;
+    Gauge* queue_depth_ = nullptr;
+    Histogram* delivery_latency_ns_ = nullptr;
+
+    DeliveryReportCb dr_cb_{*this};
+    std::unique_ptr<RdKafka::Producer> producer_;
+    RdKafka::Topic* topic_ = nullptr;  // owned by producer_ lifetime
 };
 
 }  // namespace qrsdp
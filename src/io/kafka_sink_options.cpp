@@ -0,0 +1,70 @@
+#include "io/kafka_sink_options.h"
+
+namespace qrsdp {
+
+const char* kafkaProfileName(KafkaProfile profile) {
+    switch (profile) {
+        case KafkaProfile::BALANCED:   return "balanced";
+        case KafkaProfile::THROUGHPUT: return "throughput";
+        case KafkaProfile::LATENCY:    return "latency";
+    }
+    return "unknown";
+}
+
+bool parseKafkaProfile(const std::string& name, KafkaProfile& out) {
+    for (KafkaProfile p : {KafkaProfile::BALANCED, KafkaProfile::THROUGHPUT,
+                           KafkaProfile::LATENCY}) {
+        if (name == kafkaProfileName(p)) {
+            out = p;
+            return true;
+        }
+    }
+    return false;
+}
+
+KafkaConfigEntries kafkaProfileSettings(KafkaProfile profile) {
+    switch (profile) {
+        case KafkaProfile::THROUGHPUT:
+            return {
+                {"enable.idempotence", "true"},
+                {"linger.ms", "50"},
+                {"batch.num.messages", "100000"},
+                {"batch.size", "4000000"},
+                {"queue.buffering.max.messages", "1000000"},
+                {"queue.buffering.max.kbytes", "2097152"},
+                {"compression.type", "lz4"},
+            };
+        case KafkaProfile::LATENCY:
+            // Idempotence needs acks=all; a single leader ack is the latency trade.
+            return {
+                {"enable.idempotence", "false"},
+                {"acks", "1"},
+                {"linger.ms", "0"},
+                {"compression.type", "none"},
+                {"socket.nagle.disable", "true"},
+            };
+        case KafkaProfile::BALANCED:
+            break;
+    }
+    return {
+        {"enable.idempotence", "true"},
+        {"linger.ms", "5"},
+        {"compression.type", "lz4"},
+    };
+}
+
+bool parseKafkaConfigEntry(const std::string& entry, std::pair<std::string, std::string>& out) {
+    const auto eq = entry.find('=');
+    if (eq == std::string::npos || eq == 0)
+        return false;
+    out = {entry.substr(0, eq), entry.substr(eq + 1)};
+    return true;
+}
+
+int32_t kafkaPartitionFor(size_t security_index, uint32_t partitions) {
+    if (partitions == 0)
+        return -1;
+    return static_cast<int32_t>(security_index % partitions);
+}
+
+}  // namespace qrsdp
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace qrsdp {
+
+class Gauge;
+class Histogram;
+
+/// Named librdkafka producer tunings.
+///   BALANCED   — idempotent, linger 5 ms, lz4 (the original KafkaSink settings).
+///   THROUGHPUT — idempotent, linger 50 ms, large batches and queue, lz4.
+///   LATENCY    — acks=1, no linger, no compression, Nagle off.
+enum class KafkaProfile { BALANCED, THROUGHPUT, LATENCY };
+
+/// "balanced", "throughput", "latency"; "unknown" for out-of-range values.
+const char* kafkaProfileName(KafkaProfile profile);
+
+/// Inverse of kafkaProfileName. Returns false (out untouched) for unknown names.
+bool parseKafkaProfile(const std::string& name, KafkaProfile& out);
+
+using KafkaConfigEntries = std::vector<std::pair<std::string, std::string>>;
+
+/// The librdkafka global properties a profile sets, in the order applied.
+KafkaConfigEntries kafkaProfileSettings(KafkaProfile profile);
+
+/// Parses "key=value" (value may contain '='). Returns false (out untouched)
+/// for a missing '=' or an empty key.
+bool parseKafkaConfigEntry(const std::string& entry, std::pair<std::string, std::string>& out);
+
+/// Partition for the security at security_index: security_index % partitions,
+/// so every run maps a symbol list to partitions the same way; -1 (librdkafka's
+/// PARTITION_UA, i.e. hash the key) when partitions is 0.
+int32_t kafkaPartitionFor(size_t security_index, uint32_t partitions);
+
+/// How KafkaSink groups records into messages. max_records <= 1 keeps one bare
+/// record per message, which every consumer understands.
+struct KafkaBatchOptions {
+    uint32_t max_records = 0;          // records per batch message; <= 1 = unbatched
+    uint32_t max_delay_ms = 0;         // send a part-filled batch this long after its first record; 0 = only when full
+    uint32_t buffers = 64;             // pooled batch payloads in flight (batch mode)
+    uint32_t queue_full_wait_ms = 1000;  // wait this long for queue / pool space before dropping
+};
+
+struct KafkaSinkOptions {
+    KafkaProfile profile = KafkaProfile::BALANCED;
+    uint32_t partitions = 0;          // > 0: explicit partition per security (kafkaPartitionFor); 0 = key hash
+    KafkaConfigEntries extra_config;  // applied after the profile, so it can override it
+    KafkaBatchOptions batch;
+    Gauge* queue_depth = nullptr;          // non-null: librdkafka queue depth after each append
+    Histogram* delivery_latency_ns = nullptr;  // non-null: produce-to-ack time of each delivery
+};
+
+/// Producer counters from delivery reports and produce calls.
+struct KafkaSinkStats {
+    uint64_t messages = 0;           // accepted into the producer queue
+    uint64_t records = 0;            // records in those messages
+    uint64_t delivered = 0;          // acknowledged by the broker
+    uint64_t failed_deliveries = 0;  // delivery report errors
+    uint64_t dropped_records = 0;    // queue / pool wait ran out, or produce() rejected them
+    uint64_t queue_full_waits = 0;   // produce or pool waits that had to poll for space
+    uint64_t queue_depth = 0;        // messages awaiting delivery when the stats were read
+    uint64_t latency_us_sum = 0;     // produce -> delivery report, over delivered messages
+    uint64_t latency_us_max = 0;
+
+    double meanLatencyUs() const {
+        return delivered ? static_cast<double>(latency_us_sum) / static_cast<double>(delivered) : 0.0;
+    }
+};
+
+}  // namespace qrsdp
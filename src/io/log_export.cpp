@@ -0,0 +1,271 @@
+#include "io/log_export.h"
+
+#include "io/event_log_reader.h"
+#include "io/http_post.h"
+#include "io/run_catalog.h"
+#include "io/session_container.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <exception>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <tuple>
+
+namespace fs = std::filesystem;
+
+namespace qrsdp {
+
+namespace {
+
+bool isDate(const std::string& s) {
+    try {
+        daysSinceEpoch(s);
+        return true;
+    } catch (const std::invalid_argument&) {
+        return false;
+    }
+}
+
+void addFile(const fs::path& file, const std::string& symbol, std::vector<ExportSession>& out) {
+    const std::string path = file.string();
+    if (isSessionContainer(path)) {
+        SessionContainer container(path);
+        for (size_t i = 0; i < container.size(); ++i) {
+            const ContainerSession& cs = container.sessions()[i];
+            out.push_back({path, symbol.empty() ? cs.symbol : symbol, cs.date, i});
+        }
+        return;
+    }
+    const std::string date = file.stem().string();
+    if (!isDate(date))
+        throw std::runtime_error("cannot tell the date of " + path + " (want <YYYY-MM-DD>.qrsdp)");
+    out.push_back({path, symbol, date, SIZE_MAX});
+}
+
+/// Destination of one session's encoded bytes.
+class ExportOutput {
+public:
+    virtual ~ExportOutput() = default;
+    virtual void write(const char* data, size_t size) = 0;
+    virtual void finish() = 0;
+};
+
+class FileOutput : public ExportOutput {
+public:
+    explicit FileOutput(const fs::path& path) : path_(path), tmp_(path.string() + ".tmp") {
+        fs::create_directories(path.parent_path());
+        file_ = std::fopen(tmp_.string().c_str(), "wb");
+        if (!file_) throw std::runtime_error("cannot create " + tmp_.string());
+    }
+    ~FileOutput() override {
+        if (file_) {
+            std::fclose(file_);
+            std::error_code ec;
+            fs::remove(tmp_, ec);
+        }
+    }
+    void write(const char* data, size_t size) override {
+        if (std::fwrite(data, 1, size, file_) != size)
+            throw std::runtime_error("write failed: " + tmp_.string());
+    }
+    void finish() override {
+        const bool ok = std::fclose(file_) == 0;
+        file_ = nullptr;
+        if (!ok) throw std::runtime_error("write failed: " + tmp_.string());
+        fs::rename(tmp_, path_);  // readers never see a half-written file
+    }
+
+private:
+    fs::path path_;
+    fs::path tmp_;
+    std::FILE* file_ = nullptr;
+};
+
+class ClickHouseOutput : public ExportOutput {
+public:
+    ClickHouseOutput(const ExportOptions& options)
+        : post_(insertUrl(options), options.http_headers) {}
+    void write(const char* data, size_t size) override { post_.write(data, size); }
+    void finish() override { post_.finish(); }
+
+private:
+    static std::string insertUrl(const ExportOptions& options) {
+        std::string url = options.clickhouse_url;
+        while (!url.empty() && url.back() == '/') url.pop_back();
+        const std::string query = "INSERT INTO " + options.table + " (" + kClickHouseExportColumns +
+                                  ") FORMAT " + exportFormatName(options.format);
+        return url + "/?query=" + urlEncode(query);
+    }
+
+    HttpPost post_;
+};
+
+/// Returns (records, encoded bytes).
+std::pair<uint64_t, uint64_t> exportSession(const ExportSession& session, const ExportOptions& options) {
+    std::unique_ptr<EventLogReader> reader;
+    if (session.container_index != SIZE_MAX)
+        reader = SessionContainer(session.path).open(session.container_index);
+    else
+        reader = std::make_unique<EventLogReader>(session.path);
+    const int32_t days = daysSinceEpoch(session.date);
+
+    std::unique_ptr<ExportOutput> output;
+    if (!options.clickhouse_url.empty()) {
+        output = std::make_unique<ClickHouseOutput>(options);
+    } else {
+        const std::string dir = session.symbol.empty() ? "_" : session.symbol;
+        output = std::make_unique<FileOutput>(fs::path(options.out_dir) / dir /
+                                              (session.date + exportFormatExtension(options.format)));
+    }
+
+    std::unique_ptr<ExportEncoder> encoder = makeExportEncoder(options.format);
+    const bool per_chunk = options.batch_rows == 0;
+    const size_t batch_rows = options.batch_rows;
+    std::vector<DiskEventRecord> pending;  // rows of the batch being gathered
+    std::vector<DiskEventRecord> scratch;
+    std::vector<char> out;
+    out.reserve(options.flush_bytes + (1 << 16));
+    uint64_t records = 0;
+    uint64_t bytes = 0;
+    auto drain = [&](bool force) {
+        if (out.empty() || (!force && out.size() < options.flush_bytes)) return;
+        output->write(out.data(), out.size());
+        bytes += out.size();
+        out.clear();
+    };
+    auto emit = [&](const DiskEventRecord* recs, size_t n) {
+        encoder->batch(recs, n, session.symbol, days, out);
+        records += n;
+        drain(false);
+    };
+
+    encoder->begin(out);
+    for (uint32_t c = 0; c < reader->chunkCount(); ++c) {
+        const RecordSpan span = reader->chunkRecords(c, scratch);
+        if (per_chunk) {
+            if (!span.empty()) emit(span.data, span.size);
+            continue;
+        }
+        size_t i = 0;
+        // Top up a partial batch first, then encode whole batches straight from
+        // the chunk and keep the tail for the next one.
+        if (!pending.empty()) {
+            const size_t take = std::min(span.size, batch_rows - pending.size());
+            pending.insert(pending.end(), span.data, span.data + take);
+            i = take;
+            if (pending.size() == batch_rows) {
+                emit(pending.data(), pending.size());
+                pending.clear();
+            }
+        }
+        for (; span.size - i >= batch_rows; i += batch_rows) emit(span.data + i, batch_rows);
+        pending.insert(pending.end(), span.data + i, span.data + span.size);
+    }
+    if (!pending.empty()) emit(pending.data(), pending.size());
+    encoder->end(out);
+    drain(true);
+    output->finish();
+    return {records, bytes};
+}
+
+}  // namespace
+
+std::vector<ExportSession> collectExportSessions(const std::vector<std::string>& inputs,
+                                                 const std::string& date) {
+    std::vector<ExportSession> sessions;
+    for (const std::string& input : inputs) {
+        const auto eq = input.find('=');
+        const std::string symbol = eq == std::string::npos ? "" : input.substr(0, eq);
+        const fs::path root = eq == std::string::npos ? input : input.substr(eq + 1);
+        if (!fs::exists(root)) throw std::runtime_error("no such file or directory: " + root.string());
+        if (!fs::is_directory(root)) {
+            addFile(root, symbol, sessions);
+            continue;
+        }
+        // A run's catalogue lists its days without walking the tree (container runs
+        // are listed through the container instead).
+        const fs::path catalog_path = root / kRunCatalogName;
+        if (fs::exists(catalog_path)) {
+            const std::vector<CatalogDay> days = RunCatalog(catalog_path.string()).query("", date, date);
+            if (std::none_of(days.begin(), days.end(), [](const CatalogDay& d) { return d.in_container; })) {
+                for (const CatalogDay& d : days)
+                    sessions.push_back({(root / d.file).string(), symbol.empty() ? d.symbol : symbol, d.date,
+                                        SIZE_MAX});
+                continue;
+            }
+        }
+        std::vector<fs::path> files;
+        for (const auto& entry : fs::recursive_directory_iterator(root)) {
+            const std::string ext = entry.path().extension().string();
+            if (entry.is_regular_file() && (ext == ".qrsdp" || ext == ".qrsc")) files.push_back(entry.path());
+        }
+        std::sort(files.begin(), files.end());
+        for (const fs::path& file : files) {
+            std::string sym = symbol;
+            if (sym.empty() && file.extension() == ".qrsdp" && file.parent_path() != root)
+                sym = file.parent_path().filename().string();
+            addFile(file, sym, sessions);
+        }
+    }
+    if (!date.empty()) {
+        sessions.erase(std::remove_if(sessions.begin(), sessions.end(),
+                                      [&](const ExportSession& s) { return s.date != date; }),
+                       sessions.end());
+    }
+    std::stable_sort(sessions.begin(), sessions.end(), [](const ExportSession& a, const ExportSession& b) {
+        return std::tie(a.symbol, a.date) < std::tie(b.symbol, b.date);
+    });
+    return sessions;
+}
+
+ExportStats exportSessions(const std::vector<ExportSession>& sessions, const ExportOptions& options,
+                           const ExportProgress& progress) {
+    if (options.clickhouse_url.empty() == options.out_dir.empty())
+        throw std::invalid_argument("export needs exactly one of a ClickHouse URL and an output directory");
+    if (!options.clickhouse_url.empty() && options.format == ExportFormat::Arrow)
+        throw std::invalid_argument("the arrow format is for files; use native or rowbinary for ClickHouse");
+
+    const auto t0 = std::chrono::steady_clock::now();
+    unsigned threads = options.threads > 0 ? options.threads
+                                           : std::max(1u, std::thread::hardware_concurrency());
+    threads = static_cast<unsigned>(std::min<size_t>(threads, std::max<size_t>(sessions.size(), 1)));
+
+    ExportStats stats;
+    std::atomic<size_t> next{0};
+    std::atomic<bool> failed{false};
+    std::exception_ptr error;
+    std::mutex mutex;  // stats, error, progress
+    auto work = [&]() {
+        while (!failed.load(std::memory_order_relaxed)) {
+            const size_t i = next.fetch_add(1);
+            if (i >= sessions.size()) return;
+            try {
+                const auto [records, bytes] = exportSession(sessions[i], options);
+                std::lock_guard<std::mutex> lock(mutex);
+                ++stats.sessions;
+                stats.records += records;
+                stats.bytes += bytes;
+                if (progress) progress(sessions[i], records, bytes);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (!error) error = std::current_exception();
+                failed.store(true);
+            }
+        }
+    };
+    std::vector<std::thread> workers;
+    for (unsigned t = 1; t < threads; ++t) workers.emplace_back(work);
+    work();
+    for (std::thread& w : workers) w.join();
+    if (error) std::rethrow_exception(error);
+    stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    return stats;
+}
+
+}  // namespace qrsdp
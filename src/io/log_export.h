@@ -0,0 +1,64 @@
+#pragma once
+
+#include "io/table_export.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace qrsdp {
+
+/// One session to export: a .qrsdp file, or session container_index of the .qrsc
+/// at path.
+struct ExportSession {
+    std::string path;
+    std::string symbol;
+    std::string date;  // YYYY-MM-DD
+    size_t container_index = SIZE_MAX;
+};
+
+/// Expands inputs ("[SYMBOL=]path") into sessions sorted by (symbol, date). A path
+/// may be a .qrsdp file, a .qrsc container, or a run directory, which is searched
+/// recursively for both. A day file's date is its file name (<YYYY-MM-DD>.qrsdp) and
+/// its symbol the directory it sits in, unless that is the input directory itself
+/// (single-security runs); SYMBOL= overrides the symbol. A run directory with a
+/// catalogue (run_catalog.h) of day files is listed from it instead of searched. If date is set, only that
+/// day's sessions are kept. Throws std::runtime_error for missing inputs or a day
+/// file whose name is not a date.
+std::vector<ExportSession> collectExportSessions(const std::vector<std::string>& inputs,
+                                                 const std::string& date = "");
+
+struct ExportOptions {
+    ExportFormat format = ExportFormat::Native;
+    /// ClickHouse HTTP endpoint ("http://host:8123"); each session is one INSERT.
+    std::string clickhouse_url;
+    std::string table = "exchange_events";
+    std::vector<std::string> http_headers;  // e.g. "X-ClickHouse-User: default"
+    /// Otherwise: write <out_dir>/<symbol>/<date><ext> ("_" for no symbol).
+    std::string out_dir;
+    unsigned threads = 0;         // 0 = hardware concurrency (capped at the session count)
+    /// Rows per Native block / Arrow record batch; 0 = one per chunk of the log.
+    size_t batch_rows = 1 << 19;
+    size_t flush_bytes = 8 << 20; // encoded bytes buffered before a write
+};
+
+struct ExportStats {
+    size_t sessions = 0;
+    uint64_t records = 0;
+    uint64_t bytes = 0;  // encoded bytes written or sent
+    double seconds = 0.0;
+};
+
+/// Called after each finished session, from the worker thread that exported it.
+using ExportProgress = std::function<void(const ExportSession&, uint64_t records, uint64_t bytes)>;
+
+/// Exports sessions on a pool of worker threads, one session per worker at a time.
+/// Stops handing out sessions after the first failure and rethrows it. Throws
+/// std::invalid_argument if neither or both destinations are set, or for Arrow to
+/// ClickHouse.
+ExportStats exportSessions(const std::vector<ExportSession>& sessions, const ExportOptions& options,
+                           const ExportProgress& progress = {});
+
+}  // namespace qrsdp
@@ -0,0 +1,185 @@
+#include "io/lz4_hc.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace qrsdp {
+
+namespace {
+
+// LZ4 block format limits (lz4_Block_format.md).
+constexpr size_t kMinMatch = 4;
+constexpr size_t kLastLiterals = 5;  // the block always ends in at least 5 literals
+constexpr size_t kMatchFindLimit = 12;  // no match starts in the last 12 bytes
+constexpr size_t kMaxDistance = 65535;
+constexpr int kHashLog = 15;
+
+uint32_t read32(const uint8_t* p) {
+    uint32_t v;
+    std::memcpy(&v, p, sizeof v);
+    return v;
+}
+
+uint32_t hash4(const uint8_t* p) {
+    return (read32(p) * 2654435761u) >> (32 - kHashLog);
+}
+
+/// Bytes a[i] == b[i] from 0, stopping at a + max; eight at a time where the
+/// compiler can count trailing zeros.
+size_t commonLength(const uint8_t* a, const uint8_t* b, size_t max) {
+    size_t len = 0;
+#if defined(__GNUC__) || defined(__clang__)
+    for (; len + 8 <= max; len += 8) {
+        uint64_t x, y;
+        std::memcpy(&x, a + len, 8);
+        std::memcpy(&y, b + len, 8);
+        if (x != y) {
+            if constexpr (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+                return len + static_cast<size_t>(__builtin_ctzll(x ^ y)) / 8;
+            break;
+        }
+    }
+#endif
+    while (len < max && a[len] == b[len]) ++len;
+    return len;
+}
+
+/// Hash chain over the window: head_ holds the latest position of each hash,
+/// chain_ (indexed by position mod 64 KiB) the distance back to the previous
+/// position with the same hash, 0 at the end of the chain.
+class MatchFinder {
+public:
+    MatchFinder(const uint8_t* src, size_t n, int attempts)
+        : src_(src), n_(n), attempts_(attempts), head_(size_t{1} << kHashLog, -1), chain_(65536, 0) {}
+
+    /// Inserts every position before pos.
+    void insertUntil(size_t pos) {
+        for (; next_ < pos; ++next_) {
+            if (next_ + kMinMatch > n_) continue;
+            int64_t& head = head_[hash4(src_ + next_)];
+            const size_t delta = head < 0 ? 0 : next_ - static_cast<size_t>(head);
+            chain_[next_ & 0xFFFF] = static_cast<uint16_t>(delta > kMaxDistance ? 0 : delta);
+            head = static_cast<int64_t>(next_);
+        }
+    }
+
+    /// Longest match for pos among earlier positions, ending at or before limit.
+    /// Returns its length (0 if below kMinMatch) and sets match.
+    size_t longest(size_t pos, size_t limit, size_t& match) {
+        insertUntil(pos);
+        size_t best = 0;
+        int64_t cand = head_[hash4(src_ + pos)];
+        const uint32_t head4 = read32(src_ + pos);
+        for (int tries = attempts_; cand >= 0 && tries > 0; --tries) {
+            const size_t c = static_cast<size_t>(cand);
+            if (pos - c > kMaxDistance) break;
+            // A candidate can only beat best if it also matches the four bytes
+            // that end one past best.
+            if (best == 0 ? read32(src_ + c) == head4
+                          : read32(src_ + c + best - 3) == read32(src_ + pos + best - 3)
+                                && read32(src_ + c) == head4) {
+                const size_t len = kMinMatch + commonLength(src_ + pos + kMinMatch, src_ + c + kMinMatch,
+                                                            limit - pos - kMinMatch);
+                if (len > best) {
+                    best = len;
+                    match = c;
+                    if (pos + len >= limit) break;
+                }
+            }
+            const uint16_t back = chain_[c & 0xFFFF];
+            if (back == 0) break;
+            cand -= back;
+        }
+        return best >= kMinMatch ? best : 0;
+    }
+
+private:
+    const uint8_t* src_;
+    size_t n_;
+    int attempts_;
+    size_t next_ = 0;
+    std::vector<int64_t> head_;
+    std::vector<uint16_t> chain_;
+};
+
+/// Output cursor that refuses to write past the end (ok_ then stays false).
+class BlockWriter {
+public:
+    BlockWriter(uint8_t* dst, size_t cap) : op_(dst), begin_(dst), end_(dst + cap) {}
+
+    /// One sequence: literals src[0, lit_len), then (offset, match_len) unless
+    /// match_len is 0 (the closing literal run).
+    void sequence(const uint8_t* literals, size_t lit_len, size_t offset, size_t match_len) {
+        const size_t ml = match_len > 0 ? match_len - kMinMatch : 0;
+        // Worst case: token, length bytes, literals, offset, match length bytes.
+        if (static_cast<size_t>(end_ - op_) < 1 + lit_len / 255 + 1 + lit_len + 2 + ml / 255 + 1) {
+            ok_ = false;
+            return;
+        }
+        uint8_t* token = op_++;
+        *token = static_cast<uint8_t>(std::min<size_t>(lit_len, 15) << 4);
+        if (lit_len >= 15) length(lit_len - 15);
+        std::memcpy(op_, literals, lit_len);
+        op_ += lit_len;
+        if (match_len == 0) return;
+        *op_++ = static_cast<uint8_t>(offset);
+        *op_++ = static_cast<uint8_t>(offset >> 8);
+        *token |= static_cast<uint8_t>(std::min<size_t>(ml, 15));
+        if (ml >= 15) length(ml - 15);
+    }
+
+    bool ok() const { return ok_; }
+    size_t size() const { return static_cast<size_t>(op_ - begin_); }
+
+private:
+    void length(size_t len) {
+        for (; len >= 255; len -= 255) *op_++ = 255;
+        *op_++ = static_cast<uint8_t>(len);
+    }
+
+    uint8_t* op_;
+    uint8_t* begin_;
+    uint8_t* end_;
+    bool ok_ = true;
+};
+
+}  // namespace
+
+size_t lz4HcCompress(const char* src_chars, size_t n, char* dst, size_t cap, int level) {
+    const uint8_t* src = reinterpret_cast<const uint8_t*>(src_chars);
+    BlockWriter out(reinterpret_cast<uint8_t*>(dst), cap);
+    size_t anchor = 0;
+    if (n > kMatchFindLimit) {
+        level = std::clamp(level, 1, kLz4HcMaxLevel);
+        MatchFinder finder(src, n, 1 << (level - 1));
+        const size_t last_start = n - kMatchFindLimit;  // last position a match may start at
+        const size_t match_limit = n - kLastLiterals;    // matches end at or before this
+        size_t ip = 0;
+        while (ip <= last_start && out.ok()) {
+            size_t match = 0;
+            size_t len = finder.longest(ip, match_limit, match);
+            if (len == 0) {
+                ++ip;
+                continue;
+            }
+            // Lazy step: a longer match one byte on is worth a literal.
+            while (ip + 1 <= last_start) {
+                size_t next_match = 0;
+                const size_t next_len = finder.longest(ip + 1, match_limit, next_match);
+                if (next_len <= len) break;
+                ++ip;
+                len = next_len;
+                match = next_match;
+            }
+            out.sequence(src + anchor, ip - anchor, ip - match, len);
+            ip += len;
+            anchor = ip;
+        }
+    }
+    out.sequence(src + anchor, n - anchor, 0, 0);
+    return out.ok() ? out.size() : 0;
+}
+
+}  // namespace qrsdp
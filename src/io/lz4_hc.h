@@ -0,0 +1,24 @@
+#pragma once
+
+#include <cstddef>
+
+namespace qrsdp {
+
+/// Highest search level of lz4HcCompress; higher levels are clamped to it.
+inline constexpr int kLz4HcMaxLevel = 12;
+/// Level used when none is given, as LZ4HC's own default.
+inline constexpr int kLz4HcDefaultLevel = 9;
+
+/// High-compression LZ4: writes the standard LZ4 block format (so
+/// LZ4_decompress_safe reads it, and files record the chunk as plain LZ4), but
+/// searches a hash chain over the 64 KiB window for the longest match instead
+/// of taking the first hash hit, and defers a match by one byte when the next
+/// position has a longer one. level (1..12) sets the search depth: up to
+/// 2^(level-1) candidates per position, so compression slows as the ratio
+/// improves; decompression speed is unchanged.
+///
+/// Compresses src[0, n) into dst (capacity cap; LZ4_compressBound(n) always
+/// suffices) and returns the compressed size, or 0 if it does not fit.
+size_t lz4HcCompress(const char* src, size_t n, char* dst, size_t cap, int level);
+
+}  // namespace qrsdp
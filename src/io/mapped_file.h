@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+namespace qrsdp {
+
+/// Read-only memory mapping of a whole file (mmap, or MapViewOfFile on Windows).
+/// The mapping is immutable for its lifetime, so concurrent readers need no locking.
+class MappedFile {
+public:
+    /// Maps the file. Throws std::runtime_error if it cannot be opened or mapped.
+    explicit MappedFile(const std::string& path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const char* data() const { return data_; }
+    size_t size() const { return size_; }
+
+private:
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+#ifdef _WIN32
+    void* file_handle_ = nullptr;
+    void* mapping_handle_ = nullptr;
+#endif
+};
+
+}  // namespace qrsdp
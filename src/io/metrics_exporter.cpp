@@ -0,0 +1,198 @@
+#include "io/metrics_exporter.h"
+
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#ifdef _WIN32
+    #ifndef WIN32_LEAN_AND_MEAN
+    #define WIN32_LEAN_AND_MEAN
+    #endif
+    #include <winsock2.h>
+    #include <ws2tcpip.h>
+    #pragma comment(lib, "ws2_32.lib")
+
+    namespace {
+    struct WinsockInit {
+        WinsockInit() {
+            WSADATA wsa;
+            WSAStartup(MAKEWORD(2, 2), &wsa);
+        }
+        ~WinsockInit() { WSACleanup(); }
+    };
+    static WinsockInit g_winsock_init;
+    }  // namespace
+
+    using socket_t = SOCKET;
+    using socklen_t = int;
+    constexpr socket_t kInvalidSocket = INVALID_SOCKET;
+    inline int closeSocket(socket_t s) { return closesocket(s); }
+#else
+    #include <arpa/inet.h>
+    #include <netinet/in.h>
+    #include <sys/select.h>
+    #include <sys/socket.h>
+    #include <sys/time.h>
+    #include <unistd.h>
+
+    using socket_t = int;
+    constexpr socket_t kInvalidSocket = -1;
+    inline int closeSocket(socket_t s) { return close(s); }
+#endif
+
+namespace qrsdp {
+
+namespace {
+
+constexpr int kPollTimeoutMs = 100;  // how often the thread checks stop() and the JSON clock
+constexpr size_t kMaxRequest = 4096;
+
+void sendAll(socket_t s, const std::string& data) {
+    size_t off = 0;
+    while (off < data.size()) {
+        const auto n = send(s, data.data() + off, static_cast<int>(data.size() - off), 0);
+        if (n <= 0)
+            return;
+        off += static_cast<size_t>(n);
+    }
+}
+
+}  // namespace
+
+MetricsExporter::MetricsExporter(const MetricsRegistry& registry,
+                                 const MetricsExportOptions& options)
+    : registry_(registry), options_(options), sock_(static_cast<decltype(sock_)>(kInvalidSocket)) {
+    if (options_.http) {
+        const socket_t sock = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+        if (sock == kInvalidSocket)
+            throw std::runtime_error("MetricsExporter: socket() failed");
+        const int one = 1;
+        setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char*>(&one), sizeof(one));
+
+        struct sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(options_.http_port);
+        addr.sin_addr.s_addr = htonl(INADDR_ANY);
+        if (bind(sock, reinterpret_cast<const struct sockaddr*>(&addr), sizeof(addr)) != 0
+            || listen(sock, 8) != 0) {
+            closeSocket(sock);
+            throw std::runtime_error("MetricsExporter: cannot listen on port "
+                                     + std::to_string(options_.http_port));
+        }
+        socklen_t addr_len = sizeof(addr);
+        getsockname(sock, reinterpret_cast<struct sockaddr*>(&addr), &addr_len);
+        port_ = ntohs(addr.sin_port);
+        sock_ = static_cast<decltype(sock_)>(sock);
+        listening_ = true;
+    }
+    if (!options_.json_path.empty()) {
+        json_ = options_.json_path == "-" ? stdout : std::fopen(options_.json_path.c_str(), "a");
+        if (!json_) {
+            if (listening_)
+                closeSocket(static_cast<socket_t>(sock_));
+            throw std::runtime_error("MetricsExporter: cannot open " + options_.json_path);
+        }
+    }
+}
+
+MetricsExporter::~MetricsExporter() {
+    stop();
+    if (listening_)
+        closeSocket(static_cast<socket_t>(sock_));
+    if (json_ && json_ != stdout)
+        std::fclose(json_);
+}
+
+void MetricsExporter::start() {
+    if (running_.exchange(true))
+        return;
+    thread_ = std::thread([this] { run(); });
+}
+
+void MetricsExporter::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!running_.exchange(false))
+            return;
+    }
+    cv_.notify_all();
+    if (thread_.joinable())
+        thread_.join();
+    writeJson();
+}
+
+void MetricsExporter::run() {
+    using Clock = std::chrono::steady_clock;
+    const auto interval = std::chrono::milliseconds(options_.interval_ms > 0 ? options_.interval_ms : 1000);
+    auto next_json = Clock::now() + interval;
+    while (running_.load(std::memory_order_relaxed)) {
+        if (listening_) {
+            fd_set readable;
+            FD_ZERO(&readable);
+            FD_SET(static_cast<socket_t>(sock_), &readable);
+            struct timeval tv { 0, kPollTimeoutMs * 1000 };
+            if (select(static_cast<int>(sock_) + 1, &readable, nullptr, nullptr, &tv) > 0)
+                serveOne();
+        } else {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait_until(lock, next_json, [this] { return !running_.load(std::memory_order_relaxed); });
+        }
+        if (json_ && Clock::now() >= next_json) {
+            writeJson();
+            next_json += interval;
+        }
+    }
+}
+
+void MetricsExporter::serveOne() {
+    const socket_t client = accept(static_cast<socket_t>(sock_), nullptr, nullptr);
+    if (client == kInvalidSocket)
+        return;
+#ifdef _WIN32
+    DWORD timeout_ms = kPollTimeoutMs * 10;
+    setsockopt(client, SOL_SOCKET, SO_RCVTIMEO,
+               reinterpret_cast<const char*>(&timeout_ms), sizeof(timeout_ms));
+#else
+    struct timeval tv { 1, 0 };
+    setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, reinterpret_cast<const char*>(&tv), sizeof(tv));
+#endif
+    // Read up to the end of the headers; the request line is all that matters.
+    std::string request;
+    char buf[1024];
+    while (request.size() < kMaxRequest && request.find("\r\n\r\n") == std::string::npos) {
+        const auto n = recv(client, buf, sizeof(buf), 0);
+        if (n <= 0)
+            break;
+        request.append(buf, static_cast<size_t>(n));
+    }
+
+    std::string body;
+    std::string status = "404 Not Found";
+    if (request.compare(0, 13, "GET /metrics ") == 0 || request.compare(0, 14, "GET /metrics?") == 0) {
+        body = registry_.prometheusText();
+        status = "200 OK";
+        scrapes_.fetch_add(1, std::memory_order_relaxed);
+    }
+    std::string response = "HTTP/1.1 " + status + "\r\n"
+                           "Content-Type: text/plain; version=0.0.4\r\n"
+                           "Content-Length: " + std::to_string(body.size()) + "\r\n"
+                           "Connection: close\r\n\r\n";
+    response += body;
+    sendAll(client, response);
+    closeSocket(client);
+}
+
+void MetricsExporter::writeJson() {
+    if (!json_)
+        return;
+    const auto now_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    std::string line = registry_.jsonLine();
+    // Prefix the object with its wall-clock time.
+    line.insert(1, "\"ts_ms\":" + std::to_string(now_ms) + (line.size() > 2 ? "," : ""));
+    std::fprintf(json_, "%s\n", line.c_str());
+    std::fflush(json_);
+}
+
+}  // namespace qrsdp
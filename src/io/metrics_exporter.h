@@ -0,0 +1,64 @@
+#pragma once
+
+#include "core/metrics.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace qrsdp {
+
+struct MetricsExportOptions {
+    bool http = false;           // serve GET /metrics (Prometheus text) on http_port
+    uint16_t http_port = 9464;   // 0 = ephemeral (tests)
+    std::string json_path;       // non-empty: append a JSON line every interval ("-" = stdout)
+    uint32_t interval_ms = 1000; // JSON line period
+};
+
+/// Publishes a MetricsRegistry off the hot path: an HTTP /metrics endpoint for
+/// Prometheus scrapes and/or a periodic JSON line, both from one background
+/// thread that only reads the registry's atomics. The producers never wait on it.
+class MetricsExporter {
+public:
+    /// Binds the HTTP port and opens the JSON file as configured. Throws
+    /// std::runtime_error on failure.
+    MetricsExporter(const MetricsRegistry& registry, const MetricsExportOptions& options);
+    ~MetricsExporter();
+
+    MetricsExporter(const MetricsExporter&) = delete;
+    MetricsExporter& operator=(const MetricsExporter&) = delete;
+
+    void start();
+    /// Writes a last JSON line, then stops and joins the thread. Idempotent.
+    void stop();
+
+    uint16_t port() const { return port_; }
+    uint64_t scrapesServed() const { return scrapes_.load(std::memory_order_relaxed); }
+
+private:
+    void run();
+    void serveOne();
+    void writeJson();
+
+    const MetricsRegistry& registry_;
+    MetricsExportOptions options_;
+#ifdef _WIN32
+    uintptr_t sock_;
+#else
+    int sock_;
+#endif
+    bool listening_ = false;
+    uint16_t port_ = 0;
+    std::FILE* json_ = nullptr;
+    std::atomic<bool> running_{false};
+    std::atomic<uint64_t> scrapes_{0};
+    std::mutex mutex_;               // JSON-only mode sleeps on cv_ between lines
+    std::condition_variable cv_;
+    std::thread thread_;
+};
+
+}  // namespace qrsdp
@@ -1,9 +1,11 @@
 #pragma once
 
+#include "io/async_sink.h"
 #include "io/i_event_sink.h"
 
 #include <cstdio>
 #include <exception>
+#include <memory>
 #include <vector>
 
 namespace qrsdp {
@@ -12,10 +14,22 @@ namespace qrsdp {
 /// Best-effort: if one sink throws, the error is logged and remaining
 /// sinks still receive the event. Non-owning pointers — caller manages
 /// the lifetime of downstream sinks.
-class MultiplexSink : public IEventSink {
+///
+/// addAsyncSink() puts a sink behind its own AsyncSink (bounded queue and
+/// worker thread, owned by the multiplexer): appends to it only enqueue, so a
+/// slow network sink never holds back the producer or a file sink added with
+/// addSink().
+class MultiplexSink final : public IEventSink {
 public:
     void addSink(IEventSink* sink) { sinks_.push_back(sink); }
 
+    /// Returns the AsyncSink for its counters (lag, drops).
+    AsyncSink& addAsyncSink(IEventSink* sink, const AsyncSinkOptions& options = {}) {
+        async_.push_back(std::make_unique<AsyncSink>(sink, options));
+        sinks_.push_back(async_.back().get());
+        return *async_.back();
+    }
+
     void append(const EventRecord& rec) override {
         for (auto* s : sinks_) {
             try {
@@ -26,6 +40,17 @@ public:
         }
     }
 
+    /// One try/catch per downstream sink per batch rather than per record.
+    void appendBatch(const EventRecord* recs, size_t n) override {
+        for (auto* s : sinks_) {
+            try {
+                s->appendBatch(recs, n);
+            } catch (const std::exception& e) {
+                std::fprintf(stderr, "MultiplexSink: sink error: %s\n", e.what());
+            }
+        }
+    }
+
     void flush() override {
         for (auto* s : sinks_) {
             try {
@@ -50,6 +75,7 @@ public:
 
 private:
     std::vector<IEventSink*> sinks_;
+    std::vector<std::unique_ptr<AsyncSink>> async_;
 };
 
 }  // namespace qrsdp
@@ -0,0 +1,257 @@
+#include "io/run_catalog.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+#include <system_error>
+#include <tuple>
+#include <utility>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace qrsdp {
+
+namespace {
+
+constexpr size_t kChecksummedBytes = offsetof(CatalogEntry, checksum);
+
+uint64_t fnv1a64(const void* data, size_t size) {
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    uint64_t h = 0xcbf29ce484222325ULL;
+    for (size_t i = 0; i < size; ++i) {
+        h ^= p[i];
+        h *= 0x100000001b3ULL;
+    }
+    return h;
+}
+
+std::string fixedString(const char* s, size_t max) {
+    return std::string(s, strnlen(s, max));
+}
+
+void copyFixed(char* dst, size_t max, const std::string& s, const char* what) {
+    if (s.size() >= max)
+        throw std::runtime_error(std::string("RunCatalogWriter: ") + what + " too long: " + s);
+    std::memcpy(dst, s.data(), s.size());
+}
+
+bool syncToDisk(std::FILE* f) {
+#ifdef _WIN32
+    return _commit(_fileno(f)) == 0;
+#else
+    return fsync(fileno(f)) == 0;
+#endif
+}
+
+/// Intact entries of the catalogue at path. A short or corrupt last entry is a
+/// write the crash cut off and is dropped; corruption before it throws.
+std::vector<CatalogEntry> loadEntries(const std::string& path) {
+    std::FILE* f = std::fopen(path.c_str(), "rb");
+    if (!f)
+        throw std::runtime_error("RunCatalog: cannot open " + path);
+    CatalogHeader hdr{};
+    const bool header_read = std::fread(&hdr, sizeof(hdr), 1, f) == 1;
+    if (!header_read || std::memcmp(hdr.magic, kCatalogMagic, 4) != 0
+        || hdr.version_major != kCatalogVersionMajor || hdr.entry_size != sizeof(CatalogEntry)) {
+        std::fclose(f);
+        throw std::runtime_error("RunCatalog: not a run catalogue: " + path);
+    }
+    std::vector<CatalogEntry> entries;
+    CatalogEntry e{};
+    bool corrupt = false;
+    while (std::fread(&e, sizeof(e), 1, f) == 1) {
+        if (corrupt) {
+            std::fclose(f);
+            throw std::runtime_error("RunCatalog: corrupt entry " + std::to_string(entries.size())
+                                     + " in " + path);
+        }
+        if (fnv1a64(&e, kChecksummedBytes) != e.checksum)
+            corrupt = true;
+        else
+            entries.push_back(e);
+    }
+    std::fclose(f);
+    return entries;
+}
+
+}  // namespace
+
+CatalogDay catalogDay(const EventLogReader& reader, const std::string& symbol, const std::string& date,
+                      const std::string& file) {
+    CatalogDay day;
+    day.symbol = symbol;
+    day.date = date;
+    day.file = file;
+    day.record_count = reader.totalRecords();
+    day.chunk_count = reader.chunkCount();
+    if (!reader.index().empty()) {
+        day.first_ts_ns = reader.index().front().first_ts_ns;
+        day.last_ts_ns = reader.index().back().last_ts_ns;
+    }
+    if (reader.hasStats()) {
+        day.has_stats = true;
+        day.stats = reader.stats();
+    }
+    return day;
+}
+
+CatalogEntry packCatalogEntry(const CatalogDay& day) {
+    CatalogEntry e{};
+    copyFixed(e.symbol, kCatalogSymbolBytes, day.symbol, "symbol");
+    copyFixed(e.date, kCatalogDateBytes, day.date, "date");
+    copyFixed(e.file, kCatalogFileBytes, day.file, "file name");
+    e.seed = day.seed;
+    e.open_ticks = day.open_ticks;
+    e.close_ticks = day.close_ticks;
+    e.record_count = day.record_count;
+    e.chunk_count = day.chunk_count;
+    e.flags = (day.in_container ? kCatalogFlagInContainer : 0u)
+            | (day.has_stats ? kCatalogFlagHasStats : 0u);
+    e.file_bytes = day.file_bytes;
+    e.first_ts_ns = day.first_ts_ns;
+    e.last_ts_ns = day.last_ts_ns;
+    for (int t = 0; t < 6; ++t) e.type_counts[t] = day.stats.type_counts[t];
+    e.min_price_ticks = day.stats.min_price_ticks;
+    e.max_price_ticks = day.stats.max_price_ticks;
+    e.executed_qty = day.stats.executed_qty;
+    e.shifts_up = day.stats.shifts_up;
+    e.shifts_down = day.stats.shifts_down;
+    e.reinits = day.stats.reinits;
+    e.checksum = fnv1a64(&e, kChecksummedBytes);
+    return e;
+}
+
+bool unpackCatalogEntry(const CatalogEntry& e, CatalogDay& out) {
+    if (e.checksum != fnv1a64(&e, kChecksummedBytes))
+        return false;
+    CatalogDay day;
+    day.symbol = fixedString(e.symbol, kCatalogSymbolBytes);
+    day.date = fixedString(e.date, kCatalogDateBytes);
+    day.file = fixedString(e.file, kCatalogFileBytes);
+    day.seed = e.seed;
+    day.open_ticks = e.open_ticks;
+    day.close_ticks = e.close_ticks;
+    day.record_count = e.record_count;
+    day.chunk_count = e.chunk_count;
+    day.file_bytes = e.file_bytes;
+    day.first_ts_ns = e.first_ts_ns;
+    day.last_ts_ns = e.last_ts_ns;
+    day.in_container = (e.flags & kCatalogFlagInContainer) != 0;
+    day.has_stats = (e.flags & kCatalogFlagHasStats) != 0;
+    for (int t = 0; t < 6; ++t) day.stats.type_counts[t] = e.type_counts[t];
+    day.stats.min_price_ticks = e.min_price_ticks;
+    day.stats.max_price_ticks = e.max_price_ticks;
+    day.stats.executed_qty = e.executed_qty;
+    day.stats.shifts_up = e.shifts_up;
+    day.stats.shifts_down = e.shifts_down;
+    day.stats.reinits = e.reinits;
+    out = std::move(day);
+    return true;
+}
+
+// --- RunCatalogWriter ---
+
+RunCatalogWriter::RunCatalogWriter(const std::string& path, bool keep_existing) : path_(path) {
+    std::error_code ec;
+    if (keep_existing && std::filesystem::exists(path, ec)) {
+        const std::vector<CatalogEntry> entries = loadEntries(path);
+        for (const CatalogEntry& e : entries)
+            keys_.emplace(fixedString(e.symbol, kCatalogSymbolBytes),
+                          fixedString(e.date, kCatalogDateBytes));
+        const uint64_t intact = sizeof(CatalogHeader) + entries.size() * sizeof(CatalogEntry);
+        std::filesystem::resize_file(path, intact, ec);
+        if (ec)
+            throw std::runtime_error("RunCatalogWriter: cannot truncate " + path + ": " + ec.message());
+        file_ = std::fopen(path.c_str(), "r+b");
+        if (!file_)
+            throw std::runtime_error("RunCatalogWriter: cannot open " + path);
+        std::fseek(file_, 0, SEEK_END);
+        return;
+    }
+    file_ = std::fopen(path.c_str(), "wb");
+    if (!file_)
+        throw std::runtime_error("RunCatalogWriter: cannot open " + path);
+    CatalogHeader hdr{};
+    std::memcpy(hdr.magic, kCatalogMagic, 4);
+    hdr.version_major = kCatalogVersionMajor;
+    hdr.version_minor = kCatalogVersionMinor;
+    hdr.entry_size = sizeof(CatalogEntry);
+    if (std::fwrite(&hdr, sizeof(hdr), 1, file_) != 1 || std::fflush(file_) != 0)
+        throw std::runtime_error("RunCatalogWriter: cannot write " + path);
+}
+
+RunCatalogWriter::~RunCatalogWriter() {
+    if (file_) std::fclose(file_);
+}
+
+bool RunCatalogWriter::add(const CatalogDay& day) {
+    const CatalogEntry entry = packCatalogEntry(day);
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!keys_.emplace(day.symbol, day.date).second)
+        return false;
+    if (std::fwrite(&entry, sizeof(entry), 1, file_) != 1 || std::fflush(file_) != 0
+        || !syncToDisk(file_))
+        throw std::runtime_error("RunCatalogWriter: cannot write " + path_);
+    return true;
+}
+
+size_t RunCatalogWriter::size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return keys_.size();
+}
+
+// --- RunCatalog ---
+
+RunCatalog::RunCatalog(const std::string& path) {
+    for (const CatalogEntry& e : loadEntries(path)) {
+        days_.emplace_back();
+        unpackCatalogEntry(e, days_.back());  // loadEntries checked the checksums
+    }
+    std::stable_sort(days_.begin(), days_.end(), [](const CatalogDay& a, const CatalogDay& b) {
+        return std::tie(a.symbol, a.date) < std::tie(b.symbol, b.date);
+    });
+}
+
+std::vector<CatalogDay> RunCatalog::query(const std::string& symbol, const std::string& first_date,
+                                          const std::string& last_date) const {
+    std::vector<CatalogDay> out;
+    auto it = days_.begin();
+    if (!symbol.empty()) {
+        it = std::lower_bound(days_.begin(), days_.end(), symbol,
+                              [](const CatalogDay& d, const std::string& s) { return d.symbol < s; });
+    }
+    for (; it != days_.end() && (symbol.empty() || it->symbol == symbol); ++it) {
+        if (!first_date.empty() && it->date < first_date) continue;
+        if (!last_date.empty() && it->date > last_date) continue;
+        out.push_back(*it);
+    }
+    return out;
+}
+
+const CatalogDay* RunCatalog::find(const std::string& symbol, const std::string& date) const {
+    const auto it = std::lower_bound(days_.begin(), days_.end(), std::tie(symbol, date),
+                                     [](const CatalogDay& d, const auto& key) {
+                                         return std::tie(d.symbol, d.date) < key;
+                                     });
+    if (it == days_.end() || it->symbol != symbol || it->date != date)
+        return nullptr;
+    return &*it;
+}
+
+bool isRunCatalog(const std::string& path) {
+    std::FILE* f = std::fopen(path.c_str(), "rb");
+    if (!f)
+        return false;
+    char magic[4] = {};
+    const bool read = std::fread(magic, 1, sizeof(magic), f) == sizeof(magic);
+    std::fclose(f);
+    return read && std::memcmp(magic, kCatalogMagic, 4) == 0;
+}
+
+}  // namespace qrsdp
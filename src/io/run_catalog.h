@@ -0,0 +1,151 @@
+#pragma once
+
+#include "io/event_log_reader.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace qrsdp {
+
+// --- Run catalogue (catalog.qcat) ---
+/// Append-only index of a run's finished days: a 16-byte header, then one
+/// 256-byte CatalogEntry per day in completion order. Each entry ends with an
+/// FNV-1a checksum of its other bytes and is synced to disk as the day finishes,
+/// so after a crash the catalogue lists exactly the days that were complete;
+/// a torn last entry is ignored.
+constexpr char     kCatalogMagic[4] = {'Q','C','A','T'};
+constexpr uint16_t kCatalogVersionMajor = 1;
+constexpr uint16_t kCatalogVersionMinor = 0;
+constexpr size_t   kCatalogSymbolBytes = 16;
+constexpr size_t   kCatalogDateBytes = 16;
+constexpr size_t   kCatalogFileBytes = 64;
+constexpr uint32_t kCatalogFlagInContainer = 1u << 0;  // file names a session of the run's container
+constexpr uint32_t kCatalogFlagHasStats = 1u << 1;     // the stats fields are filled
+constexpr const char* kRunCatalogName = "catalog.qcat";
+
+#pragma pack(push, 1)
+struct CatalogHeader {
+    char     magic[4];
+    uint16_t version_major;
+    uint16_t version_minor;
+    uint32_t entry_size;     // sizeof(CatalogEntry)
+    uint32_t reserved;       // must be 0
+};
+#pragma pack(pop)
+static_assert(sizeof(CatalogHeader) == 16, "CatalogHeader must be 16 bytes");
+
+#pragma pack(push, 1)
+struct CatalogEntry {
+    char     symbol[kCatalogSymbolBytes];  // NUL-padded; empty in single-security runs
+    char     date[kCatalogDateBytes];      // "YYYY-MM-DD", NUL-padded
+    char     file[kCatalogFileBytes];      // relative to the run directory, NUL-padded
+    uint64_t seed;
+    int32_t  open_ticks;
+    int32_t  close_ticks;
+    uint64_t record_count;
+    uint32_t chunk_count;
+    uint32_t flags;          // kCatalogFlag*
+    uint64_t file_bytes;
+    uint64_t first_ts_ns;
+    uint64_t last_ts_ns;
+    uint64_t type_counts[6]; // the day file's stats block totals (LogStats)
+    int32_t  min_price_ticks;
+    int32_t  max_price_ticks;
+    uint64_t executed_qty;
+    uint64_t shifts_up;
+    uint64_t shifts_down;
+    uint64_t reinits;
+    uint64_t reserved;       // must be 0
+    uint64_t checksum;       // FNV-1a 64 of the 248 bytes before it
+};
+#pragma pack(pop)
+static_assert(sizeof(CatalogEntry) == 256, "CatalogEntry must be 256 bytes");
+
+/// One catalogue entry with its strings unpacked.
+struct CatalogDay {
+    std::string symbol;
+    std::string date;
+    std::string file;
+    uint64_t seed = 0;
+    int32_t  open_ticks = 0;
+    int32_t  close_ticks = 0;
+    uint64_t record_count = 0;
+    uint32_t chunk_count = 0;
+    uint64_t file_bytes = 0;
+    uint64_t first_ts_ns = 0;
+    uint64_t last_ts_ns = 0;
+    bool in_container = false;
+    bool has_stats = false;
+    LogStats stats;
+};
+
+/// The parts of a CatalogDay a finished log answers from its index and footer
+/// (counts, time range, stats); no chunk is decoded.
+CatalogDay catalogDay(const EventLogReader& reader, const std::string& symbol, const std::string& date,
+                      const std::string& file);
+
+/// The entry RunCatalogWriter appends for day, checksum included. Throws
+/// std::runtime_error if a string does not fit its field.
+CatalogEntry packCatalogEntry(const CatalogDay& day);
+/// Unpacks e into out; false (out untouched) if its checksum does not match.
+bool unpackCatalogEntry(const CatalogEntry& e, CatalogDay& out);
+
+/// Appends days to a catalogue as they finish. add() may be called from several
+/// threads.
+class RunCatalogWriter {
+public:
+    /// With keep_existing, reopens the catalogue at path (if any), cuts off a torn
+    /// last entry and keeps the rest, so days already listed are not added again;
+    /// otherwise starts an empty one. Throws std::runtime_error on failure.
+    RunCatalogWriter(const std::string& path, bool keep_existing);
+    ~RunCatalogWriter();
+
+    RunCatalogWriter(const RunCatalogWriter&) = delete;
+    RunCatalogWriter& operator=(const RunCatalogWriter&) = delete;
+
+    /// Appends day and syncs it to disk. Returns false (nothing written) if
+    /// (symbol, date) is already listed. Throws std::runtime_error if a string does
+    /// not fit its field or the write fails.
+    bool add(const CatalogDay& day);
+
+    size_t size() const;
+
+private:
+    std::string path_;
+    std::FILE* file_ = nullptr;
+    std::set<std::pair<std::string, std::string>> keys_;
+    mutable std::mutex mutex_;
+};
+
+/// Read side: loads every intact entry.
+class RunCatalog {
+public:
+    /// Throws std::runtime_error if path is not a catalogue or an entry before the
+    /// last one is corrupt.
+    explicit RunCatalog(const std::string& path);
+
+    /// Days sorted by (symbol, date).
+    const std::vector<CatalogDay>& days() const { return days_; }
+    size_t size() const { return days_.size(); }
+
+    /// Days of symbol (every symbol if empty) with first_date <= date <= last_date
+    /// (either bound may be empty), sorted by (symbol, date).
+    std::vector<CatalogDay> query(const std::string& symbol, const std::string& first_date = "",
+                                  const std::string& last_date = "") const;
+    /// Entry for (symbol, date) by binary search, or nullptr.
+    const CatalogDay* find(const std::string& symbol, const std::string& date) const;
+
+private:
+    std::vector<CatalogDay> days_;
+};
+
+/// True if the file at path starts with the catalogue magic.
+bool isRunCatalog(const std::string& path);
+
+}  // namespace qrsdp
@@ -0,0 +1,80 @@
+#include "io/segmented_event_store.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace qrsdp {
+
+SegmentedEventStore::SegmentedEventStore(size_t block_records, size_t retain_last) : retain_(retain_last) {
+    shift_ = 0;
+    while ((size_t{1} << shift_) < std::max<size_t>(block_records, 1)) ++shift_;
+    mask_ = (size_t{1} << shift_) - 1;
+}
+
+void SegmentedEventStore::append(const EventRecord* recs, size_t n) {
+    if (retain_ != 0 && n >= retain_) {
+        // Only the batch's tail survives the window; skip copying the rest.
+        appended_ += n - retain_;
+        recs += n - retain_;
+        n = retain_;
+        dropFront(size_);
+    }
+    appended_ += n;
+    while (n > 0) {
+        const size_t pos = head_ + size_;
+        if ((pos >> shift_) == blocks_.size()) blocks_.push_back(takeBlock());
+        const size_t off = pos & mask_;
+        const size_t take = std::min(n, blockRecords() - off);
+        std::memcpy(blocks_[pos >> shift_] + off, recs, take * sizeof(EventRecord));
+        size_ += take;
+        recs += take;
+        n -= take;
+        if (retain_ != 0 && size_ > retain_) dropFront(size_ - retain_);
+    }
+}
+
+void SegmentedEventStore::reserve(size_t n) {
+    const size_t blocks = (head_ + n + mask_) >> shift_;
+    while (blocks_.size() + free_.size() < blocks) {
+        arena_.push_back(std::make_unique<EventRecord[]>(blockRecords()));
+        free_.push_back(arena_.back().get());
+    }
+}
+
+void SegmentedEventStore::clear() {
+    dropFront(size_);
+    while (!blocks_.empty()) {
+        free_.push_back(blocks_.back());
+        blocks_.pop_back();
+    }
+    head_ = 0;
+}
+
+std::vector<EventRecord> SegmentedEventStore::toVector() const {
+    std::vector<EventRecord> out;
+    out.reserve(size_);
+    forEachSpan([&out](const EventRecord* data, size_t n) { out.insert(out.end(), data, data + n); });
+    return out;
+}
+
+EventRecord* SegmentedEventStore::takeBlock() {
+    if (free_.empty()) {
+        arena_.push_back(std::make_unique<EventRecord[]>(blockRecords()));
+        return arena_.back().get();
+    }
+    EventRecord* block = free_.back();
+    free_.pop_back();
+    return block;
+}
+
+void SegmentedEventStore::dropFront(size_t n) {
+    head_ += n;
+    size_ -= n;
+    while (head_ > mask_ && !blocks_.empty()) {
+        free_.push_back(blocks_.front());
+        blocks_.pop_front();
+        head_ -= blockRecords();
+    }
+}
+
+}  // namespace qrsdp
@@ -0,0 +1,119 @@
+#pragma once
+
+#include "core/records.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <iterator>
+#include <memory>
+#include <vector>
+
+namespace qrsdp {
+
+/// Append-only record store made of fixed-size blocks. Blocks come from the
+/// store's own arena and are never moved, so appending is O(1) with no
+/// reallocation spike, and a record's address is stable until it is dropped or
+/// the store is cleared. With retain_last > 0 it keeps only the newest
+/// retain_last records: blocks that fall out of the window go back to the arena
+/// and are reused, so memory stays at about retain_last + one block of records.
+class SegmentedEventStore {
+public:
+    /// Records per block (rounded up to a power of two): 8192 x 32 B = 256 KiB.
+    static constexpr size_t kDefaultBlockRecords = 8192;
+
+    class const_iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = EventRecord;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const EventRecord*;
+        using reference = const EventRecord&;
+
+        const_iterator() = default;
+        reference operator*() const { return (*store_)[i_]; }
+        pointer operator->() const { return &(*store_)[i_]; }
+        const_iterator& operator++() { ++i_; return *this; }
+        const_iterator operator++(int) { const_iterator t = *this; ++i_; return t; }
+        bool operator==(const const_iterator& o) const { return i_ == o.i_; }
+        bool operator!=(const const_iterator& o) const { return i_ != o.i_; }
+
+    private:
+        friend class SegmentedEventStore;
+        const_iterator(const SegmentedEventStore* store, size_t i) : store_(store), i_(i) {}
+        const SegmentedEventStore* store_ = nullptr;
+        size_t i_ = 0;
+    };
+
+    explicit SegmentedEventStore(size_t block_records = kDefaultBlockRecords, size_t retain_last = 0);
+
+    void append(const EventRecord& rec) {
+        const size_t pos = head_ + size_;
+        if ((pos >> shift_) == blocks_.size()) blocks_.push_back(takeBlock());
+        blocks_[pos >> shift_][pos & mask_] = rec;
+        ++size_;
+        ++appended_;
+        if (retain_ != 0 && size_ > retain_) dropFront(size_ - retain_);
+    }
+    void append(const EventRecord* recs, size_t n);
+
+    /// Allocates blocks up front so the first n records need no allocation.
+    void reserve(size_t n);
+    /// Drops every record; the blocks stay in the arena for reuse.
+    void clear();
+
+    /// Records held (at most retain_last when it is set).
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    /// Records ever appended, including those the retention window dropped.
+    uint64_t appended() const { return appended_; }
+    /// Records the arena has room for (held + free blocks).
+    size_t capacity() const { return arena_.size() << shift_; }
+    size_t blockRecords() const { return mask_ + 1; }
+    size_t retainLast() const { return retain_; }
+
+    /// i-th held record, oldest first.
+    const EventRecord& operator[](size_t i) const {
+        const size_t pos = head_ + i;
+        return blocks_[pos >> shift_][pos & mask_];
+    }
+    const EventRecord& front() const { return (*this)[0]; }
+    const EventRecord& back() const { return (*this)[size_ - 1]; }
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, size_); }
+
+    /// Calls fn(const EventRecord* data, size_t n) for each contiguous run of
+    /// held records, oldest first (one per block).
+    template <class Fn>
+    void forEachSpan(Fn&& fn) const {
+        size_t pos = head_;
+        size_t left = size_;
+        for (size_t b = 0; left > 0; ++b) {
+            const size_t off = pos & mask_;
+            const size_t n = std::min(left, blockRecords() - off);
+            fn(blocks_[b] + off, n);
+            pos += n;
+            left -= n;
+        }
+    }
+
+    /// Copy of the held records in one vector.
+    std::vector<EventRecord> toVector() const;
+
+private:
+    EventRecord* takeBlock();
+    void dropFront(size_t n);
+
+    size_t shift_;
+    size_t mask_;
+    size_t retain_;
+    std::vector<std::unique_ptr<EventRecord[]>> arena_;  // owns every block
+    std::vector<EventRecord*> free_;                      // arena blocks not in use
+    std::deque<EventRecord*> blocks_;                     // in use, oldest first
+    size_t head_ = 0;                                     // first held record in blocks_[0]
+    size_t size_ = 0;
+    uint64_t appended_ = 0;
+};
+
+}  // namespace qrsdp
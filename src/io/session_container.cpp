@@ -0,0 +1,220 @@
+#include "io/session_container.h"
+#include "io/event_log_format.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+
+namespace qrsdp {
+
+namespace {
+
+constexpr size_t kCopyBufferBytes = 1 << 20;
+constexpr uint64_t kImageAlignment = 8;
+
+std::string fixedString(const char* s, size_t max) {
+    return std::string(s, strnlen(s, max));
+}
+
+bool entryLess(const ContainerEntry& a, const ContainerEntry& b) {
+    const int by_symbol = std::strncmp(a.symbol, b.symbol, kContainerSymbolBytes);
+    return by_symbol != 0 ? by_symbol < 0 : std::strncmp(a.date, b.date, kContainerDateBytes) < 0;
+}
+
+}  // namespace
+
+// --- SessionContainerWriter ---
+
+SessionContainerWriter::SessionContainerWriter(const std::string& path) : path_(path) {
+    file_ = std::fopen(path.c_str(), "wb");
+    if (!file_)
+        throw std::runtime_error("SessionContainerWriter: cannot open " + path);
+    ContainerHeader hdr{};
+    std::memcpy(hdr.magic, kContainerMagic, 8);
+    hdr.version_major = kContainerVersionMajor;
+    hdr.version_minor = kContainerVersionMinor;
+    std::fwrite(&hdr, sizeof(hdr), 1, file_);
+    copy_buf_.resize(kCopyBufferBytes);
+}
+
+SessionContainerWriter::~SessionContainerWriter() {
+    try {
+        close();
+    } catch (...) {
+        // Destructors must not throw; call close() explicitly to see write errors.
+    }
+}
+
+void SessionContainerWriter::addSession(const std::string& symbol, const std::string& date,
+                                        const std::string& log_path) {
+    if (symbol.size() >= kContainerSymbolBytes || date.size() >= kContainerDateBytes)
+        throw std::runtime_error("SessionContainerWriter: key too long: " + symbol + " " + date);
+
+    ContainerEntry entry{};
+    std::memcpy(entry.symbol, symbol.data(), symbol.size());
+    std::memcpy(entry.date, date.data(), date.size());
+    {
+        // A session without events has no footer; any other must be complete.
+        const EventLogReader reader(log_path);
+        if (reader.chunkCount() > 0 && !(reader.header().header_flags & kHeaderFlagHasIndex))
+            throw std::runtime_error("SessionContainerWriter: " + log_path + " is not finished");
+        entry.record_count = reader.totalRecords();
+        entry.chunk_count = reader.chunkCount();
+    }
+
+    std::FILE* in = std::fopen(log_path.c_str(), "rb");
+    if (!in)
+        throw std::runtime_error("SessionContainerWriter: cannot open " + log_path);
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!file_) {
+        std::fclose(in);
+        throw std::runtime_error("SessionContainerWriter: " + path_ + " is closed");
+    }
+    for (const ContainerEntry& e : entries_) {
+        if (!entryLess(e, entry) && !entryLess(entry, e)) {
+            std::fclose(in);
+            throw std::runtime_error("SessionContainerWriter: duplicate session " + symbol + " " + date);
+        }
+    }
+
+    static const char kPadding[kImageAlignment] = {};
+    const uint64_t pad = (kImageAlignment - end_ % kImageAlignment) % kImageAlignment;
+    std::fwrite(kPadding, 1, static_cast<size_t>(pad), file_);
+    entry.offset = end_ + pad;
+    uint64_t copied = 0;
+    bool ok = true;
+    size_t n;
+    while ((n = std::fread(copy_buf_.data(), 1, copy_buf_.size(), in)) > 0) {
+        ok = ok && std::fwrite(copy_buf_.data(), 1, n, file_) == n;
+        copied += n;
+    }
+    ok = ok && !std::ferror(in);
+    std::fclose(in);
+    if (!ok)
+        throw std::runtime_error("SessionContainerWriter: cannot copy " + log_path + " into " + path_);
+    entry.size = copied;
+    // The footer is the index entries followed by the tail, at the very end.
+    entry.index_offset = entry.chunk_count > 0
+        ? entry.offset + copied - sizeof(IndexTail) - uint64_t{entry.chunk_count} * sizeof(IndexEntry)
+        : entry.offset + copied;
+    entries_.push_back(entry);
+    end_ = entry.offset + copied;
+}
+
+void SessionContainerWriter::close() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!file_)
+        return;
+    std::vector<ContainerEntry> sorted = entries_;
+    std::sort(sorted.begin(), sorted.end(), entryLess);
+    std::fwrite(sorted.data(), sizeof(ContainerEntry), sorted.size(), file_);
+    ContainerTail tail{};
+    tail.session_count = static_cast<uint32_t>(sorted.size());
+    std::memcpy(tail.dir_magic, kContainerDirMagic, 4);
+    tail.directory_offset = end_;
+    std::fwrite(&tail, sizeof(tail), 1, file_);
+
+    std::fseek(file_, static_cast<long>(offsetof(ContainerHeader, flags)), SEEK_SET);
+    const uint32_t flags = kContainerFlagHasDirectory;
+    std::fwrite(&flags, sizeof(flags), 1, file_);
+    const bool ok = !std::ferror(file_);
+    const bool closed = std::fclose(file_) == 0;
+    file_ = nullptr;
+    if (!ok || !closed)
+        throw std::runtime_error("SessionContainerWriter: cannot write " + path_);
+}
+
+size_t SessionContainerWriter::sessionCount() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return entries_.size();
+}
+
+// --- SessionContainer ---
+
+SessionContainer::SessionContainer(const std::string& path)
+    : path_(path), mapping_(std::make_shared<const MappedFile>(path)) {
+    const char* data = mapping_->data();
+    const size_t size = mapping_->size();
+    ContainerHeader hdr{};
+    if (size < sizeof(hdr) + sizeof(ContainerTail))
+        throw std::runtime_error("SessionContainer: " + path + " is too short");
+    std::memcpy(&hdr, data, sizeof(hdr));
+    if (std::memcmp(hdr.magic, kContainerMagic, 8) != 0)
+        throw std::runtime_error("SessionContainer: invalid magic in " + path);
+    if (hdr.version_major != kContainerVersionMajor)
+        throw std::runtime_error("SessionContainer: unsupported version in " + path);
+    if (!(hdr.flags & kContainerFlagHasDirectory))
+        throw std::runtime_error("SessionContainer: " + path + " has no directory (unfinished)");
+
+    ContainerTail tail{};
+    std::memcpy(&tail, data + size - sizeof(tail), sizeof(tail));
+    const uint64_t dir_bytes = static_cast<uint64_t>(tail.session_count) * sizeof(ContainerEntry);
+    if (std::memcmp(tail.dir_magic, kContainerDirMagic, 4) != 0
+        || tail.directory_offset < sizeof(hdr) || tail.directory_offset > size - sizeof(tail)
+        || dir_bytes != size - sizeof(tail) - tail.directory_offset)
+        throw std::runtime_error("SessionContainer: invalid directory in " + path);
+
+    sessions_.reserve(tail.session_count);
+    const ContainerEntry* prev = nullptr;
+    std::vector<ContainerEntry> entries(tail.session_count);
+    std::memcpy(entries.data(), data + tail.directory_offset, static_cast<size_t>(dir_bytes));
+    for (const ContainerEntry& e : entries) {
+        if (e.offset < sizeof(hdr) || e.offset > tail.directory_offset
+            || e.size > tail.directory_offset - e.offset
+            || e.index_offset < e.offset || e.index_offset > e.offset + e.size
+            || (prev && !entryLess(*prev, e)))
+            throw std::runtime_error("SessionContainer: invalid directory entry in " + path);
+        prev = &e;
+        ContainerSession s;
+        s.symbol = fixedString(e.symbol, kContainerSymbolBytes);
+        s.date = fixedString(e.date, kContainerDateBytes);
+        s.offset = e.offset;
+        s.size = e.size;
+        s.index_offset = e.index_offset;
+        s.record_count = e.record_count;
+        s.chunk_count = e.chunk_count;
+        sessions_.push_back(std::move(s));
+    }
+}
+
+const ContainerSession* SessionContainer::find(const std::string& symbol,
+                                               const std::string& date) const {
+    const auto it = std::lower_bound(
+        sessions_.begin(), sessions_.end(), std::tie(symbol, date),
+        [](const ContainerSession& s, const std::tuple<const std::string&, const std::string&>& key) {
+            return std::tie(s.symbol, s.date) < key;
+        });
+    if (it == sessions_.end() || it->symbol != symbol || it->date != date)
+        return nullptr;
+    return &*it;
+}
+
+std::unique_ptr<EventLogReader> SessionContainer::open(size_t idx) const {
+    if (idx >= sessions_.size())
+        throw std::out_of_range("SessionContainer: session index out of range");
+    const ContainerSession& s = sessions_[idx];
+    const std::string name = path_ + "[" + (s.symbol.empty() ? "" : s.symbol + "/") + s.date + "]";
+    return std::make_unique<EventLogReader>(mapping_, s.offset, s.size, name);
+}
+
+std::unique_ptr<EventLogReader> SessionContainer::open(const std::string& symbol,
+                                                       const std::string& date) const {
+    const ContainerSession* s = find(symbol, date);
+    if (!s)
+        throw std::out_of_range("SessionContainer: no session " + symbol + " " + date + " in " + path_);
+    return open(static_cast<size_t>(s - sessions_.data()));
+}
+
+bool isSessionContainer(const std::string& path) {
+    std::FILE* f = std::fopen(path.c_str(), "rb");
+    if (!f)
+        return false;
+    char magic[8] = {};
+    const bool read = std::fread(magic, 1, sizeof(magic), f) == sizeof(magic);
+    std::fclose(f);
+    return read && std::memcmp(magic, kContainerMagic, 8) == 0;
+}
+
+}  // namespace qrsdp
@@ -0,0 +1,134 @@
+#pragma once
+
+#include "io/event_log_reader.h"
+#include "io/mapped_file.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace qrsdp {
+
+// --- Session container (.qrsc) ---
+/// Many complete .qrsdp session images in one file: a 32-byte header, the images
+/// back to back (each starting 8-byte aligned), a directory of one
+/// ContainerEntry per session sorted by (symbol, date), and a ContainerTail.
+/// Offsets are absolute in the container; inside an image they stay relative to
+/// the image, so each session reads exactly like the stand-alone file.
+constexpr char     kContainerMagic[8] = {'Q','R','S','D','P','C','T','R'};
+constexpr uint16_t kContainerVersionMajor = 1;
+constexpr uint16_t kContainerVersionMinor = 0;
+constexpr char     kContainerDirMagic[4] = {'Q','C','D','R'};
+constexpr uint32_t kContainerFlagHasDirectory = 1u << 0;
+constexpr size_t   kContainerSymbolBytes = 16;
+constexpr size_t   kContainerDateBytes = 16;
+
+#pragma pack(push, 1)
+struct ContainerHeader {
+    char     magic[8];
+    uint16_t version_major;
+    uint16_t version_minor;
+    uint32_t flags;          // kContainerFlagHasDirectory once close()d
+    uint64_t reserved[2];    // must be 0
+};
+#pragma pack(pop)
+static_assert(sizeof(ContainerHeader) == 32, "ContainerHeader must be 32 bytes");
+
+#pragma pack(push, 1)
+struct ContainerEntry {
+    char     symbol[kContainerSymbolBytes];  // NUL-padded; empty in single-security runs
+    char     date[kContainerDateBytes];      // "YYYY-MM-DD", NUL-padded
+    uint64_t offset;         // session image start
+    uint64_t size;           // session image bytes
+    uint64_t index_offset;   // the image's chunk index footer (absolute)
+    uint64_t record_count;
+    uint32_t chunk_count;
+    uint32_t reserved;       // must be 0
+};
+#pragma pack(pop)
+static_assert(sizeof(ContainerEntry) == 72, "ContainerEntry must be 72 bytes");
+
+#pragma pack(push, 1)
+struct ContainerTail {
+    uint32_t session_count;
+    char     dir_magic[4];   // "QCDR"
+    uint64_t directory_offset;
+};
+#pragma pack(pop)
+static_assert(sizeof(ContainerTail) == 16, "ContainerTail must be 16 bytes");
+
+/// One directory entry with its strings unpacked.
+struct ContainerSession {
+    std::string symbol;
+    std::string date;
+    uint64_t offset = 0;
+    uint64_t size = 0;
+    uint64_t index_offset = 0;
+    uint64_t record_count = 0;
+    uint32_t chunk_count = 0;
+};
+
+/// Packs finished .qrsdp files into a container. addSession() may be called from
+/// several threads; sessions are stored in call order and listed sorted.
+class SessionContainerWriter {
+public:
+    /// Creates the file and writes the header. Throws std::runtime_error on failure.
+    explicit SessionContainerWriter(const std::string& path);
+    ~SessionContainerWriter();
+
+    SessionContainerWriter(const SessionContainerWriter&) = delete;
+    SessionContainerWriter& operator=(const SessionContainerWriter&) = delete;
+
+    /// Copies the complete (footer-indexed) log at log_path in as (symbol, date).
+    /// Throws std::runtime_error if the log is unfinished, the key is a duplicate or
+    /// too long, or the copy fails.
+    void addSession(const std::string& symbol, const std::string& date, const std::string& log_path);
+
+    /// Writes the directory and tail and sets HAS_DIRECTORY. Idempotent.
+    void close();
+
+    size_t sessionCount() const;
+
+private:
+    std::string path_;
+    std::FILE* file_ = nullptr;
+    uint64_t end_ = sizeof(ContainerHeader);
+    std::vector<ContainerEntry> entries_;
+    std::vector<char> copy_buf_;
+    mutable std::mutex mutex_;
+};
+
+/// Read side: maps the container once and opens any session as an EventLogReader
+/// over its slice of the mapping (no further opens or copies).
+class SessionContainer {
+public:
+    /// Maps the file and parses the directory. Throws std::runtime_error if it is
+    /// not a finished container or the directory is inconsistent.
+    explicit SessionContainer(const std::string& path);
+
+    /// Sessions sorted by (symbol, date).
+    const std::vector<ContainerSession>& sessions() const { return sessions_; }
+    size_t size() const { return sessions_.size(); }
+
+    /// Entry for (symbol, date) by binary search, or nullptr.
+    const ContainerSession* find(const std::string& symbol, const std::string& date) const;
+
+    /// Reader over session idx. Throws std::out_of_range if idx >= size().
+    std::unique_ptr<EventLogReader> open(size_t idx) const;
+    /// Reader over (symbol, date). Throws std::out_of_range if there is no such session.
+    std::unique_ptr<EventLogReader> open(const std::string& symbol, const std::string& date) const;
+
+private:
+    std::string path_;
+    std::shared_ptr<const MappedFile> mapping_;
+    std::vector<ContainerSession> sessions_;
+};
+
+/// True if the file at path starts with the container magic.
+bool isSessionContainer(const std::string& path);
+
+}  // namespace qrsdp
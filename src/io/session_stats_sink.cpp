@@ -0,0 +1,164 @@
+#include "io/session_stats_sink.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace qrsdp {
+
+void ReturnMoments::merge(const ReturnMoments& other) {
+    n += other.n;
+    sum += other.sum;
+    sum2 += other.sum2;
+    sum3 += other.sum3;
+    sum4 += other.sum4;
+}
+
+double ReturnMoments::mean() const {
+    return n > 0 ? sum / static_cast<double>(n) : 0.0;
+}
+
+double ReturnMoments::stdev() const {
+    if (n == 0) return 0.0;
+    const double m = mean();
+    return std::sqrt(std::max(0.0, sum2 / static_cast<double>(n) - m * m));
+}
+
+// Central moments from the power sums: m3 = E[r^3] - 3 m E[r^2] + 2 m^3,
+// m4 = E[r^4] - 4 m E[r^3] + 6 m^2 E[r^2] - 3 m^4.
+double ReturnMoments::skewness() const {
+    if (n < 2) return 0.0;
+    const double k = static_cast<double>(n);
+    const double m = mean();
+    const double var = sum2 / k - m * m;
+    if (!(var > 0.0)) return 0.0;
+    const double m3 = sum3 / k - 3.0 * m * (sum2 / k) + 2.0 * m * m * m;
+    return m3 / (var * std::sqrt(var));
+}
+
+double ReturnMoments::excessKurtosis() const {
+    if (n < 2) return 0.0;
+    const double k = static_cast<double>(n);
+    const double m = mean();
+    const double var = sum2 / k - m * m;
+    if (!(var > 0.0)) return 0.0;
+    const double m4 = sum4 / k - 4.0 * m * (sum3 / k) + 6.0 * m * m * (sum2 / k) - 3.0 * m * m * m * m;
+    return m4 / (var * var) - 3.0;
+}
+
+double SessionStats::meanSpread() const {
+    uint64_t n = 0;
+    double total = 0.0;
+    for (size_t s = 0; s < spread_counts.size(); ++s) {
+        n += spread_counts[s];
+        total += static_cast<double>(s) * static_cast<double>(spread_counts[s]);
+    }
+    return n > 0 ? total / static_cast<double>(n) : 0.0;
+}
+
+double SessionStats::spreadShare(uint32_t s) const {
+    uint64_t n = 0;
+    for (uint64_t c : spread_counts) n += c;
+    const size_t i = std::min<size_t>(s, kMaxTrackedSpread);
+    return n > 0 && i < spread_counts.size() ? static_cast<double>(spread_counts[i]) / static_cast<double>(n)
+                                             : 0.0;
+}
+
+void SessionStats::merge(const SessionStats& other) {
+    if (events == 0) {
+        open_mid = other.open_mid;
+        high_mid = other.high_mid;
+        low_mid = other.low_mid;
+    } else if (other.events > 0) {
+        high_mid = std::max(high_mid, other.high_mid);
+        low_mid = std::min(low_mid, other.low_mid);
+    }
+    if (other.events > 0 || events == 0) close_mid = other.close_mid;
+    events += other.events;
+    shifts += other.shifts;
+    for (int t = 0; t < kNumEventTypes; ++t) type_counts[t] += other.type_counts[t];
+    bar_returns.merge(other.bar_returns);
+    if (spread_counts.size() < other.spread_counts.size()) spread_counts.resize(other.spread_counts.size(), 0);
+    for (size_t s = 0; s < other.spread_counts.size(); ++s) spread_counts[s] += other.spread_counts[s];
+}
+
+SessionStatsSink::SessionStatsSink(const BookSeed& seed, uint64_t market_open_ns, double bar_seconds)
+    : bar_ns_(std::max<uint64_t>(1, static_cast<uint64_t>(bar_seconds * 1e9))) {
+    reset(seed, market_open_ns);
+}
+
+void SessionStatsSink::reset(const BookSeed& seed, uint64_t market_open_ns) {
+    book_.seed(seed);
+    restart(market_open_ns);
+}
+
+bool SessionStatsSink::reset(const BookSeed& seed, uint64_t market_open_ns, const Level* bids,
+                             const Level* asks) {
+    book_.seed(seed);
+    const bool restored = book_.restore(bids, asks);
+    restart(market_open_ns);
+    return restored;
+}
+
+void SessionStatsSink::restart(uint64_t market_open_ns) {
+    open_ns_ = market_open_ns;
+    stats_ = SessionStats{};
+    const double mid = (book_.bestBid().price_ticks + book_.bestAsk().price_ticks) / 2.0;
+    stats_.open_mid = mid;
+    stats_.high_mid = mid;
+    stats_.low_mid = mid;
+    stats_.close_mid = mid;
+    bar_ = 0;
+    has_bar_ = false;
+    has_prev_ = false;
+    bar_close_ = mid;
+    prev_close_ = mid;
+}
+
+void SessionStatsSink::append(const EventRecord& rec) {
+    const uint64_t bar = rec.ts_ns > open_ns_ ? (rec.ts_ns - open_ns_) / bar_ns_ : 0;
+    if (has_bar_ && bar != bar_) {
+        if (has_prev_) stats_.bar_returns.add(bar_close_ - prev_close_);
+        prev_close_ = bar_close_;
+        has_prev_ = true;
+    }
+
+    const int32_t prev_bid = book_.bestBid().price_ticks;
+    const int32_t prev_ask = book_.bestAsk().price_ticks;
+    SimEvent ev;
+    ev.type = static_cast<EventType>(rec.type);
+    ev.side = static_cast<Side>(rec.side);
+    ev.price_ticks = rec.price_ticks;
+    ev.qty = rec.qty;
+    ev.order_id = rec.order_id;
+    book_.apply(ev);
+    const int32_t bid = book_.bestBid().price_ticks;
+    const int32_t ask = book_.bestAsk().price_ticks;
+
+    if (bid != prev_bid || ask != prev_ask) {
+        ++stats_.shifts;
+        const double mid = (bid + ask) / 2.0;
+        stats_.high_mid = std::max(stats_.high_mid, mid);
+        stats_.low_mid = std::min(stats_.low_mid, mid);
+        stats_.close_mid = mid;
+    }
+    const int spread = ask - bid;
+    const size_t bucket = spread < 0 ? 0 : std::min<size_t>(static_cast<size_t>(spread), SessionStats::kMaxTrackedSpread);
+    ++stats_.spread_counts[bucket];
+    if (rec.type < kNumEventTypes) ++stats_.type_counts[rec.type];
+    ++stats_.events;
+    bar_ = bar;
+    has_bar_ = true;
+    bar_close_ = stats_.close_mid;
+}
+
+void SessionStatsSink::appendBatch(const EventRecord* recs, size_t n) {
+    for (size_t i = 0; i < n; ++i) append(recs[i]);
+}
+
+SessionStats SessionStatsSink::stats() const {
+    SessionStats out = stats_;
+    if (has_bar_ && has_prev_) out.bar_returns.add(bar_close_ - prev_close_);
+    return out;
+}
+
+}  // namespace qrsdp
@@ -0,0 +1,103 @@
+#pragma once
+
+#include "book/multi_level_book.h"
+#include "core/event_types.h"
+#include "core/records.h"
+#include "io/i_event_sink.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace qrsdp {
+
+/// Power sums of a return series; moments are the population ones numpy and
+/// scipy report by default (np.std, stats.skew, stats.kurtosis).
+struct ReturnMoments {
+    uint64_t n = 0;
+    double sum = 0.0;
+    double sum2 = 0.0;
+    double sum3 = 0.0;
+    double sum4 = 0.0;
+
+    void add(double r) {
+        const double r2 = r * r;
+        ++n;
+        sum += r;
+        sum2 += r2;
+        sum3 += r2 * r;
+        sum4 += r2 * r2;
+    }
+    void merge(const ReturnMoments& other);
+    double mean() const;
+    double stdev() const;
+    double skewness() const;        // 0 with fewer than two returns or no variance
+    double excessKurtosis() const;  // Fisher: 0 for a normal sample
+};
+
+/// Summary of one session, or of several pooled by merge().
+struct SessionStats {
+    /// Spreads of at least this many ticks share the last histogram bucket.
+    static constexpr uint32_t kMaxTrackedSpread = 32;
+
+    uint64_t events = 0;
+    uint64_t shifts = 0;            // events that moved either best price
+    uint64_t type_counts[kNumEventTypes] = {};
+    double open_mid = 0.0;          // mid (bid + ask) / 2 in ticks
+    double high_mid = 0.0;
+    double low_mid = 0.0;
+    double close_mid = 0.0;
+    ReturnMoments bar_returns;      // close-to-close mid changes of consecutive non-empty bars
+    /// [s]: events after which the spread was s ticks (s < kMaxTrackedSpread).
+    std::vector<uint64_t> spread_counts = std::vector<uint64_t>(kMaxTrackedSpread + 1, 0);
+
+    double meanSpread() const;
+    /// Share of events after which the spread was s ticks.
+    double spreadShare(uint32_t s) const;
+    /// Pools other's counts, spreads and returns into these. The OHLC becomes
+    /// the extremes of both, opening at this one's open and closing at other's close.
+    void merge(const SessionStats& other);
+};
+
+/// IEventSink that keeps only SessionStats: no records are stored or written.
+/// Records carry no book state, so the sink replays them through its own
+/// MultiLevelBook seeded like the producer's and reads the touch from it after
+/// each record. Returns are taken over bars of bar_seconds from the market open,
+/// as notebooks/ohlc.py bars the mid (bars with no events are skipped).
+///
+/// The replayed book follows the producer's exactly unless the run reinitialises
+/// depths after shifts (queue_reactive.theta_reinit > 0), whose draws the records
+/// do not carry.
+class SessionStatsSink final : public IEventSink {
+public:
+    SessionStatsSink(const BookSeed& seed, uint64_t market_open_ns, double bar_seconds = 10.0);
+
+    void append(const EventRecord& rec) override;
+    void appendBatch(const EventRecord* recs, size_t n) override;
+
+    /// Starts a new session: reseeds the book and clears the stats.
+    void reset(const BookSeed& seed, uint64_t market_open_ns);
+    /// Starts part-way through a session (a forked branch): as reset(), then the
+    /// book takes the given levels (best first, levels_per_side each) and the
+    /// stats open at their mid. Returns false if the levels cannot be restored.
+    bool reset(const BookSeed& seed, uint64_t market_open_ns, const Level* bids, const Level* asks);
+
+    /// The stats so far, including the return into the bar in progress.
+    SessionStats stats() const;
+
+private:
+    /// Clears the stats, opening at the book's current mid.
+    void restart(uint64_t market_open_ns);
+
+    MultiLevelBook book_;
+    SessionStats stats_;
+    uint64_t open_ns_ = 0;
+    uint64_t bar_ns_ = 0;
+    uint64_t bar_ = 0;              // bar of the last record
+    bool has_bar_ = false;
+    double bar_close_ = 0.0;        // mid after the last record
+    bool has_prev_ = false;
+    double prev_close_ = 0.0;       // close of the last finished non-empty bar
+};
+
+}  // namespace qrsdp
@@ -0,0 +1,96 @@
+#include "io/shm_ring_sink.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+
+namespace qrsdp {
+
+static size_t batchBytes(uint32_t records) {
+    return sizeof(EventBatchHeader) + static_cast<size_t>(records) * sizeof(DiskEventRecord);
+}
+
+ShmEventBus::ShmEventBus(const ShmRingConfig& config)
+    : config_(config), ring_(config.path, config.ring_bytes) {
+    if (config_.batch_records == 0 ||
+        batchBytes(config_.batch_records) > FrameRingWriter::maxPayload(ring_.capacity()))
+        throw std::invalid_argument("ShmEventBus: batch_records must be > 0 and fit in a quarter of the ring");
+}
+
+ShmEventBus::~ShmEventBus() { close(); }
+
+void ShmEventBus::publish(char* message, size_t size) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    EventBatchHeader* header = reinterpret_cast<EventBatchHeader*>(message);
+    header->first_seq = next_seq_;
+    ring_.publish(kRingEvents, message, size);
+    next_seq_ += header->count;
+}
+
+void ShmEventBus::close() { ring_.close(); }
+
+uint64_t ShmEventBus::published() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return next_seq_;
+}
+
+ShmRingSink::ShmRingSink(ShmEventBus& bus, uint16_t security, const std::string& symbol,
+                         const std::string& date)
+    : bus_(bus), batch_records_(bus.config().batch_records),
+      message_(batchBytes(batch_records_)) {
+    EventBatchHeader header{};
+    header.security = security;
+    std::snprintf(header.symbol, sizeof(header.symbol), "%s", symbol.c_str());
+    std::snprintf(header.date, sizeof(header.date), "%s", date.c_str());
+    std::memcpy(message_.data(), &header, sizeof(header));
+}
+
+void ShmRingSink::append(const EventRecord& rec) {
+    const DiskEventRecord disk = toDisk(rec);
+    std::memcpy(message_.data() + batchBytes(pending_), &disk, sizeof(disk));
+    if (++pending_ == batch_records_) publishPending();
+}
+
+void ShmRingSink::appendBatch(const EventRecord* recs, size_t n) {
+    while (n > 0) {
+        const uint32_t take = static_cast<uint32_t>(std::min<size_t>(n, batch_records_ - pending_));
+        toDisk(recs, take, reinterpret_cast<DiskEventRecord*>(message_.data() + batchBytes(pending_)));
+        recs += take;
+        n -= take;
+        pending_ += take;
+        if (pending_ == batch_records_) publishPending();
+    }
+    publishPending();
+}
+
+void ShmRingSink::flush() { publishPending(); }
+
+void ShmRingSink::publishPending() {
+    if (pending_ == 0) return;
+    reinterpret_cast<EventBatchHeader*>(message_.data())->count = pending_;
+    bus_.publish(message_.data(), batchBytes(pending_));
+    pending_ = 0;
+}
+
+ShmRingReader::ShmRingReader(const std::string& path, bool from_oldest)
+    : ring_(path, from_oldest) {}
+
+ShmRingReader::Poll ShmRingReader::poll(const EventBatchHeader*& header,
+                                        const DiskEventRecord*& records) {
+    for (;;) {
+        FrameRingKind kind;
+        const Poll p = ring_.poll(kind, message_);
+        if (p != Poll::Message) return p;
+        if (kind != kRingEvents || message_.size() < sizeof(EventBatchHeader)) continue;
+        header = reinterpret_cast<const EventBatchHeader*>(message_.data());
+        if (message_.size() != batchBytes(header->count)) continue;
+        records = reinterpret_cast<const DiskEventRecord*>(message_.data() + sizeof(EventBatchHeader));
+        if (started_ && header->first_seq > cursor_) lost_ += header->first_seq - cursor_;
+        started_ = true;
+        cursor_ = header->first_seq + header->count;
+        return Poll::Message;
+    }
+}
+
+}  // namespace qrsdp
@@ -0,0 +1,123 @@
+#pragma once
+
+#include "io/event_log_format.h"
+#include "io/frame_ring.h"
+#include "io/i_event_sink.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace qrsdp {
+
+// ---------------------------------------------------------------------------
+// Shared-memory event bus: the run's records, as they are generated, for any
+// number of consumers on the same host (no broker). It is a FrameRing whose
+// messages are kRingEvents batches: an EventBatchHeader, then `count`
+// DiskEventRecords. Every record has a bus sequence number (first_seq + i),
+// one sequence space for all securities, so a consumer knows exactly how many
+// records it missed when the writer overtook it.
+// ---------------------------------------------------------------------------
+
+#pragma pack(push, 1)
+struct EventBatchHeader {
+    uint64_t first_seq;   // bus sequence of the first record
+    uint32_t count;       // DiskEventRecords that follow
+    uint16_t security;    // index in the run
+    uint16_t reserved;
+    char     symbol[16];  // NUL-padded; "" for single-security runs
+    char     date[16];    // "YYYY-MM-DD"; record ts_ns count from that midnight
+};
+#pragma pack(pop)
+static_assert(sizeof(EventBatchHeader) == 48, "EventBatchHeader must be 48 bytes");
+
+struct ShmRingConfig {
+    std::string path;               // ring file (e.g. /dev/shm/qrsdp_events); empty = off
+    size_t   ring_bytes = 64u << 20;
+    uint32_t batch_records = 256;   // records per message; realtime runs publish every event
+    bool enabled() const { return !path.empty(); }
+};
+
+/// Writer end of the bus. Sinks of several securities may publish from their
+/// own threads: each batch takes its sequence numbers and goes into the ring
+/// under one short lock, so the ring itself keeps a single writer. Readers
+/// never take it and never slow the writer down.
+class ShmEventBus {
+public:
+    /// Creates the ring file. Throws std::runtime_error if it cannot, or
+    /// std::invalid_argument if batch_records does not fit in a message.
+    explicit ShmEventBus(const ShmRingConfig& config);
+    /// Marks the ring closed.
+    ~ShmEventBus();
+
+    ShmEventBus(const ShmEventBus&) = delete;
+    ShmEventBus& operator=(const ShmEventBus&) = delete;
+
+    /// message: an EventBatchHeader with count set, then the records. Fills
+    /// in first_seq and publishes it.
+    void publish(char* message, size_t size);
+
+    /// Readers drain what is left, then see the end. Idempotent.
+    void close();
+
+    const ShmRingConfig& config() const { return config_; }
+    /// Records published so far (the next sequence number).
+    uint64_t published() const;
+
+private:
+    ShmRingConfig config_;
+    FrameRingWriter ring_;
+    mutable std::mutex mutex_;
+    uint64_t next_seq_ = 0;
+};
+
+/// IEventSink onto the bus for one security's day. append() collects up to
+/// batch_records records; appendBatch(), flush() and close() publish whatever
+/// is pending, so a producer's own batching carries through.
+class ShmRingSink final : public IEventSink {
+public:
+    ShmRingSink(ShmEventBus& bus, uint16_t security, const std::string& symbol,
+                const std::string& date);
+
+    void append(const EventRecord& rec) override;
+    void appendBatch(const EventRecord* recs, size_t n) override;
+    void flush() override;
+    void close() override { flush(); }
+
+private:
+    void publishPending();
+
+    ShmEventBus& bus_;
+    uint32_t batch_records_;
+    uint32_t pending_ = 0;
+    std::vector<char> message_;  // EventBatchHeader + batch_records_ records
+};
+
+/// Reader end of the bus, in any process.
+class ShmRingReader {
+public:
+    using Poll = FrameRingReader::Poll;
+
+    /// Attaches to a bus some run created; see FrameRingReader for where it
+    /// starts. Throws std::runtime_error if path is not a ring.
+    explicit ShmRingReader(const std::string& path, bool from_oldest = false);
+
+    /// The next batch. header and records stay valid until the next call.
+    Poll poll(const EventBatchHeader*& header, const DiskEventRecord*& records);
+
+    /// Sequence number the next record should have.
+    uint64_t cursor() const { return cursor_; }
+    /// Records skipped because the writer overtook this reader.
+    uint64_t lost() const { return lost_; }
+
+private:
+    FrameRingReader ring_;
+    std::vector<char> message_;
+    uint64_t cursor_ = 0;
+    bool started_ = false;
+    uint64_t lost_ = 0;
+};
+
+}  // namespace qrsdp
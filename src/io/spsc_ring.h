@@ -0,0 +1,55 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+namespace qrsdp {
+
+/// Bounded lock-free single-producer / single-consumer ring. Capacity is rounded
+/// up to a power of two. tryPush() may only be called from one thread and tryPop()
+/// from one (other) thread; neither blocks.
+template <class T>
+class SpscRing {
+public:
+    explicit SpscRing(size_t capacity) {
+        size_t cap = 1;
+        while (cap < capacity) cap <<= 1;
+        slots_.resize(cap);
+        mask_ = cap - 1;
+    }
+
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+    size_t capacity() const { return slots_.size(); }
+
+    bool tryPush(const T& value) {
+        const size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail - head_.load(std::memory_order_acquire) == slots_.size()) return false;
+        slots_[tail & mask_] = value;
+        // seq_cst so a consumer that announces it is about to sleep cannot miss it.
+        tail_.store(tail + 1, std::memory_order_seq_cst);
+        return true;
+    }
+
+    bool tryPop(T& out) {
+        const size_t head = head_.load(std::memory_order_relaxed);
+        if (head == tail_.load(std::memory_order_acquire)) return false;
+        out = slots_[head & mask_];
+        head_.store(head + 1, std::memory_order_seq_cst);
+        return true;
+    }
+
+    bool empty() const {
+        return head_.load(std::memory_order_seq_cst) == tail_.load(std::memory_order_seq_cst);
+    }
+
+private:
+    std::vector<T> slots_;
+    size_t mask_ = 0;
+    alignas(64) std::atomic<size_t> head_{0};  // consumer
+    alignas(64) std::atomic<size_t> tail_{0};  // producer
+};
+
+}  // namespace qrsdp
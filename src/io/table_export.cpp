@@ -0,0 +1,528 @@
+#include "io/table_export.h"
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <stdexcept>
+
+namespace qrsdp {
+
+const char* const kClickHouseExportColumns =
+    "ts_ns, type, type_name, side, price_ticks, qty, order_id, symbol, date";
+
+ExportFormat parseExportFormat(const std::string& name) {
+    if (name == "rowbinary") return ExportFormat::RowBinary;
+    if (name == "native") return ExportFormat::Native;
+    if (name == "arrow") return ExportFormat::Arrow;
+    throw std::invalid_argument("unknown export format: " + name + " (rowbinary, native, arrow)");
+}
+
+const char* exportFormatName(ExportFormat format) {
+    switch (format) {
+        case ExportFormat::RowBinary: return "RowBinary";
+        case ExportFormat::Native:    return "Native";
+        case ExportFormat::Arrow:     return "Arrow";
+    }
+    return "?";
+}
+
+const char* exportFormatExtension(ExportFormat format) {
+    switch (format) {
+        case ExportFormat::RowBinary: return ".rowbinary";
+        case ExportFormat::Native:    return ".native";
+        case ExportFormat::Arrow:     return ".arrow";
+    }
+    return "";
+}
+
+int32_t daysSinceEpoch(const std::string& date) {
+    int y = 0, m = 0, d = 0;
+    bool ok = date.size() == 10 && date[4] == '-' && date[7] == '-';
+    for (size_t i = 0; ok && i < date.size(); ++i)
+        if (i != 4 && i != 7) ok = date[i] >= '0' && date[i] <= '9';
+    if (ok) {
+        y = std::stoi(date.substr(0, 4));
+        m = std::stoi(date.substr(5, 2));
+        d = std::stoi(date.substr(8, 2));
+        static const int kDays[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+        const bool leap = (y % 4 == 0 && y % 100 != 0) || y % 400 == 0;
+        ok = m >= 1 && m <= 12 && d >= 1 && d <= kDays[m - 1] + (m == 2 && leap ? 1 : 0);
+    }
+    if (!ok) throw std::invalid_argument("bad date (want YYYY-MM-DD): " + date);
+    // Civil date to day number (H. Hinnant, "chrono-compatible low-level date algorithms").
+    y -= m <= 2;
+    const int era = (y >= 0 ? y : y - 399) / 400;
+    const int yoe = y - era * 400;
+    const int doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    const int doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + doe - 719468;
+}
+
+namespace {
+
+const char* eventTypeName(uint8_t type) {
+    static const char* const kNames[] = {"ADD_BID", "ADD_ASK", "CANCEL_BID",
+                                         "CANCEL_ASK", "EXECUTE_BUY", "EXECUTE_SELL"};
+    return type < 6 ? kNames[type] : "UNKNOWN";
+}
+
+template <class T>
+void put(std::vector<char>& out, T v) {
+    const char* p = reinterpret_cast<const char*>(&v);
+    out.insert(out.end(), p, p + sizeof(T));
+}
+
+void putVarUInt(std::vector<char>& out, uint64_t v) {
+    while (v >= 0x80) {
+        out.push_back(static_cast<char>(v | 0x80));
+        v >>= 7;
+    }
+    out.push_back(static_cast<char>(v));
+}
+
+void putString(std::vector<char>& out, const char* s, size_t n) {
+    putVarUInt(out, n);
+    out.insert(out.end(), s, s + n);
+}
+
+void putString(std::vector<char>& out, const std::string& s) { putString(out, s.data(), s.size()); }
+
+void padTo8(std::vector<char>& out, size_t& pos) {
+    while (pos % 8) {
+        out.push_back(0);
+        ++pos;
+    }
+}
+
+// --- ClickHouse ------------------------------------------------------------
+
+class RowBinaryEncoder final : public ExportEncoder {
+public:
+    void batch(const DiskEventRecord* recs, size_t n, const std::string& symbol, int32_t days,
+               std::vector<char>& out) override {
+        for (size_t i = 0; i < n; ++i) {
+            const DiskEventRecord& r = recs[i];
+            put<uint64_t>(out, r.ts_ns);
+            put<uint8_t>(out, r.type);
+            const char* name = eventTypeName(r.type);
+            putString(out, name, std::strlen(name));
+            put<uint8_t>(out, r.side);
+            put<int32_t>(out, r.price_ticks);
+            put<uint32_t>(out, r.qty);
+            put<uint64_t>(out, r.order_id);
+            putString(out, symbol);
+            put<uint16_t>(out, static_cast<uint16_t>(days));
+        }
+    }
+};
+
+/// Native blocks as ClickHouse reads them over HTTP (no block info). The
+/// LowCardinality(String) columns go as String; the server converts them.
+class NativeEncoder final : public ExportEncoder {
+public:
+    void batch(const DiskEventRecord* recs, size_t n, const std::string& symbol, int32_t days,
+               std::vector<char>& out) override {
+        putVarUInt(out, 9);
+        putVarUInt(out, n);
+        column(out, "ts_ns", "UInt64");
+        for (size_t i = 0; i < n; ++i) put<uint64_t>(out, recs[i].ts_ns);
+        column(out, "type", "UInt8");
+        for (size_t i = 0; i < n; ++i) put<uint8_t>(out, recs[i].type);
+        column(out, "type_name", "String");
+        for (size_t i = 0; i < n; ++i) {
+            const char* name = eventTypeName(recs[i].type);
+            putString(out, name, std::strlen(name));
+        }
+        column(out, "side", "UInt8");
+        for (size_t i = 0; i < n; ++i) put<uint8_t>(out, recs[i].side);
+        column(out, "price_ticks", "Int32");
+        for (size_t i = 0; i < n; ++i) put<int32_t>(out, recs[i].price_ticks);
+        column(out, "qty", "UInt32");
+        for (size_t i = 0; i < n; ++i) put<uint32_t>(out, recs[i].qty);
+        column(out, "order_id", "UInt64");
+        for (size_t i = 0; i < n; ++i) put<uint64_t>(out, recs[i].order_id);
+        column(out, "symbol", "String");
+        for (size_t i = 0; i < n; ++i) putString(out, symbol);
+        column(out, "date", "Date");
+        for (size_t i = 0; i < n; ++i) put<uint16_t>(out, static_cast<uint16_t>(days));
+    }
+
+private:
+    static void column(std::vector<char>& out, const char* name, const char* type) {
+        putString(out, name, std::strlen(name));
+        putString(out, type, std::strlen(type));
+    }
+};
+
+// --- Arrow IPC ---------------------------------------------------------------
+//
+// Arrow metadata is FlatBuffers (Schema.fbs, Message.fbs, File.fbs). The small
+// builder below writes it front to back: a table's vtable, then the table,
+// then the objects its offsets point to, so every offset points forward.
+
+class FlatBuffer {
+public:
+    std::vector<char> bytes;
+
+    size_t size() const { return bytes.size(); }
+    void align(size_t a) {
+        while (bytes.size() % a) bytes.push_back(0);
+    }
+    template <class T>
+    size_t put(T v) {
+        const size_t at = bytes.size();
+        bytes.resize(at + sizeof(T));
+        std::memcpy(&bytes[at], &v, sizeof(T));
+        return at;
+    }
+    /// Points the offset slot at `slot` to the object at `target`.
+    void link(size_t slot, size_t target) {
+        const uint32_t off = static_cast<uint32_t>(target - slot);
+        std::memcpy(&bytes[slot], &off, sizeof(off));
+    }
+};
+
+/// Writes one object and returns its position.
+using FbWriter = std::function<size_t(FlatBuffer&)>;
+
+struct FbField {
+    uint16_t id;
+    size_t size;         // inline bytes: 1, 2, 4 or 8
+    uint64_t value;      // scalar bits
+    FbWriter child;      // set for offsets
+};
+
+template <class T>
+FbField fbScalar(uint16_t id, T v) {
+    FbField f{id, sizeof(T), 0, nullptr};
+    std::memcpy(&f.value, &v, sizeof(T));
+    return f;
+}
+
+FbField fbOffset(uint16_t id, FbWriter child) { return FbField{id, 4, 0, std::move(child)}; }
+
+size_t fbTable(FlatBuffer& fb, std::vector<FbField> fields) {
+    // Inline: the vtable offset, then the fields by size so each is aligned.
+    std::stable_sort(fields.begin(), fields.end(),
+                     [](const FbField& a, const FbField& b) { return a.size > b.size; });
+    size_t num_ids = 0;
+    for (const FbField& f : fields) num_ids = std::max<size_t>(num_ids, f.id + 1u);
+    std::vector<uint16_t> at(num_ids, 0);
+    size_t inline_size = 4;
+    for (const FbField& f : fields) {
+        inline_size = (inline_size + f.size - 1) / f.size * f.size;
+        at[f.id] = static_cast<uint16_t>(inline_size);
+        inline_size += f.size;
+    }
+    fb.align(2);
+    const size_t vtable = fb.put<uint16_t>(static_cast<uint16_t>(4 + 2 * num_ids));
+    fb.put<uint16_t>(static_cast<uint16_t>(inline_size));
+    for (uint16_t a : at) fb.put<uint16_t>(a);
+    fb.align(8);
+    const size_t table = fb.size();
+    fb.bytes.resize(table + inline_size, 0);
+    const int32_t to_vtable = static_cast<int32_t>(table - vtable);
+    std::memcpy(&fb.bytes[table], &to_vtable, sizeof(to_vtable));
+    for (const FbField& f : fields)
+        if (!f.child) std::memcpy(&fb.bytes[table + at[f.id]], &f.value, f.size);
+    for (const FbField& f : fields)
+        if (f.child) fb.link(table + at[f.id], f.child(fb));
+    return table;
+}
+
+size_t fbString(FlatBuffer& fb, const std::string& s) {
+    fb.align(4);
+    const size_t at = fb.put<uint32_t>(static_cast<uint32_t>(s.size()));
+    fb.bytes.insert(fb.bytes.end(), s.begin(), s.end());
+    fb.bytes.push_back(0);
+    return at;
+}
+
+size_t fbTables(FlatBuffer& fb, const std::vector<FbWriter>& items) {
+    fb.align(4);
+    const size_t at = fb.put<uint32_t>(static_cast<uint32_t>(items.size()));
+    const size_t slots = fb.size();
+    fb.bytes.resize(slots + 4 * items.size(), 0);
+    for (size_t i = 0; i < items.size(); ++i) fb.link(slots + 4 * i, items[i](fb));
+    return at;
+}
+
+/// Vector of 8-byte-aligned structs.
+size_t fbStructs(FlatBuffer& fb, const void* data, size_t count, size_t elem_size) {
+    while ((fb.size() + 4) % 8) fb.bytes.push_back(0);
+    const size_t at = fb.put<uint32_t>(static_cast<uint32_t>(count));
+    const char* p = static_cast<const char*>(data);
+    fb.bytes.insert(fb.bytes.end(), p, p + count * elem_size);
+    return at;
+}
+
+/// A finished buffer: root offset, then the root table; padded to 8 bytes.
+std::vector<char> fbFinish(const FbWriter& root) {
+    FlatBuffer fb;
+    fb.put<uint32_t>(0);
+    fb.link(0, root(fb));
+    fb.align(8);
+    return std::move(fb.bytes);
+}
+
+constexpr int16_t kArrowMetadataV5 = 4;
+constexpr uint8_t kArrowHeaderSchema = 1;
+constexpr uint8_t kArrowHeaderDictionaryBatch = 2;
+constexpr uint8_t kArrowHeaderRecordBatch = 3;
+constexpr uint8_t kArrowTypeInt = 2;
+constexpr uint8_t kArrowTypeUtf8 = 5;
+constexpr uint8_t kArrowTypeDate = 8;
+constexpr int16_t kArrowDateDay = 0;
+constexpr char kArrowMagic[8] = {'A', 'R', 'R', 'O', 'W', '1', 0, 0};
+
+/// Dictionary of a dictionary-encoded column: int8 indices into these strings.
+struct ArrowDictionary {
+    int64_t id;
+    std::vector<std::string> values;
+};
+
+const ArrowDictionary kTypeDictionary = {
+    0, {"ADD_BID", "ADD_ASK", "CANCEL_BID", "CANCEL_ASK", "EXECUTE_BUY", "EXECUTE_SELL"}};
+const ArrowDictionary kSideDictionary = {1, {"BID", "ASK", "NA"}};
+
+struct ArrowColumn {
+    const char* name;
+    uint8_t type;
+    int32_t bit_width;  // Int
+    bool is_signed;     // Int
+    const ArrowDictionary* dictionary;  // set: type is the value type, indices int8
+};
+
+const ArrowColumn kArrowColumns[] = {
+    {"ts_ns", kArrowTypeInt, 64, false, nullptr},
+    {"type", kArrowTypeUtf8, 0, false, &kTypeDictionary},
+    {"side", kArrowTypeUtf8, 0, false, &kSideDictionary},
+    {"price_ticks", kArrowTypeInt, 32, true, nullptr},
+    {"qty", kArrowTypeInt, 32, false, nullptr},
+    {"order_id", kArrowTypeInt, 64, false, nullptr},
+    {"symbol", kArrowTypeUtf8, 0, false, nullptr},
+    {"date", kArrowTypeDate, 0, false, nullptr},
+};
+
+#pragma pack(push, 1)
+struct ArrowFieldNode { int64_t length; int64_t null_count; };
+struct ArrowBuffer { int64_t offset; int64_t length; };
+struct ArrowBlock { int64_t offset; int32_t meta_length; int32_t pad; int64_t body_length; };
+#pragma pack(pop)
+
+FbWriter arrowIntType(int32_t bit_width, bool is_signed) {
+    return [bit_width, is_signed](FlatBuffer& b) {
+        return fbTable(b, {fbScalar<int32_t>(0, bit_width), fbScalar<uint8_t>(1, is_signed)});
+    };
+}
+
+FbWriter arrowField(const ArrowColumn& c) {
+    return [c](FlatBuffer& fb) {
+        FbWriter type;
+        if (c.type == kArrowTypeInt)
+            type = arrowIntType(c.bit_width, c.is_signed);
+        else if (c.type == kArrowTypeDate)
+            type = [](FlatBuffer& b) { return fbTable(b, {fbScalar<int16_t>(0, kArrowDateDay)}); };
+        else
+            type = [](FlatBuffer& b) { return fbTable(b, {}); };
+        std::vector<FbField> fields = {
+            fbOffset(0, [c](FlatBuffer& b) { return fbString(b, c.name); }),  // name
+            fbScalar<uint8_t>(1, 0),                                           // nullable
+            fbScalar<uint8_t>(2, c.type),                                      // type_type
+            fbOffset(3, type),                                                 // type
+            fbOffset(5, [](FlatBuffer& b) { return fbTables(b, {}); }),        // children
+        };
+        if (c.dictionary) {
+            const int64_t id = c.dictionary->id;
+            fields.push_back(fbOffset(4, [id](FlatBuffer& b) {                 // dictionary
+                return fbTable(b, {fbScalar<int64_t>(0, id), fbOffset(1, arrowIntType(8, true))});
+            }));
+        }
+        return fbTable(fb, std::move(fields));
+    };
+}
+
+size_t arrowSchema(FlatBuffer& fb) {
+    std::vector<FbWriter> fields;
+    for (const ArrowColumn& c : kArrowColumns) fields.push_back(arrowField(c));
+    return fbTable(fb, {
+        fbScalar<int16_t>(0, 0),  // little-endian
+        fbOffset(1, [fields](FlatBuffer& b) { return fbTables(b, fields); }),
+    });
+}
+
+std::vector<char> arrowMessage(uint8_t header_type, const FbWriter& header, int64_t body_length) {
+    return fbFinish([&](FlatBuffer& fb) {
+        return fbTable(fb, {
+            fbScalar<int16_t>(0, kArrowMetadataV5),
+            fbScalar<uint8_t>(1, header_type),
+            fbOffset(2, header),
+            fbScalar<int64_t>(3, body_length),
+        });
+    });
+}
+
+/// Body of one record (or dictionary) batch: its field nodes, buffers and bytes.
+struct ArrowBody {
+    std::vector<ArrowFieldNode> nodes;
+    std::vector<ArrowBuffer> buffers;
+    std::vector<char> bytes;
+
+    void clear() {
+        nodes.clear();
+        buffers.clear();
+        bytes.clear();
+    }
+    void buffer(const void* data, size_t size) {
+        size_t pos = bytes.size();
+        buffers.push_back({static_cast<int64_t>(pos), static_cast<int64_t>(size)});
+        const char* p = static_cast<const char*>(data);
+        bytes.insert(bytes.end(), p, p + size);
+        pos += size;
+        padTo8(bytes, pos);
+    }
+    /// A fixed-width column without nulls: an empty validity buffer and the values.
+    template <class T>
+    void column(const std::vector<T>& values) {
+        nodes.push_back({static_cast<int64_t>(values.size()), 0});
+        buffer(nullptr, 0);
+        buffer(values.data(), values.size() * sizeof(T));
+    }
+    /// A Utf8 column: validity, int32 offsets, characters.
+    void strings(const std::vector<int32_t>& offsets, const std::string& chars) {
+        nodes.push_back({static_cast<int64_t>(offsets.size() - 1), 0});
+        buffer(nullptr, 0);
+        buffer(offsets.data(), offsets.size() * sizeof(int32_t));
+        buffer(chars.data(), chars.size());
+    }
+    /// RecordBatch table of length rows over this body.
+    FbWriter header(int64_t length) const {
+        return [this, length](FlatBuffer& fb) {
+            return fbTable(fb, {
+                fbScalar<int64_t>(0, length),
+                fbOffset(1, [this](FlatBuffer& b) {
+                    return fbStructs(b, nodes.data(), nodes.size(), sizeof(ArrowFieldNode));
+                }),
+                fbOffset(2, [this](FlatBuffer& b) {
+                    return fbStructs(b, buffers.data(), buffers.size(), sizeof(ArrowBuffer));
+                }),
+            });
+        };
+    }
+};
+
+class ArrowEncoder final : public ExportEncoder {
+public:
+    void begin(std::vector<char>& out) override {
+        append(out, kArrowMagic, sizeof(kArrowMagic));
+        message(out, arrowMessage(kArrowHeaderSchema, arrowSchema, 0), nullptr, 0);
+        for (const ArrowDictionary* dict : {&kTypeDictionary, &kSideDictionary}) {
+            body_.clear();
+            std::vector<int32_t> offsets = {0};
+            std::string chars;
+            for (const std::string& v : dict->values) {
+                chars += v;
+                offsets.push_back(static_cast<int32_t>(chars.size()));
+            }
+            body_.strings(offsets, chars);
+            const FbWriter data = body_.header(static_cast<int64_t>(dict->values.size()));
+            const int64_t id = dict->id;
+            const FbWriter header = [&](FlatBuffer& fb) {
+                return fbTable(fb, {fbScalar<int64_t>(0, id), fbOffset(1, data)});
+            };
+            dictionary_blocks_.push_back(
+                message(out, arrowMessage(kArrowHeaderDictionaryBatch, header,
+                                          static_cast<int64_t>(body_.bytes.size())),
+                        body_.bytes.data(), body_.bytes.size()));
+        }
+    }
+
+    void batch(const DiskEventRecord* recs, size_t n, const std::string& symbol, int32_t days,
+               std::vector<char>& out) override {
+        body_.clear();
+        auto column = [&](auto get) {
+            using T = decltype(get(recs[0]));
+            std::vector<T> values(n);
+            for (size_t i = 0; i < n; ++i) values[i] = get(recs[i]);
+            body_.column(values);
+        };
+        column([](const DiskEventRecord& r) { return static_cast<uint64_t>(r.ts_ns); });
+        column([](const DiskEventRecord& r) { return static_cast<int8_t>(r.type); });
+        column([](const DiskEventRecord& r) { return static_cast<int8_t>(r.side); });
+        column([](const DiskEventRecord& r) { return static_cast<int32_t>(r.price_ticks); });
+        column([](const DiskEventRecord& r) { return static_cast<uint32_t>(r.qty); });
+        column([](const DiskEventRecord& r) { return static_cast<uint64_t>(r.order_id); });
+        {
+            std::vector<int32_t> offsets(n + 1);
+            for (size_t i = 0; i <= n; ++i) offsets[i] = static_cast<int32_t>(i * symbol.size());
+            std::string chars;
+            chars.reserve(n * symbol.size());
+            for (size_t i = 0; i < n; ++i) chars += symbol;
+            body_.strings(offsets, chars);
+        }
+        column([days](const DiskEventRecord&) { return days; });
+
+        record_blocks_.push_back(
+            message(out, arrowMessage(kArrowHeaderRecordBatch, body_.header(static_cast<int64_t>(n)),
+                                      static_cast<int64_t>(body_.bytes.size())),
+                    body_.bytes.data(), body_.bytes.size()));
+    }
+
+    void end(std::vector<char>& out) override {
+        put<uint32_t>(out, 0xFFFFFFFFu);  // end-of-stream marker
+        put<uint32_t>(out, 0);
+        const std::vector<char> footer = fbFinish([&](FlatBuffer& fb) {
+            return fbTable(fb, {
+                fbScalar<int16_t>(0, kArrowMetadataV5),
+                fbOffset(1, arrowSchema),
+                fbOffset(2, [&](FlatBuffer& b) {
+                    return fbStructs(b, dictionary_blocks_.data(), dictionary_blocks_.size(),
+                                     sizeof(ArrowBlock));
+                }),
+                fbOffset(3, [&](FlatBuffer& b) {
+                    return fbStructs(b, record_blocks_.data(), record_blocks_.size(), sizeof(ArrowBlock));
+                }),
+            });
+        });
+        out.insert(out.end(), footer.begin(), footer.end());
+        put<int32_t>(out, static_cast<int32_t>(footer.size()));
+        out.insert(out.end(), kArrowMagic, kArrowMagic + 6);
+    }
+
+private:
+    void append(std::vector<char>& out, const char* data, size_t size) {
+        out.insert(out.end(), data, data + size);
+        pos_ += size;
+    }
+
+    /// Continuation marker, metadata length, metadata (8-byte padded), body.
+    /// Returns the message's footer block.
+    ArrowBlock message(std::vector<char>& out, const std::vector<char>& meta, const char* body, size_t size) {
+        const ArrowBlock block{static_cast<int64_t>(pos_), static_cast<int32_t>(8 + meta.size()), 0,
+                               static_cast<int64_t>(size)};
+        put<uint32_t>(out, 0xFFFFFFFFu);
+        put<int32_t>(out, static_cast<int32_t>(meta.size()));
+        pos_ += 8;
+        append(out, meta.data(), meta.size());
+        if (size > 0) append(out, body, size);
+        return block;
+    }
+
+    uint64_t pos_ = 0;  // bytes emitted so far (block offsets)
+    ArrowBody body_;
+    std::vector<ArrowBlock> dictionary_blocks_;
+    std::vector<ArrowBlock> record_blocks_;
+};
+
+}  // namespace
+
+std::unique_ptr<ExportEncoder> makeExportEncoder(ExportFormat format) {
+    switch (format) {
+        case ExportFormat::RowBinary: return std::make_unique<RowBinaryEncoder>();
+        case ExportFormat::Native:    return std::make_unique<NativeEncoder>();
+        case ExportFormat::Arrow:     return std::make_unique<ArrowEncoder>();
+    }
+    throw std::invalid_argument("unknown export format");
+}
+
+}  // namespace qrsdp
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "io/event_log_format.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace qrsdp {
+
+// ---------------------------------------------------------------------------
+// Table encodings of event logs for bulk loading: one row per record, with the
+// session's symbol and date filled in.
+//   RowBinary, Native  ClickHouse input formats for exchange_events
+//                      (pipeline/clickhouse/init.sql), columns as in
+//                      kClickHouseExportColumns
+//   Arrow              Arrow IPC file ("Feather v2") for pandas / polars /
+//                      pyarrow / DuckDB: the same columns without type_name;
+//                      type and side dictionary-encoded (int8 indices into the
+//                      event type and BID/ASK/NA names), date as date32, no nulls
+// ---------------------------------------------------------------------------
+
+enum class ExportFormat { RowBinary, Native, Arrow };
+
+/// "rowbinary", "native" or "arrow". Throws std::invalid_argument otherwise.
+ExportFormat parseExportFormat(const std::string& name);
+const char* exportFormatName(ExportFormat format);  // ClickHouse FORMAT name
+const char* exportFormatExtension(ExportFormat format);  // ".rowbinary", ".native", ".arrow"
+
+/// Column list of the ClickHouse formats, for the INSERT.
+extern const char* const kClickHouseExportColumns;
+
+/// Days since 1970-01-01 of "YYYY-MM-DD". Throws std::invalid_argument if malformed.
+int32_t daysSinceEpoch(const std::string& date);
+
+/// Encodes a stream of record batches as one output. Every call appends to out
+/// (never clears it), so the caller may drain out between calls.
+class ExportEncoder {
+public:
+    virtual ~ExportEncoder() = default;
+    /// Before the first batch.
+    virtual void begin(std::vector<char>&) {}
+    /// n records of one session. Native writes one block and Arrow one record
+    /// batch per call.
+    virtual void batch(const DiskEventRecord* recs, size_t n, const std::string& symbol,
+                       int32_t days, std::vector<char>& out) = 0;
+    /// After the last batch.
+    virtual void end(std::vector<char>&) {}
+};
+
+std::unique_ptr<ExportEncoder> makeExportEncoder(ExportFormat format);
+
+}  // namespace qrsdp
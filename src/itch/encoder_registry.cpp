@@ -0,0 +1,80 @@
+#include "itch/encoder_registry.h"
+
+#include <cstring>
+#include <stdexcept>
+
+namespace qrsdp {
+namespace itch {
+
+namespace {
+
+constexpr size_t kInitialSlots = 64;
+
+}  // namespace
+
+EncoderRegistry::EncoderRegistry(uint32_t tick_size)
+    : tick_size_(tick_size), slots_(kInitialSlots) {}
+
+uint64_t EncoderRegistry::hashKey(const char* symbol, size_t len) {
+    uint64_t h = 14695981039346656037ULL;
+    for (size_t i = 0; i < len; ++i) {
+        h ^= static_cast<uint8_t>(symbol[i]);
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+EncoderRegistry::Slot& EncoderRegistry::probe(const char* symbol, size_t len, uint64_t hash) {
+    const size_t mask = slots_.size() - 1;
+    for (size_t i = static_cast<size_t>(hash) & mask;; i = (i + 1) & mask) {
+        Slot& slot = slots_[i];
+        if (slot.locate == 0)
+            return slot;
+        if (slot.hash == hash) {
+            const std::string& s = symbols_[slot.locate - 1];
+            if (s.size() == len && std::memcmp(s.data(), symbol, len) == 0)
+                return slot;
+        }
+    }
+}
+
+ItchEncoder* EncoderRegistry::find(const char* symbol, size_t len) {
+    const Slot& slot = probe(symbol, len, hashKey(symbol, len));
+    return slot.locate != 0 ? &encoders_[slot.locate - 1] : nullptr;
+}
+
+ItchEncoder& EncoderRegistry::intern(const char* symbol, size_t len, bool& added) {
+    const uint64_t hash = hashKey(symbol, len);
+    Slot* slot = &probe(symbol, len, hash);
+    added = slot->locate == 0;
+    if (!added)
+        return encoders_[slot->locate - 1];
+
+    if (encoders_.size() >= kMaxSymbols)
+        throw std::runtime_error("EncoderRegistry: out of stock locates");
+    if (2 * (encoders_.size() + 1) > slots_.size()) {
+        grow();
+        slot = &probe(symbol, len, hash);
+    }
+    symbols_.emplace_back(symbol, len);
+    encoders_.emplace_back(symbols_.back(), static_cast<uint16_t>(encoders_.size() + 1), tick_size_);
+    slot->hash = hash;
+    slot->locate = static_cast<uint16_t>(encoders_.size());
+    return encoders_.back();
+}
+
+void EncoderRegistry::grow() {
+    std::vector<Slot> old(slots_.size() * 2);
+    old.swap(slots_);
+    const size_t mask = slots_.size() - 1;
+    for (const Slot& s : old) {
+        if (s.locate == 0)
+            continue;
+        size_t i = static_cast<size_t>(s.hash) & mask;
+        while (slots_[i].locate != 0) i = (i + 1) & mask;
+        slots_[i] = s;
+    }
+}
+
+}  // namespace itch
+}  // namespace qrsdp
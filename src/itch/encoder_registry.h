@@ -0,0 +1,60 @@
+#pragma once
+
+#include "itch/itch_encoder.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace qrsdp {
+namespace itch {
+
+/// Symbol -> ItchEncoder table for feeds that learn their symbols as they go
+/// (e.g. from Kafka message keys). A symbol is interned at first sight and
+/// gets the next stock locate (1, 2, ...); its encoder lives in a dense array
+/// indexed by locate. Lookups hash the key bytes into a small open-addressed
+/// table of (hash, locate) slots and confirm the hit with one memcmp, so a
+/// known symbol costs no allocation and no node-based map probe.
+class EncoderRegistry {
+public:
+    /// Largest number of symbols (stock locate is 16 bits; 0 is reserved).
+    static constexpr size_t kMaxSymbols = 65535;
+
+    explicit EncoderRegistry(uint32_t tick_size);
+
+    /// Encoder for the len-byte symbol, or nullptr if it has not been seen.
+    ItchEncoder* find(const char* symbol, size_t len);
+
+    /// Encoder for the symbol, interning it with the next locate if it is new
+    /// (added is then set to true). The reference stays valid until the next
+    /// symbol is added. Throws std::runtime_error once kMaxSymbols are in use.
+    ItchEncoder& intern(const char* symbol, size_t len, bool& added);
+
+    /// Encoder of an interned locate (1..size()).
+    ItchEncoder& byLocate(uint16_t locate) { return encoders_[locate - 1]; }
+    const std::string& symbol(uint16_t locate) const { return symbols_[locate - 1]; }
+
+    size_t size() const { return encoders_.size(); }
+
+    /// FNV-1a over the key bytes; exposed so callers can precompute it.
+    static uint64_t hashKey(const char* symbol, size_t len);
+
+private:
+    struct Slot {
+        uint64_t hash = 0;
+        uint16_t locate = 0;  // 0 = empty
+    };
+
+    /// Slot holding the symbol, or the empty slot where it would go.
+    Slot& probe(const char* symbol, size_t len, uint64_t hash);
+    void grow();
+
+    uint32_t tick_size_;
+    std::vector<Slot> slots_;  // power-of-two size, at most half full
+    std::vector<ItchEncoder> encoders_;
+    std::vector<std::string> symbols_;
+};
+
+}  // namespace itch
+}  // namespace qrsdp
@@ -0,0 +1,64 @@
+#include "itch/feed_stats.h"
+#include "itch/endian.h"
+#include "itch/itch_decoder.h"
+#include "itch/itch_messages.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace qrsdp {
+namespace itch {
+
+// --- FeedStats ---
+
+namespace {
+
+/// Counts by type and reads the timestamp, the part every handler decodes.
+struct CountingVisitor {
+    FeedCounters& c;
+    uint64_t& last_ts_ns;
+
+    void operator()(const SystemEventMsg& m)    { ++c.system_events; last_ts_ns = load48be(m.timestamp); }
+    void operator()(const StockDirectoryMsg& m) { ++c.directory;     last_ts_ns = load48be(m.timestamp); }
+    void operator()(const AddOrderMsg& m)       { ++c.adds;          last_ts_ns = load48be(m.timestamp); }
+    void operator()(const OrderDeleteMsg& m)    { ++c.deletes;       last_ts_ns = load48be(m.timestamp); }
+    void operator()(const OrderExecutedMsg& m)  { ++c.executions;    last_ts_ns = load48be(m.timestamp); }
+    void operator()(const EndOfSnapshotMsg& m)  { ++c.system_events; last_ts_ns = load48be(m.timestamp); }
+};
+
+}  // namespace
+
+void FeedStats::onPacket(const uint8_t* data, size_t len) {
+    ++counters_.packets;
+    counters_.bytes += len;
+    if (len < kMoldUDP64HeaderSize) {
+        ++counters_.malformed;
+        return;
+    }
+    MoldUDP64Header hdr;
+    std::memcpy(&hdr, data, kMoldUDP64HeaderSize);
+    const uint64_t seq = betoh64(hdr.sequence_number);
+    const uint16_t count = betoh16(hdr.message_count);
+    if (count == 0)
+        return;  // heartbeat
+
+    if (expected_ != 0 && seq > expected_) {
+        ++counters_.gaps;
+        counters_.missing += seq - expected_;
+    }
+    if (expected_ != 0 && seq < expected_)
+        counters_.duplicates += std::min<uint64_t>(expected_ - seq, count);
+
+    CountingVisitor visitor{counters_, last_ts_ns_};
+    const bool complete = forEachMoldUDP64Message(data, len, [&](uint64_t, const uint8_t* msg, uint16_t n) {
+        ++counters_.messages;
+        if (!visitItchMessage(msg, n, visitor))
+            ++counters_.malformed;
+    });
+    if (!complete)
+        ++counters_.malformed;
+    expected_ = std::max(expected_, seq + count);
+}
+
+}  // namespace itch
+}  // namespace qrsdp
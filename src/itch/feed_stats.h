@@ -0,0 +1,53 @@
+#pragma once
+
+#include "core/metrics.h"
+#include <cstddef>
+#include <cstdint>
+
+namespace qrsdp {
+namespace itch {
+
+using qrsdp::LatencyHistogram;
+
+/// Counts over a received MoldUDP64 / ITCH feed.
+struct FeedCounters {
+    uint64_t packets = 0;
+    uint64_t messages = 0;
+    uint64_t bytes = 0;
+    uint64_t gaps = 0;          // packets that skipped ahead of the expected sequence
+    uint64_t missing = 0;       // messages skipped over by those gaps
+    uint64_t duplicates = 0;    // messages at sequences already passed
+    uint64_t malformed = 0;     // truncated packets and undecodable messages
+    uint64_t system_events = 0;
+    uint64_t directory = 0;
+    uint64_t adds = 0;
+    uint64_t deletes = 0;
+    uint64_t executions = 0;
+};
+
+/// What qrsdp_listen --stats measures: decodes each packet with the
+/// zero-copy visitor (no printing, no allocation), tracks the sequence for
+/// gaps and keeps a latency histogram the caller fills.
+class FeedStats {
+public:
+    /// Decodes every message of one packet and updates the counters.
+    void onPacket(const uint8_t* data, size_t len);
+
+    const FeedCounters& counters() const { return counters_; }
+    /// Next sequence number expected; 0 before the first packet.
+    uint64_t expectedSequence() const { return expected_; }
+    /// Timestamp of the last message decoded (ns since midnight).
+    uint64_t lastTimestamp() const { return last_ts_ns_; }
+
+    LatencyHistogram& latency() { return latency_; }
+    const LatencyHistogram& latency() const { return latency_; }
+
+private:
+    FeedCounters counters_;
+    uint64_t expected_ = 0;
+    uint64_t last_ts_ns_ = 0;
+    LatencyHistogram latency_;
+};
+
+}  // namespace itch
+}  // namespace qrsdp
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace qrsdp {
+namespace itch {
+
+/// One datagram of a batch: the bytes are only borrowed for the call.
+struct Datagram {
+    const uint8_t* data;
+    size_t len;
+};
+
+/// Transmit backend for MoldUDP64 packets. Implementations: UdpMulticastSender
+/// (kernel sockets, the default) and XdpSender (AF_XDP, BUILD_XDP_SUPPORT).
+class IDatagramSender {
+public:
+    virtual ~IDatagramSender() = default;
+
+    /// Send one datagram. Returns true on success.
+    virtual bool send(const uint8_t* data, size_t len) = 0;
+
+    /// Send n datagrams in order; returns how many were sent.
+    virtual size_t sendBatch(const Datagram* packets, size_t n) = 0;
+};
+
+}  // namespace itch
+}  // namespace qrsdp
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "itch/partition_merge.h"
+
+#include <cstddef>
+
+namespace qrsdp {
+namespace itch {
+
+/// One consumed message, borrowed from its source until handle is released.
+struct StreamMessage {
+    const char* key = nullptr;      // null or empty: no key
+    size_t key_len = 0;
+    const void* payload = nullptr;  // a Kafka payload (io/kafka_payload.h)
+    size_t len = 0;
+    int partition = 0;
+    const char* error = nullptr;    // set: a consumer error, with no payload
+    void* handle = nullptr;         // never null; give back to releaseFn()
+};
+
+/// Where ItchStreamer reads its messages. Implementations: the librdkafka
+/// consumer inside ItchStreamConsumer (BUILD_KAFKA_SUPPORT), and in-memory
+/// fakes in the tests.
+class IStreamSource {
+public:
+    /// consume() partition meaning every assigned partition, in arrival order.
+    static constexpr int kAllPartitions = -1;
+
+    virtual ~IStreamSource() = default;
+
+    /// Partitions that can be read one by one; 0 if only kAllPartitions can.
+    virtual int partitionCount() const = 0;
+
+    /// Up to max messages of partition, waiting at most timeout_ms for the
+    /// first. Different partitions may be read from different threads at once,
+    /// each partition from one thread only.
+    virtual size_t consume(int partition, int timeout_ms, StreamMessage* out, size_t max) = 0;
+
+    /// Gives a message handle back; callable from any thread.
+    virtual PartitionMerge::ReleaseFn releaseFn() const = 0;
+
+    /// Serves consumer events (errors, rebalances) without waiting, while
+    /// partition readers hold the message queues.
+    virtual void pollEvents() = 0;
+};
+
+}  // namespace itch
+}  // namespace qrsdp
@@ -0,0 +1,302 @@
+#include "itch/itch_channels.h"
+#include "io/spsc_ring.h"
+#include "itch/encoder_registry.h"
+#include "itch/itch_encoder.h"
+#include "itch/itch_messages.h"
+#include "itch/moldudp64.h"
+#include "itch/moldudp64_retransmit.h"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+namespace qrsdp {
+namespace itch {
+
+namespace {
+
+constexpr uint32_t kMaxChannels = 64;
+constexpr size_t kSessionBytes = 10;
+/// Records encoded between checks for a due packet.
+constexpr size_t kDrainBatch = 256;
+/// Yields before the channel thread goes to sleep on an empty queue.
+constexpr int kIdleSpins = 64;
+/// Longest sleep on an empty queue when no flush deadline is set.
+constexpr std::chrono::microseconds kIdleWait{1000};
+
+/// Parses all of s as a decimal below limit.
+bool parseIndex(const std::string& s, uint32_t limit, uint32_t& out) {
+    if (s.empty() || s.size() > 9 || s.find_first_not_of("0123456789") != std::string::npos)
+        return false;
+    const unsigned long v = std::strtoul(s.c_str(), nullptr, 10);
+    if (v >= limit)
+        return false;
+    out = static_cast<uint32_t>(v);
+    return true;
+}
+
+}  // namespace
+
+// --- ItchChannelMap ---
+
+uint32_t ItchChannelMap::channelOf(const char* symbol, size_t len) const {
+    if (channels <= 1)
+        return 0;
+    if (!pinned.empty()) {
+        const auto it = pinned.find(std::string(symbol, len));
+        if (it != pinned.end())
+            return it->second;
+    }
+    return static_cast<uint32_t>(EncoderRegistry::hashKey(symbol, len) % channels);
+}
+
+bool parseChannelMap(const std::string& spec, ItchChannelMap& out) {
+    const auto colon = spec.find(':');
+    ItchChannelMap map;
+    uint32_t n = 0;
+    if (!parseIndex(spec.substr(0, colon), kMaxChannels + 1, n) || n == 0)
+        return false;
+    map.channels = n;
+    if (colon != std::string::npos) {
+        size_t pos = colon + 1;
+        for (;;) {
+            const auto comma = spec.find(',', pos);
+            const std::string entry = spec.substr(pos, comma == std::string::npos ? std::string::npos : comma - pos);
+            const auto eq = entry.find('=');
+            uint32_t channel = 0;
+            if (eq == std::string::npos || eq == 0 || !parseIndex(entry.substr(eq + 1), n, channel))
+                return false;
+            map.pinned[entry.substr(0, eq)] = channel;
+            if (comma == std::string::npos)
+                break;
+            pos = comma + 1;
+        }
+    }
+    out = std::move(map);
+    return true;
+}
+
+std::string channelSession(const std::string& session, uint32_t channel, uint32_t channels) {
+    if (channels <= 1)
+        return session;
+    const std::string number = std::to_string(channel);
+    std::string base = session.substr(0, session.find_last_not_of(' ') + 1);
+    base.resize(std::min(base.size(), kSessionBytes - number.size()));
+    return base + number;
+}
+
+// --- ItchChannel ---
+
+namespace {
+
+/// One queued record and its key, copied so the caller's buffer can go.
+struct KeyedRecord {
+    EventRecord rec;
+    uint8_t key_len;
+    char key[ItchChannel::kMaxKeyBytes];
+};
+
+}  // namespace
+
+struct ItchChannel::Impl {
+    ItchChannelConfig config;
+    std::unique_ptr<IDatagramSender> sender;
+    std::unique_ptr<RetransmitRing> retransmit_ring;
+    std::unique_ptr<RetransmitServer> retransmit_server;
+    SpscRing<KeyedRecord> ring;
+    MoldUDP64Framer framer;
+    const ItchEncoder sys_encoder{"", 0, 1};
+    EncoderRegistry encoders;
+    uint64_t last_ts_ns = 0;
+    bool seen_first_event = false;
+
+    std::atomic<uint64_t> messages{0};
+    std::atomic<bool> stop{false};
+    std::atomic<bool> sleeping{false};
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::thread thread;
+
+    Impl(const ItchChannelConfig& cfg, std::unique_ptr<IDatagramSender> s)
+        : config(cfg)
+        , sender(std::move(s))
+        , ring(std::max<size_t>(cfg.queue_records, 1))
+        , framer(cfg.session, std::max<size_t>(cfg.batch_packets, 1))
+        , encoders(cfg.tick_size) {}
+
+    void count() { messages.fetch_add(1, std::memory_order_relaxed); }
+
+    void emitSystemEvent(char code, uint64_t ts_ns) {
+        constexpr uint16_t size = sizeof(SystemEventMsg);
+        uint8_t* dst = framer.reserveMessage(size);
+        framer.commitMessage(static_cast<uint16_t>(sys_encoder.encodeSystemEventInto(code, ts_ns, dst, size)));
+        count();
+    }
+
+    /// Encoder for a key; a symbol seen for the first time gets the next
+    /// locate and a Stock Directory message.
+    ItchEncoder& getEncoder(const char* symbol, size_t len) {
+        bool added = false;
+        ItchEncoder& enc = encoders.intern(symbol, len, added);
+        if (added) {
+            constexpr uint16_t size = sizeof(StockDirectoryMsg);
+            uint8_t* dst = framer.reserveMessage(size);
+            framer.commitMessage(static_cast<uint16_t>(enc.encodeStockDirectoryInto(0, dst, size)));
+            count();
+        }
+        return enc;
+    }
+
+    void handle(const KeyedRecord& item) {
+        const EventRecord& rec = item.rec;
+        // A timestamp going backward starts the next trading day.
+        if (!seen_first_event) {
+            emitSystemEvent(kSystemEventStartOfMarket, rec.ts_ns);
+            seen_first_event = true;
+        } else if (rec.ts_ns < last_ts_ns) {
+            emitSystemEvent(kSystemEventEndOfMarket, last_ts_ns);
+            emitSystemEvent(kSystemEventStartOfMarket, rec.ts_ns);
+        }
+        last_ts_ns = rec.ts_ns;
+
+        const ItchEncoder& enc = getEncoder(item.key, item.key_len);
+        const auto size = static_cast<uint16_t>(ItchEncoder::encodedSize(rec));
+        uint8_t* dst = framer.reserveMessage(size);
+        framer.commitMessage(static_cast<uint16_t>(enc.encodeInto(rec, dst, size)));
+        count();
+    }
+
+    void run() {
+        emitSystemEvent(kSystemEventStartOfMessages, 0);
+        framer.sendPending();
+
+        const std::chrono::microseconds idle_wait = config.flush_deadline_us > 0
+            ? std::min(kIdleWait, std::chrono::microseconds(config.flush_deadline_us))
+            : kIdleWait;
+        KeyedRecord item;
+        for (;;) {
+            size_t taken = 0;
+            while (taken < kDrainBatch && ring.tryPop(item)) {
+                handle(item);
+                ++taken;
+            }
+            framer.flushIfDue();
+            if (taken > 0)
+                continue;
+            if (stop.load() && ring.empty())
+                break;
+
+            auto ready = [this] { return !ring.empty() || stop.load(); };
+            bool woke = false;
+            for (int spin = 0; spin < kIdleSpins && !woke; ++spin) {
+                woke = ready();
+                if (!woke) std::this_thread::yield();
+            }
+            if (!woke) {
+                // Timed, so a part-filled packet still goes out at its deadline.
+                std::unique_lock<std::mutex> lock(mutex);
+                sleeping.store(true);  // seq_cst: pairs with the ring's seq_cst publish in wake()
+                cv.wait_for(lock, idle_wait, ready);
+                sleeping.store(false);
+            }
+        }
+
+        framer.sendPending();
+        if (seen_first_event)
+            emitSystemEvent(kSystemEventEndOfMarket, last_ts_ns);
+        emitSystemEvent(kSystemEventEndOfMessages, 0);
+        framer.sendPending();
+    }
+
+    void wake() {
+        if (sleeping.load()) {
+            std::lock_guard<std::mutex> lock(mutex);
+            cv.notify_all();
+        }
+    }
+};
+
+ItchChannel::ItchChannel(const ItchChannelConfig& config, std::unique_ptr<IDatagramSender> sender) {
+    if (!sender)
+        throw std::runtime_error("ItchChannel: null sender");
+    impl_ = std::make_unique<Impl>(config, std::move(sender));
+    Impl* impl = impl_.get();
+    if (config.retransmit_port != 0) {
+        impl->retransmit_ring = std::make_unique<RetransmitRing>(config.retransmit_packets);
+        impl->retransmit_server = std::make_unique<RetransmitServer>(*impl->retransmit_ring,
+                                                                     config.retransmit_port);
+    }
+    impl->framer.setSendCallback([impl](const uint8_t* data, size_t len) {
+        impl->sender->send(data, len);
+        if (impl->retransmit_ring)
+            impl->retransmit_ring->record(data, len);
+    });
+    if (config.batch_packets > 1) {
+        impl->framer.setBatchCallback([impl](const Datagram* packets, size_t n) {
+            impl->sender->sendBatch(packets, n);
+            if (impl->retransmit_ring) {
+                for (size_t i = 0; i < n; ++i)
+                    impl->retransmit_ring->record(packets[i].data, packets[i].len);
+            }
+        });
+    }
+    impl->framer.setFlushDeadline(std::chrono::microseconds(config.flush_deadline_us));
+}
+
+ItchChannel::~ItchChannel() {
+    stop();
+}
+
+void ItchChannel::start() {
+    if (impl_->thread.joinable())
+        throw std::runtime_error("ItchChannel: already started");
+    if (impl_->retransmit_server)
+        impl_->retransmit_server->start();
+    impl_->stop.store(false);
+    impl_->thread = std::thread([this] { impl_->run(); });
+}
+
+void ItchChannel::push(const char* key, size_t key_len, const EventRecord& rec) {
+    KeyedRecord item;
+    item.rec = rec;
+    item.key_len = static_cast<uint8_t>(std::min(key_len, kMaxKeyBytes));
+    std::memcpy(item.key, key, item.key_len);
+    if (!impl_->ring.tryPush(item)) {
+        if (!impl_->thread.joinable())
+            throw std::runtime_error("ItchChannel: queue is full and the channel is not running");
+        do {
+            impl_->wake();
+            std::this_thread::yield();
+        } while (!impl_->ring.tryPush(item));
+    }
+    impl_->wake();
+}
+
+void ItchChannel::stop() {
+    if (!impl_->thread.joinable())
+        return;
+    impl_->stop.store(true);
+    {
+        std::lock_guard<std::mutex> lock(impl_->mutex);
+        impl_->cv.notify_all();
+    }
+    impl_->thread.join();
+    if (impl_->retransmit_server)
+        impl_->retransmit_server->stop();
+}
+
+uint64_t ItchChannel::messagesSent() const {
+    return impl_->messages.load(std::memory_order_relaxed);
+}
+
+uint16_t ItchChannel::retransmitPort() const {
+    return impl_->retransmit_server ? impl_->retransmit_server->port() : 0;
+}
+
+}  // namespace itch
+}  // namespace qrsdp
@@ -0,0 +1,96 @@
+#pragma once
+
+#include "core/records.h"
+#include "itch/i_datagram_sender.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+
+namespace qrsdp {
+namespace itch {
+
+/// Which output channel carries each symbol when an ITCH feed is split across
+/// several MoldUDP64 sessions. Pinned symbols go where they are pinned; every
+/// other symbol goes to EncoderRegistry::hashKey(symbol) % channels, so the
+/// assignment is stable across runs and processes without coordination.
+struct ItchChannelMap {
+    uint32_t channels = 1;
+    std::map<std::string, uint32_t> pinned;  // symbol -> channel (< channels)
+
+    uint32_t channelOf(const char* symbol, size_t len) const;
+    uint32_t channelOf(const std::string& symbol) const { return channelOf(symbol.data(), symbol.size()); }
+};
+
+/// Parses "N" or "N:SYM=c,SYM=c,..." (1 <= N <= 64, every c < N) into out.
+/// Returns false (out unchanged) on anything else.
+bool parseChannelMap(const std::string& spec, ItchChannelMap& out);
+
+/// MoldUDP64 session of one channel: session itself when there is a single
+/// channel, otherwise session with trailing blanks dropped, cut to leave room
+/// for the channel number, and the number appended ("QRSDPITCH" -> "QRSDPITCH3",
+/// "QRSDPITC12"), so every channel's packets name a distinct session.
+std::string channelSession(const std::string& session, uint32_t channel, uint32_t channels);
+
+/// Settings for one ItchChannel.
+struct ItchChannelConfig {
+    std::string session        = "QRSDPITCH ";
+    uint32_t    tick_size      = 100;
+    size_t      batch_packets  = 16;     // packets per sendBatch; 1 = one send per packet
+    uint32_t    flush_deadline_us = 500;  // max wait of a message before it is sent; 0 = none
+    size_t      queue_records  = 1 << 16;  // records queued to the channel thread
+    uint16_t    retransmit_port = 0;     // serve MoldUDP64 gap requests here; 0 = off
+    size_t      retransmit_packets = 16384;  // packets kept for retransmission
+};
+
+/// One channel of a keyed ITCH stream (ItchStreamConsumer): records pushed
+/// with their symbol key are encoded, framed and sent by the channel's own
+/// thread, in its own MoldUDP64 session and sequence space. Symbols get stock
+/// locates 1, 2, ... in the order the channel first sees them, each announced
+/// with a Stock Directory message; a timestamp going backwards ends one
+/// trading day's market and starts the next.
+///
+/// push() only copies into an SPSC queue (waiting for room when it is full),
+/// so one thread can feed several channels and the encoding and sending of
+/// each runs on its own core. One pushing thread at a time.
+class ItchChannel {
+public:
+    /// Keys are cut to this many bytes (ITCH symbols are 8).
+    static constexpr size_t kMaxKeyBytes = 16;
+
+    /// Throws std::runtime_error if sender is null or the retransmit port
+    /// cannot be bound.
+    ItchChannel(const ItchChannelConfig& config, std::unique_ptr<IDatagramSender> sender);
+    ~ItchChannel();
+
+    ItchChannel(const ItchChannel&) = delete;
+    ItchChannel& operator=(const ItchChannel&) = delete;
+
+    /// Starts the retransmit server and the channel thread, which sends Start
+    /// of Messages.
+    void start();
+
+    /// Queues one record for the symbol key. Must be called between start()
+    /// and stop().
+    void push(const char* key, size_t key_len, const EventRecord& rec);
+
+    /// Sends everything queued, End of Market for the last day (if any record
+    /// was seen) and End of Messages, then joins the thread. Idempotent; also
+    /// called by the destructor.
+    void stop();
+
+    /// ITCH messages framed so far, system and directory messages included.
+    uint64_t messagesSent() const;
+    /// Bound retransmit port, or 0 if retransmission is off.
+    uint16_t retransmitPort() const;
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
+}  // namespace itch
+}  // namespace qrsdp
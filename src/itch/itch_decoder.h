@@ -1,8 +1,10 @@
 #pragma once
 
 /// Reusable ITCH 5.0 message decoder and MoldUDP64 packet parser.
-/// Converts big-endian wire-format ITCH messages back into host-order
-/// structs suitable for programmatic comparison in tests and tooling.
+/// decodeItchMessage / parseMoldUDP64 convert into host-order structs for
+/// comparison in tests and tooling; visitItchMessage /
+/// forEachMoldUDP64Message are the zero-copy, allocation-free forms for
+/// high-rate consumers.
 
 #include "itch/itch_messages.h"
 #include "itch/endian.h"
@@ -26,6 +28,7 @@ struct DecodedItchMsg {
     uint32_t price          = 0;      // raw price-4 units (AddOrder only)
     char     stock[8]       = {};
     uint64_t match_number   = 0;      // OrderExecuted only
+    uint64_t sequence_number = 0;     // EndOfSnapshot only
     char     event_code     = 0;      // SystemEvent only
 };
 
@@ -84,11 +87,75 @@ inline bool decodeItchMessage(const uint8_t* data, size_t len, DecodedItchMsg& o
         out.match_number    = betoh64(m->match_number);
         return true;
     }
+    case kMsgTypeEndOfSnapshot: {
+        if (len < sizeof(EndOfSnapshotMsg)) return false;
+        const auto* m = reinterpret_cast<const EndOfSnapshotMsg*>(data);
+        out.stock_locate    = betoh16(m->stock_locate);
+        out.timestamp_ns    = load48be(m->timestamp);
+        out.sequence_number = betoh64(m->sequence_number);
+        return true;
+    }
     default:
         return false;
     }
 }
 
+namespace detail {
+
+template <class Msg, class Visitor>
+inline bool visitAs(const uint8_t* data, size_t len, Visitor& v) {
+    if (len < sizeof(Msg)) return false;
+    v(*reinterpret_cast<const Msg*>(data));
+    return true;
+}
+
+}  // namespace detail
+
+/// Calls v with the wire struct of the message at data, in place and still
+/// big-endian: v needs an overload per message type (or a generic lambda).
+/// One switch on the type byte and a length check; nothing is copied or
+/// zeroed. Returns false, without calling v, for an unknown type or a buffer
+/// too short for the declared type.
+template <class Visitor>
+inline bool visitItchMessage(const uint8_t* data, size_t len, Visitor&& v) {
+    if (len < 1) return false;
+    switch (static_cast<char>(data[0])) {
+    case kMsgTypeSystemEvent:    return detail::visitAs<SystemEventMsg>(data, len, v);
+    case kMsgTypeStockDirectory: return detail::visitAs<StockDirectoryMsg>(data, len, v);
+    case kMsgTypeAddOrder:       return detail::visitAs<AddOrderMsg>(data, len, v);
+    case kMsgTypeOrderDelete:    return detail::visitAs<OrderDeleteMsg>(data, len, v);
+    case kMsgTypeOrderExecuted:  return detail::visitAs<OrderExecutedMsg>(data, len, v);
+    case kMsgTypeEndOfSnapshot:  return detail::visitAs<EndOfSnapshotMsg>(data, len, v);
+    default:                     return false;
+    }
+}
+
+/// Calls fn(sequence_number, data, size) for each message block of a
+/// MoldUDP64 packet, in place. Returns true if the header was valid and all
+/// declared messages were present; blocks before a truncated one are still
+/// visited.
+template <class Fn>
+inline bool forEachMoldUDP64Message(const uint8_t* data, size_t len, Fn&& fn) {
+    if (len < kMoldUDP64HeaderSize) return false;
+    MoldUDP64Header hdr;
+    std::memcpy(&hdr, data, kMoldUDP64HeaderSize);
+    const uint64_t seq = betoh64(hdr.sequence_number);
+    const uint16_t count = betoh16(hdr.message_count);
+
+    size_t offset = kMoldUDP64HeaderSize;
+    for (uint16_t i = 0; i < count; ++i) {
+        if (offset + 2 > len) return false;
+        uint16_t msg_len_be;
+        std::memcpy(&msg_len_be, data + offset, 2);
+        const uint16_t msg_len = betoh16(msg_len_be);
+        offset += 2;
+        if (offset + msg_len > len) return false;
+        fn(seq + i, data + offset, msg_len);
+        offset += msg_len;
+    }
+    return true;
+}
+
 /// A byte-range view into a buffer (non-owning).
 struct ByteSpan {
     const uint8_t* data;
@@ -105,7 +172,8 @@ struct MoldUDP64Parsed {
 
 /// Parse a MoldUDP64 packet, extracting the header and individual
 /// ITCH message byte spans.  Returns true if the header was valid
-/// and all declared messages were extractable.
+/// and all declared messages were extractable. Fills a vector per call;
+/// hot paths use forEachMoldUDP64Message.
 inline bool parseMoldUDP64(const uint8_t* data, size_t len, MoldUDP64Parsed& out) {
     out = MoldUDP64Parsed{};
     if (len < kMoldUDP64HeaderSize) return false;
@@ -10,6 +10,24 @@
 namespace qrsdp {
 namespace itch {
 
+static_assert(ItchEncoder::kMaxMessageSize == sizeof(StockDirectoryMsg),
+              "kMaxMessageSize must cover the largest message");
+
+namespace {
+
+template <typename Msg>
+size_t store(const Msg& msg, uint8_t* dst) {
+    std::memcpy(dst, &msg, sizeof(msg));
+    return sizeof(msg);
+}
+
+void checkCapacity(size_t need, size_t cap) {
+    if (cap < need)
+        throw std::runtime_error("ItchEncoder: destination buffer too small");
+}
+
+}  // namespace
+
 ItchEncoder::ItchEncoder(const std::string& symbol, uint16_t locate, uint32_t tick_size)
     : locate_(locate)
     , tick_size_(tick_size)
@@ -19,8 +37,28 @@ ItchEncoder::ItchEncoder(const std::string& symbol, uint16_t locate, uint32_t ti
     std::memcpy(symbol_, symbol.data(), len);
 }
 
+size_t ItchEncoder::encodedSize(const EventRecord& rec) {
+    switch (static_cast<EventType>(rec.type)) {
+    case EventType::ADD_BID:
+    case EventType::ADD_ASK:      return sizeof(AddOrderMsg);
+    case EventType::CANCEL_BID:
+    case EventType::CANCEL_ASK:   return sizeof(OrderDeleteMsg);
+    case EventType::EXECUTE_BUY:
+    case EventType::EXECUTE_SELL: return sizeof(OrderExecutedMsg);
+    default:
+        throw std::runtime_error("ItchEncoder: unknown event type");
+    }
+}
+
 std::vector<uint8_t> ItchEncoder::encode(const EventRecord& rec) const {
+    std::vector<uint8_t> out(encodedSize(rec));
+    encodeInto(rec, out.data(), out.size());
+    return out;
+}
+
+size_t ItchEncoder::encodeInto(const EventRecord& rec, uint8_t* dst, size_t cap) const {
     auto type = static_cast<EventType>(rec.type);
+    checkCapacity(encodedSize(rec), cap);
 
     switch (type) {
     case EventType::ADD_BID:
@@ -35,10 +73,7 @@ std::vector<uint8_t> ItchEncoder::encode(const EventRecord& rec) const {
         msg.shares         = htobe32(rec.qty);
         std::memcpy(msg.stock, symbol_, 8);
         msg.price          = htobe32(static_cast<uint32_t>(rec.price_ticks) * tick_size_);
-
-        std::vector<uint8_t> out(sizeof(msg));
-        std::memcpy(out.data(), &msg, sizeof(msg));
-        return out;
+        return store(msg, dst);
     }
 
     case EventType::CANCEL_BID:
@@ -49,10 +84,7 @@ std::vector<uint8_t> ItchEncoder::encode(const EventRecord& rec) const {
         msg.tracking_number = 0;
         store48be(msg.timestamp, rec.ts_ns);
         msg.order_reference = htobe64(rec.order_id);
-
-        std::vector<uint8_t> out(sizeof(msg));
-        std::memcpy(out.data(), &msg, sizeof(msg));
-        return out;
+        return store(msg, dst);
     }
 
     case EventType::EXECUTE_BUY:
@@ -65,10 +97,7 @@ std::vector<uint8_t> ItchEncoder::encode(const EventRecord& rec) const {
         msg.order_reference = htobe64(rec.order_id);
         msg.executed_shares = htobe32(rec.qty);
         msg.match_number   = htobe64(match_number_++);
-
-        std::vector<uint8_t> out(sizeof(msg));
-        std::memcpy(out.data(), &msg, sizeof(msg));
-        return out;
+        return store(msg, dst);
     }
 
     default:
@@ -77,19 +106,31 @@ std::vector<uint8_t> ItchEncoder::encode(const EventRecord& rec) const {
 }
 
 std::vector<uint8_t> ItchEncoder::encodeSystemEvent(char event_code, uint64_t ts_ns) const {
+    std::vector<uint8_t> out(sizeof(SystemEventMsg));
+    encodeSystemEventInto(event_code, ts_ns, out.data(), out.size());
+    return out;
+}
+
+size_t ItchEncoder::encodeSystemEventInto(char event_code, uint64_t ts_ns, uint8_t* dst,
+                                          size_t cap) const {
+    checkCapacity(sizeof(SystemEventMsg), cap);
     SystemEventMsg msg{};
     msg.message_type    = kMsgTypeSystemEvent;
     msg.stock_locate    = htobe16(locate_);
     msg.tracking_number = 0;
     store48be(msg.timestamp, ts_ns);
     msg.event_code      = event_code;
+    return store(msg, dst);
+}
 
-    std::vector<uint8_t> out(sizeof(msg));
-    std::memcpy(out.data(), &msg, sizeof(msg));
+std::vector<uint8_t> ItchEncoder::encodeStockDirectory(uint64_t ts_ns) const {
+    std::vector<uint8_t> out(sizeof(StockDirectoryMsg));
+    encodeStockDirectoryInto(ts_ns, out.data(), out.size());
     return out;
 }
 
-std::vector<uint8_t> ItchEncoder::encodeStockDirectory(uint64_t ts_ns) const {
+size_t ItchEncoder::encodeStockDirectoryInto(uint64_t ts_ns, uint8_t* dst, size_t cap) const {
+    checkCapacity(sizeof(StockDirectoryMsg), cap);
     StockDirectoryMsg msg{};
     std::memset(&msg, 0, sizeof(msg));
     msg.message_type    = kMsgTypeStockDirectory;
@@ -112,9 +153,19 @@ std::vector<uint8_t> ItchEncoder::encodeStockDirectory(uint64_t ts_ns) const {
     msg.etp_leverage_factor = 0;
     msg.inverse_indicator   = 'N';
 
-    std::vector<uint8_t> out(sizeof(msg));
-    std::memcpy(out.data(), &msg, sizeof(msg));
-    return out;
+    return store(msg, dst);
+}
+
+size_t ItchEncoder::encodeEndOfSnapshotInto(uint64_t ts_ns, uint64_t next_sequence, uint8_t* dst,
+                                            size_t cap) const {
+    checkCapacity(sizeof(EndOfSnapshotMsg), cap);
+    EndOfSnapshotMsg msg{};
+    msg.message_type    = kMsgTypeEndOfSnapshot;
+    msg.stock_locate    = htobe16(locate_);
+    msg.tracking_number = 0;
+    store48be(msg.timestamp, ts_ns);
+    msg.sequence_number = htobe64(next_sequence);
+    return store(msg, dst);
 }
 
 }  // namespace itch
@@ -2,6 +2,7 @@
 
 #include "core/records.h"
 
+#include <cstddef>
 #include <cstdint>
 #include <string>
 #include <vector>
@@ -10,8 +11,16 @@ namespace qrsdp {
 namespace itch {
 
 /// Encodes EventRecords into ITCH 5.0 binary messages for a single symbol.
+///
+/// The *Into variants serialise straight into a caller buffer (typically a slot
+/// from MoldUDP64Framer::reserveMessage) and return the bytes written; they
+/// throw std::runtime_error if cap is too small and never allocate. The
+/// vector-returning forms wrap them.
 class ItchEncoder {
 public:
+    /// Largest message any encode call produces (Stock Directory).
+    static constexpr size_t kMaxMessageSize = 39;
+
     /// @param symbol   Ticker symbol (max 8 chars, right-padded with spaces).
     /// @param locate   Stock locate code (unique per symbol in the session).
     /// @param tick_size Tick size in price-4 units (e.g. 100 means 1 tick = $0.0100).
@@ -19,12 +28,22 @@ public:
 
     /// Encode an EventRecord into the appropriate ITCH message bytes.
     std::vector<uint8_t> encode(const EventRecord& rec) const;
+    size_t encodeInto(const EventRecord& rec, uint8_t* dst, size_t cap) const;
+
+    /// Bytes encode(rec) writes. Throws std::runtime_error for an unknown type.
+    static size_t encodedSize(const EventRecord& rec);
 
     /// Encode a System Event message (e.g. start/end of session).
     std::vector<uint8_t> encodeSystemEvent(char event_code, uint64_t ts_ns) const;
+    size_t encodeSystemEventInto(char event_code, uint64_t ts_ns, uint8_t* dst, size_t cap) const;
 
     /// Encode a Stock Directory message for this symbol.
     std::vector<uint8_t> encodeStockDirectory(uint64_t ts_ns) const;
+    size_t encodeStockDirectoryInto(uint64_t ts_ns, uint8_t* dst, size_t cap) const;
+
+    /// Encode an End of Snapshot message for this symbol: the snapshot reflects
+    /// every main-feed message before next_sequence.
+    size_t encodeEndOfSnapshotInto(uint64_t ts_ns, uint64_t next_sequence, uint8_t* dst, size_t cap) const;
 
     uint64_t nextMatchNumber() const { return match_number_; }
 
@@ -0,0 +1,69 @@
+#include "itch/itch_feed_writer.h"
+#include "itch/itch_messages.h"
+
+#include <stdexcept>
+
+namespace qrsdp {
+namespace itch {
+
+ItchFeedWriter::ItchFeedWriter(MoldUDP64Framer& framer) : framer_(framer) {}
+
+uint32_t ItchFeedWriter::addSecurity(const std::string& symbol, uint32_t tick_size, uint16_t locate) {
+    if (locate == 0)
+        locate = static_cast<uint16_t>(encoders_.size() + 1);
+    encoders_.emplace_back(symbol, locate, tick_size);
+    announcers_.emplace_back();
+    return static_cast<uint32_t>(encoders_.size() - 1);
+}
+
+void ItchFeedWriter::systemEvent(char code, uint64_t ts_ns) {
+    constexpr uint16_t size = sizeof(SystemEventMsg);
+    uint8_t* dst = framer_.reserveMessage(size);
+    framer_.commitMessage(static_cast<uint16_t>(system_encoder_.encodeSystemEventInto(code, ts_ns, dst, size)));
+    ++messages_written_;
+}
+
+void ItchFeedWriter::begin(uint64_t ts_ns) {
+    systemEvent(kSystemEventStartOfMessages, ts_ns);
+    for (const auto& enc : encoders_) {
+        constexpr uint16_t size = sizeof(StockDirectoryMsg);
+        uint8_t* dst = framer_.reserveMessage(size);
+        framer_.commitMessage(static_cast<uint16_t>(enc.encodeStockDirectoryInto(ts_ns, dst, size)));
+        ++messages_written_;
+    }
+    systemEvent(kSystemEventStartOfMarket, ts_ns);
+}
+
+void ItchFeedWriter::encode(uint32_t security, const EventRecord& rec) {
+    const auto size = static_cast<uint16_t>(ItchEncoder::encodedSize(rec));
+    uint8_t* dst = framer_.reserveMessage(size);
+    framer_.commitMessage(static_cast<uint16_t>(encoders_[security].encodeInto(rec, dst, size)));
+    ++messages_written_;
+}
+
+void ItchFeedWriter::append(uint32_t security, const EventRecord& rec) {
+    if (security >= encoders_.size())
+        throw std::out_of_range("ItchFeedWriter: unknown security index");
+    encode(security, rec);
+    if (OrderBookAnnouncer* announcer = announcers_[security].get()) {
+        for (const EventRecord& change : announcer->apply(rec)) encode(security, change);
+    }
+}
+
+void ItchFeedWriter::startOrderBook(uint32_t security, const BookSeed& seed, uint64_t ts_ns) {
+    if (security >= encoders_.size())
+        throw std::out_of_range("ItchFeedWriter: unknown security index");
+    std::unique_ptr<OrderBookAnnouncer>& announcer = announcers_[security];
+    if (!announcer) announcer = std::make_unique<OrderBookAnnouncer>();
+    for (const EventRecord& change : announcer->finish(ts_ns)) encode(security, change);
+    for (const EventRecord& change : announcer->start(seed, ts_ns)) encode(security, change);
+}
+
+void ItchFeedWriter::end(uint64_t ts_ns) {
+    systemEvent(kSystemEventEndOfMarket, ts_ns);
+    systemEvent(kSystemEventEndOfMessages, ts_ns);
+    framer_.sendPending();
+}
+
+}  // namespace itch
+}  // namespace qrsdp
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "io/i_consolidated_sink.h"
+#include "itch/itch_encoder.h"
+#include "itch/moldudp64.h"
+#include "itch/order_book_announcer.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace qrsdp {
+namespace itch {
+
+/// Encodes a consolidated multi-security stream (e.g. from MultiSecurityProducer)
+/// as ITCH 5.0 into one MoldUDP64Framer, with no Kafka hop. Security i is sent
+/// with stock locate i + 1, in the order securities were added, unless it is
+/// given its own (a feed split across channels keeps the whole run's locates).
+///
+/// Packets go out through the framer's send callback; end() sends the last one.
+/// Messages are encoded straight into the framer's packet buffer, so appending
+/// does not allocate.
+class ItchFeedWriter final : public IConsolidatedSink {
+public:
+    explicit ItchFeedWriter(MoldUDP64Framer& framer);
+
+    /// Registers the next security index; must be called before begin().
+    /// locate 0 means index + 1.
+    uint32_t addSecurity(const std::string& symbol, uint32_t tick_size, uint16_t locate = 0);
+
+    /// Start of Messages, a Stock Directory per security, then Start of Market.
+    void begin(uint64_t ts_ns);
+    void append(uint32_t security, const EventRecord& rec) override;
+    /// From here on, security's records come from an order-level book
+    /// (qrsdp_run --order-book) seeded with seed: sends its seed orders as Add
+    /// Orders stamped ts_ns, and after each appended record the orders the book
+    /// created or dropped besides it (OrderBookAnnouncer), so the feed carries
+    /// every order. Called again for the security's next session, it first
+    /// deletes the orders left from the previous one. Call after begin().
+    void startOrderBook(uint32_t security, const BookSeed& seed, uint64_t ts_ns);
+    /// End of Market and End of Messages, then sends the final packet.
+    void end(uint64_t ts_ns);
+
+    void flush() override { framer_.sendPending(); }
+    void close() override { flush(); }
+
+    uint64_t messagesWritten() const { return messages_written_; }
+    const ItchEncoder& encoder(uint32_t security) const { return encoders_[security]; }
+
+private:
+    void systemEvent(char code, uint64_t ts_ns);
+    void encode(uint32_t security, const EventRecord& rec);
+
+    MoldUDP64Framer& framer_;
+    const ItchEncoder system_encoder_{"", 0, 1};
+    std::vector<ItchEncoder> encoders_;
+    std::vector<std::unique_ptr<OrderBookAnnouncer>> announcers_;  // null: not order-level
+    uint64_t messages_written_ = 0;
+};
+
+}  // namespace itch
+}  // namespace qrsdp
@@ -1,6 +1,7 @@
 #pragma once
 
-/// ITCH 5.0 message structs (5-message subset).
+/// ITCH 5.0 message structs (5-message subset), plus the End of Snapshot
+/// message of the snapshot channel.
 /// All multi-byte fields are big-endian on the wire.
 /// Structs are stored in **host byte order** — the encoder is responsible
 /// for converting to big-endian before writing into these structs.
@@ -17,6 +18,7 @@ constexpr char kMsgTypeStockDirectory = 'R';
 constexpr char kMsgTypeAddOrder      = 'A';
 constexpr char kMsgTypeOrderDelete   = 'D';
 constexpr char kMsgTypeOrderExecuted = 'E';
+constexpr char kMsgTypeEndOfSnapshot = 'G';  // snapshot channel only (as in GLIMPSE 5.0)
 
 // --- System Event codes ---
 constexpr char kSystemEventStartOfMessages  = 'O';
@@ -102,6 +104,18 @@ struct OrderExecutedMsg {
 };
 static_assert(sizeof(OrderExecutedMsg) == 31, "OrderExecutedMsg must be 31 bytes");
 
+/// End of Snapshot Message (19 bytes). Closes one security's book snapshot on
+/// the snapshot channel. GLIMPSE 5.0 carries the sequence number as 20 ASCII
+/// digits; here it is a binary big-endian field like the rest of the message.
+struct EndOfSnapshotMsg {
+    char     message_type;        // 'G'
+    uint16_t stock_locate;
+    uint16_t tracking_number;
+    uint8_t  timestamp[6];
+    uint64_t sequence_number;     // first main-feed message not reflected in the snapshot
+};
+static_assert(sizeof(EndOfSnapshotMsg) == 19, "EndOfSnapshotMsg must be 19 bytes");
+
 #pragma pack(pop)
 
 // -------------------------------------------------------------------------
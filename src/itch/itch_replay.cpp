@@ -0,0 +1,132 @@
+#include "itch/itch_replay.h"
+#include "itch/itch_feed_writer.h"
+#include "core/records.h"
+
+#include <chrono>
+#include <functional>
+#include <queue>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+namespace qrsdp {
+namespace itch {
+
+namespace {
+
+/// Closer than this to an event's due time we send it rather than sleep.
+constexpr double kMinSleepSeconds = 50e-6;
+
+}  // namespace
+
+/// One session being replayed: its reader and a cursor into the current chunk.
+struct ItchReplayer::Source {
+    std::string symbol;
+    std::unique_ptr<EventLogReader> reader;
+    std::vector<DiskEventRecord> scratch;
+    RecordSpan span;
+    uint32_t next_chunk = 0;
+    size_t pos = 0;
+
+    /// Moves to the next record; false once the session is exhausted.
+    bool advance() {
+        if (++pos < span.size)
+            return true;
+        while (next_chunk < reader->chunkCount()) {
+            span = reader->chunkRecords(next_chunk++, scratch);
+            pos = 0;
+            if (!span.empty())
+                return true;
+        }
+        return false;
+    }
+
+    const DiskEventRecord& current() const { return span[pos]; }
+};
+
+ItchReplayer::ItchReplayer(MoldUDP64Framer& framer, const ReplayOptions& options)
+    : framer_(framer), options_(options) {
+    if (options.pacing == ReplayPacing::Realtime && !(options.speed > 0.0))
+        throw std::runtime_error("ItchReplayer: realtime pacing needs a positive speed");
+    if (options.pacing == ReplayPacing::FixedRate && !(options.rate > 0.0))
+        throw std::runtime_error("ItchReplayer: fixed-rate pacing needs a positive rate");
+}
+
+ItchReplayer::~ItchReplayer() = default;
+
+void ItchReplayer::addSource(const std::string& symbol, std::unique_ptr<EventLogReader> reader) {
+    if (!reader)
+        throw std::runtime_error("ItchReplayer: null reader for " + symbol);
+    auto source = std::make_unique<Source>();
+    source->symbol = symbol;
+    source->reader = std::move(reader);
+    sources_.push_back(std::move(source));
+}
+
+uint64_t ItchReplayer::run() {
+    ItchFeedWriter writer(framer_);
+    // Min-heap of (timestamp, source index): the next event of every live source.
+    using Head = std::pair<uint64_t, size_t>;
+    std::priority_queue<Head, std::vector<Head>, std::greater<Head>> heads;
+    for (size_t i = 0; i < sources_.size(); ++i) {
+        Source& s = *sources_[i];
+        writer.addSecurity(s.symbol, s.reader->header().tick_size);
+        s.pos = 0;
+        s.span = RecordSpan{};
+        if (s.advance()) {
+            const uint64_t ts = s.current().ts_ns;  // packed field: copy, never bind
+            heads.emplace(ts, i);
+        }
+    }
+
+    const uint64_t first_ts = heads.empty() ? 0 : heads.top().first;
+    uint64_t last_ts = first_ts;
+    writer.begin(first_ts);
+    if (options_.order_book) {
+        for (size_t i = 0; i < sources_.size(); ++i) {
+            const FileHeader& h = sources_[i]->reader->header();
+            writer.startOrderBook(static_cast<uint32_t>(i),
+                                  BookSeed{h.p0_ticks, h.levels_per_side, h.initial_depth, h.initial_spread_ticks},
+                                  first_ts);
+        }
+    }
+
+    const bool paced = options_.pacing != ReplayPacing::AsFastAsPossible;
+    const auto wall_start = std::chrono::steady_clock::now();
+    uint64_t sent = 0;
+    while (!heads.empty() && running_.load(std::memory_order_relaxed)) {
+        const size_t idx = heads.top().second;
+        heads.pop();
+        Source& s = *sources_[idx];
+        const DiskEventRecord& disk = s.current();
+
+        if (paced) {
+            const double due = options_.pacing == ReplayPacing::Realtime
+                ? static_cast<double>(disk.ts_ns > first_ts ? disk.ts_ns - first_ts : 0)
+                      * 1e-9 / options_.speed
+                : static_cast<double>(sent) / options_.rate;
+            const double ahead = due - std::chrono::duration<double>(
+                std::chrono::steady_clock::now() - wall_start).count();
+            if (ahead > kMinSleepSeconds) {
+                writer.flush();
+                std::this_thread::sleep_for(std::chrono::duration<double>(ahead));
+            }
+        }
+
+        const EventRecord rec = fromDisk(disk);
+        writer.append(static_cast<uint32_t>(idx), rec);
+        last_ts = rec.ts_ns;
+        ++sent;
+
+        if (s.advance()) {
+            const uint64_t ts = s.current().ts_ns;
+            heads.emplace(ts, idx);
+        }
+    }
+
+    writer.end(last_ts);
+    return sent;
+}
+
+}  // namespace itch
+}  // namespace qrsdp
@@ -0,0 +1,78 @@
+#pragma once
+
+#include "io/event_log_reader.h"
+#include "itch/moldudp64.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace qrsdp {
+namespace itch {
+
+/// How ItchReplayer spaces events in wall-clock time.
+enum class ReplayPacing : uint8_t {
+    AsFastAsPossible,  // no waiting; the framer and sender set the rate
+    Realtime,          // event timestamps, sped up by ReplayOptions::speed
+    FixedRate,         // ReplayOptions::rate events per second
+};
+
+struct ReplayOptions {
+    ReplayPacing pacing = ReplayPacing::AsFastAsPossible;
+    double speed = 1.0;  // Realtime: event time elapsed per wall second
+    double rate = 0.0;   // FixedRate: events per second
+    bool order_book = false;  // sessions from qrsdp_run --order-book: announce the book's own orders
+};
+
+/// Replays recorded .qrsdp sessions as one ITCH 5.0 feed, straight from the
+/// file mappings into a MoldUDP64Framer with no Kafka hop. Sources are merged
+/// by timestamp (ties go to the source added first) and written through an
+/// ItchFeedWriter, so source i is sent with stock locate i + 1 and the feed is
+/// bracketed by the usual system events and stock directory. Given the same
+/// files the feed is byte-for-byte the same every run; only its timing depends
+/// on the pacing.
+///
+/// With options.order_book, each source is taken to be an order-level session:
+/// its book, rebuilt from the file header and records, adds the seed orders
+/// and the orders the book created or dropped by itself
+/// (ItchFeedWriter::startOrderBook), and run() throws std::runtime_error if a
+/// record names an order that book does not have.
+///
+/// Records are read chunk by chunk, so memory stays at one chunk per source.
+/// Before waiting for an event's due time the framer's pending packets are
+/// sent, so pacing never holds a message back.
+class ItchReplayer {
+public:
+    /// Throws std::runtime_error if pacing needs a speed or rate that is not positive.
+    ItchReplayer(MoldUDP64Framer& framer, const ReplayOptions& options);
+    ~ItchReplayer();
+
+    ItchReplayer(const ItchReplayer&) = delete;
+    ItchReplayer& operator=(const ItchReplayer&) = delete;
+
+    /// Adds a session to replay as symbol, at the tick size in its header.
+    /// Must be called before run().
+    void addSource(const std::string& symbol, std::unique_ptr<EventLogReader> reader);
+    size_t sourceCount() const { return sources_.size(); }
+
+    /// Replays every source to the end (or until stop()) and sends the last
+    /// packet. Returns the number of events sent. Call at most once.
+    uint64_t run();
+
+    /// Makes run() finish after the current event (thread-safe).
+    void stop() { running_.store(false, std::memory_order_relaxed); }
+
+private:
+    struct Source;
+
+    MoldUDP64Framer& framer_;
+    ReplayOptions options_;
+    std::vector<std::unique_ptr<Source>> sources_;
+    std::atomic<bool> running_{true};
+};
+
+}  // namespace itch
+}  // namespace qrsdp
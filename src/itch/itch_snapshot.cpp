@@ -0,0 +1,78 @@
+#include "itch/itch_snapshot.h"
+#include "core/event_types.h"
+#include "itch/endian.h"
+#include "itch/itch_decoder.h"
+#include "itch/itch_messages.h"
+
+#include <cstring>
+#include <type_traits>
+#include <utility>
+
+namespace qrsdp {
+namespace itch {
+
+size_t writeBookSnapshot(MoldUDP64Framer& framer, const ItchEncoder& encoder,
+                         const BookCheckpoint& book, uint64_t next_sequence) {
+    size_t written = 0;
+    {
+        constexpr uint16_t size = sizeof(StockDirectoryMsg);
+        uint8_t* dst = framer.reserveMessage(size);
+        framer.commitMessage(static_cast<uint16_t>(encoder.encodeStockDirectoryInto(book.ts_ns, dst, size)));
+        ++written;
+    }
+    auto levels = [&](const std::vector<Level>& side, EventType type) {
+        EventRecord rec{};
+        rec.ts_ns = book.ts_ns;
+        rec.type = static_cast<uint8_t>(type);
+        rec.side = static_cast<uint8_t>(type == EventType::ADD_BID ? Side::BID : Side::ASK);
+        for (const Level& level : side) {
+            if (level.depth == 0)
+                continue;
+            rec.price_ticks = level.price_ticks;
+            rec.qty = level.depth;
+            constexpr uint16_t size = sizeof(AddOrderMsg);
+            uint8_t* dst = framer.reserveMessage(size);
+            framer.commitMessage(static_cast<uint16_t>(encoder.encodeInto(rec, dst, size)));
+            ++written;
+        }
+    };
+    levels(book.bids, EventType::ADD_BID);
+    levels(book.asks, EventType::ADD_ASK);
+    constexpr uint16_t size = sizeof(EndOfSnapshotMsg);
+    uint8_t* dst = framer.reserveMessage(size);
+    framer.commitMessage(static_cast<uint16_t>(encoder.encodeEndOfSnapshotInto(book.ts_ns, next_sequence, dst, size)));
+    return written + 1;
+}
+
+bool SnapshotAssembler::onMessage(const uint8_t* msg, size_t len, ItchBookSnapshot& out) {
+    bool done = false;
+    visitItchMessage(msg, len, [&](const auto& m) {
+        using Msg = std::decay_t<decltype(m)>;
+        const uint16_t locate = betoh16(m.stock_locate);
+        if constexpr (std::is_same_v<Msg, StockDirectoryMsg>) {
+            ItchBookSnapshot& snap = pending_[locate];
+            snap = ItchBookSnapshot{};
+            snap.stock_locate = locate;
+            std::memcpy(snap.stock, m.stock, sizeof(snap.stock));
+        } else if constexpr (std::is_same_v<Msg, AddOrderMsg>) {
+            const auto it = pending_.find(locate);
+            if (it == pending_.end())
+                return;
+            const SnapshotLevel level{betoh32(m.price), betoh32(m.shares)};
+            (m.buy_sell == 'B' ? it->second.bids : it->second.asks).push_back(level);
+        } else if constexpr (std::is_same_v<Msg, EndOfSnapshotMsg>) {
+            const auto it = pending_.find(locate);
+            if (it == pending_.end())
+                return;
+            out = std::move(it->second);
+            out.ts_ns = load48be(m.timestamp);
+            out.next_sequence = betoh64(m.sequence_number);
+            pending_.erase(it);
+            done = true;
+        }
+    });
+    return done;
+}
+
+}  // namespace itch
+}  // namespace qrsdp
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "io/book_checkpoint.h"
+#include "itch/itch_encoder.h"
+#include "itch/moldudp64.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <vector>
+
+namespace qrsdp {
+namespace itch {
+
+/// Writes one security's book snapshot to the snapshot channel's framer: a
+/// Stock Directory, an Add Order per non-empty level (order reference 0, the
+/// level's whole depth as shares; bids best first, then asks best first) and
+/// an End of Snapshot carrying next_sequence, the first message of the main
+/// feed's session that the book does not reflect. Returns messages written.
+size_t writeBookSnapshot(MoldUDP64Framer& framer, const ItchEncoder& encoder,
+                         const BookCheckpoint& book, uint64_t next_sequence);
+
+/// One level of a received snapshot, in wire units.
+struct SnapshotLevel {
+    uint32_t price;   // price-4 units
+    uint32_t shares;
+};
+
+/// A security's book as received from the snapshot channel.
+struct ItchBookSnapshot {
+    uint16_t stock_locate = 0;
+    char     stock[8] = {};
+    uint64_t ts_ns = 0;
+    uint64_t next_sequence = 0;  // apply main-feed messages from this sequence on
+    std::vector<SnapshotLevel> bids;  // best first
+    std::vector<SnapshotLevel> asks;
+};
+
+/// Client side of the snapshot channel: feed it every message in sequence
+/// order and it hands back each security's snapshot when its End of Snapshot
+/// arrives. A late joiner buffers the main feed, takes the first snapshot of
+/// each security it wants and applies that security's buffered and live
+/// messages from next_sequence on.
+class SnapshotAssembler {
+public:
+    /// Returns true (and fills out) when msg completes a snapshot. Messages of
+    /// other types, or levels of a security without a directory first (joined
+    /// mid-snapshot), are ignored.
+    bool onMessage(const uint8_t* msg, size_t len, ItchBookSnapshot& out);
+
+private:
+    std::map<uint16_t, ItchBookSnapshot> pending_;  // by stock locate
+};
+
+}  // namespace itch
+}  // namespace qrsdp
@@ -1,224 +1,235 @@
 #ifdef QRSDP_KAFKA_ENABLED
 
 #include "itch/itch_stream_consumer.h"
-#include "itch/itch_encoder.h"
-#include "itch/itch_messages.h"
-#include "itch/moldudp64.h"
 #include "itch/udp_sender.h"
-#include "io/event_log_format.h"
 
+#include <librdkafka/rdkafka.h>
 #include <librdkafka/rdkafkacpp.h>
 
+#include <algorithm>
 #include <cstdio>
 #include <cstdlib>
-#include <cstring>
 #include <memory>
 #include <stdexcept>
 #include <string>
-#include <unordered_map>
 #include <vector>
 
 namespace qrsdp {
 namespace itch {
 
-struct ItchStreamConsumer::Impl {
-    ItchStreamConfig config;
-    std::unique_ptr<RdKafka::KafkaConsumer> consumer;
-    std::unique_ptr<UdpMulticastSender> sender;
-    MoldUDP64Framer framer;
-    std::unordered_map<std::string, std::unique_ptr<ItchEncoder>> encoders;
-    uint16_t next_locate = 1;
-    uint64_t last_ts_ns = 0;
-    bool seen_first_event = false;
-
-    explicit Impl(const ItchStreamConfig& cfg)
-        : config(cfg)
-        , framer("QRSDPITCH ")
-    {}
-
-    void emitSystemEvent(char code, uint64_t ts_ns) {
-        ItchEncoder sys_enc("", 0, config.tick_size);
-        auto msg = sys_enc.encodeSystemEvent(code, ts_ns);
-        framer.addMessage(msg.data(), static_cast<uint16_t>(msg.size()));
-    }
-
-    ItchEncoder& getEncoder(const std::string& symbol) {
-        auto it = encoders.find(symbol);
-        if (it != encoders.end())
-            return *it->second;
-
-        uint16_t locate = next_locate++;
-        auto enc = std::make_unique<ItchEncoder>(symbol, locate, config.tick_size);
+namespace {
 
-        // Emit Stock Directory for the new symbol
-        auto dir_msg = enc->encodeStockDirectory(0);
-        framer.addMessage(dir_msg.data(), static_cast<uint16_t>(dir_msg.size()));
+constexpr int kMetadataTimeoutMs = 10000;
 
-        auto [inserted, ok] = encoders.emplace(symbol, std::move(enc));
-        return *inserted->second;
-    }
-};
+void destroyMessage(void* handle) {
+    rd_kafka_message_destroy(static_cast<rd_kafka_message_t*>(handle));
+}
 
-ItchStreamConsumer::ItchStreamConsumer(const ItchStreamConfig& config)
-    : impl_(new Impl(config))
-{
-    std::string errstr;
-
-    auto conf = std::unique_ptr<RdKafka::Conf>(
-        RdKafka::Conf::create(RdKafka::Conf::CONF_GLOBAL));
-
-    if (conf->set("bootstrap.servers", config.kafka_brokers, errstr) != RdKafka::Conf::CONF_OK)
-        throw std::runtime_error("ItchStreamConsumer: " + errstr);
-    if (conf->set("group.id", config.consumer_group, errstr) != RdKafka::Conf::CONF_OK)
-        throw std::runtime_error("ItchStreamConsumer: " + errstr);
-    if (conf->set("auto.offset.reset", "earliest", errstr) != RdKafka::Conf::CONF_OK)
-        throw std::runtime_error("ItchStreamConsumer: " + errstr);
-    if (conf->set("enable.auto.commit", "true", errstr) != RdKafka::Conf::CONF_OK)
-        throw std::runtime_error("ItchStreamConsumer: " + errstr);
-
-    impl_->consumer.reset(RdKafka::KafkaConsumer::create(conf.get(), errstr));
-    if (!impl_->consumer)
-        throw std::runtime_error("ItchStreamConsumer: failed to create consumer: " + errstr);
-
-    std::vector<std::string> topics = { config.kafka_topic };
-    auto err = impl_->consumer->subscribe(topics);
-    if (err != RdKafka::ERR_NO_ERROR)
-        throw std::runtime_error("ItchStreamConsumer: subscribe failed: " +
-                                 RdKafka::err2str(err));
+/// Partition count of topic from the broker metadata. Throws std::runtime_error
+/// if the topic does not exist or the brokers cannot be reached.
+int topicPartitionCount(rd_kafka_t* rk, const std::string& topic) {
+    rd_kafka_topic_t* rkt = rd_kafka_topic_new(rk, topic.c_str(), nullptr);
+    if (!rkt)
+        throw std::runtime_error("ItchStreamConsumer: cannot open topic " + topic);
+    const struct rd_kafka_metadata* md = nullptr;
+    const rd_kafka_resp_err_t err = rd_kafka_metadata(rk, 0, rkt, &md, kMetadataTimeoutMs);
+    int count = 0;
+    if (err == RD_KAFKA_RESP_ERR_NO_ERROR && md->topic_cnt == 1
+        && md->topics[0].err == RD_KAFKA_RESP_ERR_NO_ERROR)
+        count = md->topics[0].partition_cnt;
+    if (md)
+        rd_kafka_metadata_destroy(md);
+    rd_kafka_topic_destroy(rkt);
+    if (count <= 0)
+        throw std::runtime_error("ItchStreamConsumer: no partitions for topic " + topic + ": "
+                                 + rd_kafka_err2str(err));
+    return count;
+}
 
+/// Sender of one output channel: channel c goes to port + c (AF_XDP: queue_id + c).
+std::unique_ptr<IDatagramSender> makeSender(const ItchStreamConfig& config, uint32_t channel) {
+    std::string dest_host = config.multicast_group;
+    uint16_t dest_port = config.port;
     if (!config.unicast_dest.empty()) {
         auto colon = config.unicast_dest.rfind(':');
         if (colon == std::string::npos || colon == 0)
             throw std::runtime_error("ItchStreamConsumer: bad --unicast-dest, expected host:port");
-        std::string host = config.unicast_dest.substr(0, colon);
-        uint16_t uport = static_cast<uint16_t>(std::atoi(
+        dest_host = config.unicast_dest.substr(0, colon);
+        dest_port = static_cast<uint16_t>(std::atoi(
             config.unicast_dest.substr(colon + 1).c_str()));
-        impl_->sender = UdpMulticastSender::createUnicast(host, uport);
-        std::printf("ItchStreamConsumer: consuming %s from %s, unicast to %s\n",
+    }
+    dest_port = static_cast<uint16_t>(dest_port + channel);
+
+    if (!config.xdp.interface.empty()) {
+#ifdef QRSDP_XDP_ENABLED
+        XdpConfig xdp = config.xdp;
+        xdp.queue_id += channel;
+        auto sender = std::make_unique<XdpSender>(xdp, dest_host, dest_port, config.ttl);
+        std::printf("ItchStreamConsumer: consuming %s from %s, AF_XDP on %s queue %u to %s:%u\n",
                     config.kafka_topic.c_str(), config.kafka_brokers.c_str(),
-                    config.unicast_dest.c_str());
+                    xdp.interface.c_str(), xdp.queue_id, dest_host.c_str(), dest_port);
+        return sender;
+#else
+        throw std::runtime_error("ItchStreamConsumer: AF_XDP backend not built (BUILD_XDP_SUPPORT=OFF)");
+#endif
+    }
+    std::unique_ptr<UdpMulticastSender> sender;
+    if (!config.unicast_dest.empty()) {
+        sender = UdpMulticastSender::createUnicast(dest_host, dest_port);
+        std::printf("ItchStreamConsumer: consuming %s from %s, unicast to %s:%u\n",
+                    config.kafka_topic.c_str(), config.kafka_brokers.c_str(),
+                    dest_host.c_str(), dest_port);
     } else {
-        impl_->sender = std::make_unique<UdpMulticastSender>(
-            config.multicast_group, config.port, config.ttl);
+        sender = std::make_unique<UdpMulticastSender>(dest_host, dest_port, config.ttl);
         std::printf("ItchStreamConsumer: consuming %s from %s, multicast to %s:%u\n",
                     config.kafka_topic.c_str(), config.kafka_brokers.c_str(),
-                    config.multicast_group.c_str(), config.port);
+                    dest_host.c_str(), dest_port);
     }
-
-    impl_->framer.setSendCallback([this](const uint8_t* data, size_t len) {
-        impl_->sender->send(data, len);
-    });
+    if (config.gso && !sender->enableGso(true))
+        std::fprintf(stderr, "ItchStreamConsumer: UDP GSO not supported here, sending plain batches\n");
+    return sender;
 }
 
-ItchStreamConsumer::~ItchStreamConsumer() {
-    if (impl_->consumer)
-        impl_->consumer->close();
-    delete impl_;
-}
+/// IStreamSource over a librdkafka consumer. Subscribed in its group, or with
+/// partition_threads assigned every partition of the topic, each read from its
+/// own queue.
+class KafkaStreamSource final : public IStreamSource {
+public:
+    explicit KafkaStreamSource(const ItchStreamConfig& config) {
+        int partition_count = 0;
+        std::string errstr;
+
+        auto conf = std::unique_ptr<RdKafka::Conf>(
+            RdKafka::Conf::create(RdKafka::Conf::CONF_GLOBAL));
+
+        if (conf->set("bootstrap.servers", config.kafka_brokers, errstr) != RdKafka::Conf::CONF_OK)
+            throw std::runtime_error("ItchStreamConsumer: " + errstr);
+        if (conf->set("group.id", config.consumer_group, errstr) != RdKafka::Conf::CONF_OK)
+            throw std::runtime_error("ItchStreamConsumer: " + errstr);
+        if (conf->set("auto.offset.reset", "earliest", errstr) != RdKafka::Conf::CONF_OK)
+            throw std::runtime_error("ItchStreamConsumer: " + errstr);
+        if (conf->set("enable.auto.commit", "true", errstr) != RdKafka::Conf::CONF_OK)
+            throw std::runtime_error("ItchStreamConsumer: " + errstr);
+
+        consumer_.reset(RdKafka::KafkaConsumer::create(conf.get(), errstr));
+        if (!consumer_)
+            throw std::runtime_error("ItchStreamConsumer: failed to create consumer: " + errstr);
+
+        if (config.partition_threads) {
+            // Every partition, assigned directly: the merge needs them all.
+            partition_count = topicPartitionCount(consumer_->c_ptr(), config.kafka_topic);
+            std::vector<RdKafka::TopicPartition*> partitions;
+            for (int p = 0; p < partition_count; ++p)
+                partitions.push_back(RdKafka::TopicPartition::create(config.kafka_topic, p));
+            auto err = consumer_->assign(partitions);
+            RdKafka::TopicPartition::destroy(partitions);
+            if (err != RdKafka::ERR_NO_ERROR)
+                throw std::runtime_error("ItchStreamConsumer: assign failed: " +
+                                         RdKafka::err2str(err));
+            std::printf("ItchStreamConsumer: %d partitions, one reader thread each\n",
+                        partition_count);
+        } else {
+            std::vector<std::string> topics = { config.kafka_topic };
+            auto err = consumer_->subscribe(topics);
+            if (err != RdKafka::ERR_NO_ERROR)
+                throw std::runtime_error("ItchStreamConsumer: subscribe failed: " +
+                                         RdKafka::err2str(err));
+        }
 
-void ItchStreamConsumer::run() {
-    running_ = true;
+        queues_.push_back(Queue{rd_kafka_queue_get_consumer(consumer_->c_ptr()), {}});
+        for (int p = 0; p < partition_count; ++p) {
+            rd_kafka_queue_t* q = rd_kafka_queue_get_partition(consumer_->c_ptr(),
+                                                               config.kafka_topic.c_str(), p);
+            rd_kafka_queue_forward(q, nullptr);  // read it here, not via consume()
+            queues_.push_back(Queue{q, {}});
+        }
+    }
 
-    // Emit System Event: start of messages
-    {
-        ItchEncoder sys_enc("", 0, impl_->config.tick_size);
-        auto msg = sys_enc.encodeSystemEvent(kSystemEventStartOfMessages, 0);
-        impl_->framer.addMessage(msg.data(), static_cast<uint16_t>(msg.size()));
-        auto pkt = impl_->framer.flush();
-        if (!pkt.empty())
-            impl_->sender->send(pkt.data(), pkt.size());
+    ~KafkaStreamSource() override {
+        for (Queue& q : queues_)
+            rd_kafka_queue_destroy(q.queue);
+        consumer_->close();
     }
 
-    uint64_t total_messages = 0;
+    int partitionCount() const override { return static_cast<int>(queues_.size()) - 1; }
+
+    size_t consume(int partition, int timeout_ms, StreamMessage* out, size_t max) override {
+        Queue& q = queues_[static_cast<size_t>(partition + 1)];
+        q.batch.resize(max);
+        const ssize_t n = rd_kafka_consume_batch_queue(q.queue, timeout_ms, q.batch.data(), max);
+        size_t count = 0;
+        for (ssize_t i = 0; i < n; ++i) {
+            rd_kafka_message_t* m = q.batch[static_cast<size_t>(i)];
+            if (m->err == RD_KAFKA_RESP_ERR__PARTITION_EOF) {
+                rd_kafka_message_destroy(m);
+                continue;
+            }
+            StreamMessage& sm = out[count++];
+            sm = StreamMessage{};
+            sm.key = static_cast<const char*>(m->key);
+            sm.key_len = m->key_len;
+            sm.payload = m->payload;
+            sm.len = m->len;
+            sm.partition = static_cast<int>(m->partition);
+            sm.error = m->err ? rd_kafka_message_errstr(m) : nullptr;
+            sm.handle = m;
+        }
+        return count;
+    }
 
-    while (running_) {
-        std::unique_ptr<RdKafka::Message> kafka_msg(impl_->consumer->consume(100));
+    PartitionMerge::ReleaseFn releaseFn() const override { return destroyMessage; }
 
-        if (kafka_msg->err() == RdKafka::ERR__TIMED_OUT)
-            continue;
+    void pollEvents() override {
+        // Errors and rebalance events still arrive on the consumer queue.
+        std::unique_ptr<RdKafka::Message> event(consumer_->consume(0));
+        if (event->err() != RdKafka::ERR_NO_ERROR && event->err() != RdKafka::ERR__TIMED_OUT
+            && event->err() != RdKafka::ERR__PARTITION_EOF)
+            std::fprintf(stderr, "ItchStreamConsumer: consumer error: %s\n",
+                         event->errstr().c_str());
+    }
 
-        if (kafka_msg->err() == RdKafka::ERR__PARTITION_EOF)
-            continue;
+private:
+    /// A queue and the batch buffer of the one thread reading it.
+    struct Queue {
+        rd_kafka_queue_t* queue;
+        std::vector<rd_kafka_message_t*> batch;
+    };
 
-        if (kafka_msg->err() != RdKafka::ERR_NO_ERROR) {
-            std::fprintf(stderr, "ItchStreamConsumer: consumer error: %s\n",
-                         kafka_msg->errstr().c_str());
-            continue;
-        }
+    std::unique_ptr<RdKafka::KafkaConsumer> consumer_;
+    std::vector<Queue> queues_;  // [0] the consumer queue, [1 + p] partition p
+};
 
-        if (kafka_msg->len() != sizeof(DiskEventRecord)) {
-            std::fprintf(stderr, "ItchStreamConsumer: unexpected message size %zu (expected %zu)\n",
-                         kafka_msg->len(), sizeof(DiskEventRecord));
-            continue;
-        }
+std::vector<std::unique_ptr<IDatagramSender>> makeSenders(const ItchStreamConfig& config) {
+    std::vector<std::unique_ptr<IDatagramSender>> senders;
+    const uint32_t channel_count = std::max<uint32_t>(config.channels.channels, 1);
+    for (uint32_t c = 0; c < channel_count; ++c)
+        senders.push_back(makeSender(config, c));
+    return senders;
+}
 
-        // Extract symbol from message key
-        std::string symbol;
-        if (kafka_msg->key() && !kafka_msg->key()->empty())
-            symbol = *kafka_msg->key();
-        else
-            symbol = "UNKNOWN";
-
-        // Deserialize
-        DiskEventRecord disk;
-        std::memcpy(&disk, kafka_msg->payload(), sizeof(disk));
-
-        EventRecord rec{};
-        rec.ts_ns       = disk.ts_ns;
-        rec.type        = disk.type;
-        rec.side        = disk.side;
-        rec.price_ticks = disk.price_ticks;
-        rec.qty         = disk.qty;
-        rec.order_id    = disk.order_id;
-        rec.flags       = 0;
-
-        // Day-boundary detection: timestamp going backward indicates a new trading day
-        if (!impl_->seen_first_event) {
-            impl_->emitSystemEvent(kSystemEventStartOfMarket, rec.ts_ns);
-            impl_->seen_first_event = true;
-        } else if (rec.ts_ns < impl_->last_ts_ns) {
-            impl_->emitSystemEvent(kSystemEventEndOfMarket, impl_->last_ts_ns);
-            impl_->emitSystemEvent(kSystemEventStartOfMarket, rec.ts_ns);
-        }
-        impl_->last_ts_ns = rec.ts_ns;
+}  // namespace
 
-        // Encode to ITCH
-        auto& encoder = impl_->getEncoder(symbol);
-        auto itch_msg = encoder.encode(rec);
-        impl_->framer.addMessage(itch_msg.data(), static_cast<uint16_t>(itch_msg.size()));
+struct ItchStreamConsumer::Impl {
+    KafkaStreamSource source;
+    ItchStreamer streamer;
 
-        ++total_messages;
-        if ((total_messages & 0xFFFFF) == 0) {
-            std::printf("ItchStreamConsumer: streamed %llu messages\n",
-                        static_cast<unsigned long long>(total_messages));
-        }
-    }
+    explicit Impl(const ItchStreamConfig& config)
+        : source(config)
+        , streamer(config, source, makeSenders(config))
+    {}
+};
 
-    // Flush remaining buffered messages
-    auto pkt = impl_->framer.flush();
-    if (!pkt.empty())
-        impl_->sender->send(pkt.data(), pkt.size());
-
-    // Emit end-of-market for the last day (if we saw any events)
-    if (impl_->seen_first_event) {
-        impl_->emitSystemEvent(kSystemEventEndOfMarket, impl_->last_ts_ns);
-        pkt = impl_->framer.flush();
-        if (!pkt.empty())
-            impl_->sender->send(pkt.data(), pkt.size());
-    }
+ItchStreamConsumer::ItchStreamConsumer(const ItchStreamConfig& config)
+    : impl_(new Impl(config))
+{}
 
-    // Emit System Event: end of messages
-    {
-        ItchEncoder sys_enc("", 0, impl_->config.tick_size);
-        auto msg = sys_enc.encodeSystemEvent(kSystemEventEndOfMessages, 0);
-        impl_->framer.addMessage(msg.data(), static_cast<uint16_t>(msg.size()));
-        pkt = impl_->framer.flush();
-        if (!pkt.empty())
-            impl_->sender->send(pkt.data(), pkt.size());
-    }
+ItchStreamConsumer::~ItchStreamConsumer() {
+    delete impl_;
+}
 
-    std::printf("ItchStreamConsumer: stopped after %llu messages\n",
-                static_cast<unsigned long long>(total_messages));
+void ItchStreamConsumer::run() {
+    running_ = true;
+    impl_->streamer.run(running_);
 }
 
 void ItchStreamConsumer::stop() {
@@ -2,31 +2,20 @@
 
 #ifdef QRSDP_KAFKA_ENABLED
 
+#include "itch/itch_streamer.h"
+
 #include <atomic>
-#include <cstdint>
-#include <string>
 
 namespace qrsdp {
 namespace itch {
 
-struct ItchStreamConfig {
-    std::string kafka_brokers  = "localhost:9092";
-    std::string kafka_topic    = "exchange.events";
-    std::string consumer_group = "itch-streamer";
-    std::string multicast_group = "239.1.1.1";
-    std::string unicast_dest;   // empty = multicast; "host:port" = unicast to specific destination
-    uint16_t    port           = 5001;
-    uint8_t     ttl            = 1;
-    uint32_t    tick_size      = 100;
-};
-
-/// Kafka consumer that reads DiskEventRecords from a topic, encodes them
-/// as ITCH 5.0 messages, frames in MoldUDP64 packets, and streams over
-/// UDP multicast.
+/// Kafka front end of ItchStreamer: consumes the topic with librdkafka and
+/// streams it as ITCH 5.0 over UDP multicast (or unicast, or AF_XDP).
 ///
-/// Each unique symbol (extracted from the Kafka message key) gets its own
-/// ItchEncoder with a unique stock locate code. A single MoldUDP64Framer
-/// and UdpMulticastSender are shared across all symbols.
+/// Without partition_threads the consumer subscribes to the topic in its group;
+/// with it, every partition of the topic is assigned directly and read by its
+/// own thread. Channel c sends to port + c (unicast: the given port + c;
+/// AF_XDP: queue xdp.queue_id + c).
 class ItchStreamConsumer {
 public:
     explicit ItchStreamConsumer(const ItchStreamConfig& config);
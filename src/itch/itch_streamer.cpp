@@ -0,0 +1,339 @@
+#include "itch/itch_streamer.h"
+#include "itch/encoder_registry.h"
+#include "itch/itch_encoder.h"
+#include "itch/itch_messages.h"
+#include "itch/moldudp64.h"
+#include "itch/moldudp64_retransmit.h"
+#include "io/event_log_format.h"
+#include "io/kafka_payload.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <stdexcept>
+#include <thread>
+
+namespace qrsdp {
+namespace itch {
+
+namespace {
+
+constexpr int kPollTimeoutMs = 100;
+constexpr size_t kPartitionQueueMessages = 4096;
+/// A timestamp this far below the highest one a partition has carried starts
+/// the next trading day (partitions interleave several securities, so small
+/// steps back are normal).
+constexpr uint64_t kDayRolloverNs = 1000000000ull;
+constexpr auto kMergeIdleSleep = std::chrono::microseconds(50);
+constexpr char kUnknownSymbol[] = "UNKNOWN";
+constexpr char kSession[] = "QRSDPITCH ";
+
+/// Key of a message, or "UNKNOWN" if it has none.
+void messageKey(const StreamMessage& m, const char*& key, size_t& len) {
+    if (m.key && m.key_len > 0) {
+        key = m.key;
+        len = m.key_len;
+    } else {
+        key = kUnknownSymbol;
+        len = sizeof(kUnknownSymbol) - 1;
+    }
+}
+
+/// Records of a message, or false (after logging why) if it carries none.
+bool messageRecords(const StreamMessage& m, KafkaPayloadView& view) {
+    if (m.error) {
+        std::fprintf(stderr, "ItchStreamer: consumer error: %s\n", m.error);
+        return false;
+    }
+    if (!parseKafkaPayload(m.payload, m.len, view)) {
+        std::fprintf(stderr, "ItchStreamer: unrecognised payload of %zu bytes on partition %d\n",
+                     m.len, m.partition);
+        return false;
+    }
+    return true;
+}
+
+}  // namespace
+
+struct ItchStreamer::Impl {
+    ItchStreamConfig config;
+    IStreamSource& source;
+    std::unique_ptr<IDatagramSender> sender;
+    std::unique_ptr<RetransmitRing> retransmit_ring;
+    std::unique_ptr<RetransmitServer> retransmit_server;
+    MoldUDP64Framer framer;
+    ItchEncoder sys_encoder;
+    EncoderRegistry encoders;
+    uint64_t last_ts_ns = 0;
+    bool seen_first_event = false;
+    uint64_t total_messages = 0;
+    std::vector<std::unique_ptr<ItchChannel>> channels;  // sharded output (channels > 1)
+
+    Impl(const ItchStreamConfig& cfg, IStreamSource& src)
+        : config(cfg)
+        , source(src)
+        , framer(kSession, std::max<size_t>(cfg.batch_packets, 1))
+        , sys_encoder("", 0, cfg.tick_size)
+        , encoders(cfg.tick_size)
+    {}
+
+    void emitSystemEvent(char code, uint64_t ts_ns) {
+        constexpr uint16_t size = sizeof(SystemEventMsg);
+        uint8_t* dst = framer.reserveMessage(size);
+        framer.commitMessage(static_cast<uint16_t>(sys_encoder.encodeSystemEventInto(code, ts_ns, dst, size)));
+    }
+
+    /// Encodes rec straight into the framer's packet buffer.
+    void emitEvent(const ItchEncoder& encoder, const EventRecord& rec) {
+        const auto size = static_cast<uint16_t>(ItchEncoder::encodedSize(rec));
+        uint8_t* dst = framer.reserveMessage(size);
+        framer.commitMessage(static_cast<uint16_t>(encoder.encodeInto(rec, dst, size)));
+    }
+
+    /// Encoder for a message key, straight from the key bytes. A symbol seen for
+    /// the first time gets the next locate and a Stock Directory message.
+    ItchEncoder& getEncoder(const char* symbol, size_t len) {
+        bool added = false;
+        ItchEncoder& enc = encoders.intern(symbol, len, added);
+        if (added) {
+            constexpr uint16_t size = sizeof(StockDirectoryMsg);
+            uint8_t* dst = framer.reserveMessage(size);
+            framer.commitMessage(static_cast<uint16_t>(enc.encodeStockDirectoryInto(0, dst, size)));
+        }
+        return enc;
+    }
+
+    /// Encodes one consumed record, emitting market open/close around day boundaries.
+    void handleRecord(const char* key, size_t key_len, const DiskEventRecord& disk) {
+        const EventRecord rec = fromDisk(disk);
+        if (!channels.empty()) {
+            channels[config.channels.channelOf(key, key_len)]->push(key, key_len, rec);
+            countMessage();
+            return;
+        }
+
+        // Day-boundary detection: timestamp going backward indicates a new trading day
+        if (!seen_first_event) {
+            emitSystemEvent(kSystemEventStartOfMarket, rec.ts_ns);
+            seen_first_event = true;
+        } else if (rec.ts_ns < last_ts_ns) {
+            emitSystemEvent(kSystemEventEndOfMarket, last_ts_ns);
+            emitSystemEvent(kSystemEventStartOfMarket, rec.ts_ns);
+        }
+        last_ts_ns = rec.ts_ns;
+
+        emitEvent(getEncoder(key, key_len), rec);
+        countMessage();
+    }
+
+    void countMessage() {
+        ++total_messages;
+        if ((total_messages & 0xFFFFF) == 0) {
+            std::printf("ItchStreamer: streamed %llu messages\n",
+                        static_cast<unsigned long long>(total_messages));
+        }
+    }
+
+    /// Single-threaded loop: up to consume_batch messages per call straight off
+    /// the source, encoded in arrival order.
+    void runBatched(const std::atomic<bool>& running) {
+        const PartitionMerge::ReleaseFn release = source.releaseFn();
+        std::vector<StreamMessage> batch(std::max<size_t>(config.consume_batch, 1));
+        while (running) {
+            const size_t n = source.consume(IStreamSource::kAllPartitions, kPollTimeoutMs,
+                                            batch.data(), batch.size());
+            if (n == 0) {
+                if (channels.empty())
+                    framer.flushIfDue();  // idle: don't hold a part-filled batch
+                continue;
+            }
+            for (size_t i = 0; i < n; ++i) {
+                const StreamMessage& m = batch[i];
+                KafkaPayloadView view;
+                if (messageRecords(m, view)) {
+                    // The key is read in place, without a std::string copy.
+                    const char* key;
+                    size_t key_len;
+                    messageKey(m, key, key_len);
+                    for (size_t r = 0; r < view.count; ++r)
+                        handleRecord(key, key_len, view.records[r]);
+                }
+                release(m.handle);
+            }
+        }
+    }
+
+    /// Reader thread of one partition: batches off the source into the merge,
+    /// which owns (and eventually releases) every message it accepts.
+    void readPartition(int partition, PartitionMerge& merge, const std::atomic<bool>& reading) {
+        const PartitionMerge::ReleaseFn release = source.releaseFn();
+        std::vector<StreamMessage> batch(std::max<size_t>(config.consume_batch, 1));
+        while (reading) {
+            const size_t n = source.consume(partition, kPollTimeoutMs, batch.data(), batch.size());
+            for (size_t i = 0; i < n; ++i) {
+                const StreamMessage& m = batch[i];
+                KafkaPayloadView view;
+                PartitionBatch b;
+                if (!messageRecords(m, view) || !reading) {
+                    release(m.handle);
+                    continue;
+                }
+                messageKey(m, b.key, b.key_len);
+                b.records = view.records;
+                b.count = view.count;
+                b.handle = m.handle;
+                if (!merge.push(static_cast<size_t>(partition), b))
+                    release(m.handle);
+            }
+        }
+    }
+
+    /// One reader thread per partition, merged back into timestamp order here.
+    void runPartitioned(const std::atomic<bool>& running) {
+        const auto partitions = static_cast<size_t>(source.partitionCount());
+        PartitionMerge merge(partitions, kPartitionQueueMessages,
+                             std::chrono::microseconds(config.merge_wait_us), kDayRolloverNs,
+                             source.releaseFn());
+        std::atomic<bool> reading{true};
+        std::vector<std::thread> readers;
+        for (size_t p = 0; p < partitions; ++p)
+            readers.emplace_back([&, p] { readPartition(static_cast<int>(p), merge, reading); });
+
+        const size_t per_round = std::max<size_t>(config.consume_batch, 1);
+        MergedRecord m;
+        while (running) {
+            size_t n = 0;
+            while (n < per_round && merge.next(m)) {
+                handleRecord(m.key, m.key_len, *m.record);
+                ++n;
+            }
+            if (n > 0)
+                continue;
+            if (channels.empty())
+                framer.flushIfDue();
+            source.pollEvents();
+            std::this_thread::sleep_for(kMergeIdleSleep);
+        }
+
+        reading = false;
+        merge.stop();
+        for (auto& t : readers)
+            t.join();
+    }
+};
+
+ItchStreamer::ItchStreamer(const ItchStreamConfig& config, IStreamSource& source,
+                           std::vector<std::unique_ptr<IDatagramSender>> senders)
+    : impl_(std::make_unique<Impl>(config, source))
+{
+    if (config.partition_threads && source.partitionCount() <= 0)
+        throw std::invalid_argument("ItchStreamer: partition_threads needs a partitioned source");
+    const uint32_t channel_count = std::max<uint32_t>(config.channels.channels, 1);
+    if (senders.size() != channel_count)
+        throw std::invalid_argument("ItchStreamer: need one sender per channel");
+
+    if (channel_count > 1) {
+        for (uint32_t c = 0; c < channel_count; ++c) {
+            ItchChannelConfig cc;
+            cc.session = channelSession(kSession, c, channel_count);
+            cc.tick_size = config.tick_size;
+            cc.batch_packets = config.batch_packets;
+            cc.flush_deadline_us = config.flush_deadline_us;
+            cc.queue_records = config.channel_queue_records;
+            cc.retransmit_port = config.retransmit_port != 0
+                ? static_cast<uint16_t>(config.retransmit_port + c) : 0;
+            cc.retransmit_packets = config.retransmit_packets;
+            impl_->channels.push_back(std::make_unique<ItchChannel>(cc, std::move(senders[c])));
+        }
+        std::printf("ItchStreamer: %u channels, sessions %s..%s, one sender thread each\n",
+                    channel_count, channelSession(kSession, 0, channel_count).c_str(),
+                    channelSession(kSession, channel_count - 1, channel_count).c_str());
+        return;
+    }
+
+    impl_->sender = std::move(senders[0]);
+    if (config.retransmit_port != 0) {
+        impl_->retransmit_ring = std::make_unique<RetransmitRing>(config.retransmit_packets);
+        impl_->retransmit_server = std::make_unique<RetransmitServer>(*impl_->retransmit_ring,
+                                                                      config.retransmit_port);
+        std::printf("ItchStreamer: serving retransmit requests on port %u (last %zu packets)\n",
+                    impl_->retransmit_server->port(), config.retransmit_packets);
+    }
+
+    Impl* impl = impl_.get();
+    impl->framer.setSendCallback([impl](const uint8_t* data, size_t len) {
+        impl->sender->send(data, len);
+        if (impl->retransmit_ring)
+            impl->retransmit_ring->record(data, len);
+    });
+    if (config.batch_packets > 1) {
+        impl->framer.setBatchCallback([impl](const Datagram* packets, size_t n) {
+            impl->sender->sendBatch(packets, n);
+            if (impl->retransmit_ring) {
+                for (size_t i = 0; i < n; ++i)
+                    impl->retransmit_ring->record(packets[i].data, packets[i].len);
+            }
+        });
+    }
+    impl->framer.setFlushDeadline(std::chrono::microseconds(config.flush_deadline_us));
+}
+
+ItchStreamer::~ItchStreamer() = default;
+
+void ItchStreamer::run(const std::atomic<bool>& running) {
+    if (!impl_->channels.empty()) {
+        for (auto& channel : impl_->channels)
+            channel->start();
+        if (impl_->config.partition_threads)
+            impl_->runPartitioned(running);
+        else
+            impl_->runBatched(running);
+        uint64_t sent = 0;
+        for (auto& channel : impl_->channels) {
+            channel->stop();
+            sent += channel->messagesSent();
+        }
+        std::printf("ItchStreamer: stopped after %llu messages (%llu ITCH messages on %zu channels)\n",
+                    static_cast<unsigned long long>(impl_->total_messages),
+                    static_cast<unsigned long long>(sent), impl_->channels.size());
+        return;
+    }
+
+    if (impl_->retransmit_server)
+        impl_->retransmit_server->start();
+
+    // Emit System Event: start of messages
+    {
+        impl_->emitSystemEvent(kSystemEventStartOfMessages, 0);
+        impl_->framer.sendPending();
+    }
+
+    if (impl_->config.partition_threads)
+        impl_->runPartitioned(running);
+    else
+        impl_->runBatched(running);
+
+    // Flush remaining buffered messages
+    impl_->framer.sendPending();
+
+    // Emit end-of-market for the last day (if we saw any events)
+    if (impl_->seen_first_event) {
+        impl_->emitSystemEvent(kSystemEventEndOfMarket, impl_->last_ts_ns);
+        impl_->framer.sendPending();
+    }
+
+    // Emit System Event: end of messages
+    {
+        impl_->emitSystemEvent(kSystemEventEndOfMessages, 0);
+        impl_->framer.sendPending();
+    }
+
+    if (impl_->retransmit_server)
+        impl_->retransmit_server->stop();
+
+    std::printf("ItchStreamer: stopped after %llu messages\n",
+                static_cast<unsigned long long>(impl_->total_messages));
+}
+
+}  // namespace itch
+}  // namespace qrsdp
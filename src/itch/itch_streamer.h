@@ -0,0 +1,82 @@
+#pragma once
+
+#include "itch/i_datagram_sender.h"
+#include "itch/i_stream_source.h"
+#include "itch/itch_channels.h"
+#include "itch/xdp_sender.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace qrsdp {
+namespace itch {
+
+struct ItchStreamConfig {
+    std::string kafka_brokers  = "localhost:9092";
+    std::string kafka_topic    = "exchange.events";
+    std::string consumer_group = "itch-streamer";
+    std::string multicast_group = "239.1.1.1";
+    std::string unicast_dest;   // empty = multicast; "host:port" = unicast to specific destination
+    uint16_t    port           = 5001;
+    uint8_t     ttl            = 1;
+    uint32_t    tick_size      = 100;
+    size_t      batch_packets  = 16;    // packets per sendmmsg; 1 = one sendto per packet
+    uint32_t    flush_deadline_us = 500;  // max wait of a message before it is sent; 0 = none
+    bool        gso            = false;   // coalesce equal-size packets with UDP_SEGMENT (Linux)
+    XdpConfig   xdp;                      // xdp.interface set = AF_XDP backend (BUILD_XDP_SUPPORT)
+    uint16_t    retransmit_port = 0;      // serve MoldUDP64 gap requests here; 0 = off
+    size_t      retransmit_packets = 16384;  // packets kept for retransmission
+    size_t      consume_batch  = 1024;    // Kafka messages taken per poll
+    bool        partition_threads = false;  // one reader per partition, merged by timestamp
+    uint32_t    merge_wait_us  = 1000;    // how long the merge waits on an empty partition
+    ItchChannelMap channels;              // > 1 channel: symbol-sharded sessions (see below)
+    size_t      channel_queue_records = 1 << 16;  // records queued to each channel thread
+};
+
+/// Consume, merge and encode loop of the ITCH streamer, independent of Kafka:
+/// reads DiskEventRecord messages from an IStreamSource, encodes them as
+/// ITCH 5.0 messages, frames them in MoldUDP64 packets and hands those to its
+/// senders. Messages are taken consume_batch at a time and may each carry one
+/// record or a batch of them (io/kafka_payload.h).
+///
+/// With partition_threads, every partition of the source is read by its own
+/// thread, and a PartitionMerge puts the records back into timestamp order
+/// before encoding; otherwise records go out in arrival order.
+///
+/// Each unique symbol (the message key) gets its own ItchEncoder with a unique
+/// stock locate code. A single MoldUDP64Framer is shared across all symbols.
+/// Packets are sent batch_packets at a time, but never later than
+/// flush_deadline_us after their first message. With retransmit_port set, sent
+/// packets are also kept in a RetransmitRing and gap requests are answered on
+/// that port.
+///
+/// With more than one channel, the consuming thread only routes each record by
+/// its key through the channel map to an ItchChannel, which encodes, frames and
+/// sends it on its own thread in its own MoldUDP64 session (channelSession()),
+/// serving retransmits on retransmit_port + c.
+class ItchStreamer {
+public:
+    /// senders holds one sender per channel (config.channels.channels, at
+    /// least one). source must outlive the streamer.
+    ItchStreamer(const ItchStreamConfig& config, IStreamSource& source,
+                 std::vector<std::unique_ptr<IDatagramSender>> senders);
+    ~ItchStreamer();
+
+    ItchStreamer(const ItchStreamer&) = delete;
+    ItchStreamer& operator=(const ItchStreamer&) = delete;
+
+    /// Blocking consume loop: runs until running turns false, then flushes and
+    /// ends the session.
+    void run(const std::atomic<bool>& running);
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
+}  // namespace itch
+}  // namespace qrsdp
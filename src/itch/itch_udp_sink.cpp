@@ -0,0 +1,373 @@
+#include "itch/itch_udp_sink.h"
+#include "core/metrics.h"
+#include "itch/itch_feed_writer.h"
+#include "itch/itch_snapshot.h"
+#include "itch/moldudp64.h"
+#include "itch/udp_sender.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+
+namespace qrsdp {
+namespace itch {
+
+namespace {
+
+/// Records taken from one queue before moving on to the next, so a busy
+/// security cannot starve the others.
+constexpr size_t kDrainBatch = 64;
+/// Yields before the sender thread goes to sleep on an empty feed.
+constexpr int kIdleSpins = 64;
+/// Snapshots a security can have queued behind its records.
+constexpr size_t kSnapshotQueue = 4;
+/// Order-level session starts a security can have queued behind its records.
+constexpr size_t kOrderBookStartQueue = 4;
+
+}  // namespace
+
+// --- ItchUdpSink ---
+
+ItchUdpSink::ItchUdpSink(ItchLiveFeed& feed, const std::string& symbol, uint32_t tick_size,
+                         size_t capacity, uint32_t channel)
+    : feed_(feed), symbol_(symbol), tick_size_(tick_size), channel_(channel), ring_(capacity),
+      snapshots_(kSnapshotQueue), next_snapshot_(feed.config_.snapshot_records),
+      book_starts_(kOrderBookStartQueue) {}
+
+void ItchUdpSink::push(const EventRecord& rec) {
+    if (ring_.tryPush(rec))
+        return;
+    stalls_.fetch_add(1, std::memory_order_relaxed);
+    do {
+        if (!feed_.running_.load(std::memory_order_acquire))
+            throw std::runtime_error("ItchUdpSink: queue for " + symbol_ + " is full and the feed is not running");
+        feed_.wake(channel_);
+        std::this_thread::yield();
+    } while (!ring_.tryPush(rec));
+}
+
+void ItchUdpSink::append(const EventRecord& rec) {
+    push(rec);
+    ++appended_;
+    maybeSnapshot(rec.ts_ns);
+    feed_.wake(channel_);
+}
+
+void ItchUdpSink::appendBatch(const EventRecord* recs, size_t n) {
+    if (n == 0)
+        return;
+    for (size_t i = 0; i < n; ++i)
+        push(recs[i]);
+    appended_ += n;
+    maybeSnapshot(recs[n - 1].ts_ns);
+    feed_.wake(channel_);
+}
+
+void ItchUdpSink::setSnapshotSource(CheckpointSource source) {
+    snapshot_source_ = feed_.snapshots_ ? std::move(source) : nullptr;
+}
+
+void ItchUdpSink::maybeSnapshot(uint64_t last_ts_ns) {
+    if (!snapshot_source_ || appended_ < next_snapshot_)
+        return;
+    next_snapshot_ = appended_ + std::max<uint32_t>(feed_.config_.snapshot_records, 1);
+    BookCheckpoint cp;
+    snapshot_source_(cp);
+    cp.record_index = appended_;
+    cp.ts_ns = last_ts_ns;
+    if (!snapshots_.tryPush(cp))
+        snapshots_dropped_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void ItchUdpSink::startOrderBook(const BookSeed& seed) {
+    const OrderBookStart start{seed, appended_};
+    while (!book_starts_.tryPush(start)) {
+        if (!feed_.running_.load(std::memory_order_acquire))
+            throw std::runtime_error("ItchUdpSink: order book starts for " + symbol_
+                                     + " are queued and the feed is not running");
+        feed_.wake(channel_);
+        std::this_thread::yield();
+    }
+    feed_.wake(channel_);
+}
+
+void ItchUdpSink::flush() {
+    while (!ring_.empty() && feed_.running_.load(std::memory_order_acquire)) {
+        feed_.wake(channel_);
+        std::this_thread::yield();
+    }
+}
+
+// --- ItchLiveFeed ---
+
+/// Sender of one channel: channel c goes to port + c.
+static std::unique_ptr<IDatagramSender> makeUdpSender(const ItchLiveConfig& config, uint32_t channel) {
+    std::unique_ptr<UdpMulticastSender> sender;
+    if (!config.unicast_dest.empty()) {
+        const auto colon = config.unicast_dest.rfind(':');
+        if (colon == std::string::npos || colon == 0)
+            throw std::runtime_error("ItchLiveFeed: bad unicast destination, expected host:port");
+        sender = UdpMulticastSender::createUnicast(
+            config.unicast_dest.substr(0, colon),
+            static_cast<uint16_t>(std::atoi(config.unicast_dest.c_str() + colon + 1) + channel));
+    } else {
+        sender = std::make_unique<UdpMulticastSender>(config.multicast_group,
+                                                      static_cast<uint16_t>(config.port + channel), config.ttl);
+    }
+    if (config.gso && !sender->enableGso(true) && channel == 0)
+        std::fprintf(stderr, "ItchLiveFeed: UDP GSO not supported here, sending plain batches\n");
+    return sender;
+}
+
+/// One sender per channel, from port (or the unicast port) + c.
+static std::vector<std::unique_ptr<IDatagramSender>> makeUdpSenders(ItchLiveConfig config, uint16_t port) {
+    if (!config.unicast_dest.empty())
+        config.unicast_dest = config.unicast_dest.substr(0, config.unicast_dest.rfind(':') + 1) + std::to_string(port);
+    config.port = port;
+    std::vector<std::unique_ptr<IDatagramSender>> senders;
+    for (uint32_t c = 0; c < std::max<uint32_t>(config.channels.channels, 1); ++c)
+        senders.push_back(makeUdpSender(config, c));
+    return senders;
+}
+
+static uint16_t unicastPort(const ItchLiveConfig& config) {
+    const auto colon = config.unicast_dest.rfind(':');
+    return colon == std::string::npos ? 0 : static_cast<uint16_t>(std::atoi(config.unicast_dest.c_str() + colon + 1));
+}
+
+static std::vector<std::unique_ptr<IDatagramSender>> single(std::unique_ptr<IDatagramSender> sender) {
+    std::vector<std::unique_ptr<IDatagramSender>> senders;
+    senders.push_back(std::move(sender));
+    return senders;
+}
+
+ItchLiveFeed::ItchLiveFeed(const ItchLiveConfig& config)
+    : ItchLiveFeed(config,
+                   makeUdpSenders(config, config.unicast_dest.empty() ? config.port : unicastPort(config)),
+                   config.snapshot_port != 0 ? makeUdpSenders(config, config.snapshot_port)
+                                             : std::vector<std::unique_ptr<IDatagramSender>>{}) {}
+
+ItchLiveFeed::ItchLiveFeed(const ItchLiveConfig& config, std::unique_ptr<IDatagramSender> sender)
+    : ItchLiveFeed(config, single(std::move(sender))) {}
+
+ItchLiveFeed::ItchLiveFeed(const ItchLiveConfig& config, std::vector<std::unique_ptr<IDatagramSender>> senders,
+                           std::vector<std::unique_ptr<IDatagramSender>> snapshot_senders)
+    : config_(config), snapshots_(!snapshot_senders.empty()) {
+    if (senders.size() != std::max<uint32_t>(config_.channels.channels, 1))
+        throw std::runtime_error("ItchLiveFeed: need one sender per channel");
+    if (snapshots_ && snapshot_senders.size() != senders.size())
+        throw std::runtime_error("ItchLiveFeed: need one snapshot sender per channel");
+    for (size_t c = 0; c < senders.size(); ++c) {
+        if (!senders[c] || (snapshots_ && !snapshot_senders[c]))
+            throw std::runtime_error("ItchLiveFeed: null sender");
+        channels_.push_back(std::make_unique<Channel>());
+        channels_.back()->sender = std::move(senders[c]);
+        if (snapshots_)
+            channels_.back()->snapshot_sender = std::move(snapshot_senders[c]);
+    }
+}
+
+ItchLiveFeed::~ItchLiveFeed() {
+    stop();
+}
+
+ItchUdpSink& ItchLiveFeed::addSecurity(const std::string& symbol, uint32_t tick_size) {
+    if (started_)
+        throw std::runtime_error("ItchLiveFeed: addSecurity() after start()");
+    const uint32_t channel = config_.channels.channelOf(symbol);
+    channels_[channel]->securities.push_back(static_cast<uint32_t>(sinks_.size()));
+    sinks_.push_back(std::unique_ptr<ItchUdpSink>(
+        new ItchUdpSink(*this, symbol, tick_size, std::max<size_t>(config_.queue_records, 1), channel)));
+    return *sinks_.back();
+}
+
+void ItchLiveFeed::start(uint64_t ts_ns) {
+    if (started_)
+        throw std::runtime_error("ItchLiveFeed: already started");
+    started_ = true;
+    stop_.store(false);
+    running_.store(true, std::memory_order_release);
+    for (uint32_t c = 0; c < channels_.size(); ++c)
+        channels_[c]->thread = std::thread([this, c, ts_ns] { run(c, ts_ns); });
+}
+
+void ItchLiveFeed::stop() {
+    if (!running_.load(std::memory_order_acquire))
+        return;
+    stop_.store(true);
+    for (auto& channel : channels_) {
+        std::lock_guard<std::mutex> lock(channel->mutex);
+        channel->cv.notify_all();
+    }
+    for (auto& channel : channels_)
+        channel->thread.join();
+    started_ = false;
+    running_.store(false, std::memory_order_release);
+}
+
+uint64_t ItchLiveFeed::messagesSent() const {
+    uint64_t total = 0;
+    for (const auto& channel : channels_)
+        total += channel->messages_sent.load(std::memory_order_relaxed);
+    return total;
+}
+
+uint64_t ItchLiveFeed::snapshotsSent() const {
+    uint64_t total = 0;
+    for (const auto& channel : channels_)
+        total += channel->snapshots_sent.load(std::memory_order_relaxed);
+    return total;
+}
+
+bool ItchLiveFeed::anyQueued(const Channel& channel) const {
+    for (const uint32_t i : channel.securities) {
+        if (!sinks_[i]->ring_.empty() || !sinks_[i]->book_starts_.empty()
+            || (snapshots_ && !sinks_[i]->snapshots_.empty()))
+            return true;
+    }
+    return false;
+}
+
+void ItchLiveFeed::wake(uint32_t channel) {
+    Channel& ch = *channels_[channel];
+    if (ch.sleeping.load()) {
+        std::lock_guard<std::mutex> lock(ch.mutex);
+        ch.cv.notify_all();
+    }
+}
+
+void ItchLiveFeed::run(uint32_t channel, uint64_t open_ts_ns) {
+    Channel& ch = *channels_[channel];
+    IDatagramSender* const sender = ch.sender.get();
+    MoldUDP64Framer framer(channelSession(config_.session, channel, static_cast<uint32_t>(channels_.size())),
+                           std::max<size_t>(config_.batch_packets, 1));
+    Counter* const packets_sent = config_.packets_sent;
+    Counter* const bytes_sent = config_.bytes_sent;
+    framer.setSendCallback([sender, packets_sent, bytes_sent](const uint8_t* data, size_t len) {
+        sender->send(data, len);
+        if (packets_sent) packets_sent->add(1);
+        if (bytes_sent) bytes_sent->add(len);
+    });
+    if (config_.batch_packets > 1) {
+        framer.setBatchCallback([sender, packets_sent, bytes_sent](const Datagram* packets, size_t n) {
+            sender->sendBatch(packets, n);
+            if (packets_sent) packets_sent->add(n);
+            if (bytes_sent) {
+                size_t bytes = 0;
+                for (size_t i = 0; i < n; ++i) bytes += packets[i].len;
+                bytes_sent->add(bytes);
+            }
+        });
+    }
+    framer.setFlushDeadline(std::chrono::microseconds(config_.flush_deadline_us));
+
+    // Writer index k is security ch.securities[k], which keeps its run-wide locate.
+    ItchFeedWriter writer(framer);
+    for (const uint32_t i : ch.securities)
+        writer.addSecurity(sinks_[i]->symbol_, sinks_[i]->tick_size_, static_cast<uint16_t>(i + 1));
+    writer.begin(open_ts_ns);
+
+    // Snapshot session: a security's pending snapshot goes out once exactly
+    // record_index of its records have been framed on the main session.
+    std::unique_ptr<MoldUDP64Framer> snapshot_framer;
+    if (ch.snapshot_sender) {
+        IDatagramSender* const snapshot_sender = ch.snapshot_sender.get();
+        snapshot_framer = std::make_unique<MoldUDP64Framer>(
+            channelSession(config_.snapshot_session, channel, static_cast<uint32_t>(channels_.size())));
+        snapshot_framer->setSendCallback([snapshot_sender](const uint8_t* data, size_t len) {
+            snapshot_sender->send(data, len);
+        });
+    }
+    struct SnapshotState {
+        BookCheckpoint cp;
+        bool pending = false;
+        uint64_t framed = 0;  // records of the security framed so far
+    };
+    std::vector<SnapshotState> snapshots(snapshot_framer ? ch.securities.size() : 0);
+    // True if security k's next snapshot is due before its next record, which it then publishes.
+    auto publishDueSnapshot = [&](size_t k) {
+        SnapshotState& st = snapshots[k];
+        if (!st.pending)
+            st.pending = sinks_[ch.securities[k]]->snapshots_.tryPop(st.cp);
+        if (!st.pending || st.cp.record_index > st.framed)
+            return false;
+        writeBookSnapshot(*snapshot_framer, writer.encoder(static_cast<uint32_t>(k)), st.cp,
+                          framer.nextSequenceNumber() + framer.pendingMessageCount());
+        snapshot_framer->sendPending();
+        ch.snapshots_sent.fetch_add(1, std::memory_order_relaxed);
+        st.pending = false;
+        return true;
+    };
+
+    uint64_t last_ts_ns = open_ts_ns;
+
+    // Order-level sessions: a security's queued start goes to the writer once
+    // exactly record_index of its records have been framed.
+    struct OrderBookState {
+        ItchUdpSink::OrderBookStart start;
+        bool pending = false;
+        uint64_t framed = 0;
+    };
+    std::vector<OrderBookState> order_books(ch.securities.size());
+    auto startDueOrderBook = [&](size_t k) {
+        OrderBookState& st = order_books[k];
+        if (!st.pending)
+            st.pending = sinks_[ch.securities[k]]->book_starts_.tryPop(st.start);
+        if (!st.pending || st.start.record_index > st.framed)
+            return;
+        writer.startOrderBook(static_cast<uint32_t>(k), st.start.seed, last_ts_ns);
+        st.pending = false;
+    };
+
+    EventRecord rec;
+    for (;;) {
+        size_t taken = 0;
+        for (size_t k = 0; k < ch.securities.size(); ++k) {
+            SpscRing<EventRecord>& ring = sinks_[ch.securities[k]]->ring_;
+            for (size_t n = 0; n < kDrainBatch; ++n) {
+                if (snapshot_framer) {
+                    while (publishDueSnapshot(k)) {}
+                }
+                startDueOrderBook(k);
+                if (!ring.tryPop(rec))
+                    break;
+                writer.append(static_cast<uint32_t>(k), rec);
+                ++order_books[k].framed;
+                if (snapshot_framer) ++snapshots[k].framed;
+                last_ts_ns = std::max(last_ts_ns, rec.ts_ns);
+                ++taken;
+            }
+        }
+        if (taken > 0) {
+            ch.messages_sent.store(writer.messagesWritten(), std::memory_order_relaxed);
+            continue;
+        }
+
+        // Out of work: send the part-filled packet now rather than at the deadline.
+        writer.flush();
+        ch.messages_sent.store(writer.messagesWritten(), std::memory_order_relaxed);
+        if (stop_.load() && !anyQueued(ch))
+            break;
+
+        auto ready = [this, &ch] { return anyQueued(ch) || stop_.load(); };
+        bool woke = false;
+        for (int spin = 0; spin < kIdleSpins && !woke; ++spin) {
+            woke = ready();
+            if (!woke) std::this_thread::yield();
+        }
+        if (!woke) {
+            std::unique_lock<std::mutex> lock(ch.mutex);
+            ch.sleeping.store(true);  // seq_cst: pairs with the ring's seq_cst publish in wake()
+            ch.cv.wait(lock, ready);
+            ch.sleeping.store(false);
+        }
+    }
+
+    writer.end(last_ts_ns);
+    ch.messages_sent.store(writer.messagesWritten(), std::memory_order_relaxed);
+}
+
+}  // namespace itch
+}  // namespace qrsdp
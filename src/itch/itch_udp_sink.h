@@ -0,0 +1,216 @@
+#pragma once
+
+#include "io/book_checkpoint.h"
+#include "io/i_event_sink.h"
+#include "io/spsc_ring.h"
+#include "itch/i_datagram_sender.h"
+#include "itch/itch_channels.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace qrsdp {
+
+class Counter;
+
+namespace itch {
+
+struct ItchLiveConfig {
+    bool        enabled        = false;
+    std::string multicast_group = "239.1.1.1";
+    std::string unicast_dest;   // empty = multicast; "host:port" = unicast to specific destination
+    uint16_t    port           = 5001;
+    uint8_t     ttl            = 1;
+    std::string session        = "QRSDPITCH";
+    size_t      batch_packets  = 16;    // packets per sendmmsg; 1 = one sendto per packet
+    uint32_t    flush_deadline_us = 500;  // max wait of a message in a busy feed; 0 = none
+    bool        gso            = false;   // coalesce equal-size packets with UDP_SEGMENT (Linux)
+    size_t      queue_records  = 1 << 16;  // per-security queue to the sender thread
+    ItchChannelMap channels;               // > 1 channel: one session per channel, on port + channel
+    uint16_t    snapshot_port  = 0;        // > 0: book snapshots to snapshot_port + channel
+    uint32_t    snapshot_records = 100000; // records of a security between its snapshots
+    std::string snapshot_session = "QRSDPSNAP";
+    Counter*    packets_sent   = nullptr;  // non-null: count datagrams handed to the sender
+    Counter*    bytes_sent     = nullptr;  // non-null: count their payload bytes
+};
+
+class ItchLiveFeed;
+
+/// IEventSink end of an ItchLiveFeed for one security: append() only copies
+/// the record into a lock-free SPSC queue, and the feed's sender thread does
+/// the encoding, framing and sending. If the queue is full the producer waits
+/// for room (nothing is dropped); before the feed is started that throws
+/// std::runtime_error instead. One producer thread at a time per sink.
+///
+/// flush() and close() wait until the sender thread has taken every queued
+/// record; the sink stays usable, so one sink can serve a security's
+/// successive days.
+///
+/// When the feed sends snapshots, the sink asks its snapshot source for the
+/// book after every snapshot_records records and queues it behind them; the
+/// sender thread publishes it once it has framed exactly those records.
+class ItchUdpSink final : public IEventSink {
+public:
+    void append(const EventRecord& rec) override;
+    void appendBatch(const EventRecord* recs, size_t n) override;
+    void flush() override;
+    void close() override { flush(); }
+
+    const std::string& symbol() const { return symbol_; }
+    /// Times append() found the queue full and had to wait.
+    uint64_t stalls() const { return stalls_.load(std::memory_order_relaxed); }
+
+    /// Book state provider for snapshots (nullptr = none). As for
+    /// BinaryFileSink::setCheckpointSource(), its state must be the one after
+    /// the last record appended when each append call returns; it is called on
+    /// the appending thread (only levels are used). Ignored unless the feed
+    /// sends snapshots.
+    void setSnapshotSource(CheckpointSource source);
+    /// Snapshots skipped because the sender thread had not taken the previous ones.
+    uint64_t snapshotsDropped() const { return snapshots_dropped_.load(std::memory_order_relaxed); }
+
+    /// The records appended from now on are a new session of an order-level
+    /// book (qrsdp_run --order-book) seeded with seed: once the sender thread
+    /// has framed the records before it, it deletes the previous session's
+    /// orders, adds the seed orders and from then on announces the orders the
+    /// book creates or drops besides the records (ItchFeedWriter::startOrderBook).
+    /// Call before the session's first append; waits while earlier starts are
+    /// still queued, and throws std::runtime_error like append() if the feed is
+    /// not running.
+    void startOrderBook(const BookSeed& seed);
+
+private:
+    friend class ItchLiveFeed;
+    ItchUdpSink(ItchLiveFeed& feed, const std::string& symbol, uint32_t tick_size, size_t capacity,
+                uint32_t channel);
+
+    /// Queues rec, waiting for room; no wake-up.
+    void push(const EventRecord& rec);
+    /// Queues a snapshot if snapshot_records more records have been appended.
+    void maybeSnapshot(uint64_t last_ts_ns);
+
+    /// An order-level session that starts after record_index records.
+    struct OrderBookStart {
+        BookSeed seed;
+        uint64_t record_index;
+    };
+
+    ItchLiveFeed& feed_;
+    std::string symbol_;
+    uint32_t tick_size_;
+    uint32_t channel_;
+    SpscRing<EventRecord> ring_;
+    std::atomic<uint64_t> stalls_{0};
+    CheckpointSource snapshot_source_;
+    SpscRing<BookCheckpoint> snapshots_;
+    uint64_t appended_ = 0;       // records appended (producer side)
+    uint64_t next_snapshot_ = 0;  // appended_ at which the next snapshot is due
+    std::atomic<uint64_t> snapshots_dropped_{0};
+    SpscRing<OrderBookStart> book_starts_;
+};
+
+/// Live ITCH 5.0 output straight from the producers, with no Kafka hop: one
+/// ItchUdpSink per security feeds a dedicated sender thread that merges the
+/// queues into a single MoldUDP64 session (security i gets stock locate i + 1)
+/// and sends it with UdpMulticastSender, or any IDatagramSender. Encoding on
+/// the sender thread keeps all securities in one sequence space and off the
+/// producers' critical path.
+///
+/// With config.channels set to more than one channel, securities are split
+/// by the channel map and every channel gets its own sender thread, sender
+/// and MoldUDP64 session (channelSession()), each with its own sequence
+/// numbers and Stock Directory of just its securities; locates stay i + 1
+/// across channels. Channel c sends to port + c (or the unicast port + c).
+///
+/// With snapshot_port set (or snapshot senders given), each channel also sends
+/// a snapshot session (channelSession() of snapshot_session) to
+/// snapshot_port + channel: every snapshot_records records of a security, the
+/// security's book levels as Stock Directory, Add Order per level and End of
+/// Snapshot messages, the last tagged with the first main-feed sequence number
+/// the book does not reflect (itch/itch_snapshot.h), so a late joiner can start
+/// from it instead of the start of the day.
+///
+/// A sender thread sends a part-filled packet as soon as it runs out of
+/// queued records, so an idle-to-busy event reaches the wire within
+/// microseconds; under load packets fill up and go out batch_packets at a time.
+class ItchLiveFeed {
+public:
+    /// Sends to config's multicast group or unicast destination.
+    /// Throws std::runtime_error if a socket cannot be set up.
+    explicit ItchLiveFeed(const ItchLiveConfig& config);
+    /// Sends through sender instead (e.g. an XdpSender, or a test double).
+    /// Throws std::runtime_error if config has more than one channel.
+    ItchLiveFeed(const ItchLiveConfig& config, std::unique_ptr<IDatagramSender> sender);
+    /// One sender per channel of config.channels, in channel order, and none or
+    /// one snapshot sender per channel.
+    ItchLiveFeed(const ItchLiveConfig& config, std::vector<std::unique_ptr<IDatagramSender>> senders,
+                 std::vector<std::unique_ptr<IDatagramSender>> snapshot_senders = {});
+    ~ItchLiveFeed();
+
+    ItchLiveFeed(const ItchLiveFeed&) = delete;
+    ItchLiveFeed& operator=(const ItchLiveFeed&) = delete;
+
+    /// Registers the next security; must be called before start(). The sink
+    /// lives as long as the feed.
+    ItchUdpSink& addSecurity(const std::string& symbol, uint32_t tick_size);
+
+    /// Starts the sender threads; each sends Start of Messages, the Stock
+    /// Directory of its channel and Start of Market stamped ts_ns.
+    void start(uint64_t ts_ns);
+
+    /// Sends everything queued, then End of Market and End of Messages on
+    /// every channel, and joins the sender threads. Producers must have
+    /// stopped appending. Idempotent; also called by the destructor.
+    void stop();
+
+    size_t channelCount() const { return channels_.size(); }
+    /// ITCH messages framed so far on every channel (system and directory
+    /// messages included); all of them are on the wire whenever the queues
+    /// are empty.
+    uint64_t messagesSent() const;
+    uint64_t messagesSent(size_t channel) const {
+        return channels_[channel]->messages_sent.load(std::memory_order_relaxed);
+    }
+    bool sendsSnapshots() const { return snapshots_; }
+    /// Book snapshots published on every channel.
+    uint64_t snapshotsSent() const;
+
+private:
+    friend class ItchUdpSink;
+
+    /// One MoldUDP64 session and the thread that sends it.
+    struct Channel {
+        std::unique_ptr<IDatagramSender> sender;
+        std::unique_ptr<IDatagramSender> snapshot_sender;  // null without snapshots
+        std::vector<uint32_t> securities;  // indices into sinks_
+        std::atomic<bool> sleeping{false};
+        std::atomic<uint64_t> messages_sent{0};
+        std::atomic<uint64_t> snapshots_sent{0};
+        std::mutex mutex;
+        std::condition_variable cv;
+        std::thread thread;
+    };
+
+    void run(uint32_t channel, uint64_t open_ts_ns);
+    bool anyQueued(const Channel& channel) const;
+    /// Wakes a channel's sender thread if it is asleep.
+    void wake(uint32_t channel);
+
+    ItchLiveConfig config_;
+    std::vector<std::unique_ptr<Channel>> channels_;
+    std::vector<std::unique_ptr<ItchUdpSink>> sinks_;
+    std::atomic<bool> running_{false};  // between start() and the end of stop()
+    std::atomic<bool> stop_{false};
+    bool started_ = false;
+    bool snapshots_ = false;
+};
+
+}  // namespace itch
+}  // namespace qrsdp
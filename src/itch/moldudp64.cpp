@@ -1,67 +1,121 @@
 #include "itch/moldudp64.h"
-#include "itch/itch_messages.h"
 #include "itch/endian.h"
 
 #include <algorithm>
 #include <cstring>
+#include <stdexcept>
 
 namespace qrsdp {
 namespace itch {
 
-MoldUDP64Framer::MoldUDP64Framer(const std::string& session_id) {
+MoldUDP64Framer::MoldUDP64Framer(const std::string& session_id, size_t pool_size)
+    : pool_(std::max<size_t>(pool_size, 1))
+{
     std::memset(session_, ' ', sizeof(session_));
     size_t len = std::min(session_id.size(), sizeof(session_));
     std::memcpy(session_, session_id.data(), len);
-    buffer_.reserve(kMoldUDP64MaxPayload + kMoldUDP64HeaderSize);
+    batch_.reserve(pool_.size());
 }
 
 void MoldUDP64Framer::addMessage(const uint8_t* data, uint16_t len) {
-    size_t block_size = 2 + len;  // 2-byte length prefix + payload
-    size_t current_payload = buffer_.size();
+    std::memcpy(reserveMessage(len), data, len);
+    commitMessage(len);
+}
+
+uint8_t* MoldUDP64Framer::reserveMessage(uint16_t max_len) {
+    size_t block_size = 2 + static_cast<size_t>(max_len);  // 2-byte length prefix + payload
+    if (kMoldUDP64HeaderSize + block_size > kMoldUDP64MaxPayload)
+        throw std::length_error("MoldUDP64Framer: message larger than a packet");
 
-    if (message_count_ > 0 &&
-        (kMoldUDP64HeaderSize + current_payload + block_size) > kMoldUDP64MaxPayload)
-    {
+    if (message_count_ > 0 && (used_ + block_size) > kMoldUDP64MaxPayload) {
         emitPacket();
     }
 
-    // Append 2-byte big-endian length prefix
-    uint16_t be_len = htobe16(len);
-    auto* len_bytes = reinterpret_cast<const uint8_t*>(&be_len);
-    buffer_.push_back(len_bytes[0]);
-    buffer_.push_back(len_bytes[1]);
-
-    // Append message payload
-    buffer_.insert(buffer_.end(), data, data + len);
-    ++message_count_;
+    reserved_at_ = used_;
+    used_ += block_size;
+    return current() + reserved_at_ + 2;
 }
 
-std::vector<uint8_t> MoldUDP64Framer::flush() {
-    if (message_count_ == 0)
-        return {};
+void MoldUDP64Framer::commitMessage(uint16_t len) {
+    // 2-byte big-endian length prefix ahead of the payload
+    uint16_t be_len = htobe16(len);
+    std::memcpy(current() + reserved_at_, &be_len, sizeof(be_len));
+    used_ = reserved_at_ + 2 + len;
+    ++message_count_;
 
-    // Build the complete packet: header + buffered message blocks
-    std::vector<uint8_t> packet(kMoldUDP64HeaderSize + buffer_.size());
+    if (deadline_.count() > 0) {
+        const auto now = Clock::now();
+        if (message_count_ == 1 && batch_.empty())
+            first_pending_ = now;
+        else if (now - first_pending_ >= deadline_)
+            sendPending();
+    }
+}
 
+void MoldUDP64Framer::sealPacket() {
     MoldUDP64Header hdr{};
     std::memcpy(hdr.session, session_, 10);
     hdr.sequence_number = htobe64(sequence_number_);
     hdr.message_count   = htobe16(message_count_);
-    std::memcpy(packet.data(), &hdr, kMoldUDP64HeaderSize);
-    std::memcpy(packet.data() + kMoldUDP64HeaderSize, buffer_.data(), buffer_.size());
+    std::memcpy(current(), &hdr, kMoldUDP64HeaderSize);
+}
 
+void MoldUDP64Framer::nextPacket() {
     sequence_number_ += message_count_;
     message_count_ = 0;
-    buffer_.clear();
+    used_ = kMoldUDP64HeaderSize;
+    current_ = (current_ + 1) % pool_.size();
+}
 
+std::vector<uint8_t> MoldUDP64Framer::flush() {
+    deliverBatch();
+    if (message_count_ == 0)
+        return {};
+
+    sealPacket();
+    std::vector<uint8_t> packet(current(), current() + used_);
+    nextPacket();
     return packet;
 }
 
 void MoldUDP64Framer::emitPacket() {
-    auto packet = flush();
-    if (!packet.empty() && send_cb_) {
-        send_cb_(packet.data(), packet.size());
+    if (message_count_ == 0)
+        return;
+
+    sealPacket();
+    if (batch_cb_) {
+        batch_.push_back(Datagram{current(), used_});
+        nextPacket();
+        // The pool is full of held packets: hand them over before one is reused.
+        if (batch_.size() == pool_.size())
+            deliverBatch();
+        return;
+    }
+    if (send_cb_) {
+        send_cb_(current(), used_);
     }
+    nextPacket();
+}
+
+void MoldUDP64Framer::deliverBatch() {
+    if (batch_.empty())
+        return;
+    if (batch_cb_)
+        batch_cb_(batch_.data(), batch_.size());
+    batch_.clear();
+}
+
+void MoldUDP64Framer::sendPending() {
+    emitPacket();
+    deliverBatch();
+}
+
+bool MoldUDP64Framer::flushIfDue() {
+    if ((message_count_ == 0 && batch_.empty()) || deadline_.count() <= 0
+        || Clock::now() - first_pending_ < deadline_)
+        return false;
+    sendPending();
+    return true;
 }
 
 }  // namespace itch
@@ -1,5 +1,10 @@
 #pragma once
 
+#include "itch/itch_messages.h"
+#include "itch/i_datagram_sender.h"
+
+#include <chrono>
+#include <cstddef>
 #include <cstdint>
 #include <functional>
 #include <string>
@@ -15,37 +20,101 @@ namespace itch {
 /// (2-byte big-endian length + payload).
 ///
 /// Auto-flushes when the accumulated payload approaches the MTU limit.
+///
+/// Packets are built in place in a small pool of MTU-sized, cache-aligned
+/// buffers with the header space reserved up front; the header is patched in at
+/// send time and the buffer is handed to the send callback by pointer, so
+/// framing does not allocate or copy. A packet passed to the callback stays
+/// valid until pool_size - 1 further packets have been sent.
+///
+/// With a batch callback set, sealed packets are held until the whole pool is
+/// full (pool_size packets) and then handed over in one call, e.g. to
+/// UdpMulticastSender::sendBatch. A flush deadline bounds how long any message
+/// waits in the framer either way.
 class MoldUDP64Framer {
 public:
     /// Callback invoked when a complete packet is ready to send.
     using SendCallback = std::function<void(const uint8_t* data, size_t len)>;
+    /// Callback invoked with up to pool_size complete packets, in order.
+    using BatchCallback = std::function<void(const Datagram* packets, size_t n)>;
+
+    static constexpr size_t kDefaultPoolSize = 4;
 
     /// @param session_id  10-character session identifier (truncated/padded).
-    explicit MoldUDP64Framer(const std::string& session_id);
+    /// @param pool_size   Packet buffers to rotate through (at least 1).
+    explicit MoldUDP64Framer(const std::string& session_id, size_t pool_size = kDefaultPoolSize);
 
     /// Add a single ITCH message to the current packet.
     /// If the packet would exceed the MTU limit, it is flushed first via
     /// the send callback, then the message is placed in a new packet.
+    /// Throws std::length_error if the message cannot fit in any packet.
     void addMessage(const uint8_t* data, uint16_t len);
 
-    /// Flush the current packet (if non-empty) via the send callback.
-    /// Returns the flushed packet bytes, or empty if nothing to flush.
+    /// Reserves a slot for a message of at most max_len bytes in the current
+    /// packet (flushing it first, like addMessage, if it would not fit) and
+    /// returns where to write the payload. Complete it with commitMessage();
+    /// no other framer call may come in between.
+    uint8_t* reserveMessage(uint16_t max_len);
+
+    /// Completes the reserved slot with the payload's actual length (<= max_len).
+    void commitMessage(uint16_t len);
+
+    /// Flush the current packet (if non-empty), returning a copy of its bytes
+    /// instead of sending it; empty if nothing to flush. A held batch is
+    /// delivered first so packets stay in sequence order.
     std::vector<uint8_t> flush();
 
+    /// Flush the current packet (if non-empty) and any held batch through the
+    /// callbacks.
+    void sendPending();
+
+    /// Sends everything pending if its oldest message has waited past the flush
+    /// deadline; for callers to poll while no messages arrive. Returns true if
+    /// it sent.
+    bool flushIfDue();
+
     /// Set the callback that receives complete packets.
     void setSendCallback(SendCallback cb) { send_cb_ = std::move(cb); }
 
+    /// Hold sealed packets and hand them to cb pool_size at a time (replaces
+    /// the per-packet send callback while set).
+    void setBatchCallback(BatchCallback cb) { batch_cb_ = std::move(cb); }
+
+    /// Longest a message may wait before its packet (and batch) is sent, checked
+    /// as messages are added and in flushIfDue(). Zero (the default) disables it.
+    void setFlushDeadline(std::chrono::nanoseconds deadline) { deadline_ = deadline; }
+
     uint64_t nextSequenceNumber() const { return sequence_number_; }
     uint16_t pendingMessageCount() const { return message_count_; }
 
 private:
+    struct alignas(64) PacketBuffer {
+        uint8_t bytes[kMoldUDP64MaxPayload];
+    };
+
+    using Clock = std::chrono::steady_clock;
+
     void emitPacket();
+    void deliverBatch();
+    /// Writes the header into the current buffer.
+    void sealPacket();
+    /// Moves on to the next pool buffer with an empty packet.
+    void nextPacket();
+
+    uint8_t* current() { return pool_[current_].bytes; }
 
     char     session_[10];
     uint64_t sequence_number_ = 1;
     uint16_t message_count_   = 0;
-    std::vector<uint8_t> buffer_;
+    size_t   used_            = kMoldUDP64HeaderSize;  // bytes of the current packet, header included
+    size_t   reserved_at_     = 0;  // offset of the reserved slot's length prefix
+    std::vector<PacketBuffer> pool_;
+    size_t   current_         = 0;
+    std::vector<Datagram> batch_;   // sealed packets held for batch_cb_
+    std::chrono::nanoseconds deadline_{0};
+    Clock::time_point first_pending_;  // when the oldest pending message was added
     SendCallback send_cb_;
+    BatchCallback batch_cb_;
 };
 
 }  // namespace itch
@@ -0,0 +1,252 @@
+#include "itch/moldudp64_retransmit.h"
+#include "itch/endian.h"
+
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#ifdef _WIN32
+    #ifndef WIN32_LEAN_AND_MEAN
+    #define WIN32_LEAN_AND_MEAN
+    #endif
+    #include <winsock2.h>
+    #include <ws2tcpip.h>
+    #pragma comment(lib, "ws2_32.lib")
+
+    namespace {
+    struct WinsockInit {
+        WinsockInit() {
+            WSADATA wsa;
+            WSAStartup(MAKEWORD(2, 2), &wsa);
+        }
+        ~WinsockInit() { WSACleanup(); }
+    };
+    static WinsockInit g_winsock_init;
+    }  // namespace
+
+    using socket_t = SOCKET;
+    using socklen_t = int;
+    constexpr socket_t kInvalidSocket = INVALID_SOCKET;
+    inline int closeSocket(socket_t s) { return closesocket(s); }
+#else
+    #include <arpa/inet.h>
+    #include <netinet/in.h>
+    #include <sys/socket.h>
+    #include <sys/time.h>
+    #include <unistd.h>
+
+    using socket_t = int;
+    constexpr socket_t kInvalidSocket = -1;
+    inline int closeSocket(socket_t s) { return close(s); }
+#endif
+
+namespace qrsdp {
+namespace itch {
+
+namespace {
+
+constexpr int kReadAttempts = 4;
+constexpr int kPollTimeoutMs = 100;  // how often the server thread checks stop()
+
+}  // namespace
+
+// --- RetransmitRing ---
+
+RetransmitRing::RetransmitRing(size_t capacity) : slots_(capacity) {
+    if (capacity == 0)
+        throw std::runtime_error("RetransmitRing: capacity must be positive");
+}
+
+void RetransmitRing::record(const uint8_t* packet, size_t len) {
+    if (len < kMoldUDP64HeaderSize || len > kMoldUDP64MaxPayload)
+        return;
+    MoldUDP64Header hdr;
+    std::memcpy(&hdr, packet, kMoldUDP64HeaderSize);
+    const uint16_t count = betoh16(hdr.message_count);
+    if (count == 0)
+        return;
+
+    const uint64_t p = head_.load(std::memory_order_relaxed);
+    Slot& slot = slots_[p % slots_.size()];
+    const uint64_t version = slot.version.load(std::memory_order_relaxed);
+    slot.version.store(version + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    std::memcpy(slot.bytes, packet, len);
+    slot.len.store(static_cast<uint32_t>(len), std::memory_order_relaxed);
+    slot.first_seq.store(betoh64(hdr.sequence_number), std::memory_order_relaxed);
+    slot.packet.store(p, std::memory_order_relaxed);
+    slot.version.store(version + 2, std::memory_order_release);
+
+    next_seq_.store(betoh64(hdr.sequence_number) + count, std::memory_order_release);
+    head_.store(p + 1, std::memory_order_release);
+}
+
+size_t RetransmitRing::readPacket(uint64_t p, uint8_t* buf) const {
+    const Slot& slot = slots_[p % slots_.size()];
+    for (int attempt = 0; attempt < kReadAttempts; ++attempt) {
+        const uint64_t version = slot.version.load(std::memory_order_acquire);
+        if (version & 1)
+            continue;
+        if (slot.packet.load(std::memory_order_relaxed) != p)
+            return 0;
+        const uint32_t len = slot.len.load(std::memory_order_relaxed);
+        std::memcpy(buf, slot.bytes, len);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.version.load(std::memory_order_relaxed) == version)
+            return slot.packet.load(std::memory_order_relaxed) == p ? len : 0;
+    }
+    return 0;
+}
+
+uint64_t RetransmitRing::findPacket(uint64_t seq, uint64_t head) const {
+    // Largest stored packet index whose first sequence is <= seq. A slot
+    // rewritten mid-search only misleads the search; readPacket validates.
+    uint64_t lo = head > slots_.size() ? head - slots_.size() : 0;
+    uint64_t hi = head;
+    if (slots_[lo % slots_.size()].first_seq.load(std::memory_order_relaxed) > seq)
+        return head;
+    while (hi - lo > 1) {
+        const uint64_t mid = lo + (hi - lo) / 2;
+        if (slots_[mid % slots_.size()].first_seq.load(std::memory_order_relaxed) <= seq)
+            lo = mid;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+uint64_t RetransmitRing::firstSequence() const {
+    const uint64_t head = head_.load(std::memory_order_acquire);
+    if (head == 0)
+        return 0;
+    const uint64_t oldest = head > slots_.size() ? head - slots_.size() : 0;
+    return slots_[oldest % slots_.size()].first_seq.load(std::memory_order_relaxed);
+}
+
+size_t RetransmitRing::buildResponse(uint64_t seq, uint16_t count, uint8_t* out) const {
+    const uint64_t head = head_.load(std::memory_order_acquire);
+    if (count == 0 || head == 0 || seq >= nextSequence())
+        return 0;
+
+    uint8_t buf[kMoldUDP64MaxPayload];
+    MoldUDP64Header hdr{};
+    size_t used = kMoldUDP64HeaderSize;
+    uint16_t taken = 0;
+    uint64_t want = seq;
+    bool full = false;
+    for (uint64_t p = findPacket(seq, head); p < head && taken < count && !full; ++p) {
+        const size_t len = readPacket(p, buf);
+        if (len == 0)
+            break;  // evicted while we looked
+        MoldUDP64Header stored;
+        std::memcpy(&stored, buf, kMoldUDP64HeaderSize);
+        const uint64_t first = betoh64(stored.sequence_number);
+        if (first > want)
+            break;
+        if (taken == 0)
+            std::memcpy(hdr.session, stored.session, sizeof(hdr.session));
+
+        size_t off = kMoldUDP64HeaderSize;
+        const uint16_t n = betoh16(stored.message_count);
+        for (uint16_t i = 0; i < n && taken < count; ++i) {
+            uint16_t be_len;
+            if (off + 2 > len) break;
+            std::memcpy(&be_len, buf + off, 2);
+            const size_t block = 2 + static_cast<size_t>(betoh16(be_len));
+            if (off + block > len) break;
+            if (first + i >= want) {
+                if (used + block > kMoldUDP64MaxPayload) {
+                    full = true;
+                    break;
+                }
+                std::memcpy(out + used, buf + off, block);
+                used += block;
+                ++taken;
+                ++want;
+            }
+            off += block;
+        }
+    }
+    if (taken == 0)
+        return 0;
+
+    hdr.sequence_number = htobe64(seq);
+    hdr.message_count = htobe16(taken);
+    std::memcpy(out, &hdr, kMoldUDP64HeaderSize);
+    return used;
+}
+
+// --- RetransmitServer ---
+
+RetransmitServer::RetransmitServer(const RetransmitRing& ring, uint16_t port) : ring_(ring) {
+    const socket_t sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (sock == kInvalidSocket)
+        throw std::runtime_error("RetransmitServer: socket() failed");
+    sock_ = static_cast<decltype(sock_)>(sock);
+
+    struct sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    if (bind(sock, reinterpret_cast<const struct sockaddr*>(&addr), sizeof(addr)) != 0) {
+        closeSocket(sock);
+        throw std::runtime_error("RetransmitServer: cannot bind port " + std::to_string(port));
+    }
+    socklen_t addr_len = sizeof(addr);
+    getsockname(sock, reinterpret_cast<struct sockaddr*>(&addr), &addr_len);
+    port_ = ntohs(addr.sin_port);
+
+#ifdef _WIN32
+    DWORD timeout_ms = kPollTimeoutMs;
+    setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO,
+               reinterpret_cast<const char*>(&timeout_ms), sizeof(timeout_ms));
+#else
+    struct timeval tv { 0, kPollTimeoutMs * 1000 };
+    setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO,
+               reinterpret_cast<const char*>(&tv), sizeof(tv));
+#endif
+}
+
+RetransmitServer::~RetransmitServer() {
+    stop();
+    closeSocket(static_cast<socket_t>(sock_));
+}
+
+void RetransmitServer::start() {
+    if (running_.exchange(true))
+        return;
+    thread_ = std::thread([this] { run(); });
+}
+
+void RetransmitServer::stop() {
+    running_ = false;
+    if (thread_.joinable())
+        thread_.join();
+}
+
+void RetransmitServer::run() {
+    uint8_t request[64];
+    uint8_t response[kMoldUDP64MaxPayload];
+    while (running_) {
+        struct sockaddr_in from{};
+        socklen_t from_len = sizeof(from);
+        auto n = recvfrom(static_cast<socket_t>(sock_), reinterpret_cast<char*>(request),
+                                sizeof(request), 0, reinterpret_cast<struct sockaddr*>(&from),
+                                &from_len);
+        if (n != static_cast<decltype(n)>(kMoldUDP64HeaderSize))
+            continue;  // timeout, error or not a request
+
+        MoldUDP64Header hdr;
+        std::memcpy(&hdr, request, kMoldUDP64HeaderSize);
+        const size_t len = ring_.buildResponse(betoh64(hdr.sequence_number),
+                                               betoh16(hdr.message_count), response);
+        if (len == 0)
+            continue;
+        sendto(static_cast<socket_t>(sock_), reinterpret_cast<const char*>(response),
+               static_cast<int>(len), 0, reinterpret_cast<const struct sockaddr*>(&from), from_len);
+        served_.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+}  // namespace itch
+}  // namespace qrsdp
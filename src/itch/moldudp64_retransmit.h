@@ -0,0 +1,96 @@
+#pragma once
+
+#include "itch/itch_messages.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace qrsdp {
+namespace itch {
+
+/// The last `capacity` MoldUDP64 packets sent, indexed by sequence number, for
+/// answering gap requests. One thread records (the sender, after each packet);
+/// any number read concurrently. Each slot is a seqlock, so record() never
+/// waits on a reader and a reader that races a rewrite just retries. Memory is
+/// fixed at construction: capacity MTU-sized slots.
+class RetransmitRing {
+public:
+    explicit RetransmitRing(size_t capacity);
+
+    RetransmitRing(const RetransmitRing&) = delete;
+    RetransmitRing& operator=(const RetransmitRing&) = delete;
+
+    /// Stores a complete packet (header + message blocks) as sent; packets must
+    /// arrive in sequence order. Packets without messages are ignored.
+    void record(const uint8_t* packet, size_t len);
+
+    /// Builds a response packet in out (at least kMoldUDP64MaxPayload bytes)
+    /// holding up to count messages from sequence seq on, as many as fit one
+    /// packet. Returns its length, or 0 if seq is not (or no longer) stored.
+    size_t buildResponse(uint64_t seq, uint16_t count, uint8_t* out) const;
+
+    /// First and one-past-last sequence numbers currently stored.
+    uint64_t firstSequence() const;
+    uint64_t nextSequence() const { return next_seq_.load(std::memory_order_acquire); }
+
+    size_t capacity() const { return slots_.size(); }
+
+private:
+    struct alignas(64) Slot {
+        std::atomic<uint64_t> version{0};  // odd while being written
+        std::atomic<uint64_t> packet{0};   // index of the packet held
+        std::atomic<uint64_t> first_seq{0};
+        std::atomic<uint32_t> len{0};
+        uint8_t bytes[kMoldUDP64MaxPayload];
+    };
+
+    /// Copies packet p into buf if it is still stored; returns its length or 0.
+    size_t readPacket(uint64_t p, uint8_t* buf) const;
+    /// Index of the stored packet holding seq, or head if none.
+    uint64_t findPacket(uint64_t seq, uint64_t head) const;
+
+    std::vector<Slot> slots_;
+    std::atomic<uint64_t> head_{0};      // packets recorded
+    std::atomic<uint64_t> next_seq_{0};  // one past the last stored message
+};
+
+/// Answers MoldUDP64 request packets (session, sequence, count; 20 bytes) on a
+/// UDP port from a RetransmitRing, unicast back to the requester. Runs on its
+/// own thread so the primary send path never waits on it.
+class RetransmitServer {
+public:
+    /// Binds the port (0 = ephemeral). Throws std::runtime_error on failure.
+    RetransmitServer(const RetransmitRing& ring, uint16_t port);
+    ~RetransmitServer();
+
+    RetransmitServer(const RetransmitServer&) = delete;
+    RetransmitServer& operator=(const RetransmitServer&) = delete;
+
+    void start();
+    /// Stops and joins the thread. Idempotent.
+    void stop();
+
+    uint16_t port() const { return port_; }
+    uint64_t requestsServed() const { return served_.load(std::memory_order_relaxed); }
+
+private:
+    void run();
+
+    const RetransmitRing& ring_;
+#ifdef _WIN32
+    uintptr_t sock_;
+#else
+    int sock_;
+#endif
+    uint16_t port_ = 0;
+    std::atomic<bool> running_{false};
+    std::atomic<uint64_t> served_{0};
+    std::thread thread_;
+};
+
+}  // namespace itch
+}  // namespace qrsdp
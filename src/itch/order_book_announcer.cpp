@@ -0,0 +1,71 @@
+#include "itch/order_book_announcer.h"
+#include "core/event_types.h"
+
+#include <stdexcept>
+#include <string>
+
+namespace qrsdp {
+namespace itch {
+
+void OrderBookAnnouncer::stamp(uint64_t ts_ns) {
+    for (EventRecord& rec : changes_) rec.ts_ns = ts_ns;
+}
+
+const std::vector<EventRecord>& OrderBookAnnouncer::start(const BookSeed& seed, uint64_t ts_ns) {
+    changes_.clear();
+    book_.setJournal(&changes_);
+    book_.seed(seed);
+    stamp(ts_ns);
+    started_ = true;
+    return changes_;
+}
+
+const std::vector<EventRecord>& OrderBookAnnouncer::apply(const EventRecord& rec) {
+    if (!started_)
+        throw std::runtime_error("OrderBookAnnouncer: apply() before start()");
+    changes_.clear();
+    SimEvent ev;
+    ev.type = static_cast<EventType>(rec.type);
+    ev.side = static_cast<Side>(rec.side);
+    ev.price_ticks = rec.price_ticks;
+    ev.qty = rec.qty;
+    ev.order_id = rec.order_id;
+    book_.apply(ev);
+    if (rec.flags & kFlagReinit)
+        throw std::runtime_error("OrderBookAnnouncer: reinitialised depths are not in the records");
+    // An empty level leaves the record with its own (never added) id.
+    const uint64_t hit = book_.restingOrderId();
+    if (hit != 0 && hit != rec.order_id)
+        throw std::runtime_error("OrderBookAnnouncer: record names order " + std::to_string(rec.order_id)
+                                 + ", the book's resting order is " + std::to_string(hit));
+    stamp(rec.ts_ns);
+    return changes_;
+}
+
+const std::vector<EventRecord>& OrderBookAnnouncer::finish(uint64_t ts_ns) {
+    changes_.clear();
+    if (started_) {
+        for (const Side side : {Side::BID, Side::ASK}) {
+            const bool bid = side == Side::BID;
+            for (size_t k = 0; k < book_.numLevels(); ++k) {
+                const int32_t price = bid ? book_.bidPriceAtLevel(k) : book_.askPriceAtLevel(k);
+                for (const uint64_t id : book_.queueAtLevel(side, k)) {
+                    EventRecord rec{};
+                    rec.order_id = id;
+                    rec.price_ticks = price;
+                    rec.qty = book_.orderQty(id);
+                    rec.type = static_cast<uint8_t>(bid ? EventType::CANCEL_BID : EventType::CANCEL_ASK);
+                    rec.side = static_cast<uint8_t>(side);
+                    changes_.push_back(rec);
+                }
+            }
+        }
+        stamp(ts_ns);
+        book_.setJournal(nullptr);
+        started_ = false;
+    }
+    return changes_;
+}
+
+}  // namespace itch
+}  // namespace qrsdp
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "book/order_level_book.h"
+#include "core/records.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace qrsdp {
+namespace itch {
+
+/// The order changes an order-level session's records leave out, for its ITCH
+/// feed. With qrsdp_run --order-book, cancels and executions name the resting
+/// order they hit, but the book also creates orders itself (the seed depth, the
+/// level refilled after a shift) and drops some without a record of their own
+/// (the level that leaves the window when an add improves the spread). Fed the
+/// session's records in order, this rebuilds the producer's OrderLevelBook and
+/// returns those changes as ADD and CANCEL records to encode after each one, so
+/// a consumer that builds a book from the Add Order, Order Delete and Order
+/// Executed messages ends up with the producer's orders.
+///
+/// Only the records are needed, so it works on a recorded log as well as on a
+/// live stream, except after a reinitialisation (queue_reactive.theta_reinit):
+/// the redrawn depths are not in the records, and the next cancel or execution
+/// then names an order the rebuilt book does not have.
+class OrderBookAnnouncer {
+public:
+    /// Seeds the book as the producer did for the session and returns its
+    /// orders as ADD records stamped ts_ns.
+    const std::vector<EventRecord>& start(const BookSeed& seed, uint64_t ts_ns);
+
+    /// Applies the session's next record and returns the changes the book made
+    /// besides it, stamped with its timestamp. Throws std::runtime_error if a
+    /// cancel or execution names another order than the rebuilt book's (the
+    /// records do not come from this session's order-level book, or its depths
+    /// were reinitialised), if rec carries kFlagReinit, or if start() was not
+    /// called.
+    const std::vector<EventRecord>& apply(const EventRecord& rec);
+
+    /// CANCEL records for every order still in the book, stamped ts_ns; the
+    /// book is then empty until the next start().
+    const std::vector<EventRecord>& finish(uint64_t ts_ns);
+
+    bool started() const { return started_; }
+    const OrderLevelBook& book() const { return book_; }
+
+private:
+    void stamp(uint64_t ts_ns);
+
+    OrderLevelBook book_;
+    std::vector<EventRecord> changes_;
+    bool started_ = false;
+};
+
+}  // namespace itch
+}  // namespace qrsdp
@@ -0,0 +1,123 @@
+#include "itch/partition_merge.h"
+
+#include <stdexcept>
+#include <thread>
+
+namespace qrsdp {
+namespace itch {
+
+PartitionMerge::PartitionMerge(size_t inputs, size_t queue_batches,
+                               std::chrono::microseconds idle_wait, uint64_t rollover_ns,
+                               ReleaseFn release)
+    : idle_wait_(std::chrono::duration_cast<Clock::duration>(idle_wait))
+    , rollover_ns_(rollover_ns)
+    , release_(release) {
+    if (inputs == 0 || queue_batches == 0)
+        throw std::runtime_error("PartitionMerge: inputs and queue depth must be positive");
+    inputs_.reserve(inputs);
+    for (size_t i = 0; i < inputs; ++i)
+        inputs_.push_back(std::make_unique<Input>(queue_batches));
+}
+
+PartitionMerge::~PartitionMerge() {
+    for (auto& in : inputs_) {
+        releaseBatch(*in);
+        PartitionBatch b;
+        while (in->queue.tryPop(b)) {
+            if (release_ && b.handle)
+                release_(b.handle);
+        }
+    }
+}
+
+bool PartitionMerge::push(size_t input, const PartitionBatch& b) {
+    if (b.count == 0) {
+        if (release_ && b.handle)
+            release_(b.handle);
+        return true;
+    }
+    Input& in = *inputs_.at(input);
+    while (!in.queue.tryPush(b)) {
+        if (stopped_.load(std::memory_order_acquire))
+            return false;
+        std::this_thread::yield();
+    }
+    return true;
+}
+
+void PartitionMerge::releaseBatch(Input& in) {
+    if (release_ && in.batch.handle)
+        release_(in.batch.handle);
+    in.batch = PartitionBatch{};
+    in.pos = 0;
+}
+
+bool PartitionMerge::loadHead(Input& in) {
+    if (in.has_head)
+        return true;
+    if (in.pos >= in.batch.count) {
+        releaseBatch(in);
+        if (!in.queue.tryPop(in.batch))
+            return false;
+    }
+    const uint64_t ts = in.batch.records[in.pos].ts_ns;
+    if (in.seen && ts + rollover_ns_ < in.max_ts) {
+        ++in.day;
+        in.max_ts = ts;
+    } else if (!in.seen || ts > in.max_ts) {
+        in.max_ts = ts;
+    }
+    in.seen = true;
+    in.has_head = true;
+    in.waiting = false;
+    in.idle = false;
+    return true;
+}
+
+bool PartitionMerge::next(MergedRecord& out) {
+    if (last_) {
+        // The record returned last is consumed only now, so its pointers
+        // outlived the previous call.
+        last_->has_head = false;
+        ++last_->pos;
+        last_ = nullptr;
+    }
+
+    Input* best = nullptr;
+    bool now_read = false;
+    Clock::time_point now;
+    for (auto& p : inputs_) {
+        Input& in = *p;
+        if (!loadHead(in)) {
+            if (in.idle)
+                continue;
+            if (!now_read) {
+                now = Clock::now();
+                now_read = true;
+            }
+            if (!in.waiting) {
+                in.waiting = true;
+                in.empty_since = now;
+            }
+            if (now - in.empty_since < idle_wait_)
+                return false;  // may still deliver something earlier
+            in.idle = true;
+            continue;
+        }
+        if (!best || in.day < best->day
+            || (in.day == best->day
+                && in.batch.records[in.pos].ts_ns < best->batch.records[best->pos].ts_ns))
+            best = &in;
+    }
+    if (!best)
+        return false;
+
+    out.key = best->batch.key;
+    out.key_len = best->batch.key_len;
+    out.record = &best->batch.records[best->pos];
+    last_ = best;
+    return true;
+}
+
+}  // namespace itch
+}  // namespace qrsdp
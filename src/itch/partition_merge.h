@@ -0,0 +1,102 @@
+#pragma once
+
+#include "io/event_log_format.h"
+#include "io/spsc_ring.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace qrsdp {
+namespace itch {
+
+/// One Kafka message as handed from a partition reader to the merge: its key,
+/// the records it carries (see io/kafka_payload.h) and an opaque handle given
+/// back to the release function once the last record has been consumed.
+struct PartitionBatch {
+    const char* key = nullptr;
+    size_t key_len = 0;
+    const DiskEventRecord* records = nullptr;
+    size_t count = 0;
+    void* handle = nullptr;
+};
+
+/// A record in merge order. Pointers stay valid until the next call to next().
+struct MergedRecord {
+    const char* key = nullptr;
+    size_t key_len = 0;
+    const DiskEventRecord* record = nullptr;
+};
+
+/// Time-ordered merge of per-partition message streams. Each input is fed by
+/// one reader thread through its own SPSC queue; one merge thread pulls
+/// records in (day, ts_ns) order. A record is only released while every input
+/// either has one queued or has been empty for idle_wait, so a quiet partition
+/// delays the others by at most that long and then stops holding them up.
+///
+/// Each input must be in timestamp order within a day. A drop of more than
+/// rollover_ns below the highest timestamp an input has seen starts its next
+/// day, so a partition that rolls over first waits for the others to finish
+/// theirs instead of interleaving two days.
+class PartitionMerge {
+public:
+    using ReleaseFn = void (*)(void* handle);
+
+    /// queue_batches is the per-input queue depth in messages. release may be
+    /// null when handles need no cleanup.
+    PartitionMerge(size_t inputs, size_t queue_batches, std::chrono::microseconds idle_wait,
+                   uint64_t rollover_ns, ReleaseFn release);
+    /// Releases every batch still queued or in progress.
+    ~PartitionMerge();
+
+    PartitionMerge(const PartitionMerge&) = delete;
+    PartitionMerge& operator=(const PartitionMerge&) = delete;
+
+    size_t inputCount() const { return inputs_.size(); }
+
+    /// Reader side, one thread per input: queues b, yielding while the queue is
+    /// full. Returns false without queueing once stop() has been called; the
+    /// caller then still owns b.handle. Batches without records are released at once.
+    bool push(size_t input, const PartitionBatch& b);
+
+    /// Merge side: the next record in order, or false if none is ready
+    /// (an input is empty and still inside its idle wait, or all are empty).
+    bool next(MergedRecord& out);
+
+    /// Makes every blocked and future push() return false.
+    void stop() { stopped_.store(true, std::memory_order_release); }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Input {
+        explicit Input(size_t capacity) : queue(capacity) {}
+        SpscRing<PartitionBatch> queue;
+        PartitionBatch batch;        // current batch; handle == nullptr if none
+        size_t pos = 0;              // next record of batch
+        bool has_head = false;       // batch.records[pos] is loaded as the head
+        uint64_t day = 0;
+        uint64_t max_ts = 0;
+        bool seen = false;
+        bool waiting = false;        // empty, idle wait started at empty_since
+        bool idle = false;           // empty for longer than the idle wait
+        Clock::time_point empty_since;
+    };
+
+    /// Loads the input's next record as its head if one is queued.
+    bool loadHead(Input& in);
+    void releaseBatch(Input& in);
+
+    std::vector<std::unique_ptr<Input>> inputs_;
+    Clock::duration idle_wait_;
+    uint64_t rollover_ns_;
+    ReleaseFn release_;
+    Input* last_ = nullptr;          // input of the record returned last
+    std::atomic<bool> stopped_{false};
+};
+
+}  // namespace itch
+}  // namespace qrsdp
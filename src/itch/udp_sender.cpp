@@ -1,5 +1,6 @@
 #include "itch/udp_sender.h"
 
+#include <algorithm>
 #include <cstdio>
 #include <cstring>
 #include <stdexcept>
@@ -28,10 +29,18 @@
     inline int closeSocket(socket_t s) { return closesocket(s); }
 #else
     #include <arpa/inet.h>
+    #include <cerrno>
     #include <netdb.h>
     #include <netinet/in.h>
     #include <sys/socket.h>
+    #include <sys/uio.h>
     #include <unistd.h>
+    #ifdef __linux__
+        #include <netinet/udp.h>
+        #ifndef UDP_SEGMENT
+        #define UDP_SEGMENT 103  // linux/udp.h; older libc headers lack it
+        #endif
+    #endif
 
     using socket_t = int;
     constexpr socket_t kInvalidSocket = -1;
@@ -116,5 +125,115 @@ bool UdpMulticastSender::send(const uint8_t* data, size_t len) {
     return true;
 }
 
+#ifdef __linux__
+
+namespace {
+
+// Kernel limits for one UDP_SEGMENT send (UDP_MAX_SEGMENTS and the 64 KiB IP
+// datagram, minus headers).
+constexpr size_t kMaxGsoSegments = 64;
+constexpr size_t kMaxGsoBytes = 65000;
+
+/// Datagrams from packets[0] that can go as one GSO send: equal lengths, the
+/// last optionally shorter.
+size_t gsoRun(const Datagram* packets, size_t n) {
+    const size_t seg = packets[0].len;
+    size_t run = 1, bytes = seg;
+    while (run < n && run < kMaxGsoSegments && bytes + packets[run].len <= kMaxGsoBytes
+           && packets[run].len <= seg) {
+        bytes += packets[run].len;
+        if (packets[run++].len < seg) break;
+    }
+    return run;
+}
+
+bool gsoRejected(int err) {
+    return err == EIO || err == EINVAL || err == ENOPROTOOPT || err == EOPNOTSUPP;
+}
+
+}  // namespace
+
+bool UdpMulticastSender::enableGso(bool on) {
+    if (!on) {
+        gso_ = false;
+        return true;
+    }
+    // Probe with a zero segment size, which the socket accepts (and ignores) iff
+    // the kernel knows UDP_SEGMENT.
+    int probe = 0;
+    gso_ = setsockopt(sock_, SOL_UDP, UDP_SEGMENT, &probe, sizeof(probe)) == 0;
+    return gso_;
+}
+
+size_t UdpMulticastSender::sendBatch(const Datagram* packets, size_t n) {
+    struct mmsghdr msgs[kMaxBatch];
+    struct iovec iovs[kMaxBatch];
+    alignas(struct cmsghdr) char control[kMaxBatch][CMSG_SPACE(sizeof(uint16_t))];
+    size_t counts[kMaxBatch];  // datagrams carried by each message
+
+    size_t sent = 0;
+    while (sent < n) {
+        // Fill up to kMaxBatch iovecs, one message per datagram or GSO run.
+        size_t nmsg = 0, niov = 0;
+        for (size_t i = sent; i < n && niov < kMaxBatch; ++nmsg) {
+            const size_t run = gso_ ? gsoRun(packets + i, std::min(n - i, kMaxBatch - niov)) : 1;
+            std::memset(&msgs[nmsg], 0, sizeof(msgs[nmsg]));
+            struct msghdr& hdr = msgs[nmsg].msg_hdr;
+            hdr.msg_name = &dest_->addr;
+            hdr.msg_namelen = sizeof(dest_->addr);
+            hdr.msg_iov = &iovs[niov];
+            hdr.msg_iovlen = run;
+            for (size_t k = 0; k < run; ++k, ++niov) {
+                iovs[niov].iov_base = const_cast<uint8_t*>(packets[i + k].data);
+                iovs[niov].iov_len = packets[i + k].len;
+            }
+            if (run > 1) {
+                hdr.msg_control = control[nmsg];
+                hdr.msg_controllen = sizeof(control[nmsg]);
+                struct cmsghdr* cm = CMSG_FIRSTHDR(&hdr);
+                cm->cmsg_level = SOL_UDP;
+                cm->cmsg_type = UDP_SEGMENT;
+                cm->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+                const uint16_t segment = static_cast<uint16_t>(packets[i].len);
+                std::memcpy(CMSG_DATA(cm), &segment, sizeof(segment));
+            }
+            counts[nmsg] = run;
+            i += run;
+        }
+
+        const int done = sendmmsg(sock_, msgs, static_cast<unsigned>(nmsg), 0);
+        if (done < 0) {
+            if (errno == EINTR)
+                continue;
+            if (gso_ && gsoRejected(errno)) {
+                gso_ = false;  // e.g. no checksum offload on the route: batch plainly
+                continue;
+            }
+            std::fprintf(stderr, "UdpMulticastSender: sendmmsg failed\n");
+            return sent;
+        }
+        for (int m = 0; m < done; ++m)
+            sent += counts[m];
+    }
+    return sent;
+}
+
+#else
+
+bool UdpMulticastSender::enableGso(bool on) {
+    gso_ = false;
+    return !on;
+}
+
+size_t UdpMulticastSender::sendBatch(const Datagram* packets, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        if (!send(packets[i].data, packets[i].len))
+            return i;
+    }
+    return n;
+}
+
+#endif
+
 }  // namespace itch
 }  // namespace qrsdp
@@ -1,5 +1,8 @@
 #pragma once
 
+#include "itch/i_datagram_sender.h"
+
+#include <cstddef>
 #include <cstdint>
 #include <memory>
 #include <string>
@@ -9,14 +12,18 @@ namespace itch {
 
 /// Fire-and-forget UDP sender supporting both multicast and unicast.
 /// Cross-platform: uses Winsock on Windows, POSIX sockets elsewhere.
-class UdpMulticastSender {
+/// The default transmit backend.
+class UdpMulticastSender final : public IDatagramSender {
 public:
+    /// Datagrams handed to the kernel per sendmmsg call.
+    static constexpr size_t kMaxBatch = 64;
+
     /// Multicast mode: sends to a multicast group.
     /// @param group  Multicast group address (e.g. "239.1.1.1").
     /// @param port   Destination port.
     /// @param ttl    Multicast TTL (default 1 = local subnet only).
     UdpMulticastSender(const std::string& group, uint16_t port, uint8_t ttl = 1);
-    ~UdpMulticastSender();
+    ~UdpMulticastSender() override;
 
     UdpMulticastSender(const UdpMulticastSender&) = delete;
     UdpMulticastSender& operator=(const UdpMulticastSender&) = delete;
@@ -26,7 +33,20 @@ public:
     static std::unique_ptr<UdpMulticastSender> createUnicast(const std::string& host, uint16_t port);
 
     /// Send a datagram. Returns true on success.
-    bool send(const uint8_t* data, size_t len);
+    bool send(const uint8_t* data, size_t len) override;
+
+    /// Send n datagrams in order; returns how many were sent (all of them on
+    /// success). On Linux this is one sendmmsg per kMaxBatch datagrams instead of
+    /// a sendto each; elsewhere it loops over send().
+    size_t sendBatch(const Datagram* packets, size_t n) override;
+
+    /// With GSO on (Linux UDP_SEGMENT), sendBatch passes each run of equal-length
+    /// datagrams (optionally ending in one shorter) as a single super-datagram
+    /// that the kernel or NIC splits back up. Returns false, leaving GSO off,
+    /// where unsupported; sendBatch also drops back to plain batches if the
+    /// kernel rejects a GSO send.
+    bool enableGso(bool on);
+    bool gsoEnabled() const { return gso_; }
 
 private:
     UdpMulticastSender();  // used by createUnicast
@@ -38,6 +58,7 @@ private:
 #endif
     struct SockAddr;
     SockAddr* dest_;
+    bool gso_ = false;
 };
 
 }  // namespace itch
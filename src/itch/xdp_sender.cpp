@@ -0,0 +1,305 @@
+#ifdef QRSDP_XDP_ENABLED
+
+#include "itch/xdp_sender.h"
+
+#include <arpa/inet.h>
+#include <linux/if_xdp.h>
+#include <net/if.h>
+#include <netinet/in.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace qrsdp {
+namespace itch {
+
+namespace {
+
+constexpr uint32_t kFrameSize = 2048;  // one UMEM chunk per packet
+constexpr uint32_t kFillRingSize = 64; // required by bind, unused for TX only
+constexpr size_t   kEthBytes = 14;
+constexpr size_t   kIpBytes = 20;
+constexpr size_t   kUdpBytes = 8;
+constexpr size_t   kHeaderBytes = kEthBytes + kIpBytes + kUdpBytes;
+constexpr uint32_t kStallLimit = 1u << 20;  // empty polls before sendBatch gives up
+
+std::runtime_error xdpError(const std::string& what) {
+    return std::runtime_error("XdpSender: " + what + ": " + std::strerror(errno));
+}
+
+/// One mmap'd AF_XDP ring. The side we own (producer of TX, consumer of the
+/// completion ring) is cached locally and published with a release store.
+struct Ring {
+    uint32_t* producer = nullptr;
+    uint32_t* consumer = nullptr;
+    uint32_t* flags = nullptr;
+    void*     desc = nullptr;
+    uint32_t  size = 0;
+    void*     map = nullptr;
+    size_t    map_len = 0;
+
+    void mapFrom(int fd, const xdp_ring_offset& off, uint32_t n, size_t entry_bytes, uint64_t pgoff) {
+        map_len = off.desc + size_t{n} * entry_bytes;
+        map = mmap(nullptr, map_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd,
+                   static_cast<off_t>(pgoff));
+        if (map == MAP_FAILED) {
+            map = nullptr;
+            throw xdpError("cannot map ring");
+        }
+        char* base = static_cast<char*>(map);
+        producer = reinterpret_cast<uint32_t*>(base + off.producer);
+        consumer = reinterpret_cast<uint32_t*>(base + off.consumer);
+        flags = reinterpret_cast<uint32_t*>(base + off.flags);
+        desc = base + off.desc;
+        size = n;
+    }
+
+    ~Ring() {
+        if (map) munmap(map, map_len);
+    }
+};
+
+uint16_t ipChecksum(const uint8_t* hdr) {
+    uint32_t sum = 0;
+    for (size_t i = 0; i < kIpBytes; i += 2)
+        sum += static_cast<uint32_t>(hdr[i] << 8 | hdr[i + 1]);
+    while (sum >> 16)
+        sum = (sum & 0xFFFF) + (sum >> 16);
+    return static_cast<uint16_t>(~sum);
+}
+
+void storeBe16(uint8_t* p, uint16_t v) {
+    p[0] = static_cast<uint8_t>(v >> 8);
+    p[1] = static_cast<uint8_t>(v);
+}
+
+bool parseMac(const std::string& s, uint8_t out[6]) {
+    unsigned b[6];
+    if (std::sscanf(s.c_str(), "%x:%x:%x:%x:%x:%x", &b[0], &b[1], &b[2], &b[3], &b[4], &b[5]) != 6)
+        return false;
+    for (int i = 0; i < 6; ++i) {
+        if (b[i] > 0xFF) return false;
+        out[i] = static_cast<uint8_t>(b[i]);
+    }
+    return true;
+}
+
+/// Reads the interface's MAC and IPv4 address with the classic ioctls.
+void interfaceAddresses(const std::string& ifname, uint8_t mac[6], in_addr& ip) {
+    const int s = socket(AF_INET, SOCK_DGRAM, 0);
+    if (s < 0)
+        throw xdpError("socket() failed");
+    ifreq req{};
+    std::strncpy(req.ifr_name, ifname.c_str(), IFNAMSIZ - 1);
+    if (ioctl(s, SIOCGIFHWADDR, &req) != 0) {
+        close(s);
+        throw xdpError("cannot read MAC of " + ifname);
+    }
+    std::memcpy(mac, req.ifr_hwaddr.sa_data, 6);
+    const bool have_ip = ioctl(s, SIOCGIFADDR, &req) == 0;
+    close(s);
+    if (have_ip)
+        ip = reinterpret_cast<const sockaddr_in*>(&req.ifr_addr)->sin_addr;
+    else
+        ip.s_addr = 0;
+}
+
+}  // namespace
+
+struct XdpSender::Impl {
+    int fd = -1;
+    void* umem = nullptr;
+    size_t umem_len = 0;
+    Ring fill;
+    Ring completion;
+    Ring tx;
+    std::vector<uint64_t> free_frames;
+    uint8_t header[kHeaderBytes] = {};
+    uint16_t ip_id = 0;
+
+    ~Impl() {
+        if (fd >= 0) close(fd);
+        std::free(umem);
+    }
+
+    uint8_t* frame(uint64_t addr) { return static_cast<uint8_t*>(umem) + addr; }
+
+    /// Returns frames the NIC has finished with to the free list.
+    void reclaim() {
+        const uint32_t cons = *completion.consumer;
+        const uint32_t prod = __atomic_load_n(completion.producer, __ATOMIC_ACQUIRE);
+        const auto* addrs = static_cast<const uint64_t*>(completion.desc);
+        for (uint32_t i = cons; i != prod; ++i)
+            free_frames.push_back(addrs[i & (completion.size - 1)]);
+        __atomic_store_n(completion.consumer, prod, __ATOMIC_RELEASE);
+    }
+
+    /// Asks the driver to process the TX ring if it has gone to sleep.
+    void kick() {
+        if (!(__atomic_load_n(tx.flags, __ATOMIC_ACQUIRE) & XDP_RING_NEED_WAKEUP))
+            return;
+        if (sendto(fd, nullptr, 0, MSG_DONTWAIT, nullptr, 0) < 0
+            && errno != EAGAIN && errno != EBUSY && errno != ENOBUFS && errno != ENETDOWN)
+            std::fprintf(stderr, "XdpSender: TX wakeup failed: %s\n", std::strerror(errno));
+    }
+
+    /// Headers from the template with this datagram's lengths, id and checksum.
+    void writeFrame(uint8_t* f, const Datagram& d) {
+        std::memcpy(f, header, kHeaderBytes);
+        uint8_t* ip = f + kEthBytes;
+        storeBe16(ip + 2, static_cast<uint16_t>(kIpBytes + kUdpBytes + d.len));
+        storeBe16(ip + 4, ip_id++);
+        storeBe16(ip + 10, ipChecksum(ip));
+        storeBe16(ip + kIpBytes + 4, static_cast<uint16_t>(kUdpBytes + d.len));
+        std::memcpy(f + kHeaderBytes, d.data, d.len);
+    }
+};
+
+XdpSender::XdpSender(const XdpConfig& config, const std::string& dest_ip, uint16_t dest_port,
+                     uint8_t ttl)
+    : impl_(std::make_unique<Impl>())
+{
+    const uint32_t frames = config.frame_count;
+    if (frames == 0 || (frames & (frames - 1)) != 0)
+        throw std::runtime_error("XdpSender: frame_count must be a power of two");
+    const unsigned ifindex = if_nametoindex(config.interface.c_str());
+    if (ifindex == 0)
+        throw xdpError("unknown interface " + config.interface);
+
+    // --- Ethernet / IPv4 / UDP header template ---
+    in_addr dst{}, src{};
+    if (inet_pton(AF_INET, dest_ip.c_str(), &dst) != 1)
+        throw std::runtime_error("XdpSender: destination must be an IPv4 address: " + dest_ip);
+    uint8_t src_mac[6], dst_mac[6];
+    interfaceAddresses(config.interface, src_mac, src);
+    if (!config.src_ip.empty() && inet_pton(AF_INET, config.src_ip.c_str(), &src) != 1)
+        throw std::runtime_error("XdpSender: bad source address " + config.src_ip);
+    const uint32_t dst_host = ntohl(dst.s_addr);
+    if (!config.dst_mac.empty()) {
+        if (!parseMac(config.dst_mac, dst_mac))
+            throw std::runtime_error("XdpSender: bad destination MAC " + config.dst_mac);
+    } else if ((dst_host >> 28) == 0xE) {
+        // RFC 1112: 01:00:5e + the low 23 bits of the group address
+        const uint8_t mcast[6] = {0x01, 0x00, 0x5e, static_cast<uint8_t>((dst_host >> 16) & 0x7F),
+                                  static_cast<uint8_t>(dst_host >> 8), static_cast<uint8_t>(dst_host)};
+        std::memcpy(dst_mac, mcast, 6);
+    } else {
+        throw std::runtime_error("XdpSender: unicast " + dest_ip + " needs a destination MAC");
+    }
+
+    uint8_t* h = impl_->header;
+    std::memcpy(h, dst_mac, 6);
+    std::memcpy(h + 6, src_mac, 6);
+    storeBe16(h + 12, 0x0800);  // IPv4
+    uint8_t* ip = h + kEthBytes;
+    ip[0] = 0x45;               // version 4, 5-word header
+    storeBe16(ip + 6, 0x4000);  // don't fragment
+    ip[8] = ttl;
+    ip[9] = IPPROTO_UDP;
+    std::memcpy(ip + 12, &src.s_addr, 4);
+    std::memcpy(ip + 16, &dst.s_addr, 4);
+    uint8_t* udp = ip + kIpBytes;
+    storeBe16(udp, config.src_port);
+    storeBe16(udp + 2, dest_port);  // UDP checksum stays 0 (optional over IPv4)
+
+    // --- UMEM and rings ---
+    const size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    impl_->umem_len = (size_t{frames} * kFrameSize + page - 1) / page * page;
+    impl_->umem = std::aligned_alloc(page, impl_->umem_len);
+    if (!impl_->umem)
+        throw std::runtime_error("XdpSender: cannot allocate UMEM");
+    impl_->free_frames.reserve(frames);
+    for (uint32_t i = frames; i-- > 0;)
+        impl_->free_frames.push_back(uint64_t{i} * kFrameSize);
+
+    const int fd = impl_->fd = socket(AF_XDP, SOCK_RAW, 0);
+    if (fd < 0)
+        throw xdpError("cannot create AF_XDP socket (needs CAP_NET_RAW)");
+    xdp_umem_reg reg{};
+    reg.addr = reinterpret_cast<uint64_t>(impl_->umem);
+    reg.len = impl_->umem_len;
+    reg.chunk_size = kFrameSize;
+    if (setsockopt(fd, SOL_XDP, XDP_UMEM_REG, &reg, sizeof(reg)) != 0)
+        throw xdpError("cannot register UMEM");
+    const uint32_t fill_size = kFillRingSize;
+    if (setsockopt(fd, SOL_XDP, XDP_UMEM_FILL_RING, &fill_size, sizeof(fill_size)) != 0
+        || setsockopt(fd, SOL_XDP, XDP_UMEM_COMPLETION_RING, &frames, sizeof(frames)) != 0
+        || setsockopt(fd, SOL_XDP, XDP_TX_RING, &frames, sizeof(frames)) != 0)
+        throw xdpError("cannot size rings");
+
+    xdp_mmap_offsets off{};
+    socklen_t off_len = sizeof(off);
+    if (getsockopt(fd, SOL_XDP, XDP_MMAP_OFFSETS, &off, &off_len) != 0)
+        throw xdpError("cannot read ring offsets");
+    impl_->fill.mapFrom(fd, off.fr, fill_size, sizeof(uint64_t), XDP_UMEM_PGOFF_FILL_RING);
+    impl_->completion.mapFrom(fd, off.cr, frames, sizeof(uint64_t), XDP_UMEM_PGOFF_COMPLETION_RING);
+    impl_->tx.mapFrom(fd, off.tx, frames, sizeof(xdp_desc), XDP_PGOFF_TX_RING);
+
+    sockaddr_xdp addr{};
+    addr.sxdp_family = AF_XDP;
+    addr.sxdp_ifindex = ifindex;
+    addr.sxdp_queue_id = config.queue_id;
+    addr.sxdp_flags = XDP_USE_NEED_WAKEUP | (config.zero_copy ? XDP_ZEROCOPY : 0);
+    if (bind(fd, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) != 0)
+        throw xdpError("cannot bind to " + config.interface + " queue " + std::to_string(config.queue_id));
+}
+
+XdpSender::~XdpSender() = default;
+
+bool XdpSender::send(const uint8_t* data, size_t len) {
+    const Datagram d{data, len};
+    return sendBatch(&d, 1) == 1;
+}
+
+size_t XdpSender::sendBatch(const Datagram* packets, size_t n) {
+    Impl& x = *impl_;
+    size_t sent = 0;
+    uint32_t stalls = 0;
+    while (sent < n) {
+        x.reclaim();
+        const uint32_t prod = *x.tx.producer;
+        const uint32_t room = x.tx.size - (prod - __atomic_load_n(x.tx.consumer, __ATOMIC_ACQUIRE));
+        auto* descs = static_cast<xdp_desc*>(x.tx.desc);
+        uint32_t k = 0;
+        for (; sent + k < n && k < room && !x.free_frames.empty(); ++k) {
+            const Datagram& d = packets[sent + k];
+            if (d.len > kFrameSize - kHeaderBytes) {
+                std::fprintf(stderr, "XdpSender: %zu-byte datagram exceeds a frame\n", d.len);
+                break;
+            }
+            const uint64_t frame = x.free_frames.back();
+            x.free_frames.pop_back();
+            x.writeFrame(x.frame(frame), d);
+            xdp_desc& desc = descs[(prod + k) & (x.tx.size - 1)];
+            desc.addr = frame;
+            desc.len = static_cast<uint32_t>(kHeaderBytes + d.len);
+            desc.options = 0;
+        }
+        if (k > 0) {
+            __atomic_store_n(x.tx.producer, prod + k, __ATOMIC_RELEASE);
+            sent += k;
+            stalls = 0;
+        } else if (sent < n && packets[sent].len > kFrameSize - kHeaderBytes) {
+            break;
+        } else if (++stalls > kStallLimit) {
+            std::fprintf(stderr, "XdpSender: TX ring stalled\n");
+            break;
+        }
+        x.kick();
+    }
+    return sent;
+}
+
+}  // namespace itch
+}  // namespace qrsdp
+
+#endif  // QRSDP_XDP_ENABLED
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "itch/i_datagram_sender.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace qrsdp {
+namespace itch {
+
+/// Settings for the AF_XDP transmit backend. An empty interface means the
+/// default socket backend.
+struct XdpConfig {
+    std::string interface;            // NIC to transmit on, e.g. "eth0"
+    uint32_t    queue_id    = 0;      // NIC TX queue the socket binds to
+    std::string src_ip;               // empty = the interface's IPv4 address
+    std::string dst_mac;              // "aa:bb:cc:dd:ee:ff"; empty = the group's multicast MAC
+    uint16_t    src_port    = 5000;
+    uint32_t    frame_count = 4096;   // UMEM frames, also the TX ring size (power of two)
+    bool        zero_copy   = false;  // require driver zero-copy instead of letting the kernel pick
+};
+
+#ifdef QRSDP_XDP_ENABLED
+
+/// Kernel-bypass transmit over an AF_XDP socket (Linux, BUILD_XDP_SUPPORT).
+///
+/// Each datagram is written with its Ethernet/IPv4/UDP headers into a frame of
+/// a preallocated UMEM region and posted on the TX ring; completed frames are
+/// recycled from the completion ring. TX only, so no XDP program is loaded.
+/// Needs CAP_NET_RAW. Not thread-safe: one sender per thread (and per queue).
+class XdpSender final : public IDatagramSender {
+public:
+    /// @param dest_ip    IPv4 destination; a multicast group unless config.dst_mac is set.
+    /// @param dest_port  UDP destination port.
+    /// @param ttl        IP TTL.
+    /// Throws std::runtime_error if the socket, UMEM or rings cannot be set up.
+    XdpSender(const XdpConfig& config, const std::string& dest_ip, uint16_t dest_port,
+              uint8_t ttl = 1);
+    ~XdpSender() override;
+
+    XdpSender(const XdpSender&) = delete;
+    XdpSender& operator=(const XdpSender&) = delete;
+
+    bool send(const uint8_t* data, size_t len) override;
+    size_t sendBatch(const Datagram* packets, size_t n) override;
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
+#endif  // QRSDP_XDP_ENABLED
+
+}  // namespace itch
+}  // namespace qrsdp
@@ -24,6 +24,19 @@ static void printUsage(const char* prog) {
         "  --unicast-dest <h:p>  Send unicast to host:port instead of multicast\n"
         "  --port <n>            UDP port (default: 5001)\n"
         "  --tick-size <n>       Tick size in price-4 units (default: 100)\n"
+        "  --batch <n>           Packets per sendmmsg batch; 1 = one sendto each (default: 16)\n"
+        "  --flush-us <n>        Max microseconds a message waits before sending (default: 500)\n"
+        "  --gso                 Coalesce equal-size packets with UDP GSO (Linux)\n"
+        "  --xdp <ifname>        Transmit with AF_XDP on this interface (BUILD_XDP_SUPPORT)\n"
+        "  --xdp-queue <n>       NIC TX queue for --xdp (default: 0)\n"
+        "  --xdp-dst-mac <mac>   Destination MAC for --xdp (default: multicast MAC of the group)\n"
+        "  --xdp-zero-copy       Require driver zero-copy mode for --xdp\n"
+        "  --retransmit-port <n> Answer MoldUDP64 gap requests on this UDP port (default: off)\n"
+        "  --retransmit-packets <n> Packets kept for retransmission (default: 16384)\n"
+        "  --consume-batch <n>   Kafka messages taken per poll (default: 1024)\n"
+        "  --partition-threads   One reader thread per partition, merged by timestamp\n"
+        "  --merge-wait-us <n>   Longest the merge waits on an empty partition (default: 1000)\n"
+        "  --channels <spec>     Shard symbols over N sessions on port+c: N or N:SYM=c,... (default: 1)\n"
         "  --help                Show this help\n",
         prog);
 }
@@ -48,6 +61,24 @@ int main(int argc, char* argv[]) {
         else if (std::strcmp(arg, "--unicast-dest") == 0)  config.unicast_dest = next();
         else if (std::strcmp(arg, "--port") == 0)         config.port = static_cast<uint16_t>(std::atoi(next()));
         else if (std::strcmp(arg, "--tick-size") == 0)    config.tick_size = static_cast<uint32_t>(std::atoi(next()));
+        else if (std::strcmp(arg, "--batch") == 0)        config.batch_packets = static_cast<size_t>(std::atoi(next()));
+        else if (std::strcmp(arg, "--flush-us") == 0)     config.flush_deadline_us = static_cast<uint32_t>(std::atoi(next()));
+        else if (std::strcmp(arg, "--gso") == 0)          config.gso = true;
+        else if (std::strcmp(arg, "--xdp") == 0)          config.xdp.interface = next();
+        else if (std::strcmp(arg, "--xdp-queue") == 0)    config.xdp.queue_id = static_cast<uint32_t>(std::atoi(next()));
+        else if (std::strcmp(arg, "--xdp-dst-mac") == 0)  config.xdp.dst_mac = next();
+        else if (std::strcmp(arg, "--xdp-zero-copy") == 0) config.xdp.zero_copy = true;
+        else if (std::strcmp(arg, "--retransmit-port") == 0) config.retransmit_port = static_cast<uint16_t>(std::atoi(next()));
+        else if (std::strcmp(arg, "--retransmit-packets") == 0) config.retransmit_packets = static_cast<size_t>(std::atol(next()));
+        else if (std::strcmp(arg, "--consume-batch") == 0) config.consume_batch = static_cast<size_t>(std::atol(next()));
+        else if (std::strcmp(arg, "--partition-threads") == 0) config.partition_threads = true;
+        else if (std::strcmp(arg, "--merge-wait-us") == 0) config.merge_wait_us = static_cast<uint32_t>(std::atoi(next()));
+        else if (std::strcmp(arg, "--channels") == 0) {
+            if (!qrsdp::itch::parseChannelMap(next(), config.channels)) {
+                std::fprintf(stderr, "--channels expects N or N:SYM=c,... with 1 <= N <= 64\n");
+                return 1;
+            }
+        }
         else if (std::strcmp(arg, "--help") == 0 || std::strcmp(arg, "-h") == 0) {
             printUsage(argv[0]);
             return 0;
@@ -1,10 +1,19 @@
-#include "itch/itch_messages.h"
 #include "itch/endian.h"
+#include "itch/feed_stats.h"
+#include "itch/itch_decoder.h"
+#include "itch/itch_messages.h"
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstddef>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
 #include <string>
+#include <utility>
+#include <vector>
 
 #ifdef _WIN32
     #ifndef WIN32_LEAN_AND_MEAN
@@ -18,102 +27,257 @@
     #include <arpa/inet.h>
     #include <netinet/in.h>
     #include <sys/socket.h>
+    #include <sys/time.h>
+    #include <time.h>
     #include <unistd.h>
     using socket_t = int;
 #endif
 
+static std::atomic<bool> g_stop{false};
+
+static void signalHandler(int) { g_stop = true; }
+
 static void printUsage(const char* prog) {
     std::fprintf(stderr,
         "Usage: %s [options]\n"
         "  --multicast-group <s> Multicast address (default: 239.1.1.1)\n"
         "  --port <n>            UDP port (default: 5001)\n"
         "  --no-multicast        Skip multicast group join (for unicast reception)\n"
+        "  --retransmit <h:p>    Request sequence gaps from this MoldUDP64 retransmit server\n"
+        "  --stats               Decode without printing; report rates, gaps and latency\n"
+        "  --stats-interval <s>  Seconds between --stats reports (default: 1)\n"
         "  --help                Show this help\n",
         prog);
 }
 
-static void decodeItchMessage(const uint8_t* data, size_t len, uint64_t seq) {
-    using namespace qrsdp::itch;
+/// Prints one message per line, straight from the wire structs.
+struct MessagePrinter {
+    unsigned long long seq;
 
-    if (len < 1) return;
-    char msg_type = static_cast<char>(data[0]);
-
-    switch (msg_type) {
-    case kMsgTypeSystemEvent: {
-        if (len < sizeof(SystemEventMsg)) return;
-        auto* msg = reinterpret_cast<const SystemEventMsg*>(data);
-        uint64_t ts = load48be(msg->timestamp);
-        std::printf("[seq=%llu] SYSTEM_EVENT code=%c ts=%llu\n",
-                    static_cast<unsigned long long>(seq),
-                    msg->event_code,
-                    static_cast<unsigned long long>(ts));
-        break;
-    }
-    case kMsgTypeStockDirectory: {
-        if (len < sizeof(StockDirectoryMsg)) return;
-        auto* msg = reinterpret_cast<const StockDirectoryMsg*>(data);
-        char stock[9] = {};
-        std::memcpy(stock, msg->stock, 8);
-        uint64_t ts = load48be(msg->timestamp);
-        std::printf("[seq=%llu] STOCK_DIRECTORY stock=%.8s locate=%u ts=%llu\n",
-                    static_cast<unsigned long long>(seq),
-                    stock,
-                    betoh16(msg->stock_locate),
-                    static_cast<unsigned long long>(ts));
-        break;
-    }
-    case kMsgTypeAddOrder: {
-        if (len < sizeof(AddOrderMsg)) return;
-        auto* msg = reinterpret_cast<const AddOrderMsg*>(data);
-        char stock[9] = {};
-        std::memcpy(stock, msg->stock, 8);
-        uint64_t ts = load48be(msg->timestamp);
-        uint32_t price = betoh32(msg->price);
+    void operator()(const qrsdp::itch::SystemEventMsg& msg) const {
+        using namespace qrsdp::itch;
+        std::printf("[seq=%llu] SYSTEM_EVENT code=%c ts=%llu\n", seq, msg.event_code,
+                    static_cast<unsigned long long>(load48be(msg.timestamp)));
+    }
+    void operator()(const qrsdp::itch::StockDirectoryMsg& msg) const {
+        using namespace qrsdp::itch;
+        std::printf("[seq=%llu] STOCK_DIRECTORY stock=%.8s locate=%u ts=%llu\n", seq, msg.stock,
+                    betoh16(msg.stock_locate),
+                    static_cast<unsigned long long>(load48be(msg.timestamp)));
+    }
+    void operator()(const qrsdp::itch::AddOrderMsg& msg) const {
+        using namespace qrsdp::itch;
+        const uint32_t price = betoh32(msg.price);
         std::printf("[seq=%llu] ADD_ORDER ref=%llu side=%c shares=%u stock=%.8s price=%u.%04u ts=%llu\n",
-                    static_cast<unsigned long long>(seq),
-                    static_cast<unsigned long long>(betoh64(msg->order_reference)),
-                    msg->buy_sell,
-                    betoh32(msg->shares),
-                    stock,
-                    price / 10000, price % 10000,
-                    static_cast<unsigned long long>(ts));
-        break;
-    }
-    case kMsgTypeOrderDelete: {
-        if (len < sizeof(OrderDeleteMsg)) return;
-        auto* msg = reinterpret_cast<const OrderDeleteMsg*>(data);
-        uint64_t ts = load48be(msg->timestamp);
-        std::printf("[seq=%llu] ORDER_DELETE ref=%llu ts=%llu\n",
-                    static_cast<unsigned long long>(seq),
-                    static_cast<unsigned long long>(betoh64(msg->order_reference)),
-                    static_cast<unsigned long long>(ts));
-        break;
-    }
-    case kMsgTypeOrderExecuted: {
-        if (len < sizeof(OrderExecutedMsg)) return;
-        auto* msg = reinterpret_cast<const OrderExecutedMsg*>(data);
-        uint64_t ts = load48be(msg->timestamp);
-        std::printf("[seq=%llu] ORDER_EXECUTED ref=%llu shares=%u match=%llu ts=%llu\n",
-                    static_cast<unsigned long long>(seq),
-                    static_cast<unsigned long long>(betoh64(msg->order_reference)),
-                    betoh32(msg->executed_shares),
-                    static_cast<unsigned long long>(betoh64(msg->match_number)),
-                    static_cast<unsigned long long>(ts));
-        break;
-    }
-    default:
+                    seq, static_cast<unsigned long long>(betoh64(msg.order_reference)),
+                    msg.buy_sell, betoh32(msg.shares), msg.stock, price / 10000, price % 10000,
+                    static_cast<unsigned long long>(load48be(msg.timestamp)));
+    }
+    void operator()(const qrsdp::itch::OrderDeleteMsg& msg) const {
+        using namespace qrsdp::itch;
+        std::printf("[seq=%llu] ORDER_DELETE ref=%llu ts=%llu\n", seq,
+                    static_cast<unsigned long long>(betoh64(msg.order_reference)),
+                    static_cast<unsigned long long>(load48be(msg.timestamp)));
+    }
+    void operator()(const qrsdp::itch::OrderExecutedMsg& msg) const {
+        using namespace qrsdp::itch;
+        std::printf("[seq=%llu] ORDER_EXECUTED ref=%llu shares=%u match=%llu ts=%llu\n", seq,
+                    static_cast<unsigned long long>(betoh64(msg.order_reference)),
+                    betoh32(msg.executed_shares),
+                    static_cast<unsigned long long>(betoh64(msg.match_number)),
+                    static_cast<unsigned long long>(load48be(msg.timestamp)));
+    }
+    void operator()(const qrsdp::itch::EndOfSnapshotMsg& msg) const {
+        using namespace qrsdp::itch;
+        std::printf("[seq=%llu] END_OF_SNAPSHOT locate=%u feed_seq=%llu ts=%llu\n", seq,
+                    betoh16(msg.stock_locate),
+                    static_cast<unsigned long long>(betoh64(msg.sequence_number)),
+                    static_cast<unsigned long long>(load48be(msg.timestamp)));
+    }
+};
+
+static void printItchMessage(const uint8_t* data, size_t len, uint64_t seq) {
+    if (len < 1) return;
+    if (!qrsdp::itch::visitItchMessage(data, len, MessagePrinter{static_cast<unsigned long long>(seq)}))
         std::printf("[seq=%llu] UNKNOWN type=%c len=%zu\n",
-                    static_cast<unsigned long long>(seq),
-                    msg_type,
-                    len);
-        break;
+                    static_cast<unsigned long long>(seq), static_cast<char>(data[0]), len);
+}
+
+static void printLatency(const qrsdp::itch::LatencyHistogram& h) {
+    if (h.count() == 0) {
+        std::printf("  latency n/a\n");
+        return;
     }
+    std::printf("  rx->decoded p50=%.1fus p99=%.1fus p99.9=%.1fus max=%.1fus\n",
+                static_cast<double>(h.percentile(0.50)) / 1e3,
+                static_cast<double>(h.percentile(0.99)) / 1e3,
+                static_cast<double>(h.percentile(0.999)) / 1e3,
+                static_cast<double>(h.max()) / 1e3);
+}
+
+/// --stats: receives in batches (recvmmsg on Linux), decodes every message
+/// with the zero-copy visitor and prints one summary line per interval. On
+/// Linux latency is from the kernel receive timestamp (SO_TIMESTAMPNS) to the
+/// end of decoding the packet, so it includes time queued in the socket.
+static void runStats(socket_t sock, double interval_s) {
+    using namespace qrsdp::itch;
+    using Clock = std::chrono::steady_clock;
+
+    int rcvbuf = 16 << 20;  // best effort: absorb bursts while we are between reads
+    setsockopt(sock, SOL_SOCKET, SO_RCVBUF, reinterpret_cast<const char*>(&rcvbuf), sizeof(rcvbuf));
+#ifdef _WIN32
+    DWORD timeout_ms = 100;
+    setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, reinterpret_cast<const char*>(&timeout_ms), sizeof(timeout_ms));
+#else
+    struct timeval tv { 0, 100000 };
+    setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, reinterpret_cast<const char*>(&tv), sizeof(tv));
+#endif
+
+    FeedStats stats;
+    LatencyHistogram interval_latency;
+    FeedCounters last{};
+    const auto interval = std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(std::max(interval_s, 0.01)));
+    const auto start = Clock::now();
+    auto last_report = start;
+
+    auto report = [&](const Clock::time_point now) {
+        const FeedCounters& c = stats.counters();
+        const double dt = std::chrono::duration<double>(now - last_report).count();
+        std::printf("[stats] %.0fs msgs/s=%.0f pkts/s=%.0f MB/s=%.2f gaps=%llu missing=%llu dup=%llu bad=%llu\n",
+                    std::chrono::duration<double>(now - start).count(),
+                    static_cast<double>(c.messages - last.messages) / dt,
+                    static_cast<double>(c.packets - last.packets) / dt,
+                    static_cast<double>(c.bytes - last.bytes) / dt / 1e6,
+                    static_cast<unsigned long long>(c.gaps - last.gaps),
+                    static_cast<unsigned long long>(c.missing - last.missing),
+                    static_cast<unsigned long long>(c.duplicates - last.duplicates),
+                    static_cast<unsigned long long>(c.malformed - last.malformed));
+        printLatency(interval_latency);
+        std::fflush(stdout);
+        interval_latency.reset();
+        last = c;
+        last_report = now;
+    };
+
+#if defined(__linux__)
+    int on = 1;
+    const bool timestamps = setsockopt(sock, SOL_SOCKET, SO_TIMESTAMPNS, &on, sizeof(on)) == 0;
+    constexpr unsigned kBatch = 64;
+    constexpr size_t kPacketBytes = 2048;
+    std::vector<uint8_t> bufs(kBatch * kPacketBytes);
+    std::vector<char> ctrl(kBatch * CMSG_SPACE(sizeof(struct timespec)));
+    struct iovec iov[kBatch];
+    struct mmsghdr msgs[kBatch];
+    while (!g_stop) {
+        for (unsigned i = 0; i < kBatch; ++i) {
+            iov[i].iov_base = bufs.data() + i * kPacketBytes;
+            iov[i].iov_len = kPacketBytes;
+            msgs[i] = mmsghdr{};
+            msgs[i].msg_hdr.msg_iov = &iov[i];
+            msgs[i].msg_hdr.msg_iovlen = 1;
+            if (timestamps) {
+                msgs[i].msg_hdr.msg_control = ctrl.data() + i * CMSG_SPACE(sizeof(struct timespec));
+                msgs[i].msg_hdr.msg_controllen = CMSG_SPACE(sizeof(struct timespec));
+            }
+        }
+        const int n = recvmmsg(sock, msgs, kBatch, MSG_WAITFORONE, nullptr);
+        for (int i = 0; i < n; ++i) {
+            stats.onPacket(bufs.data() + static_cast<size_t>(i) * kPacketBytes, msgs[i].msg_len);
+            for (struct cmsghdr* cm = CMSG_FIRSTHDR(&msgs[i].msg_hdr); cm;
+                 cm = CMSG_NXTHDR(&msgs[i].msg_hdr, cm)) {
+                if (cm->cmsg_level != SOL_SOCKET || cm->cmsg_type != SCM_TIMESTAMPNS)
+                    continue;
+                struct timespec rx;
+                struct timespec now;
+                std::memcpy(&rx, CMSG_DATA(cm), sizeof(rx));
+                clock_gettime(CLOCK_REALTIME, &now);
+                const int64_t ns = (static_cast<int64_t>(now.tv_sec) - rx.tv_sec) * 1000000000
+                                 + (now.tv_nsec - rx.tv_nsec);
+                if (ns >= 0) {
+                    stats.latency().record(static_cast<uint64_t>(ns));
+                    interval_latency.record(static_cast<uint64_t>(ns));
+                }
+            }
+        }
+        const auto now = Clock::now();
+        if (now - last_report >= interval)
+            report(now);
+    }
+#else
+    uint8_t buf[2048];
+    while (!g_stop) {
+        const auto n = recv(sock, reinterpret_cast<char*>(buf), sizeof(buf), 0);
+        if (n > 0)
+            stats.onPacket(buf, static_cast<size_t>(n));
+        const auto now = Clock::now();
+        if (now - last_report >= interval)
+            report(now);
+    }
+#endif
+
+    const FeedCounters& c = stats.counters();
+    const double secs = std::chrono::duration<double>(Clock::now() - start).count();
+    std::printf("[stats] total %.1fs: %llu messages (%.0f/s) in %llu packets, %llu gaps (%llu missing), "
+                "%llu duplicates, %llu malformed\n",
+                secs, static_cast<unsigned long long>(c.messages),
+                static_cast<double>(c.messages) / std::max(secs, 1e-9),
+                static_cast<unsigned long long>(c.packets), static_cast<unsigned long long>(c.gaps),
+                static_cast<unsigned long long>(c.missing), static_cast<unsigned long long>(c.duplicates),
+                static_cast<unsigned long long>(c.malformed));
+    std::printf("  adds=%llu deletes=%llu executions=%llu system=%llu directory=%llu\n",
+                static_cast<unsigned long long>(c.adds), static_cast<unsigned long long>(c.deletes),
+                static_cast<unsigned long long>(c.executions),
+                static_cast<unsigned long long>(c.system_events),
+                static_cast<unsigned long long>(c.directory));
+    printLatency(stats.latency());
+}
+
+/// Sequence ranges [first, end) seen missing and requested, oldest first.
+using GapList = std::vector<std::pair<uint64_t, uint64_t>>;
+
+/// True if seq fills a gap (which is then trimmed or split), false for a
+/// duplicate of something already printed.
+static bool takeFromGap(GapList& gaps, uint64_t seq) {
+    for (size_t g = 0; g < gaps.size(); ++g) {
+        auto& [first, end] = gaps[g];
+        if (seq < first || seq >= end) continue;
+        if (seq == first) {
+            ++first;
+        } else if (seq + 1 == end) {
+            --end;
+        } else {
+            const std::pair<uint64_t, uint64_t> tail{seq + 1, end};
+            end = seq;
+            gaps.insert(gaps.begin() + static_cast<std::ptrdiff_t>(g) + 1, tail);
+        }
+        if (gaps[g].first == gaps[g].second)
+            gaps.erase(gaps.begin() + static_cast<std::ptrdiff_t>(g));
+        return true;
+    }
+    return false;
+}
+
+static void sendRequest(socket_t sock, const struct sockaddr_in& server, const char* session,
+                        uint64_t first, uint64_t end) {
+    using namespace qrsdp::itch;
+    MoldUDP64Header req{};
+    std::memcpy(req.session, session, sizeof(req.session));
+    req.sequence_number = htobe64(first);
+    req.message_count = htobe16(static_cast<uint16_t>(std::min<uint64_t>(end - first, 0xFFFF)));
+    sendto(sock, reinterpret_cast<const char*>(&req), static_cast<int>(sizeof(req)), 0,
+           reinterpret_cast<const struct sockaddr*>(&server), sizeof(server));
+    std::printf("[gap] requesting seq %llu..%llu\n", static_cast<unsigned long long>(first),
+                static_cast<unsigned long long>(end - 1));
 }
 
 int main(int argc, char* argv[]) {
     std::string group = "239.1.1.1";
     uint16_t port = 5001;
     bool join_multicast = true;
+    std::string retransmit;
+    bool stats = false;
+    double stats_interval = 1.0;
 
     for (int i = 1; i < argc; ++i) {
         const char* arg = argv[i];
@@ -128,6 +292,9 @@ int main(int argc, char* argv[]) {
         if (std::strcmp(arg, "--multicast-group") == 0) group = next();
         else if (std::strcmp(arg, "--port") == 0) port = static_cast<uint16_t>(std::atoi(next()));
         else if (std::strcmp(arg, "--no-multicast") == 0) join_multicast = false;
+        else if (std::strcmp(arg, "--retransmit") == 0) retransmit = next();
+        else if (std::strcmp(arg, "--stats") == 0) stats = true;
+        else if (std::strcmp(arg, "--stats-interval") == 0) stats_interval = std::atof(next());
         else if (std::strcmp(arg, "--help") == 0 || std::strcmp(arg, "-h") == 0) {
             printUsage(argv[0]);
             return 0;
@@ -173,8 +340,36 @@ int main(int argc, char* argv[]) {
     else
         std::printf("Listening on unicast 0.0.0.0:%u\n", port);
 
+    if (stats) {
+        std::signal(SIGINT, signalHandler);
+        std::signal(SIGTERM, signalHandler);
+        runStats(sock, stats_interval);
+#ifdef _WIN32
+        closesocket(sock);
+        WSACleanup();
+#else
+        close(sock);
+#endif
+        return 0;
+    }
+
+    struct sockaddr_in server{};
+    if (!retransmit.empty()) {
+        const auto colon = retransmit.rfind(':');
+        server.sin_family = AF_INET;
+        if (colon == std::string::npos
+            || inet_pton(AF_INET, retransmit.substr(0, colon).c_str(), &server.sin_addr) != 1) {
+            std::fprintf(stderr, "--retransmit expects ipv4:port\n");
+            return 1;
+        }
+        server.sin_port = htons(static_cast<uint16_t>(std::atoi(retransmit.c_str() + colon + 1)));
+        std::printf("Requesting gaps from %s\n", retransmit.c_str());
+    }
+
     uint8_t buf[2048];
     using namespace qrsdp::itch;
+    uint64_t expected = 0;  // next new sequence number; 0 until the first packet
+    GapList gaps;
 
     while (true) {
         auto n = recv(sock, reinterpret_cast<char*>(buf), sizeof(buf), 0);
@@ -186,6 +381,14 @@ int main(int argc, char* argv[]) {
         uint64_t seq = betoh64(hdr.sequence_number);
         uint16_t count = betoh16(hdr.message_count);
 
+        const bool recovering = !retransmit.empty();
+        const size_t gaps_before = gaps.size();
+        const uint64_t front_before = gaps.empty() ? 0 : gaps.front().first;
+        if (recovering && expected != 0 && seq > expected) {
+            gaps.emplace_back(expected, seq);
+            sendRequest(sock, server, hdr.session, expected, seq);
+        }
+
         size_t offset = kMoldUDP64HeaderSize;
         for (uint16_t i = 0; i < count; ++i) {
             if (offset + 2 > static_cast<size_t>(n))
@@ -198,9 +401,16 @@ int main(int argc, char* argv[]) {
             if (offset + msg_len > static_cast<size_t>(n))
                 break;
 
-            decodeItchMessage(buf + offset, msg_len, seq + i);
+            if (!recovering || seq + i >= expected || takeFromGap(gaps, seq + i))
+                printItchMessage(buf + offset, msg_len, seq + i);
             offset += msg_len;
         }
+        expected = std::max(expected, seq + count);
+
+        // A response holds at most one packet's worth: ask for the rest.
+        if (recovering && !gaps.empty() && gaps.size() <= gaps_before
+            && gaps.front().first != front_before)
+            sendRequest(sock, server, hdr.session, gaps.front().first, gaps.front().second);
     }
 
 #ifdef _WIN32
@@ -1,10 +1,18 @@
+#include "io/book_replayer.h"
 #include "io/event_log_reader.h"
 #include "io/event_log_format.h"
+#include "io/run_catalog.h"
+#include "io/session_container.h"
 #include "core/event_types.h"
+#include "rng/rng_factory.h"
 
+#include <chrono>
 #include <cstdio>
 #include <cstdlib>
+#include <exception>
+#include <memory>
 #include <string>
+#include <vector>
 
 static const char* eventTypeName(uint8_t t) {
     switch (t) {
@@ -30,8 +38,13 @@ static void printHeader(const qrsdp::FileHeader& h) {
     std::printf("  initial_spread:      %u ticks\n", h.initial_spread_ticks);
     std::printf("  initial_depth:       %u\n", h.initial_depth);
     std::printf("  chunk_capacity:      %u\n", h.chunk_capacity);
+    std::printf("  rng:                 %s\n",
+                qrsdp::rngAlgorithmName(static_cast<qrsdp::RngAlgorithm>(
+                    (h.header_flags & qrsdp::kHeaderRngMask) >> qrsdp::kHeaderRngShift)));
     std::printf("  has_index:           %s\n",
                 (h.header_flags & qrsdp::kHeaderFlagHasIndex) ? "yes" : "no");
+    std::printf("  chunk_checksums:     %s\n",
+                (h.header_flags & qrsdp::kHeaderFlagChunkChecksums) ? "crc32c" : "no");
 }
 
 static void printSummary(const qrsdp::EventLogReader& reader) {
@@ -54,19 +67,27 @@ static void printSummary(const qrsdp::EventLogReader& reader) {
     std::printf("  raw_size:            %.2f MB\n", static_cast<double>(raw_bytes) / (1024.0 * 1024.0));
 }
 
+/// Counts from the footer's stats block when the file has one; otherwise every
+/// chunk is decoded.
 static void printEventDistribution(const qrsdp::EventLogReader& reader) {
     uint64_t counts[6] = {};
     uint64_t total = 0;
 
-    for (uint32_t i = 0; i < reader.chunkCount(); ++i) {
-        auto chunk = reader.readChunk(i);
-        for (const auto& r : chunk) {
+    const bool from_stats = reader.hasStats();
+    if (from_stats) {
+        const qrsdp::LogStats stats = reader.stats();
+        for (int t = 0; t < 6; ++t) {
+            counts[t] = stats.type_counts[t];
+            total += counts[t];
+        }
+    } else {
+        reader.forEachRecord([&](const qrsdp::DiskEventRecord& r) {
             if (r.type < 6) counts[r.type]++;
             total++;
-        }
+        });
     }
 
-    std::printf("\n=== Event Distribution ===\n");
+    std::printf("\n=== Event Distribution%s ===\n", from_stats ? " (footer stats)" : "");
     for (int t = 0; t < 6; ++t) {
         double pct = total > 0 ? 100.0 * static_cast<double>(counts[t]) / static_cast<double>(total) : 0.0;
         std::printf("  %-14s %10llu  (%5.1f%%)\n",
@@ -75,14 +96,27 @@ static void printEventDistribution(const qrsdp::EventLogReader& reader) {
     }
 }
 
+static void printStats(const qrsdp::EventLogReader& reader) {
+    if (!reader.hasStats())
+        return;
+    const qrsdp::LogStats stats = reader.stats();
+    std::printf("\n=== Footer Stats ===\n");
+    std::printf("  price_range:         %d – %d ticks\n", stats.min_price_ticks, stats.max_price_ticks);
+    std::printf("  executed_qty:        %llu\n", (unsigned long long)stats.executed_qty);
+    std::printf("  shifts_up:           %llu\n", (unsigned long long)stats.shifts_up);
+    std::printf("  shifts_down:         %llu\n", (unsigned long long)stats.shifts_down);
+    std::printf("  reinits:             %llu\n", (unsigned long long)stats.reinits);
+}
+
 static void printFirstN(const qrsdp::EventLogReader& reader, int n) {
     std::printf("\n=== First %d Records ===\n", n);
     std::printf("  %-18s %-14s %-5s %-12s %-6s %-10s\n",
                 "ts_ns", "type", "side", "price_ticks", "qty", "order_id");
 
     int printed = 0;
+    std::vector<qrsdp::DiskEventRecord> scratch;
     for (uint32_t c = 0; c < reader.chunkCount() && printed < n; ++c) {
-        auto chunk = reader.readChunk(c);
+        const qrsdp::RecordSpan chunk = reader.chunkRecords(c, scratch);
         for (const auto& r : chunk) {
             if (printed >= n) break;
             std::printf("  %-18llu %-14s %-5u %-12d %-6u %-10llu\n",
@@ -95,28 +129,143 @@ static void printFirstN(const qrsdp::EventLogReader& reader, int n) {
     }
 }
 
+/// Replays the log through a BookReplayer and prints the closing ladder.
+static void printClosingBook(const qrsdp::EventLogReader& reader) {
+    qrsdp::BookReplayer replayer(reader.header());
+    reader.forEachRecord([&replayer](const qrsdp::DiskEventRecord& r) { replayer.apply(r); });
+    const qrsdp::MultiLevelBook& book = replayer.book();
+
+    std::printf("\n=== Closing Book ===\n");
+    std::printf("  price_shifts:        %llu\n", (unsigned long long)replayer.shifts());
+    std::printf("  %-6s %-12s %-8s %-12s %-8s\n", "level", "bid_price", "bid_qty", "ask_price", "ask_qty");
+    for (size_t k = 0; k < book.numLevels(); ++k) {
+        std::printf("  %-6zu %-12d %-8u %-12d %-8u\n", k, book.bidPriceAtLevel(k),
+                    book.bidDepthAtLevel(k), book.askPriceAtLevel(k), book.askDepthAtLevel(k));
+    }
+}
+
+static void printContainer(const qrsdp::SessionContainer& container) {
+    std::printf("=== Session Container (%zu sessions) ===\n", container.size());
+    std::printf("  %-16s %-12s %14s %8s %14s\n", "symbol", "date", "records", "chunks", "bytes");
+    for (const auto& s : container.sessions()) {
+        std::printf("  %-16s %-12s %14llu %8u %14llu\n", s.symbol.c_str(), s.date.c_str(),
+                    (unsigned long long)s.record_count, s.chunk_count, (unsigned long long)s.size);
+    }
+}
+
+/// Checks the file (EventLogReader::verify) and reports the result; false if it fails.
+static bool printVerify(const qrsdp::EventLogReader& reader, qrsdp::VerifyMode mode) {
+    std::printf("\n=== Verify (%s) ===\n", qrsdp::verifyModeName(mode));
+    if (mode != qrsdp::VerifyMode::None && !reader.hasChecksums())
+        std::printf("  (no chunk checksums in this file: headers only)\n");
+    try {
+        const auto t0 = std::chrono::steady_clock::now();
+        const uint64_t records = reader.verify(mode);
+        const double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        std::printf("  ok: %u chunks, %llu records in %.3f s\n", reader.chunkCount(),
+                    (unsigned long long)records, secs);
+        return true;
+    } catch (const std::exception& e) {
+        std::printf("  FAILED: %s\n", e.what());
+        return false;
+    }
+}
+
+/// Lists a run catalogue's days (optionally one symbol, dates in [from, to]) from
+/// the catalogue alone; no day file is opened.
+static void printCatalog(const qrsdp::RunCatalog& catalog, const std::string& symbol,
+                         const std::string& from, const std::string& to) {
+    const std::vector<qrsdp::CatalogDay> days = catalog.query(symbol, from, to);
+    std::printf("=== Run Catalogue (%zu of %zu days) ===\n", days.size(), catalog.size());
+    std::printf("  %-16s %-12s %12s %8s %12s %8s %8s %8s %8s\n", "symbol", "date", "records", "chunks",
+                "exec_qty", "open", "close", "low", "high");
+    uint64_t records = 0;
+    for (const auto& d : days) {
+        records += d.record_count;
+        std::printf("  %-16s %-12s %12llu %8u %12llu %8d %8d", d.symbol.c_str(), d.date.c_str(),
+                    (unsigned long long)d.record_count, d.chunk_count,
+                    (unsigned long long)d.stats.executed_qty, d.open_ticks, d.close_ticks);
+        if (d.has_stats)
+            std::printf(" %8d %8d\n", d.stats.min_price_ticks, d.stats.max_price_ticks);
+        else
+            std::printf(" %8s %8s\n", "-", "-");
+    }
+    std::printf("  total_records:       %llu\n", (unsigned long long)records);
+}
+
 int main(int argc, char* argv[]) {
     if (argc < 2) {
-        std::fprintf(stderr, "Usage: %s <file.qrsdp> [--events N]\n", argv[0]);
+        std::fprintf(stderr, "Usage: %s <file.qrsdp> [--events N] [--book] [--verify checksums|full]\n"
+                             "       %s <file.qrsc> [--session [SYMBOL/]DATE] [--events N] [--book]\n"
+                             "       %s <catalog.qcat> [--symbol S] [--from DATE] [--to DATE]\n",
+                     argv[0], argv[0], argv[0]);
         return 1;
     }
 
     const char* path = argv[1];
     int show_events = 10;
+    std::string session;
+    std::string symbol;
+    std::string from;
+    std::string to;
+    bool show_book = false;
+    std::string verify;
 
     for (int i = 2; i < argc; ++i) {
         if (std::string(argv[i]) == "--events" && i + 1 < argc) {
             show_events = std::atoi(argv[++i]);
+        } else if (std::string(argv[i]) == "--session" && i + 1 < argc) {
+            session = argv[++i];
+        } else if (std::string(argv[i]) == "--symbol" && i + 1 < argc) {
+            symbol = argv[++i];
+        } else if (std::string(argv[i]) == "--from" && i + 1 < argc) {
+            from = argv[++i];
+        } else if (std::string(argv[i]) == "--to" && i + 1 < argc) {
+            to = argv[++i];
+        } else if (std::string(argv[i]) == "--verify" && i + 1 < argc) {
+            verify = argv[++i];
+        } else if (std::string(argv[i]) == "--book") {
+            show_book = true;
         }
     }
 
     try {
-        qrsdp::EventLogReader reader(path);
+        std::unique_ptr<qrsdp::SessionContainer> container;
+        std::unique_ptr<qrsdp::EventLogReader> owned;
+        if (qrsdp::isRunCatalog(path)) {
+            printCatalog(qrsdp::RunCatalog(path), symbol, from, to);
+            return 0;
+        }
+        if (qrsdp::isSessionContainer(path)) {
+            container = std::make_unique<qrsdp::SessionContainer>(path);
+            if (session.empty()) {
+                printContainer(*container);
+                return 0;
+            }
+            const size_t slash = session.find('/');
+            owned = slash == std::string::npos
+                ? container->open("", session)
+                : container->open(session.substr(0, slash), session.substr(slash + 1));
+        } else {
+            owned = std::make_unique<qrsdp::EventLogReader>(path);
+        }
+        const qrsdp::EventLogReader& reader = *owned;
 
         printHeader(reader.header());
         printSummary(reader);
         printEventDistribution(reader);
+        printStats(reader);
         printFirstN(reader, show_events);
+        if (show_book) printClosingBook(reader);
+        if (!verify.empty()) {
+            qrsdp::VerifyMode mode;
+            if (!qrsdp::parseVerifyMode(verify, mode)) {
+                std::fprintf(stderr, "unknown verify mode: %s (use 'checksums', 'full' or 'none')\n",
+                             verify.c_str());
+                return 1;
+            }
+            if (!printVerify(reader, mode)) return 1;
+        }
 
     } catch (const std::exception& e) {
         std::fprintf(stderr, "Error: %s\n", e.what());
@@ -50,7 +50,8 @@ int main(int argc, char* argv[]) {
     if (output_path) {
         sink = std::make_unique<qrsdp::BinaryFileSink>(output_path, session);
     } else {
-        sink = std::make_unique<qrsdp::InMemorySink>();
+        // Nothing reads the records back: keep a short tail, not the whole session.
+        sink = std::make_unique<qrsdp::InMemorySink>(4096);
     }
 
     qrsdp::SessionResult result = producer.runSession(session, *sink);
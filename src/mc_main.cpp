@@ -0,0 +1,153 @@
+#include "montecarlo/monte_carlo.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <string>
+
+static void printUsage(const char* prog) {
+    std::fprintf(stderr,
+        "Usage: %s [options]\n"
+        "  Simulates many independent SimpleImbalanceIntensity sessions that open the same\n"
+        "  book and reports summary statistics over the paths.\n"
+        "  --paths <n>          Number of sessions (default: 1024)\n"
+        "  --backend <name>     cpu or cuda (default: cpu)\n"
+        "  --threads <n>        Host threads for the cpu backend (default: all cores)\n"
+        "  --seed <n>           Philox key; path i uses stream i (default: 42)\n"
+        "  --seconds <n>        Seconds per session (default: 23400)\n"
+        "  --p0 <ticks>         Opening mid (default: 10000)\n"
+        "  --levels <n>         Levels per side, 1..32 (default: 5)\n"
+        "  --depth <n>          Initial depth per level (default: 5)\n"
+        "  --spread <n>         Initial spread in ticks (default: 2)\n"
+        "  --base-L <x>         Add intensity (default: 20)\n"
+        "  --base-C <x>         Cancel intensity per unit of depth (default: 0.5)\n"
+        "  --base-M <x>         Execution intensity (default: 15)\n"
+        "  --imbalance-sens <x> (default: 1)\n"
+        "  --cancel-sens <x>    (default: 1)\n"
+        "  --epsilon-exec <x>   (default: 0.5)\n"
+        "  --spread-sens <x>    (default: 0.4)\n"
+        "  --csv <path>         Write one row per path (- = stdout)\n"
+        "  --help               Show this help\n",
+        prog);
+}
+
+static void writeCsv(std::FILE* f, const qrsdp::MonteCarloResult& result) {
+    std::fprintf(f, "path,open,high,low,close,events,shifts,add_bid,add_ask,cancel_bid,cancel_ask,"
+                    "exec_buy,exec_sell\n");
+    for (size_t i = 0; i < result.paths.size(); ++i) {
+        const qrsdp::PathSummary& p = result.paths[i];
+        std::fprintf(f, "%zu,%d,%d,%d,%d,%llu,%llu", i, p.open_ticks, p.high_ticks, p.low_ticks,
+                     p.close_ticks, static_cast<unsigned long long>(p.events),
+                     static_cast<unsigned long long>(p.shifts));
+        for (uint64_t c : p.type_counts) std::fprintf(f, ",%llu", static_cast<unsigned long long>(c));
+        std::fprintf(f, "\n");
+    }
+}
+
+int main(int argc, char* argv[]) {
+    qrsdp::MonteCarloConfig config;
+    std::string backend_str = "cpu";
+    unsigned threads = 0;
+    std::string csv_path;
+
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        auto next = [&]() -> const char* {
+            if (i + 1 >= argc) {
+                std::fprintf(stderr, "missing value for %s\n", arg);
+                std::exit(1);
+            }
+            return argv[++i];
+        };
+
+        if (std::strcmp(arg, "--paths") == 0)         config.paths = std::strtoull(next(), nullptr, 10);
+        else if (std::strcmp(arg, "--backend") == 0)  backend_str = next();
+        else if (std::strcmp(arg, "--threads") == 0)  threads = static_cast<unsigned>(std::atoi(next()));
+        else if (std::strcmp(arg, "--seed") == 0)     config.seed = std::strtoull(next(), nullptr, 10);
+        else if (std::strcmp(arg, "--seconds") == 0)  config.session_seconds = static_cast<uint32_t>(std::atoi(next()));
+        else if (std::strcmp(arg, "--p0") == 0)       config.p0_ticks = std::atoi(next());
+        else if (std::strcmp(arg, "--levels") == 0)   config.levels_per_side = static_cast<uint32_t>(std::atoi(next()));
+        else if (std::strcmp(arg, "--depth") == 0)    config.initial_depth = static_cast<uint32_t>(std::atoi(next()));
+        else if (std::strcmp(arg, "--spread") == 0)   config.initial_spread_ticks = static_cast<uint32_t>(std::atoi(next()));
+        else if (std::strcmp(arg, "--base-L") == 0)   config.intensity.base_L = std::atof(next());
+        else if (std::strcmp(arg, "--base-C") == 0)   config.intensity.base_C = std::atof(next());
+        else if (std::strcmp(arg, "--base-M") == 0)   config.intensity.base_M = std::atof(next());
+        else if (std::strcmp(arg, "--imbalance-sens") == 0) config.intensity.imbalance_sensitivity = std::atof(next());
+        else if (std::strcmp(arg, "--cancel-sens") == 0)    config.intensity.cancel_sensitivity = std::atof(next());
+        else if (std::strcmp(arg, "--epsilon-exec") == 0)   config.intensity.epsilon_exec = std::atof(next());
+        else if (std::strcmp(arg, "--spread-sens") == 0)    config.intensity.spread_sensitivity = std::atof(next());
+        else if (std::strcmp(arg, "--csv") == 0)      csv_path = next();
+        else if (std::strcmp(arg, "--help") == 0 || std::strcmp(arg, "-h") == 0) {
+            printUsage(argv[0]);
+            return 0;
+        } else {
+            std::fprintf(stderr, "unknown argument: %s\n", arg);
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    qrsdp::MonteCarloBackend backend;
+    if (backend_str == "cpu") {
+        backend = qrsdp::MonteCarloBackend::CPU;
+    } else if (backend_str == "cuda") {
+        if (!qrsdp::cudaMonteCarloAvailable()) {
+            std::fprintf(stderr, "--backend cuda needs a build with -DBUILD_CUDA_MONTE_CARLO=ON and a CUDA device\n");
+            return 1;
+        }
+        backend = qrsdp::MonteCarloBackend::CUDA;
+    } else {
+        std::fprintf(stderr, "unknown backend: %s (use 'cpu' or 'cuda')\n", backend_str.c_str());
+        return 1;
+    }
+
+    qrsdp::MonteCarloResult result;
+    const auto start = std::chrono::steady_clock::now();
+    try {
+        result = qrsdp::runMonteCarlo(config, backend, threads);
+    } catch (const std::exception& e) {
+        std::fprintf(stderr, "%s\n", e.what());
+        return 1;
+    }
+    const double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    const size_t n = result.paths.size();
+    double events = 0.0, ret = 0.0, ret_sq = 0.0, range = 0.0;
+    double types[qrsdp::kNumEventTypes] = {};
+    for (const qrsdp::PathSummary& p : result.paths) {
+        events += static_cast<double>(p.events);
+        const double r = static_cast<double>(p.close_ticks - p.open_ticks);
+        ret += r;
+        ret_sq += r * r;
+        range += static_cast<double>(p.high_ticks - p.low_ticks);
+        for (int t = 0; t < qrsdp::kNumEventTypes; ++t) types[t] += static_cast<double>(p.type_counts[t]);
+    }
+    const double dn = n > 0 ? static_cast<double>(n) : 1.0;
+    const double mean_ret = ret / dn;
+    std::printf("%zu paths (%s) in %.3f s: %.0f paths/s, %.3g events/s\n", n, backend_str.c_str(), secs,
+                static_cast<double>(n) / secs, events / secs);
+    std::printf("  events/path    %.1f\n", events / dn);
+    std::printf("  close - open   mean %.3f  stdev %.3f ticks\n", mean_ret,
+                std::sqrt(std::max(0.0, ret_sq / dn - mean_ret * mean_ret)));
+    std::printf("  high - low     mean %.3f ticks\n", range / dn);
+    const char* names[] = {"add_bid", "add_ask", "cancel_bid", "cancel_ask", "exec_buy", "exec_sell"};
+    std::printf("  type shares   ");
+    for (int t = 0; t < qrsdp::kNumEventTypes; ++t)
+        std::printf(" %s %.4f", names[t], events > 0.0 ? types[t] / events : 0.0);
+    std::printf("\n");
+
+    if (!csv_path.empty()) {
+        std::FILE* f = csv_path == "-" ? stdout : std::fopen(csv_path.c_str(), "w");
+        if (!f) {
+            std::fprintf(stderr, "cannot open %s\n", csv_path.c_str());
+            return 1;
+        }
+        writeCsv(f, result);
+        if (f != stdout) std::fclose(f);
+    }
+    return 0;
+}
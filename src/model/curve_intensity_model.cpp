@@ -1,7 +1,10 @@
 #include "model/curve_intensity_model.h"
+#include "book/depth_reduce.h"
 #include <algorithm>
 #include <cmath>
 #include <cstddef>
+#include <memory>
+#include <utility>
 
 namespace qrsdp {
 
@@ -11,15 +14,47 @@ constexpr double kEpsilon = 1e-12;
 
 }
 
-CurveIntensityModel::CurveIntensityModel(HLRParams params) : params_(std::move(params)) {
-    last_K_ = params_.K;
-    last_per_level_.resize(static_cast<size_t>(4 * params_.K + 2), 0.0);
+CurveIntensityModel::CurveIntensityModel(const HLRParams& params)
+    : CurveIntensityModel(HLRCurveTable(params), params.spread_sensitivity,
+                          params.imbalance_sensitivity) {}
+
+CurveIntensityModel::CurveIntensityModel(const HLRModelCurves& curves)
+    : CurveIntensityModel(curves.table, curves.spread_sensitivity, curves.imbalance_sensitivity) {}
+
+CurveIntensityModel::CurveIntensityModel(HLRCurveTable curves, double spread_sensitivity,
+                                         double imbalance_sensitivity)
+    : K_(static_cast<int>(curves.levels())),
+      imbalance_sensitivity_(imbalance_sensitivity),
+      spread_feedback_(spread_sensitivity),
+      curves_(std::move(curves)) {
+    last_K_ = K_;
+    last_per_level_.resize(static_cast<size_t>(4 * K_ + 2), 0.0);
+}
+
+void CurveIntensityModel::followParams(const HLRParamsChannel* channel) {
+    channel_ = channel;
+    channel_version_ = 0;
+}
+
+void CurveIntensityModel::adoptPublished() const {
+    uint64_t version = 0;
+    const std::shared_ptr<const HLRModelCurves> next = channel_->latestCurves(&version);
+    channel_version_ = version;
+    if (!next || next->table.levels() != static_cast<size_t>(K_)) return;
+    imbalance_sensitivity_ = next->imbalance_sensitivity;
+    spread_feedback_ = SpreadFeedback(next->spread_sensitivity);
+    curves_ = next->table;
+    cache_valid_ = false;
+    ++param_swaps_;
 }
 
 Intensities CurveIntensityModel::compute(const BookState& state) const {
-    const int K = params_.K;
+    if (channel_ && channel_->version() != channel_version_) adoptPublished();
+    const int K = K_;
     const size_t ku = static_cast<size_t>(K);
+    last_change_ = PerLevelChange{};
     if (state.bid_depths.size() < ku || state.ask_depths.size() < ku) {
+        cache_valid_ = false;
         Intensities out;
         out.add_bid = out.add_ask = out.cancel_bid = out.cancel_ask = kEpsilon;
         out.exec_buy = out.exec_sell = kEpsilon;
@@ -28,31 +63,31 @@ Intensities CurveIntensityModel::compute(const BookState& state) const {
 
     // Spread-dependent feedback: wide spread attracts limit orders, dampens executions.
     // Neutral at spread=2 (one tick each side of mid). Mirrors SimpleImbalanceIntensity.
-    const double sS = params_.spread_sensitivity;
-    double add_spread_mult = 1.0;
-    double exec_spread_mult = 1.0;
-    if (sS > 0.0) {
-        const double spread_delta = static_cast<double>(state.features.spread_ticks) - 2.0;
-        add_spread_mult = std::exp(sS * spread_delta);
-        exec_spread_mult = std::exp(-sS * spread_delta);
-    }
+    const SpreadFeedback::Multipliers spread_mult = spread_feedback_.at(state.features.spread_ticks);
+    add_spread_mult_ = spread_mult.add;
+    exec_spread_mult_ = spread_mult.exec;
+    cached_spread_ = state.features.spread_ticks;
 
     double add_bid = 0.0, add_ask = 0.0, cancel_bid = 0.0, cancel_ask = 0.0;
-    double exec_buy = 0.0, exec_sell = 0.0;
 
     last_per_level_.assign(static_cast<size_t>(4 * K + 2), 0.0);
     last_K_ = K;
+    cached_bid_depths_.assign(state.bid_depths.begin(), state.bid_depths.begin() + K);
+    cached_ask_depths_.assign(state.ask_depths.begin(), state.ask_depths.begin() + K);
+    total_bid_depth_ = sumDepths(state.bid_depths.data(), ku);
+    total_ask_depth_ = sumDepths(state.ask_depths.data(), ku);
 
     for (int i = 0; i < K; ++i) {
         const size_t si = static_cast<size_t>(i);
         const size_t n_bid = state.bid_depths[si];
         const size_t n_ask = state.ask_depths[si];
 
-        double lb = 0.0, la = 0.0, cb = 0.0, ca = 0.0;
-        if (si < params_.lambda_L_bid.size()) lb = params_.lambda_L_bid[si].value(n_bid) * add_spread_mult;
-        if (si < params_.lambda_L_ask.size()) la = params_.lambda_L_ask[si].value(n_ask) * add_spread_mult;
-        if (si < params_.lambda_C_bid.size()) cb = params_.lambda_C_bid[si].value(n_bid);
-        if (si < params_.lambda_C_ask.size()) ca = params_.lambda_C_ask[si].value(n_ask);
+        const HLRCurveTable::Rates bid = curves_.levelRates(si, Side::BID, n_bid);
+        const HLRCurveTable::Rates ask = curves_.levelRates(si, Side::ASK, n_ask);
+        const double lb = bid.add * add_spread_mult_;
+        const double la = ask.add * add_spread_mult_;
+        const double cb = bid.cancel;
+        const double ca = ask.cancel;
 
         add_bid += lb;
         add_ask += la;
@@ -64,18 +99,80 @@ Intensities CurveIntensityModel::compute(const BookState& state) const {
         last_per_level_[2 * ku + si] = cb;
         last_per_level_[3 * ku + si] = ca;
     }
+    add_bid_ = add_bid;
+    add_ask_ = add_ask;
+    cancel_bid_ = cancel_bid;
+    cancel_ask_ = cancel_ask;
+    cache_valid_ = true;
+    updates_since_resync_ = 0;
+
+    computeExec(state);
+    return currentIntensities();
+}
+
+Intensities CurveIntensityModel::update(const BookState& state, const BookDelta& delta) const {
+    if (channel_ && channel_->version() != channel_version_) adoptPublished();
+    if (delta.full || !cache_valid_ || last_K_ != K_ ||
+        state.features.spread_ticks != cached_spread_ ||
+        (totals_mode_ == TotalsMode::RUNNING && ++updates_since_resync_ >= kResyncInterval)) {
+        return compute(state);
+    }
+
+    const size_t ku = static_cast<size_t>(K_);
+    const size_t si = static_cast<size_t>(delta.level);
+    last_change_.all = false;
+    last_change_.count = 0;
+    if (delta.side != Side::NA && si < ku) {
+        const bool is_bid = (delta.side == Side::BID);
+        const uint32_t n = is_bid ? state.bid_depths[si] : state.ask_depths[si];
+        uint32_t& cached = is_bid ? cached_bid_depths_[si] : cached_ask_depths_[si];
+        uint64_t& total_depth = is_bid ? total_bid_depth_ : total_ask_depth_;
+        total_depth = total_depth - cached + n;
+        cached = n;
+
+        const HLRCurveTable::Rates rates = curves_.levelRates(si, delta.side, n);
+        const double l = rates.add * add_spread_mult_;
+        const double c = rates.cancel;
+
+        const size_t idx_l = (is_bid ? 0 : ku) + si;
+        const size_t idx_c = (is_bid ? 2 * ku : 3 * ku) + si;
+        double& slot_l = last_per_level_[idx_l];
+        double& slot_c = last_per_level_[idx_c];
+        double& sum_l = is_bid ? add_bid_ : add_ask_;
+        double& sum_c = is_bid ? cancel_bid_ : cancel_ask_;
+        if (totals_mode_ == TotalsMode::RUNNING) {
+            sum_l += l - slot_l;
+            sum_c += c - slot_c;
+            slot_l = l;
+            slot_c = c;
+        } else {
+            slot_l = l;
+            slot_c = c;
+            sum_l = sumLevels(idx_l - si);
+            sum_c = sumLevels(idx_c - si);
+        }
+        last_change_.index[last_change_.count++] = idx_l;
+        last_change_.index[last_change_.count++] = idx_c;
+    }
+    last_change_.index[last_change_.count++] = 4 * ku;
+    last_change_.index[last_change_.count++] = 4 * ku + 1;
+
+    computeExec(state);
+    return currentIntensities();
+}
+
+void CurveIntensityModel::computeExec(const BookState& state) const {
+    const size_t ku = static_cast<size_t>(K_);
+
     // Imbalance-driven feedback: drives mean-reverting price dynamics.
     // When bid depth > ask depth (positive imbalance), exec_sell is boosted
     // and exec_buy dampened, pushing the price down towards equilibrium.
     double exec_imb_buy = 1.0;
     double exec_imb_sell = 1.0;
-    const double iS = params_.imbalance_sensitivity;
+    const double iS = imbalance_sensitivity_;
     if (iS > 0.0) {
-        double total_bid = 0.0, total_ask = 0.0;
-        for (size_t i = 0; i < ku; ++i) {
-            total_bid += static_cast<double>(state.bid_depths[i]);
-            total_ask += static_cast<double>(state.ask_depths[i]);
-        }
+        const double total_bid = static_cast<double>(total_bid_depth_);
+        const double total_ask = static_cast<double>(total_ask_depth_);
         const double total = total_bid + total_ask;
         if (total > 0.0) {
             const double imbalance = (total_bid - total_ask) / total;  // [-1, 1]
@@ -84,18 +181,27 @@ Intensities CurveIntensityModel::compute(const BookState& state) const {
         }
     }
 
-    exec_buy = params_.lambda_M_buy.value(state.ask_depths[0]) * exec_spread_mult * exec_imb_buy;
-    exec_sell = params_.lambda_M_sell.value(state.bid_depths[0]) * exec_spread_mult * exec_imb_sell;
-    last_per_level_[4 * ku] = exec_buy;
-    last_per_level_[4 * ku + 1] = exec_sell;
+    last_per_level_[4 * ku] =
+        curves_.marketBuy(state.ask_depths[0]) * exec_spread_mult_ * exec_imb_buy;
+    last_per_level_[4 * ku + 1] =
+        curves_.marketSell(state.bid_depths[0]) * exec_spread_mult_ * exec_imb_sell;
+}
+
+double CurveIntensityModel::sumLevels(size_t first) const {
+    double sum = 0.0;
+    for (size_t i = first; i < first + static_cast<size_t>(K_); ++i) sum += last_per_level_[i];
+    return sum;
+}
 
+Intensities CurveIntensityModel::currentIntensities() const {
+    const size_t ku = static_cast<size_t>(K_);
     Intensities out;
-    out.add_bid = std::max(add_bid, kEpsilon);
-    out.add_ask = std::max(add_ask, kEpsilon);
-    out.cancel_bid = std::max(cancel_bid, kEpsilon);
-    out.cancel_ask = std::max(cancel_ask, kEpsilon);
-    out.exec_buy = std::max(exec_buy, kEpsilon);
-    out.exec_sell = std::max(exec_sell, kEpsilon);
+    out.add_bid = std::max(add_bid_, kEpsilon);
+    out.add_ask = std::max(add_ask_, kEpsilon);
+    out.cancel_bid = std::max(cancel_bid_, kEpsilon);
+    out.cancel_ask = std::max(cancel_ask_, kEpsilon);
+    out.exec_buy = std::max(last_per_level_[4 * ku], kEpsilon);
+    out.exec_sell = std::max(last_per_level_[4 * ku + 1], kEpsilon);
     return out;
 }
 
@@ -105,6 +211,10 @@ bool CurveIntensityModel::getPerLevelIntensities(std::vector<double>& weights_ou
     return true;
 }
 
+const std::vector<double>* CurveIntensityModel::perLevelView() const {
+    return last_per_level_.empty() ? nullptr : &last_per_level_;
+}
+
 void CurveIntensityModel::decodePerLevelIndex(size_t index, int K, EventType& type_out, size_t& level_out) {
     const size_t ku = static_cast<size_t>(K);
     if (index < ku) {
@@ -2,6 +2,9 @@
 
 #include "model/i_intensity_model.h"
 #include "model/hlr_params.h"
+#include "model/hlr_params_channel.h"
+#include "model/hlr_curve_table.h"
+#include "model/spread_feedback.h"
 #include "core/records.h"
 #include <vector>
 
@@ -9,20 +12,88 @@ namespace qrsdp {
 
 /// HLR2014 Model I: queue-size-dependent intensities from curves per level.
 /// Requires BookState.bid_depths and ask_depths filled (size >= params.K).
-class CurveIntensityModel : public IIntensityModel {
+/// The model keeps the curves only as an HLRCurveTable, which it shares rather
+/// than copies: models built from one table (or bundle) read the same rows. Its
+/// own state is the per-level scratch and totals below.
+class CurveIntensityModel final : public IIntensityModel {
 public:
-    explicit CurveIntensityModel(HLRParams params);
+    explicit CurveIntensityModel(const HLRParams& params);
+    /// Curves from a prebuilt table (K = curves.levels()), e.g. an HLRCurveBundle view.
+    CurveIntensityModel(HLRCurveTable curves, double spread_sensitivity,
+                        double imbalance_sensitivity);
+    /// Shares curves' table with every other model built from it.
+    explicit CurveIntensityModel(const HLRModelCurves& curves);
 
     Intensities compute(const BookState& state) const override;
+
+    /// How update() refreshes the side totals after a one-level change.
+    ///   EXACT   — re-adds that side's per-level entries in level order, as compute()
+    ///             does, so the totals are bit-identical to compute()'s: O(K) additions.
+    ///             LINEAR selection needs this to reproduce pre-incremental streams.
+    ///   RUNNING — adjusts a running sum by the level's change, resynced by compute()
+    ///             every kResyncInterval updates: O(1), but the totals may differ
+    ///             from compute()'s in the last ulp, which moves an occasional ts_ns.
+    enum class TotalsMode { EXACT, RUNNING };
+    void setTotalsMode(TotalsMode mode) { totals_mode_ = mode; }
+    TotalsMode totalsMode() const { return totals_mode_; }
+
+    /// Update when one level changed: looks up only that level's curves and
+    /// refreshes the totals as totalsMode() says. Falls back to compute() on full
+    /// deltas or a spread change (and in RUNNING mode every kResyncInterval updates).
+    Intensities update(const BookState& state, const BookDelta& delta) const override;
     bool getPerLevelIntensities(std::vector<double>& weights_out) const override;
+    const std::vector<double>* perLevelView() const override;
+    PerLevelChange lastPerLevelChange() const override { return last_change_; }
+
+    /// Follow channel (null stops following): whenever its version moves, the next
+    /// compute()/update() swaps in the published curves — whole, between two
+    /// events, sharing the table the channel built — and recomputes every level. Params whose K differs from the
+    /// model's are skipped. A run that follows a channel is no longer reproducible
+    /// from its seed. The channel must outlive the model.
+    void followParams(const HLRParamsChannel* channel);
+
+    /// Curves in use (the last adopted from the channel, if following one).
+    const HLRCurveTable& curves() const { return curves_; }
+    /// Params sets adopted from the channel so far.
+    uint64_t paramSwaps() const { return param_swaps_; }
 
     /// Decode per-level index [0..4*K+1] to (EventType, level). K from last compute.
     static void decodePerLevelIndex(size_t index, int K, EventType& type_out, size_t& level_out);
 
+    static constexpr uint32_t kResyncInterval = 4096;
+
 private:
-    HLRParams params_;
+    /// Exec rates depend on best depths and total-depth imbalance; recomputed every call.
+    void computeExec(const BookState& state) const;
+    Intensities currentIntensities() const;
+    /// Per-level entries [first, first + K) added in level order, as compute() adds them.
+    double sumLevels(size_t first) const;
+    /// Swaps in the channel's latest params if K matches; invalidates the cache.
+    void adoptPublished() const;
+
+    int K_;
+    // mutable: replaced whole when a followed channel publishes.
+    mutable double imbalance_sensitivity_;
+    mutable SpreadFeedback spread_feedback_;
+    mutable HLRCurveTable curves_;  // every curve lookup
+    const HLRParamsChannel* channel_ = nullptr;
+    TotalsMode totals_mode_ = TotalsMode::EXACT;
+    mutable uint64_t channel_version_ = 0;  // last channel version looked at
+    mutable uint64_t param_swaps_ = 0;
     mutable std::vector<double> last_per_level_;
     mutable int last_K_ = 0;
+
+    // Incremental cache, valid after a compute() with enough depths.
+    mutable bool cache_valid_ = false;
+    mutable int cached_spread_ = 0;
+    mutable double add_spread_mult_ = 1.0;
+    mutable double exec_spread_mult_ = 1.0;
+    mutable double add_bid_ = 0.0, add_ask_ = 0.0, cancel_bid_ = 0.0, cancel_ask_ = 0.0;
+    mutable uint64_t total_bid_depth_ = 0, total_ask_depth_ = 0;
+    mutable std::vector<uint32_t> cached_bid_depths_;
+    mutable std::vector<uint32_t> cached_ask_depths_;
+    mutable uint32_t updates_since_resync_ = 0;
+    mutable PerLevelChange last_change_{};
 };
 
 }  // namespace qrsdp
@@ -0,0 +1,170 @@
+#include "model/hawkes_intensity_model.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <stdexcept>
+
+namespace qrsdp {
+
+namespace {
+
+/// Excitation below this is dropped, so a quiet kernel does not decay into
+/// denormals (slow arithmetic) for the rest of the session.
+constexpr double kNegligible = 1e-200;
+
+Intensities fromArray(const std::array<double, kNumEventTypes>& v) {
+    Intensities out;
+    out.add_bid = v[0];
+    out.add_ask = v[1];
+    out.cancel_bid = v[2];
+    out.cancel_ask = v[3];
+    out.exec_buy = v[4];
+    out.exec_sell = v[5];
+    return out;
+}
+
+}  // namespace
+
+HawkesIntensityModel::HawkesIntensityModel(const HawkesParams& params,
+                                           std::shared_ptr<const IIntensityModel> baseline)
+    : params_(params), baseline_model_(std::move(baseline)) {
+    validateHawkesParams(params_);
+    const size_t K = params_.kernels.size();
+    beta_.resize(K);
+    alpha_.assign(K * kTypes * kTypes, 0.0);
+    alpha_sum_.assign(K * kTypes, 0.0);
+    for (size_t k = 0; k < K; ++k) {
+        beta_[k] = params_.kernels[k].beta;
+        for (size_t j = 0; j < kTypes; ++j) {
+            for (size_t i = 0; i < kTypes; ++i) {
+                alpha_[(k * kTypes + j) * kTypes + i] = params_.kernels[k].alpha[i][j];
+                alpha_sum_[k * kTypes + j] += params_.kernels[k].alpha[i][j];
+            }
+        }
+    }
+    e_.assign(K * kTypes, 0.0);
+    e_sum_.assign(K, 0.0);
+    decay_.assign(K, 1.0);
+    decay_t_ = std::numeric_limits<double>::quiet_NaN();
+    baseline_ = fromArray(params_.mu);
+    baseline_total_ = baseline_.total();
+}
+
+Intensities HawkesIntensityModel::compute(const BookState& state) const {
+    baseline_ = baseline_model_ ? baseline_model_->compute(state) : fromArray(params_.mu);
+    baseline_total_ = baseline_.total();
+    return withExcitation();
+}
+
+Intensities HawkesIntensityModel::update(const BookState& state, const BookDelta& delta) const {
+    if (delta.full || delta.side != Side::NA) {
+        baseline_ = baseline_model_ ? baseline_model_->update(state, delta) : fromArray(params_.mu);
+        baseline_total_ = baseline_.total();
+    }
+    return withExcitation();
+}
+
+void HawkesIntensityModel::resetHistory(double t) {
+    std::fill(e_.begin(), e_.end(), 0.0);
+    std::fill(e_sum_.begin(), e_sum_.end(), 0.0);
+    clock_ = t;
+    std::fill(decay_.begin(), decay_.end(), 1.0);
+    decay_t_ = t;
+}
+
+void HawkesIntensityModel::advanceTo(double t) {
+    if (!(t > clock_)) return;
+    const double* d = decayTo(t);
+    for (size_t k = 0; k < beta_.size(); ++k) {
+        double* e = &e_[k * kTypes];
+        if (e_sum_[k] * d[k] < kNegligible) {
+            std::fill(e, e + kTypes, 0.0);
+            e_sum_[k] = 0.0;
+            continue;
+        }
+        for (size_t i = 0; i < kTypes; ++i) e[i] *= d[k];
+        e_sum_[k] *= d[k];
+    }
+    // The producer's next bound is taken at the new clock: no decay, no exp.
+    clock_ = t;
+    std::fill(decay_.begin(), decay_.end(), 1.0);
+    decay_t_ = t;
+}
+
+void HawkesIntensityModel::onEvent(EventType type) {
+    const size_t j = static_cast<size_t>(type);
+    if (j >= kTypes) return;
+    for (size_t k = 0; k < beta_.size(); ++k) {
+        double* e = &e_[k * kTypes];
+        const double* a = &alpha_[(k * kTypes + j) * kTypes];
+        for (size_t i = 0; i < kTypes; ++i) e[i] += a[i];
+        e_sum_[k] += alpha_sum_[k * kTypes + j];
+    }
+}
+
+double HawkesIntensityModel::totalAt(double t) const {
+    const double* d = decayTo(t);
+    double total = baseline_total_;
+    for (size_t k = 0; k < beta_.size(); ++k) total += e_sum_[k] * d[k];
+    return total;
+}
+
+std::vector<double> HawkesIntensityModel::saveHistory() const {
+    std::vector<double> history;
+    history.reserve(1 + e_.size() + e_sum_.size());
+    history.push_back(clock_);
+    history.insert(history.end(), e_.begin(), e_.end());
+    history.insert(history.end(), e_sum_.begin(), e_sum_.end());
+    return history;
+}
+
+void HawkesIntensityModel::restoreHistory(const std::vector<double>& history, double t) {
+    if (history.empty()) {
+        resetHistory(t);
+        return;
+    }
+    if (history.size() != 1 + e_.size() + e_sum_.size())
+        throw std::invalid_argument("HawkesIntensityModel: history is for a different kernel count");
+    clock_ = history[0];
+    std::copy(history.begin() + 1, history.begin() + 1 + static_cast<std::ptrdiff_t>(e_.size()), e_.begin());
+    std::copy(history.end() - static_cast<std::ptrdiff_t>(e_sum_.size()), history.end(), e_sum_.begin());
+    std::fill(decay_.begin(), decay_.end(), 1.0);
+    decay_t_ = clock_;
+}
+
+double HawkesIntensityModel::excitation(EventType type) const {
+    const size_t i = static_cast<size_t>(type);
+    double x = 0.0;
+    if (i >= kTypes) return x;
+    for (size_t k = 0; k < beta_.size(); ++k) x += e_[k * kTypes + i];
+    return x;
+}
+
+Intensities HawkesIntensityModel::withExcitation() const {
+    std::array<double, kNumEventTypes> x{};
+    for (size_t k = 0; k < beta_.size(); ++k) {
+        const double* e = &e_[k * kTypes];
+        for (size_t i = 0; i < kTypes; ++i) x[i] += e[i];
+    }
+    Intensities out = baseline_;
+    out.add_bid += x[0];
+    out.add_ask += x[1];
+    out.cancel_bid += x[2];
+    out.cancel_ask += x[3];
+    out.exec_buy += x[4];
+    out.exec_sell += x[5];
+    return out;
+}
+
+const double* HawkesIntensityModel::decayTo(double t) const {
+    if (t != decay_t_) {
+        const double dt = t > clock_ ? t - clock_ : 0.0;
+        for (size_t k = 0; k < beta_.size(); ++k) decay_[k] = std::exp(-beta_[k] * dt);
+        decay_t_ = t;
+    }
+    return decay_.data();
+}
+
+}  // namespace qrsdp
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "model/hawkes_params.h"
+#include "model/i_intensity_model.h"
+#include "core/records.h"
+#include <memory>
+#include <vector>
+
+namespace qrsdp {
+
+/// Multivariate Hawkes intensities with multi-exponential kernels:
+///   λ_i(t) = baseline_i(book) + Σ_k e_k,i(t),   e_k,i(t) = Σ_{t_m < t} alpha_k[i][type_m] · exp(-beta_k (t - t_m))
+/// Exponential kernels make the excitation Markovian: each e_k,i decays by
+/// exp(-beta_k Δt) between events and jumps by alpha_k[i][j] at an event of type
+/// j, so advanceTo() and onEvent() cost O(kernels × types) whatever the history.
+///
+/// The baseline is another model's intensities for the current book (e.g.
+/// SimpleImbalanceIntensity), or params.mu when none is given. Sampling needs
+/// the history hooks (selfExciting() is true): BasicQrsdpProducer thins
+/// candidate times against totalAt(), which only decays between events.
+/// Not thread-safe; one model per producer.
+class HawkesIntensityModel final : public IIntensityModel {
+public:
+    /// Throws std::invalid_argument if params fail validateHawkesParams().
+    explicit HawkesIntensityModel(const HawkesParams& params,
+                                  std::shared_ptr<const IIntensityModel> baseline = nullptr);
+
+    /// Baseline for state plus the excitation at the clock.
+    Intensities compute(const BookState& state) const override;
+    /// As compute(), passing delta on to the baseline; a delta that changed
+    /// nothing reuses the last baseline.
+    Intensities update(const BookState& state, const BookDelta& delta) const override;
+
+    bool selfExciting() const override { return true; }
+    void resetHistory(double t) override;
+    void advanceTo(double t) override;
+    void onEvent(EventType type) override;
+    double totalAt(double t) const override;
+    /// {clock, e_k,i for every kernel and type, Σ_i e_k,i per kernel}: the running
+    /// sums as they are, so a restored model continues bit for bit.
+    std::vector<double> saveHistory() const override;
+    void restoreHistory(const std::vector<double>& history, double t) override;
+
+    const HawkesParams& params() const { return params_; }
+    double clock() const { return clock_; }
+    /// Σ_k e_k,i at the clock: type's intensity above its baseline.
+    double excitation(EventType type) const;
+
+private:
+    static constexpr size_t kTypes = static_cast<size_t>(kNumEventTypes);
+
+    Intensities withExcitation() const;
+    /// exp(-beta_k (t - clock_)) for every kernel into decay_ (cached per t).
+    const double* decayTo(double t) const;
+
+    HawkesParams params_;
+    std::shared_ptr<const IIntensityModel> baseline_model_;
+    std::vector<double> beta_;
+    std::vector<double> alpha_;      // [k][j][i]: column j of kernel k contiguous
+    std::vector<double> alpha_sum_;  // [k][j]: Σ_i alpha_k[i][j]
+    std::vector<double> e_;          // [k][i] at clock_
+    std::vector<double> e_sum_;      // [k]: Σ_i e_k,i
+    double clock_ = 0.0;
+
+    mutable Intensities baseline_{};
+    mutable double baseline_total_ = 0.0;
+    mutable std::vector<double> decay_;
+    mutable double decay_t_ = 0.0;
+};
+
+}  // namespace qrsdp
@@ -0,0 +1,201 @@
+#include "model/hawkes_params.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <stdexcept>
+
+namespace qrsdp {
+
+namespace {
+
+constexpr size_t kTypes = static_cast<size_t>(kNumEventTypes);
+
+size_t idx(EventType t) { return static_cast<size_t>(t); }
+
+void skipWhitespace(const char*& p) {
+    while (*p == ' ' || *p == '\n' || *p == '\r' || *p == '\t') ++p;
+}
+
+bool parseNumberArray(const char*& p, std::vector<double>& out) {
+    out.clear();
+    skipWhitespace(p);
+    if (*p != '[') return false;
+    ++p;
+    skipWhitespace(p);
+    if (*p == ']') { ++p; return true; }
+    for (;;) {
+        char* end = nullptr;
+        const double v = std::strtod(p, &end);
+        if (end == p) return false;
+        out.push_back(v);
+        p = end;
+        skipWhitespace(p);
+        if (*p == ',') { ++p; continue; }
+        if (*p == ']') { ++p; return true; }
+        return false;
+    }
+}
+
+/// Value of the first "key": in json; a "key" not followed by a colon is a
+/// string value (e.g. "baseline": "mu") and is skipped.
+const char* findKey(const char* json, const char* key) {
+    const std::string needle = std::string("\"") + key + "\"";
+    for (const char* pos = std::strstr(json, needle.c_str()); pos; pos = std::strstr(pos, needle.c_str())) {
+        pos += needle.size();
+        while (*pos == ' ') ++pos;
+        if (*pos != ':') continue;
+        while (*pos == ' ' || *pos == ':') ++pos;
+        return pos;
+    }
+    return nullptr;
+}
+
+}  // namespace
+
+HawkesParams makeDefaultHawkesParams() {
+    HawkesParams p;
+    HawkesKernel fast;  // ~50 ms memory: bursts of market orders and the refill after them
+    fast.beta = 20.0;
+    fast.alpha[idx(EventType::EXECUTE_BUY)][idx(EventType::EXECUTE_BUY)] = 6.0;
+    fast.alpha[idx(EventType::EXECUTE_SELL)][idx(EventType::EXECUTE_SELL)] = 6.0;
+    fast.alpha[idx(EventType::ADD_ASK)][idx(EventType::EXECUTE_BUY)] = 4.0;
+    fast.alpha[idx(EventType::ADD_BID)][idx(EventType::EXECUTE_SELL)] = 4.0;
+    fast.alpha[idx(EventType::ADD_BID)][idx(EventType::ADD_BID)] = 2.0;
+    fast.alpha[idx(EventType::ADD_ASK)][idx(EventType::ADD_ASK)] = 2.0;
+    fast.alpha[idx(EventType::CANCEL_BID)][idx(EventType::CANCEL_BID)] = 2.0;
+    fast.alpha[idx(EventType::CANCEL_ASK)][idx(EventType::CANCEL_ASK)] = 2.0;
+    HawkesKernel slow;  // ~1 s memory: order-splitting metaorders
+    slow.beta = 1.0;
+    slow.alpha[idx(EventType::EXECUTE_BUY)][idx(EventType::EXECUTE_BUY)] = 0.15;
+    slow.alpha[idx(EventType::EXECUTE_SELL)][idx(EventType::EXECUTE_SELL)] = 0.15;
+    p.kernels = {fast, slow};
+    return p;
+}
+
+HawkesMatrix hawkesBranchingMatrix(const HawkesParams& params) {
+    HawkesMatrix g{};
+    for (const HawkesKernel& k : params.kernels) {
+        if (!(k.beta > 0.0)) continue;
+        for (size_t i = 0; i < kTypes; ++i)
+            for (size_t j = 0; j < kTypes; ++j) g[i][j] += k.alpha[i][j] / k.beta;
+    }
+    return g;
+}
+
+double hawkesBranchingRatio(const HawkesParams& params) {
+    // Power iteration on the non-negative matrix, from a positive start vector:
+    // the growth factor converges to the Perron root, the spectral radius.
+    const HawkesMatrix g = hawkesBranchingMatrix(params);
+    std::array<double, kTypes> v;
+    v.fill(1.0);
+    double rho = 0.0;
+    for (int iter = 0; iter < 500; ++iter) {
+        std::array<double, kTypes> w{};
+        for (size_t i = 0; i < kTypes; ++i)
+            for (size_t j = 0; j < kTypes; ++j) w[i] += g[i][j] * v[j];
+        double norm = 0.0;
+        for (double x : w) norm = std::max(norm, x);
+        if (norm == 0.0) return 0.0;
+        for (size_t i = 0; i < kTypes; ++i) v[i] = w[i] / norm + 1e-300;
+        if (iter > 0 && std::fabs(norm - rho) <= 1e-12 * norm) return norm;
+        rho = norm;
+    }
+    return rho;
+}
+
+void validateHawkesParams(const HawkesParams& params) {
+    for (double m : params.mu) {
+        if (!(m >= 0.0) || !std::isfinite(m))
+            throw std::invalid_argument("HawkesParams: mu must be finite and >= 0");
+    }
+    for (const HawkesKernel& k : params.kernels) {
+        if (!(k.beta > 0.0) || !std::isfinite(k.beta))
+            throw std::invalid_argument("HawkesParams: every kernel needs a finite beta > 0");
+        for (const auto& row : k.alpha) {
+            for (double a : row) {
+                if (!(a >= 0.0) || !std::isfinite(a))
+                    throw std::invalid_argument("HawkesParams: alpha must be finite and >= 0");
+            }
+        }
+    }
+    if (params.baseline == HawkesBaseline::MU
+        && std::all_of(params.mu.begin(), params.mu.end(), [](double m) { return m == 0.0; }))
+        throw std::invalid_argument("HawkesParams: the mu baseline needs some mu > 0");
+    const double rho = hawkesBranchingRatio(params);
+    if (rho >= 1.0)
+        throw std::invalid_argument("HawkesParams: branching ratio " + std::to_string(rho)
+                                    + " >= 1 (explosive)");
+}
+
+bool saveHawkesParamsToJson(const std::string& path, const HawkesParams& params) {
+    std::ostringstream out;
+    out.precision(17);
+    out << "{\n  \"baseline\": \"" << (params.baseline == HawkesBaseline::MU ? "mu" : "book")
+        << "\",\n  \"mu\": [";
+    for (size_t i = 0; i < kTypes; ++i) out << (i ? ", " : "") << params.mu[i];
+    out << "],\n  \"beta\": [";
+    for (size_t k = 0; k < params.kernels.size(); ++k) out << (k ? ", " : "") << params.kernels[k].beta;
+    out << "],\n  \"alpha\": [";
+    for (size_t k = 0; k < params.kernels.size(); ++k) {
+        out << (k ? ",\n    [" : "\n    [");
+        for (size_t i = 0; i < kTypes; ++i)
+            for (size_t j = 0; j < kTypes; ++j)
+                out << (i + j ? ", " : "") << params.kernels[k].alpha[i][j];
+        out << "]";
+    }
+    out << "\n  ]\n}\n";
+    std::ofstream f(path);
+    if (!f) return false;
+    f << out.str();
+    return static_cast<bool>(f);
+}
+
+bool loadHawkesParamsFromJson(const std::string& path, HawkesParams& params) {
+    std::ifstream f(path);
+    if (!f) return false;
+    const std::string content((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
+    const char* json = content.c_str();
+
+    const char* p = findKey(json, "baseline");
+    params.baseline = HawkesBaseline::BOOK;
+    if (p) {
+        if (std::strncmp(p, "\"mu\"", 4) == 0) params.baseline = HawkesBaseline::MU;
+        else if (std::strncmp(p, "\"book\"", 6) != 0) return false;
+    }
+
+    std::vector<double> values;
+    p = findKey(json, "mu");
+    if (!p || !parseNumberArray(p, values) || values.size() != kTypes) return false;
+    for (size_t i = 0; i < kTypes; ++i) params.mu[i] = values[i];
+
+    std::vector<double> betas;
+    p = findKey(json, "beta");
+    if (!p || !parseNumberArray(p, betas)) return false;
+    params.kernels.assign(betas.size(), HawkesKernel{});
+
+    p = findKey(json, "alpha");
+    if (!p) return betas.empty();
+    skipWhitespace(p);
+    if (*p != '[') return false;
+    ++p;
+    for (size_t k = 0; k < betas.size(); ++k) {
+        if (k > 0) {
+            skipWhitespace(p);
+            if (*p != ',') return false;
+            ++p;
+        }
+        if (!parseNumberArray(p, values) || values.size() != kTypes * kTypes) return false;
+        params.kernels[k].beta = betas[k];
+        for (size_t i = 0; i < kTypes; ++i)
+            for (size_t j = 0; j < kTypes; ++j) params.kernels[k].alpha[i][j] = values[i * kTypes + j];
+    }
+    skipWhitespace(p);
+    return *p == ']';
+}
+
+}  // namespace qrsdp
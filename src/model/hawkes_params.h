@@ -0,0 +1,62 @@
+#pragma once
+
+#include "core/event_types.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace qrsdp {
+
+using HawkesMatrix = std::array<std::array<double, kNumEventTypes>, kNumEventTypes>;
+
+/// One exponential component of the excitation kernels: an event of type j
+/// raises type i's intensity by alpha[i][j], and the rise decays as
+/// exp(-beta * elapsed). Every type pair shares the kernel's decay rate.
+struct HawkesKernel {
+    double beta = 1.0;       // decay rate, 1/s (> 0)
+    HawkesMatrix alpha{};    // alpha[target][source] >= 0, in events/s
+};
+
+/// What the excitation sits on in qrsdp_run (and anything else that builds the
+/// model from a RunConfig).
+enum class HawkesBaseline : uint8_t {
+    BOOK = 0,  // the security's book-driven simple model; mu is unused
+    MU = 1,    // the constant mu: the model qrsdp_calibrate --hawkes fits
+};
+
+/// Multivariate Hawkes parameters over the six event types (EventType order):
+///   λ_i(t) = μ_i + Σ_k Σ_j Σ_{t_m < t, type j} alpha_k[i][j] · exp(-beta_k (t - t_m))
+/// μ is the constant baseline used when the model has no book-driven baseline.
+/// alpha is only meaningful with the baseline it was fitted or tuned against.
+struct HawkesParams {
+    std::array<double, kNumEventTypes> mu{};
+    std::vector<HawkesKernel> kernels;
+    HawkesBaseline baseline = HawkesBaseline::BOOK;
+};
+
+/// Self- and cross-excitation on realistic lines: executions cluster (two
+/// timescales), the side an execution hit is replenished, and adds and cancels
+/// mildly self-excite. Branching ratio 0.45. mu is zero (for use on top of a
+/// book-driven baseline).
+HawkesParams makeDefaultHawkesParams();
+
+/// Branching matrix G[i][j] = Σ_k alpha_k[i][j] / beta_k: expected type-i
+/// children of one type-j event.
+HawkesMatrix hawkesBranchingMatrix(const HawkesParams& params);
+
+/// Spectral radius of the branching matrix; the process is stationary below 1.
+double hawkesBranchingRatio(const HawkesParams& params);
+
+/// Throws std::invalid_argument unless every beta > 0, every alpha and mu >= 0
+/// (finite), the branching ratio is below 1 and, with the MU baseline, some mu > 0.
+void validateHawkesParams(const HawkesParams& params);
+
+/// JSON: {"baseline": "book"|"mu", "mu": [6], "beta": [K], "alpha": [[36 row-major,
+/// target-major] x K]}. A file without "baseline" is "book".
+bool saveHawkesParamsToJson(const std::string& path, const HawkesParams& params);
+/// Returns false if the file is missing or malformed (params then unspecified).
+bool loadHawkesParamsFromJson(const std::string& path, HawkesParams& params);
+
+}  // namespace qrsdp
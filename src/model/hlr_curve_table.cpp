@@ -0,0 +1,66 @@
+#include "model/hlr_curve_table.h"
+
+namespace qrsdp {
+
+namespace {
+
+constexpr size_t kRatesPerLine = 4;
+
+const IntensityCurve* curveAt(const std::vector<IntensityCurve>& curves, size_t i) {
+    return i < curves.size() ? &curves[i] : nullptr;
+}
+
+double sample(const IntensityCurve* curve, size_t n) {
+    return curve ? curve->value(n) : 0.0;
+}
+
+}  // namespace
+
+HLRCurveTable::HLRCurveTable(const HLRParams& params) {
+    levels_ = params.K > 0 ? static_cast<size_t>(params.K) : 0;
+
+    size_t n_max = std::max(params.lambda_M_buy.nMax(), params.lambda_M_sell.nMax());
+    for (const auto* set : {&params.lambda_L_bid, &params.lambda_L_ask,
+                            &params.lambda_C_bid, &params.lambda_C_ask}) {
+        for (const IntensityCurve& c : *set) n_max = std::max(n_max, c.nMax());
+    }
+    // Index n_max + 1 holds the tail: value(n) is constant for every n > n_max.
+    last_ = n_max + 1;
+    const size_t row_len = last_ + 1;
+    row_stride_ = (row_len + kRatesPerLine - 1) / kRatesPerLine * kRatesPerLine;
+
+    auto lines = std::make_shared<std::vector<CacheLine>>(rowCount() * row_stride_ / kRatesPerLine);
+    Rates* base = reinterpret_cast<Rates*>(lines->data());
+    rows_ = base;
+    storage_ = std::move(lines);
+    for (size_t i = 0; i < levels_; ++i) {
+        const IntensityCurve* bid_l = curveAt(params.lambda_L_bid, i);
+        const IntensityCurve* bid_c = curveAt(params.lambda_C_bid, i);
+        const IntensityCurve* ask_l = curveAt(params.lambda_L_ask, i);
+        const IntensityCurve* ask_c = curveAt(params.lambda_C_ask, i);
+        Rates* bid = base + (2 * i) * row_stride_;
+        Rates* ask = bid + row_stride_;
+        for (size_t n = 0; n < row_len; ++n) {
+            bid[n] = Rates{sample(bid_l, n), sample(bid_c, n)};
+            ask[n] = Rates{sample(ask_l, n), sample(ask_c, n)};
+        }
+    }
+    Rates* market = base + 2 * levels_ * row_stride_;
+    for (size_t n = 0; n < row_len; ++n) {
+        market[n] = Rates{params.lambda_M_buy.value(n), 0.0};
+        market[row_stride_ + n] = Rates{params.lambda_M_sell.value(n), 0.0};
+    }
+}
+
+HLRCurveTable HLRCurveTable::view(const Rates* rows, size_t levels, size_t row_length,
+                                  size_t row_stride, std::shared_ptr<const void> owner) {
+    HLRCurveTable t;
+    t.levels_ = levels;
+    t.row_stride_ = row_stride;
+    t.last_ = row_length > 0 ? row_length - 1 : 0;
+    t.rows_ = rows;
+    t.storage_ = std::move(owner);
+    return t;
+}
+
+}  // namespace qrsdp
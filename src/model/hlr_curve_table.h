@@ -0,0 +1,93 @@
+#pragma once
+
+#include "model/hlr_params.h"
+#include "core/event_types.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace qrsdp {
+
+/// Immutable, flattened copy of an HLRParams curve set for the per-event lookups.
+///
+/// Every curve is resampled onto one row length R = (largest n_max) + 2 with its
+/// tail rule baked in: entries past the curve's own n_max hold the tail value, and
+/// the final entry stands for every n beyond the table, so a lookup is a clamp and
+/// a load with no branching on the rule. Rows live in one 64-byte aligned block,
+/// laid out [level][side][n][add, cancel]: the add and cancel rates a queue-size
+/// change needs sit in the same 16 bytes. Values equal IntensityCurve::value().
+///
+/// The block is shared, not copied, between copies of a table, and a table can be
+/// a view of rows stored elsewhere in the same layout (an mmapped HLRCurveBundle):
+/// many models then read one set of curves.
+class HLRCurveTable {
+public:
+    struct Rates {
+        double add;
+        double cancel;
+    };
+
+    HLRCurveTable() = default;
+    explicit HLRCurveTable(const HLRParams& params);
+
+    /// Table over rowCount() rows of row_stride Rates each, laid out as rowData()
+    /// (row_stride a multiple of 4, rows 64-byte aligned). owner keeps them alive.
+    static HLRCurveTable view(const Rates* rows, size_t levels, size_t row_length,
+                              size_t row_stride, std::shared_ptr<const void> owner);
+
+    /// Add and cancel intensity of the queue at `level` on `side` holding n orders.
+    /// Levels beyond the curve set give zero rates.
+    Rates levelRates(size_t level, Side side, size_t n) const {
+        if (level >= levels_) return Rates{0.0, 0.0};
+        const Rates* row = rows() + (2 * level + (side == Side::BID ? 0 : 1)) * row_stride_;
+        return row[std::min(n, last_)];
+    }
+    /// lambda_M_buy(n) at the best ask / lambda_M_sell(n) at the best bid.
+    double marketBuy(size_t n) const { return marketRows()[std::min(n, last_)].add; }
+    double marketSell(size_t n) const { return marketRows()[row_stride_ + std::min(n, last_)].add; }
+
+    size_t levels() const { return levels_; }
+    /// Entries per row (largest n_max + 2).
+    size_t rowLength() const { return last_ + 1; }
+    /// Rates between row starts (rowLength() rounded up to whole cache lines).
+    size_t rowStride() const { return row_stride_; }
+    /// 2 * levels() + 2: bid and ask per level, then market buy and sell.
+    size_t rowCount() const { return 2 * levels_ + 2; }
+    /// The rows: [level][bid, ask][n] {add, cancel}, then the two market rows.
+    const Rates* rowData() const { return rows_; }
+
+private:
+    struct alignas(64) CacheLine { Rates r[4]; };
+
+    const Rates* rows() const { return rows_; }
+    /// Two rows after the level rows (buy, sell); the rate is in .add.
+    const Rates* marketRows() const { return rows() + 2 * levels_ * row_stride_; }
+
+    std::shared_ptr<const void> storage_;  // owns rows_: a CacheLine vector or a mapping
+    const Rates* rows_ = nullptr;
+    size_t levels_ = 0;
+    size_t row_stride_ = 0;  // in Rates, padded to whole cache lines
+    size_t last_ = 0;        // clamp index: rowLength() - 1
+};
+
+/// What a CurveIntensityModel reads: the table and the two feedback strengths.
+/// Immutable once built, so one instance (behind a shared_ptr<const>) serves
+/// every model and thread that runs the same params.
+struct HLRModelCurves {
+    HLRModelCurves() = default;
+    explicit HLRModelCurves(const HLRParams& params)
+        : table(params),
+          spread_sensitivity(params.spread_sensitivity),
+          imbalance_sensitivity(params.imbalance_sensitivity) {}
+    HLRModelCurves(HLRCurveTable t, double spread, double imbalance)
+        : table(std::move(t)), spread_sensitivity(spread), imbalance_sensitivity(imbalance) {}
+
+    HLRCurveTable table;
+    double spread_sensitivity = 0.0;
+    double imbalance_sensitivity = 0.0;
+};
+
+}  // namespace qrsdp
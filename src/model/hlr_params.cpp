@@ -126,6 +126,27 @@ const char* findKey(const char* json, const char* key) {
     return pos;
 }
 
+bool readFile(const std::string& path, std::string& content) {
+    std::ifstream f(path);
+    if (!f) return false;
+    content.assign((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
+    return true;
+}
+
+/// Optional seasonality keys; absent keys leave an empty profile. False only if malformed.
+bool parseSeasonality(const char* json, SeasonalityProfile& profile) {
+    profile = SeasonalityProfile{};
+    const char* p = findKey(json, "seasonality_bucket_seconds");
+    const char* arr = findKey(json, "seasonality");
+    if (!p && !arr) return true;
+    double bucket = 0.0;
+    std::vector<double> values;
+    if (!p || !parseDouble(p, bucket) || !(bucket > 0.0)) return false;
+    if (!arr || !parseNumberArray(arr, values) || values.empty()) return false;
+    profile = SeasonalityProfile(bucket, std::move(values));
+    return true;
+}
+
 }  // namespace
 
 HLRParams makeDefaultHLRParams(int K, int n_max) {
@@ -189,6 +210,13 @@ bool saveHLRParamsToJson(const std::string& path, const HLRParams& params) {
     f << ",\n";
     f << "  \"lambda_M_sell\": ";
     writeCurveArray(f, params.lambda_M_sell);
+    if (!params.seasonality.empty()) {
+        f << ",\n  \"seasonality_bucket_seconds\": " << params.seasonality.bucketSeconds() << ",\n";
+        f << "  \"seasonality\": [";
+        const std::vector<double>& m = params.seasonality.multipliers();
+        for (size_t i = 0; i < m.size(); ++i) f << (i ? "," : "") << m[i];
+        f << "]";
+    }
     f << "\n";
 
     f << "}\n";
@@ -253,7 +281,14 @@ bool loadHLRParamsFromJson(const std::string& path, HLRParams& params) {
     if (!loadSingleCurve("lambda_M_buy", params.lambda_M_buy)) return false;
     if (!loadSingleCurve("lambda_M_sell", params.lambda_M_sell)) return false;
 
-    return true;
+    return parseSeasonality(json, params.seasonality);
+}
+
+bool loadSeasonalityFromJson(const std::string& path, SeasonalityProfile& profile) {
+    std::string content;
+    if (!readFile(path, content)) return false;
+    if (!parseSeasonality(content.c_str(), profile)) return false;
+    return !profile.empty();
 }
 
 }  // namespace qrsdp
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "model/intensity_curve.h"
+#include "model/seasonality_profile.h"
 #include <cstddef>
 #include <string>
 #include <vector>
@@ -30,6 +31,9 @@ struct HLRParams {
     IntensityCurve lambda_M_buy;
     IntensityCurve lambda_M_sell;
 
+    /// Optional intraday profile ("seasonality_bucket_seconds" + "seasonality" in JSON).
+    SeasonalityProfile seasonality;
+
     /// True if curves have been populated (loaded from JSON or built from defaults).
     bool hasCurves() const { return !lambda_L_bid.empty(); }
 };
@@ -43,4 +47,8 @@ bool saveHLRParamsToJson(const std::string& path, const HLRParams& params);
 /// Load full HLRParams from JSON file. Returns true on success.
 bool loadHLRParamsFromJson(const std::string& path, HLRParams& params);
 
+/// Load just the seasonality keys from a JSON file (an HLR curves file or a file
+/// holding only "seasonality_bucket_seconds" and "seasonality"). Returns true on success.
+bool loadSeasonalityFromJson(const std::string& path, SeasonalityProfile& profile);
+
 }  // namespace qrsdp
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "model/hlr_curve_table.h"
+#include "model/hlr_params.h"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+namespace qrsdp {
+
+/// Latest-value slot for HLRParams handed from a publisher thread (a live
+/// calibration, a file watcher) to running models. Readers poll version() — one
+/// acquire load — and take the params with latest() only when it has moved, so a
+/// model can follow a channel from its hot path; publish() swaps in a complete
+/// set under the lock, so no reader sees half an update. publish() also builds
+/// the curve table, once, on the publisher's thread: every following model
+/// adopts that one instance.
+class HLRParamsChannel {
+public:
+    void publish(HLRParams params) {
+        auto next = std::make_shared<const HLRParams>(std::move(params));
+        std::shared_ptr<const HLRModelCurves> curves;
+        if (next->hasCurves()) curves = std::make_shared<const HLRModelCurves>(*next);
+        std::lock_guard<std::mutex> lock(mutex_);
+        params_ = std::move(next);
+        curves_ = std::move(curves);
+        version_.fetch_add(1, std::memory_order_release);
+    }
+
+    /// 0 until the first publish; increments once per publish.
+    uint64_t version() const { return version_.load(std::memory_order_acquire); }
+
+    /// The last published params (null before the first publish) and their version.
+    std::shared_ptr<const HLRParams> latest(uint64_t* version_out = nullptr) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (version_out) *version_out = version_.load(std::memory_order_relaxed);
+        return params_;
+    }
+
+    /// The last published params' curves (null before the first publish, or if
+    /// they had none) and their version.
+    std::shared_ptr<const HLRModelCurves> latestCurves(uint64_t* version_out = nullptr) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (version_out) *version_out = version_.load(std::memory_order_relaxed);
+        return curves_;
+    }
+
+private:
+    mutable std::mutex mutex_;
+    std::shared_ptr<const HLRParams> params_;
+    std::shared_ptr<const HLRModelCurves> curves_;
+    std::atomic<uint64_t> version_{0};
+};
+
+}  // namespace qrsdp
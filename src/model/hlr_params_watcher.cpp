@@ -0,0 +1,59 @@
+#include "model/hlr_params_watcher.h"
+
+#include <chrono>
+#include <cstdio>
+#include <system_error>
+#include <utility>
+
+namespace qrsdp {
+
+HLRParamsWatcher::HLRParamsWatcher(std::string path, HLRParamsChannel& channel, uint32_t interval_ms)
+    : path_(std::move(path)), channel_(channel), interval_ms_(interval_ms > 0 ? interval_ms : 1) {}
+
+HLRParamsWatcher::~HLRParamsWatcher() { stop(); }
+
+bool HLRParamsWatcher::start() {
+    const bool loaded = poll();
+    running_ = true;
+    thread_ = std::thread([this] { run(); });
+    return loaded;
+}
+
+void HLRParamsWatcher::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        running_ = false;
+    }
+    cv_.notify_all();
+    if (thread_.joinable()) thread_.join();
+}
+
+void HLRParamsWatcher::run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (running_) {
+        cv_.wait_for(lock, std::chrono::milliseconds(interval_ms_), [this] { return !running_; });
+        if (!running_) break;
+        lock.unlock();
+        poll();
+        lock.lock();
+    }
+}
+
+bool HLRParamsWatcher::poll() {
+    std::error_code ec;
+    const std::filesystem::file_time_type t = std::filesystem::last_write_time(path_, ec);
+    if (ec || (seen_ && t == last_write_)) return false;
+    last_write_ = t;
+    seen_ = true;
+    HLRParams params;
+    if (!loadHLRParamsFromJson(path_, params) || !params.hasCurves()) {
+        std::fprintf(stderr, "HLRParamsWatcher: cannot load %s, keeping the current curves\n",
+                     path_.c_str());
+        return false;
+    }
+    channel_.publish(std::move(params));
+    reloads_.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+}  // namespace qrsdp
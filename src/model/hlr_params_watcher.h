@@ -0,0 +1,52 @@
+#pragma once
+
+#include "model/hlr_params_channel.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace qrsdp {
+
+/// Publishes an HLRParams JSON file into a channel whenever it changes: a
+/// background thread compares the file's modification time every interval_ms and
+/// reloads it. Writers should replace the file by rename (qrsdp_calibrate --kafka
+/// does), so a load never sees half a file; one that fails to parse is skipped
+/// until the file changes again.
+class HLRParamsWatcher {
+public:
+    HLRParamsWatcher(std::string path, HLRParamsChannel& channel, uint32_t interval_ms = 1000);
+    ~HLRParamsWatcher();
+
+    HLRParamsWatcher(const HLRParamsWatcher&) = delete;
+    HLRParamsWatcher& operator=(const HLRParamsWatcher&) = delete;
+
+    /// Loads the file once now if it exists (true if it was published), then
+    /// starts watching.
+    bool start();
+    /// Stops and joins the thread. Idempotent.
+    void stop();
+
+    uint64_t reloads() const { return reloads_.load(std::memory_order_relaxed); }
+
+private:
+    void run();
+    bool poll();
+
+    std::string path_;
+    HLRParamsChannel& channel_;
+    uint32_t interval_ms_;
+    std::filesystem::file_time_type last_write_{};
+    bool seen_ = false;
+    std::atomic<uint64_t> reloads_{0};
+    std::atomic<bool> running_{false};
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::thread thread_;
+};
+
+}  // namespace qrsdp
@@ -1,10 +1,42 @@
 #pragma once
 
 #include "core/records.h"
+#include <cstddef>
+#include <cstdint>
 #include <vector>
 
 namespace qrsdp {
 
+/// Entries of the per-level weight vector rewritten by the last compute()/update().
+/// all = every entry may differ (count/index unused).
+struct PerLevelChange {
+    bool   all = true;
+    size_t count = 0;
+    size_t index[4] = {};
+};
+
+/// Book features of many books for computeBatch(), structure-of-arrays: entry i
+/// of every array is book i.
+struct BookFeatureBatch {
+    size_t count = 0;
+    const double* imbalance = nullptr;
+    const int* spread_ticks = nullptr;
+    const uint32_t* q_bid_best = nullptr;
+    const uint32_t* q_ask_best = nullptr;
+    const uint64_t* total_bid_depth = nullptr;  // summed over the levels (0: q_bid_best)
+    const uint64_t* total_ask_depth = nullptr;
+};
+
+/// computeBatch() output: one array per rate, each with room for count entries.
+struct IntensityBatch {
+    double* add_bid = nullptr;
+    double* add_ask = nullptr;
+    double* cancel_bid = nullptr;
+    double* cancel_ask = nullptr;
+    double* exec_buy = nullptr;
+    double* exec_sell = nullptr;
+};
+
 /// Intensities from book state. Deterministic; no RNG.
 /// Implementations may use state.features only (legacy) or full per-level state (HLR).
 class IIntensityModel {
@@ -12,6 +44,13 @@ public:
     virtual ~IIntensityModel() = default;
     virtual Intensities compute(const BookState& state) const = 0;
 
+    /// Optional incremental path: `state` differs from the state passed to the previous
+    /// compute()/update() only at the levels named by `delta`. Default: full compute().
+    virtual Intensities update(const BookState& state, const BookDelta& delta) const {
+        (void)delta;
+        return compute(state);
+    }
+
     /// Optional: per-level intensities for (level, type) categorical sampling.
     /// If true, weights_out has 4*K+2 entries: [add_bid_0..add_bid_{K-1}, add_ask_0.., cancel_bid_0.., cancel_ask_0.., exec_buy, exec_sell].
     /// Producer samples index then decodes to (EventType, level). Default: false.
@@ -19,6 +58,57 @@ public:
         (void)weights_out;
         return false;
     }
+
+    /// Optional no-copy view of the same per-level weights (valid until the next
+    /// compute()/update()). nullptr = use getPerLevelIntensities().
+    virtual const std::vector<double>* perLevelView() const { return nullptr; }
+
+    /// Which perLevelView() entries the last compute()/update() rewrote. Default: all.
+    virtual PerLevelChange lastPerLevelChange() const { return PerLevelChange{}; }
+
+    /// Optional: compute() for books.count books with this model's params in one
+    /// call, from their features alone, laid out for SIMD across the books. Entry
+    /// i equals compute() of a state with book i's features and depth totals.
+    /// Models that need per-level depths return false. Default: false.
+    /// Not on the producer's step path: lanes step one book at a time through
+    /// update(), so only qrsdp_bench and the tests call this today.
+    virtual bool computeBatch(const BookFeatureBatch& books, IntensityBatch& out) const {
+        (void)books;
+        (void)out;
+        return false;
+    }
+
+    // --- Event history (self-exciting models) ---
+    // A model whose intensities also depend on past events keeps that history
+    // itself. The producer then thins candidate times against totalAt() and
+    // reports each event; every other model ignores these hooks.
+
+    /// True if intensities depend on the event history. Default: false.
+    virtual bool selfExciting() const { return false; }
+    /// Forgets every past event; the clock starts at session time t.
+    virtual void resetHistory(double t) { (void)t; }
+    /// Moves the clock forward to t (>= the current clock) without an event;
+    /// the next compute()/update() is at t.
+    virtual void advanceTo(double t) { (void)t; }
+    /// Records an event of type at the clock (after advanceTo(event time)).
+    virtual void onEvent(EventType type) { (void)type; }
+    /// Total intensity at session time t >= the clock if no event happens
+    /// before t and the book stays as the last compute()/update() saw it.
+    /// Non-increasing in t, so totalAt(clock) bounds it until the next event:
+    /// the upper bound that thinning needs. Default: 0 (not self-exciting).
+    virtual double totalAt(double t) const {
+        (void)t;
+        return 0.0;
+    }
+    /// The history as plain values, clock included, for snapshots and checkpoints.
+    /// Default: empty (no history).
+    virtual std::vector<double> saveHistory() const { return {}; }
+    /// Puts back saveHistory() output of a model with the same shape; an empty
+    /// history is resetHistory(t). Throws std::invalid_argument if it does not fit.
+    virtual void restoreHistory(const std::vector<double>& history, double t) {
+        (void)history;
+        resetHistory(t);
+    }
 };
 
 }  // namespace qrsdp
@@ -0,0 +1,17 @@
+#pragma once
+
+namespace qrsdp {
+
+/// Deterministic time-of-session multiplier applied to every intensity:
+/// λ_i(t) = at(t) · λ_i(book state). No RNG.
+class IIntensityScale {
+public:
+    virtual ~IIntensityScale() = default;
+    /// Multiplier at session time t (seconds since open); >= 0.
+    virtual double at(double t) const = 0;
+    /// An upper bound of at() over [t0, t1). Tighter bounds mean fewer rejected
+    /// candidates in ThinningSampler.
+    virtual double bound(double t0, double t1) const = 0;
+};
+
+}  // namespace qrsdp
@@ -0,0 +1,37 @@
+#include "model/seasonality_profile.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace qrsdp {
+
+SeasonalityProfile::SeasonalityProfile(double bucket_seconds, std::vector<double> multipliers)
+    : bucket_seconds_(bucket_seconds), multipliers_(std::move(multipliers)) {
+    for (double& m : multipliers_) {
+        if (!std::isfinite(m) || m < 0.0) m = 0.0;
+    }
+}
+
+size_t SeasonalityProfile::bucketAt(double t) const {
+    if (!(t > 0.0)) return 0;
+    const double b = std::floor(t / bucket_seconds_);
+    const double last = static_cast<double>(multipliers_.size() - 1);
+    return static_cast<size_t>(std::min(b, last));
+}
+
+double SeasonalityProfile::bucketEnd(size_t bucket) const {
+    if (bucket + 1 >= multipliers_.size()) return std::numeric_limits<double>::infinity();
+    return static_cast<double>(bucket + 1) * bucket_seconds_;
+}
+
+double SeasonalityProfile::bound(double t0, double t1) const {
+    if (empty()) return 1.0;
+    const size_t b0 = bucketAt(t0);
+    size_t b1 = bucketAt(t1);
+    // [t0, t1) excludes t1: a window ending exactly on a boundary stays in b1 - 1.
+    if (b1 > b0 && static_cast<double>(b1) * bucket_seconds_ >= t1) --b1;
+    return *std::max_element(multipliers_.begin() + static_cast<std::ptrdiff_t>(b0),
+                             multipliers_.begin() + static_cast<std::ptrdiff_t>(b1) + 1);
+}
+
+}  // namespace qrsdp
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "model/i_intensity_scale.h"
+#include <cstddef>
+#include <vector>
+
+namespace qrsdp {
+
+/// Intraday activity profile: a piecewise-constant multiplier on every intensity,
+/// one value per bucket_seconds of session time (bucket b covers
+/// [b * bucket_seconds, (b + 1) * bucket_seconds)). Times past the last bucket use
+/// the last multiplier. Empty profile = no seasonality.
+class SeasonalityProfile final : public IIntensityScale {
+public:
+    SeasonalityProfile() = default;
+    /// Negative or non-finite multipliers are clamped to 0.
+    SeasonalityProfile(double bucket_seconds, std::vector<double> multipliers);
+
+    bool empty() const { return multipliers_.empty() || !(bucket_seconds_ > 0.0); }
+    size_t buckets() const { return multipliers_.size(); }
+    double bucketSeconds() const { return bucket_seconds_; }
+    const std::vector<double>& multipliers() const { return multipliers_; }
+
+    /// Bucket holding session time t (clamped to the last bucket).
+    size_t bucketAt(double t) const;
+    double multiplier(size_t bucket) const { return multipliers_[bucket]; }
+    /// End of bucket b in session seconds; the last bucket never ends.
+    double bucketEnd(size_t bucket) const;
+
+    double at(double t) const override { return empty() ? 1.0 : multipliers_[bucketAt(t)]; }
+    double bound(double t0, double t1) const override;
+
+private:
+    double bucket_seconds_ = 0.0;
+    std::vector<double> multipliers_;
+};
+
+}  // namespace qrsdp
@@ -1,32 +1,41 @@
 #include "model/simple_imbalance_intensity.h"
+#include "book/depth_reduce.h"
 #include <algorithm>
 #include <cmath>
 #include <cstdint>
+#include <limits>
 
 namespace qrsdp {
 
 namespace {
 
 constexpr double kEpsilon = 1e-9;
+constexpr size_t kBatchBlock = 64;
 
 double clampNonNegative(double x) {
     if (std::isnan(x) || std::isinf(x) || x < 0.0) return kEpsilon;
     return std::max(x, kEpsilon);
 }
 
+/// clampNonNegative() as a select: NaN, infinities, negatives and values below
+/// kEpsilon all fail the test.
+inline double clampSelect(double x) {
+    return (x >= kEpsilon && x <= std::numeric_limits<double>::max()) ? x : kEpsilon;
+}
+
 }  // namespace
 
 SimpleImbalanceIntensity::SimpleImbalanceIntensity(const IntensityParams& params)
-    : params_(params) {}
+    : params_(params), spread_feedback_(params.spread_sensitivity) {}
 
 Intensities SimpleImbalanceIntensity::compute(const BookState& state) const {
     const BookFeatures& f = state.features;
     const double I = std::isnan(f.imbalance) ? 0.0 : f.imbalance;
 
-    double total_bid_depth = 0.0;
-    double total_ask_depth = 0.0;
-    for (auto d : state.bid_depths) total_bid_depth += static_cast<double>(d);
-    for (auto d : state.ask_depths) total_ask_depth += static_cast<double>(d);
+    double total_bid_depth =
+        static_cast<double>(sumDepths(state.bid_depths.data(), state.bid_depths.size()));
+    double total_ask_depth =
+        static_cast<double>(sumDepths(state.ask_depths.data(), state.ask_depths.size()));
     if (total_bid_depth == 0.0) total_bid_depth = static_cast<double>(f.q_bid_best);
     if (total_ask_depth == 0.0) total_ask_depth = static_cast<double>(f.q_ask_best);
 
@@ -34,11 +43,10 @@ Intensities SimpleImbalanceIntensity::compute(const BookState& state) const {
     const double sC = (params_.cancel_sensitivity > 0.0) ? params_.cancel_sensitivity : 1.0;
 
     // Spread-dependent feedback: wide spread attracts limit orders, dampens executions.
-    // Uses exp(±sS * (spread - 2)) so that spread=2 is neutral (multiplier=1).
-    const double sS = params_.spread_sensitivity;
-    const double spread_delta = static_cast<double>(f.spread_ticks) - 2.0;
-    const double add_spread_mult = (sS > 0.0) ? std::exp(sS * spread_delta) : 1.0;
-    const double exec_spread_mult = (sS > 0.0) ? std::exp(-sS * spread_delta) : 1.0;
+    // exp(±sS * (spread - 2)), tabulated per spread; spread=2 is neutral (multiplier=1).
+    const SpreadFeedback::Multipliers spread_mult = spread_feedback_.at(f.spread_ticks);
+    const double add_spread_mult = spread_mult.add;
+    const double exec_spread_mult = spread_mult.exec;
 
     const double add_bid = params_.base_L * (1.0 - sI * I) * add_spread_mult;
     const double add_ask = params_.base_L * (1.0 + sI * I) * add_spread_mult;
@@ -58,4 +66,52 @@ Intensities SimpleImbalanceIntensity::compute(const BookState& state) const {
     return out;
 }
 
+bool SimpleImbalanceIntensity::computeBatch(const BookFeatureBatch& books, IntensityBatch& out) const {
+    const double sI = (params_.imbalance_sensitivity > 0.0) ? params_.imbalance_sensitivity : 1.0;
+    const double sC = (params_.cancel_sensitivity > 0.0) ? params_.cancel_sensitivity : 1.0;
+    const double eps_exec = (params_.epsilon_exec > 0.0) ? params_.epsilon_exec : 0.05;
+    const double base_L = params_.base_L;
+    const double base_M = params_.base_M;
+    const double cancel_scale = params_.base_C * sC;
+
+    double add_mult[kBatchBlock];
+    double exec_mult[kBatchBlock];
+    for (size_t start = 0; start < books.count; start += kBatchBlock) {
+        const size_t n = std::min(kBatchBlock, books.count - start);
+        // Scalar pass: the spread table lookup (a gather, with the exp fallback).
+        for (size_t i = 0; i < n; ++i) {
+            const SpreadFeedback::Multipliers m = spread_feedback_.at(books.spread_ticks[start + i]);
+            add_mult[i] = m.add;
+            exec_mult[i] = m.exec;
+        }
+        const double* imb = books.imbalance + start;
+        const uint32_t* q_bid = books.q_bid_best + start;
+        const uint32_t* q_ask = books.q_ask_best + start;
+        const uint64_t* bid_depth = books.total_bid_depth + start;
+        const uint64_t* ask_depth = books.total_ask_depth + start;
+        double* add_bid = out.add_bid + start;
+        double* add_ask = out.add_ask + start;
+        double* cancel_bid = out.cancel_bid + start;
+        double* cancel_ask = out.cancel_ask + start;
+        double* exec_buy = out.exec_buy + start;
+        double* exec_sell = out.exec_sell + start;
+        // Vector pass: compute()'s expressions, in its order, as selects.
+        for (size_t i = 0; i < n; ++i) {
+            const double I = imb[i] == imb[i] ? imb[i] : 0.0;
+            const double bid_total = bid_depth[i] != 0 ? static_cast<double>(bid_depth[i])
+                                                       : static_cast<double>(q_bid[i]);
+            const double ask_total = ask_depth[i] != 0 ? static_cast<double>(ask_depth[i])
+                                                       : static_cast<double>(q_ask[i]);
+            const double sII = sI * I;
+            add_bid[i] = clampSelect(base_L * (1.0 - sII) * add_mult[i]);
+            add_ask[i] = clampSelect(base_L * (1.0 + sII) * add_mult[i]);
+            exec_sell[i] = clampSelect(base_M * (eps_exec + std::max(sII, 0.0)) * exec_mult[i]);
+            exec_buy[i] = clampSelect(base_M * (eps_exec + std::max(-sII, 0.0)) * exec_mult[i]);
+            cancel_bid[i] = clampSelect(cancel_scale * bid_total);
+            cancel_ask[i] = clampSelect(cancel_scale * ask_total);
+        }
+    }
+    return true;
+}
+
 }  // namespace qrsdp
@@ -1,18 +1,24 @@
 #pragma once
 
 #include "model/i_intensity_model.h"
+#include "model/spread_feedback.h"
 #include "core/records.h"
 
 namespace qrsdp {
 
 /// Simple imbalance-driven intensities: add mean-reverts, exec follows pressure, cancel ∝ queue.
-class SimpleImbalanceIntensity : public IIntensityModel {
+class SimpleImbalanceIntensity final : public IIntensityModel {
 public:
     explicit SimpleImbalanceIntensity(const IntensityParams& params);
     Intensities compute(const BookState& state) const override;
+    /// The same arithmetic as compute() as branch-free passes over blocks of
+    /// books, which the compiler vectorizes (AVX2 / AVX-512 with
+    /// -DQRSDP_NATIVE_ARCH=ON); only the spread lookup stays scalar.
+    bool computeBatch(const BookFeatureBatch& books, IntensityBatch& out) const override;
 
 private:
     IntensityParams params_;
+    SpreadFeedback spread_feedback_;
 };
 
 }  // namespace qrsdp
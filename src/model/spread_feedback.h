@@ -0,0 +1,44 @@
+#pragma once
+
+#include <array>
+#include <cmath>
+
+namespace qrsdp {
+
+/// Spread feedback multipliers shared by the intensity models:
+/// add = exp(sS * (spread - 2)), exec = exp(-sS * (spread - 2)), so spread 2 is neutral.
+/// The spread is a small tick count, so both are tabulated once at construction
+/// for spreads 0..kTabulatedSpreads-1; wider (or negative) spreads fall back to
+/// std::exp. Values are bit-identical to evaluating the exponentials per event.
+class SpreadFeedback {
+public:
+    static constexpr int kTabulatedSpreads = 64;
+
+    struct Multipliers {
+        double add;
+        double exec;
+    };
+
+    /// sensitivity <= 0 disables the feedback (both multipliers 1).
+    explicit SpreadFeedback(double sensitivity) : sS_(sensitivity) {
+        for (int s = 0; s < kTabulatedSpreads; ++s) table_[static_cast<size_t>(s)] = evaluate(s);
+    }
+
+    Multipliers at(int spread_ticks) const {
+        if (spread_ticks >= 0 && spread_ticks < kTabulatedSpreads)
+            return table_[static_cast<size_t>(spread_ticks)];
+        return evaluate(spread_ticks);
+    }
+
+private:
+    Multipliers evaluate(int spread_ticks) const {
+        if (!(sS_ > 0.0)) return Multipliers{1.0, 1.0};
+        const double spread_delta = static_cast<double>(spread_ticks) - 2.0;
+        return Multipliers{std::exp(sS_ * spread_delta), std::exp(-sS_ * spread_delta)};
+    }
+
+    double sS_;
+    std::array<Multipliers, kTabulatedSpreads> table_{};
+};
+
+}  // namespace qrsdp
@@ -0,0 +1,151 @@
+#include "montecarlo/monte_carlo.h"
+#ifdef QRSDP_CUDA_ENABLED
+#include "montecarlo/monte_carlo_cuda.h"
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+namespace qrsdp {
+
+namespace {
+
+constexpr uint64_t kPathsPerTask = 64;
+
+}  // namespace
+
+MonteCarloConfig monteCarloConfigFor(const TradingSession& session, uint64_t paths) {
+    MonteCarloConfig config;
+    config.seed = session.seed;
+    config.paths = paths;
+    config.session_seconds = session.session_seconds;
+    config.p0_ticks = session.p0_ticks;
+    config.levels_per_side = session.levels_per_side;
+    // The producer's defaults for unset seeds.
+    config.initial_spread_ticks = session.initial_spread_ticks > 0 ? session.initial_spread_ticks : 2u;
+    config.initial_depth = session.initial_depth > 0 ? session.initial_depth : 50u;
+    config.market_open_seconds = session.market_open_seconds;
+    config.intensity = session.intensity_params;
+    if (session.queue_reactive.theta_reinit > 0.0)
+        throw std::invalid_argument("monte carlo: theta_reinit is not supported");
+    return config;
+}
+
+mc::PathParams makePathParams(const MonteCarloConfig& config) {
+    if (config.levels_per_side < 1 || config.levels_per_side > mc::kMaxPathLevels)
+        throw std::invalid_argument("monte carlo: levels_per_side must be 1.." +
+                                    std::to_string(mc::kMaxPathLevels));
+    if (config.session_seconds == 0)
+        throw std::invalid_argument("monte carlo: session_seconds must be positive");
+
+    mc::PathParams p{};
+    const IntensityParams& ip = config.intensity;
+    p.base_L = ip.base_L;
+    p.base_M = ip.base_M;
+    p.cancel_scale = ip.base_C * (ip.cancel_sensitivity > 0.0 ? ip.cancel_sensitivity : 1.0);
+    p.imbalance_sensitivity = ip.imbalance_sensitivity > 0.0 ? ip.imbalance_sensitivity : 1.0;
+    p.epsilon_exec = ip.epsilon_exec > 0.0 ? ip.epsilon_exec : 0.05;
+    p.spread_sensitivity = ip.spread_sensitivity;
+    for (int s = 0; s < mc::kPathSpreadTable; ++s) {
+        const double delta = static_cast<double>(s) - 2.0;
+        const bool on = ip.spread_sensitivity > 0.0;
+        p.spread_add[s] = on ? std::exp(ip.spread_sensitivity * delta) : 1.0;
+        p.spread_exec[s] = on ? std::exp(-ip.spread_sensitivity * delta) : 1.0;
+    }
+
+    double total = 0.0;
+    for (uint32_t k = 0; k < config.levels_per_side; ++k)
+        total += std::exp(-config.level_alpha * static_cast<double>(k));
+    double cum = 0.0;
+    for (uint32_t k = 0; k < config.levels_per_side; ++k) {
+        cum += std::exp(-config.level_alpha * static_cast<double>(k));
+        p.level_cdf[k] = cum / total;
+    }
+    p.spread_improve_coeff = config.spread_improve_coeff;
+
+    p.session_seconds = static_cast<double>(config.session_seconds);
+    p.market_open_ns = static_cast<uint64_t>(config.market_open_seconds) * 1'000'000'000ULL;
+    p.seed = config.seed;
+    p.p0_ticks = config.p0_ticks;
+    p.levels = config.levels_per_side;
+    p.initial_depth = config.initial_depth > 0 ? config.initial_depth : 50u;
+    p.initial_spread_ticks = config.initial_spread_ticks > 0 ? config.initial_spread_ticks : 2u;
+    p.records_per_path = config.records_per_path;
+    return p;
+}
+
+PathSummary summarizePath(const mc::PathState& state) {
+    PathSummary out;
+    out.open_ticks = state.open_ticks;
+    out.high_ticks = state.high_ticks;
+    out.low_ticks = state.low_ticks;
+    out.close_ticks = mc::pathMid(state);
+    out.events = state.events;
+    out.shifts = state.shifts;
+    std::copy(state.type_counts, state.type_counts + kNumEventTypes, out.type_counts);
+    return out;
+}
+
+MonteCarloResult runMonteCarloCpu(const MonteCarloConfig& config, unsigned threads) {
+    const mc::PathParams params = makePathParams(config);
+    MonteCarloResult result;
+    result.paths.resize(config.paths);
+    result.records.resize(config.paths * params.records_per_path);
+
+    std::atomic<uint64_t> next{0};
+    auto work = [&] {
+        mc::PathState state;
+        for (;;) {
+            const uint64_t begin = next.fetch_add(kPathsPerTask);
+            if (begin >= config.paths) break;
+            const uint64_t end = std::min(begin + kPathsPerTask, config.paths);
+            for (uint64_t i = begin; i < end; ++i) {
+                EventRecord* records = params.records_per_path > 0
+                                           ? result.records.data() + i * params.records_per_path
+                                           : nullptr;
+                mc::initPath(params, i, state);
+                while (mc::stepPath(params, state, records)) {}
+                result.paths[i] = summarizePath(state);
+            }
+        }
+    };
+
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    const uint64_t tasks = (config.paths + kPathsPerTask - 1) / kPathsPerTask;
+    threads = static_cast<unsigned>(std::min<uint64_t>(threads, std::max<uint64_t>(tasks, 1)));
+    std::vector<std::thread> pool;
+    for (unsigned t = 1; t < threads; ++t) pool.emplace_back(work);
+    work();
+    for (std::thread& t : pool) t.join();
+    return result;
+}
+
+#ifdef QRSDP_CUDA_ENABLED
+
+MonteCarloResult runMonteCarloCuda(const MonteCarloConfig& config) {
+    return mc::runPathsCuda(makePathParams(config), config.paths);
+}
+
+bool cudaMonteCarloAvailable() { return mc::cudaDevicePresent(); }
+
+#else
+
+MonteCarloResult runMonteCarloCuda(const MonteCarloConfig&) {
+    throw std::runtime_error("monte carlo: built without the CUDA backend (-DBUILD_CUDA_MONTE_CARLO=ON)");
+}
+
+bool cudaMonteCarloAvailable() { return false; }
+
+#endif
+
+MonteCarloResult runMonteCarlo(const MonteCarloConfig& config, MonteCarloBackend backend,
+                               unsigned threads) {
+    return backend == MonteCarloBackend::CUDA ? runMonteCarloCuda(config)
+                                              : runMonteCarloCpu(config, threads);
+}
+
+}  // namespace qrsdp
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "core/event_types.h"
+#include "core/records.h"
+#include "montecarlo/path_kernel.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace qrsdp {
+
+/// Batch Monte Carlo over independent MultiLevelBook + SimpleImbalanceIntensity
+/// sessions that only need summary statistics (path_kernel.h has the event law).
+/// Every path opens the same book; path i draws from Philox stream (seed, i), so
+/// results depend only on the config, not on the backend's thread or block count.
+struct MonteCarloConfig {
+    uint64_t seed = 42;
+    uint64_t paths = 1024;
+    uint32_t session_seconds = 23400;
+    int32_t p0_ticks = 10000;
+    uint32_t levels_per_side = 5;       // 1..mc::kMaxPathLevels
+    uint32_t initial_spread_ticks = 2;
+    uint32_t initial_depth = 5;         // qrsdp_run --depth default
+    uint32_t market_open_seconds = 34200;
+    IntensityParams intensity{20.0, 0.5, 15.0, 1.0, 1.0, 0.5, 0.4};  // qrsdp_run's defaults
+    double level_alpha = 0.5;           // UnitSizeAttributeSampler alpha, as SessionRunner
+    double spread_improve_coeff = 0.5;
+    uint32_t records_per_path = 0;      // keep each path's first events as EventRecords
+};
+
+/// The session config of a producer run as a Monte Carlo config.
+/// queue_reactive.theta_reinit is not modelled (makePathParams rejects it).
+MonteCarloConfig monteCarloConfigFor(const TradingSession& session, uint64_t paths);
+
+/// One path's summary. Prices are mids, (bid + ask) / 2 in ticks.
+struct PathSummary {
+    int32_t open_ticks = 0;
+    int32_t high_ticks = 0;
+    int32_t low_ticks = 0;
+    int32_t close_ticks = 0;            // SessionResult::close_ticks of the path
+    uint64_t events = 0;
+    uint64_t shifts = 0;                // events that moved either best price
+    uint64_t type_counts[kNumEventTypes] = {};
+};
+
+struct MonteCarloResult {
+    std::vector<PathSummary> paths;
+    /// Path-major, records_per_path slots per path; path i holds
+    /// min(paths[i].events, records_per_path) records.
+    std::vector<EventRecord> records;
+};
+
+enum class MonteCarloBackend { CPU, CUDA };
+
+/// Resolves config into the kernel's parameters. Throws std::invalid_argument
+/// on levels outside 1..kMaxPathLevels or a non-positive session length.
+mc::PathParams makePathParams(const MonteCarloConfig& config);
+
+/// Reads the summary off a finished path.
+PathSummary summarizePath(const mc::PathState& state);
+
+/// All paths on threads host threads (0 = hardware concurrency).
+MonteCarloResult runMonteCarloCpu(const MonteCarloConfig& config, unsigned threads = 0);
+
+/// All paths on the default CUDA device. Throws std::runtime_error when the
+/// build has no CUDA backend (BUILD_CUDA_MONTE_CARLO=OFF) or a CUDA call fails.
+MonteCarloResult runMonteCarloCuda(const MonteCarloConfig& config);
+
+/// True if this build has the CUDA backend and a device is present.
+bool cudaMonteCarloAvailable();
+
+MonteCarloResult runMonteCarlo(const MonteCarloConfig& config, MonteCarloBackend backend,
+                               unsigned threads = 0);
+
+}  // namespace qrsdp
@@ -0,0 +1,102 @@
+#include "montecarlo/monte_carlo_cuda.h"
+
+#include <cuda_runtime.h>
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace qrsdp {
+namespace mc {
+
+namespace {
+
+constexpr int kThreadsPerBlock = 128;
+/// Events each thread advances per launch. The host relaunches until every path
+/// has ended, so no single launch runs long enough to trip a display watchdog,
+/// and paths of one warp stay within a launch of each other.
+constexpr uint32_t kStepsPerLaunch = 4096;
+
+void check(cudaError_t err, const char* what) {
+    if (err != cudaSuccess)
+        throw std::runtime_error(std::string("monte carlo: ") + what + ": " + cudaGetErrorString(err));
+}
+
+/// Device allocation freed on scope exit.
+template <class T>
+struct DeviceBuffer {
+    T* ptr = nullptr;
+    explicit DeviceBuffer(size_t n) {
+        if (n > 0) check(cudaMalloc(&ptr, n * sizeof(T)), "cudaMalloc");
+    }
+    ~DeviceBuffer() { cudaFree(ptr); }
+    DeviceBuffer(const DeviceBuffer&) = delete;
+    DeviceBuffer& operator=(const DeviceBuffer&) = delete;
+};
+
+__global__ void initPathsKernel(PathParams params, PathState* states, uint64_t paths) {
+    const uint64_t i = static_cast<uint64_t>(blockIdx.x) * blockDim.x + threadIdx.x;
+    if (i >= paths) return;
+    PathState s;
+    initPath(params, i, s);
+    states[i] = s;
+}
+
+/// One thread per path; the state lives in registers and local memory for the
+/// launch and goes back to global memory at the end.
+__global__ void stepPathsKernel(PathParams params, PathState* states, uint64_t paths,
+                                EventRecord* records, unsigned long long* active) {
+    const uint64_t i = static_cast<uint64_t>(blockIdx.x) * blockDim.x + threadIdx.x;
+    if (i >= paths) return;
+    PathState s = states[i];
+    if (s.done) return;
+    EventRecord* path_records = records ? records + i * params.records_per_path : nullptr;
+    uint32_t steps = 0;
+    while (steps < kStepsPerLaunch && stepPath(params, s, path_records)) ++steps;
+    states[i] = s;
+    if (!s.done) atomicAdd(active, 1ULL);
+}
+
+}  // namespace
+
+MonteCarloResult runPathsCuda(const PathParams& params, uint64_t paths) {
+    MonteCarloResult result;
+    result.paths.resize(paths);
+    result.records.resize(paths * params.records_per_path);
+    if (paths == 0) return result;
+
+    DeviceBuffer<PathState> states(paths);
+    DeviceBuffer<EventRecord> records(result.records.size());
+    DeviceBuffer<unsigned long long> active(1);
+    const unsigned blocks = static_cast<unsigned>((paths + kThreadsPerBlock - 1) / kThreadsPerBlock);
+
+    initPathsKernel<<<blocks, kThreadsPerBlock>>>(params, states.ptr, paths);
+    check(cudaGetLastError(), "init kernel");
+    for (;;) {
+        check(cudaMemset(active.ptr, 0, sizeof(unsigned long long)), "cudaMemset");
+        stepPathsKernel<<<blocks, kThreadsPerBlock>>>(params, states.ptr, paths, records.ptr, active.ptr);
+        check(cudaGetLastError(), "step kernel");
+        unsigned long long still_active = 0;
+        check(cudaMemcpy(&still_active, active.ptr, sizeof(still_active), cudaMemcpyDeviceToHost),
+              "cudaMemcpy");
+        if (still_active == 0) break;
+    }
+
+    std::vector<PathState> host_states(paths);
+    check(cudaMemcpy(host_states.data(), states.ptr, paths * sizeof(PathState), cudaMemcpyDeviceToHost),
+          "cudaMemcpy");
+    for (uint64_t i = 0; i < paths; ++i) result.paths[i] = summarizePath(host_states[i]);
+    if (!result.records.empty())
+        check(cudaMemcpy(result.records.data(), records.ptr, result.records.size() * sizeof(EventRecord),
+                         cudaMemcpyDeviceToHost),
+              "cudaMemcpy");
+    return result;
+}
+
+bool cudaDevicePresent() {
+    int count = 0;
+    return cudaGetDeviceCount(&count) == cudaSuccess && count > 0;
+}
+
+}  // namespace mc
+}  // namespace qrsdp
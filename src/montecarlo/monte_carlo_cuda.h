@@ -0,0 +1,13 @@
+#pragma once
+
+#include "montecarlo/monte_carlo.h"
+
+namespace qrsdp {
+namespace mc {
+
+/// Entry points of monte_carlo_cuda.cu; only linked with BUILD_CUDA_MONTE_CARLO.
+MonteCarloResult runPathsCuda(const PathParams& params, uint64_t paths);
+bool cudaDevicePresent();
+
+}  // namespace mc
+}  // namespace qrsdp
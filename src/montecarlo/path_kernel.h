@@ -0,0 +1,368 @@
+#pragma once
+
+#include "core/event_types.h"
+#include "core/records.h"
+
+#include <math.h>
+#include <stdint.h>
+
+/// Functions shared by the CPU engine and the CUDA kernels (monte_carlo_cuda.cu).
+#if defined(__CUDACC__)
+#define QRSDP_HD __host__ __device__
+#else
+#define QRSDP_HD
+#endif
+
+namespace qrsdp {
+namespace mc {
+
+/// One Monte Carlo path: a MultiLevelBook + SimpleImbalanceIntensity +
+/// CompetingIntensitySampler + UnitSizeAttributeSampler session reduced to plain
+/// data and free functions, so that the same code runs on the host and, compiled
+/// by nvcc, as one GPU thread per path. No virtual calls, no heap, no standard
+/// library beyond <math.h>; every array has a fixed capacity.
+///
+/// The event law is the producer's: the same intensities, the same 6-way type
+/// choice, the same attribute rules (an add improves a wide spread with
+/// probability min(1, (spread - 1) * coeff), otherwise picks level k with weight
+/// exp(-alpha k); a cancel picks its level by depth; an execution hits the touch)
+/// and the same book updates (shift with a cascade, improvement into the
+/// spread). The random streams differ: draws come from a per-path Philox stream
+/// and levels are found by CDF search rather than an alias table, so paths match
+/// QrsdpProducer in distribution, not event for event.
+constexpr uint32_t kMaxPathLevels = 32;
+constexpr int kPathSpreadTable = 16;   // tabulated spread multipliers, as SpreadFeedback
+constexpr uint32_t kMaxShiftCascade = 64;
+
+struct PathParams {
+    // SimpleImbalanceIntensity, with its defaults for non-positive settings resolved.
+    double base_L;
+    double base_M;
+    double cancel_scale;            // base_C * cancel_sensitivity
+    double imbalance_sensitivity;
+    double epsilon_exec;
+    double spread_sensitivity;      // <= 0: no spread feedback
+    double spread_add[kPathSpreadTable];   // exp(+sS (spread - 2)) for spreads 0..15
+    double spread_exec[kPathSpreadTable];  // exp(-sS (spread - 2))
+    // UnitSizeAttributeSampler.
+    double level_cdf[kMaxPathLevels];  // cumulative exp(-alpha k), normalised
+    double spread_improve_coeff;
+    // Session.
+    double session_seconds;
+    uint64_t market_open_ns;
+    uint64_t seed;                  // Philox key; paths differ by counter
+    int32_t p0_ticks;
+    uint32_t levels;                // 1..kMaxPathLevels
+    uint32_t initial_depth;
+    uint32_t initial_spread_ticks;
+    uint32_t records_per_path;      // first events of each path kept as EventRecords
+};
+
+struct PathState {
+    // Level k of each side at index k; K is small, so a shift moves the arrays.
+    uint32_t bid_depth[kMaxPathLevels];
+    uint32_t ask_depth[kMaxPathLevels];
+    int32_t bid_price[kMaxPathLevels];
+    int32_t ask_price[kMaxPathLevels];
+    double t;
+    uint64_t counter;               // next Philox counter of this path's stream
+    uint64_t path;
+    uint64_t events;
+    uint64_t shifts;
+    uint64_t type_counts[kNumEventTypes];
+    uint32_t words[4];              // the current Philox block
+    uint32_t words_used;            // 4 = exhausted
+    int32_t open_ticks;             // mid (bid + ask) / 2, as SessionResult::close_ticks
+    int32_t high_ticks;
+    int32_t low_ticks;
+    uint32_t done;
+};
+
+// --- Philox4x32-10 (the bijection of PhiloxRng::block) ---
+
+QRSDP_HD inline void philoxBlock(uint32_t ctr[4], uint32_t k0, uint32_t k1) {
+    for (int r = 0; r < 10; ++r) {
+        if (r > 0) {
+            k0 += 0x9E3779B9u;
+            k1 += 0xBB67AE85u;
+        }
+        const uint64_t p0 = static_cast<uint64_t>(0xD2511F53u) * ctr[0];
+        const uint64_t p1 = static_cast<uint64_t>(0xCD9E8D57u) * ctr[2];
+        const uint32_t c1 = ctr[1];
+        const uint32_t c3 = ctr[3];
+        ctr[0] = static_cast<uint32_t>(p1 >> 32) ^ c1 ^ k0;
+        ctr[1] = static_cast<uint32_t>(p1);
+        ctr[2] = static_cast<uint32_t>(p0 >> 32) ^ c3 ^ k1;
+        ctr[3] = static_cast<uint32_t>(p0);
+    }
+}
+
+/// Uniform [0, 1) with 53 bits from two words. The stream of path p is Philox
+/// with key = seed and counter (i, p): blocks of distinct paths never overlap.
+QRSDP_HD inline double pathUniform(const PathParams& params, PathState& s) {
+    if (s.words_used >= 4) {
+        s.words[0] = static_cast<uint32_t>(s.counter);
+        s.words[1] = static_cast<uint32_t>(s.counter >> 32);
+        s.words[2] = static_cast<uint32_t>(s.path);
+        s.words[3] = static_cast<uint32_t>(s.path >> 32);
+        philoxBlock(s.words, static_cast<uint32_t>(params.seed), static_cast<uint32_t>(params.seed >> 32));
+        ++s.counter;
+        s.words_used = 0;
+    }
+    const uint64_t bits = (static_cast<uint64_t>(s.words[s.words_used + 1]) << 32) | s.words[s.words_used];
+    s.words_used += 2;
+    return static_cast<double>(bits >> 11) * (1.0 / 9007199254740992.0);
+}
+
+/// -log(U) with U clamped to [1e-10, 1), as IRng::exponential().
+QRSDP_HD inline double pathExponential(const PathParams& params, PathState& s) {
+    double u = pathUniform(params, s);
+    if (u < 1e-10) u = 1e-10;
+    return -log(u);
+}
+
+QRSDP_HD inline int32_t pathMid(const PathState& s) {
+    return (s.bid_price[0] + s.ask_price[0]) / 2;
+}
+
+/// Opening book of MultiLevelBook::seed() and a fresh stream for path.
+QRSDP_HD inline void initPath(const PathParams& params, uint64_t path, PathState& s) {
+    const uint32_t spread = params.initial_spread_ticks;
+    const int32_t half = static_cast<int32_t>(spread / 2);
+    const int32_t best_bid = params.p0_ticks - half;
+    const int32_t best_ask = params.p0_ticks + static_cast<int32_t>(spread) - half;
+    for (uint32_t k = 0; k < params.levels; ++k) {
+        s.bid_price[k] = best_bid - static_cast<int32_t>(k);
+        s.ask_price[k] = best_ask + static_cast<int32_t>(k);
+        s.bid_depth[k] = params.initial_depth;
+        s.ask_depth[k] = params.initial_depth;
+    }
+    s.t = 0.0;
+    s.counter = 0;
+    s.path = path;
+    s.events = 0;
+    s.shifts = 0;
+    for (int i = 0; i < kNumEventTypes; ++i) s.type_counts[i] = 0;
+    s.words_used = 4;
+    s.open_ticks = pathMid(s);
+    s.high_ticks = s.open_ticks;
+    s.low_ticks = s.open_ticks;
+    s.done = 0;
+}
+
+/// clampNonNegative() of simple_imbalance_intensity.cpp.
+QRSDP_HD inline double pathClamp(double x) {
+    return (x >= 1e-9 && x <= 1.7976931348623157e308) ? x : 1e-9;
+}
+
+/// SimpleImbalanceIntensity::compute() on the path's book, in EventType order.
+QRSDP_HD inline void pathIntensities(const PathParams& params, const PathState& s, double lambda[kNumEventTypes]) {
+    const double q_bid = static_cast<double>(s.bid_depth[0]);
+    const double q_ask = static_cast<double>(s.ask_depth[0]);
+    const double I = (q_bid - q_ask) / (q_bid + q_ask + 1e-9);
+    uint64_t bid_total = 0;
+    uint64_t ask_total = 0;
+    for (uint32_t k = 0; k < params.levels; ++k) {
+        bid_total += s.bid_depth[k];
+        ask_total += s.ask_depth[k];
+    }
+    const double total_bid = bid_total > 0 ? static_cast<double>(bid_total) : q_bid;
+    const double total_ask = ask_total > 0 ? static_cast<double>(ask_total) : q_ask;
+
+    const int spread = s.ask_price[0] - s.bid_price[0];
+    double add_mult = 1.0;
+    double exec_mult = 1.0;
+    if (spread >= 0 && spread < kPathSpreadTable) {
+        add_mult = params.spread_add[spread];
+        exec_mult = params.spread_exec[spread];
+    } else if (params.spread_sensitivity > 0.0) {
+        const double delta = static_cast<double>(spread) - 2.0;
+        add_mult = exp(params.spread_sensitivity * delta);
+        exec_mult = exp(-params.spread_sensitivity * delta);
+    }
+    const double sI = params.imbalance_sensitivity;
+    const double sell_pressure = sI * I > 0.0 ? sI * I : 0.0;
+    const double buy_pressure = -sI * I > 0.0 ? -sI * I : 0.0;
+    lambda[0] = pathClamp(params.base_L * (1.0 - sI * I) * add_mult);
+    lambda[1] = pathClamp(params.base_L * (1.0 + sI * I) * add_mult);
+    lambda[2] = pathClamp(params.cancel_scale * total_bid);
+    lambda[3] = pathClamp(params.cancel_scale * total_ask);
+    lambda[4] = pathClamp(params.base_M * (params.epsilon_exec + buy_pressure) * exec_mult);
+    lambda[5] = pathClamp(params.base_M * (params.epsilon_exec + sell_pressure) * exec_mult);
+}
+
+/// BasicMultiLevelBook::shiftBidBook()/shiftAskBook(): drop the emptied best
+/// level and refill a deepest one at the initial depth, cascading while the new
+/// best is empty.
+QRSDP_HD inline void pathShift(const PathParams& params, uint32_t* depth, int32_t* price, int32_t step) {
+    const uint32_t last = params.levels - 1;
+    for (uint32_t cascade = 0; cascade < kMaxShiftCascade; ++cascade) {
+        const int32_t deepest = price[last];
+        for (uint32_t k = 0; k < last; ++k) {
+            depth[k] = depth[k + 1];
+            price[k] = price[k + 1];
+        }
+        depth[last] = params.initial_depth;
+        price[last] = deepest + step;
+        if (depth[0] > 0) break;
+    }
+}
+
+/// improveBid()/improveAsk(): a new best level; the deepest one falls off.
+QRSDP_HD inline void pathImprove(const PathParams& params, uint32_t* depth, int32_t* price, int32_t new_price) {
+    for (uint32_t k = params.levels - 1; k > 0; --k) {
+        depth[k] = depth[k - 1];
+        price[k] = price[k - 1];
+    }
+    depth[0] = 1;
+    price[0] = new_price;
+}
+
+/// An add's level: exp(-alpha k) weights (sampleLevelIndex; no draw for K = 1).
+QRSDP_HD inline uint32_t pathAddLevel(const PathParams& params, PathState& s) {
+    if (params.levels <= 1) return 0;
+    const double u = pathUniform(params, s);
+    for (uint32_t k = 0; k + 1 < params.levels; ++k)
+        if (u < params.level_cdf[k]) return k;
+    return params.levels - 1;
+}
+
+/// A cancel's level: proportional to depth (sampleCancelLevelIndex).
+QRSDP_HD inline uint32_t pathCancelLevel(const PathParams& params, PathState& s, const uint32_t* depth) {
+    uint64_t total = 0;
+    for (uint32_t k = 0; k < params.levels; ++k) total += depth[k];
+    if (total == 0) return 0;
+    const double u = pathUniform(params, s);
+    uint64_t cum = 0;
+    for (uint32_t k = 0; k < params.levels; ++k) {
+        cum += depth[k];
+        if (u < static_cast<double>(cum) / static_cast<double>(total)) return k;
+    }
+    return params.levels - 1;
+}
+
+/// An add on a side whose best is at best (improving it when price is inside
+/// the spread), as BasicMultiLevelBook::apply(). dir = +1 on the bid, -1 on the ask.
+QRSDP_HD inline void pathAdd(const PathParams& params, uint32_t* depth, int32_t* price,
+                             int32_t new_price, int32_t other_best, int32_t dir) {
+    if (dir * (new_price - price[0]) > 0 && dir * (other_best - new_price) > 0) {
+        pathImprove(params, depth, price, new_price);
+        return;
+    }
+    const int32_t idx = dir * (price[0] - new_price);
+    if (idx >= 0 && static_cast<uint32_t>(idx) < params.levels) ++depth[idx];
+}
+
+/// One unit leaves the level at target_price; an emptied best level shifts the side.
+QRSDP_HD inline void pathRemove(const PathParams& params, uint32_t* depth, int32_t* price,
+                                int32_t target_price, int32_t dir, int32_t shift_step) {
+    const int32_t idx = dir * (price[0] - target_price);
+    if (idx < 0 || static_cast<uint32_t>(idx) >= params.levels) return;
+    const uint32_t d = depth[idx];
+    depth[idx] = d >= 1 ? d - 1 : 0;
+    if (idx == 0 && depth[0] == 0 && d > 0) pathShift(params, depth, price, shift_step);
+}
+
+/// Advances the path by one event, as BasicQrsdpProducer::generate(): intensities,
+/// Exp(λ) waiting time, type, attributes, book update. While the path has
+/// recorded fewer than records_per_path events the event is written to
+/// records[events] (records may be null when records_per_path is 0). Returns
+/// false, and marks the path done, once the clock passes the session end.
+QRSDP_HD inline bool stepPath(const PathParams& params, PathState& s, EventRecord* records) {
+    if (s.done) return false;
+    double lambda[kNumEventTypes];
+    pathIntensities(params, s, lambda);
+    const double total = lambda[0] + lambda[1] + lambda[2] + lambda[3] + lambda[4] + lambda[5];
+    const bool drawable = total > 0.0 && total <= 1.7976931348623157e308;
+    s.t += drawable ? pathExponential(params, s) / total : 1e9;
+    if (s.t >= params.session_seconds) {
+        s.done = 1;
+        return false;
+    }
+
+    // sampleType(): cumulative search in EventType order.
+    int type = kNumEventTypes - 1;
+    const double u = pathUniform(params, s);
+    double cum = 0.0;
+    for (int i = 0; i < kNumEventTypes; ++i) {
+        cum += lambda[i];
+        if (u < cum / total) {
+            type = i;
+            break;
+        }
+    }
+
+    const int32_t prev_bid = s.bid_price[0];
+    const int32_t prev_ask = s.ask_price[0];
+    const int spread = prev_ask - prev_bid;
+    int32_t price = 0;
+    Side side = Side::BID;
+    switch (static_cast<EventType>(type)) {
+        case EventType::ADD_BID:
+        case EventType::ADD_ASK: {
+            const bool bid = type == static_cast<int>(EventType::ADD_BID);
+            side = bid ? Side::BID : Side::ASK;
+            bool improve = false;
+            if (spread > 1 && params.spread_improve_coeff > 0.0) {
+                double p = static_cast<double>(spread - 1) * params.spread_improve_coeff;
+                if (p > 1.0) p = 1.0;
+                improve = pathUniform(params, s) < p;
+            }
+            if (improve) {
+                price = bid ? prev_bid + 1 : prev_ask - 1;
+            } else {
+                const uint32_t k = pathAddLevel(params, s);
+                price = bid ? s.bid_price[k] : s.ask_price[k];
+            }
+            if (bid) pathAdd(params, s.bid_depth, s.bid_price, price, prev_ask, 1);
+            else     pathAdd(params, s.ask_depth, s.ask_price, price, prev_bid, -1);
+            break;
+        }
+        case EventType::CANCEL_BID:
+            price = s.bid_price[pathCancelLevel(params, s, s.bid_depth)];
+            pathRemove(params, s.bid_depth, s.bid_price, price, 1, -1);
+            break;
+        case EventType::CANCEL_ASK:
+            side = Side::ASK;
+            price = s.ask_price[pathCancelLevel(params, s, s.ask_depth)];
+            pathRemove(params, s.ask_depth, s.ask_price, price, -1, 1);
+            break;
+        case EventType::EXECUTE_BUY:
+            side = Side::ASK;
+            price = prev_ask;
+            pathRemove(params, s.ask_depth, s.ask_price, price, -1, 1);
+            break;
+        default:
+            price = prev_bid;
+            pathRemove(params, s.bid_depth, s.bid_price, price, 1, -1);
+            break;
+    }
+
+    const int32_t new_bid = s.bid_price[0];
+    const int32_t new_ask = s.ask_price[0];
+    if (new_bid != prev_bid || new_ask != prev_ask) {
+        ++s.shifts;
+        const int32_t mid = pathMid(s);
+        if (mid > s.high_ticks) s.high_ticks = mid;
+        if (mid < s.low_ticks) s.low_ticks = mid;
+    }
+    if (records && s.events < params.records_per_path) {
+        uint32_t flags = kFlagNone;
+        if (new_bid < prev_bid) flags |= kFlagShiftDown;
+        if (new_ask > prev_ask) flags |= kFlagShiftUp;
+        EventRecord& rec = records[s.events];
+        rec.ts_ns = params.market_open_ns + static_cast<uint64_t>(s.t * 1e9);
+        rec.type = static_cast<uint8_t>(type);
+        rec.side = static_cast<uint8_t>(side);
+        rec.price_ticks = price;
+        rec.qty = 1;
+        rec.order_id = s.events + 1;
+        rec.flags = flags;
+    }
+    ++s.type_counts[type];
+    ++s.events;
+    return true;
+}
+
+}  // namespace mc
+}  // namespace qrsdp
@@ -0,0 +1,465 @@
+#pragma once
+
+#include "book/i_order_book.h"
+#include "core/records.h"
+#include "io/book_checkpoint.h"
+#include "model/i_intensity_model.h"
+#include "model/curve_intensity_model.h"
+#include "model/i_intensity_scale.h"
+#include "model/seasonality_profile.h"
+#include "producer/stage_profile.h"
+#include "rng/rng_stream.h"
+#include "sampler/i_attribute_sampler.h"
+#include "sampler/thinning_sampler.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+namespace qrsdp {
+
+/// The session loop's state between two events, as a value: the book levels,
+/// clock, order ids, counters and the intensity model's event history.
+/// Generator state is not part of it; fork() always starts a fresh stream, and
+/// the intensity model and sampler rebuild their scratch from the book. A few
+/// hundred bytes for a 5-level book.
+struct ProducerSnapshot {
+    TradingSession session{};
+    double t = 0.0;
+    uint64_t next_order_id = 1;
+    uint64_t events_written = 0;
+    uint64_t shift_count = 0;
+    std::vector<Level> bids;  // every level, best first
+    std::vector<Level> asks;
+    std::vector<double> history;  // IIntensityModel::saveHistory(); empty if none
+};
+
+/// Session loop shared by every producer, parameterised on the concrete collaborator
+/// types. Instantiated with the interfaces (IRng, IOrderBook, ...) it behaves exactly
+/// like the virtual QrsdpProducer; instantiated with `final` concrete types
+/// (Mt19937Rng, MultiLevelBook, CurveIntensityModel, ..., BinaryFileSink) the compiler
+/// can resolve and inline every per-event call in stepOneEvent().
+///
+/// Requirements are the member functions of the matching interface; no other
+/// customisation points. Non-owning references; caller manages lifetimes.
+///
+/// Profile times the stages of each event (stage_profile.h). The default
+/// NoStageProfile compiles the hooks away; CycleStageProfile keeps per-stage
+/// cycle histograms, read back through profile().
+template <class Rng, class Book, class Model, class Sampler, class Attr, class Sink,
+          class Profile = NoStageProfile>
+class BasicQrsdpProducer {
+public:
+    BasicQrsdpProducer(Rng& rng, Book& book, Model& intensityModel,
+                       Sampler& eventSampler, Attr& attributeSampler)
+        : rng_(&rng), book_(&book), intensityModel_(&intensityModel),
+          eventSampler_(&eventSampler), attributeSampler_(&attributeSampler), thinning_(rng) {}
+
+    /// Time-varying intensity multiplier (not owned; nullptr = time-homogeneous, the
+    /// default). When set, arrival times come from ThinningSampler against the scale
+    /// instead of Exp(λ_total) draws, so streams differ from the unscaled run.
+    void setIntensityScale(const IIntensityScale* scale) { scale_ = scale; }
+    /// Intraday profile (not owned; nullptr or empty = off). Applied exactly without
+    /// thinning: λ_total is scaled by the cached current bucket's multiplier, and a
+    /// draw that overshoots the bucket end restarts there (memoryless), so the only
+    /// per-event cost is one multiply and one compare. Takes effect at startSession().
+    void setSeasonality(const SeasonalityProfile* profile) { seasonality_ = profile; }
+    /// Thinning candidates drawn and accepted this session (0 without a scale).
+    uint64_t thinningCandidates() const { return thinning_.candidates(); }
+    uint64_t thinningAccepted() const { return thinning_.accepted(); }
+
+    /// Generates the whole session in kBatchSize batches handed to Sink::appendBatch.
+    SessionResult runSession(const TradingSession& session, Sink& sink) {
+        startSession(session);
+        return finishSession(sink);
+    }
+
+    /// Generates the rest of the current session (after startSession, resumeSession,
+    /// fork or some stepping) in kBatchSize batches; the close is runSession's.
+    SessionResult finishSession(Sink& sink) {
+        EventRecord batch[kBatchSize];
+        size_t n;
+        while ((n = stepEvents(kBatchSize, batch)) > 0) {
+            const uint64_t mark = profile_.start();
+            sink.appendBatch(batch, n);
+            profile_.lapBatch(Stage::SINK, mark, n);
+        }
+        const Level bid = book_->bestBid();
+        const Level ask = book_->bestAsk();
+        const int32_t close_ticks = (bid.price_ticks + ask.price_ticks) / 2;
+        return SessionResult{close_ticks, events_written_};
+    }
+
+    /// Stepping API: call startSession once, then stepOneEvent in a loop.
+    ///
+    /// Self-exciting models (IIntensityModel::selfExciting(), e.g. HawkesIntensityModel)
+    /// are sampled by thinning against the model's own bound: a candidate is drawn at
+    /// rate totalAt(t) and accepted with probability totalAt(candidate) / rate, the
+    /// bound tightening after each rejection. Each event is then reported through
+    /// onEvent(). Their history starts empty here; snapshots and checkpoints carry
+    /// it (saveHistory()), so fork() and resumeSession() continue the excitation.
+    /// Throws std::invalid_argument for a self-exciting model combined with a scale
+    /// or seasonality.
+    void startSession(const TradingSession& session);
+    /// Continues a session from a BinaryFileSink checkpoint instead of the opening
+    /// book: startSession(session), then the book, order ids and event count come
+    /// from cp. With producer state (cp.rng_position > 0, see captureCheckpoint())
+    /// the clock is cp.clock and the RNG is moved to cp.rng_position of the
+    /// session's stream, so a level book continues exactly as the uninterrupted
+    /// run did. Without it the clock is cp.ts_ns and the RNG is reseeded from
+    /// (session.seed, cp.record_index): deterministic, but a different stream.
+    /// Throws std::invalid_argument if the book cannot restore cp's levels.
+    void resumeSession(const TradingSession& session, const BookCheckpoint& cp);
+    /// Fills cp's producer-side fields for a BinaryFileSink checkpoint source:
+    /// the book levels, next order id, RNG position, exact clock and model history.
+    void captureCheckpoint(BookCheckpoint& cp) const;
+    /// Captures the state after the last generated event (see ProducerSnapshot).
+    ProducerSnapshot snapshot() const;
+    /// What-if branching: continues snap's session from snap's state with the RNG
+    /// seeded from seed. Any producer whose book and model match the snapshot's
+    /// shape can fork it, including this one, and the stream depends only on
+    /// (snap, seed): N branches from one prefix cost the prefix once. The model may
+    /// differ from the prefix's (a parameter branch) if its history has the same
+    /// shape. Order-level books restore each level as background orders, as
+    /// resumeSession does.
+    /// Throws std::invalid_argument if the book cannot restore snap's levels or the
+    /// model its history.
+    void fork(const ProducerSnapshot& snap, uint64_t seed);
+    /// Advances one event; appends to sink and returns true. Returns false if past session end.
+    bool stepOneEvent(Sink& sink);
+    /// Generates up to max events into out (no sink involved). Returns the number
+    /// written; fewer than max only when the session has ended. Same stream as
+    /// calling stepOneEvent() the same number of times.
+    size_t stepEvents(size_t max, EventRecord* out);
+    /// Skip-ahead: generates events without building records until the clock
+    /// reaches t or the session ends; returns the number of events skipped. The
+    /// state afterwards (book, clock, RNG, order ids, counters) is exactly that of
+    /// calling stepOneEvent() the same number of times, so the next event matches
+    /// an uninterrupted stream. The last skipped event is the first at or after t.
+    uint64_t fastForward(double t);
+    double currentTime() const { return t_; }
+    uint64_t eventsWrittenThisSession() const { return events_written_; }
+    /// Order id the next generated event will carry (1 at session start).
+    uint64_t nextOrderId() const { return order_id_; }
+    uint64_t shiftCountThisSession() const { return shift_count_; }
+    Profile& profile() { return profile_; }
+    const Profile& profile() const { return profile_; }
+
+    static constexpr size_t kBatchSize = 256;
+
+private:
+    /// One event: advances time and book, fills *rec when kRecord (fastForward
+    /// passes nullptr). False once past session end.
+    template <bool kRecord>
+    bool generate(EventRecord* rec);
+    /// Puts the book and clock at a mid-session state after startSession(); the
+    /// model sees the whole book changed. Throws std::invalid_argument.
+    void restoreState(const std::vector<Level>& bids, const std::vector<Level>& asks, double t,
+                      uint64_t next_order_id, uint64_t events_written);
+
+    static constexpr uint32_t kDefaultInitialDepth = 50;
+    static constexpr uint32_t kDefaultInitialSpreadTicks = 2;
+
+    Rng* rng_;
+    Book* book_;
+    Model* intensityModel_;
+    Sampler* eventSampler_;
+    Attr* attributeSampler_;
+    const IIntensityScale* scale_ = nullptr;
+    ThinningSampler thinning_;
+    const SeasonalityProfile* seasonality_ = nullptr;
+    bool seasonal_ = false;
+    bool self_exciting_ = false;
+    size_t bucket_ = 0;
+    double bucket_end_ = 0.0;
+    double bucket_mult_ = 1.0;
+    TradingSession session_{};
+    double session_seconds_ = 0.0;
+    double t_ = 0.0;
+    uint64_t order_id_ = 1;
+    uint64_t events_written_ = 0;
+    uint64_t shift_count_ = 0;
+    double theta_reinit_ = 0.0;
+    double reinit_mean_ = 10.0;
+    uint64_t market_open_ns_ = 0;
+
+    /// Per-event scratch reused across steps so steady-state stepping does not allocate.
+    BookState state_;
+    std::vector<double> per_level_;
+    /// Book levels changed since the last intensity evaluation (full after seed/reinit).
+    BookDelta pending_delta_{};
+    Profile profile_;
+};
+
+template <class Rng, class Book, class Model, class Sampler, class Attr, class Sink, class Profile>
+void BasicQrsdpProducer<Rng, Book, Model, Sampler, Attr, Sink, Profile>::startSession(
+        const TradingSession& session) {
+    rng_->seed(session.seed);
+    session_ = session;
+    BookSeed seed;
+    seed.p0_ticks = session.p0_ticks;
+    seed.levels_per_side = session.levels_per_side;
+    seed.initial_depth = session.initial_depth > 0 ? session.initial_depth : kDefaultInitialDepth;
+    seed.initial_spread_ticks = session.initial_spread_ticks > 0 ? session.initial_spread_ticks
+                                                                : kDefaultInitialSpreadTicks;
+    book_->seed(seed);
+    session_seconds_ = static_cast<double>(session.session_seconds);
+    t_ = 0.0;
+    order_id_ = 1;
+    events_written_ = 0;
+    shift_count_ = 0;
+    theta_reinit_ = session.queue_reactive.theta_reinit;
+    reinit_mean_ = session.queue_reactive.reinit_depth_mean > 0.0
+                       ? session.queue_reactive.reinit_depth_mean
+                       : 10.0;
+    market_open_ns_ = static_cast<uint64_t>(session.market_open_seconds) * 1'000'000'000ULL;
+    pending_delta_ = BookDelta{};
+    thinning_.reset();
+    seasonal_ = seasonality_ && !seasonality_->empty();
+    self_exciting_ = intensityModel_->selfExciting();
+    if (self_exciting_ && (scale_ || seasonal_))
+        throw std::invalid_argument("QrsdpProducer: a self-exciting model takes no intensity scale or seasonality");
+    intensityModel_->resetHistory(0.0);
+    if (seasonal_) {
+        bucket_ = 0;
+        bucket_end_ = seasonality_->bucketEnd(0);
+        bucket_mult_ = seasonality_->multiplier(0);
+    }
+    state_.bid_depths.reserve(book_->numLevels());
+    state_.ask_depths.reserve(book_->numLevels());
+}
+
+template <class Rng, class Book, class Model, class Sampler, class Attr, class Sink, class Profile>
+void BasicQrsdpProducer<Rng, Book, Model, Sampler, Attr, Sink, Profile>::resumeSession(
+        const TradingSession& session, const BookCheckpoint& cp) {
+    startSession(session);
+    if (cp.rng_position > 0) {
+        restoreState(cp.bids, cp.asks, cp.clock, cp.next_order_id, cp.record_index);
+        intensityModel_->restoreHistory(cp.history, t_);
+        if (rng_->seek(cp.rng_position)) return;  // startSession() seeded the stream
+    } else {
+        const double t = cp.ts_ns > market_open_ns_ ? static_cast<double>(cp.ts_ns - market_open_ns_) * 1e-9 : 0.0;
+        restoreState(cp.bids, cp.asks, t, cp.next_order_id, cp.record_index);
+    }
+    rng_->seed(streamSeed(session.seed, static_cast<uint32_t>(cp.record_index >> 32),
+                          static_cast<uint32_t>(cp.record_index)));
+}
+
+template <class Rng, class Book, class Model, class Sampler, class Attr, class Sink, class Profile>
+void BasicQrsdpProducer<Rng, Book, Model, Sampler, Attr, Sink, Profile>::captureCheckpoint(
+        BookCheckpoint& cp) const {
+    captureLevels(*book_, cp);
+    cp.next_order_id = order_id_;
+    cp.rng_position = rng_->position();
+    cp.clock = t_;
+    cp.history = intensityModel_->saveHistory();
+}
+
+template <class Rng, class Book, class Model, class Sampler, class Attr, class Sink, class Profile>
+ProducerSnapshot BasicQrsdpProducer<Rng, Book, Model, Sampler, Attr, Sink, Profile>::snapshot() const {
+    ProducerSnapshot snap;
+    snap.session = session_;
+    snap.t = t_;
+    snap.next_order_id = order_id_;
+    snap.events_written = events_written_;
+    snap.shift_count = shift_count_;
+    const size_t n = book_->numLevels();
+    snap.bids.resize(n);
+    snap.asks.resize(n);
+    for (size_t k = 0; k < n; ++k) {
+        snap.bids[k] = Level{book_->bidPriceAtLevel(k), book_->bidDepthAtLevel(k)};
+        snap.asks[k] = Level{book_->askPriceAtLevel(k), book_->askDepthAtLevel(k)};
+    }
+    snap.history = intensityModel_->saveHistory();
+    return snap;
+}
+
+template <class Rng, class Book, class Model, class Sampler, class Attr, class Sink, class Profile>
+void BasicQrsdpProducer<Rng, Book, Model, Sampler, Attr, Sink, Profile>::fork(
+        const ProducerSnapshot& snap, uint64_t seed) {
+    startSession(snap.session);
+    restoreState(snap.bids, snap.asks, snap.t, snap.next_order_id, snap.events_written);
+    intensityModel_->restoreHistory(snap.history, t_);
+    shift_count_ = snap.shift_count;
+    rng_->seed(seed);
+}
+
+template <class Rng, class Book, class Model, class Sampler, class Attr, class Sink, class Profile>
+void BasicQrsdpProducer<Rng, Book, Model, Sampler, Attr, Sink, Profile>::restoreState(
+        const std::vector<Level>& bids, const std::vector<Level>& asks, double t,
+        uint64_t next_order_id, uint64_t events_written) {
+    if (bids.size() < book_->numLevels() || asks.size() < book_->numLevels()
+        || !book_->restore(bids.data(), asks.data()))
+        throw std::invalid_argument("QrsdpProducer: book cannot be restored from checkpoint");
+    t_ = t;
+    order_id_ = next_order_id > 0 ? next_order_id : 1;
+    events_written_ = events_written;
+    pending_delta_ = BookDelta{};
+    intensityModel_->resetHistory(t_);
+    if (seasonal_) {
+        while (bucket_end_ <= t_ && bucket_end_ < session_seconds_) {
+            ++bucket_;
+            bucket_end_ = seasonality_->bucketEnd(bucket_);
+            bucket_mult_ = seasonality_->multiplier(bucket_);
+        }
+    }
+}
+
+template <class Rng, class Book, class Model, class Sampler, class Attr, class Sink, class Profile>
+bool BasicQrsdpProducer<Rng, Book, Model, Sampler, Attr, Sink, Profile>::stepOneEvent(Sink& sink) {
+    EventRecord rec;
+    if (!generate<true>(&rec)) return false;
+    const uint64_t mark = profile_.start();
+    sink.append(rec);
+    profile_.lap(Stage::SINK, mark);
+    return true;
+}
+
+template <class Rng, class Book, class Model, class Sampler, class Attr, class Sink, class Profile>
+size_t BasicQrsdpProducer<Rng, Book, Model, Sampler, Attr, Sink, Profile>::stepEvents(size_t max,
+                                                                         EventRecord* out) {
+    size_t n = 0;
+    while (n < max && generate<true>(&out[n])) ++n;
+    return n;
+}
+
+template <class Rng, class Book, class Model, class Sampler, class Attr, class Sink, class Profile>
+uint64_t BasicQrsdpProducer<Rng, Book, Model, Sampler, Attr, Sink, Profile>::fastForward(double t) {
+    const uint64_t start = events_written_;
+    while (t_ < t && generate<false>(nullptr)) {}
+    return events_written_ - start;
+}
+
+template <class Rng, class Book, class Model, class Sampler, class Attr, class Sink, class Profile>
+template <bool kRecord>
+bool BasicQrsdpProducer<Rng, Book, Model, Sampler, Attr, Sink, Profile>::generate(EventRecord* rec) {
+    if (t_ >= session_seconds_) return false;
+    uint64_t mark = profile_.start();
+    BookState& state = state_;
+    state.features = book_->features();
+    const size_t num_levels = book_->numLevels();
+    state.bid_depths.resize(num_levels);
+    state.ask_depths.resize(num_levels);
+    const DepthSpan bid_span = book_->bidDepths();
+    const DepthSpan ask_span = book_->askDepths();
+    if (bid_span.size == num_levels && ask_span.size == num_levels) {
+        std::copy(bid_span.begin(), bid_span.end(), state.bid_depths.begin());
+        std::copy(ask_span.begin(), ask_span.end(), state.ask_depths.begin());
+    } else {
+        for (size_t k = 0; k < num_levels; ++k) {
+            state.bid_depths[k] = book_->bidDepthAtLevel(k);
+            state.ask_depths[k] = book_->askDepthAtLevel(k);
+        }
+    }
+    Intensities intens = intensityModel_->update(state, pending_delta_);
+    const double lambda_total = intens.total();
+    mark = profile_.lap(Stage::INTENSITY, mark);
+    if (self_exciting_) {
+        // Without an event the total only decays, so its value at the clock bounds
+        // it until the candidate. Unexcited, every candidate is accepted without a
+        // draw: a model with zero kernels gives the stream of its baseline.
+        double bound = intensityModel_->totalAt(t_);
+        for (;;) {
+            t_ = bound > 0.0 ? t_ + eventSampler_->sampleDeltaT(bound) : session_seconds_;
+            if (t_ >= session_seconds_) break;
+            const double lambda = intensityModel_->totalAt(t_);
+            if (lambda >= bound || rng_->uniform() * bound < lambda) break;
+            bound = lambda;
+        }
+        if (t_ < session_seconds_) {
+            intensityModel_->advanceTo(t_);
+            intens = intensityModel_->update(state, BookDelta{false, Side::NA, 0});
+        }
+    } else if (scale_) {
+        t_ = thinning_.nextEventTime(t_, session_seconds_, lambda_total, *scale_);
+    } else if (seasonal_) {
+        for (;;) {
+            const double lambda = lambda_total * bucket_mult_;
+            const double t_next = lambda > 0.0 ? t_ + eventSampler_->sampleDeltaT(lambda) : bucket_end_;
+            if (t_next < bucket_end_) {
+                t_ = t_next;
+                break;
+            }
+            t_ = bucket_end_;
+            if (t_ >= session_seconds_) break;
+            ++bucket_;
+            bucket_end_ = seasonality_->bucketEnd(bucket_);
+            bucket_mult_ = seasonality_->multiplier(bucket_);
+        }
+    } else {
+        t_ += eventSampler_->sampleDeltaT(lambda_total);
+    }
+    mark = profile_.lap(Stage::DELTA_T, mark);
+    if (t_ >= session_seconds_) return false;
+
+    EventType type;
+    size_t level_hint = kLevelHintNone;
+    const std::vector<double>* per_level = intensityModel_->perLevelView();
+    if (!per_level && intensityModel_->getPerLevelIntensities(per_level_)) per_level = &per_level_;
+    if (per_level && !per_level->empty()) {
+        size_t idx;
+        if (eventSampler_->supportsIncrementalWeights()) {
+            const PerLevelChange change = intensityModel_->lastPerLevelChange();
+            if (change.all || per_level == &per_level_) {
+                eventSampler_->loadWeights(*per_level);
+            } else {
+                for (size_t i = 0; i < change.count; ++i)
+                    eventSampler_->updateWeight(change.index[i], (*per_level)[change.index[i]]);
+            }
+            idx = eventSampler_->sampleLoadedIndex();
+        } else {
+            idx = eventSampler_->sampleIndexFromWeights(*per_level);
+        }
+        const int K = static_cast<int>((per_level->size() - 2) / 4);
+        CurveIntensityModel::decodePerLevelIndex(idx, K, type, level_hint);
+    } else {
+        type = eventSampler_->sampleType(intens);
+    }
+    mark = profile_.lap(Stage::SELECT, mark);
+    const EventAttrs attrs = attributeSampler_->sample(type, *book_, state.features, level_hint);
+    mark = profile_.lap(Stage::ATTRS, mark);
+    SimEvent ev;
+    ev.type = type;
+    ev.side = attrs.side;
+    ev.price_ticks = attrs.price_ticks;
+    ev.qty = attrs.qty;
+    ev.order_id = order_id_++;
+    const int32_t prev_bid = book_->bestBid().price_ticks;
+    const int32_t prev_ask = book_->bestAsk().price_ticks;
+    book_->apply(ev);
+    const int32_t new_bid = book_->bestBid().price_ticks;
+    const int32_t new_ask = book_->bestAsk().price_ticks;
+    const bool bid_shifted = (new_bid != prev_bid);
+    const bool ask_shifted = (new_ask != prev_ask);
+    const bool shift_occurred = bid_shifted || ask_shifted;
+    bool reinit_happened = false;
+    if (shift_occurred) {
+        ++shift_count_;
+        if (theta_reinit_ > 0.0 && rng_->uniform() < theta_reinit_) {
+            book_->reinitialize(*rng_, reinit_mean_);
+            reinit_happened = true;
+        }
+    }
+    pending_delta_ = reinit_happened ? BookDelta{} : book_->lastChange();
+    if (self_exciting_) intensityModel_->onEvent(type);
+    profile_.lap(Stage::APPLY, mark);
+    if constexpr (kRecord) {
+        const uint64_t resting_id = book_->restingOrderId();
+        uint32_t flags = kFlagNone;
+        if (new_bid < prev_bid) flags |= kFlagShiftDown;
+        if (new_ask > prev_ask) flags |= kFlagShiftUp;
+        if (reinit_happened)    flags |= kFlagReinit;
+        rec->ts_ns = market_open_ns_ + static_cast<uint64_t>(t_ * 1e9);
+        rec->type = static_cast<uint8_t>(type);
+        rec->side = static_cast<uint8_t>(attrs.side);
+        rec->price_ticks = attrs.price_ticks;
+        rec->qty = attrs.qty;
+        rec->order_id = resting_id != 0 ? resting_id : ev.order_id;  // order-level books: the order hit
+        rec->flags = flags;
+    }
+    ++events_written_;
+    return true;
+}
+
+}  // namespace qrsdp
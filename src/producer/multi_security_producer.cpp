@@ -0,0 +1,78 @@
+#include "producer/multi_security_producer.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace qrsdp {
+
+namespace {
+
+/// std heap algorithms build a max-heap; order "later" entries first to get a min-heap.
+struct Later {
+    template <class E>
+    bool operator()(const E& a, const E& b) const {
+        if (a.ts_ns != b.ts_ns) return a.ts_ns > b.ts_ns;
+        return a.security > b.security;
+    }
+};
+
+}  // namespace
+
+uint32_t MultiSecurityProducer::addProducer(QrsdpProducer& producer) {
+    Lane lane;
+    lane.producer = &producer;
+    lanes_.push_back(lane);
+    return static_cast<uint32_t>(lanes_.size() - 1);
+}
+
+void MultiSecurityProducer::startSession(const std::vector<TradingSession>& sessions) {
+    if (sessions.size() != lanes_.size())
+        throw std::invalid_argument("MultiSecurityProducer: one session per producer required");
+    heap_.clear();
+    heap_.reserve(lanes_.size());
+    events_emitted_ = 0;
+    for (size_t i = 0; i < lanes_.size(); ++i) {
+        Lane& lane = lanes_[i];
+        lane.producer->startSession(sessions[i]);
+        lane.pos = 0;
+        lane.len = 0;
+        if (ensureBuffered(lane)) push(static_cast<uint32_t>(i));
+    }
+}
+
+bool MultiSecurityProducer::ensureBuffered(Lane& lane) {
+    if (lane.pos < lane.len) return true;
+    lane.len = lane.producer->stepEvents(kLookahead, lane.buf.data());
+    lane.pos = 0;
+    return lane.len > 0;
+}
+
+void MultiSecurityProducer::push(uint32_t security) {
+    const Lane& lane = lanes_[security];
+    heap_.push_back(HeapEntry{lane.buf[lane.pos].ts_ns, security});
+    std::push_heap(heap_.begin(), heap_.end(), Later{});
+}
+
+bool MultiSecurityProducer::next(uint32_t& security, EventRecord& rec) {
+    if (heap_.empty()) return false;
+    std::pop_heap(heap_.begin(), heap_.end(), Later{});
+    security = heap_.back().security;
+    heap_.pop_back();
+
+    Lane& lane = lanes_[security];
+    rec = lane.buf[lane.pos++];
+    ++events_emitted_;
+    if (ensureBuffered(lane)) push(security);
+    return true;
+}
+
+uint64_t MultiSecurityProducer::runSession(const std::vector<TradingSession>& sessions,
+                                           IConsolidatedSink& sink) {
+    startSession(sessions);
+    uint32_t security;
+    EventRecord rec;
+    while (next(security, rec)) sink.append(security, rec);
+    return events_emitted_;
+}
+
+}  // namespace qrsdp
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "core/records.h"
+#include "io/i_consolidated_sink.h"
+#include "producer/qrsdp_producer.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace qrsdp {
+
+/// Merges several producers' sessions into one stream ordered by ts_ns.
+///
+/// Each producer keeps a small lookahead buffer of its own upcoming events; a
+/// binary min-heap over the buffers' head timestamps picks the next event in
+/// O(log N). Ties go to the lower security index, so the merged stream is a
+/// deterministic function of the per-security sessions, and each security's
+/// subsequence is exactly what its producer would emit alone.
+///
+/// Non-owning: the caller keeps the producers (and their collaborators) alive.
+class MultiSecurityProducer {
+public:
+    /// Registers a producer; returns its security index (0, 1, ... in call order).
+    uint32_t addProducer(QrsdpProducer& producer);
+    size_t numSecurities() const { return lanes_.size(); }
+
+    /// Starts one session per producer (sessions[i] for security i) and primes the heap.
+    /// Throws std::invalid_argument if sessions.size() != numSecurities().
+    void startSession(const std::vector<TradingSession>& sessions);
+
+    /// Next event in global time order. Returns false once every session has ended.
+    bool next(uint32_t& security, EventRecord& rec);
+
+    /// startSession() then drains every event into sink; returns the number emitted.
+    uint64_t runSession(const std::vector<TradingSession>& sessions, IConsolidatedSink& sink);
+
+    uint64_t eventsEmitted() const { return events_emitted_; }
+
+    /// Events generated per producer call; bounds how far a lane runs ahead.
+    static constexpr size_t kLookahead = 64;
+
+private:
+    struct Lane {
+        QrsdpProducer* producer;
+        std::array<EventRecord, kLookahead> buf;
+        size_t pos = 0;
+        size_t len = 0;
+    };
+
+    struct HeapEntry {
+        uint64_t ts_ns;
+        uint32_t security;
+    };
+
+    /// Refills lane's buffer if drained. False when its session has ended.
+    bool ensureBuffered(Lane& lane);
+    void push(uint32_t security);
+
+    std::vector<Lane> lanes_;
+    std::vector<HeapEntry> heap_;
+    uint64_t events_emitted_ = 0;
+};
+
+}  // namespace qrsdp
@@ -0,0 +1,67 @@
+#include "producer/pacer.h"
+#include "core/metrics.h"
+
+#include <algorithm>
+#include <thread>
+
+#if defined(__linux__)
+#include <cerrno>
+#include <time.h>
+#endif
+
+namespace qrsdp {
+
+Pacer::Pacer(const PacingOptions& options)
+    : options_(options), origin_(Clock::now()), horizon_(origin_) {}
+
+void Pacer::start(Clock::time_point origin) {
+    origin_ = origin;
+    horizon_ = origin;
+}
+
+Pacer::Clock::time_point Pacer::dueTime(double sim_seconds) const {
+    const double speed = options_.speed > 0.0 ? options_.speed : 1.0;
+    return origin_ + std::chrono::duration_cast<Clock::duration>(
+                         std::chrono::duration<double>(sim_seconds / speed));
+}
+
+void Pacer::waitUntil(double sim_seconds) {
+    const Clock::time_point due = dueTime(sim_seconds);
+    const auto spin = std::chrono::microseconds(options_.spin_us);
+    ++stats_.releases;
+
+    Clock::time_point now = Clock::now();
+    if (now >= due) {
+        ++stats_.late;
+    } else {
+        if (due - now > spin) {
+            ++stats_.sleeps;
+            const Clock::time_point wake = due - spin;
+#if defined(__linux__)
+            // steady_clock is CLOCK_MONOTONIC on Linux, so its epoch counts are absolute deadlines.
+            const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                wake.time_since_epoch()).count();
+            struct timespec ts;
+            ts.tv_sec = static_cast<time_t>(ns / 1000000000);
+            ts.tv_nsec = static_cast<long>(ns % 1000000000);
+            while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) == EINTR) {
+                // interrupted: sleep again to the same deadline
+            }
+#else
+            std::this_thread::sleep_until(wake);
+#endif
+        }
+        while ((now = Clock::now()) < due) {
+        }
+    }
+
+    const auto late_ns = static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(now - due).count());
+    stats_.lateness_ns_sum += late_ns;
+    stats_.lateness_ns_max = std::max(stats_.lateness_ns_max, late_ns);
+    if (options_.lateness_ns)
+        options_.lateness_ns->record(late_ns);
+    horizon_ = now + std::chrono::microseconds(options_.window_us);
+}
+
+}  // namespace qrsdp
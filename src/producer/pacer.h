@@ -0,0 +1,76 @@
+#pragma once
+
+#include "core/cpu_placement.h"
+
+#include <chrono>
+#include <cstdint>
+
+namespace qrsdp {
+
+class Histogram;
+
+/// Realtime pacing knobs (qrsdp_run --realtime).
+struct PacingOptions {
+    double   speed = 1.0;      // simulated seconds per wall-clock second
+    uint32_t spin_us = 100;    // spin instead of sleeping for the last spin_us before a due time
+    uint32_t window_us = 50;   // events falling due within this long of a release go out with it
+    int      cpu = -1;         // >= 0: pin the pacing thread to this CPU (Linux)
+    Histogram* lateness_ns = nullptr;  // non-null: record every release's lateness
+};
+
+/// How closely releases tracked their due times.
+struct PacingStats {
+    uint64_t releases = 0;        // waitUntil() calls
+    uint64_t sleeps = 0;          // releases that slept in the kernel before spinning
+    uint64_t late = 0;            // releases that were already past due when called
+    uint64_t lateness_ns_sum = 0; // wall time past the due time at return, summed
+    uint64_t lateness_ns_max = 0;
+
+    double meanLatenessUs() const {
+        return releases ? static_cast<double>(lateness_ns_sum) / static_cast<double>(releases) / 1e3
+                        : 0.0;
+    }
+};
+
+/// Maps simulated session time to wall-clock due times (origin + t / speed)
+/// and waits for them with a hybrid sleep/spin: an absolute
+/// clock_nanosleep(TIMER_ABSTIME) on CLOCK_MONOTONIC until spin_us before the
+/// due time, then a spin on steady_clock, so a release lands within
+/// microseconds rather than at the scheduler's sleep granularity. Absolute
+/// deadlines keep errors from accumulating over a session.
+///
+/// Callers batch: after waitUntil(t) returns, every event whose due time is
+/// before horizon() goes out in the same release, which bounds the clock reads
+/// and syscalls per event at high --speed.
+class Pacer {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit Pacer(const PacingOptions& options);
+
+    /// Sets the wall-clock time that simulated time 0 maps to.
+    void start(Clock::time_point origin = Clock::now());
+
+    Clock::time_point dueTime(double sim_seconds) const;
+
+    /// Blocks until sim_seconds is due (returns at once if it already is) and
+    /// records the lateness of the return.
+    void waitUntil(double sim_seconds);
+
+    /// End of the current release window: the last return of waitUntil() plus window_us.
+    Clock::time_point horizon() const { return horizon_; }
+    bool dueBy(double sim_seconds, Clock::time_point horizon) const {
+        return dueTime(sim_seconds) <= horizon;
+    }
+
+    const PacingOptions& options() const { return options_; }
+    const PacingStats& stats() const { return stats_; }
+
+private:
+    PacingOptions options_;
+    Clock::time_point origin_;
+    Clock::time_point horizon_;
+    PacingStats stats_;
+};
+
+}  // namespace qrsdp
@@ -0,0 +1,208 @@
+#include "producer/parameter_sweep.h"
+
+#include "book/multi_level_book.h"
+#include "model/simple_imbalance_intensity.h"
+#include "producer/basic_qrsdp_producer.h"
+#include "producer/work_stealing_pool.h"
+#include "rng/mt19937_rng.h"
+#include "rng/rng_stream.h"
+#include "sampler/competing_intensity_sampler.h"
+#include "sampler/unit_size_attribute_sampler.h"
+
+#include <algorithm>
+#include <chrono>
+
+namespace qrsdp {
+
+namespace {
+
+using SweepProducer = BasicQrsdpProducer<Mt19937Rng, MultiLevelBook, SimpleImbalanceIntensity,
+                                         CompetingIntensitySampler, UnitSizeAttributeSampler,
+                                         SessionStatsSink>;
+
+struct DayStats {
+    SessionStats stats;
+    double seconds = 0.0;
+};
+
+TradingSession makeSession(const SweepConfig& config, const IntensityParams& params, uint64_t seed) {
+    TradingSession session{};
+    session.seed = seed;
+    session.p0_ticks = config.p0_ticks;
+    session.session_seconds = config.session_seconds;
+    session.levels_per_side = config.levels_per_side;
+    session.tick_size = 100;
+    session.initial_spread_ticks = config.initial_spread_ticks;
+    session.initial_depth = config.initial_depth;
+    session.market_open_seconds = config.market_open_seconds;
+    session.intensity_params = params;
+    return session;
+}
+
+/// The producer's book seed, with its defaults for zero depth and spread.
+BookSeed bookSeed(const TradingSession& session) {
+    return BookSeed{session.p0_ticks, session.levels_per_side,
+                    session.initial_depth > 0 ? session.initial_depth : 50u,
+                    session.initial_spread_ticks > 0 ? session.initial_spread_ticks : 2u};
+}
+
+/// Runs one day, or with prefix one branch forked from it, into a stats sink.
+DayStats runDay(const SweepConfig& config, const IntensityParams& params, uint32_t day,
+                const ProducerSnapshot* prefix) {
+    const TradingSession session =
+        makeSession(config, params, streamSeed(config.base_seed, prefix ? 1 : 0, day));
+
+    const auto start = std::chrono::steady_clock::now();
+    Mt19937Rng rng(session.seed);
+    MultiLevelBook book;
+    SimpleImbalanceIntensity model(params);
+    CompetingIntensitySampler sampler(rng);
+    UnitSizeAttributeSampler attrs(rng, 0.5, 0.5);  // as SessionRunner
+    SweepProducer producer(rng, book, model, sampler, attrs);
+    const uint64_t open_ns = static_cast<uint64_t>(session.market_open_seconds) * 1'000'000'000ULL;
+    SessionStatsSink sink(bookSeed(session), open_ns, config.bar_seconds);
+    if (prefix) {
+        producer.fork(*prefix, session.seed);
+        sink.reset(bookSeed(session), open_ns, prefix->bids.data(), prefix->asks.data());
+        producer.finishSession(sink);
+    } else {
+        producer.runSession(session, sink);
+    }
+
+    DayStats out;
+    out.stats = sink.stats();
+    out.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return out;
+}
+
+/// The shared prefix of a branching sweep: the first point's session skipped
+/// ahead to fork_seconds.
+ProducerSnapshot runPrefix(const SweepConfig& config, const IntensityParams& params) {
+    const TradingSession session = makeSession(config, params, streamSeed(config.base_seed, 0, 0));
+    Mt19937Rng rng(session.seed);
+    MultiLevelBook book;
+    SimpleImbalanceIntensity model(params);
+    CompetingIntensitySampler sampler(rng);
+    UnitSizeAttributeSampler attrs(rng, 0.5, 0.5);
+    SweepProducer producer(rng, book, model, sampler, attrs);
+    producer.startSession(session);
+    producer.fastForward(config.fork_seconds);
+    return producer.snapshot();
+}
+
+}  // namespace
+
+std::vector<IntensityParams> ParameterGrid::points() const {
+    std::vector<IntensityParams> out;
+    for (double l : base_L)
+    for (double c : base_C)
+    for (double m : base_M)
+    for (double si : imbalance_sensitivity)
+    for (double sc : cancel_sensitivity)
+    for (double eps : epsilon_exec)
+    for (double ss : spread_sensitivity)
+        out.push_back(IntensityParams{l, c, m, si, sc, eps, ss});
+    return out;
+}
+
+std::vector<SweepResult> runParameterSweep(const SweepConfig& config) {
+    const std::vector<IntensityParams> points = config.grid.points();
+    const uint32_t days = config.days;
+    std::vector<DayStats> cells(points.size() * days);
+    ProducerSnapshot prefix;
+    const bool branching = config.fork_seconds > 0.0 && !points.empty();
+    if (branching) prefix = runPrefix(config, points.front());
+    {
+        WorkStealingPool pool(config.threads);
+        for (size_t p = 0; p < points.size(); ++p)
+            for (uint32_t d = 0; d < days; ++d)
+                pool.submit([&, p, d] {
+                    cells[p * days + d] = runDay(config, points[p], d, branching ? &prefix : nullptr);
+                });
+        pool.wait();
+    }
+
+    std::vector<SweepResult> results(points.size());
+    for (size_t p = 0; p < points.size(); ++p) {
+        SweepResult& r = results[p];
+        r.params = points[p];
+        r.days = days;
+        double range = 0.0;
+        for (uint32_t d = 0; d < days; ++d) {
+            const DayStats& cell = cells[p * days + d];
+            r.pooled.merge(cell.stats);
+            r.day_returns.add(cell.stats.close_mid - cell.stats.open_mid);
+            range += cell.stats.high_mid - cell.stats.low_mid;
+            r.generate_seconds += cell.seconds;
+        }
+        r.mean_range = days > 0 ? range / days : 0.0;
+    }
+    return results;
+}
+
+namespace {
+
+double share(const SessionStats& s, EventType t) {
+    return s.events > 0 ? static_cast<double>(s.type_counts[static_cast<int>(t)]) / static_cast<double>(s.events)
+                        : 0.0;
+}
+
+double perDay(double total, uint32_t days) {
+    return days > 0 ? total / days : 0.0;
+}
+
+/// Simulated minutes each day's stats cover (the continuation when branching).
+double dayMinutes(const SweepConfig& config) {
+    return std::max(0.0, config.session_seconds - config.fork_seconds) / 60.0;
+}
+
+}  // namespace
+
+void writeSweepCsv(std::FILE* f, const std::vector<SweepResult>& results, const SweepConfig& config) {
+    std::fprintf(f, "base_L,base_C,base_M,imbalance_sens,cancel_sens,epsilon_exec,spread_sens,days,"
+                    "events_per_day,shifts_per_min,bar_s,bar_sigma,bar_skew,bar_kurtosis,day_sigma,"
+                    "mean_range,mean_spread,spread_1tick,add_bid,add_ask,cancel_bid,cancel_ask,"
+                    "exec_buy,exec_sell,generate_s\n");
+    const double minutes = dayMinutes(config);
+    for (const SweepResult& r : results) {
+        const IntensityParams& p = r.params;
+        const SessionStats& s = r.pooled;
+        std::fprintf(f, "%g,%g,%g,%g,%g,%g,%g,%u,%.1f,%.3f,%g,%.5f,%.4f,%.4f,%.4f,%.3f,%.4f,%.4f,"
+                        "%.5f,%.5f,%.5f,%.5f,%.5f,%.5f,%.4f\n",
+                     p.base_L, p.base_C, p.base_M, p.imbalance_sensitivity, p.cancel_sensitivity,
+                     p.epsilon_exec, p.spread_sensitivity, r.days,
+                     perDay(static_cast<double>(s.events), r.days),
+                     minutes > 0.0 ? perDay(static_cast<double>(s.shifts), r.days) / minutes : 0.0,
+                     config.bar_seconds, s.bar_returns.stdev(), s.bar_returns.skewness(),
+                     s.bar_returns.excessKurtosis(), r.day_returns.stdev(), r.mean_range,
+                     s.meanSpread(), s.spreadShare(1),
+                     share(s, EventType::ADD_BID), share(s, EventType::ADD_ASK),
+                     share(s, EventType::CANCEL_BID), share(s, EventType::CANCEL_ASK),
+                     share(s, EventType::EXECUTE_BUY), share(s, EventType::EXECUTE_SELL),
+                     r.generate_seconds);
+    }
+}
+
+void writeSweepSummary(std::FILE* f, const std::vector<SweepResult>& results, const SweepConfig& config) {
+    std::fprintf(f, "| base_L | base_C | base_M | sI | sC | eps | sS | ev/day | shifts/min | %gs sd "
+                    "| %gs kurt | day sd | spread | 1-tick | exec share |\n",
+                 config.bar_seconds, config.bar_seconds);
+    std::fprintf(f, "|-------:|-------:|-------:|---:|---:|----:|---:|-------:|-----------:|------:"
+                    "|--------:|------:|-------:|-------:|-----------:|\n");
+    const double minutes = dayMinutes(config);
+    for (const SweepResult& r : results) {
+        const IntensityParams& p = r.params;
+        const SessionStats& s = r.pooled;
+        std::fprintf(f, "| %g | %g | %g | %g | %g | %g | %g | %.0f | %.2f | %.4f | %.2f | %.2f | %.3f "
+                        "| %.1f%% | %.1f%% |\n",
+                     p.base_L, p.base_C, p.base_M, p.imbalance_sensitivity, p.cancel_sensitivity,
+                     p.epsilon_exec, p.spread_sensitivity,
+                     perDay(static_cast<double>(s.events), r.days),
+                     minutes > 0.0 ? perDay(static_cast<double>(s.shifts), r.days) / minutes : 0.0,
+                     s.bar_returns.stdev(), s.bar_returns.excessKurtosis(), r.day_returns.stdev(),
+                     s.meanSpread(), 100.0 * s.spreadShare(1),
+                     100.0 * (share(s, EventType::EXECUTE_BUY) + share(s, EventType::EXECUTE_SELL)));
+    }
+}
+
+}  // namespace qrsdp
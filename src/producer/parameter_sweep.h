@@ -0,0 +1,68 @@
+#pragma once
+
+#include "core/records.h"
+#include "io/session_stats_sink.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+namespace qrsdp {
+
+/// SimpleImbalanceIntensity parameter values to sweep; points() is their
+/// cartesian product.
+struct ParameterGrid {
+    std::vector<double> base_L{20.0};
+    std::vector<double> base_C{0.5};
+    std::vector<double> base_M{15.0};
+    std::vector<double> imbalance_sensitivity{1.0};
+    std::vector<double> cancel_sensitivity{1.0};
+    std::vector<double> epsilon_exec{0.5};
+    std::vector<double> spread_sensitivity{0.4};
+
+    /// Every combination, spread_sensitivity varying fastest.
+    std::vector<IntensityParams> points() const;
+};
+
+struct SweepConfig {
+    ParameterGrid grid;
+    uint64_t base_seed = 42;
+    uint32_t days = 4;                  // independent sessions per point
+    uint32_t session_seconds = 3600;
+    int32_t p0_ticks = 10000;
+    uint32_t levels_per_side = 5;
+    uint32_t initial_spread_ticks = 2;
+    uint32_t initial_depth = 5;
+    uint32_t market_open_seconds = kDefaultMarketOpenSeconds;
+    double bar_seconds = 10.0;          // return bars of SessionStatsSink
+    uint32_t threads = 0;               // 0 = hardware concurrency
+    /// > 0: what-if branching. One prefix session (the first point, seed
+    /// streamSeed(base_seed, 0, 0)) runs to this time once; every point's
+    /// `days` sessions are then forks of its state (ProducerSnapshot) with seed
+    /// streamSeed(base_seed, 1, d), and their stats cover the continuation only.
+    double fork_seconds = 0.0;
+};
+
+struct SweepResult {
+    IntensityParams params;
+    uint32_t days = 0;
+    SessionStats pooled;                // every day's stats merged
+    ReturnMoments day_returns;          // close - open mid of each day (open = fork mid when branching)
+    double mean_range = 0.0;            // high - low mid, averaged over days
+    double generate_seconds = 0.0;      // summed over the point's days
+};
+
+/// Runs every grid point for config.days sessions on a WorkStealingPool, each
+/// session straight into a SessionStatsSink: no records are kept and nothing is
+/// written. Every session opens at p0 with the qrsdp_run --model simple
+/// producer; day d of every point uses seed streamSeed(base_seed, 0, d), so
+/// points differ by their parameters only (common random numbers). Results are
+/// in points() order and do not depend on the thread count. With fork_seconds
+/// the days are branches from one shared prefix instead of whole sessions.
+std::vector<SweepResult> runParameterSweep(const SweepConfig& config);
+
+void writeSweepCsv(std::FILE* f, const std::vector<SweepResult>& results, const SweepConfig& config);
+/// Markdown table of the main columns.
+void writeSweepSummary(std::FILE* f, const std::vector<SweepResult>& results, const SweepConfig& config);
+
+}  // namespace qrsdp
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "producer/i_producer.h"
+#include "producer/basic_qrsdp_producer.h"
 #include "rng/irng.h"
 #include "book/i_order_book.h"
 #include "model/i_intensity_model.h"
@@ -12,34 +13,45 @@ namespace qrsdp {
 
 /// Runs one intraday session: continuous-time loop, append to sink, return close.
 /// Also supports stepping: startSession() then stepOneEvent() for UI/debugging.
+/// Virtual-dispatch instantiation of BasicQrsdpProducer; hot paths (SessionRunner)
+/// instantiate the template with concrete types instead.
 class QrsdpProducer : public IProducer {
 public:
     QrsdpProducer(IRng& rng, IOrderBook& book, IIntensityModel& intensityModel,
                   IEventSampler& eventSampler, IAttributeSampler& attributeSampler);
     SessionResult runSession(const TradingSession&, IEventSink&) override;
+    /// See BasicQrsdpProducer::finishSession.
+    SessionResult finishSession(IEventSink& sink) { return impl_.finishSession(sink); }
 
     /// Stepping API (non-invasive): call startSession once, then stepOneEvent in a loop.
     void startSession(const TradingSession& session);
+    /// See BasicQrsdpProducer::resumeSession.
+    void resumeSession(const TradingSession& session, const BookCheckpoint& cp) {
+        impl_.resumeSession(session, cp);
+    }
+    /// See BasicQrsdpProducer::captureCheckpoint.
+    void captureCheckpoint(BookCheckpoint& cp) const { impl_.captureCheckpoint(cp); }
+    /// See BasicQrsdpProducer::snapshot and fork.
+    ProducerSnapshot snapshot() const { return impl_.snapshot(); }
+    void fork(const ProducerSnapshot& snap, uint64_t seed) { impl_.fork(snap, seed); }
     /// Advances one event; appends to sink and returns true. Returns false if past session end.
     bool stepOneEvent(IEventSink& sink);
-    double currentTime() const { return t_; }
-    uint64_t eventsWrittenThisSession() const { return events_written_; }
-    uint64_t shiftCountThisSession() const { return shift_count_; }
+    /// Generates up to max events into out without a sink; see BasicQrsdpProducer.
+    size_t stepEvents(size_t max, EventRecord* out);
+    /// Skips ahead to simulated time t; see BasicQrsdpProducer::fastForward.
+    uint64_t fastForward(double t);
+    /// See BasicQrsdpProducer::setIntensityScale.
+    void setIntensityScale(const IIntensityScale* scale) { impl_.setIntensityScale(scale); }
+    /// See BasicQrsdpProducer::setSeasonality.
+    void setSeasonality(const SeasonalityProfile* profile) { impl_.setSeasonality(profile); }
+    double currentTime() const { return impl_.currentTime(); }
+    uint64_t eventsWrittenThisSession() const { return impl_.eventsWrittenThisSession(); }
+    uint64_t shiftCountThisSession() const { return impl_.shiftCountThisSession(); }
+    uint64_t nextOrderId() const { return impl_.nextOrderId(); }
 
 private:
-    IRng* rng_;
-    IOrderBook* book_;
-    IIntensityModel* intensityModel_;
-    IEventSampler* eventSampler_;
-    IAttributeSampler* attributeSampler_;
-    double session_seconds_ = 0.0;
-    double t_ = 0.0;
-    uint64_t order_id_ = 1;
-    uint64_t events_written_ = 0;
-    uint64_t shift_count_ = 0;
-    double theta_reinit_ = 0.0;
-    double reinit_mean_ = 10.0;
-    uint64_t market_open_ns_ = 0;
+    BasicQrsdpProducer<IRng, IOrderBook, IIntensityModel, IEventSampler,
+                       IAttributeSampler, IEventSink> impl_;
 };
 
 }  // namespace qrsdp
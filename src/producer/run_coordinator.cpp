@@ -0,0 +1,771 @@
+#include "producer/run_coordinator.h"
+
+#include "io/run_catalog.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+
+#ifdef _WIN32
+    #ifndef WIN32_LEAN_AND_MEAN
+    #define WIN32_LEAN_AND_MEAN
+    #endif
+    #include <winsock2.h>
+    #include <ws2tcpip.h>
+    #pragma comment(lib, "ws2_32.lib")
+
+    namespace {
+    struct WinsockInit {
+        WinsockInit() {
+            WSADATA wsa;
+            WSAStartup(MAKEWORD(2, 2), &wsa);
+        }
+        ~WinsockInit() { WSACleanup(); }
+    };
+    static WinsockInit g_winsock_init;
+    }  // namespace
+
+    using socket_t = SOCKET;
+    using socklen_t = int;
+    constexpr socket_t kInvalidSocket = INVALID_SOCKET;
+    inline int closeSocket(socket_t s) { return closesocket(s); }
+#else
+    #include <arpa/inet.h>
+    #include <netdb.h>
+    #include <netinet/in.h>
+    #include <netinet/tcp.h>
+    #include <sys/select.h>
+    #include <sys/socket.h>
+    #include <sys/time.h>
+    #include <unistd.h>
+
+    using socket_t = int;
+    constexpr socket_t kInvalidSocket = -1;
+    inline int closeSocket(socket_t s) { return close(s); }
+#endif
+
+namespace qrsdp {
+
+namespace {
+
+constexpr int kPollTimeoutMs = 100;   // how often the coordinator checks shard deadlines
+constexpr size_t kMaxLine = 4096;     // longer lines are a broken peer
+
+bool sendAll(socket_t s, const std::string& data) {
+    size_t off = 0;
+    while (off < data.size()) {
+#ifdef MSG_NOSIGNAL
+        const auto n = send(s, data.data() + off, static_cast<int>(data.size() - off), MSG_NOSIGNAL);
+#else
+        const auto n = send(s, data.data() + off, static_cast<int>(data.size() - off), 0);
+#endif
+        if (n <= 0)
+            return false;
+        off += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+/// Moves the first complete line of buf (without its newline) into line.
+bool takeLine(std::string& buf, std::string& line) {
+    const auto nl = buf.find('\n');
+    if (nl == std::string::npos)
+        return false;
+    line.assign(buf, 0, nl);
+    if (!line.empty() && line.back() == '\r')
+        line.pop_back();
+    buf.erase(0, nl + 1);
+    return true;
+}
+
+/// Single-line form of an error message.
+std::string oneLine(std::string s) {
+    std::replace(s.begin(), s.end(), '\n', ' ');
+    std::replace(s.begin(), s.end(), '\r', ' ');
+    return s;
+}
+
+std::string toHex(const void* data, size_t size) {
+    static const char kDigits[] = "0123456789abcdef";
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    std::string out(2 * size, '0');
+    for (size_t i = 0; i < size; ++i) {
+        out[2 * i] = kDigits[p[i] >> 4];
+        out[2 * i + 1] = kDigits[p[i] & 0xf];
+    }
+    return out;
+}
+
+bool fromHex(const std::string& hex, void* data, size_t size) {
+    if (hex.size() != 2 * size)
+        return false;
+    unsigned char* p = static_cast<unsigned char*>(data);
+    for (size_t i = 0; i < size; ++i) {
+        int v = 0;
+        for (int k = 0; k < 2; ++k) {
+            const char c = hex[2 * i + k];
+            const int d = c >= '0' && c <= '9' ? c - '0' : c >= 'a' && c <= 'f' ? c - 'a' + 10 : -1;
+            if (d < 0)
+                return false;
+            v = v * 16 + d;
+        }
+        p[i] = static_cast<unsigned char>(v);
+    }
+    return true;
+}
+
+uint64_t fnv1a64(const std::string& s) {
+    uint64_t h = 0xcbf29ce484222325ULL;
+    for (unsigned char c : s) {
+        h ^= c;
+        h *= 0x100000001b3ULL;
+    }
+    return h;
+}
+
+/// A finished day as reported by a worker.
+struct ReportedDay {
+    CatalogDay day;
+    double write_seconds = 0.0;
+    double read_seconds = 0.0;
+    double compress_seconds = 0.0;
+};
+
+std::string dayLine(const CatalogDay& day, const DayResult& d) {
+    const CatalogEntry entry = packCatalogEntry(day);
+    char head[128];
+    std::snprintf(head, sizeof(head), "DAY %.9g %.9g %.9g ", d.write_seconds, d.read_seconds,
+                  d.compress_seconds);
+    return head + toHex(&entry, sizeof(entry)) + "\n";
+}
+
+bool parseDayLine(const std::string& line, ReportedDay& out) {
+    char hex[2 * sizeof(CatalogEntry) + 2];
+    if (std::sscanf(line.c_str(), "DAY %lf %lf %lf %513s", &out.write_seconds, &out.read_seconds,
+                    &out.compress_seconds, hex) != 4)
+        return false;
+    CatalogEntry entry{};
+    return fromHex(hex, &entry, sizeof(entry)) && unpackCatalogEntry(entry, out.day);
+}
+
+/// Directory one attempt at a shard writes into, inside output_dir so that
+/// publishing its files is a rename on the same file system.
+std::filesystem::path stagingDir(const std::string& output_dir, uint32_t id, uint32_t attempt) {
+    return std::filesystem::path(output_dir) / (".shard" + std::to_string(id) + "-" + std::to_string(attempt));
+}
+
+bool isStagingDir(const std::filesystem::path& path) {
+    return path.filename().string().rfind(".shard", 0) == 0;
+}
+
+/// Moves every file under staging to the same place under output_dir,
+/// replacing what is there, then removes staging.
+void publishStaged(const std::filesystem::path& staging, const std::string& output_dir) {
+    namespace fs = std::filesystem;
+    std::vector<fs::path> files;
+    for (const auto& entry : fs::recursive_directory_iterator(staging))
+        if (entry.is_regular_file()) files.push_back(entry.path());
+    for (const fs::path& from : files) {
+        const fs::path to = fs::path(output_dir) / fs::relative(from, staging);
+        fs::create_directories(to.parent_path());
+        fs::rename(from, to);
+    }
+    fs::remove_all(staging);
+}
+
+DayResult dayResult(const ReportedDay& r) {
+    DayResult d{};
+    d.symbol = r.day.symbol;
+    d.date = r.day.date;
+    d.filename = r.day.file;
+    d.seed = r.day.seed;
+    d.open_ticks = r.day.open_ticks;
+    d.close_ticks = r.day.close_ticks;
+    d.events_written = r.day.record_count;
+    d.chunks_written = r.day.chunk_count;
+    d.file_size_bytes = r.day.file_bytes;
+    d.write_seconds = r.write_seconds;
+    d.read_seconds = r.read_seconds;
+    d.compress_seconds = r.compress_seconds;
+    return d;
+}
+
+}  // namespace
+
+// --- Planning ---
+
+std::vector<RunShard> planShards(const RunConfig& config, uint32_t days_per_shard) {
+    if (config.num_days == 0 || config.realtime || config.workers > 0 || config.resume
+        || !config.container.empty() || config.itch_live.enabled || config.live_frames.enabled()
+        || config.shm_ring.enabled())
+        throw std::invalid_argument("a distributed run needs a fixed number of days written to day "
+                                    "files: no realtime, workers, resume, container or live outputs");
+    const uint32_t securities = std::max<uint32_t>(static_cast<uint32_t>(config.securities.size()), 1);
+    const uint32_t per = days_per_shard > 0 ? days_per_shard : config.num_days;
+    std::vector<RunShard> shards;
+    for (uint32_t si = 0; si < securities; ++si) {
+        const int32_t p0 = config.securities.empty() ? config.p0_ticks : config.securities[si].p0_ticks;
+        for (uint32_t first = 0; first < config.num_days; first += per) {
+            RunShard shard;
+            shard.id = static_cast<uint32_t>(shards.size());
+            shard.security = si;
+            shard.first_day = first;
+            shard.num_days = std::min(per, config.num_days - first);
+            shard.open_ticks = p0;
+            shards.push_back(shard);
+        }
+    }
+    return shards;
+}
+
+RunConfig shardRunConfig(const RunConfig& config, const RunShard& shard) {
+    RunConfig c = config;
+    c.first_day = shard.first_day;
+    c.num_days = shard.num_days;
+    c.first_security = shard.security;
+    c.shard_name = "shard" + std::to_string(shard.id);
+    // Independent days take their opens from the run's overnight path, which
+    // starts at the security's own p0.
+    const bool chained = !config.independent_days;
+    if (config.securities.empty()) {
+        if (chained) c.p0_ticks = shard.open_ticks;
+    } else {
+        c.securities = {config.securities.at(shard.security)};
+        if (chained) c.securities[0].p0_ticks = shard.open_ticks;
+    }
+    return c;
+}
+
+uint64_t runDigest(const RunConfig& config) {
+    std::string s;
+    char buf[512];
+    auto params = [&](const IntensityParams& p, const QueueReactiveParams& q) {
+        std::snprintf(buf, sizeof(buf), "|%.17g,%.17g,%.17g,%.17g,%.17g,%.17g,%.17g,%.17g,%.17g",
+                      p.base_L, p.base_C, p.base_M, p.imbalance_sensitivity, p.cancel_sensitivity,
+                      p.epsilon_exec, p.spread_sensitivity, q.theta_reinit, q.reinit_depth_mean);
+        s += buf;
+    };
+    std::snprintf(buf, sizeof(buf), "%s|%" PRIu64 "|%u|%u|%s|%d|%d|%d|%d|%d|%.17g|%u|%d|%u|%u|%u|%u|%u",
+                  config.run_id.c_str(), config.base_seed, config.num_days, config.session_seconds,
+                  config.start_date.c_str(), static_cast<int>(config.seed_scheme),
+                  static_cast<int>(config.rng), static_cast<int>(config.model_type),
+                  static_cast<int>(config.independent_days), static_cast<int>(config.order_book),
+                  config.overnight_sigma_ticks, config.market_open_seconds, config.p0_ticks,
+                  config.levels_per_side, config.tick_size, config.initial_spread_ticks,
+                  config.initial_depth, static_cast<unsigned>(config.selection_mode));
+    s += buf;
+    params(config.intensity_params, config.queue_reactive);
+    for (const SecurityConfig& sec : config.securities) {
+        std::snprintf(buf, sizeof(buf), "|%s:%d:%u:%u:%u:%u:%d", sec.symbol.c_str(), sec.p0_ticks,
+                      sec.tick_size, sec.levels_per_side, sec.initial_spread_ticks, sec.initial_depth,
+                      static_cast<int>(sec.model_type));
+        s += buf;
+        params(sec.intensity_params, sec.queue_reactive);
+    }
+    if (config.hawkes.baseline == HawkesBaseline::MU) {
+        s += "|hmu";
+        for (double m : config.hawkes.mu) {
+            std::snprintf(buf, sizeof(buf), ",%.17g", m);
+            s += buf;
+        }
+    }
+    for (const HawkesKernel& k : config.hawkes.kernels) {
+        std::snprintf(buf, sizeof(buf), "|h%.17g", k.beta);
+        s += buf;
+        for (const auto& row : k.alpha)
+            for (double a : row) {
+                std::snprintf(buf, sizeof(buf), ",%.17g", a);
+                s += buf;
+            }
+    }
+    return fnv1a64(s);
+}
+
+// --- RunCoordinator ---
+
+struct RunCoordinator::Impl {
+    using Clock = std::chrono::steady_clock;
+
+    enum class State { PENDING, RUNNING, COMMITTING, DONE };
+
+    struct ShardSlot {
+        RunShard shard;
+        int prev = -1;           // chained predecessor (same security, earlier days)
+        State state = State::PENDING;
+        uint32_t attempts = 0;
+        std::string last_error;
+        std::vector<ReportedDay> days;
+    };
+
+    struct Connection {
+        socket_t sock = kInvalidSocket;
+        std::string in;
+        std::string name;
+        bool ready = false;      // said HELLO and waits for a shard
+        int shard = -1;          // slot it is running
+        Clock::time_point deadline;
+        std::vector<ReportedDay> days;
+    };
+
+    RunConfig config;
+    CoordinatorOptions options;
+    uint64_t digest = 0;
+    std::vector<ShardSlot> slots;
+    size_t done = 0;
+    socket_t listener = kInvalidSocket;
+    uint16_t port = 0;
+    std::vector<Connection> conns;
+
+    std::string describe(const ShardSlot& slot) const {
+        const RunShard& s = slot.shard;
+        const std::string symbol = config.securities.empty() ? "" : config.securities[s.security].symbol + " ";
+        return "shard " + std::to_string(s.id) + " (" + symbol + "days " + std::to_string(s.first_day)
+               + "-" + std::to_string(s.first_day + s.num_days - 1) + ")";
+    }
+
+    bool isReady(const ShardSlot& slot) const {
+        return slot.state == State::PENDING && (slot.prev < 0 || slots[slot.prev].state == State::DONE);
+    }
+
+    void drop(Connection& c) {
+        if (c.shard >= 0)
+            requeue(c.shard, "worker " + c.name + " went away");
+        if (c.sock != kInvalidSocket)
+            closeSocket(c.sock);
+        c.sock = kInvalidSocket;
+        c.shard = -1;
+        c.ready = false;
+    }
+
+    void requeue(int index, const std::string& why) {
+        ShardSlot& slot = slots[index];
+        slot.state = State::PENDING;
+        slot.last_error = why;
+        std::fprintf(stderr, "coordinator: %s failed (attempt %u): %s\n", describe(slot).c_str(),
+                     slot.attempts, why.c_str());
+        if (slot.attempts >= options.max_attempts)
+            throw std::runtime_error("RunCoordinator: " + describe(slot) + " failed "
+                                     + std::to_string(slot.attempts) + " times; last: " + why);
+    }
+
+    void dispatch() {
+        for (Connection& c : conns) {
+            if (c.sock == kInvalidSocket || !c.ready)
+                continue;
+            auto it = std::find_if(slots.begin(), slots.end(), [this](const ShardSlot& s) { return isReady(s); });
+            if (it == slots.end())
+                return;
+            const int index = static_cast<int>(it - slots.begin());
+            ShardSlot& slot = *it;
+            RunShard& shard = slot.shard;
+            if (slot.prev >= 0) {
+                // The chain continues from the predecessor's last close.
+                const auto& prev_days = slots[slot.prev].days;
+                const auto last = std::max_element(prev_days.begin(), prev_days.end(),
+                    [](const ReportedDay& a, const ReportedDay& b) { return a.day.date < b.day.date; });
+                shard.open_ticks = last->day.close_ticks;
+            }
+            char line[160];
+            ++slot.attempts;
+            std::snprintf(line, sizeof(line), "SHARD %u %u %u %u %d %u\n", shard.id, shard.security,
+                          shard.first_day, shard.num_days, shard.open_ticks, slot.attempts);
+            slot.state = State::RUNNING;
+            c.ready = false;
+            c.shard = index;
+            c.days.clear();
+            c.deadline = Clock::now() + std::chrono::seconds(options.shard_timeout_s);
+            if (!sendAll(c.sock, line))
+                drop(c);
+        }
+    }
+
+    /// OK: a complete report lets the worker publish its staged files (COMMIT);
+    /// anything else sends it on, and it discards them.
+    void finish(Connection& c, uint32_t id) {
+        if (c.shard < 0 || slots[c.shard].shard.id != id || slots[c.shard].state != State::RUNNING)
+            return;  // not the shard it runs: ignore
+        ShardSlot& slot = slots[c.shard];
+        if (c.days.size() != slot.shard.num_days) {
+            requeue(c.shard, "worker " + c.name + " reported " + std::to_string(c.days.size()) + " of "
+                             + std::to_string(slot.shard.num_days) + " days");
+            c.shard = -1;
+            c.days.clear();
+            c.ready = true;
+            return;
+        }
+        slot.days = std::move(c.days);
+        slot.state = State::COMMITTING;
+        c.days.clear();
+        c.deadline = Clock::now() + std::chrono::seconds(options.shard_timeout_s);
+        if (!sendAll(c.sock, "COMMIT " + std::to_string(id) + "\n"))
+            drop(c);
+    }
+
+    /// COMMITTED: the worker's files are in place and the shard is done.
+    void committed(Connection& c, uint32_t id) {
+        if (c.shard < 0 || slots[c.shard].shard.id != id || slots[c.shard].state != State::COMMITTING)
+            return;
+        ShardSlot& slot = slots[c.shard];
+        slot.state = State::DONE;
+        ++done;
+        std::printf("coordinator: %s done by %s (%zu/%zu)\n", describe(slot).c_str(), c.name.c_str(),
+                    done, slots.size());
+        c.shard = -1;
+        c.ready = true;
+    }
+
+    void handleLine(Connection& c, const std::string& line) {
+        if (line.compare(0, 6, "HELLO ") == 0) {
+            char hex[32] = {};
+            char name[256] = {};
+            const int n = std::sscanf(line.c_str(), "HELLO %31s %255s", hex, name);
+            if (n < 1 || std::strtoull(hex, nullptr, 16) != digest) {
+                sendAll(c.sock, "ERR run configuration differs from the coordinator's\n");
+                drop(c);
+                return;
+            }
+            c.name = n == 2 ? name : "?";
+            c.ready = true;
+        } else if (line.compare(0, 4, "DAY ") == 0) {
+            ReportedDay day;
+            if (c.shard < 0 || !parseDayLine(line, day)) {
+                drop(c);
+                return;
+            }
+            c.days.push_back(std::move(day));
+        } else if (line.compare(0, 3, "OK ") == 0) {
+            finish(c, static_cast<uint32_t>(std::strtoul(line.c_str() + 3, nullptr, 10)));
+        } else if (line.compare(0, 10, "COMMITTED ") == 0) {
+            committed(c, static_cast<uint32_t>(std::strtoul(line.c_str() + 10, nullptr, 10)));
+        } else if (line.compare(0, 5, "FAIL ") == 0) {
+            char* end = nullptr;
+            const auto id = static_cast<uint32_t>(std::strtoul(line.c_str() + 5, &end, 10));
+            if (c.shard >= 0 && slots[c.shard].shard.id == id) {
+                const int index = c.shard;
+                c.shard = -1;
+                c.ready = true;
+                requeue(index, "worker " + c.name + ":" + std::string(end ? end : ""));
+            }
+        } else {
+            drop(c);
+        }
+    }
+
+    void acceptOne() {
+        const socket_t s = accept(listener, nullptr, nullptr);
+        if (s == kInvalidSocket)
+            return;
+        const int one = 1;
+        setsockopt(s, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&one), sizeof(one));
+        Connection c;
+        c.sock = s;
+        conns.push_back(std::move(c));
+    }
+
+    void readFrom(Connection& c) {
+        char buf[4096];
+        const auto n = recv(c.sock, buf, sizeof(buf), 0);
+        if (n <= 0) {
+            drop(c);
+            return;
+        }
+        c.in.append(buf, static_cast<size_t>(n));
+        std::string line;
+        while (c.sock != kInvalidSocket && takeLine(c.in, line))
+            handleLine(c, line);
+        if (c.in.size() > kMaxLine)
+            drop(c);
+    }
+
+    void poll() {
+        fd_set readable;
+        FD_ZERO(&readable);
+        FD_SET(listener, &readable);
+        socket_t max_fd = listener;
+        for (const Connection& c : conns) {
+            if (c.sock == kInvalidSocket)
+                continue;
+            FD_SET(c.sock, &readable);
+            max_fd = std::max(max_fd, c.sock);
+        }
+        struct timeval tv { 0, kPollTimeoutMs * 1000 };
+        if (select(static_cast<int>(max_fd) + 1, &readable, nullptr, nullptr, &tv) > 0) {
+            for (Connection& c : conns) {
+                if (c.sock != kInvalidSocket && FD_ISSET(c.sock, &readable))
+                    readFrom(c);
+            }
+            if (FD_ISSET(listener, &readable))
+                acceptOne();
+        }
+        if (options.shard_timeout_s > 0) {
+            const auto now = Clock::now();
+            for (Connection& c : conns) {
+                if (c.sock != kInvalidSocket && c.shard >= 0 && now > c.deadline) {
+                    sendAll(c.sock, "ERR shard timed out\n");
+                    drop(c);  // the late worker discards its staged files
+                }
+            }
+        }
+        conns.erase(std::remove_if(conns.begin(), conns.end(),
+                                   [](const Connection& c) { return c.sock == kInvalidSocket; }),
+                    conns.end());
+    }
+};
+
+RunCoordinator::RunCoordinator(const RunConfig& config, const CoordinatorOptions& options)
+    : impl_(std::make_unique<Impl>()) {
+    Impl& m = *impl_;
+    m.config = config;
+    m.options = options;
+    m.options.max_attempts = std::max<uint32_t>(options.max_attempts, 1);
+    m.digest = runDigest(config);
+    std::map<uint32_t, int> last_of_security;
+    for (const RunShard& shard : planShards(config, options.days_per_shard)) {
+        Impl::ShardSlot slot;
+        slot.shard = shard;
+        if (!config.independent_days) {
+            const auto it = last_of_security.find(shard.security);
+            if (it != last_of_security.end())
+                slot.prev = it->second;
+            last_of_security[shard.security] = static_cast<int>(m.slots.size());
+        }
+        m.slots.push_back(std::move(slot));
+    }
+
+    const socket_t sock = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (sock == kInvalidSocket)
+        throw std::runtime_error("RunCoordinator: socket() failed");
+    const int one = 1;
+    setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char*>(&one), sizeof(one));
+    struct sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(options.port);
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    if (bind(sock, reinterpret_cast<const struct sockaddr*>(&addr), sizeof(addr)) != 0
+        || listen(sock, 64) != 0) {
+        closeSocket(sock);
+        throw std::runtime_error("RunCoordinator: cannot listen on port " + std::to_string(options.port));
+    }
+    socklen_t addr_len = sizeof(addr);
+    getsockname(sock, reinterpret_cast<struct sockaddr*>(&addr), &addr_len);
+    m.port = ntohs(addr.sin_port);
+    m.listener = sock;
+}
+
+RunCoordinator::~RunCoordinator() {
+    for (Impl::Connection& c : impl_->conns) {
+        if (c.sock != kInvalidSocket)
+            closeSocket(c.sock);
+    }
+    if (impl_->listener != kInvalidSocket)
+        closeSocket(impl_->listener);
+}
+
+uint16_t RunCoordinator::port() const {
+    return impl_->port;
+}
+
+size_t RunCoordinator::shardCount() const {
+    return impl_->slots.size();
+}
+
+RunResult RunCoordinator::run() {
+    namespace fs = std::filesystem;
+    Impl& m = *impl_;
+    const auto start = std::chrono::steady_clock::now();
+    auto hangUp = [&m](const std::string& line) {
+        for (Impl::Connection& c : m.conns) {
+            if (c.sock == kInvalidSocket)
+                continue;
+            sendAll(c.sock, line);
+            closeSocket(c.sock);
+        }
+        m.conns.clear();
+    };
+    try {
+        while (m.done < m.slots.size()) {
+            m.dispatch();
+            m.poll();
+        }
+    } catch (const std::exception& e) {
+        hangUp("ERR " + oneLine(e.what()) + "\n");  // so the workers stop too
+        throw;
+    }
+    hangUp("DONE\n");
+
+    // Staging directories left by workers that died or were turned away.
+    std::error_code ec;
+    std::vector<fs::path> stale;
+    for (const auto& entry : fs::directory_iterator(m.config.output_dir, ec))
+        if (entry.is_directory() && isStagingDir(entry.path())) stale.push_back(entry.path());
+    for (const fs::path& dir : stale) fs::remove_all(dir, ec);
+
+    // Run order: securities as configured, each security's days by date.
+    std::map<std::string, size_t> security_order;
+    for (size_t si = 0; si < m.config.securities.size(); ++si)
+        security_order[m.config.securities[si].symbol] = si;
+    std::vector<const ReportedDay*> days;
+    for (const Impl::ShardSlot& slot : m.slots)
+        for (const ReportedDay& d : slot.days) days.push_back(&d);
+    std::stable_sort(days.begin(), days.end(), [&](const ReportedDay* a, const ReportedDay* b) {
+        const size_t sa = security_order.count(a->day.symbol) ? security_order[a->day.symbol] : 0;
+        const size_t sb = security_order.count(b->day.symbol) ? security_order[b->day.symbol] : 0;
+        return sa != sb ? sa < sb : a->day.date < b->day.date;
+    });
+
+    fs::create_directories(m.config.output_dir);
+    RunCatalogWriter catalog((fs::path(m.config.output_dir) / kRunCatalogName).string(), false);
+    RunResult result{};
+    result.total_events = 0;
+    for (const ReportedDay* d : days) {
+        catalog.add(d->day);
+        result.days.push_back(dayResult(*d));
+        result.total_events += d->day.record_count;
+    }
+    result.total_elapsed_seconds =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    SessionRunner::writeManifest(m.config, result);
+    return result;
+}
+
+// --- Worker ---
+
+uint32_t runWorker(const RunConfig& config, const std::string& coordinator, const std::string& name) {
+    const auto colon = coordinator.rfind(':');
+    if (colon == std::string::npos || colon == 0 || colon + 1 == coordinator.size())
+        throw std::runtime_error("runWorker: coordinator must be host:port, got " + coordinator);
+    const std::string host = coordinator.substr(0, colon);
+    const std::string port = coordinator.substr(colon + 1);
+
+    struct addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    struct addrinfo* found = nullptr;
+    if (getaddrinfo(host.c_str(), port.c_str(), &hints, &found) != 0 || !found)
+        throw std::runtime_error("runWorker: cannot resolve " + coordinator);
+    socket_t sock = kInvalidSocket;
+    for (struct addrinfo* ai = found; ai; ai = ai->ai_next) {
+        sock = socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+        if (sock == kInvalidSocket)
+            continue;
+        if (connect(sock, ai->ai_addr, static_cast<int>(ai->ai_addrlen)) == 0)
+            break;
+        closeSocket(sock);
+        sock = kInvalidSocket;
+    }
+    freeaddrinfo(found);
+    if (sock == kInvalidSocket)
+        throw std::runtime_error("runWorker: cannot connect to " + coordinator);
+    const int one = 1;
+    setsockopt(sock, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&one), sizeof(one));
+
+    struct Closer {
+        socket_t s;
+        ~Closer() { closeSocket(s); }
+    } closer{sock};
+    auto fail = [&](const std::string& what) -> std::runtime_error {
+        return std::runtime_error("runWorker: " + what);
+    };
+
+    char hello[320];
+    std::snprintf(hello, sizeof(hello), "HELLO %016" PRIx64 " %s\n", runDigest(config),
+                  name.empty() ? "worker" : name.c_str());
+    if (!sendAll(sock, hello))
+        throw fail("cannot reach " + coordinator);
+
+    std::string in;
+    auto nextLine = [&](std::string& line) {
+        while (!takeLine(in, line)) {
+            char buf[1024];
+            const auto n = recv(sock, buf, sizeof(buf), 0);
+            if (n <= 0)
+                throw fail("coordinator hung up");
+            in.append(buf, static_cast<size_t>(n));
+        }
+    };
+
+    uint32_t shards_run = 0;
+    std::string line;
+    bool have_line = false;  // a line read while waiting for COMMIT, not handled yet
+    for (;;) {
+        if (!have_line)
+            nextLine(line);
+        have_line = false;
+        if (line == "DONE")
+            return shards_run;
+        if (line.compare(0, 4, "ERR ") == 0)
+            throw fail("coordinator: " + line.substr(4));
+        RunShard shard;
+        uint32_t attempt = 0;
+        if (std::sscanf(line.c_str(), "SHARD %u %u %u %u %d %u", &shard.id, &shard.security, &shard.first_day,
+                        &shard.num_days, &shard.open_ticks, &attempt) != 6)
+            throw fail("unexpected message: " + line);
+
+        // The attempt runs into its own staging directory and is published only
+        // once the coordinator accepts it, so a worker that timed out and was
+        // replaced never writes over the day files of the attempt that replaced it.
+        RunConfig shard_config = shardRunConfig(config, shard);
+        const std::filesystem::path staging = stagingDir(config.output_dir, shard.id, attempt);
+        shard_config.output_dir = staging.string();
+        std::error_code ec;
+        std::string report;
+        try {
+            std::filesystem::remove_all(staging, ec);
+            const RunResult result = SessionRunner().run(shard_config);
+            const std::string catalog_path = (staging / SessionRunner::catalogName(shard_config)).string();
+            {
+                const RunCatalog catalog(catalog_path);
+                for (const DayResult& d : result.days) {
+                    const CatalogDay* day = catalog.find(d.symbol, d.date);
+                    if (!day)
+                        throw std::runtime_error("day " + d.symbol + " " + d.date + " missing from " + catalog_path);
+                    report += dayLine(*day, d);
+                }
+            }
+            std::filesystem::remove(catalog_path, ec);
+            report += "OK " + std::to_string(shard.id) + "\n";
+        } catch (const std::exception& e) {
+            report = "FAIL " + std::to_string(shard.id) + " " + oneLine(e.what()) + "\n";
+        }
+        ++shards_run;
+        const bool ok = report.compare(0, 5, "FAIL ") != 0;
+        try {
+            if (!sendAll(sock, report))
+                throw fail("coordinator hung up");
+            if (!ok) {
+                std::filesystem::remove_all(staging, ec);
+                continue;
+            }
+            nextLine(line);
+        } catch (...) {
+            std::filesystem::remove_all(staging, ec);
+            throw;
+        }
+        if (line != "COMMIT " + std::to_string(shard.id)) {
+            // Turned away (timed out, or the report was incomplete): the line
+            // says what to do next.
+            std::filesystem::remove_all(staging, ec);
+            have_line = true;
+            continue;
+        }
+        try {
+            publishStaged(staging, config.output_dir);
+            report = "COMMITTED " + std::to_string(shard.id) + "\n";
+        } catch (const std::exception& e) {
+            std::filesystem::remove_all(staging, ec);
+            report = "FAIL " + std::to_string(shard.id) + " " + oneLine(e.what()) + "\n";
+        }
+        if (!sendAll(sock, report))
+            throw fail("coordinator hung up");
+    }
+}
+
+}  // namespace qrsdp
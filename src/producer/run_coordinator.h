@@ -0,0 +1,103 @@
+#pragma once
+
+#include "producer/session_runner.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace qrsdp {
+
+/// One slice of a distributed run: days [first_day, first_day + num_days) of the
+/// security at run index security (0 in single-security mode).
+struct RunShard {
+    uint32_t id = 0;
+    uint32_t security = 0;
+    uint32_t first_day = 0;
+    uint32_t num_days = 0;
+    int32_t  open_ticks = 0;  // chained days: open of first_day (a later shard gets its predecessor's close)
+};
+
+/// Splits config's days into shards of at most days_per_shard days per security
+/// (0 = every day of a security in one shard), security-major and in day order.
+/// Chained shards of a security must run in that order; independent_days shards
+/// can run in any order. Throws std::invalid_argument for a run that cannot be
+/// sharded (continuous, realtime, workers, resume, container or live outputs).
+std::vector<RunShard> planShards(const RunConfig& config, uint32_t days_per_shard);
+
+/// The RunConfig a worker runs for shard: shard's security and days, placed in
+/// the whole run by first_security and first_day, named "shard<id>".
+RunConfig shardRunConfig(const RunConfig& config, const RunShard& shard);
+
+/// Fingerprint of everything that decides a run's output (seeds, dates,
+/// securities, model, session shape). Workers whose digest differs from the
+/// coordinator's are turned away.
+uint64_t runDigest(const RunConfig& config);
+
+struct CoordinatorOptions {
+    uint16_t port = 0;              // TCP port; 0 = any free port (RunCoordinator::port())
+    uint32_t days_per_shard = 0;    // see planShards
+    uint32_t max_attempts = 3;      // dispatches of one shard before the run fails
+    uint32_t shard_timeout_s = 0;   // > 0: a shard not reported in time is re-dispatched
+};
+
+/// Coordinator of a distributed run. Workers (runWorker, qrsdp_run --worker) on
+/// any number of nodes connect over TCP and are handed shards; each runs its
+/// shard with the ordinary SessionRunner into the run's output_dir and reports
+/// every finished day (its DayResult timings and catalogue entry). A shard
+/// whose worker fails, disconnects or times out goes back to the queue.
+///
+/// Day seeds are counter-based per (security, day) and shards carry their
+/// place in the run, so the output does not depend on which node ran what:
+/// it is the output of one SessionRunner::run over the whole config. Day files
+/// land wherever each worker's output_dir is; on a shared mount that is the
+/// run directory itself.
+///
+/// Each attempt at a shard runs into its own staging directory,
+/// output_dir/.shard<id>-<attempt>, and its files are renamed into output_dir
+/// only after the coordinator accepts the report (COMMIT). A worker that timed
+/// out gets ERR instead and deletes its staging directory, so it never writes
+/// over the attempt that replaced it; the coordinator removes staging
+/// directories still left in its output_dir at the end of the run.
+///
+/// Protocol (one text line per message):
+///   worker: HELLO <digest hex> <name>
+///   coord:  SHARD <id> <security> <first_day> <num_days> <open_ticks> <attempt> | DONE | ERR <why>
+///   worker: DAY <write_s> <read_s> <compress_s> <CatalogEntry hex>   (per finished day)
+///           OK <id> | FAIL <id> <why>
+///   coord:  COMMIT <id>   (answer to a complete OK)
+///   worker: COMMITTED <id> | FAIL <id> <why>
+/// The coordinator answers FAIL, an incomplete OK and COMMITTED with the next
+/// SHARD (or DONE) as soon as one is ready, so a worker simply waits for the
+/// next line.
+class RunCoordinator {
+public:
+    /// Plans the shards and listens. Throws std::invalid_argument if the run
+    /// cannot be sharded, std::runtime_error if the port cannot be bound.
+    RunCoordinator(const RunConfig& config, const CoordinatorOptions& options);
+    ~RunCoordinator();
+
+    RunCoordinator(const RunCoordinator&) = delete;
+    RunCoordinator& operator=(const RunCoordinator&) = delete;
+
+    uint16_t port() const;
+    size_t shardCount() const;
+
+    /// Serves workers until every shard is done, then writes the run's
+    /// catalogue and manifest.json and returns every day in run order. Throws
+    /// std::runtime_error once a shard has failed max_attempts times.
+    RunResult run();
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
+/// Worker side: connects to the coordinator at "host:port" and runs the shards
+/// it hands out until it says DONE. Returns the number of shards run. Throws
+/// std::runtime_error if the coordinator cannot be reached, turns the worker
+/// away or hangs up. A failing shard is reported, not thrown.
+uint32_t runWorker(const RunConfig& config, const std::string& coordinator, const std::string& name);
+
+}  // namespace qrsdp
@@ -0,0 +1,251 @@
+#include "producer/scaling_benchmark.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <string>
+#include <tuple>
+
+#ifdef _WIN32
+    #ifndef WIN32_LEAN_AND_MEAN
+    #define WIN32_LEAN_AND_MEAN
+    #endif
+    #include <windows.h>
+    #include <psapi.h>
+#else
+    #include <sys/resource.h>
+#endif
+
+namespace qrsdp {
+
+const char* sinkComboName(SinkCombo sinks) {
+    switch (sinks) {
+        case SinkCombo::FILE:       return "file";
+        case SinkCombo::FILE_KAFKA: return "file+kafka";
+        case SinkCombo::FILE_ITCH:  return "file+itch";
+    }
+    return "unknown";
+}
+
+bool parseSinkCombo(const std::string& s, SinkCombo& out) {
+    for (SinkCombo c : {SinkCombo::FILE, SinkCombo::FILE_KAFKA, SinkCombo::FILE_ITCH}) {
+        if (s == sinkComboName(c)) {
+            out = c;
+            return true;
+        }
+    }
+    return false;
+}
+
+std::vector<ScalingCase> ScalingSweep::cases() const {
+    std::vector<ScalingCase> out;
+    for (SinkCombo sink : sinks)
+    for (uint32_t k : levels)
+    for (ModelType model : models)
+    for (uint32_t chunk : chunk_capacities)
+    for (const CodecConfig& codec : codecs)
+    for (uint32_t secs : securities)
+    for (uint32_t t : threads) {
+        ScalingCase c;
+        c.levels_per_side = k;
+        c.model = model;
+        c.chunk_capacity = chunk;
+        c.codec = codec;
+        c.securities = secs;
+        c.threads = t;
+        c.sinks = sink;
+        out.push_back(c);
+    }
+    return out;
+}
+
+ScalingResult runScalingCase(const RunConfig& base, const ScalingCase& c,
+                             const std::string& dir, bool keep) {
+    namespace fs = std::filesystem;
+    RunConfig config = base;
+    config.output_dir = dir;
+    config.levels_per_side = c.levels_per_side;
+    config.model_type = c.model;
+    config.chunk_capacity = c.chunk_capacity;
+    config.codec = c.codec;
+    config.threads = c.threads;
+    config.independent_days = true;
+    config.securities.clear();
+    if (c.securities > 1) {
+        for (uint32_t i = 0; i < c.securities; ++i) {
+            SecurityConfig sec{};
+            char symbol[16];
+            std::snprintf(symbol, sizeof(symbol), "S%03u", i + 1);
+            sec.symbol = symbol;
+            sec.p0_ticks = base.p0_ticks + static_cast<int32_t>(i) * 100;
+            sec.tick_size = base.tick_size;
+            sec.levels_per_side = c.levels_per_side;
+            sec.initial_spread_ticks = base.initial_spread_ticks;
+            sec.initial_depth = base.initial_depth;
+            sec.intensity_params = base.intensity_params;
+            sec.queue_reactive = base.queue_reactive;
+            sec.model_type = c.model;
+            config.securities.push_back(sec);
+        }
+    }
+    if (c.sinks != SinkCombo::FILE_KAFKA)
+        config.kafka_brokers.clear();
+    config.itch_live.enabled = (c.sinks == SinkCombo::FILE_ITCH);
+
+    fs::remove_all(dir);
+    fs::create_directories(dir);
+    resetPeakRss();
+    SessionRunner runner;
+    const RunResult run = runner.run(config);
+
+    ScalingResult r;
+    r.config = c;
+    r.peak_rss_bytes = peakRssBytes();
+    r.events = run.total_events;
+    r.wall_seconds = run.total_elapsed_seconds;
+    for (const DayResult& d : run.days) {
+        r.file_bytes += d.file_size_bytes;
+        r.write_seconds += d.write_seconds;
+    }
+    if (r.wall_seconds > 0.0)
+        r.events_per_sec = static_cast<double>(r.events) / r.wall_seconds;
+    if (r.write_seconds > 0.0)
+        r.events_per_core_sec = static_cast<double>(r.events) / r.write_seconds;
+    if (r.events > 0)
+        r.bytes_per_event = static_cast<double>(r.file_bytes) / static_cast<double>(r.events);
+
+    if (keep)
+        SessionRunner::writePerformanceResults(config, run, (fs::path(dir) / "performance-results.md").string());
+    else
+        fs::remove_all(dir);
+    return r;
+}
+
+void computeScalingEfficiency(std::vector<ScalingResult>& results) {
+    // Everything but the thread count identifies a scaling series.
+    using Key = std::tuple<uint32_t, int, uint32_t, std::string, uint32_t, int>;
+    std::map<Key, const ScalingResult*> baseline;
+    auto key = [](const ScalingCase& c) {
+        return Key{c.levels_per_side, static_cast<int>(c.model), c.chunk_capacity,
+                   codecSpecString(c.codec), c.securities, static_cast<int>(c.sinks)};
+    };
+    for (const ScalingResult& r : results) {
+        const ScalingResult*& b = baseline[key(r.config)];
+        if (!b || r.config.threads < b->config.threads)
+            b = &r;
+    }
+    std::vector<double> efficiency(results.size(), 1.0);
+    for (size_t i = 0; i < results.size(); ++i) {
+        const ScalingResult& r = results[i];
+        const ScalingResult& b = *baseline[key(r.config)];
+        if (b.events_per_sec > 0.0 && b.config.threads > 0 && r.config.threads > 0) {
+            efficiency[i] = (r.events_per_sec / b.events_per_sec)
+                            / (static_cast<double>(r.config.threads) / b.config.threads);
+        }
+    }
+    for (size_t i = 0; i < results.size(); ++i) results[i].scaling_efficiency = efficiency[i];
+}
+
+
+void writeScalingCsv(std::FILE* f, const std::vector<ScalingResult>& results) {
+    std::fprintf(f, "levels,model,chunk,codec,securities,threads,sinks,events,file_bytes,"
+                    "wall_s,write_s,events_per_s,events_per_core_s,bytes_per_event,"
+                    "peak_rss_bytes,scaling_efficiency\n");
+    for (const ScalingResult& r : results) {
+        const ScalingCase& c = r.config;
+        std::fprintf(f, "%u,%s,%u,%s,%u,%u,%s,%llu,%llu,%.4f,%.4f,%.0f,%.0f,%.3f,%llu,%.3f\n",
+                     c.levels_per_side, modelTypeName(c.model), c.chunk_capacity,
+                     codecSpecString(c.codec).c_str(), c.securities, c.threads,
+                     sinkComboName(c.sinks), (unsigned long long)r.events,
+                     (unsigned long long)r.file_bytes, r.wall_seconds, r.write_seconds,
+                     r.events_per_sec, r.events_per_core_sec, r.bytes_per_event,
+                     (unsigned long long)r.peak_rss_bytes, r.scaling_efficiency);
+    }
+}
+
+void writeScalingJson(std::FILE* f, const std::vector<ScalingResult>& results) {
+    std::fprintf(f, "{\n  \"results\": [");
+    for (size_t i = 0; i < results.size(); ++i) {
+        const ScalingResult& r = results[i];
+        const ScalingCase& c = r.config;
+        std::fprintf(f, "%s\n    {\"levels\": %u, \"model\": \"%s\", \"chunk\": %u, \"codec\": \"%s\", "
+                        "\"securities\": %u, \"threads\": %u, \"sinks\": \"%s\", "
+                        "\"events\": %llu, \"file_bytes\": %llu, \"wall_s\": %.4f, \"write_s\": %.4f, "
+                        "\"events_per_s\": %.0f, \"events_per_core_s\": %.0f, "
+                        "\"bytes_per_event\": %.3f, \"peak_rss_bytes\": %llu, "
+                        "\"scaling_efficiency\": %.3f}",
+                     i ? "," : "", c.levels_per_side, modelTypeName(c.model), c.chunk_capacity,
+                     codecSpecString(c.codec).c_str(), c.securities, c.threads,
+                     sinkComboName(c.sinks), (unsigned long long)r.events,
+                     (unsigned long long)r.file_bytes, r.wall_seconds, r.write_seconds,
+                     r.events_per_sec, r.events_per_core_sec, r.bytes_per_event,
+                     (unsigned long long)r.peak_rss_bytes, r.scaling_efficiency);
+    }
+    std::fprintf(f, "\n  ]\n}\n");
+}
+
+void writeScalingSummary(std::FILE* f, const std::vector<ScalingResult>& results) {
+    std::fprintf(f, "| K | Model | Chunk | Codec | Secs | Threads | Sinks | Events | ev/s | ev/core/s "
+                    "| B/event | Peak RSS MB | Efficiency |\n");
+    std::fprintf(f, "|--:|:------|------:|:------|-----:|--------:|:------|-------:|-----:|----------:"
+                    "|--------:|------------:|-----------:|\n");
+    for (const ScalingResult& r : results) {
+        const ScalingCase& c = r.config;
+        std::fprintf(f, "| %u | %s | %u | %s | %u | %u | %s | %llu | %.0f | %.0f | %.2f | %.1f | %.2f |\n",
+                     c.levels_per_side, modelTypeName(c.model), c.chunk_capacity,
+                     codecSpecString(c.codec).c_str(), c.securities, c.threads,
+                     sinkComboName(c.sinks), (unsigned long long)r.events, r.events_per_sec,
+                     r.events_per_core_sec, r.bytes_per_event,
+                     static_cast<double>(r.peak_rss_bytes) / (1024.0 * 1024.0), r.scaling_efficiency);
+    }
+    if (results.empty())
+        return;
+
+    const auto best = std::max_element(results.begin(), results.end(),
+        [](const ScalingResult& a, const ScalingResult& b) { return a.events_per_sec < b.events_per_sec; });
+    double core_rate = 0.0;
+    for (const ScalingResult& r : results) core_rate = std::max(core_rate, r.events_per_core_sec);
+    std::fprintf(f, "\nBest: %.0f events/s (K=%u, %s, %u securities, %u threads, %s).\n",
+                 best->events_per_sec, best->config.levels_per_side, modelTypeName(best->config.model),
+                 best->config.securities, best->config.threads, sinkComboName(best->config.sinks));
+    if (core_rate > 0.0) {
+        std::fprintf(f, "One core generates and writes up to %.0f events/s: a feed of R events/s "
+                        "needs about R / %.0f cores at linear scaling.\n", core_rate, core_rate);
+    }
+}
+
+void resetPeakRss() {
+#ifdef __linux__
+    // "5" resets VmHWM (Linux 4.0+); failure just leaves the process-wide peak.
+    std::ofstream("/proc/self/clear_refs") << "5";
+#endif
+}
+
+uint64_t peakRssBytes() {
+#if defined(__linux__)
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.compare(0, 6, "VmHWM:") == 0)
+            return std::stoull(line.substr(6)) * 1024;  // "VmHWM:   12345 kB"
+    }
+    return 0;
+#elif defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS pmc;
+    if (K32GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc)))
+        return static_cast<uint64_t>(pmc.PeakWorkingSetSize);
+    return 0;
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+        return 0;
+#ifdef __APPLE__
+    return static_cast<uint64_t>(usage.ru_maxrss);  // bytes on macOS
+#else
+    return static_cast<uint64_t>(usage.ru_maxrss) * 1024;
+#endif
+#endif
+}
+
+}  // namespace qrsdp
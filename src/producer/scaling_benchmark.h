@@ -0,0 +1,83 @@
+#pragma once
+
+#include "producer/session_runner.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace qrsdp {
+
+/// Outputs a benchmarked run writes besides its day files.
+enum class SinkCombo { FILE, FILE_KAFKA, FILE_ITCH };
+
+/// "file", "file+kafka", "file+itch".
+const char* sinkComboName(SinkCombo sinks);
+/// Parses a sinkComboName(). Returns false (out untouched) otherwise.
+bool parseSinkCombo(const std::string& s, SinkCombo& out);
+
+/// One point of a scaling sweep: the RunConfig settings it varies.
+struct ScalingCase {
+    uint32_t levels_per_side = 5;
+    ModelType model = ModelType::SIMPLE;
+    uint32_t chunk_capacity = 4096;
+    CodecConfig codec;
+    uint32_t securities = 1;     // symbols S001..; 1 = single-security mode
+    uint32_t threads = 1;        // RunConfig::threads (day-scheduler workers)
+    SinkCombo sinks = SinkCombo::FILE;
+};
+
+/// Values to sweep per dimension; cases() is their cartesian product.
+struct ScalingSweep {
+    std::vector<uint32_t> levels{5};
+    std::vector<ModelType> models{ModelType::SIMPLE};
+    std::vector<uint32_t> chunk_capacities{4096};
+    std::vector<CodecConfig> codecs{CodecConfig{}};
+    std::vector<uint32_t> securities{1};
+    std::vector<uint32_t> threads{1};
+    std::vector<SinkCombo> sinks{SinkCombo::FILE};
+
+    /// Every combination, threads varying fastest so each scaling series is
+    /// contiguous.
+    std::vector<ScalingCase> cases() const;
+};
+
+struct ScalingResult {
+    ScalingCase config;
+    uint64_t events = 0;
+    uint64_t file_bytes = 0;        // day files on disk
+    double wall_seconds = 0.0;      // SessionRunner::run, read-back verification included
+    double write_seconds = 0.0;     // sum of per-day generate+write time over all threads
+    double events_per_sec = 0.0;    // events / wall_seconds
+    double events_per_core_sec = 0.0;  // events / write_seconds: one core's generation rate
+    double bytes_per_event = 0.0;   // file_bytes / events
+    uint64_t peak_rss_bytes = 0;    // process peak RSS during the case (0 if unknown)
+    double scaling_efficiency = 1.0;  // see computeScalingEfficiency()
+};
+
+/// Runs one case: base with the case's settings applied (and independent_days,
+/// so days spread over the threads unless the ITCH sink forbids it), writing to
+/// a fresh dir that is removed afterwards unless keep (then it also gets a
+/// performance-results.md). Kafka cases need base.kafka_brokers; ITCH cases
+/// use base.itch_live's destination.
+ScalingResult runScalingCase(const RunConfig& base, const ScalingCase& c,
+                             const std::string& dir, bool keep = false);
+
+/// Sets each result's scaling_efficiency to its speed-up over the fewest-thread
+/// result of the same configuration, divided by the thread ratio: 1.0 is linear
+/// scaling, 0.5 means half of the added threads' capacity is lost.
+void computeScalingEfficiency(std::vector<ScalingResult>& results);
+
+void writeScalingCsv(std::FILE* f, const std::vector<ScalingResult>& results);
+void writeScalingJson(std::FILE* f, const std::vector<ScalingResult>& results);
+/// Markdown table of every case plus the best events/s and per-core rates, for
+/// sizing hardware.
+void writeScalingSummary(std::FILE* f, const std::vector<ScalingResult>& results);
+
+/// Resets the peak-RSS high-water mark where the OS allows it (Linux).
+void resetPeakRss();
+/// Peak resident set size of the process in bytes (0 if unavailable).
+uint64_t peakRssBytes();
+
+}  // namespace qrsdp
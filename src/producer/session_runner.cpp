@@ -1,14 +1,31 @@
 #include "producer/session_runner.h"
-#include "producer/qrsdp_producer.h"
+#include "core/metrics.h"
+#include "producer/basic_qrsdp_producer.h"
+#include "producer/pacer.h"
+#include "producer/stage_profile.h"
+#include "producer/work_stealing_pool.h"
+#include "io/arrow_file_sink.h"
 #include "io/binary_file_sink.h"
+#include "io/book_frame.h"
+#include "io/frame_ring.h"
+#include "io/shm_ring_sink.h"
+#include "io/book_replayer.h"
 #include "io/multiplex_sink.h"
 #include "io/event_log_reader.h"
 #include "io/event_log_format.h"
+#include "io/run_catalog.h"
+#include "io/session_container.h"
 #include "book/multi_level_book.h"
+#include "book/order_level_book.h"
 #include "model/simple_imbalance_intensity.h"
 #include "model/curve_intensity_model.h"
+#include "model/hawkes_intensity_model.h"
 #include "model/hlr_params.h"
 #include "rng/mt19937_rng.h"
+#include "rng/philox_rng.h"
+#include "rng/rng_factory.h"
+#include "rng/rng_stream.h"
+#include "rng/xoshiro256pp_rng.h"
 #include "sampler/competing_intensity_sampler.h"
 #include "sampler/unit_size_attribute_sampler.h"
 
@@ -16,9 +33,16 @@
 #include "io/kafka_sink.h"
 #endif
 
+#include <algorithm>
 #include <atomic>
+#include <cmath>
 #include <csignal>
+#include <exception>
+#include <functional>
+#include <map>
 #include <memory>
+#include <mutex>
+#include <queue>
 
 #include <chrono>
 #include <cstdio>
@@ -26,6 +50,7 @@
 #include <filesystem>
 #include <stdexcept>
 #include <thread>
+#include <utility>
 
 namespace qrsdp {
 
@@ -88,6 +113,13 @@ Date nextBusinessDay(const Date& d) {
     return Date{tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday};
 }
 
+/// Whether days are generated independently (RunConfig::independent_days): only
+/// for a finite run with no real-time pacing and no live ITCH feed, frames or bus.
+static bool independentDays(const RunConfig& config) {
+    return config.independent_days && config.num_days > 0 && !config.realtime
+        && !config.itch_live.enabled && !config.live_frames.enabled() && !config.shm_ring.enabled();
+}
+
 // ---------------------------------------------------------------------------
 // Manifest writer (hand-rolled JSON)
 // ---------------------------------------------------------------------------
@@ -105,8 +137,32 @@ void SessionRunner::writeManifest(const RunConfig& config, const RunResult& resu
     std::fprintf(f, "  \"run_id\": \"%s\",\n", config.run_id.c_str());
     std::fprintf(f, "  \"producer\": \"qrsdp\",\n");
     std::fprintf(f, "  \"base_seed\": %llu,\n", (unsigned long long)config.base_seed);
-    std::fprintf(f, "  \"seed_strategy\": \"sequential\",\n");
+    std::fprintf(f, "  \"seed_strategy\": \"%s\",\n",
+                 config.seed_scheme == SeedScheme::COUNTER ? "counter" : "sequential");
+    std::fprintf(f, "  \"rng\": \"%s\",\n", rngAlgorithmName(config.rng));
+    if (independentDays(config)) {
+        std::fprintf(f, "  \"independent_days\": true,\n");
+        std::fprintf(f, "  \"overnight_sigma_ticks\": %.6g,\n", config.overnight_sigma_ticks);
+    }
+    if (config.order_book) std::fprintf(f, "  \"book\": \"order_level\",\n");
+    if (!config.seasonality.empty()) {
+        std::fprintf(f, "  \"seasonality\": {\"bucket_seconds\": %.6g, \"multipliers\": [",
+                     config.seasonality.bucketSeconds());
+        const std::vector<double>& m = config.seasonality.multipliers();
+        for (size_t i = 0; i < m.size(); ++i) std::fprintf(f, "%s%.6g", i ? ", " : "", m[i]);
+        std::fprintf(f, "]},\n");
+    }
     std::fprintf(f, "  \"session_seconds\": %u,\n", config.session_seconds);
+    if (!config.bar_seconds.empty()) {
+        std::fprintf(f, "  \"bar_seconds\": [");
+        for (size_t i = 0; i < config.bar_seconds.size(); ++i)
+            std::fprintf(f, "%s%u", i ? ", " : "", config.bar_seconds[i]);
+        std::fprintf(f, "],\n");
+    }
+    if (!config.container.empty())
+        std::fprintf(f, "  \"container\": \"%s\",\n", config.container.c_str());
+    if (config.arrow)
+        std::fprintf(f, "  \"arrow\": true,\n");
 
     if (multi) {
         std::fprintf(f, "  \"securities\": [\n");
@@ -190,6 +246,25 @@ void SessionRunner::writePerformanceResults(const RunConfig& config,
     std::fprintf(f, "| initial_depth | %u |\n", config.initial_depth);
     std::fprintf(f, "| chunk_capacity | %u |\n",
                  config.chunk_capacity > 0 ? config.chunk_capacity : kDefaultChunkCapacity);
+    std::fprintf(f, "| write_buffers | %u |\n", config.write_buffers);
+    std::fprintf(f, "| chunk_layout | %s |\n", config.columnar ? "columnar (v1.1)" : "row (v1.0)");
+    std::fprintf(f, "| codec | %s |\n", codecSpecString(config.codec).c_str());
+    std::fprintf(f, "| seek_stride | %u |\n", config.seek_stride);
+    std::fprintf(f, "| checkpoint_interval | %u |\n", config.checkpoint_interval);
+    std::fprintf(f, "| sync_interval | %u |\n", config.sync_interval);
+    std::fprintf(f, "| verify | %s |\n", verifyModeName(config.verify));
+    if (config.placement.enabled())
+        std::fprintf(f, "| placement | %s |\n", config.placement.describe().c_str());
+    if (config.io_uring) {
+        const IoUringOptions& uring = config.io_uring->options();
+        std::fprintf(f, "| io_uring | %u x %u KiB buffers%s%s |\n", uring.buffers, uring.buffer_bytes / 1024,
+                     config.io_uring->buffersRegistered() ? ", registered" : "", uring.direct ? ", O_DIRECT" : "");
+    } else {
+        std::fprintf(f, "| io_uring | off (stdio) |\n");
+    }
+    std::string bars;
+    for (uint32_t b : config.bar_seconds) bars += (bars.empty() ? "" : ",") + std::to_string(b);
+    std::fprintf(f, "| bar_seconds | %s |\n", bars.empty() ? "none" : bars.c_str());
     std::fprintf(f, "| base_L | %.1f |\n", config.intensity_params.base_L);
     std::fprintf(f, "| base_C | %.1f |\n", config.intensity_params.base_C);
     std::fprintf(f, "| base_M | %.1f |\n", config.intensity_params.base_M);
@@ -203,6 +278,7 @@ void SessionRunner::writePerformanceResults(const RunConfig& config,
     uint64_t total_raw_bytes = 0;
     double total_write_secs = 0.0;
     double total_read_secs = 0.0;
+    double total_compress_secs = 0.0;
     for (const auto& d : result.days) {
         const uint64_t raw = d.events_written * sizeof(DiskEventRecord);
         const double ratio = d.file_size_bytes > 0
@@ -218,6 +294,7 @@ void SessionRunner::writePerformanceResults(const RunConfig& config,
         total_raw_bytes += raw;
         total_write_secs += d.write_seconds;
         total_read_secs += d.read_seconds;
+        total_compress_secs += d.compress_seconds;
 
         std::fprintf(f, "| %s | %llu | %llu B | %.2fx | %.0f | %.0f | %.2f | %.2f | %d | %d |\n",
                      d.date.c_str(),
@@ -253,6 +330,26 @@ void SessionRunner::writePerformanceResults(const RunConfig& config,
     std::fprintf(f, "| Total wall time | %.2f s |\n", result.total_elapsed_seconds);
     std::fprintf(f, "\n");
 
+    // Throughputs are in raw (uncompressed) MB/s. Decompression is timed by the
+    // read-back pass, which decodes every chunk once.
+    const double raw_mb = static_cast<double>(total_raw_bytes) / (1024.0 * 1024.0);
+    std::fprintf(f, "## Compression\n\n");
+    std::fprintf(f, "| Codec | Layout | Ratio | Compress MB/s | Decompress MB/s |\n");
+    std::fprintf(f, "|:------|:-------|------:|--------------:|----------------:|\n");
+    std::fprintf(f, "| %s | %s | %.2fx | %.0f | %.0f |\n",
+                 codecSpecString(config.codec).c_str(),
+                 config.columnar ? "columnar" : "row",
+                 overall_ratio,
+                 total_compress_secs > 0.0 ? raw_mb / total_compress_secs : 0.0,
+                 total_read_secs > 0.0 ? raw_mb / total_read_secs : 0.0);
+    std::fprintf(f, "\n");
+
+    if (config.stage_profile) {
+        std::fprintf(f, "## Stage Breakdown\n\n");
+        writeStageTable(f, config.stage_profile->snapshot());
+        std::fprintf(f, "\n");
+    }
+
     std::fclose(f);
 }
 
@@ -262,178 +359,1011 @@ void SessionRunner::writePerformanceResults(const RunConfig& config,
 
 static constexpr uint64_t kSeedStride = 1024;
 
-static std::vector<DayResult> runSecurityDays(
+static PacingOptions pacingOptions(const RunConfig& config) {
+    PacingOptions p;
+    p.speed = config.speed;
+    p.spin_us = config.pace_spin_us;
+    p.window_us = config.pace_window_us;
+    p.cpu = config.pace_cpu;
+    if (config.metrics) {
+        p.lateness_ns = &config.metrics->histogram(
+            "qrsdp_pacing_lateness_ns", "Realtime release lateness past the due time");
+    }
+    return p;
+}
+
+/// Hot-path metrics of one security; all null without RunConfig::metrics, in
+/// which case the generation loops skip the clock reads entirely.
+struct SecurityMetrics {
+    Counter* events = nullptr;       // qrsdp_events_total
+    Histogram* step_ns = nullptr;    // qrsdp_step_ns: generation time per event (batch mean)
+    Histogram* append_ns = nullptr;  // qrsdp_sink_append_ns: one appendBatch to the sinks
+    Histogram* flush_ns = nullptr;   // qrsdp_sink_flush_ns: closing a day's sinks
+
+    using Clock = std::chrono::steady_clock;
+    static uint64_t ns(Clock::duration d) {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(d).count());
+    }
+    /// n events stepped over [t0, t1) and appended over [t1, t2).
+    void recordBatch(size_t n, Clock::time_point t0, Clock::time_point t1, Clock::time_point t2) const {
+        events->add(n);
+        step_ns->record(ns(t1 - t0) / n);
+        append_ns->record(ns(t2 - t1));
+    }
+};
+
+static SecurityMetrics securityMetrics(const RunConfig& config, const std::string& symbol) {
+    SecurityMetrics m;
+    if (!config.metrics) return m;
+    const std::string label = "symbol=\"" + (symbol.empty() ? std::string("default") : symbol) + "\"";
+    m.events = &config.metrics->counter("qrsdp_events_total", "Events generated", label);
+    m.step_ns = &config.metrics->histogram(
+        "qrsdp_step_ns", "Generation time per event, batch mean (ns)", label);
+    m.append_ns = &config.metrics->histogram(
+        "qrsdp_sink_append_ns", "Time of one appendBatch to the sinks (ns)", label);
+    m.flush_ns = &config.metrics->histogram(
+        "qrsdp_sink_flush_ns", "Time to close a day's sinks (ns)", label);
+    return m;
+}
+
+/// Stage-timing policy of the run's producers: CycleStageProfile in
+/// QRSDP_STAGE_PROFILE builds, otherwise the free NoStageProfile. A build option
+/// rather than a RunConfig switch so the producer is not instantiated twice.
+#ifdef QRSDP_STAGE_PROFILE
+using RunStageProfile = CycleStageProfile;
+#else
+using RunStageProfile = NoStageProfile;
+#endif
+
+/// Adds a producer's stage profile to the run totals, if any are being kept.
+static void mergeStageProfile(const RunConfig& config, const RunStageProfile& profile) {
+#ifdef QRSDP_STAGE_PROFILE
+    if (config.stage_profile)
+        config.stage_profile->merge(profile);
+#else
+    (void)config;
+    (void)profile;
+#endif
+}
+
+#ifdef QRSDP_KAFKA_ENABLED
+static KafkaSinkOptions kafkaOptions(const RunConfig& config) {
+    KafkaSinkOptions options = config.kafka;
+    if (config.metrics) {
+        options.queue_depth = &config.metrics->gauge(
+            "qrsdp_kafka_queue_depth", "Messages in the librdkafka producer queue");
+        options.delivery_latency_ns = &config.metrics->histogram(
+            "qrsdp_kafka_delivery_latency_ns", "Kafka produce-to-acknowledgement time (ns)");
+    }
+    return options;
+}
+#endif
+
+/// Runs one session through a BasicQrsdpProducer specialised on the concrete model
+/// and sink, so the per-event calls are resolved at compile time. Batch mode hands
+/// records to the sink via appendBatch(); real-time mode holds each event until the
+/// Pacer says it is due and releases it with whatever else falls due in the pacing
+/// window (stats into *pacing). Honours shutdown requests. With resume_from the
+/// session continues from that checkpoint of a resumed file. Returns events written
+/// (the resumed file's earlier events included).
+template <class Rng, class Book, class Model, class Sink>
+static uint64_t generateSession(Rng& rng, Book& book, Model& model,
+                                CompetingIntensitySampler& sampler,
+                                UnitSizeAttributeSampler& attrs, Sink& sink,
+                                const TradingSession& session, const RunConfig& config,
+                                BinaryFileSink& file_sink, const BookCheckpoint* resume_from,
+                                PacingStats* pacing, const SecurityMetrics& metrics)
+{
+    using Producer = BasicQrsdpProducer<Rng, Book, Model, CompetingIntensitySampler,
+                                        UnitSizeAttributeSampler, Sink, RunStageProfile>;
+    Producer producer(rng, book, model, sampler, attrs);
+    producer.setSeasonality(&config.seasonality);
+    auto append = [&producer, &sink](const EventRecord* records, size_t n) {
+        const uint64_t mark = producer.profile().start();
+        sink.appendBatch(records, n);
+        producer.profile().lapBatch(Stage::SINK, mark, n);
+    };
+    if (config.checkpoint_interval > 0)
+        file_sink.setCheckpointSource([&producer](BookCheckpoint& cp) { producer.captureCheckpoint(cp); });
+
+    if (resume_from)
+        producer.resumeSession(session, *resume_from);
+    else
+        producer.startSession(session);
+
+    if ((!config.realtime || config.speed <= 0.0) && !metrics.events) {
+        EventRecord batch[Producer::kBatchSize];
+        size_t n;
+        while (!g_shutdown_requested.load(std::memory_order_relaxed)
+               && (n = producer.stepEvents(Producer::kBatchSize, batch)) > 0)
+        {
+            append(batch, n);
+        }
+        file_sink.setCheckpointSource(nullptr);  // the source refers to producer
+        mergeStageProfile(config, producer.profile());
+        return producer.eventsWrittenThisSession();
+    }
+    if (!config.realtime || config.speed <= 0.0) {
+        // Same loop with three clock reads per batch for the metrics.
+        EventRecord batch[Producer::kBatchSize];
+        while (!g_shutdown_requested.load(std::memory_order_relaxed)) {
+            const auto t0 = SecurityMetrics::Clock::now();
+            const size_t n = producer.stepEvents(Producer::kBatchSize, batch);
+            if (n == 0)
+                break;
+            const auto t1 = SecurityMetrics::Clock::now();
+            append(batch, n);
+            metrics.recordBatch(n, t0, t1, SecurityMetrics::Clock::now());
+        }
+        file_sink.setCheckpointSource(nullptr);
+        mergeStageProfile(config, producer.profile());
+        return producer.eventsWrittenThisSession();
+    }
+
+    Pacer pacer(pacingOptions(config));
+    pacer.start();
+    EventRecord batch[Producer::kBatchSize];
+    // batch[0] is the held event: generated, not yet due.
+    bool held = producer.stepEvents(1, batch) == 1;
+    double held_t = producer.currentTime();
+    // While an event is held the producer is one event past the sink, so a
+    // checkpoint takes the state from before that event.
+    BookCheckpoint before_held;
+    if (config.checkpoint_interval > 0) {
+        file_sink.setCheckpointSource([&](BookCheckpoint& cp) {
+            if (held)
+                cp = before_held;
+            else
+                producer.captureCheckpoint(cp);
+        });
+    }
+    while (held && !g_shutdown_requested.load(std::memory_order_relaxed)) {
+        pacer.waitUntil(held_t);
+        const auto horizon = pacer.horizon();
+        size_t n = 1;
+        held = false;
+        for (;;) {
+            if (config.checkpoint_interval > 0)
+                producer.captureCheckpoint(before_held);
+            if (producer.stepEvents(1, batch + n) != 1)
+                break;
+            const double t = producer.currentTime();
+            if (n + 1 < Producer::kBatchSize && pacer.dueBy(t, horizon)) {
+                ++n;
+                continue;
+            }
+            held = true;
+            held_t = t;
+            break;
+        }
+        if (metrics.events) {
+            const auto t1 = SecurityMetrics::Clock::now();
+            append(batch, n);
+            metrics.events->add(n);
+            metrics.append_ns->record(SecurityMetrics::ns(SecurityMetrics::Clock::now() - t1));
+        } else {
+            append(batch, n);
+        }
+        if (held)
+            batch[0] = batch[n];
+    }
+    if (pacing)
+        *pacing = pacer.stats();
+    file_sink.setCheckpointSource(nullptr);
+    mergeStageProfile(config, producer.profile());
+    return producer.eventsWrittenThisSession();
+}
+
+static TradingSession makeSession(const RunConfig& config, const SecurityConfig& sec,
+                                  uint64_t seed, int32_t p0_ticks) {
+    TradingSession session{};
+    session.seed = seed;
+    session.p0_ticks = p0_ticks;
+    session.session_seconds = config.session_seconds;
+    session.levels_per_side = sec.levels_per_side;
+    session.tick_size = sec.tick_size;
+    session.initial_spread_ticks = sec.initial_spread_ticks;
+    session.initial_depth = sec.initial_depth;
+    session.market_open_seconds = config.market_open_seconds;
+    session.intensity_params = sec.intensity_params;
+    session.queue_reactive = sec.queue_reactive;
+    session.rng = config.rng;
+    return session;
+}
+
+/// The book seed the producer uses for session, with its defaults for zero depth and spread.
+static BookSeed bookSeed(const TradingSession& session) {
+    return BookSeed{session.p0_ticks, session.levels_per_side,
+                    session.initial_depth > 0 ? session.initial_depth : 50u,
+                    session.initial_spread_ticks > 0 ? session.initial_spread_ticks : 2u};
+}
+
+static BinaryFileSinkOptions fileSinkOptions(const RunConfig& config) {
+    BinaryFileSinkOptions options;
+    options.chunk_capacity = config.chunk_capacity > 0 ? config.chunk_capacity : kDefaultChunkCapacity;
+    options.write_buffers = config.write_buffers;
+    options.columnar = config.columnar;
+    options.codec = config.codec;
+    options.seek_stride = config.seek_stride;
+    options.checkpoint_interval = config.checkpoint_interval;
+    options.sync_interval = config.sync_interval;
+    options.resume = config.resume;
+    options.bar_seconds = config.bar_seconds;
+    options.io_uring = config.io_uring;
+    if (config.metrics) {
+        options.compress_ns = &config.metrics->histogram(
+            "qrsdp_chunk_compress_ns", "Encode and compress time of one chunk (ns)");
+    }
+    return options;
+}
+
+/// Day file path relative to output_dir.
+static std::string dayFilename(const std::string& symbol, const std::string& date_str) {
+    return symbol.empty() ? (date_str + ".qrsdp") : (symbol + "/" + date_str + ".qrsdp");
+}
+
+/// Arrow copy of a day file (RunConfig::arrow), or nullptr when off.
+static std::unique_ptr<ArrowFileSink> arrowSink(const RunConfig& config, const std::string& filepath,
+                                                const std::string& symbol, const std::string& date_str) {
+    if (!config.arrow) return nullptr;
+    return std::make_unique<ArrowFileSink>(
+        std::filesystem::path(filepath).replace_extension(".arrow").string(), symbol, date_str,
+        config.chunk_capacity > 0 ? config.chunk_capacity : kDefaultChunkCapacity);
+}
+
+/// Where finished days go besides their own files.
+struct DayOutputs {
+    SessionContainerWriter* container = nullptr;
+    RunCatalogWriter* catalog = nullptr;
+};
+
+/// Lists a finished day in the run's catalogue, then moves its file into the
+/// run's container (if any).
+static void finishDay(const DayOutputs& outputs, const RunConfig& config, const DayResult& d) {
+    const std::string path = (std::filesystem::path(config.output_dir) / d.filename).string();
+    if (outputs.catalog) {
+        CatalogDay day = catalogDay(EventLogReader(path), d.symbol, d.date, d.filename);
+        day.seed = d.seed;
+        day.open_ticks = d.open_ticks;
+        day.close_ticks = d.close_ticks;
+        day.file_bytes = d.file_size_bytes;
+        day.in_container = outputs.container != nullptr;
+        outputs.catalog->add(day);
+    }
+    if (!outputs.container) return;
+    outputs.container->addSession(d.symbol, d.date, path);
+    std::filesystem::remove(path);
+}
+
+/// Re-opens a finished day and checks it holds every event written, as deep as
+/// mode asks (by default the chunk checksums, with nothing decompressed).
+/// Returns the seconds it took.
+static double readBack(const std::string& filepath, uint64_t events_written, VerifyMode mode) {
+    auto r0 = std::chrono::steady_clock::now();
+    {
+        EventLogReader reader(filepath);
+        if (reader.verify(mode) != events_written) {
+            throw std::runtime_error("read-back count mismatch");
+        }
+    }
+    auto r1 = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(r1 - r0).count();
+}
+
+/// True if path is a day file whose footer was written (a finished day).
+static bool isCompleteLog(const std::string& path) {
+    std::FILE* f = std::fopen(path.c_str(), "rb");
+    if (!f) return false;
+    FileHeader hdr{};
+    const bool read = std::fread(&hdr, sizeof(hdr), 1, f) == 1;
+    std::fclose(f);
+    return read && validateMagic(hdr) && (hdr.header_flags & kHeaderFlagHasIndex);
+}
+
+/// Closing mid of a finished day file: its last checkpoint (or the opening book)
+/// with the records after it replayed.
+static int32_t replayCloseTicks(const EventLogReader& reader) {
+    const BookCheckpoint* cp = reader.checkpoints().empty() ? nullptr : &reader.checkpoints().back();
+    BookReplayer replayer(reader.header(), cp);
+    reader.forEachRecordFrom(cp ? cp->record_index : 0,
+                             [&replayer](const DiskEventRecord& rec) { replayer.apply(rec); });
+    const MultiLevelBook& book = replayer.book();
+    return (book.bestBid().price_ticks + book.bestAsk().price_ticks) / 2;
+}
+
+const CurveBundleSymbol* SessionRunner::hlrBundleEntry(const RunConfig& config,
+                                                       const SecurityConfig& sec) {
+    if (!config.hlr_bundle) return nullptr;
+    const CurveBundleSymbol* entry = config.hlr_bundle->find(sec.symbol);
+    if (!entry && sec.symbol.empty() && config.hlr_bundle->size() == 1)
+        entry = &config.hlr_bundle->symbols()[0];
+    return entry;
+}
+
+/// Curves of an HLR security without its own: its bundle entry, else
+/// hlr_params, else the defaults for its depth. With a cache, securities that end
+/// up on hlr_params or the same defaults share one instance.
+struct SharedCurvesCache {
+    std::shared_ptr<const HLRModelCurves> params;
+    std::map<uint32_t, std::shared_ptr<const HLRModelCurves>> defaults;  // by levels_per_side
+};
+
+static std::shared_ptr<const HLRModelCurves> hlrCurvesFor(const RunConfig& config,
+                                                          const SecurityConfig& sec,
+                                                          SharedCurvesCache* cache) {
+    if (const CurveBundleSymbol* entry = SessionRunner::hlrBundleEntry(config, sec)) {
+        return std::make_shared<const HLRModelCurves>(config.hlr_bundle->table(*entry),
+                                                      entry->spread_sensitivity,
+                                                      entry->imbalance_sensitivity);
+    }
+    SharedCurvesCache local;
+    SharedCurvesCache& c = cache ? *cache : local;
+    if (config.hlr_params.hasCurves()) {
+        if (!c.params) c.params = std::make_shared<const HLRModelCurves>(config.hlr_params);
+        return c.params;
+    }
+    std::shared_ptr<const HLRModelCurves>& d = c.defaults[sec.levels_per_side];
+    if (!d) {
+        d = std::make_shared<const HLRModelCurves>(
+            makeDefaultHLRParams(static_cast<int>(sec.levels_per_side)));
+    }
+    return d;
+}
+
+/// Fills hlr_curves of every HLR security that has none, sharing instances.
+static void resolveHLRCurves(const RunConfig& config, std::vector<SecurityConfig>& secs) {
+    SharedCurvesCache cache;
+    for (SecurityConfig& sec : secs) {
+        if (sec.model_type == ModelType::HLR && !sec.hlr_curves)
+            sec.hlr_curves = hlrCurvesFor(config, sec, &cache);
+    }
+}
+
+static std::unique_ptr<CurveIntensityModel> makeCurveModel(const RunConfig& config,
+                                                           const SecurityConfig& sec) {
+    auto model = std::make_unique<CurveIntensityModel>(
+        sec.hlr_curves ? *sec.hlr_curves : *hlrCurvesFor(config, sec, nullptr));
+    model->followParams(config.hlr_updates);
+    // LINEAR reproduces earlier streams only with totals exactly as compute() adds them.
+    model->setTotalsMode(config.selection_mode == SelectionMode::LINEAR
+                             ? CurveIntensityModel::TotalsMode::EXACT
+                             : CurveIntensityModel::TotalsMode::RUNNING);
+    return model;
+}
+
+static std::unique_ptr<HawkesIntensityModel> makeHawkesModel(const RunConfig& config,
+                                                             const SecurityConfig& sec) {
+    if (config.hawkes.baseline == HawkesBaseline::MU)
+        return std::make_unique<HawkesIntensityModel>(config.hawkes);
+    return std::make_unique<HawkesIntensityModel>(
+        config.hawkes, std::make_shared<const SimpleImbalanceIntensity>(sec.intensity_params));
+}
+
+template <class Rng, class Book>
+static DayResult runDayWith(
     const RunConfig& config,
-    const std::string& symbol,
+    const SecurityConfig& sec,
+    uint32_t security_index,
+    uint32_t day_index,
+    const Date& date,
     int32_t  p0_ticks,
-    uint32_t tick_size,
-    uint32_t levels_per_side,
-    uint32_t initial_spread_ticks,
-    uint32_t initial_depth,
-    const IntensityParams& intensity_params,
-    const QueueReactiveParams& queue_reactive,
-    ModelType model_type,
-    uint64_t seed_offset)
+    itch::ItchUdpSink* live_sink,
+    FrameRingWriter* frame_ring,
+    ShmEventBus* event_bus)
 {
     namespace fs = std::filesystem;
 
-    const std::string sub_dir = symbol.empty()
-        ? config.output_dir
-        : (fs::path(config.output_dir) / symbol).string();
-    fs::create_directories(sub_dir);
-
-    const uint64_t base = config.base_seed + seed_offset;
-    Mt19937Rng rng(base);
-    MultiLevelBook book;
-
-    std::unique_ptr<IIntensityModel> model_ptr;
-    if (model_type == ModelType::HLR) {
-        HLRParams hlr = config.hlr_params.hasCurves()
-            ? config.hlr_params
-            : makeDefaultHLRParams(static_cast<int>(levels_per_side));
-        model_ptr = std::make_unique<CurveIntensityModel>(std::move(hlr));
+    const std::string& symbol = sec.symbol;
+    const uint64_t day_seed = SessionRunner::daySeed(config, security_index, day_index);
+
+    // Fresh per-day state: every collaborator is reset by startSession() anyway, so
+    // a day's output depends only on (seed, p0) and days can run on any thread.
+    Rng rng(day_seed);
+    Book book;
+
+    std::unique_ptr<CurveIntensityModel> curve_model;
+    std::unique_ptr<HawkesIntensityModel> hawkes_model;
+    std::unique_ptr<SimpleImbalanceIntensity> simple_model;
+    if (sec.model_type == ModelType::HLR) {
+        curve_model = makeCurveModel(config, sec);
+    } else if (sec.model_type == ModelType::HAWKES) {
+        hawkes_model = makeHawkesModel(config, sec);
     } else {
-        model_ptr = std::make_unique<SimpleImbalanceIntensity>(intensity_params);
+        simple_model = std::make_unique<SimpleImbalanceIntensity>(sec.intensity_params);
     }
 
-    CompetingIntensitySampler sampler(rng);
+    CompetingIntensitySampler sampler(rng, config.selection_mode);
     UnitSizeAttributeSampler attrs(rng, 0.5, 0.5);
-    QrsdpProducer producer(rng, book, *model_ptr, sampler, attrs);
 
-    const uint32_t chunk_cap = config.chunk_capacity > 0
-        ? config.chunk_capacity : kDefaultChunkCapacity;
+    const std::string date_str = formatDate(date);
+    const std::string filename = dayFilename(symbol, date_str);
+    const std::string filepath = (fs::path(config.output_dir) / filename).string();
+
+    DayResult dr{};
+    dr.symbol = symbol;
+    dr.date = date_str;
+    dr.filename = filename;
+    dr.seed = day_seed;
+    dr.open_ticks = p0_ticks;
+
+    // --resume: a day the interrupted run finished is kept as it is.
+    if (config.resume && isCompleteLog(filepath)) {
+        EventLogReader reader(filepath);
+        dr.close_ticks = replayCloseTicks(reader);
+        dr.events_written = reader.totalRecords();
+        dr.chunks_written = reader.chunkCount();
+        dr.file_size_bytes = static_cast<uint64_t>(fs::file_size(filepath));
+        return dr;
+    }
 
-    std::vector<DayResult> days;
-    Date current_date = parseDate(config.start_date);
-    int32_t next_p0 = p0_ticks;
+    const TradingSession session = makeSession(config, sec, day_seed, p0_ticks);
 
-    const bool infinite = (config.num_days == 0);
+    // The file writer, Kafka queue and librdkafka threads start on the I/O CPUs.
+    auto io_threads = std::make_unique<IoThreadScope>(config.placement);
+    BinaryFileSink file_sink(filepath, session, fileSinkOptions(config));
+    const SinkResumePoint* resume = file_sink.resumePoint();
+    if (resume) {
+        std::printf("[%s] %s resuming after %llu events\n", symbol.c_str(), date_str.c_str(),
+                    (unsigned long long)resume->records);
+    }
+    const BookCheckpoint* resume_from = resume ? &resume->checkpoint : nullptr;
+
+    PacingStats pacing;
+    const SecurityMetrics metrics = securityMetrics(config, symbol);
+    auto generate = [&](auto& sink, BinaryFileSink& file) -> uint64_t {
+        if (curve_model)
+            return generateSession(rng, book, *curve_model, sampler, attrs, sink, session, config,
+                                   file, resume_from, &pacing, metrics);
+        if (hawkes_model)
+            return generateSession(rng, book, *hawkes_model, sampler, attrs, sink, session, config,
+                                   file, resume_from, &pacing, metrics);
+        return generateSession(rng, book, *simple_model, sampler, attrs, sink, session, config, file,
+                               resume_from, &pacing, metrics);
+    };
+
+    MultiplexSink mux_sink;
+    mux_sink.addSink(&file_sink);
+    const std::unique_ptr<ArrowFileSink> arrow_sink = arrowSink(config, filepath, symbol, date_str);
+    if (arrow_sink)
+        mux_sink.addSink(arrow_sink.get());
+#ifdef QRSDP_KAFKA_ENABLED
+    std::unique_ptr<KafkaSink> kafka_sink;
+    const AsyncSink* kafka_async = nullptr;
+    if (!config.kafka_brokers.empty()) {
+        kafka_sink = std::make_unique<KafkaSink>(
+            config.kafka_brokers, config.kafka_topic, symbol, kafkaOptions(config));
+        kafka_sink->setSymbol(symbol, kafkaPartitionFor(security_index, config.kafka.partitions));
+        if (config.kafka_async)
+            kafka_async = &mux_sink.addAsyncSink(kafka_sink.get(), config.kafka_queue);
+        else
+            mux_sink.addSink(kafka_sink.get());
+    }
+#endif
+    io_threads.reset();
+    if (live_sink) {
+        mux_sink.addSink(live_sink);
+        live_sink->setSnapshotSource([&book](BookCheckpoint& cp) { captureLevels(book, cp); });
+        if (config.order_book) live_sink->startOrderBook(bookSeed(session));
+    }
+    std::unique_ptr<ShmRingSink> bus_sink;
+    if (event_bus) {
+        bus_sink = std::make_unique<ShmRingSink>(*event_bus, static_cast<uint16_t>(security_index),
+                                                 symbol, date_str);
+        mux_sink.addSink(bus_sink.get());
+    }
+    std::unique_ptr<BookFrameSink> frame_sink;
+    if (frame_ring) {
+        LiveDayStart start{};
+        start.day_index = day_index;
+        start.num_days = config.num_days;
+        start.market_open_ns = static_cast<uint64_t>(session.market_open_seconds) * 1'000'000'000ULL;
+        start.open_ticks = p0_ticks;
+        start.tick_size = session.tick_size;
+        std::snprintf(start.date, sizeof(start.date), "%s", date_str.c_str());
+        std::snprintf(start.symbol, sizeof(start.symbol), "%s", symbol.c_str());
+        frame_ring->publish(kRingDayStart, &start, sizeof(start), true);
+
+        BookFrameOptions frame_options;
+        frame_options.frame_interval_ns = config.live_frames.frame_interval_ns;
+        frame_options.recent_events = config.live_frames.recent_events;
+        frame_sink = std::make_unique<BookFrameSink>(
+            file_sink.fileHeaderFor(session), frame_options,
+            [frame_ring](const char* frame, size_t size) {
+                frame_ring->publish(kRingBookFrame, frame, size);
+            });
+        mux_sink.addSink(frame_sink.get());
+    }
 
-    for (uint32_t day_idx = 0;
-         infinite || day_idx < config.num_days;
-         ++day_idx)
-    {
-        if (g_shutdown_requested.load(std::memory_order_relaxed)) break;
+    const bool use_mux = mux_sink.sinkCount() > 1;
+    IEventSink& sink = use_mux
+        ? static_cast<IEventSink&>(mux_sink)
+        : static_cast<IEventSink&>(file_sink);
+
+    if (config.realtime) {
+        std::printf("[%s] %s session starting (speed=%.0fx)\n",
+                    symbol.c_str(), date_str.c_str(), config.speed);
+        if (config.pace_cpu >= 0 && !pinCurrentThread(config.pace_cpu + static_cast<int>(security_index)))
+            std::fprintf(stderr, "[%s] could not pin to CPU %d\n", symbol.c_str(),
+                         config.pace_cpu + static_cast<int>(security_index));
+    }
 
-        const uint64_t day_seed = base + day_idx;
-        const std::string date_str = formatDate(current_date);
-        const std::string filename = symbol.empty()
-            ? (date_str + ".qrsdp")
-            : (symbol + "/" + date_str + ".qrsdp");
-        const std::string filepath = (fs::path(config.output_dir) / filename).string();
-
-        TradingSession session{};
-        session.seed = day_seed;
-        session.p0_ticks = next_p0;
-        session.session_seconds = config.session_seconds;
-        session.levels_per_side = levels_per_side;
-        session.tick_size = tick_size;
-        session.initial_spread_ticks = initial_spread_ticks;
-        session.initial_depth = initial_depth;
-        session.market_open_seconds = config.market_open_seconds;
-        session.intensity_params = intensity_params;
-        session.queue_reactive = queue_reactive;
-
-        BinaryFileSink file_sink(filepath, session, chunk_cap);
+    auto t0 = std::chrono::steady_clock::now();
 
-#ifdef QRSDP_KAFKA_ENABLED
-        std::unique_ptr<KafkaSink> kafka_sink;
-        MultiplexSink mux_sink;
-        mux_sink.addSink(&file_sink);
+    const uint64_t events_written = use_mux
+        ? generate(mux_sink, file_sink)
+        : generate(file_sink, file_sink);
 
-        if (!config.kafka_brokers.empty()) {
-            kafka_sink = std::make_unique<KafkaSink>(
-                config.kafka_brokers, config.kafka_topic, symbol);
-            mux_sink.addSink(kafka_sink.get());
-        }
+    const int32_t close_ticks =
+        (book.bestBid().price_ticks + book.bestAsk().price_ticks) / 2;
 
-        IEventSink& sink = config.kafka_brokers.empty()
-            ? static_cast<IEventSink&>(file_sink)
-            : static_cast<IEventSink&>(mux_sink);
-#else
-        IEventSink& sink = file_sink;
+    auto t1 = std::chrono::steady_clock::now();
+    if (live_sink)
+        live_sink->setSnapshotSource(nullptr);  // the source refers to book
+    sink.close();
+    if (metrics.flush_ns)
+        metrics.flush_ns->record(SecurityMetrics::ns(std::chrono::steady_clock::now() - t1));
+#ifdef QRSDP_KAFKA_ENABLED
+    if (kafka_async && kafka_async->stats().dropped > 0) {
+        const AsyncSinkStats st = kafka_async->stats();
+        std::printf("[%s] %s kafka queue dropped %llu of %llu events (max lag %llu)\n",
+                    symbol.c_str(), date_str.c_str(), (unsigned long long)st.dropped,
+                    (unsigned long long)(st.appended + st.dropped), (unsigned long long)st.max_lag);
+    }
 #endif
 
-        if (config.realtime) {
-            std::printf("[%s] %s session starting (speed=%.0fx)\n",
-                        symbol.c_str(), date_str.c_str(), config.speed);
-        }
+    if (frame_ring) {
+        LiveDayEnd end{};
+        end.day_index = day_index;
+        end.close_ticks = close_ticks;
+        end.events = events_written;
+        frame_ring->publish(kRingDayEnd, &end, sizeof(end));
+    }
 
-        auto t0 = std::chrono::steady_clock::now();
+    const double write_secs = std::chrono::duration<double>(t1 - t0).count();
+    const uint64_t file_size = static_cast<uint64_t>(fs::file_size(filepath));
 
-        producer.startSession(session);
-        auto wall_start = std::chrono::steady_clock::now();
+    const double read_secs = config.realtime ? 0.0 : readBack(filepath, events_written, config.verify);
 
-        while (!g_shutdown_requested.load(std::memory_order_relaxed)
-               && producer.stepOneEvent(sink))
-        {
-            if (config.realtime && config.speed > 0.0) {
-                double sim_elapsed = producer.currentTime();
-                double wall_target = sim_elapsed / config.speed;
-                auto wall_elapsed = std::chrono::steady_clock::now() - wall_start;
-                double wall_secs = std::chrono::duration<double>(wall_elapsed).count();
-                if (wall_target > wall_secs) {
-                    std::this_thread::sleep_for(
-                        std::chrono::duration<double>(wall_target - wall_secs));
-                }
-            }
+    dr.close_ticks = close_ticks;
+    dr.events_written = events_written;
+    dr.chunks_written = file_sink.chunksWritten();
+    dr.file_size_bytes = file_size;
+    dr.write_seconds = write_secs;
+    dr.read_seconds = read_secs;
+    dr.compress_seconds = file_sink.compressSeconds();
+
+    if (config.realtime) {
+        std::printf("[%s] %s complete: %llu events in %.1fs (late mean %.1fus max %.1fus)\n",
+                    symbol.c_str(), date_str.c_str(),
+                    (unsigned long long)events_written, write_secs,
+                    pacing.meanLatenessUs(), static_cast<double>(pacing.lateness_ns_max) / 1e3);
+    }
+    return dr;
+}
+
+template <class B> struct BookTag { using type = B; };
+
+/// Calls f(BookTag<Book>{}) with OrderLevelBook when config.order_book is set;
+/// otherwise the compile-time-depth book for the common depths (5, 10, 20) and
+/// the runtime-depth MultiLevelBook for anything else.
+template <class F>
+static decltype(auto) withBook(const RunConfig& config, uint32_t levels_per_side, F&& f) {
+    if (config.order_book) return f(BookTag<OrderLevelBook>{});
+    switch (levels_per_side) {
+        case 5:  return f(BookTag<MultiLevelBookN<5>>{});
+        case 10: return f(BookTag<MultiLevelBookN<10>>{});
+        case 20: return f(BookTag<MultiLevelBookN<20>>{});
+        default: break;
+    }
+    return f(BookTag<MultiLevelBook>{});
+}
+
+template <class Rng>
+static DayResult runDayWithRng(const RunConfig& config, const SecurityConfig& sec,
+                               uint32_t security_index, uint32_t day_index,
+                               const Date& date, int32_t p0_ticks, itch::ItchUdpSink* live_sink,
+                               FrameRingWriter* frame_ring, ShmEventBus* event_bus) {
+    return withBook(config, sec.levels_per_side, [&](auto tag) {
+        using Book = typename decltype(tag)::type;
+        return runDayWith<Rng, Book>(config, sec, security_index, day_index, date, p0_ticks,
+                                     live_sink, frame_ring, event_bus);
+    });
+}
+
+/// Picks the concrete generator for config.rng and the book for the security's
+/// depth, so the producer's RNG and book calls are static too.
+template <class... Args>
+static DayResult runDay(const RunConfig& config, Args&&... args) {
+    switch (config.rng) {
+        case RngAlgorithm::XOSHIRO256PP:
+            return runDayWithRng<Xoshiro256ppRng>(config, std::forward<Args>(args)...);
+        case RngAlgorithm::PHILOX4X32:
+            return runDayWithRng<PhiloxRng>(config, std::forward<Args>(args)...);
+        case RngAlgorithm::MT19937:
+            break;
+    }
+    return runDayWithRng<Mt19937Rng>(config, std::forward<Args>(args)...);
+}
+
+// ---------------------------------------------------------------------------
+// Interleaving workers (RunConfig::workers)
+// ---------------------------------------------------------------------------
+
+/// One security's generator inside an interleaving worker. Collaborators persist
+/// across days (startSession() resets them); only the day's file sink is per day.
+/// The lane is the only virtual boundary: one call per batch, inside which the
+/// producer steps events over its concrete RNG, book and model.
+class Lane {
+public:
+    virtual ~Lane() = default;
+    virtual void startSession(const TradingSession& session) = 0;
+    /// Steps up to max events into out; now receives the lane's clock after them.
+    virtual size_t stepEvents(size_t max, EventRecord* out, double& now) = 0;
+    virtual double currentTime() const = 0;
+    virtual int32_t midTicks() const = 0;
+    /// Producer state for a BinaryFileSink checkpoint.
+    virtual void captureCheckpoint(BookCheckpoint& cp) const = 0;
+    /// Moves the producer's stage profile into the run totals.
+    virtual void mergeProfile(const RunConfig& config) = 0;
+};
+
+template <class Rng, class Book, class Model>
+class LaneImpl final : public Lane {
+public:
+    LaneImpl(std::unique_ptr<Model> model, SelectionMode mode, const SeasonalityProfile& seasonality)
+        : rng_(0), model_(std::move(model)), sampler_(rng_, mode), attrs_(rng_, 0.5, 0.5),
+          producer_(rng_, book_, *model_, sampler_, attrs_) {
+        producer_.setSeasonality(&seasonality);
+    }
+
+    void startSession(const TradingSession& session) override { producer_.startSession(session); }
+    size_t stepEvents(size_t max, EventRecord* out, double& now) override {
+        const size_t n = producer_.stepEvents(max, out);
+        now = producer_.currentTime();
+        return n;
+    }
+    double currentTime() const override { return producer_.currentTime(); }
+    int32_t midTicks() const override {
+        return (book_.bestBid().price_ticks + book_.bestAsk().price_ticks) / 2;
+    }
+    void captureCheckpoint(BookCheckpoint& cp) const override { producer_.captureCheckpoint(cp); }
+    void mergeProfile(const RunConfig& config) override {
+        mergeStageProfile(config, producer_.profile());
+        if constexpr (RunStageProfile::kEnabled)
+            producer_.profile().reset();
+    }
+
+private:
+    Rng rng_;
+    Book book_;
+    std::unique_ptr<Model> model_;
+    CompetingIntensitySampler sampler_;
+    UnitSizeAttributeSampler attrs_;
+    BasicQrsdpProducer<Rng, Book, Model, CompetingIntensitySampler,
+                       UnitSizeAttributeSampler, IEventSink, RunStageProfile> producer_;
+};
+
+template <class Rng>
+static std::unique_ptr<Lane> makeLaneWith(const RunConfig& config, const SecurityConfig& sec) {
+    return withBook(config, sec.levels_per_side, [&](auto tag) -> std::unique_ptr<Lane> {
+        using Book = typename decltype(tag)::type;
+        if (sec.model_type == ModelType::HLR) {
+            return std::make_unique<LaneImpl<Rng, Book, CurveIntensityModel>>(
+                makeCurveModel(config, sec), config.selection_mode, config.seasonality);
+        }
+        if (sec.model_type == ModelType::HAWKES) {
+            return std::make_unique<LaneImpl<Rng, Book, HawkesIntensityModel>>(
+                makeHawkesModel(config, sec), config.selection_mode, config.seasonality);
         }
+        return std::make_unique<LaneImpl<Rng, Book, SimpleImbalanceIntensity>>(
+            std::make_unique<SimpleImbalanceIntensity>(sec.intensity_params),
+            config.selection_mode, config.seasonality);
+    });
+}
 
-        const int32_t close_ticks =
-            (book.bestBid().price_ticks + book.bestAsk().price_ticks) / 2;
-        const uint64_t events_written = producer.eventsWrittenThisSession();
+static std::unique_ptr<Lane> makeLane(const RunConfig& config, const SecurityConfig& sec) {
+    switch (config.rng) {
+        case RngAlgorithm::XOSHIRO256PP: return makeLaneWith<Xoshiro256ppRng>(config, sec);
+        case RngAlgorithm::PHILOX4X32:   return makeLaneWith<PhiloxRng>(config, sec);
+        case RngAlgorithm::MT19937:      break;
+    }
+    return makeLaneWith<Mt19937Rng>(config, sec);
+}
 
-        auto t1 = std::chrono::steady_clock::now();
-        sink.close();
+/// Wall-clock origin of each realtime day, shared by the workers of a run so
+/// their pacers run off one clock: the first worker to start a day fixes its
+/// origin and the rest pace against it rather than their own start time.
+class DayOrigins {
+public:
+    Pacer::Clock::time_point origin(uint32_t day) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!started_ || day > day_) {
+            started_ = true;
+            day_ = day;
+            origin_ = Pacer::Clock::now();
+        }
+        return day == day_ ? origin_ : Pacer::Clock::now();  // a worker a whole day behind
+    }
+
+private:
+    std::mutex mutex_;
+    bool started_ = false;
+    uint32_t day_ = 0;
+    Pacer::Clock::time_point origin_;
+};
+
+struct LaneSlot {
+    size_t security_index;
+    std::unique_ptr<Lane> lane;
+    std::unique_ptr<BinaryFileSink> file;  // open only while its day is generating
+    std::unique_ptr<ShmRingSink> bus;      // event bus output of that day, if any
+    std::unique_ptr<ArrowFileSink> arrow;  // Arrow copy of that day, if any
+    std::vector<int32_t> opens;            // independent_days only
+    int32_t next_open;
+    DayResult day;
+    double busy_seconds;
+    bool done;
+    SecurityMetrics metrics;
+};
+
+/// Generates the given securities day by day on the calling thread, always
+/// stepping the lane whose simulated clock is furthest behind, so the
+/// securities advance together. Kafka output goes through one producer; live
+/// ITCH through live_sinks (one per security, empty when off), the event bus
+/// through event_bus when set. In realtime
+/// mode one Pacer per day releases the group's events in timestamp order,
+/// starting from origins' shared origin when given.
+static void runLaneGroup(const RunConfig& config, const std::vector<SecurityConfig>& secs,
+                         const std::vector<size_t>& group,
+                         std::vector<std::vector<DayResult>>& per_sec_results,
+                         const DayOutputs& outputs,
+                         const std::vector<itch::ItchUdpSink*>& live_sinks,
+                         ShmEventBus* event_bus,
+                         DayOrigins* origins
+#ifdef QRSDP_KAFKA_ENABLED
+                         , KafkaSink* kafka
+#endif
+                         )
+{
+    namespace fs = std::filesystem;
+    constexpr size_t kLaneBatch = 256;
 
-        const double write_secs = std::chrono::duration<double>(t1 - t0).count();
-        const uint64_t file_size = static_cast<uint64_t>(fs::file_size(filepath));
+    const bool infinite = (config.num_days == 0);
+    const bool independent = independentDays(config);
+    const bool paced = config.realtime && config.speed > 0.0;
+    const BinaryFileSinkOptions sink_options = fileSinkOptions(config);
+
+    std::vector<LaneSlot> slots(group.size());
+    for (size_t i = 0; i < group.size(); ++i) {
+        const size_t si = group[i];
+        slots[i].security_index = si;
+        slots[i].lane = makeLane(config, secs[si]);
+        slots[i].next_open = secs[si].p0_ticks;
+        slots[i].metrics = securityMetrics(config, secs[si].symbol);
+        if (!live_sinks.empty()) {
+            const Lane* lane = slots[i].lane.get();
+            live_sinks[si]->setSnapshotSource([lane](BookCheckpoint& cp) { lane->captureCheckpoint(cp); });
+        }
+        if (independent) {
+            slots[i].opens = SessionRunner::overnightOpens(
+                config, static_cast<uint32_t>(si), secs[si].p0_ticks, config.num_days);
+        }
+    }
+
+    std::vector<EventRecord> batch(paced ? 0 : kLaneBatch);
+    RunStageProfile sink_profile;  // the lanes step without a sink; emit() is timed here
+    Date date = parseDate(config.start_date);
+    if (paced && config.pace_cpu >= 0 && !group.empty()
+        && !pinCurrentThread(config.pace_cpu + static_cast<int>(group.front())))
+        std::fprintf(stderr, "could not pin worker to CPU %d\n",
+                     config.pace_cpu + static_cast<int>(group.front()));
+
+    for (uint32_t day = 0; infinite || day < config.num_days; ++day) {
+        if (g_shutdown_requested.load(std::memory_order_relaxed)) break;
 
-        double read_secs = 0.0;
-        if (!config.realtime) {
-            auto r0 = std::chrono::steady_clock::now();
+        const std::string date_str = formatDate(date);
+        for (auto& s : slots) {
+            const SecurityConfig& sec = secs[s.security_index];
+            const uint32_t si = static_cast<uint32_t>(s.security_index);
+            const int32_t open = independent ? s.opens[day] : s.next_open;
+            const TradingSession session =
+                makeSession(config, sec, SessionRunner::daySeed(config, si, day), open);
+
+            s.day = DayResult{};
+            s.day.symbol = sec.symbol;
+            s.day.date = date_str;
+            s.day.filename = dayFilename(sec.symbol, date_str);
+            s.day.seed = session.seed;
+            s.day.open_ticks = open;
             {
-                EventLogReader reader(filepath);
-                auto records = reader.readAll();
-                if (records.size() != events_written) {
-                    throw std::runtime_error("read-back count mismatch");
-                }
+                const IoThreadScope io_threads(config.placement);
+                s.file = std::make_unique<BinaryFileSink>(
+                    (fs::path(config.output_dir) / s.day.filename).string(), session, sink_options);
+            }
+            if (config.checkpoint_interval > 0) {
+                const Lane* lane = s.lane.get();
+                s.file->setCheckpointSource([lane](BookCheckpoint& cp) { lane->captureCheckpoint(cp); });
+            }
+            if (event_bus)
+                s.bus = std::make_unique<ShmRingSink>(*event_bus, static_cast<uint16_t>(si),
+                                                      sec.symbol, date_str);
+            s.arrow = arrowSink(config, (fs::path(config.output_dir) / s.day.filename).string(),
+                                sec.symbol, date_str);
+            s.lane->startSession(session);
+            if (config.order_book && !live_sinks.empty())
+                live_sinks[si]->startOrderBook(bookSeed(session));
+            s.busy_seconds = 0.0;
+            s.done = false;
+            if (config.realtime) {
+                std::printf("[%s] %s session starting (speed=%.0fx)\n",
+                            sec.symbol.c_str(), date_str.c_str(), config.speed);
             }
-            auto r1 = std::chrono::steady_clock::now();
-            read_secs = std::chrono::duration<double>(r1 - r0).count();
         }
 
-        DayResult dr{};
-        dr.symbol = symbol;
-        dr.date = date_str;
-        dr.filename = filename;
-        dr.seed = day_seed;
-        dr.open_ticks = next_p0;
-        dr.close_ticks = close_ticks;
-        dr.events_written = events_written;
-        dr.chunks_written = file_sink.chunksWritten();
-        dr.file_size_bytes = file_size;
-        dr.write_seconds = write_secs;
-        dr.read_seconds = read_secs;
-
-        days.push_back(dr);
-
-        if (config.realtime) {
-            std::printf("[%s] %s complete: %llu events in %.1fs\n",
-                        symbol.c_str(), date_str.c_str(),
-                        (unsigned long long)events_written, write_secs);
+        auto emit = [&](LaneSlot& s, const EventRecord* records, size_t n) {
+            const uint64_t mark = sink_profile.start();
+            s.file->appendBatch(records, n);
+#ifdef QRSDP_KAFKA_ENABLED
+            if (kafka) {
+                kafka->setSymbol(secs[s.security_index].symbol,
+                                 kafkaPartitionFor(s.security_index, config.kafka.partitions));
+                kafka->appendBatch(records, n);
+            }
+#endif
+            if (!live_sinks.empty())
+                live_sinks[s.security_index]->appendBatch(records, n);
+            if (s.bus) s.bus->appendBatch(records, n);
+            if (s.arrow) s.arrow->appendBatch(records, n);
+            sink_profile.lapBatch(Stage::SINK, mark, n);
+            s.day.events_written += n;
+        };
+
+        Pacer pacer(pacingOptions(config));
+        pacer.start(origins ? origins->origin(day) : Pacer::Clock::now());
+        if (paced) {
+            // Every lane holds its next event; one clock releases them across lanes in
+            // timestamp order (ties by lane), a window at a time, so the group costs one
+            // wakeup per window however many securities it has.
+            using Due = std::pair<double, size_t>;  // (simulated time, slot)
+            std::priority_queue<Due, std::vector<Due>, std::greater<Due>> due;
+            std::vector<EventRecord> held(slots.size());
+            auto hold = [&](size_t i) {
+                const auto t0 = std::chrono::steady_clock::now();
+                double now = 0.0;
+                if (slots[i].lane->stepEvents(1, &held[i], now) == 1)
+                    due.emplace(now, i);
+                else
+                    slots[i].done = true;
+                slots[i].busy_seconds +=
+                    std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+            };
+            for (size_t i = 0; i < slots.size(); ++i) hold(i);
+            while (!due.empty() && !g_shutdown_requested.load(std::memory_order_relaxed)) {
+                pacer.waitUntil(due.top().first);
+                const auto horizon = pacer.horizon();
+                do {
+                    const size_t i = due.top().second;
+                    due.pop();
+                    const auto t0 = std::chrono::steady_clock::now();
+                    emit(slots[i], &held[i], 1);
+                    const auto t1 = std::chrono::steady_clock::now();
+                    slots[i].busy_seconds += std::chrono::duration<double>(t1 - t0).count();
+                    if (slots[i].metrics.events) {
+                        slots[i].metrics.events->add(1);
+                        slots[i].metrics.append_ns->record(SecurityMetrics::ns(t1 - t0));
+                    }
+                    hold(i);
+                } while (!due.empty() && pacer.dueBy(due.top().first, horizon));
+            }
+        } else {
+            // Min-heap of (lane clock, slot): the furthest-behind lane steps next, the
+            // lowest slot on ties, in O(log lanes) per batch.
+            using Behind = std::pair<double, size_t>;
+            std::priority_queue<Behind, std::vector<Behind>, std::greater<Behind>> behind;
+            for (size_t i = 0; i < slots.size(); ++i) behind.emplace(slots[i].lane->currentTime(), i);
+            while (!behind.empty() && !g_shutdown_requested.load(std::memory_order_relaxed)) {
+                const size_t next_index = behind.top().second;
+                behind.pop();
+                LaneSlot* next = &slots[next_index];
+
+                const auto t0 = std::chrono::steady_clock::now();
+                double now = 0.0;
+                const size_t n = next->lane->stepEvents(kLaneBatch, batch.data(), now);
+                if (n > 0) {
+                    const auto t1 = next->metrics.events ? std::chrono::steady_clock::now() : t0;
+                    emit(*next, batch.data(), n);
+                    if (next->metrics.events)
+                        next->metrics.recordBatch(n, t0, t1, std::chrono::steady_clock::now());
+                }
+                next->busy_seconds +=
+                    std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+                if (n < kLaneBatch)
+                    next->done = true;
+                else
+                    behind.emplace(now, next_index);
+            }
+        }
+        if (paced) {
+            std::printf("%s pacing: %llu releases, late mean %.1fus max %.1fus\n", date_str.c_str(),
+                        (unsigned long long)pacer.stats().releases, pacer.stats().meanLatenessUs(),
+                        static_cast<double>(pacer.stats().lateness_ns_max) / 1e3);
         }
 
-        next_p0 = close_ticks;
-        current_date = nextBusinessDay(current_date);
+        for (auto& s : slots) {
+            const std::string filepath = (fs::path(config.output_dir) / s.day.filename).string();
+            const auto close_start = std::chrono::steady_clock::now();
+            s.file->close();
+            if (s.bus) {
+                s.bus->close();
+                s.bus.reset();
+            }
+            if (s.arrow) {
+                s.arrow->close();
+                s.arrow.reset();
+            }
+            if (s.metrics.flush_ns)
+                s.metrics.flush_ns->record(
+                    SecurityMetrics::ns(std::chrono::steady_clock::now() - close_start));
+            s.day.close_ticks = s.lane->midTicks();
+            s.day.chunks_written = s.file->chunksWritten();
+            s.day.compress_seconds = s.file->compressSeconds();
+            s.file.reset();
+            s.day.file_size_bytes = static_cast<uint64_t>(fs::file_size(filepath));
+            s.day.write_seconds = s.busy_seconds;
+            s.day.read_seconds = config.realtime ? 0.0 : readBack(filepath, s.day.events_written, config.verify);
+            s.next_open = s.day.close_ticks;
+            finishDay(outputs, config, s.day);
+            if (config.realtime) {
+                std::printf("[%s] %s complete: %llu events\n", s.day.symbol.c_str(),
+                            date_str.c_str(), (unsigned long long)s.day.events_written);
+            }
+            per_sec_results[s.security_index].push_back(std::move(s.day));
+        }
 
-        if (config.realtime && (infinite || day_idx + 1 < config.num_days)) {
-            std::printf("[%s] overnight pause (5s)...\n", symbol.c_str());
+        if (config.realtime && (infinite || day + 1 < config.num_days)) {
+            std::printf("overnight pause (5s)...\n");
             std::this_thread::sleep_for(std::chrono::seconds(5));
         }
+        date = nextBusinessDay(date);
+    }
+    for (auto& s : slots) {
+        s.lane->mergeProfile(config);
+        if (!live_sinks.empty())
+            live_sinks[s.security_index]->setSnapshotSource(nullptr);
     }
+    mergeStageProfile(config, sink_profile);
+}
 
-    return days;
+uint64_t SessionRunner::daySeed(const RunConfig& config, uint32_t security_index,
+                               uint32_t day_index) {
+    if (config.seed_scheme == SeedScheme::COUNTER)
+        return streamSeed(config.base_seed, security_index, day_index);
+    return config.base_seed + security_index * kSeedStride + day_index;
+}
+
+std::vector<int32_t> SessionRunner::overnightOpens(const RunConfig& config,
+                                                   uint32_t security_index,
+                                                   int32_t p0_ticks, uint32_t num_days) {
+    constexpr uint64_t kOvernightKey = 0x4F564E54ULL;  // "OVNT": keeps gaps off the day seeds
+    constexpr int32_t kMinOpenTicks = 2;
+    constexpr double kTwoPi = 6.283185307179586;
+
+    PhiloxRng rng(streamSeed(config.base_seed ^ kOvernightKey, security_index, 0));
+    std::vector<int32_t> opens;
+    opens.reserve(num_days);
+    int32_t p = p0_ticks;
+    for (uint32_t d = 0; d < num_days; ++d) {
+        if (d > 0 && config.overnight_sigma_ticks > 0.0) {
+            // Box–Muller; 1 - U keeps the log argument in (0, 1].
+            const double u1 = 1.0 - rng.uniform();
+            const double u2 = rng.uniform();
+            const double z = std::sqrt(-2.0 * std::log(u1)) * std::cos(kTwoPi * u2);
+            p += static_cast<int32_t>(std::lround(z * config.overnight_sigma_ticks));
+            if (p < kMinOpenTicks) p = kMinOpenTicks;
+        }
+        opens.push_back(p);
+    }
+    return opens;
 }
 
 // ---------------------------------------------------------------------------
@@ -449,59 +1379,298 @@ RunResult SessionRunner::run(const RunConfig& config) {
 
     auto run_start = std::chrono::steady_clock::now();
 
-    if (config.securities.empty()) {
-        // Single-security backward-compatible path
-        auto days = runSecurityDays(
-            config, "",
-            config.p0_ticks, config.tick_size, config.levels_per_side,
-            config.initial_spread_ticks, config.initial_depth,
-            config.intensity_params, config.queue_reactive,
-            config.model_type, 0);
-        for (auto& d : days) {
-            result.total_events += d.events_written;
-            result.days.push_back(std::move(d));
+    // Single-security mode is one unnamed security built from the top-level fields.
+    const bool multi = !config.securities.empty();
+    std::vector<SecurityConfig> secs = config.securities;
+    if (!multi) {
+        SecurityConfig single{};
+        single.p0_ticks = config.p0_ticks;
+        single.tick_size = config.tick_size;
+        single.levels_per_side = config.levels_per_side;
+        single.initial_spread_ticks = config.initial_spread_ticks;
+        single.initial_depth = config.initial_depth;
+        single.intensity_params = config.intensity_params;
+        single.queue_reactive = config.queue_reactive;
+        single.model_type = config.model_type;
+        secs.push_back(single);
+    }
+    for (const auto& sec : secs) {
+        if (!sec.symbol.empty()) fs::create_directories(fs::path(config.output_dir) / sec.symbol);
+    }
+    // Every day and worker of the HLR securities reads these: one table per distinct curve set.
+    resolveHLRCurves(config, secs);
+
+    const bool infinite = (config.num_days == 0);
+    const bool independent = independentDays(config);
+    const bool shard = !config.shard_name.empty() || config.first_day > 0 || config.first_security > 0;
+    if (shard && (infinite || config.realtime || config.workers > 0 || config.resume
+                  || !config.container.empty() || config.itch_live.enabled
+                  || config.live_frames.enabled() || config.shm_ring.enabled()))
+        throw std::invalid_argument("a shard runs a fixed number of days on the day scheduler "
+                                    "into day files: no realtime, workers, resume, container or live outputs");
+
+    if (!config.placement.cpus.empty() && config.pace_cpu >= 0)
+        throw std::invalid_argument("pace_cpu and placement.cpus both pin the pacing threads; use one");
+    if (std::any_of(secs.begin(), secs.end(),
+                    [](const SecurityConfig& sec) { return sec.model_type == ModelType::HAWKES; })) {
+        validateHawkesParams(config.hawkes);
+        if (!config.seasonality.empty())
+            throw std::invalid_argument("the Hawkes model takes no seasonality profile");
+    }
+    // An order-level live feed rebuilds the book's own orders from the records
+    // (itch::OrderBookAnnouncer), which hold neither reinitialised depths nor
+    // the book a resumed day restarts from.
+    if (config.order_book && config.itch_live.enabled) {
+        if (config.resume)
+            throw std::invalid_argument("an order-level live ITCH feed cannot be combined with resume");
+        if (std::any_of(secs.begin(), secs.end(),
+                        [](const SecurityConfig& sec) { return sec.queue_reactive.theta_reinit > 0.0; }))
+            throw std::invalid_argument("an order-level live ITCH feed takes no theta_reinit: "
+                                        "reinitialised depths are not in the records");
+    }
+
+    // Chains of dependent days never finish in continuous / real-time mode, so every
+    // security needs its own worker there or later securities would starve.
+    size_t threads = config.threads > 0 ? config.threads
+        : !config.placement.cpus.empty() ? config.placement.cpus.size()
+        : WorkStealingPool::defaultThreadCount();
+    if (infinite || config.realtime) threads = std::max(threads, secs.size());
+
+    std::vector<std::vector<DayResult>> per_sec_results(secs.size());
+    std::vector<std::exception_ptr> errors(secs.size());
+    std::mutex error_mutex;
+    Date start_date = parseDate(config.start_date);
+    for (uint32_t day = 0; day < config.first_day; ++day) start_date = nextBusinessDay(start_date);
+    std::vector<Date> dates;  // independent mode; outlives the pool's tasks
+    std::unique_ptr<SessionContainerWriter> container;
+    if (!config.container.empty()) {
+        container = std::make_unique<SessionContainerWriter>(
+            (fs::path(config.output_dir) / config.container).string());
+    }
+    // --resume keeps the interrupted run's entries; its kept days are not listed twice.
+    RunCatalogWriter catalog((fs::path(config.output_dir) / catalogName(config)).string(), config.resume);
+    const DayOutputs outputs{container.get(), &catalog};
+
+    // One live ITCH feed for the whole run, one queue per security.
+    std::unique_ptr<itch::ItchLiveFeed> live_feed;
+    std::vector<itch::ItchUdpSink*> live_sinks;
+    if (config.itch_live.enabled) {
+        itch::ItchLiveConfig live_config = config.itch_live;
+        if (config.metrics) {
+            live_config.packets_sent = &config.metrics->counter(
+                "qrsdp_itch_packets_sent_total", "MoldUDP64 packets sent by the live feed");
+            live_config.bytes_sent = &config.metrics->counter(
+                "qrsdp_itch_bytes_sent_total", "MoldUDP64 bytes sent by the live feed");
         }
-    } else {
-        // Multi-security: one thread per security
-        std::vector<std::thread> threads;
-        std::vector<std::vector<DayResult>> per_sec_results(config.securities.size());
-        std::vector<std::string> errors(config.securities.size());
+        live_feed = std::make_unique<itch::ItchLiveFeed>(live_config);
+        for (const auto& sec : secs)
+            live_sinks.push_back(&live_feed->addSecurity(sec.symbol.empty() ? "UNKNOWN" : sec.symbol,
+                                                         sec.tick_size));
+        const IoThreadScope io_threads(config.placement);
+        live_feed->start(static_cast<uint64_t>(config.market_open_seconds) * 1'000'000'000ULL);
+    }
 
-        for (size_t si = 0; si < config.securities.size(); ++si) {
-            threads.emplace_back([&, si]() {
+    // Realtime securities share one pacing clock: without workers they all run as
+    // one lane group on one thread. --resume and --kafka-async stay on the day
+    // scheduler, which paces every security on its own thread.
+    const bool shared_clock = config.realtime && secs.size() > 1 && !config.pace_per_security
+        && !config.resume && !config.kafka_async;
+
+    // Live book frames of the first security, one writer for the whole run.
+    std::unique_ptr<FrameRingWriter> frame_ring;
+    if (config.live_frames.enabled()) {
+        if (config.workers > 0 || shared_clock)
+            throw std::invalid_argument(
+                "live frames need the day scheduler: no workers, and pace_per_security "
+                "for several realtime securities");
+        if (config.resume)
+            throw std::invalid_argument("live frames cannot be combined with resume");
+        frame_ring = std::make_unique<FrameRingWriter>(config.live_frames.path,
+                                                       config.live_frames.ring_bytes);
+    }
+
+    // One event bus for the whole run; every security's sinks publish into it.
+    std::unique_ptr<ShmEventBus> event_bus;
+    if (config.shm_ring.enabled()) {
+        ShmRingConfig bus_config = config.shm_ring;
+        if (config.realtime) bus_config.batch_records = 1;  // each event as it is released
+        event_bus = std::make_unique<ShmEventBus>(bus_config);
+    }
+    if (config.workers > 0 || shared_clock) {
+        // Fixed workers; security si belongs to worker si % workers. A worker runs
+        // its securities in groups of at most files_per_worker so open day files stay
+        // capped; continuous and real-time runs need every security live, so one group.
+        const size_t num_workers = std::min<size_t>(std::max<uint32_t>(config.workers, 1),
+                                                    secs.size());
+        DayOrigins origins;
+        size_t files_per_worker = config.max_open_files > 0
+            ? std::max<size_t>(1, config.max_open_files / num_workers)
+            : secs.size();
+        if (infinite || config.realtime) files_per_worker = secs.size();
+
+        std::vector<std::exception_ptr> worker_errors(num_workers);
+        {
+            WorkStealingPool pool(num_workers, config.placement);
+            for (size_t w = 0; w < num_workers; ++w) {
+                pool.submit([&, w]() {
+                    try {
+#ifdef QRSDP_KAFKA_ENABLED
+                        std::unique_ptr<KafkaSink> kafka;
+                        if (!config.kafka_brokers.empty()) {
+                            const IoThreadScope io_threads(config.placement);
+                            kafka = std::make_unique<KafkaSink>(
+                                config.kafka_brokers, config.kafka_topic, "", kafkaOptions(config));
+                        }
+#endif
+                        std::vector<size_t> group;
+                        for (size_t si = w; si < secs.size(); si += num_workers) {
+                            group.push_back(si);
+                            if (group.size() == files_per_worker || si + num_workers >= secs.size()) {
+                                runLaneGroup(config, secs, group, per_sec_results, outputs,
+                                             live_sinks, event_bus.get(), config.realtime ? &origins : nullptr
+#ifdef QRSDP_KAFKA_ENABLED
+                                             , kafka.get()
+#endif
+                                             );
+                                group.clear();
+                            }
+                        }
+#ifdef QRSDP_KAFKA_ENABLED
+                        if (kafka) kafka->close();
+#endif
+                    } catch (...) {
+                        worker_errors[w] = std::current_exception();
+                    }
+                });
+            }
+            pool.wait();
+        }
+        for (size_t w = 0; w < num_workers; ++w) {
+            if (!worker_errors[w]) continue;
+            if (!multi) std::rethrow_exception(worker_errors[w]);
+            try {
+                std::rethrow_exception(worker_errors[w]);
+            } catch (const std::exception& e) {
+                throw std::runtime_error("worker " + std::to_string(w) + " failed: " + e.what());
+            }
+        }
+    } else {
+        WorkStealingPool pool(threads, config.placement);
+        std::function<void(size_t, uint32_t, Date, int32_t)> run_chain;
+
+        if (independent) {
+            // Every (security, day) is its own task; opens come from the overnight path.
+            dates.reserve(config.num_days);
+            Date d = start_date;
+            for (uint32_t day = 0; day < config.num_days; ++day) {
+                dates.push_back(d);
+                d = nextBusinessDay(d);
+            }
+            for (size_t si = 0; si < secs.size(); ++si) {
+                per_sec_results[si].resize(config.num_days);
+                const uint32_t run_si = config.first_security + static_cast<uint32_t>(si);
+                const auto opens = overnightOpens(config, run_si, secs[si].p0_ticks,
+                                                  config.first_day + config.num_days);
+                for (uint32_t day = 0; day < config.num_days; ++day) {
+                    pool.submit([&, si, run_si, day, open = opens[config.first_day + day]]() {
+                        if (g_shutdown_requested.load(std::memory_order_relaxed)) return;
+                        try {
+                            per_sec_results[si][day] = runDay(
+                                config, secs[si], run_si, config.first_day + day, dates[day], open,
+                                nullptr, nullptr, nullptr);
+                            finishDay(outputs, config, per_sec_results[si][day]);
+                        } catch (...) {
+                            std::lock_guard<std::mutex> lock(error_mutex);
+                            if (!errors[si]) errors[si] = std::current_exception();
+                        }
+                    });
+                }
+            }
+        } else {
+            // Chained: day d+1 is queued by day d once its close is known. Only one
+            // task per security is ever in flight, so its result vector needs no lock.
+            run_chain = [&](size_t si, uint32_t day, Date date, int32_t open) {
+                if (g_shutdown_requested.load(std::memory_order_relaxed)) return;
                 try {
-                    const auto& sec = config.securities[si];
-                    per_sec_results[si] = runSecurityDays(
-                        config, sec.symbol,
-                        sec.p0_ticks, sec.tick_size, sec.levels_per_side,
-                        sec.initial_spread_ticks, sec.initial_depth,
-                        sec.intensity_params, sec.queue_reactive,
-                        sec.model_type, si * kSeedStride);
-                } catch (const std::exception& e) {
-                    errors[si] = e.what();
+                    DayResult dr = runDay(config, secs[si],
+                                          config.first_security + static_cast<uint32_t>(si), day,
+                                          date, open,
+                                          live_sinks.empty() ? nullptr : live_sinks[si],
+                                          si == 0 ? frame_ring.get() : nullptr, event_bus.get());
+                    const int32_t close = dr.close_ticks;
+                    finishDay(outputs, config, dr);
+                    per_sec_results[si].push_back(std::move(dr));
+                    if (!infinite && day + 1 >= config.first_day + config.num_days) return;
+                    if (config.realtime) {
+                        std::printf("[%s] overnight pause (5s)...\n", secs[si].symbol.c_str());
+                        std::this_thread::sleep_for(std::chrono::seconds(5));
+                    }
+                    const Date next_date = nextBusinessDay(date);
+                    pool.submit([&run_chain, si, day, next_date, close]() {
+                        run_chain(si, day + 1, next_date, close);
+                    });
+                } catch (...) {
+                    std::lock_guard<std::mutex> lock(error_mutex);
+                    if (!errors[si]) errors[si] = std::current_exception();
                 }
-            });
+            };
+            for (size_t si = 0; si < secs.size(); ++si) {
+                pool.submit([&run_chain, si, first = config.first_day, start_date,
+                             open = secs[si].p0_ticks]() {
+                    run_chain(si, first, start_date, open);
+                });
+            }
         }
 
-        for (auto& t : threads) t.join();
+        pool.wait();
+    }
+    if (frame_ring) frame_ring->close();
+    if (event_bus) {
+        event_bus->close();
+        std::printf("shm ring: %llu records published\n",
+                    (unsigned long long)event_bus->published());
+    }
+    if (live_feed) {
+        live_feed->stop();
+        std::printf("itch live: %llu messages sent\n",
+                    (unsigned long long)live_feed->messagesSent());
+    }
 
-        for (size_t si = 0; si < config.securities.size(); ++si) {
-            if (!errors[si].empty()) {
-                throw std::runtime_error("security " + config.securities[si].symbol +
-                                         " failed: " + errors[si]);
-            }
-            for (auto& d : per_sec_results[si]) {
-                result.total_events += d.events_written;
-                result.days.push_back(std::move(d));
+    for (size_t si = 0; si < secs.size(); ++si) {
+        if (errors[si]) {
+            if (!multi) std::rethrow_exception(errors[si]);
+            try {
+                std::rethrow_exception(errors[si]);
+            } catch (const std::exception& e) {
+                throw std::runtime_error("security " + secs[si].symbol +
+                                         " failed: " + e.what());
             }
         }
+        for (auto& d : per_sec_results[si]) {
+            if (d.filename.empty()) continue;  // independent day skipped by shutdown
+            result.total_events += d.events_written;
+            result.days.push_back(std::move(d));
+        }
+    }
+
+    if (container) {
+        container->close();
+        for (const auto& sec : secs) {
+            std::error_code ec;  // only empty directories are removed
+            if (!sec.symbol.empty()) fs::remove(fs::path(config.output_dir) / sec.symbol, ec);
+        }
     }
 
     auto run_end = std::chrono::steady_clock::now();
     result.total_elapsed_seconds = std::chrono::duration<double>(run_end - run_start).count();
 
-    writeManifest(config, result);
+    if (config.shard_name.empty()) writeManifest(config, result);
     return result;
 }
 
+std::string SessionRunner::catalogName(const RunConfig& config) {
+    return config.shard_name.empty() ? std::string(kRunCatalogName)
+                                     : "catalog-" + config.shard_name + ".qcat";
+}
+
 }  // namespace qrsdp
@@ -1,14 +1,50 @@
 #pragma once
 
+#include "core/cpu_placement.h"
 #include "core/records.h"
+#include "io/async_sink.h"
+#include "io/chunk_codec.h"
+#include "io/event_log_reader.h"
+#include "io/hlr_curve_bundle.h"
+#include "io/kafka_sink_options.h"
+#include "io/shm_ring_sink.h"
+#include "itch/itch_udp_sink.h"
+#include "model/hawkes_params.h"
 #include "model/hlr_params.h"
+#include "model/hlr_params_channel.h"
+#include "sampler/competing_intensity_sampler.h"
 #include <cstdint>
+#include <memory>
 #include <string>
 #include <vector>
 
 namespace qrsdp {
 
-enum class ModelType { SIMPLE, HLR };
+class IoUringWriter;
+class MetricsRegistry;
+class StageProfileTotals;
+
+/// HAWKES: RunConfig::hawkes self- and cross-excitation (HawkesIntensityModel) on
+/// the simple model as a book-driven baseline, or on the constant mu when
+/// RunConfig::hawkes.baseline is MU (as qrsdp_calibrate --hawkes fits it).
+enum class ModelType { SIMPLE, HLR, HAWKES };
+
+/// "simple", "hlr" or "hawkes", as the command-line tools spell it.
+inline const char* modelTypeName(ModelType model) {
+    switch (model) {
+        case ModelType::HLR:    return "hlr";
+        case ModelType::HAWKES: return "hawkes";
+        case ModelType::SIMPLE: break;
+    }
+    return "simple";
+}
+
+/// How per-day session seeds are derived.
+///   SEQUENTIAL — base_seed + security_index * 1024 + day_index (legacy; overlaps
+///                once a security runs more than 1024 days).
+///   COUNTER    — streamSeed(base_seed, security_index, day_index); collision-free
+///                and computable for any day independently.
+enum class SeedScheme { SEQUENTIAL, COUNTER };
 
 struct SecurityConfig {
     std::string symbol;
@@ -20,6 +56,20 @@ struct SecurityConfig {
     IntensityParams intensity_params;
     QueueReactiveParams queue_reactive;
     ModelType model_type = ModelType::SIMPLE;
+    std::shared_ptr<const HLRModelCurves> hlr_curves;  // HLR: shared by every model of this security; null = from hlr_bundle / hlr_params / defaults
+};
+
+/// Live book frames (RunConfig::live_frames): the first security's days are
+/// replayed into book frames (io/book_frame.h) while they are generated and
+/// published to a FrameRing (io/frame_ring.h), bracketed by LiveDayStart /
+/// LiveDayEnd messages, so a viewer can follow the run without waiting for it.
+struct LiveFramesConfig {
+    std::string path;                          // ring file (e.g. under /dev/shm); empty = off
+    uint64_t frame_interval_ns = 50'000'000;   // simulated time per frame
+    uint32_t recent_events = 8;                // latest records carried by each frame
+    size_t ring_bytes = 4u << 20;              // ring data capacity
+
+    bool enabled() const { return !path.empty(); }
 };
 
 struct RunConfig {
@@ -36,15 +86,56 @@ struct RunConfig {
     QueueReactiveParams queue_reactive;
     ModelType model_type = ModelType::SIMPLE;
     HLRParams hlr_params;          // used when model_type == HLR; if !hasCurves(), use defaults
+    HawkesParams hawkes = makeDefaultHawkesParams();  // every HAWKES security's model (mu: MU baseline only)
+    std::shared_ptr<const HLRCurveBundle> hlr_bundle;  // non-null: HLR securities in it read their curves from it
+    const HLRParamsChannel* hlr_updates = nullptr;  // non-null: HLR models hot-swap to params published here
+    SelectionMode selection_mode = SelectionMode::FENWICK;  // LINEAR = legacy per-level draws
+    RngAlgorithm rng = RngAlgorithm::MT19937;
+    SeedScheme seed_scheme = SeedScheme::COUNTER;
     uint32_t num_days;
     uint32_t chunk_capacity;    // 0 = use default (4096)
+    uint32_t write_buffers = 0; // >= 2: BinaryFileSink compresses/writes on a background thread
+    bool columnar = false;      // v1.1 columnar chunks (smaller files, column-projected reads)
+    CodecConfig codec;          // chunk compression; default LZ4 acceleration 1
+    uint32_t seek_stride = 0;   // > 0: seek index with a ts sample every seek_stride records
+    uint32_t checkpoint_interval = 0;  // > 0: book checkpoint every this many chunks
+    uint32_t sync_interval = 0;  // > 0: fsync + sidecar index every this many chunks
+    VerifyMode verify = VerifyMode::Checksums;  // check of each finished day (read_seconds times it)
+    std::vector<uint32_t> bar_seconds;  // non-empty: OHLC bars at these resolutions in each day file's footer
+    IoUringWriter* io_uring = nullptr;  // non-null: every day file is written through this shared ring
+    bool resume = false;        // keep finished day files, resume unfinished ones (not with workers)
+    std::string container;      // non-empty: pack every day file into output_dir/container (.qrsc)
+    bool arrow = false;         // also write each day as <day>.arrow (Arrow IPC, a batch per chunk)
     std::string start_date;     // "YYYY-MM-DD"
+    uint32_t first_day = 0;     // distributed shard: run index of the first day (dates, seeds, overnight opens)
+    uint32_t first_security = 0;  // distributed shard: run index of the first security (seeds, Kafka partitions)
+    std::string shard_name;     // non-empty: a shard of a distributed run (catalogue per shard, no manifest)
     std::vector<SecurityConfig> securities;  // empty = single-security mode
     std::string kafka_brokers;  // empty = no Kafka (file-only)
     std::string kafka_topic = "exchange.events";
+    KafkaSinkOptions kafka;     // producer profile, explicit partitions, batching
+    bool kafka_async = false;   // day-scheduler mode: Kafka behind its own queue and thread
+    AsyncSinkOptions kafka_queue;  // queue size and overflow policy for kafka_async
+    itch::ItchLiveConfig itch_live;  // enabled: stream ITCH over UDP from the producers (no Kafka)
+    LiveFramesConfig live_frames;    // enabled: publish security 0's book frames as they are generated
+    ShmRingConfig shm_ring;          // enabled: publish every record to a shared-memory event bus
     uint32_t market_open_seconds = kDefaultMarketOpenSeconds;
     bool realtime = false;      // pace events to simulated inter-arrival times
     double speed = 1.0;         // wall-clock multiplier (100 = 100x faster than real time)
+    uint32_t pace_spin_us = 100;   // realtime: spin for the last pace_spin_us before a due time
+    uint32_t pace_window_us = 50;  // realtime: events due within this window go out together
+    int pace_cpu = -1;          // realtime: >= 0 pins pacing thread i (security or worker) to pace_cpu + i
+    bool pace_per_security = false;  // realtime: a pacing thread per security, not one shared clock
+    ThreadPlacement placement;  // CPUs and NUMA policy of generation and I/O threads (not with pace_cpu)
+    uint32_t threads = 0;       // day-scheduler workers; 0 = one per placement CPU, else hardware concurrency
+    bool independent_days = false;      // open each day from overnightOpens(), not the prior close
+    double overnight_sigma_ticks = 10.0;  // stddev of the independent-days overnight gap
+    uint32_t workers = 0;       // >0: fixed workers, each interleaving its securities by sim time
+    uint32_t max_open_files = 0;  // workers mode: cap on day files open at once (0 = no cap)
+    bool order_book = false;    // OrderLevelBook: cancels/executes reference resting order ids
+    SeasonalityProfile seasonality;  // intraday multiplier buckets; empty = constant intensities
+    MetricsRegistry* metrics = nullptr;  // non-null: record hot-path metrics (core/metrics.h) into it
+    StageProfileTotals* stage_profile = nullptr;  // non-null: merge per-stage cycle profiles into it (QRSDP_STAGE_PROFILE builds)
 };
 
 struct DayResult {
@@ -58,7 +149,8 @@ struct DayResult {
     uint32_t chunks_written;
     uint64_t file_size_bytes;
     double   write_seconds;
-    double   read_seconds;      // sequential read-back benchmark
+    double   read_seconds;      // read-back check of the finished file (RunConfig::verify)
+    double   compress_seconds;  // time BinaryFileSink spent encoding/compressing chunks
 };
 
 struct RunResult {
@@ -70,10 +162,71 @@ struct RunResult {
 /// Drives multiple consecutive trading sessions (days) with continuous chaining:
 /// each day's opening price = previous day's closing price.
 /// Writes one .qrsdp file per day plus a manifest.json.
+///
+/// Days are scheduled on a WorkStealingPool. Chained days of one security run in
+/// order, different securities in parallel; with independent_days every
+/// (security, day) is its own task. Output is identical for any thread count.
+///
+/// With workers > 0 a fixed set of workers each owns a slice of the securities
+/// and steps them together, earliest simulated clock first, sharing one Kafka
+/// producer per worker. Files are the same as in the default mode.
+///
+/// Realtime runs with several securities pace them from one clock: without
+/// workers every security runs in a single group on one thread, whose pacer
+/// releases their events in timestamp order; with workers each worker paces its
+/// group against a day origin shared by all workers. pace_per_security (and
+/// resume or kafka_async, which need the day scheduler) keeps a pacer per
+/// security thread instead.
+///
+/// With a container name, each finished day file is copied into one
+/// SessionContainer in output_dir and deleted, so a run leaves a single data file;
+/// manifest filenames then name the sessions inside it.
+///
+/// With itch_live enabled, every security also feeds an ItchUdpSink of one
+/// ItchLiveFeed for the whole run, so the generated events go out as a live
+/// ITCH/MoldUDP64 feed as they are produced. That turns independent_days off (a
+/// security's sink takes one producer at a time). live_frames does the same for
+/// the first security's book frames; it needs the day scheduler (no workers, no
+/// shared realtime clock) and cannot be combined with resume.
+///
+/// With a placement, the scheduler's (or fixed workers') threads are pinned to
+/// placement.cpus and build their producers, books, models and sinks after
+/// pinning, so those land on the thread's NUMA node; realtime pacing then runs
+/// on the same pinned threads. File-writer, Kafka and live ITCH sender threads
+/// start on placement.io_cpus (see ThreadPlacement).
+///
+/// A distributed run (producer/run_coordinator.h) runs slices of a run as
+/// shards: first_day and first_security place the slice in the whole run, so
+/// its days get the dates, seeds and overnight opens they have there. A shard's
+/// chained days open at p0_ticks, which the coordinator sets to the previous
+/// shard's close. With shard_name set, the catalogue is catalogName(config) and
+/// no manifest is written. Shards run on the day scheduler into day files only.
 class SessionRunner {
 public:
     RunResult run(const RunConfig& config);
 
+    /// Seed of day day_index of security security_index (0 in single-security mode).
+    /// Together with that day's opening price it fully determines the day's events,
+    /// so a single day can be regenerated without replaying the days before it.
+    static uint64_t daySeed(const RunConfig& config, uint32_t security_index, uint32_t day_index);
+
+    /// Opening prices of days 0..num_days-1 under independent_days: day 0 opens at
+    /// p0_ticks, each later day at the previous open plus a rounded
+    /// N(0, overnight_sigma_ticks) gap drawn from a stream keyed on base_seed and
+    /// security_index (floored at 2 ticks).
+    static std::vector<int32_t> overnightOpens(const RunConfig& config, uint32_t security_index,
+                                               int32_t p0_ticks, uint32_t num_days);
+
+    /// hlr_bundle's curves for sec (a single-security run takes a one-symbol
+    /// bundle's), or nullptr: an HLR security without hlr_curves then uses
+    /// hlr_params, else the defaults. Bundle curves are views of the shared
+    /// mapping, not copies; run() builds each other curve set once.
+    static const CurveBundleSymbol* hlrBundleEntry(const RunConfig& config, const SecurityConfig& sec);
+
+    /// The run's catalogue file name in output_dir: catalog.qcat, or
+    /// catalog-<shard_name>.qcat for a shard.
+    static std::string catalogName(const RunConfig& config);
+
     static void writeManifest(const RunConfig& config, const RunResult& result);
     static void writePerformanceResults(const RunConfig& config,
                                         const RunResult& result,
@@ -0,0 +1,74 @@
+#include "producer/stage_profile.h"
+
+#include <thread>
+
+namespace qrsdp {
+
+const char* stageName(Stage stage) {
+    switch (stage) {
+        case Stage::INTENSITY: return "intensity";
+        case Stage::DELTA_T:   return "delta_t";
+        case Stage::SELECT:    return "select";
+        case Stage::ATTRS:     return "attrs";
+        case Stage::APPLY:     return "apply";
+        case Stage::SINK:      return "sink";
+    }
+    return "unknown";
+}
+
+double cyclesPerNanosecond() {
+#ifdef QRSDP_HAS_RDTSC
+    static const double rate = [] {
+        const auto t0 = std::chrono::steady_clock::now();
+        const uint64_t c0 = readCycles();
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        const uint64_t c1 = readCycles();
+        const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - t0).count();
+        return ns > 0 ? static_cast<double>(c1 - c0) / static_cast<double>(ns) : 1.0;
+    }();
+    return rate;
+#else
+    return 1.0;
+#endif
+}
+
+void CycleStageProfile::merge(const CycleStageProfile& other) {
+    for (size_t s = 0; s < kStageCount; ++s) {
+        histograms_[s].merge(other.histograms_[s]);
+        cycles_[s] += other.cycles_[s];
+        events_[s] += other.events_[s];
+    }
+}
+
+void CycleStageProfile::reset() {
+    for (size_t s = 0; s < kStageCount; ++s) {
+        histograms_[s].reset();
+        cycles_[s] = 0;
+        events_[s] = 0;
+    }
+}
+
+void writeStageTable(std::FILE* f, const CycleStageProfile& profile) {
+    const double per_ns = cyclesPerNanosecond();
+    uint64_t total_cycles = 0;
+    for (size_t s = 0; s < kStageCount; ++s) total_cycles += profile.cycles(static_cast<Stage>(s));
+
+    std::fprintf(f, "| Stage | Events | Mean cyc | p50 cyc | p99 cyc | Mean ns | Share |\n");
+    std::fprintf(f, "|:------|-------:|---------:|--------:|--------:|--------:|------:|\n");
+    for (size_t s = 0; s < kStageCount; ++s) {
+        const Stage stage = static_cast<Stage>(s);
+        const uint64_t events = profile.events(stage);
+        const double mean = events ? static_cast<double>(profile.cycles(stage)) / static_cast<double>(events) : 0.0;
+        const LatencyHistogram& h = profile.histogram(stage);
+        std::fprintf(f, "| %s | %llu | %.0f | %llu | %llu | %.1f | %.1f%% |\n", stageName(stage),
+                     (unsigned long long)events, mean,
+                     (unsigned long long)h.percentile(0.5), (unsigned long long)h.percentile(0.99),
+                     mean / per_ns,
+                     total_cycles ? 100.0 * static_cast<double>(profile.cycles(stage))
+                                        / static_cast<double>(total_cycles)
+                                  : 0.0);
+    }
+}
+
+}  // namespace qrsdp
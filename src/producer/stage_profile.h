@@ -0,0 +1,125 @@
+#pragma once
+
+#include "core/metrics.h"
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define QRSDP_HAS_RDTSC 1
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#endif
+
+namespace qrsdp {
+
+/// Stages of one generated event, in the order BasicQrsdpProducer runs them.
+///   INTENSITY — book snapshot and IIntensityModel::update
+///   DELTA_T   — sampleDeltaT (or thinning / seasonal buckets)
+///   SELECT    — event type and level: sampleIndexFromWeights / sampleType
+///   ATTRS     — IAttributeSampler::sample
+///   APPLY     — IOrderBook::apply, shift detection and reinitialisation
+///   SINK      — IEventSink::append / appendBatch, per event
+enum class Stage : uint8_t { INTENSITY, DELTA_T, SELECT, ATTRS, APPLY, SINK };
+constexpr size_t kStageCount = 6;
+
+/// "intensity", "delta_t", "select", "attrs", "apply", "sink".
+const char* stageName(Stage stage);
+
+/// Cycle counter: rdtsc on x86, steady_clock nanoseconds elsewhere.
+inline uint64_t readCycles() {
+#ifdef QRSDP_HAS_RDTSC
+    return __rdtsc();
+#else
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+}
+
+/// readCycles() ticks per nanosecond, measured once per process against
+/// steady_clock (1 where readCycles() already counts nanoseconds).
+double cyclesPerNanosecond();
+
+/// Stage-timing policy of BasicQrsdpProducer that records nothing. Both calls
+/// are constant and side-effect free, so the default producer compiles to the
+/// same code as before the hooks existed.
+struct NoStageProfile {
+    static constexpr bool kEnabled = false;
+    uint64_t start() const { return 0; }
+    uint64_t lap(Stage, uint64_t) { return 0; }
+    void lapBatch(Stage, uint64_t, size_t) {}
+};
+
+/// Stage-timing policy that keeps a cycle histogram and cycle total per stage.
+/// start() reads the counter; lap(stage, since) charges the cycles since
+/// `since` to stage and returns the new reading, so consecutive stages cost
+/// one counter read each. One producer (thread) per profile.
+class CycleStageProfile {
+public:
+    static constexpr bool kEnabled = true;
+
+    uint64_t start() const { return readCycles(); }
+    uint64_t lap(Stage stage, uint64_t since) {
+        const uint64_t now = readCycles();
+        const size_t s = static_cast<size_t>(stage);
+        histograms_[s].record(now - since);
+        cycles_[s] += now - since;
+        ++events_[s];
+        return now;
+    }
+    /// Charges the cycles since `since` to stage as n events of equal cost
+    /// (sink batches): the histogram gets the per-event mean once.
+    void lapBatch(Stage stage, uint64_t since, size_t n) {
+        if (n == 0) return;
+        const uint64_t elapsed = readCycles() - since;
+        const size_t s = static_cast<size_t>(stage);
+        histograms_[s].record(elapsed / n);
+        cycles_[s] += elapsed;
+        events_[s] += n;
+    }
+
+    const LatencyHistogram& histogram(Stage stage) const {
+        return histograms_[static_cast<size_t>(stage)];
+    }
+    uint64_t cycles(Stage stage) const { return cycles_[static_cast<size_t>(stage)]; }
+    /// Events charged to stage.
+    uint64_t events(Stage stage) const { return events_[static_cast<size_t>(stage)]; }
+
+    void merge(const CycleStageProfile& other);
+    void reset();
+
+private:
+    std::array<LatencyHistogram, kStageCount> histograms_{};
+    std::array<uint64_t, kStageCount> cycles_{};
+    std::array<uint64_t, kStageCount> events_{};
+};
+
+/// Per-stage profiles of a whole run, merged from every producer thread.
+class StageProfileTotals {
+public:
+    void merge(const CycleStageProfile& profile) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        total_.merge(profile);
+    }
+    CycleStageProfile snapshot() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return total_;
+    }
+
+private:
+    mutable std::mutex mutex_;
+    CycleStageProfile total_;
+};
+
+/// Writes the breakdown as a markdown table: per stage the events, mean, p50
+/// and p99 cycles per event, mean ns per event and share of the step time.
+void writeStageTable(std::FILE* f, const CycleStageProfile& profile);
+
+}  // namespace qrsdp
@@ -0,0 +1,148 @@
+#include "producer/work_stealing_pool.h"
+
+#include <algorithm>
+
+namespace qrsdp {
+
+namespace {
+
+/// Pool and worker index of the current thread (t_pool is null off-pool).
+thread_local const WorkStealingPool* t_pool = nullptr;
+thread_local size_t t_worker = 0;
+
+/// Failed pops (queued_ > 0, but the task is not in a deque yet or another
+/// worker got it first) a worker retries with a yield before it parks until
+/// the next push.
+constexpr int kSpinsBeforePark = 64;
+
+}  // namespace
+
+size_t WorkStealingPool::defaultThreadCount() {
+    const unsigned hw = std::thread::hardware_concurrency();
+    return hw > 0 ? hw : 1;
+}
+
+WorkStealingPool::WorkStealingPool(size_t threads) : WorkStealingPool(threads, ThreadPlacement{}) {}
+
+WorkStealingPool::WorkStealingPool(size_t threads, const ThreadPlacement& placement)
+    : placement_(placement) {
+    const size_t n = threads > 0 ? threads
+        : !placement.cpus.empty() ? placement.cpus.size() : defaultThreadCount();
+    queues_.reserve(n);
+    for (size_t i = 0; i < n; ++i) queues_.push_back(std::make_unique<Queue>());
+    // Next workers round the ring, those on the thief's node first.
+    victims_.resize(n);
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t k = 1; k < n; ++k) victims_[i].push_back((i + k) % n);
+        if (placement.cpus.empty()) continue;
+        const int node = cpuNumaNode(placement.cpuFor(i));
+        std::stable_partition(victims_[i].begin(), victims_[i].end(), [&](size_t v) {
+            return cpuNumaNode(placement.cpuFor(v)) == node;
+        });
+    }
+    workers_.reserve(n);
+    for (size_t i = 0; i < n; ++i) workers_.emplace_back([this, i]() { workerLoop(i); });
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    wait();
+    {
+        std::lock_guard<std::mutex> lock(state_mutex_);
+        stop_ = true;
+    }
+    work_cv_.notify_all();
+    for (auto& t : workers_) t.join();
+}
+
+void WorkStealingPool::submit(std::function<void()> task) {
+    const size_t q = (t_pool == this)
+        ? t_worker
+        : next_queue_.fetch_add(1, std::memory_order_relaxed) % queues_.size();
+    // Count first so pending_ never dips to zero while a task is in flight.
+    {
+        std::lock_guard<std::mutex> lock(state_mutex_);
+        ++queued_;
+        ++pending_;
+    }
+    {
+        std::lock_guard<std::mutex> lock(queues_[q]->mutex);
+        queues_[q]->tasks.push_back(std::move(task));
+    }
+    {
+        std::lock_guard<std::mutex> lock(state_mutex_);
+        ++pushes_;
+    }
+    work_cv_.notify_one();
+}
+
+void WorkStealingPool::wait() {
+    std::unique_lock<std::mutex> lock(state_mutex_);
+    idle_cv_.wait(lock, [this]() { return pending_ == 0; });
+}
+
+bool WorkStealingPool::tryPop(size_t self, std::function<void()>& out) {
+    {
+        Queue& own = *queues_[self];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            out = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            return true;
+        }
+    }
+    for (size_t v : victims_[self]) {
+        Queue& victim = *queues_[v];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            out = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+void WorkStealingPool::workerLoop(size_t self) {
+    t_pool = this;
+    t_worker = self;
+    if (placement_.enabled())
+        placement_.placeThread(self);  // best effort: an unplaced worker still works
+    int misses = 0;
+    for (;;) {
+        uint64_t seen = 0;
+        {
+            std::unique_lock<std::mutex> lock(state_mutex_);
+            work_cv_.wait(lock, [this]() { return stop_ || queued_ > 0; });
+            if (stop_ && queued_ == 0) return;
+            seen = pushes_;
+        }
+        std::function<void()> task;
+        if (!tryPop(self, task)) {
+            // Counted but not yet pushed, or taken by another worker: retry briefly,
+            // then sleep. Every task pushed before `seen` was read was in a deque
+            // when tryPop looked, so only a later push can bring new work.
+            if (++misses < kSpinsBeforePark) {
+                std::this_thread::yield();
+            } else {
+                misses = 0;
+                std::unique_lock<std::mutex> lock(state_mutex_);
+                work_cv_.wait(lock, [this, seen]() { return stop_ || pushes_ != seen; });
+            }
+            continue;
+        }
+        misses = 0;
+        {
+            std::lock_guard<std::mutex> lock(state_mutex_);
+            --queued_;
+        }
+        task();
+        bool idle = false;
+        {
+            std::lock_guard<std::mutex> lock(state_mutex_);
+            idle = (--pending_ == 0);
+        }
+        if (idle) idle_cv_.notify_all();
+    }
+}
+
+}  // namespace qrsdp
@@ -0,0 +1,75 @@
+#pragma once
+
+#include "core/cpu_placement.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace qrsdp {
+
+/// Fixed-size thread pool with one task deque per worker. A worker pops its own
+/// deque LIFO (continuations run hot on the thread that queued them) and, when
+/// empty, steals FIFO from the others. Tasks may submit further tasks; wait()
+/// returns once every task, including those, has finished.
+///
+/// With a ThreadPlacement, worker i places itself (placeThread(i)) before taking
+/// work, and steals from workers on its own NUMA node before remote ones, so a
+/// stolen task still allocates and runs node-locally when it can.
+///
+/// Task exceptions are not caught by the pool: tasks must handle their own errors.
+class WorkStealingPool {
+public:
+    /// threads == 0 uses std::thread::hardware_concurrency() (at least 1).
+    explicit WorkStealingPool(size_t threads = 0);
+    /// threads == 0 uses one worker per placement CPU, or hardware concurrency
+    /// when the placement lists none.
+    WorkStealingPool(size_t threads, const ThreadPlacement& placement);
+    ~WorkStealingPool();
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    /// Queue a task. From a worker thread it goes on that worker's own deque;
+    /// otherwise deques are filled round-robin.
+    void submit(std::function<void()> task);
+
+    /// Block until all submitted tasks (and tasks they submit) have completed.
+    void wait();
+
+    size_t size() const { return queues_.size(); }
+
+    static size_t defaultThreadCount();
+
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    void workerLoop(size_t self);
+    bool tryPop(size_t self, std::function<void()>& out);
+
+    std::vector<std::unique_ptr<Queue>> queues_;
+    std::vector<std::vector<size_t>> victims_;  // per worker: whom to steal from, in order
+    ThreadPlacement placement_;
+    std::vector<std::thread> workers_;
+
+    std::mutex state_mutex_;
+    std::condition_variable work_cv_;  // signalled on submit / stop
+    std::condition_variable idle_cv_;  // signalled when pending_ reaches 0
+    size_t queued_ = 0;                // tasks sitting in deques (guarded by state_mutex_)
+    size_t pending_ = 0;               // queued + running (guarded by state_mutex_)
+    uint64_t pushes_ = 0;              // tasks pushed so far; a parked worker waits for it to move
+    bool stop_ = false;
+    std::atomic<size_t> next_queue_{0};
+};
+
+}  // namespace qrsdp
@@ -0,0 +1,191 @@
+#include "io/event_log_reader.h"
+#include "io/session_container.h"
+#include "itch/itch_replay.h"
+#include "itch/moldudp64.h"
+#include "itch/udp_sender.h"
+
+#include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <memory>
+#include <string>
+#include <vector>
+
+static qrsdp::itch::ItchReplayer* g_replayer = nullptr;
+
+static void signalHandler(int) {
+    if (g_replayer)
+        g_replayer->stop();
+}
+
+static void printUsage(const char* prog) {
+    std::fprintf(stderr,
+        "Usage: %s [options] [SYMBOL=]<file.qrsdp|run.qrsc>...\n"
+        "  Replays recorded sessions as one ITCH 5.0 / MoldUDP64 feed, merged by timestamp.\n"
+        "  A .qrsc container contributes each of its sessions under its own symbol.\n"
+        "  --date <YYYY-MM-DD>   Only replay container sessions of this date\n"
+        "  --speed <f>           Pace to event timestamps, f times faster than real time\n"
+        "  --rate <n>            Pace to a fixed n events per second\n"
+        "                        (default: as fast as possible)\n"
+        "  --order-book          Sessions come from qrsdp_run --order-book: also send the\n"
+        "                        book's own orders (seed depth, refills, dropped levels)\n"
+        "  --multicast-group <s> Multicast address (default: 239.1.1.1)\n"
+        "  --unicast-dest <h:p>  Send unicast to host:port instead of multicast\n"
+        "  --port <n>            UDP port (default: 5001)\n"
+        "  --ttl <n>             Multicast TTL (default: 1)\n"
+        "  --session <s>         MoldUDP64 session name (default: QRSDPITCH)\n"
+        "  --batch <n>           Packets per sendmmsg batch; 1 = one sendto each (default: 16)\n"
+        "  --flush-us <n>        Max microseconds a message waits before sending (default: 500)\n"
+        "  --gso                 Coalesce equal-size packets with UDP GSO (Linux)\n"
+        "  --help                Show this help\n",
+        prog);
+}
+
+int main(int argc, char* argv[]) {
+    std::vector<std::string> inputs;
+    std::string date;
+    qrsdp::itch::ReplayOptions options;
+    std::string multicast_group = "239.1.1.1";
+    std::string unicast_dest;
+    uint16_t port = 5001;
+    uint8_t ttl = 1;
+    std::string session = "QRSDPITCH";
+    size_t batch_packets = 16;
+    uint32_t flush_us = 500;
+    bool gso = false;
+
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        auto next = [&]() -> const char* {
+            if (i + 1 >= argc) {
+                std::fprintf(stderr, "missing value for %s\n", arg);
+                std::exit(1);
+            }
+            return argv[++i];
+        };
+
+        if (std::strcmp(arg, "--date") == 0)                 date = next();
+        else if (std::strcmp(arg, "--speed") == 0) {
+            options.pacing = qrsdp::itch::ReplayPacing::Realtime;
+            options.speed = std::atof(next());
+        } else if (std::strcmp(arg, "--rate") == 0) {
+            options.pacing = qrsdp::itch::ReplayPacing::FixedRate;
+            options.rate = std::atof(next());
+        }
+        else if (std::strcmp(arg, "--order-book") == 0)      options.order_book = true;
+        else if (std::strcmp(arg, "--multicast-group") == 0) multicast_group = next();
+        else if (std::strcmp(arg, "--unicast-dest") == 0)    unicast_dest = next();
+        else if (std::strcmp(arg, "--port") == 0)            port = static_cast<uint16_t>(std::atoi(next()));
+        else if (std::strcmp(arg, "--ttl") == 0)             ttl = static_cast<uint8_t>(std::atoi(next()));
+        else if (std::strcmp(arg, "--session") == 0)         session = next();
+        else if (std::strcmp(arg, "--batch") == 0)           batch_packets = static_cast<size_t>(std::atoi(next()));
+        else if (std::strcmp(arg, "--flush-us") == 0)        flush_us = static_cast<uint32_t>(std::atoi(next()));
+        else if (std::strcmp(arg, "--gso") == 0)             gso = true;
+        else if (std::strcmp(arg, "--help") == 0 || std::strcmp(arg, "-h") == 0) {
+            printUsage(argv[0]);
+            return 0;
+        } else if (arg[0] == '-') {
+            std::fprintf(stderr, "unknown argument: %s\n", arg);
+            printUsage(argv[0]);
+            return 1;
+        } else {
+            inputs.emplace_back(arg);
+        }
+    }
+    if (inputs.empty()) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    try {
+        qrsdp::itch::MoldUDP64Framer framer(session, std::max<size_t>(batch_packets, 1));
+        qrsdp::itch::ItchReplayer replayer(framer, options);
+        std::vector<std::unique_ptr<qrsdp::SessionContainer>> containers;
+        for (const std::string& input : inputs) {
+            const auto eq = input.find('=');
+            const std::string symbol = eq == std::string::npos ? "" : input.substr(0, eq);
+            const std::string path = eq == std::string::npos ? input : input.substr(eq + 1);
+            if (qrsdp::isSessionContainer(path)) {
+                containers.push_back(std::make_unique<qrsdp::SessionContainer>(path));
+                const qrsdp::SessionContainer& c = *containers.back();
+                for (size_t s = 0; s < c.size(); ++s) {
+                    const qrsdp::ContainerSession& cs = c.sessions()[s];
+                    if (!date.empty() && cs.date != date)
+                        continue;
+                    const std::string name = !symbol.empty() ? symbol
+                                           : !cs.symbol.empty() ? cs.symbol : "UNKNOWN";
+                    replayer.addSource(name, c.open(s));
+                }
+            } else {
+                replayer.addSource(symbol.empty() ? "UNKNOWN" : symbol,
+                                   std::make_unique<qrsdp::EventLogReader>(path));
+            }
+        }
+        if (replayer.sourceCount() == 0) {
+            std::fprintf(stderr, "no sessions to replay%s%s\n",
+                         date.empty() ? "" : " for ", date.c_str());
+            return 1;
+        }
+
+        std::unique_ptr<qrsdp::itch::UdpMulticastSender> sender;
+        if (!unicast_dest.empty()) {
+            const auto colon = unicast_dest.rfind(':');
+            if (colon == std::string::npos || colon == 0) {
+                std::fprintf(stderr, "--unicast-dest expects host:port\n");
+                return 1;
+            }
+            sender = qrsdp::itch::UdpMulticastSender::createUnicast(
+                unicast_dest.substr(0, colon),
+                static_cast<uint16_t>(std::atoi(unicast_dest.c_str() + colon + 1)));
+        } else {
+            sender = std::make_unique<qrsdp::itch::UdpMulticastSender>(multicast_group, port, ttl);
+        }
+        if (gso && !sender->enableGso(true))
+            std::fprintf(stderr, "UDP GSO not supported here, sending plain batches\n");
+
+        uint64_t packets = 0;
+        framer.setSendCallback([&](const uint8_t* data, size_t len) {
+            sender->send(data, len);
+            ++packets;
+        });
+        if (batch_packets > 1) {
+            framer.setBatchCallback([&](const qrsdp::itch::Datagram* batch, size_t n) {
+                sender->sendBatch(batch, n);
+                packets += n;
+            });
+        }
+        framer.setFlushDeadline(std::chrono::microseconds(flush_us));
+
+        std::printf("=== qrsdp_replay ===\n");
+        std::printf("sessions=%zu  dest=%s", replayer.sourceCount(),
+                    unicast_dest.empty() ? multicast_group.c_str() : unicast_dest.c_str());
+        if (unicast_dest.empty())
+            std::printf(":%u", port);
+        if (options.pacing == qrsdp::itch::ReplayPacing::Realtime)
+            std::printf("  pacing=realtime x%.2f\n", options.speed);
+        else if (options.pacing == qrsdp::itch::ReplayPacing::FixedRate)
+            std::printf("  pacing=%.0f events/s\n", options.rate);
+        else
+            std::printf("  pacing=as fast as possible\n");
+
+        g_replayer = &replayer;
+        std::signal(SIGINT, signalHandler);
+        std::signal(SIGTERM, signalHandler);
+
+        const auto t0 = std::chrono::steady_clock::now();
+        const uint64_t events = replayer.run();
+        const double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        g_replayer = nullptr;
+        std::printf("replayed %llu events in %llu packets, %.3f s (%.0f events/s)\n",
+                    static_cast<unsigned long long>(events), static_cast<unsigned long long>(packets),
+                    secs, secs > 0.0 ? static_cast<double>(events) / secs : 0.0);
+    } catch (const std::exception& e) {
+        std::fprintf(stderr, "qrsdp_replay: %s\n", e.what());
+        return 1;
+    }
+    return 0;
+}
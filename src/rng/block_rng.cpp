@@ -0,0 +1,95 @@
+#include "rng/block_rng.h"
+#include <cmath>
+
+namespace qrsdp {
+
+namespace {
+
+/// Ziggurat tables for the standard exponential (Marsaglia & Tsang 2000, 256 layers).
+struct ExpZiggurat {
+    uint32_t ke[256];
+    double   we[256];
+    double   fe[256];
+
+    ExpZiggurat() {
+        const double m2 = 4294967296.0;
+        double de = 7.697117470131487;
+        double te = de;
+        const double ve = 3.949659822581572e-3;
+        const double q = ve / std::exp(-de);
+        ke[0] = static_cast<uint32_t>((de / q) * m2);
+        ke[1] = 0;
+        we[0] = q / m2;
+        we[255] = de / m2;
+        fe[0] = 1.0;
+        fe[255] = std::exp(-de);
+        for (int i = 254; i >= 1; --i) {
+            de = -std::log(ve / de + std::exp(-de));
+            ke[i + 1] = static_cast<uint32_t>((de / te) * m2);
+            te = de;
+            fe[i] = std::exp(-de);
+            we[i] = de / m2;
+        }
+    }
+};
+
+const ExpZiggurat kZig;
+
+constexpr double kZigR = 7.697117470131487;
+
+/// Uniform in (0, 1); never 0 so log() is safe.
+inline double openUniform(uint64_t x) {
+    return (static_cast<double>(x >> 11) + 0.5) * 0x1.0p-53;
+}
+
+}  // namespace
+
+// Layer index from the low 8 bits, magnitude from the high 32, so the two are
+// independent (Marsaglia's original reuses the same bits for both).
+double BlockRng::exponential() {
+    const uint64_t r = next64();
+    const uint32_t iz = static_cast<uint32_t>(r & 0xFF);
+    const uint32_t jz = static_cast<uint32_t>(r >> 32);
+    if (jz < kZig.ke[iz]) return jz * kZig.we[iz];
+    return exponentialSlow(r);
+}
+
+double BlockRng::exponentialSlow(uint64_t r) {
+    for (;;) {
+        const uint32_t iz = static_cast<uint32_t>(r & 0xFF);
+        const uint32_t jz = static_cast<uint32_t>(r >> 32);
+        if (iz == 0) return kZigR - std::log(openUniform(next64()));  // tail
+        const double x = jz * kZig.we[iz];
+        if (kZig.fe[iz] + openUniform(next64()) * (kZig.fe[iz - 1] - kZig.fe[iz]) < std::exp(-x))
+            return x;
+        r = next64();
+        const uint32_t iz2 = static_cast<uint32_t>(r & 0xFF);
+        const uint32_t jz2 = static_cast<uint32_t>(r >> 32);
+        if (jz2 < kZig.ke[iz2]) return jz2 * kZig.we[iz2];
+    }
+}
+
+bool BlockRng::seek(uint64_t p) {
+    skipBlocks(p / kBlockSize);
+    blocks_ = p / kBlockSize;
+    pos_ = kBlockSize;
+    if (p % kBlockSize != 0) {
+        refill();
+        pos_ = static_cast<size_t>(p % kBlockSize);
+    }
+    return true;
+}
+
+void BlockRng::skipBlocks(uint64_t blocks) {
+    for (uint64_t b = 0; b < blocks; ++b) generateBlock(block_, kBlockSize);
+}
+
+void BlockRng::fillUniform(double* out, size_t n) {
+    for (size_t i = 0; i < n; ++i) out[i] = toUniform(next64());
+}
+
+void BlockRng::fillExponential(double* out, size_t n) {
+    for (size_t i = 0; i < n; ++i) out[i] = exponential();
+}
+
+}  // namespace qrsdp
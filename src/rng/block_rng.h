@@ -0,0 +1,58 @@
+#pragma once
+
+#include "rng/irng.h"
+#include <cstddef>
+#include <cstdint>
+
+namespace qrsdp {
+
+/// Base for generators that produce raw 64-bit words a block at a time.
+/// Keeps kBlockSize words buffered; uniform(), exponential() and the fill*()
+/// block calls all consume that single buffered stream in order, so results are
+/// a pure function of the seed and the sequence of calls.
+class BlockRng : public IRng {
+public:
+    static constexpr size_t kBlockSize = 256;
+
+    double uniform() override { return toUniform(next64()); }
+    /// Ziggurat (Marsaglia–Tsang, 256 layers); no log() on ~99% of draws.
+    double exponential() override;
+    void fillUniform(double* out, size_t n) override;
+    void fillExponential(double* out, size_t n) override;
+
+    uint64_t next64() {
+        if (pos_ == kBlockSize) refill();
+        return block_[pos_++];
+    }
+
+    /// Raw words drawn since seed(), buffered ones excluded.
+    uint64_t position() const override { return blocks_ * kBlockSize + pos_ - kBlockSize; }
+    bool seek(uint64_t p) override;
+
+protected:
+    /// Generate the next n raw words of the stream (n == kBlockSize).
+    virtual void generateBlock(uint64_t* out, size_t n) = 0;
+    /// Advances the stream past the next `blocks` blocks. Default: generates and
+    /// drops them; counter-based generators jump.
+    virtual void skipBlocks(uint64_t blocks);
+    /// Drop buffered words; call from seed() so the next draw starts the new stream.
+    void resetBuffer() {
+        pos_ = kBlockSize;
+        blocks_ = 0;
+    }
+
+private:
+    static double toUniform(uint64_t x) { return static_cast<double>(x >> 11) * 0x1.0p-53; }
+    void refill() {
+        generateBlock(block_, kBlockSize);
+        pos_ = 0;
+        ++blocks_;
+    }
+    double exponentialSlow(uint64_t r);
+
+    uint64_t block_[kBlockSize];
+    size_t pos_ = kBlockSize;
+    uint64_t blocks_ = 0;  // blocks generated or skipped since seed()
+};
+
+}  // namespace qrsdp
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cmath>
+#include <cstddef>
 #include <cstdint>
 
 namespace qrsdp {
@@ -12,6 +14,33 @@ public:
     virtual double uniform() = 0;
     /// Reseed (e.g. per session).
     virtual void seed(uint64_t s) = 0;
+
+    /// Raw generator outputs drawn since the last seed(). With seek() this puts a
+    /// reseeded generator back at the same point of its stream (book checkpoints
+    /// store it). Default: 0, not tracked.
+    virtual uint64_t position() const { return 0; }
+    /// Right after seed(): moves to position p of the new stream, as if p outputs
+    /// had been drawn. Default: false (cannot) unless p is 0.
+    virtual bool seek(uint64_t p) { return p == 0; }
+
+    /// Standard exponential (mean 1). Default: −ln(U) on one uniform with U clamped
+    /// to [1e-10, 1), i.e. exactly what the samplers computed inline before this
+    /// hook existed, so legacy streams are unchanged. Block RNGs use a ziggurat.
+    virtual double exponential() {
+        constexpr double kMinU = 1e-10;
+        double u = uniform();
+        if (u <= 0.0 || u >= 1.0) u = kMinU;
+        if (u < kMinU) u = kMinU;
+        return -std::log(u);
+    }
+
+    /// Block API: n draws into out; same values as n single calls.
+    virtual void fillUniform(double* out, size_t n) {
+        for (size_t i = 0; i < n; ++i) out[i] = uniform();
+    }
+    virtual void fillExponential(double* out, size_t n) {
+        for (size_t i = 0; i < n; ++i) out[i] = exponential();
+    }
 };
 
 }  // namespace qrsdp
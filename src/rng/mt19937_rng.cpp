@@ -5,11 +5,19 @@ namespace qrsdp {
 Mt19937Rng::Mt19937Rng(uint64_t seed) : gen_(seed), dist_(0.0, 1.0) {}
 
 double Mt19937Rng::uniform() {
+    ++position_;
     return dist_(gen_);
 }
 
 void Mt19937Rng::seed(uint64_t s) {
     gen_.seed(s);
+    position_ = 0;
+}
+
+bool Mt19937Rng::seek(uint64_t p) {
+    gen_.discard(p);
+    position_ += p;
+    return true;
 }
 
 }  // namespace qrsdp
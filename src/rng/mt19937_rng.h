@@ -7,15 +7,19 @@
 namespace qrsdp {
 
 /// Deterministic RNG: std::mt19937_64 with uniform [0, 1).
-class Mt19937Rng : public IRng {
+class Mt19937Rng final : public IRng {
 public:
     explicit Mt19937Rng(uint64_t seed = 0);
     double uniform() override;
     void seed(uint64_t s) override;
+    /// One engine output per uniform(); seek() discards p outputs.
+    uint64_t position() const override { return position_; }
+    bool seek(uint64_t p) override;
 
 private:
     std::mt19937_64 gen_;
     std::uniform_real_distribution<double> dist_;
+    uint64_t position_ = 0;
 };
 
 }  // namespace qrsdp
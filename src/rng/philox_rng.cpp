@@ -0,0 +1,62 @@
+#include "rng/philox_rng.h"
+
+namespace qrsdp {
+
+namespace {
+
+constexpr uint32_t kM0 = 0xD2511F53u;
+constexpr uint32_t kM1 = 0xCD9E8D57u;
+constexpr uint32_t kW0 = 0x9E3779B9u;
+constexpr uint32_t kW1 = 0xBB67AE85u;
+constexpr int kRounds = 10;
+
+inline void round4x32(uint32_t& c0, uint32_t& c1, uint32_t& c2, uint32_t& c3,
+                      uint32_t k0, uint32_t k1) {
+    const uint64_t p0 = static_cast<uint64_t>(kM0) * c0;
+    const uint64_t p1 = static_cast<uint64_t>(kM1) * c2;
+    const uint32_t hi0 = static_cast<uint32_t>(p0 >> 32), lo0 = static_cast<uint32_t>(p0);
+    const uint32_t hi1 = static_cast<uint32_t>(p1 >> 32), lo1 = static_cast<uint32_t>(p1);
+    c0 = hi1 ^ c1 ^ k0;
+    c1 = lo1;
+    c2 = hi0 ^ c3 ^ k1;
+    c3 = lo0;
+}
+
+}  // namespace
+
+PhiloxRng::PhiloxRng(uint64_t s) { seed(s); }
+
+void PhiloxRng::seed(uint64_t s) {
+    key_ = {static_cast<uint32_t>(s), static_cast<uint32_t>(s >> 32)};
+    counter_ = 0;
+    resetBuffer();
+}
+
+PhiloxRng::Counter PhiloxRng::block(Counter ctr, Key key) {
+    uint32_t c0 = ctr[0], c1 = ctr[1], c2 = ctr[2], c3 = ctr[3];
+    uint32_t k0 = key[0], k1 = key[1];
+    for (int r = 0; r < kRounds; ++r) {
+        if (r > 0) {
+            k0 += kW0;
+            k1 += kW1;
+        }
+        round4x32(c0, c1, c2, c3, k0, k1);
+    }
+    return {c0, c1, c2, c3};
+}
+
+void PhiloxRng::generateBlock(uint64_t* out, size_t n) {
+    // Two 64-bit words per counter; each iteration is independent.
+    const size_t counters = n / 2;
+    const uint64_t base = counter_;
+    for (size_t i = 0; i < counters; ++i) {
+        const uint64_t c = base + i;
+        const Counter r = block({static_cast<uint32_t>(c), static_cast<uint32_t>(c >> 32), 0u, 0u},
+                                key_);
+        out[2 * i]     = (static_cast<uint64_t>(r[1]) << 32) | r[0];
+        out[2 * i + 1] = (static_cast<uint64_t>(r[3]) << 32) | r[2];
+    }
+    counter_ = base + counters;
+}
+
+}  // namespace qrsdp
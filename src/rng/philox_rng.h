@@ -0,0 +1,36 @@
+#pragma once
+
+#include "rng/block_rng.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace qrsdp {
+
+/// Philox4x32-10 (Salmon et al., "Parallel random numbers: as easy as 1, 2, 3").
+/// Counter-based: output block i is a pure function of (key, counter i), so any
+/// position of any stream can be computed directly. seed(s) sets the 64-bit key
+/// and rewinds the counter; blocks have no loop-carried state, so generateBlock()
+/// vectorises across counters where the target has SIMD.
+class PhiloxRng final : public BlockRng {
+public:
+    using Counter = std::array<uint32_t, 4>;
+    using Key = std::array<uint32_t, 2>;
+
+    explicit PhiloxRng(uint64_t seed = 0);
+    void seed(uint64_t s) override;
+
+    /// The Philox4x32-10 bijection on one counter.
+    static Counter block(Counter ctr, Key key);
+
+protected:
+    void generateBlock(uint64_t* out, size_t n) override;
+    /// O(1): moves the counter on (two words per counter).
+    void skipBlocks(uint64_t blocks) override { counter_ += blocks * (kBlockSize / 2); }
+
+private:
+    Key key_{};
+    uint64_t counter_ = 0;  // next counter (low 64 bits; high 64 bits are zero)
+};
+
+}  // namespace qrsdp
@@ -0,0 +1,65 @@
+#include "rng/poisson_sampler.h"
+#include <algorithm>
+#include <cmath>
+
+namespace qrsdp {
+
+void PoissonSampler::setMean(double mean) {
+    if (mean == mean_) return;
+    mean_ = mean;
+    cdf_.clear();
+    if (mean <= 0.0 || mean > 1e6) return;
+    if (mean < kTableMaxMean) {
+        // Same recurrence and order as the sequential search; stop once the sum can
+        // no longer grow (it saturates below or at 1.0).
+        double p = std::exp(-mean);
+        double s = p;
+        cdf_.push_back(s);
+        for (uint32_t k = 1;; ++k) {
+            p *= mean / static_cast<double>(k);
+            const double next = s + p;
+            if (next == s && static_cast<double>(k) > mean) break;
+            s = next;
+            cdf_.push_back(s);
+        }
+        return;
+    }
+    const double smu = std::sqrt(mean);
+    log_mean_ = std::log(mean);
+    b_ = 0.931 + 2.53 * smu;
+    a_ = -0.059 + 0.02483 * b_;
+    inv_alpha_ = 1.1239 + 1.1328 / (b_ - 3.4);
+    v_r_ = 0.9277 - 3.6224 / (b_ - 2.0);
+}
+
+uint32_t PoissonSampler::sample(IRng& rng) const {
+    if (mean_ <= 0.0) return 0;
+    if (mean_ > 1e6) return static_cast<uint32_t>(mean_);
+    return cdf_.empty() ? samplePtrs(rng) : sampleTable(rng);
+}
+
+uint32_t PoissonSampler::sampleTable(IRng& rng) const {
+    double u = rng.uniform();
+    if (u <= 0.0 || u >= 1.0) u = 0.5;
+    // First k with u <= cdf[k], i.e. where `while (u > s)` stops.
+    const auto it = std::lower_bound(cdf_.begin(), cdf_.end(), u);
+    if (it == cdf_.end()) return static_cast<uint32_t>(cdf_.size() - 1);
+    return static_cast<uint32_t>(it - cdf_.begin());
+}
+
+uint32_t PoissonSampler::samplePtrs(IRng& rng) const {
+    for (;;) {
+        const double u = rng.uniform() - 0.5;
+        const double v = rng.uniform();
+        const double us = 0.5 - std::fabs(u);
+        const double k = std::floor((2.0 * a_ / us + b_) * u + mean_ + 0.43);
+        if (us >= 0.07 && v <= v_r_) return static_cast<uint32_t>(k);
+        if (k < 0.0 || (us < 0.013 && v > us)) continue;
+        if (std::log(v) + std::log(inv_alpha_) - std::log(a_ / (us * us) + b_)
+            <= -mean_ + k * log_mean_ - std::lgamma(k + 1.0)) {
+            return static_cast<uint32_t>(k);
+        }
+    }
+}
+
+}  // namespace qrsdp
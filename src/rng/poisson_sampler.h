@@ -0,0 +1,42 @@
+#pragma once
+
+#include "rng/irng.h"
+#include <cstdint>
+#include <vector>
+
+namespace qrsdp {
+
+/// Poisson(mean) draws for a fixed mean, O(log mean) or better per draw.
+///
+/// mean < kTableMaxMean: inversion against a CDF table built once per mean. The
+/// table is accumulated exactly like the per-draw sequential search
+/// (p *= mean / k; s += p), so a draw returns the same k for the same uniform.
+/// The book's reinitialise streams are therefore bit-identical to the old
+/// sequential search, and a draw costs a binary search instead of O(mean).
+/// mean >= kTableMaxMean: Hörmann's PTRS transformed rejection (two uniforms per
+/// attempt, ~1.1 attempts per draw), where exp(-mean) would underflow the table.
+/// mean > 1e6 returns mean; mean <= 0 returns 0.
+class PoissonSampler {
+public:
+    static constexpr double kTableMaxMean = 700.0;
+
+    PoissonSampler() = default;
+    explicit PoissonSampler(double mean) { setMean(mean); }
+
+    /// Rebuilds the table only when the mean changes.
+    void setMean(double mean);
+    double mean() const { return mean_; }
+
+    uint32_t sample(IRng& rng) const;
+
+private:
+    uint32_t sampleTable(IRng& rng) const;
+    uint32_t samplePtrs(IRng& rng) const;
+
+    double mean_ = -1.0;
+    std::vector<double> cdf_;  // cdf_[k] = P(X <= k) as the sequential search sums it
+    // PTRS constants
+    double log_mean_ = 0.0, b_ = 0.0, a_ = 0.0, inv_alpha_ = 0.0, v_r_ = 0.0;
+};
+
+}  // namespace qrsdp
@@ -0,0 +1,37 @@
+#include "rng/rng_factory.h"
+#include "rng/mt19937_rng.h"
+#include "rng/philox_rng.h"
+#include "rng/xoshiro256pp_rng.h"
+
+namespace qrsdp {
+
+std::unique_ptr<IRng> makeRng(RngAlgorithm algorithm, uint64_t seed) {
+    switch (algorithm) {
+        case RngAlgorithm::XOSHIRO256PP: return std::make_unique<Xoshiro256ppRng>(seed);
+        case RngAlgorithm::PHILOX4X32:   return std::make_unique<PhiloxRng>(seed);
+        case RngAlgorithm::MT19937:      break;
+    }
+    return std::make_unique<Mt19937Rng>(seed);
+}
+
+const char* rngAlgorithmName(RngAlgorithm algorithm) {
+    switch (algorithm) {
+        case RngAlgorithm::MT19937:      return "mt19937";
+        case RngAlgorithm::XOSHIRO256PP: return "xoshiro256pp";
+        case RngAlgorithm::PHILOX4X32:   return "philox";
+    }
+    return "unknown";
+}
+
+bool parseRngAlgorithm(const std::string& name, RngAlgorithm& out) {
+    for (RngAlgorithm a : {RngAlgorithm::MT19937, RngAlgorithm::XOSHIRO256PP,
+                           RngAlgorithm::PHILOX4X32}) {
+        if (name == rngAlgorithmName(a)) {
+            out = a;
+            return true;
+        }
+    }
+    return false;
+}
+
+}  // namespace qrsdp
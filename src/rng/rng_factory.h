@@ -0,0 +1,19 @@
+#pragma once
+
+#include "core/records.h"
+#include "rng/irng.h"
+#include <memory>
+#include <string>
+
+namespace qrsdp {
+
+/// Heap-allocated generator of the given algorithm, seeded with seed.
+std::unique_ptr<IRng> makeRng(RngAlgorithm algorithm, uint64_t seed);
+
+/// "mt19937", "xoshiro256pp", "philox"; "unknown" for out-of-range values.
+const char* rngAlgorithmName(RngAlgorithm algorithm);
+
+/// Inverse of rngAlgorithmName. Returns false (out untouched) for unknown names.
+bool parseRngAlgorithm(const std::string& name, RngAlgorithm& out);
+
+}  // namespace qrsdp
@@ -0,0 +1,19 @@
+#include "rng/rng_stream.h"
+#include "rng/philox_rng.h"
+
+namespace qrsdp {
+
+namespace {
+
+constexpr uint32_t kStreamTag = 0x51525344u;  // "QRSD": separates these counters from PhiloxRng's
+
+}  // namespace
+
+uint64_t streamSeed(uint64_t base_seed, uint32_t security, uint32_t day) {
+    const PhiloxRng::Counter out = PhiloxRng::block(
+        {day, security, kStreamTag, 0u},
+        {static_cast<uint32_t>(base_seed), static_cast<uint32_t>(base_seed >> 32)});
+    return (static_cast<uint64_t>(out[1]) << 32) | out[0];
+}
+
+}  // namespace qrsdp
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <cstdint>
+
+namespace qrsdp {
+
+/// Counter-based session seed: Philox4x32-10 of counter (day, security, tag) under
+/// key base_seed. A pure function of its arguments, so any (security, day) seed can
+/// be computed directly, in any order, on any thread. Philox is a bijection on the
+/// 128-bit counter, but the seed keeps only 64 bits of the output block, so two
+/// distinct (security, day) pairs share a seed with probability about 2^-64: for
+/// n streams under one base seed, about n^2 / 2^65 (negligible for any real run,
+/// not impossible).
+uint64_t streamSeed(uint64_t base_seed, uint32_t security, uint32_t day);
+
+}  // namespace qrsdp
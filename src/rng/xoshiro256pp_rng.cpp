@@ -0,0 +1,44 @@
+#include "rng/xoshiro256pp_rng.h"
+
+namespace qrsdp {
+
+namespace {
+
+inline uint64_t rotl(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+
+}  // namespace
+
+uint64_t splitmix64(uint64_t& x) {
+    uint64_t z = (x += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+Xoshiro256ppRng::Xoshiro256ppRng(uint64_t s) { seed(s); }
+
+void Xoshiro256ppRng::seed(uint64_t s) {
+    uint64_t x = s;
+    for (auto& w : s_) w = splitmix64(x);
+    resetBuffer();
+}
+
+uint64_t Xoshiro256ppRng::step(uint64_t (&s)[4]) {
+    const uint64_t result = rotl(s[0] + s[3], 23) + s[0];
+    const uint64_t t = s[1] << 17;
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = rotl(s[3], 45);
+    return result;
+}
+
+void Xoshiro256ppRng::generateBlock(uint64_t* out, size_t n) {
+    uint64_t s[4] = {s_[0], s_[1], s_[2], s_[3]};
+    for (size_t i = 0; i < n; ++i) out[i] = step(s);
+    for (int k = 0; k < 4; ++k) s_[k] = s[k];
+}
+
+}  // namespace qrsdp
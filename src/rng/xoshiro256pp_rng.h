@@ -0,0 +1,29 @@
+#pragma once
+
+#include "rng/block_rng.h"
+#include <cstddef>
+#include <cstdint>
+
+namespace qrsdp {
+
+/// xoshiro256++ (Blackman & Vigna), state seeded with splitmix64. Small state and
+/// a few ALU ops per word; much cheaper than mt19937_64 + uniform_real_distribution.
+class Xoshiro256ppRng final : public BlockRng {
+public:
+    explicit Xoshiro256ppRng(uint64_t seed = 0);
+    void seed(uint64_t s) override;
+
+    /// Next raw word of the underlying (unbuffered) generator; exposed for tests.
+    static uint64_t step(uint64_t (&s)[4]);
+
+protected:
+    void generateBlock(uint64_t* out, size_t n) override;
+
+private:
+    uint64_t s_[4];
+};
+
+/// splitmix64 step: advances x and returns the next output.
+uint64_t splitmix64(uint64_t& x);
+
+}  // namespace qrsdp
@@ -1,9 +1,21 @@
 #include "producer/session_runner.h"
+#include "producer/run_coordinator.h"
+#include "core/metrics.h"
+#include "io/metrics_exporter.h"
+#include "producer/stage_profile.h"
+#include "rng/rng_factory.h"
+#include "io/hlr_curve_bundle.h"
+#include "io/io_uring_writer.h"
+#include "model/hawkes_params.h"
 #include "model/hlr_params.h"
+#include "model/hlr_params_watcher.h"
 
+#include <algorithm>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
+#include <memory>
+#include <stdexcept>
 #include <string>
 #include <vector>
 
@@ -17,12 +29,73 @@ static void printUsage(const char* prog) {
         "  --output <dir>      Output directory (default: output/run_<seed>)\n"
         "  --start-date <str>  First trading date (default: 2026-01-02)\n"
         "  --chunk-size <n>    Records per chunk (default: 4096)\n"
+        "  --write-buffers <n> Compress and write chunks on a background thread with n\n"
+        "                      rotating buffers (2 = double, 3 = triple; default: 0 = inline)\n"
+        "  --columnar          Write v1.1 columnar chunks (delta/varint columns, smaller files)\n"
+        "  --codec <c[:level]> Chunk codec: lz4[:accel] (default lz4:1), lz4hc[:1-12]\n"
+        "                      (default 9), zstd[:level], zstd-dict[:level] (dictionary\n"
+        "                      trained per file) or none\n"
+        "  --seek-stride <n>   Write a seek index (ts every n records, price range per chunk)\n"
+        "                      for exact range queries (default: 0 = none)\n"
+        "  --checkpoint-every <n> Write a book checkpoint every n chunks for mid-session\n"
+        "                      replay seeks (default: 0 = none)\n"
+        "  --sync-every <n>    fsync each day file and rewrite its <file>.idx sidecar index\n"
+        "                      every n chunks, so a crash loses at most n chunks (default: 0)\n"
+        "  --verify <mode>     Check each finished day: checksums (chunk CRC-32Cs against the\n"
+        "                      footer, no decoding; default), full (also decode every chunk)\n"
+        "                      or none (footer count only)\n"
+        "  --io-uring          Write day files through one io_uring shared by every sink\n"
+        "                      (Linux; falls back to stdio where unavailable)\n"
+        "  --direct-io         With --io-uring: open day files O_DIRECT (implies --io-uring)\n"
+        "  --bars <list>       OHLC bar resolutions in seconds, stored in each day file's footer\n"
+        "                      for cheap charting (default: 1,60,300; none = no bars)\n"
+        "  --resume            Continue an interrupted run in --output: keep finished days,\n"
+        "                      restart unfinished ones from their last synced checkpoint\n"
+        "                      (needs --checkpoint-every and --sync-every in both runs)\n"
+        "  --container <name>  Pack every day file into one <output>/<name> session container\n"
+        "                      (.qrsc: one file, one directory of (symbol, date) sessions)\n"
+        "  --arrow             Also write each day as <day>.arrow, an Arrow IPC file with one\n"
+        "                      record batch per chunk (for polars / DuckDB / pyarrow scans)\n"
+        "  --coordinator <port> Serve this run's (security, day-range) shards to --worker\n"
+        "                      processes on TCP port (0 = any) and merge their results\n"
+        "  --shard-days <n>    With --coordinator: days per shard (default: 0 = all of a security)\n"
+        "  --shard-timeout <s> With --coordinator: re-dispatch a shard not done in s seconds\n"
+        "                      (default: 0 = only when its worker fails or disconnects)\n"
+        "  --max-attempts <n>  With --coordinator: dispatches of a shard before the run fails (default: 3)\n"
+        "  --worker <h:p>      Run shards handed out by the coordinator at host:port, then exit\n"
+        "                      (pass the coordinator's run flags; --output is this node's path)\n"
+        "  --worker-name <s>   Name this worker reports to the coordinator (default: worker)\n"
         "  --perf-doc <path>   Write performance doc (default: <output>/performance-results.md)\n"
         "  --depth <n>         Initial depth per level (default: 5)\n"
         "  --levels <n>        Levels per side (default: 5)\n"
         "  --securities <spec> Comma-separated symbol:p0 pairs (e.g. AAPL:10000,MSFT:15000)\n"
-        "  --model <type>      Intensity model: simple (default) or hlr\n"
+        "  --model <type>      Intensity model: simple (default), hlr or hawkes (simple\n"
+        "                      plus self- and cross-excitation, see --hawkes)\n"
+        "  --rng <name>        Generator: mt19937 (default), xoshiro256pp or philox\n"
+        "  --seed-scheme <s>   Day seeds: counter (default) or sequential (legacy base+day)\n"
+        "  --threads <n>       Day-scheduler worker threads (default: 0 = all cores)\n"
+        "  --independent-days  Open each day from a seeded overnight gap, not the prior close,\n"
+        "                      so all days generate in parallel\n"
+        "  --overnight-sigma <f> Overnight gap stddev in ticks for --independent-days (default: 10)\n"
+        "  --workers <n>       Fixed workers, each interleaving its securities by sim time\n"
+        "                      (one Kafka producer per worker; default: 0 = day scheduler)\n"
+        "  --max-open-files <n> With --workers: cap on day files open at once (default: 0 = none)\n"
+        "  --order-book        Track individual orders (FIFO per level) so cancels and\n"
+        "                      executions reference the resting order's id\n"
+        "  --sampler <mode>    HLR level draw: fenwick (default) or linear (legacy streams)\n"
         "  --hlr-curves <file> Load HLR intensity curves from JSON (calibrated or hand-tuned)\n"
+        "  --hlr-bundle <file> Per-symbol HLR curves from a .qrhc bundle (qrsdp_calibrate\n"
+        "                      --bundle), mapped once and shared by every model; symbols\n"
+        "                      it lacks use --hlr-curves or the defaults\n"
+        "  --hlr-watch <file>  Hot-swap HLR curves whenever this JSON file changes (e.g. a\n"
+        "                      qrsdp_calibrate --kafka output); checked every second,\n"
+        "                      adopted between events. Runs are then not reproducible\n"
+        "  --hawkes <file>     Hawkes model from JSON, e.g. qrsdp_calibrate --hawkes output,\n"
+        "                      whose fitted mu then replaces the book-driven baseline\n"
+        "                      (\"baseline\": \"mu\"; default: built-in kernels on the\n"
+        "                      book; implies --model hawkes)\n"
+        "  --seasonality <file> Intraday multiplier buckets from JSON (default: from the\n"
+        "                      --hlr-curves file if it has them, else none)\n"
         "  --base-L <f>        Limit order base intensity (default: 22.0)\n"
         "  --base-C <f>        Cancel base intensity (default: 0.2)\n"
         "  --base-M <f>        Market order base intensity (default: 30.0)\n"
@@ -32,10 +105,46 @@ static void printUsage(const char* prog) {
         "  --spread-sens <f>   Spread-dependent feedback strength (default: 0.4)\n"
         "  --kafka-brokers <s> Kafka bootstrap servers (e.g. kafka:9092; empty = no Kafka)\n"
         "  --kafka-topic <s>   Kafka topic name (default: exchange.events)\n"
+        "  --kafka-batch <n>   Records per Kafka message behind a QRKB header (default: 1 = bare)\n"
+        "  --kafka-batch-ms <n> Send a part-filled Kafka batch after this many ms (default: 0 = when full)\n"
+        "  --kafka-profile <p> Producer tuning: balanced (default), throughput or latency\n"
+        "  --kafka-partitions <n> Send security i to partition i %% n (default: 0 = hash the symbol)\n"
+        "  --kafka-config <k=v> Extra librdkafka property, applied after the profile (repeatable)\n"
+        "  --kafka-async <p>   Feed Kafka from its own queue and thread so it never stalls the\n"
+        "                      file sink; when full: block, drop-oldest or drop-newest\n"
+        "  --kafka-queue <n>   Records queued for --kafka-async (default: 65536)\n"
+        "  --itch-multicast <g:p> Also stream live ITCH/MoldUDP64 to multicast group:port\n"
+        "  --itch-unicast <h:p> Also stream live ITCH/MoldUDP64 unicast to host:port\n"
+        "  --itch-batch <n>    Packets per sendmmsg batch for the live feed (default: 16)\n"
+        "  --itch-channels <spec> Shard the live feed over N sessions on port+c: N or N:SYM=c,...\n"
+        "  --itch-snapshot-port <p> Also send book snapshots for late joiners to port p (+c)\n"
+        "  --itch-snapshot-every <n> Records of a security between its snapshots (default: 100000)\n"
+        "  --live-frames <path> Publish book frames of the first security to a shared-memory\n"
+        "                      ring at path (e.g. /dev/shm/qrsdp_live) as they are generated\n"
+        "  --frame-ms <n>      Simulated milliseconds per live frame (default: 50)\n"
+        "  --shm-ring <path>   Publish every record to a shared-memory event bus at path\n"
+        "                      (e.g. /dev/shm/qrsdp_events) for same-host consumers\n"
+        "  --shm-ring-mb <n>   Size of the --shm-ring ring in MiB (default: 64)\n"
         "  --market-open <HH:MM> Market open time (default: 09:30)\n"
         "  --realtime          Pace events to simulated inter-arrival times\n"
         "  --speed <f>         Speed multiplier for real-time mode (default: 100.0)\n"
         "                      100 = 6.5h session in ~4 min; 1 = actual real time\n"
+        "  --pace-spin-us <n>  Real-time: spin for the last n us before an event is due (default: 100)\n"
+        "  --pace-window-us <n> Real-time: release events due within n us together (default: 50)\n"
+        "  --pin-cpu <n>       Real-time: pin pacing thread i (security or worker) to CPU n + i\n"
+        "  --pace-per-security Real-time: pace each security on its own thread instead of\n"
+        "                      releasing all securities in timestamp order from one clock\n"
+        "  --cpu-list <list>   Pin generation thread i (day scheduler, --workers, realtime\n"
+        "                      pacing) to the i-th CPU of list, e.g. 0-7,16-23 (not with --pin-cpu)\n"
+        "  --io-cpu-list <list> Run file-writer, Kafka and ITCH sender threads on these CPUs\n"
+        "  --numa-policy <p>   none (default), local (allocate on each thread's node) or\n"
+        "                      interleave (spread over the nodes in use); local without\n"
+        "                      --cpu-list places threads over all CPUs node by node\n"
+        "  --metrics-port <n>  Serve Prometheus metrics at http://<host>:n/metrics\n"
+        "  --metrics-json <path> Append a JSON line of metrics every interval (- = stdout)\n"
+        "  --metrics-interval-ms <n> Period of --metrics-json lines (default: 1000)\n"
+        "  --profile           Print per-stage cycle costs of event generation\n"
+        "                      (needs a -DQRSDP_STAGE_PROFILE=ON build)\n"
         "  --help              Show this help\n"
         "\n"
         "Use --days 0 for continuous mode (runs indefinitely until SIGTERM).\n",
@@ -94,6 +203,23 @@ static std::vector<qrsdp::SecurityConfig> parseSecurities(
     return result;
 }
 
+/// Comma-separated positive seconds, or "none" for no bars.
+static bool parseBarSeconds(const std::string& spec, std::vector<uint32_t>& out) {
+    out.clear();
+    if (spec == "none") return true;
+    size_t start = 0;
+    while (start <= spec.size()) {
+        const size_t comma = std::min(spec.find(',', start), spec.size());
+        const std::string item = spec.substr(start, comma - start);
+        char* end = nullptr;
+        const unsigned long v = std::strtoul(item.c_str(), &end, 10);
+        if (item.empty() || *end != '\0' || v == 0 || v > 86400) return false;
+        out.push_back(static_cast<uint32_t>(v));
+        start = comma + 1;
+    }
+    return true;
+}
+
 int main(int argc, char* argv[]) {
     uint64_t seed = 42;
     uint32_t days = 5;
@@ -102,17 +228,63 @@ int main(int argc, char* argv[]) {
     std::string output_dir;
     std::string start_date = "2026-01-02";
     uint32_t chunk_size = 0;
+    uint32_t write_buffers = 0;
+    bool columnar = false;
+    std::string codec_str = "lz4";
+    uint32_t seek_stride = 0;
+    uint32_t checkpoint_every = 0;
+    uint32_t sync_every = 0;
+    std::string verify_str = "checksums";
+    bool io_uring = false;
+    bool direct_io = false;
+    std::string bars_str = "1,60,300";
+    bool resume = false;
+    std::string container;
+    bool arrow = false;
     std::string perf_doc;
+    int coordinator_port = -1;
+    qrsdp::CoordinatorOptions coordinator_options;
+    std::string worker_address;
+    std::string worker_name = "worker";
     uint32_t depth = 5;
     uint32_t levels = 5;
     std::string securities_spec;
     std::string model_str = "simple";
+    std::string sampler_str = "fenwick";
+    std::string rng_str = "mt19937";
+    std::string seed_scheme_str = "counter";
     std::string hlr_curves_path;
+    std::string hlr_watch_path;
+    std::string hlr_bundle_path;
+    std::string seasonality_path;
+    std::string hawkes_path;
     std::string kafka_brokers;
     std::string kafka_topic = "exchange.events";
+    qrsdp::KafkaSinkOptions kafka_options;
+    std::string kafka_profile_str = "balanced";
+    std::string kafka_async_str;
+    qrsdp::AsyncSinkOptions kafka_queue;
+    qrsdp::itch::ItchLiveConfig itch_live;
+    qrsdp::LiveFramesConfig live_frames;
+    qrsdp::ShmRingConfig shm_ring;
     uint32_t market_open_seconds = qrsdp::kDefaultMarketOpenSeconds;
     bool realtime = false;
     double speed = 100.0;
+    uint32_t pace_spin_us = 100;
+    uint32_t pace_window_us = 50;
+    int pin_cpu = -1;
+    bool pace_per_security = false;
+    std::string cpu_list_str;
+    std::string io_cpu_list_str;
+    std::string numa_policy_str = "none";
+    qrsdp::MetricsExportOptions metrics_export;
+    bool profile = false;
+    uint32_t threads = 0;
+    bool independent_days = false;
+    double overnight_sigma = 10.0;
+    uint32_t workers = 0;
+    uint32_t max_open_files = 0;
+    bool order_book = false;
     double base_L = 20.0;
     double base_C = 0.5;
     double base_M = 15.0;
@@ -138,17 +310,119 @@ int main(int argc, char* argv[]) {
         else if (std::strcmp(arg, "--output") == 0)  output_dir = next();
         else if (std::strcmp(arg, "--start-date") == 0) start_date = next();
         else if (std::strcmp(arg, "--chunk-size") == 0)  chunk_size = static_cast<uint32_t>(std::atoi(next()));
+        else if (std::strcmp(arg, "--write-buffers") == 0) write_buffers = static_cast<uint32_t>(std::atoi(next()));
+        else if (std::strcmp(arg, "--columnar") == 0)  columnar = true;
+        else if (std::strcmp(arg, "--codec") == 0)     codec_str = next();
+        else if (std::strcmp(arg, "--seek-stride") == 0) seek_stride = static_cast<uint32_t>(std::atoi(next()));
+        else if (std::strcmp(arg, "--checkpoint-every") == 0) checkpoint_every = static_cast<uint32_t>(std::atoi(next()));
+        else if (std::strcmp(arg, "--sync-every") == 0) sync_every = static_cast<uint32_t>(std::atoi(next()));
+        else if (std::strcmp(arg, "--verify") == 0)      verify_str = next();
+        else if (std::strcmp(arg, "--io-uring") == 0)    io_uring = true;
+        else if (std::strcmp(arg, "--direct-io") == 0)   io_uring = direct_io = true;
+        else if (std::strcmp(arg, "--bars") == 0)        bars_str = next();
+        else if (std::strcmp(arg, "--resume") == 0)      resume = true;
+        else if (std::strcmp(arg, "--container") == 0)   container = next();
+        else if (std::strcmp(arg, "--arrow") == 0)       arrow = true;
         else if (std::strcmp(arg, "--perf-doc") == 0)    perf_doc = next();
+        else if (std::strcmp(arg, "--coordinator") == 0) coordinator_port = std::atoi(next());
+        else if (std::strcmp(arg, "--shard-days") == 0)  coordinator_options.days_per_shard = static_cast<uint32_t>(std::atoi(next()));
+        else if (std::strcmp(arg, "--shard-timeout") == 0) coordinator_options.shard_timeout_s = static_cast<uint32_t>(std::atoi(next()));
+        else if (std::strcmp(arg, "--max-attempts") == 0) coordinator_options.max_attempts = static_cast<uint32_t>(std::atoi(next()));
+        else if (std::strcmp(arg, "--worker") == 0)      worker_address = next();
+        else if (std::strcmp(arg, "--worker-name") == 0) worker_name = next();
         else if (std::strcmp(arg, "--depth") == 0)   depth = static_cast<uint32_t>(std::atoi(next()));
         else if (std::strcmp(arg, "--levels") == 0)  levels = static_cast<uint32_t>(std::atoi(next()));
         else if (std::strcmp(arg, "--securities") == 0) securities_spec = next();
         else if (std::strcmp(arg, "--model") == 0)      model_str = next();
+        else if (std::strcmp(arg, "--sampler") == 0)    sampler_str = next();
+        else if (std::strcmp(arg, "--rng") == 0)        rng_str = next();
+        else if (std::strcmp(arg, "--seed-scheme") == 0) seed_scheme_str = next();
+        else if (std::strcmp(arg, "--threads") == 0)    threads = static_cast<uint32_t>(std::atoi(next()));
+        else if (std::strcmp(arg, "--independent-days") == 0) independent_days = true;
+        else if (std::strcmp(arg, "--overnight-sigma") == 0)  overnight_sigma = std::atof(next());
+        else if (std::strcmp(arg, "--workers") == 0)    workers = static_cast<uint32_t>(std::atoi(next()));
+        else if (std::strcmp(arg, "--max-open-files") == 0) max_open_files = static_cast<uint32_t>(std::atoi(next()));
+        else if (std::strcmp(arg, "--order-book") == 0) order_book = true;
         else if (std::strcmp(arg, "--hlr-curves") == 0) hlr_curves_path = next();
+        else if (std::strcmp(arg, "--hlr-watch") == 0) hlr_watch_path = next();
+        else if (std::strcmp(arg, "--hlr-bundle") == 0) hlr_bundle_path = next();
+        else if (std::strcmp(arg, "--seasonality") == 0) seasonality_path = next();
+        else if (std::strcmp(arg, "--hawkes") == 0) hawkes_path = next();
         else if (std::strcmp(arg, "--kafka-brokers") == 0) kafka_brokers = next();
         else if (std::strcmp(arg, "--kafka-topic") == 0)   kafka_topic = next();
+        else if (std::strcmp(arg, "--kafka-batch") == 0)   kafka_options.batch.max_records = static_cast<uint32_t>(std::atoi(next()));
+        else if (std::strcmp(arg, "--kafka-batch-ms") == 0) kafka_options.batch.max_delay_ms = static_cast<uint32_t>(std::atoi(next()));
+        else if (std::strcmp(arg, "--kafka-profile") == 0) kafka_profile_str = next();
+        else if (std::strcmp(arg, "--kafka-async") == 0) kafka_async_str = next();
+        else if (std::strcmp(arg, "--kafka-queue") == 0) kafka_queue.queue_records = static_cast<size_t>(std::atol(next()));
+        else if (std::strcmp(arg, "--kafka-partitions") == 0) kafka_options.partitions = static_cast<uint32_t>(std::atoi(next()));
+        else if (std::strcmp(arg, "--kafka-config") == 0) {
+            std::pair<std::string, std::string> kv;
+            if (!qrsdp::parseKafkaConfigEntry(next(), kv)) {
+                std::fprintf(stderr, "--kafka-config expects key=value\n");
+                return 1;
+            }
+            kafka_options.extra_config.push_back(std::move(kv));
+        }
+        else if (std::strcmp(arg, "--itch-multicast") == 0) {
+            const std::string dest = next();
+            const auto colon = dest.rfind(':');
+            if (colon == std::string::npos || colon == 0) {
+                std::fprintf(stderr, "--itch-multicast expects group:port\n");
+                return 1;
+            }
+            itch_live.enabled = true;
+            itch_live.multicast_group = dest.substr(0, colon);
+            itch_live.port = static_cast<uint16_t>(std::atoi(dest.c_str() + colon + 1));
+        }
+        else if (std::strcmp(arg, "--itch-unicast") == 0) {
+            itch_live.enabled = true;
+            itch_live.unicast_dest = next();
+        }
+        else if (std::strcmp(arg, "--itch-batch") == 0) itch_live.batch_packets = static_cast<size_t>(std::atoi(next()));
+        else if (std::strcmp(arg, "--itch-snapshot-port") == 0) itch_live.snapshot_port = static_cast<uint16_t>(std::atoi(next()));
+        else if (std::strcmp(arg, "--itch-snapshot-every") == 0) itch_live.snapshot_records = static_cast<uint32_t>(std::atol(next()));
+        else if (std::strcmp(arg, "--itch-channels") == 0) {
+            if (!qrsdp::itch::parseChannelMap(next(), itch_live.channels)) {
+                std::fprintf(stderr, "--itch-channels expects N or N:SYM=c,... with 1 <= N <= 64\n");
+                return 1;
+            }
+        }
+        else if (std::strcmp(arg, "--live-frames") == 0) live_frames.path = next();
+        else if (std::strcmp(arg, "--frame-ms") == 0) {
+            const long ms = std::atol(next());
+            if (ms <= 0) {
+                std::fprintf(stderr, "--frame-ms must be > 0\n");
+                return 1;
+            }
+            live_frames.frame_interval_ns = static_cast<uint64_t>(ms) * 1'000'000ULL;
+        }
+        else if (std::strcmp(arg, "--shm-ring") == 0) shm_ring.path = next();
+        else if (std::strcmp(arg, "--shm-ring-mb") == 0) {
+            const int mb = std::atoi(next());
+            if (mb <= 0) {
+                std::fprintf(stderr, "--shm-ring-mb must be > 0\n");
+                return 1;
+            }
+            shm_ring.ring_bytes = static_cast<size_t>(mb) << 20;
+        }
         else if (std::strcmp(arg, "--market-open") == 0) market_open_seconds = parseMarketOpen(next());
         else if (std::strcmp(arg, "--realtime") == 0)       realtime = true;
         else if (std::strcmp(arg, "--speed") == 0)          speed = std::atof(next());
+        else if (std::strcmp(arg, "--pace-spin-us") == 0)   pace_spin_us = static_cast<uint32_t>(std::atoi(next()));
+        else if (std::strcmp(arg, "--pace-window-us") == 0) pace_window_us = static_cast<uint32_t>(std::atoi(next()));
+        else if (std::strcmp(arg, "--pin-cpu") == 0)        pin_cpu = std::atoi(next());
+        else if (std::strcmp(arg, "--cpu-list") == 0)      cpu_list_str = next();
+        else if (std::strcmp(arg, "--io-cpu-list") == 0)   io_cpu_list_str = next();
+        else if (std::strcmp(arg, "--numa-policy") == 0)   numa_policy_str = next();
+        else if (std::strcmp(arg, "--pace-per-security") == 0) pace_per_security = true;
+        else if (std::strcmp(arg, "--metrics-port") == 0) {
+            metrics_export.http = true;
+            metrics_export.http_port = static_cast<uint16_t>(std::atoi(next()));
+        }
+        else if (std::strcmp(arg, "--metrics-json") == 0) metrics_export.json_path = next();
+        else if (std::strcmp(arg, "--metrics-interval-ms") == 0) metrics_export.interval_ms = static_cast<uint32_t>(std::atoi(next()));
+        else if (std::strcmp(arg, "--profile") == 0)        profile = true;
         else if (std::strcmp(arg, "--base-L") == 0)     base_L = std::atof(next());
         else if (std::strcmp(arg, "--base-C") == 0)     base_C = std::atof(next());
         else if (std::strcmp(arg, "--base-M") == 0)     base_M = std::atof(next());
@@ -166,6 +440,70 @@ int main(int argc, char* argv[]) {
         }
     }
 
+#ifndef QRSDP_STAGE_PROFILE
+    if (profile) {
+        std::fprintf(stderr, "--profile needs a build with -DQRSDP_STAGE_PROFILE=ON\n");
+        return 1;
+    }
+#endif
+    if (resume && workers > 0) {
+        std::fprintf(stderr, "--resume is not supported with --workers\n");
+        return 1;
+    }
+    if (resume && !container.empty()) {
+        std::fprintf(stderr, "--resume is not supported with --container\n");
+        return 1;
+    }
+    if (resume && arrow) {
+        std::fprintf(stderr, "--resume is not supported with --arrow\n");
+        return 1;
+    }
+    if (!live_frames.path.empty() && (workers > 0 || resume)) {
+        std::fprintf(stderr, "--live-frames is not supported with --workers or --resume\n");
+        return 1;
+    }
+    if (coordinator_port >= 0 && !worker_address.empty()) {
+        std::fprintf(stderr, "--coordinator and --worker are mutually exclusive\n");
+        return 1;
+    }
+    if (coordinator_port > 65535) {
+        std::fprintf(stderr, "--coordinator expects a port in 0..65535\n");
+        return 1;
+    }
+    coordinator_options.port = static_cast<uint16_t>(coordinator_port < 0 ? 0 : coordinator_port);
+
+    qrsdp::ThreadPlacement placement;
+    if (!qrsdp::parseNumaPolicy(numa_policy_str, placement.numa)) {
+        std::fprintf(stderr, "unknown --numa-policy: %s (use none, local or interleave)\n",
+                     numa_policy_str.c_str());
+        return 1;
+    }
+    try {
+        if (!cpu_list_str.empty()) placement.cpus = qrsdp::parseCpuList(cpu_list_str);
+        if (!io_cpu_list_str.empty()) placement.io_cpus = qrsdp::parseCpuList(io_cpu_list_str);
+    } catch (const std::invalid_argument& e) {
+        std::fprintf(stderr, "%s\n", e.what());
+        return 1;
+    }
+    for (int cpu : placement.io_cpus) {
+        if (std::find(placement.cpus.begin(), placement.cpus.end(), cpu) != placement.cpus.end()) {
+            std::fprintf(stderr, "--cpu-list and --io-cpu-list share CPU %d\n", cpu);
+            return 1;
+        }
+    }
+    if (placement.numa == qrsdp::NumaPolicy::LOCAL) {
+        if (placement.cpus.empty()) {
+            for (int cpu : qrsdp::onlineCpus())
+                if (std::find(placement.io_cpus.begin(), placement.io_cpus.end(), cpu) == placement.io_cpus.end())
+                    placement.cpus.push_back(cpu);
+        }
+        placement.cpus = qrsdp::cpusByNode(placement.cpus);
+    }
+    if (!placement.cpus.empty() && pin_cpu >= 0) {
+        std::fprintf(stderr, "--pin-cpu and --cpu-list both pin the pacing threads; use one\n");
+        return 1;
+    }
+
     if (output_dir.empty()) {
         output_dir = "output/run_" + std::to_string(seed);
     }
@@ -176,8 +514,72 @@ int main(int argc, char* argv[]) {
     qrsdp::ModelType model_type = qrsdp::ModelType::SIMPLE;
     if (model_str == "hlr") {
         model_type = qrsdp::ModelType::HLR;
+    } else if (model_str == "hawkes") {
+        model_type = qrsdp::ModelType::HAWKES;
     } else if (model_str != "simple") {
-        std::fprintf(stderr, "unknown model type: %s (use 'simple' or 'hlr')\n", model_str.c_str());
+        std::fprintf(stderr, "unknown model type: %s (use 'simple', 'hlr' or 'hawkes')\n", model_str.c_str());
+        return 1;
+    }
+
+    qrsdp::SelectionMode selection_mode = qrsdp::SelectionMode::FENWICK;
+    if (sampler_str == "linear") {
+        selection_mode = qrsdp::SelectionMode::LINEAR;
+    } else if (sampler_str != "fenwick") {
+        std::fprintf(stderr, "unknown sampler: %s (use 'fenwick' or 'linear')\n", sampler_str.c_str());
+        return 1;
+    }
+
+    qrsdp::RngAlgorithm rng_algorithm = qrsdp::RngAlgorithm::MT19937;
+    if (!qrsdp::parseRngAlgorithm(rng_str, rng_algorithm)) {
+        std::fprintf(stderr, "unknown rng: %s (use 'mt19937', 'xoshiro256pp' or 'philox')\n",
+                     rng_str.c_str());
+        return 1;
+    }
+
+    if (!qrsdp::parseKafkaProfile(kafka_profile_str, kafka_options.profile)) {
+        std::fprintf(stderr, "unknown kafka profile: %s (use 'balanced', 'throughput' or 'latency')\n",
+                     kafka_profile_str.c_str());
+        return 1;
+    }
+
+    if (!kafka_async_str.empty() && !qrsdp::parseOverflowPolicy(kafka_async_str, kafka_queue.policy)) {
+        std::fprintf(stderr, "unknown --kafka-async policy: %s (use 'block', 'drop-oldest' or 'drop-newest')\n",
+                     kafka_async_str.c_str());
+        return 1;
+    }
+
+    qrsdp::CodecConfig codec;
+    if (!qrsdp::parseCodecSpec(codec_str, codec)) {
+        std::fprintf(stderr, "unknown codec: %s (use 'lz4[:accel]', 'lz4hc[:level]', 'zstd[:level]', "
+                             "'zstd-dict[:level]' or 'none')\n", codec_str.c_str());
+        return 1;
+    }
+    if (!qrsdp::codecAvailable(codec.codec)) {
+        std::fprintf(stderr, "codec %s not available: rebuild with -DBUILD_ZSTD_SUPPORT=ON\n",
+                     codec_str.c_str());
+        return 1;
+    }
+
+    qrsdp::VerifyMode verify;
+    if (!qrsdp::parseVerifyMode(verify_str, verify)) {
+        std::fprintf(stderr, "unknown verify mode: %s (use 'checksums', 'full' or 'none')\n",
+                     verify_str.c_str());
+        return 1;
+    }
+
+    std::vector<uint32_t> bar_seconds;
+    if (!parseBarSeconds(bars_str, bar_seconds)) {
+        std::fprintf(stderr, "--bars expects comma-separated seconds (1..86400) or none, got %s\n",
+                     bars_str.c_str());
+        return 1;
+    }
+
+    qrsdp::SeedScheme seed_scheme = qrsdp::SeedScheme::COUNTER;
+    if (seed_scheme_str == "sequential") {
+        seed_scheme = qrsdp::SeedScheme::SEQUENTIAL;
+    } else if (seed_scheme_str != "counter") {
+        std::fprintf(stderr, "unknown seed scheme: %s (use 'counter' or 'sequential')\n",
+                     seed_scheme_str.c_str());
         return 1;
     }
 
@@ -194,6 +596,54 @@ int main(int argc, char* argv[]) {
         }
     }
 
+    std::shared_ptr<const qrsdp::HLRCurveBundle> hlr_bundle;
+    if (!hlr_bundle_path.empty()) {
+        try {
+            hlr_bundle = std::make_shared<const qrsdp::HLRCurveBundle>(hlr_bundle_path);
+        } catch (const std::exception& e) {
+            std::fprintf(stderr, "error: %s\n", e.what());
+            return 1;
+        }
+        std::printf("Mapped HLR curve bundle %s (%zu symbols)\n", hlr_bundle_path.c_str(),
+                    hlr_bundle->size());
+        if (model_type != qrsdp::ModelType::HLR) {
+            std::printf("  (auto-switching to --model hlr)\n");
+            model_type = qrsdp::ModelType::HLR;
+        }
+    }
+
+    if (!hlr_watch_path.empty() && model_type != qrsdp::ModelType::HLR) {
+        std::printf("  (--hlr-watch: auto-switching to --model hlr)\n");
+        model_type = qrsdp::ModelType::HLR;
+    }
+
+    qrsdp::HawkesParams hawkes = qrsdp::makeDefaultHawkesParams();
+    if (!hawkes_path.empty()) {
+        if (!qrsdp::loadHawkesParamsFromJson(hawkes_path, hawkes)) {
+            std::fprintf(stderr, "error: failed to load Hawkes kernels from %s\n", hawkes_path.c_str());
+            return 1;
+        }
+        std::printf("Loaded Hawkes kernels from %s (%zu kernel(s), branching ratio %.3f, %s baseline)\n",
+                    hawkes_path.c_str(), hawkes.kernels.size(), qrsdp::hawkesBranchingRatio(hawkes),
+                    hawkes.baseline == qrsdp::HawkesBaseline::MU ? "fitted mu" : "book-driven");
+        if (model_type == qrsdp::ModelType::SIMPLE) {
+            std::printf("  (auto-switching to --model hawkes)\n");
+            model_type = qrsdp::ModelType::HAWKES;
+        }
+    }
+
+    qrsdp::SeasonalityProfile seasonality = hlr_params.seasonality;
+    if (!seasonality_path.empty()) {
+        if (!qrsdp::loadSeasonalityFromJson(seasonality_path, seasonality)) {
+            std::fprintf(stderr, "error: failed to load seasonality from %s\n", seasonality_path.c_str());
+            return 1;
+        }
+    }
+    if (!seasonality.empty()) {
+        std::printf("Seasonality: %zu buckets of %.0fs\n", seasonality.buckets(),
+                    seasonality.bucketSeconds());
+    }
+
     char run_id[64];
     std::snprintf(run_id, sizeof(run_id), "run_%llu", (unsigned long long)seed);
 
@@ -210,15 +660,49 @@ int main(int argc, char* argv[]) {
     config.intensity_params = {base_L, base_C, base_M, imbalance_sens, cancel_sens, epsilon_exec, spread_sens};
     config.model_type = model_type;
     config.hlr_params = std::move(hlr_params);
+    config.hlr_bundle = hlr_bundle;
+    config.hawkes = std::move(hawkes);
+    config.selection_mode = selection_mode;
+    config.rng = rng_algorithm;
+    config.seed_scheme = seed_scheme;
     config.num_days = days;
     config.chunk_capacity = chunk_size;
+    config.write_buffers = write_buffers;
+    config.columnar = columnar;
+    config.codec = codec;
+    config.seek_stride = seek_stride;
+    config.checkpoint_interval = checkpoint_every;
+    config.sync_interval = sync_every;
+    config.verify = verify;
+    config.bar_seconds = bar_seconds;
+    config.resume = resume;
+    config.container = container;
+    config.arrow = arrow;
     config.start_date = start_date;
 
     config.market_open_seconds = market_open_seconds;
     config.kafka_brokers = kafka_brokers;
     config.kafka_topic = kafka_topic;
+    config.kafka = kafka_options;
+    config.kafka_async = !kafka_async_str.empty();
+    config.kafka_queue = kafka_queue;
+    config.itch_live = itch_live;
+    config.live_frames = live_frames;
+    config.shm_ring = shm_ring;
     config.realtime = realtime;
     config.speed = speed;
+    config.pace_spin_us = pace_spin_us;
+    config.pace_window_us = pace_window_us;
+    config.pace_cpu = pin_cpu;
+    config.pace_per_security = pace_per_security;
+    config.placement = placement;
+    config.threads = threads;
+    config.independent_days = independent_days;
+    config.overnight_sigma_ticks = overnight_sigma;
+    config.workers = workers;
+    config.max_open_files = max_open_files;
+    config.order_book = order_book;
+    config.seasonality = std::move(seasonality);
 
     if (!securities_spec.empty()) {
         config.securities = parseSecurities(
@@ -228,25 +712,71 @@ int main(int argc, char* argv[]) {
             config.intensity_params, config.queue_reactive,
             config.model_type);
     }
+    if (config.live_frames.enabled() && realtime && config.securities.size() > 1 && !pace_per_security
+        && !config.kafka_async) {
+        std::fprintf(stderr, "--live-frames with several --realtime securities needs --pace-per-security\n");
+        return 1;
+    }
 
-    const char* model_label = (config.model_type == qrsdp::ModelType::HLR) ? "hlr" : "simple";
+    const char* model_label = qrsdp::modelTypeName(config.model_type);
     std::printf("=== qrsdp_run ===\n");
     std::printf("seed=%llu  days=%u  seconds=%u  p0=%d  model=%s  output=%s\n",
                 (unsigned long long)seed, days, seconds, p0, model_label, output_dir.c_str());
-    if (config.model_type == qrsdp::ModelType::SIMPLE) {
+    if (config.model_type != qrsdp::ModelType::HLR) {
         std::printf("intensity: base_L=%.1f  base_C=%.2f  base_M=%.1f  "
                     "imb_sens=%.2f  cancel_sens=%.2f  eps_exec=%.2f  spread_sens=%.2f\n",
                     base_L, base_C, base_M, imbalance_sens, cancel_sens, epsilon_exec, spread_sens);
     }
+    if (config.model_type == qrsdp::ModelType::HAWKES) {
+        std::printf("hawkes: %zu kernel(s), branching ratio %.3f, %s baseline\n",
+                    config.hawkes.kernels.size(), qrsdp::hawkesBranchingRatio(config.hawkes),
+                    config.hawkes.baseline == qrsdp::HawkesBaseline::MU ? "mu" : "book");
+    }
     if (!config.securities.empty()) {
         std::printf("securities:");
         for (const auto& s : config.securities)
             std::printf(" %s:%d", s.symbol.c_str(), s.p0_ticks);
         std::printf("\n");
     }
+    if (config.placement.enabled())
+        std::printf("placement: %s\n", config.placement.describe().c_str());
+    if (config.hlr_bundle) {
+        qrsdp::SecurityConfig single{};
+        const std::vector<qrsdp::SecurityConfig> secs =
+            config.securities.empty() ? std::vector<qrsdp::SecurityConfig>{single} : config.securities;
+        size_t missing = 0;
+        for (const auto& s : secs) {
+            if (qrsdp::SessionRunner::hlrBundleEntry(config, s)) continue;
+            std::printf("%s %s", missing++ == 0 ? "hlr-bundle: no curves for" : ",",
+                        s.symbol.empty() ? "(single security)" : s.symbol.c_str());
+        }
+        if (missing > 0)
+            std::printf(" (using %s)\n", config.hlr_params.hasCurves() ? "--hlr-curves" : "defaults");
+    }
     if (!config.kafka_brokers.empty()) {
-        std::printf("kafka: %s  topic=%s\n",
-                    config.kafka_brokers.c_str(), config.kafka_topic.c_str());
+        std::printf("kafka: %s  topic=%s  profile=%s  partitions=%s  batch=%u\n",
+                    config.kafka_brokers.c_str(), config.kafka_topic.c_str(),
+                    qrsdp::kafkaProfileName(config.kafka.profile),
+                    config.kafka.partitions ? std::to_string(config.kafka.partitions).c_str() : "key-hash",
+                    config.kafka.batch.max_records > 1 ? config.kafka.batch.max_records : 1u);
+        if (config.kafka_async)
+            std::printf("kafka async: queue=%zu  overflow=%s\n", config.kafka_queue.queue_records,
+                        qrsdp::overflowPolicyName(config.kafka_queue.policy));
+    }
+    if (config.itch_live.enabled) {
+        if (!config.itch_live.unicast_dest.empty())
+            std::printf("itch live: unicast %s\n", config.itch_live.unicast_dest.c_str());
+        else
+            std::printf("itch live: multicast %s:%u\n",
+                        config.itch_live.multicast_group.c_str(), config.itch_live.port);
+    }
+    if (config.live_frames.enabled()) {
+        std::printf("live frames: %s  every %.0f ms\n", config.live_frames.path.c_str(),
+                    config.live_frames.frame_interval_ns / 1e6);
+    }
+    if (config.shm_ring.enabled()) {
+        std::printf("shm ring: %s  %zu MiB\n", config.shm_ring.path.c_str(),
+                    config.shm_ring.ring_bytes >> 20);
     }
     if (config.realtime) {
         std::printf("realtime: speed=%.0fx\n", config.speed);
@@ -255,9 +785,100 @@ int main(int argc, char* argv[]) {
         std::printf("continuous mode: will run indefinitely (SIGTERM to stop)\n");
     }
 
+    // Metrics are recorded only when something exports them.
+    qrsdp::MetricsRegistry metrics;
+    std::unique_ptr<qrsdp::MetricsExporter> exporter;
+    if (metrics_export.http || !metrics_export.json_path.empty()) {
+        try {
+            exporter = std::make_unique<qrsdp::MetricsExporter>(metrics, metrics_export);
+        } catch (const std::exception& e) {
+            std::fprintf(stderr, "%s\n", e.what());
+            return 1;
+        }
+        config.metrics = &metrics;
+        if (metrics_export.http)
+            std::printf("metrics: http://0.0.0.0:%u/metrics\n", exporter->port());
+        exporter->start();
+    }
+
+    // One ring for every day file; each open file holds a staging buffer, so size
+    // the pool for the files open at once with as many again in flight.
+    std::unique_ptr<qrsdp::IoUringWriter> uring;
+    if (io_uring && !qrsdp::IoUringWriter::available()) {
+        std::fprintf(stderr, "io_uring is not available here; writing day files with stdio\n");
+    } else if (io_uring) {
+        size_t open_files = std::max<size_t>(config.securities.size(), 1);
+        if (config.workers > 0 && config.max_open_files > 0)
+            open_files = std::min<size_t>(open_files, config.max_open_files);
+        qrsdp::IoUringOptions uring_options;
+        uring_options.buffers = static_cast<uint32_t>(std::max<size_t>(uring_options.buffers, 2 * open_files + 2));
+        uring_options.queue_depth = uring_options.buffers;
+        uring_options.buffer_bytes = static_cast<uint32_t>(std::clamp<size_t>(
+            (size_t{64} << 20) / uring_options.buffers, 64 * 1024, uring_options.buffer_bytes));
+        uring_options.direct = direct_io;
+        try {
+            uring = std::make_unique<qrsdp::IoUringWriter>(uring_options);
+        } catch (const std::exception& e) {
+            std::fprintf(stderr, "%s\n", e.what());
+            return 1;
+        }
+        config.io_uring = uring.get();
+        std::printf("io_uring: %u x %u KiB buffers%s%s\n", uring->options().buffers,
+                    uring->options().buffer_bytes / 1024, uring->buffersRegistered() ? ", registered" : "",
+                    direct_io ? ", O_DIRECT" : "");
+    }
+
+    qrsdp::StageProfileTotals stage_profile;
+    if (profile)
+        config.stage_profile = &stage_profile;
+
+    // Declared before the watcher, which publishes into it until stopped.
+    qrsdp::HLRParamsChannel hlr_updates;
+    std::unique_ptr<qrsdp::HLRParamsWatcher> hlr_watcher;
+    if (!hlr_watch_path.empty()) {
+        hlr_watcher = std::make_unique<qrsdp::HLRParamsWatcher>(hlr_watch_path, hlr_updates);
+        if (hlr_watcher->start())
+            std::printf("hlr-watch: loaded %s\n", hlr_watch_path.c_str());
+        else
+            std::printf("hlr-watch: waiting for %s\n", hlr_watch_path.c_str());
+        config.hlr_updates = &hlr_updates;
+    }
+
     qrsdp::installShutdownHandler();
-    qrsdp::SessionRunner runner;
-    qrsdp::RunResult result = runner.run(config);
+    if (!worker_address.empty()) {
+        uint32_t shards = 0;
+        try {
+            shards = qrsdp::runWorker(config, worker_address, worker_name);
+        } catch (const std::exception& e) {
+            std::fprintf(stderr, "worker: %s\n", e.what());
+            return 1;
+        }
+        std::printf("worker %s: ran %u shard(s) for %s\n", worker_name.c_str(), shards, worker_address.c_str());
+        return 0;
+    }
+    qrsdp::RunResult result;
+    if (coordinator_port >= 0) {
+        try {
+            qrsdp::RunCoordinator coordinator(config, coordinator_options);
+            std::printf("coordinator: %zu shard(s) on port %u\n", coordinator.shardCount(),
+                        static_cast<unsigned>(coordinator.port()));
+            std::fflush(stdout);
+            result = coordinator.run();
+        } catch (const std::exception& e) {
+            std::fprintf(stderr, "coordinator: %s\n", e.what());
+            return 1;
+        }
+    } else {
+        qrsdp::SessionRunner runner;
+        result = runner.run(config);
+    }
+    if (exporter)
+        exporter->stop();
+    if (hlr_watcher) {
+        hlr_watcher->stop();
+        std::printf("hlr-watch: %llu reload(s) of %s\n",
+                    (unsigned long long)hlr_watcher->reloads(), hlr_watch_path.c_str());
+    }
 
     std::printf("\n--- Summary ---\n");
     for (const auto& d : result.days) {
@@ -284,6 +905,10 @@ int main(int argc, char* argv[]) {
     std::printf("\nTotal: %llu events in %.2f s\n",
                 (unsigned long long)result.total_events,
                 result.total_elapsed_seconds);
+    if (profile) {
+        std::printf("\n--- Stage breakdown ---\n");
+        qrsdp::writeStageTable(stdout, stage_profile.snapshot());
+    }
 
     qrsdp::SessionRunner::writePerformanceResults(config, result, perf_doc);
     std::printf("Wrote %s\n", perf_doc.c_str());
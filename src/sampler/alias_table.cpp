@@ -0,0 +1,45 @@
+#include "sampler/alias_table.h"
+#include <cmath>
+
+namespace qrsdp {
+
+void AliasTable::assign(const std::vector<double>& weights) {
+    const size_t n = weights.size();
+    prob_.assign(n, 1.0);
+    alias_.resize(n);
+    total_ = 0.0;
+    for (size_t i = 0; i < n; ++i) {
+        alias_[i] = static_cast<uint32_t>(i);
+        const double w = weights[i];
+        if (std::isfinite(w) && w > 0.0) total_ += w;
+    }
+    if (n == 0 || total_ <= 0.0) return;
+
+    // Vose: scale to mean 1, then pair each under-full column with an over-full one.
+    std::vector<double> scaled(n);
+    std::vector<uint32_t> small, large;
+    small.reserve(n);
+    large.reserve(n);
+    for (size_t i = 0; i < n; ++i) {
+        const double w = weights[i];
+        scaled[i] = (std::isfinite(w) && w > 0.0) ? w * static_cast<double>(n) / total_ : 0.0;
+        (scaled[i] < 1.0 ? small : large).push_back(static_cast<uint32_t>(i));
+    }
+    while (!small.empty() && !large.empty()) {
+        const uint32_t s = small.back();
+        small.pop_back();
+        const uint32_t l = large.back();
+        prob_[s] = scaled[s];
+        alias_[s] = l;
+        scaled[l] -= 1.0 - scaled[s];
+        if (scaled[l] < 1.0) {
+            large.pop_back();
+            small.push_back(l);
+        }
+    }
+    // Leftovers are 1 up to rounding; keep them as always-accept columns.
+    for (const uint32_t i : large) prob_[i] = 1.0;
+    for (const uint32_t i : small) prob_[i] = 1.0;
+}
+
+}  // namespace qrsdp
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace qrsdp {
+
+/// Walker/Vose alias table over fixed nonnegative weights.
+/// O(n) build, O(1) draw from a single uniform: for static distributions where a
+/// FenwickTree's point updates are not needed.
+class AliasTable {
+public:
+    /// Rebuild from weights. Non-finite or negative weights are treated as 0.
+    void assign(const std::vector<double>& weights);
+
+    size_t size() const { return prob_.size(); }
+    /// Sum of the (sanitised) weights; 0 means sample() has nothing to draw.
+    double total() const { return total_; }
+
+    /// Index i with probability weight(i) / total(), from u in [0, 1).
+    size_t sample(double u) const {
+        const double x = u * static_cast<double>(prob_.size());
+        size_t i = static_cast<size_t>(x);
+        if (i >= prob_.size()) i = prob_.size() - 1;
+        return (x - static_cast<double>(i)) < prob_[i] ? i : alias_[i];
+    }
+
+private:
+    std::vector<double> prob_;    // acceptance threshold of column i
+    std::vector<uint32_t> alias_; // index taken when column i rejects
+    double total_ = 0.0;
+};
+
+}  // namespace qrsdp
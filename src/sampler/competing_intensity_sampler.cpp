@@ -1,4 +1,5 @@
 #include "sampler/competing_intensity_sampler.h"
+#include <algorithm>
 #include <cmath>
 #include <limits>
 #include <vector>
@@ -7,19 +8,37 @@ namespace qrsdp {
 
 namespace {
 
-constexpr double kMinU = 1e-10;
 constexpr double kSafeDeltaT = 1e9;
+constexpr size_t kBatchBlock = 64;
+
+/// The rates sampleDeltaT() draws for: positive and finite.
+inline bool drawable(double lambda) {
+    return lambda > 0.0 && lambda <= std::numeric_limits<double>::max();
+}
 
 }  // namespace
 
-CompetingIntensitySampler::CompetingIntensitySampler(IRng& rng) : rng_(&rng) {}
+CompetingIntensitySampler::CompetingIntensitySampler(IRng& rng, SelectionMode mode)
+    : rng_(&rng), mode_(mode) {}
 
 double CompetingIntensitySampler::sampleDeltaT(double lambdaTotal) {
     if (lambdaTotal <= 0.0 || !std::isfinite(lambdaTotal)) return kSafeDeltaT;
-    double u = rng_->uniform();
-    if (u <= 0.0 || u >= 1.0) u = kMinU;
-    if (u < kMinU) u = kMinU;
-    return -std::log(u) / lambdaTotal;
+    return rng_->exponential() / lambdaTotal;
+}
+
+void CompetingIntensitySampler::sampleDeltaTBatch(CompetingIntensitySampler* const* samplers,
+                                                  const double* lambda_total, size_t m,
+                                                  double* dt_out) {
+    double draws[kBatchBlock];
+    for (size_t start = 0; start < m; start += kBatchBlock) {
+        const size_t n = std::min(kBatchBlock, m - start);
+        const double* lambda = lambda_total + start;
+        for (size_t i = 0; i < n; ++i)
+            draws[i] = drawable(lambda[i]) ? samplers[start + i]->rng_->exponential() : 0.0;
+        double* dt = dt_out + start;
+        for (size_t i = 0; i < n; ++i)
+            dt[i] = drawable(lambda[i]) ? draws[i] / lambda[i] : kSafeDeltaT;
+    }
 }
 
 EventType CompetingIntensitySampler::sampleType(const Intensities& intens) {
@@ -57,4 +76,20 @@ size_t CompetingIntensitySampler::sampleIndexFromWeights(const std::vector<doubl
     return weights.size() - 1;
 }
 
+void CompetingIntensitySampler::loadWeights(const std::vector<double>& weights) {
+    tree_.assign(weights);
+}
+
+void CompetingIntensitySampler::updateWeight(size_t index, double weight) {
+    if (index < tree_.size()) tree_.set(index, weight);
+}
+
+size_t CompetingIntensitySampler::sampleLoadedIndex() {
+    const double total = tree_.total();
+    if (tree_.size() == 0 || total <= 0.0 || !std::isfinite(total)) return 0;
+    const double u = rng_->uniform();
+    if (u <= 0.0 || u >= 1.0) return 0;
+    return tree_.find(u * total);
+}
+
 }  // namespace qrsdp
@@ -2,20 +2,50 @@
 
 #include "sampler/i_event_sampler.h"
 #include "rng/irng.h"
+#include "sampler/fenwick_tree.h"
 #include "core/records.h"
 
+#include <cstddef>
+
 namespace qrsdp {
 
+/// How per-level indices are drawn from the HLR weight vector.
+///   LINEAR  — cumulative scan over the full vector per draw; reproduces the draws of
+///             every build before FENWICK existed (same seed => identical stream), given
+///             totals exactly as the model's compute() adds them (CurveIntensityModel's
+///             EXACT totals mode, which SessionRunner selects for LINEAR runs).
+///   FENWICK — weights held in a FenwickTree with O(log n) point updates and draws.
+///             Same distribution, but boundary rounding differs, so streams differ.
+enum class SelectionMode { LINEAR, FENWICK };
+
 /// Δt ~ Exp(λ_total), event type ~ categorical(λ_i / λ_total). Uses injected IRng.
-class CompetingIntensitySampler : public IEventSampler {
+class CompetingIntensitySampler final : public IEventSampler {
 public:
-    explicit CompetingIntensitySampler(IRng& rng);
+    explicit CompetingIntensitySampler(IRng& rng, SelectionMode mode = SelectionMode::LINEAR);
     double sampleDeltaT(double lambdaTotal) override;
     EventType sampleType(const Intensities&) override;
     size_t sampleIndexFromWeights(const std::vector<double>& weights) override;
 
+    bool supportsIncrementalWeights() const override { return mode_ == SelectionMode::FENWICK; }
+    void loadWeights(const std::vector<double>& weights) override;
+    void updateWeight(size_t index, double weight) override;
+    size_t sampleLoadedIndex() override;
+
+    SelectionMode mode() const { return mode_; }
+
+    /// sampleDeltaT() for m books at once: dt_out[i] equals
+    /// samplers[i]->sampleDeltaT(lambda_total[i]). Each book's exponential comes
+    /// from its own RNG in the same order, so the streams are unchanged; the
+    /// divisions and the invalid-rate fallback run as one vectorizable pass.
+    /// Like IIntensityModel::computeBatch(), for callers that step many books in
+    /// lockstep; the producer draws one Δt per step.
+    static void sampleDeltaTBatch(CompetingIntensitySampler* const* samplers,
+                                  const double* lambda_total, size_t m, double* dt_out);
+
 private:
     IRng* rng_;
+    SelectionMode mode_;
+    FenwickTree tree_;
 };
 
 }  // namespace qrsdp
@@ -0,0 +1,58 @@
+#include "sampler/fenwick_tree.h"
+#include <cmath>
+
+namespace qrsdp {
+
+double FenwickTree::sanitize(double w) {
+    return (std::isfinite(w) && w > 0.0) ? w : 0.0;
+}
+
+void FenwickTree::assign(const std::vector<double>& weights) {
+    const size_t n = weights.size();
+    leaves_.resize(n);
+    tree_.assign(n + 1, 0.0);
+    total_ = 0.0;
+    for (size_t i = 0; i < n; ++i) {
+        leaves_[i] = sanitize(weights[i]);
+        total_ += leaves_[i];
+        tree_[i + 1] += leaves_[i];
+        const size_t parent = (i + 1) + ((i + 1) & (~(i + 1) + 1));
+        if (parent <= n) tree_[parent] += tree_[i + 1];
+    }
+    top_bit_ = 1;
+    while (top_bit_ * 2 <= n) top_bit_ *= 2;
+    if (n == 0) top_bit_ = 0;
+}
+
+void FenwickTree::set(size_t i, double w) {
+    const double v = sanitize(w);
+    const double delta = v - leaves_[i];
+    if (delta == 0.0) return;
+    leaves_[i] = v;
+    total_ += delta;
+    const size_t n = leaves_.size();
+    for (size_t j = i + 1; j <= n; j += j & (~j + 1)) tree_[j] += delta;
+}
+
+size_t FenwickTree::find(double target) const {
+    const size_t n = leaves_.size();
+    if (n == 0) return 0;
+    size_t pos = 0;
+    for (size_t step = top_bit_; step > 0; step >>= 1) {
+        const size_t next = pos + step;
+        if (next <= n && tree_[next] <= target) {
+            pos = next;
+            target -= tree_[next];
+        }
+    }
+    // pos is the count of leaves whose cumulative weight is <= target; skip any
+    // zero-weight leaves that rounding may have landed on.
+    while (pos < n && leaves_[pos] <= 0.0) ++pos;
+    if (pos >= n) {
+        pos = n - 1;
+        while (pos > 0 && leaves_[pos] <= 0.0) --pos;
+    }
+    return pos;
+}
+
+}  // namespace qrsdp
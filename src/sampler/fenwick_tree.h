@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace qrsdp {
+
+/// Binary indexed (Fenwick) tree over nonnegative weights.
+/// O(n) build, O(log n) point update and prefix search; used to draw an index
+/// with probability ∝ weight without re-scanning the whole weight vector.
+class FenwickTree {
+public:
+    /// Rebuild from weights. Non-finite or negative weights are treated as 0.
+    void assign(const std::vector<double>& weights);
+
+    /// Set weight i (i < size()). Same clamping as assign().
+    void set(size_t i, double w);
+
+    double weight(size_t i) const { return leaves_[i]; }
+    double total() const { return total_; }
+    size_t size() const { return leaves_.size(); }
+
+    /// Smallest index i with prefix_sum(0..i) > target. target in [0, total()).
+    /// Clamped to size()-1 so rounding at the top end never runs off the tree.
+    size_t find(double target) const;
+
+private:
+    static double sanitize(double w);
+
+    std::vector<double> tree_;    // 1-based partial sums; tree_[0] unused
+    std::vector<double> leaves_;  // current weights, to turn set() into a delta
+    double total_ = 0.0;
+    size_t top_bit_ = 0;          // highest power of two <= size()
+};
+
+}  // namespace qrsdp
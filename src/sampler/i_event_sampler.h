@@ -19,6 +19,17 @@ public:
         (void)weights;
         return 0;
     }
+
+    /// Optional incremental per-level sampling: loadWeights() once (O(n)), then
+    /// updateWeight() for entries that changed and sampleLoadedIndex() per draw.
+    /// Producers use this path only when supportsIncrementalWeights() is true.
+    virtual bool supportsIncrementalWeights() const { return false; }
+    virtual void loadWeights(const std::vector<double>& weights) { (void)weights; }
+    virtual void updateWeight(size_t index, double weight) {
+        (void)index;
+        (void)weight;
+    }
+    virtual size_t sampleLoadedIndex() { return 0; }
 };
 
 }  // namespace qrsdp
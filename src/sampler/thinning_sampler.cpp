@@ -0,0 +1,45 @@
+#include "sampler/thinning_sampler.h"
+#include <algorithm>
+
+namespace qrsdp {
+
+ThinningSampler::ThinningSampler(IRng& rng, double window_seconds)
+    : rng_(&rng), window_(window_seconds > 0.0 ? window_seconds : kDefaultWindowSeconds) {}
+
+void ThinningSampler::reset() {
+    exp_pos_ = kBatch;
+    uni_pos_ = kBatch;
+    candidates_ = 0;
+    accepted_ = 0;
+}
+
+double ThinningSampler::nextEventTime(double t, double t_end, double lambda,
+                                      const IIntensityScale& scale) {
+    if (!(lambda > 0.0)) return t_end;
+    while (t < t_end) {
+        const double w_end = std::min(t + window_, t_end);
+        const double m_bar = scale.bound(t, w_end);
+        if (!(m_bar > 0.0)) {
+            t = w_end;
+            continue;
+        }
+        const double rate_bar = lambda * m_bar;
+        // The candidate process is memoryless, so restarting it at w_end (with
+        // the next window's bound) leaves the accepted process unchanged.
+        for (;;) {
+            t += nextExponential() / rate_bar;
+            if (t >= w_end) {
+                t = w_end;
+                break;
+            }
+            ++candidates_;
+            if (nextUniform() * m_bar < scale.at(t)) {
+                ++accepted_;
+                return t;
+            }
+        }
+    }
+    return t_end;
+}
+
+}  // namespace qrsdp
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "model/i_intensity_scale.h"
+#include "rng/irng.h"
+#include <cstddef>
+#include <cstdint>
+
+namespace qrsdp {
+
+/// Ogata thinning for a time-varying total intensity λ · scale(t), where λ is the
+/// state-driven total (constant until the next event changes the book).
+///
+/// Time is walked in windows of window_seconds; within a window candidates arrive
+/// at rate λ · scale.bound(window) and are accepted with probability
+/// scale.at(t) / bound, so a rejection costs one draw, one scale lookup and a
+/// compare, and no intensity recomputation. Exponential and uniform draws are
+/// pulled from the RNG kBatch at a time through its block API.
+class ThinningSampler {
+public:
+    static constexpr size_t kBatch = 64;
+    static constexpr double kDefaultWindowSeconds = 60.0;
+
+    explicit ThinningSampler(IRng& rng, double window_seconds = kDefaultWindowSeconds);
+
+    /// First accepted event time after t, or t_end if none before t_end.
+    double nextEventTime(double t, double t_end, double lambda, const IIntensityScale& scale);
+
+    /// Drop buffered draws (call after reseeding the RNG).
+    void reset();
+
+    uint64_t candidates() const { return candidates_; }
+    uint64_t accepted() const { return accepted_; }
+
+private:
+    double nextExponential() {
+        if (exp_pos_ == kBatch) {
+            rng_->fillExponential(exp_buf_, kBatch);
+            exp_pos_ = 0;
+        }
+        return exp_buf_[exp_pos_++];
+    }
+    double nextUniform() {
+        if (uni_pos_ == kBatch) {
+            rng_->fillUniform(uni_buf_, kBatch);
+            uni_pos_ = 0;
+        }
+        return uni_buf_[uni_pos_++];
+    }
+
+    IRng* rng_;
+    double window_;
+    double exp_buf_[kBatch];
+    double uni_buf_[kBatch];
+    size_t exp_pos_ = kBatch;
+    size_t uni_pos_ = kBatch;
+    uint64_t candidates_ = 0;
+    uint64_t accepted_ = 0;
+};
+
+}  // namespace qrsdp
@@ -1,4 +1,5 @@
 #include "sampler/unit_size_attribute_sampler.h"
+#include "book/depth_reduce.h"
 #include <cmath>
 #include <algorithm>
 
@@ -10,37 +11,39 @@ UnitSizeAttributeSampler::UnitSizeAttributeSampler(IRng& rng, double alpha, doub
 size_t UnitSizeAttributeSampler::sampleLevelIndex(size_t num_levels) {
     if (num_levels == 0) return 0;
     if (num_levels == 1) return 0;
-    const size_t n = std::min(num_levels, kAttrSamplerMaxLevels);
-    double total = 0.0;
-    for (size_t k = 0; k < n; ++k) {
-        weight_buf_[k] = std::exp(-alpha_ * static_cast<double>(k));
-        total += weight_buf_[k];
-    }
-    if (total <= 0.0) return 0;
-    const double u = rng_->uniform();
-    double cum = 0.0;
-    for (size_t k = 0; k < n; ++k) {
-        cum += weight_buf_[k];
-        if (u < cum / total) return k;
+    if (level_alias_.size() != num_levels) {
+        std::vector<double> weights(num_levels);
+        for (size_t k = 0; k < num_levels; ++k) weights[k] = std::exp(-alpha_ * static_cast<double>(k));
+        level_alias_.assign(weights);
     }
-    return n - 1;
+    if (level_alias_.total() <= 0.0) return 0;
+    return level_alias_.sample(rng_->uniform());
 }
 
 size_t UnitSizeAttributeSampler::sampleCancelLevelIndex(bool is_bid, const IOrderBook& book) {
-    const size_t n = std::min(book.numLevels(), kAttrSamplerMaxLevels);
+    const size_t n = book.numLevels();
     if (n == 0) return 0;
-    double total = 0.0;
-    for (size_t k = 0; k < n; ++k) {
-        const uint32_t d = is_bid ? book.bidDepthAtLevel(k) : book.askDepthAtLevel(k);
-        weight_buf_[k] = static_cast<double>(d);
-        total += weight_buf_[k];
+    // Books that maintain a depth Fenwick tree: O(log n), same level as the scan below.
+    if (const LevelDepthIndex* index = is_bid ? book.bidDepthIndex() : book.askDepthIndex()) {
+        if (index->total() == 0) return 0;
+        return index->find(rng_->uniform());
+    }
+    const DepthSpan span = is_bid ? book.bidDepths() : book.askDepths();
+    const uint32_t* depths = span.data;
+    if (span.size < n) {
+        if (depth_buf_.size() < n) depth_buf_.resize(n);
+        for (size_t k = 0; k < n; ++k)
+            depth_buf_[k] = is_bid ? book.bidDepthAtLevel(k) : book.askDepthAtLevel(k);
+        depths = depth_buf_.data();
     }
+    // Integer sums are exact in double, so this matches summing the weights one by one.
+    const double total = static_cast<double>(sumDepths(depths, n));
     if (total <= 0.0) return 0;
     const double u = rng_->uniform();
-    double cum = 0.0;
+    uint64_t cum = 0;
     for (size_t k = 0; k < n; ++k) {
-        cum += weight_buf_[k];
-        if (u < cum / total) return k;
+        cum += depths[k];
+        if (u < static_cast<double>(cum) / total) return k;
     }
     return n - 1;
 }
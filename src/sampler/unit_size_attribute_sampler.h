@@ -1,19 +1,19 @@
 #pragma once
 
 #include "sampler/i_attribute_sampler.h"
+#include "sampler/alias_table.h"
 #include "rng/irng.h"
 #include "core/records.h"
-#include <array>
 #include <cstddef>
+#include <cstdint>
+#include <vector>
 
 namespace qrsdp {
 
-constexpr size_t kAttrSamplerMaxLevels = 64;
-
 /// v1: qty=1 always; level k with prob ∝ exp(-alpha*k); EXECUTE at best opposite.
 /// When spread > 1 and spread_improve_coeff > 0, ADD events may target inside
 /// the spread (price improvement) with probability min(1, (spread-1)*coeff).
-class UnitSizeAttributeSampler : public IAttributeSampler {
+class UnitSizeAttributeSampler final : public IAttributeSampler {
 public:
     UnitSizeAttributeSampler(IRng& rng, double alpha, double spread_improve_coeff = 0.0);
     EventAttrs sample(EventType, const IOrderBook&, const BookFeatures&,
@@ -23,7 +23,11 @@ private:
     IRng* rng_;
     double alpha_;
     double spread_improve_coeff_;
-    std::array<double, kAttrSamplerMaxLevels> weight_buf_{};
+    /// Alias table over exp(-alpha*k), k < book depth: alpha is fixed, so add levels
+    /// are drawn in O(1). Built for the book depth on first use, rebuilt if it changes.
+    AliasTable level_alias_;
+    /// Scratch grown to the book depth on first use; no per-event allocation after that.
+    std::vector<uint32_t> depth_buf_;  // books without depth indexes or spans
     size_t sampleLevelIndex(size_t num_levels);
     size_t sampleCancelLevelIndex(bool is_bid, const IOrderBook& book);
 };
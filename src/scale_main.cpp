@@ -0,0 +1,226 @@
+#include "producer/scaling_benchmark.h"
+#include "producer/session_runner.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <string>
+#include <thread>
+#include <vector>
+
+static void printUsage(const char* prog) {
+    std::fprintf(stderr,
+        "Usage: %s [options]\n"
+        "  Runs qrsdp_run's SessionRunner over every combination of the swept settings\n"
+        "  and reports events/s, bytes/event, peak RSS and thread-scaling efficiency.\n"
+        "  List options take comma-separated values.\n"
+        "  --levels <list>     Levels per side (default: 5)\n"
+        "  --model <list>      simple, hlr and/or hawkes (default: simple)\n"
+        "  --chunk-size <list> Records per chunk (default: 4096)\n"
+        "  --codec <list>      Chunk codecs, e.g. lz4,lz4:8,none (default: lz4)\n"
+        "  --securities <list> Securities per run (default: 1)\n"
+        "  --threads <list>    Day-scheduler threads (default: 1,2,4,...,all cores)\n"
+        "  --sinks <list>      file, file+kafka and/or file+itch (default: file)\n"
+        "  --days <n>          Independent days per security (default: 4)\n"
+        "  --seconds <n>       Seconds per session (default: 3600)\n"
+        "  --seed <n>          Base seed (default: 42)\n"
+        "  --output <dir>      Scratch directory for the runs (default: output/scale)\n"
+        "  --keep              Keep each case's files and performance-results.md\n"
+        "  --csv <path>        Write results as CSV (- = stdout)\n"
+        "  --json <path>       Write results as JSON (- = stdout)\n"
+        "  --kafka-brokers <s> Brokers for file+kafka cases\n"
+        "  --kafka-topic <s>   Topic for file+kafka cases (default: exchange.events)\n"
+        "  --itch-unicast <h:p> Destination of file+itch cases (default: 127.0.0.1:5001)\n"
+        "  --help              Show this help\n",
+        prog);
+}
+
+static std::vector<std::string> splitList(const char* s) {
+    std::vector<std::string> out;
+    std::string item;
+    for (const char* p = s;; ++p) {
+        if (*p == ',' || *p == '\0') {
+            if (!item.empty()) out.push_back(item);
+            item.clear();
+            if (*p == '\0') break;
+        } else {
+            item += *p;
+        }
+    }
+    return out;
+}
+
+static std::vector<uint32_t> parseUintList(const char* s) {
+    std::vector<uint32_t> out;
+    for (const std::string& v : splitList(s)) out.push_back(static_cast<uint32_t>(std::atoi(v.c_str())));
+    return out;
+}
+
+/// 1, 2, 4, ... up to and including the core count.
+static std::vector<uint32_t> defaultThreads() {
+    const uint32_t cores = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<uint32_t> out;
+    for (uint32_t t = 1; t < cores; t *= 2) out.push_back(t);
+    out.push_back(cores);
+    return out;
+}
+
+static bool writeTo(const std::string& path, void (*write)(std::FILE*, const std::vector<qrsdp::ScalingResult>&),
+                    const std::vector<qrsdp::ScalingResult>& results) {
+    std::FILE* f = path == "-" ? stdout : std::fopen(path.c_str(), "w");
+    if (!f) {
+        std::fprintf(stderr, "cannot open %s\n", path.c_str());
+        return false;
+    }
+    write(f, results);
+    if (f != stdout) std::fclose(f);
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    qrsdp::ScalingSweep sweep;
+    sweep.threads = defaultThreads();
+    uint32_t days = 4;
+    uint32_t seconds = 3600;
+    uint64_t seed = 42;
+    std::string output_dir = "output/scale";
+    bool keep = false;
+    std::string csv_path;
+    std::string json_path;
+    std::string kafka_brokers;
+    std::string kafka_topic = "exchange.events";
+    std::string itch_unicast = "127.0.0.1:5001";
+
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        auto next = [&]() -> const char* {
+            if (i + 1 >= argc) {
+                std::fprintf(stderr, "missing value for %s\n", arg);
+                std::exit(1);
+            }
+            return argv[++i];
+        };
+
+        if (std::strcmp(arg, "--levels") == 0)          sweep.levels = parseUintList(next());
+        else if (std::strcmp(arg, "--model") == 0) {
+            sweep.models.clear();
+            for (const std::string& m : splitList(next())) {
+                if (m == "simple") sweep.models.push_back(qrsdp::ModelType::SIMPLE);
+                else if (m == "hlr") sweep.models.push_back(qrsdp::ModelType::HLR);
+                else if (m == "hawkes") sweep.models.push_back(qrsdp::ModelType::HAWKES);
+                else {
+                    std::fprintf(stderr, "unknown model type: %s (use 'simple', 'hlr' or 'hawkes')\n", m.c_str());
+                    return 1;
+                }
+            }
+        }
+        else if (std::strcmp(arg, "--chunk-size") == 0)  sweep.chunk_capacities = parseUintList(next());
+        else if (std::strcmp(arg, "--codec") == 0) {
+            sweep.codecs.clear();
+            for (const std::string& c : splitList(next())) {
+                qrsdp::CodecConfig codec;
+                if (!qrsdp::parseCodecSpec(c, codec) || !qrsdp::codecAvailable(codec.codec)) {
+                    std::fprintf(stderr, "unknown or unavailable codec: %s\n", c.c_str());
+                    return 1;
+                }
+                sweep.codecs.push_back(codec);
+            }
+        }
+        else if (std::strcmp(arg, "--securities") == 0) sweep.securities = parseUintList(next());
+        else if (std::strcmp(arg, "--threads") == 0)    sweep.threads = parseUintList(next());
+        else if (std::strcmp(arg, "--sinks") == 0) {
+            sweep.sinks.clear();
+            for (const std::string& s : splitList(next())) {
+                qrsdp::SinkCombo sinks;
+                if (!qrsdp::parseSinkCombo(s, sinks)) {
+                    std::fprintf(stderr, "unknown sinks: %s (use 'file', 'file+kafka' or 'file+itch')\n",
+                                 s.c_str());
+                    return 1;
+                }
+                sweep.sinks.push_back(sinks);
+            }
+        }
+        else if (std::strcmp(arg, "--days") == 0)       days = static_cast<uint32_t>(std::atoi(next()));
+        else if (std::strcmp(arg, "--seconds") == 0)    seconds = static_cast<uint32_t>(std::atoi(next()));
+        else if (std::strcmp(arg, "--seed") == 0)       seed = std::strtoull(next(), nullptr, 10);
+        else if (std::strcmp(arg, "--output") == 0)     output_dir = next();
+        else if (std::strcmp(arg, "--keep") == 0)       keep = true;
+        else if (std::strcmp(arg, "--csv") == 0)        csv_path = next();
+        else if (std::strcmp(arg, "--json") == 0)       json_path = next();
+        else if (std::strcmp(arg, "--kafka-brokers") == 0) kafka_brokers = next();
+        else if (std::strcmp(arg, "--kafka-topic") == 0)   kafka_topic = next();
+        else if (std::strcmp(arg, "--itch-unicast") == 0)  itch_unicast = next();
+        else if (std::strcmp(arg, "--help") == 0 || std::strcmp(arg, "-h") == 0) {
+            printUsage(argv[0]);
+            return 0;
+        } else {
+            std::fprintf(stderr, "unknown argument: %s\n", arg);
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (days == 0) {
+        std::fprintf(stderr, "--days must be at least 1\n");
+        return 1;
+    }
+    for (qrsdp::SinkCombo s : sweep.sinks) {
+        if (s != qrsdp::SinkCombo::FILE_KAFKA) continue;
+#ifndef QRSDP_KAFKA_ENABLED
+        std::fprintf(stderr, "file+kafka needs a build with -DBUILD_KAFKA_SUPPORT=ON\n");
+        return 1;
+#else
+        if (kafka_brokers.empty()) {
+            std::fprintf(stderr, "file+kafka needs --kafka-brokers\n");
+            return 1;
+        }
+#endif
+    }
+
+    qrsdp::RunConfig base{};
+    base.run_id = "scale";
+    base.base_seed = seed;
+    base.p0_ticks = 10000;
+    base.session_seconds = seconds;
+    base.tick_size = 100;
+    base.initial_spread_ticks = 2;
+    base.initial_depth = 5;
+    base.intensity_params = {22.0, 0.2, 30.0, 1.0, 1.0, 0.5, 0.4};
+    base.num_days = days;
+    base.start_date = "2026-01-02";
+    base.kafka_brokers = kafka_brokers;
+    base.kafka_topic = kafka_topic;
+    base.itch_live.unicast_dest = itch_unicast;
+
+    const std::vector<qrsdp::ScalingCase> cases = sweep.cases();
+    std::vector<qrsdp::ScalingResult> results;
+    qrsdp::installShutdownHandler();
+    for (size_t i = 0; i < cases.size(); ++i) {
+        const qrsdp::ScalingCase& c = cases[i];
+        const std::string dir = output_dir + "/case_" + std::to_string(i);
+        std::printf("[%zu/%zu] K=%u %s chunk=%u %s securities=%u threads=%u %s ... ", i + 1,
+                    cases.size(), c.levels_per_side, qrsdp::modelTypeName(c.model),
+                    c.chunk_capacity, qrsdp::codecSpecString(c.codec).c_str(), c.securities,
+                    c.threads, qrsdp::sinkComboName(c.sinks));
+        std::fflush(stdout);
+        try {
+            results.push_back(qrsdp::runScalingCase(base, c, dir, keep));
+        } catch (const std::exception& e) {
+            std::printf("failed\n");
+            std::fprintf(stderr, "%s\n", e.what());
+            return 1;
+        }
+        std::printf("%.0f ev/s\n", results.back().events_per_sec);
+    }
+    qrsdp::computeScalingEfficiency(results);
+
+    std::printf("\n");
+    qrsdp::writeScalingSummary(stdout, results);
+    if (!csv_path.empty() && !writeTo(csv_path, qrsdp::writeScalingCsv, results))
+        return 1;
+    if (!json_path.empty() && !writeTo(json_path, qrsdp::writeScalingJson, results))
+        return 1;
+    return 0;
+}
@@ -0,0 +1,152 @@
+#include "producer/parameter_sweep.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+static void printUsage(const char* prog) {
+    std::fprintf(stderr,
+        "Usage: %s [options]\n"
+        "  Runs every combination of the listed SimpleImbalanceIntensity parameters for\n"
+        "  --days independent sessions each, keeping only summary statistics (no event\n"
+        "  files), and prints one row per combination. List options take comma-separated values.\n"
+        "  --base-L <list>         Add intensity (default: 20)\n"
+        "  --base-C <list>         Cancel intensity per unit of depth (default: 0.5)\n"
+        "  --base-M <list>         Execution intensity (default: 15)\n"
+        "  --imbalance-sens <list> (default: 1)\n"
+        "  --cancel-sens <list>    (default: 1)\n"
+        "  --epsilon-exec <list>   (default: 0.5)\n"
+        "  --spread-sens <list>    (default: 0.4)\n"
+        "  --days <n>              Sessions per combination (default: 4)\n"
+        "  --seconds <n>           Seconds per session (default: 3600)\n"
+        "  --seed <n>              Base seed; day d uses the same seed at every point (default: 42)\n"
+        "  --fork-at <seconds>     Run one prefix to this time, then make every day a branch\n"
+        "                          forked from its state (what-if continuations; default: off)\n"
+        "  --p0 <ticks>            Opening mid (default: 10000)\n"
+        "  --levels <n>            Levels per side (default: 5)\n"
+        "  --depth <n>             Initial depth per level (default: 5)\n"
+        "  --bar-seconds <x>       Bar length for return moments (default: 10)\n"
+        "  --threads <n>           Worker threads (default: all cores)\n"
+        "  --csv <path>            Write results as CSV (- = stdout, the table is then skipped)\n"
+        "  --help                  Show this help\n",
+        prog);
+}
+
+static bool parseDoubleList(const char* s, std::vector<double>& out) {
+    out.clear();
+    std::string item;
+    for (const char* p = s;; ++p) {
+        if (*p == ',' || *p == '\0') {
+            if (!item.empty()) {
+                char* end = nullptr;
+                const double v = std::strtod(item.c_str(), &end);
+                if (end == item.c_str() || *end != '\0') return false;
+                out.push_back(v);
+            }
+            item.clear();
+            if (*p == '\0') break;
+        } else {
+            item += *p;
+        }
+    }
+    return !out.empty();
+}
+
+int main(int argc, char* argv[]) {
+    qrsdp::SweepConfig config;
+    std::string csv_path;
+
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        auto next = [&]() -> const char* {
+            if (i + 1 >= argc) {
+                std::fprintf(stderr, "missing value for %s\n", arg);
+                std::exit(1);
+            }
+            return argv[++i];
+        };
+        auto list = [&](std::vector<double>& out) {
+            const char* v = next();
+            if (!parseDoubleList(v, out)) {
+                std::fprintf(stderr, "%s expects comma-separated numbers, got %s\n", arg, v);
+                std::exit(1);
+            }
+        };
+
+        if (std::strcmp(arg, "--base-L") == 0)              list(config.grid.base_L);
+        else if (std::strcmp(arg, "--base-C") == 0)         list(config.grid.base_C);
+        else if (std::strcmp(arg, "--base-M") == 0)         list(config.grid.base_M);
+        else if (std::strcmp(arg, "--imbalance-sens") == 0) list(config.grid.imbalance_sensitivity);
+        else if (std::strcmp(arg, "--cancel-sens") == 0)    list(config.grid.cancel_sensitivity);
+        else if (std::strcmp(arg, "--epsilon-exec") == 0)   list(config.grid.epsilon_exec);
+        else if (std::strcmp(arg, "--spread-sens") == 0)    list(config.grid.spread_sensitivity);
+        else if (std::strcmp(arg, "--days") == 0)     config.days = static_cast<uint32_t>(std::atoi(next()));
+        else if (std::strcmp(arg, "--seconds") == 0)  config.session_seconds = static_cast<uint32_t>(std::atoi(next()));
+        else if (std::strcmp(arg, "--seed") == 0)     config.base_seed = std::strtoull(next(), nullptr, 10);
+        else if (std::strcmp(arg, "--fork-at") == 0)  config.fork_seconds = std::atof(next());
+        else if (std::strcmp(arg, "--p0") == 0)       config.p0_ticks = std::atoi(next());
+        else if (std::strcmp(arg, "--levels") == 0)   config.levels_per_side = static_cast<uint32_t>(std::atoi(next()));
+        else if (std::strcmp(arg, "--depth") == 0)    config.initial_depth = static_cast<uint32_t>(std::atoi(next()));
+        else if (std::strcmp(arg, "--bar-seconds") == 0) config.bar_seconds = std::atof(next());
+        else if (std::strcmp(arg, "--threads") == 0)  config.threads = static_cast<uint32_t>(std::atoi(next()));
+        else if (std::strcmp(arg, "--csv") == 0)      csv_path = next();
+        else if (std::strcmp(arg, "--help") == 0 || std::strcmp(arg, "-h") == 0) {
+            printUsage(argv[0]);
+            return 0;
+        } else {
+            std::fprintf(stderr, "unknown argument: %s\n", arg);
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (config.days == 0) {
+        std::fprintf(stderr, "--days must be at least 1\n");
+        return 1;
+    }
+    if (config.levels_per_side == 0) {
+        std::fprintf(stderr, "--levels must be at least 1\n");
+        return 1;
+    }
+    if (config.fork_seconds < 0.0 || config.fork_seconds >= config.session_seconds) {
+        std::fprintf(stderr, "--fork-at must be within the session (0 <= t < --seconds)\n");
+        return 1;
+    }
+    if (!(config.bar_seconds > 0.0)) {
+        std::fprintf(stderr, "--bar-seconds must be positive\n");
+        return 1;
+    }
+
+    const size_t points = config.grid.points().size();
+    if (config.fork_seconds > 0.0)
+        std::fprintf(stderr, "Sweeping %zu points x %u branches from t = %g s of %u s...\n", points,
+                     config.days, config.fork_seconds, config.session_seconds);
+    else
+        std::fprintf(stderr, "Sweeping %zu points x %u days of %u s...\n", points, config.days,
+                     config.session_seconds);
+    const auto start = std::chrono::steady_clock::now();
+    const std::vector<qrsdp::SweepResult> results = qrsdp::runParameterSweep(config);
+    const double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    uint64_t events = 0;
+    for (const qrsdp::SweepResult& r : results) events += r.pooled.events;
+
+    if (csv_path != "-") {
+        qrsdp::writeSweepSummary(stdout, results, config);
+        std::printf("\n%zu sessions, %llu events in %.2f s (%.3g events/s)\n",
+                    points * config.days, static_cast<unsigned long long>(events), wall,
+                    wall > 0.0 ? static_cast<double>(events) / wall : 0.0);
+    }
+    if (!csv_path.empty()) {
+        std::FILE* f = csv_path == "-" ? stdout : std::fopen(csv_path.c_str(), "w");
+        if (!f) {
+            std::fprintf(stderr, "cannot open %s\n", csv_path.c_str());
+            return 1;
+        }
+        qrsdp::writeSweepCsv(f, results, config);
+        if (f != stdout) std::fclose(f);
+    }
+    return 0;
+}
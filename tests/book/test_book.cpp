@@ -1,7 +1,13 @@
 #include <gtest/gtest.h>
 #include "book/multi_level_book.h"
+#include "book/depth_reduce.h"
+#include "rng/mt19937_rng.h"
 #include "core/records.h"
 
+#include <random>
+#include <stdexcept>
+#include <vector>
+
 namespace qrsdp {
 namespace test {
 
@@ -92,5 +98,237 @@ TEST(QrsdpBook, ShiftWhenBestDepleted) {
     assertBookInvariants(book);
 }
 
+TEST(QrsdpBook, LastChangeNamesTouchedLevel) {
+    MultiLevelBook book;
+    book.seed(BookSeed{10000, 5, 10, 2});
+    EXPECT_TRUE(book.lastChange().full) << "seed resets every level";
+
+    book.apply(SimEvent{EventType::ADD_BID, Side::BID, 9997, 1, 1});
+    BookDelta d = book.lastChange();
+    EXPECT_FALSE(d.full);
+    EXPECT_EQ(d.side, Side::BID);
+    EXPECT_EQ(d.level, 2u);
+
+    book.apply(SimEvent{EventType::CANCEL_ASK, Side::ASK, 10002, 1, 2});
+    d = book.lastChange();
+    EXPECT_FALSE(d.full);
+    EXPECT_EQ(d.side, Side::ASK);
+    EXPECT_EQ(d.level, 1u);
+
+    book.apply(SimEvent{EventType::ADD_ASK, Side::ASK, 20000, 1, 3});
+    d = book.lastChange();
+    EXPECT_FALSE(d.full);
+    EXPECT_EQ(d.side, Side::NA) << "out-of-range add changes nothing";
+}
+
+TEST(QrsdpBook, LastChangeFullOnShiftAndImprove) {
+    MultiLevelBook book;
+    book.seed(BookSeed{10000, 3, 1, 4});
+    book.apply(SimEvent{EventType::EXECUTE_SELL, Side::BID, 9998, 1, 1});
+    EXPECT_TRUE(book.lastChange().full) << "depleting the best bid shifts the book";
+
+    book.apply(SimEvent{EventType::ADD_ASK, Side::ASK, 10001, 1, 2});
+    EXPECT_TRUE(book.lastChange().full) << "spread improvement re-prices every level";
+}
+
+/// Array-shifting ladder with the original MultiLevelBook semantics, for
+/// checking the ring layout level by level.
+struct ReferenceLadder {
+    struct Slot { int32_t price; uint32_t depth; };
+    std::vector<Slot> bid, ask;
+    uint32_t initial_depth;
+
+    ReferenceLadder(int32_t best_bid, int32_t best_ask, size_t n, uint32_t depth)
+        : initial_depth(depth) {
+        for (size_t k = 0; k < n; ++k) {
+            bid.push_back({best_bid - static_cast<int32_t>(k), depth});
+            ask.push_back({best_ask + static_cast<int32_t>(k), depth});
+        }
+    }
+    static void shift(std::vector<Slot>& side, int32_t step, uint32_t depth) {
+        for (int cascade = 0; cascade < 64; ++cascade) {
+            const int32_t deepest = side.back().price;
+            side.erase(side.begin());
+            side.push_back({deepest + step, depth});
+            if (side.front().depth > 0) break;
+        }
+    }
+    static void improve(std::vector<Slot>& side, int32_t price, uint32_t qty) {
+        side.pop_back();
+        side.insert(side.begin(), {price, qty});
+    }
+};
+
+/// Drives book and reference with the same random improve/execute/add stream
+/// and checks every level after every event.
+template <class Book>
+static void checkAgainstReference(size_t n) {
+    Book book;
+    book.seed(BookSeed{10000, static_cast<uint32_t>(n), 2, 6});
+    ReferenceLadder ref(9997, 10003, n, 2);
+
+    std::mt19937 gen(7);
+    uint64_t order_id = 1;
+    for (int step = 0; step < 20000; ++step) {
+        const int32_t bb = book.bestBid().price_ticks;
+        const int32_t ba = book.bestAsk().price_ticks;
+        const size_t k = gen() % n;
+        switch (gen() % 6) {
+            case 0:  // improve by a random amount inside the spread (may leave a gap)
+                if (ba - bb > 1) {
+                    const int32_t p = bb + 1 + static_cast<int32_t>(gen() % (ba - bb - 1));
+                    book.apply(SimEvent{EventType::ADD_BID, Side::BID, p, 1, order_id++});
+                    ReferenceLadder::improve(ref.bid, p, 1);
+                }
+                break;
+            case 1:
+                if (ba - bb > 1) {
+                    book.apply(SimEvent{EventType::ADD_ASK, Side::ASK, ba - 1, 1, order_id++});
+                    ReferenceLadder::improve(ref.ask, ba - 1, 1);
+                }
+                break;
+            case 2:
+                book.apply(SimEvent{EventType::EXECUTE_SELL, Side::BID, bb, 1, 0});
+                if (ref.bid[0].depth > 0 && --ref.bid[0].depth == 0)
+                    ReferenceLadder::shift(ref.bid, -1, ref.initial_depth);
+                break;
+            case 3:
+                book.apply(SimEvent{EventType::EXECUTE_BUY, Side::ASK, ba, 1, 0});
+                if (ref.ask[0].depth > 0 && --ref.ask[0].depth == 0)
+                    ReferenceLadder::shift(ref.ask, +1, ref.initial_depth);
+                break;
+            case 4:
+                book.apply(SimEvent{EventType::ADD_BID, Side::BID, bb - static_cast<int32_t>(k), 1,
+                                    order_id++});
+                ref.bid[k].depth += 1;
+                break;
+            default:
+                book.apply(SimEvent{EventType::ADD_ASK, Side::ASK, ba + static_cast<int32_t>(k), 1,
+                                    order_id++});
+                ref.ask[k].depth += 1;
+                break;
+        }
+        for (size_t i = 0; i < n; ++i) {
+            ASSERT_EQ(book.bidPriceAtLevel(i), ref.bid[i].price) << "step " << step << " bid " << i;
+            ASSERT_EQ(book.bidDepthAtLevel(i), ref.bid[i].depth) << "step " << step << " bid " << i;
+            ASSERT_EQ(book.askPriceAtLevel(i), ref.ask[i].price) << "step " << step << " ask " << i;
+            ASSERT_EQ(book.askDepthAtLevel(i), ref.ask[i].depth) << "step " << step << " ask " << i;
+        }
+    }
+}
+
+TEST(QrsdpBook, RingLadderMatchesShiftingReference) {
+    checkAgainstReference<MultiLevelBook>(64);  // full ring: every improve overwrites the old tail
+    checkAgainstReference<MultiLevelBook>(7);   // ring larger than the window
+}
+
+TEST(QrsdpBook, DeepBookBeyondSixtyFourLevels) {
+    checkAgainstReference<MultiLevelBook>(200);
+    MultiLevelBook book;
+    book.seed(BookSeed{10000, 200, 3, 2});
+    EXPECT_EQ(book.numLevels(), 200u);
+    EXPECT_EQ(book.bidPriceAtLevel(199), 9999 - 199);
+    EXPECT_EQ(book.askDepths().size, 200u);
+}
+
+TEST(QrsdpBook, FixedDepthBookMatchesReference) {
+    checkAgainstReference<MultiLevelBookN<5>>(5);
+    checkAgainstReference<MultiLevelBookN<20>>(20);
+    checkAgainstReference<MultiLevelBookN<3>>(3);  // not pre-instantiated: header-only path
+}
+
+TEST(QrsdpBook, FixedDepthBookRejectsOtherDepth) {
+    MultiLevelBookN<10> book;
+    EXPECT_THROW(book.seed(BookSeed{10000, 5, 3, 2}), std::invalid_argument);
+    EXPECT_NO_THROW(book.seed(BookSeed{10000, 10, 3, 2}));
+    EXPECT_EQ(book.numLevels(), 10u);
+}
+
+TEST(QrsdpBook, DepthSpansMatchLevelAccessors) {
+    MultiLevelBook book;
+    book.seed(BookSeed{10000, 20, 3, 4});
+    std::mt19937 gen(11);
+    for (int step = 0; step < 5000; ++step) {
+        const int32_t bb = book.bestBid().price_ticks;
+        const int32_t ba = book.bestAsk().price_ticks;
+        switch (gen() % 4) {
+            case 0: book.apply(SimEvent{EventType::EXECUTE_SELL, Side::BID, bb, 1, 0}); break;
+            case 1: book.apply(SimEvent{EventType::EXECUTE_BUY, Side::ASK, ba, 1, 0}); break;
+            case 2:
+                book.apply(SimEvent{EventType::ADD_BID, Side::BID,
+                                    ba - bb > 1 ? bb + 1 : bb - static_cast<int32_t>(gen() % 20), 1, 0});
+                break;
+            default:
+                book.apply(SimEvent{EventType::ADD_ASK, Side::ASK,
+                                    ba + static_cast<int32_t>(gen() % 20), 1, 0});
+                break;
+        }
+        const DepthSpan bids = book.bidDepths();
+        const DepthSpan asks = book.askDepths();
+        ASSERT_EQ(bids.size, book.numLevels());
+        ASSERT_EQ(asks.size, book.numLevels());
+        for (size_t k = 0; k < book.numLevels(); ++k) {
+            ASSERT_EQ(bids[k], book.bidDepthAtLevel(k)) << "step " << step << " level " << k;
+            ASSERT_EQ(asks[k], book.askDepthAtLevel(k)) << "step " << step << " level " << k;
+        }
+    }
+}
+
+TEST(QrsdpBook, SumDepthsMatchesScalar) {
+    std::mt19937 gen(3);
+    std::vector<uint32_t> d(71);
+    for (auto& x : d) x = gen();  // large values: the 64-bit widening matters
+    for (size_t n = 0; n <= d.size(); ++n) {
+        EXPECT_EQ(sumDepths(d.data(), n), sumDepthsScalar(d.data(), n)) << "n=" << n;
+        EXPECT_EQ(sumDepths(d.data() + 1, n - (n > 0)), sumDepthsScalar(d.data() + 1, n - (n > 0)))
+            << "unaligned n=" << n;
+    }
+}
+
+/// Level a linear cumulative-depth scan picks for u (the pre-index cancel selection).
+static size_t scanQuantileLevel(const DepthSpan& d, double u) {
+    const double total = static_cast<double>(sumDepthsScalar(d.data, d.size));
+    uint64_t cum = 0;
+    for (size_t k = 0; k < d.size; ++k) {
+        cum += d[k];
+        if (u < static_cast<double>(cum) / total) return k;
+    }
+    return d.size - 1;
+}
+
+TEST(QrsdpBook, DepthIndexMatchesLinearScan) {
+    MultiLevelBook book;
+    book.seed(BookSeed{10000, 13, 3, 4});
+    std::mt19937 gen(23);
+    Mt19937Rng rng(8);
+    for (int step = 0; step < 20000; ++step) {
+        const int32_t bb = book.bestBid().price_ticks;
+        const int32_t ba = book.bestAsk().price_ticks;
+        const int32_t k = static_cast<int32_t>(gen() % 13);
+        switch (gen() % 6) {
+            case 0: book.apply(SimEvent{EventType::EXECUTE_SELL, Side::BID, bb, 1, 0}); break;
+            case 1: book.apply(SimEvent{EventType::CANCEL_ASK, Side::ASK, ba + k, 2, 0}); break;
+            case 2: book.apply(SimEvent{EventType::CANCEL_BID, Side::BID, bb - k, 1, 0}); break;
+            case 3:
+                book.apply(SimEvent{EventType::ADD_BID, Side::BID, ba - bb > 1 ? bb + 1 : bb - k, 3, 0});
+                break;
+            default: book.apply(SimEvent{EventType::ADD_ASK, Side::ASK, ba + k, 1, 0}); break;
+        }
+        if (step % 1999 == 0) book.reinitialize(rng, 3.0);
+        if (step % 3 != 0) continue;  // let the index go stale between queries too
+        const LevelDepthIndex* bids = book.bidDepthIndex();
+        const LevelDepthIndex* asks = book.askDepthIndex();
+        ASSERT_NE(bids, nullptr);
+        ASSERT_NE(asks, nullptr);
+        ASSERT_EQ(bids->total(), sumDepthsScalar(book.bidDepths().data, book.numLevels())) << "step " << step;
+        ASSERT_EQ(asks->total(), sumDepthsScalar(book.askDepths().data, book.numLevels())) << "step " << step;
+        for (int j = 0; j < 8; ++j) {
+            const double u = rng.uniform();
+            ASSERT_EQ(bids->find(u), scanQuantileLevel(book.bidDepths(), u)) << "step " << step << " u " << u;
+            ASSERT_EQ(asks->find(u), scanQuantileLevel(book.askDepths(), u)) << "step " << step << " u " << u;
+        }
+    }
+}
+
 }  // namespace test
 }  // namespace qrsdp
@@ -0,0 +1,178 @@
+#include <gtest/gtest.h>
+#include "book/order_level_book.h"
+#include "book/multi_level_book.h"
+#include "book/order_pool.h"
+#include "producer/qrsdp_producer.h"
+#include "io/in_memory_sink.h"
+#include "model/simple_imbalance_intensity.h"
+#include "rng/mt19937_rng.h"
+#include "sampler/competing_intensity_sampler.h"
+#include "sampler/unit_size_attribute_sampler.h"
+#include "core/records.h"
+
+#include <random>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace qrsdp {
+namespace test {
+
+TEST(OrderLevelBook, ExecuteFillsOldestCancelRemovesNewest) {
+    OrderLevelBook book;
+    book.seed(BookSeed{10000, 3, 2, 2});  // best bid 9999 with two background orders
+    const std::vector<uint64_t> seeded = book.queueAtLevel(Side::BID, 0);
+    ASSERT_EQ(seeded.size(), 2u);
+    EXPECT_GE(seeded[0], kBackgroundOrderIdBase);
+
+    book.apply(SimEvent{EventType::ADD_BID, Side::BID, 9999, 1, 7});
+    book.apply(SimEvent{EventType::ADD_BID, Side::BID, 9999, 1, 8});
+    EXPECT_EQ(book.queueAtLevel(Side::BID, 0),
+              (std::vector<uint64_t>{seeded[0], seeded[1], 7, 8}));
+
+    book.apply(SimEvent{EventType::CANCEL_BID, Side::BID, 9999, 1, 9});
+    EXPECT_EQ(book.restingOrderId(), 8u) << "cancel hits the newest order";
+    EXPECT_EQ(book.orderQty(8), 0u);
+
+    book.apply(SimEvent{EventType::EXECUTE_SELL, Side::BID, 9999, 1, 10});
+    EXPECT_EQ(book.restingOrderId(), seeded[0]) << "execution hits the oldest order";
+    EXPECT_EQ(book.queueAtLevel(Side::BID, 0), (std::vector<uint64_t>{seeded[1], 7}));
+    EXPECT_EQ(book.bestBid().depth, 2u);
+    EXPECT_EQ(book.orderQty(7), 1u);
+
+    book.apply(SimEvent{EventType::ADD_ASK, Side::ASK, 10000, 1, 11});  // improvement
+    EXPECT_EQ(book.queueAtLevel(Side::ASK, 0), (std::vector<uint64_t>{11}));
+    EXPECT_EQ(book.restingOrderId(), 0u) << "adds hit no resting order";
+}
+
+TEST(OrderLevelBook, MatchesCountsBookUnderRandomEvents) {
+    for (size_t n : {3u, 8u, 64u}) {
+        OrderLevelBook book;
+        MultiLevelBook ref;
+        const BookSeed s{10000, static_cast<uint32_t>(n), 3, 4};
+        book.seed(s);
+        ref.seed(s);
+        Mt19937Rng rng_a(5), rng_b(5);
+        std::mt19937 gen(17);
+        uint64_t order_id = 1;
+        for (int step = 0; step < 20000; ++step) {
+            const int32_t bb = ref.bestBid().price_ticks;
+            const int32_t ba = ref.bestAsk().price_ticks;
+            const int32_t k = static_cast<int32_t>(gen() % n);
+            SimEvent e{EventType::ADD_BID, Side::BID, bb - k, static_cast<uint32_t>(1 + gen() % 2), order_id++};
+            switch (gen() % 7) {
+                case 0: e.price_ticks = ba - bb > 1 ? bb + 1 : bb - k; break;
+                case 1: e = SimEvent{EventType::ADD_ASK, Side::ASK, ba + k, 1, e.order_id}; break;
+                case 2: e = SimEvent{EventType::CANCEL_BID, Side::BID, bb - k, static_cast<uint32_t>(1 + gen() % 3), e.order_id}; break;
+                case 3: e = SimEvent{EventType::CANCEL_ASK, Side::ASK, ba + k, 1, e.order_id}; break;
+                case 4: e = SimEvent{EventType::EXECUTE_SELL, Side::BID, bb, 1, e.order_id}; break;
+                case 5: e = SimEvent{EventType::EXECUTE_BUY, Side::ASK, ba, 1, e.order_id}; break;
+                default: break;
+            }
+            book.apply(e);
+            ref.apply(e);
+            if (step % 997 == 0) {
+                book.reinitialize(rng_a, 4.0);
+                ref.reinitialize(rng_b, 4.0);
+            }
+            const BookDelta da = book.lastChange(), db = ref.lastChange();
+            ASSERT_EQ(da.full, db.full) << "step " << step;
+            if (!da.full) {
+                ASSERT_EQ(da.side, db.side) << "step " << step;
+                ASSERT_EQ(da.level, db.level) << "step " << step;
+            }
+            size_t total = 0;
+            for (size_t i = 0; i < n; ++i) {
+                ASSERT_EQ(book.bidPriceAtLevel(i), ref.bidPriceAtLevel(i)) << "step " << step;
+                ASSERT_EQ(book.askPriceAtLevel(i), ref.askPriceAtLevel(i)) << "step " << step;
+                ASSERT_EQ(book.bidDepthAtLevel(i), ref.bidDepthAtLevel(i)) << "step " << step;
+                ASSERT_EQ(book.askDepthAtLevel(i), ref.askDepthAtLevel(i)) << "step " << step;
+                ASSERT_EQ(book.bidDepths()[i], ref.bidDepthAtLevel(i));
+                total += book.bidDepthAtLevel(i) + book.askDepthAtLevel(i);
+            }
+            // Unit-size orders except the multi-share adds; count shares, not orders.
+            size_t shares = 0;
+            for (size_t i = 0; i < n; ++i) {
+                for (uint64_t id : book.queueAtLevel(Side::BID, i)) shares += book.orderQty(id);
+                for (uint64_t id : book.queueAtLevel(Side::ASK, i)) shares += book.orderQty(id);
+            }
+            ASSERT_EQ(shares, total) << "queues and depths disagree at step " << step;
+            if (step % 5 == 0) {
+                const double u = static_cast<double>(gen() % 1000) / 1000.0;
+                ASSERT_EQ(book.bidDepthIndex()->total(), ref.bidDepthIndex()->total()) << "step " << step;
+                ASSERT_EQ(book.askDepthIndex()->find(u), ref.askDepthIndex()->find(u)) << "step " << step;
+            }
+        }
+    }
+}
+
+TEST(OrderLevelBook, IndexMapMatchesUnorderedMap) {
+    OrderIndexMap map;
+    std::unordered_map<uint64_t, uint32_t> ref;
+    std::mt19937_64 gen(3);
+    for (int i = 0; i < 50000; ++i) {
+        const uint64_t key = 1 + gen() % 4096;  // dense keys: long probe runs and wrap-around
+        if (gen() % 3 == 0) {
+            map.erase(key);
+            ref.erase(key);
+        } else {
+            const uint32_t v = static_cast<uint32_t>(gen());
+            map.insert(key, v);
+            ref[key] = v;
+        }
+    }
+    ASSERT_EQ(map.size(), ref.size());
+    for (uint64_t key = 1; key <= 4096; ++key) {
+        const auto it = ref.find(key);
+        EXPECT_EQ(map.find(key), it == ref.end() ? kNilOrder : it->second) << "key " << key;
+    }
+}
+
+TEST(OrderLevelBook, ProducerReferencesRestingOrders) {
+    TradingSession session{};
+    session.seed = 99;
+    session.p0_ticks = 10000;
+    session.session_seconds = 60;
+    session.levels_per_side = 5;
+    session.tick_size = 100;
+    session.initial_spread_ticks = 2;
+    session.initial_depth = 5;
+    session.intensity_params = IntensityParams{20.0, 0.5, 15.0, 1.0, 1.0, 0.5, 0.4};
+
+    auto run = [&](IOrderBook& book, InMemorySink& sink) {
+        Mt19937Rng rng(session.seed);
+        SimpleImbalanceIntensity model(session.intensity_params);
+        CompetingIntensitySampler sampler(rng);
+        UnitSizeAttributeSampler attrs(rng, 0.5, 0.5);
+        QrsdpProducer producer(rng, book, model, sampler, attrs);
+        producer.runSession(session, sink);
+    };
+    OrderLevelBook order_book;
+    MultiLevelBook counts_book;
+    InMemorySink with_orders, counts_only;
+    run(order_book, with_orders);
+    run(counts_book, counts_only);
+
+    ASSERT_EQ(with_orders.size(), counts_only.size()) << "same event stream, only ids differ";
+    std::unordered_set<uint64_t> live;
+    size_t referenced = 0;
+    for (size_t i = 0; i < with_orders.size(); ++i) {
+        const EventRecord& a = with_orders.events()[i];
+        const EventRecord& b = counts_only.events()[i];
+        ASSERT_EQ(a.ts_ns, b.ts_ns);
+        ASSERT_EQ(a.type, b.type);
+        ASSERT_EQ(a.price_ticks, b.price_ticks);
+        const auto type = static_cast<EventType>(a.type);
+        if (type == EventType::ADD_BID || type == EventType::ADD_ASK) {
+            EXPECT_EQ(a.order_id, b.order_id);
+            live.insert(a.order_id);
+        } else if (a.order_id < kBackgroundOrderIdBase) {
+            EXPECT_EQ(live.count(a.order_id), 1u) << "record " << i << " hits an order never added";
+            ++referenced;
+        }
+    }
+    EXPECT_GT(referenced, 0u);
+}
+
+}  // namespace test
+}  // namespace qrsdp
@@ -1,11 +1,25 @@
 #include <gtest/gtest.h>
 #include "calibration/intensity_estimator.h"
 #include "calibration/intensity_curve_io.h"
+#include "calibration/online_calibrator.h"
+#include "calibration/sojourn_replay.h"
+#include "book/multi_level_book.h"
+#include "io/binary_file_sink.h"
+#include "io/event_log_reader.h"
+#include "io/in_memory_sink.h"
+#include "model/simple_imbalance_intensity.h"
+#include "producer/qrsdp_producer.h"
+#include "rng/mt19937_rng.h"
+#include "sampler/competing_intensity_sampler.h"
+#include "sampler/unit_size_attribute_sampler.h"
+#include "support/alloc_counter.h"
 #include "model/hlr_params.h"
 #include "core/records.h"
 #include "core/event_types.h"
+#include <algorithm>
 #include <cstdio>
 #include <string>
+#include <vector>
 
 namespace qrsdp {
 namespace test {
@@ -23,6 +37,352 @@ TEST(IntensityEstimator, LambdaTotalAndType) {
     EXPECT_NEAR(lambda_add, lambda_tot / 3.0, 0.01);
 }
 
+TEST(IntensityEstimator, MergeMatchesRecordingEverythingInOne) {
+    IntensityEstimator all, a, b;
+    all.recordSojourn(2, 0.5, EventType::ADD_BID);
+    a.recordSojourn(2, 0.5, EventType::ADD_BID);
+    all.recordSojourn(7, 0.25, EventType::CANCEL_BID);
+    b.recordSojourn(7, 0.25, EventType::CANCEL_BID);
+    all.recordSojourn(2, 1.5, EventType::CANCEL_BID);
+    b.recordSojourn(2, 1.5, EventType::CANCEL_BID);
+    a.merge(b);
+    EXPECT_EQ(a.nMaxObserved(), 7u);
+    for (uint32_t n : {0u, 2u, 7u}) {
+        EXPECT_DOUBLE_EQ(a.lambdaTotal(n), all.lambdaTotal(n)) << "n=" << n;
+        EXPECT_DOUBLE_EQ(a.lambdaType(n, EventType::CANCEL_BID), all.lambdaType(n, EventType::CANCEL_BID));
+    }
+}
+
+TEST(IntensityEstimator, FixedRangeMatchesGrowingAndPoolsOverflow) {
+    IntensityEstimator growing;
+    IntensityEstimator fixed(10);
+    EXPECT_EQ(fixed.nMax(), 10u);
+    for (uint32_t i = 0; i < 200; ++i) {
+        const uint32_t n = (i * 7) % 16;
+        const double dt = 0.01 * (1 + i % 5);
+        const EventType type = static_cast<EventType>(i % 6);
+        growing.recordSojourn(n, dt, type);
+        fixed.recordSojourn(n, dt, type);
+    }
+    for (uint32_t n = 0; n <= 10; ++n) {
+        EXPECT_DOUBLE_EQ(fixed.lambdaTotal(n), growing.lambdaTotal(n)) << "n=" << n;
+        EXPECT_DOUBLE_EQ(fixed.lambdaType(n, EventType::ADD_BID), growing.lambdaType(n, EventType::ADD_BID));
+    }
+    // Queues 11..15 share the overflow cell: every n above 10 reads it.
+    EXPECT_GT(fixed.lambdaTotal(11), 0.0);
+    EXPECT_DOUBLE_EQ(fixed.lambdaTotal(11), fixed.lambdaTotal(1000));
+    EXPECT_EQ(fixed.nMaxObserved(), 11u);
+    EXPECT_EQ(growing.nMaxObserved(), 15u);
+
+    fixed.reset();
+    EXPECT_EQ(fixed.lambdaTotal(3), 0.0);
+    const size_t before = allocationCount();
+    for (uint32_t n = 0; n < 1000; ++n) fixed.recordSojourn(n, 0.5, EventType::CANCEL_ASK);
+    EXPECT_EQ(allocationCount() - before, 0u) << "a fixed range records without allocating";
+}
+
+TEST(IntensityEstimator, FixedRangeMergeFoldsLargerQueuesIntoOverflow) {
+    IntensityEstimator a(4), b(4), wide;
+    a.recordSojourn(2, 1.0, EventType::ADD_ASK);
+    b.recordSojourn(2, 3.0, EventType::ADD_ASK);
+    b.recordSojourn(9, 2.0, EventType::CANCEL_ASK);
+    wide.recordSojourn(7, 2.0, EventType::CANCEL_ASK);
+    a.merge(b);
+    EXPECT_DOUBLE_EQ(a.lambdaTotal(2), 2.0 / 4.0);
+    EXPECT_DOUBLE_EQ(a.lambdaTotal(5), 1.0 / 2.0);
+    a.merge(wide);  // unbounded: n=7 lands in the overflow cell too
+    EXPECT_DOUBLE_EQ(a.lambdaTotal(5), 2.0 / 4.0);
+    EXPECT_DOUBLE_EQ(a.lambdaType(5, EventType::CANCEL_ASK), 2.0 / 4.0);
+}
+
+/// Writes a 120 s simulated session with a book checkpoint every 2 chunks.
+TEST(IntensityEstimator, DecayWeighsEarlierSojournsLess) {
+    IntensityEstimator e(8);
+    e.recordSojourn(2, 1.0, EventType::ADD_BID);
+    e.recordSojourn(2, 1.0, EventType::ADD_BID);
+    e.decay(0.5);
+    EXPECT_DOUBLE_EQ(e.lambdaTotal(2), 1.0) << "a decay alone leaves the rates";
+    EXPECT_DOUBLE_EQ(e.lambdaType(2, EventType::ADD_BID), 1.0);
+    e.recordSojourn(2, 3.0, EventType::ADD_ASK);
+    // (0.5 * 2 + 1) sojourns over (0.5 * 2.0 + 3.0) s, half of them ADD_ASK.
+    EXPECT_DOUBLE_EQ(e.lambdaTotal(2), 0.5);
+    EXPECT_DOUBLE_EQ(e.lambdaType(2, EventType::ADD_ASK), 0.25);
+    EXPECT_DOUBLE_EQ(e.lambdaType(2, EventType::ADD_BID), 0.25);
+    EXPECT_EQ(e.nMaxObserved(), 2u);
+}
+
+static std::string writeCheckpointedLog(const char* name) {
+    const std::string path = testing::TempDir() + name;
+    TradingSession session{};
+    session.seed = 515;
+    session.p0_ticks = 10000;
+    session.session_seconds = 120;
+    session.levels_per_side = 5;
+    session.tick_size = 100;
+    session.initial_spread_ticks = 2;
+    session.initial_depth = 5;
+    session.intensity_params = {20.0, 0.1, 5.0, 1.0, 1.0, 0.05, 0.0};
+    Mt19937Rng rng(session.seed);
+    MultiLevelBook book;
+    SimpleImbalanceIntensity model(session.intensity_params);
+    CompetingIntensitySampler sampler(rng);
+    UnitSizeAttributeSampler attrs(rng, 0.5);
+    QrsdpProducer producer(rng, book, model, sampler, attrs);
+    BinaryFileSinkOptions options;
+    options.chunk_capacity = 256;
+    options.checkpoint_interval = 2;
+    BinaryFileSink sink(path, session, options);
+    sink.setCheckpointSource([&](BookCheckpoint& cp) {
+        captureLevels(book, cp);
+        cp.next_order_id = producer.nextOrderId();
+    });
+    producer.runSession(session, sink);
+    sink.close();
+    return path;
+}
+
+TEST(SojournReplay, FirstSojournStartsAtTheMarketOpen) {
+    FileHeader h{};
+    h.p0_ticks = 10000;
+    h.levels_per_side = 3;
+    h.initial_spread_ticks = 2;
+    h.initial_depth = 5;
+    h.market_open_ns = 34'200'000'000'000ULL;  // 09:30
+    LevelEstimators out(3);
+    SojournReplay replay(h, 3, out);
+    DiskEventRecord add{};
+    add.ts_ns = h.market_open_ns + 1'500'000'000ULL;
+    add.type = static_cast<uint8_t>(EventType::ADD_BID);
+    add.side = static_cast<uint8_t>(Side::BID);
+    add.price_ticks = 9999;  // level 0
+    add.qty = 1;
+    add.order_id = 1;
+    replay.apply(add);
+    // One 1.5 s sojourn at the seed depth, not 09:30 plus 1.5 s of it.
+    EXPECT_NEAR(out.bid[0].dwellTime(5), 1.5, 1e-6);
+    EXPECT_NEAR(out.bid[0].lambdaType(5, EventType::ADD_BID), 1.0 / 1.5, 1e-6);
+}
+
+TEST(SojournReplay, CheckpointSegmentsMergeToTheSequentialEstimate) {
+    const std::string path = writeCheckpointedLog("test_calibration_segments.qrsdp");
+    EventLogReader reader(path);
+    ASSERT_GT(reader.checkpoints().size(), 2u);
+
+    const std::vector<CalibrationSegment> whole = planSegments(reader, 0, false);
+    ASSERT_EQ(whole.size(), 1u);
+    EXPECT_EQ(whole[0].end_record, reader.totalRecords());
+    LevelEstimators sequential(5);
+    replaySegment(reader, whole[0], 5, sequential);
+    EXPECT_EQ(sequential.events, reader.totalRecords());
+    EXPECT_GT(sequential.sojourns, 0u);
+
+    const std::vector<CalibrationSegment> split = planSegments(reader, 0, true);
+    ASSERT_GT(split.size(), 2u);
+    EXPECT_EQ(split.front().first_record, 0u);
+    EXPECT_EQ(split.front().checkpoint, -1);
+    EXPECT_EQ(split.back().end_record, reader.totalRecords());
+    LevelEstimators merged(5);
+    for (size_t i = 0; i < split.size(); ++i) {
+        if (i > 0) {
+            EXPECT_EQ(split[i].first_record, split[i - 1].end_record);
+            EXPECT_EQ(reader.checkpoints()[static_cast<size_t>(split[i].checkpoint)].record_index,
+                      split[i].first_record);
+        }
+        LevelEstimators part(5);
+        replaySegment(reader, split[i], 5, part);
+        merged.merge(part);
+    }
+    EXPECT_EQ(merged.events, sequential.events);
+    // Each boundary restarts the trackers: at most one sojourn per level and side
+    // differs, so the estimates agree closely.
+    const uint64_t slack = 2 * 5 * (split.size() - 1);
+    EXPECT_LE(merged.sojourns, sequential.sojourns + slack);
+    EXPECT_GE(merged.sojourns + slack, sequential.sojourns);
+    for (uint32_t n = 1; n <= 5; ++n) {
+        const double seq = sequential.bid[0].lambdaTotal(n);
+        if (seq <= 0.0) continue;
+        EXPECT_NEAR(merged.bid[0].lambdaTotal(n), seq, 0.05 * seq) << "n=" << n;
+    }
+    std::remove(path.c_str());
+}
+
+/// One session's records as a KafkaSink consumer receives them; close_mid_out is
+/// the book's mid at the close (the next chained session's p0).
+static std::vector<DiskEventRecord> sessionRecords(uint64_t seed, int32_t p0, int32_t& close_mid_out) {
+    TradingSession session{};
+    session.seed = seed;
+    session.p0_ticks = p0;
+    session.session_seconds = 60;
+    session.levels_per_side = 5;
+    session.tick_size = 100;
+    session.initial_spread_ticks = 2;
+    session.initial_depth = 5;
+    session.intensity_params = {20.0, 0.1, 5.0, 1.0, 1.0, 0.05, 0.0};
+    Mt19937Rng rng(seed);
+    MultiLevelBook book;
+    SimpleImbalanceIntensity model(session.intensity_params);
+    CompetingIntensitySampler sampler(rng);
+    UnitSizeAttributeSampler attrs(rng, 0.5);
+    QrsdpProducer producer(rng, book, model, sampler, attrs);
+    InMemorySink sink;
+    producer.runSession(session, sink);
+    close_mid_out = (book.bestBid().price_ticks + book.bestAsk().price_ticks) / 2;
+    std::vector<DiskEventRecord> out;
+    out.reserve(sink.size());
+    for (const EventRecord& e : sink.events()) {
+        DiskEventRecord r{};
+        r.ts_ns = e.ts_ns;
+        r.type = e.type;
+        r.side = e.side;
+        r.price_ticks = e.price_ticks;
+        r.qty = e.qty;
+        r.order_id = e.order_id;
+        out.push_back(r);
+    }
+    return out;
+}
+
+/// The batch calibration of one session: what qrsdp_calibrate records from its file.
+static void batchReplay(const std::vector<DiskEventRecord>& recs, int32_t p0, LevelEstimators& out) {
+    FileHeader h{};
+    h.p0_ticks = p0;
+    h.levels_per_side = 5;
+    h.initial_spread_ticks = 2;
+    h.initial_depth = 5;
+    h.market_open_ns = recs.front().ts_ns;  // the online calibrator opens at the first record
+    SojournReplay replay(h, 5, out);
+    for (const DiskEventRecord& r : recs) replay.apply(r);
+}
+
+static void expectSameCurves(const HLRParams& a, const HLRParams& b) {
+    ASSERT_EQ(a.K, b.K);
+    for (size_t k = 0; k < static_cast<size_t>(a.K); ++k) {
+        for (size_t n = 0; n <= 10; ++n) {
+            // Merged partial sums may round differently from one running sum.
+            const double l = b.lambda_L_bid[k].value(n);
+            const double c = b.lambda_C_ask[k].value(n);
+            ASSERT_NEAR(a.lambda_L_bid[k].value(n), l, 1e-12 * l) << k << "/" << n;
+            ASSERT_NEAR(a.lambda_C_ask[k].value(n), c, 1e-12 * c) << k << "/" << n;
+        }
+    }
+    EXPECT_NEAR(hlrCurveDrift(a, b), 0.0, 1e-12);
+}
+
+TEST(OnlineCalibrator, MatchesTheBatchCalibrationPerSymbolAndSession) {
+    int32_t a_close = 0, b_close = 0, a2_close = 0;
+    const std::vector<DiskEventRecord> a1 = sessionRecords(11, 10000, a_close);
+    const std::vector<DiskEventRecord> b1 = sessionRecords(12, 20000, b_close);
+    const std::vector<DiskEventRecord> a2 = sessionRecords(13, a_close, a2_close);  // chained day 2
+    ASSERT_GT(a1.size(), 1000u);
+
+    OnlineCalibrationConfig config;
+    config.levels = 5;
+    config.n_max = 30;
+    config.half_life_seconds = 0.0;  // no decay: plain sums, as the batch pass
+    config.p0_ticks = 0;             // from each symbol's first record
+    OnlineCalibrator calibrator(config);
+    // The two symbols interleave in message-sized runs, as on the topic.
+    for (size_t i = 0; i < std::max(a1.size(), b1.size()); i += 16) {
+        if (i < a1.size()) calibrator.apply("AAA", &a1[i], std::min<size_t>(16, a1.size() - i));
+        if (i < b1.size()) calibrator.apply("BBB", &b1[i], std::min<size_t>(16, b1.size() - i));
+    }
+    std::vector<SymbolCalibration> first = calibrator.publish();
+    ASSERT_EQ(first.size(), 2u);
+    EXPECT_EQ(calibrator.symbolCount(), 2u);
+    EXPECT_TRUE(first[0].first);
+    EXPECT_EQ(first[0].symbol, "AAA");
+    EXPECT_EQ(first[0].events, a1.size());
+
+    LevelEstimators a_batch(5), b_batch(5);
+    batchReplay(a1, 10000, a_batch);
+    batchReplay(b1, 20000, b_batch);
+    expectSameCurves(first[0].params, fitHLRParams(a_batch, 30, config.spread_sensitivity));
+    expectSameCurves(first[1].params, fitHLRParams(b_batch, 30, config.spread_sensitivity));
+    EXPECT_TRUE(calibrator.publish().empty()) << "nothing new to publish";
+
+    // Day 2 of AAA: the timestamps step back, the book reopens at the close mid.
+    calibrator.apply("AAA", a2.data(), a2.size());
+    std::vector<SymbolCalibration> second = calibrator.publish();
+    ASSERT_EQ(second.size(), 1u);
+    EXPECT_FALSE(second[0].first);
+    EXPECT_EQ(second[0].sessions, 2u);
+    LevelEstimators a2_batch(5);
+    batchReplay(a2, a_close, a2_batch);
+    a_batch.merge(a2_batch);
+    expectSameCurves(second[0].params, fitHLRParams(a_batch, 30, config.spread_sensitivity));
+    EXPECT_GT(second[0].drift, 0.0);
+    EXPECT_LT(second[0].drift, 1.0);
+    EXPECT_GT(hlrCurveDrift(first[0].params, second[0].params), second[0].drift)
+        << "unweighted, thinly observed queue sizes dominate";
+}
+
+TEST(OnlineCalibrator, JoiningMidSessionResyncsAtExecutionsUntilTheNextOpen) {
+    int32_t close = 0, unused = 0;
+    const std::vector<DiskEventRecord> day1 = sessionRecords(31, 10000, close);
+    const std::vector<DiskEventRecord> day2 = sessionRecords(32, close, unused);
+    OnlineCalibrationConfig config;
+    config.n_max = 30;
+    config.half_life_seconds = 0.0;
+    OnlineCalibrator calibrator(config);
+    const size_t joined = day1.size() / 3;
+    calibrator.apply("X", &day1[joined], day1.size() - joined);
+    const std::vector<SymbolCalibration> first = calibrator.publish();
+    ASSERT_EQ(first.size(), 1u);
+    EXPECT_GT(first[0].resyncs, 0u) << "the guessed book meets executions off its touch";
+
+    // By the close the touch is right again, so day 2 opens on the true book.
+    calibrator.apply("X", day2.data(), day2.size());
+    const std::vector<SymbolCalibration> second = calibrator.publish();
+    ASSERT_EQ(second.size(), 1u);
+    EXPECT_EQ(second[0].resyncs, first[0].resyncs);
+    EXPECT_EQ(second[0].sessions, 2u);
+}
+
+TEST(OnlineCalibrator, HalfLifeWeighsTheLatestSessionMore) {
+    int32_t close = 0, unused = 0;
+    const std::vector<DiskEventRecord> day1 = sessionRecords(21, 10000, close);
+    const std::vector<DiskEventRecord> day2 = sessionRecords(22, close, unused);
+    OnlineCalibrationConfig config;
+    config.n_max = 30;
+    config.p0_ticks = 10000;
+    config.half_life_seconds = 1.0;  // a 60 s session later, day 1 weighs 2^-60
+    OnlineCalibrator decayed(config);
+    decayed.apply("X", day1.data(), day1.size());
+    decayed.publish();
+    decayed.apply("X", day2.data(), day2.size());
+    const std::vector<SymbolCalibration> cal = decayed.publish();
+    ASSERT_EQ(cal.size(), 1u);
+
+    LevelEstimators only_day2(5);
+    batchReplay(day2, close, only_day2);
+    const HLRParams expected = fitHLRParams(only_day2, 30, config.spread_sensitivity);
+    // Where day 2 has sojourns it alone counts; elsewhere day 1's estimate stands.
+    EXPECT_LT(hlrCurveDrift(cal[0].params, expected, &only_day2), 1e-9);
+    EXPECT_GT(hlrCurveDrift(cal[0].params, expected), 0.0);
+}
+
+TEST(OnlineCalibrator, DriftPoolsCurvesAndWeighsByOccupancy) {
+    const HLRParams p = makeDefaultHLRParams(3, 20);
+    EXPECT_DOUBLE_EQ(hlrCurveDrift(p, p), 0.0);
+    HLRParams zeroed = p;
+    zeroed.lambda_C_bid[1].setTable(std::vector<double>(21, 0.0));
+    EXPECT_GT(hlrCurveDrift(p, zeroed), 0.0);
+    EXPECT_LT(hlrCurveDrift(p, zeroed), 1.0) << "pooled over every curve";
+    HLRParams silent = makeDefaultHLRParams(3, 20);
+    for (std::vector<IntensityCurve>* v : {&silent.lambda_L_bid, &silent.lambda_L_ask,
+                                          &silent.lambda_C_bid, &silent.lambda_C_ask})
+        for (IntensityCurve& c : *v) c.setTable(std::vector<double>(21, 0.0));
+    silent.lambda_M_buy.setTable(std::vector<double>(21, 0.0));
+    silent.lambda_M_sell.setTable(std::vector<double>(21, 0.0));
+    EXPECT_NEAR(hlrCurveDrift(p, silent), 1.0, 1e-9);
+    EXPECT_DOUBLE_EQ(hlrCurveDrift(p, makeDefaultHLRParams(4, 20)), 1.0);
+    LevelEstimators occupancy(3);
+    occupancy.bid[1].recordSojourn(4, 1.0, EventType::ADD_BID);
+    EXPECT_NEAR(hlrCurveDrift(p, zeroed, &occupancy), p.lambda_C_bid[1].value(4)
+                / (p.lambda_L_bid[1].value(4) + p.lambda_C_bid[1].value(4)), 1e-12)
+        << "only level 1's bid curves at n=4 count";
+}
+
 TEST(IntensityCurveIo, SaveAndLoad) {
     IntensityCurve c;
     c.setTable({1.0, 2.0, 3.0}, IntensityCurve::TailRule::FLAT);
@@ -74,6 +434,28 @@ TEST(HLRParamsIo, SaveAndLoadRoundTrip) {
     std::remove(path.c_str());
 }
 
+TEST(HLRParamsIo, SeasonalityRoundTrip) {
+    HLRParams orig = makeDefaultHLRParams(2, 5);
+    orig.seasonality = SeasonalityProfile(1800.0, {2.5, 1.0, 0.6, 1.0, 2.0});
+
+    const std::string path = "test_hlr_seasonality_tmp.json";
+    ASSERT_TRUE(saveHLRParamsToJson(path, orig));
+    HLRParams loaded;
+    ASSERT_TRUE(loadHLRParamsFromJson(path, loaded));
+    EXPECT_EQ(loaded.seasonality.bucketSeconds(), 1800.0);
+    EXPECT_EQ(loaded.seasonality.multipliers(), orig.seasonality.multipliers());
+
+    SeasonalityProfile only;
+    ASSERT_TRUE(loadSeasonalityFromJson(path, only));
+    EXPECT_EQ(only.buckets(), 5u);
+
+    ASSERT_TRUE(saveHLRParamsToJson(path, makeDefaultHLRParams(2, 5)));
+    EXPECT_FALSE(loadSeasonalityFromJson(path, only)) << "file without seasonality keys";
+    ASSERT_TRUE(loadHLRParamsFromJson(path, loaded));
+    EXPECT_TRUE(loaded.seasonality.empty());
+    std::remove(path.c_str());
+}
+
 TEST(HLRParamsIo, LoadBadPathFails) {
     HLRParams p;
     EXPECT_FALSE(loadHLRParamsFromJson("nonexistent_file_xyz.json", p));
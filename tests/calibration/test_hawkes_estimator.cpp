@@ -0,0 +1,120 @@
+#include <gtest/gtest.h>
+#include "calibration/hawkes_estimator.h"
+#include "model/hawkes_intensity_model.h"
+#include "model/hawkes_params.h"
+#include "core/records.h"
+#include "core/event_types.h"
+#include <cmath>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+namespace qrsdp {
+namespace test {
+
+namespace {
+
+constexpr size_t kBuy = static_cast<size_t>(EventType::EXECUTE_BUY);
+constexpr size_t kSell = static_cast<size_t>(EventType::EXECUTE_SELL);
+
+HawkesParams truth() {
+    HawkesParams p;
+    p.mu[kBuy] = 1.0;
+    p.mu[kSell] = 0.5;
+    HawkesKernel k;
+    k.beta = 5.0;
+    k.alpha[kBuy][kBuy] = 2.0;
+    k.alpha[kSell][kBuy] = 1.5;
+    k.alpha[kSell][kSell] = 1.0;
+    p.kernels = {k};
+    return p;
+}
+
+/// Ogata thinning of the constant-baseline model over [0, horizon].
+void simulate(const HawkesParams& p, uint64_t seed, double horizon, HawkesEstimator& est) {
+    HawkesIntensityModel model(p);
+    model.resetHistory(0.0);
+    const BookState state{};
+    std::mt19937_64 gen(seed);
+    std::uniform_real_distribution<double> u(0.0, 1.0);
+    est.beginSession();
+    double t = 0.0;
+    for (;;) {
+        double bound = model.totalAt(t);
+        for (;;) {
+            t += -std::log(1.0 - u(gen)) / bound;
+            if (t >= horizon) break;
+            const double lambda = model.totalAt(t);
+            if (u(gen) * bound < lambda) break;
+            bound = lambda;
+        }
+        if (t >= horizon) break;
+        model.advanceTo(t);
+        const Intensities in = model.compute(state);
+        double pick = u(gen) * in.total();
+        EventType type = EventType::EXECUTE_SELL;
+        for (int i = 0; i < kNumEventTypes; ++i) {
+            pick -= in.at(static_cast<EventType>(i));
+            if (pick < 0.0) {
+                type = static_cast<EventType>(i);
+                break;
+            }
+        }
+        est.recordEvent(t, type);
+        model.onEvent(type);
+    }
+    est.endSession(horizon);
+}
+
+}  // namespace
+
+TEST(HawkesEstimator, RecoversSimulatedParameters) {
+    const HawkesParams p = truth();
+    HawkesEstimator est({5.0});
+    for (uint64_t s = 0; s < 4; ++s) simulate(p, 100 + s, 1000.0, est);
+    ASSERT_EQ(est.sessions(), 4u);
+    EXPECT_DOUBLE_EQ(est.observedSeconds(), 4000.0);
+    ASSERT_GT(est.events(), 10000u);
+
+    const HawkesFitResult fit = est.fit();
+    EXPECT_TRUE(fit.converged);
+    const HawkesParams& q = fit.params;
+    // mu was fitted jointly with alpha, so the run must use it as the baseline.
+    EXPECT_EQ(q.baseline, HawkesBaseline::MU);
+    EXPECT_NEAR(q.mu[kBuy], 1.0, 0.2);
+    EXPECT_NEAR(q.mu[kSell], 0.5, 0.15);
+    EXPECT_NEAR(q.kernels[0].alpha[kBuy][kBuy], 2.0, 0.4);
+    EXPECT_NEAR(q.kernels[0].alpha[kSell][kBuy], 1.5, 0.3);
+    EXPECT_NEAR(q.kernels[0].alpha[kSell][kSell], 1.0, 0.3);
+    EXPECT_LT(q.kernels[0].alpha[kBuy][kSell], 0.2);
+    EXPECT_NEAR(hawkesBranchingRatio(q), hawkesBranchingRatio(p), 0.08);
+    // Types that never occur get nothing.
+    EXPECT_EQ(q.mu[0], 0.0);
+    EXPECT_EQ(q.kernels[0].alpha[0][kBuy], 0.0);
+    // The fit is at least as likely as the truth, and more likely than no excitation.
+    EXPECT_GE(fit.log_likelihood, est.logLikelihood(p) - 1e-6 * std::fabs(fit.log_likelihood));
+    HawkesParams poisson = q;
+    poisson.kernels[0].alpha = HawkesMatrix{};
+    EXPECT_GT(fit.log_likelihood, est.logLikelihood(poisson));
+}
+
+TEST(HawkesEstimator, EmptyAndInvalidInput) {
+    EXPECT_THROW(HawkesEstimator({1.0, 0.0}), std::invalid_argument);
+    HawkesEstimator est({1.0});
+    const HawkesFitResult none = est.fit();
+    EXPECT_EQ(none.params.kernels.size(), 1u);
+    EXPECT_EQ(none.params.kernels[0].beta, 1.0);
+    EXPECT_EQ(none.params.mu[kBuy], 0.0);
+    est.beginSession();
+    est.recordEvent(2.0, EventType::ADD_BID);
+    EXPECT_THROW(est.recordEvent(1.0, EventType::ADD_BID), std::invalid_argument);
+    est.endSession(1.0);  // never shorter than the last event
+    EXPECT_DOUBLE_EQ(est.observedSeconds(), 2.0);
+    est.recordEvent(0.5, EventType::ADD_BID);  // a new session starts from 0
+    est.endSession(3.0);
+    EXPECT_EQ(est.sessions(), 2u);
+    EXPECT_EQ(est.events(), 2u);
+}
+
+}  // namespace test
+}  // namespace qrsdp
@@ -0,0 +1,492 @@
+#include <gtest/gtest.h>
+#include "capi/qrsdp.h"
+#include "io/book_frame.h"
+#include "io/event_log_reader.h"
+#include "io/in_memory_sink.h"
+#include "io/shm_ring_sink.h"
+#include "book/multi_level_book.h"
+#include "model/simple_imbalance_intensity.h"
+#include "producer/qrsdp_producer.h"
+#include "rng/mt19937_rng.h"
+#include "sampler/competing_intensity_sampler.h"
+#include "sampler/unit_size_attribute_sampler.h"
+#include "core/records.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace qrsdp {
+namespace test {
+
+namespace fs = std::filesystem;
+
+static qrsdp_session_config shortSession(uint64_t seed) {
+    qrsdp_session_config config;
+    qrsdp_session_config_init(&config);
+    config.seed = seed;
+    config.session_seconds = 60;
+    return config;
+}
+
+static std::vector<qrsdp_event> drain(qrsdp_session* s, size_t batch) {
+    std::vector<qrsdp_event> events;
+    std::vector<qrsdp_event> buf(batch);
+    int64_t n;
+    while ((n = qrsdp_session_next(s, buf.data(), buf.size(), nullptr)) > 0)
+        events.insert(events.end(), buf.begin(), buf.begin() + n);
+    EXPECT_EQ(n, 0);
+    return events;
+}
+
+static void expectSameEvent(const qrsdp_event& a, uint64_t ts_ns, uint8_t type, uint8_t side,
+                            int32_t price, uint32_t qty, uint64_t order_id, size_t i) {
+    ASSERT_EQ(a.ts_ns, ts_ns) << "event " << i;
+    EXPECT_EQ(a.type, type) << "event " << i;
+    EXPECT_EQ(a.side, side) << "event " << i;
+    EXPECT_EQ(a.price_ticks, price) << "event " << i;
+    EXPECT_EQ(a.qty, qty) << "event " << i;
+    EXPECT_EQ(a.order_id, order_id) << "event " << i;
+}
+
+TEST(CApi, SessionMatchesQrsdpProducer) {
+    EXPECT_EQ(qrsdp_abi_version(), static_cast<uint32_t>(QRSDP_ABI_VERSION));
+    const qrsdp_session_config config = shortSession(11);
+    qrsdp_session* s = qrsdp_session_create(&config);
+    ASSERT_NE(s, nullptr) << qrsdp_last_error();
+    const std::vector<qrsdp_event> events = drain(s, 1000);
+
+    TradingSession session{};
+    session.seed = 11;
+    session.p0_ticks = 10000;
+    session.session_seconds = 60;
+    session.levels_per_side = 5;
+    session.tick_size = 100;
+    session.initial_spread_ticks = 2;
+    session.initial_depth = 5;
+    session.market_open_seconds = 34200;
+    session.intensity_params = {20.0, 0.5, 15.0, 1.0, 1.0, 0.5, 0.4};
+    Mt19937Rng rng(session.seed);
+    MultiLevelBook book;
+    SimpleImbalanceIntensity model(session.intensity_params);
+    CompetingIntensitySampler sampler(rng);
+    UnitSizeAttributeSampler attrs(rng, 0.5, 0.5);
+    QrsdpProducer producer(rng, book, model, sampler, attrs);
+    InMemorySink ref;
+    producer.runSession(session, ref);
+
+    ASSERT_GT(ref.size(), 1000u);
+    ASSERT_EQ(events.size(), ref.size());
+    for (size_t i = 0; i < events.size(); ++i) {
+        const EventRecord& r = ref.events()[i];
+        expectSameEvent(events[i], r.ts_ns, r.type, r.side, r.price_ticks, r.qty, r.order_id, i);
+    }
+
+    qrsdp_session_stats stats;
+    ASSERT_EQ(qrsdp_session_stats_get(s, &stats), QRSDP_OK);
+    EXPECT_EQ(stats.events, events.size());
+    EXPECT_EQ(stats.shifts, producer.shiftCountThisSession());
+    EXPECT_NE(stats.finished, 0);
+    qrsdp_event extra;
+    EXPECT_EQ(qrsdp_session_next(s, &extra, 1, nullptr), 0) << "an ended session stays ended";
+    qrsdp_session_destroy(s);
+}
+
+TEST(CApi, TopsFollowTheBook) {
+    qrsdp_session_config config = shortSession(5);
+    config.model = QRSDP_MODEL_HLR;
+    qrsdp_session* with_tops = qrsdp_session_create(&config);
+    qrsdp_session* plain = qrsdp_session_create(&config);
+    ASSERT_NE(with_tops, nullptr) << qrsdp_last_error();
+    ASSERT_NE(plain, nullptr);
+
+    std::vector<qrsdp_event> a(300), b(300);
+    std::vector<qrsdp_top> tops(300);
+    ASSERT_EQ(qrsdp_session_next(with_tops, a.data(), a.size(), tops.data()), 300);
+    ASSERT_EQ(qrsdp_session_next(plain, b.data(), b.size(), nullptr), 300);
+    for (size_t i = 0; i < a.size(); ++i) {
+        expectSameEvent(a[i], b[i].ts_ns, b[i].type, b[i].side, b[i].price_ticks, b[i].qty, b[i].order_id, i);
+        EXPECT_LT(tops[i].bid_ticks, tops[i].ask_ticks);
+    }
+
+    qrsdp_level bids[8], asks[8];
+    ASSERT_EQ(qrsdp_session_book(with_tops, bids, asks, 8), 5);
+    EXPECT_EQ(bids[0].price_ticks, tops.back().bid_ticks);
+    EXPECT_EQ(bids[0].depth, tops.back().bid_depth);
+    EXPECT_EQ(asks[0].price_ticks, tops.back().ask_ticks);
+    EXPECT_EQ(asks[0].depth, tops.back().ask_depth);
+    EXPECT_EQ(bids[1].price_ticks, bids[0].price_ticks - 1);
+    EXPECT_EQ(qrsdp_session_book(with_tops, bids, asks, 2), 2);
+    qrsdp_session_destroy(with_tops);
+    qrsdp_session_destroy(plain);
+}
+
+TEST(CApi, CallbackReceivesBatchesAndCanStop) {
+    const qrsdp_session_config config = shortSession(3);
+    qrsdp_session* all = qrsdp_session_create(&config);
+    qrsdp_session* stopped = qrsdp_session_create(&config);
+    ASSERT_NE(all, nullptr);
+    ASSERT_NE(stopped, nullptr);
+
+    struct Seen { uint64_t events = 0; uint64_t batches = 0; uint64_t stop_after = 0; };
+    const qrsdp_event_callback count = [](const qrsdp_event*, size_t n, void* user) {
+        Seen* seen = static_cast<Seen*>(user);
+        seen->events += n;
+        ++seen->batches;
+        return seen->stop_after > 0 && seen->batches >= seen->stop_after ? 1 : 0;
+    };
+
+    Seen full;
+    const int64_t total = qrsdp_session_run(all, count, &full, 512);
+    ASSERT_GT(total, 0);
+    EXPECT_EQ(full.events, static_cast<uint64_t>(total));
+    EXPECT_EQ(full.batches, (full.events + 511) / 512);
+
+    Seen partial;
+    partial.stop_after = 2;
+    EXPECT_EQ(qrsdp_session_run(stopped, count, &partial, 512), 1024);
+    qrsdp_session_stats stats;
+    qrsdp_session_stats_get(stopped, &stats);
+    EXPECT_EQ(stats.events, 1024u);
+    EXPECT_EQ(stats.finished, 0);
+    qrsdp_session_destroy(all);
+    qrsdp_session_destroy(stopped);
+}
+
+TEST(CApi, InvalidArgumentsReportAnError) {
+    qrsdp_session_config config = shortSession(1);
+    config.struct_size = 0;
+    EXPECT_EQ(qrsdp_session_create(&config), nullptr);
+    EXPECT_NE(std::string(qrsdp_last_error()).find("struct_size"), std::string::npos);
+
+    config = shortSession(1);
+    config.levels_per_side = 0;
+    EXPECT_EQ(qrsdp_session_create(&config), nullptr);
+    EXPECT_EQ(qrsdp_session_next(nullptr, nullptr, 0, nullptr), QRSDP_ERR_INVALID);
+
+    qrsdp_run_config run;
+    qrsdp_run_config_init(&run);
+    EXPECT_EQ(qrsdp_run(&run), nullptr) << "output_dir is required";
+    EXPECT_NE(std::string(qrsdp_last_error()).find("output_dir"), std::string::npos);
+    run.output_dir = "unused";
+    run.start_date = "2026/01/02";
+    EXPECT_EQ(qrsdp_run(&run), nullptr);
+    EXPECT_FALSE(fs::exists("unused"));
+}
+
+TEST(CApi, RunResultCountsMatchTheDayFiles) {
+    const std::string dir = testing::TempDir() + "capi_run_" + std::to_string(::testing::UnitTest::GetInstance()->random_seed());
+    fs::remove_all(dir);
+
+    qrsdp_run_config run;
+    qrsdp_run_config_init(&run);
+    run.output_dir = dir.c_str();
+    run.symbol = "TEST";
+    run.num_days = 2;
+    run.base_seed = 9;
+    run.threads = 2;
+    run.session.session_seconds = 60;
+    qrsdp_run_result* result = qrsdp_run(&run);
+    ASSERT_NE(result, nullptr) << qrsdp_last_error();
+    ASSERT_EQ(qrsdp_run_result_day_count(result), 2u);
+    EXPECT_TRUE(fs::exists(fs::path(dir) / "manifest.json"));
+
+    uint64_t total = 0;
+    for (size_t d = 0; d < 2; ++d) {
+        qrsdp_day_info day;
+        ASSERT_EQ(qrsdp_run_result_day(result, d, &day), QRSDP_OK);
+        EXPECT_STREQ(day.symbol, "TEST");
+        EventLogReader reader((fs::path(dir) / day.filename).string());
+        EXPECT_EQ(reader.totalRecords(), day.events);
+        EXPECT_EQ(reader.bars().size(), 3u) << "default bar resolutions";
+        total += day.events;
+
+        // A session handle with the day's seed and open regenerates the file.
+        qrsdp_session_config config = run.session;
+        config.seed = day.seed;
+        config.p0_ticks = day.open_ticks;
+        qrsdp_session* s = qrsdp_session_create(&config);
+        ASSERT_NE(s, nullptr);
+        const std::vector<qrsdp_event> events = drain(s, 4096);
+        qrsdp_session_destroy(s);
+        ASSERT_EQ(events.size(), day.events);
+        size_t i = 0;
+        reader.forEachRecordFrom(0, [&](const DiskEventRecord& r) {
+            if (i < events.size())
+                expectSameEvent(events[i], r.ts_ns, r.type, r.side, r.price_ticks, r.qty, r.order_id, i);
+            ++i;
+        });
+    }
+    EXPECT_EQ(qrsdp_run_result_total_events(result), total);
+    EXPECT_GT(qrsdp_run_result_elapsed_seconds(result), 0.0);
+    qrsdp_day_info out_of_range;
+    EXPECT_EQ(qrsdp_run_result_day(result, 2, &out_of_range), QRSDP_ERR_INVALID);
+    qrsdp_run_result_free(result);
+    fs::remove_all(dir);
+}
+
+class CApiLogTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        dir_ = testing::TempDir() + "capi_log_" + std::to_string(reinterpret_cast<uintptr_t>(this));
+        fs::remove_all(dir_);
+        qrsdp_run_config run;
+        qrsdp_run_config_init(&run);
+        run.output_dir = dir_.c_str();
+        run.columnar = 1;
+        run.session.session_seconds = 300;
+        qrsdp_run_result* result = qrsdp_run(&run);
+        ASSERT_NE(result, nullptr) << qrsdp_last_error();
+        qrsdp_day_info day;
+        qrsdp_run_result_day(result, 0, &day);
+        path_ = (fs::path(dir_) / day.filename).string();
+        qrsdp_run_result_free(result);
+    }
+
+    void TearDown() override { fs::remove_all(dir_); }
+
+    static void expectSameRecords(const qrsdp_records* got, const std::vector<DiskEventRecord>& want) {
+        ASSERT_NE(got, nullptr) << qrsdp_last_error();
+        ASSERT_EQ(qrsdp_records_count(got), want.size());
+        const qrsdp_event* data = qrsdp_records_data(got);
+        for (size_t i = 0; i < want.size(); ++i) {
+            const DiskEventRecord& r = want[i];
+            expectSameEvent(data[i], r.ts_ns, r.type, r.side, r.price_ticks, r.qty, r.order_id, i);
+        }
+    }
+
+    std::string dir_;
+    std::string path_;
+};
+
+TEST_F(CApiLogTest, ReadsMatchEventLogReader) {
+    EventLogReader reader(path_);
+    const std::vector<DiskEventRecord> all = reader.readAll();
+    ASSERT_GT(reader.chunkCount(), 3u);
+
+    for (uint32_t threads : {0u, 4u}) {
+        qrsdp_log* log = qrsdp_log_open(path_.c_str(), threads);
+        ASSERT_NE(log, nullptr) << qrsdp_last_error();
+        qrsdp_log_info info;
+        ASSERT_EQ(qrsdp_log_get_info(log, &info), QRSDP_OK);
+        EXPECT_EQ(info.version_minor, 1u) << "columnar";
+        EXPECT_EQ(info.total_records, all.size());
+        EXPECT_EQ(info.chunk_count, reader.chunkCount());
+        EXPECT_EQ(info.seed, reader.header().seed);
+        EXPECT_EQ(info.market_open_ns, reader.header().market_open_ns);
+
+        qrsdp_log_stats stats;
+        ASSERT_EQ(qrsdp_log_get_stats(log, &stats), QRSDP_OK) << qrsdp_last_error();
+        uint64_t counted = 0;
+        for (uint64_t n : stats.type_counts) counted += n;
+        EXPECT_EQ(counted, all.size());
+        EXPECT_EQ(stats.shifts_up + stats.shifts_down, reader.stats().shifts_up + reader.stats().shifts_down);
+
+        qrsdp_records* r = qrsdp_log_read(log, 0, UINT64_MAX);
+        expectSameRecords(r, all);
+        qrsdp_records_free(r);
+        qrsdp_log_close(log);
+    }
+
+    qrsdp_log* log = qrsdp_log_open(path_.c_str(), 0);
+    ASSERT_NE(log, nullptr);
+    const uint64_t first = reader.index()[0].record_count - 10;
+    qrsdp_records* r = qrsdp_log_read(log, first, first + 5000);
+    expectSameRecords(r, std::vector<DiskEventRecord>(all.begin() + first, all.begin() + first + 5000));
+    qrsdp_records_free(r);
+
+    r = qrsdp_log_read_chunks(log, 1, 3);
+    std::vector<DiskEventRecord> chunks = reader.readChunk(1);
+    const std::vector<DiskEventRecord> second = reader.readChunk(2);
+    chunks.insert(chunks.end(), second.begin(), second.end());
+    expectSameRecords(r, chunks);
+    qrsdp_records_free(r);
+    EXPECT_EQ(qrsdp_log_read_chunks(log, 2, reader.chunkCount() + 1), nullptr);
+
+    RecordQuery q;
+    q.ts_start = all[1000].ts_ns;
+    q.ts_end = all[3000].ts_ns;
+    r = qrsdp_log_select(log, q.ts_start, q.ts_end);
+    expectSameRecords(r, reader.select(q));
+    qrsdp_records_free(r);
+
+    r = qrsdp_log_read(log, 10, 10);
+    ASSERT_NE(r, nullptr);
+    EXPECT_EQ(qrsdp_records_count(r), 0u);
+    qrsdp_records_free(r);
+    qrsdp_log_close(log);
+}
+
+TEST_F(CApiLogTest, BarsAreViewedInPlace) {
+    EventLogReader reader(path_);
+    qrsdp_log* log = qrsdp_log_open(path_.c_str(), 0);
+    ASSERT_NE(log, nullptr);
+    uint64_t intervals[4] = {};
+    ASSERT_EQ(qrsdp_log_bar_intervals(log, intervals, 4), 3u);
+    EXPECT_EQ(intervals[1], 60'000'000'000ULL);
+
+    const qrsdp_bar* bars = nullptr;
+    ASSERT_EQ(qrsdp_log_bars(log, 60'000'000'000ULL, &bars), 5u);
+    const BarSeries* want = reader.barsAt(60'000'000'000ULL);
+    ASSERT_NE(want, nullptr);
+    uint64_t events = 0;
+    for (size_t k = 0; k < 5; ++k) {
+        EXPECT_EQ(bars[k].start_ns, want->bars[k].start_ns);
+        EXPECT_EQ(bars[k].close_mid2, want->bars[k].close_mid2);
+        events += bars[k].events;
+    }
+    EXPECT_EQ(events, reader.totalRecords());
+    const qrsdp_bar* again = nullptr;
+    qrsdp_log_bars(log, 60'000'000'000ULL, &again);
+    EXPECT_EQ(again, bars) << "a view into the open log, not a copy";
+    EXPECT_EQ(qrsdp_log_bars(log, 7, &bars), 0u);
+    EXPECT_EQ(bars, nullptr);
+    qrsdp_log_close(log);
+}
+
+TEST_F(CApiLogTest, FramesMatchABookFrameBuilder) {
+    EventLogReader reader(path_);
+    BookFrameOptions options;
+    options.frame_interval_ns = 5'000'000'000ULL;
+    options.recent_events = 4;
+    BookFrameBuilder builder(reader.header(), options);
+    std::vector<std::vector<char>> want;
+    std::vector<char> frame;
+    reader.forEachRecordFrom(0, [&](const DiskEventRecord& rec) {
+        if (builder.add(rec, frame)) want.push_back(frame);
+    });
+    if (builder.flush(frame)) want.push_back(frame);
+    ASSERT_GT(want.size(), 50u);
+
+    qrsdp_frames* frames = qrsdp_frames_open(path_.c_str(), options.frame_interval_ns, options.recent_events);
+    ASSERT_NE(frames, nullptr) << qrsdp_last_error();
+    const void* data = nullptr;
+    for (size_t i = 0; i < want.size(); ++i) {
+        const int64_t n = qrsdp_frames_next(frames, &data);
+        ASSERT_EQ(n, static_cast<int64_t>(want[i].size())) << "frame " << i;
+        EXPECT_EQ(std::memcmp(data, want[i].data(), want[i].size()), 0) << "frame " << i;
+    }
+    EXPECT_EQ(qrsdp_frames_next(frames, &data), 0);
+    EXPECT_EQ(data, nullptr);
+    EXPECT_EQ(qrsdp_frames_set_interval(frames, 0), QRSDP_ERR_INVALID);
+    qrsdp_frames_close(frames);
+
+    EXPECT_EQ(qrsdp_frames_open(path_.c_str(), 0, 4), nullptr);
+    EXPECT_EQ(qrsdp_frames_open("no_such_file.qrsdp", 1'000'000'000ULL, 4), nullptr);
+}
+
+TEST(CApi, FeedFollowsARealtimeRun) {
+    const std::string dir = testing::TempDir() + "capi_live_" + std::to_string(::testing::UnitTest::GetInstance()->random_seed());
+    fs::remove_all(dir);
+    const std::string ring = dir + ".ring";
+    fs::remove(ring);
+
+    qrsdp_run_config run;
+    qrsdp_run_config_init(&run);
+    run.output_dir = dir.c_str();
+    run.session.session_seconds = 30;
+    run.realtime = 1;
+    run.speed = 60.0;  // half a second of wall time
+    run.live_frames = ring.c_str();
+    run.live_frame_interval_ns = 250'000'000ULL;
+    qrsdp_run_result* result = nullptr;
+    std::thread runner([&] { result = qrsdp_run(&run); });
+
+    qrsdp_feed* feed = nullptr;
+    for (int i = 0; i < 2000 && !feed; ++i) {
+        feed = qrsdp_feed_attach(ring.c_str());
+        if (!feed) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    ASSERT_NE(feed, nullptr) << qrsdp_last_error();
+    std::vector<uint32_t> kinds;
+    qrsdp_day_end end{};
+    BookFrame last;
+    uint32_t kind;
+    const void* data;
+    size_t size;
+    int r;
+    while ((r = qrsdp_feed_next(feed, &kind, &data, &size)) != QRSDP_FEED_CLOSED) {
+        ASSERT_GE(r, 0);
+        if (r == QRSDP_FEED_EMPTY) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            continue;
+        }
+        kinds.push_back(kind);
+        if (kind == QRSDP_FEED_BOOK_FRAME)
+            decodeBookFrame(static_cast<const char*>(data), size, last);
+        else if (kind == QRSDP_FEED_DAY_END)
+            std::memcpy(&end, data, sizeof(end));
+    }
+    EXPECT_EQ(qrsdp_feed_dropped(feed), 0u);
+    qrsdp_feed_close(feed);
+    runner.join();
+    ASSERT_NE(result, nullptr) << qrsdp_last_error();
+
+    ASSERT_GT(kinds.size(), 10u);
+    EXPECT_EQ(kinds.front(), static_cast<uint32_t>(QRSDP_FEED_DAY_START)) << "the sticky day start";
+    EXPECT_EQ(kinds.back(), static_cast<uint32_t>(QRSDP_FEED_DAY_END));
+    qrsdp_day_info day;
+    ASSERT_EQ(qrsdp_run_result_day(result, 0, &day), QRSDP_OK);
+    EXPECT_EQ(end.events, day.events);
+    EXPECT_EQ(last.header.record_index, day.events);
+    qrsdp_run_result_free(result);
+    fs::remove_all(dir);
+    fs::remove(ring);
+}
+
+TEST(CApi, BusReadsTheBatchesASinkPublished) {
+    ShmRingConfig config;
+    config.path = testing::TempDir() + "capi_bus_" +
+                  std::to_string(::testing::UnitTest::GetInstance()->random_seed()) + ".ring";
+    config.ring_bytes = 1 << 16;
+    config.batch_records = 8;
+    ShmEventBus bus(config);
+    ShmRingSink sink(bus, 3, "CAPI", "2026-01-05");
+    std::vector<EventRecord> recs(20);
+    for (size_t i = 0; i < recs.size(); ++i) {
+        recs[i] = EventRecord{};
+        recs[i].ts_ns = 1000 + i;
+        recs[i].price_ticks = 10000 + static_cast<int32_t>(i);
+        recs[i].order_id = i;
+    }
+    sink.appendBatch(recs.data(), recs.size());
+    bus.close();
+
+    qrsdp_bus* reader = qrsdp_bus_attach(config.path.c_str(), 1);
+    ASSERT_NE(reader, nullptr) << qrsdp_last_error();
+    const qrsdp_bus_batch* batch = nullptr;
+    const qrsdp_event* events = nullptr;
+    size_t seen = 0;
+    int r;
+    while ((r = qrsdp_bus_next(reader, &batch, &events)) == QRSDP_FEED_MESSAGE) {
+        EXPECT_EQ(batch->first_seq, seen);
+        EXPECT_EQ(batch->security, 3u);
+        EXPECT_STREQ(batch->symbol, "CAPI");
+        EXPECT_STREQ(batch->date, "2026-01-05");
+        for (uint32_t k = 0; k < batch->count; ++k, ++seen)
+            expectSameEvent(events[k], recs[seen].ts_ns, 0, 0, recs[seen].price_ticks, 0, seen, seen);
+    }
+    EXPECT_EQ(r, QRSDP_FEED_CLOSED);
+    EXPECT_EQ(seen, recs.size());
+    EXPECT_EQ(qrsdp_bus_cursor(reader), recs.size());
+    EXPECT_EQ(qrsdp_bus_lost(reader), 0u);
+    qrsdp_bus_close(reader);
+    std::remove(config.path.c_str());
+
+    EXPECT_EQ(qrsdp_bus_attach("no_such_bus.ring", 0), nullptr);
+    EXPECT_EQ(qrsdp_bus_next(nullptr, &batch, &events), QRSDP_ERR_INVALID);
+}
+
+TEST(CApi, OpeningAMissingLogFails) {
+    EXPECT_EQ(qrsdp_log_open("no_such_file.qrsdp", 0), nullptr);
+    EXPECT_NE(std::string(qrsdp_last_error()), "");
+    EXPECT_EQ(qrsdp_log_read(nullptr, 0, 1), nullptr);
+}
+
+}  // namespace test
+}  // namespace qrsdp
@@ -0,0 +1,67 @@
+#include <gtest/gtest.h>
+#include "core/cpu_placement.h"
+
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace qrsdp {
+namespace test {
+
+TEST(CpuPlacement, ParsesAndFormatsCpuLists) {
+    EXPECT_EQ(parseCpuList("0-3,8,10-11"), (std::vector<int>{0, 1, 2, 3, 8, 10, 11}));
+    EXPECT_EQ(parseCpuList("5,1,1,2"), (std::vector<int>{1, 2, 5}));
+    EXPECT_EQ(formatCpuList({0, 1, 2, 3, 8, 10, 11}), "0-3,8,10-11");
+    EXPECT_EQ(formatCpuList({}), "");
+    for (const char* bad : {"", "a", "3-1", "1,,2", "1-", "-1", "0x1"})
+        EXPECT_THROW(parseCpuList(bad), std::invalid_argument) << bad;
+}
+
+TEST(CpuPlacement, NumaPolicyNamesRoundTrip) {
+    for (NumaPolicy p : {NumaPolicy::NONE, NumaPolicy::LOCAL, NumaPolicy::INTERLEAVE}) {
+        NumaPolicy back = NumaPolicy::NONE;
+        ASSERT_TRUE(parseNumaPolicy(numaPolicyName(p), back));
+        EXPECT_EQ(back, p);
+    }
+    NumaPolicy p;
+    EXPECT_FALSE(parseNumaPolicy("bind", p));
+}
+
+TEST(CpuPlacement, EveryOnlineCpuHasANode) {
+    const std::vector<int> cpus = onlineCpus();
+    ASSERT_FALSE(cpus.empty());
+    const std::vector<int> ordered = cpusByNode(cpus);
+    ASSERT_EQ(ordered.size(), cpus.size());
+    for (size_t i = 1; i < ordered.size(); ++i)
+        EXPECT_LE(cpuNumaNode(ordered[i - 1]), cpuNumaNode(ordered[i]));
+    ThreadPlacement placement;
+    EXPECT_FALSE(placement.enabled());
+    placement.cpus = {cpus.front()};
+    EXPECT_EQ(placement.cpuFor(3), cpus.front());
+    EXPECT_FALSE(placement.nodes().empty());
+    EXPECT_NE(placement.describe().find("numa=none"), std::string::npos);
+}
+
+TEST(CpuPlacement, IoThreadScopeStartsThreadsOnIoCpusAndRestores) {
+    const std::vector<int> allowed = currentThreadCpus();
+    if (allowed.empty()) GTEST_SKIP() << "thread affinity not supported here";
+
+    ThreadPlacement placement;
+    placement.io_cpus = {allowed.back()};
+    std::vector<int> child;
+    {
+        const IoThreadScope scope(placement);
+        std::thread([&] { child = currentThreadCpus(); }).join();
+    }
+    EXPECT_EQ(child, placement.io_cpus);
+    EXPECT_EQ(currentThreadCpus(), allowed);
+
+    std::thread([&] {
+        ASSERT_TRUE(pinCurrentThread(allowed.front()));
+        EXPECT_EQ(currentThreadCpus(), std::vector<int>{allowed.front()});
+    }).join();
+}
+
+}  // namespace test
+}  // namespace qrsdp
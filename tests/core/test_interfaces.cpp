@@ -14,7 +14,7 @@ namespace test {
 /// Step 3: Interface headers compile and have expected virtual APIs.
 
 TEST(QrsdpInterfaces, InterfacesCompile) {
-    static_assert(sizeof(EventRecord) == 30u);
+    static_assert(sizeof(EventRecord) == 32u);
     EXPECT_TRUE(true);
 }
 
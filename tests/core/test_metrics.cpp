@@ -0,0 +1,88 @@
+#include <gtest/gtest.h>
+#include "core/metrics.h"
+
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace qrsdp {
+namespace test {
+
+TEST(Metrics, CounterSumsAcrossThreads) {
+    Counter c;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 8; ++t) {
+        threads.emplace_back([&c] {
+            for (int i = 0; i < 10000; ++i) c.add();
+        });
+    }
+    for (auto& t : threads) t.join();
+    c.add(5);
+    EXPECT_EQ(c.value(), 80005u);
+}
+
+TEST(Metrics, HistogramPercentilesWithinBucketError) {
+    Histogram h;
+    EXPECT_EQ(h.percentile(0.5), 0u);
+    for (uint64_t v = 1; v <= 1000; ++v) h.record(v * 1000);
+    EXPECT_EQ(h.count(), 1000u);
+    EXPECT_EQ(h.sum(), 500500u * 1000u);
+    EXPECT_EQ(h.max(), 1000000u);
+    const uint64_t p50 = h.percentile(0.5);
+    EXPECT_GE(p50, 500000u);
+    EXPECT_LE(p50, 500000u + 500000u / 16);
+    EXPECT_EQ(h.percentile(1.0), 1000000u);
+}
+
+TEST(Metrics, LogLinearBucketsBoundTheirValues) {
+    for (uint64_t v : {0ull, 1ull, 15ull, 16ull, 17ull, 1000ull, 123456789ull, ~0ull}) {
+        const size_t b = logLinearBucket(v);
+        ASSERT_LT(b, kLogLinearBuckets);
+        EXPECT_GE(logLinearBucketUpper(b), v);
+        if (b > 0) {
+            EXPECT_LT(logLinearBucketUpper(b - 1), v);
+        }
+    }
+}
+
+TEST(Metrics, RegistryReturnsSameMetricForSameNameAndLabel) {
+    MetricsRegistry reg;
+    Counter& a = reg.counter("qrsdp_events_total", "Events", "symbol=\"AAA\"");
+    Counter& b = reg.counter("qrsdp_events_total", "Events", "symbol=\"BBB\"");
+    EXPECT_NE(&a, &b);
+    EXPECT_EQ(&a, &reg.counter("qrsdp_events_total", "Events", "symbol=\"AAA\""));
+    // Registering more metrics never moves the earlier ones.
+    for (int i = 0; i < 100; ++i) reg.gauge("g" + std::to_string(i), "gauge");
+    EXPECT_EQ(&a, &reg.counter("qrsdp_events_total", "Events", "symbol=\"AAA\""));
+}
+
+TEST(Metrics, PrometheusTextGroupsFamilies) {
+    MetricsRegistry reg;
+    reg.counter("qrsdp_events_total", "Events generated", "symbol=\"AAA\"").add(3);
+    reg.gauge("qrsdp_kafka_queue_depth", "Queue").set(7);
+    reg.counter("qrsdp_events_total", "Events generated", "symbol=\"BBB\"").add(4);
+    reg.histogram("qrsdp_step_ns", "Step").record(100);
+
+    const std::string text = reg.prometheusText();
+    EXPECT_NE(text.find("# TYPE qrsdp_events_total counter\n"
+                        "qrsdp_events_total{symbol=\"AAA\"} 3\n"
+                        "qrsdp_events_total{symbol=\"BBB\"} 4\n"), std::string::npos) << text;
+    EXPECT_NE(text.find("qrsdp_kafka_queue_depth 7\n"), std::string::npos);
+    EXPECT_NE(text.find("# TYPE qrsdp_step_ns summary\n"), std::string::npos);
+    EXPECT_NE(text.find("qrsdp_step_ns{quantile=\"0.99\"} 100\n"), std::string::npos);
+    EXPECT_NE(text.find("qrsdp_step_ns_count 1\n"), std::string::npos);
+    // One HELP per family.
+    EXPECT_EQ(text.find("# HELP qrsdp_events_total"), text.rfind("# HELP qrsdp_events_total"));
+}
+
+TEST(Metrics, JsonLineEscapesLabels) {
+    MetricsRegistry reg;
+    reg.counter("c", "counter", "symbol=\"AAA\"").add(2);
+    reg.histogram("h", "hist").record(5);
+    EXPECT_EQ(reg.jsonLine(),
+              "{\"c{symbol=\\\"AAA\\\"}\":2,"
+              "\"h\":{\"count\":1,\"sum\":5,\"p50\":5,\"p99\":5,\"p999\":5,\"max\":5}}");
+}
+
+}  // namespace test
+}  // namespace qrsdp
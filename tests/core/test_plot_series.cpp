@@ -0,0 +1,66 @@
+#include <gtest/gtest.h>
+#include "core/plot_series.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+namespace qrsdp {
+namespace test {
+
+TEST(PlotSeries, OverwritesTheOldestPointOnceFull) {
+    PlotSeries s(4);
+    for (int i = 0; i < 6; ++i) s.push(i, 10.0 * i);
+    ASSERT_EQ(s.size(), 4u);
+    EXPECT_EQ(s.capacity(), 4u);
+    for (size_t i = 0; i < 4; ++i) {
+        EXPECT_EQ(s.x(i), static_cast<double>(i + 2));
+        EXPECT_EQ(s.y(i), 10.0 * static_cast<double>(i + 2));
+    }
+    s.clear();
+    EXPECT_TRUE(s.empty());
+    s.push(7, 70);
+    EXPECT_EQ(s.x(0), 7.0);
+    EXPECT_THROW(PlotSeries(0), std::invalid_argument);
+}
+
+TEST(PlotSeries, MinMaxKeepsSpikesInOrder) {
+    PlotSeries s(10000);
+    for (int i = 0; i < 12000; ++i) {  // wraps: the series starts at x = 2000
+        const double y = i == 5000 ? 100.0 : i == 7777 ? -50.0 : std::sin(i * 0.01);
+        s.push(i, y);
+    }
+    std::vector<double> x, y;
+    decimateMinMax(s, 50, x, y);
+    ASSERT_LE(x.size(), 100u);
+    ASSERT_EQ(x.size(), y.size());
+    EXPECT_GE(x.front(), 2000.0);
+    EXPECT_LT(x.front(), 2200.0) << "the first point comes from the first bucket";
+    EXPECT_TRUE(std::is_sorted(x.begin(), x.end()));
+    EXPECT_EQ(*std::max_element(y.begin(), y.end()), 100.0);
+    EXPECT_EQ(*std::min_element(y.begin(), y.end()), -50.0);
+
+    PlotSeries small(100);
+    for (int i = 0; i < 60; ++i) small.push(i, i);
+    decimateMinMax(small, 50, x, y);
+    EXPECT_EQ(x.size(), 60u) << "short series are copied";
+}
+
+TEST(PlotSeries, LttbKeepsEndpointsAndShape) {
+    PlotSeries s(1000);
+    for (int i = 0; i < 1000; ++i) s.push(i * 0.5, i == 400 ? 9.0 : std::sin(i * 0.02));
+    std::vector<double> x, y;
+    decimateLttb(s, 100, x, y);
+    ASSERT_EQ(x.size(), 100u);
+    EXPECT_EQ(x.front(), 0.0);
+    EXPECT_EQ(x.back(), 999 * 0.5);
+    for (size_t i = 1; i < x.size(); ++i) EXPECT_LT(x[i - 1], x[i]);
+    EXPECT_EQ(*std::max_element(y.begin(), y.end()), 9.0) << "an outlier spans the largest triangle";
+
+    decimateLttb(s, 2, x, y);
+    EXPECT_EQ(x.size(), 1000u) << "fewer than 3 points: copied";
+}
+
+}  // namespace test
+}  // namespace qrsdp
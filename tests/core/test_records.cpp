@@ -1,6 +1,7 @@
 #include <gtest/gtest.h>
 #include "core/records.h"
 #include "core/event_types.h"
+#include <cstddef>
 #include <type_traits>
 
 namespace qrsdp {
@@ -11,12 +12,17 @@ TEST(QrsdpRecords, EventRecordIsTriviallyCopyable) {
 }
 
 TEST(QrsdpRecords, EventRecordFixedSize) {
-    static_assert(sizeof(EventRecord) == 30, "EventRecord must be 30 bytes packed");
-    EXPECT_EQ(sizeof(EventRecord), 30u);
+    static_assert(sizeof(EventRecord) == 32, "EventRecord must be 32 bytes");
+    EXPECT_EQ(sizeof(EventRecord), 32u);
 }
 
-TEST(QrsdpRecords, EventRecordNoPointers) {
-    static_assert(sizeof(EventRecord) == 30u);
+TEST(QrsdpRecords, EventRecordFieldsAreNaturallyAligned) {
+    static_assert(alignof(EventRecord) == 8u);
+    EXPECT_EQ(offsetof(EventRecord, ts_ns) % 8, 0u);
+    EXPECT_EQ(offsetof(EventRecord, order_id) % 8, 0u);
+    EXPECT_EQ(offsetof(EventRecord, price_ticks) % 4, 0u);
+    EXPECT_EQ(offsetof(EventRecord, qty) % 4, 0u);
+    EXPECT_EQ(offsetof(EventRecord, flags) % 4, 0u);
 }
 
 TEST(QrsdpRecords, IntensitiesTotalAndAt) {
@@ -0,0 +1,67 @@
+#include <gtest/gtest.h>
+#include "io/arrow_file_sink.h"
+#include "io/table_export.h"
+#include "core/records.h"
+
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+namespace qrsdp {
+namespace test {
+
+namespace fs = std::filesystem;
+
+static std::vector<char> readFile(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    return std::vector<char>((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+}
+
+TEST(ArrowFileSink, BatchesMatchTheEncoderAndAppearOnClose) {
+    const std::string path = testing::TempDir() + "qrsdp_arrow_file_sink_test.arrow";
+    fs::remove(path);
+    std::vector<EventRecord> recs(40);
+    for (size_t i = 0; i < recs.size(); ++i) {
+        recs[i].ts_ns = 100 * (i + 1);
+        recs[i].type = static_cast<uint8_t>(i % 6);
+        recs[i].side = static_cast<uint8_t>(i % 3);
+        recs[i].price_ticks = 5000 + static_cast<int32_t>(i % 7);
+        recs[i].qty = 1;
+        recs[i].order_id = i + 1;
+    }
+
+    ArrowFileSink sink(path, "AAPL", "2026-01-05", 16);
+    sink.append(recs[0]);
+    sink.appendBatch(recs.data() + 1, recs.size() - 1);
+    sink.flush();
+    EXPECT_FALSE(fs::exists(path)) << "only the temporary file exists until close()";
+    sink.close();
+    sink.close();
+    EXPECT_EQ(sink.recordsWritten(), 40u);
+    EXPECT_EQ(sink.batchesWritten(), 3u);  // 16 + 16 + 8
+
+    std::vector<DiskEventRecord> disk(recs.size());
+    for (size_t i = 0; i < recs.size(); ++i) {
+        disk[i].ts_ns = recs[i].ts_ns;
+        disk[i].type = recs[i].type;
+        disk[i].side = recs[i].side;
+        disk[i].price_ticks = recs[i].price_ticks;
+        disk[i].qty = recs[i].qty;
+        disk[i].order_id = recs[i].order_id;
+    }
+    std::vector<char> expected;
+    auto encoder = makeExportEncoder(ExportFormat::Arrow);
+    encoder->begin(expected);
+    for (size_t i = 0; i < disk.size(); i += 16)
+        encoder->batch(disk.data() + i, std::min<size_t>(16, disk.size() - i), "AAPL",
+                       daysSinceEpoch("2026-01-05"), expected);
+    encoder->end(expected);
+    EXPECT_EQ(readFile(path), expected);
+    EXPECT_FALSE(fs::exists(path + ".tmp"));
+    fs::remove(path);
+}
+
+}  // namespace test
+}  // namespace qrsdp
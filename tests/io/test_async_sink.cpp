@@ -0,0 +1,166 @@
+#include <gtest/gtest.h>
+#include "io/async_sink.h"
+#include "io/multiplex_sink.h"
+#include "io/in_memory_sink.h"
+#include "core/records.h"
+
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace qrsdp {
+namespace test {
+
+static EventRecord makeRecord(uint64_t ts) {
+    EventRecord r{};
+    r.ts_ns = ts;
+    r.price_ticks = 100;
+    r.qty = 1;
+    r.order_id = ts;
+    return r;
+}
+
+/// Holds the worker inside its first appendBatch until released, and records
+/// which thread flush/close ran on.
+class GatedSink : public IEventSink {
+public:
+    void append(const EventRecord& rec) override { appendBatch(&rec, 1); }
+    void appendBatch(const EventRecord* recs, size_t n) override {
+        entered = true;
+        while (!open) std::this_thread::yield();
+        mem.appendBatch(recs, n);
+    }
+    void flush() override { flush_thread = std::this_thread::get_id(); ++flushes; }
+    void close() override { ++closes; }
+
+    void waitEntered() const {
+        while (!entered) std::this_thread::yield();
+    }
+
+    InMemorySink mem;
+    std::atomic<bool> entered{false};
+    std::atomic<bool> open{false};
+    std::thread::id flush_thread;
+    int flushes = 0;
+    int closes = 0;
+};
+
+static std::vector<uint64_t> timestamps(const InMemorySink& sink) {
+    std::vector<uint64_t> ts;
+    for (const auto& r : sink.events()) ts.push_back(r.ts_ns);
+    return ts;
+}
+
+TEST(AsyncSink, DeliversInOrderAndFlushesOnWorker) {
+    GatedSink down;
+    down.open = true;
+    AsyncSink async(&down, {8, OverflowPolicy::BLOCK});
+    std::vector<EventRecord> recs;
+    for (uint64_t i = 0; i < 1000; ++i) recs.push_back(makeRecord(i));
+    async.appendBatch(recs.data(), 600);
+    for (size_t i = 600; i < recs.size(); ++i) async.append(recs[i]);
+    async.flush();
+
+    ASSERT_EQ(down.mem.size(), 1000u) << "flush waits for everything queued";
+    for (uint64_t i = 0; i < 1000; ++i) EXPECT_EQ(down.mem.events()[i].ts_ns, i);
+    EXPECT_EQ(down.flushes, 1);
+    EXPECT_NE(down.flush_thread, std::this_thread::get_id());
+
+    const AsyncSinkStats st = async.stats();
+    EXPECT_EQ(st.appended, 1000u);
+    EXPECT_EQ(st.written, 1000u);
+    EXPECT_EQ(st.dropped, 0u);
+    EXPECT_EQ(st.lag, 0u);
+    EXPECT_LE(st.max_lag, 8u);
+
+    async.close();
+    EXPECT_EQ(down.closes, 1);
+    async.append(makeRecord(1000));  // still usable after close
+    async.flush();
+    EXPECT_EQ(down.mem.size(), 1001u);
+}
+
+TEST(AsyncSink, DropNewestKeepsTheQueuedRecords) {
+    GatedSink down;
+    AsyncSink async(&down, {4, OverflowPolicy::DROP_NEWEST});
+    async.append(makeRecord(0));
+    down.waitEntered();  // worker holds record 0; the queue is empty again
+    for (uint64_t i = 1; i <= 10; ++i) async.append(makeRecord(i));
+    EXPECT_EQ(async.stats().lag, 4u);
+    EXPECT_EQ(async.stats().dropped, 6u);
+    down.open = true;
+    async.flush();
+    EXPECT_EQ(timestamps(down.mem), (std::vector<uint64_t>{0, 1, 2, 3, 4}));
+}
+
+TEST(AsyncSink, DropOldestKeepsTheLatestRecords) {
+    GatedSink down;
+    AsyncSink async(&down, {4, OverflowPolicy::DROP_OLDEST});
+    async.append(makeRecord(0));
+    down.waitEntered();
+    for (uint64_t i = 1; i <= 10; ++i) async.append(makeRecord(i));
+    EXPECT_EQ(async.stats().dropped, 6u);
+    down.open = true;
+    async.flush();
+    EXPECT_EQ(timestamps(down.mem), (std::vector<uint64_t>{0, 7, 8, 9, 10}));
+    EXPECT_EQ(async.stats().written, 5u);
+}
+
+TEST(AsyncSink, BlockWaitsForRoom) {
+    GatedSink down;
+    AsyncSink async(&down, {4, OverflowPolicy::BLOCK});
+    async.append(makeRecord(0));
+    down.waitEntered();
+    std::thread producer([&] {
+        for (uint64_t i = 1; i <= 20; ++i) async.append(makeRecord(i));
+    });
+    while (async.stats().stalls == 0) std::this_thread::yield();
+    down.open = true;
+    producer.join();
+    async.flush();
+    EXPECT_EQ(down.mem.size(), 21u);
+    EXPECT_EQ(async.stats().dropped, 0u);
+}
+
+class ThrowingSink : public IEventSink {
+public:
+    void append(const EventRecord&) override { throw std::runtime_error("intentional test failure"); }
+};
+
+TEST(AsyncSink, MultiplexFileSinkIsNotHeldBackBySlowSink) {
+    InMemorySink file;
+    GatedSink slow;
+    ThrowingSink bad;
+    MultiplexSink mux;
+    mux.addSink(&file);
+    AsyncSink& async = mux.addAsyncSink(&slow, {16, OverflowPolicy::DROP_NEWEST});
+    mux.addAsyncSink(&bad);
+    EXPECT_EQ(mux.sinkCount(), 3u);
+
+    std::vector<EventRecord> recs;
+    for (uint64_t i = 0; i < 100; ++i) recs.push_back(makeRecord(i));
+    mux.appendBatch(recs.data(), recs.size());  // returns although slow never opens
+    EXPECT_EQ(file.size(), 100u);
+    EXPECT_GT(async.stats().dropped, 0u);
+
+    slow.open = true;
+    mux.flush();
+    EXPECT_EQ(slow.mem.size() + async.stats().dropped, 100u);
+}
+
+TEST(AsyncSink, PolicyNamesRoundTrip) {
+    for (OverflowPolicy p : {OverflowPolicy::BLOCK, OverflowPolicy::DROP_OLDEST,
+                             OverflowPolicy::DROP_NEWEST}) {
+        OverflowPolicy parsed = OverflowPolicy::BLOCK;
+        ASSERT_TRUE(parseOverflowPolicy(overflowPolicyName(p), parsed));
+        EXPECT_EQ(parsed, p);
+    }
+    OverflowPolicy untouched = OverflowPolicy::DROP_NEWEST;
+    EXPECT_FALSE(parseOverflowPolicy("spill", untouched));
+    EXPECT_EQ(untouched, OverflowPolicy::DROP_NEWEST);
+}
+
+}  // namespace test
+}  // namespace qrsdp
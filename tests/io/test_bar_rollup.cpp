@@ -0,0 +1,199 @@
+#include <gtest/gtest.h>
+#include "io/bar_rollup.h"
+#include "io/binary_file_sink.h"
+#include "io/event_log_reader.h"
+#include "book/multi_level_book.h"
+#include "model/simple_imbalance_intensity.h"
+#include "producer/qrsdp_producer.h"
+#include "rng/mt19937_rng.h"
+#include "sampler/competing_intensity_sampler.h"
+#include "sampler/unit_size_attribute_sampler.h"
+#include "core/event_types.h"
+#include "core/records.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace qrsdp {
+namespace test {
+
+static constexpr uint64_t kOpenNs = 34200ULL * 1'000'000'000ULL;
+
+static FileHeader makeHeader() {
+    FileHeader h{};
+    h.p0_ticks = 100;
+    h.levels_per_side = 3;
+    h.initial_spread_ticks = 2;
+    h.initial_depth = 1;
+    h.market_open_ns = kOpenNs;
+    return h;
+}
+
+static DiskEventRecord makeRecord(EventType type, int32_t price, double t_seconds, uint32_t qty = 1) {
+    DiskEventRecord r{};
+    r.ts_ns = kOpenNs + static_cast<uint64_t>(t_seconds * 1e9);
+    r.type = static_cast<uint8_t>(type);
+    r.side = static_cast<uint8_t>(type == EventType::ADD_BID || type == EventType::CANCEL_BID
+                                  || type == EventType::EXECUTE_SELL ? Side::BID : Side::ASK);
+    r.price_ticks = price;
+    r.qty = qty;
+    return r;
+}
+
+static void expectSameBars(const std::vector<BarSeries>& a, const std::vector<BarSeries>& b) {
+    ASSERT_EQ(a.size(), b.size());
+    for (size_t s = 0; s < a.size(); ++s) {
+        EXPECT_EQ(a[s].interval_ns, b[s].interval_ns);
+        ASSERT_EQ(a[s].bars.size(), b[s].bars.size()) << "series " << s;
+        for (size_t k = 0; k < a[s].bars.size(); ++k) {
+            const DiskBar& x = a[s].bars[k];
+            const DiskBar& y = b[s].bars[k];
+            EXPECT_EQ(x.start_ns, y.start_ns);
+            EXPECT_EQ(x.open_mid2, y.open_mid2);
+            EXPECT_EQ(x.high_mid2, y.high_mid2);
+            EXPECT_EQ(x.low_mid2, y.low_mid2);
+            EXPECT_EQ(x.close_mid2, y.close_mid2);
+            EXPECT_EQ(x.close_bid_ticks, y.close_bid_ticks);
+            EXPECT_EQ(x.close_ask_ticks, y.close_ask_ticks);
+            EXPECT_EQ(x.events, y.events);
+            EXPECT_EQ(x.executions, y.executions);
+            EXPECT_EQ(x.volume, y.volume);
+        }
+    }
+}
+
+TEST(BarRollup, BuildsOhlcPerResolutionAndSkipsEmptyBars) {
+    // Bid 99, ask 101, one unit per level: each execution moves its side by a tick.
+    BarRollup rollup(makeHeader(), {60, 1, 0, 60});
+    ASSERT_EQ(rollup.series().size(), 2u) << "zero and duplicate resolutions are dropped";
+    EXPECT_EQ(rollup.series()[0].interval_ns, 1'000'000'000ULL);
+    EXPECT_EQ(rollup.series()[1].interval_ns, 60'000'000'000ULL);
+
+    rollup.add(makeRecord(EventType::EXECUTE_BUY, 101, 0.2));   // ask 102: mid2 201
+    rollup.add(makeRecord(EventType::ADD_BID, 99, 0.7, 3));     // mid2 201
+    rollup.add(makeRecord(EventType::EXECUTE_SELL, 99, 3.5));   // bid 99 depth 3 -> 2: mid2 201
+    rollup.add(makeRecord(EventType::EXECUTE_BUY, 102, 3.9, 2));  // ask 103: mid2 202
+    rollup.add(makeRecord(EventType::ADD_ASK, 102, 61.0));      // ask 102: mid2 201
+    EXPECT_EQ(rollup.records(), 5u);
+
+    const std::vector<DiskBar>& sec = rollup.series()[0].bars;
+    ASSERT_EQ(sec.size(), 3u);
+    EXPECT_EQ(sec[0].start_ns, kOpenNs);
+    EXPECT_EQ(sec[0].open_mid2, 201);
+    EXPECT_EQ(sec[0].events, 2u);
+    EXPECT_EQ(sec[0].executions, 1u);
+    EXPECT_EQ(sec[0].volume, 1u);
+    EXPECT_EQ(sec[1].start_ns, kOpenNs + 3'000'000'000ULL);
+    EXPECT_EQ(sec[1].open_mid2, 201);
+    EXPECT_EQ(sec[1].high_mid2, 202);
+    EXPECT_EQ(sec[1].close_mid2, 202);
+    EXPECT_EQ(sec[1].close_bid_ticks, 99);
+    EXPECT_EQ(sec[1].close_ask_ticks, 103);
+    EXPECT_EQ(sec[1].executions, 2u);
+    EXPECT_EQ(sec[1].volume, 3u);
+    EXPECT_EQ(sec[2].start_ns, kOpenNs + 61'000'000'000ULL);
+
+    const std::vector<DiskBar>& min = rollup.series()[1].bars;
+    ASSERT_EQ(min.size(), 2u);
+    EXPECT_EQ(min[0].events, 4u);
+    EXPECT_EQ(min[0].low_mid2, 201);
+    EXPECT_EQ(min[0].high_mid2, 202);
+    EXPECT_EQ(min[0].close_mid2, 202);
+    EXPECT_EQ(min[0].volume, 4u);
+    EXPECT_EQ(min[1].start_ns, kOpenNs + 60'000'000'000ULL);
+    EXPECT_EQ(min[1].close_mid2, 201);
+}
+
+TEST(BarRollup, EncodeDecodeRoundTrip) {
+    BarRollup rollup(makeHeader(), {1, 60, 300});
+    rollup.add(makeRecord(EventType::EXECUTE_BUY, 101, 0.5));
+    rollup.add(makeRecord(EventType::ADD_BID, 100, 90.0));
+
+    std::vector<char> payload;
+    encodeBars(rollup.series(), payload);
+    EXPECT_EQ(payload.size(), sizeof(BarBlockHeader) + 3 * sizeof(BarSeriesHeader) + 5 * sizeof(DiskBar));
+    expectSameBars(decodeBars(payload.data(), payload.size()), rollup.series());
+
+    EXPECT_THROW(decodeBars(payload.data(), payload.size() - 1), std::runtime_error);
+    EXPECT_THROW(decodeBars(payload.data(), 4), std::runtime_error);
+}
+
+class BarBlockTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        path_ = testing::TempDir() + "test_bars_" +
+                std::to_string(reinterpret_cast<uintptr_t>(this)) + ".qrsdp";
+    }
+
+    void TearDown() override {
+        std::remove(path_.c_str());
+    }
+
+    /// Runs a seeded session into a BinaryFileSink at path_; returns the final book's mid2.
+    int32_t writeSession(const BinaryFileSinkOptions& options) {
+        TradingSession session{};
+        session.seed = 7;
+        session.p0_ticks = 10000;
+        session.session_seconds = 90;
+        session.levels_per_side = 5;
+        session.tick_size = 100;
+        session.initial_spread_ticks = 2;
+        session.initial_depth = 5;
+        session.market_open_seconds = 34200;
+        session.intensity_params = {20.0, 0.5, 15.0, 1.0, 1.0, 0.5, 0.4};
+
+        Mt19937Rng rng(session.seed);
+        MultiLevelBook book;
+        SimpleImbalanceIntensity model(session.intensity_params);
+        CompetingIntensitySampler sampler(rng);
+        UnitSizeAttributeSampler attrs(rng, 0.5, 0.5);
+        QrsdpProducer producer(rng, book, model, sampler, attrs);
+        BinaryFileSink sink(path_, session, options);
+        producer.runSession(session, sink);
+        sink.close();
+        return book.bestBid().price_ticks + book.bestAsk().price_ticks;
+    }
+
+    std::string path_;
+};
+
+TEST_F(BarBlockTest, FooterBarsMatchAFullReplay) {
+    BinaryFileSinkOptions options;
+    options.chunk_capacity = 512;
+    options.write_buffers = 2;
+    options.seek_stride = 64;
+    options.bar_seconds = {1, 60, 300};
+    const int32_t final_mid2 = writeSession(options);
+
+    EventLogReader reader(path_);
+    ASSERT_EQ(reader.bars().size(), 3u);
+    ASSERT_NE(reader.barsAt(60'000'000'000ULL), nullptr);
+    EXPECT_EQ(reader.barsAt(10'000'000'000ULL), nullptr);
+    EXPECT_TRUE(reader.hasSeekIndex()) << "other trailing blocks still load";
+
+    BarRollup replay(reader.header(), {1, 60, 300});
+    reader.forEachRecordFrom(0, [&](const DiskEventRecord& rec) { replay.add(rec); });
+    expectSameBars(reader.bars(), replay.series());
+
+    for (const BarSeries& series : reader.bars()) {
+        uint64_t events = 0;
+        for (const DiskBar& bar : series.bars) events += bar.events;
+        EXPECT_EQ(events, reader.totalRecords());
+        ASSERT_FALSE(series.bars.empty());
+        EXPECT_EQ(series.bars.back().close_mid2, final_mid2) << "bars follow the producer's book";
+    }
+    EXPECT_EQ(reader.barsAt(300'000'000'000ULL)->bars.size(), 1u);
+}
+
+TEST_F(BarBlockTest, NoBarsByDefault) {
+    writeSession(BinaryFileSinkOptions{});
+    EventLogReader reader(path_);
+    EXPECT_TRUE(reader.bars().empty());
+    EXPECT_EQ(reader.barsAt(1'000'000'000ULL), nullptr);
+}
+
+}  // namespace test
+}  // namespace qrsdp
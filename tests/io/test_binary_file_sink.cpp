@@ -1,12 +1,15 @@
 #include <gtest/gtest.h>
 #include "io/binary_file_sink.h"
+#include "io/event_log_reader.h"
 #include "io/event_log_format.h"
 #include "core/records.h"
 
 #include <lz4.h>
 
+#include <algorithm>
 #include <cstdio>
 #include <cstring>
+#include <stdexcept>
 #include <string>
 #include <vector>
 
@@ -263,11 +266,41 @@ TEST_F(BinaryFileSinkTest, FlagsNotWrittenToDisk) {
                         static_cast<int>(chdr.uncompressed_size));
 
     // DiskEventRecord is 26 bytes with no flags field.
-    // Verify the raw bytes contain exactly one 26-byte record, not 30 bytes.
+    // Verify the raw bytes contain exactly one 26-byte record, not the 32-byte
+    // in-memory one.
     EXPECT_EQ(chdr.uncompressed_size, sizeof(DiskEventRecord));
     EXPECT_EQ(chdr.record_count, 1u);
 }
 
+TEST(DiskEventRecordTest, BatchConversionMatchesPerRecord) {
+    std::vector<EventRecord> recs(37);
+    for (size_t i = 0; i < recs.size(); ++i) {
+        recs[i] = EventRecord{};
+        recs[i].ts_ns = 1000000007ULL * i;
+        recs[i].type = static_cast<uint8_t>(i % 6);
+        recs[i].side = static_cast<uint8_t>(i % 3);
+        recs[i].price_ticks = 10000 - static_cast<int32_t>(i);
+        recs[i].qty = static_cast<uint32_t>(i + 1);
+        recs[i].order_id = 0xABCD000000000000ULL + i;
+        recs[i].flags = kFlagShiftUp;
+    }
+    std::vector<DiskEventRecord> disk(recs.size());
+    toDisk(recs.data(), recs.size(), disk.data());
+    std::vector<EventRecord> back(recs.size());
+    fromDisk(disk.data(), disk.size(), back.data());
+    for (size_t i = 0; i < recs.size(); ++i) {
+        const DiskEventRecord one = toDisk(recs[i]);
+        EXPECT_EQ(std::memcmp(&disk[i], &one, sizeof(one)), 0) << i;
+        EXPECT_EQ(back[i].ts_ns, recs[i].ts_ns);
+        EXPECT_EQ(back[i].type, recs[i].type);
+        EXPECT_EQ(back[i].side, recs[i].side);
+        EXPECT_EQ(back[i].price_ticks, recs[i].price_ticks);
+        EXPECT_EQ(back[i].qty, recs[i].qty);
+        EXPECT_EQ(back[i].order_id, recs[i].order_id);
+        EXPECT_EQ(back[i].flags, kFlagNone) << "flags are not stored on disk";
+    }
+}
+
 // --- Chunk Index Footer ---
 
 TEST_F(BinaryFileSinkTest, IndexFooterPresent) {
@@ -410,5 +443,177 @@ TEST_F(BinaryFileSinkTest, DestructorFlushesAndCloses) {
     std::fclose(f);
 }
 
+// --- Batched append ---
+
+static std::vector<char> readFileBytes(const std::string& path) {
+    std::vector<char> bytes;
+    std::FILE* f = std::fopen(path.c_str(), "rb");
+    if (!f) return bytes;
+    char buf[4096];
+    size_t n;
+    while ((n = std::fread(buf, 1, sizeof(buf), f)) > 0) bytes.insert(bytes.end(), buf, buf + n);
+    std::fclose(f);
+    return bytes;
+}
+
+TEST_F(BinaryFileSinkTest, AppendBatchMatchesPerRecordAppend) {
+    auto session = makeTestSession();
+    constexpr uint32_t kChunkCap = 8;
+    std::vector<EventRecord> recs;
+    for (int i = 0; i < 25; ++i) {
+        recs.push_back(makeRecord(static_cast<uint64_t>(i) * 500000,
+                                  static_cast<uint8_t>(i % 6), static_cast<uint8_t>(i % 2),
+                                  100000 + i, 1, static_cast<uint64_t>(i + 1)));
+    }
+
+    {
+        BinaryFileSink sink(path_, session, kChunkCap);
+        for (const auto& r : recs) sink.append(r);
+    }
+    const std::string batch_path = path_ + ".batch";
+    {
+        BinaryFileSink sink(batch_path, session, kChunkCap);
+        sink.appendBatch(recs.data(), 3);        // partial chunk
+        sink.appendBatch(recs.data() + 3, 10);   // completes one chunk, spills into the next
+        sink.appendBatch(recs.data() + 13, 12);  // crosses a boundary, leaves a tail of 1
+        EXPECT_EQ(sink.chunksWritten(), 3u);
+    }
+
+    const auto expected = readFileBytes(path_);
+    const auto actual = readFileBytes(batch_path);
+    std::remove(batch_path.c_str());
+    ASSERT_FALSE(expected.empty());
+    EXPECT_EQ(actual, expected);
+}
+
+// --- Async (background writer) mode ---
+
+TEST_F(BinaryFileSinkTest, AsyncWriterMatchesSynchronousFile) {
+    auto session = makeTestSession();
+    constexpr uint32_t kChunkCap = 16;
+    std::vector<EventRecord> recs;
+    for (int i = 0; i < 2000; ++i) {
+        recs.push_back(makeRecord(static_cast<uint64_t>(i) * 250000,
+                                  static_cast<uint8_t>(i % 6), static_cast<uint8_t>(i % 2),
+                                  100000 + (i * 7) % 31, 1 + i % 3, static_cast<uint64_t>(i + 1)));
+    }
+    {
+        BinaryFileSink sink(path_, session, kChunkCap);
+        for (const auto& r : recs) sink.append(r);
+    }
+    const auto expected = readFileBytes(path_);
+    ASSERT_FALSE(expected.empty());
+
+    for (uint32_t buffers : {2u, 3u, 8u}) {
+        const std::string async_path = path_ + ".async" + std::to_string(buffers);
+        {
+            BinaryFileSink sink(async_path, session, kChunkCap, buffers);
+            EXPECT_TRUE(sink.isAsync());
+            sink.appendBatch(recs.data(), 5);
+            for (size_t i = 5; i < 1000; ++i) sink.append(recs[i]);
+            sink.flush();  // partial chunk mid-stream, as a synchronous flush would write
+            sink.appendBatch(recs.data() + 1000, recs.size() - 1000);
+            EXPECT_EQ(sink.recordsWritten(), 1000u + 992u);  // 8-record tail still buffered
+            sink.close();
+            EXPECT_EQ(sink.recordsWritten(), recs.size());
+        }
+        const std::string sync_path = path_ + ".sync";
+        {
+            BinaryFileSink sink(sync_path, session, kChunkCap);
+            sink.appendBatch(recs.data(), 1000);
+            sink.flush();
+            sink.appendBatch(recs.data() + 1000, recs.size() - 1000);
+        }
+        const auto actual = readFileBytes(async_path);
+        const auto reference = readFileBytes(sync_path);
+        std::remove(async_path.c_str());
+        std::remove(sync_path.c_str());
+        EXPECT_EQ(actual, reference) << "buffers " << buffers;
+    }
+
+    // Without the mid-stream flush the chunking is the default one.
+    const std::string async_path = path_ + ".async";
+    {
+        BinaryFileSink sink(async_path, session, kChunkCap, 2);
+        for (const auto& r : recs) sink.append(r);
+    }  // destructor joins the writer and writes the index
+    EXPECT_EQ(readFileBytes(async_path), expected);
+    std::remove(async_path.c_str());
+}
+
+// --- Footer stats ---
+
+TEST_F(BinaryFileSinkTest, FooterStatsSummariseEachChunk) {
+    auto session = makeTestSession();
+    constexpr uint32_t kChunkCap = 16;
+    std::vector<EventRecord> recs;
+    for (int i = 0; i < 1000; ++i) {
+        EventRecord r = makeRecord(static_cast<uint64_t>(i) * 250000,
+                                   static_cast<uint8_t>(i % 6), static_cast<uint8_t>(i % 2),
+                                   100000 + (i * 7) % 31 - 15, 1 + i % 3, static_cast<uint64_t>(i + 1));
+        r.flags = kFlagNone;
+        if (i % 5 == 4) r.flags = kFlagShiftUp;
+        if (i % 7 == 6) r.flags = kFlagShiftDown | (i % 21 == 20 ? kFlagReinit : kFlagNone);
+        recs.push_back(r);
+    }
+
+    for (uint32_t buffers : {0u, 3u}) {
+        {
+            BinaryFileSink sink(path_, session, kChunkCap, buffers);
+            sink.appendBatch(recs.data(), 300);
+            sink.flush();  // a short chunk mid-stream
+            for (size_t i = 300; i < recs.size(); ++i) sink.append(recs[i]);
+        }
+        EventLogReader reader(path_);
+        ASSERT_TRUE(reader.hasStats());
+        ASSERT_EQ(reader.chunkStats().size(), reader.chunkCount());
+
+        size_t next = 0;
+        for (uint32_t c = 0; c < reader.chunkCount(); ++c) {
+            ChunkStats expected{};
+            const auto rows = reader.readChunk(c);
+            expected.min_price_ticks = expected.max_price_ticks = rows.front().price_ticks;
+            for (const DiskEventRecord& rec : rows) {
+                ++expected.type_counts[rec.type];
+                expected.min_price_ticks = std::min(expected.min_price_ticks, rec.price_ticks);
+                expected.max_price_ticks = std::max(expected.max_price_ticks, rec.price_ticks);
+                if (rec.type == 4 || rec.type == 5) expected.executed_qty += rec.qty;
+                const uint32_t flags = recs[next++].flags;
+                expected.shifts_up += (flags & kFlagShiftUp) ? 1 : 0;
+                expected.shifts_down += (flags & kFlagShiftDown) ? 1 : 0;
+                expected.reinits += (flags & kFlagReinit) ? 1 : 0;
+            }
+            EXPECT_EQ(std::memcmp(&reader.chunkStats()[c], &expected, sizeof(ChunkStats)), 0)
+                << "buffers " << buffers << " chunk " << c;
+        }
+
+        const LogStats total = reader.stats();
+        uint64_t events = 0;
+        for (uint64_t n : total.type_counts) events += n;
+        EXPECT_EQ(events, recs.size());
+        EXPECT_EQ(total.min_price_ticks, 100000 - 15);
+        EXPECT_EQ(total.max_price_ticks, 100000 + 15);
+        EXPECT_EQ(total.shifts_up, 172u);
+        EXPECT_EQ(total.shifts_down, 142u);
+        EXPECT_EQ(total.reinits, 47u);
+    }
+}
+
+TEST_F(BinaryFileSinkTest, FooterStatsCanBeTurnedOff) {
+    auto session = makeTestSession();
+    BinaryFileSinkOptions options;
+    options.chunk_capacity = 8;
+    options.stats = false;
+    {
+        BinaryFileSink sink(path_, session, options);
+        for (int i = 0; i < 20; ++i)
+            sink.append(makeRecord(static_cast<uint64_t>(i) * 1000, 0, 0, 100000, 1, i + 1));
+    }
+    EventLogReader reader(path_);
+    EXPECT_EQ(reader.chunkCount(), 3u);
+    EXPECT_FALSE(reader.hasStats());
+    EXPECT_THROW(reader.stats(), std::runtime_error);
+}
+
 }  // namespace test
 }  // namespace qrsdp
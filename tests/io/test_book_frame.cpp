@@ -0,0 +1,155 @@
+#include <gtest/gtest.h>
+#include "io/book_frame.h"
+#include "io/binary_file_sink.h"
+#include "io/book_replayer.h"
+#include "book/multi_level_book.h"
+#include "model/simple_imbalance_intensity.h"
+#include "producer/qrsdp_producer.h"
+#include "rng/mt19937_rng.h"
+#include "sampler/competing_intensity_sampler.h"
+#include "sampler/unit_size_attribute_sampler.h"
+#include "core/event_types.h"
+#include "core/records.h"
+
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+namespace qrsdp {
+namespace test {
+
+static constexpr uint64_t kOpenNs = 34200ULL * 1'000'000'000ULL;
+
+static FileHeader makeHeader() {
+    FileHeader h{};
+    h.p0_ticks = 100;
+    h.levels_per_side = 3;
+    h.initial_spread_ticks = 2;
+    h.initial_depth = 1;
+    h.market_open_ns = kOpenNs;
+    return h;
+}
+
+static DiskEventRecord makeRecord(EventType type, int32_t price, double t_seconds, uint32_t qty = 1) {
+    DiskEventRecord r{};
+    r.ts_ns = kOpenNs + static_cast<uint64_t>(t_seconds * 1e9);
+    r.type = static_cast<uint8_t>(type);
+    r.side = static_cast<uint8_t>(type == EventType::ADD_BID || type == EventType::CANCEL_BID
+                                  || type == EventType::EXECUTE_SELL ? Side::BID : Side::ASK);
+    r.price_ticks = price;
+    r.qty = qty;
+    return r;
+}
+
+TEST(BookFrameBuilder, EmitsOneFramePerIntervalWithRecords) {
+    BookFrameOptions options;
+    options.frame_interval_ns = 1'000'000'000ULL;
+    options.recent_events = 2;
+    BookFrameBuilder builder(makeHeader(), options);
+    std::vector<char> frame;
+    BookFrame f;
+
+    // Bid 99, ask 101, one unit per level.
+    ASSERT_TRUE(builder.add(makeRecord(EventType::ADD_BID, 99, 0.1, 2), frame)) << "first record";
+    decodeBookFrame(frame.data(), frame.size(), f);
+    EXPECT_EQ(f.header.record_index, 1u);
+    EXPECT_EQ(f.header.frame_records, 1u);
+    ASSERT_EQ(f.bids.size(), 3u);
+    EXPECT_EQ(f.bids[0].price_ticks, 99);
+    EXPECT_EQ(f.bids[0].depth, 3u);
+    EXPECT_EQ(f.asks[0].price_ticks, 101);
+
+    EXPECT_FALSE(builder.add(makeRecord(EventType::ADD_ASK, 102, 0.4), frame));
+    EXPECT_FALSE(builder.add(makeRecord(EventType::EXECUTE_BUY, 101, 0.9), frame));
+    EXPECT_FALSE(builder.add(makeRecord(EventType::CANCEL_BID, 98, 0.95), frame));
+    ASSERT_TRUE(builder.add(makeRecord(EventType::ADD_BID, 100, 3.2), frame)) << "idle seconds emit nothing";
+    const size_t bytes = decodeBookFrame(frame.data(), frame.size(), f);
+    EXPECT_EQ(bytes, frame.size());
+    EXPECT_EQ(bytes, sizeof(BookFrameHeader) + 6 * sizeof(FrameLevel) + 2 * sizeof(FrameEvent));
+    EXPECT_EQ(f.header.ts_ns, kOpenNs + 3'200'000'000ULL);
+    EXPECT_EQ(f.header.record_index, 5u);
+    EXPECT_EQ(f.header.frame_records, 4u);
+    EXPECT_EQ(f.header.best_bid_ticks, 100);
+    EXPECT_EQ(f.header.best_ask_ticks, 102);
+    ASSERT_EQ(f.events.size(), 2u) << "capped at recent_events, oldest first";
+    EXPECT_EQ(f.events[0].type, static_cast<uint8_t>(EventType::CANCEL_BID));
+    EXPECT_EQ(f.events[1].type, static_cast<uint8_t>(EventType::ADD_BID));
+    EXPECT_EQ(f.events[1].price_ticks, 100);
+
+    EXPECT_FALSE(builder.add(makeRecord(EventType::ADD_ASK, 103, 3.5), frame));
+    builder.setFrameInterval(10'000'000'000ULL);
+    EXPECT_TRUE(builder.add(makeRecord(EventType::ADD_ASK, 103, 4.0), frame)) << "boundary set before the change";
+    EXPECT_FALSE(builder.add(makeRecord(EventType::ADD_ASK, 103, 9.0), frame));
+    EXPECT_TRUE(builder.flush(frame));
+    decodeBookFrame(frame.data(), frame.size(), f);
+    EXPECT_EQ(f.header.frame_records, 1u);
+    EXPECT_FALSE(builder.flush(frame)) << "nothing pending";
+    EXPECT_EQ(builder.frames(), 4u);
+    EXPECT_EQ(builder.records(), 8u);
+
+    EXPECT_THROW(builder.setFrameInterval(0), std::invalid_argument);
+    EXPECT_THROW(decodeBookFrame(frame.data(), frame.size() - 1, f), std::runtime_error);
+    frame[0] ^= 1;
+    EXPECT_THROW(decodeBookFrame(frame.data(), frame.size(), f), std::runtime_error);
+}
+
+TEST(BookFrameSink, LiveFramesFollowTheProducersBook) {
+    TradingSession session{};
+    session.seed = 11;
+    session.p0_ticks = 10000;
+    session.session_seconds = 60;
+    session.levels_per_side = 5;
+    session.tick_size = 100;
+    session.initial_spread_ticks = 2;
+    session.initial_depth = 5;
+    session.market_open_seconds = 34200;
+    session.intensity_params = {20.0, 0.5, 15.0, 1.0, 1.0, 0.5, 0.4};
+
+    FileHeader header{};
+    header.p0_ticks = session.p0_ticks;
+    header.levels_per_side = session.levels_per_side;
+    header.initial_spread_ticks = session.initial_spread_ticks;
+    header.initial_depth = session.initial_depth;
+    header.market_open_ns = static_cast<uint64_t>(session.market_open_seconds) * 1'000'000'000ULL;
+
+    BookFrameOptions options;
+    options.frame_interval_ns = 500'000'000ULL;
+    std::vector<BookFrame> frames;
+    BookFrameSink sink(header, options, [&](const char* data, size_t size) {
+        BookFrame f;
+        EXPECT_EQ(decodeBookFrame(data, size, f), size);
+        frames.push_back(f);
+    });
+
+    Mt19937Rng rng(session.seed);
+    MultiLevelBook book;
+    SimpleImbalanceIntensity model(session.intensity_params);
+    CompetingIntensitySampler sampler(rng);
+    UnitSizeAttributeSampler attrs(rng, 0.5, 0.5);
+    QrsdpProducer producer(rng, book, model, sampler, attrs);
+    producer.runSession(session, sink);
+    sink.close();
+
+    ASSERT_GT(frames.size(), 60u);
+    ASSERT_LE(frames.size(), 121u) << "at most one frame per interval, plus the final one";
+    uint64_t records = 0;
+    for (const BookFrame& f : frames) records += f.header.frame_records;
+    EXPECT_EQ(records, producer.eventsWrittenThisSession());
+
+    const BookFrame& last = frames.back();
+    EXPECT_EQ(last.header.record_index, producer.eventsWrittenThisSession());
+    EXPECT_EQ(last.header.best_bid_ticks, book.bestBid().price_ticks);
+    EXPECT_EQ(last.header.best_ask_ticks, book.bestAsk().price_ticks);
+    ASSERT_EQ(last.bids.size(), book.numLevels());
+    for (size_t k = 0; k < book.numLevels(); ++k) {
+        EXPECT_EQ(last.bids[k].price_ticks, book.bidPriceAtLevel(k));
+        EXPECT_EQ(last.bids[k].depth, book.bidDepthAtLevel(k));
+        EXPECT_EQ(last.asks[k].price_ticks, book.askPriceAtLevel(k));
+        EXPECT_EQ(last.asks[k].depth, book.askDepthAtLevel(k));
+    }
+    for (size_t i = 1; i < frames.size(); ++i)
+        EXPECT_LT(frames[i - 1].header.ts_ns, frames[i].header.ts_ns);
+}
+
+}  // namespace test
+}  // namespace qrsdp
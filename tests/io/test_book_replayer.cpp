@@ -0,0 +1,136 @@
+#include <gtest/gtest.h>
+#include "io/book_replayer.h"
+#include "io/event_log_format.h"
+#include "io/in_memory_sink.h"
+#include "book/multi_level_book.h"
+#include "model/curve_intensity_model.h"
+#include "model/hlr_params.h"
+#include "producer/qrsdp_producer.h"
+#include "rng/mt19937_rng.h"
+#include "sampler/competing_intensity_sampler.h"
+#include "sampler/unit_size_attribute_sampler.h"
+#include "core/event_types.h"
+#include "core/records.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace qrsdp {
+namespace test {
+
+static FileHeader makeHeader(uint32_t levels, uint32_t spread_ticks, uint32_t depth) {
+    FileHeader h{};
+    h.p0_ticks = 10000;
+    h.levels_per_side = levels;
+    h.initial_spread_ticks = spread_ticks;
+    h.initial_depth = depth;
+    return h;
+}
+
+static DiskEventRecord makeRecord(EventType type, int32_t price, uint32_t qty = 1) {
+    DiskEventRecord r{};
+    r.type = static_cast<uint8_t>(type);
+    r.side = static_cast<uint8_t>(type == EventType::ADD_BID || type == EventType::CANCEL_BID
+                                  || type == EventType::EXECUTE_SELL ? Side::BID : Side::ASK);
+    r.price_ticks = price;
+    r.qty = qty;
+    return r;
+}
+
+/// Linear scan: the reference the offset lookup must agree with.
+static int scanBid(const MultiLevelBook& book, int32_t price) {
+    for (size_t k = 0; k < book.numLevels(); ++k)
+        if (book.bidPriceAtLevel(k) == price) return static_cast<int>(k);
+    return -1;
+}
+
+static int scanAsk(const MultiLevelBook& book, int32_t price) {
+    for (size_t k = 0; k < book.numLevels(); ++k)
+        if (book.askPriceAtLevel(k) == price) return static_cast<int>(k);
+    return -1;
+}
+
+TEST(BookReplayer, LevelLookupIsExactAcrossGaps) {
+    // Spread 6: best bid 9997, best ask 10003. Improving both sides by two ticks
+    // leaves a one-tick gap behind each new best.
+    BookReplayer replayer(makeHeader(5, 6, 3));
+    BookReplayer::Step step = replayer.apply(makeRecord(EventType::ADD_BID, 9999));
+    EXPECT_EQ(step.level, 0) << "spread-improving add counts as level 0";
+    EXPECT_TRUE(step.bid);
+    EXPECT_TRUE(step.shifted);
+    replayer.apply(makeRecord(EventType::ADD_ASK, 10001));
+    const MultiLevelBook& book = replayer.book();
+    ASSERT_EQ(book.bidPriceAtLevel(1), 9997);
+    ASSERT_EQ(book.askPriceAtLevel(1), 10003);
+    EXPECT_EQ(book.bidIndexForPrice(9997), 2) << "offset guess lands past the gap";
+
+    for (int32_t p = 9985; p <= 10015; ++p) {
+        EXPECT_EQ(replayer.bidLevelOf(p), scanBid(book, p)) << "bid price " << p;
+        EXPECT_EQ(replayer.askLevelOf(p), scanAsk(book, p)) << "ask price " << p;
+    }
+
+    step = replayer.apply(makeRecord(EventType::CANCEL_BID, 9997));
+    EXPECT_EQ(step.level, 1);
+    EXPECT_EQ(step.depth_before, 3u);
+    EXPECT_FALSE(step.shifted);
+    step = replayer.apply(makeRecord(EventType::CANCEL_ASK, 10002));
+    EXPECT_EQ(step.level, -1) << "the gap holds no level";
+    step = replayer.apply(makeRecord(EventType::EXECUTE_BUY, 10001));
+    EXPECT_EQ(step.level, 0);
+    EXPECT_FALSE(step.bid);
+    EXPECT_EQ(step.depth_before, 1u);
+    EXPECT_TRUE(step.shifted) << "the one-lot best ask is consumed";
+    EXPECT_EQ(replayer.recordsApplied(), 5u);
+    EXPECT_EQ(replayer.shifts(), 3u);
+}
+
+TEST(BookReplayer, ReplayMatchesTheProducersBookAndALinearScan) {
+    TradingSession session{};
+    session.seed = 2718;
+    session.p0_ticks = 10000;
+    session.session_seconds = 60;
+    session.levels_per_side = 5;
+    session.tick_size = 100;
+    session.initial_spread_ticks = 2;
+    session.initial_depth = 5;
+    Mt19937Rng rng(session.seed);
+    MultiLevelBook book;
+    CurveIntensityModel model(makeDefaultHLRParams(5, 100));
+    CompetingIntensitySampler sampler(rng);
+    UnitSizeAttributeSampler attrs(rng, 0.5, 0.5);  // spread improvements: gaps occur
+    QrsdpProducer producer(rng, book, model, sampler, attrs);
+    InMemorySink sink;
+    producer.runSession(session, sink);
+    ASSERT_GT(sink.size(), 1000u);
+
+    BookReplayer replayer(makeHeader(session.levels_per_side, session.initial_spread_ticks,
+                                     session.initial_depth));
+    for (const EventRecord& e : sink.events()) {
+        DiskEventRecord r{};
+        r.ts_ns = e.ts_ns;
+        r.type = e.type;
+        r.side = e.side;
+        r.price_ticks = e.price_ticks;
+        r.qty = e.qty;
+        r.order_id = e.order_id;
+        const EventType type = static_cast<EventType>(e.type);
+        int expected = -1;
+        if (type == EventType::CANCEL_BID) expected = scanBid(replayer.book(), r.price_ticks);
+        if (type == EventType::CANCEL_ASK) expected = scanAsk(replayer.book(), r.price_ticks);
+        const BookReplayer::Step step = replayer.apply(r);
+        if (type == EventType::CANCEL_BID || type == EventType::CANCEL_ASK) {
+            ASSERT_EQ(step.level, expected) << "record " << replayer.recordsApplied();
+        }
+    }
+    EXPECT_EQ(replayer.recordsApplied(), sink.size());
+    EXPECT_EQ(replayer.shifts(), producer.shiftCountThisSession());
+    for (size_t k = 0; k < book.numLevels(); ++k) {
+        EXPECT_EQ(replayer.book().bidPriceAtLevel(k), book.bidPriceAtLevel(k)) << "level " << k;
+        EXPECT_EQ(replayer.book().bidDepthAtLevel(k), book.bidDepthAtLevel(k)) << "level " << k;
+        EXPECT_EQ(replayer.book().askPriceAtLevel(k), book.askPriceAtLevel(k)) << "level " << k;
+        EXPECT_EQ(replayer.book().askDepthAtLevel(k), book.askDepthAtLevel(k)) << "level " << k;
+    }
+}
+
+}  // namespace test
+}  // namespace qrsdp
@@ -0,0 +1,42 @@
+#include <gtest/gtest.h>
+#include "io/crc32c.h"
+
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace qrsdp {
+namespace test {
+
+TEST(Crc32c, MatchesTheStandardCheckValues) {
+    const char* check = "123456789";
+    EXPECT_EQ(crc32c(check, 9), 0xE3069283u);
+    EXPECT_EQ(crc32cSoftware(check, 9), 0xE3069283u);
+    EXPECT_EQ(crc32c(nullptr, 0), 0u);
+
+    // RFC 3720 B.4: 32 bytes of zeros, and of 0xFF.
+    std::vector<unsigned char> buf(32, 0);
+    EXPECT_EQ(crc32c(buf.data(), buf.size()), 0x8A9136AAu);
+    std::memset(buf.data(), 0xFF, buf.size());
+    EXPECT_EQ(crc32c(buf.data(), buf.size()), 0x62A8AB43u);
+}
+
+TEST(Crc32c, HardwareAndTablePathsAgreeAndContinue) {
+    std::mt19937_64 rng(7);
+    std::vector<unsigned char> data(5000);
+    for (auto& b : data) b = static_cast<unsigned char>(rng());
+    for (size_t size : {1u, 7u, 8u, 9u, 63u, 4096u, 5000u}) {
+        for (size_t offset : {0u, 1u, 3u}) {
+            if (offset + size > data.size()) continue;
+            const unsigned char* p = data.data() + offset;
+            const uint32_t whole = crc32c(p, size);
+            EXPECT_EQ(whole, crc32cSoftware(p, size)) << size << "@" << offset;
+            const size_t cut = size / 3;
+            EXPECT_EQ(crc32c(p + cut, size - cut, crc32c(p, cut)), whole) << size;
+        }
+    }
+}
+
+}  // namespace test
+}  // namespace qrsdp
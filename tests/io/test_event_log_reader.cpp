@@ -1,10 +1,17 @@
 #include <gtest/gtest.h>
+#include <lz4.h>
 #include "io/binary_file_sink.h"
 #include "io/event_log_reader.h"
 #include "io/event_log_format.h"
+#include "io/chunk_codec.h"
+#include "io/lz4_hc.h"
+#include "producer/work_stealing_pool.h"
 #include "core/records.h"
 
+#include <cstddef>
 #include <cstdio>
+#include <cstring>
+#include <random>
 #include <string>
 #include <vector>
 
@@ -293,5 +300,568 @@ TEST_F(EventLogReaderTest, WorksWithoutIndexFooter) {
     }
 }
 
+// --- Zero-copy chunk views ---
+
+TEST_F(EventLogReaderTest, ChunkRecordsDecodesIntoReusedScratch) {
+    auto originals = writeTestFile(path_, 25, 8);
+    EventLogReader reader(path_);
+
+    std::vector<DiskEventRecord> scratch;
+    const DiskEventRecord* buf = nullptr;
+    size_t pos = 0;
+    for (uint32_t c = 0; c < reader.chunkCount(); ++c) {
+        const RecordSpan span = reader.chunkRecords(c, scratch);
+        ASSERT_EQ(span.size, reader.index()[c].record_count);
+        if (c == 0) buf = scratch.data();
+        EXPECT_EQ(span.data, buf) << "compressed chunks decode into the same scratch buffer";
+        for (const auto& r : span) {
+            EXPECT_EQ(r.ts_ns, originals[pos].ts_ns);
+            EXPECT_EQ(r.order_id, originals[pos].order_id);
+            ++pos;
+        }
+    }
+    EXPECT_EQ(pos, originals.size());
+    EXPECT_THROW(reader.chunkRecords(reader.chunkCount(), scratch), std::out_of_range);
+}
+
+TEST_F(EventLogReaderTest, IncompressibleChunksAreViewedInPlace) {
+    auto session = makeTestSession();
+    std::vector<EventRecord> originals;
+    {
+        BinaryFileSink sink(path_, session, 8);
+        std::mt19937_64 gen(5);
+        for (int i = 0; i < 20; ++i) {
+            auto rec = makeRecord(gen(), static_cast<uint8_t>(gen()), static_cast<uint8_t>(gen()),
+                                  static_cast<int32_t>(gen()), static_cast<uint32_t>(gen()), gen());
+            originals.push_back(rec);
+            sink.append(rec);
+        }
+        sink.close();
+    }
+    EventLogReader reader(path_);
+    ASSERT_EQ(reader.chunkCount(), 3u);
+
+    std::vector<DiskEventRecord> scratch;
+    size_t pos = 0;
+    for (uint32_t c = 0; c < reader.chunkCount(); ++c) {
+        const RecordSpan span = reader.chunkRecords(c, scratch);
+        EXPECT_TRUE(scratch.empty()) << "raw chunk " << c << " should not touch scratch";
+        for (const auto& r : span) {
+            EXPECT_EQ(r.ts_ns, originals[pos].ts_ns);
+            EXPECT_EQ(r.price_ticks, originals[pos].price_ticks);
+            EXPECT_EQ(r.order_id, originals[pos].order_id);
+            ++pos;
+        }
+    }
+    EXPECT_EQ(pos, originals.size());
+
+    auto all = reader.readAll();
+    ASSERT_EQ(all.size(), originals.size());
+    EXPECT_EQ(all.back().qty, originals.back().qty);
+}
+
+// --- Streaming visitors ---
+
+TEST_F(EventLogReaderTest, ForEachRecordStreamsInOrder) {
+    auto originals = writeTestFile(path_, 40, 8);  // full chunks: all LZ4, none raw
+    EventLogReader reader(path_);
+
+    size_t chunks = 0;
+    const DiskEventRecord* buf = nullptr;
+    reader.forEachChunk([&](const RecordSpan& chunk) {
+        if (chunks == 0) buf = chunk.data;
+        EXPECT_EQ(chunk.data, buf) << "one decode buffer for the whole pass";
+        EXPECT_EQ(chunk.size, reader.index()[chunks].record_count);
+        ++chunks;
+    });
+    EXPECT_EQ(chunks, reader.chunkCount());
+
+    size_t pos = 0;
+    reader.forEachRecord([&](const DiskEventRecord& r) {
+        ASSERT_LT(pos, originals.size());
+        EXPECT_EQ(r.ts_ns, originals[pos].ts_ns);
+        EXPECT_EQ(r.price_ticks, originals[pos].price_ticks);
+        EXPECT_EQ(r.order_id, originals[pos].order_id);
+        ++pos;
+    });
+    EXPECT_EQ(pos, originals.size());
+}
+
+TEST_F(EventLogReaderTest, ForEachChunkInRangeMatchesReadRange) {
+    writeTestFile(path_, 32, 8);
+    EventLogReader reader(path_);
+
+    const uint64_t ts_start = 10 * 1000000ULL, ts_end = 17 * 1000000ULL;
+    auto expected = reader.readRange(ts_start, ts_end);
+    std::vector<uint64_t> streamed;
+    reader.forEachChunkInRange(ts_start, ts_end, [&](const RecordSpan& chunk) {
+        for (const auto& r : chunk) streamed.push_back(r.ts_ns);
+    });
+    ASSERT_EQ(streamed.size(), expected.size());
+    for (size_t i = 0; i < streamed.size(); ++i) EXPECT_EQ(streamed[i], expected[i].ts_ns);
+}
+
+// --- Parallel decompression ---
+
+TEST_F(EventLogReaderTest, ParallelReadAllMatchesSerial) {
+    writeTestFile(path_, 1000, 16);
+    EventLogReader reader(path_);
+    WorkStealingPool pool(4);
+
+    const auto serial = reader.readAll();
+    const auto parallel = reader.readAll(pool);
+    ASSERT_EQ(parallel.size(), serial.size());
+    for (size_t i = 0; i < serial.size(); ++i) {
+        ASSERT_EQ(parallel[i].ts_ns, serial[i].ts_ns) << "record " << i;
+        ASSERT_EQ(parallel[i].order_id, serial[i].order_id) << "record " << i;
+    }
+}
+
+TEST_F(EventLogReaderTest, ParallelForEachChunkPreservesOrder) {
+    auto originals = writeTestFile(path_, 1003, 16);
+    EventLogReader reader(path_);
+    WorkStealingPool pool(3);
+
+    for (size_t window : {size_t{0}, size_t{1}, size_t{5}, size_t{500}}) {
+        size_t pos = 0;
+        uint32_t chunks = 0;
+        reader.forEachChunk(pool, [&](const RecordSpan& chunk) {
+            ASSERT_EQ(chunk.size, reader.index()[chunks].record_count);
+            for (const auto& r : chunk) {
+                ASSERT_EQ(r.order_id, originals[pos].order_id) << "window " << window;
+                ++pos;
+            }
+            ++chunks;
+        }, window);
+        EXPECT_EQ(chunks, reader.chunkCount()) << "window " << window;
+        EXPECT_EQ(pos, originals.size()) << "window " << window;
+    }
+}
+
+TEST_F(EventLogReaderTest, ParallelReadPropagatesErrors) {
+    writeTestFile(path_, 200, 16);
+    {
+        EventLogReader reader(path_);
+        WorkStealingPool pool(2);
+        EXPECT_THROW(reader.forEachChunk(pool, [](const RecordSpan&) { throw std::logic_error("visit"); }),
+                     std::logic_error);
+    }
+    {
+        // Corrupt one chunk's record count so decoding it throws.
+        EventLogReader probe(path_);
+        const uint64_t offset = probe.index()[7].file_offset + offsetof(ChunkHeader, record_count);
+        std::FILE* f = std::fopen(path_.c_str(), "r+b");
+        ASSERT_NE(f, nullptr);
+        std::fseek(f, static_cast<long>(offset), SEEK_SET);
+        const uint32_t bogus = 3;
+        std::fwrite(&bogus, sizeof(bogus), 1, f);
+        std::fclose(f);
+    }
+    EventLogReader reader(path_);
+    WorkStealingPool pool(4);
+    EXPECT_THROW(reader.readAll(pool), std::runtime_error);
+    size_t visited = 0;
+    EXPECT_THROW(reader.forEachChunk(pool, [&](const RecordSpan&) { ++visited; }, 2), std::runtime_error);
+    EXPECT_EQ(visited, 6u) << "chunks before the bad batch are still visited in order";
+}
+
+// --- Columnar chunks (v1.1) ---
+
+/// Random-walk stream shaped like producer output: rising timestamps, prices moving
+/// both ways, order ids that jump back to resting orders.
+static std::vector<EventRecord> writeWalkFile(const std::string& path, int n, bool columnar,
+                                             const CodecConfig& codec = CodecConfig{},
+                                             uint32_t seek_stride = 0) {
+    std::vector<EventRecord> records;
+    BinaryFileSinkOptions options;
+    options.chunk_capacity = 64;
+    options.columnar = columnar;
+    options.codec = codec;
+    options.seek_stride = seek_stride;
+    BinaryFileSink sink(path, makeTestSession(), options);
+    std::mt19937_64 gen(11);
+    uint64_t ts = 34'200'000'000'000ULL;
+    int32_t price = 50000;
+    for (int i = 0; i < n; ++i) {
+        ts += gen() % 200000;
+        price += static_cast<int32_t>(gen() % 5) - 2;
+        const uint64_t oid = (gen() % 4 == 0) ? 1 + gen() % (i + 1) : static_cast<uint64_t>(i + 1);
+        auto rec = makeRecord(ts, static_cast<uint8_t>(gen() % 6), static_cast<uint8_t>(gen() % 3),
+                              price, 1 + static_cast<uint32_t>(gen() % 3), oid);
+        records.push_back(rec);
+        sink.append(rec);
+    }
+    sink.close();
+    return records;
+}
+
+static uint32_t chunkFlagsAt(const std::string& path, uint64_t file_offset) {
+    ChunkHeader chdr{};
+    std::FILE* f = std::fopen(path.c_str(), "rb");
+    std::fseek(f, static_cast<long>(file_offset), SEEK_SET);
+    const size_t got = std::fread(&chdr, sizeof(chdr), 1, f);
+    std::fclose(f);
+    return got == 1 ? chdr.chunk_flags : ~0u;
+}
+
+TEST_F(EventLogReaderTest, ColumnarChunksRoundTripAndShrinkFile) {
+    const std::string row_path = path_ + ".row";
+    const auto originals = writeWalkFile(row_path, 1000, false);
+    writeWalkFile(path_, 1000, true);
+
+    EventLogReader reader(path_);
+    EXPECT_EQ(reader.header().version_minor, kLogVersionMinorColumnar);
+    ASSERT_EQ(reader.chunkCount(), 16u);
+    for (const auto& entry : reader.index())
+        EXPECT_EQ(chunkFlagsAt(path_, entry.file_offset), kChunkFlagColumnar);
+
+    auto all = reader.readAll();
+    ASSERT_EQ(all.size(), originals.size());
+    for (size_t i = 0; i < all.size(); ++i) {
+        EXPECT_EQ(all[i].ts_ns, originals[i].ts_ns) << i;
+        EXPECT_EQ(all[i].type, originals[i].type) << i;
+        EXPECT_EQ(all[i].side, originals[i].side) << i;
+        EXPECT_EQ(all[i].price_ticks, originals[i].price_ticks) << i;
+        EXPECT_EQ(all[i].qty, originals[i].qty) << i;
+        EXPECT_EQ(all[i].order_id, originals[i].order_id) << i;
+    }
+    EventLogReader rows(row_path);
+    EXPECT_EQ(rows.header().version_minor, kLogVersionMinor);
+    auto row_all = rows.readAll();
+    EXPECT_EQ(std::memcmp(row_all.data(), all.data(), all.size() * sizeof(DiskEventRecord)), 0);
+
+    std::FILE* f = std::fopen(path_.c_str(), "rb");
+    std::fseek(f, 0, SEEK_END);
+    const long columnar_size = std::ftell(f);
+    std::fclose(f);
+    f = std::fopen(row_path.c_str(), "rb");
+    std::fseek(f, 0, SEEK_END);
+    const long row_size = std::ftell(f);
+    std::fclose(f);
+    EXPECT_LT(columnar_size, row_size);
+    std::remove(row_path.c_str());
+}
+
+TEST_F(EventLogReaderTest, ReadColumnsProjectsBothLayouts) {
+    for (bool columnar : {false, true}) {
+        const auto originals = writeWalkFile(path_, 300, columnar);
+        EventLogReader reader(path_);
+        ChunkColumns cols;
+        size_t pos = 0;
+        reader.forEachChunkColumns(kSelectTs | kSelectPrice, [&](const ChunkColumns& c) {
+            EXPECT_TRUE(c.type.empty() && c.side.empty() && c.qty.empty() && c.order_id.empty());
+            ASSERT_EQ(c.ts_ns.size(), c.price_ticks.size());
+            for (size_t i = 0; i < c.size(); ++i, ++pos) {
+                EXPECT_EQ(c.ts_ns[i], originals[pos].ts_ns);
+                EXPECT_EQ(c.price_ticks[i], originals[pos].price_ticks);
+            }
+        });
+        EXPECT_EQ(pos, originals.size()) << "columnar=" << columnar;
+
+        reader.readColumns(2, kSelectAll, cols);
+        ASSERT_EQ(cols.size(), 64u);
+        EXPECT_EQ(cols.order_id[5], originals[128 + 5].order_id);
+        EXPECT_EQ(cols.side[63], originals[128 + 63].side);
+        EXPECT_EQ(cols.qty[0], originals[128].qty);
+    }
+}
+
+TEST_F(EventLogReaderTest, ColumnarFallsBackToRowsAndRejectsCorruption) {
+    {
+        BinaryFileSinkOptions options;
+        options.chunk_capacity = 8;
+        options.columnar = true;
+        BinaryFileSink sink(path_, makeTestSession(), options);
+        for (int i = 0; i < 16; ++i)  // second chunk: type does not fit the 4-bit column
+            sink.append(makeRecord(1000u * i, static_cast<uint8_t>(i < 8 ? 1 : 200), 0, 50000, 1, i + 1));
+        sink.close();
+    }
+    {
+        EventLogReader reader(path_);
+        ASSERT_EQ(reader.chunkCount(), 2u);
+        EXPECT_EQ(chunkFlagsAt(path_, reader.index()[0].file_offset), kChunkFlagColumnar);
+        EXPECT_EQ(chunkFlagsAt(path_, reader.index()[1].file_offset) & kChunkFlagColumnar, 0u);
+        auto all = reader.readAll();
+        EXPECT_EQ(all[3].type, 1);
+        EXPECT_EQ(all[12].type, 200);
+    }
+    {
+        // Grow the first column's stored size: the directory no longer adds up.
+        EventLogReader probe(path_);
+        const uint64_t offset = probe.index()[0].file_offset + sizeof(ChunkHeader)
+                              + offsetof(ColumnDirectory, stored_size);
+        std::FILE* f = std::fopen(path_.c_str(), "r+b");
+        ASSERT_NE(f, nullptr);
+        std::fseek(f, static_cast<long>(offset), SEEK_SET);
+        const uint32_t bogus = 7;
+        std::fwrite(&bogus, sizeof(bogus), 1, f);
+        std::fclose(f);
+    }
+    EventLogReader reader(path_);
+    EXPECT_THROW(reader.readChunk(0), std::runtime_error);
+    ChunkColumns cols;
+    EXPECT_THROW(reader.readColumns(0, kSelectTs, cols), std::runtime_error);
+    EXPECT_NO_THROW(reader.readChunk(1));
+}
+
+// --- Codecs ---
+
+TEST(ChunkCodec, ParsesSpecs) {
+    CodecConfig c;
+    ASSERT_TRUE(parseCodecSpec("lz4", c));
+    EXPECT_EQ(c.codec, ChunkCodec::LZ4);
+    EXPECT_EQ(codecSpecString(c), "lz4:1");
+    ASSERT_TRUE(parseCodecSpec("lz4:8", c));
+    EXPECT_EQ(c.level, 8);
+    ASSERT_TRUE(parseCodecSpec("lz4hc", c));
+    EXPECT_EQ(c.codec, ChunkCodec::LZ4) << "HC writes plain LZ4 chunks";
+    EXPECT_TRUE(c.high_compression);
+    EXPECT_EQ(codecSpecString(c), "lz4hc:9");
+    ASSERT_TRUE(parseCodecSpec("lz4hc:12", c));
+    EXPECT_EQ(codecSpecString(c), "lz4hc:12");
+    EXPECT_FALSE(parseCodecSpec("lz4hc:13", c));
+    EXPECT_FALSE(parseCodecSpec("lz4-hc", c));
+    ASSERT_TRUE(parseCodecSpec("zstd-dict:19", c));
+    EXPECT_EQ(c.codec, ChunkCodec::ZSTD);
+    EXPECT_TRUE(c.dictionary);
+    EXPECT_EQ(codecSpecString(c), "zstd-dict:19");
+    ASSERT_TRUE(parseCodecSpec("none", c));
+    EXPECT_EQ(c.codec, ChunkCodec::NONE);
+    EXPECT_FALSE(c.dictionary);
+    EXPECT_FALSE(parseCodecSpec("zstd:", c));
+    EXPECT_FALSE(parseCodecSpec("zstd:x", c));
+    EXPECT_EQ(c.codec, ChunkCodec::NONE) << "failed parse leaves out untouched";
+}
+
+TEST(ChunkCodec, Lz4HcWritesBlocksLz4Reads) {
+    std::mt19937_64 gen(5);
+    std::vector<char> noise(70000);
+    for (char& c : noise) c = static_cast<char>(gen());
+    // Records-like input: short repeats at varying distances, some beyond 64 KiB.
+    std::vector<char> records;
+    for (uint32_t i = 0; records.size() < 200000; ++i) {
+        const uint64_t fields[3] = {1000000000ull + i * 37ull, 10000u + (gen() % 7), i % 3 == 0 ? 1u : gen() % 4};
+        const char* bytes = reinterpret_cast<const char*>(fields);
+        records.insert(records.end(), bytes, bytes + sizeof fields);
+    }
+    auto roundTrip = [](const std::vector<char>& in, size_t n, int level) {
+        std::vector<char> packed(static_cast<size_t>(LZ4_compressBound(static_cast<int>(n))));
+        const size_t bytes = lz4HcCompress(in.data(), n, packed.data(), packed.size(), level);
+        EXPECT_GT(bytes, 0u) << n;
+        std::vector<char> out(n + 1);
+        const int got = LZ4_decompress_safe(packed.data(), out.data(), static_cast<int>(bytes),
+                                            static_cast<int>(n));
+        EXPECT_EQ(got, static_cast<int>(n)) << "n=" << n << " level=" << level;
+        EXPECT_EQ(std::memcmp(out.data(), in.data(), n), 0) << "n=" << n << " level=" << level;
+        return bytes;
+    };
+    for (size_t n : {0, 1, 12, 13, 17, 100, 4096, 70000}) {
+        for (int level : {1, 9, 12}) {
+            roundTrip(noise, n, level);
+            roundTrip(records, n, level);
+        }
+    }
+    const size_t hc = roundTrip(records, records.size(), kLz4HcDefaultLevel);
+    std::vector<char> fast(static_cast<size_t>(LZ4_compressBound(static_cast<int>(records.size()))));
+    const int lz4 = LZ4_compress_default(records.data(), fast.data(), static_cast<int>(records.size()),
+                                         static_cast<int>(fast.size()));
+    EXPECT_LT(hc, static_cast<size_t>(lz4)) << "the deeper search finds longer matches";
+    EXPECT_LE(roundTrip(records, records.size(), 12), roundTrip(records, records.size(), 1));
+    // A too-small buffer is refused, not overrun.
+    std::vector<char> small(16);
+    EXPECT_EQ(lz4HcCompress(noise.data(), 4096, small.data(), small.size(), 9), 0u);
+}
+
+TEST_F(EventLogReaderTest, EveryCodecRoundTripsBothLayouts) {
+    for (const char* spec : {"lz4:1", "lz4:16", "lz4hc:1", "lz4hc", "none", "zstd:1", "zstd:19", "zstd-dict"}) {
+        CodecConfig codec;
+        ASSERT_TRUE(parseCodecSpec(spec, codec));
+        if (!codecAvailable(codec.codec)) {
+            EXPECT_THROW(writeWalkFile(path_, 10, false, codec), std::runtime_error) << spec;
+            continue;
+        }
+        for (bool columnar : {false, true}) {
+            const auto originals = writeWalkFile(path_, 1500, columnar, codec);
+            EventLogReader reader(path_);
+            EXPECT_EQ((reader.header().header_flags & kHeaderCodecMask) >> kHeaderCodecShift,
+                      static_cast<uint32_t>(codec.codec)) << spec;
+            for (const auto& entry : reader.index()) {
+                const uint32_t flags = chunkFlagsAt(path_, entry.file_offset);
+                if (codec.codec == ChunkCodec::NONE && !columnar) {
+                    EXPECT_EQ(flags, kChunkFlagRaw) << spec;
+                } else if (!(flags & kChunkFlagRaw)) {
+                    EXPECT_EQ((flags & kChunkCodecMask) >> kChunkCodecShift,
+                              static_cast<uint32_t>(codec.codec)) << spec;
+                }
+            }
+            const auto all = reader.readAll();
+            ASSERT_EQ(all.size(), originals.size()) << spec;
+            for (size_t i = 0; i < all.size(); ++i) {
+                ASSERT_EQ(all[i].ts_ns, originals[i].ts_ns) << spec << " " << i;
+                ASSERT_EQ(all[i].price_ticks, originals[i].price_ticks) << spec << " " << i;
+                ASSERT_EQ(all[i].order_id, originals[i].order_id) << spec << " " << i;
+                ASSERT_EQ(all[i].qty, originals[i].qty) << spec << " " << i;
+            }
+        }
+    }
+}
+
+TEST_F(EventLogReaderTest, ZstdDictionaryIsWrittenAfterHeader) {
+    CodecConfig codec;
+    ASSERT_TRUE(parseCodecSpec("zstd-dict", codec));
+    if (!codecAvailable(codec.codec)) GTEST_SKIP() << "built without zstd";
+
+    const auto originals = writeWalkFile(path_, 3000, false, codec);
+    EventLogReader reader(path_);
+    ASSERT_EQ(reader.chunkCount(), (3000u + 63) / 64) << "the dictionary block is not a chunk";
+    EXPECT_EQ(chunkFlagsAt(path_, sizeof(FileHeader)) & kChunkFlagDictionary, kChunkFlagDictionary);
+    EXPECT_GT(reader.index()[0].file_offset, sizeof(FileHeader) + sizeof(ChunkHeader));
+
+    // The scanning path (no footer) must also step over the dictionary block.
+    {
+        std::FILE* f = std::fopen(path_.c_str(), "r+b");
+        ASSERT_NE(f, nullptr);
+        std::fseek(f, -static_cast<long>(sizeof(IndexTail)), SEEK_END);
+        IndexTail tail{};
+        ASSERT_EQ(std::fread(&tail, sizeof(tail), 1, f), 1u);
+        std::fseek(f, static_cast<long>(offsetof(FileHeader, header_flags)), SEEK_SET);
+        const uint32_t flags = reader.header().header_flags & ~kHeaderFlagHasIndex;
+        std::fwrite(&flags, sizeof(flags), 1, f);
+        std::fclose(f);
+        truncate(path_.c_str(), static_cast<long>(tail.index_start_offset));
+    }
+    EventLogReader scanned(path_);
+    ASSERT_EQ(scanned.chunkCount(), reader.chunkCount());
+    EXPECT_EQ(scanned.index()[0].file_offset, reader.index()[0].file_offset);
+    const auto all = scanned.readAll();
+    ASSERT_EQ(all.size(), originals.size());
+    EXPECT_EQ(all.back().order_id, originals.back().order_id);
+}
+
+// --- Seek index and exact queries ---
+
+static std::vector<EventRecord> bruteForceSelect(const std::vector<EventRecord>& records,
+                                                 const RecordQuery& q) {
+    std::vector<EventRecord> out;
+    for (const auto& r : records)
+        if (r.ts_ns >= q.ts_start && r.ts_ns <= q.ts_end && r.price_ticks >= q.price_min
+            && r.price_ticks <= q.price_max)
+            out.push_back(r);
+    return out;
+}
+
+TEST_F(EventLogReaderTest, SelectMatchesBruteForceFilter) {
+    for (bool columnar : {false, true}) {
+        for (uint32_t stride : {0u, 1u, 16u, 1000u}) {
+            const auto originals = writeWalkFile(path_, 3000, columnar, CodecConfig{}, stride);
+            EventLogReader reader(path_);
+            EXPECT_EQ(reader.hasSeekIndex(), stride > 0);
+            EXPECT_EQ(reader.seekStride(), stride);
+
+            std::mt19937_64 gen(5);
+            const uint64_t t0 = originals.front().ts_ns;
+            const uint64_t span = originals.back().ts_ns - t0;
+            std::vector<RecordQuery> queries(1);  // match everything
+            RecordQuery exact_ts;
+            exact_ts.ts_start = exact_ts.ts_end = originals[1234].ts_ns;
+            queries.push_back(exact_ts);
+            RecordQuery before;
+            before.ts_end = t0 - 1;
+            queries.push_back(before);
+            for (int i = 0; i < 20; ++i) {
+                RecordQuery q;
+                q.ts_start = t0 + gen() % span;
+                q.ts_end = q.ts_start + gen() % (span / 10);
+                if (i % 2) {
+                    q.price_min = originals[gen() % originals.size()].price_ticks;
+                    q.price_max = q.price_min + static_cast<int32_t>(gen() % 4);
+                }
+                queries.push_back(q);
+            }
+
+            for (const RecordQuery& q : queries) {
+                const auto expected = bruteForceSelect(originals, q);
+                const auto got = reader.select(q);
+                ASSERT_EQ(got.size(), expected.size()) << "columnar=" << columnar << " stride=" << stride
+                                                       << " ts=[" << q.ts_start << "," << q.ts_end << "]";
+                for (size_t i = 0; i < got.size(); ++i) {
+                    ASSERT_EQ(got[i].ts_ns, expected[i].ts_ns);
+                    ASSERT_EQ(got[i].order_id, expected[i].order_id);
+                }
+            }
+        }
+    }
+}
+
+TEST_F(EventLogReaderTest, SeekIndexStatsSurviveScanPath) {
+    const auto originals = writeWalkFile(path_, 1000, false, CodecConfig{}, 16);
+    EventLogReader reader(path_);
+    ASSERT_TRUE(reader.hasSeekIndex());
+    ASSERT_EQ(reader.chunkCount(), (1000u + 63) / 64) << "the seek index block is not a chunk";
+    size_t pos = 0;
+    for (uint32_t i = 0; i < reader.chunkCount(); ++i) {
+        int32_t lo = originals[pos].price_ticks;
+        int32_t hi = lo;
+        for (uint32_t k = 0; k < reader.index()[i].record_count; ++k, ++pos) {
+            lo = std::min(lo, originals[pos].price_ticks);
+            hi = std::max(hi, originals[pos].price_ticks);
+        }
+        EXPECT_EQ(reader.chunkSeekStats(i).min_price_ticks, lo) << "chunk " << i;
+        EXPECT_EQ(reader.chunkSeekStats(i).max_price_ticks, hi) << "chunk " << i;
+    }
+
+    // Without the footer the scanner meets the seek block after the last chunk.
+    {
+        std::FILE* f = std::fopen(path_.c_str(), "r+b");
+        ASSERT_NE(f, nullptr);
+        std::fseek(f, -static_cast<long>(sizeof(IndexTail)), SEEK_END);
+        IndexTail tail{};
+        ASSERT_EQ(std::fread(&tail, sizeof(tail), 1, f), 1u);
+        std::fseek(f, static_cast<long>(offsetof(FileHeader, header_flags)), SEEK_SET);
+        const uint32_t flags = reader.header().header_flags & ~kHeaderFlagHasIndex;
+        std::fwrite(&flags, sizeof(flags), 1, f);
+        std::fclose(f);
+        truncate(path_.c_str(), static_cast<long>(tail.index_start_offset));
+    }
+    EventLogReader scanned(path_);
+    ASSERT_EQ(scanned.chunkCount(), reader.chunkCount());
+    EXPECT_TRUE(scanned.hasSeekIndex());
+    RecordQuery q;
+    q.price_min = q.price_max = originals[500].price_ticks;
+    EXPECT_EQ(scanned.select(q).size(), bruteForceSelect(originals, q).size());
+}
+
+TEST_F(EventLogReaderTest, ChecksumsCatchPayloadCorruption) {
+    writeTestFile(path_, 100);
+    {
+        EventLogReader reader(path_);
+        ASSERT_TRUE(reader.hasChecksums());
+        for (uint32_t i = 0; i < reader.chunkCount(); ++i)
+            EXPECT_EQ(reader.chunkChecksum(i), reader.index()[i].checksum) << "chunk " << i;
+        EXPECT_EQ(reader.verify(VerifyMode::None), 100u);
+        EXPECT_EQ(reader.verify(VerifyMode::Checksums), 100u);
+        EXPECT_EQ(reader.verify(VerifyMode::Full), 100u);
+
+        // Flip one payload byte in the middle chunk.
+        const IndexEntry& e = reader.index()[reader.chunkCount() / 2];
+        std::FILE* f = std::fopen(path_.c_str(), "r+b");
+        ASSERT_NE(f, nullptr);
+        std::fseek(f, static_cast<long>(e.file_offset + sizeof(ChunkHeader) + 3), SEEK_SET);
+        const int c = std::fgetc(f);
+        std::fseek(f, static_cast<long>(e.file_offset + sizeof(ChunkHeader) + 3), SEEK_SET);
+        std::fputc(c ^ 0x40, f);
+        std::fclose(f);
+    }
+    EventLogReader reader(path_);
+    EXPECT_EQ(reader.verify(VerifyMode::None), 100u);
+    EXPECT_THROW(reader.verify(VerifyMode::Checksums), std::runtime_error);
+
+    VerifyMode mode = VerifyMode::None;
+    EXPECT_TRUE(parseVerifyMode("full", mode));
+    EXPECT_EQ(mode, VerifyMode::Full);
+    EXPECT_STREQ(verifyModeName(VerifyMode::Checksums), "checksums");
+    EXPECT_FALSE(parseVerifyMode("crc", mode));
+}
+
 }  // namespace test
 }  // namespace qrsdp
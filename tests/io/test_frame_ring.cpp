@@ -0,0 +1,161 @@
+#include <gtest/gtest.h>
+#include "io/frame_ring.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace qrsdp {
+namespace test {
+
+class FrameRingTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        path_ = testing::TempDir() + "test_ring_" +
+                std::to_string(reinterpret_cast<uintptr_t>(this)) + ".ring";
+    }
+
+    void TearDown() override {
+        std::remove(path_.c_str());
+    }
+
+    /// Payload of message i: its index, then i % 200 bytes of (i + k) & 0xFF.
+    static std::vector<char> message(uint32_t i) {
+        std::vector<char> m(sizeof(i) + i % 200);
+        std::memcpy(m.data(), &i, sizeof(i));
+        for (size_t k = sizeof(i); k < m.size(); ++k) m[k] = static_cast<char>((i + k) & 0xFF);
+        return m;
+    }
+
+    static uint32_t indexOf(const std::vector<char>& m) {
+        uint32_t i;
+        std::memcpy(&i, m.data(), sizeof(i));
+        return i;
+    }
+
+    std::string path_;
+};
+
+TEST_F(FrameRingTest, ReadersFollowAcrossLapsAndSeeTheEnd) {
+    FrameRingWriter writer(path_, 4096);
+    EXPECT_EQ(writer.capacity(), 4096u);
+    FrameRingReader reader(path_);
+    FrameRingKind kind;
+    std::vector<char> payload;
+    EXPECT_EQ(reader.poll(kind, payload), FrameRingReader::Poll::Empty);
+
+    // Read as we go, far past the ring's size: wrap records are invisible.
+    for (uint32_t i = 0; i < 500; ++i) {
+        const std::vector<char> m = message(i);
+        writer.publish(kRingBookFrame, m.data(), m.size());
+        ASSERT_EQ(reader.poll(kind, payload), FrameRingReader::Poll::Message) << i;
+        EXPECT_EQ(kind, kRingBookFrame);
+        EXPECT_EQ(payload, m) << i;
+    }
+    EXPECT_EQ(reader.poll(kind, payload), FrameRingReader::Poll::Empty);
+    writer.publish(kRingDayEnd, nullptr, 0);
+    writer.close();
+    ASSERT_EQ(reader.poll(kind, payload), FrameRingReader::Poll::Message) << "drained before the end";
+    EXPECT_EQ(kind, kRingDayEnd);
+    EXPECT_TRUE(payload.empty());
+    EXPECT_EQ(reader.poll(kind, payload), FrameRingReader::Poll::Closed);
+    EXPECT_EQ(reader.dropped(), 0u);
+
+    std::vector<char> huge(FrameRingWriter::maxPayload(writer.capacity()) + 1);
+    EXPECT_THROW(writer.publish(kRingBookFrame, huge.data(), huge.size()), std::invalid_argument);
+}
+
+TEST_F(FrameRingTest, LateReadersStartAtTheStickyMessage) {
+    FrameRingWriter writer(path_, 1 << 16);
+    const LiveDayStart day{3, 5, 1, 10000, 100, "2026-01-07", "AAPL"};
+    writer.publish(kRingDayStart, &day, sizeof(day), true);
+    const std::vector<char> m = message(7);
+    writer.publish(kRingBookFrame, m.data(), m.size());
+
+    FrameRingReader late(path_);
+    FrameRingKind kind;
+    std::vector<char> payload;
+    ASSERT_EQ(late.poll(kind, payload), FrameRingReader::Poll::Message);
+    ASSERT_EQ(kind, kRingDayStart);
+    ASSERT_EQ(payload.size(), sizeof(LiveDayStart));
+    LiveDayStart got;
+    std::memcpy(&got, payload.data(), sizeof(got));
+    EXPECT_EQ(got.day_index, 3u);
+    EXPECT_STREQ(got.date, "2026-01-07");
+    EXPECT_EQ(late.poll(kind, payload), FrameRingReader::Poll::Empty) << "then only new messages";
+
+    FrameRingReader oldest(path_, true);
+    ASSERT_EQ(oldest.poll(kind, payload), FrameRingReader::Poll::Message);
+    EXPECT_EQ(kind, kRingDayStart);
+    ASSERT_EQ(oldest.poll(kind, payload), FrameRingReader::Poll::Message);
+    EXPECT_EQ(payload, m);
+}
+
+TEST_F(FrameRingTest, OvertakenReaderSkipsToTheNewest) {
+    FrameRingWriter writer(path_, 4096);
+    FrameRingReader reader(path_);
+    for (uint32_t i = 0; i < 200; ++i) {
+        const std::vector<char> m = message(i);
+        writer.publish(kRingBookFrame, m.data(), m.size());
+    }
+    FrameRingKind kind;
+    std::vector<char> payload;
+    EXPECT_EQ(reader.poll(kind, payload), FrameRingReader::Poll::Empty) << "resynced at the write position";
+    EXPECT_EQ(reader.dropped(), 1u);
+    const std::vector<char> m = message(200);
+    writer.publish(kRingBookFrame, m.data(), m.size());
+    ASSERT_EQ(reader.poll(kind, payload), FrameRingReader::Poll::Message);
+    EXPECT_EQ(payload, m);
+}
+
+TEST_F(FrameRingTest, ConcurrentReaderNeverSeesATornMessage) {
+    FrameRingWriter writer(path_, 4096);
+    FrameRingReader reader(path_);
+    constexpr uint32_t kMessages = 200000;
+    std::thread producer([&] {
+        for (uint32_t i = 0; i < kMessages; ++i) {
+            const std::vector<char> m = message(i);
+            writer.publish(kRingBookFrame, m.data(), m.size());
+            if (i % 8 == 0) std::this_thread::yield();  // let a single-core reader in
+        }
+        writer.close();
+    });
+
+    FrameRingKind kind;
+    std::vector<char> payload;
+    uint64_t received = 0;
+    int64_t last = -1;
+    for (;;) {
+        const FrameRingReader::Poll p = reader.poll(kind, payload);
+        if (p == FrameRingReader::Poll::Closed) break;
+        if (p == FrameRingReader::Poll::Empty) {
+            std::this_thread::yield();
+            continue;
+        }
+        const uint32_t i = indexOf(payload);
+        ASSERT_GT(static_cast<int64_t>(i), last) << "in order";
+        ASSERT_EQ(payload, message(i)) << "intact";
+        last = i;
+        ++received;
+    }
+    producer.join();
+    EXPECT_GT(received, 0u);
+    EXPECT_LT(last, static_cast<int64_t>(kMessages));
+}
+
+TEST_F(FrameRingTest, AttachingToSomethingElseFails) {
+    EXPECT_THROW(FrameRingReader("no_such_ring"), std::runtime_error);
+    {
+        std::ofstream out(path_, std::ios::binary);
+        out << std::string(8192, 'x');
+    }
+    EXPECT_THROW(FrameRingReader{path_}, std::runtime_error);
+}
+
+}  // namespace test
+}  // namespace qrsdp
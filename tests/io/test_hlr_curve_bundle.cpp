@@ -0,0 +1,143 @@
+#include <gtest/gtest.h>
+#include "io/hlr_curve_bundle.h"
+#include "model/curve_intensity_model.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace qrsdp {
+namespace test {
+
+static std::vector<std::pair<std::string, HLRParams>> makeCurves() {
+    HLRParams wide = makeDefaultHLRParams(5, 60);
+    wide.spread_sensitivity = 0.4;
+    wide.imbalance_sensitivity = 0.25;
+    HLRParams narrow = makeDefaultHLRParams(2, 7);
+    for (IntensityCurve& c : narrow.lambda_C_ask) c.setTable(std::vector<double>(8, 1.5));
+    return {{"MSFT", wide}, {"AAPL", narrow}, {"", makeDefaultHLRParams(3, 20)}};
+}
+
+static void expectSameRates(const HLRCurveTable& got, const HLRCurveTable& want) {
+    ASSERT_EQ(got.levels(), want.levels());
+    ASSERT_EQ(got.rowLength(), want.rowLength());
+    for (size_t n = 0; n < want.rowLength() + 3; ++n) {
+        for (size_t level = 0; level < want.levels(); ++level) {
+            for (Side side : {Side::BID, Side::ASK}) {
+                EXPECT_EQ(got.levelRates(level, side, n).add, want.levelRates(level, side, n).add);
+                EXPECT_EQ(got.levelRates(level, side, n).cancel, want.levelRates(level, side, n).cancel);
+            }
+        }
+        EXPECT_EQ(got.marketBuy(n), want.marketBuy(n));
+        EXPECT_EQ(got.marketSell(n), want.marketSell(n));
+    }
+}
+
+TEST(HLRCurveBundle, RoundTripsEverySymbolsTable) {
+    const std::string path = testing::TempDir() + "test_curves.qrhc";
+    const auto curves = makeCurves();
+    writeHLRCurveBundle(path, curves);
+    ASSERT_TRUE(isHLRCurveBundle(path));
+
+    const HLRCurveBundle bundle(path);
+    ASSERT_EQ(bundle.size(), 3u);
+    EXPECT_EQ(bundle.symbols()[0].symbol, "");
+    EXPECT_EQ(bundle.symbols()[1].symbol, "AAPL");
+    EXPECT_EQ(bundle.symbols()[2].symbol, "MSFT");
+    EXPECT_EQ(bundle.find("GOOG"), nullptr);
+    for (const auto& [symbol, params] : curves) {
+        const CurveBundleSymbol* entry = bundle.find(symbol);
+        ASSERT_NE(entry, nullptr) << symbol;
+        EXPECT_EQ(entry->levels, static_cast<uint32_t>(params.K));
+        EXPECT_EQ(entry->spread_sensitivity, params.spread_sensitivity);
+        EXPECT_EQ(entry->imbalance_sensitivity, params.imbalance_sensitivity);
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(entry->rows) % kCurveBundleAlignment, 0u);
+        expectSameRates(bundle.table(*entry), HLRCurveTable(params));
+    }
+    std::remove(path.c_str());
+}
+
+TEST(HLRCurveBundle, ModelsReadTheMappingAfterTheBundleIsGone) {
+    const std::string path = testing::TempDir() + "test_curves_view.qrhc";
+    const auto curves = makeCurves();
+    writeHLRCurveBundle(path, curves);
+    const HLRParams& msft = curves[0].second;
+
+    std::unique_ptr<CurveIntensityModel> a, b;
+    {
+        const HLRCurveBundle bundle(path);
+        const CurveBundleSymbol* entry = bundle.find("MSFT");
+        ASSERT_NE(entry, nullptr);
+        a = std::make_unique<CurveIntensityModel>(bundle.table(*entry), entry->spread_sensitivity,
+                                                  entry->imbalance_sensitivity);
+        b = std::make_unique<CurveIntensityModel>(bundle.table(*entry), entry->spread_sensitivity,
+                                                  entry->imbalance_sensitivity);
+        EXPECT_EQ(a->curves().rowData(), entry->rows) << "a view, not a copy";
+    }
+    EXPECT_EQ(a->curves().rowData(), b->curves().rowData());
+    CurveIntensityModel reference(msft);
+
+    BookState state;
+    state.features = BookFeatures{9999, 10002, 7, 2, 3, 0.0};
+    state.bid_depths = {7, 0, 3, 61, 12};
+    state.ask_depths = {2, 9, 5, 1, 80};
+    const Intensities got = a->compute(state);
+    const Intensities want = reference.compute(state);
+    EXPECT_EQ(got.add_bid, want.add_bid);
+    EXPECT_EQ(got.add_ask, want.add_ask);
+    EXPECT_EQ(got.cancel_bid, want.cancel_bid);
+    EXPECT_EQ(got.cancel_ask, want.cancel_ask);
+    EXPECT_EQ(got.exec_buy, want.exec_buy);
+    EXPECT_EQ(got.exec_sell, want.exec_sell);
+    std::remove(path.c_str());
+}
+
+TEST(HLRCurveBundle, RejectsDuplicatesAndDamagedFiles) {
+    const std::string path = testing::TempDir() + "test_curves_bad.qrhc";
+    const HLRParams p = makeDefaultHLRParams(2, 10);
+    EXPECT_THROW(writeHLRCurveBundle(path, {{"AAA", p}, {"AAA", p}}), std::runtime_error);
+    EXPECT_THROW(writeHLRCurveBundle(path, {{"SEVENTEEN_CHARS__", p}}), std::runtime_error);
+
+    writeHLRCurveBundle(path, {{"AAA", p}, {"BBB", p}});
+    std::vector<char> bytes;
+    {
+        std::ifstream in(path, std::ios::binary);
+        bytes.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+    auto writeBytes = [&](const std::vector<char>& b) {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out.write(b.data(), static_cast<std::streamsize>(b.size()));
+    };
+
+    std::vector<char> truncated(bytes.begin(), bytes.end() - 64);
+    writeBytes(truncated);
+    EXPECT_THROW(HLRCurveBundle{path}, std::runtime_error);
+
+    std::vector<char> bad_magic = bytes;
+    bad_magic[0] = 'X';
+    writeBytes(bad_magic);
+    EXPECT_FALSE(isHLRCurveBundle(path));
+    EXPECT_THROW(HLRCurveBundle{path}, std::runtime_error);
+
+    std::vector<char> bad_entry = bytes;
+    CurveBundleEntry e{};
+    const size_t at = sizeof(CurveBundleHeader) + sizeof(CurveBundleEntry);
+    std::memcpy(&e, bad_entry.data() + at, sizeof(e));
+    e.rows_offset += 8;  // misaligned
+    std::memcpy(bad_entry.data() + at, &e, sizeof(e));
+    writeBytes(bad_entry);
+    EXPECT_THROW(HLRCurveBundle{path}, std::runtime_error);
+
+    writeBytes(bytes);
+    EXPECT_EQ(HLRCurveBundle(path).size(), 2u);
+    std::remove(path.c_str());
+}
+
+}  // namespace test
+}  // namespace qrsdp
@@ -0,0 +1,178 @@
+#include <gtest/gtest.h>
+#include "io/binary_file_sink.h"
+#include "io/event_log_reader.h"
+#include "io/io_uring_writer.h"
+#include "core/records.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace qrsdp {
+namespace test {
+
+static std::vector<char> fileBytes(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    return std::vector<char>(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+static TradingSession makeTestSession(uint64_t seed) {
+    TradingSession s{};
+    s.seed                 = seed;
+    s.p0_ticks             = 100000;
+    s.session_seconds      = 30;
+    s.levels_per_side      = 10;
+    s.tick_size            = 100;
+    s.initial_spread_ticks = 2;
+    s.initial_depth        = 50;
+    return s;
+}
+
+static std::vector<EventRecord> makeRecords(size_t n, uint64_t seed) {
+    std::mt19937_64 rng(seed);
+    std::vector<EventRecord> recs(n);
+    for (size_t i = 0; i < n; ++i) {
+        recs[i].ts_ns = i * 100000 + rng() % 1000;
+        recs[i].type = static_cast<uint8_t>(rng() % 6);
+        recs[i].side = static_cast<uint8_t>(rng() % 2);
+        recs[i].price_ticks = 100000 + static_cast<int32_t>(rng() % 40);
+        recs[i].qty = 1;
+        recs[i].order_id = i + 1;
+    }
+    return recs;
+}
+
+class IoUringWriterTest : public ::testing::TestWithParam<bool> {
+protected:
+    void SetUp() override {
+        if (!IoUringWriter::available())
+            GTEST_SKIP() << "io_uring not built or not permitted here";
+        base_ = testing::TempDir() + "test_uring_" + std::to_string(reinterpret_cast<uintptr_t>(this));
+    }
+
+    void TearDown() override {
+        for (const std::string& p : paths_) std::remove(p.c_str());
+    }
+
+    std::string path(const std::string& name) {
+        paths_.push_back(base_ + name);
+        return paths_.back();
+    }
+
+    IoUringOptions options() const {
+        IoUringOptions o;
+        o.buffers = 16;
+        o.buffer_bytes = 8192;  // small, so every file spans many writes
+        o.direct = GetParam();
+        return o;
+    }
+
+    std::string base_;
+    std::vector<std::string> paths_;
+};
+
+TEST_P(IoUringWriterTest, FileMatchesWhatWasAppendedAndPatched) {
+    IoUringWriter writer(options());
+    std::mt19937 rng(3);
+    std::vector<char> expected;
+    const std::string p = path(".bin");
+    {
+        auto f = writer.open(p, true);
+        for (int i = 0; i < 300; ++i) {
+            std::vector<char> piece(1 + rng() % 700);
+            for (char& c : piece) c = static_cast<char>(rng());
+            f->append(piece.data(), piece.size());
+            expected.insert(expected.end(), piece.begin(), piece.end());
+            if (i % 97 == 0) f->sync();  // pads the tail under O_DIRECT, rewritten later
+        }
+        EXPECT_EQ(f->size(), expected.size());
+        const uint32_t word = 0xA5A5A5A5u;
+        f->patch(52, &word, sizeof(word));
+        std::memcpy(expected.data() + 52, &word, sizeof(word));
+        f->close();
+    }
+    EXPECT_EQ(fileBytes(p), expected);
+
+    // Reopened without truncation it appends after the unaligned end.
+    {
+        auto f = writer.open(p, false);
+        EXPECT_EQ(f->size(), expected.size());
+        const char tail[] = "appended";
+        f->append(tail, sizeof(tail));
+        expected.insert(expected.end(), tail, tail + sizeof(tail));
+    }  // destructor closes
+    EXPECT_EQ(fileBytes(p), expected);
+    EXPECT_GT(writer.writesSubmitted(), expected.size() / options().buffer_bytes);
+}
+
+TEST_P(IoUringWriterTest, SharedBySinksOnSeveralThreadsMatchesStdio) {
+    constexpr int kFiles = 4;
+    BinaryFileSinkOptions stdio;
+    stdio.chunk_capacity = 64;
+    stdio.seek_stride = 16;
+    stdio.sync_interval = 5;
+    for (int i = 0; i < kFiles; ++i) {
+        BinaryFileSink sink(path("_ref" + std::to_string(i)), makeTestSession(i), stdio);
+        const auto recs = makeRecords(3000 + 500 * i, i);
+        sink.appendBatch(recs.data(), recs.size());
+    }
+
+    IoUringWriter writer(options());
+    BinaryFileSinkOptions uring = stdio;
+    uring.io_uring = &writer;
+    std::vector<std::thread> threads;
+    for (int i = 0; i < kFiles; ++i) {
+        const std::string p = path("_uring" + std::to_string(i));
+        threads.emplace_back([&uring, p, i] {
+            BinaryFileSink sink(p, makeTestSession(i), uring);
+            const auto recs = makeRecords(3000 + 500 * i, i);
+            for (size_t k = 0; k < recs.size(); k += 37)
+                sink.appendBatch(recs.data() + k, std::min<size_t>(37, recs.size() - k));
+            sink.close();
+        });
+    }
+    for (auto& t : threads) t.join();
+
+    for (int i = 0; i < kFiles; ++i) {
+        const std::string p = base_ + "_uring" + std::to_string(i);
+        EXPECT_EQ(fileBytes(p), fileBytes(base_ + "_ref" + std::to_string(i))) << "file " << i;
+        EventLogReader reader(p);
+        EXPECT_EQ(reader.verify(VerifyMode::Full), 3000u + 500u * i);
+    }
+}
+
+INSTANTIATE_TEST_SUITE_P(Buffered, IoUringWriterTest, ::testing::Values(false));
+INSTANTIATE_TEST_SUITE_P(Direct, IoUringWriterTest, ::testing::Values(true));
+
+TEST(IoUringWriter, TooFewBuffersForTheOpenFilesIsAnError) {
+    if (!IoUringWriter::available())
+        GTEST_SKIP() << "io_uring not built or not permitted here";
+    IoUringOptions o;
+    o.buffers = 2;
+    o.buffer_bytes = 4096;
+    IoUringWriter writer(o);
+    const std::string base = testing::TempDir() + "test_uring_few";
+    auto a = writer.open(base + "a", true);
+    auto b = writer.open(base + "b", true);
+    auto c = writer.open(base + "c", true);
+    const char byte = 1;
+    a->append(&byte, 1);
+    b->append(&byte, 1);
+    EXPECT_THROW(c->append(&byte, 1), std::runtime_error);
+    a.reset();
+    c->append(&byte, 1);  // a's buffer went back to the pool
+    b.reset();
+    c.reset();
+    for (const char* n : {"a", "b", "c"}) std::remove((base + n).c_str());
+}
+
+}  // namespace test
+}  // namespace qrsdp
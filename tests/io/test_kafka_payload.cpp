@@ -0,0 +1,88 @@
+#include <gtest/gtest.h>
+#include "io/kafka_payload.h"
+
+#include <cstring>
+#include <vector>
+
+namespace qrsdp {
+namespace test {
+
+static std::vector<char> makeBatch(const std::vector<DiskEventRecord>& recs) {
+    KafkaBatchHeader hdr{};
+    std::memcpy(hdr.magic, kKafkaBatchMagic, 4);
+    hdr.version = kKafkaBatchVersion;
+    hdr.record_size = sizeof(DiskEventRecord);
+    hdr.record_count = static_cast<uint32_t>(recs.size());
+    std::vector<char> out(sizeof(hdr) + recs.size() * sizeof(DiskEventRecord));
+    std::memcpy(out.data(), &hdr, sizeof(hdr));
+    if (!recs.empty())
+        std::memcpy(out.data() + sizeof(hdr), recs.data(), recs.size() * sizeof(DiskEventRecord));
+    return out;
+}
+
+TEST(KafkaPayload, BareRecordAndBatch) {
+    DiskEventRecord one{};
+    one.ts_ns = 42;
+    one.order_id = 7;
+    KafkaPayloadView view;
+    ASSERT_TRUE(parseKafkaPayload(&one, sizeof(one), view));
+    ASSERT_EQ(view.count, 1u);
+    EXPECT_EQ(view.records[0].order_id, 7u);
+
+    std::vector<DiskEventRecord> recs(3);
+    for (size_t i = 0; i < recs.size(); ++i)
+        recs[i].ts_ns = 100 + i;
+    const std::vector<char> batch = makeBatch(recs);
+    ASSERT_TRUE(parseKafkaPayload(batch.data(), batch.size(), view));
+    ASSERT_EQ(view.count, 3u);
+    EXPECT_EQ(view.records[2].ts_ns, 102u);
+}
+
+TEST(KafkaPayload, RejectsMalformedPayloads) {
+    std::vector<DiskEventRecord> recs(2);
+    std::vector<char> batch = makeBatch(recs);
+    KafkaPayloadView view;
+    EXPECT_FALSE(parseKafkaPayload(batch.data(), batch.size() - 1, view)) << "truncated";
+    EXPECT_EQ(view.count, 0u);
+    EXPECT_FALSE(parseKafkaPayload(batch.data(), 5, view)) << "shorter than a header";
+    EXPECT_FALSE(parseKafkaPayload(nullptr, sizeof(DiskEventRecord), view));
+    batch[0] = 'X';
+    EXPECT_FALSE(parseKafkaPayload(batch.data(), batch.size(), view)) << "bad magic";
+
+    const std::vector<char> empty = makeBatch({});
+    ASSERT_TRUE(parseKafkaPayload(empty.data(), empty.size(), view));
+    EXPECT_EQ(view.count, 0u);
+}
+
+TEST(KafkaPayload, WriterBuildsParseableBatches) {
+    const uint32_t capacity = 4;
+    std::vector<char> buf(kafkaBatchBytes(capacity));
+    KafkaBatchWriter writer;
+    writer.reset(buf.data(), capacity);
+    for (uint32_t i = 0; i < capacity; ++i) {
+        DiskEventRecord rec{};
+        rec.ts_ns = 1000 + i;
+        rec.order_id = i + 1;
+        writer.add(rec);
+    }
+    EXPECT_TRUE(writer.full());
+    const size_t len = writer.finish();
+    EXPECT_EQ(len, buf.size());
+    KafkaPayloadView view;
+    ASSERT_TRUE(parseKafkaPayload(buf.data(), len, view));
+    ASSERT_EQ(view.count, 4u);
+    EXPECT_EQ(view.records[3].ts_ns, 1003u);
+    EXPECT_EQ(view.records[3].order_id, 4u);
+
+    writer.reset(buf.data(), capacity);
+    DiskEventRecord one{};
+    one.ts_ns = 7;
+    writer.add(one);
+    EXPECT_FALSE(writer.full());
+    ASSERT_TRUE(parseKafkaPayload(buf.data(), writer.finish(), view));
+    ASSERT_EQ(view.count, 1u) << "a one-record batch keeps its header";
+    EXPECT_EQ(view.records[0].ts_ns, 7u);
+}
+
+}  // namespace test
+}  // namespace qrsdp
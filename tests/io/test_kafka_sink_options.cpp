@@ -0,0 +1,61 @@
+#include <gtest/gtest.h>
+#include "io/kafka_sink_options.h"
+
+#include <string>
+
+namespace qrsdp {
+namespace test {
+
+static std::string settingOf(const KafkaConfigEntries& entries, const std::string& key) {
+    std::string value;
+    for (const auto& kv : entries)
+        if (kv.first == key) value = kv.second;
+    return value;
+}
+
+TEST(KafkaSinkOptions, ProfileNamesRoundTrip) {
+    for (KafkaProfile p : {KafkaProfile::BALANCED, KafkaProfile::THROUGHPUT,
+                           KafkaProfile::LATENCY}) {
+        KafkaProfile parsed = KafkaProfile::BALANCED;
+        ASSERT_TRUE(parseKafkaProfile(kafkaProfileName(p), parsed));
+        EXPECT_EQ(parsed, p);
+    }
+    KafkaProfile untouched = KafkaProfile::LATENCY;
+    EXPECT_FALSE(parseKafkaProfile("fast", untouched));
+    EXPECT_EQ(untouched, KafkaProfile::LATENCY);
+}
+
+TEST(KafkaSinkOptions, ProfileSettings) {
+    const auto balanced = kafkaProfileSettings(KafkaProfile::BALANCED);
+    EXPECT_EQ(settingOf(balanced, "linger.ms"), "5");
+    EXPECT_EQ(settingOf(balanced, "enable.idempotence"), "true");
+
+    const auto throughput = kafkaProfileSettings(KafkaProfile::THROUGHPUT);
+    EXPECT_EQ(settingOf(throughput, "linger.ms"), "50");
+    EXPECT_FALSE(settingOf(throughput, "batch.num.messages").empty());
+
+    const auto latency = kafkaProfileSettings(KafkaProfile::LATENCY);
+    EXPECT_EQ(settingOf(latency, "linger.ms"), "0");
+    EXPECT_EQ(settingOf(latency, "acks"), "1");
+    EXPECT_EQ(settingOf(latency, "enable.idempotence"), "false") << "idempotence requires acks=all";
+}
+
+TEST(KafkaSinkOptions, ConfigEntriesAndPartitions) {
+    std::pair<std::string, std::string> kv;
+    ASSERT_TRUE(parseKafkaConfigEntry("sasl.password=a=b", kv));
+    EXPECT_EQ(kv.first, "sasl.password");
+    EXPECT_EQ(kv.second, "a=b");
+    ASSERT_TRUE(parseKafkaConfigEntry("client.id=", kv));
+    EXPECT_EQ(kv.second, "");
+    EXPECT_FALSE(parseKafkaConfigEntry("linger.ms", kv));
+    EXPECT_FALSE(parseKafkaConfigEntry("=5", kv));
+
+    EXPECT_EQ(kafkaPartitionFor(0, 0), -1);
+    EXPECT_EQ(kafkaPartitionFor(4, 0), -1);
+    EXPECT_EQ(kafkaPartitionFor(0, 3), 0);
+    EXPECT_EQ(kafkaPartitionFor(2, 3), 2);
+    EXPECT_EQ(kafkaPartitionFor(4, 3), 1);
+}
+
+}  // namespace test
+}  // namespace qrsdp
@@ -0,0 +1,91 @@
+#include <gtest/gtest.h>
+#include "core/metrics.h"
+#include "io/metrics_exporter.h"
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#ifndef _WIN32
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+namespace qrsdp {
+namespace test {
+
+#ifndef _WIN32
+static std::string httpGet(uint16_t port, const std::string& path) {
+    const int sock = socket(AF_INET, SOCK_STREAM, 0);
+    if (sock < 0) return "";
+    struct sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    std::string response;
+    if (connect(sock, reinterpret_cast<const struct sockaddr*>(&addr), sizeof(addr)) == 0) {
+        const std::string request = "GET " + path + " HTTP/1.1\r\nHost: localhost\r\n\r\n";
+        if (send(sock, request.data(), request.size(), 0) == static_cast<ssize_t>(request.size())) {
+            char buf[4096];
+            ssize_t n;
+            while ((n = recv(sock, buf, sizeof(buf), 0)) > 0) response.append(buf, static_cast<size_t>(n));
+        }
+    }
+    close(sock);
+    return response;
+}
+
+TEST(MetricsExporter, ServesPrometheusText) {
+    MetricsRegistry reg;
+    reg.counter("qrsdp_events_total", "Events generated", "symbol=\"AAA\"").add(42);
+    MetricsExportOptions options;
+    options.http = true;
+    options.http_port = 0;
+    MetricsExporter exporter(reg, options);
+    ASSERT_NE(exporter.port(), 0);
+    exporter.start();
+
+    const std::string ok = httpGet(exporter.port(), "/metrics");
+    EXPECT_EQ(ok.compare(0, 15, "HTTP/1.1 200 OK"), 0) << ok;
+    EXPECT_NE(ok.find("qrsdp_events_total{symbol=\"AAA\"} 42\n"), std::string::npos) << ok;
+    EXPECT_EQ(httpGet(exporter.port(), "/other").compare(0, 12, "HTTP/1.1 404"), 0);
+    exporter.stop();
+    EXPECT_EQ(exporter.scrapesServed(), 1u);
+}
+#endif
+
+TEST(MetricsExporter, WritesJsonLinesAndAFinalOne) {
+    const std::string path =
+        (std::filesystem::temp_directory_path() / "qrsdp_metrics_exporter_test.jsonl").string();
+    std::remove(path.c_str());
+
+    MetricsRegistry reg;
+    Counter& c = reg.counter("c", "counter");
+    MetricsExportOptions options;
+    options.json_path = path;
+    options.interval_ms = 10;
+    {
+        MetricsExporter exporter(reg, options);
+        exporter.start();
+        c.add(3);
+        exporter.stop();
+    }
+
+    std::ifstream in(path);
+    std::string line, last;
+    size_t lines = 0;
+    while (std::getline(in, line)) {
+        ++lines;
+        last = line;
+        EXPECT_EQ(line.compare(0, 9, "{\"ts_ms\":"), 0) << line;
+    }
+    EXPECT_GE(lines, 1u);
+    EXPECT_NE(last.find("\"c\":3}"), std::string::npos) << last;
+    std::remove(path.c_str());
+}
+
+}  // namespace test
+}  // namespace qrsdp
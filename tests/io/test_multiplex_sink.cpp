@@ -3,6 +3,8 @@
 #include "io/in_memory_sink.h"
 #include "core/records.h"
 
+#include <vector>
+
 namespace qrsdp {
 namespace test {
 
@@ -75,5 +77,36 @@ TEST(MultiplexSink, BestEffortOnFailure) {
     EXPECT_EQ(good.size(), 1u);
 }
 
+TEST(MultiplexSink, AppendBatchFansOutInOrder) {
+    InMemorySink a, b;
+    MultiplexSink mux;
+    mux.addSink(&a);
+    mux.addSink(&b);
+
+    std::vector<EventRecord> recs;
+    for (uint64_t i = 0; i < 100; ++i) recs.push_back(makeRecord(i));
+    mux.appendBatch(recs.data(), 60);
+    mux.appendBatch(recs.data() + 60, 40);
+
+    ASSERT_EQ(a.size(), 100u);
+    ASSERT_EQ(b.size(), 100u);
+    for (uint64_t i = 0; i < 100; ++i) {
+        EXPECT_EQ(a.events()[i].ts_ns, i);
+        EXPECT_EQ(b.events()[i].ts_ns, i);
+    }
+}
+
+TEST(MultiplexSink, BatchBestEffortOnFailure) {
+    ThrowingSink bad;
+    InMemorySink good;
+    MultiplexSink mux;
+    mux.addSink(&bad);
+    mux.addSink(&good);
+
+    const EventRecord recs[3] = {makeRecord(1), makeRecord(2), makeRecord(3)};
+    mux.appendBatch(recs, 3);
+    EXPECT_EQ(good.size(), 3u);
+}
+
 }  // namespace test
 }  // namespace qrsdp
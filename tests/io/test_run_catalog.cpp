@@ -0,0 +1,165 @@
+#include <gtest/gtest.h>
+#include "io/binary_file_sink.h"
+#include "io/event_log_reader.h"
+#include "io/run_catalog.h"
+#include "core/records.h"
+
+#include <cstddef>
+#include <cstdio>
+#include <filesystem>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace qrsdp {
+namespace test {
+
+static CatalogDay makeDay(const std::string& symbol, const std::string& date, uint64_t records) {
+    CatalogDay day;
+    day.symbol = symbol;
+    day.date = date;
+    day.file = (symbol.empty() ? "" : symbol + "/") + date + ".qrsdp";
+    day.seed = records * 3;
+    day.open_ticks = 10000;
+    day.close_ticks = 10000 + static_cast<int32_t>(records % 7);
+    day.record_count = records;
+    day.chunk_count = static_cast<uint32_t>(records / 4096 + 1);
+    day.has_stats = true;
+    day.stats.type_counts[0] = records;
+    day.stats.min_price_ticks = 9990;
+    day.stats.max_price_ticks = 10010;
+    day.stats.shifts_up = records / 10;
+    return day;
+}
+
+class RunCatalogTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        path_ = testing::TempDir() + "test_catalog_" + std::to_string(reinterpret_cast<uintptr_t>(this))
+              + ".qcat";
+    }
+
+    void TearDown() override { std::remove(path_.c_str()); }
+
+    std::string path_;
+};
+
+TEST_F(RunCatalogTest, QueriesBySymbolAndDateRange) {
+    {
+        RunCatalogWriter writer(path_, false);
+        // Completion order, not key order.
+        EXPECT_TRUE(writer.add(makeDay("BBB", "2026-01-05", 500)));
+        EXPECT_TRUE(writer.add(makeDay("AAA", "2026-01-06", 600)));
+        EXPECT_TRUE(writer.add(makeDay("AAA", "2026-01-02", 200)));
+        EXPECT_TRUE(writer.add(makeDay("AAA", "2026-01-05", 300)));
+        EXPECT_FALSE(writer.add(makeDay("AAA", "2026-01-05", 999))) << "duplicate key";
+        EXPECT_EQ(writer.size(), 4u);
+    }
+    ASSERT_TRUE(isRunCatalog(path_));
+
+    const RunCatalog catalog(path_);
+    ASSERT_EQ(catalog.size(), 4u);
+    EXPECT_EQ(catalog.days()[0].date, "2026-01-02");
+    EXPECT_EQ(catalog.days()[3].symbol, "BBB");
+
+    const std::vector<CatalogDay> aaa = catalog.query("AAA", "2026-01-03", "2026-01-06");
+    ASSERT_EQ(aaa.size(), 2u);
+    EXPECT_EQ(aaa[0].date, "2026-01-05");
+    EXPECT_EQ(aaa[0].record_count, 300u);
+    EXPECT_EQ(aaa[0].file, "AAA/2026-01-05.qrsdp");
+    EXPECT_EQ(aaa[0].stats.shifts_up, 30u);
+    EXPECT_TRUE(aaa[0].has_stats);
+    EXPECT_EQ(aaa[1].date, "2026-01-06");
+
+    EXPECT_EQ(catalog.query("", "2026-01-05", "2026-01-05").size(), 2u);
+    EXPECT_EQ(catalog.query("CCC").size(), 0u);
+    ASSERT_NE(catalog.find("BBB", "2026-01-05"), nullptr);
+    EXPECT_EQ(catalog.find("BBB", "2026-01-05")->seed, 1500u);
+    EXPECT_EQ(catalog.find("BBB", "2026-01-06"), nullptr);
+}
+
+TEST_F(RunCatalogTest, TornLastEntryIsDroppedAndReopenKeepsTheRest) {
+    {
+        RunCatalogWriter writer(path_, false);
+        writer.add(makeDay("", "2026-01-02", 100));
+        writer.add(makeDay("", "2026-01-05", 200));
+        writer.add(makeDay("", "2026-01-06", 300));
+    }
+    // A crash mid-write: half of the last entry made it to disk.
+    const auto full = std::filesystem::file_size(path_);
+    std::filesystem::resize_file(path_, full - sizeof(CatalogEntry) / 2);
+    EXPECT_EQ(RunCatalog(path_).size(), 2u);
+
+    {
+        RunCatalogWriter writer(path_, true);
+        EXPECT_EQ(writer.size(), 2u);
+        EXPECT_FALSE(writer.add(makeDay("", "2026-01-05", 200))) << "kept day";
+        EXPECT_TRUE(writer.add(makeDay("", "2026-01-06", 300)));
+    }
+    EXPECT_EQ(std::filesystem::file_size(path_), full);
+    const RunCatalog catalog(path_);
+    ASSERT_EQ(catalog.size(), 3u);
+    EXPECT_EQ(catalog.days()[2].record_count, 300u);
+
+    // Without keep_existing the catalogue starts over.
+    { RunCatalogWriter writer(path_, false); }
+    EXPECT_EQ(RunCatalog(path_).size(), 0u);
+}
+
+TEST_F(RunCatalogTest, CorruptEntryBeforeTheLastThrows) {
+    {
+        RunCatalogWriter writer(path_, false);
+        writer.add(makeDay("X", "2026-01-02", 1));
+        writer.add(makeDay("X", "2026-01-05", 2));
+    }
+    std::FILE* f = std::fopen(path_.c_str(), "r+b");
+    ASSERT_NE(f, nullptr);
+    std::fseek(f, sizeof(CatalogHeader) + offsetof(CatalogEntry, record_count), SEEK_SET);
+    std::fputc(0x7f, f);
+    std::fclose(f);
+    EXPECT_THROW(RunCatalog catalog(path_), std::runtime_error);
+}
+
+TEST_F(RunCatalogTest, RejectsFieldsThatDoNotFit) {
+    RunCatalogWriter writer(path_, false);
+    EXPECT_THROW(writer.add(makeDay("A_VERY_LONG_SYMBOL_NAME", "2026-01-02", 1)), std::runtime_error);
+    EXPECT_EQ(writer.size(), 0u);
+}
+
+TEST_F(RunCatalogTest, CatalogDayReadsTheFooterOnly) {
+    const std::string log_path = path_ + ".qrsdp";
+    TradingSession session{};
+    session.seed = 7;
+    session.p0_ticks = 10000;
+    session.levels_per_side = 5;
+    session.tick_size = 100;
+    session.initial_spread_ticks = 2;
+    session.initial_depth = 10;
+    {
+        BinaryFileSink sink(log_path, session, 16);
+        for (int i = 0; i < 50; ++i) {
+            EventRecord r{};
+            r.ts_ns = 1000 + static_cast<uint64_t>(i);
+            r.type = static_cast<uint8_t>(i % 6);
+            r.price_ticks = 10000 + i % 5;
+            r.qty = 2;
+            r.order_id = static_cast<uint64_t>(i + 1);
+            r.flags = i % 10 == 0 ? kFlagShiftDown : kFlagNone;
+            sink.append(r);
+        }
+    }
+    const CatalogDay day = catalogDay(EventLogReader(log_path), "SYM", "2026-01-02", "SYM/2026-01-02.qrsdp");
+    std::remove(log_path.c_str());
+    EXPECT_EQ(day.record_count, 50u);
+    EXPECT_EQ(day.chunk_count, 4u);
+    EXPECT_EQ(day.first_ts_ns, 1000u);
+    EXPECT_EQ(day.last_ts_ns, 1049u);
+    ASSERT_TRUE(day.has_stats);
+    EXPECT_EQ(day.stats.type_counts[0], 9u);
+    EXPECT_EQ(day.stats.min_price_ticks, 10000);
+    EXPECT_EQ(day.stats.max_price_ticks, 10004);
+    EXPECT_EQ(day.stats.shifts_down, 5u);
+}
+
+}  // namespace test
+}  // namespace qrsdp
@@ -0,0 +1,103 @@
+#include <gtest/gtest.h>
+#include "io/in_memory_sink.h"
+#include "io/segmented_event_store.h"
+#include "core/records.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace qrsdp {
+namespace test {
+
+static EventRecord rec(uint64_t i) {
+    EventRecord r{};
+    r.ts_ns = i;
+    r.order_id = i + 1;
+    return r;
+}
+
+static std::vector<EventRecord> recs(uint64_t first, size_t n) {
+    std::vector<EventRecord> out;
+    for (size_t i = 0; i < n; ++i) out.push_back(rec(first + i));
+    return out;
+}
+
+TEST(SegmentedEventStore, AppendsAcrossBlocksWithStableAddresses) {
+    SegmentedEventStore store(6);  // rounded up to 8
+    EXPECT_EQ(store.blockRecords(), 8u);
+    store.append(rec(0));
+    const EventRecord* first = &store[0];
+    const std::vector<EventRecord> batch = recs(1, 20);
+    store.append(batch.data(), batch.size());
+    for (uint64_t i = 21; i < 30; ++i) store.append(rec(i));
+
+    ASSERT_EQ(store.size(), 30u);
+    EXPECT_EQ(&store[0], first) << "growing never moves held records";
+    EXPECT_EQ(store.capacity(), 32u);
+    for (size_t i = 0; i < store.size(); ++i) EXPECT_EQ(store[i].ts_ns, i);
+    EXPECT_EQ(store.back().order_id, 30u);
+
+    uint64_t expect = 0;
+    for (const EventRecord& r : store) EXPECT_EQ(r.ts_ns, expect++);
+    EXPECT_EQ(expect, 30u);
+
+    std::vector<size_t> spans;
+    store.forEachSpan([&](const EventRecord* data, size_t n) {
+        EXPECT_EQ(data[0].ts_ns % 8, 0u);
+        spans.push_back(n);
+    });
+    EXPECT_EQ(spans, (std::vector<size_t>{8, 8, 8, 6}));
+    EXPECT_EQ(store.toVector().size(), 30u);
+}
+
+TEST(SegmentedEventStore, RetainsTheLastNAndReusesBlocks) {
+    SegmentedEventStore store(4, 10);
+    for (uint64_t i = 0; i < 100; ++i) store.append(rec(i));
+    ASSERT_EQ(store.size(), 10u);
+    EXPECT_EQ(store.appended(), 100u);
+    EXPECT_EQ(store.front().ts_ns, 90u);
+    EXPECT_EQ(store.back().ts_ns, 99u);
+    EXPECT_LE(store.capacity(), 16u) << "dropped blocks are recycled";
+
+    // A batch larger than the window only copies its tail.
+    const std::vector<EventRecord> batch = recs(100, 25);
+    store.append(batch.data(), batch.size());
+    ASSERT_EQ(store.size(), 10u);
+    EXPECT_EQ(store.appended(), 125u);
+    for (size_t i = 0; i < store.size(); ++i) EXPECT_EQ(store[i].ts_ns, 115u + i);
+
+    const std::vector<EventRecord> small = recs(125, 3);
+    store.append(small.data(), small.size());
+    EXPECT_EQ(store.front().ts_ns, 118u);
+    EXPECT_EQ(store.back().ts_ns, 127u);
+    EXPECT_LE(store.capacity(), 16u);
+}
+
+TEST(SegmentedEventStore, ClearAndReserveKeepTheArena) {
+    SegmentedEventStore store(16);
+    store.reserve(100);
+    EXPECT_EQ(store.capacity(), 112u);
+    const std::vector<EventRecord> batch = recs(0, 100);
+    store.append(batch.data(), batch.size());
+    EXPECT_EQ(store.capacity(), 112u) << "reserved blocks are used first";
+    store.clear();
+    EXPECT_TRUE(store.empty());
+    store.append(rec(7));
+    EXPECT_EQ(store.size(), 1u);
+    EXPECT_EQ(store.front().ts_ns, 7u);
+    EXPECT_EQ(store.capacity(), 112u);
+}
+
+TEST(InMemorySinkTest, RetentionWindowKeepsTheTail) {
+    InMemorySink sink(5, 4);
+    const std::vector<EventRecord> batch = recs(0, 12);
+    sink.appendBatch(batch.data(), batch.size());
+    sink.append(rec(12));
+    EXPECT_EQ(sink.size(), 5u);
+    EXPECT_EQ(sink.appended(), 13u);
+    EXPECT_EQ(sink.events().front().ts_ns, 8u);
+    EXPECT_EQ(sink.events().back().ts_ns, 12u);
+}
+
+}  // namespace test
+}  // namespace qrsdp
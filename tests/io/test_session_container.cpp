@@ -0,0 +1,149 @@
+#include <gtest/gtest.h>
+#include "io/binary_file_sink.h"
+#include "io/event_log_reader.h"
+#include "io/session_container.h"
+#include "core/records.h"
+
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace qrsdp {
+namespace test {
+
+static TradingSession makeTestSession(uint64_t seed) {
+    TradingSession s{};
+    s.seed                 = seed;
+    s.p0_ticks             = 50000;
+    s.session_seconds      = 60;
+    s.levels_per_side      = 8;
+    s.tick_size            = 100;
+    s.initial_spread_ticks = 2;
+    s.initial_depth        = 20;
+    return s;
+}
+
+/// Writes n records (seeded by seed) to path.
+static void writeLog(const std::string& path, uint64_t seed, int n) {
+    BinaryFileSinkOptions options;
+    options.chunk_capacity = 16;
+    BinaryFileSink sink(path, makeTestSession(seed), options);
+    for (int i = 0; i < n; ++i) {
+        EventRecord r{};
+        r.ts_ns = static_cast<uint64_t>(i) * 1000 + seed;
+        r.type = static_cast<uint8_t>(i % 6);
+        r.side = static_cast<uint8_t>(i % 2);
+        r.price_ticks = 50000 + static_cast<int32_t>((i * 7 + seed) % 30);
+        r.qty = 1;
+        r.order_id = static_cast<uint64_t>(i + 1);
+        sink.append(r);
+    }
+    sink.close();
+}
+
+class SessionContainerTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        base_ = testing::TempDir() + "test_container_" + std::to_string(reinterpret_cast<uintptr_t>(this));
+    }
+
+    void TearDown() override {
+        for (const auto& p : paths_) std::remove(p.c_str());
+    }
+
+    std::string path(const std::string& suffix) {
+        paths_.push_back(base_ + suffix);
+        return paths_.back();
+    }
+
+    std::string base_;
+    std::vector<std::string> paths_;
+};
+
+TEST_F(SessionContainerTest, SessionsReadLikeTheirFiles) {
+    const std::string a = path("_a.qrsdp");
+    const std::string b = path("_b.qrsdp");
+    const std::string c = path("_c.qrsdp");
+    const std::string pack = path(".qrsc");
+    writeLog(a, 1, 100);
+    writeLog(b, 2, 37);
+    writeLog(c, 3, 0);
+    {
+        SessionContainerWriter writer(pack);
+        writer.addSession("MSFT", "2026-01-05", a);
+        writer.addSession("AAPL", "2026-01-05", b);
+        writer.addSession("AAPL", "2026-01-02", c);
+        EXPECT_THROW(writer.addSession("AAPL", "2026-01-02", a), std::runtime_error);
+        EXPECT_THROW(writer.addSession("A_SYMBOL_TOO_LONG", "2026-01-02", a), std::runtime_error);
+        writer.close();
+    }
+    ASSERT_TRUE(isSessionContainer(pack));
+    EXPECT_FALSE(isSessionContainer(a));
+
+    SessionContainer container(pack);
+    ASSERT_EQ(container.size(), 3u);
+    EXPECT_EQ(container.sessions()[0].symbol, "AAPL");
+    EXPECT_EQ(container.sessions()[0].date, "2026-01-02");
+    EXPECT_EQ(container.sessions()[1].date, "2026-01-05");
+    EXPECT_EQ(container.sessions()[2].symbol, "MSFT");
+    EXPECT_EQ(container.find("MSFT", "2026-01-02"), nullptr);
+    EXPECT_THROW(container.open("MSFT", "2026-01-02"), std::out_of_range);
+
+    for (const auto& [symbol, date, file] : {std::make_tuple("MSFT", "2026-01-05", a),
+                                             std::make_tuple("AAPL", "2026-01-05", b),
+                                             std::make_tuple("AAPL", "2026-01-02", c)}) {
+        const ContainerSession* s = container.find(symbol, date);
+        ASSERT_NE(s, nullptr) << symbol << " " << date;
+        EXPECT_EQ(s->offset % 8, 0u);
+        const EventLogReader expected(file);
+        const auto reader = container.open(symbol, date);
+        EXPECT_EQ(s->record_count, expected.totalRecords());
+        EXPECT_EQ(reader->header().seed, expected.header().seed);
+        ASSERT_EQ(reader->chunkCount(), expected.chunkCount());
+        const auto got = reader->readAll();
+        const auto want = expected.readAll();
+        ASSERT_EQ(got.size(), want.size());
+        EXPECT_EQ(std::memcmp(got.data(), want.data(), got.size() * sizeof(DiskEventRecord)), 0);
+        if (s->chunk_count > 0) {
+            IndexEntry first{};
+            std::FILE* f = std::fopen(pack.c_str(), "rb");
+            ASSERT_NE(f, nullptr);
+            std::fseek(f, static_cast<long>(s->index_offset), SEEK_SET);
+            ASSERT_EQ(std::fread(&first, sizeof(first), 1, f), 1u);
+            std::fclose(f);
+            EXPECT_EQ(first.file_offset, expected.index()[0].file_offset) << "index_offset";
+        }
+    }
+}
+
+TEST_F(SessionContainerTest, RejectsUnfinishedInputsAndContainers) {
+    const std::string log = path(".qrsdp");
+    const std::string pack = path(".qrsc");
+    writeLog(log, 4, 50);
+    {
+        // Without HAS_INDEX the log reads as one a crashed writer left behind.
+        std::FILE* f = std::fopen(log.c_str(), "r+b");
+        ASSERT_NE(f, nullptr);
+        FileHeader hdr{};
+        ASSERT_EQ(std::fread(&hdr, sizeof(hdr), 1, f), 1u);
+        const uint32_t flags = hdr.header_flags & ~kHeaderFlagHasIndex;
+        std::fseek(f, static_cast<long>(offsetof(FileHeader, header_flags)), SEEK_SET);
+        std::fwrite(&flags, sizeof(flags), 1, f);
+        std::fclose(f);
+    }
+    SessionContainerWriter writer(pack);
+    EXPECT_THROW(writer.addSession("X", "2026-01-02", log), std::runtime_error);
+    writeLog(log, 4, 50);
+    writer.addSession("X", "2026-01-02", log);
+    EXPECT_EQ(writer.sessionCount(), 1u);
+    EXPECT_THROW(SessionContainer{pack}, std::runtime_error) << "no directory before close()";
+    writer.close();
+    EXPECT_EQ(SessionContainer(pack).size(), 1u);
+}
+
+}  // namespace test
+}  // namespace qrsdp
@@ -0,0 +1,145 @@
+#include <gtest/gtest.h>
+#include "io/session_stats_sink.h"
+#include "io/multiplex_sink.h"
+#include "io/in_memory_sink.h"
+#include "book/multi_level_book.h"
+#include "model/simple_imbalance_intensity.h"
+#include "producer/qrsdp_producer.h"
+#include "rng/mt19937_rng.h"
+#include "sampler/competing_intensity_sampler.h"
+#include "sampler/unit_size_attribute_sampler.h"
+#include "core/event_types.h"
+#include "core/records.h"
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+namespace qrsdp {
+namespace test {
+
+static constexpr uint64_t kOpenNs = 34200ULL * 1'000'000'000ULL;
+
+static EventRecord makeRecord(EventType type, int32_t price, double t_seconds) {
+    EventRecord r{};
+    r.ts_ns = kOpenNs + static_cast<uint64_t>(t_seconds * 1e9);
+    r.type = static_cast<uint8_t>(type);
+    r.side = static_cast<uint8_t>(type == EventType::EXECUTE_BUY ? Side::ASK : Side::BID);
+    r.price_ticks = price;
+    r.qty = 1;
+    return r;
+}
+
+TEST(ReturnMoments, PopulationMoments) {
+    ReturnMoments m;
+    for (double r : {1.0, -1.0, 2.0, -2.0, 0.0}) m.add(r);
+    EXPECT_EQ(m.n, 5u);
+    EXPECT_DOUBLE_EQ(m.mean(), 0.0);
+    EXPECT_DOUBLE_EQ(m.stdev(), std::sqrt(2.0));
+    EXPECT_DOUBLE_EQ(m.skewness(), 0.0);
+    EXPECT_NEAR(m.excessKurtosis(), 6.8 / 4.0 - 3.0, 1e-12);
+
+    ReturnMoments a, b;
+    a.add(1.0);
+    a.add(-1.0);
+    b.add(2.0);
+    b.add(-2.0);
+    b.add(0.0);
+    a.merge(b);
+    EXPECT_DOUBLE_EQ(a.stdev(), m.stdev());
+    EXPECT_DOUBLE_EQ(a.excessKurtosis(), m.excessKurtosis());
+}
+
+TEST(SessionStatsSink, BarsSkipEmptyIntervals) {
+    // p0 100, spread 2: bid 99, ask 101, one unit per level, so each execution shifts.
+    const BookSeed seed{100, 3, 1, 2};
+    SessionStatsSink sink(seed, kOpenNs, 10.0);
+    sink.append(makeRecord(EventType::EXECUTE_BUY, 101, 1.0));   // bar 0: ask 102, mid 100.5
+    sink.append(makeRecord(EventType::EXECUTE_BUY, 102, 12.0));  // bar 1: ask 103, mid 101
+    sink.append(makeRecord(EventType::EXECUTE_SELL, 99, 35.0));  // bar 3: bid 98, mid 100.5
+
+    const SessionStats s = sink.stats();
+    EXPECT_EQ(s.events, 3u);
+    EXPECT_EQ(s.shifts, 3u);
+    EXPECT_EQ(s.type_counts[static_cast<int>(EventType::EXECUTE_BUY)], 2u);
+    EXPECT_DOUBLE_EQ(s.open_mid, 100.0);
+    EXPECT_DOUBLE_EQ(s.high_mid, 101.0);
+    EXPECT_DOUBLE_EQ(s.low_mid, 100.0);
+    EXPECT_DOUBLE_EQ(s.close_mid, 100.5);
+    // Bar closes 100.5, 101, 100.5 (bar 2 is empty): returns +0.5, -0.5.
+    EXPECT_EQ(s.bar_returns.n, 2u);
+    EXPECT_DOUBLE_EQ(s.bar_returns.mean(), 0.0);
+    EXPECT_DOUBLE_EQ(s.bar_returns.stdev(), 0.5);
+    // Spreads after each event: 3, 4, 5 ticks.
+    EXPECT_EQ(s.spread_counts[3], 1u);
+    EXPECT_EQ(s.spread_counts[5], 1u);
+    EXPECT_DOUBLE_EQ(s.meanSpread(), 4.0);
+
+    sink.reset(seed, kOpenNs);
+    EXPECT_EQ(sink.stats().events, 0u);
+    EXPECT_EQ(sink.stats().bar_returns.n, 0u);
+}
+
+TEST(SessionStatsSink, FollowsTheProducersBook) {
+    TradingSession session{};
+    session.seed = 2024;
+    session.p0_ticks = 10000;
+    session.session_seconds = 60;
+    session.levels_per_side = 5;
+    session.tick_size = 100;
+    session.initial_spread_ticks = 2;
+    session.initial_depth = 5;
+    session.market_open_seconds = 34200;
+    session.intensity_params = {20.0, 0.5, 15.0, 1.0, 1.0, 0.5, 0.4};
+
+    Mt19937Rng rng(session.seed);
+    MultiLevelBook book;
+    SimpleImbalanceIntensity model(session.intensity_params);
+    CompetingIntensitySampler sampler(rng);
+    UnitSizeAttributeSampler attrs(rng, 0.5, 0.5);
+    QrsdpProducer producer(rng, book, model, sampler, attrs);
+
+    SessionStatsSink stats_sink(BookSeed{session.p0_ticks, 5, 5, 2}, kOpenNs);
+    InMemorySink records;
+    MultiplexSink both;
+    both.addSink(&stats_sink);
+    both.addSink(&records);
+    producer.runSession(session, both);
+
+    const SessionStats s = stats_sink.stats();
+    ASSERT_GT(s.events, 1000u);
+    EXPECT_EQ(s.events, records.size());
+    EXPECT_EQ(s.shifts, producer.shiftCountThisSession());
+    EXPECT_DOUBLE_EQ(s.close_mid, (book.bestBid().price_ticks + book.bestAsk().price_ticks) / 2.0);
+    uint64_t counts[kNumEventTypes] = {};
+    for (const EventRecord& r : records.events()) ++counts[r.type];
+    for (int t = 0; t < kNumEventTypes; ++t) EXPECT_EQ(s.type_counts[t], counts[t]) << "type " << t;
+    uint64_t spread_total = 0;
+    for (uint64_t c : s.spread_counts) spread_total += c;
+    EXPECT_EQ(spread_total, s.events);
+    EXPECT_EQ(s.spread_counts[0], 0u);
+    EXPECT_GT(s.bar_returns.n, 0u);
+    EXPECT_LE(s.low_mid, s.close_mid);
+    EXPECT_GE(s.high_mid, s.close_mid);
+}
+
+TEST(SessionStats, MergePoolsDays) {
+    const BookSeed seed{100, 3, 1, 2};
+    SessionStatsSink a(seed, kOpenNs);
+    a.append(makeRecord(EventType::EXECUTE_BUY, 101, 1.0));
+    SessionStatsSink b(seed, kOpenNs);
+    b.append(makeRecord(EventType::EXECUTE_SELL, 99, 1.0));
+
+    SessionStats pooled;
+    pooled.merge(a.stats());
+    pooled.merge(b.stats());
+    EXPECT_EQ(pooled.events, 2u);
+    EXPECT_DOUBLE_EQ(pooled.open_mid, 100.0);
+    EXPECT_DOUBLE_EQ(pooled.close_mid, 99.5);
+    EXPECT_DOUBLE_EQ(pooled.high_mid, 100.5);
+    EXPECT_DOUBLE_EQ(pooled.low_mid, 99.5);
+    EXPECT_DOUBLE_EQ(pooled.spreadShare(3), 1.0);
+}
+
+}  // namespace test
+}  // namespace qrsdp
@@ -0,0 +1,113 @@
+#include <gtest/gtest.h>
+#include "io/shm_ring_sink.h"
+#include "core/records.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace qrsdp {
+namespace test {
+
+class ShmRingSinkTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        path_ = testing::TempDir() + "test_bus_" +
+                std::to_string(reinterpret_cast<uintptr_t>(this)) + ".ring";
+    }
+
+    void TearDown() override {
+        std::remove(path_.c_str());
+    }
+
+    static EventRecord record(uint64_t i) {
+        EventRecord r{};
+        r.ts_ns = 34'200'000'000'000ULL + i * 1000;
+        r.type = static_cast<uint8_t>(i % 6);
+        r.side = static_cast<uint8_t>(i % 2);
+        r.price_ticks = 10000 + static_cast<int32_t>(i % 7);
+        r.qty = 1 + static_cast<uint32_t>(i % 3);
+        r.order_id = i + 1;
+        return r;
+    }
+
+    ShmRingConfig config(size_t ring_bytes, uint32_t batch_records) const {
+        ShmRingConfig c;
+        c.path = path_;
+        c.ring_bytes = ring_bytes;
+        c.batch_records = batch_records;
+        return c;
+    }
+
+    std::string path_;
+};
+
+TEST_F(ShmRingSinkTest, BatchesCarrySequenceNumbersAndTheirSecurity) {
+    ShmEventBus bus(config(1 << 16, 4));
+    ShmRingSink aaa(bus, 0, "AAA", "2026-01-02");
+    ShmRingSink bbb(bus, 1, "BBB", "2026-01-02");
+    for (uint64_t i = 0; i < 10; ++i) aaa.append(record(i));  // two full batches
+    std::vector<EventRecord> three = {record(100), record(101), record(102)};
+    bbb.appendBatch(three.data(), three.size());               // published at once
+    aaa.close();                                               // the last two
+    EXPECT_EQ(bus.published(), 13u);
+
+    ShmRingReader reader(path_, true);
+    const EventBatchHeader* h = nullptr;
+    const DiskEventRecord* recs = nullptr;
+    const struct { uint64_t first; uint32_t count; uint16_t security; uint64_t record0; } want[] = {
+        {0, 4, 0, 0}, {4, 4, 0, 4}, {8, 3, 1, 100}, {11, 2, 0, 8},
+    };
+    for (const auto& w : want) {
+        ASSERT_EQ(reader.poll(h, recs), ShmRingReader::Poll::Message);
+        EXPECT_EQ(h->first_seq, w.first);
+        ASSERT_EQ(h->count, w.count);
+        EXPECT_EQ(h->security, w.security);
+        EXPECT_STREQ(h->symbol, w.security == 0 ? "AAA" : "BBB");
+        EXPECT_STREQ(h->date, "2026-01-02");
+        for (uint32_t k = 0; k < h->count; ++k) {
+            const EventRecord r = record(w.record0 + k);
+            EXPECT_EQ(recs[k].ts_ns, r.ts_ns);
+            EXPECT_EQ(recs[k].type, r.type);
+            EXPECT_EQ(recs[k].price_ticks, r.price_ticks);
+            EXPECT_EQ(recs[k].qty, r.qty);
+            EXPECT_EQ(recs[k].order_id, r.order_id);
+        }
+    }
+    EXPECT_EQ(reader.poll(h, recs), ShmRingReader::Poll::Empty);
+    EXPECT_EQ(reader.cursor(), 13u);
+    bus.close();
+    EXPECT_EQ(reader.poll(h, recs), ShmRingReader::Poll::Closed);
+    EXPECT_EQ(reader.lost(), 0u);
+}
+
+TEST_F(ShmRingSinkTest, OvertakenReaderCountsTheRecordsItLost) {
+    ShmEventBus bus(config(4096, 16));
+    ShmRingSink sink(bus, 0, "", "2026-01-02");
+    ShmRingReader reader(path_);
+    const EventBatchHeader* h = nullptr;
+    const DiskEventRecord* recs = nullptr;
+
+    std::vector<EventRecord> batch(16);
+    for (uint64_t i = 0; i < batch.size(); ++i) batch[i] = record(i);
+    sink.appendBatch(batch.data(), batch.size());
+    ASSERT_EQ(reader.poll(h, recs), ShmRingReader::Poll::Message);
+    EXPECT_EQ(reader.cursor(), 16u);
+
+    for (int n = 0; n < 50; ++n) sink.appendBatch(batch.data(), batch.size());  // laps the 4 KiB ring
+    EXPECT_EQ(reader.poll(h, recs), ShmRingReader::Poll::Empty) << "resynced at the newest";
+    sink.appendBatch(batch.data(), batch.size());
+    ASSERT_EQ(reader.poll(h, recs), ShmRingReader::Poll::Message);
+    EXPECT_EQ(h->first_seq, 51u * 16);
+    EXPECT_EQ(reader.lost(), 50u * 16);
+}
+
+TEST_F(ShmRingSinkTest, BatchesMustFitTheRing) {
+    EXPECT_THROW(ShmEventBus(config(4096, 64)), std::invalid_argument);
+    EXPECT_THROW(ShmEventBus(config(4096, 0)), std::invalid_argument);
+}
+
+}  // namespace test
+}  // namespace qrsdp
@@ -0,0 +1,461 @@
+#include <gtest/gtest.h>
+#include "io/binary_file_sink.h"
+#include "io/http_post.h"
+#include "io/log_export.h"
+#include "io/run_catalog.h"
+#include "io/table_export.h"
+#include "core/records.h"
+
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifndef _WIN32
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace qrsdp {
+namespace test {
+
+static std::vector<DiskEventRecord> makeRecords(size_t n) {
+    std::vector<DiskEventRecord> recs(n);
+    for (size_t i = 0; i < n; ++i) {
+        recs[i].ts_ns = 1000 * (i + 1);
+        recs[i].type = static_cast<uint8_t>(i % 6);
+        recs[i].side = static_cast<uint8_t>(i % 2);
+        recs[i].price_ticks = 10000 - static_cast<int32_t>(i);
+        recs[i].qty = static_cast<uint32_t>(i + 1);
+        recs[i].order_id = 500 + i;
+    }
+    return recs;
+}
+
+template <class T>
+static T load(const std::vector<char>& b, size_t pos) {
+    T v;
+    std::memcpy(&v, &b[pos], sizeof(T));
+    return v;
+}
+
+static uint64_t loadVarUInt(const std::vector<char>& b, size_t& pos) {
+    uint64_t v = 0;
+    for (int shift = 0;; shift += 7) {
+        const uint8_t byte = static_cast<uint8_t>(b[pos++]);
+        v |= static_cast<uint64_t>(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) return v;
+    }
+}
+
+static std::string loadString(const std::vector<char>& b, size_t& pos) {
+    const size_t n = static_cast<size_t>(loadVarUInt(b, pos));
+    std::string s(&b[pos], n);
+    pos += n;
+    return s;
+}
+
+TEST(TableExport, DaysSinceEpoch) {
+    EXPECT_EQ(daysSinceEpoch("1970-01-01"), 0);
+    EXPECT_EQ(daysSinceEpoch("2000-03-01"), 11017);
+    EXPECT_EQ(daysSinceEpoch("2026-01-05"), 20458);
+    EXPECT_THROW(daysSinceEpoch("2026-02-29"), std::invalid_argument);
+    EXPECT_THROW(daysSinceEpoch("2026-1-5"), std::invalid_argument);
+    EXPECT_EQ(parseExportFormat("native"), ExportFormat::Native);
+    EXPECT_THROW(parseExportFormat("parquet"), std::invalid_argument);
+}
+
+TEST(TableExport, RowBinaryRows) {
+    const auto recs = makeRecords(3);
+    std::vector<char> out;
+    makeExportEncoder(ExportFormat::RowBinary)->batch(recs.data(), recs.size(), "AAPL", 20458, out);
+    size_t pos = 0;
+    for (const DiskEventRecord& r : recs) {
+        EXPECT_EQ(load<uint64_t>(out, pos), r.ts_ns);
+        EXPECT_EQ(static_cast<uint8_t>(out[pos + 8]), r.type);
+        pos += 9;
+        const std::string name = loadString(out, pos);
+        EXPECT_FALSE(name.empty());
+        EXPECT_EQ(static_cast<uint8_t>(out[pos]), r.side);
+        EXPECT_EQ(load<int32_t>(out, pos + 1), r.price_ticks);
+        EXPECT_EQ(load<uint32_t>(out, pos + 5), r.qty);
+        EXPECT_EQ(load<uint64_t>(out, pos + 9), r.order_id);
+        pos += 17;
+        EXPECT_EQ(loadString(out, pos), "AAPL");
+        EXPECT_EQ(load<uint16_t>(out, pos), 20458);
+        pos += 2;
+    }
+    EXPECT_EQ(pos, out.size());
+}
+
+TEST(TableExport, NativeBlock) {
+    const auto recs = makeRecords(4);
+    std::vector<char> out;
+    makeExportEncoder(ExportFormat::Native)->batch(recs.data(), recs.size(), "MSFT", 7, out);
+    size_t pos = 0;
+    EXPECT_EQ(loadVarUInt(out, pos), 9u);
+    EXPECT_EQ(loadVarUInt(out, pos), 4u);
+    std::vector<std::string> names;
+    while (pos < out.size()) {
+        names.push_back(loadString(out, pos));
+        const std::string type = loadString(out, pos);
+        for (size_t i = 0; i < recs.size(); ++i) {
+            if (type == "UInt64") {
+                const uint64_t v = load<uint64_t>(out, pos);
+                EXPECT_EQ(v, names.back() == "ts_ns" ? recs[i].ts_ns : recs[i].order_id);
+                pos += 8;
+            } else if (type == "UInt8") {
+                pos += 1;
+            } else if (type == "Int32") {
+                EXPECT_EQ(load<int32_t>(out, pos), recs[i].price_ticks);
+                pos += 4;
+            } else if (type == "UInt32") {
+                EXPECT_EQ(load<uint32_t>(out, pos), recs[i].qty);
+                pos += 4;
+            } else if (type == "Date") {
+                EXPECT_EQ(load<uint16_t>(out, pos), 7);
+                pos += 2;
+            } else {
+                ASSERT_EQ(type, "String");
+                const std::string s = loadString(out, pos);
+                if (names.back() == "symbol") {
+                    EXPECT_EQ(s, "MSFT");
+                }
+            }
+        }
+    }
+    EXPECT_EQ(pos, out.size());
+    const std::vector<std::string> expected = {"ts_ns", "type", "type_name", "side", "price_ticks",
+                                               "qty", "order_id", "symbol", "date"};
+    EXPECT_EQ(names, expected);
+}
+
+/// Just enough of a FlatBuffers reader to walk Arrow metadata.
+struct FbReader {
+    const std::vector<char>& b;
+    size_t base;  // start of the buffer
+
+    size_t root() const { return base + load<uint32_t>(b, base); }
+    /// Position of field id of the table at t, or 0 if absent.
+    size_t field(size_t t, uint16_t id) const {
+        const size_t vt = static_cast<size_t>(static_cast<int64_t>(t) - load<int32_t>(b, t));
+        if (4u + 2u * id >= load<uint16_t>(b, vt)) return 0;
+        const uint16_t off = load<uint16_t>(b, vt + 4 + 2 * id);
+        return off ? t + off : 0;
+    }
+    size_t deref(size_t slot) const { return slot + load<uint32_t>(b, slot); }
+    std::string string(size_t t, uint16_t id) const {
+        const size_t s = deref(field(t, id));
+        return std::string(&b[s + 4], load<uint32_t>(b, s));
+    }
+};
+
+TEST(TableExport, ArrowFileReadsBack) {
+    const auto recs = makeRecords(5);
+    std::vector<char> out;
+    auto enc = makeExportEncoder(ExportFormat::Arrow);
+    enc->begin(out);
+    enc->batch(recs.data(), 3, "IBM", 20458, out);
+    enc->batch(recs.data() + 3, 2, "IBM", 20458, out);
+    enc->end(out);
+
+    ASSERT_GT(out.size(), 20u);
+    EXPECT_EQ(std::string(out.data(), 6), "ARROW1");
+    EXPECT_EQ(std::string(out.data() + out.size() - 6, 6), "ARROW1");
+    const size_t footer_size = static_cast<size_t>(load<int32_t>(out, out.size() - 10));
+    const size_t footer = out.size() - 10 - footer_size;
+    EXPECT_EQ(footer % 8, 0u);
+    FbReader fb{out, footer};
+    const size_t root = fb.root();
+    EXPECT_EQ(load<int16_t>(out, fb.field(root, 0)), 4);  // MetadataVersion V5
+
+    const size_t schema = fb.deref(fb.field(root, 1));
+    const size_t fields = fb.deref(fb.field(schema, 1));
+    ASSERT_EQ(load<uint32_t>(out, fields), 8u);
+    const char* const kNames[] = {"ts_ns", "type", "side", "price_ticks", "qty", "order_id", "symbol", "date"};
+    for (size_t i = 0; i < 8; ++i) {
+        const size_t field = fb.deref(fields + 4 + 4 * i);
+        EXPECT_EQ(fb.string(field, 0), kNames[i]);
+        // type and side: Utf8 values behind int8 indices (dictionary ids 0 and 1).
+        const bool dictionary = i == 1 || i == 2;
+        EXPECT_EQ(fb.field(field, 4) != 0, dictionary) << kNames[i];
+        if (dictionary) {
+            EXPECT_EQ(static_cast<uint8_t>(out[fb.field(field, 2)]), 5);
+            EXPECT_EQ(load<int64_t>(out, fb.field(fb.deref(fb.field(field, 4)), 0)), static_cast<int64_t>(i - 1));
+        }
+    }
+
+    const size_t dictionaries = fb.deref(fb.field(root, 2));
+    ASSERT_EQ(load<uint32_t>(out, dictionaries), 2u);
+    for (size_t k = 0; k < 2; ++k) {
+        const size_t offset = static_cast<size_t>(load<int64_t>(out, dictionaries + 4 + 24 * k));
+        const size_t meta_length = static_cast<size_t>(load<int32_t>(out, dictionaries + 4 + 24 * k + 8));
+        FbReader msg{out, offset + 8};
+        const size_t m = msg.root();
+        EXPECT_EQ(static_cast<uint8_t>(out[msg.field(m, 1)]), 2);  // DictionaryBatch
+        const size_t batch = msg.deref(msg.field(m, 2));
+        EXPECT_EQ(load<int64_t>(out, msg.field(batch, 0)), static_cast<int64_t>(k));
+        const size_t data = msg.deref(msg.field(batch, 1));
+        const size_t buffers = msg.deref(msg.field(data, 2));
+        const size_t body = offset + meta_length;
+        const size_t offsets = body + static_cast<size_t>(load<int64_t>(out, buffers + 4 + 16));
+        const size_t chars = body + static_cast<size_t>(load<int64_t>(out, buffers + 4 + 32));
+        const size_t n = static_cast<size_t>(load<int64_t>(out, msg.field(data, 0)));
+        EXPECT_EQ(n, k == 0 ? 6u : 3u);
+        const auto first = static_cast<size_t>(load<int32_t>(out, offsets + 4));
+        EXPECT_EQ(std::string(&out[chars], first), k == 0 ? "ADD_BID" : "BID");
+        const auto last = static_cast<size_t>(load<int32_t>(out, offsets + 4 * n));
+        const auto before = static_cast<size_t>(load<int32_t>(out, offsets + 4 * (n - 1)));
+        EXPECT_EQ(std::string(&out[chars + before], last - before), k == 0 ? "EXECUTE_SELL" : "NA");
+    }
+
+    const size_t blocks = fb.deref(fb.field(root, 3));
+    ASSERT_EQ(load<uint32_t>(out, blocks), 2u);
+    size_t row = 0;
+    for (size_t k = 0; k < 2; ++k) {
+        const size_t block = blocks + 4 + 24 * k;
+        const size_t offset = static_cast<size_t>(load<int64_t>(out, block));
+        const size_t meta_length = static_cast<size_t>(load<int32_t>(out, block + 8));
+        EXPECT_EQ(offset % 8, 0u);
+        EXPECT_EQ(load<uint32_t>(out, offset), 0xFFFFFFFFu);
+        EXPECT_EQ(static_cast<size_t>(load<int32_t>(out, offset + 4)) + 8, meta_length);
+
+        FbReader msg{out, offset + 8};
+        const size_t m = msg.root();
+        EXPECT_EQ(load<int16_t>(out, msg.field(m, 0)), 4);
+        EXPECT_EQ(static_cast<uint8_t>(out[msg.field(m, 1)]), 3);  // RecordBatch
+        const size_t rb = msg.deref(msg.field(m, 2));
+        const size_t n = static_cast<size_t>(load<int64_t>(out, msg.field(rb, 0)));
+        EXPECT_EQ(n, k == 0 ? 3u : 2u);
+        const size_t buffers = msg.deref(msg.field(rb, 2));
+        ASSERT_EQ(load<uint32_t>(out, buffers), 17u);
+        const size_t body = offset + meta_length;
+        auto buffer = [&](size_t i) { return body + static_cast<size_t>(load<int64_t>(out, buffers + 4 + 16 * i)); };
+        for (size_t i = 0; i < n; ++i) {
+            const DiskEventRecord& r = recs[row + i];
+            EXPECT_EQ(load<uint64_t>(out, buffer(1) + 8 * i), r.ts_ns);
+            EXPECT_EQ(static_cast<uint8_t>(out[buffer(3) + i]), r.type);
+            EXPECT_EQ(static_cast<uint8_t>(out[buffer(5) + i]), r.side);
+            EXPECT_EQ(load<int32_t>(out, buffer(7) + 4 * i), r.price_ticks);
+            EXPECT_EQ(load<uint64_t>(out, buffer(11) + 8 * i), r.order_id);
+            EXPECT_EQ(load<int32_t>(out, buffer(13) + 4 * (i + 1)), static_cast<int32_t>(3 * (i + 1)));
+            EXPECT_EQ(load<int32_t>(out, buffer(16) + 4 * i), 20458);
+        }
+        EXPECT_EQ(std::string(&out[buffer(14)], 3 * n).substr(0, 3), "IBM");
+        row += n;
+    }
+}
+
+class LogExportTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        dir_ = fs::path(testing::TempDir()) /
+               ("qrsdp_export_" + std::to_string(reinterpret_cast<uintptr_t>(this)));
+        fs::remove_all(dir_);
+        fs::create_directories(dir_);
+    }
+    void TearDown() override { fs::remove_all(dir_); }
+
+    void writeLog(const fs::path& path, size_t n) {
+        fs::create_directories(path.parent_path());
+        TradingSession s{};
+        s.p0_ticks = 10000;
+        s.session_seconds = 60;
+        s.levels_per_side = 4;
+        s.tick_size = 1;
+        s.initial_spread_ticks = 2;
+        s.initial_depth = 5;
+        BinaryFileSinkOptions options;
+        options.chunk_capacity = 16;
+        BinaryFileSink sink(path.string(), s, options);
+        for (const DiskEventRecord& d : makeRecords(n)) {
+            EventRecord r{};
+            r.ts_ns = d.ts_ns;
+            r.type = d.type;
+            r.side = d.side;
+            r.price_ticks = d.price_ticks;
+            r.qty = d.qty;
+            r.order_id = d.order_id;
+            sink.append(r);
+        }
+        sink.close();
+    }
+
+    fs::path dir_;
+};
+
+TEST_F(LogExportTest, CollectsRunLayouts) {
+    writeLog(dir_ / "multi" / "MSFT" / "2026-01-05.qrsdp", 10);
+    writeLog(dir_ / "multi" / "AAPL" / "2026-01-06.qrsdp", 10);
+    writeLog(dir_ / "multi" / "AAPL" / "2026-01-05.qrsdp", 10);
+    writeLog(dir_ / "single" / "2026-01-05.qrsdp", 10);
+    writeLog(dir_ / "bad" / "notes.qrsdp", 1);
+
+    const auto multi = collectExportSessions({(dir_ / "multi").string()});
+    ASSERT_EQ(multi.size(), 3u);
+    EXPECT_EQ(multi[0].symbol, "AAPL");
+    EXPECT_EQ(multi[0].date, "2026-01-05");
+    EXPECT_EQ(multi[1].date, "2026-01-06");
+    EXPECT_EQ(multi[2].symbol, "MSFT");
+
+    const auto single = collectExportSessions({"IBM=" + (dir_ / "single").string()}, "2026-01-05");
+    ASSERT_EQ(single.size(), 1u);
+    EXPECT_EQ(single[0].symbol, "IBM");
+    EXPECT_TRUE(collectExportSessions({(dir_ / "multi").string()}, "2026-01-07").empty());
+    EXPECT_THROW(collectExportSessions({(dir_ / "bad").string()}), std::runtime_error);
+    EXPECT_THROW(collectExportSessions({(dir_ / "missing").string()}), std::runtime_error);
+}
+
+TEST_F(LogExportTest, ListsACataloguedRunFromItsCatalogue) {
+    writeLog(dir_ / "run" / "MSFT" / "2026-01-05.qrsdp", 10);
+    writeLog(dir_ / "run" / "MSFT" / "2026-01-06.qrsdp", 10);
+    writeLog(dir_ / "run" / "MSFT" / "2026-01-07.qrsdp", 10);  // not finished yet: unlisted
+    {
+        RunCatalogWriter catalog((dir_ / "run" / kRunCatalogName).string(), false);
+        for (const char* date : {"2026-01-06", "2026-01-05"}) {
+            const std::string file = std::string("MSFT/") + date + ".qrsdp";
+            catalog.add(catalogDay(EventLogReader((dir_ / "run" / file).string()), "MSFT", date, file));
+        }
+    }
+    const auto sessions = collectExportSessions({(dir_ / "run").string()});
+    ASSERT_EQ(sessions.size(), 2u);
+    EXPECT_EQ(sessions[0].date, "2026-01-05");
+    EXPECT_EQ(sessions[1].symbol, "MSFT");
+    EXPECT_EQ(fs::path(sessions[1].path), dir_ / "run" / "MSFT" / "2026-01-06.qrsdp");
+    const auto one = collectExportSessions({"X=" + (dir_ / "run").string()}, "2026-01-06");
+    ASSERT_EQ(one.size(), 1u);
+    EXPECT_EQ(one[0].symbol, "X");
+}
+
+TEST_F(LogExportTest, WritesFilesInBatches) {
+    writeLog(dir_ / "run" / "MSFT" / "2026-01-05.qrsdp", 100);
+    writeLog(dir_ / "run" / "AAPL" / "2026-01-05.qrsdp", 37);
+    const auto sessions = collectExportSessions({(dir_ / "run").string()});
+
+    ExportOptions options;
+    options.format = ExportFormat::RowBinary;
+    options.out_dir = (dir_ / "out").string();
+    options.threads = 2;
+    options.batch_rows = 10;  // batches span chunks of 16
+    options.flush_bytes = 64;
+    const ExportStats stats = exportSessions(sessions, options);
+    EXPECT_EQ(stats.sessions, 2u);
+    EXPECT_EQ(stats.records, 137u);
+
+    const fs::path file = dir_ / "out" / "MSFT" / "2026-01-05.rowbinary";
+    ASSERT_TRUE(fs::exists(file));
+    std::ifstream in(file, std::ios::binary);
+    const std::vector<char> bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    const auto recs = makeRecords(100);
+    std::vector<char> expected;
+    makeExportEncoder(ExportFormat::RowBinary)->batch(recs.data(), recs.size(), "MSFT",
+                                                      daysSinceEpoch("2026-01-05"), expected);
+    EXPECT_EQ(bytes, expected);
+    EXPECT_EQ(stats.bytes, fs::file_size(file) + fs::file_size(dir_ / "out" / "AAPL" / "2026-01-05.rowbinary"));
+
+    options.format = ExportFormat::Arrow;
+    options.clickhouse_url = "http://localhost:8123";
+    EXPECT_THROW(exportSessions(sessions, options), std::invalid_argument);
+}
+
+#ifndef _WIN32
+/// One-shot HTTP server: reads a chunked request and answers with status.
+class FakeHttpServer {
+public:
+    explicit FakeHttpServer(const std::string& status) : status_(status) {
+        listen_ = socket(AF_INET, SOCK_STREAM, 0);
+        struct sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        bind(listen_, reinterpret_cast<const struct sockaddr*>(&addr), sizeof(addr));
+        listen(listen_, 1);
+        socklen_t len = sizeof(addr);
+        getsockname(listen_, reinterpret_cast<struct sockaddr*>(&addr), &len);
+        port_ = ntohs(addr.sin_port);
+        thread_ = std::thread([this] { serve(); });
+    }
+    ~FakeHttpServer() {
+        thread_.join();
+        close(listen_);
+    }
+
+    uint16_t port() const { return port_; }
+    /// Valid once the client has finished.
+    const std::string& head() const { return head_; }
+    const std::string& body() const { return body_; }
+
+private:
+    void serve() {
+        const int conn = accept(listen_, nullptr, nullptr);
+        std::string in;
+        char buf[4096];
+        ssize_t n;
+        while (in.find("\r\n0\r\n\r\n") == std::string::npos && (n = recv(conn, buf, sizeof(buf), 0)) > 0)
+            in.append(buf, static_cast<size_t>(n));
+        const size_t head_end = in.find("\r\n\r\n");
+        head_ = in.substr(0, head_end);
+        for (size_t pos = head_end + 4; pos < in.size();) {
+            const size_t eol = in.find("\r\n", pos);
+            const size_t size = std::stoul(in.substr(pos, eol - pos), nullptr, 16);
+            if (size == 0) break;
+            body_ += in.substr(eol + 2, size);
+            pos = eol + 2 + size + 2;
+        }
+        const std::string reply = "HTTP/1.1 " + status_ + "\r\nContent-Length: 4\r\n\r\nnope";
+        send(conn, reply.data(), reply.size(), 0);
+        close(conn);
+    }
+
+    std::string status_;
+    int listen_ = -1;
+    uint16_t port_ = 0;
+    std::thread thread_;
+    std::string head_;
+    std::string body_;
+};
+
+TEST(HttpPost, SendsAChunkedBody) {
+    FakeHttpServer server("200 OK");
+    {
+        HttpPost post("http://127.0.0.1:" + std::to_string(server.port()) + "/?query=" + urlEncode("INSERT x"),
+                      {"X-ClickHouse-User: default"});
+        post.write("hello ", 6);
+        post.write("", 0);
+        post.write("world", 5);
+        EXPECT_EQ(post.finish(), "nope");
+        EXPECT_EQ(post.bytesSent(), 11u);
+    }
+    EXPECT_EQ(server.head().compare(0, 32, "POST /?query=INSERT%20x HTTP/1.1"), 0) << server.head();
+    EXPECT_NE(server.head().find("X-ClickHouse-User: default"), std::string::npos);
+    EXPECT_EQ(server.body(), "hello world");
+}
+
+TEST(HttpPost, ThrowsOnErrorStatus) {
+    FakeHttpServer server("500 Internal Server Error");
+    HttpPost post("http://127.0.0.1:" + std::to_string(server.port()));
+    post.write("x", 1);
+    try {
+        post.finish();
+        FAIL() << "expected an error";
+    } catch (const std::runtime_error& e) {
+        EXPECT_NE(std::string(e.what()).find("500"), std::string::npos) << e.what();
+        EXPECT_NE(std::string(e.what()).find("nope"), std::string::npos) << e.what();
+    }
+}
+#endif
+
+TEST(HttpPost, RejectsOtherSchemes) {
+    EXPECT_THROW(HttpPost("https://localhost:8443"), std::runtime_error);
+}
+
+}  // namespace test
+}  // namespace qrsdp
@@ -154,7 +154,7 @@ static std::vector<EventRecord> generateEvents(uint64_t seed,
     QrsdpProducer producer(rng, book, model, eventSampler, attrSampler);
     InMemorySink sink;
     producer.runSession(session, sink);
-    return sink.events();
+    return sink.events().toVector();
 }
 
 // ---------------------------------------------------------------------------
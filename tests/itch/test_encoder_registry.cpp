@@ -0,0 +1,70 @@
+#include <gtest/gtest.h>
+
+#include "itch/encoder_registry.h"
+#include "itch/itch_decoder.h"
+#include "support/alloc_counter.h"
+
+#include <string>
+#include <vector>
+
+namespace qrsdp {
+namespace itch {
+namespace test {
+
+using qrsdp::test::allocationCount;
+
+static uint16_t directoryLocate(EncoderRegistry& reg, const std::string& symbol) {
+    bool added = false;
+    const auto bytes = reg.intern(symbol.data(), symbol.size(), added).encodeStockDirectory(0);
+    DecodedItchMsg d;
+    EXPECT_TRUE(decodeItchMessage(bytes.data(), bytes.size(), d));
+    return d.stock_locate;
+}
+
+TEST(EncoderRegistry, InternsSymbolsIntoDenseLocates) {
+    EncoderRegistry reg(100);
+    bool added = false;
+    reg.intern("AAPL", 4, added);
+    EXPECT_TRUE(added);
+    reg.intern("MSFT", 4, added);
+    EXPECT_TRUE(added);
+    EXPECT_EQ(&reg.intern("AAPL", 4, added), &reg.byLocate(1));
+    EXPECT_FALSE(added);
+    EXPECT_EQ(reg.size(), 2u);
+    EXPECT_EQ(reg.symbol(2), "MSFT");
+    EXPECT_EQ(reg.find("GOOG", 4), nullptr);
+    EXPECT_EQ(reg.find("AAP", 3), nullptr) << "prefixes are different keys";
+    EXPECT_EQ(directoryLocate(reg, "AAPL"), 1u);
+    EXPECT_EQ(directoryLocate(reg, "MSFT"), 2u);
+}
+
+TEST(EncoderRegistry, GrowsAndKeepsEverySymbol) {
+    EncoderRegistry reg(100);
+    std::vector<std::string> symbols;
+    for (int i = 0; i < 3000; ++i) symbols.push_back("SYM" + std::to_string(i));
+    bool added = false;
+    for (const auto& s : symbols) reg.intern(s.data(), s.size(), added);
+    ASSERT_EQ(reg.size(), symbols.size());
+    for (size_t i = 0; i < symbols.size(); ++i) {
+        ASSERT_EQ(reg.find(symbols[i].data(), symbols[i].size()), &reg.byLocate(static_cast<uint16_t>(i + 1)))
+            << symbols[i];
+    }
+}
+
+TEST(EncoderRegistry, KnownSymbolLookupDoesNotAllocate) {
+    EncoderRegistry reg(100);
+    bool added = false;
+    for (const char* s : {"AAPL", "MSFT", "A_SYMBOL_LONGER_THAN_EIGHT"})
+        reg.intern(s, std::char_traits<char>::length(s), added);
+    const size_t before = allocationCount();
+    for (int i = 0; i < 1000; ++i) {
+        reg.intern("MSFT", 4, added);
+        reg.intern("A_SYMBOL_LONGER_THAN_EIGHT", 26, added);
+    }
+    EXPECT_EQ(allocationCount(), before);
+    EXPECT_EQ(reg.size(), 3u);
+}
+
+}  // namespace test
+}  // namespace itch
+}  // namespace qrsdp
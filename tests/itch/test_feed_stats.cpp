@@ -0,0 +1,128 @@
+#include <gtest/gtest.h>
+
+#include "itch/feed_stats.h"
+#include "itch/itch_decoder.h"
+#include "itch/itch_encoder.h"
+#include "itch/itch_messages.h"
+#include "itch/moldudp64.h"
+#include "core/event_types.h"
+#include "core/records.h"
+#include "support/alloc_counter.h"
+
+#include <string>
+#include <vector>
+
+namespace qrsdp {
+namespace itch {
+namespace test {
+
+static EventRecord makeEvent(EventType type, uint64_t ts, uint64_t order_id) {
+    EventRecord r{};
+    r.ts_ns = ts;
+    r.type = static_cast<uint8_t>(type);
+    r.side = static_cast<uint8_t>(Side::BID);
+    r.price_ticks = 1000;
+    r.qty = 1;
+    r.order_id = order_id;
+    return r;
+}
+
+/// Packets of eight messages each: adds with every fourth one executed.
+static std::vector<std::vector<uint8_t>> makePackets(size_t events) {
+    MoldUDP64Framer framer("STATS     ");
+    std::vector<std::vector<uint8_t>> packets;
+    framer.setSendCallback([&](const uint8_t* data, size_t len) { packets.emplace_back(data, data + len); });
+    const ItchEncoder enc("AAA", 1, 100);
+    for (size_t i = 0; i < events; ++i) {
+        const EventType type = i % 4 == 3 ? EventType::EXECUTE_BUY : EventType::ADD_BID;
+        const auto bytes = enc.encode(makeEvent(type, 1000 + i, i + 1));
+        framer.addMessage(bytes.data(), static_cast<uint16_t>(bytes.size()));
+        if (i % 8 == 7)
+            framer.sendPending();
+    }
+    framer.sendPending();
+    return packets;
+}
+
+TEST(ItchDecoderVisitor, DispatchesOnTheWireStruct) {
+    const ItchEncoder enc("AAA", 7, 100);
+    const auto add = enc.encode(makeEvent(EventType::ADD_BID, 5000, 42));
+    uint64_t ref = 0;
+    int calls = 0;
+    auto visitor = [&](const auto& m) {
+        ++calls;
+        using Msg = std::decay_t<decltype(m)>;
+        if constexpr (std::is_same_v<Msg, AddOrderMsg>)
+            ref = betoh64(m.order_reference);
+    };
+    EXPECT_TRUE(visitItchMessage(add.data(), add.size(), visitor));
+    EXPECT_EQ(ref, 42u);
+    EXPECT_FALSE(visitItchMessage(add.data(), add.size() - 1, visitor)) << "short";
+    const uint8_t unknown[4] = {'Z', 0, 0, 0};
+    EXPECT_FALSE(visitItchMessage(unknown, sizeof(unknown), visitor));
+    EXPECT_EQ(calls, 1);
+}
+
+TEST(ItchDecoderVisitor, WalksPacketsInPlace) {
+    const auto packets = makePackets(20);
+    ASSERT_EQ(packets.size(), 3u);
+    std::vector<uint64_t> seqs;
+    EXPECT_TRUE(forEachMoldUDP64Message(packets[1].data(), packets[1].size(),
+                                        [&](uint64_t seq, const uint8_t*, uint16_t) { seqs.push_back(seq); }));
+    EXPECT_EQ(seqs, (std::vector<uint64_t>{9, 10, 11, 12, 13, 14, 15, 16}));
+
+    seqs.clear();
+    EXPECT_FALSE(forEachMoldUDP64Message(packets[1].data(), packets[1].size() - 1,
+                                         [&](uint64_t seq, const uint8_t*, uint16_t) { seqs.push_back(seq); }));
+    EXPECT_EQ(seqs.size(), 7u) << "blocks before the truncated one are visited";
+}
+
+TEST(FeedStats, CountsMessagesGapsAndDuplicates) {
+    const auto packets = makePackets(40);
+    ASSERT_EQ(packets.size(), 5u);
+    FeedStats stats;
+    const uint64_t before = qrsdp::test::allocationCount();
+    for (size_t p : {0, 1, 3, 4, 3})  // packet 2 lost, packet 3 repeated
+        stats.onPacket(packets[p].data(), packets[p].size());
+    EXPECT_EQ(qrsdp::test::allocationCount(), before) << "decoding must not allocate";
+
+    const FeedCounters& c = stats.counters();
+    EXPECT_EQ(c.packets, 5u);
+    EXPECT_EQ(c.messages, 40u);
+    EXPECT_EQ(c.gaps, 1u);
+    EXPECT_EQ(c.missing, 8u);
+    EXPECT_EQ(c.duplicates, 8u);
+    EXPECT_EQ(c.malformed, 0u);
+    EXPECT_EQ(c.adds, 30u);
+    EXPECT_EQ(c.executions, 10u);
+    EXPECT_EQ(stats.expectedSequence(), 41u);
+    EXPECT_EQ(stats.lastTimestamp(), 1000u + 31);
+
+    stats.onPacket(packets[0].data(), 10);
+    EXPECT_EQ(stats.counters().malformed, 1u);
+}
+
+TEST(LatencyHistogram, PercentilesWithinABucket) {
+    LatencyHistogram h;
+    EXPECT_EQ(h.percentile(0.5), 0u);
+    for (uint64_t v = 1; v <= 10000; ++v)
+        h.record(v * 1000);
+    EXPECT_EQ(h.count(), 10000u);
+    EXPECT_EQ(h.max(), 10000000u);
+    const auto near = [](uint64_t got, double want) {
+        return static_cast<double>(got) >= want && static_cast<double>(got) <= want * (1 + 1.0 / 16);
+    };
+    EXPECT_TRUE(near(h.percentile(0.5), 5000000)) << h.percentile(0.5);
+    EXPECT_TRUE(near(h.percentile(0.99), 9900000)) << h.percentile(0.99);
+    EXPECT_EQ(h.percentile(1.0), 10000000u);
+
+    h.reset();
+    h.record(3);
+    EXPECT_EQ(h.percentile(0.5), 3u) << "small values are exact";
+    h.record(~uint64_t{0});
+    EXPECT_EQ(h.percentile(1.0), ~uint64_t{0});
+}
+
+}  // namespace test
+}  // namespace itch
+}  // namespace qrsdp
@@ -0,0 +1,172 @@
+#include <gtest/gtest.h>
+
+#include "itch/itch_channels.h"
+#include "itch/itch_decoder.h"
+#include "itch/itch_messages.h"
+#include "core/event_types.h"
+
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace qrsdp {
+namespace itch {
+namespace test {
+
+/// Decodes every datagram it is given, checking the session and sequence.
+class SequenceCheckingSender final : public IDatagramSender {
+public:
+    bool send(const uint8_t* data, size_t len) override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        MoldUDP64Parsed parsed;
+        EXPECT_TRUE(parseMoldUDP64(data, len, parsed));
+        session_.assign(parsed.session, sizeof(parsed.session));
+        EXPECT_EQ(parsed.sequence_number, next_seq_);
+        next_seq_ += parsed.message_count;
+        for (const auto& m : parsed.messages) {
+            DecodedItchMsg d;
+            EXPECT_TRUE(decodeItchMessage(m.data, m.size, d));
+            messages_.push_back(d);
+        }
+        return true;
+    }
+    size_t sendBatch(const Datagram* packets, size_t n) override {
+        for (size_t i = 0; i < n; ++i) send(packets[i].data, packets[i].len);
+        return n;
+    }
+
+    std::vector<DecodedItchMsg> messages() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return messages_;
+    }
+    std::string session() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return session_;
+    }
+
+private:
+    std::mutex mutex_;
+    std::vector<DecodedItchMsg> messages_;
+    std::string session_;
+    uint64_t next_seq_ = 1;
+};
+
+static EventRecord makeAdd(uint64_t ts, uint64_t order_id) {
+    EventRecord r{};
+    r.ts_ns = ts;
+    r.type = static_cast<uint8_t>(EventType::ADD_ASK);
+    r.side = static_cast<uint8_t>(Side::ASK);
+    r.price_ticks = 5000;
+    r.qty = 1;
+    r.order_id = order_id;
+    return r;
+}
+
+TEST(ItchChannelMap, ParsesCountAndPins) {
+    ItchChannelMap map;
+    ASSERT_TRUE(parseChannelMap("4", map));
+    EXPECT_EQ(map.channels, 4u);
+    EXPECT_TRUE(map.pinned.empty());
+
+    ASSERT_TRUE(parseChannelMap("4:AAPL=0,MSFT=3", map));
+    EXPECT_EQ(map.channels, 4u);
+    EXPECT_EQ(map.channelOf("AAPL"), 0u);
+    EXPECT_EQ(map.channelOf("MSFT"), 3u);
+
+    for (const char* bad : {"", "0", "65", "x", "4:", "4:AAPL", "4:AAPL=4", "4:=1", "4:AAPL=1,", "-2"})
+        EXPECT_FALSE(parseChannelMap(bad, map)) << bad;
+    EXPECT_EQ(map.channels, 4u) << "a failed parse leaves the map alone";
+}
+
+TEST(ItchChannelMap, UnpinnedSymbolsHashStablyAcrossChannels) {
+    ItchChannelMap map;
+    ASSERT_TRUE(parseChannelMap("4", map));
+    std::vector<int> used(4, 0);
+    for (int i = 0; i < 200; ++i) {
+        const std::string sym = "S" + std::to_string(i);
+        const uint32_t c = map.channelOf(sym);
+        ASSERT_LT(c, 4u);
+        EXPECT_EQ(map.channelOf(sym.data(), sym.size()), c);
+        ++used[c];
+    }
+    for (int n : used) EXPECT_GT(n, 20);
+
+    ItchChannelMap one;
+    EXPECT_EQ(one.channelOf("ANY"), 0u);
+}
+
+TEST(ItchChannelMap, ChannelSessionsAreDistinctTenCharacterNames) {
+    EXPECT_EQ(channelSession("QRSDPITCH ", 0, 1), "QRSDPITCH ");
+    EXPECT_EQ(channelSession("QRSDPITCH ", 3, 4), "QRSDPITCH3");
+    EXPECT_EQ(channelSession("QRSDPITCH", 12, 16), "QRSDPITC12");
+    EXPECT_EQ(channelSession("FEED", 1, 2), "FEED1");
+}
+
+TEST(ItchChannel, KeyedRecordsGetTheirOwnSessionLocatesAndDays) {
+    ItchChannelConfig config;
+    config.session = channelSession(config.session, 1, 2);
+    config.batch_packets = 4;
+    config.queue_records = 16;  // small enough that push() has to wait
+    auto sender = std::make_unique<SequenceCheckingSender>();
+    SequenceCheckingSender* capture = sender.get();
+    ItchChannel channel(config, std::move(sender));
+    EXPECT_THROW(ItchChannel(config, nullptr), std::runtime_error);
+    channel.start();
+
+    constexpr uint64_t kEvents = 1000;
+    for (uint64_t day = 0; day < 2; ++day) {
+        for (uint64_t i = 1; i <= kEvents; ++i) {
+            const char* key = (i % 2) ? "BBB" : "AAA";
+            channel.push(key, std::strlen(key), makeAdd(i, day * kEvents + i));
+        }
+    }
+    channel.stop();
+    channel.stop();
+
+    const auto msgs = capture->messages();
+    EXPECT_EQ(capture->session(), "QRSDPITCH1");
+    EXPECT_EQ(channel.messagesSent(), msgs.size());
+    // Start of Messages, Start of Market, two directories, the events, a day
+    // boundary (End + Start of Market), End of Market, End of Messages.
+    ASSERT_EQ(msgs.size(), 2 * kEvents + 8);
+    EXPECT_EQ(msgs[0].event_code, kSystemEventStartOfMessages);
+    EXPECT_EQ(msgs[1].event_code, kSystemEventStartOfMarket);
+    ASSERT_EQ(msgs[2].msg_type, kMsgTypeStockDirectory);
+    EXPECT_EQ(msgs[2].stock_locate, 1u);
+    EXPECT_EQ(std::string(msgs[2].stock, 3), "BBB");
+    EXPECT_EQ(msgs[3].order_reference, 1u);
+    ASSERT_EQ(msgs[4].msg_type, kMsgTypeStockDirectory);
+    EXPECT_EQ(msgs[4].stock_locate, 2u);
+    EXPECT_EQ(msgs[5].stock_locate, 2u);
+
+    size_t boundaries = 0;
+    for (size_t i = 6; i < msgs.size() - 2; ++i) {
+        if (msgs[i].msg_type == kMsgTypeSystemEvent) {
+            EXPECT_EQ(msgs[i].event_code, kSystemEventEndOfMarket);
+            EXPECT_EQ(msgs[++i].event_code, kSystemEventStartOfMarket);
+            ++boundaries;
+        }
+    }
+    EXPECT_EQ(boundaries, 1u);
+    EXPECT_EQ(msgs[msgs.size() - 2].event_code, kSystemEventEndOfMarket);
+    EXPECT_EQ(msgs.back().event_code, kSystemEventEndOfMessages);
+}
+
+TEST(ItchChannel, PushBeforeStartThrowsOnceTheQueueIsFull) {
+    ItchChannelConfig config;
+    config.queue_records = 2;
+    ItchChannel channel(config, std::make_unique<SequenceCheckingSender>());
+    channel.push("A", 1, makeAdd(1, 1));
+    channel.push("A", 1, makeAdd(2, 2));
+    EXPECT_THROW(channel.push("A", 1, makeAdd(3, 3)), std::runtime_error);
+    channel.start();
+    channel.stop();
+    EXPECT_EQ(channel.messagesSent(), 7u);  // SoM, SoMkt, directory, 2 events, EoMkt, EoM
+}
+
+}  // namespace test
+}  // namespace itch
+}  // namespace qrsdp
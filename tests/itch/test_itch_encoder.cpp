@@ -6,6 +6,7 @@
 #include "core/records.h"
 
 #include <cstring>
+#include <stdexcept>
 
 namespace qrsdp {
 namespace itch {
@@ -188,6 +189,36 @@ TEST(ItchEncoder, SymbolTruncatedAt8Chars) {
     EXPECT_STREQ(stock, "ABCDEFGH");
 }
 
+TEST(ItchEncoder, EncodeIntoMatchesEncode) {
+    ItchEncoder enc("AAPL", 3, 100);
+    ItchEncoder into("AAPL", 3, 100);
+    uint8_t buf[ItchEncoder::kMaxMessageSize];
+    for (EventType type : {EventType::ADD_ASK, EventType::CANCEL_BID, EventType::EXECUTE_SELL,
+                           EventType::EXECUTE_BUY}) {
+        auto rec = makeRecord(type, 5000, 9, 10020, 4);
+        const auto bytes = enc.encode(rec);
+        ASSERT_EQ(ItchEncoder::encodedSize(rec), bytes.size());
+        ASSERT_EQ(into.encodeInto(rec, buf, sizeof(buf)), bytes.size());
+        EXPECT_EQ(std::memcmp(buf, bytes.data(), bytes.size()), 0);
+    }
+    EXPECT_EQ(into.nextMatchNumber(), enc.nextMatchNumber());
+
+    const auto dir = enc.encodeStockDirectory(7);
+    ASSERT_EQ(into.encodeStockDirectoryInto(7, buf, sizeof(buf)), dir.size());
+    EXPECT_EQ(std::memcmp(buf, dir.data(), dir.size()), 0);
+    const auto sys = enc.encodeSystemEvent(kSystemEventStartOfMarket, 7);
+    ASSERT_EQ(into.encodeSystemEventInto(kSystemEventStartOfMarket, 7, buf, sizeof(buf)), sys.size());
+    EXPECT_EQ(std::memcmp(buf, sys.data(), sys.size()), 0);
+}
+
+TEST(ItchEncoder, EncodeIntoRejectsShortBuffer) {
+    ItchEncoder enc("AAPL", 1, 100);
+    uint8_t buf[sizeof(OrderExecutedMsg) - 1];
+    auto rec = makeRecord(EventType::EXECUTE_BUY, 100, 1, 100, 1);
+    EXPECT_THROW(enc.encodeInto(rec, buf, sizeof(buf)), std::runtime_error);
+    EXPECT_EQ(enc.nextMatchNumber(), 1u) << "a failed encode must not consume a match number";
+}
+
 }  // namespace test
 }  // namespace itch
 }  // namespace qrsdp
@@ -0,0 +1,251 @@
+#include <gtest/gtest.h>
+
+#include "itch/itch_feed_writer.h"
+#include "itch/itch_decoder.h"
+#include "itch/itch_messages.h"
+#include "itch/moldudp64.h"
+#include "book/order_level_book.h"
+#include "core/event_types.h"
+#include "core/records.h"
+#include "io/i_event_sink.h"
+#include "model/simple_imbalance_intensity.h"
+#include "producer/qrsdp_producer.h"
+#include "rng/mt19937_rng.h"
+#include "sampler/competing_intensity_sampler.h"
+#include "sampler/unit_size_attribute_sampler.h"
+
+#include <cstring>
+#include <list>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace qrsdp {
+namespace itch {
+namespace test {
+
+static EventRecord makeAdd(uint64_t ts, uint64_t order_id, int32_t price_ticks) {
+    EventRecord r{};
+    r.ts_ns = ts;
+    r.type = static_cast<uint8_t>(EventType::ADD_BID);
+    r.side = static_cast<uint8_t>(Side::BID);
+    r.price_ticks = price_ticks;
+    r.qty = 1;
+    r.order_id = order_id;
+    return r;
+}
+
+static std::vector<DecodedItchMsg> decodeAll(const std::vector<std::vector<uint8_t>>& packets) {
+    std::vector<DecodedItchMsg> out;
+    uint64_t expected_seq = 1;
+    for (const auto& pkt : packets) {
+        MoldUDP64Parsed parsed;
+        EXPECT_TRUE(parseMoldUDP64(pkt.data(), pkt.size(), parsed));
+        EXPECT_EQ(parsed.sequence_number, expected_seq);
+        expected_seq += parsed.message_count;
+        for (const auto& m : parsed.messages) {
+            DecodedItchMsg d;
+            EXPECT_TRUE(decodeItchMessage(m.data, m.size, d));
+            out.push_back(d);
+        }
+    }
+    return out;
+}
+
+TEST(ItchFeedWriter, FramesSessionWithLocatesAndSystemEvents) {
+    MoldUDP64Framer framer("FEED      ");
+    std::vector<std::vector<uint8_t>> packets;
+    framer.setSendCallback([&](const uint8_t* data, size_t len) {
+        packets.emplace_back(data, data + len);
+    });
+
+    ItchFeedWriter writer(framer);
+    EXPECT_EQ(writer.addSecurity("AAA", 100), 0u);
+    EXPECT_EQ(writer.addSecurity("BBB", 50), 1u);
+
+    writer.begin(1000);
+    // Enough events to span several MoldUDP64 packets.
+    const size_t kEvents = 200;
+    for (size_t i = 0; i < kEvents; ++i)
+        writer.append(static_cast<uint32_t>(i % 2), makeAdd(2000 + i, i + 1, 5000));
+    writer.end(9000);
+    EXPECT_EQ(framer.pendingMessageCount(), 0u);
+    ASSERT_GT(packets.size(), 1u);
+
+    const auto msgs = decodeAll(packets);
+    ASSERT_EQ(msgs.size(), kEvents + 6);
+    EXPECT_EQ(writer.messagesWritten(), msgs.size());
+
+    EXPECT_EQ(msgs[0].msg_type, kMsgTypeSystemEvent);
+    EXPECT_EQ(msgs[0].event_code, kSystemEventStartOfMessages);
+    EXPECT_EQ(msgs[1].msg_type, kMsgTypeStockDirectory);
+    EXPECT_EQ(msgs[1].stock_locate, 1u);
+    EXPECT_EQ(std::string(msgs[1].stock, 8), "AAA     ");
+    EXPECT_EQ(msgs[2].msg_type, kMsgTypeStockDirectory);
+    EXPECT_EQ(msgs[2].stock_locate, 2u);
+    EXPECT_EQ(msgs[3].event_code, kSystemEventStartOfMarket);
+
+    for (size_t i = 0; i < kEvents; ++i) {
+        const DecodedItchMsg& d = msgs[4 + i];
+        ASSERT_EQ(d.msg_type, kMsgTypeAddOrder);
+        EXPECT_EQ(d.stock_locate, (i % 2) + 1);
+        EXPECT_EQ(d.timestamp_ns, 2000 + i);
+        EXPECT_EQ(d.price, 5000u * ((i % 2) ? 50u : 100u));
+    }
+    EXPECT_EQ(msgs[kEvents + 4].event_code, kSystemEventEndOfMarket);
+    EXPECT_EQ(msgs[kEvents + 5].event_code, kSystemEventEndOfMessages);
+}
+
+TEST(ItchFeedWriter, UnknownSecurityThrows) {
+    MoldUDP64Framer framer("FEED      ");
+    ItchFeedWriter writer(framer);
+    writer.addSecurity("AAA", 100);
+    EXPECT_THROW(writer.append(1, makeAdd(1, 1, 1)), std::out_of_range);
+}
+
+/// A feed consumer that keeps a book of orders by reference: Add Order queues
+/// an order at its price, Order Executed takes shares from it, Order Delete
+/// removes it. References it never saw are ignored.
+struct OrderBookConsumer {
+    struct Order {
+        bool bid;
+        uint32_t price;
+        uint32_t shares;
+    };
+    std::unordered_map<uint64_t, Order> orders;
+    std::map<std::pair<bool, uint32_t>, std::list<uint64_t>> queues;  // (bid, price) -> refs, oldest first
+    size_t unknown = 0;
+
+    void remove(uint64_t ref) {
+        const Order& o = orders.at(ref);
+        queues[{o.bid, o.price}].remove(ref);
+        orders.erase(ref);
+    }
+
+    void onPacket(const uint8_t* data, size_t len) {
+        forEachMoldUDP64Message(data, len, [&](uint64_t, const uint8_t* msg, size_t size) {
+            DecodedItchMsg d;
+            ASSERT_TRUE(decodeItchMessage(msg, size, d));
+            if (d.msg_type == kMsgTypeAddOrder) {
+                ASSERT_EQ(orders.count(d.order_reference), 0u) << "order " << d.order_reference << " added twice";
+                orders[d.order_reference] = Order{d.buy_sell == 'B', d.price, d.shares};
+                queues[{d.buy_sell == 'B', d.price}].push_back(d.order_reference);
+            } else if (d.msg_type == kMsgTypeOrderDelete || d.msg_type == kMsgTypeOrderExecuted) {
+                const auto it = orders.find(d.order_reference);
+                if (it == orders.end()) {
+                    ++unknown;
+                } else if (d.msg_type == kMsgTypeOrderDelete || (it->second.shares -= d.shares) == 0) {
+                    remove(d.order_reference);
+                }
+            }
+        });
+    }
+
+    /// Whether the consumer holds exactly the orders of book, queued in the same order.
+    ::testing::AssertionResult matches(const OrderLevelBook& book, uint32_t tick_size) const {
+        size_t held = 0;
+        for (const bool bid : {true, false}) {
+            const Side side = bid ? Side::BID : Side::ASK;
+            for (size_t k = 0; k < book.numLevels(); ++k) {
+                const int32_t price = bid ? book.bidPriceAtLevel(k) : book.askPriceAtLevel(k);
+                const std::vector<uint64_t> want = book.queueAtLevel(side, k);
+                const auto it = queues.find({bid, static_cast<uint32_t>(price) * tick_size});
+                const std::vector<uint64_t> got = it == queues.end()
+                    ? std::vector<uint64_t>{} : std::vector<uint64_t>(it->second.begin(), it->second.end());
+                if (got != want)
+                    return ::testing::AssertionFailure() << (bid ? "bid" : "ask") << " level " << k << " at "
+                                                         << price << ": " << got.size() << " orders, book has "
+                                                         << want.size();
+                for (const uint64_t id : want) {
+                    if (orders.at(id).shares != book.orderQty(id))
+                        return ::testing::AssertionFailure() << "order " << id << " shares differ";
+                }
+                held += want.size();
+            }
+        }
+        if (orders.size() != held)
+            return ::testing::AssertionFailure() << orders.size() - held << " orders the book no longer has";
+        return ::testing::AssertionSuccess();
+    }
+};
+
+/// Replays an order-level producer's records through the feed into a consumer
+/// book and compares it with the producer's book along the way.
+TEST(ItchFeedWriter, OrderBookFeedRebuildsTheProducersBook) {
+    TradingSession session{};
+    session.seed = 99;
+    session.p0_ticks = 10000;
+    session.session_seconds = 30;
+    session.levels_per_side = 5;
+    session.tick_size = 100;
+    session.initial_spread_ticks = 2;
+    session.initial_depth = 5;
+    session.intensity_params = IntensityParams{20.0, 0.5, 15.0, 1.0, 1.0, 0.5, 0.4};
+
+    struct WriterSink : IEventSink {
+        ItchFeedWriter* writer;
+        size_t records = 0;
+        void append(const EventRecord& rec) override { writer->append(0, rec); ++records; }
+    };
+
+    for (const bool announce : {true, false}) {
+        MoldUDP64Framer framer("FEED      ");
+        OrderBookConsumer consumer;
+        framer.setSendCallback([&](const uint8_t* data, size_t len) { consumer.onPacket(data, len); });
+        ItchFeedWriter writer(framer);
+        writer.addSecurity("AAA", session.tick_size);
+        writer.begin(0);
+        if (announce)
+            writer.startOrderBook(0, BookSeed{session.p0_ticks, session.levels_per_side, session.initial_depth,
+                                              session.initial_spread_ticks}, 0);
+
+        Mt19937Rng rng(session.seed);
+        OrderLevelBook book;
+        SimpleImbalanceIntensity model(session.intensity_params);
+        CompetingIntensitySampler sampler(rng);
+        UnitSizeAttributeSampler attrs(rng, 0.5, 0.5);
+        QrsdpProducer producer(rng, book, model, sampler, attrs);
+        producer.startSession(session);
+        WriterSink sink;
+        sink.writer = &writer;
+        bool all_matched = true;
+        while (producer.stepOneEvent(sink)) {
+            if (sink.records % 25 != 0) continue;
+            writer.flush();
+            const ::testing::AssertionResult same = consumer.matches(book, session.tick_size);
+            if (announce) {
+                ASSERT_TRUE(same) << "after record " << sink.records;
+            }
+            all_matched = all_matched && same;
+        }
+        writer.end(0);
+        ASSERT_GT(sink.records, 500u);
+        if (announce) {
+            EXPECT_TRUE(consumer.matches(book, session.tick_size));
+            EXPECT_EQ(consumer.unknown, 0u) << "every delete and execution names an announced order";
+            EXPECT_GT(writer.messagesWritten(), sink.records + 4) << "background orders were announced";
+        } else {
+            // Without the announcements the seed depth is missing from the start.
+            EXPECT_FALSE(all_matched);
+            EXPECT_GT(consumer.unknown, 0u);
+        }
+    }
+}
+
+TEST(ItchFeedWriter, OrderBookAnnouncerRejectsForeignRecords) {
+    OrderBookAnnouncer announcer;
+    EXPECT_THROW(announcer.apply(makeAdd(1, 1, 9999)), std::runtime_error);
+    announcer.start(BookSeed{10000, 3, 2, 2}, 0);
+    EXPECT_EQ(announcer.book().orderCount(), 12u);
+    EventRecord cancel = makeAdd(2, 77, 9999);
+    cancel.type = static_cast<uint8_t>(EventType::CANCEL_BID);
+    EXPECT_THROW(announcer.apply(cancel), std::runtime_error) << "names an order the book does not have";
+    EXPECT_EQ(announcer.finish(3).size(), 11u) << "one order left the book";
+}
+
+}  // namespace test
+}  // namespace itch
+}  // namespace qrsdp
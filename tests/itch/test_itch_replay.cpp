@@ -0,0 +1,136 @@
+#include <gtest/gtest.h>
+
+#include "itch/itch_replay.h"
+#include "itch/itch_decoder.h"
+#include "itch/itch_messages.h"
+#include "itch/moldudp64.h"
+#include "io/binary_file_sink.h"
+#include "io/event_log_reader.h"
+#include "core/event_types.h"
+#include "core/records.h"
+
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace qrsdp {
+namespace itch {
+namespace test {
+
+/// Writes n ADD_BID records at ts = first_ts + i * step to path.
+static void writeLog(const std::string& path, uint32_t tick_size, uint64_t first_ts, uint64_t step, int n) {
+    TradingSession s{};
+    s.seed = 1;
+    s.p0_ticks = 5000;
+    s.session_seconds = 60;
+    s.levels_per_side = 8;
+    s.tick_size = tick_size;
+    s.initial_spread_ticks = 2;
+    s.initial_depth = 20;
+    BinaryFileSinkOptions options;
+    options.chunk_capacity = 8;
+    BinaryFileSink sink(path, s, options);
+    for (int i = 0; i < n; ++i) {
+        EventRecord r{};
+        r.ts_ns = first_ts + static_cast<uint64_t>(i) * step;
+        r.type = static_cast<uint8_t>(EventType::ADD_BID);
+        r.side = static_cast<uint8_t>(Side::BID);
+        r.price_ticks = 5000;
+        r.qty = 1;
+        r.order_id = static_cast<uint64_t>(i + 1);
+        sink.append(r);
+    }
+    sink.close();
+}
+
+class ItchReplayerTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        base_ = testing::TempDir() + "test_replay_" + std::to_string(reinterpret_cast<uintptr_t>(this));
+        framer_.setSendCallback([this](const uint8_t* data, size_t len) {
+            MoldUDP64Parsed parsed;
+            EXPECT_TRUE(parseMoldUDP64(data, len, parsed));
+            for (const auto& m : parsed.messages) {
+                DecodedItchMsg d;
+                EXPECT_TRUE(decodeItchMessage(m.data, m.size, d));
+                msgs_.push_back(d);
+            }
+        });
+    }
+
+    void TearDown() override {
+        for (const auto& p : paths_) std::remove(p.c_str());
+    }
+
+    std::string path(const std::string& suffix) {
+        paths_.push_back(base_ + suffix);
+        return paths_.back();
+    }
+
+    std::string base_;
+    std::vector<std::string> paths_;
+    MoldUDP64Framer framer_{"REPLAY    "};
+    std::vector<DecodedItchMsg> msgs_;
+};
+
+TEST_F(ItchReplayerTest, MergesSourcesByTimestamp) {
+    const std::string a = path("_a.qrsdp");
+    const std::string b = path("_b.qrsdp");
+    writeLog(a, 100, 1000, 20, 50);  // 1000, 1020, ...
+    writeLog(b, 50, 1010, 20, 30);   // 1010, 1030, ... (ends first)
+
+    ItchReplayer replayer(framer_, ReplayOptions{});
+    replayer.addSource("AAA", std::make_unique<EventLogReader>(a));
+    replayer.addSource("BBB", std::make_unique<EventLogReader>(b));
+    EXPECT_EQ(replayer.run(), 80u);
+
+    ASSERT_EQ(msgs_.size(), 80u + 6);
+    EXPECT_EQ(msgs_[0].event_code, kSystemEventStartOfMessages);
+    EXPECT_EQ(std::string(msgs_[1].stock, 3), "AAA");
+    EXPECT_EQ(std::string(msgs_[2].stock, 3), "BBB");
+    EXPECT_EQ(msgs_[3].event_code, kSystemEventStartOfMarket);
+    EXPECT_EQ(msgs_[3].timestamp_ns, 1000u);
+    uint64_t prev_ts = 0;
+    for (size_t i = 4; i < 84; ++i) {
+        const DecodedItchMsg& d = msgs_[i];
+        ASSERT_EQ(d.msg_type, kMsgTypeAddOrder);
+        EXPECT_GT(d.timestamp_ns, prev_ts);
+        prev_ts = d.timestamp_ns;
+        const bool from_a = (d.timestamp_ns - 1000) % 20 == 0;
+        EXPECT_EQ(d.stock_locate, from_a ? 1u : 2u);
+        EXPECT_EQ(d.price, 5000u * (from_a ? 100u : 50u)) << "uses each header's tick size";
+    }
+    EXPECT_EQ(msgs_[84].event_code, kSystemEventEndOfMarket);
+    EXPECT_EQ(msgs_[84].timestamp_ns, prev_ts);
+    EXPECT_EQ(msgs_[85].event_code, kSystemEventEndOfMessages);
+}
+
+TEST_F(ItchReplayerTest, FixedRatePacesEvents) {
+    const std::string a = path(".qrsdp");
+    writeLog(a, 100, 0, 1, 101);
+    ReplayOptions options;
+    options.pacing = ReplayPacing::FixedRate;
+    options.rate = 5000.0;  // 101 events: the last is due at 20 ms
+    ItchReplayer replayer(framer_, options);
+    replayer.addSource("AAA", std::make_unique<EventLogReader>(a));
+    const auto t0 = std::chrono::steady_clock::now();
+    EXPECT_EQ(replayer.run(), 101u);
+    EXPECT_GE(std::chrono::steady_clock::now() - t0, std::chrono::milliseconds(19));
+    EXPECT_EQ(msgs_.size(), 101u + 5);
+}
+
+TEST_F(ItchReplayerTest, RealtimeNeedsPositiveSpeed) {
+    ReplayOptions options;
+    options.pacing = ReplayPacing::Realtime;
+    options.speed = 0.0;
+    EXPECT_THROW(ItchReplayer(framer_, options), std::runtime_error);
+    options.pacing = ReplayPacing::FixedRate;
+    EXPECT_THROW(ItchReplayer(framer_, options), std::runtime_error);
+}
+
+}  // namespace test
+}  // namespace itch
+}  // namespace qrsdp
@@ -0,0 +1,94 @@
+#include <gtest/gtest.h>
+
+#include "itch/itch_snapshot.h"
+#include "itch/itch_decoder.h"
+#include "itch/itch_messages.h"
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace qrsdp {
+namespace itch {
+namespace test {
+
+static BookCheckpoint makeBook() {
+    BookCheckpoint cp;
+    cp.ts_ns = 34200000000123ULL;
+    cp.bids = {{5000, 30}, {4999, 0}, {4998, 12}};
+    cp.asks = {{5002, 7}, {5003, 9}, {5004, 0}};
+    return cp;
+}
+
+TEST(ItchSnapshot, WritesDirectoryLevelsAndEndOfSnapshot) {
+    std::vector<std::vector<uint8_t>> packets;
+    MoldUDP64Framer framer("QRSDPSNAP");
+    framer.setSendCallback([&](const uint8_t* data, size_t len) { packets.emplace_back(data, data + len); });
+    const ItchEncoder enc("AAPL", 3, 100);
+    EXPECT_EQ(writeBookSnapshot(framer, enc, makeBook(), 777), 6u);  // directory, 4 levels, end
+    framer.sendPending();
+    ASSERT_EQ(packets.size(), 1u);
+
+    MoldUDP64Parsed parsed;
+    ASSERT_TRUE(parseMoldUDP64(packets[0].data(), packets[0].size(), parsed));
+    ASSERT_EQ(parsed.messages.size(), 6u);
+    DecodedItchMsg m;
+    ASSERT_TRUE(decodeItchMessage(parsed.messages[1].data, parsed.messages[1].size, m));
+    EXPECT_EQ(m.msg_type, kMsgTypeAddOrder);
+    EXPECT_EQ(m.order_reference, 0u);
+    EXPECT_EQ(m.buy_sell, 'B');
+    EXPECT_EQ(m.shares, 30u);
+    EXPECT_EQ(m.price, 500000u);
+    ASSERT_TRUE(decodeItchMessage(parsed.messages[5].data, parsed.messages[5].size, m));
+    EXPECT_EQ(m.msg_type, kMsgTypeEndOfSnapshot);
+    EXPECT_EQ(m.stock_locate, 3u);
+    EXPECT_EQ(m.sequence_number, 777u);
+    EXPECT_EQ(m.timestamp_ns, makeBook().ts_ns);
+}
+
+TEST(ItchSnapshot, AssemblerRebuildsTheBookPerSecurity) {
+    std::vector<std::vector<uint8_t>> packets;
+    MoldUDP64Framer framer("QRSDPSNAP");
+    framer.setSendCallback([&](const uint8_t* data, size_t len) { packets.emplace_back(data, data + len); });
+    const ItchEncoder aapl("AAPL", 1, 100);
+    const ItchEncoder msft("MSFT", 2, 1);
+    BookCheckpoint other = makeBook();
+    other.bids.resize(1);
+    writeBookSnapshot(framer, aapl, makeBook(), 10);
+    writeBookSnapshot(framer, msft, other, 11);
+    framer.sendPending();
+
+    SnapshotAssembler assembler;
+    std::vector<ItchBookSnapshot> got;
+    for (const auto& pkt : packets) {
+        forEachMoldUDP64Message(pkt.data(), pkt.size(), [&](uint64_t, const uint8_t* msg, uint16_t n) {
+            ItchBookSnapshot snap;
+            if (assembler.onMessage(msg, n, snap)) got.push_back(snap);
+        });
+    }
+    ASSERT_EQ(got.size(), 2u);
+    EXPECT_EQ(std::string(got[0].stock, 4), "AAPL");
+    EXPECT_EQ(got[0].stock_locate, 1u);
+    EXPECT_EQ(got[0].next_sequence, 10u);
+    ASSERT_EQ(got[0].bids.size(), 2u);
+    EXPECT_EQ(got[0].bids[1].price, 499800u);
+    EXPECT_EQ(got[0].bids[1].shares, 12u);
+    ASSERT_EQ(got[0].asks.size(), 2u);
+    EXPECT_EQ(got[0].asks[0].price, 500200u);
+    EXPECT_EQ(std::string(got[1].stock, 4), "MSFT");
+    EXPECT_EQ(got[1].next_sequence, 11u);
+    ASSERT_EQ(got[1].bids.size(), 1u);
+    EXPECT_EQ(got[1].bids[0].price, 5000u);
+
+    // Levels without their directory (joined mid-snapshot) are ignored.
+    const auto directory = msft.encodeStockDirectory(0);
+    ItchBookSnapshot snap;
+    EXPECT_FALSE(assembler.onMessage(directory.data(), directory.size(), snap));
+    std::vector<uint8_t> stray(sizeof(EndOfSnapshotMsg));
+    aapl.encodeEndOfSnapshotInto(0, 1, stray.data(), stray.size());
+    EXPECT_FALSE(assembler.onMessage(stray.data(), stray.size(), snap));
+}
+
+}  // namespace test
+}  // namespace itch
+}  // namespace qrsdp
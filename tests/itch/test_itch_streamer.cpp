@@ -0,0 +1,281 @@
+#include <gtest/gtest.h>
+
+#include "itch/itch_streamer.h"
+#include "itch/itch_decoder.h"
+#include "itch/itch_messages.h"
+#include "itch/moldudp64.h"
+#include "core/event_types.h"
+#include "io/kafka_payload.h"
+
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace qrsdp {
+namespace itch {
+namespace test {
+
+/// A message of the fake source, counting how often it was released.
+struct FakeMessage {
+    std::string key;
+    std::vector<char> payload;
+    int partition = 0;
+    bool error = false;
+    std::atomic<int> released{0};
+};
+
+/// In-memory IStreamSource. Every message is queued both in arrival order (for
+/// kAllPartitions) and on its partition; a test reads it one way, not both.
+class FakeStreamSource final : public IStreamSource {
+public:
+    explicit FakeStreamSource(int partitions)
+        : partitions_(partitions), queues_(static_cast<size_t>(std::max(partitions, 1))) {}
+
+    FakeMessage& add(int partition, const std::string& key, const std::vector<EventRecord>& recs) {
+        std::vector<char> payload;
+        if (recs.size() == 1) {
+            const DiskEventRecord disk = toDisk(recs[0]);
+            const char* bytes = reinterpret_cast<const char*>(&disk);
+            payload.assign(bytes, bytes + sizeof(disk));
+        } else {
+            payload.resize(kafkaBatchBytes(recs.size()));
+            KafkaBatchWriter writer;
+            writer.reset(payload.data(), static_cast<uint32_t>(recs.size()));
+            for (const EventRecord& r : recs)
+                writer.add(toDisk(r));
+            writer.finish();
+        }
+        return queue(partition, key, std::move(payload), false);
+    }
+
+    FakeMessage& addRaw(int partition, const std::string& key, std::vector<char> payload) {
+        return queue(partition, key, std::move(payload), false);
+    }
+
+    FakeMessage& addError(int partition) { return queue(partition, "", {}, true); }
+
+    int partitionCount() const override { return partitions_; }
+
+    size_t consume(int partition, int timeout_ms, StreamMessage* out, size_t max) override {
+        size_t n = 0;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto& q = partition == kAllPartitions ? arrival_ : queues_[static_cast<size_t>(partition)];
+            for (; n < max && !q.empty(); ++n) {
+                FakeMessage* m = q.front();
+                q.pop_front();
+                out[n] = StreamMessage{};
+                out[n].key = m->key.empty() ? nullptr : m->key.data();
+                out[n].key_len = m->key.size();
+                out[n].payload = m->payload.empty() ? nullptr : m->payload.data();
+                out[n].len = m->payload.size();
+                out[n].partition = m->partition;
+                out[n].error = m->error ? "broker down" : nullptr;
+                out[n].handle = m;
+            }
+        }
+        if (n == 0)
+            std::this_thread::sleep_for(std::chrono::milliseconds(std::min(timeout_ms, 1)));
+        return n;
+    }
+
+    PartitionMerge::ReleaseFn releaseFn() const override { return release; }
+
+    void pollEvents() override { ++polls; }
+
+    std::atomic<int> polls{0};
+
+private:
+    static void release(void* handle) { ++static_cast<FakeMessage*>(handle)->released; }
+
+    FakeMessage& queue(int partition, const std::string& key, std::vector<char> payload, bool error) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        messages_.push_back(std::make_unique<FakeMessage>());
+        FakeMessage& m = *messages_.back();
+        m.key = key;
+        m.payload = std::move(payload);
+        m.partition = partition;
+        m.error = error;
+        arrival_.push_back(&m);
+        queues_[static_cast<size_t>(partition)].push_back(&m);
+        return m;
+    }
+
+    int partitions_;
+    std::mutex mutex_;
+    std::deque<std::unique_ptr<FakeMessage>> messages_;
+    std::deque<FakeMessage*> arrival_;
+    std::vector<std::deque<FakeMessage*>> queues_;
+};
+
+/// Decodes every datagram it is given, checking the session and sequence.
+class RecordingSender final : public IDatagramSender {
+public:
+    bool send(const uint8_t* data, size_t len) override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        MoldUDP64Parsed parsed;
+        EXPECT_TRUE(parseMoldUDP64(data, len, parsed));
+        session_.assign(parsed.session, sizeof(parsed.session));
+        EXPECT_EQ(parsed.sequence_number, next_seq_);
+        next_seq_ += parsed.message_count;
+        for (const auto& m : parsed.messages) {
+            DecodedItchMsg d;
+            EXPECT_TRUE(decodeItchMessage(m.data, m.size, d));
+            messages_.push_back(d);
+        }
+        return true;
+    }
+    size_t sendBatch(const Datagram* packets, size_t n) override {
+        for (size_t i = 0; i < n; ++i) send(packets[i].data, packets[i].len);
+        return n;
+    }
+
+    std::vector<DecodedItchMsg> messages() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return messages_;
+    }
+    std::string session() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return session_;
+    }
+    std::vector<uint64_t> orders() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::vector<uint64_t> ids;
+        for (const auto& m : messages_)
+            if (m.msg_type == kMsgTypeAddOrder) ids.push_back(m.order_reference);
+        return ids;
+    }
+
+private:
+    std::mutex mutex_;
+    std::vector<DecodedItchMsg> messages_;
+    std::string session_;
+    uint64_t next_seq_ = 1;
+};
+
+static EventRecord makeAdd(uint64_t ts, uint64_t order_id) {
+    EventRecord r{};
+    r.ts_ns = ts;
+    r.type = static_cast<uint8_t>(EventType::ADD_ASK);
+    r.side = static_cast<uint8_t>(Side::ASK);
+    r.price_ticks = 5000;
+    r.qty = 1;
+    r.order_id = order_id;
+    return r;
+}
+
+/// Runs the streamer on its own thread until done() holds (or 5 s pass), then stops it.
+static void runUntil(ItchStreamer& streamer, const std::function<bool()>& done) {
+    std::atomic<bool> running{true};
+    std::thread t([&] { streamer.run(running); });
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (!done() && std::chrono::steady_clock::now() < deadline)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    running = false;
+    t.join();
+}
+
+static std::vector<std::unique_ptr<IDatagramSender>> senders(
+    std::initializer_list<RecordingSender*> list) {
+    std::vector<std::unique_ptr<IDatagramSender>> out;
+    for (RecordingSender* s : list)
+        out.emplace_back(s);
+    return out;
+}
+
+TEST(ItchStreamer, BatchedModeEncodesInArrivalOrderAcrossDays) {
+    FakeStreamSource source(0);
+    FakeMessage& a = source.add(0, "AAPL", {makeAdd(100, 1)});
+    FakeMessage& err = source.addError(0);
+    FakeMessage& unkeyed = source.add(0, "", {makeAdd(200, 2)});
+    FakeMessage& garbage = source.addRaw(0, "MSFT", {'x', 'y', 'z'});
+    FakeMessage& batch = source.add(0, "MSFT", {makeAdd(300, 3), makeAdd(50, 4)});
+
+    ItchStreamConfig config;
+    config.consume_batch = 2;  // several polls
+    auto* sender = new RecordingSender;
+    ItchStreamer streamer(config, source, senders({sender}));
+    runUntil(streamer, [&] { return sender->orders().size() == 4; });
+
+    EXPECT_EQ(sender->orders(), (std::vector<uint64_t>{1, 2, 3, 4}));
+    for (const FakeMessage* m : {&a, &err, &unkeyed, &garbage, &batch})
+        EXPECT_EQ(m->released.load(), 1);
+
+    // Start of Messages, Start of Market, AAPL, UNKNOWN and MSFT each with a
+    // directory, the ts drop to 50 as a day boundary, End of Market, End of Messages.
+    const auto msgs = sender->messages();
+    const std::string types = [&] {
+        std::string s;
+        for (const auto& m : msgs)
+            s += m.msg_type == kMsgTypeSystemEvent ? m.event_code : m.msg_type;
+        return s;
+    }();
+    EXPECT_EQ(types, "OQRARARAMQAME");
+    EXPECT_EQ(std::string(msgs[2].stock, 4), "AAPL");
+    EXPECT_EQ(std::string(msgs[4].stock, 7), "UNKNOWN");
+    EXPECT_EQ(std::string(msgs[6].stock, 4), "MSFT");
+    EXPECT_EQ(msgs[8].timestamp_ns, 300u);
+    EXPECT_EQ(msgs[9].timestamp_ns, 50u);
+    EXPECT_EQ(msgs[10].stock_locate, msgs[7].stock_locate);
+}
+
+TEST(ItchStreamer, PartitionThreadsMergeIntoTimestampOrder) {
+    FakeStreamSource source(2);
+    std::vector<FakeMessage*> all;
+    all.push_back(&source.add(0, "AAPL", {makeAdd(100, 1), makeAdd(300, 3)}));
+    all.push_back(&source.add(1, "MSFT", {makeAdd(200, 2)}));
+    all.push_back(&source.add(0, "AAPL", {makeAdd(500, 5)}));
+    all.push_back(&source.add(1, "MSFT", {makeAdd(400, 4), makeAdd(600, 6)}));
+    all.push_back(&source.addError(1));
+
+    ItchStreamConfig config;
+    config.partition_threads = true;
+    config.merge_wait_us = 200000;  // well past reader start-up, so nothing goes early
+    auto* sender = new RecordingSender;
+    ItchStreamer streamer(config, source, senders({sender}));
+    runUntil(streamer, [&] { return sender->orders().size() == 6; });
+
+    EXPECT_EQ(sender->orders(), (std::vector<uint64_t>{1, 2, 3, 4, 5, 6}));
+    for (const FakeMessage* m : all)
+        EXPECT_EQ(m->released.load(), 1);
+    EXPECT_GT(source.polls.load(), 0);  // idle merge rounds serve consumer events
+}
+
+TEST(ItchStreamer, ChannelsRouteEachSymbolToItsOwnSession) {
+    FakeStreamSource source(0);
+    source.add(0, "AAPL", {makeAdd(100, 1)});
+    source.add(0, "MSFT", {makeAdd(200, 2)});
+    source.add(0, "AAPL", {makeAdd(300, 3)});
+
+    ItchStreamConfig config;
+    ASSERT_TRUE(parseChannelMap("2:AAPL=0,MSFT=1", config.channels));
+    auto* first = new RecordingSender;
+    auto* second = new RecordingSender;
+    ItchStreamer streamer(config, source, senders({first, second}));
+    runUntil(streamer, [&] { return first->orders().size() + second->orders().size() == 3; });
+
+    EXPECT_EQ(first->orders(), (std::vector<uint64_t>{1, 3}));
+    EXPECT_EQ(second->orders(), (std::vector<uint64_t>{2}));
+    EXPECT_EQ(first->session(), "QRSDPITCH0");
+    EXPECT_EQ(second->session(), "QRSDPITCH1");
+}
+
+TEST(ItchStreamer, RejectsMismatchedSendersAndUnpartitionedSources) {
+    FakeStreamSource source(0);
+    ItchStreamConfig config;
+    EXPECT_THROW(ItchStreamer(config, source, {}), std::invalid_argument);
+    config.partition_threads = true;
+    EXPECT_THROW(ItchStreamer(config, source, senders({new RecordingSender})),
+                 std::invalid_argument);
+}
+
+}  // namespace test
+}  // namespace itch
+}  // namespace qrsdp
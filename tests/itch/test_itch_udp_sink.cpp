@@ -0,0 +1,318 @@
+#include <gtest/gtest.h>
+
+#include "itch/itch_udp_sink.h"
+#include "itch/itch_decoder.h"
+#include "itch/itch_snapshot.h"
+#include "itch/itch_messages.h"
+#include "book/order_level_book.h"
+#include "core/event_types.h"
+#include "core/records.h"
+
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace qrsdp {
+namespace itch {
+namespace test {
+
+/// Keeps a copy of every datagram, in send order.
+class CapturingSender final : public IDatagramSender {
+public:
+    bool send(const uint8_t* data, size_t len) override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        packets_.emplace_back(data, data + len);
+        return true;
+    }
+    size_t sendBatch(const Datagram* packets, size_t n) override {
+        for (size_t i = 0; i < n; ++i) send(packets[i].data, packets[i].len);
+        return n;
+    }
+
+    /// Every datagram, in send order.
+    std::vector<std::vector<uint8_t>> packets() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return packets_;
+    }
+
+    std::vector<DecodedItchMsg> messages() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::vector<DecodedItchMsg> out;
+        uint64_t expected_seq = 1;
+        for (const auto& pkt : packets_) {
+            MoldUDP64Parsed parsed;
+            EXPECT_TRUE(parseMoldUDP64(pkt.data(), pkt.size(), parsed));
+            EXPECT_EQ(parsed.sequence_number, expected_seq);
+            expected_seq += parsed.message_count;
+            for (const auto& m : parsed.messages) {
+                DecodedItchMsg d;
+                EXPECT_TRUE(decodeItchMessage(m.data, m.size, d));
+                out.push_back(d);
+            }
+        }
+        return out;
+    }
+
+    /// Session of the first packet, blanks included.
+    std::string session() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        MoldUDP64Parsed parsed;
+        if (packets_.empty() || !parseMoldUDP64(packets_[0].data(), packets_[0].size(), parsed))
+            return {};
+        return std::string(parsed.session, sizeof(parsed.session));
+    }
+
+private:
+    std::mutex mutex_;
+    std::vector<std::vector<uint8_t>> packets_;
+};
+
+static EventRecord makeAdd(uint64_t ts, uint64_t order_id) {
+    EventRecord r{};
+    r.ts_ns = ts;
+    r.type = static_cast<uint8_t>(EventType::ADD_BID);
+    r.side = static_cast<uint8_t>(Side::BID);
+    r.price_ticks = 5000;
+    r.qty = 1;
+    r.order_id = order_id;
+    return r;
+}
+
+TEST(ItchLiveFeed, MergesProducerThreadsIntoOneSession) {
+    ItchLiveConfig config;
+    config.queue_records = 64;  // small enough that producers have to wait
+    auto sender = std::make_unique<CapturingSender>();
+    CapturingSender* capture = sender.get();
+    ItchLiveFeed feed(config, std::move(sender));
+    ItchUdpSink& a = feed.addSecurity("AAA", 100);
+    ItchUdpSink& b = feed.addSecurity("BBB", 100);
+    feed.start(1000);
+
+    constexpr uint64_t kEvents = 5000;
+    auto produce = [](ItchUdpSink& sink, bool batched) {
+        std::vector<EventRecord> batch;
+        for (uint64_t i = 1; i <= kEvents; ++i) {
+            if (!batched) {
+                sink.append(makeAdd(1000 + i, i));
+                continue;
+            }
+            batch.push_back(makeAdd(1000 + i, i));
+            if (batch.size() == 7 || i == kEvents) {
+                sink.appendBatch(batch.data(), batch.size());
+                batch.clear();
+            }
+        }
+        sink.flush();
+    };
+    std::thread ta(produce, std::ref(a), false);
+    std::thread tb(produce, std::ref(b), true);
+    ta.join();
+    tb.join();
+    feed.stop();
+
+    const auto msgs = capture->messages();
+    ASSERT_EQ(msgs.size(), 2 * kEvents + 6);
+    EXPECT_EQ(feed.messagesSent(), msgs.size());
+    EXPECT_EQ(msgs[0].event_code, kSystemEventStartOfMessages);
+    EXPECT_EQ(msgs[3].event_code, kSystemEventStartOfMarket);
+    std::map<uint16_t, uint64_t> last_ref;
+    for (size_t i = 4; i < 4 + 2 * kEvents; ++i) {
+        ASSERT_EQ(msgs[i].msg_type, kMsgTypeAddOrder);
+        uint64_t& last = last_ref[msgs[i].stock_locate];
+        EXPECT_EQ(msgs[i].order_reference, last + 1) << "per-security order is kept";
+        last = msgs[i].order_reference;
+    }
+    EXPECT_EQ(last_ref.size(), 2u);
+    EXPECT_EQ(msgs.back().event_code, kSystemEventEndOfMessages);
+    EXPECT_EQ(msgs.back().timestamp_ns, 1000 + kEvents);
+}
+
+TEST(ItchLiveFeed, SendsWithoutWaitingForAFullPacket) {
+    auto sender = std::make_unique<CapturingSender>();
+    CapturingSender* capture = sender.get();
+    ItchLiveConfig config;
+    config.flush_deadline_us = 0;  // only the idle flush can send a lone event
+    ItchLiveFeed feed(config, std::move(sender));
+    ItchUdpSink& sink = feed.addSecurity("AAA", 100);
+    feed.start(0);
+
+    sink.append(makeAdd(10, 1));
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+    while (capture->messages().size() < 4 && std::chrono::steady_clock::now() < deadline)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    const auto msgs = capture->messages();
+    ASSERT_EQ(msgs.size(), 4u);  // Start of Messages, directory, Start of Market, the event
+    EXPECT_EQ(msgs[3].order_reference, 1u);
+    feed.stop();
+}
+
+TEST(ItchLiveFeed, OrderBookStartsAnnounceTheSeedBetweenSessions) {
+    auto sender = std::make_unique<CapturingSender>();
+    CapturingSender* capture = sender.get();
+    ItchLiveConfig config;
+    ItchLiveFeed feed(config, std::move(sender));
+    ItchUdpSink& sink = feed.addSecurity("AAA", 100);
+    feed.start(0);
+
+    const BookSeed seed{5001, 2, 3, 2};  // bids 5000, 4999 and asks 5002, 5003, three orders each
+    sink.startOrderBook(seed);
+    sink.append(makeAdd(10, 1));
+    sink.startOrderBook(seed);  // the next day
+    feed.stop();
+
+    const auto msgs = capture->messages();
+    ASSERT_EQ(msgs.size(), 3u + 12 + 1 + 13 + 12 + 2);
+    for (size_t i = 3; i < 15; ++i) {
+        EXPECT_EQ(msgs[i].msg_type, kMsgTypeAddOrder);
+        EXPECT_GE(msgs[i].order_reference, kBackgroundOrderIdBase);
+    }
+    EXPECT_EQ(msgs[15].order_reference, 1u) << "the record follows its session's seed";
+    std::vector<uint64_t> deleted;
+    for (size_t i = 16; i < 29; ++i) {
+        EXPECT_EQ(msgs[i].msg_type, kMsgTypeOrderDelete);
+        deleted.push_back(msgs[i].order_reference);
+    }
+    EXPECT_NE(std::find(deleted.begin(), deleted.end(), 1u), deleted.end()) << "the first day's orders go";
+    for (size_t i = 29; i < 41; ++i) EXPECT_EQ(msgs[i].msg_type, kMsgTypeAddOrder);
+}
+
+TEST(ItchLiveFeed, FullQueueBeforeStartThrows) {
+    ItchLiveConfig config;
+    config.queue_records = 4;
+    ItchLiveFeed feed(config, std::make_unique<CapturingSender>());
+    ItchUdpSink& sink = feed.addSecurity("AAA", 100);
+    for (uint64_t i = 0; i < 4; ++i) sink.append(makeAdd(i, i + 1));
+    EXPECT_THROW(sink.append(makeAdd(5, 5)), std::runtime_error);
+    EXPECT_EQ(sink.stalls(), 1u);
+    feed.start(0);
+    EXPECT_THROW(feed.addSecurity("BBB", 100), std::runtime_error);
+}
+
+TEST(ItchLiveFeed, ChannelsAreSeparateSessionsOfTheirOwnSecurities) {
+    ItchLiveConfig config;
+    ASSERT_TRUE(parseChannelMap("3:AAA=2", config.channels));
+    std::vector<std::unique_ptr<IDatagramSender>> senders;
+    std::vector<CapturingSender*> captures;
+    for (int c = 0; c < 3; ++c) {
+        senders.push_back(std::make_unique<CapturingSender>());
+        captures.push_back(static_cast<CapturingSender*>(senders.back().get()));
+    }
+    EXPECT_THROW(ItchLiveFeed(config, std::make_unique<CapturingSender>()), std::runtime_error);
+    ItchLiveFeed feed(config, std::move(senders));
+    ASSERT_EQ(feed.channelCount(), 3u);
+
+    const std::vector<std::string> symbols = {"AAA", "BBB", "CCC", "DDD", "EEE", "FFF"};
+    std::vector<ItchUdpSink*> sinks;
+    for (const auto& sym : symbols) sinks.push_back(&feed.addSecurity(sym, 100));
+    feed.start(0);
+    constexpr uint64_t kEvents = 500;
+    for (uint64_t i = 1; i <= kEvents; ++i)
+        for (ItchUdpSink* sink : sinks) sink->append(makeAdd(i, i));
+    for (ItchUdpSink* sink : sinks) sink->flush();
+    feed.stop();
+
+    uint64_t total = 0;
+    std::map<std::string, int> sessions;
+    for (uint32_t c = 0; c < 3; ++c) {
+        // messages() checks that the channel's sequence numbers start at 1 and have no gaps.
+        const auto msgs = captures[c]->messages();
+        EXPECT_EQ(feed.messagesSent(c), msgs.size());
+        total += msgs.size();
+        ++sessions[captures[c]->session()];
+        std::vector<uint16_t> own;
+        for (size_t i = 0; i < symbols.size(); ++i)
+            if (config.channels.channelOf(symbols[i]) == c) own.push_back(static_cast<uint16_t>(i + 1));
+        ASSERT_EQ(msgs.size(), 4 + own.size() * (kEvents + 1)) << "channel " << c;
+        EXPECT_EQ(msgs[0].event_code, kSystemEventStartOfMessages);
+        for (size_t k = 0; k < own.size(); ++k) {
+            EXPECT_EQ(msgs[1 + k].msg_type, kMsgTypeStockDirectory);
+            EXPECT_EQ(msgs[1 + k].stock_locate, own[k]) << "locates are run-wide";
+        }
+        for (size_t i = 2 + own.size(); i < msgs.size() - 2; ++i) {
+            ASSERT_EQ(msgs[i].msg_type, kMsgTypeAddOrder);
+            EXPECT_NE(std::find(own.begin(), own.end(), msgs[i].stock_locate), own.end());
+        }
+        EXPECT_EQ(msgs.back().event_code, kSystemEventEndOfMessages);
+    }
+    EXPECT_EQ(config.channels.channelOf("AAA"), 2u);
+    EXPECT_EQ(total, feed.messagesSent());
+    EXPECT_EQ(sessions.size(), 3u);
+    EXPECT_EQ(sessions.count("QRSDPITCH2"), 1u);
+}
+
+TEST(ItchLiveFeed, SnapshotsAreTaggedWithTheMainFeedSequence) {
+    ItchLiveConfig config;
+    config.snapshot_records = 100;
+    config.queue_records = 64;
+    std::vector<std::unique_ptr<IDatagramSender>> senders;
+    std::vector<std::unique_ptr<IDatagramSender>> snapshot_senders;
+    senders.push_back(std::make_unique<CapturingSender>());
+    snapshot_senders.push_back(std::make_unique<CapturingSender>());
+    CapturingSender* feed_capture = static_cast<CapturingSender*>(senders[0].get());
+    CapturingSender* snapshot_capture = static_cast<CapturingSender*>(snapshot_senders[0].get());
+    ItchLiveFeed feed(config, std::move(senders), std::move(snapshot_senders));
+    ASSERT_TRUE(feed.sendsSnapshots());
+    ItchUdpSink& a = feed.addSecurity("AAA", 100);
+    ItchUdpSink& b = feed.addSecurity("BBB", 100);
+    feed.start(0);
+
+    // The "book" of each security is the number of records appended to it.
+    constexpr uint64_t kEvents = 1050;
+    auto produce = [](ItchUdpSink& sink) {
+        uint64_t appended = 0;
+        sink.setSnapshotSource([&appended](BookCheckpoint& cp) {
+            cp.bids = {{1, static_cast<uint32_t>(appended)}};
+        });
+        for (uint64_t i = 1; i <= kEvents; ++i) {
+            appended = i;
+            sink.append(makeAdd(i, i));
+        }
+        sink.flush();
+        sink.setSnapshotSource(nullptr);
+    };
+    std::thread ta(produce, std::ref(a));
+    std::thread tb(produce, std::ref(b));
+    ta.join();
+    tb.join();
+    feed.stop();
+
+    const auto msgs = feed_capture->messages();  // msgs[i] has sequence i + 1
+    SnapshotAssembler assembler;
+    std::vector<ItchBookSnapshot> snaps;
+    for (const auto& pkt : snapshot_capture->packets()) {
+        forEachMoldUDP64Message(pkt.data(), pkt.size(), [&](uint64_t, const uint8_t* m, uint16_t n) {
+            ItchBookSnapshot snap;
+            if (assembler.onMessage(m, n, snap)) snaps.push_back(snap);
+        });
+    }
+    EXPECT_EQ(snapshot_capture->session(), "QRSDPSNAP ");
+    const uint64_t dropped = a.snapshotsDropped() + b.snapshotsDropped();
+    EXPECT_EQ(snaps.size() + dropped, 2 * (kEvents / 100));
+    EXPECT_EQ(feed.snapshotsSent(), snaps.size());
+    ASSERT_FALSE(snaps.empty());
+    for (const ItchBookSnapshot& snap : snaps) {
+        ASSERT_EQ(snap.bids.size(), 1u);
+        const uint64_t records = snap.bids[0].shares;
+        EXPECT_EQ(records % 100, 0u);
+        // Every add of this security before next_sequence is in the snapshot, none after.
+        ASSERT_LE(snap.next_sequence, msgs.size() + 1);
+        for (size_t i = 0; i < msgs.size(); ++i) {
+            if (msgs[i].msg_type != kMsgTypeAddOrder || msgs[i].stock_locate != snap.stock_locate)
+                continue;
+            if (i + 1 < snap.next_sequence)
+                EXPECT_LE(msgs[i].order_reference, records);
+            else
+                EXPECT_GT(msgs[i].order_reference, records);
+        }
+    }
+}
+
+}  // namespace test
+}  // namespace itch
+}  // namespace qrsdp
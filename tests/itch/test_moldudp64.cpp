@@ -3,7 +3,11 @@
 #include "itch/itch_messages.h"
 #include "itch/endian.h"
 
+#include <chrono>
 #include <cstring>
+#include <stdexcept>
+#include <thread>
+#include <vector>
 
 namespace qrsdp {
 namespace itch {
@@ -158,6 +162,121 @@ TEST(MoldUDP64, PendingMessageCount) {
     EXPECT_EQ(framer.pendingMessageCount(), 0u);
 }
 
+TEST(MoldUDP64, ReservedSlotsMatchAddMessage) {
+    MoldUDP64Framer added("SLOTS     ");
+    MoldUDP64Framer reserved("SLOTS     ");
+    std::vector<std::vector<uint8_t>> added_packets, reserved_packets;
+    added.setSendCallback([&](const uint8_t* data, size_t len) { added_packets.emplace_back(data, data + len); });
+    reserved.setSendCallback([&](const uint8_t* data, size_t len) { reserved_packets.emplace_back(data, data + len); });
+
+    std::vector<uint8_t> msg(300);
+    for (int i = 0; i < 10; ++i) {
+        const auto len = static_cast<uint16_t>(100 + 20 * i);
+        for (uint16_t b = 0; b < len; ++b) msg[b] = static_cast<uint8_t>(i + b);
+        added.addMessage(msg.data(), len);
+        uint8_t* dst = reserved.reserveMessage(len);
+        std::memcpy(dst, msg.data(), len);
+        reserved.commitMessage(len);
+    }
+    added.sendPending();
+    reserved.sendPending();
+    EXPECT_EQ(reserved.nextSequenceNumber(), 11u);
+    EXPECT_EQ(reserved_packets, added_packets);
+
+    // A slot reserved larger than its message shrinks to the committed length.
+    uint8_t* dst = reserved.reserveMessage(50);
+    std::memcpy(dst, msg.data(), 3);
+    reserved.commitMessage(3);
+    EXPECT_EQ(reserved.flush().size(), kMoldUDP64HeaderSize + 2 + 3);
+}
+
+TEST(MoldUDP64, PacketBuffersAreAlignedAndRecycled) {
+    MoldUDP64Framer framer("POOL      ", 2);
+    std::vector<const uint8_t*> sent;
+    std::vector<std::vector<uint8_t>> copies;
+    framer.setSendCallback([&](const uint8_t* data, size_t len) {
+        sent.push_back(data);
+        copies.emplace_back(data, data + len);
+    });
+
+    uint8_t msg[] = {0x42};
+    for (int i = 0; i < 3; ++i) {
+        framer.addMessage(msg, 1);
+        framer.sendPending();
+    }
+    ASSERT_EQ(sent.size(), 3u);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(sent[0]) % 64, 0u);
+    EXPECT_NE(sent[0], sent[1]);
+    EXPECT_EQ(sent[0], sent[2]) << "pool of two: the third packet reuses the first buffer";
+    for (size_t i = 0; i < copies.size(); ++i) {
+        MoldUDP64Header hdr;
+        std::memcpy(&hdr, copies[i].data(), kMoldUDP64HeaderSize);
+        EXPECT_EQ(betoh64(hdr.sequence_number), i + 1);
+    }
+}
+
+TEST(MoldUDP64, MessageLargerThanAPacketThrows) {
+    MoldUDP64Framer framer("BIG       ");
+    std::vector<uint8_t> fits(kMoldUDP64MaxPayload - kMoldUDP64HeaderSize - 2);
+    std::vector<uint8_t> too_big(fits.size() + 1);
+    framer.addMessage(fits.data(), static_cast<uint16_t>(fits.size()));
+    EXPECT_EQ(framer.flush().size(), kMoldUDP64MaxPayload);
+    EXPECT_THROW(framer.addMessage(too_big.data(), static_cast<uint16_t>(too_big.size())),
+                 std::length_error);
+    EXPECT_EQ(framer.pendingMessageCount(), 0u);
+}
+
+TEST(MoldUDP64, BatchCallbackGetsFullPoolsInOrder) {
+    MoldUDP64Framer framer("BATCH     ", 3);
+    std::vector<size_t> batch_sizes;
+    std::vector<uint64_t> sequences;
+    framer.setBatchCallback([&](const Datagram* packets, size_t n) {
+        batch_sizes.push_back(n);
+        for (size_t i = 0; i < n; ++i) {
+            MoldUDP64Header hdr;
+            std::memcpy(&hdr, packets[i].data, kMoldUDP64HeaderSize);
+            sequences.push_back(betoh64(hdr.sequence_number));
+        }
+    });
+
+    // Two of these never share a packet, so every add seals the previous one.
+    std::vector<uint8_t> msg(700, 0x01);
+    for (int i = 0; i < 7; ++i) {
+        framer.addMessage(msg.data(), static_cast<uint16_t>(msg.size()));
+        if (i == 3) {
+            EXPECT_EQ(batch_sizes, std::vector<size_t>({3}));
+        }
+    }
+    EXPECT_EQ(batch_sizes, (std::vector<size_t>{3, 3}));
+    // sendPending() hands over a part-filled batch rather than waiting for three.
+    framer.sendPending();
+    EXPECT_EQ(batch_sizes, (std::vector<size_t>{3, 3, 1}));
+    EXPECT_EQ(sequences, (std::vector<uint64_t>{1, 2, 3, 4, 5, 6, 7}));
+}
+
+TEST(MoldUDP64, FlushDeadlineBoundsHoldingTime) {
+    MoldUDP64Framer framer("DEADLINE  ");
+    std::vector<std::vector<uint8_t>> sent;
+    framer.setSendCallback([&](const uint8_t* data, size_t len) { sent.emplace_back(data, data + len); });
+    framer.setFlushDeadline(std::chrono::milliseconds(20));
+
+    uint8_t msg[] = {0x01};
+    framer.addMessage(msg, 1);
+    EXPECT_FALSE(framer.flushIfDue());
+    std::this_thread::sleep_for(std::chrono::milliseconds(30));
+    framer.addMessage(msg, 1);  // past the deadline: both go out now
+    ASSERT_EQ(sent.size(), 1u);
+    MoldUDP64Header hdr;
+    std::memcpy(&hdr, sent[0].data(), kMoldUDP64HeaderSize);
+    EXPECT_EQ(betoh16(hdr.message_count), 2u);
+
+    framer.addMessage(msg, 1);
+    std::this_thread::sleep_for(std::chrono::milliseconds(30));
+    EXPECT_TRUE(framer.flushIfDue());
+    EXPECT_EQ(sent.size(), 2u);
+    EXPECT_FALSE(framer.flushIfDue());
+}
+
 }  // namespace test
 }  // namespace itch
 }  // namespace qrsdp
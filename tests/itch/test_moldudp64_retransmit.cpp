@@ -0,0 +1,134 @@
+#include <gtest/gtest.h>
+#include "itch/moldudp64.h"
+#include "itch/moldudp64_retransmit.h"
+#include "itch/itch_messages.h"
+#include "itch/endian.h"
+
+#include <cstring>
+#include <vector>
+
+#ifdef _WIN32
+    #ifndef WIN32_LEAN_AND_MEAN
+    #define WIN32_LEAN_AND_MEAN
+    #endif
+    #include <winsock2.h>
+    #include <ws2tcpip.h>
+    using socket_t = SOCKET;
+    inline int close_sock(socket_t s) { return closesocket(s); }
+#else
+    #include <arpa/inet.h>
+    #include <netinet/in.h>
+    #include <sys/socket.h>
+    #include <unistd.h>
+    using socket_t = int;
+    inline int close_sock(socket_t s) { return close(s); }
+#endif
+
+namespace qrsdp {
+namespace itch {
+namespace test {
+
+/// Frames messages 1..n (300 bytes each, every byte = its sequence number, so
+/// four per packet) and records every packet sent into ring.
+static void sendMessages(RetransmitRing& ring, int n) {
+    MoldUDP64Framer framer("REXMIT    ");
+    framer.setSendCallback([&](const uint8_t* data, size_t len) { ring.record(data, len); });
+    std::vector<uint8_t> msg(300);
+    for (int seq = 1; seq <= n; ++seq) {
+        std::fill(msg.begin(), msg.end(), static_cast<uint8_t>(seq));
+        framer.addMessage(msg.data(), static_cast<uint16_t>(msg.size()));
+    }
+    framer.sendPending();
+}
+
+/// The sequence number each message block of a packet was filled with.
+static std::vector<int> messageTags(const uint8_t* packet, size_t len) {
+    MoldUDP64Header hdr;
+    std::memcpy(&hdr, packet, kMoldUDP64HeaderSize);
+    std::vector<int> tags;
+    size_t off = kMoldUDP64HeaderSize;
+    for (uint16_t i = 0; i < betoh16(hdr.message_count) && off + 2 <= len; ++i) {
+        uint16_t be_len;
+        std::memcpy(&be_len, packet + off, 2);
+        tags.push_back(packet[off + 2]);
+        off += 2 + betoh16(be_len);
+    }
+    EXPECT_EQ(off, len);
+    return tags;
+}
+
+TEST(RetransmitRing, ServesStoredRangesAcrossPackets) {
+    RetransmitRing ring(4);
+    sendMessages(ring, 40);  // ten packets; the last four (25..40) are kept
+    EXPECT_EQ(ring.firstSequence(), 25u);
+    EXPECT_EQ(ring.nextSequence(), 41u);
+
+    uint8_t out[kMoldUDP64MaxPayload];
+    size_t len = ring.buildResponse(30, 3, out);
+    ASSERT_GT(len, 0u);
+    MoldUDP64Header hdr;
+    std::memcpy(&hdr, out, kMoldUDP64HeaderSize);
+    EXPECT_EQ(std::string(hdr.session, 10), "REXMIT    ");
+    EXPECT_EQ(betoh64(hdr.sequence_number), 30u);
+    EXPECT_EQ(messageTags(out, len), (std::vector<int>{30, 31, 32}));
+
+    // Spans two stored packets, capped at one packet's worth.
+    len = ring.buildResponse(27, 100, out);
+    EXPECT_EQ(messageTags(out, len), (std::vector<int>{27, 28, 29, 30}));
+
+    EXPECT_EQ(ring.buildResponse(24, 1, out), 0u) << "evicted";
+    EXPECT_EQ(ring.buildResponse(41, 1, out), 0u) << "not sent yet";
+    EXPECT_EQ(ring.buildResponse(30, 0, out), 0u);
+}
+
+TEST(RetransmitServer, AnswersRequestsOverLoopback) {
+#ifdef _WIN32
+    WSADATA wsa;
+    WSAStartup(MAKEWORD(2, 2), &wsa);
+#endif
+    RetransmitRing ring(16);
+    sendMessages(ring, 20);
+    RetransmitServer server(ring, 0);
+    server.start();
+
+    socket_t client = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+#ifdef _WIN32
+    DWORD timeout_ms = 2000;
+    setsockopt(client, SOL_SOCKET, SO_RCVTIMEO,
+               reinterpret_cast<const char*>(&timeout_ms), sizeof(timeout_ms));
+#else
+    struct timeval tv { 2, 0 };
+    setsockopt(client, SOL_SOCKET, SO_RCVTIMEO,
+               reinterpret_cast<const char*>(&tv), sizeof(tv));
+#endif
+    struct sockaddr_in dest{};
+    dest.sin_family = AF_INET;
+    dest.sin_port = htons(server.port());
+    dest.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    MoldUDP64Header req{};
+    std::memcpy(req.session, "REXMIT    ", 10);
+    req.sequence_number = htobe64(18);
+    req.message_count = htobe16(2);
+    sendto(client, reinterpret_cast<const char*>(&req), static_cast<int>(sizeof(req)), 0,
+           reinterpret_cast<const struct sockaddr*>(&dest), sizeof(dest));
+
+    uint8_t buf[2048];
+    auto n = recv(client, reinterpret_cast<char*>(buf), sizeof(buf), 0);
+    ASSERT_GT(n, static_cast<decltype(n)>(kMoldUDP64HeaderSize));
+    MoldUDP64Header hdr;
+    std::memcpy(&hdr, buf, kMoldUDP64HeaderSize);
+    EXPECT_EQ(betoh64(hdr.sequence_number), 18u);
+    EXPECT_EQ(messageTags(buf, static_cast<size_t>(n)), (std::vector<int>{18, 19}));
+
+    server.stop();
+    EXPECT_EQ(server.requestsServed(), 1u);
+    close_sock(client);
+#ifdef _WIN32
+    WSACleanup();
+#endif
+}
+
+}  // namespace test
+}  // namespace itch
+}  // namespace qrsdp
@@ -0,0 +1,138 @@
+#include <gtest/gtest.h>
+#include "itch/partition_merge.h"
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace qrsdp {
+namespace itch {
+namespace test {
+
+static int g_released = 0;
+
+static void countRelease(void*) { ++g_released; }
+
+/// Records with the given timestamps, kept alive for the merge to point into.
+struct Message {
+    explicit Message(const std::vector<uint64_t>& ts) : records(ts.size()) {
+        for (size_t i = 0; i < ts.size(); ++i) {
+            records[i].ts_ns = ts[i];
+            records[i].order_id = ts[i];
+        }
+    }
+
+    PartitionBatch batch(const char* key) {
+        PartitionBatch b;
+        b.key = key;
+        b.key_len = std::char_traits<char>::length(key);
+        b.records = records.data();
+        b.count = records.size();
+        b.handle = this;
+        return b;
+    }
+
+    std::vector<DiskEventRecord> records;
+};
+
+static std::vector<uint64_t> drain(PartitionMerge& merge, std::string* keys = nullptr) {
+    std::vector<uint64_t> out;
+    MergedRecord m;
+    while (merge.next(m)) {
+        out.push_back(m.record->ts_ns);
+        if (keys)
+            keys->append(m.key, m.key_len);
+    }
+    return out;
+}
+
+TEST(PartitionMerge, MergesInputsInTimestampOrder) {
+    g_released = 0;
+    Message a1({10, 30}), a2({50}), b1({20, 40, 60});
+    {
+        PartitionMerge merge(2, 8, std::chrono::microseconds(0), 1000, countRelease);
+        ASSERT_TRUE(merge.push(0, a1.batch("A")));
+        ASSERT_TRUE(merge.push(0, a2.batch("A")));
+        ASSERT_TRUE(merge.push(1, b1.batch("B")));
+        std::string keys;
+        EXPECT_EQ(drain(merge, &keys), (std::vector<uint64_t>{10, 20, 30, 40, 50, 60}));
+        EXPECT_EQ(keys, "ABABAB");
+        EXPECT_EQ(g_released, 3);
+    }
+    EXPECT_EQ(g_released, 3) << "each batch released once";
+}
+
+TEST(PartitionMerge, WaitsForAnEmptyInputUntilItIsIdle) {
+    Message a({10, 20});
+    PartitionMerge merge(2, 8, std::chrono::milliseconds(20), 1000, nullptr);
+    ASSERT_TRUE(merge.push(0, a.batch("A")));
+    MergedRecord m;
+    EXPECT_FALSE(merge.next(m)) << "input 1 may still bring something earlier";
+    std::this_thread::sleep_for(std::chrono::milliseconds(30));
+    EXPECT_EQ(drain(merge), (std::vector<uint64_t>{10, 20}));
+
+    Message b({5});
+    ASSERT_TRUE(merge.push(1, b.batch("B")));
+    EXPECT_FALSE(merge.next(m)) << "now input 0 has run dry";
+    std::this_thread::sleep_for(std::chrono::milliseconds(30));
+    EXPECT_EQ(drain(merge), (std::vector<uint64_t>{5})) << "a late record still goes out";
+}
+
+TEST(PartitionMerge, KeepsDaysApart) {
+    // Input 0 rolls over to day two while input 1 is still finishing day one.
+    Message a({100, 200, 5, 15}), b({150, 250, 300, 10});
+    PartitionMerge merge(2, 8, std::chrono::microseconds(0), 50, nullptr);
+    ASSERT_TRUE(merge.push(0, a.batch("A")));
+    ASSERT_TRUE(merge.push(1, b.batch("B")));
+    EXPECT_EQ(drain(merge), (std::vector<uint64_t>{100, 150, 200, 250, 300, 5, 10, 15}));
+}
+
+TEST(PartitionMerge, ConcurrentReadersDeliverEverything) {
+    constexpr size_t kInputs = 4;
+    constexpr uint64_t kPerInput = 2000;
+    std::vector<std::vector<Message>> messages(kInputs);
+    for (size_t i = 0; i < kInputs; ++i) {
+        messages[i].reserve(kPerInput / 4);
+        for (uint64_t j = 0; j < kPerInput; j += 4) {
+            const uint64_t t = j * kInputs + i;
+            messages[i].emplace_back(std::vector<uint64_t>{t, t + kInputs, t + 2 * kInputs,
+                                                           t + 3 * kInputs});
+        }
+    }
+    PartitionMerge merge(kInputs, 4, std::chrono::milliseconds(500), 1000000, nullptr);
+    std::vector<std::thread> readers;
+    for (size_t i = 0; i < kInputs; ++i) {
+        readers.emplace_back([&, i] {
+            for (Message& msg : messages[i])
+                ASSERT_TRUE(merge.push(i, msg.batch("X")));
+        });
+    }
+    std::vector<uint64_t> got;
+    MergedRecord m;
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (got.size() < kInputs * kPerInput && std::chrono::steady_clock::now() < deadline) {
+        if (merge.next(m))
+            got.push_back(m.record->ts_ns);
+    }
+    for (auto& t : readers)
+        t.join();
+    ASSERT_EQ(got.size(), kInputs * kPerInput);
+    for (size_t i = 1; i < got.size(); ++i)
+        ASSERT_LT(got[i - 1], got[i]) << "at " << i;
+}
+
+TEST(PartitionMerge, StopUnblocksAFullQueue) {
+    Message a({1}), b({2});
+    PartitionMerge merge(1, 1, std::chrono::microseconds(0), 1000, nullptr);
+    ASSERT_TRUE(merge.push(0, a.batch("A")));
+    std::thread reader([&] { EXPECT_FALSE(merge.push(0, b.batch("A"))); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    merge.stop();
+    reader.join();
+}
+
+}  // namespace test
+}  // namespace itch
+}  // namespace qrsdp
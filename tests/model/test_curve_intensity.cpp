@@ -2,9 +2,16 @@
 #include "model/intensity_curve.h"
 #include "model/hlr_params.h"
 #include "model/curve_intensity_model.h"
+#include "model/hlr_curve_table.h"
+#include "model/hlr_params_channel.h"
+#include "model/hlr_params_watcher.h"
 #include "core/records.h"
 #include "core/event_types.h"
+#include <chrono>
 #include <cmath>
+#include <cstdio>
+#include <string>
+#include <thread>
 #include <vector>
 
 namespace qrsdp {
@@ -53,6 +60,34 @@ TEST(HLRParams, DefaultStarterCurves) {
 }
 
 // --- CurveIntensityModel ---
+TEST(HLRCurveTable, MatchesCurvesIncludingTails) {
+    HLRParams p = makeDefaultHLRParams(4, 20);
+    // Mixed table lengths and tail rules; one level with no cancel curves at all.
+    p.lambda_L_bid[1].setTable({1.0, 2.0, 3.0}, IntensityCurve::TailRule::ZERO);
+    p.lambda_C_ask[2].setTable({0.5, 0.25}, IntensityCurve::TailRule::FLAT);
+    p.lambda_M_sell.setTable(std::vector<double>(40, 0.7), IntensityCurve::TailRule::ZERO);
+    p.lambda_C_bid.resize(3);
+    const HLRCurveTable table(p);
+    EXPECT_EQ(table.rowLength(), 41u);
+    for (size_t i = 0; i < 5; ++i) {
+        for (size_t n = 0; n < 60; ++n) {
+            const auto value = [&](const std::vector<IntensityCurve>& c) {
+                return i < c.size() && i < 4 ? c[i].value(n) : 0.0;
+            };
+            const HLRCurveTable::Rates bid = table.levelRates(i, Side::BID, n);
+            const HLRCurveTable::Rates ask = table.levelRates(i, Side::ASK, n);
+            EXPECT_EQ(bid.add, value(p.lambda_L_bid)) << "level " << i << " n " << n;
+            EXPECT_EQ(bid.cancel, value(p.lambda_C_bid)) << "level " << i << " n " << n;
+            EXPECT_EQ(ask.add, value(p.lambda_L_ask)) << "level " << i << " n " << n;
+            EXPECT_EQ(ask.cancel, value(p.lambda_C_ask)) << "level " << i << " n " << n;
+        }
+    }
+    for (size_t n = 0; n < 60; ++n) {
+        EXPECT_EQ(table.marketBuy(n), p.lambda_M_buy.value(n));
+        EXPECT_EQ(table.marketSell(n), p.lambda_M_sell.value(n));
+    }
+}
+
 TEST(CurveIntensityModel, ComputeWithDepthsReturnsPositiveTotal) {
     HLRParams p = makeDefaultHLRParams(2, 10);
     CurveIntensityModel model(p);
@@ -99,5 +134,197 @@ TEST(CurveIntensityModel, DecodePerLevelIndex) {
     EXPECT_EQ(lev, 0u);
 }
 
+/// Drives update() with random one-level changes and compares each result with
+/// compute() on the same state: exactly in EXACT mode, to 1e-9 in RUNNING mode.
+static void checkIncrementalAgainstCompute(CurveIntensityModel::TotalsMode mode, int steps) {
+    HLRParams p = makeDefaultHLRParams(10, 100);
+    CurveIntensityModel incremental(p);
+    incremental.setTotalsMode(mode);
+    CurveIntensityModel full(p);
+    const bool exact = mode == CurveIntensityModel::TotalsMode::EXACT;
+
+    BookState state;
+    state.features = BookFeatures{9999, 10001, 5, 5, 2, 0.0};
+    state.bid_depths.assign(10, 5);
+    state.ask_depths.assign(10, 5);
+    incremental.compute(state);
+
+    uint32_t lcg = 12345;
+    for (int step = 0; step < steps; ++step) {
+        lcg = lcg * 1664525u + 1013904223u;
+        const bool bid = (lcg >> 31) != 0;
+        const uint32_t level = (lcg >> 16) % 10;
+        auto& depths = bid ? state.bid_depths : state.ask_depths;
+        depths[level] = (lcg >> 8) % 40;
+        state.features.q_bid_best = state.bid_depths[0];
+        state.features.q_ask_best = state.ask_depths[0];
+
+        const Intensities a = incremental.update(state, BookDelta{false, bid ? Side::BID : Side::ASK, level});
+        const Intensities b = full.compute(state);
+        if (exact) {
+            // The totals feed the sampler: an ulp moves a ts_ns.
+            ASSERT_EQ(a.add_bid, b.add_bid) << "step " << step;
+            ASSERT_EQ(a.add_ask, b.add_ask) << "step " << step;
+            ASSERT_EQ(a.cancel_bid, b.cancel_bid) << "step " << step;
+            ASSERT_EQ(a.cancel_ask, b.cancel_ask) << "step " << step;
+        } else {
+            ASSERT_NEAR(a.add_bid, b.add_bid, 1e-9) << "step " << step;
+            ASSERT_NEAR(a.add_ask, b.add_ask, 1e-9) << "step " << step;
+            ASSERT_NEAR(a.cancel_bid, b.cancel_bid, 1e-9) << "step " << step;
+            ASSERT_NEAR(a.cancel_ask, b.cancel_ask, 1e-9) << "step " << step;
+        }
+        ASSERT_EQ(a.exec_buy, b.exec_buy) << "step " << step;
+        ASSERT_EQ(a.exec_sell, b.exec_sell) << "step " << step;
+
+        std::vector<double> wa, wb;
+        incremental.getPerLevelIntensities(wa);
+        full.getPerLevelIntensities(wb);
+        ASSERT_EQ(wa, wb) << "per-level weights are recomputed exactly, step " << step;
+    }
+}
+
+TEST(CurveIntensityModel, ExactUpdateMatchesFullComputeBitForBit) {
+    // Long enough that running totals would have drifted by an ulp many times over.
+    EXPECT_EQ(CurveIntensityModel(makeDefaultHLRParams(2, 10)).totalsMode(),
+              CurveIntensityModel::TotalsMode::EXACT);
+    checkIncrementalAgainstCompute(CurveIntensityModel::TotalsMode::EXACT, 50000);
+}
+
+TEST(CurveIntensityModel, RunningUpdateStaysCloseToFullCompute) {
+    checkIncrementalAgainstCompute(CurveIntensityModel::TotalsMode::RUNNING, 5000);
+}
+
+TEST(CurveIntensityModel, UpdateFallsBackOnSpreadChange) {
+    HLRParams p = makeDefaultHLRParams(3, 50);
+    CurveIntensityModel incremental(p);
+    CurveIntensityModel full(p);
+
+    BookState state;
+    state.features = BookFeatures{9999, 10001, 4, 4, 2, 0.0};
+    state.bid_depths = {4, 4, 4};
+    state.ask_depths = {4, 4, 4};
+    incremental.compute(state);
+
+    // A single-level delta with a different spread must not reuse stale multipliers.
+    state.features.spread_ticks = 3;
+    state.bid_depths[1] = 7;
+    const Intensities a = incremental.update(state, BookDelta{false, Side::BID, 1});
+    const Intensities b = full.compute(state);
+    EXPECT_DOUBLE_EQ(a.add_bid, b.add_bid);
+    EXPECT_DOUBLE_EQ(a.exec_buy, b.exec_buy);
+}
+
+TEST(CurveIntensityModel, FollowsParamsPublishedOnAChannel) {
+    HLRParams p = makeDefaultHLRParams(3, 50);
+    HLRParams doubled = p;
+    doubled.lambda_M_buy.setTable(std::vector<double>(51, 2.0 * p.lambda_M_buy.value(4)));
+    HLRParamsChannel channel;
+    CurveIntensityModel model(p);
+    model.followParams(&channel);
+    CurveIntensityModel reference(doubled);
+
+    BookState state;
+    state.features = BookFeatures{9999, 10001, 4, 4, 2, 0.0};
+    state.bid_depths = {4, 4, 4};
+    state.ask_depths = {4, 4, 4};
+    model.compute(state);
+    EXPECT_EQ(model.paramSwaps(), 0u);
+
+    channel.publish(makeDefaultHLRParams(2, 50));  // wrong K: skipped
+    state.bid_depths[1] = 5;
+    model.update(state, BookDelta{false, Side::BID, 1});
+    EXPECT_EQ(model.paramSwaps(), 0u);
+
+    channel.publish(doubled);
+    state.bid_depths[1] = 6;
+    const Intensities after = model.update(state, BookDelta{false, Side::BID, 1});
+    EXPECT_EQ(model.paramSwaps(), 1u);
+    const Intensities expected = reference.compute(state);
+    EXPECT_DOUBLE_EQ(after.exec_buy, expected.exec_buy);
+    EXPECT_DOUBLE_EQ(after.add_bid, expected.add_bid);
+    EXPECT_EQ(model.curves().marketBuy(0), doubled.lambda_M_buy.value(0));
+}
+
+TEST(CurveIntensityModel, ModelsOverOneTableShareItsRows) {
+    const HLRParams p = makeDefaultHLRParams(3, 40);
+    const HLRCurveTable table(p);
+    CurveIntensityModel a(table, p.spread_sensitivity, p.imbalance_sensitivity);
+    CurveIntensityModel b(table, p.spread_sensitivity, p.imbalance_sensitivity);
+    CurveIntensityModel own(p);
+    EXPECT_EQ(a.curves().rowData(), table.rowData());
+    EXPECT_EQ(b.curves().rowData(), table.rowData());
+    EXPECT_NE(own.curves().rowData(), table.rowData());
+
+    BookState state;
+    state.features = BookFeatures{9999, 10002, 3, 6, 3, 0.0};
+    state.bid_depths = {3, 0, 12};
+    state.ask_depths = {6, 41, 1};
+    const Intensities x = a.compute(state);
+    const Intensities y = own.compute(state);
+    EXPECT_EQ(x.add_bid, y.add_bid);
+    EXPECT_EQ(x.add_ask, y.add_ask);
+    EXPECT_EQ(x.cancel_bid, y.cancel_bid);
+    EXPECT_EQ(x.cancel_ask, y.cancel_ask);
+    EXPECT_EQ(x.exec_buy, y.exec_buy);
+    EXPECT_EQ(x.exec_sell, y.exec_sell);
+}
+
+TEST(CurveIntensityModel, FollowersAdoptTheChannelsOneTable) {
+    const HLRParams p = makeDefaultHLRParams(3, 20);
+    const HLRModelCurves shared(p);
+    HLRParamsChannel channel;
+    CurveIntensityModel a(shared);
+    CurveIntensityModel b(shared);
+    EXPECT_EQ(a.curves().rowData(), b.curves().rowData());
+    a.followParams(&channel);
+    b.followParams(&channel);
+
+    HLRParams next = p;
+    next.spread_sensitivity = 0.9;
+    channel.publish(next);
+    BookState state;
+    state.features = BookFeatures{9999, 10001, 4, 4, 2, 0.0};
+    state.bid_depths = {4, 4, 4};
+    state.ask_depths = {4, 4, 4};
+    a.compute(state);
+    b.compute(state);
+    ASSERT_EQ(a.paramSwaps(), 1u);
+    ASSERT_EQ(b.paramSwaps(), 1u);
+    EXPECT_EQ(a.curves().rowData(), channel.latestCurves()->table.rowData());
+    EXPECT_EQ(b.curves().rowData(), a.curves().rowData());
+}
+
+TEST(HLRParamsWatcher, PublishesTheFileAndEachChange) {
+    const std::string path = testing::TempDir() + "test_hlr_watch.json";
+    std::remove(path.c_str());
+    HLRParamsChannel channel;
+    HLRParamsWatcher watcher(path, channel, 5);
+    EXPECT_FALSE(watcher.start()) << "no file yet";
+    EXPECT_EQ(channel.version(), 0u);
+
+    HLRParams p = makeDefaultHLRParams(2, 10);
+    const std::string tmp = path + ".tmp";
+    ASSERT_TRUE(saveHLRParamsToJson(tmp, p));
+    ASSERT_EQ(std::rename(tmp.c_str(), path.c_str()), 0);
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (channel.version() == 0 && std::chrono::steady_clock::now() < deadline)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    ASSERT_EQ(channel.version(), 1u);
+    EXPECT_EQ(channel.latest()->K, 2);
+
+    p.spread_sensitivity = 0.75;
+    ASSERT_TRUE(saveHLRParamsToJson(tmp, p));
+    // Make the change visible even on a coarse-mtime filesystem.
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    ASSERT_EQ(std::rename(tmp.c_str(), path.c_str()), 0);
+    while (channel.version() == 1 && std::chrono::steady_clock::now() < deadline)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    watcher.stop();
+    ASSERT_EQ(channel.version(), 2u);
+    EXPECT_DOUBLE_EQ(channel.latest()->spread_sensitivity, 0.75);
+    EXPECT_EQ(watcher.reloads(), 2u);
+    std::remove(path.c_str());
+}
+
 }  // namespace test
 }  // namespace qrsdp
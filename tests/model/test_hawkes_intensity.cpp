@@ -0,0 +1,189 @@
+#include <gtest/gtest.h>
+#include "model/hawkes_intensity_model.h"
+#include "model/hawkes_params.h"
+#include "model/simple_imbalance_intensity.h"
+#include "core/records.h"
+#include "core/event_types.h"
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace qrsdp {
+namespace test {
+
+static size_t idx(EventType t) { return static_cast<size_t>(t); }
+
+static const IntensityParams kParams{20.0, 0.1, 5.0, 1.0, 1.0, 0.05, 0.0};
+
+static BookState makeState(uint32_t q_bid, uint32_t q_ask) {
+    BookState s;
+    s.features.best_bid_ticks = 9999;
+    s.features.best_ask_ticks = 10001;
+    s.features.q_bid_best = q_bid;
+    s.features.q_ask_best = q_ask;
+    s.features.spread_ticks = 2;
+    s.features.imbalance = (static_cast<double>(q_bid) - q_ask) / (q_bid + q_ask);
+    s.bid_depths = {q_bid, 5, 5};
+    s.ask_depths = {q_ask, 5, 5};
+    return s;
+}
+
+TEST(HawkesParams, DefaultsAreStationary) {
+    const HawkesParams p = makeDefaultHawkesParams();
+    ASSERT_EQ(p.kernels.size(), 2u);
+    const double rho = hawkesBranchingRatio(p);
+    EXPECT_GT(rho, 0.3);
+    EXPECT_LT(rho, 0.6);
+    EXPECT_NO_THROW(validateHawkesParams(p));
+}
+
+TEST(HawkesParams, BranchingRatioIsTheSpectralRadius) {
+    HawkesParams p;
+    HawkesKernel k;
+    k.beta = 2.0;
+    // G = [[0.2, 0.3], [0.3, 0.2]] on (ADD_BID, ADD_ASK): eigenvalues 0.5 and -0.1.
+    k.alpha[0][0] = 0.4;
+    k.alpha[0][1] = 0.6;
+    k.alpha[1][0] = 0.6;
+    k.alpha[1][1] = 0.4;
+    p.kernels = {k};
+    EXPECT_NEAR(hawkesBranchingRatio(p), 0.5, 1e-9);
+    p.kernels.push_back(k);  // doubles every entry
+    EXPECT_NEAR(hawkesBranchingRatio(p), 1.0, 1e-9);
+    EXPECT_THROW(validateHawkesParams(p), std::invalid_argument);
+}
+
+TEST(HawkesParams, ValidationRejectsBadKernels) {
+    HawkesParams p = makeDefaultHawkesParams();
+    p.kernels[0].beta = 0.0;
+    EXPECT_THROW(HawkesIntensityModel{p}, std::invalid_argument);
+    p = makeDefaultHawkesParams();
+    p.kernels[1].alpha[0][3] = -0.1;
+    EXPECT_THROW(HawkesIntensityModel{p}, std::invalid_argument);
+    p = makeDefaultHawkesParams();
+    p.mu[2] = std::nan("");
+    EXPECT_THROW(HawkesIntensityModel{p}, std::invalid_argument);
+}
+
+TEST(HawkesParams, JsonRoundTrip) {
+    HawkesParams p = makeDefaultHawkesParams();
+    p.mu = {1.0, 2.0, 0.5, 0.25, 3.0, 1e-3};
+    p.kernels[1].alpha[2][5] = 0.123456789012345;
+    const std::string path = "test_hawkes_params.json";
+    ASSERT_TRUE(saveHawkesParamsToJson(path, p));
+    HawkesParams q;
+    ASSERT_TRUE(loadHawkesParamsFromJson(path, q));
+    std::remove(path.c_str());
+    EXPECT_EQ(q.mu, p.mu);
+    ASSERT_EQ(q.kernels.size(), p.kernels.size());
+    for (size_t k = 0; k < p.kernels.size(); ++k) {
+        EXPECT_EQ(q.kernels[k].beta, p.kernels[k].beta);
+        EXPECT_EQ(q.kernels[k].alpha, p.kernels[k].alpha);
+    }
+    EXPECT_FALSE(loadHawkesParamsFromJson("does_not_exist.json", q));
+    EXPECT_EQ(q.baseline, HawkesBaseline::BOOK);
+
+    // A fitted file runs on its own mu; files written before the key load as "book".
+    p.baseline = HawkesBaseline::MU;
+    ASSERT_TRUE(saveHawkesParamsToJson(path, p));
+    ASSERT_TRUE(loadHawkesParamsFromJson(path, q));
+    EXPECT_EQ(q.baseline, HawkesBaseline::MU);
+    {
+        std::ofstream out(path);
+        out << "{\"mu\": [1, 1, 1, 1, 1, 1], \"beta\": []}";
+    }
+    ASSERT_TRUE(loadHawkesParamsFromJson(path, q));
+    EXPECT_EQ(q.baseline, HawkesBaseline::BOOK);
+    {
+        std::ofstream out(path);
+        out << "{\"baseline\": \"fitted\", \"mu\": [1, 1, 1, 1, 1, 1], \"beta\": []}";
+    }
+    EXPECT_FALSE(loadHawkesParamsFromJson(path, q));
+    std::remove(path.c_str());
+
+    // A mu baseline of all zeros would never start an event.
+    HawkesParams silent = makeDefaultHawkesParams();
+    silent.baseline = HawkesBaseline::MU;
+    EXPECT_THROW(validateHawkesParams(silent), std::invalid_argument);
+}
+
+TEST(HawkesIntensityModel, RecursionMatchesTheKernelSum) {
+    HawkesParams p = makeDefaultHawkesParams();
+    p.mu = {1.0, 1.0, 0.5, 0.5, 2.0, 2.0};
+    HawkesIntensityModel model(p);
+    model.resetHistory(0.0);
+    std::mt19937_64 gen(7);
+    std::exponential_distribution<double> gap(30.0);
+    std::uniform_int_distribution<int> pick(0, kNumEventTypes - 1);
+    std::vector<std::pair<double, EventType>> history;
+    const BookState state = makeState(5, 5);
+    double t = 0.0;
+    for (int n = 0; n < 400; ++n) {
+        t += gap(gen);
+        model.advanceTo(t);
+        const Intensities got = model.compute(state);
+        for (int i = 0; i < kNumEventTypes; ++i) {
+            double expected = p.mu[static_cast<size_t>(i)];
+            for (const auto& [tm, type] : history)
+                for (const HawkesKernel& k : p.kernels)
+                    expected += k.alpha[static_cast<size_t>(i)][idx(type)] * std::exp(-k.beta * (t - tm));
+            ASSERT_NEAR(got.at(static_cast<EventType>(i)), expected, 1e-9 * expected)
+                << "event " << n << " type " << i;
+        }
+        const EventType type = static_cast<EventType>(pick(gen));
+        model.onEvent(type);
+        history.emplace_back(t, type);
+    }
+}
+
+TEST(HawkesIntensityModel, TotalDecaysFromTheClockValue) {
+    HawkesIntensityModel model(makeDefaultHawkesParams(),
+                               std::make_shared<const SimpleImbalanceIntensity>(kParams));
+    model.resetHistory(1.0);
+    const BookState state = makeState(4, 6);
+    const double base = model.compute(state).total();
+    EXPECT_DOUBLE_EQ(model.totalAt(1.0), base) << "nothing to excite yet";
+    model.onEvent(EventType::EXECUTE_BUY);
+    model.onEvent(EventType::EXECUTE_BUY);
+    const double at_clock = model.update(state, BookDelta{false, Side::NA, 0}).total();
+    EXPECT_NEAR(model.totalAt(1.0), at_clock, 1e-12);
+    EXPECT_GT(model.excitation(EventType::EXECUTE_BUY), 0.0);
+    EXPECT_GT(model.excitation(EventType::ADD_ASK), 0.0) << "executions refill the side they hit";
+    EXPECT_EQ(model.excitation(EventType::CANCEL_BID), 0.0);
+    double prev = model.totalAt(1.0);
+    for (double t = 1.001; t < 20.0; t *= 1.3) {
+        const double now = model.totalAt(t);
+        EXPECT_LE(now, prev) << "t=" << t;
+        EXPECT_GE(now, base);
+        prev = now;
+    }
+    EXPECT_NEAR(model.totalAt(1e4), base, 1e-9);
+    model.advanceTo(1e4);
+    EXPECT_EQ(model.excitation(EventType::EXECUTE_BUY), 0.0) << "decayed excitation is dropped";
+    model.resetHistory(0.0);
+    EXPECT_EQ(model.clock(), 0.0);
+}
+
+TEST(HawkesIntensityModel, BaselineFollowsTheBook) {
+    auto simple = std::make_shared<const SimpleImbalanceIntensity>(kParams);
+    HawkesIntensityModel model(makeDefaultHawkesParams(), simple);
+    model.resetHistory(0.0);
+    const BookState a = makeState(2, 8);
+    const BookState b = makeState(8, 2);
+    const Intensities ia = model.compute(a);
+    const Intensities sa = simple->compute(a);
+    EXPECT_EQ(ia.total(), sa.total()) << "no history: the baseline itself";
+    const Intensities ib = model.update(b, BookDelta{});
+    EXPECT_EQ(ib.exec_sell, simple->compute(b).exec_sell);
+    // A delta that changed nothing keeps the last baseline.
+    EXPECT_EQ(model.update(a, BookDelta{false, Side::NA, 0}).exec_sell, ib.exec_sell);
+}
+
+}  // namespace test
+}  // namespace qrsdp
@@ -1,7 +1,13 @@
 #include <gtest/gtest.h>
 #include "model/simple_imbalance_intensity.h"
+#include "model/spread_feedback.h"
+#include "model/seasonality_profile.h"
 #include "core/records.h"
 #include <cmath>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <vector>
 
 namespace qrsdp {
 namespace test {
@@ -77,5 +83,90 @@ TEST(QrsdpIntensity, InterfaceComputeBookState) {
     EXPECT_DOUBLE_EQ(i.add_bid, i.add_ask);
 }
 
+TEST(QrsdpIntensity, SpreadFeedbackTableMatchesExp) {
+    for (double sS : {0.4, 1.3}) {
+        const SpreadFeedback table(sS);
+        for (int spread = -3; spread < SpreadFeedback::kTabulatedSpreads + 10; ++spread) {
+            const double delta = static_cast<double>(spread) - 2.0;
+            const SpreadFeedback::Multipliers m = table.at(spread);
+            EXPECT_EQ(m.add, std::exp(sS * delta)) << "sS=" << sS << " spread=" << spread;
+            EXPECT_EQ(m.exec, std::exp(-sS * delta)) << "sS=" << sS << " spread=" << spread;
+        }
+    }
+    const SpreadFeedback off(0.0);
+    EXPECT_EQ(off.at(7).add, 1.0);
+    EXPECT_EQ(off.at(7).exec, 1.0);
+}
+
+TEST(QrsdpIntensity, BatchMatchesComputePerBook) {
+    IntensityParams p{22.0, 0.2, 30.0, 1.3, 0.8, 0.5, 0.3};
+    SimpleImbalanceIntensity model(p);
+
+    // 150 books: more than one block, with a partial last one.
+    const size_t m = 150;
+    std::mt19937 gen(7);
+    std::uniform_real_distribution<double> imb(-1.2, 1.2);
+    std::vector<double> imbalance(m);
+    std::vector<int> spread(m);
+    std::vector<uint32_t> q_bid(m), q_ask(m);
+    std::vector<uint64_t> bid_total(m), ask_total(m);
+    std::vector<BookState> states(m);
+    for (size_t i = 0; i < m; ++i) {
+        imbalance[i] = i % 17 == 3 ? std::numeric_limits<double>::quiet_NaN() : imb(gen);
+        spread[i] = i % 23 == 5 ? 80 : (i % 29 == 7 ? -1 : static_cast<int>(gen() % 8));
+        q_bid[i] = gen() % 40;
+        q_ask[i] = gen() % 40;
+        BookState& st = states[i];
+        st.features = BookFeatures{9999, 10001, q_bid[i], q_ask[i], spread[i], imbalance[i]};
+        if (i % 5 != 0) {  // every fifth book has no depths: totals fall back to the touch
+            for (int k = 0; k < 4; ++k) {
+                st.bid_depths.push_back(gen() % 30);
+                st.ask_depths.push_back(gen() % 30);
+            }
+        }
+        for (uint32_t d : st.bid_depths) bid_total[i] += d;
+        for (uint32_t d : st.ask_depths) ask_total[i] += d;
+    }
+
+    BookFeatureBatch books;
+    books.count = m;
+    books.imbalance = imbalance.data();
+    books.spread_ticks = spread.data();
+    books.q_bid_best = q_bid.data();
+    books.q_ask_best = q_ask.data();
+    books.total_bid_depth = bid_total.data();
+    books.total_ask_depth = ask_total.data();
+    std::vector<double> add_bid(m), add_ask(m), cancel_bid(m), cancel_ask(m), exec_buy(m), exec_sell(m);
+    IntensityBatch out{add_bid.data(), add_ask.data(), cancel_bid.data(), cancel_ask.data(),
+                       exec_buy.data(), exec_sell.data()};
+    ASSERT_TRUE(model.computeBatch(books, out));
+
+    for (size_t i = 0; i < m; ++i) {
+        const Intensities want = model.compute(states[i]);
+        EXPECT_EQ(add_bid[i], want.add_bid) << i;
+        EXPECT_EQ(add_ask[i], want.add_ask) << i;
+        EXPECT_EQ(cancel_bid[i], want.cancel_bid) << i;
+        EXPECT_EQ(cancel_ask[i], want.cancel_ask) << i;
+        EXPECT_EQ(exec_buy[i], want.exec_buy) << i;
+        EXPECT_EQ(exec_sell[i], want.exec_sell) << i;
+    }
+}
+
+TEST(SeasonalityProfile, BucketsAndBounds) {
+    const SeasonalityProfile p(100.0, {3.0, 1.0, -2.0, 2.0});
+    EXPECT_EQ(p.multiplier(2), 0.0) << "negative multipliers clamp to zero";
+    EXPECT_EQ(p.bucketAt(0.0), 0u);
+    EXPECT_EQ(p.bucketAt(99.9), 0u);
+    EXPECT_EQ(p.bucketAt(100.0), 1u);
+    EXPECT_EQ(p.bucketAt(1e6), 3u) << "past the end uses the last bucket";
+    EXPECT_EQ(p.bucketEnd(1), 200.0);
+    EXPECT_TRUE(std::isinf(p.bucketEnd(3)));
+    EXPECT_EQ(p.at(150.0), 1.0);
+    EXPECT_EQ(p.bound(100.0, 200.0), 1.0) << "window ending on a boundary";
+    EXPECT_EQ(p.bound(150.0, 350.0), 2.0);
+    EXPECT_EQ(p.bound(50.0, 120.0), 3.0);
+    EXPECT_EQ(SeasonalityProfile{}.at(10.0), 1.0);
+}
+
 }  // namespace test
 }  // namespace qrsdp
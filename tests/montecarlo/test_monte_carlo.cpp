@@ -0,0 +1,201 @@
+#include <gtest/gtest.h>
+#include "montecarlo/monte_carlo.h"
+#include "producer/qrsdp_producer.h"
+#include "io/in_memory_sink.h"
+#include "book/multi_level_book.h"
+#include "model/simple_imbalance_intensity.h"
+#include "rng/mt19937_rng.h"
+#include "sampler/competing_intensity_sampler.h"
+#include "sampler/unit_size_attribute_sampler.h"
+#include "core/records.h"
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+namespace qrsdp {
+namespace test {
+
+static MonteCarloConfig smallConfig(uint64_t paths, uint32_t seconds = 30) {
+    MonteCarloConfig config;
+    config.seed = 7;
+    config.paths = paths;
+    config.session_seconds = seconds;
+    return config;
+}
+
+/// Per-path statistics compared between the engines: mean and variance over paths.
+struct PathStats {
+    double n = 0.0;
+    double events = 0.0, events_sq = 0.0;
+    double ret_sq = 0.0;    // (close - open)^2
+    double range = 0.0;     // high - low
+    double types[kNumEventTypes] = {};
+    double total_events = 0.0;
+
+    void add(const PathSummary& p) {
+        const double e = static_cast<double>(p.events);
+        const double r = static_cast<double>(p.close_ticks - p.open_ticks);
+        n += 1.0;
+        events += e;
+        events_sq += e * e;
+        ret_sq += r * r;
+        range += static_cast<double>(p.high_ticks - p.low_ticks);
+        for (int t = 0; t < kNumEventTypes; ++t) types[t] += static_cast<double>(p.type_counts[t]);
+        total_events += e;
+    }
+    double meanEvents() const { return events / n; }
+    double varEvents() const { return events_sq / n - meanEvents() * meanEvents(); }
+    double share(int t) const { return types[t] / total_events; }
+};
+
+/// The producer's session for the Monte Carlo config: same book, intensities and
+/// attribute sampler settings (SessionRunner's UnitSizeAttributeSampler(0.5, 0.5)).
+static PathSummary producerPath(const MonteCarloConfig& config, uint64_t seed) {
+    TradingSession session{};
+    session.seed = seed;
+    session.p0_ticks = config.p0_ticks;
+    session.session_seconds = config.session_seconds;
+    session.levels_per_side = config.levels_per_side;
+    session.tick_size = 100;
+    session.initial_spread_ticks = config.initial_spread_ticks;
+    session.initial_depth = config.initial_depth;
+    session.intensity_params = config.intensity;
+
+    Mt19937Rng rng(seed);
+    MultiLevelBook book;
+    SimpleImbalanceIntensity model(config.intensity);
+    CompetingIntensitySampler sampler(rng);
+    UnitSizeAttributeSampler attrs(rng, config.level_alpha, config.spread_improve_coeff);
+    QrsdpProducer producer(rng, book, model, sampler, attrs);
+    InMemorySink sink;
+    producer.startSession(session);
+
+    PathSummary p;
+    p.open_ticks = (book.bestBid().price_ticks + book.bestAsk().price_ticks) / 2;
+    p.high_ticks = p.open_ticks;
+    p.low_ticks = p.open_ticks;
+    size_t seen = 0;
+    while (producer.stepOneEvent(sink)) {
+        const EventRecord& rec = sink.events()[seen++];
+        const int32_t mid = (book.bestBid().price_ticks + book.bestAsk().price_ticks) / 2;
+        p.high_ticks = std::max(p.high_ticks, mid);
+        p.low_ticks = std::min(p.low_ticks, mid);
+        ++p.type_counts[rec.type];
+    }
+    p.close_ticks = (book.bestBid().price_ticks + book.bestAsk().price_ticks) / 2;
+    p.events = producer.eventsWrittenThisSession();
+    p.shifts = producer.shiftCountThisSession();
+    return p;
+}
+
+TEST(MonteCarlo, SameConfigGivesTheSamePathsOnAnyThreadCount) {
+    const MonteCarloConfig config = smallConfig(200, 5);
+    const MonteCarloResult one = runMonteCarloCpu(config, 1);
+    const MonteCarloResult four = runMonteCarloCpu(config, 4);
+    ASSERT_EQ(one.paths.size(), 200u);
+    ASSERT_EQ(four.paths.size(), 200u);
+    for (size_t i = 0; i < one.paths.size(); ++i) {
+        EXPECT_EQ(one.paths[i].events, four.paths[i].events) << "path " << i;
+        EXPECT_EQ(one.paths[i].close_ticks, four.paths[i].close_ticks) << "path " << i;
+    }
+    // Distinct streams: paths are not copies of each other.
+    EXPECT_NE(one.paths[0].events, one.paths[1].events);
+}
+
+TEST(MonteCarlo, SummariesAreConsistent) {
+    const MonteCarloResult result = runMonteCarloCpu(smallConfig(64, 10));
+    for (const PathSummary& p : result.paths) {
+        uint64_t sum = 0;
+        for (uint64_t c : p.type_counts) sum += c;
+        EXPECT_EQ(sum, p.events);
+        EXPECT_EQ(p.open_ticks, 10000);
+        EXPECT_LE(p.low_ticks, std::min(p.open_ticks, p.close_ticks));
+        EXPECT_GE(p.high_ticks, std::max(p.open_ticks, p.close_ticks));
+        EXPECT_LE(p.shifts, p.events);
+    }
+}
+
+TEST(MonteCarlo, RecordsAreTheFirstEventsOfEachPath) {
+    MonteCarloConfig config = smallConfig(8, 5);
+    config.records_per_path = 16;
+    const MonteCarloResult result = runMonteCarloCpu(config, 2);
+    ASSERT_EQ(result.records.size(), 8u * 16u);
+    const uint64_t open_ns = static_cast<uint64_t>(config.market_open_seconds) * 1'000'000'000ULL;
+    for (size_t i = 0; i < 8; ++i) {
+        ASSERT_GE(result.paths[i].events, 16u);
+        uint64_t prev = open_ns;
+        for (size_t j = 0; j < 16; ++j) {
+            const EventRecord& rec = result.records[i * 16 + j];
+            EXPECT_EQ(rec.order_id, j + 1);
+            EXPECT_GE(rec.ts_ns, prev);
+            EXPECT_LT(rec.type, static_cast<uint8_t>(kNumEventTypes));
+            EXPECT_EQ(rec.qty, 1u);
+            prev = rec.ts_ns;
+        }
+    }
+}
+
+TEST(MonteCarlo, RejectsUnsupportedConfigs) {
+    MonteCarloConfig config = smallConfig(1);
+    config.levels_per_side = mc::kMaxPathLevels + 1;
+    EXPECT_THROW(makePathParams(config), std::invalid_argument);
+    config.levels_per_side = 0;
+    EXPECT_THROW(makePathParams(config), std::invalid_argument);
+
+    TradingSession session{};
+    session.session_seconds = 10;
+    session.levels_per_side = 5;
+    session.queue_reactive.theta_reinit = 0.1;
+    EXPECT_THROW(monteCarloConfigFor(session, 1), std::invalid_argument);
+}
+
+// The engine reimplements the producer's event law; over many sessions its
+// statistics must agree with QrsdpProducer's within sampling error.
+TEST(MonteCarlo, MatchesQrsdpProducerInDistribution) {
+    const uint64_t kPaths = 300;
+    const MonteCarloConfig config = smallConfig(kPaths, 30);
+    const MonteCarloResult mc = runMonteCarloCpu(config);
+    PathStats engine;
+    for (const PathSummary& p : mc.paths) engine.add(p);
+    PathStats producer;
+    for (uint64_t i = 0; i < kPaths; ++i) producer.add(producerPath(config, 1000 + i));
+
+    // Mean events per session: a two-sample z-test at 4 standard errors.
+    const double se = std::sqrt(engine.varEvents() / engine.n + producer.varEvents() / producer.n);
+    EXPECT_LT(std::fabs(engine.meanEvents() - producer.meanEvents()), 4.0 * se)
+        << engine.meanEvents() << " vs " << producer.meanEvents();
+    // Event type mix.
+    for (int t = 0; t < kNumEventTypes; ++t)
+        EXPECT_NEAR(engine.share(t), producer.share(t), 0.01) << "type " << t;
+    // Price dispersion: mean squared close - open and mean high - low range.
+    const double engine_var = engine.ret_sq / engine.n;
+    const double producer_var = producer.ret_sq / producer.n;
+    EXPECT_GT(engine_var, 0.0);
+    EXPECT_NEAR(engine_var / producer_var, 1.0, 0.3) << engine_var << " vs " << producer_var;
+    EXPECT_NEAR((engine.range / engine.n) / (producer.range / producer.n), 1.0, 0.15);
+}
+
+TEST(MonteCarlo, CudaBackendAgreesWithTheCpuEngine) {
+    if (!cudaMonteCarloAvailable()) {
+        EXPECT_THROW(runMonteCarloCuda(smallConfig(1)), std::runtime_error);
+        GTEST_SKIP() << "built without BUILD_CUDA_MONTE_CARLO or no CUDA device";
+    }
+    MonteCarloConfig config = smallConfig(2048, 30);
+    config.records_per_path = 4;
+    const MonteCarloResult gpu = runMonteCarloCuda(config);
+    const MonteCarloResult cpu = runMonteCarloCpu(config);
+    ASSERT_EQ(gpu.paths.size(), cpu.paths.size());
+    ASSERT_EQ(gpu.records.size(), cpu.records.size());
+    // Same streams, but device exp/log and FMA contraction may round differently,
+    // so paths can part ways: compare in distribution.
+    PathStats a, b;
+    for (const PathSummary& p : gpu.paths) a.add(p);
+    for (const PathSummary& p : cpu.paths) b.add(p);
+    const double se = std::sqrt(a.varEvents() / a.n + b.varEvents() / b.n);
+    EXPECT_LT(std::fabs(a.meanEvents() - b.meanEvents()), 4.0 * se);
+    for (int t = 0; t < kNumEventTypes; ++t) EXPECT_NEAR(a.share(t), b.share(t), 0.005);
+}
+
+}  // namespace test
+}  // namespace qrsdp
@@ -0,0 +1,140 @@
+#include <gtest/gtest.h>
+#include "producer/multi_security_producer.h"
+#include "producer/qrsdp_producer.h"
+#include "io/in_memory_sink.h"
+#include "book/multi_level_book.h"
+#include "model/simple_imbalance_intensity.h"
+#include "rng/mt19937_rng.h"
+#include "sampler/competing_intensity_sampler.h"
+#include "sampler/unit_size_attribute_sampler.h"
+#include "core/records.h"
+
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+namespace qrsdp {
+namespace test {
+
+static TradingSession makeSession(uint64_t seed, int32_t p0_ticks, uint32_t session_seconds = 5) {
+    TradingSession s{};
+    s.seed = seed;
+    s.p0_ticks = p0_ticks;
+    s.session_seconds = session_seconds;
+    s.levels_per_side = 5;
+    s.tick_size = 100;
+    s.initial_spread_ticks = 2;
+    s.intensity_params.base_L = 20.0;
+    s.intensity_params.base_C = 0.1;
+    s.intensity_params.base_M = 5.0;
+    s.intensity_params.imbalance_sensitivity = 1.0;
+    s.intensity_params.cancel_sensitivity = 1.0;
+    s.intensity_params.epsilon_exec = 0.05;
+    return s;
+}
+
+/// One security's collaborators plus its producer.
+struct Stack {
+    explicit Stack(const IntensityParams& p)
+        : rng(0), model(p), sampler(rng), attrs(rng, 0.5, 0.5),
+          producer(rng, book, model, sampler, attrs) {}
+    Mt19937Rng rng;
+    MultiLevelBook book;
+    SimpleImbalanceIntensity model;
+    CompetingIntensitySampler sampler;
+    UnitSizeAttributeSampler attrs;
+    QrsdpProducer producer;
+};
+
+struct Tagged {
+    uint32_t security;
+    EventRecord rec;
+};
+
+class RecordingSink : public IConsolidatedSink {
+public:
+    void append(uint32_t security, const EventRecord& rec) override {
+        events.push_back(Tagged{security, rec});
+    }
+    std::vector<Tagged> events;
+};
+
+TEST(MultiSecurityProducer, MergedStreamIsTimeOrderedAndLossless) {
+    std::vector<TradingSession> sessions = {
+        makeSession(11, 10000), makeSession(22, 20000), makeSession(33, 5000)};
+
+    std::vector<std::unique_ptr<Stack>> stacks;
+    MultiSecurityProducer merged;
+    for (size_t i = 0; i < sessions.size(); ++i) {
+        stacks.push_back(std::make_unique<Stack>(sessions[i].intensity_params));
+        EXPECT_EQ(merged.addProducer(stacks.back()->producer), i);
+    }
+    RecordingSink sink;
+    const uint64_t n = merged.runSession(sessions, sink);
+    ASSERT_EQ(n, sink.events.size());
+    ASSERT_GT(n, 0u);
+
+    for (size_t i = 1; i < sink.events.size(); ++i) {
+        const Tagged& a = sink.events[i - 1];
+        const Tagged& b = sink.events[i];
+        ASSERT_LE(a.rec.ts_ns, b.rec.ts_ns) << "event " << i;
+        if (a.rec.ts_ns == b.rec.ts_ns && a.security != b.security) {
+            ASSERT_LT(a.security, b.security) << "tie break at event " << i;
+        }
+    }
+
+    // Each security's subsequence is exactly its standalone session.
+    for (uint32_t s = 0; s < sessions.size(); ++s) {
+        Stack alone(sessions[s].intensity_params);
+        InMemorySink expected;
+        alone.producer.runSession(sessions[s], expected);
+
+        size_t k = 0;
+        for (const Tagged& t : sink.events) {
+            if (t.security != s) continue;
+            ASSERT_LT(k, expected.size());
+            const EventRecord& e = expected.events()[k++];
+            ASSERT_EQ(t.rec.ts_ns, e.ts_ns);
+            ASSERT_EQ(t.rec.type, e.type);
+            ASSERT_EQ(t.rec.price_ticks, e.price_ticks);
+            ASSERT_EQ(t.rec.order_id, e.order_id);
+        }
+        EXPECT_EQ(k, expected.size()) << "security " << s;
+    }
+}
+
+TEST(MultiSecurityProducer, RestartsCleanlyAndStepsManually) {
+    std::vector<TradingSession> sessions = {makeSession(7, 10000, 2), makeSession(8, 10000, 2)};
+    Stack a(sessions[0].intensity_params);
+    Stack b(sessions[1].intensity_params);
+    MultiSecurityProducer merged;
+    merged.addProducer(a.producer);
+    merged.addProducer(b.producer);
+
+    RecordingSink first;
+    merged.runSession(sessions, first);
+
+    merged.startSession(sessions);
+    uint32_t security;
+    EventRecord rec;
+    size_t i = 0;
+    while (merged.next(security, rec)) {
+        ASSERT_LT(i, first.events.size());
+        EXPECT_EQ(security, first.events[i].security);
+        EXPECT_EQ(rec.ts_ns, first.events[i].rec.ts_ns);
+        ++i;
+    }
+    EXPECT_EQ(i, first.events.size());
+    EXPECT_EQ(merged.eventsEmitted(), i);
+    EXPECT_FALSE(merged.next(security, rec));
+}
+
+TEST(MultiSecurityProducer, SessionCountMustMatch) {
+    Stack a(makeSession(1, 10000).intensity_params);
+    MultiSecurityProducer merged;
+    merged.addProducer(a.producer);
+    EXPECT_THROW(merged.startSession({}), std::invalid_argument);
+}
+
+}  // namespace test
+}  // namespace qrsdp
@@ -0,0 +1,54 @@
+#include <gtest/gtest.h>
+#include "producer/pacer.h"
+
+#include <chrono>
+
+namespace qrsdp {
+namespace test {
+
+using Clock = Pacer::Clock;
+
+TEST(Pacer, DueTimesScaleBySpeed) {
+    PacingOptions opts;
+    opts.speed = 100.0;
+    Pacer pacer(opts);
+    const Clock::time_point origin = Clock::now();
+    pacer.start(origin);
+    EXPECT_EQ(pacer.dueTime(0.0), origin);
+    EXPECT_EQ(pacer.dueTime(1.0) - origin, std::chrono::milliseconds(10));
+    EXPECT_EQ(pacer.dueTime(23400.0) - origin, std::chrono::seconds(234));
+}
+
+TEST(Pacer, WaitsUntilDueAndTracksLateness) {
+    PacingOptions opts;
+    opts.speed = 1000.0;
+    opts.spin_us = 200;
+    opts.window_us = 500;
+    Pacer pacer(opts);
+    const Clock::time_point origin = Clock::now();
+    pacer.start(origin);
+
+    pacer.waitUntil(2.0);  // due 2 ms after origin: sleeps, then spins
+    const Clock::time_point after = Clock::now();
+    EXPECT_GE(after, origin + std::chrono::milliseconds(2));
+    EXPECT_EQ(pacer.stats().releases, 1u);
+    EXPECT_EQ(pacer.stats().sleeps, 1u);
+    EXPECT_EQ(pacer.stats().late, 0u);
+
+    // The window covers events due up to 500 us after the release.
+    EXPECT_TRUE(pacer.dueBy(2.4, pacer.horizon()));
+    EXPECT_FALSE(pacer.dueBy(5.0, pacer.horizon()));
+
+    pacer.waitUntil(1.0);  // already past: returns at once, counted late
+    EXPECT_EQ(pacer.stats().releases, 2u);
+    EXPECT_EQ(pacer.stats().late, 1u);
+    EXPECT_GE(pacer.stats().lateness_ns_max, 1000000u);
+    EXPECT_GT(pacer.stats().meanLatenessUs(), 0.0);
+}
+
+TEST(Pacer, PinRejectsNegativeCpu) {
+    EXPECT_FALSE(pinCurrentThread(-1));
+}
+
+}  // namespace test
+}  // namespace qrsdp
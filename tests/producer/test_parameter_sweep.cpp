@@ -0,0 +1,128 @@
+#include <gtest/gtest.h>
+#include "producer/parameter_sweep.h"
+#include "core/event_types.h"
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace qrsdp {
+namespace test {
+
+static std::string readAll(std::FILE* f) {
+    std::rewind(f);
+    std::string text;
+    char buf[1024];
+    size_t n;
+    while ((n = std::fread(buf, 1, sizeof(buf), f)) > 0) text.append(buf, n);
+    return text;
+}
+
+static size_t countLines(const std::string& text) {
+    size_t n = 0;
+    for (char c : text) n += c == '\n';
+    return n;
+}
+
+static SweepConfig smallSweep() {
+    SweepConfig config;
+    config.grid.base_M = {5.0, 30.0};
+    config.days = 2;
+    config.session_seconds = 30;
+    config.threads = 2;
+    return config;
+}
+
+static double execShare(const SessionStats& s) {
+    const uint64_t exec = s.type_counts[static_cast<int>(EventType::EXECUTE_BUY)] +
+                          s.type_counts[static_cast<int>(EventType::EXECUTE_SELL)];
+    return static_cast<double>(exec) / static_cast<double>(s.events);
+}
+
+TEST(ParameterSweep, PointsAreTheCartesianProductWithSpreadSensitivityInnermost) {
+    ParameterGrid grid;
+    grid.base_L = {10.0, 20.0};
+    grid.spread_sensitivity = {0.0, 0.4, 0.8};
+    const std::vector<IntensityParams> points = grid.points();
+    ASSERT_EQ(points.size(), 6u);
+    EXPECT_DOUBLE_EQ(points[0].spread_sensitivity, 0.0);
+    EXPECT_DOUBLE_EQ(points[1].spread_sensitivity, 0.4);
+    EXPECT_DOUBLE_EQ(points[3].base_L, 20.0);
+    EXPECT_DOUBLE_EQ(points[3].spread_sensitivity, 0.0);
+    EXPECT_DOUBLE_EQ(points[5].base_M, 15.0);
+}
+
+TEST(ParameterSweep, ResultsFollowTheGridAndDoNotDependOnThreads) {
+    SweepConfig config = smallSweep();
+    const std::vector<SweepResult> a = runParameterSweep(config);
+    config.threads = 1;
+    const std::vector<SweepResult> b = runParameterSweep(config);
+
+    ASSERT_EQ(a.size(), 2u);
+    ASSERT_EQ(b.size(), 2u);
+    for (size_t i = 0; i < a.size(); ++i) {
+        EXPECT_DOUBLE_EQ(a[i].params.base_M, config.grid.base_M[i]);
+        EXPECT_EQ(a[i].days, 2u);
+        EXPECT_EQ(a[i].day_returns.n, 2u);
+        EXPECT_GT(a[i].pooled.events, 0u);
+        EXPECT_EQ(a[i].pooled.events, b[i].pooled.events);
+        EXPECT_EQ(a[i].pooled.shifts, b[i].pooled.shifts);
+        EXPECT_DOUBLE_EQ(a[i].pooled.bar_returns.sum2, b[i].pooled.bar_returns.sum2);
+        EXPECT_DOUBLE_EQ(a[i].mean_range, b[i].mean_range);
+    }
+}
+
+TEST(ParameterSweep, HigherExecutionIntensityRaisesTheExecutionShare) {
+    const std::vector<SweepResult> results = runParameterSweep(smallSweep());
+    ASSERT_EQ(results.size(), 2u);
+    EXPECT_GT(execShare(results[1].pooled), execShare(results[0].pooled));
+    EXPECT_GT(results[1].pooled.shifts, results[0].pooled.shifts);
+}
+
+TEST(ParameterSweep, BranchesForkFromOneSharedPrefix) {
+    SweepConfig config = smallSweep();
+    config.days = 3;
+    config.fork_seconds = 20.0;
+    const std::vector<SweepResult> a = runParameterSweep(config);
+    config.threads = 1;
+    const std::vector<SweepResult> b = runParameterSweep(config);
+    ASSERT_EQ(a.size(), 2u);
+    for (size_t i = 0; i < a.size(); ++i) {
+        EXPECT_EQ(a[i].days, 3u);
+        EXPECT_GT(a[i].pooled.events, 0u);
+        EXPECT_EQ(a[i].pooled.events, b[i].pooled.events);
+        EXPECT_DOUBLE_EQ(a[i].day_returns.sum2, b[i].day_returns.sum2);
+    }
+    // Every branch of every point opens at the prefix's mid.
+    EXPECT_DOUBLE_EQ(a[0].pooled.open_mid, a[1].pooled.open_mid);
+
+    // Branches only simulate the last third of the session.
+    config.fork_seconds = 0.0;
+    const std::vector<SweepResult> whole = runParameterSweep(config);
+    EXPECT_LT(a[0].pooled.events, whole[0].pooled.events);
+    EXPECT_GT(a[1].pooled.events, a[0].pooled.events) << "the branch's own parameters apply";
+}
+
+TEST(ParameterSweep, WritersEmitAHeaderAndOneRowPerPoint) {
+    const SweepConfig config = smallSweep();
+    const std::vector<SweepResult> results = runParameterSweep(config);
+
+    std::FILE* csv = std::tmpfile();
+    ASSERT_NE(csv, nullptr);
+    writeSweepCsv(csv, results, config);
+    const std::string csv_text = readAll(csv);
+    std::fclose(csv);
+    EXPECT_EQ(countLines(csv_text), 1u + results.size());
+    EXPECT_EQ(csv_text.rfind("base_L,base_C,base_M,", 0), 0u);
+
+    std::FILE* md = std::tmpfile();
+    ASSERT_NE(md, nullptr);
+    writeSweepSummary(md, results, config);
+    const std::string md_text = readAll(md);
+    std::fclose(md);
+    EXPECT_EQ(countLines(md_text), 2u + results.size());
+    EXPECT_NE(md_text.find("| 30 |"), std::string::npos);
+}
+
+}  // namespace test
+}  // namespace qrsdp
@@ -1,17 +1,29 @@
 #include <gtest/gtest.h>
 #include "producer/qrsdp_producer.h"
+#include "producer/basic_qrsdp_producer.h"
+#include "io/binary_file_sink.h"
+#include "io/event_log_reader.h"
 #include "io/in_memory_sink.h"
 #include "book/multi_level_book.h"
 #include "model/simple_imbalance_intensity.h"
 #include "model/hlr_params.h"
 #include "model/curve_intensity_model.h"
+#include "model/hawkes_intensity_model.h"
+#include "model/seasonality_profile.h"
 #include "rng/mt19937_rng.h"
+#include "rng/xoshiro256pp_rng.h"
 #include "sampler/competing_intensity_sampler.h"
 #include "sampler/unit_size_attribute_sampler.h"
 #include "core/records.h"
+#include "support/alloc_counter.h"
 #include <algorithm>
 #include <cstddef>
 #include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <utility>
 #include <vector>
 
 namespace qrsdp {
@@ -134,10 +146,10 @@ TEST(QrsdpProducer, IntegrationEventsWrittenAndCloseValid) {
 TEST(QrsdpProducer, InMemorySinkAccumulates) {
     InMemorySink sink;
     EXPECT_EQ(sink.size(), 0u);
-    EventRecord r1{1000, 0, 0, 9999, 1, 1, 0};
+    EventRecord r1{1000, 1, 9999, 1, 0, 0, 0, 0};
     sink.append(r1);
     EXPECT_EQ(sink.size(), 1u);
-    EventRecord r2{2000, 1, 1, 10001, 1, 2, 0};
+    EventRecord r2{2000, 2, 10001, 1, 0, 1, 1, 0};
     sink.append(r2);
     EXPECT_EQ(sink.size(), 2u);
     EXPECT_EQ(sink.events()[0].ts_ns, 1000u);
@@ -392,5 +404,830 @@ TEST(QrsdpProducer, ZeroMarketOpenPreservesLegacyTimestamps) {
         << "first event should be within 1s of zero when no offset";
 }
 
+// --- Allocation-free hot loop ---
+
+/// Counts appends without storing them, so the sink itself never allocates.
+class CountingSink : public IEventSink {
+public:
+    void append(const EventRecord&) override { ++count_; }
+    uint64_t count() const { return count_; }
+
+private:
+    uint64_t count_ = 0;
+};
+
+static size_t allocationsOverSteps(QrsdpProducer& producer, CountingSink& sink,
+                                   int warmup, int steps) {
+    for (int i = 0; i < warmup; ++i) producer.stepOneEvent(sink);
+    const size_t before = allocationCount();
+    for (int i = 0; i < steps; ++i) producer.stepOneEvent(sink);
+    return allocationCount() - before;
+}
+
+TEST(QrsdpProducer, SteadyStateStepIsAllocationFreeSimpleModel) {
+    TradingSession session = makeSession(2024, 3600, 5);
+    Mt19937Rng rng(session.seed);
+    MultiLevelBook book;
+    SimpleImbalanceIntensity model(session.intensity_params);
+    CompetingIntensitySampler eventSampler(rng);
+    UnitSizeAttributeSampler attrSampler(rng, 0.5, 0.5);
+    QrsdpProducer producer(rng, book, model, eventSampler, attrSampler);
+    CountingSink sink;
+
+    producer.startSession(session);
+    const size_t allocs = allocationsOverSteps(producer, sink, 100, 10000);
+    ASSERT_EQ(sink.count(), 10100u) << "session ended before the measured window";
+    EXPECT_EQ(allocs, 0u) << "stepOneEvent allocated in steady state";
+}
+
+TEST(QrsdpProducer, SteadyStateStepIsAllocationFreeCurveModel) {
+    TradingSession session = makeSession(2025, 3600, 5);
+    HLRParams p = makeDefaultHLRParams(5, 100);
+    CurveIntensityModel model(p);
+    Mt19937Rng rng(session.seed);
+    MultiLevelBook book;
+    CompetingIntensitySampler eventSampler(rng);
+    UnitSizeAttributeSampler attrSampler(rng, 0.5, 0.5);
+    QrsdpProducer producer(rng, book, model, eventSampler, attrSampler);
+    CountingSink sink;
+
+    producer.startSession(session);
+    const size_t allocs = allocationsOverSteps(producer, sink, 100, 10000);
+    ASSERT_EQ(sink.count(), 10100u) << "session ended before the measured window";
+    EXPECT_EQ(allocs, 0u) << "stepOneEvent allocated in steady state";
+}
+
+TEST(QrsdpProducer, SteadyStateStepIsAllocationFreeCurveModelFenwick) {
+    TradingSession session = makeSession(2026, 3600, 5);
+    HLRParams p = makeDefaultHLRParams(5, 100);
+    CurveIntensityModel model(p);
+    Mt19937Rng rng(session.seed);
+    MultiLevelBook book;
+    CompetingIntensitySampler eventSampler(rng, SelectionMode::FENWICK);
+    UnitSizeAttributeSampler attrSampler(rng, 0.5, 0.5);
+    QrsdpProducer producer(rng, book, model, eventSampler, attrSampler);
+    CountingSink sink;
+
+    producer.startSession(session);
+    const size_t allocs = allocationsOverSteps(producer, sink, 100, 10000);
+    ASSERT_EQ(sink.count(), 10100u) << "session ended before the measured window";
+    EXPECT_EQ(allocs, 0u) << "stepOneEvent allocated in steady state";
+}
+
+// --- Fenwick per-level selection ---
+
+/// Reports every per-level entry as changed, forcing a full tree reload each step.
+class FullReloadCurveModel : public IIntensityModel {
+public:
+    explicit FullReloadCurveModel(HLRParams p) : inner_(std::move(p)) {}
+    Intensities compute(const BookState& s) const override { return inner_.compute(s); }
+    Intensities update(const BookState& s, const BookDelta& d) const override {
+        return inner_.update(s, d);
+    }
+    bool getPerLevelIntensities(std::vector<double>& w) const override {
+        return inner_.getPerLevelIntensities(w);
+    }
+    const std::vector<double>* perLevelView() const override { return inner_.perLevelView(); }
+
+private:
+    CurveIntensityModel inner_;
+};
+
+TEST(QrsdpProducer, FenwickPointUpdatesMatchFullReload) {
+    TradingSession session = makeSession(777, 30, 5);
+    HLRParams p = makeDefaultHLRParams(5, 100);
+    CurveIntensityModel incremental_model(p);
+    FullReloadCurveModel reload_model(p);
+
+    Mt19937Rng rng1(session.seed);
+    Mt19937Rng rng2(session.seed);
+    MultiLevelBook book1;
+    MultiLevelBook book2;
+    CompetingIntensitySampler sampler1(rng1, SelectionMode::FENWICK);
+    CompetingIntensitySampler sampler2(rng2, SelectionMode::FENWICK);
+    UnitSizeAttributeSampler attr1(rng1, 0.5, 0.5);
+    UnitSizeAttributeSampler attr2(rng2, 0.5, 0.5);
+    QrsdpProducer producer1(rng1, book1, incremental_model, sampler1, attr1);
+    QrsdpProducer producer2(rng2, book2, reload_model, sampler2, attr2);
+
+    InMemorySink sink1;
+    InMemorySink sink2;
+    producer1.runSession(session, sink1);
+    producer2.runSession(session, sink2);
+
+    ASSERT_GT(sink1.size(), 1000u);
+    ASSERT_EQ(sink1.size(), sink2.size());
+    for (size_t i = 0; i < sink1.size(); ++i) {
+        ASSERT_TRUE(eventRecordsEqual(sink1.events()[i], sink2.events()[i]))
+            << "record " << i << " differs between point-update and full-reload paths";
+    }
+}
+
+TEST(QrsdpProducer, FenwickCurveModelDeterminismSameSeed) {
+    TradingSession session = makeSession(4243, 5);
+    session.levels_per_side = 3;
+    HLRParams p = makeDefaultHLRParams(3, 50);
+    CurveIntensityModel model1(p);
+    CurveIntensityModel model2(p);
+
+    Mt19937Rng rng1(session.seed);
+    Mt19937Rng rng2(session.seed);
+    MultiLevelBook book1;
+    MultiLevelBook book2;
+    CompetingIntensitySampler sampler1(rng1, SelectionMode::FENWICK);
+    CompetingIntensitySampler sampler2(rng2, SelectionMode::FENWICK);
+    UnitSizeAttributeSampler attr1(rng1, 0.5);
+    UnitSizeAttributeSampler attr2(rng2, 0.5);
+    QrsdpProducer producer1(rng1, book1, model1, sampler1, attr1);
+    QrsdpProducer producer2(rng2, book2, model2, sampler2, attr2);
+
+    InMemorySink sink1;
+    InMemorySink sink2;
+    producer1.runSession(session, sink1);
+    producer2.runSession(session, sink2);
+
+    ASSERT_EQ(sink1.size(), sink2.size());
+    for (size_t i = 0; i < sink1.size(); ++i) {
+        ASSERT_TRUE(eventRecordsEqual(sink1.events()[i], sink2.events()[i])) << "record " << i;
+    }
+}
+
+// --- Concrete (devirtualised) instantiation ---
+
+template <class Model>
+static void expectConcreteMatchesVirtual(const TradingSession& session, Model& model1, Model& model2,
+                                         SelectionMode mode) {
+    Mt19937Rng rng1(session.seed);
+    Mt19937Rng rng2(session.seed);
+    MultiLevelBook book1;
+    MultiLevelBook book2;
+    CompetingIntensitySampler sampler1(rng1, mode);
+    CompetingIntensitySampler sampler2(rng2, mode);
+    UnitSizeAttributeSampler attr1(rng1, 0.5, 0.5);
+    UnitSizeAttributeSampler attr2(rng2, 0.5, 0.5);
+    QrsdpProducer virtual_producer(rng1, book1, model1, sampler1, attr1);
+    BasicQrsdpProducer<Mt19937Rng, MultiLevelBook, Model, CompetingIntensitySampler,
+                       UnitSizeAttributeSampler, InMemorySink>
+        concrete_producer(rng2, book2, model2, sampler2, attr2);
+
+    InMemorySink sink1;
+    InMemorySink sink2;
+    SessionResult r1 = virtual_producer.runSession(session, sink1);
+    SessionResult r2 = concrete_producer.runSession(session, sink2);
+
+    EXPECT_EQ(r1.close_ticks, r2.close_ticks);
+    ASSERT_GT(sink1.size(), 0u);
+    ASSERT_EQ(sink1.size(), sink2.size());
+    for (size_t i = 0; i < sink1.size(); ++i) {
+        ASSERT_TRUE(eventRecordsEqual(sink1.events()[i], sink2.events()[i])) << "record " << i;
+    }
+}
+
+TEST(QrsdpProducer, ConcreteInstantiationMatchesVirtualSimpleModel) {
+    TradingSession session = makeSession(31337, 30, 5);
+    SimpleImbalanceIntensity model1(session.intensity_params);
+    SimpleImbalanceIntensity model2(session.intensity_params);
+    expectConcreteMatchesVirtual(session, model1, model2, SelectionMode::LINEAR);
+}
+
+TEST(QrsdpProducer, ConcreteInstantiationMatchesVirtualCurveModel) {
+    TradingSession session = makeSession(31338, 30, 5);
+    HLRParams p = makeDefaultHLRParams(5, 100);
+    CurveIntensityModel model1(p);
+    CurveIntensityModel model2(p);
+    expectConcreteMatchesVirtual(session, model1, model2, SelectionMode::FENWICK);
+}
+
+// --- Batched stepping ---
+
+TEST(QrsdpProducer, StepEventsMatchesStepOneEvent) {
+    TradingSession session = makeSession(9090, 30, 5);
+    HLRParams p = makeDefaultHLRParams(5, 100);
+    CurveIntensityModel model1(p);
+    CurveIntensityModel model2(p);
+    Mt19937Rng rng1(session.seed);
+    Mt19937Rng rng2(session.seed);
+    MultiLevelBook book1;
+    MultiLevelBook book2;
+    CompetingIntensitySampler sampler1(rng1);
+    CompetingIntensitySampler sampler2(rng2);
+    UnitSizeAttributeSampler attr1(rng1, 0.5, 0.5);
+    UnitSizeAttributeSampler attr2(rng2, 0.5, 0.5);
+    QrsdpProducer producer1(rng1, book1, model1, sampler1, attr1);
+    QrsdpProducer producer2(rng2, book2, model2, sampler2, attr2);
+
+    InMemorySink single;
+    producer1.startSession(session);
+    while (producer1.stepOneEvent(single)) {}
+
+    InMemorySink batched;
+    producer2.startSession(session);
+    EventRecord buf[37];  // odd size so batches do not align with anything
+    size_t n;
+    while ((n = producer2.stepEvents(37, buf)) > 0) batched.appendBatch(buf, n);
+
+    EXPECT_EQ(producer1.eventsWrittenThisSession(), producer2.eventsWrittenThisSession());
+    ASSERT_GT(single.size(), 0u);
+    ASSERT_EQ(single.size(), batched.size());
+    for (size_t i = 0; i < single.size(); ++i) {
+        ASSERT_TRUE(eventRecordsEqual(single.events()[i], batched.events()[i])) << "record " << i;
+    }
+    EXPECT_EQ(producer2.stepEvents(37, buf), 0u) << "session already ended";
+}
+
+TEST(QrsdpProducer, FastForwardReachesTheSteppedState) {
+    TradingSession session = makeSession(3131, 60, 5);
+    HLRParams p = makeDefaultHLRParams(5, 100);
+    CurveIntensityModel model1(p);
+    CurveIntensityModel model2(p);
+    Mt19937Rng rng1(session.seed);
+    Mt19937Rng rng2(session.seed);
+    MultiLevelBook book1;
+    MultiLevelBook book2;
+    CompetingIntensitySampler sampler1(rng1, SelectionMode::FENWICK);
+    CompetingIntensitySampler sampler2(rng2, SelectionMode::FENWICK);
+    UnitSizeAttributeSampler attr1(rng1, 0.5, 0.5);
+    UnitSizeAttributeSampler attr2(rng2, 0.5, 0.5);
+    QrsdpProducer stepped(rng1, book1, model1, sampler1, attr1);
+    QrsdpProducer skipped(rng2, book2, model2, sampler2, attr2);
+
+    InMemorySink full;
+    stepped.startSession(session);
+    while (stepped.stepOneEvent(full) && stepped.currentTime() < 20.0) {}
+    const size_t at = full.size();
+
+    skipped.startSession(session);
+    EXPECT_EQ(skipped.fastForward(20.0), at);
+    EXPECT_EQ(skipped.eventsWrittenThisSession(), stepped.eventsWrittenThisSession());
+    EXPECT_EQ(skipped.currentTime(), stepped.currentTime());
+    EXPECT_EQ(skipped.nextOrderId(), stepped.nextOrderId());
+    EXPECT_EQ(skipped.shiftCountThisSession(), stepped.shiftCountThisSession());
+    for (size_t k = 0; k < book1.numLevels(); ++k) {
+        EXPECT_EQ(book2.bidDepthAtLevel(k), book1.bidDepthAtLevel(k)) << "bid level " << k;
+        EXPECT_EQ(book2.askDepthAtLevel(k), book1.askDepthAtLevel(k)) << "ask level " << k;
+    }
+    EXPECT_EQ(skipped.fastForward(10.0), 0u) << "already past t";
+
+    // The rest of the session continues the uninterrupted stream.
+    while (stepped.stepOneEvent(full)) {}
+    InMemorySink rest;
+    while (skipped.stepOneEvent(rest)) {}
+    ASSERT_EQ(at + rest.size(), full.size());
+    ASSERT_GT(rest.size(), 0u);
+    for (size_t i = 0; i < rest.size(); ++i)
+        ASSERT_TRUE(eventRecordsEqual(rest.events()[i], full.events()[at + i])) << "record " << at + i;
+    EXPECT_EQ(skipped.fastForward(1e9), 0u) << "session already ended";
+}
+
+TEST(QrsdpProducer, ForksContinueFromTheSnapshotDependingOnlyOnTheSeed) {
+    TradingSession session = makeSession(4242, 60, 5);
+    HLRParams p = makeDefaultHLRParams(5, 100);
+    CurveIntensityModel model1(p);
+    CurveIntensityModel model2(p);
+    Mt19937Rng rng1(session.seed);
+    Mt19937Rng rng2(1);
+    MultiLevelBook book1;
+    MultiLevelBook book2;
+    CompetingIntensitySampler sampler1(rng1, SelectionMode::FENWICK);
+    CompetingIntensitySampler sampler2(rng2, SelectionMode::FENWICK);
+    UnitSizeAttributeSampler attr1(rng1, 0.5, 0.5);
+    UnitSizeAttributeSampler attr2(rng2, 0.5, 0.5);
+    QrsdpProducer prefix(rng1, book1, model1, sampler1, attr1);
+    QrsdpProducer fresh(rng2, book2, model2, sampler2, attr2);
+
+    prefix.startSession(session);
+    prefix.fastForward(20.0);
+    const ProducerSnapshot snap = prefix.snapshot();
+    EXPECT_EQ(snap.t, prefix.currentTime());
+    EXPECT_EQ(snap.events_written, prefix.eventsWrittenThisSession());
+    EXPECT_EQ(snap.next_order_id, prefix.nextOrderId());
+    ASSERT_EQ(snap.bids.size(), book1.numLevels());
+
+    // A fresh producer and the prefix's own, forked with one seed, agree.
+    fresh.fork(snap, 99);
+    EXPECT_EQ(fresh.currentTime(), snap.t);
+    EXPECT_EQ(fresh.shiftCountThisSession(), snap.shift_count);
+    for (size_t k = 0; k < book2.numLevels(); ++k) {
+        EXPECT_EQ(book2.bidDepthAtLevel(k), snap.bids[k].depth) << "bid level " << k;
+        EXPECT_EQ(book2.askPriceAtLevel(k), snap.asks[k].price_ticks) << "ask level " << k;
+    }
+    InMemorySink a;
+    fresh.finishSession(a);
+    std::vector<EventRecord> moved_on(100);
+    prefix.stepEvents(moved_on.size(), moved_on.data());
+    prefix.fork(snap, 99);
+    InMemorySink b;
+    prefix.finishSession(b);
+    ASSERT_GT(a.size(), 0u);
+    ASSERT_EQ(a.size(), b.size());
+    for (size_t i = 0; i < a.size(); ++i)
+        ASSERT_TRUE(eventRecordsEqual(a.events()[i], b.events()[i])) << "record " << i;
+    EXPECT_GE(a.events().front().ts_ns, session.market_open_seconds * 1'000'000'000ULL + 20'000'000'000ULL);
+    EXPECT_EQ(a.events().front().order_id, snap.next_order_id);
+
+    fresh.fork(snap, 100);
+    InMemorySink c;
+    fresh.finishSession(c);
+    bool differs = c.size() != a.size();
+    for (size_t i = 0; !differs && i < a.size(); ++i) differs = !eventRecordsEqual(a.events()[i], c.events()[i]);
+    EXPECT_TRUE(differs) << "another seed is another branch";
+
+    ProducerSnapshot bad = snap;
+    bad.bids.resize(1);
+    EXPECT_THROW(fresh.fork(bad, 1), std::invalid_argument);
+}
+
+TEST(QrsdpProducer, IntensityScaleGatesArrivals) {
+    struct ClosedThenOpen final : IIntensityScale {
+        double at(double t) const override { return t < 5.0 ? 0.0 : 1.0; }
+        double bound(double t0, double t1) const override { return t1 > 5.0 || t0 >= 5.0 ? 1.0 : 0.0; }
+    } scale;
+    const TradingSession session = makeSession(77, 10);
+    Mt19937Rng rng(session.seed);
+    MultiLevelBook book;
+    SimpleImbalanceIntensity model(session.intensity_params);
+    CompetingIntensitySampler sampler(rng);
+    UnitSizeAttributeSampler attrs(rng, 0.5);
+    QrsdpProducer producer(rng, book, model, sampler, attrs);
+    producer.setIntensityScale(&scale);
+    InMemorySink sink;
+    producer.runSession(session, sink);
+    ASSERT_GT(sink.size(), 0u);
+    const uint64_t open_ns = static_cast<uint64_t>(session.market_open_seconds) * 1'000'000'000ULL;
+    EXPECT_GE(sink.events().front().ts_ns, open_ns + 5'000'000'000ULL);
+}
+
+TEST(QrsdpProducer, SeasonalityScalesArrivalsPerBucket) {
+    const TradingSession session = makeSession(78, 30);
+    const uint64_t open_ns = static_cast<uint64_t>(session.market_open_seconds) * 1'000'000'000ULL;
+    auto run = [&](const SeasonalityProfile* profile) {
+        Mt19937Rng rng(session.seed);
+        MultiLevelBook book;
+        SimpleImbalanceIntensity model(session.intensity_params);
+        CompetingIntensitySampler sampler(rng);
+        UnitSizeAttributeSampler attrs(rng, 0.5);
+        QrsdpProducer producer(rng, book, model, sampler, attrs);
+        producer.setSeasonality(profile);
+        InMemorySink sink;
+        producer.runSession(session, sink);
+        return sink.events().toVector();
+    };
+    const std::vector<EventRecord> plain = run(nullptr);
+
+    const SeasonalityProfile flat(10.0, {1.0});  // one bucket never ends: same draws
+    const std::vector<EventRecord> same = run(&flat);
+    ASSERT_EQ(same.size(), plain.size());
+    for (size_t i = 0; i < plain.size(); ++i) ASSERT_TRUE(eventRecordsEqual(same[i], plain[i]));
+
+    const SeasonalityProfile closed_middle(10.0, {1.0, 0.0, 3.0});
+    const std::vector<EventRecord> seasonal = run(&closed_middle);
+    size_t per_bucket[3] = {0, 0, 0};
+    for (const EventRecord& r : seasonal) ++per_bucket[(r.ts_ns - open_ns) / 10'000'000'000ULL];
+    EXPECT_GT(per_bucket[0], 0u);
+    EXPECT_EQ(per_bucket[1], 0u) << "zero multiplier: no arrivals in [10, 20)";
+    EXPECT_GT(per_bucket[2], 2 * per_bucket[0]);
+}
+
+// --- Self-exciting models ---
+
+static std::unique_ptr<HawkesIntensityModel> makeHawkes(const TradingSession& session,
+                                                        const HawkesParams& params) {
+    return std::make_unique<HawkesIntensityModel>(
+        params, std::make_shared<const SimpleImbalanceIntensity>(session.intensity_params));
+}
+
+static std::vector<EventRecord> runWith(const TradingSession& session, IIntensityModel& model) {
+    Mt19937Rng rng(session.seed);
+    MultiLevelBook book;
+    CompetingIntensitySampler sampler(rng);
+    UnitSizeAttributeSampler attrs(rng, 0.5, 0.5);
+    QrsdpProducer producer(rng, book, model, sampler, attrs);
+    InMemorySink sink;
+    producer.runSession(session, sink);
+    return sink.events().toVector();
+}
+
+TEST(QrsdpProducer, HawkesWithoutExcitationReproducesItsBaseline) {
+    const TradingSession session = makeSession(2024, 60, 5);
+    SimpleImbalanceIntensity simple(session.intensity_params);
+    const std::vector<EventRecord> plain = runWith(session, simple);
+    HawkesParams zero;                                  // no kernels
+    HawkesParams silent = makeDefaultHawkesParams();   // kernels that never fire
+    for (HawkesKernel& k : silent.kernels) k.alpha = HawkesMatrix{};
+    for (const HawkesParams* params : {&zero, &silent}) {
+        const auto hawkes = makeHawkes(session, *params);
+        const std::vector<EventRecord> same = runWith(session, *hawkes);
+        ASSERT_EQ(same.size(), plain.size());
+        for (size_t i = 0; i < plain.size(); ++i)
+            ASSERT_TRUE(eventRecordsEqual(same[i], plain[i])) << "record " << i;
+    }
+}
+
+TEST(QrsdpProducer, ConcreteInstantiationMatchesVirtualHawkesModel) {
+    TradingSession session = makeSession(31339, 30, 5);
+    const auto model1 = makeHawkes(session, makeDefaultHawkesParams());
+    const auto model2 = makeHawkes(session, makeDefaultHawkesParams());
+    expectConcreteMatchesVirtual(session, *model1, *model2, SelectionMode::LINEAR);
+}
+
+TEST(QrsdpProducer, HawkesExcitationClustersExecutions) {
+    const TradingSession session = makeSession(555, 600, 5);
+    const uint64_t open_ns = static_cast<uint64_t>(session.market_open_seconds) * 1'000'000'000ULL;
+    // Index of dispersion (variance / mean) of executions per 1 s window: about 1
+    // for the state-driven baseline, well above it once executions self-excite.
+    auto dispersion = [&](const std::vector<EventRecord>& events, size_t& executions) {
+        std::vector<double> counts(session.session_seconds, 0.0);
+        executions = 0;
+        for (const EventRecord& r : events) {
+            const auto type = static_cast<EventType>(r.type);
+            if (type != EventType::EXECUTE_BUY && type != EventType::EXECUTE_SELL) continue;
+            counts[(r.ts_ns - open_ns) / 1'000'000'000ULL] += 1.0;
+            ++executions;
+        }
+        double mean = 0.0, var = 0.0;
+        for (double c : counts) mean += c;
+        mean /= static_cast<double>(counts.size());
+        for (double c : counts) var += (c - mean) * (c - mean);
+        var /= static_cast<double>(counts.size() - 1);
+        return var / mean;
+    };
+    SimpleImbalanceIntensity simple(session.intensity_params);
+    const auto hawkes = makeHawkes(session, makeDefaultHawkesParams());
+    size_t plain_execs = 0, hawkes_execs = 0;
+    const double plain = dispersion(runWith(session, simple), plain_execs);
+    const double excited = dispersion(runWith(session, *hawkes), hawkes_execs);
+    EXPECT_GT(hawkes_execs, plain_execs);
+    EXPECT_GT(excited, 1.5 * plain) << "plain " << plain << " hawkes " << excited;
+}
+
+TEST(QrsdpProducer, HawkesForkContinuesTheExcitation) {
+    const TradingSession session = makeSession(606, 60, 5);
+    const auto model1 = makeHawkes(session, makeDefaultHawkesParams());
+    const auto model2 = makeHawkes(session, makeDefaultHawkesParams());
+    Mt19937Rng rng1(session.seed);
+    Mt19937Rng rng2(1);
+    MultiLevelBook book1;
+    MultiLevelBook book2;
+    CompetingIntensitySampler sampler1(rng1);
+    CompetingIntensitySampler sampler2(rng2);
+    UnitSizeAttributeSampler attr1(rng1, 0.5, 0.5);
+    UnitSizeAttributeSampler attr2(rng2, 0.5, 0.5);
+    QrsdpProducer straight(rng1, book1, *model1, sampler1, attr1);
+    QrsdpProducer forked(rng2, book2, *model2, sampler2, attr2);
+
+    straight.startSession(session);
+    straight.fastForward(20.0);
+    const ProducerSnapshot snap = straight.snapshot();
+    EXPECT_GT(model1->excitation(EventType::EXECUTE_BUY) + model1->excitation(EventType::EXECUTE_SELL), 0.0)
+        << "the snapshot is taken while excited";
+    forked.fork(snap, 7);
+    EXPECT_EQ(model2->clock(), model1->clock());
+    for (int i = 0; i < kNumEventTypes; ++i)
+        EXPECT_EQ(model2->excitation(static_cast<EventType>(i)), model1->excitation(static_cast<EventType>(i)));
+
+    // The straight-through run keeps its producer and model and only switches to
+    // the fork's stream: the fork must continue exactly as it does.
+    rng1.seed(7);
+    InMemorySink a;
+    straight.finishSession(a);
+    InMemorySink b;
+    forked.finishSession(b);
+    ASSERT_GT(a.size(), 0u);
+    ASSERT_EQ(a.size(), b.size());
+    for (size_t i = 0; i < a.size(); ++i)
+        ASSERT_TRUE(eventRecordsEqual(a.events()[i], b.events()[i])) << "record " << i;
+
+    // A model of another shape cannot take the history; a baseline-only one ignores it.
+    HawkesParams one_kernel = makeDefaultHawkesParams();
+    one_kernel.kernels.resize(1);
+    const auto other = makeHawkes(session, one_kernel);
+    QrsdpProducer other_producer(rng2, book2, *other, sampler2, attr2);
+    EXPECT_THROW(other_producer.fork(snap, 7), std::invalid_argument);
+    SimpleImbalanceIntensity simple(session.intensity_params);
+    QrsdpProducer simple_producer(rng2, book2, simple, sampler2, attr2);
+    EXPECT_NO_THROW(simple_producer.fork(snap, 7));
+}
+
+TEST(QrsdpProducer, HawkesResumeFromCheckpointIsByteIdentical) {
+    const std::string path = testing::TempDir() + "test_producer_hawkes_resume.qrsdp";
+    const TradingSession session = makeSession(607, 60, 5);
+    BinaryFileSinkOptions options;
+    options.chunk_capacity = 128;
+    options.checkpoint_interval = 5;
+    {
+        const auto model = makeHawkes(session, makeDefaultHawkesParams());
+        Mt19937Rng rng(0);
+        MultiLevelBook book;
+        CompetingIntensitySampler sampler(rng);
+        UnitSizeAttributeSampler attrs(rng, 0.5, 0.5);
+        QrsdpProducer producer(rng, book, *model, sampler, attrs);
+        BinaryFileSink sink(path, session, options);
+        sink.setCheckpointSource([&](BookCheckpoint& cp) { producer.captureCheckpoint(cp); });
+        producer.runSession(session, sink);
+        sink.close();
+    }
+    EventLogReader reader(path);
+    const auto all = reader.readAll();
+    ASSERT_GT(reader.checkpoints().size(), 2u);
+    const BookCheckpoint& cp = reader.checkpoints()[reader.checkpoints().size() / 2];
+    ASSERT_FALSE(cp.history.empty()) << "the excitation survives the file";
+    EXPECT_EQ(cp.history[0], cp.clock) << "the model's clock is the last event's";
+
+    const auto model = makeHawkes(session, makeDefaultHawkesParams());
+    Mt19937Rng rng(0);
+    MultiLevelBook book;
+    CompetingIntensitySampler sampler(rng);
+    UnitSizeAttributeSampler attrs(rng, 0.5, 0.5);
+    QrsdpProducer producer(rng, book, *model, sampler, attrs);
+    producer.resumeSession(session, cp);
+    std::vector<DiskEventRecord> rest;
+    EventRecord rec;
+    while (producer.stepEvents(1, &rec) == 1) rest.push_back(toDisk(rec));
+    ASSERT_EQ(cp.record_index + rest.size(), all.size());
+    EXPECT_EQ(std::memcmp(rest.data(), all.data() + cp.record_index, rest.size() * sizeof(DiskEventRecord)), 0);
+    std::remove(path.c_str());
+}
+
+TEST(QrsdpProducer, HawkesTakesNoSeasonality) {
+    const TradingSession session = makeSession(1, 10);
+    const auto model = makeHawkes(session, makeDefaultHawkesParams());
+    Mt19937Rng rng(session.seed);
+    MultiLevelBook book;
+    CompetingIntensitySampler sampler(rng);
+    UnitSizeAttributeSampler attrs(rng, 0.5, 0.5);
+    QrsdpProducer producer(rng, book, *model, sampler, attrs);
+    const SeasonalityProfile profile(5.0, {1.0, 2.0});
+    producer.setSeasonality(&profile);
+    EXPECT_THROW(producer.startSession(session), std::invalid_argument);
+    producer.setSeasonality(nullptr);
+    EXPECT_NO_THROW(producer.startSession(session));
+}
+
+// --- Book checkpoints ---
+
+static void applyRecord(MultiLevelBook& book, const DiskEventRecord& rec) {
+    SimEvent ev{};
+    ev.type = static_cast<EventType>(rec.type);
+    ev.side = static_cast<Side>(rec.side);
+    ev.price_ticks = rec.price_ticks;
+    ev.qty = rec.qty;
+    ev.order_id = rec.order_id;
+    book.apply(ev);
+}
+
+static void expectSameLevels(const MultiLevelBook& a, const MultiLevelBook& b, const char* what) {
+    ASSERT_EQ(a.numLevels(), b.numLevels());
+    for (size_t k = 0; k < a.numLevels(); ++k) {
+        EXPECT_EQ(a.bidPriceAtLevel(k), b.bidPriceAtLevel(k)) << what << " bid level " << k;
+        EXPECT_EQ(a.bidDepthAtLevel(k), b.bidDepthAtLevel(k)) << what << " bid level " << k;
+        EXPECT_EQ(a.askPriceAtLevel(k), b.askPriceAtLevel(k)) << what << " ask level " << k;
+        EXPECT_EQ(a.askDepthAtLevel(k), b.askDepthAtLevel(k)) << what << " ask level " << k;
+    }
+}
+
+TEST(QrsdpProducer, CheckpointsResumeReplayMidSession) {
+    const std::string path = testing::TempDir() + "test_producer_checkpoints.qrsdp";
+    const TradingSession session = makeSession(77, 60);
+    Mt19937Rng rng(session.seed);
+    MultiLevelBook book;
+    SimpleImbalanceIntensity model(session.intensity_params);
+    CompetingIntensitySampler sampler(rng);
+    UnitSizeAttributeSampler attrs(rng, 0.5);
+    QrsdpProducer producer(rng, book, model, sampler, attrs);
+
+    BinaryFileSinkOptions options;
+    options.chunk_capacity = 128;
+    options.checkpoint_interval = 4;
+    options.write_buffers = 2;  // checkpoints are taken on the appending thread either way
+    {
+        BinaryFileSink sink(path, session, options);
+        sink.setCheckpointSource([&](BookCheckpoint& cp) {
+            captureLevels(book, cp);
+            cp.next_order_id = producer.nextOrderId();
+        });
+        producer.runSession(session, sink);
+        sink.close();
+        EXPECT_GT(sink.checkpointsTaken(), 2u);
+    }
+
+    EventLogReader reader(path);
+    const auto& checkpoints = reader.checkpoints();
+    ASSERT_GT(checkpoints.size(), 2u);
+    EXPECT_EQ(reader.checkpointAtOrBefore(checkpoints.front().ts_ns - 1), nullptr);
+
+    BookSeed seed{};
+    seed.p0_ticks = reader.header().p0_ticks;
+    seed.levels_per_side = reader.header().levels_per_side;
+    seed.initial_depth = reader.header().initial_depth;
+    seed.initial_spread_ticks = reader.header().initial_spread_ticks;
+    const auto all = reader.readAll();
+
+    // Full replay up to each checkpoint reproduces its levels and order id.
+    MultiLevelBook full;
+    full.seed(seed);
+    size_t pos = 0;
+    for (const BookCheckpoint& cp : checkpoints) {
+        ASSERT_LE(cp.record_index, all.size());
+        for (; pos < cp.record_index; ++pos) applyRecord(full, all[pos]);
+        EXPECT_EQ(cp.ts_ns, all[pos - 1].ts_ns);
+        EXPECT_EQ(cp.next_order_id, all[pos - 1].order_id + 1);
+        MultiLevelBook restored;
+        restored.seed(seed);
+        restored.restore(cp.bids.data(), cp.asks.data());
+        expectSameLevels(full, restored, "checkpoint");
+    }
+
+    // Seeking: restore the checkpoint before T, replay the rest, match a full replay to T.
+    const uint64_t target = all[all.size() * 2 / 3].ts_ns;
+    const BookCheckpoint* cp = reader.checkpointAtOrBefore(target);
+    ASSERT_NE(cp, nullptr);
+    EXPECT_LE(cp->ts_ns, target);
+    MultiLevelBook resumed;
+    resumed.seed(seed);
+    resumed.restore(cp->bids.data(), cp->asks.data());
+    size_t replayed = 0;
+    reader.forEachRecordFrom(cp->record_index, [&](const DiskEventRecord& rec) {
+        if (rec.ts_ns > target) return;
+        applyRecord(resumed, rec);
+        ++replayed;
+    });
+    EXPECT_LT(replayed, all.size() / 2);
+
+    MultiLevelBook reference;
+    reference.seed(seed);
+    for (const auto& rec : all)
+        if (rec.ts_ns <= target) applyRecord(reference, rec);
+    expectSameLevels(reference, resumed, "seek");
+    std::remove(path.c_str());
+}
+
+TEST(QrsdpProducer, ResumesCrashedFileFromLastSyncedCheckpoint) {
+    namespace fs = std::filesystem;
+    const std::string path = testing::TempDir() + "test_producer_resume.qrsdp";
+    const std::string crashed = testing::TempDir() + "test_producer_resume_crashed.qrsdp";
+    const TradingSession session = makeSession(91, 60);
+    BinaryFileSinkOptions options;
+    options.chunk_capacity = 64;
+    options.checkpoint_interval = 3;
+    options.sync_interval = 2;
+
+    // Copy the file and its sidecar part-way through, as a crash would leave them.
+    {
+        Mt19937Rng rng(session.seed);
+        MultiLevelBook book;
+        SimpleImbalanceIntensity model(session.intensity_params);
+        CompetingIntensitySampler sampler(rng);
+        UnitSizeAttributeSampler attrs(rng, 0.5);
+        QrsdpProducer producer(rng, book, model, sampler, attrs);
+        BinaryFileSink sink(path, session, options);
+        sink.setCheckpointSource([&](BookCheckpoint& cp) {
+            captureLevels(book, cp);
+            cp.next_order_id = producer.nextOrderId();
+        });
+        producer.startSession(session);
+        EventRecord batch[32];
+        size_t n;
+        while (sink.chunksWritten() < 11 && (n = producer.stepEvents(32, batch)) > 0)
+            sink.appendBatch(batch, n);
+        ASSERT_EQ(sink.chunksWritten(), 11u);
+        fs::copy_file(path, crashed, fs::copy_options::overwrite_existing);
+        fs::copy_file(sidecarIndexPath(path), sidecarIndexPath(crashed),
+                      fs::copy_options::overwrite_existing);
+        sink.close();
+        EXPECT_FALSE(fs::exists(sidecarIndexPath(path))) << "close() removes the sidecar";
+    }
+    // Tear the tail: the sidecar's data plus half a chunk header's worth of garbage.
+    {
+        std::FILE* f = std::fopen(sidecarIndexPath(crashed).c_str(), "rb");
+        ASSERT_NE(f, nullptr);
+        SidecarHeader sh{};
+        ASSERT_EQ(std::fread(&sh, sizeof(sh), 1, f), 1u);
+        std::fclose(f);
+        EXPECT_EQ(sh.chunk_count, 10u);
+        fs::resize_file(crashed, sh.data_end + sizeof(ChunkHeader) / 2);
+    }
+    std::vector<DiskEventRecord> before;
+    {
+        EventLogReader torn(crashed);
+        EXPECT_EQ(torn.chunkCount(), 10u);
+        ASSERT_FALSE(torn.checkpoints().empty());
+        EXPECT_LE(torn.checkpoints().back().record_index, torn.totalRecords());
+        before = torn.readAll();
+    }
+
+    Mt19937Rng rng(0);
+    MultiLevelBook book;
+    SimpleImbalanceIntensity model(session.intensity_params);
+    CompetingIntensitySampler sampler(rng);
+    UnitSizeAttributeSampler attrs(rng, 0.5);
+    QrsdpProducer producer(rng, book, model, sampler, attrs);
+    options.resume = true;
+    uint64_t kept = 0;
+    {
+        BinaryFileSink sink(crashed, session, options);
+        ASSERT_NE(sink.resumePoint(), nullptr);
+        kept = sink.resumePoint()->records;
+        EXPECT_EQ(kept, sink.resumePoint()->checkpoint.record_index);
+        EXPECT_EQ(sink.recordsWritten(), sink.chunksWritten() * 64ULL);
+        sink.setCheckpointSource([&](BookCheckpoint& cp) {
+            captureLevels(book, cp);
+            cp.next_order_id = producer.nextOrderId();
+        });
+        producer.resumeSession(session, sink.resumePoint()->checkpoint);
+        EventRecord batch[32];
+        size_t n;
+        while ((n = producer.stepEvents(32, batch)) > 0) sink.appendBatch(batch, n);
+        sink.close();
+    }
+    EXPECT_FALSE(fs::exists(sidecarIndexPath(crashed)));
+
+    EventLogReader reader(crashed);
+    EXPECT_NE(reader.header().header_flags & kHeaderFlagHasIndex, 0u);
+    EXPECT_FALSE(reader.hasStats()) << "the first run's shift flags are not on disk";
+    ASSERT_TRUE(reader.hasChecksums());
+    EXPECT_EQ(reader.verify(VerifyMode::Checksums), producer.eventsWrittenThisSession())
+        << "kept chunks get their checksums back on resume";
+    const auto all = reader.readAll();
+    ASSERT_EQ(all.size(), producer.eventsWrittenThisSession());
+    ASSERT_GT(all.size(), kept);
+    for (size_t i = 0; i < kept; ++i)
+        ASSERT_EQ(all[i].order_id, before[i].order_id) << "kept record " << i;
+    for (size_t i = 1; i < all.size(); ++i)
+        ASSERT_LE(all[i - 1].ts_ns, all[i].ts_ns) << "record " << i;
+    EXPECT_EQ(all[kept].order_id, all[kept - 1].order_id + 1) << "order ids continue";
+
+    // The checkpoints still describe the book a full replay reaches.
+    BookSeed seed{};
+    seed.p0_ticks = session.p0_ticks;
+    seed.levels_per_side = session.levels_per_side;
+    seed.initial_depth = reader.header().initial_depth;
+    seed.initial_spread_ticks = session.initial_spread_ticks;
+    MultiLevelBook full;
+    full.seed(seed);
+    size_t pos = 0;
+    for (const BookCheckpoint& cp : reader.checkpoints()) {
+        for (; pos < cp.record_index; ++pos) applyRecord(full, all[pos]);
+        MultiLevelBook restored;
+        restored.seed(seed);
+        restored.restore(cp.bids.data(), cp.asks.data());
+        expectSameLevels(full, restored, "checkpoint");
+    }
+    for (; pos < all.size(); ++pos) applyRecord(full, all[pos]);
+    expectSameLevels(full, book, "close");
+
+    // A finished file is not resumed.
+    EXPECT_THROW(BinaryFileSink(crashed, session, options), std::runtime_error);
+    std::remove(path.c_str());
+    std::remove(crashed.c_str());
+}
+
+TEST(QrsdpProducer, ResumeFromCheckpointIsByteIdentical) {
+    const std::string path = testing::TempDir() + "test_producer_exact_resume.qrsdp";
+    const TradingSession session = makeSession(63, 60);
+    BinaryFileSinkOptions options;
+    options.chunk_capacity = 128;
+    options.checkpoint_interval = 5;
+    {
+        Xoshiro256ppRng rng(0);
+        MultiLevelBook book;
+        SimpleImbalanceIntensity model(session.intensity_params);
+        CompetingIntensitySampler sampler(rng);
+        UnitSizeAttributeSampler attrs(rng, 0.5);
+        QrsdpProducer producer(rng, book, model, sampler, attrs);
+        BinaryFileSink sink(path, session, options);
+        sink.setCheckpointSource([&](BookCheckpoint& cp) { producer.captureCheckpoint(cp); });
+        producer.runSession(session, sink);
+        sink.close();
+    }
+    EventLogReader reader(path);
+    const auto all = reader.readAll();
+    ASSERT_GT(reader.checkpoints().size(), 2u);
+    const BookCheckpoint& cp = reader.checkpoints()[reader.checkpoints().size() / 2];
+    ASSERT_GT(cp.rng_position, 0u) << "the producer state survives the file";
+    EXPECT_GE(cp.clock * 1e9, static_cast<double>(cp.ts_ns - reader.header().market_open_ns) - 1.0);
+
+    Xoshiro256ppRng rng(0);
+    MultiLevelBook book;
+    SimpleImbalanceIntensity model(session.intensity_params);
+    CompetingIntensitySampler sampler(rng);
+    UnitSizeAttributeSampler attrs(rng, 0.5);
+    QrsdpProducer producer(rng, book, model, sampler, attrs);
+    producer.resumeSession(session, cp);
+    std::vector<DiskEventRecord> rest;
+    EventRecord rec;
+    while (producer.stepEvents(1, &rec) == 1) rest.push_back(toDisk(rec));
+    ASSERT_EQ(cp.record_index + rest.size(), all.size());
+    EXPECT_EQ(std::memcmp(rest.data(), all.data() + cp.record_index, rest.size() * sizeof(DiskEventRecord)), 0)
+        << "the continuation is the uninterrupted stream";
+
+    // Without the producer state the old reseeded continuation still runs.
+    BookCheckpoint levels_only = cp;
+    levels_only.rng_position = 0;
+    producer.resumeSession(session, levels_only);
+    ASSERT_EQ(producer.stepEvents(1, &rec), 1u);
+    EXPECT_EQ(rec.order_id, cp.next_order_id);
+    std::remove(path.c_str());
+}
+
 }  // namespace test
 }  // namespace qrsdp
@@ -0,0 +1,294 @@
+#include <gtest/gtest.h>
+#include "producer/run_coordinator.h"
+#include "io/run_catalog.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace qrsdp {
+namespace test {
+
+namespace fs = std::filesystem;
+
+static RunConfig makeConfig(const std::string& dir, uint32_t num_days) {
+    RunConfig c{};
+    c.run_id = "coord_test";
+    c.output_dir = dir;
+    c.base_seed = 7;
+    c.p0_ticks = 10000;
+    c.session_seconds = 2;
+    c.levels_per_side = 5;
+    c.tick_size = 100;
+    c.initial_spread_ticks = 2;
+    c.initial_depth = 5;
+    c.intensity_params = {22.0, 0.2, 30.0, 1.0, 1.0, 0.5, 0.0};
+    c.num_days = num_days;
+    c.chunk_capacity = 64;
+    c.start_date = "2026-01-02";
+    c.threads = 2;
+    return c;
+}
+
+static void addSecurities(RunConfig& c) {
+    for (const char* sym : {"AAA", "BBB"}) {
+        SecurityConfig s{};
+        s.symbol = sym;
+        s.p0_ticks = sym[0] == 'A' ? 10000 : 5000;
+        s.tick_size = 100;
+        s.levels_per_side = 5;
+        s.initial_spread_ticks = 2;
+        s.initial_depth = 5;
+        s.intensity_params = c.intensity_params;
+        c.securities.push_back(s);
+    }
+}
+
+static std::string readFile(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+class RunCoordinatorTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        base_ = testing::TempDir() + "run_coordinator_" + std::to_string(reinterpret_cast<uintptr_t>(this));
+        fs::remove_all(base_);
+    }
+    void TearDown() override { fs::remove_all(base_); }
+
+    /// Runs config through a coordinator and `workers` in-process workers.
+    RunResult distributed(const RunConfig& config, const CoordinatorOptions& options, int workers,
+                          const std::function<void(uint16_t)>& before_workers = nullptr) {
+        RunCoordinator coordinator(config, options);
+        RunResult result;
+        std::exception_ptr error;
+        std::thread serve([&] {
+            try {
+                result = coordinator.run();
+            } catch (...) {
+                error = std::current_exception();
+            }
+        });
+        if (before_workers) before_workers(coordinator.port());
+        std::vector<std::thread> threads;
+        const std::string address = "127.0.0.1:" + std::to_string(coordinator.port());
+        for (int w = 0; w < workers; ++w)
+            threads.emplace_back([&, w] { runWorker(config, address, "w" + std::to_string(w)); });
+        for (auto& t : threads) t.join();
+        serve.join();
+        if (error) std::rethrow_exception(error);
+        return result;
+    }
+
+    /// The same days as a single SessionRunner::run, file for file.
+    void expectSameRun(const RunResult& whole, const std::string& whole_dir, const RunResult& dist,
+                       const std::string& dist_dir) {
+        ASSERT_EQ(dist.days.size(), whole.days.size());
+        EXPECT_EQ(dist.total_events, whole.total_events);
+        for (size_t i = 0; i < whole.days.size(); ++i) {
+            const DayResult& a = whole.days[i];
+            const DayResult& b = dist.days[i];
+            EXPECT_EQ(b.symbol, a.symbol);
+            EXPECT_EQ(b.date, a.date);
+            EXPECT_EQ(b.seed, a.seed);
+            EXPECT_EQ(b.open_ticks, a.open_ticks) << a.symbol << " " << a.date;
+            EXPECT_EQ(b.close_ticks, a.close_ticks);
+            EXPECT_EQ(b.events_written, a.events_written);
+            EXPECT_EQ(readFile(dist_dir + "/" + b.filename), readFile(whole_dir + "/" + a.filename))
+                << a.filename;
+        }
+        const RunCatalog catalog(dist_dir + "/" + kRunCatalogName);
+        EXPECT_EQ(catalog.size(), whole.days.size());
+        EXPECT_TRUE(fs::exists(dist_dir + "/manifest.json"));
+        for (const auto& entry : fs::directory_iterator(dist_dir)) {
+            EXPECT_EQ(entry.path().filename().string().rfind("catalog-", 0), std::string::npos)
+                << "shard catalogue left behind: " << entry.path();
+            EXPECT_EQ(entry.path().filename().string().rfind(".shard", 0), std::string::npos)
+                << "staging directory left behind: " << entry.path();
+        }
+    }
+
+    std::string base_;
+};
+
+TEST(RunShards, PlanSplitsEverySecurityIntoDayRanges) {
+    RunConfig config = makeConfig("unused", 5);
+    addSecurities(config);
+    const std::vector<RunShard> shards = planShards(config, 2);
+    ASSERT_EQ(shards.size(), 6u);
+    EXPECT_EQ(shards[2].security, 0u);
+    EXPECT_EQ(shards[2].first_day, 4u);
+    EXPECT_EQ(shards[2].num_days, 1u);
+    EXPECT_EQ(shards[3].security, 1u);
+    EXPECT_EQ(shards[3].open_ticks, 5000);
+    EXPECT_EQ(planShards(config, 0).size(), 2u);
+
+    const RunConfig shard = shardRunConfig(config, shards[4]);
+    ASSERT_EQ(shard.securities.size(), 1u);
+    EXPECT_EQ(shard.securities[0].symbol, "BBB");
+    EXPECT_EQ(shard.first_security, 1u);
+    EXPECT_EQ(shard.first_day, 2u);
+    EXPECT_EQ(shard.num_days, 2u);
+    EXPECT_EQ(shard.shard_name, "shard4");
+    EXPECT_EQ(SessionRunner::catalogName(shard), "catalog-shard4.qcat");
+    EXPECT_EQ(runDigest(shard), runDigest(shardRunConfig(config, shards[4])));
+    EXPECT_NE(runDigest(shard), runDigest(config));
+
+    config.realtime = true;
+    EXPECT_THROW(planShards(config, 2), std::invalid_argument);
+    config.realtime = false;
+    config.num_days = 0;
+    EXPECT_THROW(planShards(config, 2), std::invalid_argument);
+}
+
+TEST_F(RunCoordinatorTest, ChainedShardsOnSeveralWorkersMatchOneProcess) {
+    RunConfig whole = makeConfig(base_ + "/whole", 5);
+    addSecurities(whole);
+    const RunResult expected = SessionRunner().run(whole);
+
+    RunConfig config = whole;
+    config.output_dir = base_ + "/dist";
+    CoordinatorOptions options;
+    options.days_per_shard = 2;
+    const RunResult got = distributed(config, options, 3);
+    expectSameRun(expected, whole.output_dir, got, config.output_dir);
+}
+
+TEST_F(RunCoordinatorTest, IndependentDaysMatchOneProcess) {
+    RunConfig whole = makeConfig(base_ + "/whole", 4);
+    whole.independent_days = true;
+    const RunResult expected = SessionRunner().run(whole);
+
+    RunConfig config = whole;
+    config.output_dir = base_ + "/dist";
+    CoordinatorOptions options;
+    options.days_per_shard = 1;
+    const RunResult got = distributed(config, options, 2);
+    expectSameRun(expected, whole.output_dir, got, config.output_dir);
+}
+
+/// Connects, says HELLO with digest and returns the first line the coordinator sends.
+static std::string helloAndRead(uint16_t port, uint64_t digest, int& sock) {
+    sock = socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (connect(sock, reinterpret_cast<const struct sockaddr*>(&addr), sizeof(addr)) != 0) return "";
+    char hello[64];
+    std::snprintf(hello, sizeof(hello), "HELLO %016llx flaky\n", static_cast<unsigned long long>(digest));
+    if (send(sock, hello, std::strlen(hello), 0) <= 0) return "";
+    std::string line;
+    char c;
+    while (recv(sock, &c, 1, 0) == 1 && c != '\n') line += c;
+    return line;
+}
+
+TEST_F(RunCoordinatorTest, ShardOfAVanishedWorkerIsRedispatched) {
+    RunConfig whole = makeConfig(base_ + "/whole", 3);
+    const RunResult expected = SessionRunner().run(whole);
+
+    RunConfig config = whole;
+    config.output_dir = base_ + "/dist";
+    CoordinatorOptions options;
+    options.days_per_shard = 1;
+    options.max_attempts = 2;
+    const RunResult got = distributed(config, options, 1, [&](uint16_t port) {
+        int sock = -1;
+        EXPECT_EQ(helloAndRead(port, runDigest(config) ^ 1, sock).rfind("ERR ", 0), 0u)
+            << "another run's worker is turned away";
+        close(sock);
+        EXPECT_EQ(helloAndRead(port, runDigest(config), sock), "SHARD 0 0 0 1 10000 1");
+        fs::create_directories(config.output_dir + "/.shard0-1");
+        std::ofstream(config.output_dir + "/.shard0-1/2026-01-02.qrsdp") << "partial";
+        close(sock);  // dies holding shard 0, half written
+    });
+    expectSameRun(expected, whole.output_dir, got, config.output_dir);
+}
+
+/// Reads one line from sock (without its newline); empty once the peer hangs up.
+static std::string readLine(int sock) {
+    std::string line;
+    char c;
+    while (recv(sock, &c, 1, 0) == 1 && c != '\n') line += c;
+    return line;
+}
+
+TEST_F(RunCoordinatorTest, ALateWorkerPublishesNothing) {
+    RunConfig config = makeConfig(base_ + "/dist", 2);
+
+    // A coordinator that times the worker out while it runs its shard.
+    const int listener = socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    ASSERT_EQ(bind(listener, reinterpret_cast<const struct sockaddr*>(&addr), sizeof(addr)), 0);
+    ASSERT_EQ(listen(listener, 1), 0);
+    socklen_t len = sizeof(addr);
+    getsockname(listener, reinterpret_cast<struct sockaddr*>(&addr), &len);
+    std::vector<std::string> reported;
+    std::thread coordinator([&] {
+        const int sock = accept(listener, nullptr, nullptr);
+        readLine(sock);  // HELLO
+        const std::string shard = "SHARD 0 0 0 2 10000 1\n";
+        send(sock, shard.data(), shard.size(), 0);
+        for (std::string line = readLine(sock); !line.empty(); line = readLine(sock)) {
+            reported.push_back(line);
+            if (line.rfind("OK ", 0) == 0) break;
+        }
+        const std::string err = "ERR shard timed out\n";
+        send(sock, err.data(), err.size(), 0);
+        close(sock);
+    });
+    EXPECT_THROW(runWorker(config, "127.0.0.1:" + std::to_string(ntohs(addr.sin_port)), "late"),
+                 std::runtime_error);
+    coordinator.join();
+    close(listener);
+
+    ASSERT_EQ(reported.size(), 3u);
+    EXPECT_EQ(reported.back(), "OK 0");
+    ASSERT_TRUE(fs::exists(config.output_dir));
+    for (const auto& entry : fs::recursive_directory_iterator(config.output_dir))
+        ADD_FAILURE() << "a rejected attempt left " << entry.path();
+}
+
+TEST_F(RunCoordinatorTest, AShardFailingEveryAttemptFailsTheRun) {
+    RunConfig config = makeConfig(base_ + "/dist", 2);
+    CoordinatorOptions options;
+    options.max_attempts = 2;
+    RunConfig broken = config;
+    broken.output_dir = base_ + "/file";  // a file, so the worker cannot create the directory
+    fs::create_directories(base_);
+    std::ofstream(broken.output_dir) << "x";
+
+    RunCoordinator coordinator(config, options);
+    std::exception_ptr error;
+    std::thread serve([&] {
+        try {
+            coordinator.run();
+        } catch (...) {
+            error = std::current_exception();
+        }
+    });
+    EXPECT_THROW(runWorker(broken, "127.0.0.1:" + std::to_string(coordinator.port()), "bad"),
+                 std::runtime_error) << "the coordinator gives up and hangs up";
+    serve.join();
+    ASSERT_TRUE(error);
+    EXPECT_THROW(std::rethrow_exception(error), std::runtime_error);
+}
+
+}  // namespace test
+}  // namespace qrsdp
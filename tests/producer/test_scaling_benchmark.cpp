@@ -0,0 +1,112 @@
+#include <gtest/gtest.h>
+#include "producer/scaling_benchmark.h"
+
+#include <cstdio>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace qrsdp {
+namespace test {
+
+namespace fs = std::filesystem;
+
+static std::string readAll(std::FILE* f) {
+    std::rewind(f);
+    std::string text;
+    char buf[1024];
+    size_t n;
+    while ((n = std::fread(buf, 1, sizeof(buf), f)) > 0) text.append(buf, n);
+    return text;
+}
+
+TEST(ScalingBenchmark, SweepIsTheCartesianProductWithThreadsInnermost) {
+    ScalingSweep sweep;
+    sweep.levels = {5, 10};
+    sweep.models = {ModelType::SIMPLE, ModelType::HLR};
+    sweep.threads = {1, 2, 4};
+    const std::vector<ScalingCase> cases = sweep.cases();
+    ASSERT_EQ(cases.size(), 12u);
+    EXPECT_EQ(cases[0].threads, 1u);
+    EXPECT_EQ(cases[1].threads, 2u);
+    EXPECT_EQ(cases[2].threads, 4u);
+    EXPECT_EQ(cases[3].model, ModelType::HLR);
+    EXPECT_EQ(cases[6].levels_per_side, 10u);
+}
+
+TEST(ScalingBenchmark, ParsesSinkCombos) {
+    SinkCombo s = SinkCombo::FILE;
+    EXPECT_TRUE(parseSinkCombo("file+itch", s));
+    EXPECT_EQ(s, SinkCombo::FILE_ITCH);
+    EXPECT_TRUE(parseSinkCombo("file+kafka", s));
+    EXPECT_EQ(s, SinkCombo::FILE_KAFKA);
+    EXPECT_FALSE(parseSinkCombo("kafka", s));
+    EXPECT_EQ(s, SinkCombo::FILE_KAFKA);
+}
+
+TEST(ScalingBenchmark, EfficiencyIsRelativeToTheFewestThreadsOfEachSeries) {
+    std::vector<ScalingResult> results(4);
+    results[0].config.threads = 1;
+    results[0].events_per_sec = 1000.0;
+    results[1].config.threads = 4;
+    results[1].events_per_sec = 3000.0;
+    results[2].config.threads = 2;  // another series: different K
+    results[2].config.levels_per_side = 10;
+    results[2].events_per_sec = 500.0;
+    results[3].config.threads = 4;
+    results[3].config.levels_per_side = 10;
+    results[3].events_per_sec = 1000.0;
+    computeScalingEfficiency(results);
+    EXPECT_DOUBLE_EQ(results[0].scaling_efficiency, 1.0);
+    EXPECT_DOUBLE_EQ(results[1].scaling_efficiency, 0.75);
+    EXPECT_DOUBLE_EQ(results[2].scaling_efficiency, 1.0);
+    EXPECT_DOUBLE_EQ(results[3].scaling_efficiency, 1.0);
+}
+
+TEST(ScalingBenchmark, RunsACaseAndReportsIt) {
+    const std::string dir = testing::TempDir() + "scaling_benchmark_case";
+    RunConfig base{};
+    base.run_id = "scale_test";
+    base.base_seed = 7;
+    base.p0_ticks = 10000;
+    base.session_seconds = 5;
+    base.tick_size = 100;
+    base.initial_spread_ticks = 2;
+    base.initial_depth = 5;
+    base.intensity_params = {22.0, 0.2, 30.0, 1.0, 1.0, 0.5, 0.0};
+    base.num_days = 2;
+    base.start_date = "2026-01-02";
+
+    ScalingCase c;
+    c.securities = 2;
+    c.threads = 2;
+    c.chunk_capacity = 64;
+    const ScalingResult r = runScalingCase(base, c, dir);
+    EXPECT_GT(r.events, 0u);
+    EXPECT_GT(r.file_bytes, 0u);
+    EXPECT_GT(r.events_per_sec, 0.0);
+    EXPECT_GT(r.bytes_per_event, 0.0);
+    EXPECT_FALSE(fs::exists(dir));
+#ifdef __linux__
+    EXPECT_GT(r.peak_rss_bytes, 0u);
+#endif
+
+    std::FILE* f = std::tmpfile();
+    ASSERT_NE(f, nullptr);
+    writeScalingCsv(f, {r});
+    const std::string csv = readAll(f);
+    std::fclose(f);
+    EXPECT_EQ(csv.compare(0, 12, "levels,model"), 0) << csv;
+    EXPECT_NE(csv.find("\n5,simple,64,lz4:1,2,2,file,"), std::string::npos) << csv;
+
+    f = std::tmpfile();
+    ASSERT_NE(f, nullptr);
+    writeScalingJson(f, {r});
+    const std::string json = readAll(f);
+    std::fclose(f);
+    EXPECT_NE(json.find("\"sinks\": \"file\""), std::string::npos) << json;
+    EXPECT_NE(json.find("\"events\": " + std::to_string(r.events)), std::string::npos) << json;
+}
+
+}  // namespace test
+}  // namespace qrsdp
@@ -1,11 +1,33 @@
 #include <gtest/gtest.h>
 #include "producer/session_runner.h"
+#include "core/metrics.h"
 #include "io/event_log_format.h"
 #include "io/event_log_reader.h"
+#include "io/book_frame.h"
+#include "io/frame_ring.h"
+#include "io/hlr_curve_bundle.h"
+#include "io/in_memory_sink.h"
+#include "io/io_uring_writer.h"
+#include "io/log_export.h"
+#include "io/run_catalog.h"
+#include "io/session_container.h"
+#include "io/shm_ring_sink.h"
+#include "book/multi_level_book.h"
+#include "model/simple_imbalance_intensity.h"
+#include "producer/qrsdp_producer.h"
+#include "rng/mt19937_rng.h"
+#include "rng/rng_stream.h"
+#include "sampler/competing_intensity_sampler.h"
+#include "sampler/unit_size_attribute_sampler.h"
 
+#include <cmath>
+#include <cstring>
 #include <filesystem>
 #include <fstream>
+#include <map>
+#include <set>
 #include <string>
+#include <vector>
 
 namespace qrsdp {
 namespace test {
@@ -98,6 +120,7 @@ TEST(DateHelpers, NextBusinessDayMonthEnd) {
 
 TEST_F(SessionRunnerTest, SingleDay) {
     RunConfig config = makeTestConfig(dir_, 1);
+    config.seed_scheme = SeedScheme::SEQUENTIAL;
     SessionRunner runner;
     RunResult result = runner.run(config);
 
@@ -146,6 +169,7 @@ TEST_F(SessionRunnerTest, ContinuousChaining) {
 TEST_F(SessionRunnerTest, SeedSequential) {
     RunConfig config = makeTestConfig(dir_, 4);
     config.base_seed = 200;
+    config.seed_scheme = SeedScheme::SEQUENTIAL;
     SessionRunner runner;
     RunResult result = runner.run(config);
 
@@ -175,6 +199,7 @@ TEST_F(SessionRunnerTest, BusinessDatesSkipWeekend) {
 
 TEST_F(SessionRunnerTest, ManifestFormat) {
     RunConfig config = makeTestConfig(dir_, 2);
+    config.seed_scheme = SeedScheme::SEQUENTIAL;
     SessionRunner runner;
     RunResult result = runner.run(config);
 
@@ -266,6 +291,25 @@ TEST_F(SessionRunnerTest, MultiSecurityRun) {
             << "Missing file: " << d.filename;
     }
 
+    // Each finished day is in the catalogue with its footer stats.
+    const RunCatalog catalog((fs::path(dir_) / kRunCatalogName).string());
+    ASSERT_EQ(catalog.size(), result.days.size());
+    for (const auto& d : result.days) {
+        const CatalogDay* day = catalog.find(d.symbol, d.date);
+        ASSERT_NE(day, nullptr) << d.filename;
+        EXPECT_EQ(day->file, d.filename);
+        EXPECT_EQ(day->record_count, d.events_written);
+        EXPECT_EQ(day->seed, d.seed);
+        EXPECT_EQ(day->close_ticks, d.close_ticks);
+        EXPECT_EQ(day->file_bytes, d.file_size_bytes);
+        EXPECT_FALSE(day->in_container);
+        ASSERT_TRUE(day->has_stats);
+        uint64_t events = 0;
+        for (uint64_t n : day->stats.type_counts) events += n;
+        EXPECT_EQ(events, d.events_written);
+    }
+    EXPECT_EQ(catalog.query("BBB", "", result.days.front().date).size(), 1u);
+
     // Price chaining within each security
     int aaa_idx = -1;
     int bbb_idx = -1;
@@ -291,7 +335,7 @@ TEST_F(SessionRunnerTest, MultiSecuritySeedIndependence) {
     RunResult result = runner.run(config);
 
     ASSERT_EQ(result.days.size(), 2u);
-    // Different seeds for different securities (offset by kSeedStride=1024)
+    // Different seeds for different securities (keyed by security index)
     EXPECT_NE(result.days[0].seed, result.days[1].seed);
 }
 
@@ -343,5 +387,654 @@ TEST_F(SessionRunnerTest, SingleSecurityBackwardCompat) {
         << "securities array should not exist in v1.0 manifest";
 }
 
+TEST_F(SessionRunnerTest, RngAlgorithmRecordedAndReproducible) {
+    for (RngAlgorithm algo : {RngAlgorithm::MT19937, RngAlgorithm::XOSHIRO256PP,
+                              RngAlgorithm::PHILOX4X32}) {
+        std::vector<std::vector<DiskEventRecord>> runs;
+        for (int rep = 0; rep < 2; ++rep) {
+            const std::string dir = dir_ + "_rng" + std::to_string(rep);
+            RunConfig config = makeTestConfig(dir, 1);
+            config.rng = algo;
+            SessionRunner runner;
+            RunResult result = runner.run(config);
+            ASSERT_EQ(result.days.size(), 1u);
+
+            EventLogReader reader((fs::path(dir) / result.days[0].filename).string());
+            const FileHeader& h = reader.header();
+            EXPECT_EQ((h.header_flags & kHeaderRngMask) >> kHeaderRngShift,
+                      static_cast<uint32_t>(algo));
+            EXPECT_NE(h.header_flags & kHeaderFlagHasIndex, 0u);
+            EXPECT_EQ(h.seed, result.days[0].seed);
+            runs.push_back(reader.readAll());
+            fs::remove_all(dir);
+        }
+        ASSERT_FALSE(runs[0].empty());
+        ASSERT_EQ(runs[0].size(), runs[1].size());
+        EXPECT_EQ(std::memcmp(runs[0].data(), runs[1].data(),
+                              runs[0].size() * sizeof(DiskEventRecord)), 0);
+    }
+}
+
+/// Golden stream: qrsdp_run --seed 7 --model hlr --levels 5 --seconds 3600 --days 1
+/// from the build before Fenwick selection and incremental intensity updates,
+/// hashed record by record. LINEAR selection with sequential seeds must still
+/// produce it bit for bit (its record 17972 is where running totals once drifted
+/// by an ulp and moved ts_ns by 1 ns).
+TEST_F(SessionRunnerTest, LinearSelectionReproducesThePreFenwickStream) {
+    constexpr uint64_t kGoldenRecords = 246944;
+    constexpr uint64_t kGoldenFnv1a = 0x2321ca12b1d520c0ULL;
+
+    RunConfig config = makeTestConfig(dir_, 1, 3600);
+    config.base_seed = 7;
+    config.intensity_params = {20.0, 0.5, 15.0, 1.0, 1.0, 0.5, 0.4};
+    config.model_type = ModelType::HLR;
+    config.chunk_capacity = 0;
+    config.selection_mode = SelectionMode::LINEAR;
+    config.seed_scheme = SeedScheme::SEQUENTIAL;
+    const RunResult result = SessionRunner().run(config);
+    ASSERT_EQ(result.days.size(), 1u);
+
+    const std::vector<DiskEventRecord> records =
+        EventLogReader((fs::path(dir_) / result.days[0].filename).string()).readAll();
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (const DiskEventRecord& r : records) {
+        const unsigned char* p = reinterpret_cast<const unsigned char*>(&r);
+        for (size_t i = 0; i < sizeof(r); ++i) {
+            hash ^= p[i];
+            hash *= 0x100000001b3ULL;
+        }
+    }
+    ASSERT_EQ(records.size(), kGoldenRecords);
+    EXPECT_EQ(records[17972].ts_ns, 34460061025801ULL);
+    EXPECT_EQ(hash, kGoldenFnv1a);
+}
+
+// ----- Counter-based seeds -----
+
+TEST(SessionRunnerSeeds, CounterSeedsAreKeyedAndCollisionFree) {
+    RunConfig config{};
+    config.base_seed = 42;
+    config.seed_scheme = SeedScheme::COUNTER;
+    EXPECT_EQ(SessionRunner::daySeed(config, 3, 17), streamSeed(42, 3, 17));
+    EXPECT_EQ(SessionRunner::daySeed(config, 3, 17), SessionRunner::daySeed(config, 3, 17));
+
+    // The sequential scheme aliases security 1 day 0 with security 0 day 1024.
+    RunConfig legacy = config;
+    legacy.seed_scheme = SeedScheme::SEQUENTIAL;
+    EXPECT_EQ(SessionRunner::daySeed(legacy, 1, 0), SessionRunner::daySeed(legacy, 0, 1024));
+    EXPECT_NE(SessionRunner::daySeed(config, 1, 0), SessionRunner::daySeed(config, 0, 1024));
+
+    std::set<uint64_t> seen;
+    for (uint32_t sec = 0; sec < 8; ++sec)
+        for (uint32_t day = 0; day < 2048; ++day)
+            seen.insert(SessionRunner::daySeed(config, sec, day));
+    EXPECT_EQ(seen.size(), 8u * 2048u);
+
+    config.base_seed = 43;
+    EXPECT_NE(SessionRunner::daySeed(config, 3, 17), streamSeed(42, 3, 17));
+}
+
+TEST_F(SessionRunnerTest, CounterSeedDayRegeneratesIndependently) {
+    RunConfig config = makeTestConfig(dir_, 3);
+    SessionRunner runner;
+    RunResult result = runner.run(config);
+    ASSERT_EQ(result.days.size(), 3u);
+    EXPECT_EQ(result.days[2].seed, SessionRunner::daySeed(config, 0, 2));
+
+    // Rebuild day 3 alone from its seed and opening price, without days 1-2.
+    const std::string path = (fs::path(dir_) / result.days[2].filename).string();
+    EventLogReader reader(path);
+    const FileHeader& h = reader.header();
+    EXPECT_EQ(h.seed, result.days[2].seed);
+    TradingSession session{};
+    session.seed = h.seed;
+    session.p0_ticks = h.p0_ticks;
+    session.session_seconds = h.session_seconds;
+    session.levels_per_side = h.levels_per_side;
+    session.tick_size = h.tick_size;
+    session.initial_spread_ticks = h.initial_spread_ticks;
+    session.initial_depth = h.initial_depth;
+    session.market_open_seconds = static_cast<uint32_t>(h.market_open_ns / 1'000'000'000ULL);
+    session.intensity_params = config.intensity_params;
+    session.queue_reactive = config.queue_reactive;
+
+    Mt19937Rng rng(0);
+    MultiLevelBook book;
+    SimpleImbalanceIntensity model(config.intensity_params);
+    CompetingIntensitySampler sampler(rng, config.selection_mode);
+    UnitSizeAttributeSampler attrs(rng, 0.5, 0.5);
+    QrsdpProducer producer(rng, book, model, sampler, attrs);
+    InMemorySink sink;
+    producer.runSession(session, sink);
+
+    const auto disk = reader.readAll();
+    ASSERT_EQ(disk.size(), sink.size());
+    for (size_t i = 0; i < disk.size(); ++i) {
+        const EventRecord& r = sink.events()[i];
+        ASSERT_EQ(disk[i].ts_ns, r.ts_ns) << "record " << i;
+        ASSERT_EQ(disk[i].type, r.type) << "record " << i;
+        ASSERT_EQ(disk[i].price_ticks, r.price_ticks) << "record " << i;
+        ASSERT_EQ(disk[i].order_id, r.order_id) << "record " << i;
+    }
+}
+
+// ----- Day scheduler -----
+
+static std::vector<char> readFileBytes(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    return std::vector<char>(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+TEST_F(SessionRunnerTest, ThreadCountDoesNotChangeOutput) {
+    RunConfig config = makeMultiSecConfig(dir_ + "/t1", 3);
+    config.threads = 1;
+    RunResult serial = SessionRunner().run(config);
+
+    config.output_dir = dir_ + "/t4";
+    config.threads = 4;
+    RunResult parallel = SessionRunner().run(config);
+
+    ASSERT_EQ(serial.days.size(), 6u);
+    ASSERT_EQ(parallel.days.size(), serial.days.size());
+    for (size_t i = 0; i < serial.days.size(); ++i) {
+        EXPECT_EQ(parallel.days[i].symbol, serial.days[i].symbol);
+        EXPECT_EQ(parallel.days[i].date, serial.days[i].date);
+        EXPECT_EQ(parallel.days[i].open_ticks, serial.days[i].open_ticks);
+        EXPECT_EQ(parallel.days[i].close_ticks, serial.days[i].close_ticks);
+        EXPECT_EQ(readFileBytes(dir_ + "/t1/" + serial.days[i].filename),
+                  readFileBytes(dir_ + "/t4/" + parallel.days[i].filename))
+            << serial.days[i].filename;
+    }
+}
+
+TEST_F(SessionRunnerTest, BackgroundWriterDoesNotChangeOutput) {
+    RunConfig config = makeMultiSecConfig(dir_ + "/inline", 2);
+    RunResult inline_run = SessionRunner().run(config);
+
+    config.output_dir = dir_ + "/async";
+    config.write_buffers = 3;
+    RunResult async_run = SessionRunner().run(config);
+
+    config.output_dir = dir_ + "/async_workers";
+    config.workers = 1;
+    config.write_buffers = 2;
+    RunResult async_workers = SessionRunner().run(config);
+
+    ASSERT_EQ(async_run.days.size(), inline_run.days.size());
+    ASSERT_EQ(async_workers.days.size(), inline_run.days.size());
+    for (const auto& d : inline_run.days) {
+        const auto expected = readFileBytes(dir_ + "/inline/" + d.filename);
+        ASSERT_FALSE(expected.empty());
+        EXPECT_EQ(readFileBytes(dir_ + "/async/" + d.filename), expected) << d.filename;
+        EXPECT_EQ(readFileBytes(dir_ + "/async_workers/" + d.filename), expected) << d.filename;
+    }
+}
+
+TEST_F(SessionRunnerTest, IoUringWriterDoesNotChangeOutput) {
+    if (!IoUringWriter::available())
+        GTEST_SKIP() << "io_uring not built or not permitted here";
+    RunConfig config = makeMultiSecConfig(dir_ + "/stdio", 3);
+    RunResult stdio_run = SessionRunner().run(config);
+
+    IoUringWriter writer;
+    config.output_dir = dir_ + "/uring";
+    config.io_uring = &writer;
+    config.threads = 3;
+    config.write_buffers = 2;
+    RunResult uring_run = SessionRunner().run(config);
+
+    ASSERT_EQ(uring_run.days.size(), stdio_run.days.size());
+    for (const auto& d : stdio_run.days) {
+        const auto expected = readFileBytes(dir_ + "/stdio/" + d.filename);
+        ASSERT_FALSE(expected.empty());
+        EXPECT_EQ(readFileBytes(dir_ + "/uring/" + d.filename), expected) << d.filename;
+    }
+    EXPECT_GT(writer.writesSubmitted(), 0u);
+}
+
+TEST_F(SessionRunnerTest, ResumeKeepsFinishedDaysAndChainsFromThem) {
+    RunConfig config = makeTestConfig(dir_, 3, 20);
+    config.checkpoint_interval = 2;
+    config.sync_interval = 4;
+    const RunResult first = SessionRunner().run(config);
+    ASSERT_EQ(first.days.size(), 3u);
+    std::vector<std::vector<char>> files;
+    for (const auto& d : first.days) files.push_back(readFileBytes(dir_ + "/" + d.filename));
+
+    // Days 2 and 3 were never written: resuming regenerates them from day 1's replayed close.
+    fs::remove(fs::path(dir_) / first.days[1].filename);
+    fs::remove(fs::path(dir_) / first.days[2].filename);
+    config.resume = true;
+    const RunResult resumed = SessionRunner().run(config);
+    ASSERT_EQ(resumed.days.size(), 3u);
+    for (size_t i = 0; i < 3; ++i) {
+        EXPECT_EQ(resumed.days[i].close_ticks, first.days[i].close_ticks) << "day " << i;
+        EXPECT_EQ(resumed.days[i].events_written, first.days[i].events_written) << "day " << i;
+        EXPECT_EQ(readFileBytes(dir_ + "/" + first.days[i].filename), files[i]) << "day " << i;
+    }
+    EXPECT_EQ(resumed.days[0].write_seconds, 0.0) << "finished day is not regenerated";
+    EXPECT_EQ(RunCatalog(dir_ + "/" + kRunCatalogName).size(), 3u) << "kept days are listed once";
+}
+
+TEST_F(SessionRunnerTest, ContainerPacksTheSameSessions) {
+    RunConfig config = makeMultiSecConfig(dir_ + "/files", 2);
+    const RunResult files = SessionRunner().run(config);
+
+    config.output_dir = dir_ + "/packed";
+    config.container = "run.qrsc";
+    const RunResult packed = SessionRunner().run(config);
+
+    ASSERT_EQ(packed.days.size(), files.days.size());
+    EXPECT_FALSE(fs::exists(dir_ + "/packed/AAA")) << "day files are moved into the container";
+    SessionContainer container(dir_ + "/packed/run.qrsc");
+    ASSERT_EQ(container.size(), files.days.size());
+    for (const auto& d : files.days) {
+        const auto reader = container.open(d.symbol, d.date);
+        const auto expected = readFileBytes(dir_ + "/files/" + d.filename);
+        const ContainerSession* s = container.find(d.symbol, d.date);
+        ASSERT_EQ(s->size, expected.size()) << d.filename;
+        EXPECT_EQ(reader->totalRecords(), d.events_written) << d.filename;
+    }
+    std::ifstream manifest(dir_ + "/packed/manifest.json");
+    const std::string text((std::istreambuf_iterator<char>(manifest)), std::istreambuf_iterator<char>());
+    EXPECT_NE(text.find("\"container\": \"run.qrsc\""), std::string::npos);
+    const RunCatalog catalog(dir_ + "/packed/" + kRunCatalogName);
+    ASSERT_EQ(catalog.size(), files.days.size());
+    EXPECT_TRUE(catalog.days().front().in_container);
+}
+
+TEST_F(SessionRunnerTest, HLRBundleGivesEachSymbolItsCurves) {
+    const HLRParams a = makeDefaultHLRParams(5, 30);
+    HLRParams b = a;
+    for (IntensityCurve& c : b.lambda_L_bid) c.setTable(std::vector<double>(31, 3.0));
+    b.imbalance_sensitivity = 0.5;
+    fs::create_directories(dir_);
+    writeHLRCurveBundle(dir_ + "/curves.qrhc", {{"BBB", b}, {"AAA", a}});
+
+    RunConfig config = makeMultiSecConfig(dir_ + "/bundle", 2);
+    for (SecurityConfig& sec : config.securities) sec.model_type = ModelType::HLR;
+    config.hlr_bundle = std::make_shared<const HLRCurveBundle>(dir_ + "/curves.qrhc");
+    const RunResult bundled = SessionRunner().run(config);
+    config.output_dir = dir_ + "/bundle_workers";
+    config.workers = 2;
+    const RunResult workers = SessionRunner().run(config);
+
+    // Each symbol's files match a run that has its curves as hlr_params.
+    config.hlr_bundle.reset();
+    config.workers = 0;
+    config.output_dir = dir_ + "/a";
+    config.hlr_params = a;
+    const RunResult run_a = SessionRunner().run(config);
+    config.output_dir = dir_ + "/b";
+    config.hlr_params = b;
+    const RunResult run_b = SessionRunner().run(config);
+
+    ASSERT_EQ(bundled.days.size(), 4u);
+    for (const auto& d : bundled.days) {
+        const std::string expected_dir = d.symbol == "AAA" ? dir_ + "/a/" : dir_ + "/b/";
+        const auto got = readFileBytes(dir_ + "/bundle/" + d.filename);
+        EXPECT_EQ(got, readFileBytes(expected_dir + d.filename)) << d.filename;
+        EXPECT_EQ(got, readFileBytes(dir_ + "/bundle_workers/" + d.filename)) << d.filename;
+    }
+    EXPECT_NE(readFileBytes(dir_ + "/a/" + bundled.days[0].filename),
+              readFileBytes(dir_ + "/b/" + bundled.days[0].filename));
+}
+
+TEST_F(SessionRunnerTest, SecurityCurvesOverrideTheRunsParams) {
+    const HLRParams a = makeDefaultHLRParams(5, 30);
+    HLRParams b = a;
+    for (IntensityCurve& c : b.lambda_C_ask) c.setTable(std::vector<double>(31, 2.0));
+
+    RunConfig config = makeMultiSecConfig(dir_ + "/own", 1);
+    for (SecurityConfig& sec : config.securities) sec.model_type = ModelType::HLR;
+    config.hlr_params = a;
+    config.securities[1].hlr_curves = std::make_shared<const HLRModelCurves>(b);
+    const RunResult own = SessionRunner().run(config);
+
+    config.securities[1].hlr_curves.reset();
+    config.output_dir = dir_ + "/a";
+    SessionRunner().run(config);
+    config.output_dir = dir_ + "/b";
+    config.hlr_params = b;
+    SessionRunner().run(config);
+
+    ASSERT_EQ(own.days.size(), 2u);
+    for (const auto& d : own.days) {
+        const std::string expected_dir = d.symbol == "AAA" ? dir_ + "/a/" : dir_ + "/b/";
+        EXPECT_EQ(readFileBytes(dir_ + "/own/" + d.filename), readFileBytes(expected_dir + d.filename))
+            << d.filename;
+    }
+}
+
+TEST_F(SessionRunnerTest, HawkesModelMatchesAcrossSchedulers) {
+    RunConfig config = makeMultiSecConfig(dir_ + "/days", 2);
+    for (SecurityConfig& sec : config.securities) sec.model_type = ModelType::HAWKES;
+    const RunResult days = SessionRunner().run(config);
+    config.output_dir = dir_ + "/workers";
+    config.workers = 2;
+    SessionRunner().run(config);
+    config.workers = 0;
+    config.output_dir = dir_ + "/simple";
+    for (SecurityConfig& sec : config.securities) sec.model_type = ModelType::SIMPLE;
+    SessionRunner().run(config);
+
+    ASSERT_EQ(days.days.size(), 4u);
+    for (const auto& d : days.days) {
+        const auto got = readFileBytes(dir_ + "/days/" + d.filename);
+        EXPECT_EQ(got, readFileBytes(dir_ + "/workers/" + d.filename)) << d.filename;
+        EXPECT_NE(got, readFileBytes(dir_ + "/simple/" + d.filename)) << d.filename;
+    }
+
+    for (SecurityConfig& sec : config.securities) sec.model_type = ModelType::HAWKES;
+    // A fitted file runs on its own mu instead of the book's intensities: with
+    // no excitation that is a Poisson stream at sum(mu) events per second.
+    const HawkesParams book_baseline = config.hawkes;
+    config.hawkes.baseline = HawkesBaseline::MU;
+    config.hawkes.mu = {40.0, 40.0, 30.0, 30.0, 20.0, 20.0};
+    for (HawkesKernel& k : config.hawkes.kernels) k.alpha = HawkesMatrix{};
+    config.output_dir = dir_ + "/mu";
+    const RunResult mu_days = SessionRunner().run(config);
+    ASSERT_EQ(mu_days.days.size(), 4u);
+    const double expected = 180.0 * config.session_seconds;
+    for (const auto& d : mu_days.days) {
+        EXPECT_NEAR(static_cast<double>(d.events_written), expected, 5.0 * std::sqrt(expected)) << d.filename;
+        EXPECT_NE(readFileBytes(dir_ + "/mu/" + d.filename), readFileBytes(dir_ + "/days/" + d.filename));
+    }
+    config.hawkes = book_baseline;
+
+    config.output_dir = dir_ + "/bad";
+    config.seasonality = SeasonalityProfile(60.0, {1.0, 2.0});
+    EXPECT_THROW(SessionRunner().run(config), std::invalid_argument);
+    config.seasonality = SeasonalityProfile();
+    config.hawkes.kernels[0].alpha[0][0] = 100.0;  // explosive
+    EXPECT_THROW(SessionRunner().run(config), std::invalid_argument);
+}
+
+TEST_F(SessionRunnerTest, IndependentDaysOpenFromOvernightPath) {
+    RunConfig config = makeTestConfig(dir_ + "/a", 4);
+    config.independent_days = true;
+    config.threads = 3;
+    RunResult result = SessionRunner().run(config);
+    ASSERT_EQ(result.days.size(), 4u);
+
+    const auto opens = SessionRunner::overnightOpens(config, 0, config.p0_ticks, 4);
+    ASSERT_EQ(opens.size(), 4u);
+    EXPECT_EQ(opens[0], config.p0_ticks);
+    for (size_t d = 0; d < 4; ++d) {
+        EXPECT_EQ(result.days[d].open_ticks, opens[d]);
+        EXPECT_EQ(result.days[d].seed, SessionRunner::daySeed(config, 0, static_cast<uint32_t>(d)));
+    }
+    EXPECT_EQ(result.days[1].date, "2026-01-05");
+
+    config.output_dir = dir_ + "/b";
+    config.threads = 1;
+    RunResult again = SessionRunner().run(config);
+    ASSERT_EQ(again.days.size(), 4u);
+    for (size_t d = 0; d < 4; ++d) {
+        EXPECT_EQ(readFileBytes(dir_ + "/a/" + result.days[d].filename),
+                  readFileBytes(dir_ + "/b/" + again.days[d].filename));
+    }
+
+    std::ifstream in(fs::path(dir_) / "a" / "manifest.json");
+    std::string content((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    EXPECT_NE(content.find("\"independent_days\": true"), std::string::npos);
+}
+
+TEST(SessionRunnerSeeds, OvernightOpensKeyedAndFloored) {
+    RunConfig config = makeTestConfig("", 0);
+    const auto a = SessionRunner::overnightOpens(config, 0, 10000, 50);
+    const auto b = SessionRunner::overnightOpens(config, 1, 10000, 50);
+    EXPECT_EQ(a, SessionRunner::overnightOpens(config, 0, 10000, 50));
+    EXPECT_NE(a, b);
+
+    config.overnight_sigma_ticks = 0.0;
+    for (int32_t p : SessionRunner::overnightOpens(config, 0, 10000, 10)) EXPECT_EQ(p, 10000);
+
+    config.overnight_sigma_ticks = 1000.0;
+    for (int32_t p : SessionRunner::overnightOpens(config, 0, 5, 200)) EXPECT_GE(p, 2);
+}
+
+TEST_F(SessionRunnerTest, ArrowFilesMatchAChunkAlignedExport) {
+    RunConfig config = makeMultiSecConfig(dir_ + "/run", 2);
+    config.arrow = true;
+    const RunResult result = SessionRunner().run(config);
+    config.output_dir = dir_ + "/workers";
+    config.workers = 1;
+    SessionRunner().run(config);
+
+    ExportOptions options;
+    options.format = ExportFormat::Arrow;
+    options.out_dir = dir_ + "/export";
+    options.batch_rows = 0;
+    exportSessions(collectExportSessions({dir_ + "/run"}), options);
+    for (const auto& d : result.days) {
+        const std::string arrow = fs::path(d.filename).replace_extension(".arrow").string();
+        const auto expected = readFileBytes(dir_ + "/export/" + arrow);
+        ASSERT_FALSE(expected.empty()) << arrow;
+        EXPECT_EQ(readFileBytes(dir_ + "/run/" + arrow), expected) << arrow;
+        EXPECT_EQ(readFileBytes(dir_ + "/workers/" + arrow), expected) << arrow;
+    }
+}
+
+TEST_F(SessionRunnerTest, WorkersInterleaveWithSameOutput) {
+    RunConfig config = makeMultiSecConfig(dir_ + "/pool", 2);
+    SecurityConfig sec_c = config.securities[0];
+    sec_c.symbol = "CCC";
+    sec_c.p0_ticks = 30000;
+    config.securities.push_back(sec_c);
+    RunResult baseline = SessionRunner().run(config);
+    ASSERT_EQ(baseline.days.size(), 6u);
+
+    // Two workers, at most one open day file each: worker 0 runs AAA then CCC.
+    config.output_dir = dir_ + "/capped";
+    config.workers = 2;
+    config.max_open_files = 2;
+    RunResult capped = SessionRunner().run(config);
+
+    // One worker stepping all three securities together.
+    config.output_dir = dir_ + "/mixed";
+    config.workers = 1;
+    config.max_open_files = 0;
+    RunResult mixed = SessionRunner().run(config);
+
+    for (const RunResult* r : {&capped, &mixed}) {
+        ASSERT_EQ(r->days.size(), baseline.days.size());
+        EXPECT_EQ(r->total_events, baseline.total_events);
+        for (size_t i = 0; i < baseline.days.size(); ++i) {
+            EXPECT_EQ(r->days[i].symbol, baseline.days[i].symbol);
+            EXPECT_EQ(r->days[i].date, baseline.days[i].date);
+            EXPECT_EQ(r->days[i].open_ticks, baseline.days[i].open_ticks);
+            EXPECT_EQ(r->days[i].close_ticks, baseline.days[i].close_ticks);
+        }
+    }
+    for (const auto& d : baseline.days) {
+        const auto expected = readFileBytes(dir_ + "/pool/" + d.filename);
+        EXPECT_EQ(readFileBytes(dir_ + "/capped/" + d.filename), expected) << d.filename;
+        EXPECT_EQ(readFileBytes(dir_ + "/mixed/" + d.filename), expected) << d.filename;
+    }
+}
+
+TEST_F(SessionRunnerTest, RealtimeSharedClockSameOutput) {
+    RunConfig config = makeMultiSecConfig(dir_ + "/batch", 1);
+    RunResult baseline = SessionRunner().run(config);
+
+    // Realtime pacing at a speed that finishes in milliseconds: one shared
+    // clock, per-security pacers, and workers on a shared day origin.
+    config.realtime = true;
+    config.speed = 1e6;
+    config.output_dir = dir_ + "/shared";
+    RunResult shared = SessionRunner().run(config);
+
+    config.output_dir = dir_ + "/per_security";
+    config.pace_per_security = true;
+    RunResult per_security = SessionRunner().run(config);
+
+    config.output_dir = dir_ + "/workers";
+    config.pace_per_security = false;
+    config.workers = 2;
+    RunResult workers = SessionRunner().run(config);
+
+    for (const RunResult* r : {&shared, &per_security, &workers}) {
+        ASSERT_EQ(r->days.size(), baseline.days.size());
+        EXPECT_EQ(r->total_events, baseline.total_events);
+    }
+    for (const auto& d : baseline.days) {
+        const auto expected = readFileBytes(dir_ + "/batch/" + d.filename);
+        ASSERT_FALSE(expected.empty());
+        EXPECT_EQ(readFileBytes(dir_ + "/shared/" + d.filename), expected) << d.filename;
+        EXPECT_EQ(readFileBytes(dir_ + "/per_security/" + d.filename), expected) << d.filename;
+        EXPECT_EQ(readFileBytes(dir_ + "/workers/" + d.filename), expected) << d.filename;
+    }
+}
+
+TEST_F(SessionRunnerTest, ThreadPlacementLeavesOutputUnchanged) {
+    RunConfig config = makeMultiSecConfig(dir_ + "/floating", 2);
+    RunResult baseline = SessionRunner().run(config);
+
+    const std::vector<int> cpus = onlineCpus();
+    config.output_dir = dir_ + "/placed";
+    config.placement.cpus = {cpus.front()};
+    config.placement.io_cpus = {cpus.back()};
+    config.placement.numa = NumaPolicy::LOCAL;
+    config.write_buffers = 2;  // a writer thread per day file, started on the I/O CPU
+    RunResult placed = SessionRunner().run(config);
+
+    ASSERT_EQ(placed.days.size(), baseline.days.size());
+    for (const auto& d : baseline.days)
+        EXPECT_EQ(readFileBytes(dir_ + "/placed/" + d.filename),
+                  readFileBytes(dir_ + "/floating/" + d.filename)) << d.filename;
+
+    config.pace_cpu = 0;
+    EXPECT_THROW(SessionRunner().run(config), std::invalid_argument);
+}
+
+TEST_F(SessionRunnerTest, MetricsCountEventsAndChunks) {
+    RunConfig config = makeMultiSecConfig(dir_ + "/plain", 1);
+    RunResult plain = SessionRunner().run(config);
+
+    MetricsRegistry metrics;
+    config.output_dir = dir_ + "/metrics";
+    config.metrics = &metrics;
+    RunResult measured = SessionRunner().run(config);
+
+    ASSERT_EQ(measured.days.size(), plain.days.size());
+    uint32_t chunks = 0;
+    for (const auto& d : measured.days) {
+        EXPECT_EQ(readFileBytes(dir_ + "/metrics/" + d.filename),
+                  readFileBytes(dir_ + "/plain/" + d.filename)) << d.filename;
+        EXPECT_EQ(metrics.counter("qrsdp_events_total", "", "symbol=\"" + d.symbol + "\"").value(),
+                  d.events_written);
+        EXPECT_GT(metrics.histogram("qrsdp_step_ns", "", "symbol=\"" + d.symbol + "\"").count(), 0u);
+        EXPECT_EQ(metrics.histogram("qrsdp_sink_flush_ns", "", "symbol=\"" + d.symbol + "\"").count(), 1u);
+        chunks += d.chunks_written;
+    }
+    EXPECT_EQ(metrics.histogram("qrsdp_chunk_compress_ns", "").count(), chunks);
+}
+
+TEST_F(SessionRunnerTest, WorkersSingleSecurityIndependentDays) {
+    RunConfig config = makeTestConfig(dir_ + "/a", 3);
+    config.independent_days = true;
+    RunResult baseline = SessionRunner().run(config);
+
+    config.output_dir = dir_ + "/b";
+    config.workers = 4;  // clamped to the one security
+    RunResult workers = SessionRunner().run(config);
+    ASSERT_EQ(workers.days.size(), 3u);
+    for (size_t d = 0; d < 3; ++d) {
+        EXPECT_EQ(workers.days[d].open_ticks, baseline.days[d].open_ticks);
+        EXPECT_EQ(readFileBytes(dir_ + "/b/" + workers.days[d].filename),
+                  readFileBytes(dir_ + "/a/" + baseline.days[d].filename));
+    }
+}
+
+TEST_F(SessionRunnerTest, LiveFramesBracketEachDay) {
+    RunConfig config = makeTestConfig(dir_, 3);
+    fs::create_directories(dir_);
+    config.live_frames.path = dir_ + "/live.ring";
+    config.live_frames.frame_interval_ns = 100'000'000ULL;
+    config.live_frames.ring_bytes = 1u << 20;  // holds the whole run
+    RunResult result = SessionRunner().run(config);
+    ASSERT_EQ(result.days.size(), 3u);
+
+    FrameRingReader reader(config.live_frames.path, true);
+    FrameRingKind kind;
+    std::vector<char> payload;
+    for (uint32_t day = 0; day < 3; ++day) {
+        ASSERT_EQ(reader.poll(kind, payload), FrameRingReader::Poll::Message);
+        ASSERT_EQ(kind, kRingDayStart);
+        LiveDayStart start;
+        std::memcpy(&start, payload.data(), sizeof(start));
+        EXPECT_EQ(start.day_index, day);
+        EXPECT_EQ(start.num_days, 3u);
+        EXPECT_EQ(start.open_ticks, result.days[day].open_ticks);
+        EXPECT_EQ(std::string(start.date), result.days[day].date);
+
+        size_t frames = 0;
+        BookFrame last;
+        while (reader.poll(kind, payload) == FrameRingReader::Poll::Message && kind == kRingBookFrame) {
+            decodeBookFrame(payload.data(), payload.size(), last);
+            ++frames;
+        }
+        ASSERT_EQ(kind, kRingDayEnd);
+        LiveDayEnd end;
+        std::memcpy(&end, payload.data(), sizeof(end));
+        EXPECT_EQ(end.day_index, day);
+        EXPECT_EQ(end.events, result.days[day].events_written);
+        EXPECT_EQ(end.close_ticks, result.days[day].close_ticks);
+        EXPECT_GT(frames, 5u);
+        EXPECT_LE(frames, 21u) << "2 s at 100 ms, plus the final frame";
+        EXPECT_EQ(last.header.record_index, result.days[day].events_written);
+        EXPECT_EQ((last.header.best_bid_ticks + last.header.best_ask_ticks) / 2,
+                  result.days[day].close_ticks);
+    }
+    EXPECT_EQ(reader.poll(kind, payload), FrameRingReader::Poll::Closed);
+
+    config.output_dir = dir_ + "/workers";
+    config.workers = 2;
+    EXPECT_THROW(SessionRunner().run(config), std::invalid_argument);
+}
+
+TEST_F(SessionRunnerTest, EventBusCarriesEveryRecordOfEverySecurity) {
+    for (uint32_t workers : {0u, 2u}) {
+        RunConfig config = makeMultiSecConfig(dir_ + "/w" + std::to_string(workers), 2);
+        fs::create_directories(config.output_dir);
+        config.workers = workers;
+        config.shm_ring.path = config.output_dir + "/bus.ring";
+        config.shm_ring.ring_bytes = 8u << 20;  // holds the whole run
+        config.shm_ring.batch_records = 100;
+        const RunResult result = SessionRunner().run(config);
+
+        std::map<std::string, std::vector<DiskEventRecord>> got;  // "SYM/date"
+        ShmRingReader reader(config.shm_ring.path, true);
+        const EventBatchHeader* h = nullptr;
+        const DiskEventRecord* recs = nullptr;
+        uint64_t seq = 0;
+        while (reader.poll(h, recs) == ShmRingReader::Poll::Message) {
+            ASSERT_EQ(h->first_seq, seq);
+            seq += h->count;
+            EXPECT_LE(h->count, 100u);
+            EXPECT_EQ(std::string(h->symbol), h->security == 0 ? "AAA" : "BBB");
+            auto& day = got[std::string(h->symbol) + "/" + h->date];
+            day.insert(day.end(), recs, recs + h->count);
+        }
+        EXPECT_EQ(reader.lost(), 0u);
+        EXPECT_EQ(seq, result.total_events);
+
+        ASSERT_EQ(got.size(), result.days.size());
+        for (const DayResult& d : result.days) {
+            const std::vector<DiskEventRecord>& records = got[d.symbol + "/" + d.date];
+            ASSERT_EQ(records.size(), d.events_written) << d.filename;
+            EventLogReader file((fs::path(config.output_dir) / d.filename).string());
+            size_t i = 0;
+            file.forEachRecordFrom(0, [&](const DiskEventRecord& r) {
+                if (i < records.size()) {
+                    EXPECT_EQ(std::memcmp(&r, &records[i], sizeof(r)), 0) << d.filename << " " << i;
+                }
+                ++i;
+            });
+        }
+    }
+}
+
 }  // namespace test
 }  // namespace qrsdp
@@ -0,0 +1,121 @@
+#include <gtest/gtest.h>
+#include "producer/basic_qrsdp_producer.h"
+#include "producer/stage_profile.h"
+#include "io/in_memory_sink.h"
+#include "book/multi_level_book.h"
+#include "model/simple_imbalance_intensity.h"
+#include "rng/mt19937_rng.h"
+#include "sampler/competing_intensity_sampler.h"
+#include "sampler/unit_size_attribute_sampler.h"
+
+#include <cstdio>
+#include <string>
+
+namespace qrsdp {
+namespace test {
+
+static TradingSession makeSession(uint64_t seed) {
+    TradingSession s{};
+    s.seed = seed;
+    s.p0_ticks = 10000;
+    s.session_seconds = 20;
+    s.levels_per_side = 5;
+    s.tick_size = 100;
+    s.initial_spread_ticks = 2;
+    s.initial_depth = 5;
+    s.intensity_params.base_L = 20.0;
+    s.intensity_params.base_C = 0.1;
+    s.intensity_params.base_M = 5.0;
+    s.intensity_params.imbalance_sensitivity = 1.0;
+    s.intensity_params.cancel_sensitivity = 1.0;
+    s.intensity_params.epsilon_exec = 0.05;
+    return s;
+}
+
+template <class Profile>
+using SimpleProducer = BasicQrsdpProducer<Mt19937Rng, MultiLevelBook, SimpleImbalanceIntensity,
+                                          CompetingIntensitySampler, UnitSizeAttributeSampler,
+                                          InMemorySink, Profile>;
+
+TEST(StageProfile, ProfiledProducerMatchesDefaultAndCountsEveryStage) {
+    const TradingSession session = makeSession(4242);
+    Mt19937Rng rng1(0), rng2(0);
+    MultiLevelBook book1, book2;
+    SimpleImbalanceIntensity model1(session.intensity_params), model2(session.intensity_params);
+    CompetingIntensitySampler sampler1(rng1), sampler2(rng2);
+    UnitSizeAttributeSampler attr1(rng1, 0.5, 0.5), attr2(rng2, 0.5, 0.5);
+    SimpleProducer<NoStageProfile> plain(rng1, book1, model1, sampler1, attr1);
+    SimpleProducer<CycleStageProfile> profiled(rng2, book2, model2, sampler2, attr2);
+
+    InMemorySink sink1, sink2;
+    plain.runSession(session, sink1);
+    profiled.runSession(session, sink2);
+
+    ASSERT_GT(sink1.size(), 0u);
+    ASSERT_EQ(sink1.size(), sink2.size());
+    for (size_t i = 0; i < sink1.size(); ++i) {
+        ASSERT_EQ(sink1.events()[i].ts_ns, sink2.events()[i].ts_ns) << "record " << i;
+        ASSERT_EQ(sink1.events()[i].order_id, sink2.events()[i].order_id) << "record " << i;
+    }
+
+    const CycleStageProfile& p = profiled.profile();
+    const uint64_t n = sink2.size();
+    // The final draw crosses the session end after INTENSITY and DELTA_T only.
+    EXPECT_EQ(p.events(Stage::INTENSITY), n + 1);
+    EXPECT_EQ(p.events(Stage::DELTA_T), n + 1);
+    for (Stage s : {Stage::SELECT, Stage::ATTRS, Stage::APPLY}) {
+        EXPECT_EQ(p.events(s), n) << stageName(s);
+        EXPECT_EQ(p.histogram(s).count(), n) << stageName(s);
+    }
+    // runSession appends whole batches: one histogram sample per batch.
+    EXPECT_EQ(p.events(Stage::SINK), n);
+    const size_t batch = SimpleProducer<CycleStageProfile>::kBatchSize;
+    EXPECT_EQ(p.histogram(Stage::SINK).count(), (n + batch - 1) / batch);
+    EXPECT_GT(p.cycles(Stage::INTENSITY), 0u);
+}
+
+TEST(StageProfile, LapBatchMergeAndReset) {
+    CycleStageProfile a;
+    a.lapBatch(Stage::SINK, a.start(), 256);
+    a.lapBatch(Stage::SINK, a.start(), 0);  // empty batches are ignored
+    EXPECT_EQ(a.events(Stage::SINK), 256u);
+    EXPECT_EQ(a.histogram(Stage::SINK).count(), 1u);
+
+    CycleStageProfile b;
+    b.lap(Stage::APPLY, b.start());
+    b.merge(a);
+    EXPECT_EQ(b.events(Stage::SINK), 256u);
+    EXPECT_EQ(b.events(Stage::APPLY), 1u);
+
+    StageProfileTotals totals;
+    totals.merge(a);
+    totals.merge(b);
+    EXPECT_EQ(totals.snapshot().events(Stage::SINK), 512u);
+
+    b.reset();
+    EXPECT_EQ(b.events(Stage::SINK), 0u);
+    EXPECT_EQ(b.cycles(Stage::APPLY), 0u);
+    EXPECT_EQ(b.histogram(Stage::APPLY).count(), 0u);
+}
+
+TEST(StageProfile, TableListsEveryStage) {
+    CycleStageProfile p;
+    p.lap(Stage::INTENSITY, p.start());
+    std::FILE* f = std::tmpfile();
+    ASSERT_NE(f, nullptr);
+    writeStageTable(f, p);
+    std::rewind(f);
+    std::string text;
+    char buf[512];
+    size_t got;
+    while ((got = std::fread(buf, 1, sizeof(buf), f)) > 0) text.append(buf, got);
+    std::fclose(f);
+
+    EXPECT_EQ(text.compare(0, 8, "| Stage "), 0) << text;
+    for (const char* name : {"intensity", "delta_t", "select", "attrs", "apply", "sink"})
+        EXPECT_NE(text.find(std::string("| ") + name + " |"), std::string::npos) << name;
+    EXPECT_NE(text.find("| intensity | 1 |"), std::string::npos) << text;
+}
+
+}  // namespace test
+}  // namespace qrsdp
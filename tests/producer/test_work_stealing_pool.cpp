@@ -0,0 +1,99 @@
+#include <gtest/gtest.h>
+#include "producer/work_stealing_pool.h"
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+namespace qrsdp {
+namespace test {
+
+TEST(WorkStealingPool, RunsEverySubmittedTask) {
+    WorkStealingPool pool(4);
+    EXPECT_EQ(pool.size(), 4u);
+    std::atomic<int> count{0};
+    for (int i = 0; i < 1000; ++i) pool.submit([&count]() { count.fetch_add(1); });
+    pool.wait();
+    EXPECT_EQ(count.load(), 1000);
+}
+
+TEST(WorkStealingPool, WaitCoversNestedSubmits) {
+    WorkStealingPool pool(3);
+    std::atomic<int> count{0};
+    // Each chain resubmits itself from inside a worker, like chained trading days.
+    std::function<void(int)> chain = [&](int remaining) {
+        count.fetch_add(1);
+        if (remaining > 0) pool.submit([&chain, remaining]() { chain(remaining - 1); });
+    };
+    for (int c = 0; c < 8; ++c) pool.submit([&chain]() { chain(49); });
+    pool.wait();
+    EXPECT_EQ(count.load(), 8 * 50);
+}
+
+TEST(WorkStealingPool, IdleWorkersStealQueuedTasks) {
+    WorkStealingPool pool(4);
+    std::mutex mutex;
+    std::set<std::thread::id> ids;
+    std::atomic<int> count{0};
+    // All tasks land on one worker's deque; the others can only reach them by stealing.
+    pool.submit([&]() {
+        for (int i = 0; i < 64; ++i) {
+            pool.submit([&]() {
+                std::this_thread::sleep_for(std::chrono::milliseconds(2));
+                std::lock_guard<std::mutex> lock(mutex);
+                ids.insert(std::this_thread::get_id());
+                count.fetch_add(1);
+            });
+        }
+    });
+    pool.wait();
+    EXPECT_EQ(count.load(), 64);
+    EXPECT_GT(ids.size(), 1u);
+}
+
+TEST(WorkStealingPool, ReusableAfterWait) {
+    WorkStealingPool pool(2);
+    std::atomic<int> count{0};
+    pool.wait();  // nothing queued: returns immediately
+    for (int round = 0; round < 3; ++round) {
+        for (int i = 0; i < 10; ++i) pool.submit([&count]() { count.fetch_add(1); });
+        pool.wait();
+        EXPECT_EQ(count.load(), (round + 1) * 10);
+    }
+}
+
+TEST(WorkStealingPool, ZeroThreadsUsesDefault) {
+    WorkStealingPool pool(0);
+    EXPECT_EQ(pool.size(), WorkStealingPool::defaultThreadCount());
+    EXPECT_GE(pool.size(), 1u);
+}
+
+TEST(WorkStealingPool, PlacementPinsEachWorker) {
+    const std::vector<int> allowed = currentThreadCpus();
+    if (allowed.empty()) GTEST_SKIP() << "thread affinity not supported here";
+    ThreadPlacement placement;
+    placement.cpus = {allowed.back()};
+    {
+        WorkStealingPool sized(0, placement);
+        EXPECT_EQ(sized.size(), 1u);
+    }
+    WorkStealingPool pool(3, placement);
+    std::mutex mutex;
+    std::set<std::vector<int>> seen;
+    for (int i = 0; i < 32; ++i) {
+        pool.submit([&]() {
+            std::lock_guard<std::mutex> lock(mutex);
+            seen.insert(currentThreadCpus());
+        });
+    }
+    pool.wait();
+    ASSERT_EQ(seen.size(), 1u);
+    EXPECT_EQ(*seen.begin(), placement.cpus);
+}
+
+}  // namespace test
+}  // namespace qrsdp
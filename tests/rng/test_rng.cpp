@@ -0,0 +1,188 @@
+#include <gtest/gtest.h>
+#include "rng/mt19937_rng.h"
+#include "rng/xoshiro256pp_rng.h"
+#include "rng/philox_rng.h"
+#include "rng/poisson_sampler.h"
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+namespace qrsdp {
+namespace test {
+
+// --- Known-answer vectors ---
+
+TEST(QrsdpRng, SplitMix64ReferenceOutput) {
+    uint64_t x = 1234567;
+    EXPECT_EQ(splitmix64(x), 6457827717110365317ULL);
+    EXPECT_EQ(splitmix64(x), 3203168211198807973ULL);
+}
+
+TEST(QrsdpRng, Xoshiro256ppReferenceOutput) {
+    uint64_t s[4] = {1, 2, 3, 4};
+    EXPECT_EQ(Xoshiro256ppRng::step(s), 41943041ULL);
+    EXPECT_EQ(Xoshiro256ppRng::step(s), 58720359ULL);
+    EXPECT_EQ(Xoshiro256ppRng::step(s), 3588806011781223ULL);
+}
+
+TEST(QrsdpRng, PhiloxKnownAnswers) {
+    // Random123 kat_vectors, philox4x32_10.
+    const auto r0 = PhiloxRng::block({0u, 0u, 0u, 0u}, {0u, 0u});
+    EXPECT_EQ(r0, (PhiloxRng::Counter{0x6627e8d5u, 0xe169c58du, 0xbc57ac4cu, 0x9b00dbd8u}));
+    const auto r1 = PhiloxRng::block({0xffffffffu, 0xffffffffu, 0xffffffffu, 0xffffffffu},
+                                     {0xffffffffu, 0xffffffffu});
+    EXPECT_EQ(r1, (PhiloxRng::Counter{0x408f276du, 0x41c83b0eu, 0xa20bc7c6u, 0x6d5451fdu}));
+    const auto r2 = PhiloxRng::block({0x243f6a88u, 0x85a308d3u, 0x13198a2eu, 0x03707344u},
+                                     {0xa4093822u, 0x299f31d0u});
+    EXPECT_EQ(r2, (PhiloxRng::Counter{0xd16cfe09u, 0x94fdccebu, 0x5001e420u, 0x24126ea1u}));
+}
+
+// --- Stream properties (all backends) ---
+
+template <class Rng>
+class RngBackendTest : public ::testing::Test {};
+
+using Backends = ::testing::Types<Mt19937Rng, Xoshiro256ppRng, PhiloxRng>;
+TYPED_TEST_SUITE(RngBackendTest, Backends);
+
+TYPED_TEST(RngBackendTest, SeedReproducesStream) {
+    TypeParam a(99);
+    TypeParam b(1);
+    for (int i = 0; i < 300; ++i) a.uniform();
+    a.seed(7);
+    b.seed(7);
+    for (int i = 0; i < 1000; ++i) {
+        ASSERT_EQ(a.uniform(), b.uniform()) << "draw " << i;
+        ASSERT_EQ(a.exponential(), b.exponential()) << "draw " << i;
+    }
+}
+
+TYPED_TEST(RngBackendTest, FillMatchesSingleDraws) {
+    TypeParam a(2024);
+    TypeParam b(2024);
+    std::vector<double> u(1000), e(1000);
+    a.fillUniform(u.data(), u.size());
+    a.fillExponential(e.data(), e.size());
+    for (size_t i = 0; i < u.size(); ++i) ASSERT_EQ(u[i], b.uniform()) << "uniform " << i;
+    for (size_t i = 0; i < e.size(); ++i) ASSERT_EQ(e[i], b.exponential()) << "exponential " << i;
+}
+
+TYPED_TEST(RngBackendTest, SeekResumesAtPosition) {
+    // Mixed draws, then seed + seek(position) continues the stream; positions
+    // inside a block and on a block boundary.
+    for (int draws : {1, 300, 511, 512, 1000}) {
+        TypeParam a(31);
+        for (int i = 0; i < draws; ++i) i % 3 ? a.uniform() : a.exponential();
+        const uint64_t pos = a.position();
+        EXPECT_GE(pos, static_cast<uint64_t>(draws));
+        TypeParam b(0);
+        b.seed(31);
+        EXPECT_EQ(b.position(), 0u);
+        ASSERT_TRUE(b.seek(pos));
+        EXPECT_EQ(b.position(), pos);
+        for (int i = 0; i < 600; ++i) {
+            ASSERT_EQ(a.uniform(), b.uniform()) << "after " << draws << " draws, draw " << i;
+            ASSERT_EQ(a.exponential(), b.exponential()) << "after " << draws << " draws, draw " << i;
+        }
+        EXPECT_EQ(a.position(), b.position());
+    }
+}
+
+TYPED_TEST(RngBackendTest, UniformMomentsAndRange) {
+    TypeParam rng(12345);
+    const int N = 400000;
+    double sum = 0.0, sum_sq = 0.0;
+    for (int i = 0; i < N; ++i) {
+        const double u = rng.uniform();
+        ASSERT_GE(u, 0.0);
+        ASSERT_LT(u, 1.0);
+        sum += u;
+        sum_sq += u * u;
+    }
+    const double mean = sum / N;
+    EXPECT_NEAR(mean, 0.5, 0.005);
+    EXPECT_NEAR(sum_sq / N - mean * mean, 1.0 / 12.0, 0.002);
+}
+
+TYPED_TEST(RngBackendTest, ExponentialMomentsAndTail) {
+    TypeParam rng(777);
+    const int N = 400000;
+    double sum = 0.0, sum_sq = 0.0;
+    int above_3 = 0;
+    for (int i = 0; i < N; ++i) {
+        const double x = rng.exponential();
+        ASSERT_GT(x, 0.0);
+        ASSERT_TRUE(std::isfinite(x));
+        sum += x;
+        sum_sq += x * x;
+        if (x > 3.0) ++above_3;
+    }
+    const double mean = sum / N;
+    EXPECT_NEAR(mean, 1.0, 0.01);
+    EXPECT_NEAR(sum_sq / N - mean * mean, 1.0, 0.03);
+    EXPECT_NEAR(static_cast<double>(above_3) / N, std::exp(-3.0), 0.003);
+}
+
+TEST(QrsdpRng, Mt19937ExponentialMatchesLegacyInlineFormula) {
+    Mt19937Rng a(5);
+    Mt19937Rng b(5);
+    for (int i = 0; i < 1000; ++i) {
+        double u = b.uniform();
+        if (u <= 0.0 || u >= 1.0) u = 1e-10;
+        if (u < 1e-10) u = 1e-10;
+        ASSERT_EQ(a.exponential(), -std::log(u));
+    }
+}
+
+/// The sequential-search inversion PoissonSampler's table path must reproduce.
+static uint32_t sequentialPoisson(IRng& rng, double mean) {
+    double u = rng.uniform();
+    if (u <= 0.0 || u >= 1.0) u = 0.5;
+    double p = std::exp(-mean);
+    double s = p;
+    uint32_t k = 0;
+    while (u > s) {
+        ++k;
+        p *= mean / static_cast<double>(k);
+        s += p;
+    }
+    return k;
+}
+
+TEST(QrsdpPoissonSampler, TableMatchesSequentialSearch) {
+    for (double mean : {0.3, 4.0, 10.0, 250.0, 650.0}) {
+        Mt19937Rng a(9), b(9);
+        const PoissonSampler sampler(mean);
+        for (int i = 0; i < 20000; ++i) {
+            ASSERT_EQ(sampler.sample(a), sequentialPoisson(b, mean)) << "mean " << mean << " draw " << i;
+        }
+    }
+}
+
+TEST(QrsdpPoissonSampler, RejectionMomentsForLargeMean) {
+    for (double mean : {800.0, 5000.0}) {
+        Xoshiro256ppRng rng(4);
+        const PoissonSampler sampler(mean);
+        const int n = 200000;
+        double sum = 0.0, sum_sq = 0.0;
+        for (int i = 0; i < n; ++i) {
+            const double x = sampler.sample(rng);
+            sum += x;
+            sum_sq += x * x;
+        }
+        const double m = sum / n;
+        const double var = sum_sq / n - m * m;
+        EXPECT_NEAR(m, mean, 4.0 * std::sqrt(mean / n)) << "mean " << mean;
+        EXPECT_NEAR(var / mean, 1.0, 0.02) << "mean " << mean;
+    }
+}
+
+TEST(QrsdpPoissonSampler, DegenerateMeans) {
+    Mt19937Rng rng(1);
+    EXPECT_EQ(PoissonSampler(0.0).sample(rng), 0u);
+    EXPECT_EQ(PoissonSampler(-3.0).sample(rng), 0u);
+    EXPECT_EQ(PoissonSampler(2e6).sample(rng), 2000000u);
+}
+
+}  // namespace test
+}  // namespace qrsdp
@@ -1,9 +1,14 @@
 #include <gtest/gtest.h>
+#include "sampler/alias_table.h"
 #include "sampler/competing_intensity_sampler.h"
+#include "sampler/fenwick_tree.h"
+#include "sampler/thinning_sampler.h"
 #include "rng/mt19937_rng.h"
 #include "core/records.h"
+#include <algorithm>
 #include <cmath>
 #include <cstddef>
+#include <limits>
 #include <vector>
 
 namespace qrsdp {
@@ -81,5 +86,189 @@ TEST(QrsdpSampler, DeltaTPositiveAndFinite) {
     }
 }
 
+TEST(QrsdpSampler, DeltaTBatchMatchesEachBooksSampler) {
+    const size_t m = 100;
+    std::vector<Mt19937Rng> rngs_a, rngs_b;
+    for (size_t i = 0; i < m; ++i) {
+        rngs_a.emplace_back(1000 + i);
+        rngs_b.emplace_back(1000 + i);
+    }
+    std::vector<CompetingIntensitySampler> batched, single;
+    std::vector<CompetingIntensitySampler*> ptrs;
+    for (size_t i = 0; i < m; ++i) {
+        batched.emplace_back(rngs_a[i]);
+        single.emplace_back(rngs_b[i]);
+    }
+    for (auto& s : batched) ptrs.push_back(&s);
+
+    std::vector<double> lambda(m);
+    std::vector<double> dt(m);
+    for (int round = 0; round < 3; ++round) {
+        for (size_t i = 0; i < m; ++i) {
+            lambda[i] = 1.0 + static_cast<double>((i * 7 + round) % 50);
+            if (i % 13 == 4) lambda[i] = 0.0;  // no draw, as sampleDeltaT()
+            if (i % 31 == 9) lambda[i] = std::numeric_limits<double>::infinity();
+        }
+        CompetingIntensitySampler::sampleDeltaTBatch(ptrs.data(), lambda.data(), m, dt.data());
+        for (size_t i = 0; i < m; ++i)
+            EXPECT_EQ(dt[i], single[i].sampleDeltaT(lambda[i])) << "round " << round << " book " << i;
+    }
+}
+
+TEST(QrsdpFenwickTree, FindMatchesLinearScan) {
+    std::vector<double> w = {0.5, 0.0, 2.0, 1.5, 0.0, 0.0, 3.0, 0.25, 1.0};
+    FenwickTree tree;
+    tree.assign(w);
+    double total = 0.0;
+    for (double x : w) total += x;
+    EXPECT_DOUBLE_EQ(tree.total(), total);
+    for (int k = 0; k < 1000; ++k) {
+        const double target = total * (k + 0.5) / 1000.0;
+        double cum = 0.0;
+        size_t expected = w.size() - 1;
+        for (size_t i = 0; i < w.size(); ++i) {
+            cum += w[i];
+            if (target < cum) { expected = i; break; }
+        }
+        EXPECT_EQ(tree.find(target), expected) << "target " << target;
+    }
+}
+
+TEST(QrsdpFenwickTree, PointUpdatesMatchRebuild) {
+    std::vector<double> w(34, 1.0);
+    FenwickTree incremental;
+    incremental.assign(w);
+    uint32_t x = 7;
+    for (int step = 0; step < 500; ++step) {
+        x = x * 1664525u + 1013904223u;
+        const size_t i = x % w.size();
+        w[i] = static_cast<double>((x >> 8) % 50) * 0.1;  // includes zeros
+        incremental.set(i, w[i]);
+    }
+    FenwickTree rebuilt;
+    rebuilt.assign(w);
+    EXPECT_NEAR(incremental.total(), rebuilt.total(), 1e-9);
+    for (int k = 0; k < 200; ++k) {
+        const double target = rebuilt.total() * (k + 0.5) / 200.0;
+        const size_t idx = incremental.find(target);
+        EXPECT_EQ(idx, rebuilt.find(target));
+        EXPECT_GT(w[idx], 0.0);
+    }
+}
+
+TEST(QrsdpSampler, FenwickLoadedIndexRatios) {
+    Mt19937Rng rng(4242);
+    CompetingIntensitySampler sampler(rng, SelectionMode::FENWICK);
+    ASSERT_TRUE(sampler.supportsIncrementalWeights());
+    sampler.loadWeights({1.0, 0.0, 1.0, 1.0});
+    sampler.updateWeight(1, 2.0);
+    sampler.updateWeight(3, 4.0);  // weights now {1, 2, 1, 4}
+    const int N = 200000;
+    std::vector<int> counts(4, 0);
+    for (int i = 0; i < N; ++i) counts[sampler.sampleLoadedIndex()]++;
+    const double expected[4] = {1.0 / 8, 2.0 / 8, 1.0 / 8, 4.0 / 8};
+    for (int k = 0; k < 4; ++k) {
+        const double actual = static_cast<double>(counts[k]) / N;
+        EXPECT_NEAR(actual, expected[k], 0.01) << "index " << k;
+    }
+}
+
+TEST(QrsdpSampler, LinearModeDoesNotTakeIncrementalPath) {
+    Mt19937Rng rng(1);
+    CompetingIntensitySampler sampler(rng);
+    EXPECT_EQ(sampler.mode(), SelectionMode::LINEAR);
+    EXPECT_FALSE(sampler.supportsIncrementalWeights());
+}
+
+namespace {
+
+/// at() = value_early before t_switch, value_late after; bound() = bound_factor * sup.
+struct StepScale final : IIntensityScale {
+    double t_switch, value_early, value_late, bound_factor;
+    StepScale(double ts, double early, double late, double factor = 1.0)
+        : t_switch(ts), value_early(early), value_late(late), bound_factor(factor) {}
+    double at(double t) const override { return t < t_switch ? value_early : value_late; }
+    double bound(double t0, double t1) const override {
+        double m = t0 < t_switch ? value_early : value_late;
+        if (t1 > t_switch) m = std::max(m, value_late);
+        return m * bound_factor;
+    }
+};
+
+size_t countEvents(ThinningSampler& thin, double t0, double t_end, double lambda,
+                   const IIntensityScale& scale, double* first = nullptr) {
+    size_t n = 0;
+    double t = t0;
+    while ((t = thin.nextEventTime(t, t_end, lambda, scale)) < t_end) {
+        if (n == 0 && first) *first = t;
+        ++n;
+    }
+    return n;
+}
+
+}  // namespace
+
+TEST(QrsdpThinningSampler, ConstantScaleGivesPoissonRate) {
+    Mt19937Rng rng(21);
+    ThinningSampler thin(rng);
+    const StepScale flat(0.0, 1.0, 1.0);
+    const size_t n = countEvents(thin, 0.0, 1000.0, 10.0, flat);
+    EXPECT_NEAR(static_cast<double>(n), 10000.0, 400.0);
+    EXPECT_EQ(thin.accepted(), thin.candidates()) << "exact bound: nothing rejected";
+}
+
+TEST(QrsdpThinningSampler, FollowsStepScale) {
+    Mt19937Rng rng(22);
+    ThinningSampler thin(rng, 7.0);  // windows straddle the switch
+    const StepScale step(50.0, 0.0, 3.0);
+    double first = 0.0;
+    const size_t n = countEvents(thin, 0.0, 100.0, 10.0, step, &first);
+    EXPECT_GE(first, 50.0) << "no events while the scale is zero";
+    EXPECT_NEAR(static_cast<double>(n), 1500.0, 150.0);
+}
+
+TEST(QrsdpThinningSampler, LooseBoundRejectsButKeepsRate) {
+    Mt19937Rng rng(23);
+    ThinningSampler thin(rng);
+    const StepScale loose(0.0, 0.5, 0.5, 4.0);  // bound 2.0 vs actual 0.5
+    const size_t n = countEvents(thin, 0.0, 2000.0, 10.0, loose);
+    EXPECT_NEAR(static_cast<double>(n), 10000.0, 400.0);
+    const double acceptance =
+        static_cast<double>(thin.accepted()) / static_cast<double>(thin.candidates());
+    EXPECT_NEAR(acceptance, 0.25, 0.02);
+}
+
+TEST(QrsdpAliasTable, FrequenciesMatchWeights) {
+    std::vector<double> w = {1.0, 0.0, 0.6065, 0.3679, 0.2231, 0.0, 0.1353, 0.0821};
+    AliasTable table;
+    table.assign(w);
+    double total = 0.0;
+    for (double x : w) total += x;
+    EXPECT_DOUBLE_EQ(table.total(), total);
+    Mt19937Rng rng(77);
+    const int n = 400000;
+    std::vector<int> counts(w.size(), 0);
+    for (int i = 0; i < n; ++i) ++counts[table.sample(rng.uniform())];
+    for (size_t i = 0; i < w.size(); ++i) {
+        const double p = w[i] / total;
+        if (p == 0.0) {
+            EXPECT_EQ(counts[i], 0) << "zero-weight index " << i;
+        } else {
+            EXPECT_NEAR(counts[i] / static_cast<double>(n), p, 4.0 * std::sqrt(p * (1 - p) / n)) << "index " << i;
+        }
+    }
+}
+
+TEST(QrsdpAliasTable, SingleAndDegenerateWeights) {
+    AliasTable table;
+    table.assign({2.5});
+    EXPECT_EQ(table.sample(0.0), 0u);
+    EXPECT_EQ(table.sample(0.999999), 0u);
+    table.assign({0.0, 3.0, 0.0});
+    for (double u : {0.0, 0.2, 0.5, 0.9, 0.9999999}) EXPECT_EQ(table.sample(u), 1u) << u;
+    table.assign({0.0, -1.0});
+    EXPECT_EQ(table.total(), 0.0);
+}
+
 }  // namespace test
 }  // namespace qrsdp
@@ -0,0 +1,14 @@
+#pragma once
+
+#include <cstddef>
+
+namespace qrsdp {
+namespace test {
+
+/// Number of global operator new calls made by the test binary so far.
+/// Backed by a replacement operator new in alloc_counter.cpp; compare two
+/// readings around a code path to assert it performs no heap allocation.
+size_t allocationCount();
+
+}  // namespace test
+}  // namespace qrsdp
@@ -1,8 +1,14 @@
 // Minimal QRSDP real-time debugging UI: ImGui + ImPlot + GLFW + OpenGL3.
 // Shows price over time, order book ladder, event table, and diagnostics.
+//
+// The producer runs on its own thread and hands every event to the render
+// thread through a lock-free SPSC ring; the render thread keeps fixed-size plot
+// histories and decimates them to a few points per pixel, so frames stay cheap
+// however fast the simulation runs.
 
 #include "producer/qrsdp_producer.h"
-#include "io/in_memory_sink.h"
+#include "io/i_event_sink.h"
+#include "io/spsc_ring.h"
 #include "book/multi_level_book.h"
 #include "model/simple_imbalance_intensity.h"
 #include "model/hlr_params.h"
@@ -12,6 +18,7 @@
 #include "sampler/unit_size_attribute_sampler.h"
 #include "core/records.h"
 #include "core/event_types.h"
+#include "core/plot_series.h"
 
 #include "imgui.h"
 #include "imgui_impl_glfw.h"
@@ -19,31 +26,65 @@
 #include "implot.h"
 #include <GLFW/glfw3.h>
 #include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <cmath>
 #include <cstdint>
 #include <cstdio>
 #include <cstring>
 #include <deque>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <vector>
 
 namespace {
 
-constexpr size_t kPriceHistoryMax = 200000;
+constexpr size_t kPriceHistoryMax = 500000;   // points per price series (fixed memory)
+constexpr size_t kShiftHistoryMax = 4096;
 constexpr size_t kEventTableMax = 200;
-constexpr size_t kDepthHistoryMax = 10000;
+constexpr size_t kDepthHistoryMax = 100000;
+constexpr size_t kSampleRingCapacity = 1u << 18;  // events in flight to the render thread
+constexpr size_t kStepChunk = 4096;           // events per hold of the simulation lock
 constexpr int kLadderLevels = 10;
 
-struct PricePoint {
+/// One event as the simulation thread hands it over, with the top of book after it.
+struct Sample {
     double t = 0.0;
-    double mid = 0.0;
-    double bid = 0.0;
-    double ask = 0.0;
+    uint64_t ts_ns = 0;
+    uint64_t order_id = 0;
+    int32_t price_ticks = 0;
+    uint32_t qty = 0;
+    int32_t bid = 0;
+    int32_t ask = 0;
+    uint32_t bid_depth = 0;
+    uint32_t ask_depth = 0;
+    uint8_t type = 0;
+    uint8_t side = 0;
     bool shift_up = false;
     bool shift_down = false;
 };
 
+/// Book and producer state the render thread copies once per frame.
+struct BookSnapshot {
+    double t = 0.0;
+    uint64_t producer_shifts = 0;
+    qrsdp::Level bid{};
+    qrsdp::Level ask{};
+    qrsdp::BookFeatures features{};
+    qrsdp::Intensities intensities{};
+    std::vector<int32_t> bid_prices, ask_prices;
+    std::vector<uint32_t> bid_depths, ask_depths;
+};
+
+/// Keeps only the latest record; the UI's history lives in its own fixed buffers.
+class LastRecordSink final : public qrsdp::IEventSink {
+public:
+    void append(const qrsdp::EventRecord& rec) override { last = rec; }
+    qrsdp::EventRecord last{};
+};
+
 struct EventRow {
     double t_sec = 0.0;
     uint64_t ts_ns = 0;
@@ -103,7 +144,6 @@ int main(int argc, char** argv) {
     qrsdp::CompetingIntensitySampler eventSampler(rng);
     qrsdp::UnitSizeAttributeSampler* attrSampler = nullptr;
     qrsdp::QrsdpProducer* producer = nullptr;
-    qrsdp::InMemorySink sink;
 
     // Session params (UI-driven) — defaults match CLI/production tuning
     uint64_t ui_seed = 777;
@@ -121,7 +161,9 @@ int main(int argc, char** argv) {
     double ui_spread_improve = 0.5;
     double ui_alpha = 0.5;
     int ui_step_N = 10;
-    int ui_max_events_per_frame = 100;
+    double ui_seek_t = 60.0;
+    double ui_events_per_sec = 20000.0;
+    int ui_decimation = 0;  // 0 = min-max, 1 = LTTB
     bool ui_running = false;
     bool ui_show_mid = true;
     bool ui_show_bid_ask = true;
@@ -149,11 +191,14 @@ int main(int argc, char** argv) {
         new qrsdp::QrsdpProducer(rng, book, *intensityModel, eventSampler, *attrSampler));
     producer = producerPtr.get();
 
-    // History (ring buffers)
-    std::deque<PricePoint> price_history;
+    // History: fixed-capacity ring buffers, filled from the simulation thread's samples
+    qrsdp::PlotSeries mid_history(kPriceHistoryMax);
+    qrsdp::PlotSeries bid_history(kPriceHistoryMax);
+    qrsdp::PlotSeries ask_history(kPriceHistoryMax);
+    qrsdp::PlotSeries shift_history(kShiftHistoryMax);
+    qrsdp::PlotSeries depth_bid_best_history(kDepthHistoryMax);  // x = event index
+    qrsdp::PlotSeries depth_ask_best_history(kDepthHistoryMax);
     std::deque<EventRow> event_rows;
-    std::deque<double> depth_bid_best_history;
-    std::deque<double> depth_ask_best_history;
 
     // Diagnostics
     uint64_t event_count = 0;
@@ -165,6 +210,27 @@ int main(int argc, char** argv) {
     bool invariants_ok = true;
     char invariant_msg[256] = "";
 
+    // Simulation thread. It holds sim_mutex while stepping a chunk of events;
+    // the render thread takes it to reset, seek, queue steps and snapshot the
+    // book. The events themselves cross in sample_ring, without a lock.
+    qrsdp::SpscRing<Sample> sample_ring(kSampleRingCapacity);
+    std::mutex sim_mutex;
+    std::atomic<bool> sim_quit{false};
+    std::atomic<bool> sim_running{false};
+    std::atomic<bool> sim_finished{false};  // the session ended while running
+    std::atomic<double> sim_rate{ui_events_per_sec};
+    std::atomic<bool> ui_waiting{false};    // the render thread wants sim_mutex
+    uint64_t steps_requested = 0;           // guarded by sim_mutex: Step 1 / Step N
+    Sample pending{};                       // guarded by sim_mutex: refused by a full ring
+    bool has_pending = false;
+
+    auto lockSim = [&]() {
+        ui_waiting.store(true);
+        std::unique_lock<std::mutex> lock(sim_mutex);
+        ui_waiting.store(false);
+        return lock;
+    };
+
     auto buildSession = [&]() {
         qrsdp::TradingSession s{};
         s.seed = ui_seed;
@@ -185,7 +251,32 @@ int main(int argc, char** argv) {
         return s;
     };
 
-    auto reset = [&]() {
+    // The helpers below run on the render thread with sim_mutex held.
+    auto clearHistory = [&]() {
+        mid_history.clear();
+        bid_history.clear();
+        ask_history.clear();
+        shift_history.clear();
+        depth_bid_best_history.clear();
+        depth_ask_best_history.clear();
+        event_rows.clear();
+        Sample stale;
+        while (sample_ring.tryPop(stale)) {}  // still in flight from before
+        has_pending = false;
+    };
+
+    auto pushTopOfBook = [&]() {
+        qrsdp::Level bid = book.bestBid();
+        qrsdp::Level ask = book.bestAsk();
+        const double t = producer->currentTime();
+        mid_history.push(t, 0.5 * (bid.price_ticks + ask.price_ticks));
+        bid_history.push(t, static_cast<double>(bid.price_ticks));
+        ask_history.push(t, static_cast<double>(ask.price_ticks));
+        depth_bid_best_history.push(static_cast<double>(event_count), static_cast<double>(bid.depth));
+        depth_ask_best_history.push(static_cast<double>(event_count), static_cast<double>(ask.depth));
+    };
+
+    auto resetLocked = [&]() {
         event_count = 0;
         count_add_bid = count_add_ask = count_cancel_bid = count_cancel_ask = 0;
         count_exec_buy = count_exec_sell = 0;
@@ -194,11 +285,8 @@ int main(int argc, char** argv) {
         last_shift_bid = last_shift_ask = 0;
         invariants_ok = true;
         invariant_msg[0] = '\0';
-        price_history.clear();
-        event_rows.clear();
-        depth_bid_best_history.clear();
-        depth_ask_best_history.clear();
-        sink.clear();
+        clearHistory();
+        steps_requested = 0;
         attrSamplerPtr = std::make_unique<qrsdp::UnitSizeAttributeSampler>(rng, ui_alpha, ui_spread_improve);
         attrSampler = attrSamplerPtr.get();
         if (ui_model == 0) {
@@ -222,86 +310,165 @@ int main(int argc, char** argv) {
         qrsdp::TradingSession session = buildSession();
         producer->startSession(session);
         ui_running = false;
-        // Push initial book state
-        qrsdp::Level bid = book.bestBid();
-        qrsdp::Level ask = book.bestAsk();
-        double mid = 0.5 * (bid.price_ticks + ask.price_ticks);
-        PricePoint pt;
-        pt.t = 0.0;
-        pt.mid = mid;
-        pt.bid = static_cast<double>(bid.price_ticks);
-        pt.ask = static_cast<double>(ask.price_ticks);
-        price_history.push_back(pt);
-        depth_bid_best_history.push_back(static_cast<double>(bid.depth));
-        depth_ask_best_history.push_back(static_cast<double>(ask.depth));
+        sim_running.store(false);
+        sim_finished.store(false);
+        pushTopOfBook();
+    };
+
+    auto reset = [&]() {
+        auto lock = lockSim();
+        resetLocked();
     };
 
-    auto stepOne = [&]() -> bool {
-        int32_t prev_bid = book.bestBid().price_ticks;
-        int32_t prev_ask = book.bestAsk().price_ticks;
-        bool produced = producer->stepOneEvent(sink);
-        if (!produced) return false;
-        const qrsdp::EventRecord& rec = sink.events().back();
+    // Render thread: folds one event into the histories and diagnostics.
+    auto consume = [&](const Sample& smp) {
         event_count++;
-        if (rec.type == 0) count_add_bid++;
-        else if (rec.type == 1) count_add_ask++;
-        else if (rec.type == 2) count_cancel_bid++;
-        else if (rec.type == 3) count_cancel_ask++;
-        else if (rec.type == 4) count_exec_buy++;
-        else if (rec.type == 5) count_exec_sell++;
-        qrsdp::Level bid = book.bestBid();
-        qrsdp::Level ask = book.bestAsk();
-        double t = producer->currentTime();
-        bool shift_down = (bid.price_ticks != prev_bid);
-        bool shift_up = (ask.price_ticks != prev_ask);
-        if (shift_down) { down_shifts++; last_shift_t = t; last_shift_bid = bid.price_ticks; last_shift_ask = ask.price_ticks; }
-        if (shift_up)   { up_shifts++;   last_shift_t = t; last_shift_bid = bid.price_ticks; last_shift_ask = ask.price_ticks; }
-        PricePoint pt;
-        pt.t = t;
-        pt.mid = 0.5 * (bid.price_ticks + ask.price_ticks);
-        pt.bid = static_cast<double>(bid.price_ticks);
-        pt.ask = static_cast<double>(ask.price_ticks);
-        pt.shift_up = shift_up;
-        pt.shift_down = shift_down;
-        price_history.push_back(pt);
-        if (price_history.size() > kPriceHistoryMax) price_history.pop_front();
-        depth_bid_best_history.push_back(static_cast<double>(bid.depth));
-        depth_ask_best_history.push_back(static_cast<double>(ask.depth));
-        while (depth_bid_best_history.size() > kDepthHistoryMax) depth_bid_best_history.pop_front();
-        while (depth_ask_best_history.size() > kDepthHistoryMax) depth_ask_best_history.pop_front();
+        if (smp.type == 0) count_add_bid++;
+        else if (smp.type == 1) count_add_ask++;
+        else if (smp.type == 2) count_cancel_bid++;
+        else if (smp.type == 3) count_cancel_ask++;
+        else if (smp.type == 4) count_exec_buy++;
+        else if (smp.type == 5) count_exec_sell++;
+        const double t = smp.t;
+        if (smp.shift_down) { down_shifts++; last_shift_t = t; last_shift_bid = smp.bid; last_shift_ask = smp.ask; }
+        if (smp.shift_up)   { up_shifts++;   last_shift_t = t; last_shift_bid = smp.bid; last_shift_ask = smp.ask; }
+        const double mid = 0.5 * (smp.bid + smp.ask);
+        mid_history.push(t, mid);
+        bid_history.push(t, static_cast<double>(smp.bid));
+        ask_history.push(t, static_cast<double>(smp.ask));
+        if (smp.shift_up || smp.shift_down) shift_history.push(t, mid);
+        depth_bid_best_history.push(static_cast<double>(event_count), static_cast<double>(smp.bid_depth));
+        depth_ask_best_history.push(static_cast<double>(event_count), static_cast<double>(smp.ask_depth));
         EventRow row;
         row.t_sec = t;
-        row.ts_ns = rec.ts_ns;
-        row.type = rec.type;
-        row.side = rec.side;
-        row.price_ticks = rec.price_ticks;
-        row.qty = rec.qty;
-        row.order_id = rec.order_id;
+        row.ts_ns = smp.ts_ns;
+        row.type = smp.type;
+        row.side = smp.side;
+        row.price_ticks = smp.price_ticks;
+        row.qty = smp.qty;
+        row.order_id = smp.order_id;
         row.is_shift_marker = false;
         event_rows.push_back(row);
-        if (shift_down || shift_up) {
+        if (smp.shift_down || smp.shift_up) {
             EventRow marker;
             marker.t_sec = t;
             marker.is_shift_marker = true;
-            snprintf(marker.shift_label, sizeof(marker.shift_label), "%s", shift_up && shift_down ? "SHIFT UP+DOWN" : shift_up ? "SHIFT UP" : "SHIFT DOWN");
+            snprintf(marker.shift_label, sizeof(marker.shift_label), "%s", smp.shift_up && smp.shift_down ? "SHIFT UP+DOWN" : smp.shift_up ? "SHIFT UP" : "SHIFT DOWN");
             event_rows.push_back(marker);
         }
         while (event_rows.size() > kEventTableMax) event_rows.pop_front();
         // Invariants
-        if (bid.price_ticks >= ask.price_ticks) {
+        if (smp.bid >= smp.ask) {
             invariants_ok = false;
-            snprintf(invariant_msg, sizeof(invariant_msg), "bid >= ask (%d >= %d)", bid.price_ticks, ask.price_ticks);
-        } else if (bid.depth > 1000000u || ask.depth > 1000000u) {
+            snprintf(invariant_msg, sizeof(invariant_msg), "bid >= ask (%d >= %d)", smp.bid, smp.ask);
+        } else if (smp.bid_depth > 1000000u || smp.ask_depth > 1000000u) {
             invariants_ok = false;
             snprintf(invariant_msg, sizeof(invariant_msg), "suspicious depth");
-        } else if (ask.price_ticks - bid.price_ticks < 1) {
+        } else if (smp.ask - smp.bid < 1) {
             invariants_ok = false;
             snprintf(invariant_msg, sizeof(invariant_msg), "spread < 1");
         }
-        return true;
     };
 
+    // Skip-ahead: replays from the session start when seeking backwards (the
+    // stream is deterministic), then fast-forwards without records. Histories
+    // and per-type counts restart at the landing point.
+    auto seekTo = [&](double target) {
+        auto lock = lockSim();
+        if (target < producer->currentTime()) resetLocked();
+        producer->fastForward(target);
+        event_count = producer->eventsWrittenThisSession();
+        count_add_bid = count_add_ask = count_cancel_bid = count_cancel_ask = 0;
+        count_exec_buy = count_exec_sell = 0;
+        up_shifts = down_shifts = 0;
+        clearHistory();
+        pushTopOfBook();
+    };
+
+    // Simulation thread: steps while running (paced to sim_rate) or while
+    // steps are queued. A full ring means the render thread is behind; the
+    // thread then waits rather than dropping events.
+    auto simLoop = [&]() {
+        LastRecordSink sink;
+        double credit = 0.0;
+        auto last = std::chrono::steady_clock::now();
+        while (!sim_quit.load()) {
+            while (ui_waiting.load()) std::this_thread::yield();
+            const auto now = std::chrono::steady_clock::now();
+            const double dt = std::chrono::duration<double>(now - last).count();
+            last = now;
+            if (sim_running.load())
+                credit = std::min(credit + dt * sim_rate.load(), static_cast<double>(kStepChunk));
+            else
+                credit = 0.0;
+            size_t produced = 0;
+            {
+                std::lock_guard<std::mutex> lock(sim_mutex);
+                bool blocked = has_pending && !sample_ring.tryPush(pending);
+                has_pending = blocked;
+                const size_t steps = static_cast<size_t>(std::min<uint64_t>(steps_requested, kStepChunk));
+                const size_t want = std::min(steps + static_cast<size_t>(credit), kStepChunk);
+                while (!blocked && produced < want) {
+                    const int32_t prev_bid = book.bestBid().price_ticks;
+                    const int32_t prev_ask = book.bestAsk().price_ticks;
+                    if (!producer->stepOneEvent(sink)) break;
+                    ++produced;
+                    const qrsdp::EventRecord& rec = sink.last;
+                    const qrsdp::Level bid = book.bestBid();
+                    const qrsdp::Level ask = book.bestAsk();
+                    Sample smp;
+                    smp.t = producer->currentTime();
+                    smp.ts_ns = rec.ts_ns;
+                    smp.order_id = rec.order_id;
+                    smp.price_ticks = rec.price_ticks;
+                    smp.qty = rec.qty;
+                    smp.bid = bid.price_ticks;
+                    smp.ask = ask.price_ticks;
+                    smp.bid_depth = bid.depth;
+                    smp.ask_depth = ask.depth;
+                    smp.type = rec.type;
+                    smp.side = rec.side;
+                    smp.shift_down = bid.price_ticks != prev_bid;
+                    smp.shift_up = ask.price_ticks != prev_ask;
+                    if (!sample_ring.tryPush(smp)) {
+                        pending = smp;
+                        has_pending = blocked = true;
+                    }
+                }
+                const size_t by_steps = std::min(produced, steps);
+                steps_requested -= by_steps;
+                credit -= static_cast<double>(produced - by_steps);
+                if (!blocked && produced < want) {  // the session is over
+                    steps_requested = 0;
+                    if (sim_running.load()) sim_finished.store(true);
+                }
+            }
+            if (produced == 0) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    };
+
+    // A few points per pixel of the plot about to be drawn.
+    auto decimate = [&](const qrsdp::PlotSeries& series, size_t pixels,
+                        std::vector<double>& x, std::vector<double>& y) {
+        if (ui_decimation == 0) qrsdp::decimateMinMax(series, pixels, x, y);
+        else qrsdp::decimateLttb(series, 2 * pixels, x, y);
+    };
+    auto plotPixels = []() {
+        return static_cast<size_t>(std::max(64.0f, ImGui::GetContentRegionAvail().x));
+    };
+    auto extendRange = [](const std::vector<double>& v, double& lo, double& hi) {
+        for (double d : v) {
+            lo = std::min(lo, d);
+            hi = std::max(hi, d);
+        }
+    };
+    std::vector<double> mid_x, mid_y, bid_x, bid_y, ask_x, ask_y, shift_x, shift_y;
+    std::vector<double> dep_bid_x, dep_bid_y, dep_ask_x, dep_ask_y;
+    BookSnapshot snap;
+    qrsdp::BookState state;
+
     reset();
+    std::thread sim_thread(simLoop);
 
     while (!glfwWindowShouldClose(window)) {
         glfwPollEvents();
@@ -309,11 +476,43 @@ int main(int argc, char** argv) {
         ImGui_ImplGlfw_NewFrame();
         ImGui::NewFrame();
 
-        if (ui_running) {
-            int limit = ui_max_events_per_frame;
-            while (limit-- > 0 && stepOne()) {}
-            if (producer->currentTime() >= static_cast<double>(ui_session_seconds))
-                ui_running = false;
+        if (sim_finished.exchange(false)) ui_running = false;
+        sim_running.store(ui_running);
+        sim_rate.store(ui_events_per_sec);
+        size_t drained = 0;
+        {
+            Sample smp;
+            while (drained < kSampleRingCapacity && sample_ring.tryPop(smp)) {
+                consume(smp);
+                ++drained;
+            }
+        }
+        {
+            auto lock = lockSim();
+            snap.t = producer->currentTime();
+            snap.producer_shifts = producer->shiftCountThisSession();
+            snap.bid = book.bestBid();
+            snap.ask = book.bestAsk();
+            state.features = book.features();
+            state.bid_depths.clear();
+            state.ask_depths.clear();
+            const size_t num_levels = book.numLevels();
+            for (size_t k = 0; k < num_levels; ++k) {
+                state.bid_depths.push_back(book.bidDepthAtLevel(k));
+                state.ask_depths.push_back(book.askDepthAtLevel(k));
+            }
+            snap.features = state.features;
+            snap.intensities = intensityModel->compute(state);
+            snap.bid_prices.clear();
+            snap.ask_prices.clear();
+            snap.bid_depths.clear();
+            snap.ask_depths.clear();
+            for (size_t k = 0; k < std::min(num_levels, static_cast<size_t>(kLadderLevels)); ++k) {
+                snap.bid_prices.push_back(book.bidPriceAtLevel(k));
+                snap.bid_depths.push_back(book.bidDepthAtLevel(k));
+                snap.ask_prices.push_back(book.askPriceAtLevel(k));
+                snap.ask_depths.push_back(book.askDepthAtLevel(k));
+            }
         }
 
         // --- Controls (left) ---
@@ -379,13 +578,35 @@ int main(int argc, char** argv) {
         ImGui::Separator();
         if (ImGui::Button("Reset")) reset();
         ImGui::SameLine();
-        if (ImGui::Button("Step 1")) stepOne();
+        if (ImGui::Button("Step 1")) {
+            auto lock = lockSim();
+            steps_requested += 1;
+        }
         ImGui::SameLine();
         ImGui::SetNextItemWidth(60);
         ImGui::InputInt("N", &ui_step_N); if (ui_step_N < 1) ui_step_N = 1; if (ui_step_N > 1000) ui_step_N = 1000;
-        if (ImGui::Button("Step N")) { for (int i = 0; i < ui_step_N; i++) if (!stepOne()) break; }
+        if (ImGui::Button("Step N")) {
+            auto lock = lockSim();
+            steps_requested += static_cast<uint64_t>(ui_step_N);
+        }
+        ImGui::SetNextItemWidth(100);
+        ImGui::InputDouble("t (s)", &ui_seek_t, 1.0, 0, "%.3f");
+        ImGui::SameLine();
+        if (ImGui::Button("Seek")) seekTo(ui_seek_t);
+        if (ImGui::IsItemHovered())
+            ImGui::SetTooltip("Fast-forward to the first event at or after t (replays from 0 when seeking back).");
         ImGui::Checkbox("Run", &ui_running);
-        ImGui::SliderInt("Max events/frame", &ui_max_events_per_frame, 1, 5000, "%d");
+        {
+            const double rate_min = 10.0, rate_max = 1e7;
+            ImGui::SliderScalar("Events/s", ImGuiDataType_Double, &ui_events_per_sec, &rate_min, &rate_max,
+                                "%.0f", ImGuiSliderFlags_Logarithmic);
+            if (ImGui::IsItemHovered())
+                ImGui::SetTooltip("Simulation speed while running; the simulation thread goes flat out at the top.");
+        }
+        const char* decimation_items[] = { "Min-max", "LTTB" };
+        ImGui::Combo("Decimation", &ui_decimation, decimation_items, 2);
+        if (ImGui::IsItemHovered())
+            ImGui::SetTooltip("Plots draw a few points per pixel. Min-max keeps every spike; LTTB keeps the shape.");
         if (ImGui::Button("Debug Preset")) {
             ui_initial_depth = 2;
             ui_initial_spread_ticks = 2;
@@ -424,26 +645,17 @@ int main(int argc, char** argv) {
 
         // --- Diagnostics (top-right) ---
         ImGui::Begin("Top-of-book / Diagnostics");
-        qrsdp::Level bid = book.bestBid();
-        qrsdp::Level ask = book.bestAsk();
-        qrsdp::BookState state;
-        state.features = book.features();
-        const size_t num_levels = book.numLevels();
-        state.bid_depths.clear();
-        state.ask_depths.clear();
-        for (size_t k = 0; k < num_levels; ++k) {
-            state.bid_depths.push_back(book.bidDepthAtLevel(k));
-            state.ask_depths.push_back(book.askDepthAtLevel(k));
-        }
-        const qrsdp::BookFeatures& f = state.features;
-        ImGui::Text("t = %.3f s   event_count = %lu", producer->currentTime(), (unsigned long)event_count);
+        const qrsdp::Level& bid = snap.bid;
+        const qrsdp::Level& ask = snap.ask;
+        const qrsdp::BookFeatures& f = snap.features;
+        ImGui::Text("t = %.3f s   event_count = %lu", snap.t, (unsigned long)event_count);
         ImGui::Text("best_bid = %d   best_ask = %d   spread = %d", bid.price_ticks, ask.price_ticks, f.spread_ticks);
         ImGui::Text("best_bid_depth = %u   best_ask_depth = %u", bid.depth, ask.depth);
         ImGui::Text("imbalance I = %.4f", f.imbalance);
         ImGui::Separator();
         // Real-time intensities (exact producer logic via same model)
         {
-            qrsdp::Intensities intens = intensityModel->compute(state);
+            const qrsdp::Intensities& intens = snap.intensities;
             ImGui::Text("lambda_total (Lambda) = %.4f", intens.total());
             ImGui::Text("add_bid=%.3f add_ask=%.3f cancel_bid=%.3f cancel_ask=%.3f exec_buy=%.3f exec_sell=%.3f",
                         intens.add_bid, intens.add_ask, intens.cancel_bid, intens.cancel_ask, intens.exec_buy, intens.exec_sell);
@@ -479,7 +691,7 @@ int main(int argc, char** argv) {
                     (unsigned long)count_exec_buy, (unsigned long)count_exec_sell);
         ImGui::Text("Shifts: up=%lu down=%lu total=%lu (producer shift_count=%lu)",
                     (unsigned long)up_shifts, (unsigned long)down_shifts, (unsigned long)(up_shifts + down_shifts),
-                    (unsigned long)producer->shiftCountThisSession());
+                    (unsigned long)snap.producer_shifts);
         ImGui::Text("Last shift: t=%.3f bid=%d ask=%d", last_shift_t, last_shift_bid, last_shift_ask);
         if (!invariants_ok && invariant_msg[0]) {
             ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(1, 0.2f, 0.2f, 1));
@@ -488,6 +700,8 @@ int main(int argc, char** argv) {
         } else {
             ImGui::TextColored(ImVec4(0.2f, 1, 0.2f, 1), "Invariants OK");
         }
+        ImGui::Separator();
+        ImGui::Text("Render: %.0f fps   events this frame: %lu", io.Framerate, (unsigned long)drained);
         ImGui::End();
 
         // --- Price over time ---
@@ -497,40 +711,37 @@ int main(int argc, char** argv) {
         ImGui::Checkbox("Bid/Ask", &ui_show_bid_ask);
         ImGui::SameLine();
         ImGui::Checkbox("Shift markers", &ui_show_shift_markers);
+        const size_t price_px = plotPixels();
         if (ImPlot::BeginPlot("Price", ImVec2(-1, 280))) {
-            if (!price_history.empty()) {
-                const size_t n = price_history.size();
-                std::vector<double> tx(n), mid_v(n), bid_v(n), ask_v(n);
-                std::vector<double> shift_t, shift_y;
-                double x_min = price_history[0].t, x_max = price_history[0].t;
-                double y_min = price_history[0].mid, y_max = price_history[0].mid;
-                for (size_t i = 0; i < n; i++) {
-                    tx[i] = price_history[i].t;
-                    mid_v[i] = price_history[i].mid;
-                    bid_v[i] = price_history[i].bid;
-                    ask_v[i] = price_history[i].ask;
-                    x_min = std::min(x_min, price_history[i].t);
-                    x_max = std::max(x_max, price_history[i].t);
-                    y_min = std::min(y_min, std::min(price_history[i].mid, std::min(price_history[i].bid, price_history[i].ask)));
-                    y_max = std::max(y_max, std::max(price_history[i].mid, std::max(price_history[i].bid, price_history[i].ask)));
-                    if (ui_show_shift_markers && (price_history[i].shift_up || price_history[i].shift_down)) {
-                        shift_t.push_back(price_history[i].t);
-                        shift_y.push_back(price_history[i].mid);
-                        y_min = std::min(y_min, price_history[i].mid);
-                        y_max = std::max(y_max, price_history[i].mid);
+            if (!mid_history.empty()) {
+                decimate(mid_history, price_px, mid_x, mid_y);
+                decimate(bid_history, price_px, bid_x, bid_y);
+                decimate(ask_history, price_px, ask_x, ask_y);
+                double x_min = mid_history.x(0), x_max = mid_history.x(mid_history.size() - 1);
+                double y_min = mid_y[0], y_max = mid_y[0];
+                extendRange(mid_y, y_min, y_max);
+                extendRange(bid_y, y_min, y_max);
+                extendRange(ask_y, y_min, y_max);
+                shift_x.clear();
+                shift_y.clear();
+                if (ui_show_shift_markers) {
+                    for (size_t i = 0; i < shift_history.size(); i++) {
+                        if (shift_history.x(i) < x_min) continue;  // older than the price history
+                        shift_x.push_back(shift_history.x(i));
+                        shift_y.push_back(shift_history.y(i));
                     }
                 }
                 double y_pad = (y_max - y_min) * 0.05;
                 if (y_pad < 0.5) y_pad = 0.5;
                 if (x_max <= x_min) x_max = x_min + 1.0;
                 ImPlot::SetupAxesLimits(x_min, x_max, y_min - y_pad, y_max + y_pad, ImPlotCond_Always);
-                if (ui_show_mid) ImPlot::PlotLine("Mid", tx.data(), mid_v.data(), (int)n);
+                if (ui_show_mid) ImPlot::PlotLine("Mid", mid_x.data(), mid_y.data(), (int)mid_x.size());
                 if (ui_show_bid_ask) {
-                    ImPlot::PlotLine("Bid", tx.data(), bid_v.data(), (int)n);
-                    ImPlot::PlotLine("Ask", tx.data(), ask_v.data(), (int)n);
+                    ImPlot::PlotLine("Bid", bid_x.data(), bid_y.data(), (int)bid_x.size());
+                    ImPlot::PlotLine("Ask", ask_x.data(), ask_y.data(), (int)ask_x.size());
                 }
-                if (ui_show_shift_markers && !shift_t.empty())
-                    ImPlot::PlotScatter("Shift", shift_t.data(), shift_y.data(), (int)shift_t.size());
+                if (ui_show_shift_markers && !shift_x.empty())
+                    ImPlot::PlotScatter("Shift", shift_x.data(), shift_y.data(), (int)shift_x.size());
             }
             ImPlot::EndPlot();
         }
@@ -538,23 +749,22 @@ int main(int argc, char** argv) {
 
         // --- Depth at best over time ---
         ImGui::Begin("Depth at best");
+        const size_t depth_px = plotPixels();
         if (ImPlot::BeginPlot("Depth", ImVec2(-1, 180))) {
             if (!depth_bid_best_history.empty()) {
-                const size_t n = depth_bid_best_history.size();
-                std::vector<double> tx(n), bid_dep(n), ask_dep(n);
-                double d_min = depth_bid_best_history[0], d_max = depth_bid_best_history[0];
-                for (size_t i = 0; i < n; i++) {
-                    tx[i] = static_cast<double>(i);
-                    bid_dep[i] = depth_bid_best_history[i];
-                    ask_dep[i] = depth_ask_best_history[i];
-                    d_min = std::min(d_min, std::min(depth_bid_best_history[i], depth_ask_best_history[i]));
-                    d_max = std::max(d_max, std::max(depth_bid_best_history[i], depth_ask_best_history[i]));
-                }
+                decimate(depth_bid_best_history, depth_px, dep_bid_x, dep_bid_y);
+                decimate(depth_ask_best_history, depth_px, dep_ask_x, dep_ask_y);
+                const double x_min = depth_bid_best_history.x(0);
+                double x_max = depth_bid_best_history.x(depth_bid_best_history.size() - 1);
+                double d_min = dep_bid_y[0], d_max = dep_bid_y[0];
+                extendRange(dep_bid_y, d_min, d_max);
+                extendRange(dep_ask_y, d_min, d_max);
                 double d_pad = (d_max - d_min) * 0.05;
                 if (d_pad < 0.5) d_pad = 0.5;
-                ImPlot::SetupAxesLimits(0.0, static_cast<double>(n) - 0.5, d_min - d_pad, d_max + d_pad, ImPlotCond_Always);
-                ImPlot::PlotLine("Bid best", tx.data(), bid_dep.data(), (int)n);
-                ImPlot::PlotLine("Ask best", tx.data(), ask_dep.data(), (int)n);
+                if (x_max <= x_min) x_max = x_min + 1.0;
+                ImPlot::SetupAxesLimits(x_min, x_max, d_min - d_pad, d_max + d_pad, ImPlotCond_Always);
+                ImPlot::PlotLine("Bid best", dep_bid_x.data(), dep_bid_y.data(), (int)dep_bid_x.size());
+                ImPlot::PlotLine("Ask best", dep_ask_x.data(), dep_ask_y.data(), (int)dep_ask_x.size());
             }
             ImPlot::EndPlot();
         }
@@ -568,15 +778,14 @@ int main(int argc, char** argv) {
             ImGui::TableSetupColumn("Ask price", ImGuiTableColumnFlags_WidthFixed, 100);
             ImGui::TableSetupColumn("Ask depth", ImGuiTableColumnFlags_WidthFixed, 80);
             ImGui::TableHeadersRow();
-            int32_t best_bid = book.bestBid().price_ticks;
-            int32_t best_ask = book.bestAsk().price_ticks;
-            int n = static_cast<int>(std::min(book.numLevels(), static_cast<size_t>(kLadderLevels)));
-            for (int k = 0; k < n; k++) {
+            int32_t best_bid = snap.bid.price_ticks;
+            int32_t best_ask = snap.ask.price_ticks;
+            for (size_t k = 0; k < snap.bid_prices.size(); k++) {
                 ImGui::TableNextRow();
-                int32_t bp = book.bidPriceAtLevel(static_cast<size_t>(k));
-                uint32_t bd = book.bidDepthAtLevel(static_cast<size_t>(k));
-                int32_t ap = book.askPriceAtLevel(static_cast<size_t>(k));
-                uint32_t ad = book.askDepthAtLevel(static_cast<size_t>(k));
+                int32_t bp = snap.bid_prices[k];
+                uint32_t bd = snap.bid_depths[k];
+                int32_t ap = snap.ask_prices[k];
+                uint32_t ad = snap.ask_depths[k];
                 bool best_bid_row = (bp == best_bid);
                 bool best_ask_row = (ap == best_ask);
                 if (best_bid_row) ImGui::TableSetBgColor(ImGuiTableBgTarget_RowBg0, IM_COL32(80, 120, 80, 80));
@@ -631,6 +840,9 @@ int main(int argc, char** argv) {
         glfwSwapBuffers(window);
     }
 
+    sim_quit.store(true);
+    sim_thread.join();
+
     ImGui_ImplOpenGL3_Shutdown();
     ImGui_ImplGlfw_Shutdown();
     ImPlot::DestroyContext();